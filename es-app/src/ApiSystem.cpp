@@ -2,11 +2,14 @@
 #include "Settings.h"
 #include "Log.h"
 #include "HttpReq.h"
+#include "HttpDownload.h"
 #include "AudioManager.h"
 #include "VolumeControl.h"
 #include "InputManager.h"
 #include "EmulationStation.h"
 #include "SystemConf.h"
+#include "ConfigWriter.h"
+#include "CommandCache.h"
 #include "Sound.h"
 #include "utils/Platform.h"
 #include "utils/FileSystemUtil.h"
@@ -14,6 +17,7 @@
 #include "utils/ThreadPool.h"
 #include "RetroAchievements.h"
 #include "utils/ZipFile.h"
+#include "HashCache.h"
 #include "Paths.h"
 #include "utils/VectorEx.h"
 #include "LocaleES.h"
@@ -502,58 +506,61 @@ void ApiSystem::stopBluetoothLiveDevices()
 
 bool ApiSystem::pairBluetoothDevice(const std::string& deviceName)
 {
+	CommandCache::invalidate("batocera-bluetooth");
 	return executeScript("batocera-bluetooth trust " + deviceName);
 }
 
 bool ApiSystem::removeBluetoothDevice(const std::string& deviceName)
 {
+	CommandCache::invalidate("batocera-bluetooth");
 	return executeScript("batocera-bluetooth remove " + deviceName);
 }
 
 bool ApiSystem::scanNewBluetooth(const std::function<void(const std::string)>& func)
 {
+	CommandCache::invalidate("batocera-bluetooth");
 	return executeScript("batocera-bluetooth trust input", func).second == 0;
 }
 
 std::vector<std::string> ApiSystem::getPairedBluetoothDeviceList()
 {
-	return executeEnumerationScript("batocera-bluetooth list");
+	return executeCachedEnumerationScript("batocera-bluetooth list", CommandCache::DEVICES);
 }
 
 
 std::vector<std::string> ApiSystem::getAvailableStorageDevices() 
 {
-	return executeEnumerationScript("batocera-config storage list");
+	return executeCachedEnumerationScript("batocera-config storage list", CommandCache::DEVICES);
 }
 
 std::vector<std::string> ApiSystem::getVideoModes() 
 {
-	return executeEnumerationScript("batocera-resolution listModes");
+	return executeCachedEnumerationScript("batocera-resolution listModes", CommandCache::HARDWARE);
 }
 
 std::vector<std::string> ApiSystem::getAvailableBackupDevices() 
 {
-	return executeEnumerationScript("batocera-sync list");
+	return executeCachedEnumerationScript("batocera-sync list", CommandCache::DEVICES);
 }
 
 std::vector<std::string> ApiSystem::getAvailableInstallDevices() 
 {
-	return executeEnumerationScript("batocera-install listDisks");
+	return executeCachedEnumerationScript("batocera-install listDisks", CommandCache::DEVICES);
 }
 
 std::vector<std::string> ApiSystem::getAvailableInstallArchitectures() 
 {
-	return executeEnumerationScript("batocera-install listArchs");
+	return executeCachedEnumerationScript("batocera-install listArchs", CommandCache::HARDWARE);
 }
 
 std::vector<std::string> ApiSystem::getAvailableOverclocking() 
 {
-	return executeEnumerationScript("batocera-overclock list");
+	return executeCachedEnumerationScript("batocera-overclock list", CommandCache::HARDWARE);
 }
 
 std::vector<std::string> ApiSystem::getSystemInformations() 
 {
-	return executeEnumerationScript("batocera-info --full");
+	return executeCachedEnumerationScript("batocera-info --full", CommandCache::STATUS);
 }
 
 std::vector<BiosSystem> ApiSystem::getBiosInformations(const std::string system) 
@@ -620,24 +627,16 @@ std::string ApiSystem::getCurrentStorage()
 	return "DEFAULT";
 #endif
 
-	std::ostringstream oss;
-	oss << "batocera-config storage current";
-	FILE *pipe = popen(oss.str().c_str(), "r");
-	char line[1024];
-
-	if (pipe == NULL)
-		return "";	
+	auto lines = executeCachedEnumerationScript("batocera-config storage current", CommandCache::STATUS);
+	if (lines.size() > 0)
+		return lines[0];
 
-	if (fgets(line, 1024, pipe)) {
-		strtok(line, "\n");
-		pclose(pipe);
-		return std::string(line);
-	}
 	return "INTERNAL";
 }
 
 bool ApiSystem::setStorage(std::string selected) 
 {
+	CommandCache::invalidate("batocera-config storage");
 	return executeScript("batocera-config storage " + selected);
 }
 
@@ -653,6 +652,7 @@ bool ApiSystem::setPowerLedGameForce(std::string selected)
 
 bool ApiSystem::forgetBluetoothControllers() 
 {
+	CommandCache::invalidate("batocera-bluetooth");
 	return executeScript("batocera-config forgetBT");
 }
 
@@ -679,7 +679,7 @@ std::string ApiSystem::getRootPassword()
 
 std::vector<std::string> ApiSystem::getAvailableVideoOutputDevices() 
 {
-	return executeEnumerationScript("batocera-config lsoutputs");
+	return executeCachedEnumerationScript("batocera-config lsoutputs", CommandCache::DEVICES);
 }
 
 std::vector<std::string> ApiSystem::getAvailableAudioOutputDevices() 
@@ -690,7 +690,7 @@ std::vector<std::string> ApiSystem::getAvailableAudioOutputDevices()
 	return res;
 #endif
 
-	return executeEnumerationScript("batocera-audio list");
+	return executeCachedEnumerationScript("batocera-audio list", CommandCache::DEVICES);
 }
 
 std::string ApiSystem::getCurrentAudioOutputDevice() 
@@ -701,20 +701,9 @@ std::string ApiSystem::getCurrentAudioOutputDevice()
 
 	LOG(LogDebug) << "ApiSystem::getCurrentAudioOutputDevice";
 
-	std::ostringstream oss;
-	oss << "batocera-audio get";
-	FILE *pipe = popen(oss.str().c_str(), "r");
-	char line[1024];
-
-	if (pipe == NULL)
-		return "";	
-
-	if (fgets(line, 1024, pipe)) 
-	{
-		strtok(line, "\n");
-		pclose(pipe);
-		return std::string(line);
-	}
+	auto lines = executeCachedEnumerationScript("batocera-audio get", CommandCache::STATUS);
+	if (lines.size() > 0)
+		return lines[0];
 
 	return "";
 }
@@ -728,6 +717,8 @@ bool ApiSystem::setAudioOutputDevice(std::string selected)
 	oss << "batocera-audio set" << " '" << selected << "'";
 	int exitcode = system(oss.str().c_str());
 
+	CommandCache::invalidate("batocera-audio");
+
 	Sound::get(":/checksound.ogg")->play();
 
 	return exitcode == 0;
@@ -741,7 +732,7 @@ std::vector<std::string> ApiSystem::getAvailableAudioOutputProfiles()
 	return res;
 #endif
 
-	return executeEnumerationScript("batocera-audio list-profiles");
+	return executeCachedEnumerationScript("batocera-audio list-profiles", CommandCache::DEVICES);
 }
 
 std::string ApiSystem::getCurrentAudioOutputProfile() 
@@ -752,20 +743,9 @@ std::string ApiSystem::getCurrentAudioOutputProfile()
 
 	LOG(LogDebug) << "ApiSystem::getCurrentAudioOutputProfile";
 
-	std::ostringstream oss;
-	oss << "batocera-audio get-profile";
-	FILE *pipe = popen(oss.str().c_str(), "r");
-	char line[1024];
-
-	if (pipe == NULL)
-		return "";	
-
-	if (fgets(line, 1024, pipe)) 
-	{
-		strtok(line, "\n");
-		pclose(pipe);
-		return std::string(line);
-	}
+	auto lines = executeCachedEnumerationScript("batocera-audio get-profile", CommandCache::STATUS);
+	if (lines.size() > 0)
+		return lines[0];
 
 	return "";
 }
@@ -778,6 +758,8 @@ bool ApiSystem::setAudioOutputProfile(std::string selected)
 
 	oss << "batocera-audio set-profile" << " '" << selected << "'";
 	int exitcode = system(oss.str().c_str());
+
+	CommandCache::invalidate("batocera-audio get-profile");
 	
 	Sound::get(":/checksound.ogg")->play();
 
@@ -856,33 +838,22 @@ bool ApiSystem::downloadGitRepository(const std::string& url, const std::string&
 		}
 	}
 
-	HttpReq httpreq(url + "/archive/"+ branch +".zip", fileName);
-
-	int curPos = -1;
-	while (httpreq.status() == HttpReq::REQ_IN_PROGRESS)
+	int64_t curPos = -1;
+	return HttpDownload::download(url + "/archive/" + branch + ".zip", fileName, [&](int64_t pos, int64_t total)
 	{
-		if (downloadSize > 0)
+		// Archives generated on the fly have no length : estimated from the repository size
+		int64_t size = total > 0 ? total : downloadSize;
+		if (size > 0 && pos > 0 && curPos != pos)
 		{
-			int64_t pos = httpreq.getPosition();
-			if (pos > 0 && curPos != pos)
+			if (func != nullptr)
 			{
-				if (func != nullptr)
-				{
-					std::string pc = std::to_string((int)(pos * 100LL / downloadSize));
-					func(std::string("Downloading " + label + " >>> " + pc + " %"));
-				}
-
-				curPos = pos;
+				std::string pc = std::to_string((int)(pos * 100LL / size));
+				func(std::string("Downloading " + label + " >>> " + pc + " %"));
 			}
-		}
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(20));
-	}
 
-	if (httpreq.status() != HttpReq::REQ_SUCCESS)
-		return false;
-
-	return true;
+			curPos = pos;
+		}
+	});
 }
 
 bool ApiSystem::isThemeInstalled(const std::string& themeName, const std::string& url)
@@ -1086,7 +1057,29 @@ std::pair<std::string, int> ApiSystem::uninstallBatoceraBezel(std::string bezels
 	return executeScript("batocera-es-thebezelproject remove " + bezelsystem, func);
 }
 
+static bool isHashedFromArchive(const std::string& fileName, bool fromZipContents)
+{
+	if (!fromZipContents)
+		return false;
+
+	std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(fileName));
+	return ext == ".zip" || ext == ".7z";
+}
+
 std::string ApiSystem::getMD5(const std::string fileName, bool fromZipContents)
+{
+	bool fromArchive = isHashedFromArchive(fileName, fromZipContents);
+
+	std::string ret;
+	if (HashCache::get(fileName, HashCache::HASH_MD5, fromArchive, ret))
+		return ret;
+
+	ret = computeMD5(fileName, fromZipContents);
+	HashCache::set(fileName, HashCache::HASH_MD5, fromArchive, ret);
+	return ret;
+}
+
+std::string ApiSystem::computeMD5(const std::string& fileName, bool fromZipContents)
 {
 	LOG(LogDebug) << "getMD5 >> " << fileName;
 
@@ -1094,28 +1087,11 @@ std::string ApiSystem::getMD5(const std::string fileName, bool fromZipContents)
 	std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(fileName));
 	if (ext == ".zip" && fromZipContents)
 	{
+		// Decompressed straight into the MD5 : no temporary file
 		Utils::Zip::ZipFile file;
-		if (file.load(fileName))
-		{
-			std::string romName;
-
-			for (auto name : file.namelist())
-			{
-				if (Utils::FileSystem::getExtension(name) != ".txt" && !Utils::String::endsWith(name, "/"))
-				{
-					if (!romName.empty())
-					{
-						romName = "";
-						break;
-					}
-
-					romName = name;
-				}
-			}
-
-			if (!romName.empty())
-				return file.getFileMd5(romName);
-		}
+		Utils::Zip::ZipInfo rom;
+		if (file.load(fileName) && file.findSingleFile(rom))
+			return file.getFileMd5(rom.filename);
 	}
 
 #if !WIN32
@@ -1162,6 +1138,19 @@ std::string ApiSystem::getMD5(const std::string fileName, bool fromZipContents)
 }
 
 std::string ApiSystem::getCRC32(std::string fileName, bool fromZipContents)
+{
+	bool fromArchive = isHashedFromArchive(fileName, fromZipContents);
+
+	std::string ret;
+	if (HashCache::get(fileName, HashCache::HASH_CRC32, fromArchive, ret))
+		return ret;
+
+	ret = computeCRC32(fileName, fromZipContents);
+	HashCache::set(fileName, HashCache::HASH_CRC32, fromArchive, ret);
+	return ret;
+}
+
+std::string ApiSystem::computeCRC32(const std::string& fileName, bool fromZipContents)
 {
 	LOG(LogDebug) << "getCRC32 >> " << fileName;
 
@@ -1187,32 +1176,47 @@ std::string ApiSystem::getCRC32(std::string fileName, bool fromZipContents)
 	{
 		LOG(LogDebug) << "getCRC32 is using ZipFile";
 
+		// The CRC32 of the central directory
 		Utils::Zip::ZipFile file;
-		if (file.load(fileName))
-		{
-			std::string romName;
+		Utils::Zip::ZipInfo rom;
+		if (file.load(fileName) && file.findSingleFile(rom))
+			return Utils::String::format("%08X", rom.crc);
+	}
 
-			for (auto name : file.namelist())
-			{
-				if (Utils::FileSystem::getExtension(name) != ".txt" && !Utils::String::endsWith(name, "/"))
-				{
-					if (!romName.empty())
-					{
-						romName = "";
-						break;
-					}
+	LOG(LogDebug) << "getCRC32 is using fileBuffer";
+	return Utils::FileSystem::getFileCrc32(fileName);
+}
 
-					romName = name;
-				}
-			}
+bool ApiSystem::getCRC32AndMD5(const std::string fileName, bool fromZipContents, std::string& crc32, std::string& md5)
+{
+	bool fromArchive = isHashedFromArchive(fileName, fromZipContents);
+	if (fromArchive && Utils::String::toLower(Utils::FileSystem::getExtension(fileName)) != ".zip")
+		return false;
 
-			if (!romName.empty())
-				return file.getFileCrc(romName);
-		}
+	if (HashCache::get(fileName, HashCache::HASH_CRC32, fromArchive, crc32) && HashCache::get(fileName, HashCache::HASH_MD5, fromArchive, md5))
+		return true;
+
+	LOG(LogDebug) << "getCRC32AndMD5 >> " << fileName;
+
+	if (fromArchive)
+	{
+		// One opening of the zip : the CRC32 from its central directory, the MD5 streamed from the decompression
+		Utils::Zip::ZipFile file;
+		Utils::Zip::ZipInfo rom;
+		if (!file.load(fileName) || !file.findSingleFile(rom))
+			return false;
+
+		crc32 = Utils::String::format("%08X", rom.crc);
+		md5 = file.getFileMd5(rom.filename);
+		if (md5.empty())
+			return false;
 	}
+	else if (!Utils::FileSystem::getFileCrc32AndMd5(fileName, crc32, md5))
+		return false;
 
-	LOG(LogDebug) << "getCRC32 is using fileBuffer";
-	return Utils::FileSystem::getFileCrc32(fileName);
+	HashCache::set(fileName, HashCache::HASH_CRC32, fromArchive, crc32);
+	HashCache::set(fileName, HashCache::HASH_MD5, fromArchive, md5);
+	return true;
 }
 
 bool ApiSystem::unzipFile(const std::string fileName, const std::string destFolder, const std::function<bool(const std::string)>& shouldExtract)
@@ -1340,10 +1344,42 @@ std::vector<std::string> ApiSystem::getWifiNetworks(bool scan)
 	return executeEnumerationScript(scan ? "batocera-wifi scanlist" : "batocera-wifi list");
 }
 
+std::vector<std::string> ApiSystem::executeCachedEnumerationScript(const std::string& command, CommandCache::Kind kind)
+{
+	return CommandCache::execute(command, kind, [this, command]() { return executeEnumerationScript(command); });
+}
+
+void ApiSystem::prefetchMenuQueries()
+{
+#if !WIN32
+	// What the system & sound settings ask first. Unsupported commands just return nothing
+	static const std::vector<std::pair<const char*, CommandCache::Kind>> queries =
+	{
+		{ "batocera-config lsoutputs", CommandCache::DEVICES },
+		{ "batocera-audio list", CommandCache::DEVICES },
+		{ "batocera-audio get", CommandCache::STATUS },
+		{ "batocera-audio list-profiles", CommandCache::DEVICES },
+		{ "batocera-overclock list", CommandCache::HARDWARE },
+		{ "batocera-config storage list", CommandCache::DEVICES },
+		{ "batocera-config storage current", CommandCache::STATUS },
+		{ "batocera-resolution listModes", CommandCache::HARDWARE }
+	};
+
+	for (auto& query : queries)
+	{
+		std::string command = query.first;
+		CommandCache::prefetch(command, query.second, [this, command]() { return executeEnumerationScript(command); });
+	}
+#endif
+}
+
 std::vector<std::string> ApiSystem::executeEnumerationScript(const std::string command)
 {
 	LOG(LogDebug) << "ApiSystem::executeEnumerationScript -> " << command;
 
+	// The batocera scripts read the configuration files
+	ConfigWriter::flush();
+
 	std::vector<std::string> res;
 
 	FILE *pipe = popen(command.c_str(), "r");
@@ -1366,6 +1402,8 @@ std::pair<std::string, int> ApiSystem::executeScript(const std::string command,
 {
 	LOG(LogInfo) << "ApiSystem::executeScript -> " << command;
 
+	ConfigWriter::flush();
+
 	FILE *pipe = popen(command.c_str(), "r");
 	if (pipe == NULL)
 	{
@@ -1390,6 +1428,8 @@ bool ApiSystem::executeScript(const std::string command)
 {	
 	LOG(LogInfo) << "Running " << command;
 
+	ConfigWriter::flush();
+
 	if (system(command.c_str()) == 0)
 		return true;
 	
@@ -1499,19 +1539,11 @@ bool ApiSystem::downloadFile(const std::string url, const std::string fileName,
 	if (func != nullptr)
 		func("Downloading " + label);
 
-	HttpReq httpreq(url, fileName);
-	while (httpreq.status() == HttpReq::REQ_IN_PROGRESS)
+	return HttpDownload::download(url, fileName, [&](int64_t pos, int64_t total)
 	{
-		if (func != nullptr)
-			func(std::string("Downloading " + label + " >>> " + std::to_string(httpreq.getPercent()) + " %"));
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(20));
-	}
-
-	if (httpreq.status() != HttpReq::REQ_SUCCESS)
-		return false;
-
-	return true;
+		if (func != nullptr && total > 0)
+			func(std::string("Downloading " + label + " >>> " + std::to_string((int)(pos * 100LL / total)) + " %"));
+	});
 }
 
 void ApiSystem::setReadyFlag(bool ready)
@@ -1561,15 +1593,33 @@ int ApiSystem::formatDisk(const std::string disk, const std::string format, cons
 
 int ApiSystem::getPdfPageCount(const std::string& fileName)
 {
+	float pageHeight;
+	return getPdfInfo(fileName, pageHeight);
+}
+
+int ApiSystem::getPdfInfo(const std::string& fileName, float& pageHeight)
+{
+	int pages = 0;
+	pageHeight = 0;
+
 	auto lines = executeEnumerationScript("pdfinfo \"" + fileName + "\"");
 	for (auto line : lines)
 	{
 		auto splits = Utils::String::split(line, ':', true);
-		if (splits.size() == 2 && splits[0] == "Pages")
-			return atoi(Utils::String::trim(splits[1]).c_str());
+		if (splits.size() != 2)
+			continue;
+
+		if (splits[0] == "Pages")
+			pages = atoi(Utils::String::trim(splits[1]).c_str());
+		else if (splits[0] == "Page size") // "612 x 792 pts (letter)"
+		{
+			float width, height;
+			if (sscanf(Utils::String::trim(splits[1]).c_str(), "%f x %f", &width, &height) == 2 && height > 0)
+				pageHeight = height;
+		}
 	}
 
-	return 0;
+	return pages;
 }
 
 std::vector<std::string> ApiSystem::extractPdfImages(const std::string& fileName, int pageIndex, int pageCount, int quality)
@@ -1594,7 +1644,7 @@ std::vector<std::string> ApiSystem::extractPdfImages(const std::string& fileName
 			int pc = getPdfPageCount(fileName);
 			if (pc > 0)
 			{
-				Utils::ThreadPool pool(1);
+				Utils::ThreadPool pool(TaskScheduler::TEXTURE_IO);
 
 				for (int i = 0; i < pc; i += numberOfPagesToProcess)
 					pool.queueWorkItem([this, fileName, i, numberOfPagesToProcess] { extractPdfImages(fileName, i + 1, numberOfPagesToProcess); });
@@ -7,6 +7,7 @@
 #include "components/BusyComponent.h"
 #include "resources/TextureData.h"
 #include "components/IExternalActivity.h"
+#include "CommandCache.h"
 
 struct BiosFile 
 {
@@ -186,6 +187,9 @@ public:
 	virtual std::vector<std::string> getAvailableStorageDevices();
 	virtual std::vector<std::string> getSystemInformations();
 
+	// Runs the queries of the settings menus in the background, so their first opening doesn't wait for the scripts
+	void prefetchMenuQueries();
+
     bool generateSupportFile();
 
     std::string getCurrentStorage();
@@ -221,10 +225,12 @@ public:
 
 	virtual std::string getCRC32(const std::string fileName, bool fromZipContents = true);
 	virtual std::string getMD5(const std::string fileName, bool fromZipContents = true);
+	virtual bool getCRC32AndMD5(const std::string fileName, bool fromZipContents, std::string& crc32, std::string& md5); // Single read of the file ( or of the zip ), false when it needs a look into a 7z archive
 
 	virtual bool unzipFile(const std::string fileName, const std::string destFolder = "", const std::function<bool(const std::string)>& shouldExtract = nullptr);
 
 	virtual int getPdfPageCount(const std::string& fileName);
+	virtual int getPdfInfo(const std::string& fileName, float& pageHeight); // Page count, and height of the first page in points ( 0 when unknown )
 	virtual std::vector<std::string> extractPdfImages(const std::string& fileName, int pageIndex = -1, int pageCount = 1, int quality = 0);
 
 	virtual std::string getRunningArchitecture();
@@ -280,12 +286,18 @@ protected:
 	virtual bool executeScript(const std::string command);  
 	virtual std::pair<std::string, int> executeScript(const std::string command, const std::function<void(const std::string)>& func);
 	virtual std::vector<std::string> executeEnumerationScript(const std::string command);
+	// Through CommandCache : a stale result is returned while it's refreshed in the background
+	std::vector<std::string> executeCachedEnumerationScript(const std::string& command, CommandCache::Kind kind);
 	virtual bool downloadGitRepository(const std::string& url, const std::string& branch, const std::string& fileName, const std::string& label, const std::function<void(const std::string)>& func, int64_t defaultDownloadSize = 0);
 	virtual std::string getGitRepositoryDefaultBranch(const std::string& url);
 		
 	virtual std::string getUpdateUrl();
 	virtual std::string getThemesUrl();
 
+	// Uncached hashes, getCRC32 & getMD5 look into the HashCache first
+	std::string computeCRC32(const std::string& fileName, bool fromZipContents);
+	std::string computeMD5(const std::string& fileName, bool fromZipContents);
+
     static ApiSystem* instance;
 
     void launchExternalWindow_before(Window *window);
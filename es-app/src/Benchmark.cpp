@@ -0,0 +1,495 @@
+#include "Benchmark.h"
+
+#include "EmulationStation.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/MathExpr.h"
+#include "DirectoryManifest.h"
+#include "FileData.h"
+#include "FileSorts.h"
+#include "Gamelist.h"
+#include "GamelistCache.h"
+#include "GamelistJournal.h"
+#include "ImageIO.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include "ThemeData.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <pugixml/src/pugixml.hpp>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+#define BENCHMARK_SYSTEM		"benchmark"
+#define BENCHMARK_FOLDER_SIZE	500 // Games per sub folder
+
+template<typename F> static double timeMs(F func)
+{
+	auto start = std::chrono::steady_clock::now();
+	func();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static const char* sGenres[] = { "Action", "Platform", "Shoot'em up", "Fighting", "Puzzle", "Racing", "Sports", "RPG", "Adventure", "Strategy" };
+static const char* sCompanies[] = { "Capcom", "Konami", "Sega", "Nintendo", "Namco", "Taito", "SNK", "Irem", "Hudson", "Data East", "Atlus", "Treasure" };
+static const char* sRegions[] = { "eu", "us", "jp", "wor", "fr", "de" };
+static const char* sLanguages[] = { "en", "fr,en", "ja", "de,en,fr", "es", "en,it" };
+static const char* sPlayers[] = { "1", "1-2", "1-4", "2", "1-8" };
+
+#define PICK(array, index) array[(index) % (sizeof(array) / sizeof(array[0]))]
+
+std::string Benchmark::getFixturePath()
+{
+	return Paths::getUserEmulationStationPath() + "/benchmark";
+}
+
+// Empty rom files in sub folders, and a gamelist with varied metadata for all of them
+void Benchmark::createFixture(const std::string& romPath, int games)
+{
+	Utils::FileSystem::deleteDirectoryFiles(romPath, true);
+	Utils::FileSystem::createDirectory(romPath);
+
+	pugi::xml_document doc;
+	pugi::xml_node root = doc.append_child("gameList");
+
+	std::string folder;
+
+	for (int i = 0; i < games; i++)
+	{
+		if (i % BENCHMARK_FOLDER_SIZE == 0)
+		{
+			folder = "Folder " + std::to_string(i / BENCHMARK_FOLDER_SIZE + 1);
+			Utils::FileSystem::createDirectory(romPath + "/" + folder);
+		}
+
+		std::string name = std::string(PICK(sGenres, i / 7)) + " Game " + std::to_string(i + 1);
+		std::string fileName = name + " (" + Utils::String::toUpper(PICK(sRegions, i)) + ").zip";
+
+		Utils::FileSystem::writeAllText(romPath + "/" + folder + "/" + fileName, "");
+
+		pugi::xml_node game = root.append_child("game");
+		game.append_child("path").text().set(("./" + folder + "/" + fileName).c_str());
+		game.append_child("name").text().set(name.c_str());
+		game.append_child("desc").text().set(("Synthetic entry " + std::to_string(i + 1) + " : a " + PICK(sGenres, i / 7) + " game by " + PICK(sCompanies, i / 3) + ".").c_str());
+		game.append_child("rating").text().set(std::to_string((i % 11) / 10.0f).c_str());
+		game.append_child("releasedate").text().set((std::to_string(1980 + (i % 40)) + "0" + std::to_string(1 + i % 9) + "15T000000").c_str());
+		game.append_child("developer").text().set(PICK(sCompanies, i / 3));
+		game.append_child("publisher").text().set(PICK(sCompanies, i / 5 + 1));
+		game.append_child("genre").text().set(PICK(sGenres, i / 7));
+		game.append_child("players").text().set(PICK(sPlayers, i));
+		game.append_child("lang").text().set(PICK(sLanguages, i / 2));
+		game.append_child("region").text().set(PICK(sRegions, i));
+		game.append_child("family").text().set(("Family " + std::to_string(i % 300)).c_str());
+
+		if (i % 4 == 0)
+		{
+			game.append_child("playcount").text().set(std::to_string(i % 23).c_str());
+			game.append_child("lastplayed").text().set(("2024" + std::string(i % 2 ? "03" : "11") + "0" + std::to_string(1 + i % 9) + "T201500").c_str());
+		}
+
+		if (i % 13 == 0)
+			game.append_child("favorite").text().set("true");
+
+		if (i % 17 == 0)
+			game.append_child("kidgame").text().set("true");
+	}
+
+	doc.save_file(WINSTRINGW(romPath + "/gamelist.xml").c_str());
+}
+
+// A theme with the usual views, each with many elements & variables to resolve
+std::string Benchmark::createThemeFixture()
+{
+	std::string xml = "<theme><formatVersion>7</formatVersion><variables><mainColor>FFFFFF</mainColor><fontSize>0.035</fontSize></variables>";
+
+	for (auto view : { "system", "basic", "detailed", "grid" })
+	{
+		xml += "<view name=\"" + std::string(view) + "\">";
+
+		for (int i = 0; i < 60; i++)
+		{
+			std::string index = std::to_string(i);
+			xml += "<text name=\"text" + index + "\" extra=\"true\"><pos>0." + std::to_string(i % 10) + " 0.5</pos><size>0.2 0.05</size><color>${mainColor}</color><fontSize>${fontSize}</fontSize><text>Label " + index + "</text></text>";
+			xml += "<image name=\"image" + index + "\" extra=\"true\"><pos>0.5 0." + std::to_string(i % 10) + "</pos><maxSize>0.1 0.1</maxSize><path>./art/image" + index + ".png</path><color>${mainColor}</color></image>";
+		}
+
+		xml += "</view>";
+	}
+
+	xml += "</theme>";
+	return xml;
+}
+
+#define STRING_PASSES	10 // The string functions are too fast for a single pass over the names
+
+// Utils::String on the file names, as sorting, filtering & populateFolder use it
+void Benchmark::runStrings(int games, const std::vector<std::string>& names, std::vector<Result>& results)
+{
+	auto add = [&results, games](const std::string& name, double ms)
+	{
+		results.push_back({ name, games, ms });
+		std::cout << name << " (" << games << " games) : " << ms << " ms" << std::endl;
+	};
+
+	size_t sink = 0; // Keeps the results alive
+
+	add("string.toLower", timeMs([&] { for (int p = 0; p < STRING_PASSES; p++) for (auto& name : names) sink += Utils::String::toLower(name).size(); }));
+	add("string.toUpper", timeMs([&] { for (int p = 0; p < STRING_PASSES; p++) for (auto& name : names) sink += Utils::String::toUpper(name).size(); }));
+
+	add("string.toLowerInPlace", timeMs([&]
+	{
+		std::string text;
+		for (int p = 0; p < STRING_PASSES; p++)
+			for (auto& name : names)
+			{
+				text = name;
+				Utils::String::toLowerInPlace(text);
+				sink += text.size();
+			}
+	}));
+
+	add("string.toUpperInPlace", timeMs([&]
+	{
+		std::string text;
+		for (int p = 0; p < STRING_PASSES; p++)
+			for (auto& name : names)
+			{
+				text = name;
+				Utils::String::toUpperInPlace(text);
+				sink += text.size();
+			}
+	}));
+
+	// Accented names : the words with multibyte characters go through the unicode tables
+	std::vector<std::string> accented;
+	for (auto& name : names)
+		accented.push_back("Émile & Zoé " + name);
+
+	add("string.toLowerUtf8", timeMs([&] { for (int p = 0; p < STRING_PASSES; p++) for (auto& name : accented) sink += Utils::String::toLower(name).size(); }));
+	add("string.toUpperUtf8", timeMs([&] { for (int p = 0; p < STRING_PASSES; p++) for (auto& name : accented) sink += Utils::String::toUpper(name).size(); }));
+
+	add("string.replace", timeMs([&] { for (int p = 0; p < STRING_PASSES; p++) for (auto& name : names) sink += Utils::String::replace(name, " ", "_").size(); }));
+
+	add("string.replaceInPlace", timeMs([&]
+	{
+		std::string text;
+		for (int p = 0; p < STRING_PASSES; p++)
+			for (auto& name : names)
+			{
+				text = name;
+				Utils::String::replaceInPlace(text, " ", "_");
+				sink += text.size();
+			}
+	}));
+
+	add("string.split", timeMs([&] { for (int p = 0; p < STRING_PASSES; p++) for (auto& name : names) sink += Utils::String::split(name, ' ').size(); }));
+	add("string.splitAny", timeMs([&] { for (int p = 0; p < STRING_PASSES; p++) for (auto& name : names) sink += Utils::String::splitAny(name, " ()", true).size(); }));
+	add("string.startsWith", timeMs([&] { for (int p = 0; p < STRING_PASSES; p++) for (auto& name : names) sink += Utils::String::startsWith(name, "Action") ? 1 : 0; }));
+	add("string.endsWith", timeMs([&] { for (int p = 0; p < STRING_PASSES; p++) for (auto& name : names) sink += Utils::String::endsWith(name, ".zip") ? 1 : 0; }));
+	add("string.extractStrings", timeMs([&] { for (int p = 0; p < STRING_PASSES; p++) for (auto& name : names) sink += Utils::String::extractStrings(name, "(", ")").size(); }));
+
+	LOG(LogDebug) << "Benchmark : string checksum " << sink;
+}
+
+#define IMAGE_WIDTH		1920
+#define IMAGE_HEIGHT	1080
+#define IMAGE_PASSES	20
+
+// The pixel loops of ImageIO on a full HD picture. decodeBmp32 goes through FreeImage, then the BGRA to RGBA swizzle & the flip
+void Benchmark::runImageKernels(std::vector<Result>& results)
+{
+	auto add = [&results](const std::string& name, double ms)
+	{
+		results.push_back({ name, 0, ms });
+		std::cout << name << " (" << IMAGE_PASSES << " x " << IMAGE_WIDTH << "x" << IMAGE_HEIGHT << ") : " << ms << " ms" << std::endl;
+	};
+
+	size_t pixelsSize = IMAGE_WIDTH * IMAGE_HEIGHT * 4;
+
+	std::vector<unsigned char> pixels(pixelsSize);
+	for (size_t i = 0; i < pixelsSize; i++)
+		pixels[i] = (unsigned char)((i * 7) ^ (i >> 11));
+
+	// Uncompressed 32 bits bitmap : the decode is a copy, the kernels are most of the time
+	std::vector<unsigned char> bmp(54 + pixelsSize);
+
+	auto write32 = [&bmp](size_t offset, unsigned int value)
+	{
+		for (int i = 0; i < 4; i++)
+			bmp[offset + i] = (unsigned char)(value >> (i * 8));
+	};
+
+	bmp[0] = 'B';
+	bmp[1] = 'M';
+	write32(2, (unsigned int)bmp.size());
+	write32(10, 54);
+	write32(14, 40);
+	write32(18, IMAGE_WIDTH);
+	write32(22, IMAGE_HEIGHT);
+	write32(26, 1 | (32 << 16)); // Planes & bits per pixel
+	write32(34, (unsigned int)pixelsSize);
+	memcpy(bmp.data() + 54, pixels.data(), pixelsSize);
+
+	size_t sink = 0; // Keeps the results alive
+
+	add("image.flipPixelsVert", timeMs([&] { for (int p = 0; p < IMAGE_PASSES; p++) ImageIO::flipPixelsVert(pixels.data(), IMAGE_WIDTH, IMAGE_HEIGHT); }));
+
+	add("image.halveRGBA32", timeMs([&]
+	{
+		for (int p = 0; p < IMAGE_PASSES; p++)
+		{
+			size_t width, height;
+			PixelBuffer half = ImageIO::halveRGBA32(pixels.data(), IMAGE_WIDTH, IMAGE_HEIGHT, width, height);
+			sink += half != nullptr ? half[p % (width * height)] : 0;
+		}
+	}));
+
+	add("image.decodeBmp32", timeMs([&]
+	{
+		for (int p = 0; p < IMAGE_PASSES; p++)
+		{
+			size_t width, height;
+			PixelBuffer decoded = ImageIO::loadFromMemoryRGBA32(bmp.data(), bmp.size(), width, height);
+			sink += decoded != nullptr ? decoded[p] : 0;
+		}
+	}));
+
+	LOG(LogDebug) << "Benchmark : image checksum " << sink;
+}
+
+#define EXPRESSION_PASSES	200000
+
+// Theme-like conditions & bindings : parsed at each call, cached by text, and compiled once with their variables in slots
+void Benchmark::runExpressions(std::vector<Result>& results)
+{
+	auto add = [&results](const std::string& name, double ms)
+	{
+		results.push_back({ name, 0, ms });
+		std::cout << name << " (" << EXPRESSION_PASSES << " evaluations) : " << ms << " ms" << std::endl;
+	};
+
+	static const char* expressions[] =
+	{
+		"screenwidth >= 1280 && screenheight >= 720",
+		"(screenwidth / screenheight) * 100 > 160",
+		"lang == 'fr' || lang == 'en'",
+		"rating * 5 + 0.5",
+		"!(gamecount > 100) && (favorites > 0 || kidgame == 0)"
+	};
+
+	const int count = sizeof(expressions) / sizeof(expressions[0]);
+
+	Utils::MathExpr::ValueMap vars;
+	vars["screenwidth"] = 1920.0f;
+	vars["screenheight"] = 1080.0f;
+	vars["lang"] = std::string("fr");
+	vars["rating"] = 0.7f;
+	vars["gamecount"] = 250.0f;
+	vars["favorites"] = 12.0f;
+	vars["kidgame"] = 0.0f;
+
+	float sink = 0; // Keeps the results alive
+
+	add("mathExpr.evalParsed", timeMs([&]
+	{
+		for (int p = 0; p < EXPRESSION_PASSES; p++)
+		{
+			Utils::MathExpr evaluator; // No program cache : tokenized at each call, as before compiled programs
+			sink += evaluator.eval(expressions[p % count], &vars).toNumber();
+		}
+	}));
+
+	Utils::MathExpr evaluator;
+
+	add("mathExpr.evalCached", timeMs([&] { for (int p = 0; p < EXPRESSION_PASSES; p++) sink += evaluator.eval(expressions[p % count], &vars).toNumber(); }));
+
+	std::vector<Utils::MathExpr::Program> programs;
+	std::vector<std::vector<Utils::MathExpr::Value>> slots;
+
+	for (int i = 0; i < count; i++)
+	{
+		programs.push_back(evaluator.compile(expressions[i]));
+
+		std::vector<Utils::MathExpr::Value> values;
+		for (auto& name : programs.back().variables)
+			values.push_back(vars[name]);
+
+		slots.push_back(values);
+	}
+
+	add("mathExpr.evalProgram", timeMs([&] { for (int p = 0; p < EXPRESSION_PASSES; p++) sink += evaluator.eval(programs[p % count], slots[p % count]).toNumber(); }));
+
+	LOG(LogDebug) << "Benchmark : expression checksum " << sink;
+}
+
+void Benchmark::runSize(int games, std::vector<Result>& results)
+{
+	std::string romPath = getFixturePath() + "/" + std::to_string(games);
+
+	auto add = [&results, games](const std::string& name, double ms)
+	{
+		results.push_back({ name, games, ms });
+		std::cout << name << " (" << games << " games) : " << ms << " ms" << std::endl;
+	};
+
+	add("fixture", timeMs([&] { createFixture(romPath, games); }));
+
+	SystemMetadata md;
+	md.name = BENCHMARK_SYSTEM;
+	md.fullName = "Benchmark";
+	md.themeFolder = BENCHMARK_SYSTEM;
+	md.releaseYear = 0;
+
+	auto createEnvData = [&romPath]()
+	{
+		SystemEnvironmentData* envData = new SystemEnvironmentData();
+		envData->mStartPath = romPath;
+		envData->mSearchExtensions.insert(".zip");
+		envData->mPlatformIds.push_back(PlatformIds::PLATFORM_UNKNOWN);
+		return envData;
+	};
+
+	bool ignoreGamelist = Settings::IgnoreGamelist();
+	bool parseGamelistOnly = Settings::ParseGamelistOnly();
+
+	SystemData* system = nullptr;
+	auto load = [&] { system = new SystemData(md, createEnvData(), nullptr, false, false, false); };
+
+	// The next load is cold : no directory manifest nor gamelist cache
+	auto invalidate = [&]
+	{
+		DirectoryManifest::invalidate(system);
+		GamelistCache::invalidate(system);
+		GamelistJournal::clear(system);
+	};
+
+	Settings::setIgnoreGamelist(true);
+	Settings::setParseGamelistOnly(false);
+
+	add("populateFolder", timeMs(load));
+	invalidate();
+	delete system;
+
+	Settings::setIgnoreGamelist(false);
+	Settings::setParseGamelistOnly(true);
+
+	add("parseGamelist", timeMs(load));
+	invalidate();
+	delete system;
+
+	Settings::setParseGamelistOnly(false);
+
+	add("loadSystem", timeMs(load));
+	add("deleteSystem", timeMs([&] { delete system; }));
+
+	// Warm : manifest & gamelist cache written by the previous load
+	add("loadSystemCached", timeMs(load));
+
+	add("filterIndexRebuild", timeMs([&] { system->deleteIndex(); system->getIndex(true); }));
+
+	std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME);
+
+	for (auto& sort : FileSorts::getSortTypes())
+	{
+		std::vector<FileData*> sorted = files;
+		add("sort." + Utils::String::replace(Utils::String::toLower(sort.description), " ", ""), timeMs([&] { FileSorts::sortFiles(sorted, sort); }));
+	}
+
+	// Every game changed
+	for (auto file : files)
+		file->setMetadata(MetaDataId::PlayCount, std::to_string(atoi(file->getMetadata(MetaDataId::PlayCount).c_str()) + 1));
+
+	add("updateGamelist", timeMs([&] { updateGamelist(system); }));
+
+	std::vector<std::string> names;
+	for (auto file : files)
+		names.push_back(file->getLeafName());
+
+	runStrings(games, names, results);
+
+	// One image size per game, written to the image cache then taken out
+	std::vector<std::string> images;
+	for (auto& name : names)
+		images.push_back(romPath + "/images/" + name + ".png");
+
+	add("imageCacheUpdate", timeMs([&] { for (int i = 0; i < (int)images.size(); i++) ImageIO::updateImageCache(images[i], 1000 + i, 640, 480); }));
+	add("imageCacheSave", timeMs([&] { ImageIO::saveImageCache(); }));
+	add("imageCacheLoad", timeMs([&] { ImageIO::loadImageCache(); }));
+
+	for (auto& image : images)
+		ImageIO::removeImageCache(image);
+
+	ImageIO::saveImageCache();
+
+	invalidate();
+	delete system;
+
+	Settings::setIgnoreGamelist(ignoreGamelist);
+	Settings::setParseGamelistOnly(parseGamelistOnly);
+
+	Utils::FileSystem::deleteDirectoryFiles(romPath, true);
+}
+
+void Benchmark::writeResults(const std::string& outputPath, const std::vector<Result>& results)
+{
+	std::ofstream stream(WINSTRINGW(outputPath), std::ios::out | std::ios::binary);
+	if (!stream.is_open())
+	{
+		LOG(LogError) << "Benchmark : unable to write " << outputPath;
+		return;
+	}
+
+	stream << "{\"version\":\"" << PROGRAM_VERSION_STRING << "\",\"results\":[\n";
+
+	bool first = true;
+	for (auto& result : results)
+	{
+		stream << (first ? "" : ",\n") << "{\"name\":\"" << result.name << "\",\"games\":" << result.games << ",\"ms\":" << result.ms << "}";
+		first = false;
+	}
+
+	stream << "\n]}\n";
+	stream.close();
+
+	LOG(LogInfo) << "Benchmark : results written to " << outputPath;
+}
+
+int Benchmark::run(const std::string& sizes, const std::string& outputPath)
+{
+	std::vector<Result> results;
+
+	Utils::FileSystem::createDirectory(getFixturePath());
+
+	// Not tied to the catalog size
+	std::map<std::string, std::string> sysDataMap;
+	std::string themeXml = createThemeFixture();
+
+	double themeMs = timeMs([&]
+	{
+		ThemeData theme;
+		theme.loadFile(BENCHMARK_SYSTEM, sysDataMap, themeXml, false);
+	});
+
+	results.push_back({ "themeLoadFile", 0, themeMs });
+	std::cout << "themeLoadFile : " << themeMs << " ms" << std::endl;
+
+	runImageKernels(results);
+	runExpressions(results);
+
+	for (auto& size : Utils::String::split(sizes, ',', true))
+	{
+		int games = atoi(size.c_str());
+		if (games > 0)
+			runSize(games, results);
+	}
+
+	Utils::FileSystem::deleteDirectoryFiles(getFixturePath(), true);
+
+	writeResults(outputPath.empty() ? Paths::getUserEmulationStationPath() + "/es_benchmark.json" : outputPath, results);
+	return 0;
+}
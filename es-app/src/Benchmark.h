@@ -0,0 +1,36 @@
+#pragma once
+#ifndef ES_APP_BENCHMARK_H
+#define ES_APP_BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+// Headless timings of the catalog operations on synthetic rom folders & gamelists, written as JSON to compare the releases.
+// Run with --benchmark [sizes] [output] : sizes are game counts separated by commas ( default 1000,10000,50000 ), the output defaults to es_benchmark.json in the user folder.
+// The fixtures are generated in the user folder ( not /tmp, which the image cache skips ) and removed afterwards
+class Benchmark
+{
+public:
+	static int run(const std::string& sizes, const std::string& outputPath);
+
+private:
+	struct Result
+	{
+		std::string name;
+		int games;
+		double ms;
+	};
+
+	static void runSize(int games, std::vector<Result>& results);
+	static void runStrings(int games, const std::vector<std::string>& names, std::vector<Result>& results);
+	static void runImageKernels(std::vector<Result>& results);
+	static void runExpressions(std::vector<Result>& results);
+
+	static std::string getFixturePath();
+	static void createFixture(const std::string& romPath, int games);
+	static std::string createThemeFixture();
+
+	static void writeResults(const std::string& outputPath, const std::vector<Result>& results);
+};
+
+#endif // ES_APP_BENCHMARK_H
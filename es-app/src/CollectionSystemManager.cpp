@@ -379,17 +379,24 @@ void CollectionSystemManager::updateSystemsList()
 	// remove all Collection Systems
 	removeCollectionsFromDisplayedSystems();
 
+	// The games by file name are only needed to populate the custom collections, don't build "All games" for nothing
+	bool customToPopulate = false;
+	for (auto& data : mCustomCollectionSystemsData)
+		if (data.second.isEnabled && !data.second.isPopulated)
+			customToPopulate = true;
+
 	std::unordered_map<std::string, FileData*> map;
-	getAllGamesCollection()->getRootFolder()->createChildrenByFilenameMap(map);
+	if (customToPopulate)
+		getAllGamesCollection()->getRootFolder()->createChildrenByFilenameMap(map);
 
 	// add custom enabled ones
-	addEnabledCollectionsToDisplayedSystems(&mCustomCollectionSystemsData, &map);
+	addEnabledCollectionsToDisplayedSystems(&mCustomCollectionSystemsData, customToPopulate ? &map : nullptr);
 
 	if (!sortMode.empty() && !sortByManufacturer && !sortByHardware && !sortByReleaseDate && !sortBySubgroup)
 		std::sort(SystemData::sSystemVector.begin(), SystemData::sSystemVector.end(), systemByAlphaSort);
 
 	// add auto enabled ones
-	addEnabledCollectionsToDisplayedSystems(&mAutoCollectionSystemsData, &map);
+	addEnabledCollectionsToDisplayedSystems(&mAutoCollectionSystemsData, nullptr);
 
 	// Add custom collections bundle to the system list, if there are items
 	if (mCustomCollectionsBundle->getRootFolder()->getChildren().size() > 0)
@@ -429,25 +436,22 @@ void CollectionSystemManager::refreshCollectionSystems(FileData* file)
 	if (!file->getSystem()->isGameSystem() || file->getType() != GAME)
 		return;
 
-	std::map<std::string, CollectionSystemData> allCollections;
-	allCollections.insert(mAutoCollectionSystemsData.cbegin(), mAutoCollectionSystemsData.cend());
-	allCollections.insert(mCustomCollectionSystemsData.cbegin(), mCustomCollectionSystemsData.cend());
+	for (auto& sysData : mAutoCollectionSystemsData)
+		updateCollectionSystem(file, sysData.second);
 
-	for (auto sysDataIt = allCollections.cbegin(); sysDataIt != allCollections.cend(); sysDataIt++)
-		updateCollectionSystem(file, sysDataIt->second);
+	for (auto& sysData : mCustomCollectionSystemsData)
+		updateCollectionSystem(file, sysData.second);
 }
 
-void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionSystemData sysData)
+void CollectionSystemManager::updateCollectionSystem(FileData* file, const CollectionSystemData& sysData)
 {
 	if (!sysData.isPopulated)
 		return;
 
-	// collection files use the full path as key, to avoid clashes
-	std::string key = file->getFullPath();
-
 	SystemData* curSys = sysData.system;
-	FileData* collectionEntry = curSys->getRootFolder()->FindByPath(key);
 	FolderData* rootFolder = curSys->getRootFolder();
+	FileData* collectionEntry = CollectionFileData::findEntry(file, rootFolder);
+	FileData* sortedEntry = collectionEntry;
 
 	std::string name = curSys->getName();
 
@@ -456,8 +460,8 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 		// remove from index, so we can re-index metadata after refreshing
 		curSys->removeFromIndex(collectionEntry);
 
-		// found and we are removing
-		if (name == "favorites" && !file->getFavorite())
+		// found and we are removing. Dynamic collections follow their rules
+		if ((name == "favorites" && !file->getFavorite()) || (sysData.filteredIndex != nullptr && !sysData.filteredIndex->match(file)))
 		{
 			// need to check if still marked as favorite, if not remove
 			auto view = ViewController::get()->getGameListView(curSys, false);
@@ -480,12 +484,15 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 	{
 		// we didn't find it here - we need to check if we should add it
 		if (name == "recent" && file->getMetadata(MetaDataId::PlayCount) > "0" && includeFileInAutoCollections(file) ||
-			name == "favorites" && file->getFavorite())
+			name == "favorites" && file->getFavorite() ||
+			sysData.filteredIndex != nullptr && isDynamicCollectionCandidate(file) && sysData.filteredIndex->match(file))
 		{
-			CollectionFileData* newGame = new CollectionFileData(file, curSys);
+			CollectionFileData* newGame = new (curSys) CollectionFileData(file, curSys);
 			rootFolder->addChild(newGame);
 			curSys->addToIndex(newGame);
 			ViewController::get()->onFileChanged(file, FILE_METADATA_CHANGED);
+
+			sortedEntry = newGame;
 		}
 	}
 
@@ -493,7 +500,7 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 
 	if (name == "recent")
 	{
-		sortLastPlayed(curSys);
+		sortLastPlayed(curSys, sortedEntry);
 		trimCollectionCount(rootFolder, LAST_PLAYED_MAX);
 		ViewController::get()->onFileChanged(rootFolder, FILE_METADATA_CHANGED);
 	}
@@ -501,7 +508,20 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 		ViewController::get()->onFileChanged(rootFolder, FILE_SORTED);
 }
 
-void CollectionSystemManager::sortLastPlayed(SystemData* system)
+// Games a dynamic collection can take : the ones of "All games", out of the hidden systems
+bool CollectionSystemManager::isDynamicCollectionCandidate(FileData* file)
+{
+	if (!Settings::HiddenSystemsShowGames())
+	{
+		auto hiddenSystems = Utils::String::split(Settings::getInstance()->getString("HiddenSystems"), ';');
+		if (std::find(hiddenSystems.cbegin(), hiddenSystems.cend(), file->getSystemName()) != hiddenSystems.cend())
+			return false;
+	}
+
+	return CollectionFileData::findEntry(file, getAllGamesCollection()->getRootFolder()) != nullptr;
+}
+
+void CollectionSystemManager::sortLastPlayed(SystemData* system, FileData* changed)
 {
 	if (system->getName() != "recent")
 		return;
@@ -512,7 +532,23 @@ void CollectionSystemManager::sortLastPlayed(SystemData* system)
 	const FileSorts::SortType& sort = FileSorts::getSortTypes().at(system->getSortId());
 
 	std::vector<FileData*>& childs = (std::vector<FileData*>&) rootFolder->getChildren();
-	std::sort(childs.begin(), childs.end(), sort.comparisonFunction);
+
+	// After a launch, the other entries are still sorted : only move the changed one
+	auto changedIt = std::find(childs.begin(), childs.end(), changed);
+	if (changedIt != childs.end())
+	{
+		childs.erase(changedIt);
+
+		auto compf = sort.comparisonFunction;
+		auto pos = sort.ascending ?
+			std::upper_bound(childs.begin(), childs.end(), changed, [compf](FileData* a, FileData* b) { return compf(a, b); }) :
+			std::upper_bound(childs.begin(), childs.end(), changed, [compf](FileData* a, FileData* b) { return compf(b, a); });
+
+		childs.insert(pos, changed);
+		return;
+	}
+
+	FileSorts::sortFiles(childs, sort);
 	if (!sort.ascending)
 		std::reverse(childs.begin(), childs.end());
 }
@@ -536,34 +572,93 @@ void CollectionSystemManager::trimCollectionCount(FolderData* rootFolder, int li
 // deletes all collection files from collection systems related to the source file
 void CollectionSystemManager::deleteCollectionFiles(FileData* file)
 {
-	// collection files use the full path as key, to avoid clashes
-	std::string key = file->getFullPath();
-
 	// find games in collection systems
-	std::map<std::string, CollectionSystemData> allCollections;
-	allCollections.insert(mAutoCollectionSystemsData.cbegin(), mAutoCollectionSystemsData.cend());
-	allCollections.insert(mCustomCollectionSystemsData.cbegin(), mCustomCollectionSystemsData.cend());
+	for (auto collections : { &mAutoCollectionSystemsData, &mCustomCollectionSystemsData })
+	{
+		for (auto& sysData : *collections)
+		{
+			if (!sysData.second.isPopulated)
+				continue;
 
-	for (auto sysDataIt = allCollections.begin(); sysDataIt != allCollections.end(); sysDataIt++)
+			FileData* collectionEntry = CollectionFileData::findEntry(file, sysData.second.system->getRootFolder());
+			if (collectionEntry == nullptr)
+				continue;
+
+			sysData.second.needsSave = true;
+
+			SystemData* systemViewToUpdate = getSystemToView(sysData.second.system);
+			if (systemViewToUpdate == nullptr)
+				continue;
+
+			auto view = ViewController::get()->getGameListView(systemViewToUpdate, false);
+			if (view != nullptr)
+				view.get()->remove(collectionEntry);
+			else
+				delete collectionEntry;
+		}
+	}
+}
+
+// adds new source files ( RomFolderWatcher ) to the populated automatic & dynamic collections they belong to
+void CollectionSystemManager::addCollectionFiles(const std::vector<FileData*>& files)
+{
+	std::vector<SystemData*> sources = getAutoCollectionSources();
+	std::set<SystemData*> changed;
+
+	for (auto file : files)
 	{
-		if (!sysDataIt->second.isPopulated)
+		SystemData* system = file->getSystem();
+		if (file->getType() != GAME || std::find(sources.cbegin(), sources.cend(), system) == sources.cend() || !includeFileInAutoCollections(file))
 			continue;
 
-		FileData* collectionEntry = (sysDataIt->second.system)->getRootFolder()->FindByPath(key);
-		if (collectionEntry == nullptr)
+		std::string extlow = Utils::String::toLower(Utils::FileSystem::getExtension(file->getFileName()));
+		auto hiddenExts = Utils::String::split(Settings::getInstance()->getString(system->getName() + ".HiddenExt"), ';');
+		if (std::find_if(hiddenExts.cbegin(), hiddenExts.cend(), [extlow](const std::string& ext) { return "." + Utils::String::toLower(ext) == extlow; }) != hiddenExts.cend())
 			continue;
-		
-		sysDataIt->second.needsSave = true;
 
-		SystemData* systemViewToUpdate = getSystemToView(sysDataIt->second.system);
-		if (systemViewToUpdate == nullptr)
-			continue;
+		bool isArcade = system->hasPlatformId(PlatformIds::ARCADE);
 
-		auto view = ViewController::get()->getGameListView(systemViewToUpdate, false);
-		if (view != nullptr)
-			view.get()->remove(collectionEntry);		
-		else
-			delete collectionEntry;		
+		for (auto& sysData : mAutoCollectionSystemsData)
+		{
+			if (!sysData.second.isPopulated || CollectionFileData::findEntry(file, sysData.second.system->getRootFolder()) != nullptr)
+				continue;
+
+			if (!isAutoCollectionGame(sysData.second.decl, file, isArcade))
+				continue;
+
+			CollectionFileData* newGame = new (sysData.second.system) CollectionFileData(file, sysData.second.system);
+			sysData.second.system->getRootFolder()->addChild(newGame);
+			sysData.second.system->addToIndex(newGame);
+			changed.insert(sysData.second.system);
+		}
+
+		// Dynamic collections take the games of "All games" : it's been updated above
+		for (auto& sysData : mCustomCollectionSystemsData)
+		{
+			if (!sysData.second.isPopulated || sysData.second.filteredIndex == nullptr || !isDynamicCollectionCandidate(file))
+				continue;
+
+			if (sysData.second.filteredIndex->isSystemSelected(file->getSystemName()))
+				sysData.second.filteredIndex->addToIndex(file);
+
+			if (!sysData.second.filteredIndex->match(file) || CollectionFileData::findEntry(file, sysData.second.system->getRootFolder()) != nullptr)
+				continue;
+
+			CollectionFileData* newGame = new (sysData.second.system) CollectionFileData(file, sysData.second.system);
+			sysData.second.system->getRootFolder()->addChild(newGame);
+			sysData.second.system->addToIndex(newGame);
+			changed.insert(sysData.second.system);
+		}
+	}
+
+	for (auto sys : changed)
+	{
+		updateCollectionFolderMetadata(sys);
+		sys->updateDisplayedGameCount();
+
+		SystemData* systemViewToUpdate = getSystemToView(sys);
+		if (systemViewToUpdate != nullptr)
+			ViewController::get()->onFileChanged(systemViewToUpdate->getRootFolder(), FILE_ADDED);
 	}
 }
 
@@ -670,10 +765,7 @@ bool CollectionSystemManager::inInCustomCollection(FileData* file, const std::st
 	if (!data->second.isPopulated)
 		populateCustomCollection(&data->second);
 	
-	std::string key = file->getFullPath();
-	FolderData* rootFolder = data->second.system->getRootFolder();
-	FileData* collectionEntry = rootFolder->FindByPath(key);
-	return collectionEntry != nullptr;
+	return CollectionFileData::findEntry(file, data->second.system->getRootFolder()) != nullptr;
 }
 
 // Adds or removes a game from a specific collection
@@ -718,10 +810,9 @@ bool CollectionSystemManager::toggleGameInCollection(FileData* file, const std::
 		if (!collectionSystemData->isPopulated)
 			populateCustomCollection(collectionSystemData);
 	
-		std::string key = file->getFullPath();
 		SystemData* sysData = collectionSystemData->system;
 		FolderData* rootFolder = sysData->getRootFolder();
-		FileData* collectionEntry = rootFolder->FindByPath(key);
+		FileData* collectionEntry = CollectionFileData::findEntry(file, rootFolder);
 
 		SystemData* systemViewToUpdate = getSystemToView(sysData);
 		if (collectionEntry != nullptr)
@@ -742,7 +833,7 @@ bool CollectionSystemManager::toggleGameInCollection(FileData* file, const std::
 		else
 		{
 			// we didn't find it here, we should add it
-			CollectionFileData* newGame = new CollectionFileData(file->getSourceFileData(), sysData);
+			CollectionFileData* newGame = new (sysData) CollectionFileData(file->getSourceFileData(), sysData);
 			rootFolder->addChild(newGame);
 			sysData->addToIndex(newGame);
 
@@ -898,8 +989,10 @@ void CollectionSystemManager::initCustomCollectionSystems()
 SystemData* CollectionSystemManager::getArcadeCollection()
 {
 	CollectionSystemData* allSysData = &mAutoCollectionSystemsData["arcade"];
-	if (!allSysData->isPopulated)
-		populateAutoCollection(allSysData);
+	if (allSysData->system->isPopulationPending())
+		allSysData->system->getRootFolder();
+	else if (!allSysData->isPopulated)
+		populateAutoCollection(allSysData, true);
 
 	return allSysData->system;
 }
@@ -907,8 +1000,10 @@ SystemData* CollectionSystemManager::getArcadeCollection()
 SystemData* CollectionSystemManager::getAllGamesCollection()
 {
 	CollectionSystemData* allSysData = &mAutoCollectionSystemsData["all"];
-	if (!allSysData->isPopulated)
-		populateAutoCollection(allSysData);
+	if (allSysData->system->isPopulationPending())
+		allSysData->system->getRootFolder();
+	else if (!allSysData->isPopulated)
+		populateAutoCollection(allSysData, true);
 
 	return allSysData->system;
 }
@@ -968,16 +1063,14 @@ SystemData* CollectionSystemManager::createNewCollectionEntry(std::string name,
 	return newSys;
 }
 
-// populates an Automatic Collection System
-void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysData)
+// systems whose games are candidates for the auto collections
+std::vector<SystemData*> CollectionSystemManager::getAutoCollectionSources()
 {
-	SystemData* newSys = sysData->system;
-	CollectionSystemDecl sysDecl = sysData->decl;
-	FolderData* rootFolder = newSys->getRootFolder();
-
 	bool hiddenSystemsShowGames = Settings::HiddenSystemsShowGames();
 	auto hiddenSystems = Utils::String::split(Settings::getInstance()->getString("HiddenSystems"), ';');
 
+	std::vector<SystemData*> systems;
+
 	for (auto& system : SystemData::sSystemVector)
 	{
 		// we won't iterate all collections
@@ -987,93 +1080,162 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 		if (!hiddenSystemsShowGames && std::find(hiddenSystems.cbegin(), hiddenSystems.cend(), system->getName()) != hiddenSystems.cend())
 			continue;
 
-		std::vector<PlatformIds::PlatformId> platforms = system->getPlatformIds();
-		bool isArcade = std::find(platforms.begin(), platforms.end(), PlatformIds::ARCADE) != platforms.end();
+		systems.push_back(system);
+	}
+
+	return systems;
+}
 
-		std::vector<std::string> hiddenExts;
-		for (auto ext : Utils::String::split(Settings::getInstance()->getString(system->getName() + ".HiddenExt"), ';'))
-			hiddenExts.push_back("." + Utils::String::toLower(ext));
+// Games of a system that belong to the collection, read-only on the tree & the metadata. Without games, stops at the first one
+bool CollectionSystemManager::collectAutoCollectionGames(const CollectionSystemDecl& decl, SystemData* system, std::vector<FileData*>* games)
+{
+	std::vector<PlatformIds::PlatformId> platforms = system->getPlatformIds();
+	bool isArcade = std::find(platforms.begin(), platforms.end(), PlatformIds::ARCADE) != platforms.end();
 
-		std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME);
-		for (auto& game : files)
+	std::vector<std::string> hiddenExts;
+	for (auto ext : Utils::String::split(Settings::getInstance()->getString(system->getName() + ".HiddenExt"), ';'))
+		hiddenExts.push_back("." + Utils::String::toLower(ext));
+
+	std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME);
+	for (auto& game : files)
+	{
+		if (system->isGroupSystem() && game->getSystem() != system)
+			continue;
+
+		if (!includeFileInAutoCollections(game))
+			continue;
+
+		if (hiddenExts.size() > 0 && game->getType() == GAME)
 		{
-			if (system->isGroupSystem() && game->getSystem() != system)
+			std::string extlow = Utils::String::toLower(Utils::FileSystem::getExtension(game->getFileName()));
+			if (std::find(hiddenExts.cbegin(), hiddenExts.cend(), extlow) != hiddenExts.cend())
 				continue;
+		}
 
-			bool include = includeFileInAutoCollections(game);
-			if (!include)
-				continue;
+		if (!isAutoCollectionGame(decl, game, isArcade))
+			continue;
 
-			if (hiddenExts.size() > 0 && game->getType() == GAME)
-			{
-				std::string extlow = Utils::String::toLower(Utils::FileSystem::getExtension(game->getFileName()));
-				if (std::find(hiddenExts.cbegin(), hiddenExts.cend(), extlow) != hiddenExts.cend())
-					continue;
-			}
+		if (games == nullptr)
+			return true;
 
-			switch (sysDecl.type)
-			{
-			case AUTO_ALL_GAMES:
-				break;
-			case AUTO_VERTICALARCADE:
-				include = game->isVerticalArcadeGame();
-				break;
-			case AUTO_LIGHTGUN:
-				include = game->isLightGunGame();
-				break;
-			case AUTO_WHEEL:
-				include = game->isWheelGame();
-				break;
-			case AUTO_RETROACHIEVEMENTS:
-				include = game->hasCheevos();
-				break;
-			case AUTO_LAST_PLAYED:
-				include = game->getMetadata(MetaDataId::PlayCount) > "0";
-				break;
-			case AUTO_NEVER_PLAYED:
-				include = !(game->getMetadata(MetaDataId::PlayCount) > "0");
-				break;
-			case AUTO_FAVORITES:
-				// we may still want to add files we don't want in auto collections in "favorites"
-				include = game->getFavorite();
-				break;
-			case AUTO_ARCADE:
-				include = isArcade;
-				break;
-			case AUTO_AT2PLAYERS: 
-			case AUTO_AT4PLAYERS:
-			{
-				std::string players = game->getMetadata(MetaDataId::Players);
-				if (players.empty())
-					include = false;
-				else
-				{
-					auto range = game->parsePlayersRange();
+		games->push_back(game);
+	}
 
-					int val = (sysDecl.type == AUTO_AT2PLAYERS ? 2 : 4);
-					include = range.first <= 0 ? (val == range.second) : (range.first <= val && val <= range.second);
-				}
-			}
-			break;
+	return games != nullptr && !games->empty();
+}
 
-			default:
-				if (!sysDecl.isCustom && !sysDecl.displayIfEmpty)
-				{
-					if (sysDecl.isGenreCollection())
-						include = Genres::genreExists(&game->getMetadata(), ((int)sysDecl.type) - 10000);
-					else if (sysDecl.isArcadeSubSystem())
-						include = isArcade && game->getMetadata(MetaDataId::ArcadeSystemName) == sysDecl.themeFolder;
-				}
+// Whether a game of the auto collection sources belongs to the automatic collection, hidden extensions aside
+bool CollectionSystemManager::isAutoCollectionGame(const CollectionSystemDecl& decl, FileData* file, bool isArcade)
+{
+	bool include = true;
 
-				break;
-			}
+	switch (decl.type)
+	{
+	case AUTO_ALL_GAMES:
+		break;
+	case AUTO_VERTICALARCADE:
+		include = file->isVerticalArcadeGame();
+		break;
+	case AUTO_LIGHTGUN:
+		include = file->isLightGunGame();
+		break;
+	case AUTO_WHEEL:
+		include = file->isWheelGame();
+		break;
+	case AUTO_RETROACHIEVEMENTS:
+		include = file->hasCheevos();
+		break;
+	case AUTO_LAST_PLAYED:
+		include = file->getMetadata(MetaDataId::PlayCount) > "0";
+		break;
+	case AUTO_NEVER_PLAYED:
+		include = !(file->getMetadata(MetaDataId::PlayCount) > "0");
+		break;
+	case AUTO_FAVORITES:
+		// we may still want to add files we don't want in auto collections in "favorites"
+		include = file->getFavorite();
+		break;
+	case AUTO_ARCADE:
+		include = isArcade;
+		break;
+	case AUTO_AT2PLAYERS: 
+	case AUTO_AT4PLAYERS:
+	{
+		std::string players = file->getMetadata(MetaDataId::Players);
+		if (players.empty())
+			include = false;
+		else
+		{
+			auto range = file->parsePlayersRange();
 
-			if (include)
-			{
-				CollectionFileData* newGame = new CollectionFileData(game, newSys);
-				rootFolder->addChild(newGame);
-				newSys->addToIndex(newGame);
-			}
+			int val = (decl.type == AUTO_AT2PLAYERS ? 2 : 4);
+			include = range.first <= 0 ? (val == range.second) : (range.first <= val && val <= range.second);
+		}
+	}
+	break;
+
+	default:
+		if (!decl.isCustom && !decl.displayIfEmpty)
+		{
+			if (decl.isGenreCollection())
+				include = Genres::genreExists(&file->getMetadata(), ((int)decl.type) - 10000);
+			else if (decl.isArcadeSubSystem())
+				include = isArcade && file->getMetadata(MetaDataId::ArcadeSystemName) == decl.themeFolder;
+		}
+
+		break;
+	}
+
+	return include;
+}
+
+bool CollectionSystemManager::hasAutoCollectionGames(const CollectionSystemDecl& decl)
+{
+	for (auto system : getAutoCollectionSources())
+		if (collectAutoCollectionGames(decl, system, nullptr))
+			return true;
+
+	return false;
+}
+
+// populates an Automatic Collection System
+void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysData, bool splitBySystem)
+{
+	SystemData* newSys = sysData->system;
+	CollectionSystemDecl sysDecl = sysData->decl;
+	FolderData* rootFolder = newSys->getRootFolder();
+
+	std::vector<SystemData*> systems = getAutoCollectionSources();
+
+	std::vector<std::vector<FileData*>> gamesBySystem(systems.size());
+
+	// Opening "All games" or "Arcade" traverses every system : split them on a pool. The games are added in the systems order afterwards
+	if (splitBySystem && systems.size() > 1 && Settings::getInstance()->getBool("ThreadedLoading"))
+	{
+		Utils::ThreadPool pool;
+
+		for (size_t i = 0; i < systems.size(); i++)
+		{
+			SystemData* system = systems[i];
+			std::vector<FileData*>* games = &gamesBySystem[i];
+			pool.queueWorkItem([this, &sysDecl, system, games] { collectAutoCollectionGames(sysDecl, system, games); });
+		}
+
+		pool.wait();
+	}
+	else
+	{
+		for (size_t i = 0; i < systems.size(); i++)
+			collectAutoCollectionGames(sysDecl, systems[i], &gamesBySystem[i]);
+	}
+
+	for (auto& games : gamesBySystem)
+	{
+		for (auto game : games)
+		{
+			CollectionFileData* newGame = new (newSys) CollectionFileData(game, newSys);
+			rootFolder->addChild(newGame);
+			newSys->addToIndex(newGame);
 		}
 	}
 
@@ -1084,6 +1246,7 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 	}
 
 	sysData->isPopulated = true;
+	newSys->setPendingPopulation(nullptr);
 	updateCollectionFolderMetadata(newSys);
 }
 
@@ -1111,18 +1274,19 @@ void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sys
 
 			std::vector<FileData*> games = folder->getFilesRecursive(GAME);
 			for (auto game : games)
-			{
 				if (sysData->filteredIndex->isSystemSelected(game->getSystemName()))
 					sysData->filteredIndex->addToIndex(game);
 
-				if (sysData->filteredIndex->showFile(game))
-				{
-					if (!hiddenSystemsShowGames && std::find(hiddenSystems.cbegin(), hiddenSystems.cend(), game->getSystemName()) != hiddenSystems.cend())
-						continue;
+			std::vector<FileData*> matches;
+			sysData->filteredIndex->query(games, matches);
 
-					CollectionFileData* newGame = new CollectionFileData(game, newSys);
-					rootFolder->addChild(newGame);
-				}
+			for (auto game : matches)
+			{
+				if (!hiddenSystemsShowGames && std::find(hiddenSystems.cbegin(), hiddenSystems.cend(), game->getSystemName()) != hiddenSystems.cend())
+					continue;
+
+				CollectionFileData* newGame = new (newSys) CollectionFileData(game, newSys);
+				rootFolder->addChild(newGame);
 			}
 		}
 
@@ -1171,7 +1335,7 @@ void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sys
 			if (std::find(hiddenSystems.cbegin(), hiddenSystems.cend(), it->second->getName()) != hiddenSystems.cend())
 				continue;
 
-			CollectionFileData* newGame = new CollectionFileData(it->second, newSys);
+			CollectionFileData* newGame = new (newSys) CollectionFileData(it->second, newSys);
 			rootFolder->addChild(newGame);
 			newSys->addToIndex(newGame);
 		}
@@ -1217,7 +1381,7 @@ void CollectionSystemManager::addEnabledCollectionsToDisplayedSystems(std::map<s
 	{
 		std::vector<CollectionSystemData*> collectionsToPopulate;
 		for (auto it = colSystemData->begin(); it != colSystemData->end(); it++)
-			if (it->second.isEnabled && !it->second.isPopulated)
+			if (it->second.isEnabled && !it->second.isPopulated && it->second.decl.isCustom)
 				collectionsToPopulate.push_back(&(it->second));
 
 		if (collectionsToPopulate.size() > 1)
@@ -1227,12 +1391,7 @@ void CollectionSystemManager::addEnabledCollectionsToDisplayedSystems(std::map<s
 			Utils::ThreadPool pool;
 
 			for (auto collection : collectionsToPopulate)
-			{
-				if (collection->decl.isCustom)
-					pool.queueWorkItem([this, collection, pMap] { populateCustomCollection(collection, pMap); });
-				else
-					pool.queueWorkItem([this, collection, pMap] { populateAutoCollection(collection); });
-			}
+				pool.queueWorkItem([this, collection, pMap] { populateCustomCollection(collection, pMap); });
 
 			pool.wait();
 		}
@@ -1247,14 +1406,9 @@ void CollectionSystemManager::addEnabledCollectionsToDisplayedSystems(std::map<s
 		if (it->second.system->getTheme() == nullptr)
 			it->second.system->loadTheme();
 
-		// check if populated, otherwise populate
-		if (!it->second.isPopulated)
-		{
-			if (it->second.decl.isCustom)
-				populateCustomCollection(&(it->second), pMap);
-			else
-				populateAutoCollection(&(it->second));
-		}
+		// check if populated, otherwise populate. The auto collections with their own view are populated on their first access
+		if (!it->second.isPopulated && it->second.decl.isCustom)
+			populateCustomCollection(&(it->second), pMap);
 
 		bool groupableCollection = it->second.decl.isCustom;
 
@@ -1273,16 +1427,30 @@ void CollectionSystemManager::addEnabledCollectionsToDisplayedSystems(std::map<s
 		// check if it has its own view
 		if (!groupableCollection || themeFolderExists(it->first) || !Settings::getInstance()->getBool("UseCustomCollectionsSystem")) 
 		{
-			if (it->second.decl.displayIfEmpty || it->second.system->getRootFolder()->getChildren().size() > 0)
+			CollectionSystemData* data = &(it->second);
+
+			bool hasGames;
+			if (data->isPopulated || data->system->isPopulationPending())
+				hasGames = data->system->isPopulationPending() || data->system->getRootFolder()->getChildren().size() > 0;
+			else
+				hasGames = hasAutoCollectionGames(data->decl);
+
+			if (data->decl.displayIfEmpty || hasGames)
 			{
+				if (!data->isPopulated && !data->system->isPopulationPending())
+					data->system->setPendingPopulation([this, data] { populateAutoCollection(data); });
+
 				// exists theme folder, or we chose not to bundle it under the custom-collections system
 				// so we need to create a view
-				if (it->second.isEnabled)
-					SystemData::sSystemVector.push_back(it->second.system);
+				if (data->isEnabled)
+					SystemData::sSystemVector.push_back(data->system);
 			}
 		}
 		else
 		{
+			if (!it->second.isPopulated)
+				populateAutoCollection(&(it->second), true);
+
 			FileData* newSysRootFolder = it->second.system->getRootFolder();
 			mCustomCollectionsBundle->getRootFolder()->addChild(newSysRootFolder);
 
@@ -40,8 +40,8 @@ struct CollectionSystemDecl
 	bool isCustom;	
     bool displayIfEmpty;
 
-	bool isArcadeSubSystem() { return (int)type >= 1000 && (int)type < 10000; }
-	bool isGenreCollection() { return (int)type >= 10000 && (int)type < 20000; }
+	bool isArcadeSubSystem() const { return (int)type >= 1000 && (int)type < 10000; }
+	bool isGenreCollection() const { return (int)type >= 10000 && (int)type < 20000; }
 };
 
 struct CollectionSystemData
@@ -74,8 +74,9 @@ public:
 	void updateSystemsList();
 
 	void refreshCollectionSystems(FileData* file);
-	void updateCollectionSystem(FileData* file, CollectionSystemData sysData);
+	void updateCollectionSystem(FileData* file, const CollectionSystemData& sysData);
 	void deleteCollectionFiles(FileData* file);
+	void addCollectionFiles(const std::vector<FileData*>& files);
 
 	inline std::map<std::string, CollectionSystemData>& getAutoCollectionSystems() { return mAutoCollectionSystemsData; };
 	inline std::map<std::string, CollectionSystemData> getCustomCollectionSystems() { return mCustomCollectionSystemsData; };
@@ -93,7 +94,11 @@ public:
 	void updateCollectionFolderMetadata(SystemData* sys);
 
 	void reloadCollection(const std::string collectionName, bool repopulateGamelist = true);
-    void populateAutoCollection(CollectionSystemData* sysData);
+    void populateAutoCollection(CollectionSystemData* sysData, bool splitBySystem = false); // splitBySystem : the systems are traversed on a pool, not to be used from one
+	std::vector<SystemData*> getAutoCollectionSources();
+	bool collectAutoCollectionGames(const CollectionSystemDecl& decl, SystemData* system, std::vector<FileData*>* games);
+	bool isAutoCollectionGame(const CollectionSystemDecl& decl, FileData* file, bool isArcade);
+	bool hasAutoCollectionGames(const CollectionSystemDecl& decl);
 	bool deleteCustomCollection(CollectionSystemData* data);
 
 	bool isCustomCollection(const std::string collectionName);
@@ -129,11 +134,12 @@ private:
 	std::vector<std::string> getUserCollectionThemeFolders();
 
 	void trimCollectionCount(FolderData* rootFolder, int limit);
-	void sortLastPlayed(SystemData* system);
+	void sortLastPlayed(SystemData* system, FileData* changed = nullptr); // changed : the only entry out of place
 
 	bool themeFolderExists(std::string folder);
 
 	bool includeFileInAutoCollections(FileData* file);
+	bool isDynamicCollectionCandidate(FileData* file);
 
 	SystemData* mCustomCollectionsBundle;
 };
@@ -0,0 +1,116 @@
+#include "CommandCache.h"
+
+#include "utils/StringUtil.h"
+#include "TaskScheduler.h"
+#include "Log.h"
+#include <SDL_timer.h>
+
+std::mutex CommandCache::mLock;
+std::condition_variable CommandCache::mEvent;
+std::map<std::string, CommandCache::Entry> CommandCache::mEntries;
+
+int CommandCache::getTimeToLive(Kind kind)
+{
+	switch (kind)
+	{
+	case HARDWARE:
+		return 10 * 60 * 1000;
+	case DEVICES:
+		return 15 * 1000;
+	default:
+		return 5 * 1000;
+	}
+}
+
+std::vector<std::string> CommandCache::execute(const std::string& command, Kind kind, const run_function& run)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	Entry& entry = mEntries[command];
+
+	// A prefetch is running : the result comes sooner than running the script again
+	if (!entry.valid && entry.running)
+		mEvent.wait(lock, [&entry]() { return entry.valid || !entry.running; });
+
+	if (entry.valid)
+	{
+		if ((int)SDL_GetTicks() - entry.time >= getTimeToLive(kind) && !entry.running)
+		{
+			entry.running = true;
+
+			int generation = entry.generation;
+			TaskScheduler::submit(TaskScheduler::BACKGROUND, [command, run, generation]() { refresh(command, run, generation); });
+		}
+
+		return entry.lines;
+	}
+
+	entry.running = true;
+	int generation = entry.generation;
+	lock.unlock();
+
+	auto lines = run();
+
+	lock.lock();
+
+	Entry& done = mEntries[command];
+	done.running = false;
+
+	if (done.generation == generation)
+	{
+		done.lines = lines;
+		done.valid = true;
+		done.time = SDL_GetTicks();
+	}
+
+	mEvent.notify_all();
+	return lines;
+}
+
+void CommandCache::prefetch(const std::string& command, Kind kind, const run_function& run)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	Entry& entry = mEntries[command];
+	if (entry.running || (entry.valid && (int)SDL_GetTicks() - entry.time < getTimeToLive(kind)))
+		return;
+
+	entry.running = true;
+
+	int generation = entry.generation;
+	TaskScheduler::submit(TaskScheduler::BACKGROUND, [command, run, generation]() { refresh(command, run, generation); });
+}
+
+void CommandCache::refresh(const std::string& command, const run_function& run, int generation)
+{
+	auto lines = run();
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	Entry& entry = mEntries[command];
+	entry.running = false;
+
+	// Invalidated while running : the result may be the state before the change
+	if (entry.generation == generation)
+	{
+		entry.lines = lines;
+		entry.valid = true;
+		entry.time = SDL_GetTicks();
+	}
+
+	mEvent.notify_all();
+}
+
+void CommandCache::invalidate(const std::string& prefix)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	for (auto& entry : mEntries)
+	{
+		if (!Utils::String::startsWith(entry.first, prefix))
+			continue;
+
+		entry.second.valid = false;
+		entry.second.generation++;
+	}
+}
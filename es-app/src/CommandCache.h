@@ -0,0 +1,54 @@
+#pragma once
+#ifndef ES_APP_COMMAND_CACHE_H
+#define ES_APP_COMMAND_CACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Results of the ApiSystem queries ( batocera-xxx list... ). A result is fresh for the TTL of its kind, then it's still returned while a background refresh runs :
+// only the first query of a command waits for the script, and the menus can prefetch what their sub screens will ask
+class CommandCache
+{
+public:
+	enum Kind
+	{
+		HARDWARE,	// Video modes, architectures, overclocking : no change while running
+		DEVICES,	// Storages, audio & video outputs, paired devices : plugged & unplugged
+		STATUS		// Current storage & audio output, system informations
+	};
+
+	typedef std::function<std::vector<std::string>()> run_function;
+
+	static std::vector<std::string> execute(const std::string& command, Kind kind, const run_function& run);
+
+	// Runs the command in the background if it has no fresh result
+	static void prefetch(const std::string& command, Kind kind, const run_function& run);
+
+	// The commands starting with prefix run again on their next query, after a change of their state
+	static void invalidate(const std::string& prefix);
+
+private:
+	struct Entry
+	{
+		Entry() : valid(false), running(false), time(0), generation(0) { }
+
+		std::vector<std::string> lines;
+		bool valid;
+		bool running;
+		int time;
+		int generation;
+	};
+
+	static int getTimeToLive(Kind kind);
+	static void refresh(const std::string& command, const run_function& run, int generation);
+
+	static std::mutex mLock;
+	static std::condition_variable mEvent;
+	static std::map<std::string, Entry> mEntries;
+};
+
+#endif // ES_APP_COMMAND_CACHE_H
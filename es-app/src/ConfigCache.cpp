@@ -0,0 +1,91 @@
+#include "ConfigCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/MemoryMappedFile.h"
+#include "utils/StringUtil.h"
+#include "utils/VectorEx.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <fstream>
+
+#define CONFIG_CACHE_MAGIC	0x46434545 // 'EECF'
+#define CONFIG_CACHE_END	0x444E4545 // 'EEND'
+
+std::string ConfigCache::getCachePath(const std::string& name)
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/" + name + ".cache");
+}
+
+std::vector<std::string> ConfigCache::getAdditionalFiles(const std::string& prefix)
+{
+	std::vector<std::string> ret;
+
+	std::vector<std::string> rootPaths = { Paths::getUserEmulationStationPath(), Paths::getEmulationStationPath() };
+	for (auto rootPath : VectorHelper::distinct(rootPaths, [](auto x) { return x; }))
+	{
+		for (auto customPath : Utils::FileSystem::getDirContent(rootPath, false, false))
+		{
+			if (Utils::FileSystem::getExtension(customPath) != ".cfg")
+				continue;
+
+			if (!Utils::String::startsWith(Utils::FileSystem::getFileName(customPath), prefix))
+				continue;
+
+			ret.push_back(customPath);
+		}
+	}
+
+	return ret;
+}
+
+std::string ConfigCache::getKey(const std::string& version, const std::vector<std::string>& files)
+{
+	std::string key = version;
+
+	for (auto& file : files)
+	{
+		long long modificationTime = 0;
+		unsigned long long size = 0;
+		Utils::FileSystem::getFileStamp(file, modificationTime, size);
+
+		key += "|" + file + "|" + std::to_string(size) + "|" + std::to_string(modificationTime);
+	}
+
+	return key;
+}
+
+bool ConfigCache::read(const std::string& name, const std::string& key, const std::function<bool(Utils::BinaryReader& reader)>& func)
+{
+	Utils::MemoryMappedFile file(getCachePath(name));
+	if (!file.isOpen())
+		return false;
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (reader.readUInt32() != CONFIG_CACHE_MAGIC || reader.readString() != key)
+		return false;
+
+	// Never use a partially read cache
+	if (!func(reader) || reader.failed() || reader.readUInt32() != CONFIG_CACHE_END)
+	{
+		LOG(LogWarning) << "ConfigCache : Ignoring invalid " << name << " cache";
+		return false;
+	}
+
+	LOG(LogDebug) << "ConfigCache : " << name << " loaded from the cache";
+	return true;
+}
+
+void ConfigCache::write(const std::string& name, const std::string& key, const std::function<void(Utils::BinaryWriter& writer)>& func)
+{
+	Utils::BinaryWriter writer;
+	writer.writeUInt32(CONFIG_CACHE_MAGIC);
+	writer.writeString(key);
+	func(writer);
+	writer.writeUInt32(CONFIG_CACHE_END);
+
+	std::string cachePath = getCachePath(name);
+
+	if (!Utils::FileSystem::writeFileAtomic(cachePath, writer))
+		LOG(LogWarning) << "ConfigCache : Unable to write " << cachePath;
+}
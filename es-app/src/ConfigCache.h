@@ -0,0 +1,29 @@
+#pragma once
+#ifndef ES_APP_CONFIG_CACHE_H
+#define ES_APP_CONFIG_CACHE_H
+
+#include "utils/BinaryStream.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Binary copies of the configurations merged from several xml files ( es_systems, es_features ), in the cache folder of the user.
+// They are keyed by the path, size & modification time of every file they come from : while none of them changes, the xml files are not parsed
+class ConfigCache
+{
+public:
+	// The <prefix>*.cfg files of the user & emulationstation folders, in the order they are merged
+	static std::vector<std::string> getAdditionalFiles(const std::string& prefix);
+
+	static std::string getKey(const std::string& version, const std::vector<std::string>& files);
+
+	// func returns false when the content can't be used
+	static bool read(const std::string& name, const std::string& key, const std::function<bool(Utils::BinaryReader& reader)>& func);
+	static void write(const std::string& name, const std::string& key, const std::function<void(Utils::BinaryWriter& writer)>& func);
+
+private:
+	static std::string getCachePath(const std::string& name);
+};
+
+#endif // ES_APP_CONFIG_CACHE_H
@@ -3,7 +3,9 @@
 #include "components/AsyncNotificationComponent.h"
 #include "utils/StringUtil.h"
 #include "ApiSystem.h"
+#include "HttpReq.h"
 #include "LocaleES.h"
+#include "TaskScheduler.h"
 
 #define ICONINDEX _U("\uF019 ")
 
@@ -27,6 +29,10 @@ void ContentInstaller::Enqueue(Window* window, ContentType type, const std::stri
 
 	mQueue.push_back(std::pair<int, std::string>(type, contentName));
 
+	// Themes are downloaded in-process from github, the other contents by external scripts
+	if (type == CONTENT_THEME_INSTALL)
+		HttpReq::preconnect({ "https://api.github.com/", "https://codeload.github.com/" });
+
 	if (mInstance == nullptr)
 		mInstance = new ContentInstaller(window);
 
@@ -105,6 +111,8 @@ void ContentInstaller::updateNotificationComponentContent(const std::string info
 
 void ContentInstaller::threadUpdate()
 {
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::NETWORK);
+
 	mCurrent = 0;
 
 	// Wait for an event to say there is something in the queue
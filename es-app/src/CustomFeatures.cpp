@@ -3,6 +3,9 @@
 #include "utils/StringUtil.h"
 #include "Log.h"
 #include "Paths.h"
+#include "ConfigCache.h"
+
+#define FEATURES_CACHE_VERSION	"1" // Increase when the features or their serialization change
 
 bool CustomFeatures::FeaturesLoaded = false;
 
@@ -90,59 +93,52 @@ void CustomFeatures::importXmlElements(pugi::xml_node& from, const std::string&
 	}
 }
 
-void CustomFeatures::loadAdditionnalFeatures(pugi::xml_node& srcSystems)
+void CustomFeatures::loadAdditionnalFeatures(pugi::xml_node& srcSystems, const std::vector<std::string>& files)
 {
-	std::vector<std::string> rootPaths = { Paths::getUserEmulationStationPath(), Paths::getEmulationStationPath() };
-	for (auto rootPath : VectorHelper::distinct(rootPaths, [](auto x) { return x; }))
+	for (auto customPath : files)
 	{
-		for (auto customPath : Utils::FileSystem::getDirContent(rootPath, false, false))
+		pugi::xml_document doc;
+		pugi::xml_parse_result res = doc.load_file(WINSTRINGW(customPath).c_str());
+		if (!res)
 		{
-			if (Utils::FileSystem::getExtension(customPath) != ".cfg" || !Utils::String::startsWith(Utils::FileSystem::getFileName(customPath), "es_features_"))
-				continue;
-
-			pugi::xml_document doc;
-			pugi::xml_parse_result res = doc.load_file(WINSTRINGW(customPath).c_str());
-			if (!res)
-			{
-				LOG(LogError) << "Could not parse " << Utils::FileSystem::getFileName(customPath) << " file!";
-				continue;
-			}
+			LOG(LogError) << "Could not parse " << Utils::FileSystem::getFileName(customPath) << " file!";
+			continue;
+		}
 
-			pugi::xml_node systemList = doc.child("features");
-			if (!systemList)
-			{
-				LOG(LogError) << Utils::FileSystem::getFileName(customPath) << " is missing the <features> tag !";
-				continue;
-			}
+		pugi::xml_node systemList = doc.child("features");
+		if (!systemList)
+		{
+			LOG(LogError) << Utils::FileSystem::getFileName(customPath) << " is missing the <features> tag !";
+			continue;
+		}
 
-			// import/replace shared features
-			pugi::xml_node sharedFeaturesToAdd = systemList.child("sharedFeatures");
-			if (sharedFeaturesToAdd)
-			{
-				pugi::xml_node sharedFeatures = srcSystems.child("sharedFeatures");
-				if (sharedFeatures)
-					importXmlElements(sharedFeaturesToAdd, "feature", sharedFeatures, "value");
-				else
-					srcSystems.append_copy(sharedFeaturesToAdd);
-			}
+		// import/replace shared features
+		pugi::xml_node sharedFeaturesToAdd = systemList.child("sharedFeatures");
+		if (sharedFeaturesToAdd)
+		{
+			pugi::xml_node sharedFeatures = srcSystems.child("sharedFeatures");
+			if (sharedFeatures)
+				importXmlElements(sharedFeaturesToAdd, "feature", sharedFeatures, "value");
+			else
+				srcSystems.append_copy(sharedFeaturesToAdd);
+		}
 
-			// import/replace global features
-			pugi::xml_node globalFeaturesToAdd = systemList.child("globalFeatures");
-			if (globalFeaturesToAdd)
+		// import/replace global features
+		pugi::xml_node globalFeaturesToAdd = systemList.child("globalFeatures");
+		if (globalFeaturesToAdd)
+		{
+			pugi::xml_node globalFeatures = srcSystems.child("globalFeatures");
+			if (globalFeatures)
 			{
-				pugi::xml_node globalFeatures = srcSystems.child("globalFeatures");
-				if (globalFeatures)
-				{
-					importXmlElements(globalFeaturesToAdd, "sharedFeature", globalFeatures, "value");
-					importXmlElements(globalFeaturesToAdd, "feature", globalFeatures, "value");
-				}
-				else
-					srcSystems.append_copy(globalFeaturesToAdd);
+				importXmlElements(globalFeaturesToAdd, "sharedFeature", globalFeatures, "value");
+				importXmlElements(globalFeaturesToAdd, "feature", globalFeatures, "value");
 			}
-
-			// import emulators
-			importXmlElements(systemList, "emulator", srcSystems);
+			else
+				srcSystems.append_copy(globalFeaturesToAdd);
 		}
+
+		// import emulators
+		importXmlElements(systemList, "emulator", srcSystems);
 	}
 
 	/* Uncomment to see final XML result
@@ -167,6 +163,23 @@ bool CustomFeatures::loadEsFeaturesFile()
 	if (!Utils::FileSystem::exists(path))
 		return false;
 
+	// The resolved features, while es_features.cfg & the es_features_*.cfg files don't change
+	std::vector<std::string> files = ConfigCache::getAdditionalFiles("es_features_");
+
+	std::vector<std::string> sources = files;
+	sources.insert(sources.begin(), path);
+
+	std::string key = ConfigCache::getKey(FEATURES_CACHE_VERSION, sources);
+	if (ConfigCache::read("features", key, readCache))
+	{
+		FeaturesLoaded = true;
+		return true;
+	}
+
+	EmulatorFeatures.clear();
+	GlobalFeatures.clear();
+	SharedFeatures.clear();
+
 	pugi::xml_document doc;
 	pugi::xml_parse_result res = doc.load_file(WINSTRINGW(path).c_str());
 
@@ -184,7 +197,7 @@ bool CustomFeatures::loadEsFeaturesFile()
 		return false;
 	}
 
-	loadAdditionnalFeatures(systemList);
+	loadAdditionnalFeatures(systemList, files);
 
 	pugi::xml_node sharedFeatures = systemList.child("sharedFeatures");
 	if (sharedFeatures)
@@ -391,10 +404,142 @@ bool CustomFeatures::loadEsFeaturesFile()
 			}
 		}
 	}
-	
+
+	ConfigCache::write("features", key, writeCache);
 	return true;
 }
 
+void CustomFeatures::write(Utils::BinaryWriter& writer) const
+{
+	writer.writeUInt32((uint32_t)size());
+	for (auto& feature : *this)
+	{
+		for (auto value : { &feature.name, &feature.value, &feature.description, &feature.submenu, &feature.preset, &feature.group })
+			writer.writeString(*value);
+
+		writer.writeUInt32((uint32_t)feature.order);
+
+		writer.writeUInt32((uint32_t)feature.choices.size());
+		for (auto& choice : feature.choices)
+		{
+			writer.writeString(choice.name);
+			writer.writeString(choice.value);
+		}
+	}
+}
+
+void CustomFeatures::read(Utils::BinaryReader& reader)
+{
+	clear();
+
+	uint32_t count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		CustomFeature feature;
+		for (auto value : { &feature.name, &feature.value, &feature.description, &feature.submenu, &feature.preset, &feature.group })
+			*value = reader.readString();
+
+		feature.order = (int)reader.readUInt32();
+
+		uint32_t choiceCount = reader.readUInt32();
+		for (uint32_t c = 0; c < choiceCount && !reader.failed(); c++)
+		{
+			CustomFeatureChoice choice;
+			choice.name = reader.readString();
+			choice.value = reader.readString();
+			feature.choices.push_back(choice);
+		}
+
+		push_back(feature);
+	}
+}
+
+static void writeSystemFeatures(Utils::BinaryWriter& writer, const std::vector<SystemFeature>& systemFeatures)
+{
+	writer.writeUInt32((uint32_t)systemFeatures.size());
+	for (auto& systemFeature : systemFeatures)
+	{
+		writer.writeString(systemFeature.name);
+		writer.writeUInt32((uint32_t)systemFeature.features);
+		systemFeature.customFeatures.write(writer);
+	}
+}
+
+static void readSystemFeatures(Utils::BinaryReader& reader, std::vector<SystemFeature>& systemFeatures)
+{
+	uint32_t count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		SystemFeature systemFeature;
+		systemFeature.name = reader.readString();
+		systemFeature.features = (EmulatorFeatures::Features)reader.readUInt32();
+		systemFeature.customFeatures.read(reader);
+		systemFeatures.push_back(systemFeature);
+	}
+}
+
+void CustomFeatures::writeCache(Utils::BinaryWriter& writer)
+{
+	SharedFeatures.write(writer);
+	GlobalFeatures.write(writer);
+
+	writer.writeUInt32((uint32_t)EmulatorFeatures.size());
+	for (auto& it : EmulatorFeatures)
+	{
+		auto& emul = it.second;
+
+		writer.writeString(it.first);
+		writer.writeString(emul.name);
+		writer.writeUInt32((uint32_t)emul.features);
+		emul.customFeatures.write(writer);
+		writeSystemFeatures(writer, emul.systemFeatures);
+
+		writer.writeUInt32((uint32_t)emul.cores.size());
+		for (auto& core : emul.cores)
+		{
+			writer.writeString(core.name);
+			writer.writeUInt32((uint32_t)core.features);
+			core.customFeatures.write(writer);
+			writeSystemFeatures(writer, core.systemFeatures);
+		}
+	}
+}
+
+bool CustomFeatures::readCache(Utils::BinaryReader& reader)
+{
+	SharedFeatures.read(reader);
+	GlobalFeatures.read(reader);
+
+	uint32_t count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		EmulatorData& emul = EmulatorFeatures[reader.readString()];
+		emul.name = reader.readString();
+		emul.features = (EmulatorFeatures::Features)reader.readUInt32();
+		emul.customFeatures.read(reader);
+		readSystemFeatures(reader, emul.systemFeatures);
+
+		uint32_t coreCount = reader.readUInt32();
+		for (uint32_t c = 0; c < coreCount && !reader.failed(); c++)
+		{
+			CoreData core;
+			core.name = reader.readString();
+			core.features = (EmulatorFeatures::Features)reader.readUInt32();
+			core.customFeatures.read(reader);
+			readSystemFeatures(reader, core.systemFeatures);
+			emul.cores.push_back(core);
+		}
+	}
+
+	if (!reader.failed())
+		return true;
+
+	EmulatorFeatures.clear();
+	GlobalFeatures.clear();
+	SharedFeatures.clear();
+	return false;
+}
+
 CustomFeatures CustomFeatures::loadCustomFeatures(pugi::xml_node node)
 {
 	CustomFeatures ret;
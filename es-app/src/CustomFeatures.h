@@ -11,6 +11,7 @@
 #include <pugixml/src/pugixml.hpp>
 
 #include "utils/VectorEx.h"
+#include "utils/BinaryStream.h"
 
 struct CustomFeatureChoice
 {
@@ -56,10 +57,17 @@ public:
 
 	bool hasFeature(const std::string& name) const;
 	bool hasGlobalFeature(const std::string& name) const;
+
+	void write(Utils::BinaryWriter& writer) const;
+	void read(Utils::BinaryReader& reader);
 	
 private:
 	static CustomFeatures loadCustomFeatures(pugi::xml_node node);
-	static void loadAdditionnalFeatures(pugi::xml_node& srcSystems);
+	static void loadAdditionnalFeatures(pugi::xml_node& srcSystems, const std::vector<std::string>& files);
+
+	// Shared, global & emulator features, in the config cache
+	static void writeCache(Utils::BinaryWriter& writer);
+	static bool readCache(Utils::BinaryReader& reader);
 
 	static void importXmlElements(pugi::xml_node& from, const std::string& elementName, pugi::xml_node& to, const std::string& remplacementKey = "");
 };
@@ -0,0 +1,206 @@
+#include "DirectoryManifest.h"
+
+#include "utils/BinaryStream.h"
+#include "utils/MemoryMappedFile.h"
+#include "utils/StringUtil.h"
+#include "SystemData.h"
+#include "SharedCatalog.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <fstream>
+#include <time.h>
+
+#define DIRECTORY_MANIFEST_MAGIC	0x4D444545 // 'EEDM'
+#define DIRECTORY_MANIFEST_END		0x444E4545 // 'EEND'
+#define DIRECTORY_MANIFEST_VERSION	1
+
+#define ENTRY_HIDDEN				1
+#define ENTRY_DIRECTORY				2
+
+// Directories modified less than this before the listing are listed again next time ( timestamps granularity )
+#define UNSTABLE_DELAY_SECONDS		2
+
+DirectoryManifest::DirectoryManifest(SystemData* system) : mSystem(system), mChanged(false), mRestored(0), mListed(0)
+{
+	load();
+}
+
+bool DirectoryManifest::isEnabled()
+{
+	return Settings::getInstance()->getBool("IncrementalRomScan");
+}
+
+std::string DirectoryManifest::getManifestPath(SystemData* system)
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/gamelists/" + system->getName() + ".dirs");
+}
+
+void DirectoryManifest::invalidate(SystemData* system)
+{
+	std::string manifestPath = getManifestPath(system);
+	if (Utils::FileSystem::exists(manifestPath))
+		Utils::FileSystem::removeFile(manifestPath);
+}
+
+void DirectoryManifest::load()
+{
+	if (!isEnabled())
+		return;
+
+	Utils::MemoryMappedFile file(getManifestPath(mSystem));
+	if (!file.isOpen())
+	{
+		// Listing of the fleet : its directories are checked against their stamps like the local ones
+		std::string sharedPath = SharedCatalog::getSharedPath("cache/gamelists/" + mSystem->getName() + ".dirs");
+		if (sharedPath.empty() || !file.open(sharedPath))
+			return;
+	}
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (reader.readUInt32() != DIRECTORY_MANIFEST_MAGIC || reader.readUInt32() != DIRECTORY_MANIFEST_VERSION)
+		return;
+
+	std::unordered_map<std::string, DirectoryEntry> directories;
+
+	uint32_t count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		std::string path = reader.readString();
+
+		DirectoryEntry& entry = directories[path];
+		entry.modificationTime = reader.readInt64();
+		entry.inode = reader.readUInt64();
+
+		uint32_t fileCount = reader.readUInt32();
+		for (uint32_t f = 0; f < fileCount && !reader.failed(); f++)
+		{
+			Utils::FileSystem::FileInfo fi;
+			fi.path = path + "/" + reader.readString();
+
+			uint8_t flags = reader.readUInt8();
+			fi.hidden = (flags & ENTRY_HIDDEN) != 0;
+			fi.directory = (flags & ENTRY_DIRECTORY) != 0;
+#if WIN32
+			fi.lastWriteTime = (time_t)reader.readInt64();
+#else
+			reader.readInt64();
+#endif
+			entry.files.push_back(fi);
+		}
+	}
+
+	// Never use a partially read manifest
+	if (reader.failed() || reader.readUInt32() != DIRECTORY_MANIFEST_END)
+	{
+		LOG(LogWarning) << "DirectoryManifest : Ignoring invalid manifest for " << mSystem->getName();
+		return;
+	}
+
+	mDirectories = std::move(directories);
+}
+
+Utils::FileSystem::fileList DirectoryManifest::getDirectoryFiles(const std::string& _path)
+{
+	if (!isEnabled())
+		return Utils::FileSystem::getDirectoryFiles(_path);
+
+	std::string path = Utils::FileSystem::getGenericPath(_path);
+
+	long long modificationTime;
+	unsigned long long inode;
+	if (!Utils::FileSystem::getDirectoryStamp(path, modificationTime, inode))
+		return Utils::FileSystem::getDirectoryFiles(path);
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		DirectoryEntry& entry = mDirectories[path];
+		entry.visited = true;
+
+		if (entry.modificationTime == modificationTime && entry.inode == inode && modificationTime != 0)
+		{
+			Utils::FileSystem::addDirectoryFilesToCache(path, entry.files);
+			mRestored++;
+			return entry.files;
+		}
+	}
+
+	Utils::FileSystem::fileList files = Utils::FileSystem::getDirectoryFiles(path);
+
+	// A directory changed in the same timestamp tick as its listing can't be trusted : it will be listed again next time
+	if (modificationTime / 1000000000LL + UNSTABLE_DELAY_SECONDS >= (long long)time(NULL))
+		modificationTime = 0;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	DirectoryEntry& entry = mDirectories[path];
+	entry.files = files;
+	entry.inode = inode;
+	entry.modificationTime = modificationTime;
+
+	mChanged = true;
+	mListed++;
+	return files;
+}
+
+bool DirectoryManifest::save()
+{
+	if (!isEnabled())
+		return false;
+
+	int count = 0;
+	for (auto& dir : mDirectories)
+		if (dir.second.visited)
+			count++;
+
+	// Directories that have not been visited don't exist anymore ( or are not scanned anymore )
+	if (!mChanged && count == (int)mDirectories.size())
+	{
+		LOG(LogDebug) << "DirectoryManifest : " << mSystem->getName() << " unchanged, " << mRestored << " directories restored";
+		return true;
+	}
+
+	Utils::BinaryWriter writer;
+	writer.writeUInt32(DIRECTORY_MANIFEST_MAGIC);
+	writer.writeUInt32(DIRECTORY_MANIFEST_VERSION);
+	writer.writeUInt32((uint32_t)count);
+
+	for (auto& dir : mDirectories)
+	{
+		if (!dir.second.visited)
+			continue;
+
+		writer.writeString(dir.first);
+		writer.writeInt64(dir.second.modificationTime);
+		writer.writeUInt64(dir.second.inode);
+		writer.writeUInt32((uint32_t)dir.second.files.size());
+
+		size_t prefix = dir.first.size() + 1;
+
+		for (auto& fi : dir.second.files)
+		{
+			writer.writeString(fi.path.size() > prefix ? fi.path.substr(prefix) : fi.path);
+			writer.writeUInt8((fi.hidden ? ENTRY_HIDDEN : 0) | (fi.directory ? ENTRY_DIRECTORY : 0));
+#if WIN32
+			writer.writeInt64((int64_t)fi.lastWriteTime);
+#else
+			writer.writeInt64(0);
+#endif
+		}
+	}
+
+	writer.writeUInt32(DIRECTORY_MANIFEST_END);
+
+	std::string manifestPath = getManifestPath(mSystem);
+
+	if (!Utils::FileSystem::writeFileAtomic(manifestPath, writer))
+	{
+		LOG(LogWarning) << "DirectoryManifest : Unable to write " << manifestPath;
+		return false;
+	}
+
+	LOG(LogDebug) << "DirectoryManifest : " << mSystem->getName() << " " << mRestored << " directories restored, " << mListed << " listed";
+	return true;
+}
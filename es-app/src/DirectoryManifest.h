@@ -0,0 +1,50 @@
+#pragma once
+#ifndef ES_APP_DIRECTORY_MANIFEST_H
+#define ES_APP_DIRECTORY_MANIFEST_H
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include "utils/FileSystemUtil.h"
+
+class SystemData;
+
+// Persisted listing of the rom folders of a system, stored next to the gamelist cache.
+// Each directory is keyed by its modification time & inode : unchanged directories are restored without being listed again.
+class DirectoryManifest
+{
+public:
+	DirectoryManifest(SystemData* system);
+
+	// Same as Utils::FileSystem::getDirectoryFiles, but served from the manifest when the directory did not change. Thread safe
+	Utils::FileSystem::fileList getDirectoryFiles(const std::string& path);
+
+	bool save();
+
+	static void invalidate(SystemData* system);
+	static bool isEnabled();
+
+private:
+	struct DirectoryEntry
+	{
+		DirectoryEntry() : modificationTime(0), inode(0), visited(false) { }
+
+		long long modificationTime;
+		unsigned long long inode;
+		Utils::FileSystem::fileList files;
+		bool visited;
+	};
+
+	static std::string getManifestPath(SystemData* system);
+	void load();
+
+	SystemData* mSystem;
+	std::unordered_map<std::string, DirectoryEntry> mDirectories;
+	std::mutex mLock;
+
+	bool mChanged;
+	int mRestored;
+	int mListed;
+};
+
+#endif // ES_APP_DIRECTORY_MANIFEST_H
@@ -5,8 +5,10 @@
 #include "utils/TimeUtil.h"
 #include "AudioManager.h"
 #include "CollectionSystemManager.h"
+#include "FileDataArena.h"
 #include "FileFilterIndex.h"
 #include "FileSorts.h"
+#include "LocalArtIndex.h"
 #include "Log.h"
 #include "MameNames.h"
 #include "utils/Platform.h"
@@ -17,12 +19,15 @@
 #include "views/UIModeController.h"
 #include <assert.h>
 #include "SystemConf.h"
+#include "ConfigWriter.h"
 #include "InputManager.h"
 #include "scrapers/ThreadedScraper.h"
 #include "Gamelist.h" 
 #include "ApiSystem.h"
 #include <time.h>
 #include <algorithm>
+#include <atomic>
+#include <unordered_set>
 #include "LangParser.h"
 #include "resources/ResourceManager.h"
 #include "RetroAchievements.h"
@@ -38,22 +43,117 @@ using namespace Utils::Platform;
 
 FileData* FileData::mRunningGame = nullptr;
 
+// Folders of the files, shared by the siblings. Never released : the rom folders are kept across the reloads
+static std::mutex sDirectoriesLock;
+static std::unordered_set<std::string> sDirectories;
+
+static const std::string* internDirectory(const std::string& path, size_t length)
+{
+	// Siblings are created in a row by the same loading thread
+	static thread_local const std::string* lastDirectory = nullptr;
+	if (lastDirectory != nullptr && lastDirectory->size() == length && path.compare(0, length, *lastDirectory) == 0)
+		return lastDirectory;
+
+	std::unique_lock<std::mutex> lock(sDirectoriesLock);
+	lastDirectory = &(*sDirectories.insert(path.substr(0, length)).first);
+	return lastDirectory;
+}
+
 FileData::FileData(FileType type, const std::string& path, SystemData* system)
-	: mPath(path), mType(type), mSystem(system), mParent(nullptr), mDisplayName(nullptr), mMetadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
+	: mDirectory(nullptr), mType(type), mSystem(system), mParent(nullptr), mDisplayName(nullptr), mMetadata(new MetaDataList(type == GAME ? GAME_METADATA : FOLDER_METADATA)) // metadata is REALLY set in the constructor!
 {
+	// Same split as Utils::FileSystem::getFileName, so the leaf name is the file name
+	for (int i = (int)path.size() - 1; i > 0; i--)
+	{
+		if (path[i] == '/' || path[i] == '\\')
+		{
+			mDirectory = internDirectory(path, i + 1);
+			mLeafName = path.substr(i + 1);
+			break;
+		}
+	}
+
+	if (mDirectory == nullptr && !path.empty())
+	{
+		mDirectory = internDirectory(path, 0);
+		mLeafName = path;
+	}
+
 	// metadata needs at least a name field (since that's what getName() will return)
-	if (mMetadata.get(MetaDataId::Name).empty() && !mPath.empty())
-		mMetadata.set(MetaDataId::Name, getDisplayName());
+	if (mMetadata->get(MetaDataId::Name).empty() && mDirectory != nullptr)
+		mMetadata->set(MetaDataId::Name, getDisplayName());
 	
-	mMetadata.resetChangedFlag();
+	mMetadata->resetChangedFlag();
+}
+
+void* FileData::operator new(size_t size)
+{
+	return FileDataArena::allocate(nullptr, size);
+}
+
+void* FileData::operator new(size_t size, SystemData* system)
+{
+	return FileDataArena::allocate(system != nullptr ? system->getFileDataArena() : nullptr, size);
+}
+
+void FileData::operator delete(void* ptr)
+{
+	FileDataArena::deallocate(ptr);
+}
+
+void FileData::operator delete(void* ptr, SystemData* system)
+{
+	FileDataArena::deallocate(ptr);
+}
+
+FileData::FileData(FileType type, SystemData* system)
+	: mDirectory(nullptr), mType(type), mSystem(system), mParent(nullptr), mDisplayName(nullptr), mMetadata(nullptr)
+{
+}
+
+// What the collection entries read while their own destructor has run ( the index removal of ~FileData )
+static MetaDataList sEmptyGameMetadata(GAME_METADATA);
+static MetaDataList sEmptyFolderMetadata(FOLDER_METADATA);
+
+const MetaDataList& FileData::getMetadata() const
+{
+	if (mMetadata == nullptr)
+		return mType == GAME ? sEmptyGameMetadata : sEmptyFolderMetadata;
+
+	return *mMetadata;
+}
+
+MetaDataList& FileData::getMetadata()
+{
+	if (mMetadata == nullptr)
+		return mType == GAME ? sEmptyGameMetadata : sEmptyFolderMetadata;
+
+	return *mMetadata;
 }
 
 const std::string FileData::getPath() const
 {
-	if (mPath.empty())
-		return getSystemEnvData()->mStartPath;
+	std::string path;
+	getPath(path);
+	return path;
+}
+
+void FileData::getPath(std::string& path) const
+{
+	if (mDirectory == nullptr)
+	{
+		path = getSystemEnvData()->mStartPath;
+		return;
+	}
 
-	return mPath;
+	path.reserve(mDirectory->size() + mLeafName.size());
+	path.assign(*mDirectory);
+	path.append(mLeafName);
+}
+
+const std::string& FileData::getLeafName() const
+{
+	return mLeafName;
 }
 
 const std::string FileData::getBreadCrumbPath()
@@ -89,7 +189,7 @@ const std::string FileData::getBreadCrumbPath()
 
 const std::string FileData::getConfigurationName()
 {
-	std::string gameConf = Utils::FileSystem::getFileName(getPath());
+	std::string gameConf = getLeafName();
 	gameConf = Utils::String::replace(gameConf, "=", "");
 	gameConf = Utils::String::replace(gameConf, "#", "");
 	gameConf = getSourceFileData()->getSystem()->getName() + std::string("[\"") + gameConf + std::string("\"]");
@@ -116,13 +216,16 @@ FileData::~FileData()
 
 	if (mType == GAME)
 		mSystem->removeFromIndex(this);
+
+	if (mMetadata != nullptr)
+		delete mMetadata;
 }
 
 std::string& FileData::getDisplayName()
 {
 	if (mDisplayName == nullptr)
 	{
-		std::string stem = Utils::FileSystem::getStem(getPath());
+		std::string stem = Utils::FileSystem::getStem(getLeafName());
 		if (mSystem && (mSystem->hasPlatformId(PlatformIds::ARCADE) || mSystem->hasPlatformId(PlatformIds::NEOGEO)))
 			stem = MameNames::getInstance()->getRealName(stem);
 
@@ -139,22 +242,25 @@ std::string FileData::getCleanName()
 
 std::string FileData::findLocalArt(const std::string& type, std::vector<std::string> exts)
 {
-	if (Settings::getInstance()->getBool("LocalArt"))
+	if (Settings::get(BoolSetting::LocalArt))
 	{
+		LocalArtIndex* index = getSourceFileData()->getSystem()->getLocalArtIndex();
+		auto exists = [index](const std::string& path) { return index != nullptr ? index->exists(path) : Utils::FileSystem::exists(path); };
+
 		for (auto ext : exts)
 		{
 			std::string path = getSystemEnvData()->mStartPath + "/images/" + getDisplayName() + (type.empty() ? "" :  "-" + type) + ext;
-			if (Utils::FileSystem::exists(path))
+			if (exists(path))
 				return path;
 
 			if (type == "video")
 			{
 				path = getSystemEnvData()->mStartPath + "/videos/" + getDisplayName() + "-" + type + ext;
-				if (Utils::FileSystem::exists(path))
+				if (exists(path))
 					return path;
 
 				path = getSystemEnvData()->mStartPath + "/videos/" + getDisplayName() + ext;
-				if (Utils::FileSystem::exists(path))
+				if (exists(path))
 					return path;
 			}
 		}
@@ -233,12 +339,12 @@ bool FileData::hasAnyMedia()
 	if (Utils::FileSystem::exists(getImagePath()) || Utils::FileSystem::exists(getThumbnailPath()) || Utils::FileSystem::exists(getVideoPath()))
 		return true;
 
-	for (auto mdd : mMetadata.getMDD())
+	for (auto mdd : getMetadata().getMDD())
 	{
 		if (mdd.type != MetaDataType::MD_PATH)
 			continue;
 
-		std::string path = mMetadata.get(mdd.key);
+		std::string path = getMetadata().get(mdd.key);
 		if (path.empty())
 			continue;
 
@@ -264,7 +370,7 @@ std::vector<std::string> FileData::getFileMedias()
 {
 	std::vector<std::string> ret;
 
-	for (auto mdd : mMetadata.getMDD())
+	for (auto mdd : getMetadata().getMDD())
 	{
 		if (mdd.type != MetaDataType::MD_PATH)
 			continue;
@@ -272,7 +378,7 @@ std::vector<std::string> FileData::getFileMedias()
 		if (mdd.id == MetaDataId::Video || mdd.id == MetaDataId::Manual || mdd.id == MetaDataId::Magazine)
 			continue;
 
-		std::string path = mMetadata.get(mdd.key);
+		std::string path = getMetadata().get(mdd.key);
 		if (path.empty())
 			continue;
 
@@ -296,7 +402,7 @@ const std::string& FileData::getName()
 	if (mSystem != nullptr && mSystem->getShowFilenames())
 		return getDisplayName();
 
-	return mMetadata.getName();
+	return getMetadata().getName();
 }
 
 const std::string FileData::getVideoPath()
@@ -650,6 +756,9 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 	if (command.empty())
 		return false;
 
+	// The emulator reads the configuration files
+	ConfigWriter::flush();
+
 	AudioManager::getInstance()->deinit();
 	VolumeControl::getInstance()->deinit();
 
@@ -683,13 +792,18 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 		if (options.saveStateInfo != nullptr)
 			options.saveStateInfo->onGameEnded(this);
 
-		getSourceFileData()->getSystem()->getSaveStateRepository()->refresh();
+		getSourceFileData()->getSystem()->getSaveStateRepository()->refresh(this);
 	}
 
 	if (!p2kConv.empty()) // delete .keys file if it has been converted from p2k
+	{
 		Utils::FileSystem::removeFile(p2kConv);
+		KeyMappingCache::invalidate(p2kConv);
+	}
 
 	Scripting::fireEvent("game-end");
+
+	RetroAchievements::invalidateProgress();
 	
 	if (!hideWindow && Settings::getInstance()->getBool("HideWindowFullReinit"))
 	{
@@ -742,10 +856,10 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 
 bool FileData::hasContentFiles()
 {
-	if (mPath.empty())
+	if (mDirectory == nullptr)
 		return false;
 
-	std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(mPath));
+	std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(mLeafName));
 	if (ext == ".m3u" || ext == ".cue" || ext == ".ccd" || ext == ".gdi")
 		return getSourceFileData()->getSystemEnvData()->isValidExtension(ext) && getSourceFileData()->getSystemEnvData()->mSearchExtensions.size() > 1;
 
@@ -795,86 +909,119 @@ static std::vector<std::string> getTokens(const std::string& string)
 	return tokens;
 }
 
-std::set<std::string> FileData::getContentFiles()
+std::mutex FileData::sContentFilesLock;
+std::unordered_map<std::string, FileData::ContentFiles> FileData::sContentFiles;
+
+std::set<std::string> FileData::readContentFiles(const std::string& fullPath, const std::string& ext)
 {
 	std::set<std::string> files;
 
-	if (mPath.empty())
-		return files;
+	auto path = Utils::FileSystem::getParent(fullPath);
 
-	if (Utils::FileSystem::isDirectory(mPath))
+	if (ext == ".cue")
 	{
-		for (auto file : Utils::FileSystem::getDirContent(mPath, true, true))
-			files.insert(file);
-	}
-	else if (hasContentFiles())
-	{
-		auto path = Utils::FileSystem::getParent(mPath);
-		auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(mPath));
+		std::string start = "FILE";
 
-		if (ext == ".cue")
+		std::ifstream cue(WINSTRINGW(fullPath));
+		if (cue && cue.is_open())
 		{
-			std::string start = "FILE";
-
-			std::ifstream cue(WINSTRINGW(mPath));
-			if (cue && cue.is_open())
+			std::string line;
+			while (std::getline(cue, line))
 			{
-				std::string line;
-				while (std::getline(cue, line))
-				{
-					if (!Utils::String::startsWith(line, start))
-						continue;
-
-					auto tokens = getTokens(line);
-					if (tokens.size() > 1)
-						files.insert(path + "/" + tokens[1]);
-				}
+				if (!Utils::String::startsWith(line, start))
+					continue;
 
-				cue.close();
+				auto tokens = getTokens(line);
+				if (tokens.size() > 1)
+					files.insert(path + "/" + tokens[1]);
 			}
+
+			cue.close();
 		}
-		else if (ext == ".ccd")
-		{
-			std::string stem = Utils::FileSystem::getStem(mPath);
-			files.insert(path + "/" + stem + ".cue");
-			files.insert(path + "/" + stem + ".img");
-			files.insert(path + "/" + stem + ".bin");
-			files.insert(path + "/" + stem + ".sub");
-		}
-		else if (ext == ".m3u")
+	}
+	else if (ext == ".ccd")
+	{
+		std::string stem = Utils::FileSystem::getStem(fullPath);
+		files.insert(path + "/" + stem + ".cue");
+		files.insert(path + "/" + stem + ".img");
+		files.insert(path + "/" + stem + ".bin");
+		files.insert(path + "/" + stem + ".sub");
+	}
+	else if (ext == ".m3u")
+	{
+		std::ifstream m3u(WINSTRINGW(fullPath));
+		if (m3u && m3u.is_open())
 		{
-			std::ifstream m3u(WINSTRINGW(mPath));
-			if (m3u && m3u.is_open())
+			std::string line;
+			while (std::getline(m3u, line))
 			{
-				std::string line;
-				while (std::getline(m3u, line))
-				{
-					auto trim = Utils::String::trim(line);
-					if (trim[0] == '#' || trim[0] == '\\' || trim[0] == '/')
-						continue;
-
-					files.insert(path + "/" + trim);
-				}
+				auto trim = Utils::String::trim(line);
+				if (trim[0] == '#' || trim[0] == '\\' || trim[0] == '/')
+					continue;
 
-				m3u.close();
+				files.insert(path + "/" + trim);
 			}
+
+			m3u.close();
 		}
-		else if (ext == ".gdi")
+	}
+	else if (ext == ".gdi")
+	{
+		std::ifstream gdi(WINSTRINGW(fullPath));
+		if (gdi && gdi.is_open())
 		{
-			std::ifstream gdi(WINSTRINGW(mPath));
-			if (gdi && gdi.is_open())
+			std::string line;
+			while (std::getline(gdi, line))
 			{
-				std::string line;
-				while (std::getline(gdi, line))
-				{
-					auto tokens = getTokens(line);
-					if (tokens.size() > 5 && tokens[4].find(".") != std::string::npos)
-						files.insert(path + "/" + tokens[4]);
-				}
+				auto tokens = getTokens(line);
+				if (tokens.size() > 5 && tokens[4].find(".") != std::string::npos)
+					files.insert(path + "/" + tokens[4]);
+			}
+
+			gdi.close();
+		}			
+	}
+
+	return files;
+}
+
+std::set<std::string> FileData::getContentFiles()
+{
+	if (mDirectory == nullptr)
+		return std::set<std::string>();
+
+	std::string fullPath = getPath();
+
+	long long modificationTime = 0;
+	unsigned long long size = 0;
+
+	if (hasContentFiles() && Utils::FileSystem::getFileStamp(fullPath, modificationTime, size))
+	{
+		{
+			std::unique_lock<std::mutex> lock(sContentFilesLock);
 
-				gdi.close();
-			}			
+			auto it = sContentFiles.find(fullPath);
+			if (it != sContentFiles.cend() && it->second.modificationTime == modificationTime && it->second.size == size)
+				return it->second.files;
 		}
+
+		// Parsed out of the lock : the systems resolve their playlists in parallel
+		ContentFiles content;
+		content.modificationTime = modificationTime;
+		content.size = size;
+		content.files = readContentFiles(fullPath, Utils::String::toLower(Utils::FileSystem::getExtension(mLeafName)));
+
+		std::unique_lock<std::mutex> lock(sContentFilesLock);
+		sContentFiles[fullPath] = content;
+		return content.files;
+	}
+
+	std::set<std::string> files;
+
+	if (Utils::FileSystem::isDirectory(fullPath))
+	{
+		for (auto file : Utils::FileSystem::getDirContent(fullPath, true, true))
+			files.insert(file);
 	}
 
 	return files;
@@ -882,12 +1029,12 @@ std::set<std::string> FileData::getContentFiles()
 
 void FileData::deleteGameFiles()
 {
-	for (auto mdd : mMetadata.getMDD())
+	for (auto mdd : getMetadata().getMDD())
 	{
-		if (mMetadata.getType(mdd.id) != MetaDataType::MD_PATH)
+		if (getMetadata().getType(mdd.id) != MetaDataType::MD_PATH)
 			continue;
 
-		Utils::FileSystem::removeFile(mMetadata.get(mdd.id));
+		Utils::FileSystem::removeFile(getMetadata().get(mdd.id));
 	}
 
 	Utils::FileSystem::removeFile(getPath());
@@ -896,11 +1043,36 @@ void FileData::deleteGameFiles()
 		Utils::FileSystem::removeFile(contentFile);
 }
 
+std::mutex CollectionFileData::sEntriesLock;
+std::unordered_map<FileData*, std::vector<CollectionFileData*>> CollectionFileData::sEntries;
+
 CollectionFileData::CollectionFileData(FileData* file, SystemData* system)
-	: FileData(file->getSourceFileData()->getType(), "", system)
+	: FileData(file->getSourceFileData()->getType(), system)
 {
 	mSourceFileData = file->getSourceFileData();
 	mParent = NULL;	
+
+	std::unique_lock<std::mutex> lock(sEntriesLock);
+	sEntries[mSourceFileData].push_back(this);
+}
+
+CollectionFileData* CollectionFileData::findEntry(FileData* source, FolderData* collectionRoot)
+{
+	if (source == nullptr || collectionRoot == nullptr)
+		return nullptr;
+
+	std::unique_lock<std::mutex> lock(sEntriesLock);
+
+	auto it = sEntries.find(source->getSourceFileData());
+	if (it == sEntries.cend())
+		return nullptr;
+
+	for (auto entry : it->second)
+		for (FolderData* parent = entry->getParent(); parent != nullptr; parent = parent->getParent())
+			if (parent == collectionRoot)
+				return entry;
+
+	return nullptr;
 }
 
 SystemEnvironmentData* CollectionFileData::getSystemEnvData() const
@@ -913,6 +1085,16 @@ const std::string CollectionFileData::getPath() const
 	return mSourceFileData->getPath();
 }
 
+void CollectionFileData::getPath(std::string& path) const
+{
+	mSourceFileData->getPath(path);
+}
+
+const std::string& CollectionFileData::getLeafName() const
+{
+	return mSourceFileData->getLeafName();
+}
+
 std::string CollectionFileData::getSystemName() const
 {
 	return mSourceFileData->getSystem()->getName();
@@ -925,6 +1107,19 @@ CollectionFileData::~CollectionFileData()
 		mParent->removeChild(this);
 
 	mParent = NULL;
+
+	std::unique_lock<std::mutex> lock(sEntriesLock);
+
+	auto it = sEntries.find(mSourceFileData);
+	if (it != sEntries.cend())
+	{
+		auto entry = std::find(it->second.begin(), it->second.end(), this);
+		if (entry != it->second.end())
+			it->second.erase(entry);
+
+		if (it->second.empty())
+			sEntries.erase(it);
+	}
 }
 
 std::string CollectionFileData::getKey() 
@@ -942,108 +1137,199 @@ const std::string& CollectionFileData::getName()
 	return mSourceFileData->getName();
 }
 
-const std::vector<FileData*> FolderData::getChildrenListToDisplay() 
+// Children added or removed in any folder : the display caches are rebuilt
+static std::atomic<unsigned int> sTreeGeneration(0);
+
+unsigned int FolderData::getTreeGeneration()
 {
-	std::vector<FileData*> ret;
+	return sTreeGeneration;
+}
 
-	std::string showFoldersMode = getSystem()->getFolderViewMode();
-	
-	bool showHiddenFiles = Settings::ShowHiddenFiles();
+struct FolderData::DisplayCache
+{
+	struct Entry
+	{
+		FileData* source;	// Child, or game of the flat list
+		FileData* shown;	// Same, or the unique game of a folder in "having multiple games" mode
+	};
 
-	auto shv = Settings::getInstance()->getString(getSystem()->getName() + ".ShowHiddenFiles");
-	if (shv == "1") showHiddenFiles = true;
-	else if (shv == "0") showHiddenFiles = false;
+	DisplayCache() : valid(false), treeGeneration(0), metadataGeneration(0), showHiddenFiles(false), filterKidGame(false), refactorUniqueGameFolders(false), index(nullptr), visibleValid(false) { }
 
-	bool filterKidGame = false;
+	bool getEntry(FileData* source, FileData* uniqueGame, Entry& entry) const
+	{
+		if (!showHiddenFiles && source->getHidden())
+			return false;
+
+		if (filterKidGame && source->getType() == GAME && !source->getKidGame())
+			return false;
+
+		if (hiddenExts.size() > 0 && source->getType() == GAME)
+		{
+			std::string extlow = Utils::String::toLower(Utils::FileSystem::getExtension(source->getFileName(), false));
+			if (std::find(hiddenExts.cbegin(), hiddenExts.cend(), extlow) != hiddenExts.cend())
+				return false;
+		}
+
+		entry.source = source;
+		entry.shown = source;
+
+		if (source->getType() == FOLDER && refactorUniqueGameFolders)
+		{
+			if (((FolderData*)source)->getChildren().size() == 0)
+				return false;
+
+			if (uniqueGame != nullptr)
+			{
+				if (!showHiddenFiles && uniqueGame->getHidden())
+					return false;
 
-	if (!Settings::getInstance()->getBool("ForceDisableFilters"))
+				if (filterKidGame && !uniqueGame->getKidGame())
+					return false;
+
+				entry.shown = uniqueGame;
+			}
+		}
+
+		return true;
+	}
+
+	bool			valid;
+	std::string		settings;	// Display settings & sort the entries were built for
+	unsigned int	treeGeneration;
+	unsigned int	metadataGeneration;
+
+	bool						showHiddenFiles;
+	bool						filterKidGame;
+	bool						refactorUniqueGameFolders;
+	std::vector<std::string>	hiddenExts;
+
+	std::vector<FileData*>	sources;		// All the candidates
+	std::vector<FileData*>	uniqueGames;	// Unique game of the folder sources, by source
+	std::vector<Entry>		entries;		// Displayable ones without the filters, in ascending sort order
+
+	// Last filtered result, as indexes of entries
+	FileFilterIndex*				index;
+	FileFilterIndex::FilterState	filter;
+	std::vector<unsigned int>		visible;
+	bool							visibleValid;
+};
+
+void FolderData::buildDisplayCache(DisplayCache& cache, SystemData* sys, const std::string& showFoldersMode)
+{
+	cache.sources.clear();
+	cache.uniqueGames.clear();
+	cache.entries.clear();
+	cache.visibleValid = false;
+
+	if (showFoldersMode == "never")
+		cache.sources = getFlatGameList(false, sys);
+	else
+		cache.sources = mChildren;
+
+	cache.uniqueGames.resize(cache.sources.size(), nullptr);
+
+	std::vector<FileData*> shown;
+
+	for (size_t i = 0; i < cache.sources.size(); i++)
 	{
-		if (UIModeController::getInstance()->isUIModeKiosk())
-			showHiddenFiles = false;
+		FileData* source = cache.sources[i];
 
-		if (UIModeController::getInstance()->isUIModeKid())
-			filterKidGame = true;
+		if (source->getType() == FOLDER && cache.refactorUniqueGameFolders)
+		{
+			FolderData* pFolder = (FolderData*)source;
+			if (pFolder->getChildren().size() > 0 && !(pFolder->isVirtualStorage() && pFolder->getSourceFileData()->getSystem()->isGroupChildSystem() && pFolder->getSourceFileData()->getSystem()->getName() == "windows_installers"))
+				cache.uniqueGames[i] = pFolder->findUniqueGameForFolder();
+		}
+
+		DisplayCache::Entry entry;
+		if (cache.getEntry(source, cache.uniqueGames[i], entry))
+		{
+			cache.entries.push_back(entry);
+			shown.push_back(entry.shown);
+		}
 	}
 
-	auto sys = CollectionSystemManager::get()->getSystemToView(mSystem);
+	// The sort is made on the shown files, then the entries follow the same order
+	unsigned int currentSortId = sys->getSortId();
+	if (currentSortId > FileSorts::getSortTypes().size())
+		currentSortId = 0;
 
-	std::vector<std::string> hiddenExts;
-	if (mSystem->isGameSystem() && !mSystem->isCollection())
-		hiddenExts = Utils::String::split(Utils::String::toLower(Settings::getInstance()->getString(mSystem->getName() + ".HiddenExt")), ';');
+	FileSorts::sortFiles(shown, FileSorts::getSortTypes().at(currentSortId));
 
-	FileFilterIndex* idx = sys->getIndex(false);
-	if (idx != nullptr && !idx->isFiltered())
-		idx = nullptr;
+	std::unordered_map<FileData*, std::vector<DisplayCache::Entry>> entriesByShown;
+	for (auto& entry : cache.entries)
+		entriesByShown[entry.shown].push_back(entry);
 
-  	std::vector<FileData*>* items = &mChildren;
-	
-	std::vector<FileData*> flatGameList;
-	if (showFoldersMode == "never")
+	cache.entries.clear();
+
+	for (auto file : shown)
 	{
-		flatGameList = getFlatGameList(false, sys);
-		items = &flatGameList;		
+		auto& entries = entriesByShown[file];
+		cache.entries.push_back(entries.back());
+		entries.pop_back();
 	}
+}
 
-	std::map<FileData*, int> scoringBoard;
+void FolderData::updateDisplayCache(DisplayCache& cache, const MetaDataList* changed, const FileSorts::SortType& sort)
+{
+	cache.visibleValid = false;
 
-	bool refactorUniqueGameFolders = (showFoldersMode == "having multiple games");
+	auto compf = sort.comparisonFunction;
 
-	for (auto it = items->cbegin(); it != items->cend(); it++)
+	for (size_t i = 0; i < cache.sources.size(); i++)
 	{
-		if (!showHiddenFiles && (*it)->getHidden())
-			continue;
+		FileData* source = cache.sources[i];
+		FileData* uniqueGame = cache.uniqueGames[i];
 
-		if (filterKidGame && (*it)->getType() == GAME && !(*it)->getKidGame())
+		if (&source->getMetadata() != changed && (uniqueGame == nullptr || &uniqueGame->getMetadata() != changed))
 			continue;
 
-		if (hiddenExts.size() > 0 && (*it)->getType() == GAME)
+		for (auto it = cache.entries.begin(); it != cache.entries.end(); it++)
 		{
-			std::string extlow = Utils::String::toLower(Utils::FileSystem::getExtension((*it)->getFileName(), false));
-			if (std::find(hiddenExts.cbegin(), hiddenExts.cend(), extlow) != hiddenExts.cend())
-				continue;
+			if (it->source == source)
+			{
+				cache.entries.erase(it);
+				break;
+			}
 		}
 
-		if (idx != nullptr)
-		{
-			int score = idx->showFile(*it);
-			if (score == 0)
-				continue;
+		DisplayCache::Entry entry;
+		if (!cache.getEntry(source, uniqueGame, entry))
+			continue;
 
-			scoringBoard[*it] = score;
-		}
+		auto pos = std::upper_bound(cache.entries.begin(), cache.entries.end(), entry, [compf](const DisplayCache::Entry& a, const DisplayCache::Entry& b) { return compf(a.shown, b.shown); });
+		cache.entries.insert(pos, entry);
+	}
+}
 
-		if ((*it)->getType() == FOLDER && refactorUniqueGameFolders)
-		{
-			FolderData* pFolder = (FolderData*)(*it);
-			if (pFolder->getChildren().size() == 0)
-				continue;
+const std::vector<FileData*> FolderData::getChildrenListToDisplay() 
+{
+	std::vector<FileData*> ret;
 
-			if (pFolder->isVirtualStorage() && pFolder->getSourceFileData()->getSystem()->isGroupChildSystem() && pFolder->getSourceFileData()->getSystem()->getName() == "windows_installers")
-			{
-				ret.push_back(*it);
-				continue;
-			}
+	std::string showFoldersMode = getSystem()->getFolderViewMode();
+	
+	bool showHiddenFiles = getSystem()->getShowHiddenFiles();
 
-			auto fd = pFolder->findUniqueGameForFolder();
-			if (fd != nullptr)
-			{
-				if (idx != nullptr && !idx->showFile(fd))
-					continue;
+	bool filterKidGame = false;
 
-				if (!showHiddenFiles && fd->getHidden())
-					continue;
+	if (!Settings::get(BoolSetting::ForceDisableFilters))
+	{
+		if (UIModeController::getInstance()->isUIModeKiosk())
+			showHiddenFiles = false;
 
-				if (filterKidGame && !fd->getKidGame())
-					continue;
+		if (UIModeController::getInstance()->isUIModeKid())
+			filterKidGame = true;
+	}
 
-				ret.push_back(fd);
+	auto sys = CollectionSystemManager::get()->getSystemToView(mSystem);
 
-				continue;
-			}
-		}
+	std::string hiddenExts;
+	if (mSystem->isGameSystem() && !mSystem->isCollection())
+		hiddenExts = mSystem->getHiddenExtensions();
 
-		ret.push_back(*it);
-	}
+	FileFilterIndex* idx = sys->getIndex(false);
+	if (idx != nullptr && !idx->isFiltered())
+		idx = nullptr;
 
 	unsigned int currentSortId = sys->getSortId();
 	if (currentSortId > FileSorts::getSortTypes().size())
@@ -1051,29 +1337,90 @@ const std::vector<FileData*> FolderData::getChildrenListToDisplay()
 
 	const FileSorts::SortType& sort = FileSorts::getSortTypes().at(currentSortId);
 
-	if (idx != nullptr && idx->hasRelevency())
+	// The entries are kept until the tree, the metadata or one of these change
+	std::string settings = showFoldersMode + "|" + std::to_string(currentSortId) + "|" + std::to_string((unsigned long long)sys) + "|" + hiddenExts + "|" +
+		(showHiddenFiles ? "1" : "0") + (filterKidGame ? "1" : "0") + (Settings::ShowFoldersFirst() ? "1" : "0") + (Settings::IgnoreLeadingArticles() ? "1" : "0");
+
+	if (mDisplayCache == nullptr)
+		mDisplayCache = new DisplayCache();
+
+	DisplayCache& cache = *mDisplayCache;
+
+	unsigned int treeGeneration = sTreeGeneration;
+	unsigned int metadataGeneration = MetaDataList::getChangeGeneration();
+
+	if (!cache.valid || cache.settings != settings || cache.treeGeneration != treeGeneration)
 	{
-		auto compf = sort.comparisonFunction;
+		cache.valid = true;
+		cache.settings = settings;
+		cache.showHiddenFiles = showHiddenFiles;
+		cache.filterKidGame = filterKidGame;
+		cache.refactorUniqueGameFolders = (showFoldersMode == "having multiple games");
+		cache.hiddenExts = Utils::String::split(hiddenExts, ';');
+
+		buildDisplayCache(cache, sys, showFoldersMode);
+	}
+	else if (cache.metadataGeneration != metadataGeneration)
+	{
+		// A single game edited since : only its entry moves to its new sorted position
+		const MetaDataList* changed = MetaDataList::getSingleChangedListSince(cache.metadataGeneration);
+		if (changed != nullptr)
+			updateDisplayCache(cache, changed, sort);
+		else
+			buildDisplayCache(cache, sys, showFoldersMode);
+	}
+
+	cache.treeGeneration = treeGeneration;
+	cache.metadataGeneration = metadataGeneration;
 
-		std::sort(ret.begin(), ret.end(), [scoringBoard, compf](const FileData* file1, const FileData* file2) -> bool
-		{ 
-			auto s1 = scoringBoard.find((FileData*) file1);
-			auto s2 = scoringBoard.find((FileData*) file2);		
+	// Narrowed filters only have to check the entries shown for the previous ones
+	std::map<FileData*, int> scoringBoard;
+	std::vector<unsigned int> visible;
 
-			if (s1 != scoringBoard.cend() && s2 != scoringBoard.cend() && s1->second != s2->second)
-				return s1->second < s2->second;
-			
-			return compf(file1, file2);
-		});
+	if (idx == nullptr)
+	{
+		cache.visibleValid = false;
+
+		for (auto& entry : cache.entries)
+			ret.push_back(entry.shown);
 	}
 	else
 	{
-		std::sort(ret.begin(), ret.end(), sort.comparisonFunction);
+		FileFilterIndex::FilterState filter;
+		idx->getFilterState(filter);
+
+		bool narrowing = cache.visibleValid && cache.index == idx && FileFilterIndex::isNarrowing(cache.filter, filter);
+
+		size_t count = narrowing ? cache.visible.size() : cache.entries.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			unsigned int pos = narrowing ? cache.visible[i] : (unsigned int)i;
+			const DisplayCache::Entry& entry = cache.entries[pos];
+
+			int score = idx->showFile(entry.source);
+			if (score == 0)
+				continue;
+
+			scoringBoard[entry.source] = score;
+
+			if (entry.shown != entry.source && !idx->showFile(entry.shown))
+				continue;
+
+			visible.push_back(pos);
+			ret.push_back(entry.shown);
+		}
 
-		if (!sort.ascending)
-			std::reverse(ret.begin(), ret.end());
+		cache.index = idx;
+		cache.filter = filter;
+		cache.visible = visible;
+		cache.visibleValid = true;
 	}
 
+	if (idx != nullptr && idx->hasRelevency())
+		FileSorts::sortFiles(ret, sort, &scoringBoard);
+	else if (!sort.ascending)
+		std::reverse(ret.begin(), ret.end());
+
 	return ret;
 }
 
@@ -1116,13 +1463,7 @@ FileData* FolderData::findUniqueGameForFolder()
 	{
 		if (game->getHidden())
 		{
-			bool showHiddenFiles = Settings::ShowHiddenFiles() && !UIModeController::getInstance()->isUIModeKiosk();
-
-			auto shv = Settings::getInstance()->getString(getSystem()->getName() + ".ShowHiddenFiles");
-			if (shv == "1") showHiddenFiles = true;
-			else if (shv == "0") showHiddenFiles = false;
-
-			if (!showHiddenFiles)
+			if (!getSystem()->getShowHiddenFiles(true))
 				continue;
 		}
 
@@ -1217,17 +1558,11 @@ std::vector<FileData*> FolderData::getFilesRecursive(unsigned int typeMask, bool
 	SystemData* pSystem = (system != nullptr ? system : mSystem);
 	
 	GetFileContext ctx;
-	ctx.showHiddenFiles = Settings::ShowHiddenFiles() && !UIModeController::getInstance()->isUIModeKiosk();
-
-	auto shv = Settings::getInstance()->getString(getSystem()->getName() + ".ShowHiddenFiles");
-	if (shv == "1")
-		ctx.showHiddenFiles = true;
-	else if (shv == "0")
-		ctx.showHiddenFiles = false;
+	ctx.showHiddenFiles = getSystem()->getShowHiddenFiles(true);
 
 	if (pSystem->isGameSystem() && !pSystem->isCollection())
 	{
-		for (auto ext : Utils::String::split(Utils::String::toLower(Settings::getInstance()->getString(pSystem->getName() + ".HiddenExt")), ';'))
+		for (auto ext : Utils::String::split(pSystem->getHiddenExtensions(), ';'))
 			if (ctx.hiddenExtensions.find(ext) == ctx.hiddenExtensions.cend())
 				ctx.hiddenExtensions.insert(ext);
 	}
@@ -1246,6 +1581,7 @@ void FolderData::addChild(FileData* file, bool assignParent)
 #endif
 
 	mChildren.push_back(file);
+	sTreeGeneration++;
 
 	if (assignParent)
 		file->setParent(this);	
@@ -1264,6 +1600,7 @@ void FolderData::removeChild(FileData* file)
 		{
 			file->setParent(NULL);
 			mChildren.erase(it);
+			sTreeGeneration++;
 			return;
 		}
 	}
@@ -1446,9 +1783,9 @@ void FileData::detectLanguageAndRegion(bool overWrite)
 
 	auto info = LangInfo::parse(getSourceFileData()->getPath(), getSourceFileData()->getSystem());
 	if (info.languages.size() > 0)
-		mMetadata.set(MetaDataId::Language, info.getLanguageString());
+		getMetadata().set(MetaDataId::Language, info.getLanguageString());
 	if (!info.region.empty())
-		mMetadata.set(MetaDataId::Region, info.region);
+		getMetadata().set(MetaDataId::Region, info.region);
 }
 
 void FolderData::removeVirtualFolders()
@@ -1537,21 +1874,53 @@ void FileData::checkCheevosHash(bool force)
 	saveToGamelistRecovery(this);
 }
 
+void FileData::checkCrc32AndCheevosHash(bool force)
+{
+	if (getSourceFileData() != this)
+	{
+		getSourceFileData()->checkCrc32AndCheevosHash(force);
+		return;
+	}
+
+	bool needsCrc32 = force || getMetadata(MetaDataId::Crc32).empty();
+	bool needsCheevosHash = force || getMetadata(MetaDataId::CheevosHash).empty();
+
+	SystemData* system = getSystem();
+	if (system != nullptr && needsCrc32 && needsCheevosHash && RetroAchievements::isCheevosHashMd5(system))
+	{
+		std::string crc, md5;
+		if (ApiSystem::getInstance()->getCRC32AndMD5(getPath(), system->shouldExtractHashesFromArchives(), crc, md5))
+		{
+			getMetadata().set(MetaDataId::Crc32, Utils::String::toUpper(crc));
+			getMetadata().set(MetaDataId::CheevosHash, Utils::String::toUpper(md5));
+			saveToGamelistRecovery(this);
+			return;
+		}
+	}
+
+	checkCrc32(force);
+	checkCheevosHash(force);
+}
+
 std::string FileData::getKeyboardMappingFilePath()
 {
-	if (Utils::FileSystem::isDirectory(getSourceFileData()->getPath()))
+	if (KeyMappingCache::isDirectory(getSourceFileData()->getPath()))
 		return getSourceFileData()->getPath() + "/padto.keys";
 
 	return getSourceFileData()->getPath() + ".keys";
 }
 
-bool FileData::hasP2kFile()
+std::string FileData::getP2kFilePath()
 {
-	std::string p2kPath = getSourceFileData()->getPath() + ".p2k.cfg";
-	if (Utils::FileSystem::isDirectory(getSourceFileData()->getPath()))
-		p2kPath = getSourceFileData()->getPath() + "/.p2k.cfg";
+	if (KeyMappingCache::isDirectory(getSourceFileData()->getPath()))
+		return getSourceFileData()->getPath() + "/.p2k.cfg";
 
-	return Utils::FileSystem::exists(p2kPath);
+	return getSourceFileData()->getPath() + ".p2k.cfg";
+}
+
+bool FileData::hasP2kFile()
+{
+	return KeyMappingCache::exists(getP2kFilePath());
 }
 
 void FileData::importP2k(const std::string& p2k)
@@ -1559,31 +1928,29 @@ void FileData::importP2k(const std::string& p2k)
 	if (p2k.empty())
 		return;
 
-	std::string p2kPath = getSourceFileData()->getPath() + ".p2k.cfg";
-	if (Utils::FileSystem::isDirectory(getSourceFileData()->getPath()))
-		p2kPath = getSourceFileData()->getPath() + "/.p2k.cfg";
-
+	std::string p2kPath = getP2kFilePath();
 	Utils::FileSystem::writeAllText(p2kPath, p2k);
+	KeyMappingCache::invalidate(p2kPath);
 
 	std::string keysPath = getKeyboardMappingFilePath();
-	if (Utils::FileSystem::exists(keysPath))
+	if (KeyMappingCache::exists(keysPath))
+	{
 		Utils::FileSystem::removeFile(keysPath);
+		KeyMappingCache::invalidate(keysPath);
+	}
 }
 
 std::string FileData::convertP2kFile()
 {
-	std::string p2kPath = getSourceFileData()->getPath() + ".p2k.cfg";
-	if (Utils::FileSystem::isDirectory(getSourceFileData()->getPath()))
-		p2kPath = getSourceFileData()->getPath() + "/.p2k.cfg";
-
-	if (!Utils::FileSystem::exists(p2kPath))
+	std::string p2kPath = getP2kFilePath();
+	if (!KeyMappingCache::exists(p2kPath))
 		return "";
 
 	std::string keysPath = getKeyboardMappingFilePath();
-	if (Utils::FileSystem::exists(keysPath))
+	if (KeyMappingCache::exists(keysPath))
 		return "";
 
-	auto map = KeyMappingFile::fromP2k(p2kPath);
+	auto map = KeyMappingCache::fromP2k(p2kPath);
 	if (map.isValid())
 	{
 		map.save(keysPath);
@@ -1595,7 +1962,7 @@ std::string FileData::convertP2kFile()
 
 bool FileData::hasKeyboardMapping()
 {
-	if (!Utils::FileSystem::exists(getKeyboardMappingFilePath()))
+	if (!KeyMappingCache::exists(getKeyboardMappingFilePath()))
 		return hasP2kFile();
 
 	return true;
@@ -1607,17 +1974,18 @@ KeyMappingFile FileData::getKeyboardMapping()
 	auto path = getKeyboardMappingFilePath();
 
 	// If pk2.cfg file but no .keys file, then convert & load
-	if (!Utils::FileSystem::exists(path) && hasP2kFile())
+	if (!KeyMappingCache::exists(path) && hasP2kFile())
 	{
 		convertP2kFile();
 
-		ret = KeyMappingFile::load(path);
+		ret = KeyMappingCache::load(path);
 		Utils::FileSystem::removeFile(path);
+		KeyMappingCache::invalidate(path);
 		return ret;
 	}
 		
-	if (Utils::FileSystem::exists(path))
-		ret = KeyMappingFile::load(path);
+	if (KeyMappingCache::exists(path))
+		ret = KeyMappingCache::load(path);
 	else
 		ret = getSystem()->getKeyboardMapping(); // if .keys file does not exist, take system config as predefined mapping
 
@@ -1664,39 +2032,50 @@ FolderData::FolderData(const std::string& startpath, SystemData* system, bool ow
 {
 	mIsDisplayableAsVirtualFolder = false;
 	mOwnsChildrens = ownsChildrens;
+	mDisplayCache = nullptr;
 }
 
 FolderData::~FolderData()
 {
 	clear();
+
+	if (mDisplayCache != nullptr)
+		delete mDisplayCache;
 }
 
 void FolderData::clear()
 {
 	if (mOwnsChildrens)
 	{
+		// Detached first, so the destructors don't look for themselves in the children
 		for (int i = mChildren.size() - 1; i >= 0; i--)
-			delete mChildren.at(i);
+		{
+			FileData* child = mChildren.at(i);
+			if (child->getParent() == this)
+				child->setParent(nullptr);
+
+			delete child;
+		}
 	}
 
 	mChildren.clear();
+	sTreeGeneration++;
 }
 
 void FolderData::removeFromVirtualFolders(FileData* game)
 {
 	for (auto it = mChildren.begin(); it != mChildren.end(); ++it) 
 	{		
-		if ((*it)->getType() == FOLDER)
-		{
-			((FolderData*)(*it))->removeFromVirtualFolders(game);
-			continue;
-		}
-
+		// game can also be a folder, shared with a group system
 		if ((*it) == game)
 		{
 			mChildren.erase(it);
+			sTreeGeneration++;
 			return;
 		}
+
+		if ((*it)->getType() == FOLDER)
+			((FolderData*)(*it))->removeFromVirtualFolders(game);
 	}
 }
 
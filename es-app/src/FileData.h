@@ -6,6 +6,7 @@
 #include "MetaData.h"
 #include <unordered_map>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <stack>
 #include "KeyboardMapping.h"
@@ -14,6 +15,7 @@
 
 class Window;
 struct SystemEnvironmentData;
+namespace FileSorts { struct SortType; }
 
 
 enum FileType
@@ -77,6 +79,12 @@ public:
 	FileData(FileType type, const std::string& path, SystemData* system);
 	virtual ~FileData();
 
+	// Tree nodes are allocated in the arena of their system : new (system) FileData(...). Nodes outside the trees ( placeholders ) use the heap
+	static void* operator new(size_t size);
+	static void* operator new(size_t size, SystemData* system);
+	static void operator delete(void* ptr);
+	static void operator delete(void* ptr, SystemData* system);
+
 	static FileData* GetRunningGame() { return mRunningGame; }
 
 	virtual const std::string& getName();
@@ -89,6 +97,8 @@ public:
 	inline SystemData* getSystem() const { return mSystem; }
 
 	virtual const std::string getPath() const;
+	virtual void getPath(std::string& path) const; // Composes the path into a buffer of the caller, which can be reused across the files
+	virtual const std::string& getLeafName() const; // File name, without composing the path
 	const std::string getBreadCrumbPath();
 
 	virtual SystemEnvironmentData* getSystemEnvData() const;
@@ -124,7 +134,7 @@ public:
 	const bool isLightGunGame();
   	const bool isWheelGame();
 	inline std::string getFullPath() { return getPath(); };
-	inline std::string getFileName() { return Utils::FileSystem::getFileName(getPath()); };
+	inline std::string getFileName() { return getLeafName(); };
 	virtual FileData* getSourceFileData();
 	virtual std::string getSystemName() const;
 
@@ -141,8 +151,8 @@ public:
 
 	static void resetSettings();
 	
-	virtual const MetaDataList& getMetadata() const { return mMetadata; }
-	virtual MetaDataList& getMetadata() { return mMetadata; }
+	virtual const MetaDataList& getMetadata() const;
+	virtual MetaDataList& getMetadata();
 
 	void setMetadata(MetaDataList value) { getMetadata() = value; } 
 	
@@ -156,6 +166,7 @@ public:
 	void checkCrc32(bool force = false);
 	void checkMd5(bool force = false);
 	void checkCheevosHash(bool force = false);
+	void checkCrc32AndCheevosHash(bool force = false); // Both in a single read of the file when the cheevos hash is its md5
 
 	void importP2k(const std::string& p2k);
 	std::string convertP2kFile();
@@ -179,16 +190,35 @@ public:
 
 private:
 	std::string getKeyboardMappingFilePath();
+	std::string getP2kFilePath();
 	std::string getMessageFromExitCode(int exitCode);
-	MetaDataList mMetadata;
+
+	// The tracks & discs of a playlist, parsed again when its size or modification time changes
+	struct ContentFiles
+	{
+		long long				modificationTime;
+		unsigned long long		size;
+		std::set<std::string>	files;
+	};
+
+	static std::set<std::string> readContentFiles(const std::string& fullPath, const std::string& ext);
+
+	static std::mutex sContentFilesLock;
+	static std::unordered_map<std::string, ContentFiles> sContentFiles;
+
+	MetaDataList* mMetadata; // nullptr for the collection entries, which use the one of their source
 
 protected:	
+	// Collection entries : no path nor metadata of their own
+	FileData(FileType type, SystemData* system);
+
 	std::string  findLocalArt(const std::string& type = "", std::vector<std::string> exts = { ".png", ".jpg" });
 
 	static FileData* mRunningGame;
 
 	FolderData* mParent;
-	std::string mPath;
+	const std::string* mDirectory; // Interned, shared by the files of the folder. Includes the separator, nullptr without path
+	std::string mLeafName;
 	FileType mType;
 	SystemData* mSystem;
 	std::string* mDisplayName;
@@ -203,6 +233,8 @@ public:
 	FileData* getSourceFileData();
 	std::string getKey();
 	virtual const std::string getPath() const;
+	virtual void getPath(std::string& path) const;
+	virtual const std::string& getLeafName() const;
 
 	virtual std::string getSystemName() const;
 	virtual SystemEnvironmentData* getSystemEnvData() const;
@@ -211,9 +243,16 @@ public:
 	virtual MetaDataList& getMetadata() { return mSourceFileData->getMetadata(); }
 	virtual std::string& getDisplayName() { return mSourceFileData->getDisplayName(); }
 
+	// Entry of the source file in the tree of the collection root, nullptr when it's not in. Replaces the path searches in the collection trees
+	static CollectionFileData* findEntry(FileData* source, FolderData* collectionRoot);
+
 private:
 	// needs to be updated when metadata changes
 	FileData* mSourceFileData;
+
+	// Entries by source file, kept by the constructor & destructor ( collections are populated on pools )
+	static std::mutex sEntriesLock;
+	static std::unordered_map<FileData*, std::vector<CollectionFileData*>> sEntries;
 };
 
 class FolderData : public FileData
@@ -251,13 +290,21 @@ public:
 	void removeVirtualFolders();
 	void removeFromVirtualFolders(FileData* game);
 
+	// Counts the children added or removed in any folder
+	static unsigned int getTreeGeneration();
+
 private:
 	void getFilesRecursiveWithContext(std::vector<FileData*>& out, unsigned int typeMask, GetFileContext* filter, bool displayedOnly, SystemData* system, bool includeVirtualStorage) const;
 
+	// Sorted displayable children & last filtered result of getChildrenListToDisplay
+	struct DisplayCache;
+	void buildDisplayCache(DisplayCache& cache, SystemData* sys, const std::string& showFoldersMode);
+	void updateDisplayCache(DisplayCache& cache, const MetaDataList* changed, const FileSorts::SortType& sort);
 
 	std::vector<FileData*> mChildren;
 	bool	mOwnsChildrens;
 	bool	mIsDisplayableAsVirtualFolder;
+	DisplayCache* mDisplayCache;
 };
 
 #endif // ES_APP_FILE_DATA_H
@@ -0,0 +1,129 @@
+#include "FileDataArena.h"
+
+#include "MemoryStats.h"
+
+#include <new>
+#include <cstdlib>
+
+#define ARENA_CHUNK_SIZE		(256 * 1024)
+#define ARENA_ALIGNMENT			16
+#define ARENA_MAX_BLOCK_SIZE	1024
+
+// Every block starts with its arena ( nullptr for the nodes allocated on the heap ) and its size class ( its size on the heap ), so it can be freed from the pointer only
+struct BlockHeader
+{
+	FileDataArena* arena;
+	size_t sizeClass;
+};
+
+#define HEADER_SIZE (((sizeof(BlockHeader) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT) * ARENA_ALIGNMENT)
+
+FileDataArena::FileDataArena() : mCurrent(nullptr), mAvailable(0), mLiveCount(0), mReleased(false)
+{
+	mFreeLists.resize(ARENA_MAX_BLOCK_SIZE / ARENA_ALIGNMENT + 1, nullptr);
+}
+
+FileDataArena::~FileDataArena()
+{
+	for (auto chunk : mChunks)
+		free(chunk);
+
+	MemoryStats::add(MemoryStats::FILE_DATA, -(int64_t)(mChunks.size() * ARENA_CHUNK_SIZE));
+}
+
+void* FileDataArena::allocate(FileDataArena* arena, size_t size)
+{
+	size_t sizeClass = (size + HEADER_SIZE + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT;
+	size_t blockSize = sizeClass * ARENA_ALIGNMENT;
+
+	BlockHeader* header = nullptr;
+
+	if (arena == nullptr || blockSize > ARENA_MAX_BLOCK_SIZE)
+	{
+		header = (BlockHeader*)malloc(blockSize);
+		if (header == nullptr)
+			throw std::bad_alloc();
+
+		header->arena = nullptr;
+		header->sizeClass = blockSize;
+		MemoryStats::add(MemoryStats::FILE_DATA, blockSize);
+		return (char*)header + HEADER_SIZE;
+	}
+
+	std::unique_lock<std::mutex> lock(arena->mLock);
+
+	FreeBlock* block = arena->mFreeLists[sizeClass];
+	if (block != nullptr)
+	{
+		arena->mFreeLists[sizeClass] = block->next;
+		header = (BlockHeader*)block;
+	}
+	else
+	{
+		if (arena->mAvailable < blockSize)
+		{
+			char* chunk = (char*)malloc(ARENA_CHUNK_SIZE);
+			if (chunk == nullptr)
+				throw std::bad_alloc();
+
+			arena->mChunks.push_back(chunk);
+			arena->mCurrent = chunk;
+			arena->mAvailable = ARENA_CHUNK_SIZE;
+
+			MemoryStats::add(MemoryStats::FILE_DATA, ARENA_CHUNK_SIZE);
+		}
+
+		header = (BlockHeader*)arena->mCurrent;
+		arena->mCurrent += blockSize;
+		arena->mAvailable -= blockSize;
+	}
+
+	header->arena = arena;
+	header->sizeClass = sizeClass;
+	arena->mLiveCount++;
+
+	return (char*)header + HEADER_SIZE;
+}
+
+void FileDataArena::deallocate(void* ptr)
+{
+	if (ptr == nullptr)
+		return;
+
+	BlockHeader* header = (BlockHeader*)((char*)ptr - HEADER_SIZE);
+
+	FileDataArena* arena = header->arena;
+	if (arena == nullptr)
+	{
+		MemoryStats::add(MemoryStats::FILE_DATA, -(int64_t)header->sizeClass);
+		free(header);
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(arena->mLock);
+
+	size_t sizeClass = header->sizeClass;
+
+	FreeBlock* block = (FreeBlock*)header;
+	block->next = arena->mFreeLists[sizeClass];
+	arena->mFreeLists[sizeClass] = block;
+
+	arena->mLiveCount--;
+	if (arena->mLiveCount == 0 && arena->mReleased)
+	{
+		lock.unlock();
+		delete arena;
+	}
+}
+
+void FileDataArena::release()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	mReleased = true;
+	if (mLiveCount != 0)
+		return;
+
+	lock.unlock();
+	delete this;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#ifndef ES_APP_FILE_DATA_ARENA_H
+#define ES_APP_FILE_DATA_ARENA_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Storage of the tree nodes of a system ( FileData, FolderData, CollectionFileData ) : the nodes are carved in large chunks, one free list per size,
+// so a system of 100k games is a few hundred allocations that sit together in memory, and its teardown frees the chunks instead of every node.
+// The system releases its arena when it's deleted. A node still alive at that point keeps the chunks until it's deleted itself
+class FileDataArena
+{
+public:
+	FileDataArena();
+
+	// arena can be nullptr : the block is allocated on the heap
+	static void* allocate(FileDataArena* arena, size_t size);
+	static void deallocate(void* ptr);
+
+	void release();
+
+private:
+	~FileDataArena();
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	std::mutex mLock;
+	std::vector<char*> mChunks;
+	char* mCurrent;
+	size_t mAvailable;
+	std::vector<FreeBlock*> mFreeLists; // By size class
+	size_t mLiveCount;
+	bool mReleased;
+};
+
+#endif // ES_APP_FILE_DATA_ARENA_H
@@ -15,12 +15,16 @@
 #include "Genres.h"
 #include "SystemConf.h"
 
+#include <algorithm>
+
 #define UNKNOWN_LABEL "UNKNOWN"
 #define INCLUDE_UNKNOWN false;
 
 FileFilterIndex::FileFilterIndex()
 	: filterByFavorites(false), filterByGenre(false), filterByKidGame(false), filterByPlayers(false), filterByPubDev(false), filterByRatings(false), filterByYear(false)
 	, filterByLightGun(false), filterByWheel(false), filterByVertical(false), filterByCheevos(false), filterByPlayed(false), filterByRegion(false), filterByLang(false), filterByFamily(false), filterByHasMedia(false)
+	, mNextOrdinal(0), mIndexedMatchValid(false), mTextIndexBuilt(false), mTextCandidatesAll(false), mTextCandidatesValid(false)
+	, mTextCandidatesRelevancy(false), mTextCandidatesChinese(false)
 {
 	clearAllFilters();
 	FilterDataDecl filterDecls[] = 
@@ -190,6 +194,8 @@ void FileFilterIndex::resetIndex()
 	manageIndexEntry(&ratingsIndexAllKeys, "3 STARS", false);
 	manageIndexEntry(&ratingsIndexAllKeys, "4 STARS", false);
 	manageIndexEntry(&ratingsIndexAllKeys, "5 STARS", false);
+
+	resetInvertedIndex();
 }
 
 std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType type, bool getSecondary)
@@ -378,6 +384,8 @@ void FileFilterIndex::addToIndex(FileData* game)
 	manageYearEntryInIndex(game);
 	manageLangEntryInIndex(game);
 	manageRegionEntryInIndex(game);		
+
+	addToInvertedIndex(game);
 }
 
 void FileFilterIndex::removeFromIndex(FileData* game)
@@ -389,6 +397,8 @@ void FileFilterIndex::removeFromIndex(FileData* game)
 	manageYearEntryInIndex(game, true);
 	manageLangEntryInIndex(game, true);
 	manageRegionEntryInIndex(game, true);	
+
+	removeFromInvertedIndex(game);
 }
 
 void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>* values)
@@ -452,7 +462,7 @@ void FileFilterIndex::resetFilters()
 
 void FileFilterIndex::setUIModeFilters()
 {
-	if (Settings::getInstance()->getBool("ForceDisableFilters"))
+	if (Settings::get(BoolSetting::ForceDisableFilters))
 		return;
 	
 	if (UIModeController::getInstance()->isUIModeKid())
@@ -469,30 +479,83 @@ void FileFilterIndex::setTextFilter(const std::string text, bool useRelevancy)
 	mUseRelevency = useRelevancy;
 }
 
-float jw_distance(std::string s1, std::string s2, bool caseSensitive = true) {
+void FileFilterIndex::getFilterState(FilterState& state)
+{
+	state.keys.clear();
+	state.systems.clear();
+
+	for (auto& it : mFilterDecl)
+		if (*(it.second.filteredByRef))
+			state.keys[it.first] = *it.second.currentFilteredKeys;
+
+	state.text = mTextFilter;
+	state.useRelevancy = mUseRelevency;
+}
+
+bool FileFilterIndex::isNarrowing(const FilterState& from, const FilterState& to)
+{
+	// A text change can show other names, only adding one narrows
+	if (to.text != from.text && !from.text.empty())
+		return false;
+
+	if (to.useRelevancy != from.useRelevancy && !from.text.empty())
+		return false;
+
+	// The keys of a type are or'ed, the types are and'ed
+	for (auto& type : from.keys)
+	{
+		auto it = to.keys.find(type.first);
+		if (it == to.keys.cend())
+			return false;
+
+		for (auto& key : it->second)
+			if (type.second.find(key) == type.second.cend())
+				return false;
+	}
+
+	if (!from.systems.empty())
+	{
+		if (to.systems.empty())
+			return false;
+
+		for (auto& system : to.systems)
+			if (from.systems.find(system) == from.systems.cend())
+				return false;
+	}
+
+	return true;
+}
+
+float jw_distance(const std::string& source1, const std::string& source2, bool caseSensitive = true) {
 	float m = 0;
 	int low, high, range;
 	int k = 0, numTrans = 0;
 
 	// Exit early if either are empty
-	if (s1.length() == 0 || s2.length() == 0) {
+	if (source1.length() == 0 || source2.length() == 0) {
 		return 0;
 	}
 
 	// Convert to lower if case-sensitive is false
+	std::string lower1, lower2;
 	if (caseSensitive == false) {
-		transform(s1.begin(), s1.end(), s1.begin(), ::tolower);
-		transform(s2.begin(), s2.end(), s2.begin(), ::tolower);
+		lower1 = source1;
+		lower2 = source2;
+		transform(lower1.begin(), lower1.end(), lower1.begin(), ::tolower);
+		transform(lower2.begin(), lower2.end(), lower2.begin(), ::tolower);
 	}
 
+	const std::string& s1 = caseSensitive ? source1 : lower1;
+	const std::string& s2 = caseSensitive ? source2 : lower2;
+
 	// Exit early if they're an exact match.
 	if (s1 == s2) {
 		return 1;
 	}
 
 	range = (std::max(s1.length(), s2.length()) / 2) - 1;
-	int s1Matches[65000] = {};
-	int s2Matches[65000] = {};
+	std::vector<char> s1Matches(s1.length(), 0);
+	std::vector<char> s2Matches(s2.length(), 0);
 
 	for (int i = 0; i < s1.length(); i++) {
 
@@ -557,6 +620,64 @@ float jw_distance(std::string s1, std::string s2, bool caseSensitive = true) {
 	return weight;
 }
 
+// Words of a name for the relevancy search, lower case & without the short ones
+static std::vector<std::string> simplifyWords(const std::string& text)
+{
+	auto s = Utils::String::toLower(text);
+	s = Utils::String::replace(s, ":", "");
+	s = Utils::String::replace(s, ".", "");
+	s = Utils::String::replace(s, " - ", " ");
+	s = Utils::String::replace(s, "- ", " ");				
+
+	std::vector<std::string> ret;
+
+	for (auto v : Utils::String::split(s, ' '))
+	{
+		if (v.empty() || v.length() <= 2 || v == "and" || v == "not" || v == "for" || v == "the" || v == "les" || v == "des")
+			continue;
+
+		ret.push_back(v);
+	}
+
+	return ret;
+}
+
+unsigned long long FileFilterIndex::getFilteredFields()
+{
+	unsigned long long fields = 0;
+
+	if (!mTextFilter.empty())
+		fields |= 1ULL << MetaDataId::Name;
+
+	for (auto& it : mFilterDecl)
+	{
+		if (!(*(it.second.filteredByRef)))
+			continue;
+
+		switch (it.second.type)
+		{
+		case FAVORITES_FILTER:	fields |= 1ULL << MetaDataId::Favorite; break;
+		case GENRE_FILTER:		fields |= (1ULL << MetaDataId::Genre) | (1ULL << MetaDataId::GenreIds); break;
+		case FAMILY_FILTER:		fields |= 1ULL << MetaDataId::Family; break;
+		case PLAYER_FILTER:		fields |= 1ULL << MetaDataId::Players; break;
+		case PUBDEV_FILTER:		fields |= (1ULL << MetaDataId::Publisher) | (1ULL << MetaDataId::Developer); break;
+		case RATINGS_FILTER:	fields |= 1ULL << MetaDataId::Rating; break;
+		case YEAR_FILTER:		fields |= 1ULL << MetaDataId::ReleaseDate; break;
+		case LANG_FILTER:		fields |= 1ULL << MetaDataId::Language; break;
+		case REGION_FILTER:		fields |= 1ULL << MetaDataId::Region; break;
+		case KIDGAME_FILTER:	fields |= 1ULL << MetaDataId::KidGame; break;
+		case PLAYED_FILTER:		fields |= 1ULL << MetaDataId::PlayCount; break;
+
+		// Cheevos, vertical, lightgun, wheel & medias are not only read from a single field
+		default:
+			fields |= CHANGED_ALL;
+			break;
+		}
+	}
+
+	return fields;
+}
+
 int FileFilterIndex::showFile(FileData* game)
 {
 	// this shouldn't happen, but just in case let's get it out of the way
@@ -587,7 +708,10 @@ int FileFilterIndex::showFile(FileData* game)
 		std::string language = SystemConf::getInstance()->get("system.language");
 		bool isChinese = (language == "zh_CN" || language == "zh_TW");
 
-		if (!mUseRelevency)
+		// Names without the trigrams or words of the filter can't match
+		if (!isTextCandidate(game, name, isChinese))
+			textScore = 0;
+		else if (!mUseRelevency)
 		{
 			if (mTextFilter.find(',') == std::string::npos)
 			{
@@ -638,29 +762,8 @@ int FileFilterIndex::showFile(FileData* game)
 			}
 			else if (mTextFilter.find(' ') != std::string::npos)
 			{
-				auto simplify = [](const std::string& text)
-				{
-					auto s = Utils::String::toLower(text);
-					s = Utils::String::replace(s, ":", "");
-					s = Utils::String::replace(s, ".", "");
-					s = Utils::String::replace(s, " - ", " ");
-					s = Utils::String::replace(s, "- ", " ");				
-
-					std::vector<std::string> ret;
-
-					for (auto v : Utils::String::split(s, ' '))
-					{
-						if (v.empty() || v.length() <= 2 || v == "and" || v == "not" || v == "for" || v == "the" || v == "les" || v == "des")
-							continue;
-
-						ret.push_back(v);
-					}
-
-					return ret;
-				};
-
-				auto filters = simplify(mTextFilter);
-				auto words = simplify(name);
+				auto filters = simplifyWords(mTextFilter);
+				auto words = simplifyWords(name);
 
 				int totalWords = 0;
 				int commonWords = 0;
@@ -746,6 +849,11 @@ int FileFilterIndex::showFile(FileData* game)
 
 	bool hasFilter = false;
 
+	// All the indexed filters at once
+	int indexedMatch = matchInvertedIndex(game);
+	if (indexedMatch == 0)
+		return 0;
+
 	for (auto& it : mFilterDecl)
 	{
 		FilterDataDecl& filterData = it.second;
@@ -754,11 +862,17 @@ int FileFilterIndex::showFile(FileData* game)
 		
 		hasFilter = true;
 
+		if (indexedMatch > 0 && isInvertedIndexType(filterData.type))
+		{
+			keepGoing = true;
+			continue;
+		}
+
 		bool filterValid = false;
 
 		if (filterData.type == GENRE_FILTER)
 		{
-			for (auto val : Genres::getGenreFiltersNames(&game->getMetadata()))
+			for (auto& val : Genres::getGenreFiltersNames(&game->getMetadata()))
 			{
 				if (isKeyBeingFilteredBy(val, filterData.type))
 				{
@@ -795,30 +909,7 @@ int FileFilterIndex::showFile(FileData* game)
 			}			
 		}
 		else
-		{
-			// try to find a match
-			std::string key = getIndexableKey(game, filterData.type, false);
-
-			if (filterData.type == LANG_FILTER || filterData.type == REGION_FILTER)
-			{
-				for (auto val : Utils::String::split(key, ','))
-					if (isKeyBeingFilteredBy(val, filterData.type))
-						filterValid = true;
-			}
-			else
-				filterValid = isKeyBeingFilteredBy(key, filterData.type);
-
-			// if we didn't find a match, try for secondary keys - i.e. publisher and dev, or first genre
-			if (!filterValid)
-			{
-				if (!filterData.hasSecondaryKey)
-					return 0;
-
-				std::string secKey = getIndexableKey(game, filterData.type, true);
-				if (secKey != UNKNOWN_LABEL)
-					filterValid = isKeyBeingFilteredBy(secKey, filterData.type);
-			}
-		}
+			filterValid = matchInternedKey(game, filterData);
 
 		// if still nothing, then it's not a match
 		if (!filterValid)
@@ -836,6 +927,531 @@ int FileFilterIndex::showFile(FileData* game)
 	return keepGoing ? 1 : 0;
 }
 
+bool FileFilterIndex::matchIndexableKey(FileData* game, FilterDataDecl& filterData)
+{
+	// try to find a match
+	std::string key = getIndexableKey(game, filterData.type, false);
+
+	bool filterValid = false;
+
+	if (filterData.type == LANG_FILTER || filterData.type == REGION_FILTER)
+	{
+		for (auto val : Utils::String::split(key, ','))
+			if (isKeyBeingFilteredBy(val, filterData.type))
+				filterValid = true;
+	}
+	else
+		filterValid = isKeyBeingFilteredBy(key, filterData.type);
+
+	// if we didn't find a match, try for secondary keys - i.e. publisher and dev, or first genre
+	if (!filterValid && filterData.hasSecondaryKey)
+	{
+		std::string secKey = getIndexableKey(game, filterData.type, true);
+		if (secKey != UNKNOWN_LABEL)
+			filterValid = isKeyBeingFilteredBy(secKey, filterData.type);
+	}
+
+	return filterValid;
+}
+
+// The keys of those filters only depend on interned metadata values : the result is computed once per distinct value, then found by integer ids
+bool FileFilterIndex::matchInternedKey(FileData* game, FilterDataDecl& filterData)
+{
+	const MetaDataList& md = game->getMetadata();
+
+	unsigned long long key;
+
+	switch (filterData.type)
+	{
+	case FAMILY_FILTER:
+		key = md.getInternedId(MetaDataId::Family);
+		break;
+	case LANG_FILTER:
+		key = md.getInternedId(MetaDataId::Language);
+		break;
+	case REGION_FILTER:
+		key = md.getInternedId(MetaDataId::Region);
+		break;
+	case PUBDEV_FILTER:
+		key = ((unsigned long long)md.getInternedId(MetaDataId::Publisher) << 32) | md.getInternedId(MetaDataId::Developer);
+		break;
+	default:
+		return matchIndexableKey(game, filterData);
+	}
+
+	std::unique_lock<std::mutex> lock(mMatchCacheLock);
+
+	auto& cache = mMatchCache[filterData.type];
+	if (cache.first != *filterData.currentFilteredKeys)
+	{
+		cache.first = *filterData.currentFilteredKeys;
+		cache.second.clear();
+	}
+
+	auto it = cache.second.find(key);
+	if (it != cache.second.cend())
+		return it->second;
+
+	bool filterValid = matchIndexableKey(game, filterData);
+	cache.second[key] = filterValid;
+	return filterValid;
+}
+
+static void insertOrdinal(std::vector<unsigned int>& ordinals, unsigned int ordinal)
+{
+	auto pos = std::lower_bound(ordinals.begin(), ordinals.end(), ordinal);
+	if (pos == ordinals.end() || *pos != ordinal)
+		ordinals.insert(pos, ordinal);
+}
+
+static void eraseOrdinal(std::vector<unsigned int>& ordinals, unsigned int ordinal)
+{
+	auto pos = std::lower_bound(ordinals.begin(), ordinals.end(), ordinal);
+	if (pos != ordinals.end() && *pos == ordinal)
+		ordinals.erase(pos);
+}
+
+static bool isAscii(const std::string& text)
+{
+	for (auto ch : text)
+		if ((ch & 0x80) != 0)
+			return false;
+
+	return true;
+}
+
+// Same case folding as Utils::String::containsIgnoreCase
+static std::vector<unsigned int> getTrigrams(const std::string& text)
+{
+	std::vector<unsigned int> ret;
+	if (text.size() < 3)
+		return ret;
+
+	ret.reserve(text.size() - 2);
+
+	for (size_t i = 0; i + 2 < text.size(); i++)
+		ret.push_back(((unsigned int)(unsigned char)toupper(text[i]) << 16) | ((unsigned int)(unsigned char)toupper(text[i + 1]) << 8) | (unsigned int)(unsigned char)toupper(text[i + 2]));
+
+	std::sort(ret.begin(), ret.end());
+	ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+	return ret;
+}
+
+bool FileFilterIndex::isInvertedIndexType(int type)
+{
+	return type == GENRE_FILTER || type == FAMILY_FILTER || type == PUBDEV_FILTER || type == LANG_FILTER || type == REGION_FILTER;
+}
+
+FileFilterIndex::IndexSignature FileFilterIndex::getIndexSignature(FileData* game)
+{
+	const MetaDataList& md = game->getMetadata();
+
+	return IndexSignature {{
+		md.getInternedId(MetaDataId::GenreIds), md.getInternedId(MetaDataId::Family),
+		md.getInternedId(MetaDataId::Publisher), md.getInternedId(MetaDataId::Developer),
+		md.getInternedId(MetaDataId::Language), md.getInternedId(MetaDataId::Region) }};
+}
+
+// The keys that make showFile accept the game, when one of them is filtered
+std::vector<std::string> FileFilterIndex::getMatchKeys(FileData* game, FilterDataDecl& filterData)
+{
+	if (filterData.type == GENRE_FILTER)
+		return Genres::getGenreFiltersNames(&game->getMetadata());
+
+	std::vector<std::string> ret;
+
+	std::string key = getIndexableKey(game, filterData.type, false);
+	if (filterData.type == LANG_FILTER || filterData.type == REGION_FILTER)
+		ret = Utils::String::split(key, ',');
+	else
+		ret.push_back(key);
+
+	if (filterData.hasSecondaryKey)
+	{
+		std::string secKey = getIndexableKey(game, filterData.type, true);
+		if (secKey != UNKNOWN_LABEL)
+			ret.push_back(secKey);
+	}
+
+	return ret;
+}
+
+void FileFilterIndex::addToInvertedIndex(FileData* game)
+{
+	if (game->getType() != GAME)
+		return;
+
+	std::unique_lock<std::mutex> lock(mMatchCacheLock);
+
+	if (mIndexedGames.find(game) != mIndexedGames.cend())
+		return;
+
+	IndexedGame indexed;
+	indexed.signature = getIndexSignature(game);
+	indexed.name = game->getSourceFileData()->getName();
+	indexed.asciiName = isAscii(indexed.name);
+
+	if (!mFreeOrdinals.empty())
+	{
+		indexed.ordinal = mFreeOrdinals.back();
+		mFreeOrdinals.pop_back();
+	}
+	else
+		indexed.ordinal = mNextOrdinal++;
+
+	size_t ordinals = 0;
+
+	for (auto& it : mFilterDecl)
+	{
+		if (!isInvertedIndexType(it.first))
+			continue;
+
+		auto& keys = mIndexedKeys[it.first];
+
+		for (auto& key : getMatchKeys(game, it.second))
+		{
+			insertOrdinal(keys[key], indexed.ordinal);
+			ordinals++;
+		}
+	}
+
+	// The map node, its name & the ordinals of its keys
+	indexed.memUsage = (unsigned int)(sizeof(std::pair<FileData*, IndexedGame>) + 2 * sizeof(void*) + indexed.name.capacity() + ordinals * sizeof(unsigned int));
+	mMemUsage.add(indexed.memUsage);
+
+	if (mTextIndexBuilt)
+		addToTextIndex(indexed);
+
+	mIndexedGames[game] = indexed;
+	mIndexedMatchValid = false;
+}
+
+void FileFilterIndex::removeFromInvertedIndex(FileData* game)
+{
+	std::unique_lock<std::mutex> lock(mMatchCacheLock);
+
+	auto it = mIndexedGames.find(game);
+	if (it == mIndexedGames.cend())
+		return;
+
+	unsigned int ordinal = it->second.ordinal;
+	bool sameKeys = (it->second.signature == getIndexSignature(game));
+
+	for (auto& type : mIndexedKeys)
+	{
+		// The metadata changed since the game was indexed : its entries can only be found by looking at all the keys
+		if (!sameKeys)
+		{
+			for (auto& key : type.second)
+				eraseOrdinal(key.second, ordinal);
+
+			continue;
+		}
+
+		auto decl = mFilterDecl.find(type.first);
+		if (decl == mFilterDecl.cend())
+			continue;
+
+		for (auto& key : getMatchKeys(game, decl->second))
+		{
+			auto ordinals = type.second.find(key);
+			if (ordinals != type.second.cend())
+				eraseOrdinal(ordinals->second, ordinal);
+		}
+	}
+
+	if (mTextIndexBuilt)
+		removeFromTextIndex(it->second);
+
+	mMemUsage.add(-(int64_t)it->second.memUsage);
+
+	mFreeOrdinals.push_back(ordinal);
+	mIndexedGames.erase(it);
+	mIndexedMatchValid = false;
+}
+
+void FileFilterIndex::resetInvertedIndex()
+{
+	std::unique_lock<std::mutex> lock(mMatchCacheLock);
+
+	mIndexedGames.clear();
+	mIndexedKeys.clear();
+	mFreeOrdinals.clear();
+	mNextOrdinal = 0;
+	mMemUsage.set(0);
+
+	mIndexedMatch.clear();
+	mIndexedMatchKeys.clear();
+	mIndexedMatchValid = false;
+
+	mTextIndexBuilt = false;
+	mTrigrams.clear();
+	mWords.clear();
+	mTextCandidates.clear();
+	mTextCandidatesValid = false;
+	mLastToken.clear();
+	mLastTokenCandidates.clear();
+}
+
+int FileFilterIndex::matchInvertedIndex(FileData* game)
+{
+	std::unique_lock<std::mutex> lock(mMatchCacheLock);
+
+	auto indexed = mIndexedGames.find(game);
+	if (indexed == mIndexedGames.cend() || indexed->second.signature != getIndexSignature(game))
+		return -1;
+
+	// The filtered keys can be changed through getFilter : compare them with the ones the intersection was computed for
+	bool active = false;
+	bool changed = !mIndexedMatchValid;
+
+	for (auto& it : mFilterDecl)
+	{
+		if (!isInvertedIndexType(it.first))
+			continue;
+
+		bool filtered = *(it.second.filteredByRef);
+		active |= filtered;
+
+		auto keys = mIndexedMatchKeys.find(it.first);
+		if (filtered != (keys != mIndexedMatchKeys.cend()) || (filtered && keys->second != *it.second.currentFilteredKeys))
+			changed = true;
+	}
+
+	if (!active)
+		return -1;
+
+	if (changed)
+	{
+		mIndexedMatch.clear();
+		mIndexedMatchKeys.clear();
+
+		bool first = true;
+
+		for (auto& it : mFilterDecl)
+		{
+			if (!isInvertedIndexType(it.first) || !(*(it.second.filteredByRef)))
+				continue;
+
+			mIndexedMatchKeys[it.first] = *it.second.currentFilteredKeys;
+
+			Utils::Bitset typeMatch;
+
+			auto& keys = mIndexedKeys[it.first];
+			for (auto& key : *it.second.currentFilteredKeys)
+			{
+				auto ordinals = keys.find(key);
+				if (ordinals == keys.cend())
+					continue;
+
+				for (auto ordinal : ordinals->second)
+					typeMatch.set(ordinal);
+			}
+
+			if (first)
+				mIndexedMatch = typeMatch;
+			else
+				mIndexedMatch &= typeMatch;
+
+			first = false;
+		}
+
+		mIndexedMatchValid = true;
+	}
+
+	return mIndexedMatch.test(indexed->second.ordinal) ? 1 : 0;
+}
+
+void FileFilterIndex::buildTextIndex()
+{
+	mTextIndexBuilt = true;
+
+	for (auto& game : mIndexedGames)
+		addToTextIndex(game.second);
+}
+
+void FileFilterIndex::addToTextIndex(const IndexedGame& game)
+{
+	mTextCandidatesValid = false;
+	mLastToken.clear();
+
+	if (!game.asciiName)
+		return;
+
+	auto trigrams = getTrigrams(game.name);
+	for (auto trigram : trigrams)
+		insertOrdinal(mTrigrams[trigram], game.ordinal);
+
+	auto words = simplifyWords(game.name);
+	for (auto& word : words)
+		insertOrdinal(mWords[word], game.ordinal);
+
+	mMemUsage.add((trigrams.size() + words.size()) * sizeof(unsigned int));
+}
+
+void FileFilterIndex::removeFromTextIndex(const IndexedGame& game)
+{
+	mTextCandidatesValid = false;
+	mLastToken.clear();
+
+	if (!game.asciiName)
+		return;
+
+	auto trigrams = getTrigrams(game.name);
+	for (auto trigram : trigrams)
+	{
+		auto it = mTrigrams.find(trigram);
+		if (it != mTrigrams.cend())
+			eraseOrdinal(it->second, game.ordinal);
+	}
+
+	auto words = simplifyWords(game.name);
+	for (auto& word : words)
+	{
+		auto it = mWords.find(word);
+		if (it != mWords.cend())
+			eraseOrdinal(it->second, game.ordinal);
+	}
+
+	mMemUsage.add(-(int64_t)((trigrams.size() + words.size()) * sizeof(unsigned int)));
+}
+
+bool FileFilterIndex::getTokenCandidates(const std::string& token, std::vector<unsigned int>& candidates)
+{
+	auto trigrams = getTrigrams(token);
+	if (trigrams.empty())
+		return false;
+
+	std::vector<const std::vector<unsigned int>*> postings;
+	for (auto trigram : trigrams)
+	{
+		auto it = mTrigrams.find(trigram);
+		if (it == mTrigrams.cend())
+		{
+			candidates.clear();
+			return true;
+		}
+
+		postings.push_back(&it->second);
+	}
+
+	// Start from the candidates of the previous token when it's part of this one, else from the rarest trigram
+	const std::vector<unsigned int>* base;
+
+	if (!mLastToken.empty() && token.find(mLastToken) != std::string::npos)
+		base = &mLastTokenCandidates;
+	else
+		base = *std::min_element(postings.cbegin(), postings.cend(), [](const std::vector<unsigned int>* a, const std::vector<unsigned int>* b) { return a->size() < b->size(); });
+
+	std::vector<unsigned int> ret;
+	ret.reserve(base->size());
+
+	for (auto ordinal : *base)
+	{
+		bool found = true;
+
+		for (auto list : postings)
+		{
+			if (list != base && !std::binary_search(list->cbegin(), list->cend(), ordinal))
+			{
+				found = false;
+				break;
+			}
+		}
+
+		if (found)
+			ret.push_back(ordinal);
+	}
+
+	mLastToken = token;
+	mLastTokenCandidates = ret;
+
+	candidates = std::move(ret);
+	return true;
+}
+
+void FileFilterIndex::prepareTextCandidates(bool isChinese)
+{
+	mTextCandidatesValid = true;
+	mTextCandidatesFilter = mTextFilter;
+	mTextCandidatesRelevancy = mUseRelevency;
+	mTextCandidatesChinese = isChinese;
+
+	mTextCandidates.clear();
+	mTextCandidatesAll = false;
+
+	std::vector<unsigned int> candidates;
+
+	auto addToken = [this, &candidates](const std::string& token)
+	{
+		if (!getTokenCandidates(token, candidates))
+			return false;
+
+		for (auto ordinal : candidates)
+			mTextCandidates.set(ordinal);
+
+		return true;
+	};
+
+	if (!mUseRelevency)
+	{
+		// The pinyin matches aren't in the index
+		if (isChinese)
+			mTextCandidatesAll = true;
+		else if (mTextFilter.find(',') == std::string::npos)
+			mTextCandidatesAll = !addToken(mTextFilter);
+		else
+		{
+			for (auto token : Utils::String::split(mTextFilter, ',', true))
+			{
+				if (!addToken(Utils::String::trim(token)))
+				{
+					mTextCandidatesAll = true;
+					break;
+				}
+			}
+		}
+
+		return;
+	}
+
+	// Same name, starting with or containing the filter : all of them contain it. The unicode case folding of those compares is not byte wise
+	if (!isAscii(mTextFilter) || !addToken(mTextFilter))
+	{
+		mTextCandidatesAll = true;
+		return;
+	}
+
+	// Or at least one common word
+	if (mTextFilter.find(' ') != std::string::npos)
+	{
+		for (auto& word : simplifyWords(mTextFilter))
+		{
+			auto it = mWords.find(word);
+			if (it != mWords.cend())
+				for (auto ordinal : it->second)
+					mTextCandidates.set(ordinal);
+		}
+	}
+}
+
+bool FileFilterIndex::isTextCandidate(FileData* game, const std::string& name, bool isChinese)
+{
+	std::unique_lock<std::mutex> lock(mMatchCacheLock);
+
+	auto indexed = mIndexedGames.find(game);
+	if (indexed == mIndexedGames.cend() || !indexed->second.asciiName || indexed->second.name != name)
+		return true;
+
+	if (!mTextIndexBuilt)
+		buildTextIndex();
+
+	if (!mTextCandidatesValid || mTextCandidatesFilter != mTextFilter || mTextCandidatesRelevancy != mUseRelevency || mTextCandidatesChinese != isChinese)
+		prepareTextCandidates(isChinese);
+
+	return mTextCandidatesAll || mTextCandidates.test(indexed->second.ordinal);
+}
+
 bool FileFilterIndex::isKeyBeingFilteredBy(std::string key, FilterIndexType type)
 {
 	auto it = mFilterDecl.find(type);
@@ -875,7 +1491,7 @@ void FileFilterIndex::manageFamilyEntryInIndex(FileData* game, bool remove)
 
 void FileFilterIndex::manageGenreEntryInIndex(FileData* game, bool remove)
 {
-	for (auto key : Genres::getGenreFiltersNames(&game->getMetadata()))
+	for (auto& key : Genres::getGenreFiltersNames(&game->getMetadata()))
 		manageIndexEntry(&genreIndexAllKeys, key, remove);
 }
 
@@ -1207,6 +1823,92 @@ void CollectionFilter::resetSystemFilter()
 	mSystemFilter.clear();
 }
 
+void CollectionFilter::getFilterState(FilterState& state)
+{
+	FileFilterIndex::getFilterState(state);
+	state.systems = mSystemFilter;
+}
+
+void CollectionFilter::query(const std::vector<FileData*>& games, std::vector<FileData*>& matches)
+{
+	unsigned int generation = MetaDataList::getChangeGeneration();
+	unsigned int treeGeneration = FolderData::getTreeGeneration();
+
+	FilterState state;
+	getFilterState(state);
+
+	if (state != mResultsState)
+	{
+		mResults.clear();
+		mResultsState = state;
+	}
+	else if (MetaDataList::getLastChangeGeneration(getFilteredFields()) > mResultsGeneration)
+	{
+		// After editing a game, only that one has to be evaluated again
+		const MetaDataList* changed = MetaDataList::getSingleChangedListSince(mResultsGeneration);
+		if (changed == nullptr)
+			mResults.clear();
+		else
+		{
+			for (auto it = mResults.begin(); it != mResults.end(); ++it)
+			{
+				if (&it->first->getMetadata() == changed)
+				{
+					mResults.erase(it);
+					break;
+				}
+			}
+		}
+	}
+
+	bool checkPaths = (treeGeneration != mResultsTreeGeneration);
+
+	mResultsGeneration = generation;
+	mResultsTreeGeneration = treeGeneration;
+
+	for (auto game : games)
+	{
+		FileData* source = game->getSourceFileData();
+
+		auto it = mResults.find(source);
+		if (it != mResults.cend() && (!checkPaths || it->second.pathHash == std::hash<std::string>()(source->getPath())))
+		{
+			if (it->second.match)
+				matches.push_back(game);
+
+			continue;
+		}
+
+		QueryResult result;
+		result.pathHash = std::hash<std::string>()(source->getPath());
+		result.match = (showFile(game) != 0);
+		mResults[source] = result;
+
+		if (result.match)
+			matches.push_back(game);
+	}
+}
+
+bool CollectionFilter::match(FileData* game)
+{
+	bool match = (showFile(game) != 0);
+
+	FilterState state;
+	getFilterState(state);
+
+	if (state == mResultsState)
+	{
+		FileData* source = game->getSourceFileData();
+
+		QueryResult result;
+		result.pathHash = std::hash<std::string>()(source->getPath());
+		result.match = match;
+		mResults[source] = result;
+	}
+
+	return match;
+}
+
 std::string FileFilterIndex::getDisplayLabel(bool includeText)
 {
 	std::string filterInfo;
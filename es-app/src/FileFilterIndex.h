@@ -5,7 +5,12 @@
 #include <map>
 #include <vector>
 #include <unordered_set>
+#include <unordered_map>
 #include <string>
+#include <mutex>
+#include <array>
+#include "utils/Bitset.h"
+#include "MemoryStats.h"
 
 class FileData;
 class SystemData;
@@ -83,6 +88,24 @@ public:
 
 	std::string getDisplayLabel(bool includeText = false);
 
+	// Active filters, as compared by the cached display lists : a change that narrows the filters only has to check the games shown for the previous ones
+	struct FilterState
+	{
+		FilterState() : useRelevancy(false) { }
+
+		bool operator==(const FilterState& other) const { return keys == other.keys && text == other.text && useRelevancy == other.useRelevancy && systems == other.systems; }
+		bool operator!=(const FilterState& other) const { return !(*this == other); }
+
+		std::map<int, std::unordered_set<std::string>> keys; // Filtered keys, by filtered type
+		std::string text;
+		bool useRelevancy;
+		std::unordered_set<std::string> systems; // CollectionFilter systems, empty for all
+	};
+
+	virtual void getFilterState(FilterState& state);
+	static bool isNarrowing(const FilterState& from, const FilterState& to); // true when the games shown for 'to' are a subset of the ones shown for 'from'
+	unsigned long long getFilteredFields(); // MetaDataList change bits of the fields the active filters read
+
 protected:
 	//std::vector<FilterDataDecl> filterDataDecl;
 	std::map<int, FilterDataDecl> mFilterDecl;
@@ -101,6 +124,73 @@ protected:
 
 	void clearIndex(std::map<std::string, int> indexMap);
 
+	bool matchIndexableKey(FileData* game, FilterDataDecl& filterData);
+	bool matchInternedKey(FileData* game, FilterDataDecl& filterData);
+
+	// Per filter type : filtered keys the results were computed for, and results by metadata pool ids
+	std::map<int, std::pair<std::unordered_set<std::string>, std::unordered_map<unsigned long long, bool>>> mMatchCache;
+	std::mutex mMatchCacheLock;
+
+	// Inverted index of the filters whose keys only depend on interned metadata ( genre, family, publisher/developer, language, region ) :
+	// sorted game ordinals by filter type & key. The games whose metadata changed since addToIndex use the regular matching
+	typedef std::array<unsigned int, 6> IndexSignature;
+
+	struct IndexedGame
+	{
+		unsigned int	ordinal;
+		IndexSignature	signature;
+
+		std::string		name;		// Source name, as searched by the text filter
+		bool			asciiName;	// Only those are in the text index : the case insensitive compares of the others are not byte wise
+		unsigned int	memUsage;	// Entry & ordinals in the inverted index, without the text index
+	};
+
+	static bool isInvertedIndexType(int type);
+	static IndexSignature getIndexSignature(FileData* game);
+	std::vector<std::string> getMatchKeys(FileData* game, FilterDataDecl& filterData);
+
+	void addToInvertedIndex(FileData* game);
+	void removeFromInvertedIndex(FileData* game);
+	void resetInvertedIndex();
+	int matchInvertedIndex(FileData* game); // -1 when the index can't tell
+
+	std::unordered_map<FileData*, IndexedGame> mIndexedGames;
+	std::map<int, std::unordered_map<std::string, std::vector<unsigned int>>> mIndexedKeys;
+	std::vector<unsigned int> mFreeOrdinals;
+	unsigned int mNextOrdinal;
+
+	// Intersection of the active indexed filters, and the filtered keys it was computed for
+	Utils::Bitset mIndexedMatch;
+	std::map<int, std::unordered_set<std::string>> mIndexedMatchKeys;
+	bool mIndexedMatchValid;
+
+	// Text filter : trigrams of the upper case names & words of the relevancy search, built at the first search.
+	// They give the games that can match, the text filter only compares the names of those
+	bool isTextCandidate(FileData* game, const std::string& name, bool isChinese);
+	void buildTextIndex();
+	void addToTextIndex(const IndexedGame& game);
+	void removeFromTextIndex(const IndexedGame& game);
+	void prepareTextCandidates(bool isChinese);
+	bool getTokenCandidates(const std::string& token, std::vector<unsigned int>& candidates); // false when any name can contain the token
+
+	bool mTextIndexBuilt;
+	std::unordered_map<unsigned int, std::vector<unsigned int>> mTrigrams;
+	std::unordered_map<std::string, std::vector<unsigned int>> mWords;
+
+	// Estimated from the entries & ordinals added to the indexes
+	MemoryCounter<MemoryStats::FILTER_INDEX> mMemUsage;
+
+	Utils::Bitset	mTextCandidates;
+	bool			mTextCandidatesAll;
+	bool			mTextCandidatesValid;
+	std::string		mTextCandidatesFilter;
+	bool			mTextCandidatesRelevancy;
+	bool			mTextCandidatesChinese;
+
+	// While typing, the candidates of a token are found among the ones of the previous token
+	std::string					mLastToken;
+	std::vector<unsigned int>	mLastTokenCandidates;
+
 	bool filterByGenre;
 	bool filterByFamily;
 	bool filterByPlayers;
@@ -159,6 +249,8 @@ protected:
 class CollectionFilter : public FileFilterIndex
 {
 public:	
+	CollectionFilter() : mResultsGeneration(0), mResultsTreeGeneration(0) { }
+
 	bool create(const std::string name);
 	bool createFromSystem(const std::string name, SystemData* system);
 
@@ -167,15 +259,31 @@ public:
 
 	int showFile(FileData* game) override;
 	bool isFiltered() override;
+	void getFilterState(FilterState& state) override;
 
 	bool isSystemSelected(const std::string name);
 	void setSystemSelected(const std::string name, bool value);
 	void resetSystemFilter();
 
+	// The games of 'games' that match the rules. Results are kept by source game : unless the rules change, only the games whose filtered fields changed are evaluated again
+	void query(const std::vector<FileData*>& games, std::vector<FileData*>& matches);
+	bool match(FileData* game); // Evaluates a single game, and updates its kept result
+
 protected:
 	std::string mName;
 	std::string mPath;
 	std::unordered_set<std::string> mSystemFilter;
+
+	struct QueryResult
+	{
+		size_t	pathHash;	// Deleted games may leave their address to new ones
+		bool	match;
+	};
+
+	std::unordered_map<FileData*, QueryResult> mResults;
+	FilterState		mResultsState;
+	unsigned int	mResultsGeneration;		// MetaDataList::getChangeGeneration() of the results
+	unsigned int	mResultsTreeGeneration;	// FolderData::getTreeGeneration() of the results
 };
 
 #endif // ES_APP_FILE_FILTER_INDEX_H
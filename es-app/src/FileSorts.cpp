@@ -2,8 +2,14 @@
 #include "FileSorts.h"
 
 #include "utils/StringUtil.h"
+#include "utils/ThreadPool.h"
 #include "LocaleES.h"
 
+#include <algorithm>
+#include <thread>
+
+#define PARALLEL_SORT_MIN	16384	// Smaller lists are sorted on the calling thread
+
 namespace FileSorts
 {
 	static Singleton* sInstance = nullptr;
@@ -226,4 +232,215 @@ namespace FileSorts
 		std::string system2 = ((FileData*)file2)->getSourceFileData()->getSystemName();
 		return Utils::String::compareIgnoreCase(system1, system2) < 0;		
 	}
+
+	struct SortKey
+	{
+		FileData*		file;
+		bool			hasScore;
+		int				score;
+
+		int				type;
+		bool			isGame;		// Game metadata
+		float			number;
+		int				integer;
+		std::string		text;
+		std::string		text2;
+		std::u32string	folded;
+		std::u32string	folded2;
+	};
+
+	void sortFiles(std::vector<FileData*>& files, const SortType& sort, const std::map<FileData*, int>* scores)
+	{
+		if (files.size() < 2)
+			return;
+
+		ComparisonFunction* compf = sort.comparisonFunction;
+
+		bool foldersFirst = Settings::ShowFoldersFirst();
+		bool ignoreArticles = Settings::IgnoreLeadingArticles();
+		static auto articles = Utils::String::commaStringToVector(_("A,AN,THE"));
+
+		std::vector<SortKey> keys(files.size());
+
+		auto buildKeys = [&](size_t from, size_t to)
+		{
+			for (size_t i = from; i < to; i++)
+			{
+				FileData* file = files[i];
+				const MetaDataList& md = file->getMetadata();
+
+				SortKey& key = keys[i];
+				key.file = file;
+				key.hasScore = false;
+				key.score = 0;
+				key.type = file->getType();
+				key.isGame = (md.getType() == GAME_METADATA);
+				key.number = 0;
+				key.integer = 0;
+
+				if (scores != nullptr)
+				{
+					auto score = scores->find(file);
+					if (score != scores->cend())
+					{
+						key.hasScore = true;
+						key.score = score->second;
+					}
+				}
+
+				if (compf == &compareName)
+					key.folded = Utils::String::foldCase(ignoreArticles ? stripLeadingArticle(file->getName(), articles) : file->getName());
+				else if (compf == &compareRating)
+					key.number = md.getFloat(MetaDataId::Rating);
+				else if (compf == &compareTimesPlayed)
+					key.integer = md.getInt(MetaDataId::PlayCount);
+				else if (compf == &compareGameTime)
+					key.integer = md.getInt(MetaDataId::GameTime);
+				else if (compf == &compareNumPlayers)
+					key.integer = md.getInt(MetaDataId::Players);
+				else if (compf == &compareLastPlayed)
+					key.text = md.get(MetaDataId::LastPlayed);
+				else if (compf == &compareReleaseDate)
+					key.text = md.get(MetaDataId::ReleaseDate);
+				else if (compf == &compareFileCreationDate)
+					key.text = Utils::FileSystem::getFileCreationDate(file->getPath()).getIsoString();
+				else if (compf == &compareGenre)
+					key.folded = Utils::String::foldCase(md.get(MetaDataId::Genre));
+				else if (compf == &compareDeveloper)
+					key.folded = Utils::String::foldCase(md.get(MetaDataId::Developer));
+				else if (compf == &comparePublisher)
+					key.folded = Utils::String::foldCase(md.get(MetaDataId::Publisher));
+				else if (compf == &compareSystem)
+					key.folded = Utils::String::foldCase(file->getSourceFileData()->getSystemName());
+				else if (compf == &compareSystemReleaseYear || compf == &compareReleaseYearSystem)
+				{
+					key.text = file->getSourceFileData()->getSystemName();
+					key.text2 = md.get(MetaDataId::ReleaseDate).substr(0, 4);
+					key.folded = Utils::String::foldCase(file->getName());
+					key.folded2 = Utils::String::foldCase(key.text);
+				}
+			}
+		};
+
+		auto compareKeys = [compf, foldersFirst](const SortKey& a, const SortKey& b) -> bool
+		{
+			if (a.hasScore && b.hasScore && a.score != b.score)
+				return a.score < b.score;
+
+			if (compf == &compareName)
+			{
+				if (foldersFirst && a.type != b.type)
+					return a.type == FOLDER;
+
+				return a.folded < b.folded;
+			}
+
+			if (compf == &compareTimesPlayed || compf == &compareGameTime)
+				return a.isGame && b.isGame && a.integer < b.integer;
+
+			if (compf == &compareNumPlayers)
+				return a.integer < b.integer;
+
+			if (compf == &compareRating)
+				return a.number < b.number;
+
+			if (compf == &compareLastPlayed || compf == &compareReleaseDate || compf == &compareFileCreationDate)
+				return a.text < b.text;
+
+			if (compf == &compareSystemReleaseYear)
+			{
+				if (a.text == b.text)
+				{
+					if (a.text2 == b.text2)
+						return a.folded < b.folded;
+
+					return a.text2 < b.text2;
+				}
+
+				return a.folded2 < b.folded2;
+			}
+
+			if (compf == &compareReleaseYearSystem)
+			{
+				if (a.text2 == b.text2)
+				{
+					if (a.text == b.text)
+						return a.folded < b.folded;
+
+					return a.folded2 < b.folded2;
+				}
+
+				return a.text2 < b.text2;
+			}
+
+			if (compf == &compareGenre || compf == &compareDeveloper || compf == &comparePublisher || compf == &compareSystem)
+				return a.folded < b.folded;
+
+			return compf(a.file, b.file);
+		};
+
+		// Large lists ( "All games"... ) : the keys are built & sorted by chunks on a pool, then the sorted chunks are merged by pairs
+		size_t chunks = 1;
+		if (files.size() >= PARALLEL_SORT_MIN)
+			chunks = std::min<size_t>(std::thread::hardware_concurrency(), files.size() / (PARALLEL_SORT_MIN / 2));
+
+		if (chunks < 2)
+		{
+			buildKeys(0, keys.size());
+			std::sort(keys.begin(), keys.end(), compareKeys);
+		}
+		else
+		{
+			std::vector<size_t> bounds;
+			for (size_t i = 0; i <= chunks; i++)
+				bounds.push_back(keys.size() * i / chunks);
+
+			{
+				Utils::ThreadPool pool;
+
+				for (size_t i = 0; i < chunks; i++)
+				{
+					size_t from = bounds[i];
+					size_t to = bounds[i + 1];
+
+					pool.queueWorkItem([&buildKeys, &keys, &compareKeys, from, to]
+					{
+						buildKeys(from, to);
+						std::sort(keys.begin() + from, keys.begin() + to, compareKeys);
+					});
+				}
+
+				pool.wait();
+			}
+
+			while (bounds.size() > 2)
+			{
+				std::vector<size_t> merged;
+
+				Utils::ThreadPool pool;
+
+				for (size_t i = 0; i + 2 < bounds.size(); i += 2)
+				{
+					size_t from = bounds[i];
+					size_t middle = bounds[i + 1];
+					size_t to = bounds[i + 2];
+
+					pool.queueWorkItem([&keys, &compareKeys, from, middle, to] { std::inplace_merge(keys.begin() + from, keys.begin() + middle, keys.begin() + to, compareKeys); });
+					merged.push_back(from);
+				}
+
+				// Odd count : the last range waits for the next round
+				if ((bounds.size() - 1) % 2 == 1)
+					merged.push_back(bounds[bounds.size() - 2]);
+
+				merged.push_back(bounds.back());
+
+				pool.wait();
+				bounds = merged;
+			}
+		}
+
+		for (size_t i = 0; i < files.size(); i++)
+			files[i] = keys[i].file;
+	}
 };
@@ -3,6 +3,7 @@
 #define ES_APP_FILE_SORTS_H
 
 #include "FileData.h"
+#include <map>
 #include <vector>
 
 namespace FileSorts
@@ -66,6 +67,10 @@ namespace FileSorts
 	SortType getSortType(int sortId);
 	const std::vector<SortType>& getSortTypes();
 
+	// Same order as std::sort with sort.comparisonFunction ( not reversed for descending sorts ), but the metadata values are read, folded & parsed once per file.
+	// When given, the files with different scores are ordered by score first
+	void sortFiles(std::vector<FileData*>& files, const SortType& sort, const std::map<FileData*, int>* scores = nullptr);
+
 	bool compareName(const FileData* file1, const FileData* file2);
 	bool compareRating(const FileData* file1, const FileData* file2);
 	bool compareTimesPlayed(const FileData* file1, const FileData* fil2);
@@ -5,11 +5,18 @@
 #include "FileData.h"
 #include "FileFilterIndex.h"
 #include "Log.h"
+#include "Trace.h"
 #include "Settings.h"
 #include "SystemData.h"
 #include <pugixml/src/pugixml.hpp>
 #include "Genres.h"
 #include "Paths.h"
+#include "GamelistCache.h"
+#include "GamelistSource.h"
+#include "GamelistStream.h"
+#include "GamelistWriter.h"
+#include "GamelistJournal.h"
+#include "SharedCatalog.h"
 
 #ifdef WIN32
 #include <Windows.h>
@@ -73,7 +80,7 @@ FileData* findOrCreateFile(SystemData* system, const std::string& path, FileType
 			}
 
 			// Add final game
-			item = new FileData(GAME, path, system);
+			item = new (system) FileData(GAME, path, system);
 			if (!item->isArcadeAsset())
 			{
 				fileMap[key] = item;
@@ -94,7 +101,7 @@ FileData* findOrCreateFile(SystemData* system, const std::string& path, FileType
 			}
 
 			// create missing folder
-			FolderData* folder = new FolderData(treeNode->getPath() + "/" + *path_it, system);
+			FolderData* folder = new (system) FolderData(treeNode->getPath() + "/" + *path_it, system);
 			fileMap[key] = folder;
 			treeNode->addChild(folder);
 			treeNode = folder;
@@ -106,26 +113,40 @@ FileData* findOrCreateFile(SystemData* system, const std::string& path, FileType
 	return NULL;
 }
 
-std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize, bool fromFile)
+std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize, bool fromFile, GamelistCache* cache)
 {	
 	std::vector<FileData*> ret;
 
 	LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
 
+	// Files are streamed one record at a time : a huge gamelist is never entirely in memory. Strings ( web server uploads ) are small
+	GamelistStream stream(fromFile ? xmlpath : std::string());
+
 	pugi::xml_document doc;
-	pugi::xml_parse_result result = fromFile ? doc.load_file(WINSTRINGW(xmlpath).c_str()) : doc.load_string(xmlpath.c_str());
+	pugi::xml_node root;
 
-	if (!result)
+	if (fromFile)
 	{
-		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
-		return ret;
-	}
+		if (!stream.open())
+			return ret;
 
-	pugi::xml_node root = doc.child("gameList");
-	if (!root)
+		root = stream.getRoot();
+	}
+	else
 	{
-		LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlpath << "\"!";
-		return ret;
+		pugi::xml_parse_result result = doc.load_string(xmlpath.c_str());
+		if (!result)
+		{
+			LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
+			return ret;
+		}
+
+		root = doc.child("gameList");
+		if (!root)
+		{
+			LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlpath << "\"!";
+			return ret;
+		}
 	}
 
 	if (checkSize != SIZE_MAX)
@@ -141,7 +162,13 @@ std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* s
 	std::string relativeTo = system->getStartPath();
 	bool trustGamelist = Settings::ParseGamelistOnly();
 
-	for (pugi::xml_node fileNode : root.children())
+	// Lazy records point in this file : not when building the snapshot ( it needs everything ), nor for recovery files
+	bool lazy = fromFile && cache == nullptr && checkSize == SIZE_MAX && GamelistSource::isEnabled();
+	if (lazy)
+		system->setGamelistSource(new GamelistSource(system, GamelistSource::XML_SOURCE, xmlpath));
+
+	// recordOffset : position of the record in the file, -1 if unknown
+	auto loadRecord = [&](pugi::xml_node fileNode, long long recordOffset)
 	{
 		FileType type = GAME;
 
@@ -150,7 +177,7 @@ std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* s
 		if (tag == "folder")
 			type = FOLDER;
 		else if (tag != "game")
-			continue;
+			return;
 
 		const std::string path = Utils::FileSystem::resolveRelativePath(fileNode.child("path").text().get(), relativeTo, false);
 		
@@ -170,7 +197,18 @@ std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* s
 				else
 				{
 					LOG(LogWarning) << "File \"" << path << "\" does not exist or is arcade asset ! Ignoring.";
-					continue;
+
+					// Keep the entry in the snapshot : the file may appear later without gamelist.xml being changed
+					if (cache != nullptr)
+					{
+						MetaDataList mdl(type == FOLDER ? FOLDER_METADATA : GAME_METADATA);
+						mdl.loadFromXML(type == FOLDER ? FOLDER_METADATA : GAME_METADATA, fileNode, system);
+						mdl.migrate(nullptr, fileNode);
+						Genres::convertGenreToGenreIds(&mdl);
+						cache->add(type, path, mdl);
+					}
+
+					return;
 				}
 			}
 		}
@@ -178,15 +216,20 @@ std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* s
 		if (file == nullptr)
 		{			
 			LOG(LogError) << "Error finding/creating FileData for \"" << path << "\", skipping.";
-			continue;
+			return;
 		}
 		
 		if (!trustGamelist || !file->isArcadeAsset()) // arcade assets already filtered when !trustGamelist
 		{
+			long long offset = lazy ? recordOffset : -1;
+
 			MetaDataList& mdl = file->getMetadata();
-			mdl.loadFromXML(type == FOLDER ? FOLDER_METADATA : GAME_METADATA, fileNode, system);
+			mdl.loadFromXML(type == FOLDER ? FOLDER_METADATA : GAME_METADATA, fileNode, system, offset >= 0);
 			mdl.migrate(file, fileNode);
 
+			if (offset >= 0)
+				mdl.setLazyRecord((unsigned int)offset, GamelistSource::hashPath(path));
+
 			// Make sure name gets set if one didn't exist
 			if (mdl.getName().empty())
 				mdl.set(MetaDataId::Name, file->getDisplayName());
@@ -201,8 +244,25 @@ std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* s
 			else
 				mdl.resetChangedFlag();
 
+			if (cache != nullptr)
+				cache->add(type, path, mdl);
+
 			ret.push_back(file);
 		}
+	};
+
+	if (fromFile)
+	{
+		pugi::xml_document record;
+		size_t offset;
+
+		while (stream.next(record, offset))
+			loadRecord(record.first_child(), (long long)offset);
+	}
+	else
+	{
+		for (pugi::xml_node fileNode : root.children())
+			loadRecord(fileNode, GamelistSource::getRecordOffset(fileNode));
 	}
 
 	return ret;
@@ -216,16 +276,29 @@ void clearTemporaryGamelistRecovery(SystemData* system)
 
 void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap)
 {
+	TraceSpan span("parseGamelist", system->getName());
+
 	std::string xmlpath = system->getGamelistPath(false);
 
 	auto size = Utils::FileSystem::getFileSize(xmlpath);
-	if (size != 0)
-		loadGamelistFile(xmlpath, system, fileMap, SIZE_MAX, true);
+	if (size != 0 && !GamelistCache::load(system, xmlpath, fileMap))
+	{
+		if (GamelistCache::isEnabled())
+		{
+			GamelistCache cache(system, xmlpath);
+			loadGamelistFile(xmlpath, system, fileMap, SIZE_MAX, true, &cache);
+			cache.save();
+		}
+		else
+			loadGamelistFile(xmlpath, system, fileMap, SIZE_MAX, true);
+	}
 
 	auto files = Utils::FileSystem::getDirContent(getGamelistRecoveryPath(system), true);
 	for (auto file : files)
 		loadGamelistFile(file, system, fileMap, size, true);
 
+	GamelistJournal::replay(system, fileMap);
+
 	if (size != SIZE_MAX)
 		system->setGamelistHash(size);	
 }
@@ -295,6 +368,19 @@ bool saveToXml(FileData* file, const std::string& fileName, bool fullPaths)
 	return false;
 }
 
+std::string getGamelistRecoveryFile(FileData* file)
+{
+	SystemData* system = file->getSourceFileData()->getSystem();
+	if (system == nullptr)
+		return "";
+
+	std::string fp = Utils::FileSystem::createRelativePath(file->getFullPath(), system->getRootFolder()->getFullPath(), true);
+	fp = Utils::FileSystem::getParent(fp) + "/" + Utils::FileSystem::getStem(fp) + ".xml";
+
+	std::string path = Utils::FileSystem::getAbsolutePath(fp, getGamelistRecoveryPath(system));
+	return Utils::FileSystem::getCanonicalPath(path);
+}
+
 bool saveToGamelistRecovery(FileData* file)
 {
 	if (!Settings::getInstance()->getBool("SaveGamelistsOnExit"))
@@ -304,14 +390,9 @@ bool saveToGamelistRecovery(FileData* file)
 	if (!Settings::HiddenSystemsShowGames() && !system->isVisible())
 		return false;
 
-	std::string fp = file->getFullPath();
-	fp = Utils::FileSystem::createRelativePath(file->getFullPath(), system->getRootFolder()->getFullPath(), true);
-	fp = Utils::FileSystem::getParent(fp) + "/" + Utils::FileSystem::getStem(fp) + ".xml";
-
-	std::string path = Utils::FileSystem::getAbsolutePath(fp, getGamelistRecoveryPath(system));
-	path = Utils::FileSystem::getCanonicalPath(path);
-
-	return saveToXml(file, path);
+	// The change goes to the journal, until the background writer merges it into gamelist.xml
+	GamelistWriter::queue(file);
+	return true;
 }
 
 bool removeFromGamelistRecovery(FileData* file)
@@ -320,13 +401,7 @@ bool removeFromGamelistRecovery(FileData* file)
 	if (system == nullptr)
 		return false;
 
-	std::string fp = file->getFullPath();
-	fp = Utils::FileSystem::createRelativePath(file->getFullPath(), system->getRootFolder()->getFullPath(), true);
-	fp = Utils::FileSystem::getParent(fp) + "/" + Utils::FileSystem::getStem(fp) + ".xml";
-
-	std::string path = Utils::FileSystem::getAbsolutePath(fp, getGamelistRecoveryPath(system));
-	path = Utils::FileSystem::getCanonicalPath(path);
-
+	std::string path = getGamelistRecoveryFile(file);
 	if (Utils::FileSystem::exists(path))
 		return Utils::FileSystem::removeFile(path);
 
@@ -351,111 +426,7 @@ bool hasDirtyFile(SystemData* system)
 
 void updateGamelist(SystemData* system)
 {
-	// We do this by reading the XML again, adding changes and then writing it back,
-	// because there might be information missing in our systemdata which would then miss in the new XML.
-	// We have the complete information for every game though, so we can simply remove a game
-	// we already have in the system from the XML, and then add it back from its GameData information...
-
-	if (system == nullptr || Settings::IgnoreGamelist())
-		return;
-
-	if (!system->isGameSystem() || system->isCollection() || (!Settings::HiddenSystemsShowGames() && system->isHidden()))
-		return;
-
-	FolderData* rootFolder = system->getRootFolder();
-	if (rootFolder == nullptr)
-	{
-		LOG(LogError) << "Found no root folder for system \"" << system->getName() << "\"!";
-		return;
-	}
-
-	std::vector<FileData*> dirtyFiles;
-	
-	auto files = rootFolder->getFilesRecursive(GAME | FOLDER, false, nullptr, false);
-	for (auto file : files)
-		if (file->getSystem() == system && file->getMetadata().wasChanged())
-			dirtyFiles.push_back(file);
-
-	if (dirtyFiles.size() == 0)
-	{
-		clearTemporaryGamelistRecovery(system);
-		return;
-	}
-
-	int numUpdated = 0;
-
-	pugi::xml_document doc;
-	pugi::xml_node root;
-	std::string xmlReadPath = system->getGamelistPath(false);
-
-	if(Utils::FileSystem::exists(xmlReadPath))
-	{
-		//parse an existing file first
-		pugi::xml_parse_result result = doc.load_file(WINSTRINGW(xmlReadPath).c_str());
-		if(!result)
-			LOG(LogError) << "Error parsing XML file \"" << xmlReadPath << "\"!\n	" << result.description();
-
-		root = doc.child("gameList");
-		if(!root)
-		{
-			LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlReadPath << "\"!";
-			root = doc.append_child("gameList");
-		}
-	}
-	else //set up an empty gamelist to append to		
-		root = doc.append_child("gameList");
-
-	std::map<std::string, pugi::xml_node> xmlMap;
-
-	for (pugi::xml_node fileNode : root.children())
-	{
-		pugi::xml_node path = fileNode.child("path");
-		if (path)
-		{
-			std::string nodePath = Utils::FileSystem::getCanonicalPath(Utils::FileSystem::resolveRelativePath(path.text().get(), system->getStartPath(), true));
-			xmlMap[nodePath] = fileNode;
-		}
-	}
-	
-	// iterate through all files, checking if they're already in the XML
-	for(auto file : dirtyFiles)
-	{
-		bool removed = false;
-
-		// check if the file already exists in the XML
-		// if it does, remove it before adding
-		auto xmf = xmlMap.find(Utils::FileSystem::getCanonicalPath(file->getPath()));
-		if (xmf != xmlMap.cend())
-		{
-			removed = true;
-			root.remove_child(xmf->second);
-		}
-		
-		const char* tag = (file->getType() == GAME) ? "game" : "folder";
-
-		// it was either removed or never existed to begin with; either way, we can add it now
-		if (addFileDataNode(root, file, tag, system))
-			++numUpdated; // Only if really added
-		else if (removed)
-			++numUpdated; // Only if really removed
-	}
-
-	// Now write the file
-	if (numUpdated > 0) 
-	{
-		//make sure the folders leading up to this path exist (or the write will fail)
-		std::string xmlWritePath(system->getGamelistPath(true));
-		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));
-
-		LOG(LogInfo) << "Added/Updated " << numUpdated << " entities in '" << xmlReadPath << "'";
-
-		if (!doc.save_file(WINSTRINGW(xmlWritePath).c_str()))
-			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
-		else
-			clearTemporaryGamelistRecovery(system);
-	}
-	else
-		clearTemporaryGamelistRecovery(system);
+	GamelistWriter::write(system);
 }
 
 
@@ -464,6 +435,10 @@ void cleanupGamelist(SystemData* system)
 	if (!system->isGameSystem() || system->isCollection() || (!Settings::HiddenSystemsShowGames() && !system->isVisible())) //  || system->hasPlatformId(PlatformIds::IMAGEVIEWER)
 		return;
 
+	// The gamelists of a shared catalog are maintained by the publishing node
+	if (SharedCatalog::isConsumer())
+		return;
+
 	FolderData* rootFolder = system->getRootFolder();
 	if (rootFolder == nullptr)
 	{
@@ -669,6 +644,8 @@ void cleanupGamelist(SystemData* system)
 		Utils::FileSystem::removeFile(oldXml);
 		Utils::FileSystem::copyFile(xmlWritePath, oldXml);
 
+		GamelistCache::invalidate(system);
+
 		if (!doc.save_file(WINSTRINGW(xmlWritePath).c_str()))
 			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
 		else
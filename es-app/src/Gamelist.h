@@ -9,21 +9,25 @@
 
 class SystemData;
 class FileData;
+class GamelistCache;
 
 // Loads gamelist.xml data into a SystemData.
 void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap);
 
-// Writes currently loaded metadata for a SystemData to gamelist.xml.
+// Writes currently loaded metadata for a SystemData to gamelist.xml, on the calling thread. See GamelistWriter for background saves.
 void updateGamelist(SystemData* system);
 void cleanupGamelist(SystemData* system);
 
 bool saveToGamelistRecovery(FileData* file);
 bool removeFromGamelistRecovery(FileData* file);
 
+std::string getGamelistRecoveryPath(SystemData* system);
+std::string getGamelistRecoveryFile(FileData* file);
+
 bool saveToXml(FileData* file, const std::string& fileName, bool fullPaths = false);
 
 bool hasDirtyFile(SystemData* system);
 
-std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize = SIZE_MAX, bool fromFile = true);
+std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize = SIZE_MAX, bool fromFile = true, GamelistCache* cache = nullptr);
 
 #endif // ES_APP_GAME_LIST_H
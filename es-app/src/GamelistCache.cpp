@@ -0,0 +1,294 @@
+#include "GamelistCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/MemoryMappedFile.h"
+#include "utils/StringUtil.h"
+#include "FileData.h"
+#include "SystemData.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+#include "GamelistSource.h"
+#include "SharedCatalog.h"
+
+#include <fstream>
+#include <functional>
+#include <unordered_set>
+
+#define GAMELIST_CACHE_MAGIC	0x43474C45 // 'ELGC'
+#define GAMELIST_CACHE_END		0x444E4545 // 'EEND'
+#define GAMELIST_CACHE_VERSION	"3"
+
+FileData* findOrCreateFile(SystemData* system, const std::string& path, FileType type, std::unordered_map<std::string, FileData*>& fileMap);
+
+// Walks the records of a mapped snapshot. Returns false if the file is not a valid snapshot for the key.
+static bool enumerateRecords(const Utils::MemoryMappedFile& file, const std::string& key, const std::function<void(Utils::BinaryReader& record)>& func)
+{
+	if (!file.isOpen())
+		return false;
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (reader.readUInt32() != GAMELIST_CACHE_MAGIC || reader.readString() != key)
+		return false;
+
+	uint32_t count = reader.readUInt32();
+
+	// First pass : check the structure, so that a truncated file is never partially applied
+	Utils::BinaryReader check = reader;
+	for (uint32_t i = 0; i < count && !check.failed(); i++)
+		check.readRaw(check.readUInt32());
+
+	if (check.failed() || check.readUInt32() != GAMELIST_CACHE_END)
+		return false;
+
+	if (func == nullptr)
+		return true;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t size = reader.readUInt32();
+		Utils::BinaryReader record(reader.readRaw(size), size);
+		func(record);
+	}
+
+	return true;
+}
+
+GamelistCache::GamelistCache(SystemData* system, const std::string& xmlPath) : mSystem(system)
+{
+	mKey = getKey(system, xmlPath);
+}
+
+bool GamelistCache::isEnabled()
+{
+	if (!Settings::getInstance()->getBool("GamelistCache"))
+		return false;
+
+	// Media existence checks done while parsing depend on the filesystem, not on gamelist.xml
+	if (Settings::PreloadMedias() && !Settings::ParseGamelistOnly())
+		return false;
+
+	return true;
+}
+
+std::string GamelistCache::getCachePath(SystemData* system)
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/gamelists/" + system->getName() + ".cache");
+}
+
+std::string GamelistCache::getKey(SystemData* system, const std::string& xmlPath)
+{
+	// The parts of the es_systems entry that have an effect on the tree
+	std::string key = GAMELIST_CACHE_VERSION "|" + system->getName() + "|" + system->getStartPath() + "|";
+
+	for (auto ext : system->getExtensions())
+		key += ext + " ";
+
+	key += "|" + std::to_string(Utils::FileSystem::getFileSize(xmlPath));
+	key += "|" + std::to_string((long long)Utils::FileSystem::getFileModificationDate(xmlPath).getTime());
+
+	return key;
+}
+
+void GamelistCache::invalidate(SystemData* system)
+{
+	std::string cachePath = getCachePath(system);
+	if (Utils::FileSystem::exists(cachePath))
+		Utils::FileSystem::removeFile(cachePath);
+}
+
+std::string GamelistCache::createRecord(int type, const std::string& path, const MetaDataList& mdl)
+{
+	Utils::BinaryWriter writer;
+	writer.writeUInt8((uint8_t)type);
+	writer.writeString(path);
+	mdl.saveToBinary(writer);
+	return writer.buffer();
+}
+
+void GamelistCache::add(int type, const std::string& path, const MetaDataList& mdl)
+{
+	mRecords.push_back(std::pair<std::string, std::string>(path, createRecord(type, path, mdl)));
+}
+
+bool GamelistCache::save()
+{
+	if (mRecords.size() == 0)
+		return false;
+
+	return writeRecords(getCachePath(mSystem), mKey, mRecords);
+}
+
+bool GamelistCache::writeRecords(const std::string& cachePath, const std::string& key, const std::vector<std::pair<std::string, std::string>>& records)
+{
+	Utils::BinaryWriter writer;
+	writer.writeUInt32(GAMELIST_CACHE_MAGIC);
+	writer.writeString(key);
+	writer.writeUInt32((uint32_t)records.size());
+
+	for (auto& record : records)
+	{
+		writer.writeUInt32((uint32_t)record.second.size());
+		writer.write(record.second.data(), record.second.size());
+	}
+
+	writer.writeUInt32(GAMELIST_CACHE_END);
+
+	if (!Utils::FileSystem::writeFileAtomic(cachePath, writer))
+	{
+		LOG(LogWarning) << "GamelistCache : Unable to write " << cachePath;
+		return false;
+	}
+
+	return true;
+}
+
+bool GamelistCache::readRecords(const std::string& cachePath, const std::string& key, std::vector<std::pair<std::string, std::string>>& records)
+{
+	Utils::MemoryMappedFile file(cachePath);
+
+	return enumerateRecords(file, key, [&records](Utils::BinaryReader& record)
+	{
+		const unsigned char* start = record.readRaw(0);
+		size_t size = record.remaining();
+
+		record.readUInt8(); // type
+		std::string path = record.readString();
+		if (!record.failed())
+			records.push_back(std::pair<std::string, std::string>(path, std::string((const char*)start, size)));
+	});
+}
+
+bool GamelistCache::load(SystemData* system, const std::string& xmlPath, std::unordered_map<std::string, FileData*>& fileMap)
+{
+	if (!isEnabled())
+		return false;
+
+	std::string key = getKey(system, xmlPath);
+	std::string cachePath = getCachePath(system);
+
+	Utils::MemoryMappedFile file(cachePath);
+	if (file.isOpen() && !enumerateRecords(file, key, nullptr))
+	{
+		LOG(LogDebug) << "GamelistCache : Snapshot for " << system->getName() << " is out of date";
+		file.close();
+	}
+
+	// No local snapshot : the one of the fleet is used as is, as long as it matches the same gamelist.xml
+	if (!file.isOpen())
+	{
+		cachePath = SharedCatalog::getSharedPath("cache/gamelists/" + system->getName() + ".cache");
+		if (cachePath.empty() || !file.open(cachePath))
+			return false;
+
+		if (!enumerateRecords(file, key, nullptr))
+		{
+			LOG(LogDebug) << "GamelistCache : Shared snapshot for " << system->getName() << " is out of date";
+			return false;
+		}
+	}
+
+	StopWatch stopWatch("GamelistCache::load - " + system->getName() + " :", LogDebug);
+
+	bool trustGamelist = Settings::ParseGamelistOnly();
+	int count = 0;
+
+	// Deferred fields are read back from the snapshot when needed
+	bool lazy = GamelistSource::isEnabled();
+	if (lazy)
+		system->setGamelistSource(new GamelistSource(system, GamelistSource::SNAPSHOT_SOURCE, cachePath));
+
+	const unsigned char* fileStart = file.data();
+
+	enumerateRecords(file, key, [system, &fileMap, trustGamelist, lazy, fileStart, &count](Utils::BinaryReader& record)
+	{
+		// Offset of the record size, just before the record
+		size_t offset = (size_t)(record.readRaw(0) - fileStart) - sizeof(uint32_t);
+
+		FileType type = (FileType)record.readUInt8();
+		std::string path = record.readString();
+		if (record.failed())
+			return;
+
+		FileData* file = nullptr;
+
+		if (trustGamelist)
+			file = findOrCreateFile(system, path, type, fileMap);
+		else
+		{
+			auto pGame = fileMap.find(path);
+			if (pGame != fileMap.end())
+				file = pGame->second;
+		}
+
+		if (file == nullptr || (trustGamelist && file->isArcadeAsset()))
+			return;
+
+		MetaDataList& mdl = file->getMetadata();
+		if (!mdl.loadFromBinary(record, type == FOLDER ? FOLDER_METADATA : GAME_METADATA, system, lazy))
+			return;
+
+		if (lazy)
+			mdl.setLazyRecord((unsigned int)offset, GamelistSource::hashPath(path));
+
+		// Same post-processing as in loadGamelistFile : those values depend on the file, not on gamelist.xml
+		if (mdl.getName().empty())
+			mdl.set(MetaDataId::Name, file->getDisplayName());
+
+		if (!trustGamelist && !file->getHidden() && Utils::FileSystem::isHidden(path))
+			mdl.set(MetaDataId::Hidden, "true");
+
+		mdl.resetChangedFlag();
+		count++;
+	});
+
+	LOG(LogInfo) << "GamelistCache : Restored " << count << " entries for " << system->getName() << " from snapshot";
+	return true;
+}
+
+void GamelistCache::update(SystemData* system, const std::string& previousKey, const std::string& xmlPath, const std::vector<std::pair<std::string, std::string>>& savedRecords, const std::vector<std::string>& removedPaths)
+{
+	if (!isEnabled())
+		return;
+
+	std::string cachePath = getCachePath(system);
+
+	std::vector<std::pair<std::string, std::string>> records;
+	if (!readRecords(cachePath, previousKey, records))
+	{
+		// The snapshot didn't match the previous gamelist.xml : it will be rebuilt at next start
+		invalidate(system);
+		return;
+	}
+
+	std::unordered_map<std::string, size_t> indexes;
+	for (size_t i = 0; i < records.size(); i++)
+		indexes[records[i].first] = i;
+
+	std::unordered_set<std::string> removed(removedPaths.cbegin(), removedPaths.cend());
+
+	for (auto& saved : savedRecords)
+	{
+		auto it = indexes.find(saved.first);
+		if (it != indexes.cend())
+			records[it->second].second = saved.second;
+		else
+		{
+			indexes[saved.first] = records.size();
+			records.push_back(saved);
+		}
+	}
+
+	if (removed.size())
+	{
+		std::vector<std::pair<std::string, std::string>> kept;
+		for (auto& record : records)
+			if (removed.find(record.first) == removed.cend())
+				kept.push_back(record);
+
+		records = kept;
+	}
+
+	if (!writeRecords(cachePath, getKey(system, xmlPath), records))
+		invalidate(system);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_CACHE_H
+#define ES_APP_GAMELIST_CACHE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "utils/BinaryStream.h"
+
+class SystemData;
+class FileData;
+class MetaDataList;
+
+// Binary snapshot of a parsed gamelist.xml, stored per system in the user cache folder.
+// The snapshot is keyed by the gamelist.xml size/date and the es_systems entry : as long as they don't change, the XML parsing is skipped.
+class GamelistCache
+{
+public:
+	GamelistCache(SystemData* system, const std::string& xmlPath);
+
+	// Records a gamelist.xml entry, while the XML is being parsed
+	void add(int type, const std::string& path, const MetaDataList& mdl);
+	bool save();
+
+	// Restores the metadatas into the FileData tree. Returns false if the snapshot is missing or out of date
+	static bool load(SystemData* system, const std::string& xmlPath, std::unordered_map<std::string, FileData*>& fileMap);
+
+	// Patches a snapshot after gamelist.xml has been rewritten, so that it stays valid at next start.
+	// savedRecords are ( path, record ) pairs made with createRecord
+	static void update(SystemData* system, const std::string& previousKey, const std::string& xmlPath, const std::vector<std::pair<std::string, std::string>>& savedRecords, const std::vector<std::string>& removedPaths);
+
+	static std::string createRecord(int type, const std::string& path, const MetaDataList& mdl);
+
+	static std::string getKey(SystemData* system, const std::string& xmlPath);
+	static void invalidate(SystemData* system);
+
+	static bool isEnabled();
+
+private:
+	static std::string getCachePath(SystemData* system);
+	static bool readRecords(const std::string& cachePath, const std::string& key, std::vector<std::pair<std::string, std::string>>& records);
+	static bool writeRecords(const std::string& cachePath, const std::string& key, const std::vector<std::pair<std::string, std::string>>& records);
+
+	SystemData* mSystem;
+	std::string mKey;
+	std::vector<std::pair<std::string, std::string>> mRecords;
+};
+
+#endif // ES_APP_GAMELIST_CACHE_H
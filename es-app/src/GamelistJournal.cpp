@@ -0,0 +1,290 @@
+#include "GamelistJournal.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/BinaryStream.h"
+#include "utils/MemoryMappedFile.h"
+#include "FileData.h"
+#include "SystemData.h"
+#include "Gamelist.h"
+#include "GamelistCache.h"
+#include "Log.h"
+
+#include <fstream>
+#include <functional>
+
+#if WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define GAMELIST_JOURNAL_MAGIC		0x4A474C45 // 'ELGJ'
+#define GAMELIST_JOURNAL_VERSION	1
+
+// Record kinds : [u32 size][u8 kind][u8 filetype][string path]...
+#define RECORD_FULL		1 // followed by MetaDataList::saveToBinary
+#define RECORD_DELTA	2 // followed by MetaDataList::saveChangesToBinary
+
+std::mutex GamelistJournal::mLock;
+std::set<std::string> GamelistJournal::mUnsynced;
+
+// Walks the records of a journal, stops at the first incomplete one ( interrupted append ). 'end' is the offset after the record
+static void enumerateRecords(const Utils::MemoryMappedFile& file, const std::function<void(Utils::BinaryReader& record, int kind, size_t end)>& func)
+{
+	if (!file.isOpen())
+		return;
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (reader.readUInt32() != GAMELIST_JOURNAL_MAGIC || reader.readUInt32() != GAMELIST_JOURNAL_VERSION)
+		return;
+
+	while (!reader.eof())
+	{
+		uint32_t size = reader.readUInt32();
+		const unsigned char* data = reader.readRaw(size);
+		if (data == nullptr || size == 0)
+			break;
+
+		Utils::BinaryReader record(data + 1, size - 1);
+		func(record, data[0], file.size() - reader.remaining());
+	}
+}
+
+std::string GamelistJournal::getJournalPath(SystemData* system)
+{
+	return getGamelistRecoveryPath(system) + ".journal";
+}
+
+size_t GamelistJournal::size(SystemData* system)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	return Utils::FileSystem::getFileSize(getJournalPath(system));
+}
+
+bool GamelistJournal::appendRecord(const std::string& path, int kind, const std::string& payload)
+{
+	Utils::BinaryWriter writer;
+
+	if (Utils::FileSystem::getFileSize(path) == 0)
+	{
+		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(path));
+
+		writer.writeUInt32(GAMELIST_JOURNAL_MAGIC);
+		writer.writeUInt32(GAMELIST_JOURNAL_VERSION);
+	}
+
+	writer.writeUInt32((uint32_t)payload.size() + 1);
+	writer.writeUInt8((uint8_t)kind);
+	writer.write(payload.data(), payload.size());
+
+	std::ofstream stream(WINSTRINGW(path), std::ios::binary | std::ios::app);
+	if (!stream.is_open())
+	{
+		LOG(LogWarning) << "GamelistJournal : Unable to write " << path;
+		return false;
+	}
+
+	stream.write(writer.buffer().data(), writer.size());
+	stream.close();
+
+	mUnsynced.insert(path);
+	return !stream.fail();
+}
+
+size_t GamelistJournal::append(FileData* file)
+{
+	SystemData* system = file->getSystem();
+	if (system == nullptr)
+		return 0;
+
+	MetaDataList& mdl = file->getMetadata();
+
+	Utils::BinaryWriter writer;
+	writer.writeUInt8((uint8_t)file->getType());
+	writer.writeString(file->getPath());
+
+	int kind = RECORD_DELTA;
+	std::string payload;
+
+	if (mdl.saveChangesToBinary(writer))
+		payload = writer.buffer();
+	else
+	{
+		payload = GamelistCache::createRecord(file->getType(), file->getPath(), mdl);
+		kind = RECORD_FULL;
+	}
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	std::string path = getJournalPath(system);
+	appendRecord(path, kind, payload);
+	return Utils::FileSystem::getFileSize(path);
+}
+
+void GamelistJournal::append(SystemData* system, const std::vector<std::string>& records)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	std::string path = getJournalPath(system);
+	for (auto& record : records)
+		appendRecord(path, RECORD_FULL, record);
+}
+
+void GamelistJournal::replay(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	Utils::MemoryMappedFile file(getJournalPath(system));
+	if (!file.isOpen())
+		return;
+
+	int count = 0;
+
+	enumerateRecords(file, [system, &fileMap, &count](Utils::BinaryReader& record, int kind, size_t end)
+	{
+		FileType type = (FileType)record.readUInt8();
+		std::string path = record.readString();
+		if (record.failed())
+			return;
+
+		auto it = fileMap.find(path);
+		if (it == fileMap.cend())
+			return;
+
+		MetaDataList& mdl = it->second->getMetadata();
+
+		if (kind == RECORD_FULL)
+		{
+			if (mdl.loadFromBinary(record, type == FOLDER ? FOLDER_METADATA : GAME_METADATA, system))
+				mdl.setDirty();
+		}
+		else if (kind == RECORD_DELTA)
+			mdl.loadChangesFromBinary(record);
+
+		count++;
+	});
+
+	if (count > 0)
+		LOG(LogInfo) << "GamelistJournal : Replayed " << count << " changes for " << system->getName();
+}
+
+void GamelistJournal::compact(SystemData* system, const std::map<std::string, size_t>& written)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	std::string path = getJournalPath(system);
+
+	Utils::BinaryWriter writer;
+	bool keep = false;
+
+	{
+		Utils::MemoryMappedFile file(path);
+		if (!file.isOpen())
+			return;
+
+		writer.writeUInt32(GAMELIST_JOURNAL_MAGIC);
+		writer.writeUInt32(GAMELIST_JOURNAL_VERSION);
+
+		enumerateRecords(file, [&writer, &written, &keep](Utils::BinaryReader& record, int kind, size_t end)
+		{
+			const unsigned char* start = record.readRaw(0);
+			size_t size = record.remaining();
+
+			record.readUInt8(); // type
+			std::string recordPath = record.readString();
+
+			// Already in gamelist.xml
+			auto it = written.find(recordPath);
+			if (it != written.cend() && end <= it->second)
+				return;
+
+			writer.writeUInt32((uint32_t)size + 1);
+			writer.writeUInt8((uint8_t)kind);
+			writer.write(start, size);
+			keep = true;
+		});
+	}
+
+	mUnsynced.erase(path);
+
+	if (!keep)
+	{
+		Utils::FileSystem::removeFile(path);
+		return;
+	}
+
+	// Changes made meanwhile are kept
+	if (!Utils::FileSystem::writeFileAtomic(path, writer))
+		LOG(LogWarning) << "GamelistJournal : Unable to compact " << path;
+}
+
+void GamelistJournal::rewrite(SystemData* system, const std::vector<std::string>& records)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	std::string path = getJournalPath(system);
+	mUnsynced.erase(path);
+
+	if (records.size() == 0)
+	{
+		Utils::FileSystem::removeFile(path);
+		return;
+	}
+
+	Utils::BinaryWriter writer;
+	writer.writeUInt32(GAMELIST_JOURNAL_MAGIC);
+	writer.writeUInt32(GAMELIST_JOURNAL_VERSION);
+
+	for (auto& record : records)
+	{
+		writer.writeUInt32((uint32_t)record.size() + 1);
+		writer.writeUInt8((uint8_t)RECORD_FULL);
+		writer.write(record.data(), record.size());
+	}
+
+	if (!Utils::FileSystem::writeFileAtomic(path, writer))
+		LOG(LogWarning) << "GamelistJournal : Unable to rewrite " << path;
+}
+
+void GamelistJournal::clear(SystemData* system)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	std::string path = getJournalPath(system);
+	mUnsynced.erase(path);
+
+	if (Utils::FileSystem::exists(path))
+		Utils::FileSystem::removeFile(path);
+}
+
+void GamelistJournal::sync()
+{
+	std::set<std::string> paths;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		paths = mUnsynced;
+		mUnsynced.clear();
+	}
+
+	for (auto& path : paths)
+	{
+#if WIN32
+		HANDLE hFile = CreateFileW(WINSTRINGW(path).c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (hFile != INVALID_HANDLE_VALUE)
+		{
+			FlushFileBuffers(hFile);
+			CloseHandle(hFile);
+		}
+#else
+		int fd = ::open(path.c_str(), O_WRONLY);
+		if (fd >= 0)
+		{
+			fsync(fd);
+			::close(fd);
+		}
+#endif
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_JOURNAL_H
+#define ES_APP_GAMELIST_JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <unordered_map>
+
+class SystemData;
+class FileData;
+
+// Append-only journal of the metadata changes of a system, stored next to its gamelist recovery folder.
+// A play count bump costs a few bytes here instead of a gamelist.xml rewrite : the journal is replayed when the gamelist is loaded,
+// and GamelistWriter compacts it each time it merges the changes into gamelist.xml.
+class GamelistJournal
+{
+public:
+	// Appends the changed fields of the file ( or the whole metadata if they are not tracked ). Returns the journal size after the record
+	static size_t append(FileData* file);
+
+	// Appends whole records, as made by GamelistCache::createRecord
+	static void append(SystemData* system, const std::vector<std::string>& records);
+
+	static size_t size(SystemData* system);
+
+	// Applies the journal over the loaded gamelist. Replayed entries are dirty until they're written to gamelist.xml
+	static void replay(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap);
+
+	// Drops the records that have been merged into gamelist.xml : 'written' maps a path to the journal size when its entry was serialized
+	static void compact(SystemData* system, const std::map<std::string, size_t>& written);
+
+	// Replaces the journal with whole records, as made by GamelistCache::createRecord
+	static void rewrite(SystemData* system, const std::vector<std::string>& records);
+
+	static void clear(SystemData* system);
+
+	// Flushes the appended records to the storage. Appends are not synced one by one, the writer thread calls this in batches
+	static void sync();
+
+private:
+	static std::string getJournalPath(SystemData* system);
+	static bool appendRecord(const std::string& path, int kind, const std::string& payload);
+
+	static std::mutex mLock;
+	static std::set<std::string> mUnsynced;
+};
+
+#endif // ES_APP_GAMELIST_JOURNAL_H
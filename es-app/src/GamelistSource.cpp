@@ -0,0 +1,212 @@
+#include "GamelistSource.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/BinaryStream.h"
+#include "MetaData.h"
+#include "SystemData.h"
+#include "Settings.h"
+#include "MemoryProfile.h"
+#include "GamelistStream.h"
+#include "Log.h"
+
+#include <pugixml/src/pugixml.hpp>
+#include <fstream>
+
+#define MAX_RECORD_SIZE		(4 * 1024 * 1024)
+#define READ_BLOCK_SIZE		4096
+
+GamelistSource::GamelistSource(SystemData* system, SourceType type, const std::string& path) : mSystem(system), mType(type), mPath(path)
+{
+
+}
+
+bool GamelistSource::isEnabled()
+{
+	if (!Settings::getInstance()->getBool("LazyMetadata") && !MemoryProfile::isLowMemory())
+		return false;
+
+	// Medias are checked while parsing in this mode
+	if (Settings::PreloadMedias() && !Settings::ParseGamelistOnly())
+		return false;
+
+	return true;
+}
+
+// FNV-1a : std::hash is only 32 bits on some of our targets
+unsigned long long GamelistSource::hashPath(const std::string& path)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+
+	for (auto c : path)
+	{
+		hash ^= (unsigned char)c;
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+// Offset of the '<' starting the node in the file, -1 if unknown. offset_debug points to the node name
+long long GamelistSource::getRecordOffset(const pugi::xml_node& node)
+{
+	std::ptrdiff_t offset = node.offset_debug();
+	if (offset < 1)
+		return -1;
+
+	return (long long)offset - 1;
+}
+
+static std::string getFileStamp(const std::string& path)
+{
+	return std::to_string(Utils::FileSystem::getFileSize(path)) + "|" + std::to_string((long long)Utils::FileSystem::getFileModificationDate(path).getTime());
+}
+
+void GamelistSource::materialize(MetaDataList* mdl)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	// Another thread may have done it while we were waiting
+	if (mdl->mLazyOffset == 0)
+		return;
+
+	size_t offset = mdl->mLazyOffset - 1;
+	unsigned long long pathHash = mdl->mLazyPathHash;
+
+	MetaDataList record(mdl->getType());
+
+	bool loaded = (mType == SNAPSHOT_SOURCE ? readSnapshotRecord(offset, pathHash, record) : readXmlRecord(offset, pathHash, record));
+	if (!loaded)
+	{
+		// The record moved : look for it in the current gamelist.xml
+		std::string stamp = getFileStamp(mSystem->getGamelistPath(false));
+		if (mIndexStamp != stamp)
+		{
+			buildXmlIndex();
+			mIndexStamp = stamp;
+		}
+
+		auto it = mIndex.find(pathHash);
+		if (it != mIndex.cend())
+			loaded = readXmlRecord(it->second, pathHash, record);
+	}
+
+	if (loaded)
+		mdl->mergeDeferredFields(record);
+	else
+		LOG(LogWarning) << "GamelistSource : Unable to find the metadata record in " << mPath;
+
+	mdl->mLazyOffset = 0;
+}
+
+bool GamelistSource::readXmlRecord(size_t offset, unsigned long long pathHash, MetaDataList& dest)
+{
+	std::string tag = dest.getType() == FOLDER_METADATA ? "folder" : "game";
+	std::string endTag = "</" + tag + ">";
+
+	std::ifstream stream(WINSTRINGW(mPath), std::ios::in | std::ios::binary);
+	if (!stream.is_open())
+		return false;
+
+	stream.seekg(offset, std::ios::beg);
+	if (stream.fail())
+		return false;
+
+	std::string buffer;
+	size_t end = std::string::npos;
+
+	char block[READ_BLOCK_SIZE];
+	while (end == std::string::npos && buffer.size() < MAX_RECORD_SIZE)
+	{
+		stream.read(block, READ_BLOCK_SIZE);
+
+		size_t read = (size_t)stream.gcount();
+		if (read == 0)
+			break;
+
+		size_t searchFrom = buffer.size() > endTag.size() ? buffer.size() - endTag.size() : 0;
+		buffer.append(block, read);
+
+		if (!Utils::String::startsWith(buffer, "<" + tag))
+			return false;
+
+		end = buffer.find(endTag, searchFrom);
+	}
+
+	if (end == std::string::npos)
+		return false;
+
+	pugi::xml_document doc;
+	if (!doc.load_buffer(buffer.data(), end + endTag.size()))
+		return false;
+
+	pugi::xml_node node = doc.first_child();
+	std::string path = Utils::FileSystem::resolveRelativePath(node.child("path").text().get(), mSystem->getStartPath(), false);
+	if (hashPath(path) != pathHash)
+		return false;
+
+	dest.loadFromXML(dest.getType(), node, mSystem);
+	return true;
+}
+
+bool GamelistSource::readSnapshotRecord(size_t offset, unsigned long long pathHash, MetaDataList& dest)
+{
+	std::ifstream stream(WINSTRINGW(mPath), std::ios::in | std::ios::binary);
+	if (!stream.is_open())
+		return false;
+
+	uint32_t size = 0;
+
+	stream.seekg(offset, std::ios::beg);
+	stream.read((char*)&size, sizeof(size));
+	if (stream.fail() || size == 0 || size > MAX_RECORD_SIZE)
+		return false;
+
+	std::string buffer(size, 0);
+	stream.read(&buffer[0], size);
+	if ((size_t)stream.gcount() != size)
+		return false;
+
+	Utils::BinaryReader reader((const unsigned char*)buffer.data(), buffer.size());
+	reader.readUInt8(); // type
+
+	if (hashPath(reader.readString()) != pathHash || reader.failed())
+		return false;
+
+	return dest.loadFromBinary(reader, dest.getType(), mSystem);
+}
+
+bool GamelistSource::buildXmlIndex()
+{
+	mIndex.clear();
+
+	// From now on, records are read from gamelist.xml
+	mType = XML_SOURCE;
+	mPath = mSystem->getGamelistPath(false);
+
+	GamelistStream stream(mPath);
+	if (!stream.open())
+		return false;
+
+	std::string relativeTo = mSystem->getStartPath();
+
+	pugi::xml_document record;
+	size_t offset;
+
+	while (stream.next(record, offset))
+	{
+		pugi::xml_node fileNode = record.first_child();
+
+		std::string tag = fileNode.name();
+		if (tag != "game" && tag != "folder")
+			continue;
+
+		std::string path = Utils::FileSystem::resolveRelativePath(fileNode.child("path").text().get(), relativeTo, false);
+		mIndex[hashPath(path)] = offset;
+	}
+
+	if (stream.hasError())
+		return false;
+
+	return true;
+}
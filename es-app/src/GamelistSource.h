@@ -0,0 +1,49 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_SOURCE_H
+#define ES_APP_GAMELIST_SOURCE_H
+
+#include <string>
+#include <mutex>
+#include <unordered_map>
+
+class SystemData;
+class MetaDataList;
+
+namespace pugi { class xml_node; }
+
+// The file a system's lazy metadata comes from ( gamelist.xml or the gamelist snapshot ).
+// Lazy MetaDataLists only keep the offset of their record : the deferred fields are read back from here on first access.
+class GamelistSource
+{
+public:
+	enum SourceType
+	{
+		XML_SOURCE,
+		SNAPSHOT_SOURCE
+	};
+
+	GamelistSource(SystemData* system, SourceType type, const std::string& path);
+
+	void materialize(MetaDataList* mdl);
+
+	static unsigned long long hashPath(const std::string& path);
+	static long long getRecordOffset(const pugi::xml_node& node);
+	static bool isEnabled();
+
+private:
+	bool readXmlRecord(size_t offset, unsigned long long pathHash, MetaDataList& dest);
+	bool readSnapshotRecord(size_t offset, unsigned long long pathHash, MetaDataList& dest);
+	bool buildXmlIndex();
+
+	SystemData* mSystem;
+	SourceType mType;
+	std::string mPath;
+
+	std::mutex mLock;
+
+	// Offsets in the current gamelist.xml, built when records have moved ( gamelist.xml or snapshot rewritten )
+	std::unordered_map<unsigned long long, size_t> mIndex;
+	std::string mIndexStamp;
+};
+
+#endif // ES_APP_GAMELIST_SOURCE_H
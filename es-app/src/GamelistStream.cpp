@@ -0,0 +1,301 @@
+#include "GamelistStream.h"
+
+#include "utils/StringUtil.h"
+#include "Log.h"
+
+#include <cstring>
+
+#define READ_BLOCK_SIZE		(64 * 1024)
+#define MAX_RECORD_SIZE		(4 * 1024 * 1024)
+#define WRITE_BUFFER_SIZE	(256 * 1024)
+
+GamelistStream::GamelistStream(const std::string& path) : mPath(path), mPosition(0), mBufferOffset(0), mEncoding(pugi::encoding_auto), mEnd(false), mError(false)
+{
+
+}
+
+bool GamelistStream::fail(const std::string& message)
+{
+	LOG(LogError) << "Error parsing XML file \"" << mPath << "\"!\n	" << message;
+
+	mError = true;
+	mEnd = true;
+	return false;
+}
+
+// Drops what has been read, then appends a block
+bool GamelistStream::fill()
+{
+	if (mPosition > 0)
+	{
+		mBuffer.erase(0, mPosition);
+		mBufferOffset += mPosition;
+		mPosition = 0;
+	}
+
+	if (!mStream.good())
+		return false;
+
+	size_t size = mBuffer.size();
+	mBuffer.resize(size + READ_BLOCK_SIZE);
+	mStream.read(&mBuffer[size], READ_BLOCK_SIZE);
+
+	size_t read = (size_t)mStream.gcount();
+	mBuffer.resize(size + read);
+	return read > 0;
+}
+
+bool GamelistStream::ensure(size_t count)
+{
+	while (mBuffer.size() - mPosition < count)
+		if (!fill())
+			return false;
+
+	return true;
+}
+
+bool GamelistStream::startsWith(const char* token)
+{
+	size_t length = strlen(token);
+	return ensure(length) && mBuffer.compare(mPosition, length, token) == 0;
+}
+
+// Position of token from the next character to read, reading more blocks until it's found ( within MAX_RECORD_SIZE )
+size_t GamelistStream::find(const std::string& token, size_t from)
+{
+	while (true)
+	{
+		size_t pos = mBuffer.find(token, mPosition + from);
+		if (pos != std::string::npos)
+			return pos - mPosition;
+
+		size_t available = mBuffer.size() - mPosition;
+		if (available > MAX_RECORD_SIZE)
+			return std::string::npos;
+
+		// The token may straddle the next block
+		from = available >= token.size() ? available - token.size() + 1 : 0;
+
+		if (!fill())
+			return std::string::npos;
+	}
+}
+
+bool GamelistStream::skipNode(const char* end)
+{
+	size_t pos = find(end, 1);
+	if (pos == std::string::npos)
+		return fail(std::string("Unterminated node, expecting ") + end);
+
+	mPosition += pos + strlen(end);
+	return true;
+}
+
+bool GamelistStream::open()
+{
+	mStream.open(WINSTRINGW(mPath), std::ios::in | std::ios::binary);
+	if (!mStream.is_open())
+		return fail("Unable to open the file");
+
+	// Prolog : the declaration, comments & doctype until <gameList
+	while (true)
+	{
+		size_t pos = find("<", 0);
+		if (pos == std::string::npos)
+			return fail("No document element found");
+
+		mPosition += pos;
+
+		if (startsWith("<?"))
+		{
+			size_t end = find("?>", 2);
+			if (end == std::string::npos)
+				return fail("Unterminated declaration");
+
+			// The records are parsed alone : they can't see the encoding of the declaration
+			std::string declaration = Utils::String::toLower(mBuffer.substr(mPosition, end));
+			if (declaration.find("iso-8859-1") != std::string::npos || declaration.find("latin1") != std::string::npos)
+				mEncoding = pugi::encoding_latin1;
+
+			mPosition += end + 2;
+		}
+		else if (startsWith("<!--"))
+		{
+			if (!skipNode("-->"))
+				return false;
+		}
+		else if (startsWith("<!"))
+		{
+			if (!skipNode(">"))
+				return false;
+		}
+		else
+			break;
+	}
+
+	if (!startsWith("<gameList"))
+	{
+		LOG(LogError) << "Could not find <gameList> node in gamelist \"" << mPath << "\"!";
+		mError = true;
+		return false;
+	}
+
+	size_t end = find(">", 1);
+	if (end == std::string::npos)
+		return fail("Unterminated <gameList> node");
+
+	// The start tag alone, closed to make it a document : it only brings the attributes
+	std::string root = mBuffer.substr(mPosition, end + 1);
+	if (mBuffer[mPosition + end - 1] == '/')
+		mEnd = true;
+	else
+		root.insert(root.size() - 1, "/");
+
+	mPosition += end + 1;
+
+	pugi::xml_parse_result result = mRootDoc.load_buffer(root.data(), root.size(), pugi::parse_default, mEncoding);
+	if (!result)
+		return fail(result.description());
+
+	return true;
+}
+
+bool GamelistStream::next(pugi::xml_document& doc, size_t& offset)
+{
+	while (!mEnd)
+	{
+		// Between the records, only blanks
+		size_t pos = find("<", 0);
+		if (pos == std::string::npos)
+			return fail("Unterminated <gameList> node");
+
+		mPosition += pos;
+
+		if (startsWith("</"))
+		{
+			mEnd = true;
+			return false;
+		}
+
+		if (startsWith("<!--"))
+		{
+			if (!skipNode("-->"))
+				return false;
+
+			continue;
+		}
+
+		if (startsWith("<?"))
+		{
+			if (!skipNode("?>"))
+				return false;
+
+			continue;
+		}
+
+		size_t startEnd = find(">", 1);
+		if (startEnd == std::string::npos)
+			return fail("Unterminated node");
+
+		size_t end = startEnd + 1;
+
+		if (mBuffer[mPosition + startEnd - 1] != '/')
+		{
+			size_t nameEnd = mBuffer.find_first_of(" \t\r\n/>", mPosition + 1) - mPosition;
+			std::string endTag = "</" + mBuffer.substr(mPosition + 1, nameEnd - 1) + ">";
+
+			size_t close = find(endTag, startEnd + 1);
+			if (close == std::string::npos)
+				return fail("Unterminated node, expecting " + endTag);
+
+			end = close + endTag.size();
+		}
+
+		offset = mBufferOffset + mPosition;
+
+		pugi::xml_parse_result result = doc.load_buffer(mBuffer.data() + mPosition, end, pugi::parse_default, mEncoding);
+		mPosition += end;
+
+		if (!result)
+			return fail(std::string(result.description()) + " at offset " + std::to_string(offset + result.offset));
+
+		return true;
+	}
+
+	return false;
+}
+
+GamelistOutputStream::GamelistOutputStream(const std::string& path) : mPath(path)
+{
+
+}
+
+GamelistOutputStream::~GamelistOutputStream()
+{
+	if (mStream.is_open())
+		mStream.close();
+}
+
+bool GamelistOutputStream::open(pugi::xml_node root)
+{
+	mStream.open(WINSTRINGW(mPath), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!mStream.is_open())
+		return false;
+
+	mBuffer.reserve(WRITE_BUFFER_SIZE + READ_BLOCK_SIZE);
+	mBuffer = "<?xml version=\"1.0\"?>\n";
+
+	if (!root)
+	{
+		mBuffer += "<gameList>\n";
+		return true;
+	}
+
+	// The element is printed empty, then reopened : pugixml escapes the attributes
+	size_t start = mBuffer.size();
+	root.print(*this, "", pugi::format_raw);
+
+	size_t end = mBuffer.rfind("/>");
+	if (end == std::string::npos || end < start)
+		return false;
+
+	while (end > start && mBuffer[end - 1] == ' ')
+		end--;
+
+	mBuffer.resize(end);
+	mBuffer += ">\n";
+	return true;
+}
+
+void GamelistOutputStream::writeRecord(pugi::xml_node node)
+{
+	node.print(*this, "\t", pugi::format_default, pugi::encoding_utf8, 1);
+}
+
+void GamelistOutputStream::write(const void* data, size_t size)
+{
+	mBuffer.append((const char*)data, size);
+
+	if (mBuffer.size() >= WRITE_BUFFER_SIZE)
+		flush();
+}
+
+void GamelistOutputStream::flush()
+{
+	if (!mBuffer.empty() && mStream.is_open())
+		mStream.write(mBuffer.data(), mBuffer.size());
+
+	mBuffer.clear();
+}
+
+bool GamelistOutputStream::close()
+{
+	if (!mStream.is_open())
+		return false;
+
+	mBuffer += "</gameList>\n";
+	flush();
+
+	mStream.close();
+	return !mStream.fail();
+}
@@ -0,0 +1,74 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_STREAM_H
+#define ES_APP_GAMELIST_STREAM_H
+
+#include <pugixml/src/pugixml.hpp>
+#include <fstream>
+#include <string>
+
+// Reads a gamelist.xml one record at a time : only the block being read and the current record are in memory, whatever the size of the file.
+// Each child of <gameList> is parsed into its own small document, so the records go through the same code as with the whole DOM
+class GamelistStream
+{
+public:
+	GamelistStream(const std::string& path);
+
+	// False if the file can't be read or doesn't start with a <gameList> element
+	bool open();
+
+	// <gameList> with its attributes, without children
+	pugi::xml_node getRoot() { return mRootDoc.first_child(); }
+
+	// The next child of <gameList> into doc, offset being the position of its '<' in the file.
+	// False after </gameList>, or on a broken record ( hasError )
+	bool next(pugi::xml_document& doc, size_t& offset);
+	bool hasError() { return mError; }
+
+private:
+	bool fill();
+	bool ensure(size_t count);
+	bool startsWith(const char* token);
+	size_t find(const std::string& token, size_t from);
+	bool skipNode(const char* end);
+	bool fail(const std::string& message);
+
+	std::string		mPath;
+	std::ifstream	mStream;
+
+	std::string		mBuffer;
+	size_t			mPosition;		// Position in mBuffer of the next character to read
+	size_t			mBufferOffset;	// Position of mBuffer in the file
+
+	pugi::xml_document	mRootDoc;
+	pugi::xml_encoding	mEncoding;
+
+	bool mEnd;
+	bool mError;
+};
+
+// Writes a gamelist.xml sequentially through a buffer : the records are printed one after the other, no document holds the whole list.
+// The output is the same as pugixml's save_file
+class GamelistOutputStream : public pugi::xml_writer
+{
+public:
+	GamelistOutputStream(const std::string& path);
+	~GamelistOutputStream();
+
+	// Starts <gameList>, with the attributes of root if it's not null
+	bool open(pugi::xml_node root);
+	void writeRecord(pugi::xml_node node);
+
+	// Ends <gameList> : false if anything could not be written
+	bool close();
+
+	void write(const void* data, size_t size) override;
+
+private:
+	void flush();
+
+	std::string		mPath;
+	std::ofstream	mStream;
+	std::string		mBuffer;
+};
+
+#endif // ES_APP_GAMELIST_STREAM_H
@@ -0,0 +1,520 @@
+#include "GamelistWriter.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "FileData.h"
+#include "SystemData.h"
+#include "Settings.h"
+#include "Gamelist.h"
+#include "GamelistCache.h"
+#include "GamelistJournal.h"
+#include "GamelistStream.h"
+#include "SharedCatalog.h"
+#include "Log.h"
+#include "TaskScheduler.h"
+
+#include <vector>
+#include <set>
+#include <algorithm>
+
+// Delay without changes before a system is written, and longest delay for a system which keeps changing. Until then, changes live in the journal
+#define WRITE_DELAY_MS		30000
+#define WRITE_MAX_DELAY_MS	300000
+
+// Journal size which triggers a write without waiting for the system to be idle
+#define JOURNAL_COMPACT_SIZE	(64 * 1024)
+
+// Journal appends are synced to the storage in batches
+#define JOURNAL_SYNC_DELAY_MS	1000
+
+bool addFileDataNode(pugi::xml_node& parent, FileData* file, const char* tag, SystemData* system, bool fullPaths = false);
+
+std::mutex GamelistWriter::mLock;
+std::condition_variable GamelistWriter::mEvent;
+std::thread* GamelistWriter::mThread = nullptr;
+bool GamelistWriter::mExit = false;
+std::map<SystemData*, GamelistWriter::Job*> GamelistWriter::mJobs;
+SystemData* GamelistWriter::mWritingSystem = nullptr;
+bool GamelistWriter::mSyncPending = false;
+std::chrono::steady_clock::time_point GamelistWriter::mSyncDue;
+
+GamelistWriter::Job::Job(SystemData* sys) : system(sys)
+{
+	doc.append_child("gameList");
+	firstQueued = due = std::chrono::steady_clock::now();
+}
+
+bool GamelistWriter::canWrite(SystemData* system)
+{
+	if (system == nullptr || Settings::IgnoreGamelist())
+		return false;
+
+	if (!system->isGameSystem() || system->isCollection() || (!Settings::HiddenSystemsShowGames() && system->isHidden()))
+		return false;
+
+	return system->getRootFolder() != nullptr;
+}
+
+void GamelistWriter::addEntry(Job* job, FileData* file, size_t journalOffset)
+{
+	pugi::xml_node root = job->doc.child("gameList");
+
+	Entry entry;
+	entry.path = file->getPath();
+	entry.recoveryPath = getGamelistRecoveryFile(file);
+	entry.journalOffset = journalOffset;
+
+	auto it = job->entries.find(entry.path);
+	if (it != job->entries.cend() && it->second.node)
+		root.remove_child(it->second.node);
+
+	const char* tag = (file->getType() == GAME) ? "game" : "folder";
+
+	if (addFileDataNode(root, file, tag, job->system))
+	{
+		entry.node = root.last_child();
+		entry.record = GamelistCache::createRecord(file->getType(), entry.path, file->getMetadata());
+	}
+
+	job->entries[entry.path] = entry;
+
+	// The entry is owned by the writer from now on
+	file->getMetadata().resetChangedFlag();
+}
+
+void GamelistWriter::queue(FileData* file)
+{
+	FileData* source = file->getSourceFileData();
+
+	SystemData* system = source->getSystem();
+	if (!canWrite(system))
+		return;
+
+	// A few bytes in the journal : the change is safe, gamelist.xml can wait
+	size_t journalSize = GamelistJournal::append(source);
+
+	if (SharedCatalog::isConsumer())
+	{
+		if (journalSize > JOURNAL_COMPACT_SIZE)
+			rewriteJournal(system);
+	}
+	else
+	{
+		Job* job = new Job(system);
+		addEntry(job, source, journalSize);
+		queueJob(job, journalSize > JOURNAL_COMPACT_SIZE);
+	}
+
+	std::unique_lock<std::mutex> lock(mLock);
+	if (!mSyncPending)
+	{
+		mSyncPending = true;
+		mSyncDue = std::chrono::steady_clock::now() + std::chrono::milliseconds(JOURNAL_SYNC_DELAY_MS);
+		mEvent.notify_all();
+	}
+}
+
+// The gamelists of a shared catalog belong to the publishing node : the changes of the others only live in their journal,
+// which is replayed over the shared gamelist at each start. The entries stay dirty, the journal is rewritten with one record per entry
+void GamelistWriter::rewriteJournal(SystemData* system)
+{
+	std::vector<std::string> records;
+
+	for (auto file : system->getRootFolder()->getFilesRecursive(GAME | FOLDER, false, nullptr, false))
+		if (file->getSystem() == system && file->getMetadata().wasChanged())
+			records.push_back(GamelistCache::createRecord(file->getType(), file->getPath(), file->getMetadata()));
+
+	GamelistJournal::rewrite(system, records);
+}
+
+void GamelistWriter::queue(SystemData* system)
+{
+	if (!canWrite(system))
+		return;
+
+	if (SharedCatalog::isConsumer())
+	{
+		rewriteJournal(system);
+		return;
+	}
+
+	Job* job = new Job(system);
+	size_t journalSize = GamelistJournal::size(system);
+
+	for (auto file : system->getRootFolder()->getFilesRecursive(GAME | FOLDER, false, nullptr, false))
+		if (file->getSystem() == system && file->getMetadata().wasChanged())
+			addEntry(job, file, journalSize);
+
+	if (job->entries.size() == 0)
+	{
+		delete job;
+
+		// Nothing left to save : the journal & recovery files are obsolete, unless the worker still has something for this system
+		std::unique_lock<std::mutex> lock(mLock);
+		if (mWritingSystem != system && mJobs.find(system) == mJobs.cend())
+		{
+			GamelistJournal::clear(system);
+			Utils::FileSystem::deleteDirectoryFiles(getGamelistRecoveryPath(system), true);
+		}
+
+		return;
+	}
+
+	queueJob(job, true);
+}
+
+void GamelistWriter::queueJob(Job* job, bool immediate)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto now = std::chrono::steady_clock::now();
+
+	auto it = mJobs.find(job->system);
+	if (it == mJobs.cend())
+		mJobs[job->system] = job;
+	else
+	{
+		// Coalesce with the entries waiting for this system : the newest ones win
+		Job* pending = it->second;
+		pugi::xml_node root = pending->doc.child("gameList");
+
+		for (auto& item : job->entries)
+		{
+			Entry entry = item.second;
+
+			auto prev = pending->entries.find(entry.path);
+			if (prev != pending->entries.cend() && prev->second.node)
+				root.remove_child(prev->second.node);
+
+			if (entry.node)
+				entry.node = root.append_copy(entry.node);
+
+			pending->entries[entry.path] = entry;
+		}
+
+		delete job;
+		job = pending;
+	}
+
+	if (immediate)
+		job->due = now;
+	else
+		job->due = std::min(now + std::chrono::milliseconds(WRITE_DELAY_MS), job->firstQueued + std::chrono::milliseconds(WRITE_MAX_DELAY_MS));
+
+	if (mThread == nullptr)
+	{
+		mExit = false;
+		mThread = new std::thread(&GamelistWriter::run);
+	}
+
+	mEvent.notify_all();
+}
+
+void GamelistWriter::write(SystemData* system)
+{
+	if (!canWrite(system))
+		return;
+
+	if (SharedCatalog::isConsumer())
+	{
+		rewriteJournal(system);
+		return;
+	}
+
+	Job* job = nullptr;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		// Don't write the same file from two threads
+		mEvent.wait(lock, [system] { return mWritingSystem != system; });
+
+		auto it = mJobs.find(system);
+		if (it != mJobs.cend())
+		{
+			job = it->second;
+			mJobs.erase(it);
+		}
+		else
+			job = new Job(system);
+
+		mWritingSystem = system;
+	}
+
+	size_t journalSize = GamelistJournal::size(system);
+
+	for (auto file : system->getRootFolder()->getFilesRecursive(GAME | FOLDER, false, nullptr, false))
+		if (file->getSystem() == system && file->getMetadata().wasChanged())
+			addEntry(job, file, journalSize);
+
+	if (job->entries.size() == 0)
+	{
+		GamelistJournal::clear(system);
+		Utils::FileSystem::deleteDirectoryFiles(getGamelistRecoveryPath(system), true);
+	}
+	else
+		writeJob(job);
+
+	delete job;
+
+	std::unique_lock<std::mutex> lock(mLock);
+	mWritingSystem = nullptr;
+	mEvent.notify_all();
+}
+
+// Same as the previous synchronous updateGamelist : the existing records are copied, because there might be information missing in our systemdata
+// which would then miss in the new XML. gamelist.xml is streamed to a temporary file one record at a time : a saved entry takes the place
+// of its old record, the new ones go at the end
+void GamelistWriter::writeJob(Job* job)
+{
+	SystemData* system = job->system;
+
+	std::string xmlReadPath = system->getGamelistPath(false);
+	std::string previousCacheKey = GamelistCache::getKey(system, xmlReadPath);
+
+	//make sure the folders leading up to this path exist (or the write will fail)
+	std::string xmlWritePath(system->getGamelistPath(true));
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));
+
+	// Streamed to a temporary file, renamed over gamelist.xml once complete
+	std::string tmpPath = xmlWritePath + ".tmp";
+
+	// Matched with the records of gamelist.xml by their canonical path
+	std::map<std::string, Entry*> entries;
+	for (auto& item : job->entries)
+		entries[Utils::FileSystem::getCanonicalPath(item.second.path)] = &item.second;
+
+	GamelistStream input(xmlReadPath);
+	bool hasInput = Utils::FileSystem::exists(xmlReadPath) && input.open();
+
+	GamelistOutputStream output(tmpPath);
+	bool ok = output.open(hasInput ? input.getRoot() : pugi::xml_node());
+
+	int numUpdated = 0;
+
+	std::vector<std::pair<std::string, std::string>> savedRecords;
+	std::vector<std::string> removedPaths;
+	std::set<std::string> done;
+
+	auto writeEntry = [&](const std::string& key, Entry* entry, bool removed)
+	{
+		// A path listed twice in gamelist.xml : the duplicates go away
+		if (!done.insert(key).second)
+			return;
+
+		if (entry->node)
+		{
+			output.writeRecord(entry->node);
+			++numUpdated;
+
+			savedRecords.push_back(std::pair<std::string, std::string>(entry->path, entry->record));
+		}
+		else if (removed)
+		{
+			++numUpdated; // Only if really removed
+			removedPaths.push_back(entry->path);
+		}
+	};
+
+	if (ok && hasInput)
+	{
+		pugi::xml_document record;
+		size_t offset;
+
+		while (input.next(record, offset))
+		{
+			pugi::xml_node fileNode = record.first_child();
+
+			pugi::xml_node path = fileNode.child("path");
+			if (path)
+			{
+				std::string nodePath = Utils::FileSystem::getCanonicalPath(Utils::FileSystem::resolveRelativePath(path.text().get(), system->getStartPath(), true));
+
+				auto it = entries.find(nodePath);
+				if (it != entries.cend())
+				{
+					writeEntry(it->first, it->second, true);
+					continue;
+				}
+			}
+
+			output.writeRecord(fileNode);
+		}
+
+		// A broken record stops the copy : the records after it would be lost
+		if (input.hasError())
+		{
+			LOG(LogError) << "GamelistWriter : broken record in \"" << xmlReadPath << "\", not saved";
+			ok = false;
+		}
+	}
+
+	for (auto& item : entries)
+		if (done.find(item.first) == done.cend())
+			writeEntry(item.first, item.second, false);
+
+	ok = output.close() && ok;
+
+	if (numUpdated == 0 && ok)
+		Utils::FileSystem::removeFile(tmpPath);
+	else
+	{
+		if (ok)
+			LOG(LogInfo) << "Added/Updated " << numUpdated << " entities in '" << xmlReadPath << "'";
+
+		if (!ok || !Utils::FileSystem::renameFile(tmpPath, xmlWritePath))
+		{
+			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
+			Utils::FileSystem::removeFile(tmpPath);
+			GamelistCache::invalidate(system);
+
+			// Keep the journal : it is applied at next start
+			return;
+		}
+
+		GamelistCache::update(system, previousCacheKey, xmlWritePath, savedRecords, removedPaths);
+
+		// Recovery files written from now on must match the new gamelist.xml
+		system->setGamelistHash(Utils::FileSystem::getFileSize(xmlWritePath));
+	}
+
+	std::map<std::string, size_t> written;
+
+	for (auto& item : job->entries)
+	{
+		written[item.second.path] = item.second.journalOffset;
+
+		// Left by older versions, before the journal
+		if (!item.second.recoveryPath.empty() && Utils::FileSystem::exists(item.second.recoveryPath))
+			Utils::FileSystem::removeFile(item.second.recoveryPath);
+	}
+
+	GamelistJournal::compact(system, written);
+}
+
+// Saves that could not be done in time : the entries go to the journal, and parseGamelist replays them at next start
+void GamelistWriter::moveToJournal(Job* job)
+{
+	std::vector<std::string> records;
+	for (auto& item : job->entries)
+		if (item.second.node)
+			records.push_back(item.second.record);
+
+	GamelistJournal::append(job->system, records);
+
+	LOG(LogWarning) << "GamelistWriter : " << job->system->getName() << " not saved in time, " << records.size() << " entries moved to the journal";
+}
+
+void GamelistWriter::run()
+{
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::BACKGROUND);
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	while (!mExit)
+	{
+		auto now = std::chrono::steady_clock::now();
+
+		if (mSyncPending && mSyncDue <= now)
+		{
+			mSyncPending = false;
+
+			lock.unlock();
+			GamelistJournal::sync();
+			lock.lock();
+			continue;
+		}
+
+		// Next system to write
+		auto next = mJobs.begin();
+		for (auto it = mJobs.begin(); it != mJobs.end(); ++it)
+			if (it->second->due < next->second->due)
+				next = it;
+
+		// Wait for write() to finish if it's working on a system
+		if (next == mJobs.end() || next->second->due > now || mWritingSystem != nullptr)
+		{
+			if (next != mJobs.end() && mWritingSystem == nullptr)
+				mEvent.wait_until(lock, mSyncPending ? std::min(next->second->due, mSyncDue) : next->second->due);
+			else if (mSyncPending)
+				mEvent.wait_until(lock, mSyncDue);
+			else
+				mEvent.wait(lock);
+
+			continue;
+		}
+
+		Job* job = next->second;
+		mJobs.erase(next);
+		mWritingSystem = job->system;
+
+		lock.unlock();
+
+		writeJob(job);
+		delete job;
+
+		lock.lock();
+		mWritingSystem = nullptr;
+		mEvent.notify_all();
+	}
+}
+
+bool GamelistWriter::isBusy()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	return mWritingSystem != nullptr || mJobs.size() > 0;
+}
+
+bool GamelistWriter::flush(int timeoutMs)
+{
+	std::vector<Job*> late;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		if (mThread == nullptr && mJobs.size() == 0 && !mSyncPending)
+			return true;
+
+		// No more waiting : everything is due now
+		for (auto& item : mJobs)
+			item.second->due = std::chrono::steady_clock::now();
+
+		mEvent.notify_all();
+
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+		mEvent.wait_until(lock, deadline, [] { return mWritingSystem == nullptr && mJobs.size() == 0; });
+
+		for (auto& item : mJobs)
+			late.push_back(item.second);
+
+		mJobs.clear();
+
+		// A write in progress can't be interrupted
+		mEvent.wait(lock, [] { return mWritingSystem == nullptr; });
+
+		mExit = true;
+		mEvent.notify_all();
+	}
+
+	if (mThread != nullptr)
+	{
+		mThread->join();
+		delete mThread;
+		mThread = nullptr;
+	}
+
+	for (auto job : late)
+	{
+		moveToJournal(job);
+		delete job;
+	}
+
+	GamelistJournal::sync();
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		mSyncPending = false;
+	}
+
+	return late.size() == 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_WRITER_H
+#define ES_APP_GAMELIST_WRITER_H
+
+#include <string>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <pugixml/src/pugixml.hpp>
+
+// Longest wait for the background saves when the systems are unloaded
+#define GAMELIST_FLUSH_TIMEOUT	5000
+
+class SystemData;
+class FileData;
+
+// Writes gamelist.xml files in a background thread.
+// Entries are serialized on the calling thread ( the FileData tree is not thread safe ) : the worker only merges them into gamelist.xml.
+// Each change is appended to the system's GamelistJournal right away. Entries queued for the same system are coalesced,
+// and gamelist.xml is only rewritten once the system has been idle for a while, or when its journal gets too large.
+class GamelistWriter
+{
+public:
+	// Journals the changes of the file, and serializes its entry for the next save of its system
+	static void queue(FileData* file);
+
+	// Serializes every dirty entry of the system, and writes them as soon as possible
+	static void queue(SystemData* system);
+
+	// Writes the dirty & pending entries of the system on the calling thread
+	static void write(SystemData* system);
+
+	// Waits for the pending saves, then stops the worker.
+	// Saves which are not done within the delay are moved to the journal, and applied at next start
+	static bool flush(int timeoutMs);
+
+	static bool isBusy();
+
+private:
+	struct Entry
+	{
+		std::string path;
+		std::string recoveryPath;
+		std::string record; // GamelistCache::createRecord
+		size_t journalOffset; // journal size when the entry was serialized
+		pugi::xml_node node; // null if the entry has to be removed from gamelist.xml
+	};
+
+	struct Job
+	{
+		Job(SystemData* sys);
+
+		SystemData* system;
+		pugi::xml_document doc;
+		std::map<std::string, Entry> entries;
+
+		std::chrono::steady_clock::time_point firstQueued;
+		std::chrono::steady_clock::time_point due;
+	};
+
+	static bool canWrite(SystemData* system);
+	static void addEntry(Job* job, FileData* file, size_t journalOffset);
+	static void queueJob(Job* job, bool immediate);
+	static void writeJob(Job* job);
+	static void moveToJournal(Job* job);
+	static void rewriteJournal(SystemData* system);
+
+	static void run();
+
+	static std::mutex		mLock;
+	static std::condition_variable	mEvent;
+	static std::thread*		mThread;
+	static bool				mExit;
+
+	static std::map<SystemData*, Job*> mJobs;
+	static SystemData*		mWritingSystem;
+
+	static bool				mSyncPending;
+	static std::chrono::steady_clock::time_point mSyncDue;
+};
+
+#endif // ES_APP_GAMELIST_WRITER_H
@@ -11,10 +11,14 @@
 #include "FileData.h"
 
 #include <set>
+#include <algorithm>
 
 std::vector<GameGenre*> Genres::mGameGenres;
-std::map<int, GameGenre*> Genres::mGenres;
-std::map<std::string, int> Genres::mAllGenresNames;
+std::unordered_map<int, GameGenre*> Genres::mGenres;
+std::unordered_map<std::string, int> Genres::mAllGenresNames;
+std::unordered_map<unsigned int, Genres::GenreIdsInfo> Genres::mGenreIdsInfos;
+std::unordered_map<unsigned int, std::string> Genres::mGenreToIds;
+std::mutex Genres::mCacheLock;
 
 void Genres::init()
 {
@@ -180,6 +184,20 @@ void Genres::init()
 				mAllGenresNames[Utils::String::toUpper(genre->nom_ja)] = genre->id;
 		}
 	}
+
+	for (auto genre : genres)
+	{
+		if (genre->parent != nullptr)
+		{
+			genre->label = genre->parent->nom_en + " / " + genre->nom_en;
+			genre->localizedLabel = genre->parent->getLocalizedName() + " / " + genre->getLocalizedName();
+		}
+		else
+		{
+			genre->label = genre->nom_en;
+			genre->localizedLabel = genre->getLocalizedName();
+		}
+	}
 }
 
 bool Genres::genreExists(int id)
@@ -231,27 +249,40 @@ std::string& GameGenre::getLocalizedName()
 	return nom_en;
 }
 
-std::vector<std::string> Genres::getGenreFiltersNames(MetaDataList* game)
+const Genres::GenreIdsInfo& Genres::getGenreIdsInfo(MetaDataList* game)
 {
-	std::vector<std::string> ret;
+	unsigned int poolId = game->getInternedId(MetaDataId::GenreIds);
 
-	auto ids = Utils::String::split(game->get(MetaDataId::GenreIds), ',', true);
-	for (auto id : ids)
+	std::unique_lock<std::mutex> lock(mCacheLock);
+
+	auto it = mGenreIdsInfos.find(poolId);
+	if (it != mGenreIdsInfos.cend())
+		return it->second;
+
+	GenreIdsInfo& info = mGenreIdsInfos[poolId];
+
+	for (auto id : Utils::String::split(game->get(MetaDataId::GenreIds), ',', true))
 	{
-		auto g = mGenres.find(Utils::String::toInteger(id));
+		int genreId = Utils::String::toInteger(id);
+		info.ids.push_back(genreId);
+
+		auto g = mGenres.find(genreId);
 		if (g != mGenres.cend())
 		{
 			if (g->second->parent != nullptr)
-			{
-				ret.push_back(std::to_string(g->second->parent->id));
-				ret.push_back(std::to_string(g->second->id));
-			}
-			else
-				ret.push_back(std::to_string(g->second->id));
+				info.filterNames.push_back(std::to_string(g->second->parent->id));
+
+			info.filterNames.push_back(std::to_string(g->second->id));
 		}
 	}
 
-	return ret;
+	std::sort(info.ids.begin(), info.ids.end());
+	return info;
+}
+
+const std::vector<std::string>& Genres::getGenreFiltersNames(MetaDataList* game)
+{
+	return getGenreIdsInfo(game).filterNames;
 }
 
 std::string Genres::genreStringFromIds(const std::vector<std::string>& ids, bool localized)
@@ -262,19 +293,7 @@ std::string Genres::genreStringFromIds(const std::vector<std::string>& ids, bool
 	{
 		auto g = mGenres.find(Utils::String::toInteger(id));
 		if (g != mGenres.cend())
-		{
-			if (g->second->parent != nullptr)
-			{
-				if (localized)
-					ret.push_back(g->second->parent->getLocalizedName() + " / " + g->second->getLocalizedName());
-				else 
-					ret.push_back(g->second->parent->nom_en + " / " + g->second->nom_en);
-
-				continue;
-			}
-
-			ret.push_back(localized ? g->second->getLocalizedName() : g->second->nom_en);
-		}
+			ret.push_back(localized ? g->second->localizedLabel : g->second->label);
 	}
 
 	return Utils::String::join(ret, ", ");
@@ -302,7 +321,7 @@ GameGenre* Genres::fromGenreName(const std::string& name)
 		{
 			auto sg = mAllGenresNames.find(Utils::String::trim(subgenre));
 			if (sg != mAllGenresNames.cend())
-				return mGenres[g->second];
+				return mGenres[sg->second];
 		}
 	}
 
@@ -311,27 +330,18 @@ GameGenre* Genres::fromGenreName(const std::string& name)
 
 bool Genres::genreExists(MetaDataList* file, int id)
 {
-	auto idToFind = std::to_string(id);
-	auto ids = Utils::String::split(file->get(MetaDataId::GenreIds), ',', true);
-	for (auto id : ids)
-		if (id == idToFind)
-			return true;
-
-	return false;
+	auto& ids = getGenreIdsInfo(file).ids;
+	return std::binary_search(ids.cbegin(), ids.cend(), id);
 }
 
-void Genres::convertGenreToGenreIds(MetaDataList* file)
+std::string Genres::findGenreIds(const std::string& genre)
 {
-	auto genre = Utils::String::toUpper(file->get(MetaDataId::Genre));
-	if (genre.empty())
-		return;
-
 	std::set<int> ids;
 
 	auto g = mAllGenresNames.find(genre);
 	if (g != mAllGenresNames.cend())
 		ids.insert(g->second);
-	else if (genre.find(",") >= 0 || genre.find("/") >= 0)
+	else if (genre.find(",") != std::string::npos || genre.find("/") != std::string::npos)
 	{
 		for (auto subgenre : Utils::String::splitAny(genre, ",/", true))
 		{
@@ -341,17 +351,40 @@ void Genres::convertGenreToGenreIds(MetaDataList* file)
 		}
 	}
 
-	if (ids.size() > 0)
+	if (ids.size() == 0)
 	{
-		std::vector<std::string> list;
-		for (auto id : ids)
-			list.push_back(std::to_string(id));
-		
-		file->set(MetaDataId::GenreIds, Utils::String::join(list, ","));
+		LOG(LogDebug) << "UNKNOWN GENRE : " << genre;
+		return "";
 	}
-	else
+
+	std::vector<std::string> list;
+	for (auto id : ids)
+		list.push_back(std::to_string(id));
+
+	return Utils::String::join(list, ",");
+}
+
+void Genres::convertGenreToGenreIds(MetaDataList* file)
+{
+	unsigned int poolId = file->getInternedId(MetaDataId::Genre);
+	std::string ids;
+
 	{
-		LOG(LogDebug) << "UNKNOWN GENRE : " << genre;
-		//file->set(MetaDataId::GenreIds, "");
+		std::unique_lock<std::mutex> lock(mCacheLock);
+
+		auto it = mGenreToIds.find(poolId);
+		if (it != mGenreToIds.cend())
+			ids = it->second;
+		else
+		{
+			auto genre = Utils::String::toUpper(file->get(MetaDataId::Genre));
+			if (!genre.empty())
+				ids = findGenreIds(genre);
+
+			mGenreToIds[poolId] = ids;
+		}
 	}
+
+	if (!ids.empty())
+		file->set(MetaDataId::GenreIds, ids);
 }
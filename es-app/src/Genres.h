@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <mutex>
 
 #define GENRE_LIGHTGUN 32
 #define GENRE_WHEEL    33
@@ -35,6 +37,10 @@ struct GameGenre
 
 	std::string& getLocalizedName();
 
+	// "Parent / Name" labels, set by Genres::init
+	std::string label;
+	std::string localizedLabel;
+
 	GameGenre* parent;
 	std::vector<GameGenre*> children;
 };
@@ -56,12 +62,27 @@ public:
 
 	static std::string					genreStringFromIds(const std::vector<std::string>& ids, bool localized = true);
 
-	static std::vector<std::string>		getGenreFiltersNames(MetaDataList* game);
+	static const std::vector<std::string>&	getGenreFiltersNames(MetaDataList* game);
 
 private:
+	// Parsed GenreIds value : games share a few distinct values, each one is parsed once
+	struct GenreIdsInfo
+	{
+		std::vector<int> ids; // sorted
+		std::vector<std::string> filterNames;
+	};
+
+	static const GenreIdsInfo& getGenreIdsInfo(MetaDataList* game);
+	static std::string findGenreIds(const std::string& genre);
+
 	static std::vector<GameGenre*> mGameGenres;
-	static std::map<int, GameGenre*> mGenres;
-	static std::map<std::string, int> mAllGenresNames;
+	static std::unordered_map<int, GameGenre*> mGenres;
+	static std::unordered_map<std::string, int> mAllGenresNames;
+
+	// By string pool id of the GenreIds & Genre values
+	static std::unordered_map<unsigned int, GenreIdsInfo> mGenreIdsInfos;
+	static std::unordered_map<unsigned int, std::string> mGenreToIds;
+	static std::mutex mCacheLock;
 };
 
 #endif // ES_CORE_GENRES_H
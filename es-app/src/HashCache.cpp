@@ -0,0 +1,195 @@
+#include "HashCache.h"
+
+#include "utils/BinaryStream.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/MemoryMappedFile.h"
+#include "utils/StringUtil.h"
+#include "Settings.h"
+#include "SharedCatalog.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <fstream>
+#include <time.h>
+
+#define HASH_CACHE_MAGIC	0x48534545 // 'EESH'
+#define HASH_CACHE_END		0x444E4545 // 'EEND'
+#define HASH_CACHE_VERSION	1
+
+// Files modified less than this before being hashed are hashed again next time ( timestamps granularity )
+#define UNSTABLE_DELAY_SECONDS	2
+
+std::unordered_map<std::string, HashCache::Entry> HashCache::mEntries;
+std::mutex HashCache::mLock;
+bool HashCache::mLoaded = false;
+bool HashCache::mChanged = false;
+
+bool HashCache::isEnabled()
+{
+	return Settings::getInstance()->getBool("HashCache");
+}
+
+std::string HashCache::getCachePath()
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/hashes.cache");
+}
+
+bool HashCache::loadFile(const std::string& path, bool shared)
+{
+	Utils::MemoryMappedFile file(path);
+	if (!file.isOpen())
+		return false;
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (reader.readUInt32() != HASH_CACHE_MAGIC || reader.readUInt32() != HASH_CACHE_VERSION)
+		return false;
+
+	std::unordered_map<std::string, Entry> entries;
+
+	uint32_t count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		Entry& entry = entries[reader.readString()];
+		entry.modificationTime = reader.readInt64();
+		entry.size = reader.readUInt64();
+		entry.shared = shared;
+
+		for (int h = 0; h < HASH_TYPES * 2; h++)
+			entry.hashes[h] = reader.readString();
+	}
+
+	// Never use a partially read cache
+	if (reader.failed() || reader.readUInt32() != HASH_CACHE_END)
+	{
+		LOG(LogWarning) << "HashCache : Ignoring invalid cache " << path;
+		return false;
+	}
+
+	if (mEntries.size() == 0)
+		mEntries = std::move(entries);
+	else
+	{
+		for (auto& it : entries)
+			mEntries[it.first] = it.second;
+	}
+
+	return true;
+}
+
+void HashCache::load()
+{
+	mLoaded = true;
+
+	// The hashes of the fleet, then the local ones over them
+	std::string sharedPath = SharedCatalog::getSharedPath("cache/hashes.cache");
+	if (!sharedPath.empty())
+		loadFile(sharedPath, true);
+
+	loadFile(getCachePath(), false);
+}
+
+bool HashCache::get(const std::string& path, HashType type, bool fromArchive, std::string& value)
+{
+	if (!isEnabled())
+		return false;
+
+	long long modificationTime;
+	unsigned long long size;
+	if (!Utils::FileSystem::getFileStamp(path, modificationTime, size))
+		return false;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (!mLoaded)
+		load();
+
+	auto it = mEntries.find(path);
+	if (it == mEntries.cend() || it->second.modificationTime != modificationTime || it->second.size != size || modificationTime == 0)
+		return false;
+
+	const std::string& hash = it->second.hashes[type * 2 + (fromArchive ? 1 : 0)];
+	if (hash.empty())
+		return false;
+
+	value = hash;
+	return true;
+}
+
+void HashCache::set(const std::string& path, HashType type, bool fromArchive, const std::string& value)
+{
+	if (!isEnabled() || value.empty())
+		return;
+
+	long long modificationTime;
+	unsigned long long size;
+	if (!Utils::FileSystem::getFileStamp(path, modificationTime, size))
+		return;
+
+	// A file changed in the same timestamp tick as its hashing can't be trusted
+	if (modificationTime / 1000000000LL + UNSTABLE_DELAY_SECONDS >= (long long)time(NULL))
+		return;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (!mLoaded)
+		load();
+
+	Entry& entry = mEntries[path];
+
+	// The file changed : the other hashes are outdated too
+	if (entry.modificationTime != modificationTime || entry.size != size)
+	{
+		entry = Entry();
+		entry.modificationTime = modificationTime;
+		entry.size = size;
+	}
+
+	entry.hashes[type * 2 + (fromArchive ? 1 : 0)] = value;
+	entry.shared = false;
+	mChanged = true;
+}
+
+void HashCache::save()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (!mChanged)
+		return;
+
+	// Entries coming from the shared cache are not copied in the local one
+	uint32_t count = 0;
+	for (auto& it : mEntries)
+		if (!it.second.shared)
+			count++;
+
+	Utils::BinaryWriter writer;
+	writer.writeUInt32(HASH_CACHE_MAGIC);
+	writer.writeUInt32(HASH_CACHE_VERSION);
+	writer.writeUInt32(count);
+
+	for (auto& it : mEntries)
+	{
+		if (it.second.shared)
+			continue;
+
+		writer.writeString(it.first);
+		writer.writeInt64(it.second.modificationTime);
+		writer.writeUInt64(it.second.size);
+
+		for (int h = 0; h < HASH_TYPES * 2; h++)
+			writer.writeString(it.second.hashes[h]);
+	}
+
+	writer.writeUInt32(HASH_CACHE_END);
+
+	std::string cachePath = getCachePath();
+
+	if (!Utils::FileSystem::writeFileAtomic(cachePath, writer))
+	{
+		LOG(LogWarning) << "HashCache : Unable to write " << cachePath;
+		return;
+	}
+
+	mChanged = false;
+	LOG(LogDebug) << "HashCache : " << count << " files saved";
+}
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef ES_APP_HASH_CACHE_H
+#define ES_APP_HASH_CACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+// Persisted hashes of the rom files, keyed by path and stamped with the file size & modification time : unchanged files are never read twice,
+// even when the gamelist is moved or a scrape drops the hash fields. Shared by the netplay CRC checks, the cheevos hashes & the scrapers
+class HashCache
+{
+public:
+	enum HashType
+	{
+		HASH_CRC32 = 0,
+		HASH_MD5 = 1,
+		HASH_CHEEVOS = 2,
+		HASH_TYPES = 3
+	};
+
+	// fromArchive : the hash was computed on the contents of a zip / 7z. Thread safe
+	static bool get(const std::string& path, HashType type, bool fromArchive, std::string& value);
+	static void set(const std::string& path, HashType type, bool fromArchive, const std::string& value);
+
+	static void save();
+	static bool isEnabled();
+
+private:
+	struct Entry
+	{
+		Entry() : modificationTime(0), size(0), shared(false) { }
+
+		long long modificationTime;
+		unsigned long long size;
+		bool shared; // Read from the SharedCatalog file, not saved locally
+		std::string hashes[HASH_TYPES * 2];
+	};
+
+	static std::string getCachePath();
+	static void load();
+	static bool loadFile(const std::string& path, bool shared);
+
+	static std::unordered_map<std::string, Entry> mEntries;
+	static std::mutex mLock;
+	static bool mLoaded;
+	static bool mChanged;
+};
+
+#endif // ES_APP_HASH_CACHE_H
@@ -322,7 +322,10 @@ std::string KeyMappingFile::joinStrings(const std::set<std::string>& items)
 void KeyMappingFile::deleteFile()
 {
 	if (!path.empty() && Utils::FileSystem::exists(path))
+	{
 		Utils::FileSystem::removeFile(path);
+		KeyMappingCache::invalidate(path);
+	}
 }
 
 void KeyMappingFile::save(const std::string& fileName)
@@ -423,10 +426,16 @@ void KeyMappingFile::save(const std::string& fileName)
 	if (fileName.empty())
 	{
 		if (!path.empty())
+		{
 			Utils::FileSystem::writeAllText(path, data);
+			KeyMappingCache::invalidate(path);
+		}
 	}
 	else
+	{
 		Utils::FileSystem::writeAllText(fileName, data);
+		KeyMappingCache::invalidate(fileName);
+	}
 }
 
 KeyMappingFile KeyMappingFile::fromP2k(const std::string& fileName)
@@ -814,4 +823,154 @@ bool KeyMappingFile::updateMappingDescription(int player, const std::string& tri
 	}
 
 	return false;
-}
\ No newline at end of file
+}
+//////////////////////////////////////////////////////////////////////////////////////
+
+std::mutex KeyMappingCache::sMutex;
+std::unordered_map<std::string, KeyMappingCache::Folder> KeyMappingCache::sFolders;
+std::list<KeyMappingCache::Mapping> KeyMappingCache::sMappings;
+int KeyMappingCache::sWatchListener = -1;
+
+bool KeyMappingCache::isMappingFile(const std::string& name)
+{
+	return Utils::String::endsWith(name, ".keys") || Utils::String::endsWith(name, ".p2k.cfg");
+}
+
+KeyMappingCache::Folder& KeyMappingCache::getFolder(const std::string& directory)
+{
+	if (sWatchListener < 0)
+	{
+		// Called from the watcher thread
+		sWatchListener = Utils::FileSystem::addFileCacheWatchListener([](const std::string& path)
+		{
+			std::unique_lock<std::mutex> lock(sMutex);
+			sFolders.erase(Utils::FileSystem::getParent(path));
+			sFolders.erase(path);
+		});
+	}
+
+	auto it = sFolders.find(directory);
+	if (it != sFolders.end() && it->second.watched)
+		return it->second;
+
+	long long modificationTime = 0;
+	unsigned long long inode = 0;
+	bool exists = Utils::FileSystem::getDirectoryStamp(directory, modificationTime, inode);
+
+	if (it != sFolders.end() && it->second.modificationTime == modificationTime && it->second.inode == inode)
+		return it->second;
+
+	Folder& folder = sFolders[directory];
+	folder.modificationTime = modificationTime;
+	folder.inode = inode;
+	folder.watched = Utils::FileSystem::isFileCacheWatched(directory);
+	folder.files.clear();
+	folder.directories.clear();
+
+	if (exists)
+	{
+		for (auto& file : Utils::FileSystem::getDirectoryFiles(directory))
+		{
+			std::string name = Utils::FileSystem::getFileName(file.path);
+
+			if (file.directory)
+				folder.directories.insert(name);
+			else if (isMappingFile(name))
+				folder.files.insert(name);
+		}
+	}
+
+	return folder;
+}
+
+bool KeyMappingCache::exists(const std::string& path)
+{
+	std::string name = Utils::FileSystem::getFileName(path);
+	if (!isMappingFile(name))
+		return Utils::FileSystem::exists(path);
+
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	auto& folder = getFolder(Utils::FileSystem::getParent(path));
+	return folder.files.find(name) != folder.files.cend();
+}
+
+bool KeyMappingCache::isDirectory(const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	auto& folder = getFolder(Utils::FileSystem::getParent(path));
+	return folder.directories.find(Utils::FileSystem::getFileName(path)) != folder.directories.cend();
+}
+
+KeyMappingFile KeyMappingCache::getMapping(const std::string& path, bool p2k)
+{
+	long long modificationTime = 0;
+	unsigned long long size = 0;
+	if (!Utils::FileSystem::getFileStamp(path, modificationTime, size))
+	{
+		KeyMappingFile ret;
+		ret.path = path;
+		return ret;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(sMutex);
+
+		for (auto it = sMappings.begin(); it != sMappings.end(); it++)
+		{
+			if (it->path != path || it->p2k != p2k)
+				continue;
+
+			if (it->modificationTime != modificationTime || it->size != size)
+			{
+				sMappings.erase(it);
+				break;
+			}
+
+			sMappings.splice(sMappings.begin(), sMappings, it);
+			return it->file;
+		}
+	}
+
+	Mapping mapping;
+	mapping.path = path;
+	mapping.p2k = p2k;
+	mapping.modificationTime = modificationTime;
+	mapping.size = size;
+	mapping.file = p2k ? KeyMappingFile::fromP2k(path) : KeyMappingFile::load(path);
+
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	sMappings.push_front(mapping);
+	if (sMappings.size() > MAX_MAPPINGS)
+		sMappings.pop_back();
+
+	return mapping.file;
+}
+
+KeyMappingFile KeyMappingCache::load(const std::string& path)
+{
+	return getMapping(path, false);
+}
+
+KeyMappingFile KeyMappingCache::fromP2k(const std::string& path)
+{
+	return getMapping(path, true);
+}
+
+void KeyMappingCache::invalidate(const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	sFolders.erase(Utils::FileSystem::getParent(path));
+	sMappings.remove_if([path](const Mapping& x) { return x.path == path; });
+}
+
+void KeyMappingCache::clear()
+{
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	sFolders.clear();
+	sMappings.clear();
+}
@@ -3,6 +3,10 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 class KeyMappingFile
 {
@@ -72,6 +76,53 @@ private:
 	void clearAnalogJoysticksMappings(int player, const std::string& trigger);
 };
 
+// Keyboard mapping files ( .keys, .p2k.cfg ) of the gamelists & menus, without probing the file system for each game :
+// the mapping files & sub directories of a folder come from a single listing, checked against the folder stamp ( or dropped on watcher events in the watched folders ),
+// and the last parsed files are kept while their stamp does not change
+class KeyMappingCache
+{
+public:
+	static const size_t MAX_MAPPINGS = 16;
+
+	static bool exists(const std::string& path);
+	static bool isDirectory(const std::string& path);
+
+	static KeyMappingFile load(const std::string& path);
+	static KeyMappingFile fromP2k(const std::string& path);
+
+	// A mapping file was written or removed
+	static void invalidate(const std::string& path);
+	static void clear();
+
+private:
+	struct Folder
+	{
+		long long						modificationTime;
+		unsigned long long				inode;
+		bool							watched;
+		std::unordered_set<std::string>	files;
+		std::unordered_set<std::string>	directories;
+	};
+
+	struct Mapping
+	{
+		std::string			path;
+		bool				p2k;
+		long long			modificationTime;
+		unsigned long long	size;
+		KeyMappingFile		file;
+	};
+
+	static bool isMappingFile(const std::string& name);
+	static Folder& getFolder(const std::string& directory);
+	static KeyMappingFile getMapping(const std::string& path, bool p2k);
+
+	static std::mutex								sMutex;
+	static std::unordered_map<std::string, Folder>	sFolders;
+	static std::list<Mapping>						sMappings; // Most recently used first
+	static int										sWatchListener;
+};
+
 class IKeyboardMapContainer
 {
 public:
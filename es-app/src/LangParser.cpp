@@ -6,6 +6,14 @@
 #include "SystemConf.h"
 #include "MameNames.h"
 #include <algorithm>
+#include <unordered_map>
+
+#define TAG_SEPARATOR		'\x1F'
+#define GROUP_SEPARATOR		'\x1E'
+#define MAX_CACHED_TAGS		8192
+
+std::mutex LangInfo::mCacheLock;
+std::unordered_map<std::string, LangInfo> LangInfo::mCache;
 
 struct LangData
 {
@@ -29,7 +37,27 @@ std::string LangInfo::getLanguageString()
 	return data;
 }
 
-void LangInfo::extractLang(std::string val)
+// Token of a tag -> index in langDatas
+static std::unordered_map<std::string, int> buildLangTokens(const std::vector<LangData>& langDatas)
+{
+	std::unordered_map<std::string, int> ret;
+
+	for (int i = 0; i < (int)langDatas.size(); i++)
+		for (auto& value : langDatas[i].value)
+			ret.emplace(value, i);
+
+	return ret;
+}
+
+// Removes each occurrence of 'pattern' (2 chars), in place
+static void removePattern(std::string& token, const char* pattern)
+{
+	size_t pos;
+	while ((pos = token.find(pattern)) != std::string::npos)
+		token.erase(pos, 2);
+}
+
+void LangInfo::extractLang(const char* data, size_t length)
 {
 	static std::vector<LangData> langDatas =
 	{
@@ -64,7 +92,9 @@ void LangInfo::extractLang(std::string val)
 		{ { "in", "ìndia" }, "in", "in" },
 	};
 
-	static std::set<std::string> hardRegions =
+	static std::unordered_map<std::string, int> langTokens = buildLangTokens(langDatas);
+
+	static std::unordered_set<std::string> hardRegions =
 	{
 		"usa", "us",
 		"europe", "eu",
@@ -73,18 +103,32 @@ void LangInfo::extractLang(std::string val)
 		"kr", "korea"
 	};
 
-	for (auto s : Utils::String::splitAny(val, "_, "))
-	{
-		bool clearLang = s.find("t-") != std::string::npos;
+	// Tokens are short : the buffer stays in the small string storage
+	std::string s;
 
-		s = Utils::String::replace(s, "_", "");
-		s = Utils::String::replace(s, "t+", "");
-		s = Utils::String::replace(s, "t-", "");
+	const char* end = data + length;
+	for (const char* p = data; p < end; )
+	{
+		const char* tokenEnd = p;
+		while (tokenEnd < end && *tokenEnd != '_' && *tokenEnd != ',' && *tokenEnd != ' ')
+			tokenEnd++;
 
-		for (auto langData : langDatas)
+		if (tokenEnd > p)
 		{
-			if (std::find(langData.value.cbegin(), langData.value.cend(), s) != langData.value.cend())
+			s.assign(p, tokenEnd - p);
+
+			bool clearLang = s.find("t-") != std::string::npos;
+			if (clearLang || s.find("t+") != std::string::npos)
+			{
+				removePattern(s, "t+");
+				removePattern(s, "t-");
+			}
+
+			auto it = langTokens.find(s);
+			if (it != langTokens.cend())
 			{
+				auto& langData = langDatas[it->second];
+
 				if (!langData.lang.empty())
 				{
 					if (clearLang)
@@ -100,10 +144,34 @@ void LangInfo::extractLang(std::string val)
 				}
 			}
 		}
+
+		p = tokenEnd + 1;
 	}
 }
 
-LangInfo LangInfo::parse(std::string rom, SystemData* system)
+// Appends the tags between 'start' and 'end' to the key, as extractStrings finds them, each one followed by a separator
+static void appendTags(const std::string& fileName, char start, char end, std::string& key)
+{
+	size_t pos = 0;
+	while ((pos = fileName.find(start, pos)) != std::string::npos)
+	{
+		size_t close = fileName.find(end, pos + 1);
+		if (close == std::string::npos)
+			break;
+
+		if (close > pos + 1)
+		{
+			key.append(fileName, pos + 1, close - pos - 1);
+			key += TAG_SEPARATOR;
+		}
+
+		pos = close + 1;
+	}
+
+	key += GROUP_SEPARATOR;
+}
+
+LangInfo LangInfo::parse(const std::string& rom, SystemData* system)
 {
 	LangInfo info;
 	if (rom.empty() || (system && system->hasPlatformId(PlatformIds::IMAGEVIEWER)))
@@ -113,19 +181,44 @@ LangInfo LangInfo::parse(std::string rom, SystemData* system)
 
 	if (system && (system->hasPlatformId(PlatformIds::ARCADE) || system->hasPlatformId(PlatformIds::NEOGEO)) && fileName.find("j.zip") == std::string::npos)
 	{
-		std::string realName = Utils::String::toLower(MameNames::getInstance()->getRealName(Utils::FileSystem::getStem(rom)));
+		std::string realName = MameNames::getInstance()->getRealName(Utils::FileSystem::getStem(rom));
 		if (!realName.empty() && realName.find("(") != std::string::npos)
-			fileName = Utils::String::toLower(MameNames::getInstance()->getRealName(Utils::FileSystem::getStem(rom)));
+			fileName = Utils::String::toLower(realName);
 	}
 
-	for (auto s : Utils::String::extractStrings(fileName, "(", ")"))
-		info.extractLang(s);
+	// The result only depends on the tags : games sharing "(Europe) (En,Fr,De)" are parsed once
+	std::string key;
+	appendTags(fileName, '(', ')', key);
+	appendTags(fileName, '[', ']', key);
+	appendTags(fileName, '_', '_', key);
 
-	for (auto s : Utils::String::extractStrings(fileName, "[", "]"))
-		info.extractLang(s);
+	{
+		std::unique_lock<std::mutex> lock(mCacheLock);
 
-	for (auto s : Utils::String::extractStrings(fileName, "_", "_"))
-		info.extractLang(s);
+		auto it = mCache.find(key);
+		if (it != mCache.cend())
+			info = it->second;
+		else
+		{
+			// Tags separated by TAG_SEPARATOR & GROUP_SEPARATOR, in the parsing order
+			const char* tag = key.c_str();
+			for (const char* p = tag; *p != 0; p++)
+			{
+				if (*p != TAG_SEPARATOR && *p != GROUP_SEPARATOR)
+					continue;
+
+				if (p > tag)
+					info.extractLang(tag, p - tag);
+
+				tag = p + 1;
+			}
+
+			if (mCache.size() >= MAX_CACHED_TAGS)
+				mCache.clear();
+
+			mCache[key] = info;
+		}
+	}
 
 	if (system != nullptr)
 	{
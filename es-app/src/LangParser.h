@@ -2,6 +2,8 @@
 
 #include <string>
 #include <unordered_set>
+#include <unordered_map>
+#include <mutex>
 
 class SystemData;
 
@@ -10,7 +12,7 @@ class LangInfo
 public:
 	LangInfo() { mHardRegion = false; }
 
-	static LangInfo parse(std::string rom, SystemData* system);
+	static LangInfo parse(const std::string& rom, SystemData* system);
 	static std::string getFlag(const std::string lang, const std::string region);
 
 	std::string region;
@@ -20,8 +22,12 @@ public:
 	bool empty() { return region.empty() && languages.size() == 0; }
 
 private:
-	void extractLang(std::string val);
+	void extractLang(const char* data, size_t length);
 
 	bool mHardRegion;
+
+	// Tags of a file name -> parsed languages & region, before the system defaults
+	static std::mutex mCacheLock;
+	static std::unordered_map<std::string, LangInfo> mCache;
 };
 
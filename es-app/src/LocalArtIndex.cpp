@@ -0,0 +1,86 @@
+#include "LocalArtIndex.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+
+LocalArtIndex::LocalArtIndex(const std::string& startPath) : mStartPath(startPath)
+{
+	mListenerId = Utils::FileSystem::addFileCacheWatchListener([this](const std::string& path) { onPathChanged(path); });
+}
+
+LocalArtIndex::~LocalArtIndex()
+{
+	Utils::FileSystem::removeFileCacheWatchListener(mListenerId);
+}
+
+bool LocalArtIndex::exists(const std::string& path)
+{
+	std::string directory = Utils::FileSystem::getParent(path);
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mFolders.find(directory);
+	if (it == mFolders.cend())
+	{
+		// Listed under the lock : a change reported meanwhile waits for the listing to be there
+		Folder folder;
+
+		if (Utils::FileSystem::isDirectory(directory))
+		{
+			for (auto& file : Utils::FileSystem::getDirectoryFiles(directory))
+				if (!file.directory)
+					folder.files.insert(Utils::FileSystem::getFileName(file.path));
+
+			folder.indexed = Utils::FileSystem::isFileCacheWatched(directory);
+		}
+		else // Its creation would be reported by the watch on the parent folder
+			folder.indexed = Utils::FileSystem::isFileCacheWatched(Utils::FileSystem::getParent(directory));
+
+		if (!folder.indexed)
+			folder.files.clear();
+
+		it = mFolders.insert(std::make_pair(directory, folder)).first;
+	}
+
+	if (!it->second.indexed)
+	{
+		lock.unlock();
+		return Utils::FileSystem::exists(path);
+	}
+
+	return it->second.files.find(Utils::FileSystem::getFileName(path)) != it->second.files.cend();
+}
+
+// Called from the file cache watcher thread
+void LocalArtIndex::onPathChanged(const std::string& path)
+{
+	if (!Utils::String::startsWith(path, mStartPath + "/"))
+		return;
+
+	std::string directory = Utils::FileSystem::getParent(path);
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		// The folder itself was created, removed or moved : list it again on the next lookup
+		mFolders.erase(path);
+
+		auto it = mFolders.find(directory);
+		if (it == mFolders.cend() || !it->second.indexed)
+			return;
+	}
+
+	// The file cache has just forgotten the path : this is a real lookup, kept out of the lock
+	bool exists = Utils::FileSystem::exists(path) && !Utils::FileSystem::isDirectory(path);
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mFolders.find(directory);
+	if (it == mFolders.cend() || !it->second.indexed)
+		return;
+
+	if (exists)
+		it->second.files.insert(Utils::FileSystem::getFileName(path));
+	else
+		it->second.files.erase(Utils::FileSystem::getFileName(path));
+}
@@ -0,0 +1,37 @@
+#pragma once
+#ifndef ES_APP_LOCAL_ART_INDEX_H
+#define ES_APP_LOCAL_ART_INDEX_H
+
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+// Contents of the media folders of a system ( images, videos ), for the local art lookups of FileData : one listing instead of a stat per candidate path.
+// A folder is listed on its first lookup, then the file cache watcher keeps it current. Folders the watcher doesn't follow are not indexed
+class LocalArtIndex
+{
+public:
+	LocalArtIndex(const std::string& startPath);
+	~LocalArtIndex();
+
+	// Same as Utils::FileSystem::exists, for a file directly in a folder below the start path
+	bool exists(const std::string& path);
+
+private:
+	struct Folder
+	{
+		bool indexed;
+		std::unordered_set<std::string> files;
+	};
+
+	void onPathChanged(const std::string& path);
+
+	std::string mStartPath;
+	int mListenerId;
+
+	std::mutex mLock;
+	std::unordered_map<std::string, Folder> mFolders;
+};
+
+#endif // ES_APP_LOCAL_ART_INDEX_H
@@ -9,12 +9,23 @@
 #include "Settings.h"
 #include "FileData.h"
 #include "ImageIO.h"
+#include "utils/BinaryStream.h"
+#include "utils/StringPool.h"
+#include "GamelistSource.h"
 
 std::vector<MetaDataDecl> MetaDataList::mMetaDataDecls;
 
+std::mutex MetaDataList::sChangeLock;
+unsigned int MetaDataList::sChangeGeneration = 0;
+const MetaDataList* MetaDataList::sLastChangedList = nullptr;
+unsigned int MetaDataList::sLastChangedListSince = 0;
+unsigned int MetaDataList::sFieldChangeGeneration[64] = { 0 };
+
 static std::map<MetaDataId, int> mMetaDataIndexes;
 static std::string* mDefaultGameMap = nullptr;
 static MetaDataType* mGameTypeMap = nullptr;
+static bool* mInternedMap = nullptr;
+static unsigned int* mDefaultInternedIds = nullptr;
 static std::map<std::string, MetaDataId> mGameIdMap;
 
 static std::map<std::string, int> KnowScrapersIds =
@@ -111,11 +122,23 @@ void MetaDataList::initMetadata()
 	if (mGameTypeMap != nullptr) 
 		delete[] mGameTypeMap;
 
+	if (mInternedMap != nullptr)
+		delete[] mInternedMap;
+
+	if (mDefaultInternedIds != nullptr)
+		delete[] mDefaultInternedIds;
+
 	mDefaultGameMap = new std::string[maxID];
 	mGameTypeMap = new MetaDataType[maxID];
+	mInternedMap = new bool[maxID];
+	mDefaultInternedIds = new unsigned int[maxID];
 
 	for (int i = 0; i < maxID; i++)
+	{
 		mGameTypeMap[i] = MD_STRING;
+		mInternedMap[i] = false;
+		mDefaultInternedIds[i] = 0;
+	}
 		
 	for (auto iter = mMetaDataDecls.cbegin(); iter != mMetaDataDecls.cend(); iter++)
 	{
@@ -123,6 +146,16 @@ void MetaDataList::initMetadata()
 		mGameTypeMap[iter->id] = iter->type;
 		mGameIdMap[iter->key] = iter->id;
 	}
+
+	// Values shared by many games are stored in the string pool
+	for (auto id : { Emulator, Core, Developer, Publisher, Genre, GenreIds, ArcadeSystemName, Players, Language, Region, Family })
+	{
+		if (id >= maxID)
+			continue;
+
+		mInternedMap[id] = true;
+		mDefaultInternedIds[id] = Utils::StringPool::intern(mDefaultGameMap[id]);
+	}
 }
 
 MetaDataType MetaDataList::getType(MetaDataId id) const
@@ -140,13 +173,85 @@ MetaDataId MetaDataList::getId(const std::string& key) const
 	return mGameIdMap[key];
 }
 
-MetaDataList::MetaDataList(MetaDataListType type) : mType(type), mWasChanged(false), mRelativeTo(nullptr)
+MetaDataList::MetaDataList(MetaDataListType type) : mType(type), mWasChanged(false), mChangedFields(0), mRelativeTo(nullptr), mLazyOffset(0), mLazyPathHash(0)
+{
+	updateMemUsage();
+}
+
+void MetaDataList::updateMemUsage() const
 {
+	mMemUsage.set(sizeof(MetaDataList) + mValues.capacity() + mName.capacity() + mScrapeDates.capacity() * sizeof(std::pair<uint8_t, time_t>));
+}
 
+bool MetaDataList::isDeferred(MetaDataId id)
+{
+	return id == MetaDataId::Desc || mGameTypeMap[id] == MD_PATH;
 }
 
-void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, SystemData* system)
+void MetaDataList::setLazyRecord(unsigned int offset, unsigned long long pathHash)
 {
+	mLazyOffset = offset + 1;
+	mLazyPathHash = pathHash;
+}
+
+// materialize() rewrites mValues from const getters, possibly from another thread :
+// while a list is lazy, its readers & writers share a lock with it. Once materialized, they don't lock anymore
+static std::mutex sLazyLocks[64];
+
+std::unique_lock<std::mutex> MetaDataList::lockWhileLazy() const
+{
+	if (mLazyOffset == 0)
+		return std::unique_lock<std::mutex>();
+
+	return std::unique_lock<std::mutex>(sLazyLocks[((size_t)this / sizeof(MetaDataList)) % 64]);
+}
+
+void MetaDataList::materialize() const
+{
+	if (mLazyOffset == 0)
+		return;
+
+	std::unique_lock<std::mutex> lock(lockWhileLazy());
+	if (mLazyOffset == 0)
+		return;
+
+	GamelistSource* source = mRelativeTo == nullptr ? nullptr : mRelativeTo->getGamelistSource();
+	if (source != nullptr)
+		source->materialize(const_cast<MetaDataList*>(this));
+	else
+		mLazyOffset = 0;
+}
+
+// Copies the deferred fields of a fully loaded list, without flagging this one as changed
+void MetaDataList::mergeDeferredFields(const MetaDataList& source)
+{
+	MetaDataId id;
+	size_t valuePos, valueSize;
+
+	size_t pos = 0;
+	while (pos < source.mValues.size())
+	{
+		size_t next = source.nextValue(pos, id, valuePos, valueSize);
+		if (isDeferred(id))
+		{
+			size_t entryPos, entrySize, currentPos, currentSize;
+			if (!findValue(id, entryPos, entrySize, currentPos, currentSize))
+				setValue(id, source.mValues.data() + valuePos, valueSize);
+		}
+
+		pos = next;
+	}
+
+	mUnKnownElements = source.mUnKnownElements;
+	mScrapeDates = source.mScrapeDates;
+
+	updateMemUsage();
+}
+
+void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, SystemData* system, bool lazy)
+{
+	materialize();
+
 	mType = type;
 	mRelativeTo = system;	
 
@@ -166,7 +271,7 @@ void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, Syst
 
 		if (name == "scrap")
 		{
-			if (xelement.attribute("name") && xelement.attribute("date"))
+			if (!lazy && xelement.attribute("name") && xelement.attribute("date"))
 			{
 				auto scraperId = KnowScrapersIds.find(xelement.attribute("name").value());
 				if (scraperId == KnowScrapersIds.cend())
@@ -176,7 +281,7 @@ void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, Syst
 				if (!dateTime.isValid())
 					continue;
 								
-				mScrapeDates[scraperId->second] = dateTime;
+				setScrapeDate(scraperId->second, dateTime.getTime());
 			}		
 								
 			continue;
@@ -185,7 +290,7 @@ void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, Syst
 		auto it = mGameIdMap.find(name);
 		if (it == mGameIdMap.cend())
 		{
-			if (name == "hash" || name == "path")
+			if (name == "hash" || name == "path" || lazy)
 				continue;
 
 			value = xelement.text().get();
@@ -196,7 +301,7 @@ void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, Syst
 		}
 
 		MetaDataDecl& mdd = mMetaDataDecls[mMetaDataIndexes[it->second]];
-		if (mdd.isAttribute)
+		if (mdd.isAttribute || (lazy && isDeferred(mdd.id)))
 			continue;
 
 		value = xelement.text().get();
@@ -234,14 +339,14 @@ void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, Syst
 		if (it == mGameIdMap.cend())
 		{
 			value = xattr.value();
-			if (!value.empty())
+			if (!value.empty() && !lazy)
 				mUnKnownElements.push_back(std::tuple<std::string, std::string, bool>(name, value, false));
 
 			continue;
 		}
 
 		MetaDataDecl& mdd = mMetaDataDecls[mMetaDataIndexes[it->second]];
-		if (!mdd.isAttribute)
+		if (!mdd.isAttribute || (lazy && isDeferred(mdd.id)))
 			continue;
 
 		value = xattr.value();
@@ -261,6 +366,9 @@ void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, Syst
 		else
 			set(mdd.id, value);
 	}
+
+	mValues.shrink_to_fit();
+	updateMemUsage();
 }
 
 // Add migration for alternative formats & old tags
@@ -274,8 +382,165 @@ void MetaDataList::migrate(FileData* file, pugi::xml_node& node)
 	}
 }
 
+void MetaDataList::saveToBinary(Utils::BinaryWriter& writer) const
+{
+	materialize();
+
+	writer.writeString(mName);
+
+	// Interned values are only valid in this process : values are written as strings
+	std::vector<std::pair<MetaDataId, std::string>> values;
+
+	MetaDataId id;
+	size_t valuePos, valueSize;
+	size_t pos = 0;
+	while (pos < mValues.size())
+	{
+		size_t next = nextValue(pos, id, valuePos, valueSize);
+		values.push_back(std::pair<MetaDataId, std::string>(id, readValue(id, valuePos, valueSize)));
+		pos = next;
+	}
+
+	writer.writeUInt16((uint16_t)values.size());
+	for (auto& item : values)
+	{
+		writer.writeUInt8((uint8_t)item.first);
+		writer.writeString(item.second);
+	}
+
+	writer.writeUInt16((uint16_t)mUnKnownElements.size());
+	for (auto& element : mUnKnownElements)
+	{
+		writer.writeString(std::get<0>(element));
+		writer.writeString(std::get<1>(element));
+		writer.writeUInt8(std::get<2>(element) ? 1 : 0);
+	}
+
+	writer.writeUInt8((uint8_t)mScrapeDates.size());
+	for (auto& scrapeDate : mScrapeDates)
+	{
+		writer.writeUInt8(scrapeDate.first);
+		writer.writeInt64((int64_t)scrapeDate.second);
+	}
+}
+
+bool MetaDataList::loadFromBinary(Utils::BinaryReader& reader, MetaDataListType type, SystemData* system, bool lazy)
+{
+	materialize();
+
+	mType = type;
+	mRelativeTo = system;
+
+	mUnKnownElements.clear();
+	mScrapeDates.clear();
+
+	mName = reader.readString();
+
+	int count = reader.readUInt16();
+	for (int i = 0; i < count && !reader.failed(); i++)
+	{
+		MetaDataId id = (MetaDataId)reader.readUInt8();
+		std::string value = reader.readString();
+		if (!reader.failed() && (!lazy || !isDeferred(id)))
+			setValue(id, value);
+	}
+
+	mValues.shrink_to_fit();
+	updateMemUsage();
+
+	count = reader.readUInt16();
+	for (int i = 0; i < count && !reader.failed(); i++)
+	{
+		std::string name = reader.readString();
+		std::string value = reader.readString();
+		bool isElement = reader.readUInt8() != 0;
+
+		if (!lazy)
+			mUnKnownElements.push_back(std::tuple<std::string, std::string, bool>(name, value, isElement));
+	}
+
+	count = reader.readUInt8();
+	for (int i = 0; i < count && !reader.failed(); i++)
+	{
+		uint8_t scraperId = reader.readUInt8();
+		time_t time = (time_t)reader.readInt64();
+
+		if (!lazy)
+			mScrapeDates.push_back(std::pair<uint8_t, time_t>(scraperId, time));
+	}
+
+	return !reader.failed();
+}
+
+bool MetaDataList::saveChangesToBinary(Utils::BinaryWriter& writer) const
+{
+	if (mChangedFields & CHANGED_ALL)
+		return false;
+
+	std::vector<std::pair<MetaDataId, std::string>> values;
+
+	if (mChangedFields & (1ULL << MetaDataId::Name))
+		values.push_back(std::pair<MetaDataId, std::string>(MetaDataId::Name, mName));
+
+	{
+		std::unique_lock<std::mutex> lock(lockWhileLazy());
+
+		MetaDataId id;
+		size_t valuePos, valueSize;
+		size_t pos = 0;
+		while (pos < mValues.size())
+		{
+			size_t next = nextValue(pos, id, valuePos, valueSize);
+			if (mChangedFields & (1ULL << id))
+				values.push_back(std::pair<MetaDataId, std::string>(id, readValue(id, valuePos, valueSize)));
+
+			pos = next;
+		}
+	}
+
+	writer.writeUInt16((uint16_t)values.size());
+	for (auto& item : values)
+	{
+		writer.writeUInt8((uint8_t)item.first);
+		writer.writeString(item.second);
+	}
+
+	return true;
+}
+
+bool MetaDataList::loadChangesFromBinary(Utils::BinaryReader& reader)
+{
+	int count = reader.readUInt16();
+	for (int i = 0; i < count && !reader.failed(); i++)
+	{
+		MetaDataId id = (MetaDataId)reader.readUInt8();
+		std::string value = reader.readString();
+		if (reader.failed())
+			break;
+
+		if (id >= 63)
+			continue;
+
+		if (mLazyOffset != 0 && isDeferred(id))
+			materialize();
+
+		if (id == MetaDataId::Name)
+			mName = value;
+		else
+			setValue(id, value);
+
+		mWasChanged = true;
+		mChangedFields |= 1ULL << id;
+		notifyChange(id);
+	}
+
+	return !reader.failed();
+}
+
 void MetaDataList::appendToXML(pugi::xml_node& parent, bool ignoreDefaults, const std::string& relativeTo, bool fullPaths) const
 {
+	materialize();
+
 	const std::vector<MetaDataDecl>& mdd = getMDD();
 
 	for(auto mddIter = mdd.cbegin(); mddIter != mdd.cend(); mddIter++)
@@ -290,16 +555,16 @@ void MetaDataList::appendToXML(pugi::xml_node& parent, bool ignoreDefaults, cons
 		if (mddIter->id == MetaDataId::GenreIds)
 			continue;
 
-		auto mapIter = mMap.find(mddIter->id);
-		if(mapIter != mMap.cend())
+		size_t entryPos, entrySize, valuePos, valueSize;
+		if (findValue(mddIter->id, entryPos, entrySize, valuePos, valueSize))
 		{
 			// we have this value!
 			// if it's just the default (and we ignore defaults), don't write it
-			if (ignoreDefaults && mapIter->second == mddIter->defaultValue)
+			std::string value = readValue(mddIter->id, valuePos, valueSize);
+			if (ignoreDefaults && value == mddIter->defaultValue)
 				continue;
 
 			// try and make paths relative if we can
-			std::string value = mapIter->second;
 			if (mddIter->type == MD_PATH)
 			{
 				if (fullPaths && mRelativeTo != nullptr)
@@ -343,7 +608,7 @@ void MetaDataList::appendToXML(pugi::xml_node& parent, bool ignoreDefaults, cons
 			{
 				auto scraper = parent.append_child("scrap");
 				scraper.append_attribute("name").set_value(name.c_str());
-				scraper.append_attribute("date").set_value(scrapeDate.second.getIsoString().c_str());
+				scraper.append_attribute("date").set_value(Utils::Time::DateTime(scrapeDate.second).getIsoString().c_str());
 			}
 		}
 	}
@@ -351,6 +616,9 @@ void MetaDataList::appendToXML(pugi::xml_node& parent, bool ignoreDefaults, cons
 
 void MetaDataList::set(MetaDataId id, const std::string& value)
 {
+	if (mLazyOffset != 0 && isDeferred(id))
+		materialize();
+
 	if (id == MetaDataId::Name)
 	{
 		if (mName == value)
@@ -358,9 +626,13 @@ void MetaDataList::set(MetaDataId id, const std::string& value)
 
 		mName = value;
 		mWasChanged = true;
+		mChangedFields |= 1ULL << id;
+		notifyChange(id);
 		return;
 	}
 
+	std::unique_lock<std::mutex> lock(lockWhileLazy());
+
 	// Players -> remove "1-"
 	// if (mType == GAME_METADATA && id == 12 && Utils::String::startsWith(value, "1-")) // "players"
 	// {
@@ -368,30 +640,199 @@ void MetaDataList::set(MetaDataId id, const std::string& value)
 	// 	return;
 	// }
 
-	auto prev = mMap.find(id);
-	if (prev != mMap.cend() && prev->second == value)
+	size_t entryPos, entrySize, valuePos, valueSize;
+	if (findValue(id, entryPos, entrySize, valuePos, valueSize) && equalsValue(id, valuePos, valueSize, value))
 		return;
 
 	if (mGameTypeMap[id] == MD_PATH && mRelativeTo != nullptr) // if it's a path, resolve relative paths				
-		mMap[id] = Utils::FileSystem::createRelativePath(value, mRelativeTo->getStartPath(), true);
+		setValue(id, Utils::FileSystem::createRelativePath(value, mRelativeTo->getStartPath(), true));
 	else
-		mMap[id] = Utils::String::trim(value);
+		setValue(id, Utils::String::trim(value));
 
 	mWasChanged = true;
+	mChangedFields |= 1ULL << id;
+	notifyChange(id);
+}
+
+void MetaDataList::notifyChange(MetaDataId id)
+{
+	std::unique_lock<std::mutex> lock(sChangeLock);
+
+	if (sLastChangedList != this)
+	{
+		sLastChangedList = this;
+		sLastChangedListSince = sChangeGeneration;
+	}
+
+	sChangeGeneration++;
+	sFieldChangeGeneration[id & 63] = sChangeGeneration;
+}
+
+unsigned int MetaDataList::getChangeGeneration()
+{
+	std::unique_lock<std::mutex> lock(sChangeLock);
+	return sChangeGeneration;
+}
+
+unsigned int MetaDataList::getLastChangeGeneration(unsigned long long fields)
+{
+	std::unique_lock<std::mutex> lock(sChangeLock);
+
+	if (fields & CHANGED_ALL)
+		return sChangeGeneration;
+
+	unsigned int generation = 0;
+	for (int id = 0; id < 63; id++)
+		if ((fields & (1ULL << id)) && sFieldChangeGeneration[id] > generation)
+			generation = sFieldChangeGeneration[id];
+
+	return generation;
+}
+
+const MetaDataList* MetaDataList::getSingleChangedListSince(unsigned int generation)
+{
+	std::unique_lock<std::mutex> lock(sChangeLock);
+
+	if (sChangeGeneration != generation && sLastChangedListSince <= generation)
+		return sLastChangedList;
+
+	return nullptr;
+}
+
+size_t MetaDataList::nextValue(size_t pos, MetaDataId& id, size_t& valuePos, size_t& valueSize) const
+{
+	id = (MetaDataId)(unsigned char)mValues[pos++];
+
+	valueSize = 0;
+	for (int shift = 0; pos < mValues.size(); shift += 7)
+	{
+		unsigned char c = (unsigned char)mValues[pos++];
+		valueSize |= (size_t)(c & 0x7F) << shift;
+		if ((c & 0x80) == 0)
+			break;
+	}
+
+	valuePos = pos;
+	return valuePos + valueSize;
+}
+
+bool MetaDataList::findValue(MetaDataId id, size_t& entryPos, size_t& entrySize, size_t& valuePos, size_t& valueSize) const
+{
+	MetaDataId entryId;
+
+	size_t pos = 0;
+	while (pos < mValues.size())
+	{
+		size_t next = nextValue(pos, entryId, valuePos, valueSize);
+		if (entryId >= id)
+		{
+			entryPos = pos;
+			entrySize = next - pos;
+			return entryId == id;
+		}
+
+		pos = next;
+	}
+
+	entryPos = mValues.size();
+	entrySize = 0;
+	return false;
+}
+
+// Interned values are stored as a 4 bytes pool id
+bool MetaDataList::equalsValue(MetaDataId id, size_t valuePos, size_t valueSize, const std::string& value) const
+{
+	if (mInternedMap[id])
+		return readValue(id, valuePos, valueSize) == value;
+
+	return mValues.compare(valuePos, valueSize, value) == 0;
+}
+
+const std::string MetaDataList::readValue(MetaDataId id, size_t valuePos, size_t valueSize) const
+{
+	if (mInternedMap[id])
+	{
+		unsigned int poolId = 0;
+		if (valueSize == sizeof(poolId))
+			memcpy(&poolId, &mValues[valuePos], sizeof(poolId));
+
+		return Utils::StringPool::get(poolId);
+	}
+
+	return mValues.substr(valuePos, valueSize);
+}
+
+unsigned int MetaDataList::getInternedId(MetaDataId id) const
+{
+	if (!mInternedMap[id])
+		return 0;
+
+	std::unique_lock<std::mutex> lock(lockWhileLazy());
+
+	size_t entryPos, entrySize, valuePos, valueSize;
+	if (!findValue(id, entryPos, entrySize, valuePos, valueSize))
+		return mDefaultInternedIds[id];
+
+	unsigned int poolId = 0;
+	if (valueSize == sizeof(poolId))
+		memcpy(&poolId, &mValues[valuePos], sizeof(poolId));
+
+	return poolId;
+}
+
+void MetaDataList::setValue(MetaDataId id, const std::string& value)
+{
+	if (mInternedMap[id])
+	{
+		unsigned int poolId = Utils::StringPool::intern(value);
+		setValue(id, (const char*)&poolId, sizeof(poolId));
+	}
+	else
+		setValue(id, value.data(), value.size());
+}
+
+void MetaDataList::setValue(MetaDataId id, const char* value, size_t size)
+{
+	std::string entry;
+	entry.reserve(size + 4);
+	entry.push_back((char)id);
+
+	size_t length = size;
+	while (length >= 0x80)
+	{
+		entry.push_back((char)((length & 0x7F) | 0x80));
+		length >>= 7;
+	}
+
+	entry.push_back((char)length);
+	entry.append(value, size);
+
+	size_t entryPos, entrySize, valuePos, valueSize;
+	if (findValue(id, entryPos, entrySize, valuePos, valueSize))
+		mValues.replace(entryPos, entrySize, entry);
+	else
+		mValues.insert(entryPos, entry);
+
+	updateMemUsage();
 }
 
 const std::string MetaDataList::get(MetaDataId id, bool resolveRelativePaths) const
 {
+	if (mLazyOffset != 0 && isDeferred(id))
+		materialize();
+
 	if (id == MetaDataId::Name)
 		return mName;
 
-	auto it = mMap.find(id);
-	if (it != mMap.end())
+	std::unique_lock<std::mutex> lock(lockWhileLazy());
+
+	size_t entryPos, entrySize, valuePos, valueSize;
+	if (findValue(id, entryPos, entrySize, valuePos, valueSize))
 	{
 		if (resolveRelativePaths && mGameTypeMap[id] == MD_PATH && mRelativeTo != nullptr) // if it's a path, resolve relative paths				
-			return Utils::FileSystem::resolveRelativePath(it->second, mRelativeTo->getStartPath(), true);
+			return Utils::FileSystem::resolveRelativePath(mValues.substr(valuePos, valueSize), mRelativeTo->getStartPath(), true);
 
-		return it->second;
+		return readValue(id, valuePos, valueSize);
 	}
 
 	return mDefaultGameMap[id];
@@ -431,6 +872,7 @@ bool MetaDataList::wasChanged() const
 void MetaDataList::resetChangedFlag()
 {
 	mWasChanged = false;
+	mChangedFields = 0;
 }
 
 void MetaDataList::importScrappedMetadata(const MetaDataList& source)
@@ -547,19 +989,38 @@ void MetaDataList::setScrapeDate(const std::string& scraper)
 	if (it == KnowScrapersIds.cend())
 		return;
 
-	mScrapeDates[it->second] = Utils::Time::DateTime::now();
+	materialize();
+	setScrapeDate(it->second, Utils::Time::DateTime::now().getTime());
 	mWasChanged = true;
+	mChangedFields |= CHANGED_ALL;
+}
+
+void MetaDataList::setScrapeDate(int scraperId, time_t time)
+{
+	for (auto& scrapeDate : mScrapeDates)
+	{
+		if (scrapeDate.first == scraperId)
+		{
+			scrapeDate.second = time;
+			return;
+		}
+	}
+
+	mScrapeDates.push_back(std::pair<uint8_t, time_t>((uint8_t)scraperId, time));
+	updateMemUsage();
 }
 
-Utils::Time::DateTime* MetaDataList::getScrapeDate(const std::string& scraper)
+Utils::Time::DateTime MetaDataList::getScrapeDate(const std::string& scraper) const
 {
+	materialize();
+
 	auto it = KnowScrapersIds.find(scraper);
 	if (it != KnowScrapersIds.cend())
 	{
-		auto itd = mScrapeDates.find(it->second);
-		if (itd != mScrapeDates.cend())
-			return &itd->second;
+		for (auto& scrapeDate : mScrapeDates)
+			if (scrapeDate.first == it->second)
+				return Utils::Time::DateTime(scrapeDate.second);
 	}
 
-	return nullptr;
+	return Utils::Time::DateTime();
 }
\ No newline at end of file
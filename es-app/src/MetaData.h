@@ -6,14 +6,18 @@
 #include <vector>
 #include <functional>
 #include <string>
+#include <mutex>
+#include <atomic>
 
 #include "utils/TimeUtil.h"
+#include "MemoryStats.h"
 
 class SystemData;
 class FileData;
 class Scraper;
 
 namespace pugi { class xml_node; }
+namespace Utils { class BinaryWriter; class BinaryReader; }
 
 enum MetaDataType
 {
@@ -129,16 +133,37 @@ enum MetaDataListType
 	FOLDER_METADATA
 };
 
+#define CHANGED_ALL (1ULL << 63)
+
 class MetaDataList
 {
+	friend class GamelistSource;
+
 public:
 	static void initMetadata();
 
-	void loadFromXML(MetaDataListType type, pugi::xml_node& node, SystemData* system);
+	// In lazy mode, the deferred fields ( description, media paths, unknown elements... ) are skipped : they are read back from the gamelist source on first access
+	void loadFromXML(MetaDataListType type, pugi::xml_node& node, SystemData* system, bool lazy = false);
 	void appendToXML(pugi::xml_node& parent, bool ignoreDefaults, const std::string& relativeTo, bool fullPaths = false) const;
 
 	void migrate(FileData* file, pugi::xml_node& node);
 
+	// Raw serialization used by the gamelist snapshot cache
+	void saveToBinary(Utils::BinaryWriter& writer) const;
+	bool loadFromBinary(Utils::BinaryReader& reader, MetaDataListType type, SystemData* system, bool lazy = false);
+
+	// Fields changed since the last save, used by the gamelist journal. Returns false if the whole list has to be saved instead
+	bool saveChangesToBinary(Utils::BinaryWriter& writer) const;
+	bool loadChangesFromBinary(Utils::BinaryReader& reader);
+
+	// Lazy materialization : the record of this list in the system's GamelistSource
+	void setLazyRecord(unsigned int offset, unsigned long long pathHash);
+	inline bool isLazy() const { return mLazyOffset != 0; }
+	void materialize() const;
+	void mergeDeferredFields(const MetaDataList& source);
+
+	static bool isDeferred(MetaDataId id);
+
 	MetaDataList(MetaDataListType type);
 	
 	void set(MetaDataId id, const std::string& value);
@@ -148,6 +173,9 @@ public:
 	void set(const std::string& key, const std::string& value);
 	const std::string get(const std::string& key, bool resolveRelativePaths = true) const;
 
+	// Pool id of an interned value ( developer, publisher, genre, region... ), 0 if empty or if the field is not interned
+	unsigned int getInternedId(MetaDataId id) const;
+
 	int getInt(MetaDataId id) const;
 	float getFloat(MetaDataId id) const;
 
@@ -158,9 +186,17 @@ public:
 
 	bool wasChanged() const;
 	void resetChangedFlag();
+
+	// Counts the value changes of all the lists, so that the caches built on metadata values can tell they're outdated
+	static unsigned int getChangeGeneration();
+	// The list changed last, if it's the only one that changed since 'generation'. nullptr otherwise
+	static const MetaDataList* getSingleChangedListSince(unsigned int generation);
+	// Generation of the last change of any of the fields ( one bit per MetaDataId, CHANGED_ALL for any field )
+	static unsigned int getLastChangeGeneration(unsigned long long fields);
 	const void setDirty() 
 	{ 
 		mWasChanged = true; 
+		mChangedFields = CHANGED_ALL;
 	}
 
 	inline MetaDataListType getType() const { return mType; }
@@ -172,20 +208,59 @@ public:
 	std::string getRelativeRootPath();
 
 	void setScrapeDate(const std::string& scraper);
-	Utils::Time::DateTime* getScrapeDate(const std::string& scraper);
+	Utils::Time::DateTime getScrapeDate(const std::string& scraper) const;
 
 private:
-	std::map<int, Utils::Time::DateTime> mScrapeDates;
+	// Values are packed in a single buffer, sorted by id : [id][length][value]... ( length is a 7 bits varint ). Interned fields store a Utils::StringPool id
+	// A std::map<MetaDataId, std::string> per game was costing millions of nodes & small allocations on large collections
+	bool findValue(MetaDataId id, size_t& entryPos, size_t& entrySize, size_t& valuePos, size_t& valueSize) const;
+	size_t nextValue(size_t pos, MetaDataId& id, size_t& valuePos, size_t& valueSize) const;
+	void setValue(MetaDataId id, const std::string& value);
+	void setValue(MetaDataId id, const char* value, size_t size);
+	bool equalsValue(MetaDataId id, size_t valuePos, size_t valueSize, const std::string& value) const;
+	const std::string readValue(MetaDataId id, size_t valuePos, size_t valueSize) const;
+	void setScrapeDate(int scraperId, time_t time);
+	void notifyChange(MetaDataId id);
+	void updateMemUsage() const;
+	std::unique_lock<std::mutex> lockWhileLazy() const;
+
+	// Copied with the list. Cleared by materialize(), from any thread, once the deferred fields are merged
+	struct LazyOffset
+	{
+		LazyOffset(unsigned int offset = 0) : value(offset) { }
+		LazyOffset(const LazyOffset& other) : value(other.value.load(std::memory_order_acquire)) { }
+
+		inline LazyOffset& operator=(const LazyOffset& other) { value.store(other.value.load(std::memory_order_acquire), std::memory_order_release); return *this; }
+		inline LazyOffset& operator=(unsigned int offset) { value.store(offset, std::memory_order_release); return *this; }
+		inline operator unsigned int() const { return value.load(std::memory_order_acquire); }
+
+		std::atomic<unsigned int> value;
+	};
+
+	// mutable : deferred fields are filled by materialize(), which can be called from const getters
+	mutable std::vector<std::pair<uint8_t, time_t>> mScrapeDates;
 
 	std::string		mName;
 	MetaDataListType mType;
-	std::map<MetaDataId, std::string> mMap;
+	mutable std::string	mValues;
 	bool mWasChanged;
+	unsigned long long mChangedFields; // one bit per MetaDataId, CHANGED_ALL when it can't be tracked per field
 	SystemData*		mRelativeTo;
 
+	mutable LazyOffset mLazyOffset; // record offset + 1, 0 when the list is fully loaded
+	unsigned long long mLazyPathHash;
+
 	static std::vector<MetaDataDecl> mMetaDataDecls;
 
-	std::vector<std::tuple<std::string, std::string, bool>> mUnKnownElements;
+	static std::mutex			sChangeLock;
+	static unsigned int			sChangeGeneration;
+	static const MetaDataList*	sLastChangedList;
+	static unsigned int			sLastChangedListSince;	// Generation before the first change of sLastChangedList's current run
+	static unsigned int			sFieldChangeGeneration[64];
+
+	mutable std::vector<std::tuple<std::string, std::string, bool>> mUnKnownElements;
+
+	mutable MemoryCounter<MemoryStats::METADATA> mMemUsage;
 };
 
 #endif // ES_APP_META_DATA_H
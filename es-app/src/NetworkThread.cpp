@@ -4,6 +4,7 @@
 #include "guis/GuiMsgBox.h"
 #include "LocaleES.h"
 #include "Log.h"
+#include "TaskScheduler.h"
 #include <chrono>
 #include <SDL.h>
 
@@ -72,6 +73,8 @@ void NetworkThread::checkPadsBatteryLevel()
 
 void NetworkThread::run()
 {
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::NETWORK);
+
 	while (mRunning)
 	{
 		if (mFirstRun)
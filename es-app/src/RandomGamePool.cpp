@@ -0,0 +1,198 @@
+#include "RandomGamePool.h"
+
+#include "FileData.h"
+#include "SystemData.h"
+#include "PlatformId.h"
+#include "utils/Randomizer.h"
+#include "Log.h"
+
+#include <algorithm>
+
+// Random draws checked against the filters before scanning for a game they show
+#define MAX_FILTERED_DRAWS 32
+
+std::unordered_map<SystemData*, RandomGamePool::SystemGames> RandomGamePool::mSystems;
+std::unordered_set<SystemData*> RandomGamePool::mDirtySystems;
+std::vector<FileData*> RandomGamePool::mGames[MEDIA_COUNT];
+bool RandomGamePool::mGamesValid = false;
+unsigned int RandomGamePool::mTreeGeneration = 0;
+unsigned int RandomGamePool::mVersion = 0;
+
+void RandomGamePool::invalidate(SystemData* system)
+{
+	if (system == nullptr || mSystems.find(system) == mSystems.cend())
+		return;
+
+	mDirtySystems.insert(system);
+	mGamesValid = false;
+}
+
+std::string RandomGamePool::getMediaPath(FileData* game, MediaType type)
+{
+	switch (type)
+	{
+	case IMAGE:
+		return game->getImagePath();
+	case VIDEO:
+		return game->getVideoPath();
+	case THUMBNAIL:
+		return game->getThumbnailPath();
+	case MARQUEE:
+		return game->getMarqueePath();
+	case FANART:
+		return game->getMetadata(MetaDataId::FanArt);
+	case TITLESHOT:
+		return game->getMetadata(MetaDataId::TitleShot);
+	default:
+		return "";
+	}
+}
+
+void RandomGamePool::checkTreeGeneration()
+{
+	if (mTreeGeneration == FolderData::getTreeGeneration())
+		return;
+
+	mSystems.clear();
+	mDirtySystems.clear();
+	mGamesValid = false;
+	mTreeGeneration = FolderData::getTreeGeneration();
+	mVersion++;
+}
+
+RandomGamePool::SystemGames& RandomGamePool::getSystemGames(SystemData* system)
+{
+	auto it = mSystems.find(system);
+	if (it != mSystems.end() && mDirtySystems.find(system) == mDirtySystems.cend())
+		return it->second;
+
+	SystemGames& systemGames = mSystems[system];
+	systemGames = SystemGames();
+
+	// Hidden games & extensions are left out, the filters are applied when picking
+	FileFilterIndex* index = system->getFilterIndex();
+	system->setIndex(nullptr);
+	std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME, true);
+	system->setIndex(index);
+
+	systemGames.games[ANY] = files;
+
+	for (auto game : files)
+		for (int type = IMAGE; type < MEDIA_COUNT; type++)
+			if (!getMediaPath(game, (MediaType)type).empty())
+				systemGames.games[type].push_back(game);
+
+	mDirtySystems.erase(system);
+	mGamesValid = false;
+	mVersion++;
+
+	LOG(LogDebug) << "RandomGamePool : " << system->getName() << " indexed, " << files.size() << " games, " << systemGames.games[VIDEO].size() << " videos, " << systemGames.games[IMAGE].size() << " images";
+	return systemGames;
+}
+
+void RandomGamePool::updateAllGames()
+{
+	if (mGamesValid)
+		return;
+
+	for (int type = ANY; type < MEDIA_COUNT; type++)
+		mGames[type].clear();
+
+	for (auto system : SystemData::sSystemVector)
+	{
+		// We only want nodes from game systems that are not collections
+		if (!system->isGameSystem() || system->isCollection() || system->hasPlatformId(PlatformIds::IMAGEVIEWER) || system->hasPlatformId(PlatformIds::PLATFORM_IGNORE))
+			continue;
+
+		// Flattened for the random picks : pointer copies only
+		SystemGames& systemGames = getSystemGames(system);
+		for (int type = ANY; type < MEDIA_COUNT; type++)
+			mGames[type].insert(mGames[type].end(), systemGames.games[type].cbegin(), systemGames.games[type].cend());
+	}
+
+	mGamesValid = true;
+}
+
+unsigned int RandomGamePool::getVersion()
+{
+	checkTreeGeneration();
+	updateAllGames();
+	return mVersion;
+}
+
+FileData* RandomGamePool::pick(SystemData* system, MediaType type, bool filtered)
+{
+	checkTreeGeneration();
+
+	if (system != nullptr)
+		return pick(getSystemGames(system).games[type], system, filtered);
+
+	updateAllGames();
+	return pick(mGames[type], nullptr, filtered);
+}
+
+FileData* RandomGamePool::pick(const std::vector<FileData*>& games, SystemData* system, bool filtered)
+{
+	if (games.empty())
+		return nullptr;
+
+	int count = (int)games.size();
+
+	if (filtered && system != nullptr)
+	{
+		FileFilterIndex* index = system->getIndex(false);
+		filtered = index != nullptr && index->isFiltered();
+	}
+
+	if (!filtered)
+		return games[Randomizer::random(count)];
+
+	// The filter index of the system of the game : indexed filters are bit tests
+	auto isShown = [system](FileData* game)
+	{
+		FileFilterIndex* index = (system != nullptr ? system : game->getSystem())->getIndex(false);
+		return index == nullptr || !index->isFiltered() || index->showFile(game);
+	};
+
+	for (int draw = 0; draw < MAX_FILTERED_DRAWS; draw++)
+	{
+		FileData* game = games[Randomizer::random(count)];
+		if (isShown(game))
+			return game;
+	}
+
+	// Narrow filters : the first game shown after a random start
+	int start = Randomizer::random(count);
+	for (int i = 0; i < count; i++)
+	{
+		FileData* game = games[(start + i) % count];
+		if (isShown(game))
+			return game;
+	}
+
+	return nullptr;
+}
+
+void RandomGamePool::remove(FileData* game, MediaType type)
+{
+	// The order doesn't matter
+	auto removeFrom = [game](std::vector<FileData*>& games)
+	{
+		auto it = std::find(games.begin(), games.end(), game);
+		if (it == games.end())
+			return;
+
+		*it = games.back();
+		games.pop_back();
+	};
+
+	removeFrom(mGames[type]);
+
+	// Its system, and the collection it was picked from
+	for (auto system : { game->getSourceFileData()->getSystem(), game->getSystem() })
+	{
+		auto it = mSystems.find(system);
+		if (it != mSystems.end())
+			removeFrom(it->second.games[type]);
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#ifndef ES_APP_RANDOM_GAME_POOL_H
+#define ES_APP_RANDOM_GAME_POOL_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+class FileData;
+class SystemData;
+
+// Dense arrays of the playable games, per system & per media, for the random picks : screensavers, {random} theme playlists,
+// random game jumps. A system is indexed at its first pick, again when the metadata of one of its games changed ( invalidate ),
+// and all of them after a reload ( tree generation ). The filters are not applied when indexing : filtered picks check the games
+// drawn against the filter index of their system instead. Main thread only
+class RandomGamePool
+{
+public:
+	enum MediaType
+	{
+		ANY = 0,
+		IMAGE = 1,
+		VIDEO = 2,
+		THUMBNAIL = 3,
+		MARQUEE = 4,
+		FANART = 5,
+		TITLESHOT = 6,
+		MEDIA_COUNT = 7
+	};
+
+	static void invalidate(SystemData* system);
+
+	// Random game of the system, of all the game systems when nullptr, having this media. The media file itself is not checked
+	static FileData* pick(SystemData* system, MediaType type, bool filtered = false);
+
+	// A game whose media file is missing, left out until its system is indexed again
+	static void remove(FileData* game, MediaType type);
+
+	// Changes each time the games are indexed again : the games picked before may have been deleted
+	static unsigned int getVersion();
+
+	static std::string getMediaPath(FileData* game, MediaType type);
+
+private:
+	struct SystemGames
+	{
+		std::vector<FileData*> games[MEDIA_COUNT];
+	};
+
+	static void checkTreeGeneration();
+	static SystemGames& getSystemGames(SystemData* system);
+	static void updateAllGames();
+	static FileData* pick(const std::vector<FileData*>& games, SystemData* system, bool filtered);
+
+	static std::unordered_map<SystemData*, SystemGames> mSystems;
+	static std::unordered_set<SystemData*> mDirtySystems;
+	static std::vector<FileData*> mGames[MEDIA_COUNT]; // Game systems, flattened
+	static bool mGamesValid;
+	static unsigned int mTreeGeneration;
+	static unsigned int mVersion;
+};
+
+#endif // ES_APP_RANDOM_GAME_POOL_H
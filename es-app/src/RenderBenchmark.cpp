@@ -0,0 +1,237 @@
+#include "RenderBenchmark.h"
+
+#include "EmulationStation.h"
+
+#include "renderers/Renderer.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "views/gamelist/IGameListView.h"
+#include "views/ViewController.h"
+#include "InputManager.h"
+#include "InputConfig.h"
+#include "Profiler.h"
+#include "Window.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+#define FRAME_TIME_MS		16 // Fixed timestep, for the runs to be comparable
+#define PRESS_FRAMES		10 // Frames between two presses of a repeated input
+
+// System list, a gamelist, a menu, and back
+static const char* sDefaultScript =
+	"wait 60\n"
+	"right 5\n"
+	"left 5\n"
+	"a\n"
+	"wait 60\n"
+	"down 30\n"
+	"pagedown 5\n"
+	"up 30\n"
+	"start\n"
+	"wait 30\n"
+	"down 5\n"
+	"b\n"
+	"wait 30\n"
+	"b\n"
+	"wait 60\n";
+
+std::string RenderBenchmark::getViewType(Window* window)
+{
+	if (window->peekGui() != ViewController::get())
+		return "menu";
+
+	auto& state = ViewController::get()->getState();
+	if (state.viewing == ViewController::SYSTEM_SELECT)
+		return "system";
+
+	if (state.viewing == ViewController::GAME_LIST)
+	{
+		auto view = ViewController::get()->getGameListView(state.getSystem(), false);
+		if (view != nullptr)
+			return std::string("gamelist.") + view->getName();
+
+		return "gamelist";
+	}
+
+	return "start";
+}
+
+void RenderBenchmark::runFrame(Window* window, std::map<std::string, std::vector<Frame>>& frames)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	window->update(FRAME_TIME_MS);
+	window->render();
+
+	Frame frame;
+	frame.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	auto stats = Renderer::getBatchStats();
+	frame.drawCalls = stats.drawCalls;
+	frame.batches = stats.batches;
+	frame.vertices = stats.vertices;
+	frame.stateCalls = stats.stateCalls;
+
+	frames[getViewType(window)].push_back(frame);
+}
+
+// Through the keyboard mapping, whatever the device of the recording
+void RenderBenchmark::sendInput(Window* window, const InputRecorder::Event& event)
+{
+	InputConfig* config = InputManager::getInstance()->getInputConfigByDevice(DEVICE_KEYBOARD);
+
+	Input input;
+	if (config == nullptr || !config->getInputByName(event.name, &input))
+	{
+		LOG(LogWarning) << "RenderBenchmark : no keyboard input mapped to " << event.name;
+		return;
+	}
+
+	input.value = event.pressed ? 1 : 0;
+	window->input(config, input);
+}
+
+void RenderBenchmark::loadScript(const std::string& scriptPath, std::vector<InputRecorder::Event>& events, int& duration)
+{
+	std::string script = sDefaultScript;
+
+	if (!scriptPath.empty())
+	{
+		if (Utils::FileSystem::exists(scriptPath))
+			script = Utils::FileSystem::readAllText(scriptPath);
+		else
+			LOG(LogError) << "RenderBenchmark : " << scriptPath << " not found, running the default script";
+	}
+
+	int frame = 0;
+
+	for (auto line : Utils::String::splitAny(script, "\r\n", true))
+	{
+		auto comment = line.find('#');
+		if (comment != std::string::npos)
+			line = line.substr(0, comment);
+
+		auto args = Utils::String::split(Utils::String::trim(line), ' ', true);
+		if (args.empty())
+			continue;
+
+		int count = args.size() > 1 ? std::max(0, atoi(args[1].c_str())) : 1;
+
+		if (args[0] == "wait")
+		{
+			frame += count;
+			continue;
+		}
+
+		// Released on the next frame
+		for (int i = 0; i < count; i++, frame += PRESS_FRAMES)
+		{
+			events.push_back({ frame * FRAME_TIME_MS, args[0], true });
+			events.push_back({ (frame + 1) * FRAME_TIME_MS, args[0], false });
+		}
+	}
+
+	duration = frame * FRAME_TIME_MS;
+}
+
+void RenderBenchmark::writeResults(const std::string& outputPath, const std::map<std::string, std::vector<Frame>>& frames)
+{
+	std::ofstream stream(WINSTRINGW(outputPath), std::ios::out | std::ios::binary);
+	if (!stream.is_open())
+	{
+		LOG(LogError) << "RenderBenchmark : unable to write " << outputPath;
+		return;
+	}
+
+	stream << "{\"version\":\"" << PROGRAM_VERSION_STRING << "\",\"renderer\":\"" << Renderer::getDriverName() << "\",\"frameMs\":" << FRAME_TIME_MS << ",\"views\":[\n";
+
+	bool first = true;
+	for (auto& view : frames)
+	{
+		auto& list = view.second;
+		if (list.empty())
+			continue;
+
+		std::vector<double> times;
+		double total = 0;
+		double drawCalls = 0, batches = 0, vertices = 0, stateCalls = 0;
+
+		for (auto& frame : list)
+		{
+			times.push_back(frame.ms);
+			total += frame.ms;
+			drawCalls += frame.drawCalls;
+			batches += frame.batches;
+			vertices += frame.vertices;
+			stateCalls += frame.stateCalls;
+		}
+
+		std::sort(times.begin(), times.end());
+
+		double count = (double)list.size();
+
+		stream << (first ? "" : ",\n") << "{\"view\":\"" << view.first << "\",\"frames\":" << list.size()
+			<< ",\"msMean\":" << (total / count)
+			<< ",\"msMedian\":" << times[times.size() / 2]
+			<< ",\"msP95\":" << times[std::min(times.size() - 1, (size_t)(count * 0.95))]
+			<< ",\"msMax\":" << times.back()
+			<< ",\"drawCalls\":" << (drawCalls / count)
+			<< ",\"batches\":" << (batches / count)
+			<< ",\"vertices\":" << (vertices / count)
+			<< ",\"stateCalls\":" << (stateCalls / count) << "}";
+
+		first = false;
+	}
+
+	stream << "\n]}\n";
+	stream.close();
+
+	LOG(LogInfo) << "RenderBenchmark : results written to " << outputPath;
+}
+
+int RenderBenchmark::play(Window* window, const std::vector<InputRecorder::Event>& events, int duration, const std::string& outputPath)
+{
+	LOG(LogInfo) << "RenderBenchmark : running with the " << Renderer::getDriverName() << " renderer";
+
+	std::map<std::string, std::vector<Frame>> frames;
+
+	auto it = events.cbegin();
+	for (int time = 0; time < duration || it != events.cend(); time += FRAME_TIME_MS)
+	{
+		// Each event on the frame covering its time
+		for (; it != events.cend() && it->time < time + FRAME_TIME_MS; it++)
+			sendInput(window, *it);
+
+		runFrame(window, frames);
+	}
+
+	if (Profiler::enabled())
+		Profiler::exportHistory();
+
+	writeResults(outputPath.empty() ? Paths::getUserEmulationStationPath() + "/es_render_benchmark.json" : outputPath, frames);
+	return 0;
+}
+
+int RenderBenchmark::run(Window* window, const std::string& scriptPath, const std::string& outputPath)
+{
+	std::vector<InputRecorder::Event> events;
+	int duration = 0;
+
+	loadScript(scriptPath, events, duration);
+	return play(window, events, duration, outputPath);
+}
+
+int RenderBenchmark::replay(Window* window, const std::string& recordingPath, const std::string& outputPath)
+{
+	std::vector<InputRecorder::Event> events;
+	int duration = 0;
+
+	if (!InputRecorder::load(recordingPath, events, duration))
+		return 1;
+
+	return play(window, events, duration, outputPath);
+}
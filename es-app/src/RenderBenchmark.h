@@ -0,0 +1,45 @@
+#pragma once
+#ifndef ES_APP_RENDER_BENCHMARK_H
+#define ES_APP_RENDER_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "InputRecorder.h"
+
+class Window;
+
+// Drives the UI with a scripted input sequence at a fixed timestep, and reports the CPU time, draw calls & vertices of the frames for each view type.
+// Run with --render-benchmark [script] [output] : headless with the NULL renderer when SDL uses the dummy or offscreen video driver.
+// The script has one command per line, '#' starts a comment :
+//   <input> [count]	press & release a mapped input ( up, down, a, b, start, pagedown... ) count times, 10 frames apart
+//   wait <frames>		run frames without input
+// --replay [recording] [output] plays an InputRecorder recording ( --record [file] ) the same way, each event on the frame of its time
+class RenderBenchmark
+{
+public:
+	static int run(Window* window, const std::string& scriptPath, const std::string& outputPath);
+	static int replay(Window* window, const std::string& recordingPath, const std::string& outputPath);
+
+private:
+	struct Frame
+	{
+		double ms;
+		unsigned int drawCalls;
+		unsigned int batches;
+		unsigned int vertices;
+		unsigned int stateCalls;
+	};
+
+	static int play(Window* window, const std::vector<InputRecorder::Event>& events, int duration, const std::string& outputPath);
+	static void runFrame(Window* window, std::map<std::string, std::vector<Frame>>& frames);
+	static void sendInput(Window* window, const InputRecorder::Event& event);
+
+	static std::string getViewType(Window* window);
+	static void loadScript(const std::string& scriptPath, std::vector<InputRecorder::Event>& events, int& duration);
+
+	static void writeResults(const std::string& outputPath, const std::map<std::string, std::vector<Frame>>& frames);
+};
+
+#endif // ES_APP_RENDER_BENCHMARK_H
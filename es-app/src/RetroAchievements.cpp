@@ -1,5 +1,7 @@
 #include "RetroAchievements.h"
+#include "HashCache.h"
 #include "HttpReq.h"
+#include "scrapers/ScraperCache.h"
 #include "ApiSystem.h"
 #include "SystemConf.h"
 #include "PlatformId.h"
@@ -9,6 +11,7 @@
 #include "ApiSystem.h"
 #include "Log.h"
 #include <algorithm>
+#include <atomic>
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/pointer.h>
 #include <libcheevos/cheevos.h>
@@ -124,6 +127,88 @@ const std::set<unsigned short> consolesWithmd5hashes
 	RC_CONSOLE_SUPERVISION
 };
 
+#define PROGRESS_CACHE_AGE	300		// User summary & game progress, seconds
+#define HASHES_CACHE_AGE	86400	// Hash library & official games list
+
+// A request whose response is kept on disk : served without network access for maxAge seconds, then revalidated with its ETag / Last-Modified.
+// The cache key leaves the API credentials out of the files
+class CachedRequest
+{
+public:
+	CachedRequest(const std::string& url, const std::string& cacheKey, int maxAge, time_t notBefore = 0) : mRequest(nullptr), mKey("RetroAchievements\n" + cacheKey), mFresh(false)
+	{
+		HttpReqOptions options;
+
+		if (ScraperCache::load(mKey, mResponse))
+		{
+			time_t now = time(NULL);
+			if (mResponse.time <= now && now - mResponse.time < maxAge && mResponse.time >= notBefore)
+			{
+				mFresh = true;
+				return;
+			}
+
+			if (!mResponse.etag.empty())
+				options.customHeaders.push_back("If-None-Match: " + mResponse.etag);
+
+			if (!mResponse.lastModified.empty())
+				options.customHeaders.push_back("If-Modified-Since: " + mResponse.lastModified);
+		}
+
+		mRequest = new HttpReq(url, &options);
+	}
+
+	~CachedRequest()
+	{
+		delete mRequest;
+	}
+
+	bool wait()
+	{
+		if (mFresh)
+			return true;
+
+		mRequest->wait();
+
+		auto status = mRequest->status();
+		if (status == HttpReq::REQ_304_NOTMODIFIED && !mResponse.content.empty())
+		{
+			mResponse.time = time(NULL);
+			ScraperCache::save(mKey, mResponse);
+			mFresh = true;
+			return true;
+		}
+
+		if (status != HttpReq::REQ_SUCCESS)
+			return false;
+
+		mResponse.time = time(NULL);
+		mResponse.etag = ScraperCache::getResponseHeader(mRequest, "ETag");
+		mResponse.lastModified = ScraperCache::getResponseHeader(mRequest, "Last-Modified");
+		mResponse.content = mRequest->getContent();
+
+		ScraperCache::save(mKey, mResponse);
+		mFresh = true;
+		return true;
+	}
+
+	const std::string& getContent() { return mResponse.content; }
+	std::string getErrorMsg() { return mRequest != nullptr ? mRequest->getErrorMsg() : ""; }
+
+private:
+	HttpReq* mRequest;
+	std::string mKey;
+	ScraperCache::Response mResponse;
+	bool mFresh;
+};
+
+static std::atomic<time_t> sProgressChangeTime(0);
+
+void RetroAchievements::invalidateProgress()
+{
+	sProgressChangeTime = time(NULL);
+}
+
 std::string RetroAchievements::getApiUrl(const std::string method, const std::string parameters)
 {
 #ifdef CHEEVOS_DEV_LOGIN
@@ -204,7 +289,9 @@ GameInfoAndUserProgress RetroAchievements::getGameInfoAndUserProgress(int gameId
 	return ret;
 #endif
 
-	HttpReq httpreq(getApiUrl("API_GetGameInfoAndUserProgress", "u=" + HttpReq::urlEncode(usrName) + "&g=" + std::to_string(gameId)));
+	std::string parameters = "u=" + HttpReq::urlEncode(usrName) + "&g=" + std::to_string(gameId);
+
+	CachedRequest httpreq(getApiUrl("API_GetGameInfoAndUserProgress", parameters), "API_GetGameInfoAndUserProgress?" + parameters, PROGRESS_CACHE_AGE, sProgressChangeTime);
 	if (httpreq.wait())
 	{
 		rapidjson::Document doc;
@@ -277,7 +364,9 @@ UserSummary RetroAchievements::getUserSummary(const std::string userName, int ga
 
 	std::string count = std::to_string(gameCount);
 
-	HttpReq httpreq(getApiUrl("API_GetUserSummary", "u="+ HttpReq::urlEncode(usrName) +"&g="+ count +"&a="+ count));
+	std::string parameters = "u=" + HttpReq::urlEncode(usrName) + "&g=" + count + "&a=" + count;
+
+	CachedRequest httpreq(getApiUrl("API_GetUserSummary", parameters), "API_GetUserSummary?" + parameters, PROGRESS_CACHE_AGE, sProgressChangeTime);
 	if (httpreq.wait())
 	{
 		rapidjson::Document doc;
@@ -438,8 +527,8 @@ std::map<std::string, std::string> RetroAchievements::getCheevosHashes()
 	{
 		std::map<int, std::string> officialGames;
 
-		HttpReq hashLibrary("https://retroachievements.org/dorequest.php?r=hashlibrary");
-		HttpReq officialGamesList("https://retroachievements.org/dorequest.php?r=officialgameslist");
+		CachedRequest hashLibrary("https://retroachievements.org/dorequest.php?r=hashlibrary", "hashlibrary", HASHES_CACHE_AGE);
+		CachedRequest officialGamesList("https://retroachievements.org/dorequest.php?r=officialgameslist", "officialgameslist", HASHES_CACHE_AGE);
 
 		// Official games
 		if (officialGamesList.wait())
@@ -518,32 +607,49 @@ std::string RetroAchievements::getCheevosHashFromFile(int consoleId, const std::
 	return "00000000000000000000000000000000";	
 }
 
-std::string RetroAchievements::getCheevosHash( SystemData* system, const std::string fileName)
+static int getCheevosConsoleId(SystemData* system)
 {
-	bool fromZipContents = system->shouldExtractHashesFromArchives();
-
-	int consoleId = 0;
-
 	for (auto pid : system->getPlatformIds())
 	{
 		auto it = cheevosConsoleID.find(pid);
 		if (it != cheevosConsoleID.cend())
-		{
-			consoleId = it->second;
-			break;
-		}
+			return it->second;
 	}
 
-	if (consoleId == RC_CONSOLE_ARCADE)
-		return getCheevosHashFromFile(consoleId, fileName);
+	return 0;
+}
 
-	if (consoleId == 0 || consolesWithmd5hashes.find(consoleId) != consolesWithmd5hashes.cend())
-		return ApiSystem::getInstance()->getMD5(fileName, fromZipContents);
+bool RetroAchievements::isCheevosHashMd5(SystemData* system)
+{
+	int consoleId = getCheevosConsoleId(system);
+	return consoleId == 0 || (consoleId != RC_CONSOLE_ARCADE && consolesWithmd5hashes.find(consoleId) != consolesWithmd5hashes.cend());
+}
 
+// rcheevos' own limit for the roms it reads in memory
+#define MAX_BUFFER_HASH_SIZE (64 * 1024 * 1024)
+
+std::string RetroAchievements::computeCheevosHash(int consoleId, bool fromZipContents, const std::string& fileName)
+{
 	std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(fileName));
-	if (ext != ".zip" && ext != ".7z")
+	if (consoleId == RC_CONSOLE_ARCADE || (ext != ".zip" && ext != ".7z"))
 		return getCheevosHashFromFile(consoleId, fileName);
 
+	// Cartridge roms are decompressed in memory and hashed there, instead of being written to a temporary folder
+	if (fromZipContents && ext == ".zip" && isHashFromBufferSupported(consoleId))
+	{
+		Utils::Zip::ZipFile file;
+		Utils::Zip::ZipInfo rom;
+		if (file.load(fileName) && file.findSingleFile(rom) && rom.file_size <= MAX_BUFFER_HASH_SIZE)
+		{
+			std::vector<unsigned char> data;
+			data.reserve(rom.file_size);
+
+			char hash[33];
+			if (file.readFile(rom.filename, data, MAX_BUFFER_HASH_SIZE) && generateHashFromBuffer(hash, consoleId, data.data(), data.size()))
+				return hash;
+		}
+	}
+
 	std::string contentFile = fileName;
 	std::string ret;
 	std::string tmpZipDirectory;
@@ -576,6 +682,31 @@ std::string RetroAchievements::getCheevosHash( SystemData* system, const std::st
 	return ret;
 }
 
+std::string RetroAchievements::getCheevosHash( SystemData* system, const std::string fileName)
+{
+	bool fromZipContents = system->shouldExtractHashesFromArchives();
+
+	int consoleId = getCheevosConsoleId(system);
+
+	if (consoleId != RC_CONSOLE_ARCADE && (consoleId == 0 || consolesWithmd5hashes.find(consoleId) != consolesWithmd5hashes.cend()))
+		return ApiSystem::getInstance()->getMD5(fileName, fromZipContents);
+
+	// The hash algorithm depends on the console : it's stored with the hash
+	std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(fileName));
+	bool fromArchive = fromZipContents && (ext == ".zip" || ext == ".7z");
+	std::string prefix = std::to_string(consoleId) + ":";
+
+	std::string cached;
+	if (HashCache::get(fileName, HashCache::HASH_CHEEVOS, fromArchive, cached) && Utils::String::startsWith(cached, prefix))
+		return cached.substr(prefix.size());
+
+	std::string ret = computeCheevosHash(consoleId, fromZipContents, fileName);
+	if (!ret.empty())
+		HashCache::set(fileName, HashCache::HASH_CHEEVOS, fromArchive, prefix + ret);
+
+	return ret;
+}
+
 bool RetroAchievements::testAccount(const std::string& username, const std::string& password, std::string& tokenOrError)
 {
 	if (username.empty() || password.empty())
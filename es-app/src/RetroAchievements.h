@@ -195,12 +195,16 @@ public:
 	static UserSummary				getUserSummary(const std::string userName = "", int gameCount = 500);
 	static GameInfoAndUserProgress	getGameInfoAndUserProgress(int gameId, const std::string userName = "");
 	static RetroAchievementInfo		toRetroAchivementInfo(UserSummary& ret);
+	// After a game : the cached progress is revalidated at the next query
+	static void						invalidateProgress();
 
 	static std::map<std::string, std::string>	getCheevosHashes();
 
 	static std::string				getCheevosHash(SystemData* pSystem, const std::string fileName);
+	static bool						isCheevosHashMd5(SystemData* pSystem); // getCheevosHash is ApiSystem::getMD5 for the games of the system
 	static bool						testAccount(const std::string& username, const std::string& password, std::string& tokenOrError);
 
 private:
 	static std::string				getCheevosHashFromFile(int consoleId, const std::string fileName);
+	static std::string				computeCheevosHash(int consoleId, bool fromZipContents, const std::string& fileName);
 };
@@ -0,0 +1,347 @@
+#include "RomFolderWatcher.h"
+
+#include "utils/FileSystemUtil.h"
+#include "views/gamelist/IGameListView.h"
+#include "views/ViewController.h"
+#include "scrapers/ThreadedScraper.h"
+#include "CollectionSystemManager.h"
+#include "ThreadedHasher.h"
+#include "FileData.h"
+#include "SystemData.h"
+#include "Settings.h"
+#include "Window.h"
+#include "Log.h"
+#include "TaskScheduler.h"
+
+#include <unordered_set>
+#include <algorithm>
+
+// Delay without changes before the paths are applied, and longest delay while a bulk copy keeps changing the folders
+#define WATCH_DELAY_MS		2000
+#define WATCH_MAX_DELAY_MS	10000
+
+std::mutex RomFolderWatcher::mLock;
+std::condition_variable RomFolderWatcher::mEvent;
+std::thread* RomFolderWatcher::mThread = nullptr;
+bool RomFolderWatcher::mExit = false;
+Window* RomFolderWatcher::mWindow = nullptr;
+int RomFolderWatcher::mListenerId = -1;
+std::set<std::string> RomFolderWatcher::mPending;
+std::chrono::steady_clock::time_point RomFolderWatcher::mFirstChange;
+std::chrono::steady_clock::time_point RomFolderWatcher::mLastChange;
+
+void RomFolderWatcher::start(Window* window)
+{
+	if (mThread != nullptr || !Settings::getInstance()->getBool("LiveRomFolders"))
+		return;
+
+	mWindow = window;
+	mExit = false;
+	mThread = new std::thread(&RomFolderWatcher::run);
+
+	mListenerId = Utils::FileSystem::addFileCacheWatchListener(&RomFolderWatcher::onPathChanged);
+}
+
+void RomFolderWatcher::stop()
+{
+	if (mThread == nullptr)
+		return;
+
+	Utils::FileSystem::removeFileCacheWatchListener(mListenerId);
+	mListenerId = -1;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		mExit = true;
+		mPending.clear();
+		mEvent.notify_all();
+	}
+
+	mThread->join();
+	delete mThread;
+	mThread = nullptr;
+}
+
+// Called from the file cache watcher thread
+void RomFolderWatcher::onPathChanged(const std::string& path)
+{
+	std::set<std::string> paths;
+	paths.insert(path);
+	queue(paths);
+}
+
+void RomFolderWatcher::queue(const std::set<std::string>& paths)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	if (mExit)
+		return;
+
+	auto now = std::chrono::steady_clock::now();
+	if (mPending.empty())
+		mFirstChange = now;
+
+	mLastChange = now;
+	mPending.insert(paths.cbegin(), paths.cend());
+	mEvent.notify_all();
+}
+
+void RomFolderWatcher::run()
+{
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::BACKGROUND);
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	while (!mExit)
+	{
+		if (mPending.empty())
+		{
+			mEvent.wait(lock);
+			continue;
+		}
+
+		auto due = std::min(mLastChange + std::chrono::milliseconds(WATCH_DELAY_MS), mFirstChange + std::chrono::milliseconds(WATCH_MAX_DELAY_MS));
+		if (std::chrono::steady_clock::now() < due)
+		{
+			mEvent.wait_until(lock, due);
+			continue;
+		}
+
+		std::set<std::string> paths;
+		paths.swap(mPending);
+
+		lock.unlock();
+		mWindow->postToUiThread([paths]() { apply(paths); });
+		lock.lock();
+	}
+}
+
+void RomFolderWatcher::apply(const std::set<std::string>& paths)
+{
+	if (!ViewController::hasInstance())
+		return;
+
+	// The scraper & the hasher keep pointers to the games : wait for them to be done
+	if (ThreadedScraper::isRunning() || ThreadedHasher::isRunning())
+	{
+		queue(paths);
+		return;
+	}
+
+	// Several systems can share a folder, with different extensions
+	for (auto system : SystemData::sSystemVector)
+	{
+		if (system->isCollection() || !system->isGameSystem() || system->getRootFolder() == nullptr)
+			continue;
+
+		std::vector<std::string> systemPaths;
+		for (auto& path : paths)
+			if (system->isRomPath(path))
+				systemPaths.push_back(path);
+
+		if (systemPaths.size())
+			applySystem(system, systemPaths);
+	}
+}
+
+// The virtual folder of a group child system, in the root of its group
+static FolderData* getGroupFolder(SystemData* system)
+{
+	if (!system->isGroupChildSystem())
+		return nullptr;
+
+	SystemData* group = system->getParentGroupSystem();
+	if (group == system)
+		return nullptr;
+
+	for (auto child : group->getRootFolder()->getChildren())
+		if (child->getType() == FOLDER && child->getSystem() == system && child->getPath() == system->getRootFolder()->getPath())
+			return (FolderData*)child;
+
+	return nullptr;
+}
+
+// paths are sorted : a folder comes before its files
+void RomFolderWatcher::applySystem(SystemData* system, const std::vector<std::string>& paths)
+{
+	FolderData* root = system->getRootFolder();
+
+	std::unordered_map<std::string, FileData*> fileMap;
+	fileMap[root->getPath()] = root;
+
+	for (auto file : root->getFilesRecursive(GAME | FOLDER, false, nullptr, false))
+		fileMap[file->getPath()] = file;
+
+	bool removed = false;
+	std::vector<std::string> added;
+
+	for (auto& path : paths)
+	{
+		auto it = fileMap.find(path);
+		if (it != fileMap.cend())
+		{
+			// Removed and created again before the changes were applied
+			if (Utils::FileSystem::exists(path))
+				continue;
+
+			removeNode(it->second, fileMap);
+			removed = true;
+			continue;
+		}
+
+		FileData* node = system->addPath(path, fileMap);
+		if (node != nullptr)
+			added.push_back(node->getPath());
+	}
+
+	std::unordered_set<FileData*> games;
+
+	for (auto& path : added)
+	{
+		auto it = fileMap.find(path);
+		if (it == fileMap.cend())
+			continue;
+
+		FileData* node = it->second;
+		if (node->getType() == GAME)
+			games.insert(node);
+		else
+			for (auto game : ((FolderData*)node)->getFilesRecursive(GAME))
+				games.insert(game);
+	}
+
+	// Tracks of the new multi-disk games, or new tracks of the multi-disk games in the same folders
+	if (Settings::RemoveMultiDiskContent() && games.size())
+	{
+		std::set<std::string> contentFiles;
+		std::set<FileData*> multiDiskGames;
+
+		for (auto game : games)
+		{
+			if (game->hasContentFiles())
+				multiDiskGames.insert(game);
+			else
+			{
+				for (auto sibling : game->getParent()->getChildren())
+					if (sibling->getType() == GAME && sibling->hasContentFiles())
+						multiDiskGames.insert(sibling);
+			}
+		}
+
+		for (auto game : multiDiskGames)
+			for (auto file : game->getContentFiles())
+				contentFiles.insert(file);
+
+		for (auto& file : contentFiles)
+		{
+			auto it = fileMap.find(file);
+			if (it == fileMap.cend() || it->second->getType() != GAME)
+				continue;
+
+			FileData* game = it->second;
+			fileMap.erase(it);
+
+			// New games are not in the index, the collections or the view yet
+			if (games.erase(game))
+				delete game;
+			else
+			{
+				removeNode(game, fileMap);
+				removed = true;
+			}
+		}
+	}
+
+	if (games.size())
+	{
+		SystemData* group = system->getParentGroupSystem();
+		FolderData* groupFolder = getGroupFolder(system);
+
+		// New nodes at the top of the tree are shared with the group
+		if (groupFolder != nullptr)
+		{
+			for (auto& path : added)
+			{
+				auto it = fileMap.find(path);
+				if (it != fileMap.cend() && it->second->getParent() == root)
+					groupFolder->addChild(it->second, false);
+			}
+		}
+
+		for (auto game : games)
+		{
+			system->addToIndex(game);
+			if (group != system)
+				group->addToIndex(game);
+		}
+
+		LOG(LogInfo) << "RomFolderWatcher : " << games.size() << " game(s) added to " << system->getName();
+	}
+
+	if (!removed && games.empty())
+		return;
+
+	system->updateDisplayedGameCount();
+	if (system->getParentGroupSystem() != system)
+		system->getParentGroupSystem()->updateDisplayedGameCount();
+
+	if (games.size())
+		CollectionSystemManager::get()->addCollectionFiles(std::vector<FileData*>(games.cbegin(), games.cend()));
+
+	ViewController::get()->onFileChanged(root, games.size() ? FILE_ADDED : FILE_REMOVED);
+}
+
+// Removes a game, or a folder with its games, then the parent folders left without games
+void RomFolderWatcher::removeNode(FileData* node, std::unordered_map<std::string, FileData*>& fileMap)
+{
+	FolderData* root = node->getSystem()->getRootFolder();
+	FolderData* parent = node->getParent();
+
+	fileMap.erase(node->getPath());
+
+	if (node->getType() == FOLDER)
+	{
+		for (auto file : ((FolderData*)node)->getFilesRecursive(GAME | FOLDER))
+			fileMap.erase(file->getPath());
+
+		for (auto game : ((FolderData*)node)->getFilesRecursive(GAME))
+			removeFromTree(game);
+	}
+
+	removeFromTree(node);
+
+	while (parent != nullptr && parent != root && parent->getChildren().size() == 0)
+	{
+		FolderData* next = parent->getParent();
+		fileMap.erase(parent->getPath());
+		removeFromTree(parent);
+		parent = next;
+	}
+}
+
+// Same as deleting a game from the game options, the files aside
+void RomFolderWatcher::removeFromTree(FileData* file)
+{
+	SystemData* system = file->getSystem();
+	SystemData* viewSystem = system->getParentGroupSystem();
+
+	if (file->getType() == GAME)
+	{
+		CollectionSystemManager::get()->deleteCollectionFiles(file);
+
+		if (viewSystem != system)
+			viewSystem->removeFromIndex(file);
+	}
+
+	auto view = ViewController::get()->getGameListView(viewSystem, false);
+	if (view != nullptr)
+	{
+		view.get()->remove(file);
+		return;
+	}
+
+	FolderData* groupFolder = getGroupFolder(system);
+	if (groupFolder != nullptr && file->getParent() == system->getRootFolder())
+		groupFolder->removeFromVirtualFolders(file);
+
+	delete file;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef ES_APP_ROM_FOLDER_WATCHER_H
+#define ES_APP_ROM_FOLDER_WATCHER_H
+
+#include <string>
+#include <set>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+class Window;
+class SystemData;
+class FileData;
+
+// Applies the roms added, removed or renamed in the system folders ( SMB, web manager... ) to the loaded trees, without reloading the games.
+// The paths come from the file cache watcher ( inotify, "SessionFileCache" ). They are coalesced until the folders have been quiet for a while,
+// then the UI thread updates the affected systems only : tree, filter index, collections & gamelist view.
+class RomFolderWatcher
+{
+public:
+	static void start(Window* window);
+	static void stop();
+
+private:
+	static void onPathChanged(const std::string& path);
+	static void queue(const std::set<std::string>& paths);
+	static void run();
+
+	// UI thread
+	static void apply(const std::set<std::string>& paths);
+	static void applySystem(SystemData* system, const std::vector<std::string>& paths);
+	static void removeNode(FileData* node, std::unordered_map<std::string, FileData*>& fileMap);
+	static void removeFromTree(FileData* file);
+
+	static std::mutex		mLock;
+	static std::condition_variable	mEvent;
+	static std::thread*		mThread;
+	static bool				mExit;
+	static Window*			mWindow;
+	static int				mListenerId;
+
+	static std::set<std::string> mPending;
+	static std::chrono::steady_clock::time_point mFirstChange;
+	static std::chrono::steady_clock::time_point mLastChange;
+};
+
+#endif // ES_APP_ROM_FOLDER_WATCHER_H
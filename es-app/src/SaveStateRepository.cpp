@@ -37,6 +37,7 @@ void SaveStateRepository::clear()
 			delete state;
 
 	mStates.clear();
+	mStamps.clear();
 }
 
 bool SaveStateRepository::supportsAutoSave()
@@ -57,72 +58,172 @@ bool SaveStateRepository::supportsIncrementalSaveStates()
 	return false;
 }
 
-void SaveStateRepository::refresh()
+SaveState* SaveStateRepository::createSaveState(std::shared_ptr<SaveStateConfig> rs, const std::string& path, const Utils::FileSystem::FileInfo& file, const std::string& rom, int slot)
 {
-	clear();
-
-	auto list = SaveStateConfigFile::getSaveStateConfigs(mSystem);
-	for (auto rs : list)
+	SaveState* state = new SaveState();
+	state->config = rs;
+	state->fileName = file.path;
+	state->rom = rom;
+	state->slot = slot;
+
+	// generators are the same for autosave and slots
+	state->fileGenerator = Utils::String::replace(rs->file, "{{romfilename}}", rom);
+	state->imageGenerator = Utils::String::replace(rs->image, "{{romfilename}}", rom);
+
+	// screenshot
+	if (Utils::FileSystem::exists(state->fileName + ".png"))
+		state->screenshot = state->fileName + ".png";
+	else
 	{
-		std::string path = rs->getDirectory(mSystem);
+		std::string screenshot = Utils::FileSystem::combine(path, slot < 0 ? rs->autosave_image : rs->image);
+
+		screenshot = Utils::String::replace(screenshot, "{{romfilename}}", rom);
+		screenshot = Utils::String::replace(screenshot, "{{slot}}", state->slot == 0 ? "" : std::to_string(state->slot));
+		screenshot = Utils::String::replace(screenshot, "{{slot0}}", std::to_string(state->slot));
+		screenshot = Utils::String::replace(screenshot, "{{slot00}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
+		screenshot = Utils::String::replace(screenshot, "{{slot2d}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
+
+		if (Utils::FileSystem::exists(screenshot))
+			state->screenshot = screenshot;
+	}
+
+	// retroarch specific commands
+	state->racommands = rs->racommands;
+	state->hasAutosave = rs->autosave;
 
-		if (!Utils::FileSystem::exists(path))
+#if WIN32
+	state->creationDate.setTime(file.lastWriteTime);
+#else
+	state->creationDate = Utils::FileSystem::getFileModificationDate(state->fileName);
+#endif
+
+	return state;
+}
+
+// Text of the file pattern before the rom name : the files of a rom start with it, followed by the rom name
+static std::string getRomPrefix(const std::string& pattern)
+{
+	auto pos = pattern.find("{{romfilename}}");
+	return pos == std::string::npos ? pattern : pattern.substr(0, pos);
+}
+
+void SaveStateRepository::removeStates(SaveStateConfig* config, const std::string& rom)
+{
+	for (auto it = mStates.begin(); it != mStates.end(); )
+	{
+		if (!rom.empty() && it->first != rom)
+		{
+			it++;
 			continue;
+		}
 
-		auto files = Utils::FileSystem::getDirectoryFiles(path);
-		for (auto file : files)
+		auto& states = it->second;
+		for (auto state = states.begin(); state != states.end(); )
 		{
-			if (file.hidden || file.directory)
-				continue;
+			if ((*state)->config.get() == config)
+			{
+				delete *state;
+				state = states.erase(state);
+			}
+			else
+				state++;
+		}
 
-			std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(file.path));
+		if (states.empty())
+			it = mStates.erase(it);
+		else
+			it++;
+	}
+}
 
-			std::string rom;
-			int slot = -1;
+void SaveStateRepository::scanDirectory(std::shared_ptr<SaveStateConfig> rs, const std::string& path, const std::string& rom)
+{
+	std::string slotPrefix = getRomPrefix(rs->file) + rom;
+	std::string autoPrefix = getRomPrefix(rs->autosave_file) + rom;
 
-			std::string fileName = Utils::FileSystem::getFileName(file.path);
-			if (!rs->matchSlotFile(fileName, rom, slot) && !rs->matchAutoFile(fileName, rom))
-				continue;
+	for (auto& file : Utils::FileSystem::getDirectoryFiles(path))
+	{
+		if (file.hidden || file.directory)
+			continue;
 
-			SaveState* state = new SaveState();
-			state->config = rs;
-			state->fileName = file.path;
-			state->rom = rom;
-			state->slot = slot;
+		std::string fileName = Utils::FileSystem::getFileName(file.path);
 
-			// generators are the same for autosave and slots
-			state->fileGenerator = Utils::String::replace(rs->file, "{{romfilename}}", rom);
-			state->imageGenerator = Utils::String::replace(rs->image, "{{romfilename}}", rom);
+		// Only the files of the rom go through the regular expressions
+		if (!rom.empty() && !Utils::String::startsWith(fileName, slotPrefix) && !Utils::String::startsWith(fileName, autoPrefix))
+			continue;
 
-			// screenshot
-			if (Utils::FileSystem::exists(state->fileName + ".png"))
-				state->screenshot = state->fileName + ".png";
-			else
-			{
-				std::string screenshot = Utils::FileSystem::combine(path, slot < 0 ? rs->autosave_image : rs->image);
-				std::string basename = Utils::FileSystem::getFileName(file.path);
+		std::string romName;
+		int slot = -1;
 
-				screenshot = Utils::String::replace(screenshot, "{{romfilename}}", rom);
-				screenshot = Utils::String::replace(screenshot, "{{slot}}", state->slot == 0 ? "" : std::to_string(state->slot));
-				screenshot = Utils::String::replace(screenshot, "{{slot0}}", std::to_string(state->slot));
-				screenshot = Utils::String::replace(screenshot, "{{slot00}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
-				screenshot = Utils::String::replace(screenshot, "{{slot2d}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
+		if (!rs->matchSlotFile(fileName, romName, slot) && !rs->matchAutoFile(fileName, romName))
+			continue;
 
-				if (Utils::FileSystem::exists(screenshot))
-					state->screenshot = screenshot;
-			}
+		if (!rom.empty() && romName != rom)
+			continue;
 
-			// retroarch specific commands
-			state->racommands = rs->racommands;
-			state->hasAutosave = rs->autosave;
+		mStates[romName].push_back(createSaveState(rs, path, file, romName, slot));
+	}
+}
 
-#if WIN32
-			state->creationDate.setTime(file.lastWriteTime);
-#else
-			state->creationDate = Utils::FileSystem::getFileModificationDate(state->fileName);
-#endif
-			mStates[state->rom].push_back(state);
+void SaveStateRepository::refresh()
+{
+	auto list = SaveStateConfigFile::getSaveStateConfigs(mSystem);
+	for (auto rs : list)
+	{
+		std::string path = rs->getDirectory(mSystem);
+
+		DirectoryStamp stamp;
+		if (!Utils::FileSystem::getDirectoryStamp(path, stamp.modificationTime, stamp.inode))
+		{
+			removeStates(rs.get());
+			mStamps.erase(rs.get());
+			continue;
+		}
+
+		// The files of the directory were not added, removed or renamed since the last scan
+		auto it = mStamps.find(rs.get());
+		if (it != mStamps.cend() && it->second.modificationTime == stamp.modificationTime && it->second.inode == stamp.inode)
+			continue;
+
+		removeStates(rs.get());
+		scanDirectory(rs, path);
+
+		mStamps[rs.get()] = stamp;
+	}
+}
+
+void SaveStateRepository::refresh(FileData* game)
+{
+	if (game == nullptr || game->getSourceFileData()->getSystem() != mSystem)
+	{
+		refresh();
+		return;
+	}
+
+	for (auto rs : SaveStateConfigFile::getSaveStateConfigs(mSystem))
+	{
+		std::string path = rs->getDirectory(mSystem);
+		std::string rom = rs->nofileextension ? Utils::FileSystem::getStem(game->getLeafName()) : game->getLeafName();
+
+		// A slot written again keeps its file name : the states of the game are read again whatever the stamp of the directory
+		removeStates(rs.get(), rom);
+
+		DirectoryStamp stamp;
+		if (!Utils::FileSystem::getDirectoryStamp(path, stamp.modificationTime, stamp.inode))
+			continue;
+
+		// Other games did not change : the directory stays up to date if it was
+		auto it = mStamps.find(rs.get());
+		if (it == mStamps.cend())
+		{
+			removeStates(rs.get());
+			scanDirectory(rs, path);
+			mStamps[rs.get()] = stamp;
+			continue;
 		}
+
+		scanDirectory(rs, path, rom);
+		it->second = stamp;
 	}
 }
 
@@ -133,7 +234,7 @@ bool SaveStateRepository::hasSaveStates(FileData* game)
 		if (game->getSourceFileData()->getSystem() != mSystem)
 			return false;
 
-		auto name = Utils::FileSystem::getFileName(game->getPath());
+		auto name = game->getLeafName();
 
 		auto it = mStates.find(name);
 		if (it != mStates.cend())
@@ -168,7 +269,7 @@ std::vector<SaveState*> SaveStateRepository::getSaveStates(FileData* game, std::
 			if (config != nullptr && !config->equals(rs))
 				continue;
 
-			std::string name = rs->nofileextension ? Utils::FileSystem::getStem(game->getPath()) : Utils::FileSystem::getFileName(game->getPath());
+			std::string name = rs->nofileextension ? Utils::FileSystem::getStem(game->getLeafName()) : game->getLeafName();
 
 			auto it = mStates.find(name);
 			if (it != mStates.cend())
@@ -226,7 +327,7 @@ void SaveStateRepository::renumberSlots(FileData* game, std::shared_ptr<SaveStat
 		return;
 
 	auto repo = game->getSourceFileData()->getSystem()->getSaveStateRepository();	
-	repo->refresh();
+	repo->refresh(game);
 
 	auto states = repo->getSaveStates(game, config);
 	if (states.size() == 0)
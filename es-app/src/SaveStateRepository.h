@@ -5,6 +5,7 @@
 #include <map>
 
 #include "SaveState.h"
+#include "utils/FileSystemUtil.h"
 
 class SystemData;
 class FileData;
@@ -27,7 +28,8 @@ public:
 	std::vector<SaveState*> getSaveStates(FileData* game, std::shared_ptr<SaveStateConfig> config = nullptr);
 
 	void clear();
-	void refresh();
+	void refresh();					// Scans the directories changed since the last refresh
+	void refresh(FileData* game);	// Scans the states of a game only, as after it ran
 
 	SaveState* getGameAutoSave(FileData* game);
 	SaveState* getDefaultAutoSaveSaveState();
@@ -38,8 +40,21 @@ public:
 private:
 	// std::string getDefaultSavesPath();
 
+	struct DirectoryStamp
+	{
+		long long			modificationTime;
+		unsigned long long	inode;
+	};
+
+	SaveState* createSaveState(std::shared_ptr<SaveStateConfig> rs, const std::string& path, const Utils::FileSystem::FileInfo& file, const std::string& rom, int slot);
+	void scanDirectory(std::shared_ptr<SaveStateConfig> rs, const std::string& path, const std::string& rom = "");	// All roms when empty
+	void removeStates(SaveStateConfig* config, const std::string& rom = "");
+
 	SystemData* mSystem;
-	std::map<std::string, std::vector<SaveState*>> mStates;
+	std::map<std::string, std::vector<SaveState*>> mStates; // By rom name
+
+	// Directory stamps of the configs, at their last scan
+	std::map<SaveStateConfig*, DirectoryStamp> mStamps;
 
 	static SaveState* _empty;
 	SaveState* _autosave;
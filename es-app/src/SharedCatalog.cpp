@@ -0,0 +1,93 @@
+#include "SharedCatalog.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <mutex>
+
+static std::mutex sPublishLock;
+
+std::string SharedCatalog::getRoot()
+{
+	std::string path = Settings::getInstance()->getString("SharedCatalogPath");
+	if (path.empty())
+		return "";
+
+	return Utils::FileSystem::getGenericPath(path);
+}
+
+bool SharedCatalog::isPublisher()
+{
+	return Settings::getInstance()->getString("SharedCatalogMode") == "publish" && !getRoot().empty();
+}
+
+bool SharedCatalog::isConsumer()
+{
+	return Settings::getInstance()->getString("SharedCatalogMode") == "use" && !getRoot().empty();
+}
+
+std::string SharedCatalog::getSharedPath(const std::string& relativePath)
+{
+	if (!isConsumer())
+		return "";
+
+	return getRoot() + "/" + relativePath;
+}
+
+bool SharedCatalog::publishFile(const std::string& localPath, const std::string& sharedPath)
+{
+	if (!Utils::FileSystem::exists(localPath))
+		return false;
+
+	// Already published
+	if (Utils::FileSystem::exists(sharedPath) &&
+		Utils::FileSystem::getFileSize(sharedPath) == Utils::FileSystem::getFileSize(localPath) &&
+		Utils::FileSystem::getFileModificationDate(sharedPath).getTime() >= Utils::FileSystem::getFileModificationDate(localPath).getTime())
+		return false;
+
+	// The consumers may be mapping the previous file : it's replaced, never rewritten
+	std::string tmpPath = sharedPath + ".tmp";
+
+	if (!Utils::FileSystem::copyFile(localPath, tmpPath) || !Utils::FileSystem::renameFile(tmpPath, sharedPath))
+	{
+		LOG(LogWarning) << "SharedCatalog : Unable to publish " << sharedPath;
+		Utils::FileSystem::removeFile(tmpPath);
+		return false;
+	}
+
+	return true;
+}
+
+void SharedCatalog::publish()
+{
+	if (!isPublisher())
+		return;
+
+	std::unique_lock<std::mutex> lock(sPublishLock);
+
+	std::string root = getRoot();
+	std::string userPath = Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath());
+
+	int count = 0;
+
+	for (auto file : Utils::FileSystem::getDirContent(userPath + "/cache/gamelists"))
+	{
+		std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(file));
+		if (ext != ".cache" && ext != ".dirs")
+			continue;
+
+		if (publishFile(file, root + "/cache/gamelists/" + Utils::FileSystem::getFileName(file)))
+			count++;
+	}
+
+	if (publishFile(userPath + "/cache/hashes.cache", root + "/cache/hashes.cache"))
+		count++;
+
+	if (publishFile(userPath + "/imagecache.bin", root + "/imagecache.bin"))
+		count++;
+
+	LOG(LogInfo) << "SharedCatalog : " << count << " files published to " << root;
+}
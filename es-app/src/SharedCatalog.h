@@ -0,0 +1,29 @@
+#pragma once
+#ifndef ES_APP_SHARED_CATALOG_H
+#define ES_APP_SHARED_CATALOG_H
+
+#include <string>
+
+// Catalog snapshots shared by the cabinets of a fleet, when the roms & gamelists live on a network share.
+// The publishing node copies its gamelist caches, directory manifests, hash cache & image size cache to the "SharedCatalogPath" folder.
+// The other nodes ( "SharedCatalogMode" = "use" ) map those files from the share whenever they have no valid local copy :
+// the snapshots are keyed like the local ones, so an outdated file is ignored and the node falls back to the usual scan.
+// Consumers never rewrite the shared gamelist.xml files : their changes ( play counts, favorites... ) stay in the local gamelist journal.
+class SharedCatalog
+{
+public:
+	static bool isPublisher();
+	static bool isConsumer();
+
+	// File of the share matching a local cache file, relative to the user folder ( ex : "cache/hashes.cache" ). Empty when not a consumer
+	static std::string getSharedPath(const std::string& relativePath);
+
+	// Copies the local caches to the share. Thread safe, does nothing if the node is not the publisher
+	static void publish();
+
+private:
+	static std::string getRoot();
+	static bool publishFile(const std::string& localPath, const std::string& sharedPath);
+};
+
+#endif // ES_APP_SHARED_CATALOG_H
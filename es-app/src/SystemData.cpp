@@ -7,23 +7,36 @@
 #include "FileFilterIndex.h"
 #include "FileSorts.h"
 #include "Gamelist.h"
+#include "DirectoryManifest.h"
+#include "GamelistSource.h"
+#include "GamelistWriter.h"
 #include "Log.h"
+#include "Trace.h"
 #include "utils/Platform.h"
 #include "Settings.h"
 #include "ThemeData.h"
+#include "SoundBank.h"
 #include "views/UIModeController.h"
 #include <fstream>
 #include "Window.h"
 #include "LocaleES.h"
 #include "utils/StringUtil.h"
 #include "utils/Randomizer.h"
+#include "RandomGamePool.h"
 #include "views/ViewController.h"
 #include "ThreadedHasher.h"
 #include <unordered_set>
 #include <algorithm>
 #include <functional>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include "SaveStateRepository.h"
+#include "LocalArtIndex.h"
+#include "FileDataArena.h"
 #include "Paths.h"
+#include "ConfigCache.h"
 
 #if WIN32
 #include "Win32ApiSystem.h"
@@ -31,6 +44,9 @@
 
 using namespace Utils;
 
+#define MULTIDISK_BATCH_SIZE	32 // Playlists read by each work item of removeMultiDiskContent
+#define SYSTEMS_CACHE_VERSION	"1" // Increase when SystemDecl changes
+
 static std::map<std::string, std::function<std::string(SystemData*)>> properties =
 {
 	{ "name",			[] (SystemData* sys) { return sys->getName(); } },
@@ -48,15 +64,20 @@ VectorEx<SystemData*> SystemData::sSystemVector;
 bool SystemData::IsManufacturerSupported = false;
 
 SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envData, std::vector<EmulatorData>* pEmulators, bool CollectionSystem, bool groupedSystem, bool withTheme, bool loadThemeOnlyIfElements) :
-	mMetadata(meta), mEnvData(envData), mIsCollectionSystem(CollectionSystem), mIsGameSystem(true)
+	mMetadata(meta), mEnvData(envData), mIsCollectionSystem(CollectionSystem), mIsGameSystem(true), mPendingPopulation(false), mPopulating(false)
 {
 	mSaveRepository = nullptr;
+	mLocalArtIndex = nullptr;
+	mFileDataArena = new FileDataArena();
+	mGamelistSource = nullptr;
 	mIsCheevosSupported = -1;
 	mIsGroupSystem = groupedSystem;
 	mGameListHash = 0;
 	mGameCountInfo = nullptr;
 	mSortId = Settings::getInstance()->getInt(getName() + ".sort");
 	mGridSizeOverride = Vector2f(0, 0);
+	mSettingsGeneration = 0;
+	mShowHiddenFilesOverride = -1;
 
 	mFilterIndex = nullptr;
 
@@ -71,15 +92,20 @@ SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envDat
 	// if it's an actual system, initialize it, if not, just create the data structure
 	if (!mIsCollectionSystem && mIsGameSystem)
 	{
-		mRootFolder = new FolderData(mEnvData->mStartPath, this);
+		mRootFolder = new (this) FolderData(mEnvData->mStartPath, this);
 		mRootFolder->getMetadata().set(MetaDataId::Name, mMetadata.fullName);
+		mLocalArtIndex = new LocalArtIndex(mEnvData->mStartPath);
 
 		std::unordered_map<std::string, FileData*> fileMap;
 		fileMap[mEnvData->mStartPath] = mRootFolder;
 
 		if (!Settings::ParseGamelistOnly())
 		{
-			populateFolder(mRootFolder, fileMap);
+			Utils::FileSystem::watchFileCacheRoot(mEnvData->mStartPath);
+
+			DirectoryManifest manifest(this);
+			populateFolder(mRootFolder, fileMap, &manifest);
+			manifest.save();
 
 			if (!UIModeController::LoadEmptySystems())
 			{
@@ -100,7 +126,7 @@ SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envDat
 	else
 	{
 		// virtual systems are updated afterwards, we're just creating the data structure
-		mRootFolder = new FolderData(mMetadata.fullName, this);
+		mRootFolder = new (this) FolderData(mMetadata.fullName, this);
 		mRootFolder->getMetadata().set(MetaDataId::Name, mMetadata.fullName);
 	}
 
@@ -123,20 +149,41 @@ SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envDat
 
 SystemData::~SystemData()
 {
+	// The whole tree goes : no need to take the games out of the filter index one by one
+	if (mFilterIndex != nullptr)
+	{
+		delete mFilterIndex;
+		mFilterIndex = nullptr;
+	}
+
 	if (mRootFolder)
 		delete mRootFolder;
 
+	if (mFileDataArena != nullptr)
+		mFileDataArena->release();
+
 	if (!mIsCollectionSystem && mEnvData != nullptr)
 		delete mEnvData;
 
 	if (mSaveRepository != nullptr)
 		delete mSaveRepository;
 
+	if (mLocalArtIndex != nullptr)
+		delete mLocalArtIndex;
+
 	if (mGameCountInfo != nullptr)
 		delete mGameCountInfo;
 
-	if (mFilterIndex != nullptr)
-		delete mFilterIndex;
+	if (mGamelistSource != nullptr)
+		delete mGamelistSource;
+}
+
+void SystemData::setGamelistSource(GamelistSource* source)
+{
+	if (mGamelistSource != nullptr && mGamelistSource != source)
+		delete mGamelistSource;
+
+	mGamelistSource = source;
 }
 
 void SystemData::removeMultiDiskContent(std::unordered_map<std::string, FileData*>& fileMap)
@@ -146,8 +193,7 @@ void SystemData::removeMultiDiskContent(std::unordered_map<std::string, FileData
 
 	StopWatch stopWatch("RemoveMultiDiskContent - "+ getName() +" :", LogDebug);
 
-	std::vector<std::string> files;
-
+	std::vector<FileData*> games;
 	std::vector<FolderData*> folders;
 
 	std::stack<FolderData*> stack;
@@ -161,10 +207,7 @@ void SystemData::removeMultiDiskContent(std::unordered_map<std::string, FileData
 		for (auto it : current->getChildren())
 		{
 			if (it->getType() == GAME && it->hasContentFiles())
-			{
-				for (auto ct : it->getContentFiles())
-					files.push_back(ct);
-			}
+				games.push_back(it);
 			else if (it->getType() == FOLDER)
 			{
 				folders.push_back((FolderData*)it);
@@ -173,13 +216,41 @@ void SystemData::removeMultiDiskContent(std::unordered_map<std::string, FileData
 		}
 	}
 
-	for (auto file : files)
+	// The playlists are read in parallel, the games removed afterwards
+	std::vector<std::set<std::string>> contents(games.size());
+
+	if (games.size() > MULTIDISK_BATCH_SIZE)
 	{
-		auto it = fileMap.find(file);
-		if (it != fileMap.cend())
+		ThreadPool pool;
+
+		for (size_t start = 0; start < games.size(); start += MULTIDISK_BATCH_SIZE)
 		{
-			delete it->second;
-			fileMap.erase(it);
+			pool.queueWorkItem([&games, &contents, start]
+			{
+				size_t end = std::min(games.size(), start + MULTIDISK_BATCH_SIZE);
+				for (size_t i = start; i < end; i++)
+					contents[i] = games[i]->getContentFiles();
+			});
+		}
+
+		pool.wait();
+	}
+	else
+	{
+		for (size_t i = 0; i < games.size(); i++)
+			contents[i] = games[i]->getContentFiles();
+	}
+
+	for (auto& content : contents)
+	{
+		for (auto& file : content)
+		{
+			auto it = fileMap.find(file);
+			if (it != fileMap.cend())
+			{
+				delete it->second;
+				fileMap.erase(it);
+			}
 		}
 	}
 
@@ -206,8 +277,35 @@ void SystemData::setIsGameSystemStatus()
 	mIsGameSystem = (mMetadata.name != "retropie" && mMetadata.name != "retrobat");
 }
 
-void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::string, FileData*>& fileMap)
+// Shared state of the folder walk of a system : queued folders are processed by the walking thread,
+// and by helpers running in the loading thread pool when there's one ( so a huge system doesn't stay on a single core )
+class FolderWalk
 {
+public:
+	FolderWalk(std::unordered_map<std::string, FileData*>& map, DirectoryManifest* dirManifest, ThreadPool* threadPool) :
+		fileMap(map), manifest(dirManifest), pool(threadPool), showHidden(false), preloadMedias(false), active(0), helpers(0) { }
+
+	std::unordered_map<std::string, FileData*>& fileMap;
+	DirectoryManifest* manifest;
+	ThreadPool* pool;
+
+	bool showHidden;
+	bool preloadMedias;
+
+	std::mutex lock;
+	std::condition_variable changed; // Folders were queued, or one has been processed
+	std::queue<FolderData*> queue;
+	std::unordered_map<FolderData*, std::vector<FolderData*>> subFolders;
+	int active;
+	int helpers;
+};
+
+static ThreadPool* sFolderWalkPool = nullptr;
+
+void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::string, FileData*>& fileMap, DirectoryManifest* manifest)
+{
+	TraceSpan span("populateFolder", folder->getPath());
+
 	const std::string& folderPath = folder->getPath();
 
 	if(!Utils::FileSystem::isDirectory(folderPath))
@@ -225,28 +323,77 @@ void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::stri
 		}
 	}
 	*/
+	// Parallel helpers only make a spinning disk or a network share seek between the folders
+	ThreadPool* pool = sFolderWalkPool;
+	if (pool != nullptr && Utils::FileSystem::getStorageDevice(folderPath).sequential)
+		pool = nullptr;
+
+	auto walk = std::make_shared<FolderWalk>(fileMap, manifest, pool);
+	walk->showHidden = getShowHiddenFiles();
+	walk->preloadMedias = Settings::PreloadMedias();
+
+	walk->queue.push(folder);
+
+	// This thread works on the walk too, until every queued folder has been processed
+	while (true)
+	{
+		if (processFolderWalk(walk))
+			continue;
+
+		// The folders being processed by the helpers may queue new ones
+		std::unique_lock<std::mutex> lock(walk->lock);
+		walk->changed.wait(lock, [&walk]() { return !walk->queue.empty() || walk->active == 0; });
+
+		if (walk->queue.empty())
+			break;
+	}
+
+	attachSubFolders(folder, walk.get());
+}
+
+// Processes one queued folder. Returns false if the queue is empty
+bool SystemData::processFolderWalk(const std::shared_ptr<FolderWalk>& walk)
+{
+	std::unique_lock<std::mutex> lock(walk->lock);
+	if (walk->queue.empty())
+		return false;
+
+	FolderData* folder = walk->queue.front();
+	walk->queue.pop();
+	walk->active++;
+	lock.unlock();
+
+	populateFolderEntries(folder, walk);
+
+	lock.lock();
+	walk->active--;
+	walk->changed.notify_all();
+	return true;
+}
+
+// Adds the games of a folder, and queues its subfolders. Subfolders are attached once the whole walk is done
+void SystemData::populateFolderEntries(FolderData* folder, const std::shared_ptr<FolderWalk>& walk)
+{
 	std::string filePath;
 	std::string extension;
 	bool isGame;
-	bool showHidden = Settings::ShowHiddenFiles();
-	bool preloadMedias = Settings::PreloadMedias();
 
-	auto shv = Settings::getInstance()->getString(getName() + ".ShowHiddenFiles");
-	if (shv == "1") showHidden = true;
-	else if (shv == "0") showHidden = false;
+	std::vector<FileData*> games;
+	std::vector<FolderData*> folders;
 
-	Utils::FileSystem::fileList dirContent = Utils::FileSystem::getDirectoryFiles(folderPath);
+	Utils::FileSystem::fileList dirContent = walk->manifest != nullptr ? walk->manifest->getDirectoryFiles(folder->getPath()) : Utils::FileSystem::getDirectoryFiles(folder->getPath());
 	for (auto fileInfo : dirContent)
 	{
 		filePath = fileInfo.path;
 
 		// skip hidden files and folders
-		if(!showHidden && fileInfo.hidden)
+		if(!walk->showHidden && fileInfo.hidden)
 			continue;
 
 		//this is a little complicated because we allow a list of extensions to be defined (delimited with a space)
 		//we first get the extension of the file itself:
-		extension = Utils::String::toLower(Utils::FileSystem::getExtension(filePath));
+		extension = Utils::FileSystem::getExtension(filePath);
+		Utils::String::toLowerInPlace(extension);
 
 		//fyi, folders *can* also match the extension and be added as games - this is mostly just to support higan
 		//see issue #75: https://github.com/Aloshi/EmulationStation/issues/75
@@ -254,13 +401,13 @@ void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::stri
 		isGame = false;
 		if(mEnvData->isValidExtension(extension))
 		{
-			FileData* newGame = new FileData(GAME, filePath, this);
+			FileData* newGame = new (this) FileData(GAME, filePath, this);
 
 			// preventing new arcade assets to be added
 			if(!newGame->isArcadeAsset())
 			{
 				folder->addChild(newGame);
-				fileMap[filePath] = newGame;
+				games.push_back(newGame);
 				isGame = true;
 			}
 		}
@@ -270,11 +417,7 @@ void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::stri
 		{
 			std::string fn = Utils::String::toLower(Utils::FileSystem::getFileName(filePath));
 
-			// Never look in "artwork", reserved for mame roms artwork
-			if (fn == "artwork")
-				continue;
-
-			if (preloadMedias && (!mHidden || Settings::HiddenSystemsShowGames()))
+			if (walk->preloadMedias && (!mHidden || Settings::HiddenSystemsShowGames()))
 			{
 				// Recurse list files in medias folder, just to let OS build filesystem cache 
 				if (fn == "media" || fn == "medias")
@@ -291,43 +434,226 @@ void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::stri
 				}
 			}
 
-			// Don't loose time looking in downloaded_images, downloaded_videos & media folders
-			if (fn == "media" || fn == "medias" || fn == "images" || fn == "manuals" || fn == "videos" || fn == "assets" || Utils::String::startsWith(fn, "downloaded_") || Utils::String::startsWith(fn, "."))
-				continue;
-			
-			// Hardcoded optimisation : WiiU has so many files in content & meta directories
-			if (mMetadata.name == "wiiu" && (fn == "content" || fn == "meta"))
+			if (isIgnoredFolder(fn))
 				continue;
 
-			// Hardcoded optimisation : vpinball 'roms' subfolder must be excluded
-			if (mMetadata.name == "vpinball" && fn == "roms")
-				continue;			
+			folders.push_back(new (this) FolderData(filePath, this));
+		}
+	}
 
-			FolderData* newFolder = new FolderData(filePath, this);
-			populateFolder(newFolder, fileMap);
+	if (games.size() == 0 && folders.size() == 0)
+		return;
 
-			//ignore folders that do not contain games
-			if(newFolder->getChildren().size() == 0)
-				delete newFolder;
-			else 
-			{
-				const std::string& key = newFolder->getPath();
-				if (fileMap.find(key) == fileMap.end())
-				{
-					folder->addChild(newFolder);
-					fileMap[key] = newFolder;
-				}
-			}
+	std::unique_lock<std::mutex> lock(walk->lock);
+
+	for (auto game : games)
+		walk->fileMap[game->getPath()] = game;
+
+	if (folders.size() == 0)
+		return;
+
+	walk->subFolders[folder] = folders;
+
+	for (auto newFolder : folders)
+		walk->queue.push(newFolder);
+
+	walk->changed.notify_all();
+
+	if (walk->pool == nullptr)
+		return;
+
+	// Wake up helpers in the thread pool for the folders that have just been queued
+	int maxHelpers = TaskScheduler::getWorkerCount(TaskScheduler::UI_CRITICAL) - 1;
+	int count = std::min((int)walk->queue.size(), maxHelpers - walk->helpers);
+	if (count <= 0)
+		return;
+
+	walk->helpers += count;
+	lock.unlock();
+
+	for (int i = 0; i < count; i++)
+	{
+		walk->pool->queueWorkItem([this, walk]
+		{
+			while (processFolderWalk(walk));
+
+			std::unique_lock<std::mutex> lock(walk->lock);
+			walk->helpers--;
+		});
+	}
+}
+
+// Folders never searched for games. name is lower case
+bool SystemData::isIgnoredFolder(const std::string& name) const
+{
+	// Never look in "artwork", reserved for mame roms artwork
+	if (name == "artwork")
+		return true;
+
+	// Don't loose time looking in downloaded_images, downloaded_videos & media folders
+	if (name == "media" || name == "medias" || name == "images" || name == "manuals" || name == "videos" || name == "assets" || Utils::String::startsWith(name, "downloaded_") || Utils::String::startsWith(name, "."))
+		return true;
+
+	// Hardcoded optimisation : WiiU has so many files in content & meta directories
+	if (mMetadata.name == "wiiu" && (name == "content" || name == "meta"))
+		return true;
+
+	// Hardcoded optimisation : vpinball 'roms' subfolder must be excluded
+	if (mMetadata.name == "vpinball" && name == "roms")
+		return true;
+
+	return false;
+}
+
+bool SystemData::isRomPath(const std::string& path) const
+{
+	if (mEnvData == nullptr || mEnvData->mStartPath.empty() || !Utils::String::startsWith(path, mEnvData->mStartPath + "/"))
+		return false;
+
+	// The folders between the start path & the file
+	for (auto name : Utils::String::split(Utils::FileSystem::getParent(path).substr(mEnvData->mStartPath.size()), '/', true))
+		if (isIgnoredFolder(Utils::String::toLower(name)))
+			return false;
+
+	return true;
+}
+
+FileData* SystemData::addPath(const std::string& path, std::unordered_map<std::string, FileData*>& fileMap)
+{
+	if (fileMap.find(path) != fileMap.cend() || !isRomPath(path) || !Utils::FileSystem::exists(path))
+		return nullptr;
+
+	if (!getShowHiddenFiles() && Utils::FileSystem::isHidden(path))
+		return nullptr;
+
+	FileData* node = nullptr;
+
+	std::string extension = Utils::FileSystem::getExtension(path);
+	Utils::String::toLowerInPlace(extension);
+
+	if (mEnvData->isValidExtension(extension))
+	{
+		FileData* newGame = new (this) FileData(GAME, path, this);
+
+		// preventing new arcade assets to be added
+		if (newGame->isArcadeAsset())
+			delete newGame;
+		else
+			node = newGame;
+	}
+
+	if (node == nullptr && Utils::FileSystem::isDirectory(path))
+	{
+		if (isIgnoredFolder(Utils::String::toLower(Utils::FileSystem::getFileName(path))))
+			return nullptr;
+
+		FolderData* folder = new (this) FolderData(path, this);
+		populateFolder(folder, fileMap);
+
+		//ignore folders that do not contain games
+		if (folder->getChildren().size() == 0)
+		{
+			delete folder;
+			return nullptr;
+		}
+
+		node = folder;
+	}
+
+	if (node == nullptr)
+		return nullptr;
+
+	fileMap[path] = node;
+
+	// The parent folders without games were not in the tree
+	while (true)
+	{
+		std::string parentPath = Utils::FileSystem::getParent(node->getPath());
+
+		auto it = fileMap.find(parentPath);
+		if (it != fileMap.cend() && it->second->getType() == FOLDER)
+		{
+			((FolderData*)it->second)->addChild(node);
+			return node;
+		}
+
+		// Below a folder which is a game ( higan ), or fileMap misses the root folder
+		if (it != fileMap.cend() || parentPath.size() <= mEnvData->mStartPath.size())
+		{
+			for (auto file : node->getType() == FOLDER ? ((FolderData*)node)->getFilesRecursive(GAME | FOLDER) : std::vector<FileData*>())
+				fileMap.erase(file->getPath());
+
+			fileMap.erase(node->getPath());
+			delete node;
+			return nullptr;
+		}
+
+		FolderData* folder = new (this) FolderData(parentPath, this);
+		folder->addChild(node);
+		fileMap[parentPath] = folder;
+		node = folder;
+	}
+}
+
+// Attaches the subfolders containing games and deletes the empty ones, children first
+void SystemData::attachSubFolders(FolderData* folder, FolderWalk* walk)
+{
+	auto it = walk->subFolders.find(folder);
+	if (it == walk->subFolders.cend())
+		return;
+
+	for (auto newFolder : it->second)
+	{
+		attachSubFolders(newFolder, walk);
+
+		//ignore folders that do not contain games
+		if (newFolder->getChildren().size() == 0)
+		{
+			delete newFolder;
+			continue;
+		}
+
+		const std::string& key = newFolder->getPath();
+		if (walk->fileMap.find(key) == walk->fileMap.end())
+		{
+			folder->addChild(newFolder);
+			walk->fileMap[key] = newFolder;
 		}
+		else
+			delete newFolder;
 	}
 }
 
+void SystemData::setPendingPopulation(const std::function<void()>& populate)
+{
+	std::unique_lock<std::recursive_mutex> lock(mPopulateLock);
+	mPopulate = populate;
+	mPendingPopulation = (populate != nullptr);
+}
+
+void SystemData::populatePending() const
+{
+	// Other threads wait for the population, the populating one gets the tree being filled
+	std::unique_lock<std::recursive_mutex> lock(mPopulateLock);
+	if (!mPendingPopulation || mPopulating)
+		return;
+
+	// The population clears mPopulate
+	std::function<void()> populate = mPopulate;
+
+	mPopulating = true;
+	populate();
+	mPopulate = nullptr;
+	mPopulating = false;
+	mPendingPopulation = false;
+}
+
 FileFilterIndex* SystemData::getIndex(bool createIndex)
 {
 	if (mFilterIndex == nullptr && createIndex)
 	{
 		mFilterIndex = new FileFilterIndex();
-		indexAllGameFilters(mRootFolder);
+		indexAllGameFilters(getRootFolder());
 		mFilterIndex->setUIModeFilters();
 	}
 
@@ -454,7 +780,7 @@ void SystemData::createGroupedSystems()
 			auto children = childSystem->getRootFolder()->getChildren();
 			if (children.size() > 0)
 			{
-				auto folder = new FolderData(childSystem->getRootFolder()->getPath(), childSystem, false);
+				auto folder = new (system) FolderData(childSystem->getRootFolder()->getPath(), childSystem, false); // Owned by the group
 				folder->setMetadata(childSystem->getRootFolder()->getMetadata());
 				root->addChild(folder);
 
@@ -654,75 +980,65 @@ bool SystemData::isFeatureSupported(std::string emulatorName, std::string coreNa
 }
 
 // Load custom additionnal config from es_systems_*.cfg files
-void SystemData::loadAdditionnalConfig(pugi::xml_node& srcSystems)
+void SystemData::loadAdditionnalConfig(pugi::xml_node& srcSystems, const std::vector<std::string>& files)
 {	
-	std::vector<std::string> rootPaths = { Paths::getUserEmulationStationPath(), Paths::getEmulationStationPath() };
-	for (auto rootPath : VectorHelper::distinct(rootPaths, [](auto x) { return x; }))
+	for (auto customPath : files)
 	{
-		for (auto customPath : Utils::FileSystem::getDirContent(rootPath, false, false))
+		pugi::xml_document doc;
+		pugi::xml_parse_result res = doc.load_file(WINSTRINGW(customPath).c_str());
+		if (!res)
 		{
-			if (Utils::FileSystem::getExtension(customPath) != ".cfg")
-				continue;
+			LOG(LogError) << "Could not parse " << Utils::FileSystem::getFileName(customPath) << " file!";
+			return;
+		}
+
+		pugi::xml_node systemList = doc.child("systemList");
+		if (!systemList)
+		{
+			LOG(LogError) << Utils::FileSystem::getFileName(customPath) << " is missing the <systemList> tag !";
+			return;
+		}
 
-			if (!Utils::String::startsWith(Utils::FileSystem::getFileName(customPath), "es_systems_"))
+		for (pugi::xml_node system = systemList.child("system"); system; system = system.next_sibling("system"))
+		{
+			if (!system.child("name"))
 				continue;
 
-			pugi::xml_document doc;
-			pugi::xml_parse_result res = doc.load_file(WINSTRINGW(customPath).c_str());
-			if (!res)
-			{
-				LOG(LogError) << "Could not parse " << Utils::FileSystem::getFileName(customPath) << " file!";
-				return;
-			}
+			std::string name = system.child("name").text().get();
+			if (name.empty())
+				continue;
 
-			pugi::xml_node systemList = doc.child("systemList");
-			if (!systemList)
-			{
-				LOG(LogError) << Utils::FileSystem::getFileName(customPath) << " is missing the <systemList> tag !";
-				return;
-			}
+			bool found = false;
 
-			for (pugi::xml_node system = systemList.child("system"); system; system = system.next_sibling("system"))
+			// Remove existing one
+			for (pugi::xml_node& srcSystem : srcSystems.children())
 			{
-				if (!system.child("name"))
+				if (std::string(srcSystem.name()) != "system")
 					continue;
 
-				std::string name = system.child("name").text().get();
-				if (name.empty())
+				std::string srcName = srcSystem.child("name").text().get();
+				if (srcName != name)
 					continue;
 
-				bool found = false;
+				found = true;
 
-				// Remove existing one
-				for (pugi::xml_node& srcSystem : srcSystems.children())
+				for (pugi::xml_node& child : system.children())
 				{
-					if (std::string(srcSystem.name()) != "system")
+					std::string tag = child.name();
+					if (tag == "name")
 						continue;
 
-					std::string srcName = srcSystem.child("name").text().get();
-					if (srcName != name)
-						continue;
-
-					found = true;
-
-					for (pugi::xml_node& child : system.children())
-					{
-						std::string tag = child.name();
-						if (tag == "name")
-							continue;
-
-						srcSystem.remove_child(tag.c_str());
+					srcSystem.remove_child(tag.c_str());
 
-						if (tag == "emulators" || !std::string(child.text().get()).empty())
-							srcSystem.append_copy(child);
-					}
-
-					break;
+					if (tag == "emulators" || !std::string(child.text().get()).empty())
+						srcSystem.append_copy(child);
 				}
 
-				if (!found)
-					srcSystems.append_copy(system);
+				break;
 			}
+
+			if (!found)
+				srcSystems.append_copy(system);
 		}
 	}
 }
@@ -730,6 +1046,8 @@ void SystemData::loadAdditionnalConfig(pugi::xml_node& srcSystems)
 //creates systems from information located in a config file
 bool SystemData::loadConfig(Window* window)
 {
+	TraceSpan span("SystemData::loadConfig");
+
 	deleteSystems();
 	ThemeData::setDefaultTheme(nullptr);
 	UIModeController::getInstance(); // Init UIModeController before loading systems
@@ -744,34 +1062,15 @@ bool SystemData::loadConfig(Window* window)
 		return false;
 	}
 
-	pugi::xml_document doc;
-	pugi::xml_parse_result res = doc.load_file(WINSTRINGW(path).c_str());
-
-	if (!res)
-	{
-		LOG(LogError) << "Could not parse es_systems.cfg file!";
-		LOG(LogError) << res.description();
-		return false;
-	}
-
-	//actually read the file
-	pugi::xml_node systemList = doc.child("systemList");
-	if (!systemList)
-	{
-		LOG(LogError) << "es_systems.cfg is missing the <systemList> tag!";
+	std::vector<SystemDecl> systemDecls;
+	if (!loadSystemDecls(systemDecls))
 		return false;
-	}
-
-	loadAdditionnalConfig(systemList);
 
 	std::vector<std::string> systemsNames;
+	for (auto& system : systemDecls)
+		systemsNames.push_back(system.fullName);
 
-	int systemCount = 0;
-	for (pugi::xml_node system = systemList.child("system"); system; system = system.next_sibling("system"))
-	{
-		systemsNames.push_back(system.child("fullname").text().get());
-		systemCount++;
-	}
+	int systemCount = (int)systemDecls.size();
 
 	if (systemCount == 0)
 	{
@@ -794,6 +1093,7 @@ bool SystemData::loadConfig(Window* window)
 	if (std::thread::hardware_concurrency() > 1 && Settings::ThreadedLoading())
 	{
 		pThreadPool = new ThreadPool();
+		sFolderWalkPool = pThreadPool;
 
 		systems = new SystemDataPtr[systemCount];
 		for (int i = 0; i < systemCount; i++)
@@ -802,26 +1102,24 @@ bool SystemData::loadConfig(Window* window)
 		pThreadPool->queueWorkItem([] { CollectionSystemManager::get()->loadCollectionSystems(); });
 	}
 
-	int processedSystem = 0;
+	std::atomic<int> processedSystem(0); // Counted by the loading threads, read by the splash screen
 
-	for (pugi::xml_node system = systemList.child("system"); system; system = system.next_sibling("system"))
+	for (auto& system : systemDecls)
 	{
 		if (pThreadPool != NULL)
 		{
-			pThreadPool->queueWorkItem([system, currentSystem, systems, &processedSystem]
+			const SystemDecl* decl = &system;
+
+			pThreadPool->queueWorkItem([decl, currentSystem, systems, &processedSystem]
 			{
-				systems[currentSystem] = loadSystem(system);
+				systems[currentSystem] = loadSystem(*decl);
 				processedSystem++;
 			});
 		}
 		else
 		{
-			std::string fullname = system.child("fullname").text().get();
-
 			if (window != NULL)
-				window->renderSplashScreen(fullname, systemCount == 0 ? 0 : (float)currentSystem / (float)(systemCount + 1));
-
-			std::string nm = system.child("name").text().get();
+				window->renderSplashScreen(system.fullName, systemCount == 0 ? 0 : (float)currentSystem / (float)(systemCount + 1));
 
 			SystemData* pSystem = loadSystem(system);
 			if (pSystem != nullptr)
@@ -852,6 +1150,8 @@ bool SystemData::loadConfig(Window* window)
 				sSystemVector.push_back(pSystem);
 		}
 
+		sFolderWalkPool = nullptr;
+
 		delete[] systems;
 		delete pThreadPool;
 
@@ -886,6 +1186,10 @@ bool SystemData::loadConfig(Window* window)
 		}
 	}
 
+	// Every system has loaded its theme : the shared theme files are no longer needed
+	ThemeData::clearFileCache();
+	preloadThemeImages();
+
 	if (window != nullptr && !ThreadedHasher::isRunning())
 	{
 		int checkIndex = 0;
@@ -905,97 +1209,236 @@ bool SystemData::loadConfig(Window* window)
 
 SystemData* SystemData::loadSystem(std::string systemName, bool fullMode)
 {
-	std::string path = getConfigPath();
-	if (!Utils::FileSystem::exists(path))
+	std::vector<SystemDecl> systems;
+	if (!loadSystemDecls(systems))
 		return nullptr;
 
-	pugi::xml_document doc;
-	pugi::xml_parse_result res = doc.load_file(WINSTRINGW(path).c_str());
-	if (!res)
-		return nullptr;
+	for (auto& system : systems)
+		if (Utils::String::compareIgnoreCase(system.name, systemName) == 0)
+			return loadSystem(system, fullMode);
 
-	//actually read the file
-	pugi::xml_node systemList = doc.child("systemList");
-	if (!systemList)
-		return nullptr;
+	return nullptr;
+}
+
+std::map<std::string, std::string> SystemData::getKnownSystemNames()
+{
+	std::map<std::string, std::string> ret;
 
-	loadAdditionnalConfig(systemList);
+	std::vector<SystemDecl> systems;
+	if (!loadSystemDecls(systems))
+		return ret;
 
-	for (pugi::xml_node system = systemList.child("system"); system; system = system.next_sibling("system"))
+	for (auto& system : systems)
 	{
-		std::string name = system.child("name").text().get();
-		if (Utils::String::compareIgnoreCase(name, systemName) == 0)
-			return loadSystem(system, fullMode);
+		if (system.name.empty() || system.fullName.empty())
+			continue;
+		
+		ret[system.name] = system.fullName;
 	}
 
-	return nullptr;
+	return ret;
 }
 
-std::map<std::string, std::string> SystemData::getKnownSystemNames()
+SystemDecl SystemData::readSystemDecl(pugi::xml_node system)
 {
-	std::map<std::string, std::string> ret;
+	SystemDecl decl;
+	decl.name = system.child("name").text().get();
+	decl.fullName = system.child("fullname").text().get();
+	decl.manufacturer = system.child("manufacturer").text().get();
+	decl.release = system.child("release").text().get();
+	decl.hardware = system.child("hardware").text().get();
+	decl.theme = system.child("theme").text().as_string(decl.name.c_str());
+	decl.path = system.child("path").text().get();
+	decl.extension = system.child("extension").text().get();
+	decl.command = system.child("command").text().get();
+	decl.platform = system.child("platform").text().get();
+	decl.group = system.child("group").text().get();
+
+	pugi::xml_node emulatorsNode = system.child("emulators");
+	if (emulatorsNode == nullptr)
+		emulatorsNode = system;
+
+	for (pugi::xml_node emuNode = emulatorsNode.child("emulator"); emuNode; emuNode = emuNode.next_sibling("emulator"))
+	{
+		SystemDecl::Emulator emulator;
+		emulator.name = emuNode.attribute("name").value();
+		emulator.command = emuNode.attribute("command").value();
+		emulator.incompatibleExtensions = emuNode.attribute("incompatible_extensions").value();
+
+		pugi::xml_node coresNode = emuNode.child("cores");
+		if (coresNode == nullptr)
+			coresNode = emuNode;
+
+		for (pugi::xml_node coreNode = coresNode.child("core"); coreNode; coreNode = coreNode.next_sibling("core"))
+		{
+			SystemDecl::Core core;
+			core.name = coreNode.text().as_string();
+			core.netplay = coreNode.attribute("netplay") && strcmp(coreNode.attribute("netplay").value(), "true") == 0;
+			core.isDefault = coreNode.attribute("default") && strcmp(coreNode.attribute("default").value(), "true") == 0;
+			core.incompatibleExtensions = coreNode.attribute("incompatible_extensions").value();
+			core.command = coreNode.attribute("command").value();
+			emulator.cores.push_back(core);
+		}
+
+		decl.emulators.push_back(emulator);
+	}
+
+	return decl;
+}
+
+static void writeBinarySystemDecl(Utils::BinaryWriter& writer, const SystemDecl& decl)
+{
+	for (auto value : { &decl.name, &decl.fullName, &decl.manufacturer, &decl.release, &decl.hardware, &decl.theme, &decl.path, &decl.extension, &decl.command, &decl.platform, &decl.group })
+		writer.writeString(*value);
+
+	writer.writeUInt32((uint32_t)decl.emulators.size());
+	for (auto& emulator : decl.emulators)
+	{
+		writer.writeString(emulator.name);
+		writer.writeString(emulator.command);
+		writer.writeString(emulator.incompatibleExtensions);
+
+		writer.writeUInt32((uint32_t)emulator.cores.size());
+		for (auto& core : emulator.cores)
+		{
+			writer.writeString(core.name);
+			writer.writeUInt8(core.netplay ? 1 : 0);
+			writer.writeUInt8(core.isDefault ? 1 : 0);
+			writer.writeString(core.incompatibleExtensions);
+			writer.writeString(core.command);
+		}
+	}
+}
+
+static void readBinarySystemDecl(Utils::BinaryReader& reader, SystemDecl& decl)
+{
+	for (auto value : { &decl.name, &decl.fullName, &decl.manufacturer, &decl.release, &decl.hardware, &decl.theme, &decl.path, &decl.extension, &decl.command, &decl.platform, &decl.group })
+		*value = reader.readString();
+
+	uint32_t emulatorCount = reader.readUInt32();
+	for (uint32_t e = 0; e < emulatorCount && !reader.failed(); e++)
+	{
+		SystemDecl::Emulator emulator;
+		emulator.name = reader.readString();
+		emulator.command = reader.readString();
+		emulator.incompatibleExtensions = reader.readString();
+
+		uint32_t coreCount = reader.readUInt32();
+		for (uint32_t c = 0; c < coreCount && !reader.failed(); c++)
+		{
+			SystemDecl::Core core;
+			core.name = reader.readString();
+			core.netplay = reader.readUInt8() != 0;
+			core.isDefault = reader.readUInt8() != 0;
+			core.incompatibleExtensions = reader.readString();
+			core.command = reader.readString();
+			emulator.cores.push_back(core);
+		}
+
+		decl.emulators.push_back(emulator);
+	}
+}
+
+// The merged systems, from the config cache while es_systems.cfg & the es_systems_*.cfg files don't change
+bool SystemData::loadSystemDecls(std::vector<SystemDecl>& systems)
+{
+	systems.clear();
 
 	std::string path = getConfigPath();
 	if (!Utils::FileSystem::exists(path))
-		return ret;
+		return false;
+
+	std::vector<std::string> files = ConfigCache::getAdditionalFiles("es_systems_");
+
+	std::vector<std::string> sources = files;
+	sources.insert(sources.begin(), path);
+
+	std::string key = ConfigCache::getKey(SYSTEMS_CACHE_VERSION, sources);
+
+	bool cached = ConfigCache::read("systems", key, [&systems](Utils::BinaryReader& reader)
+	{
+		uint32_t count = reader.readUInt32();
+		for (uint32_t i = 0; i < count && !reader.failed(); i++)
+		{
+			systems.push_back(SystemDecl());
+			readBinarySystemDecl(reader, systems.back());
+		}
+
+		return !reader.failed() && count > 0;
+	});
+
+	if (cached)
+		return true;
+
+	systems.clear();
 
 	pugi::xml_document doc;
 	pugi::xml_parse_result res = doc.load_file(WINSTRINGW(path).c_str());
+
 	if (!res)
-		return ret;
+	{
+		LOG(LogError) << "Could not parse es_systems.cfg file!";
+		LOG(LogError) << res.description();
+		return false;
+	}
 
 	//actually read the file
 	pugi::xml_node systemList = doc.child("systemList");
 	if (!systemList)
-		return ret;
+	{
+		LOG(LogError) << "es_systems.cfg is missing the <systemList> tag!";
+		return false;
+	}
 
-	loadAdditionnalConfig(systemList);
+	loadAdditionnalConfig(systemList, files);
 
 	for (pugi::xml_node system = systemList.child("system"); system; system = system.next_sibling("system"))
-	{
-		std::string name = system.child("name").text().get();
-		if (name.empty())
-			continue;
+		systems.push_back(readSystemDecl(system));
 
-		std::string fullName = system.child("fullname").text().get();
-		if (fullName.empty())
-			continue;
-		
-		ret[name] = fullName;
+	if (systems.size() > 0)
+	{
+		ConfigCache::write("systems", key, [&systems](Utils::BinaryWriter& writer)
+		{
+			writer.writeUInt32((uint32_t)systems.size());
+			for (auto& system : systems)
+				writeBinarySystemDecl(writer, system);
+		});
 	}
 
-	return ret;
+	return true;
 }
 
 #define readList(x) Utils::String::splitAny(x, " \t\r\n,", true)
 
-SystemData* SystemData::loadSystem(pugi::xml_node system, bool fullMode)
+SystemData* SystemData::loadSystem(const SystemDecl& system, bool fullMode)
 {
+	TraceSpan span("loadSystem", system.name.c_str());
+
 	std::string path, cmd; // , name, fullname, themeFolder;
 
-	path = system.child("path").text().get();
+	path = system.path;
 
 	SystemMetadata md;
-	md.name = system.child("name").text().get();
-	md.fullName = system.child("fullname").text().get();
-	md.manufacturer = system.child("manufacturer").text().get();
-	md.releaseYear = Utils::String::toInteger(system.child("release").text().get());
-	md.hardwareType = system.child("hardware").text().get();
-	md.themeFolder = system.child("theme").text().as_string(md.name.c_str());
+	md.name = system.name;
+	md.fullName = system.fullName;
+	md.manufacturer = system.manufacturer;
+	md.releaseYear = Utils::String::toInteger(system.release);
+	md.hardwareType = system.hardware;
+	md.themeFolder = system.theme;
 
 	// convert extensions list from a string into a vector of strings
 	std::set<std::string> extensions;
-	for (auto ext : readList(system.child("extension").text().get()))
+	for (auto ext : readList(system.extension))
 	{
 		std::string extlow = Utils::String::toLower(ext);
 		if (extensions.find(extlow) == extensions.cend())
 			extensions.insert(extlow);
 	}
 
-	cmd = system.child("command").text().get();
+	cmd = system.command;
 
 	// platform id list
-	std::string platformList = system.child("platform").text().get();
+	std::string platformList = system.platform;
 	std::vector<std::string> platformStrs = readList(platformList);
 	std::vector<PlatformIds::PlatformId> platformIds;
 	for (auto it = platformStrs.cbegin(); it != platformStrs.cend(); it++)
@@ -1053,66 +1496,46 @@ SystemData* SystemData::loadSystem(pugi::xml_node system, bool fullMode)
 	envData->mSearchExtensions = extensions;
 	envData->mLaunchCommand = cmd;
 	envData->mPlatformIds = platformIds;
-	envData->mGroup = system.child("group").text().get();
+	envData->mGroup = system.group;
 	
 	// Emulators and cores
 	std::vector<EmulatorData> systemEmulators;
 	
-	pugi::xml_node emulatorsNode = system.child("emulators");
-	if (emulatorsNode == nullptr)
-		emulatorsNode = system;
-
-	if (emulatorsNode != nullptr)
+	for (auto& emulator : system.emulators)
 	{
-		for (pugi::xml_node emuNode = emulatorsNode.child("emulator"); emuNode; emuNode = emuNode.next_sibling("emulator"))
-		{
-			EmulatorData emulatorData;
-			emulatorData.name = emuNode.attribute("name").value();
-			emulatorData.customCommandLine = emuNode.attribute("command").value();
-			emulatorData.features = EmulatorFeatures::Features::all;
+		EmulatorData emulatorData;
+		emulatorData.name = emulator.name;
+		emulatorData.customCommandLine = emulator.command;
+		emulatorData.features = EmulatorFeatures::Features::all;
 
-			if (emuNode.attribute("incompatible_extensions"))
-			{
-				for (auto ext : readList(emuNode.attribute("incompatible_extensions").value()))
-				{
-					std::string extlow = Utils::String::toLower(ext);
-					if (std::find(emulatorData.incompatibleExtensions.cbegin(), emulatorData.incompatibleExtensions.cend(), extlow) == emulatorData.incompatibleExtensions.cend())
-						emulatorData.incompatibleExtensions.push_back(extlow);
-				}
-			}
+		for (auto ext : readList(emulator.incompatibleExtensions))
+		{
+			std::string extlow = Utils::String::toLower(ext);
+			if (std::find(emulatorData.incompatibleExtensions.cbegin(), emulatorData.incompatibleExtensions.cend(), extlow) == emulatorData.incompatibleExtensions.cend())
+				emulatorData.incompatibleExtensions.push_back(extlow);
+		}
 
-			pugi::xml_node coresNode = emuNode.child("cores");
-			if (coresNode == nullptr)
-				coresNode = emuNode;
+		for (auto& coreDecl : emulator.cores)
+		{
+			CoreData core;
+			core.name = coreDecl.name;
+			core.netplay = coreDecl.netplay;
+			core.isDefault = coreDecl.isDefault;
 
-			if (coresNode != nullptr)
+			for (auto ext : readList(coreDecl.incompatibleExtensions))
 			{
-				for (pugi::xml_node coreNode = coresNode.child("core"); coreNode; coreNode = coreNode.next_sibling("core"))
-				{
-					CoreData core;
-					core.name = coreNode.text().as_string();
-					core.netplay = coreNode.attribute("netplay") && strcmp(coreNode.attribute("netplay").value(), "true") == 0;
-					core.isDefault = coreNode.attribute("default") && strcmp(coreNode.attribute("default").value(), "true") == 0;
-					
-					if (coreNode.attribute("incompatible_extensions"))
-					{
-						for (auto ext : readList(coreNode.attribute("incompatible_extensions").value()))
-						{
-							std::string extlow = Utils::String::toLower(ext);
-							if (std::find(core.incompatibleExtensions.cbegin(), core.incompatibleExtensions.cend(), extlow) == core.incompatibleExtensions.cend())
-								core.incompatibleExtensions.push_back(extlow);
-						}
-					}
-
-					core.features = EmulatorFeatures::Features::all;
-					core.customCommandLine = coreNode.attribute("command").value();
-
-					emulatorData.cores.push_back(core);
-				}
+				std::string extlow = Utils::String::toLower(ext);
+				if (std::find(core.incompatibleExtensions.cbegin(), core.incompatibleExtensions.cend(), extlow) == core.incompatibleExtensions.cend())
+					core.incompatibleExtensions.push_back(extlow);
 			}
 
-			systemEmulators.push_back(emulatorData);
+			core.features = EmulatorFeatures::Features::all;
+			core.customCommandLine = coreDecl.command;
+
+			emulatorData.cores.push_back(core);
 		}
+
+		systemEmulators.push_back(emulatorData);
 	}
 
 	SystemData* newSys = new SystemData(md, envData, &systemEmulators, false, false, fullMode, true);
@@ -1162,11 +1585,15 @@ void SystemData::deleteSystems()
 		pData->getRootFolder()->removeVirtualFolders();
 
 		if (saveOnExit && !pData->mIsCollectionSystem)
-			updateGamelist(pData);
-
-		delete pData;
+			GamelistWriter::queue(pData);
 	}
 
+	// Systems are written in the background, what's not done in time goes to the gamelist recovery
+	GamelistWriter::flush(GAMELIST_FLUSH_TIMEOUT);
+
+	for (unsigned int i = 0; i < sSystemVector.size(); i++)
+		delete sSystemVector.at(i);
+
 	sSystemVector.clear();
 	IsManufacturerSupported = false;
 }
@@ -1292,7 +1719,7 @@ bool SystemData::hasGamelist() const
 
 unsigned int SystemData::getGameCount() const
 {
-	return (unsigned int)mRootFolder->getFilesRecursive(GAME).size();
+	return (unsigned int)getRootFolder()->getFilesRecursive(GAME).size();
 }
 
 SystemData* SystemData::getRandomSystem()
@@ -1324,14 +1751,7 @@ SystemData* SystemData::getRandomSystem()
 
 FileData* SystemData::getRandomGame()
 {
-	std::vector<FileData*> list = mRootFolder->getFilesRecursive(GAME, true);
-	unsigned int total = (int)list.size();
-	if (total == 0)
-		return NULL;
-
-	int target = Randomizer::random(total);
-	//target = (int)Math::round((std::rand() / (float)RAND_MAX) * (total - 1));
-	return list.at(target);
+	return RandomGamePool::pick(this, RandomGamePool::ANY, true);
 }
 
 GameCountInfo* SystemData::getGameCountInfo()
@@ -1339,7 +1759,7 @@ GameCountInfo* SystemData::getGameCountInfo()
 	if (mGameCountInfo != nullptr)
 		return mGameCountInfo;	
 
-	std::vector<FileData*> games = mRootFolder->getFilesRecursive(GAME, true);
+	std::vector<FileData*> games = getRootFolder()->getFilesRecursive(GAME, true);
 
 	int realTotal = games.size();
 	if (mFilterIndex != nullptr)
@@ -1410,8 +1830,24 @@ void SystemData::updateDisplayedGameCount()
 	mGameCountInfo = nullptr;
 }
 
+void SystemData::preloadThemeImages()
+{
+	std::vector<ThemeData*> themes;
+
+	for (auto system : sSystemVector)
+		if (system->getTheme() != nullptr)
+			themes.push_back(system->getTheme().get());
+
+	ThemeData::preloadImageSizes(themes);
+
+	if (Settings::getInstance()->getBool("EnableSounds"))
+		SoundBank::preload(ThemeData::getSoundPaths(themes));
+}
+
 void SystemData::loadTheme()
 {
+	TraceSpan span("loadTheme", getName());
+
 	mTheme = std::make_shared<ThemeData>();
 
 	std::string path = getThemePath();
@@ -1863,20 +2299,20 @@ bool SystemData::hasKeyboardMapping()
 	if (isCollection())
 		return false;
 
-	return Utils::FileSystem::exists(getKeyboardMappingFilePath());
+	return KeyMappingCache::exists(getKeyboardMappingFilePath());
 }
 
 KeyMappingFile SystemData::getKeyboardMapping()
 {
 	KeyMappingFile ret;
 
-	if (Utils::FileSystem::exists(getKeyboardMappingFilePath()))
-		ret = KeyMappingFile::load(getKeyboardMappingFilePath());
+	if (KeyMappingCache::exists(getKeyboardMappingFilePath()))
+		ret = KeyMappingCache::load(getKeyboardMappingFilePath());
 	else
 	{
 		std::string path = Paths::getKeyboardMappingsPath();
 		if (!path.empty())
-			ret = KeyMappingFile::load(path + "/" + getName() + ".keys");
+			ret = KeyMappingCache::load(path + "/" + getName() + ".keys");
 	}
 
 	ret.path = getKeyboardMappingFilePath();
@@ -1944,6 +2380,34 @@ bool SystemData::getShowParentFolder()
 	return getBoolSetting("ShowParentFolder");
 }
 
+void SystemData::updateSystemSettings()
+{
+	if (mSettingsGeneration == Settings::getGeneration())
+		return;
+
+	auto shv = Settings::getInstance()->getString(getName() + ".ShowHiddenFiles");
+	mShowHiddenFilesOverride = (shv == "1" ? 1 : shv == "0" ? 0 : -1);
+
+	mHiddenExtensions = Utils::String::toLower(Settings::getInstance()->getString(getName() + ".HiddenExt"));
+	mSettingsGeneration = Settings::getGeneration();
+}
+
+bool SystemData::getShowHiddenFiles(bool applyKioskMode)
+{
+	updateSystemSettings();
+
+	if (mShowHiddenFilesOverride >= 0)
+		return mShowHiddenFilesOverride == 1;
+
+	return Settings::ShowHiddenFiles() && !(applyKioskMode && UIModeController::getInstance()->isUIModeKiosk());
+}
+
+const std::string& SystemData::getHiddenExtensions()
+{
+	updateSystemSettings();
+	return mHiddenExtensions;
+}
+
 std::string SystemData::getFolderViewMode()
 {
 	std::string showFoldersMode = Settings::getInstance()->getString("FolderViewMode");
@@ -4,7 +4,10 @@
 
 #include "PlatformId.h"
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <map>
@@ -23,6 +26,11 @@ class FolderData;
 class ThemeData;
 class Window;
 class SaveStateRepository;
+class DirectoryManifest;
+class FolderWalk;
+class GamelistSource;
+class LocalArtIndex;
+class FileDataArena;
 
 struct GameCountInfo
 {
@@ -61,6 +69,40 @@ struct SystemEnvironmentData
 	}
 };
 
+// A <system> of es_systems.cfg, merged with the es_systems_*.cfg files, as kept in the config cache
+struct SystemDecl
+{
+	struct Core
+	{
+		std::string name;
+		bool netplay;
+		bool isDefault;
+		std::string incompatibleExtensions;
+		std::string command;
+	};
+
+	struct Emulator
+	{
+		std::string name;
+		std::string command;
+		std::string incompatibleExtensions;
+		std::vector<Core> cores;
+	};
+
+	std::string name;
+	std::string fullName;
+	std::string manufacturer;
+	std::string release;
+	std::string hardware;
+	std::string theme;
+	std::string path;
+	std::string extension;
+	std::string command;
+	std::string platform;
+	std::string group;
+	std::vector<Emulator> emulators;
+};
+
 class SystemData : public IKeyboardMapContainer
 {
 public:
@@ -70,7 +112,11 @@ public:
 	static SystemData* getSystem(const std::string name);
 	static SystemData* getFirstVisibleSystem();
 
-	inline FolderData* getRootFolder() const { return mRootFolder; };
+	inline FolderData* getRootFolder() const { if (mPendingPopulation) populatePending(); return mRootFolder; };
+
+	// Collections whose games are only added on the first access to their tree ( or to their game count )
+	void setPendingPopulation(const std::function<void()>& populate);
+	inline bool isPopulationPending() const { return mPendingPopulation; }
 	inline const std::string& getName() const { return mMetadata.name; }
 	inline const std::string& getFullName() const { return mMetadata.fullName; }
 	inline const std::string& getStartPath() const { return mEnvData->mStartPath; }
@@ -97,6 +143,7 @@ public:
 	static void deleteSystems();
 	static bool loadConfig(Window* window = nullptr); //Load the system config file at getConfigPath(). Returns true if no errors were encountered. An example will be written if the file doesn't exist.	
 	static std::string getConfigPath();
+	static void preloadThemeImages(); // Probes the image sizes & reads the sounds of every loaded theme, after the themes are (re)loaded
 	
 	bool loadFeatures();
 
@@ -205,12 +252,28 @@ public:
 	std::string getFolderViewMode();
 	bool getBoolSetting(const std::string& settingName);
 
+	// ShowHiddenFiles with the override of the system ( kiosk mode hides them unless overridden ), and its lower case HiddenExt. Cached until a setting changes
+	bool getShowHiddenFiles(bool applyKioskMode = false);
+	const std::string& getHiddenExtensions();
+
 	static void resetSettings();
 
 	SaveStateRepository* getSaveStateRepository();
+	inline LocalArtIndex* getLocalArtIndex() { return mLocalArtIndex; }
+	inline FileDataArena* getFileDataArena() { return mFileDataArena; }
+
+	inline GamelistSource* getGamelistSource() { return mGamelistSource; }
+	void setGamelistSource(GamelistSource* source);
 
 	std::string getProperty(const std::string& name);
 
+	// Whether a game may live at path : below the start path, out of the media & ignored folders
+	bool isRomPath(const std::string& path) const;
+
+	// Adds the game, or the folder of games, found at path to the tree ( RomFolderWatcher ), with the missing parent folders.
+	// fileMap holds the nodes of the tree by path, the root folder included. Returns the node attached to the tree, or nullptr
+	FileData* addPath(const std::string& path, std::unordered_map<std::string, FileData*>& fileMap);
+
 private:
 	std::string getKeyboardMappingFilePath();
 	static void createGroupedSystems();
@@ -228,18 +291,31 @@ private:
 	SystemEnvironmentData* mEnvData;
 	std::shared_ptr<ThemeData> mTheme;
 
-	void populateFolder(FolderData* folder, std::unordered_map<std::string, FileData*>& fileMap);
+	void populateFolder(FolderData* folder, std::unordered_map<std::string, FileData*>& fileMap, DirectoryManifest* manifest = nullptr);
+	void populateFolderEntries(FolderData* folder, const std::shared_ptr<FolderWalk>& walk);
+	bool processFolderWalk(const std::shared_ptr<FolderWalk>& walk);
+	void attachSubFolders(FolderData* folder, FolderWalk* walk);
+	bool isIgnoredFolder(const std::string& name) const;
 	void indexAllGameFilters(const FolderData* folder);
 	void setIsGameSystemStatus();
 	void removeMultiDiskContent(std::unordered_map<std::string, FileData*>& fileMap);
 
-	static SystemData* loadSystem(pugi::xml_node system, bool fullMode = true);
-	static void loadAdditionnalConfig(pugi::xml_node& srcSystems);
+	static SystemData* loadSystem(const SystemDecl& system, bool fullMode = true);
+	static bool loadSystemDecls(std::vector<SystemDecl>& systems);
+	static SystemDecl readSystemDecl(pugi::xml_node system);
+	static void loadAdditionnalConfig(pugi::xml_node& srcSystems, const std::vector<std::string>& files);
 
 	FileFilterIndex* mFilterIndex;
 
 	FolderData* mRootFolder;
 
+	void populatePending() const;
+
+	mutable std::atomic<bool>		mPendingPopulation;
+	mutable bool					mPopulating;
+	mutable std::function<void()>	mPopulate;
+	mutable std::recursive_mutex	mPopulateLock;
+
 	std::vector<EmulatorData> mEmulators;
 	
 	unsigned int mSortId;
@@ -250,8 +326,17 @@ private:
 
 	GameCountInfo* mGameCountInfo;
 	SaveStateRepository* mSaveRepository;
+	LocalArtIndex* mLocalArtIndex;
+	FileDataArena* mFileDataArena;
+	GamelistSource* mGamelistSource;
 
 	bool mHidden;
+
+	void updateSystemSettings();
+
+	unsigned int mSettingsGeneration;
+	int mShowHiddenFilesOverride; // -1 : none
+	std::string mHiddenExtensions;
 };
 
 #endif // ES_APP_SYSTEM_DATA_H
@@ -1,108 +1,63 @@
 #include "SystemRandomPlaylist.h"
-#include "utils/StringUtil.h"
 #include "utils/FileSystemUtil.h"
+#include "RandomGamePool.h"
 #include "SystemData.h"
 #include "FileData.h"
 
-///////////// SystemRandomPlaylist ///////////// 
+///////////// SystemRandomPlaylist /////////////
 
-static std::random_device mRandomDevice;
-std::map<std::string, std::vector<std::string>> SystemRandomPlaylist::mFileCache;
+// Draws before giving up when the media files are missing
+#define MAX_DRAWS 10
 
-SystemRandomPlaylist::SystemRandomPlaylist(SystemData* system, PlaylistType type) : mMt19937(mRandomDevice())
+SystemRandomPlaylist::SystemRandomPlaylist(SystemData* system, PlaylistType type)
 {
-	mFirstRun = true;
 	mSystem = system;
 	mType = type;
 }
 
-void SystemRandomPlaylist::resetCache()
+static RandomGamePool::MediaType getMediaType(SystemRandomPlaylist::PlaylistType type)
 {
-	mFileCache.clear();
+	switch (type)
+	{
+	case SystemRandomPlaylist::THUMBNAIL:
+		return RandomGamePool::THUMBNAIL;
+	case SystemRandomPlaylist::MARQUEE:
+		return RandomGamePool::MARQUEE;
+	case SystemRandomPlaylist::FANART:
+		return RandomGamePool::FANART;
+	case SystemRandomPlaylist::TITLESHOT:
+		return RandomGamePool::TITLESHOT;
+	case SystemRandomPlaylist::VIDEO:
+		return RandomGamePool::VIDEO;
+	default:
+		return RandomGamePool::IMAGE;
+	}
 }
 
 std::string SystemRandomPlaylist::getNextItem()
 {
-	if (mFirstRun)
-	{		
-		auto it = mFileCache.find(mSystem->getName() + "." + std::to_string(mType));
-		if (it != mFileCache.cend())
-			mPaths = it->second;
-		else
-		{
-			std::vector<FileData*> files = mSystem->getRootFolder()->getFilesRecursive(GAME, false);
-
-			for (auto file : files)
-			{
-				std::string path;
-
-				switch (mType)
-				{
-				case IMAGE:
-					path = file->getImagePath();
-					break;
-				case THUMBNAIL:
-					path = file->getThumbnailPath();
-					break;
-				case MARQUEE:
-					path = file->getMarqueePath();
-					break;
-				case FANART:
-					path = file->getMetadata(MetaDataId::FanArt);
-					break;
-				case TITLESHOT:
-					path = file->getMetadata(MetaDataId::TitleShot);
-					break;
-				case VIDEO:
-					path = file->getVideoPath();
-					break;
-				}
-
-				if (!path.empty())
-					mPaths.push_back(path);
-			}
-
-			if (mType == FANART && mPaths.size() == 0)
-			{
-				for (auto file : files)
-				{
-					std::string path = file->getThumbnailPath();
-					if (!path.empty())
-						mPaths.push_back(path);
-				}
-			}
-
-			mFileCache[mSystem->getName() + "." + std::to_string(mType)] = mPaths;
-		}
-
-		if (mPaths.size() > 0)
-			mUniformDistribution = std::uniform_int_distribution<int>(0, mPaths.size() - 1);
-
-		mFirstRun = false;
-	}
+	auto type = getMediaType(mType);
 
-	if (mPaths.size() > 0)
+	for (int draw = 0; draw < MAX_DRAWS; draw++)
 	{
-		int idx = mUniformDistribution(mMt19937);
-		if (idx >= 0 && idx < mPaths.size() && Utils::FileSystem::exists(mPaths[idx]))
-			return mPaths[idx];
+		FileData* game = RandomGamePool::pick(mSystem, type);
 
-		// File not found ? Try the next file...
-		int stopidx = idx;
-
-		idx++;
-		if (idx >= mPaths.size())
-			idx = 0;
-
-		while (idx != stopidx && idx < mPaths.size() && !Utils::FileSystem::exists(mPaths[idx]))
+		// Systems without fan arts show the thumbnails
+		if (game == nullptr && type == RandomGamePool::FANART)
 		{
-			idx++;
-			if (idx >= mPaths.size())
-				idx = 0;
+			type = RandomGamePool::THUMBNAIL;
+			game = RandomGamePool::pick(mSystem, type);
 		}
 
-		if (idx >= 0 && idx < mPaths.size() && Utils::FileSystem::exists(mPaths[idx]))
-			return mPaths[idx];
+		if (game == nullptr)
+			break;
+
+		std::string path = RandomGamePool::getMediaPath(game, type);
+		if (Utils::FileSystem::exists(path))
+			return path;
+
+		// File not found ? Left out until the system is indexed again
+		RandomGamePool::remove(game, type);
 	}
 
 	return "";
@@ -1,7 +1,4 @@
 #include "components/ImageComponent.h"
-#include <random>
-#include <vector>
-#include <map>
 
 class SystemData;
 
@@ -21,18 +18,7 @@ public:
 	SystemRandomPlaylist(SystemData* system, PlaylistType type);
 	std::string getNextItem() override;
 
-	static void resetCache();
-
 private:
 	SystemData*		mSystem;
-	bool			mFirstRun;
 	PlaylistType	mType;
-
-	std::vector<std::string> mPaths;
-
-	static std::map<std::string, std::vector<std::string>> mFileCache;
-
-	//std::random_device	mRandomDevice;
-	std::mt19937		mMt19937;
-	std::uniform_int_distribution<int> mUniformDistribution;
 };
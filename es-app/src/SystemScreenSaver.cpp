@@ -9,6 +9,7 @@
 #include "views/ViewController.h"
 #include "FileData.h"
 #include "FileFilterIndex.h"
+#include "RandomGamePool.h"
 #include "Log.h"
 #include "PowerSaver.h"
 #include "Scripting.h"
@@ -32,8 +33,8 @@ SystemScreenSaver::SystemScreenSaver(Window* window) :
 	mVideoScreensaver(NULL),
 	mImageScreensaver(NULL),
 	mWindow(window),
-	mGamesWithVideosLoaded(false),
-	mGamesWithImagesLoaded(false),
+	mNextVideoGame(nullptr),
+	mNextVideoVersion(0),
 	mState(STATE_INACTIVE),
 	mOpacity(0.0f),
 	mTimer(0),
@@ -78,7 +79,7 @@ void SystemScreenSaver::startScreenSaver()
 
 	stopScreenSaver();
 
-	std::string screensaver_behavior = Settings::getInstance()->getString("ScreenSaverBehavior");
+	std::string screensaver_behavior = Settings::get(StringSetting::ScreenSaverBehavior);
 
 	if (screensaver_behavior == "suspend")
 	{
@@ -94,13 +95,13 @@ void SystemScreenSaver::startScreenSaver()
 			screensaver_behavior = "black";
 	}
 
-	if (!loadingNext && Settings::getInstance()->getBool("StopMusicOnScreenSaver")) //(Settings::getInstance()->getBool("VideoAudio") && !Settings::getInstance()->getBool("ScreenSaverVideoMute")))
+	if (!loadingNext && Settings::getInstance()->getBool("StopMusicOnScreenSaver")) //(Settings::get(BoolSetting::VideoAudio) && !Settings::get(BoolSetting::ScreenSaverVideoMute)))
 		AudioManager::getInstance()->deinit();
 
 
 	if (screensaver_behavior == "random video")
 	{
-		mVideoChangeTime = Settings::getInstance()->getInt("ScreenSaverSwapVideoTimeout");
+		mVideoChangeTime = Settings::get(IntSetting::ScreenSaverSwapVideoTimeout);
 
 		// Configure to fade out the windows, Skip Fading if Instant mode
 		mState =  PowerSaver::getMode() == PowerSaver::INSTANT
@@ -143,6 +144,9 @@ void SystemScreenSaver::startScreenSaver()
 			mVideoScreensaver->setGame(mCurrentGame);
 			mVideoScreensaver->setVideo(path);
 
+			if (!Settings::getInstance()->getBool("SlideshowScreenSaverCustomVideoSource"))
+				prefetchNextVideo();
+
 			if (mCurrentGame)
 				Scripting::fireEvent("game-selected", mCurrentGame->getSystem()->getName(), mCurrentGame->getPath(), mCurrentGame->getName());
 
@@ -226,7 +230,7 @@ void SystemScreenSaver::stopScreenSaver()
 	PowerSaver::runningScreenSaver(false);
 
 	// Exiting screen saver -> Restore sound
-	if (isExitingScreenSaver && Settings::getInstance()->getBool("StopMusicOnScreenSaver")) //isVideoScreenSaver && Settings::getInstance()->getBool("VideoAudio") && !Settings::getInstance()->getBool("ScreenSaverVideoMute"))
+	if (isExitingScreenSaver && Settings::getInstance()->getBool("StopMusicOnScreenSaver")) //isVideoScreenSaver && Settings::get(BoolSetting::VideoAudio) && !Settings::get(BoolSetting::ScreenSaverVideoMute))
 	{
 		AudioManager::getInstance()->init();
 
@@ -284,7 +288,7 @@ void SystemScreenSaver::renderScreenSaver()
 	}
 	else if (mState != STATE_INACTIVE)
 	{
-		std::string screensaver_behavior = Settings::getInstance()->getString("ScreenSaverBehavior");
+		std::string screensaver_behavior = Settings::get(StringSetting::ScreenSaverBehavior);
 
 		Renderer::setMatrix(Transform4x4f::Identity());
 		unsigned char color = screensaver_behavior == "dim" ? 0x000000A0 : 0x000000FF;
@@ -292,52 +296,6 @@ void SystemScreenSaver::renderScreenSaver()
 	}
 }
 
-unsigned long SystemScreenSaver::countGameListNodes(bool video)
-{
-	if (video && mGamesWithVideosLoaded)
-		return mGamesWithVideos.size();
-
-	if (!video && mGamesWithImagesLoaded)
-		return mGamesWithImages.size();
-
-	unsigned long nodeCount = 0;
-
-	if (video)
-	{
-		mGamesWithVideosLoaded = true;
-		mGamesWithVideos.clear();
-	}
-	else
-	{
-		mGamesWithImagesLoaded = true;
-		mGamesWithImages.clear();
-	}
-
-	for (auto system : SystemData::sSystemVector)
-	{
-		// We only want nodes from game systems that are not collections
-		if (!system->isGameSystem() || system->isCollection() || system->hasPlatformId(PlatformIds::IMAGEVIEWER) || system->hasPlatformId(PlatformIds::PLATFORM_IGNORE))
-			continue;
-
-		auto games = system->getRootFolder()->getFilesRecursive(GAME, true);
-		for (auto game : games)
-		{
-			if (video && !game->getVideoPath().empty())
-			{
-				mGamesWithVideos.push_back(game);
-				nodeCount++;
-			}
-			else if (!video && !game->getImagePath().empty())
-			{
-				mGamesWithImages.push_back(game);
-				nodeCount++;
-			}
-		}
-	}
-
-	return nodeCount;
-}
-
 std::string  SystemScreenSaver::selectGameMedia(FileData* game, bool video)
 {
 	std::string path = video ? game->getVideoPath() : game->getImagePath();
@@ -369,41 +327,52 @@ std::string SystemScreenSaver::pickRandomGameMedia(bool video)
 {
 	mCurrentGame = NULL;
 
-	int count = countGameListNodes(video);
-	if (count == 0)
-		return "";
+	auto type = video ? RandomGamePool::VIDEO : RandomGamePool::IMAGE;
 
-	std::vector<FileData*>* games = &mGamesWithImages;
-	if (video)
-		games = &mGamesWithVideos;	
+	// The video prefetched while the previous one played, unless the games were indexed again since
+	FileData* game = nullptr;
+	if (video && mNextVideoGame != nullptr && mNextVideoVersion == RandomGamePool::getVersion())
+		game = mNextVideoGame;
 
-	int randomValue = Randomizer::random(count) % count;
-	int index = randomValue;
+	mNextVideoGame = nullptr;
 
-	while (true)
+	// The games whose media file was deleted leave the pool
+	for (int retry = 0; retry < 10; retry++)
 	{
-		auto path = selectGameMedia(games->at(index), video);
-		if (!path.empty())
-			return path;
-		
-		games->erase(std::next(games->begin(), index));
-		
-		count = games->size();
-		if (count == 0)
-			break;
+		if (game == nullptr)
+			game = RandomGamePool::pick(nullptr, type, true);
 
-		index--;
+		if (game == nullptr)
+			break;
 
-		if (index < 0)
-			index = count - 1;
+		auto path = selectGameMedia(game, video);
+		if (!path.empty())
+			return path;
 
-		if (index == randomValue)
-			break;
+		RandomGamePool::remove(game, type);
+		game = nullptr;
 	}
 
 	return "";
 }
 
+void SystemScreenSaver::prefetchNextVideo()
+{
+	mNextVideoGame = RandomGamePool::pick(nullptr, RandomGamePool::VIDEO, true);
+	mNextVideoVersion = RandomGamePool::getVersion();
+
+	if (mNextVideoGame == nullptr)
+		return;
+
+#ifdef _RPI_
+	if (Settings::getInstance()->getBool("ScreenSaverOmxPlayer"))
+		return;
+#endif
+
+	// Opened & parsed by VLC while the current video plays
+	VideoVlcComponent::prefetch(mNextVideoGame->getVideoPath());
+}
+
 std::string SystemScreenSaver::pickRandomCustomImage(bool video)
 {
 	std::string path;
@@ -513,7 +482,7 @@ void SystemScreenSaver::launchGame()
 		if (view != nullptr)
 			view->setCursor(mCurrentGame);
 
-		if (Settings::getInstance()->getBool("ScreenSaverControls"))
+		if (Settings::get(BoolSetting::ScreenSaverControls))
 			mCurrentGame->launchGame(mWindow);
 		else
 			ViewController::get()->goToGameList(mCurrentGame->getSystem());
@@ -953,7 +922,7 @@ void VideoScreenSaver::update(int deltaTime)
 		if (Settings::getInstance()->getString("ScreenSaverGameInfo") == "start & end")
 		{
 			int duration = SUBTITLE_DURATION;
-			int end = Settings::getInstance()->getInt("ScreenSaverSwapVideoTimeout") - duration;
+			int end = Settings::get(IntSetting::ScreenSaverSwapVideoTimeout) - duration;
 
 			if (mTime >= duration - SUBTITLE_FADE && mTime < duration)
 			{
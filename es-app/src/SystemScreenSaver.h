@@ -85,12 +85,11 @@ public:
 
 	virtual FileData* getCurrentGame();
 	virtual void launchGame();
-	inline virtual void resetCounts() { mGamesWithVideosLoaded = false; mGamesWithImagesLoaded = false; mGamesWithImages.clear(); mGamesWithVideos.clear(); };
+	inline virtual void resetCounts() { mNextVideoGame = nullptr; };
 
 private:
-	unsigned long countGameListNodes(bool video = false);
-
 	std::string pickRandomGameMedia(bool video = false);
+	void prefetchNextVideo();
 	std::string pickRandomCustomImage(bool video = false);
 	
 	std::string	selectGameMedia(FileData* game, bool video = false);
@@ -107,11 +106,10 @@ private:
 	std::shared_ptr<ImageScreenSaver>		mFadingImageScreensaver;
 	std::shared_ptr<ImageScreenSaver>		mImageScreensaver;
 
-	std::vector<FileData*> mGamesWithImages;
-	std::vector<FileData*> mGamesWithVideos;
+	// Picked when the previous video started, VLC has parsed it
+	FileData*		mNextVideoGame;
+	unsigned int	mNextVideoVersion;
 
-	bool			mGamesWithVideosLoaded;
-	bool			mGamesWithImagesLoaded;
 	Window*			mWindow;
 	STATE			mState;
 	float			mOpacity;
@@ -4,6 +4,7 @@
 #include "guis/GuiMsgBox.h"
 #include "ApiSystem.h"
 #include "LocaleES.h"
+#include "TaskScheduler.h"
 
 #define ICONINDEX _U("\uF085 ")
 
@@ -38,6 +39,8 @@ void ThreadedBluetooth::updateNotificationComponentContent(const std::string inf
 
 void ThreadedBluetooth::run()
 {
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::BACKGROUND);
+
 	ApiSystem::getInstance()->scanNewBluetooth([this](const std::string info)
 	{
 		updateNotificationComponentContent(info);
@@ -95,6 +98,8 @@ void ThreadedFormatter::updateNotificationComponentContent(const std::string inf
 
 void ThreadedFormatter::run()
 {
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::BACKGROUND);
+
 #if WIN32
 	std::this_thread::sleep_for(std::chrono::milliseconds(10000));
 #endif
@@ -9,10 +9,15 @@
 #include "SystemData.h"
 #include "FileData.h"
 #include "ApiSystem.h"
+#include "HashCache.h"
+#include "services/HttpEventStream.h"
 #include "utils/StringUtil.h"
+#include "utils/FileSystemUtil.h"
 #include "Log.h"
+#include "TaskScheduler.h"
 #include <unordered_set>
 #include <queue>
+#include <algorithm>
 
 #include "LocaleES.h"
 
@@ -20,6 +25,7 @@
 
 ThreadedHasher* ThreadedHasher::mInstance = nullptr;
 bool ThreadedHasher::mPaused = false;
+std::atomic<unsigned long long> ThreadedHasher::mHashedCount(0);
 
 static std::mutex mLoaderLock;
 
@@ -30,8 +36,32 @@ ThreadedHasher::ThreadedHasher(Window* window, HasherType type, std::queue<FileD
 	mExit = false;
 	mType = type;
 
-	mSearchQueue = searchQueue;
-	mTotal = mSearchQueue.size();
+	mTotal = searchQueue.size();
+
+	// One device query by system : the games are seldom spread over several devices
+	std::map<SystemData*, Utils::FileSystem::StorageDevice> devices;
+
+	while (!searchQueue.empty())
+	{
+		FileData* game = searchQueue.front();
+		searchQueue.pop();
+
+		SystemData* system = game->getSourceFileData()->getSystem();
+
+		auto device = devices.find(system);
+		if (device == devices.cend())
+			device = devices.insert(std::make_pair(system, Utils::FileSystem::getStorageDevice(system->getRootFolder()->getPath()))).first;
+
+		auto& queue = mQueues[device->second.id];
+		queue.sequential = device->second.sequential;
+		queue.games.push_back(game);
+	}
+
+	// Path order keeps the head of a spinning disk moving forward
+	for (auto& it : mQueues)
+		std::sort(it.second.games.begin(), it.second.games.end(), [](FileData* a, FileData* b) { return a->getPath() < b->getPath(); });
+
+	mRemaining = mTotal;
 
 	mWndNotification = mWindow->createAsyncNotificationComponent();
 
@@ -39,8 +69,10 @@ ThreadedHasher::ThreadedHasher(Window* window, HasherType type, std::queue<FileD
 	{
 		mCheevosHashes = RetroAchievements::getCheevosHashes();
 		if (mCheevosHashes.size() == 0)
-			while (!mSearchQueue.empty())
-				mSearchQueue.pop();
+		{
+			mQueues.clear();
+			mRemaining = 0;
+		}
 	}
 
 	if (mType == HASH_CHEEVOS_MD5)
@@ -48,9 +80,7 @@ ThreadedHasher::ThreadedHasher(Window* window, HasherType type, std::queue<FileD
 	else 
 		mWndNotification->updateTitle(ICONINDEX + _("SEARCHING NETPLAY GAMES"));
 
-	int num_threads = std::thread::hardware_concurrency() / 2;
-	if (num_threads == 0)
-		num_threads = 1;
+	int num_threads = TaskScheduler::getWorkerCount(TaskScheduler::BACKGROUND);
 
 	mThreadCount = num_threads;
 	for (size_t i = 0; i < num_threads; i++)
@@ -65,6 +95,10 @@ ThreadedHasher::~ThreadedHasher()
 	mWndNotification->close();
 	mWndNotification = nullptr;
 
+	HashCache::save();
+
+	HttpEventStream::push("hash-end", "{}");
+
 	ThreadedHasher::mInstance = nullptr;
 }
 
@@ -75,30 +109,68 @@ std::string ThreadedHasher::formatGameName(FileData* game)
 
 void ThreadedHasher::updateUI(const std::string label)
 {
-	std::string idx = std::to_string(mTotal + 1 - mSearchQueue.size()) + "/" + std::to_string(mTotal);
-	int percent = 100 - (mSearchQueue.size() * 100 / mTotal);
+	std::string idx = std::to_string(mTotal + 1 - mRemaining) + "/" + std::to_string(mTotal);
+	int percent = 100 - (mRemaining * 100 / mTotal);
 		
 	mWndNotification->updateText(label);
 	mWndNotification->updatePercent(percent);	
+
+	HttpEventStream::pushProgress("hash-progress", mTotal + 1 - mRemaining, mTotal, label);
+}
+
+// The first device with games left & a free reader. pending is false once all the queues are empty
+ThreadedHasher::DeviceQueue* ThreadedHasher::getNextQueue(bool& pending)
+{
+	pending = false;
+
+	for (auto& it : mQueues)
+	{
+		if (it.second.games.empty())
+			continue;
+
+		pending = true;
+
+		if (!it.second.sequential || it.second.readers == 0)
+			return &it.second;
+	}
+
+	return nullptr;
 }
 
 void ThreadedHasher::run()
 {
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::BACKGROUND);
+
 	std::unique_lock<std::mutex> lock(mLoaderLock);
 
 	bool cheevos = ((mType & HASH_CHEEVOS_MD5) == HASH_CHEEVOS_MD5);
 	bool netplay = ((mType & HASH_NETPLAY_CRC) == HASH_NETPLAY_CRC);
 
-	while (!mExit && !mSearchQueue.empty())
+	while (!mExit)
 	{
-		FileData* game = mSearchQueue.front();
+		bool pending;
+		DeviceQueue* queue = getNextQueue(pending);
+		if (!pending)
+			break;
+
+		if (queue == nullptr)
+		{
+			// Only sequential devices busy with another thread are left
+			mDeviceFreed.wait_for(lock, std::chrono::milliseconds(500));
+			continue;
+		}
+
+		FileData* game = queue->games.front();
 
 		auto label = formatGameName(game);
 
 		LOG(LogDebug) << "Hashing " << formatGameName(game);
 		updateUI(label);
 
-		mSearchQueue.pop();
+		queue->games.pop_front();
+		queue->readers++;
+		mRemaining--;
+		mHashedCount++;
 
 		lock.unlock();
 
@@ -111,17 +183,24 @@ void ThreadedHasher::run()
 			}
 		}		
 
-		if (netplay)
+		if (netplay && cheevos)
+		{
+			LOG(LogDebug) << "CheckCrc32AndCheevosHash : " << label;
+			game->checkCrc32AndCheevosHash(mForce);
+		}
+		else if (netplay)
 		{
 			LOG(LogDebug) << "CheckCrc32 : " << label;
 			game->checkCrc32(mForce);
 		}
-
-		if (cheevos)
+		else if (cheevos)
 		{
 			LOG(LogDebug) << "CheckCheevosHash : " << label;
 			game->checkCheevosHash(mForce);
+		}
 
+		if (cheevos)
+		{
 			auto hash = Utils::String::toUpper(game->getMetadata(MetaDataId::CheevosHash));
 			if (!hash.empty())
 			{
@@ -136,6 +215,9 @@ void ThreadedHasher::run()
 		}		
 
 		lock.lock();
+
+		queue->readers--;
+		mDeviceFreed.notify_all();
 	}
 
 	mThreadCount--;
@@ -204,7 +286,7 @@ void ThreadedHasher::start(Window* window, HasherType type, bool forceAllGames,
 
 			if (cheevos)
 			{
-				std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(file->getPath()));
+				std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(file->getLeafName()));
 				
 				if (ext == ".pbp" || ext == ".cso") // Currently unsupported formats
 					cheevos = false;
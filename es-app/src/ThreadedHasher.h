@@ -1,8 +1,12 @@
 #pragma once
 
 #include <thread>
+#include <atomic>
 #include <queue>
 #include <set>
+#include <map>
+#include <deque>
+#include <condition_variable>
 #include "components/AsyncNotificationComponent.h"
 
 class FileData;
@@ -25,6 +29,9 @@ public:
 	static void pause() { mPaused = true; }
 	static void resume() { mPaused = false; }
 
+	// Games hashed since startup, for the web server /metrics
+	static unsigned long long getHashedCount() { return mHashedCount; }
+
 private:
 	ThreadedHasher(Window* window, HasherType type, std::queue<FileData*> searchQueue, bool forceAllGames = false);
 	~ThreadedHasher();
@@ -32,7 +39,21 @@ private:
 	void updateUI(const std::string label);
 	static std::string formatGameName(FileData* game);
 
-	std::queue<FileData*> mSearchQueue;
+	// The games by storage device, in path order. A sequential device ( spinning disk, network share ) is read by one thread at a time
+	struct DeviceQueue
+	{
+		DeviceQueue() : sequential(false), readers(0) { }
+
+		std::deque<FileData*> games;
+		bool sequential;
+		int readers;
+	};
+
+	DeviceQueue* getNextQueue(bool& pending);
+
+	std::map<unsigned long long, DeviceQueue> mQueues;
+	std::condition_variable mDeviceFreed;
+	int mRemaining;
 
 	Window* mWindow;
 	AsyncNotificationComponent* mWndNotification;
@@ -55,5 +76,7 @@ private:
 
 	static bool mPaused;
 	static ThreadedHasher* mInstance;
+
+	static std::atomic<unsigned long long> mHashedCount;
 };
 
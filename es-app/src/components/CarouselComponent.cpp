@@ -12,6 +12,9 @@
 const int logoBuffersLeft[] = { -5, -2, -1 };
 const int logoBuffersRight[] = { 1, 2, 5 };
 
+#define LOGO_WINDOW_MARGIN		5	// Logos kept loaded on each side of the visible ones, the largest render buffer
+#define LOGO_PREFETCH_COUNT		3	// Logos created ahead of the cursor, in the scroll direction
+
 CarouselComponent::CarouselComponent(Window* window) :
 	IList<CarouselComponentData, FileData*>(window, LIST_SCROLL_STYLE_SLOW, LIST_ALWAYS_LOOP)
 {
@@ -217,6 +220,8 @@ void CarouselComponent::onCursorChanged(const CursorState& state)
 		Sound::get(mScrollSound)->play();
 
 	int oldCursor = mLastCursor;
+
+	updateLogoWindow();
 	
 	bool oldCursorHasStoryboard = false;
 
@@ -649,6 +654,46 @@ FileData* CarouselComponent::getActiveFileData()
 	return mEntries[mCursor].object;
 }
 
+// Logos live in a window around the cursor : the ones leaving it are released with their textures, the ones entering it are created & queued nearest first, ahead of the scroll direction
+void CarouselComponent::updateLogoWindow()
+{
+	int count = (int)mEntries.size();
+	if (count == 0 || mCursor < 0 || mCursor >= count)
+		return;
+
+	int window = mMaxLogoCount / 2 + LOGO_WINDOW_MARGIN;
+	if (count > window * 2 + 1)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (i == mCursor || i == mLastCursor || mEntries.at(i).data.logo == nullptr)
+				continue;
+
+			int distance = abs(i - mCursor);
+			if (Math::min(distance, count - distance) > window)
+				mEntries.at(i).data.logo = nullptr;
+		}
+	}
+
+	int direction = getScrollingVelocity() < 0 ? -1 : 1;
+
+	for (int d = 0; d <= LOGO_PREFETCH_COUNT && d * 2 < count; d++)
+	{
+		for (int side = 0; side < (d == 0 ? 1 : 2); side++)
+		{
+			int index = (mCursor + (side == 0 ? direction : -direction) * d) % count;
+			if (index < 0)
+				index += count;
+
+			auto& entry = mEntries.at(index);
+			ensureLogo(entry);
+
+			if (entry.data.logo->isKindOf<ImageComponent>())
+				((ImageComponent*)entry.data.logo.get())->setLoadPriority(d * 2 + side);
+		}
+	}
+}
+
 void CarouselComponent::ensureLogo(IList<CarouselComponentData, FileData*>::Entry& entry)
 {
 	if (entry.data.logo != nullptr)
@@ -73,6 +73,7 @@ private:
 
 	void renderCarousel(const Transform4x4f& parentTrans);	
 	void ensureLogo(IList<CarouselComponentData, FileData*>::Entry& entry);
+	void updateLogoWindow();
 
 	// unit is list index
 	float mCamOffset;
@@ -10,6 +10,7 @@
 #include <memory>
 #include "components/ScrollbarComponent.h"
 #include "Settings.h"
+#include "LocaleES.h"
 #include "Window.h"
 #include "InputManager.h"
 #include "utils/Delegate.h"
@@ -21,7 +22,6 @@ class TextCache;
 struct TextListData
 {
 	unsigned int colorId;
-	std::shared_ptr<TextCache> textCache;
 };
 
 //A graphical list. Supports multiple colors for rows and scrolling.
@@ -74,15 +74,23 @@ public:
 	inline void setFont(const std::shared_ptr<Font>& font)
 	{
 		mFont = font;
-		for (auto it = mEntries.begin(); it != mEntries.end(); it++)
-			it->data.textCache.reset();
+		mRowCaches.clear();
 	}
 
 	inline void setUppercase(bool uppercase)
 	{
 		mUppercase = uppercase;
-		for (auto it = mEntries.begin(); it != mEntries.end(); it++)
-			it->data.textCache.reset();
+		mRowCaches.clear();
+	}
+
+	// RTL locales with the "PrecomputeBidi" setting : reorders every name now instead of while scrolling
+	void prepareBidiTexts()
+	{
+		if (!EsLocale::isRTL() || !Settings::getInstance()->getBool("PrecomputeBidi"))
+			return;
+
+		for (auto it = mEntries.cbegin(); it != mEntries.cend(); it++)
+			Font::prepareBidiText(mUppercase ? Utils::String::toUpper(it->name) : it->name);
 	}
 
 	inline void setSelectorHeight(float selectorScale) { mSelectorHeight = selectorScale; }
@@ -115,6 +123,22 @@ protected:
 	virtual void onCursorChanged(const CursorState& state);
 
 private:
+	// Text caches of the visible rows plus a margin, as a ring indexed by entry : the entries themselves hold none
+	struct RowCache
+	{
+		RowCache() : entry(-1) { }
+
+		int							entry;
+		std::string					name;
+		std::unique_ptr<TextCache>	cache;
+	};
+
+	static const int ROW_CACHE_MARGIN = 4;
+
+	TextCache* getRowCache(int index, int screenCount);
+
+	std::vector<RowCache> mRowCaches;
+
 	void  updateCameraOffset();
 	float getRowHeight() const;
 	float getTotalRowHeight() const;
@@ -248,20 +272,19 @@ void TextListComponent<T>::render(const Transform4x4f& parentTrans)
 		else
 			color = mColors[entry.data.colorId];
 
-		if (!entry.data.textCache)
-			entry.data.textCache = std::unique_ptr<TextCache>(font->buildTextCache(mUppercase ? Utils::String::toUpper(entry.name) : entry.name, 0, 0, 0x000000FF));
+		TextCache* textCache = getRowCache(i, screenCount);
 
 		if (mCursor == i && mHasBonusSelectedColor)
-			entry.data.textCache->setColors(color, mBonusSelectedColor);
+			textCache->setColors(color, mBonusSelectedColor);
 		else if (mHasBonusColor)
-			entry.data.textCache->setColors(color, mBonusColor);
+			textCache->setColors(color, mBonusColor);
 		else
-			entry.data.textCache->setColor(color);
+			textCache->setColor(color);
 
 		Vector3f offset(0, y, 0);
 
 		if (mLineCount > 0) // Vertical center
-			offset[1] += (int)((entrySize - entry.data.textCache->metrics.size.y()) / 2);
+			offset[1] += (int)((entrySize - textCache->metrics.size.y()) / 2);
 
 		switch (mAlignment)
 		{
@@ -269,12 +292,12 @@ void TextListComponent<T>::render(const Transform4x4f& parentTrans)
 			offset[0] = mHorizontalMargin;
 			break;
 		case ALIGN_CENTER:
-			offset[0] = (int)((mSize.x() - entry.data.textCache->metrics.size.x()) / 2);
+			offset[0] = (int)((mSize.x() - textCache->metrics.size.x()) / 2);
 			if (offset[0] < mHorizontalMargin)
 				offset[0] = mHorizontalMargin;
 			break;
 		case ALIGN_RIGHT:
-			offset[0] = (mSize.x() - entry.data.textCache->metrics.size.x());
+			offset[0] = (mSize.x() - textCache->metrics.size.x());
 			offset[0] -= mHorizontalMargin;
 			if (offset[0] < mHorizontalMargin)
 				offset[0] = mHorizontalMargin;
@@ -324,7 +347,7 @@ void TextListComponent<T>::render(const Transform4x4f& parentTrans)
 				mSelectorColorGradientHorizontal);
 		}
 
-		font->renderTextCacheEx(entry.data.textCache.get(), drawTrans, mGlowSize, mGlowColor, mGlowOffset, GuiComponent::mOpacity);
+		font->renderTextCacheEx(textCache, drawTrans, mGlowSize, mGlowColor, mGlowOffset, GuiComponent::mOpacity);
 
 		// render currently selected item text again if
 		// marquee is scrolled far enough for it to repeat
@@ -333,7 +356,7 @@ void TextListComponent<T>::render(const Transform4x4f& parentTrans)
 			drawTrans = trans;
 			drawTrans.translate(offset - Vector3f((float)mMarqueeOffset2, 0, 0));
 
-			font->renderTextCacheEx(entry.data.textCache.get(), drawTrans, mGlowSize, mGlowColor, mGlowOffset, GuiComponent::mOpacity);
+			font->renderTextCacheEx(textCache, drawTrans, mGlowSize, mGlowColor, mGlowOffset, GuiComponent::mOpacity);
 		}
 
 		y += entrySize;
@@ -356,6 +379,36 @@ void TextListComponent<T>::render(const Transform4x4f& parentTrans)
 	}
 }
 
+template <typename T>
+TextCache* TextListComponent<T>::getRowCache(int index, int screenCount)
+{
+	size_t ringSize = (size_t)(Math::max(1, screenCount) + 2 * ROW_CACHE_MARGIN);
+	if (mRowCaches.size() != ringSize)
+	{
+		mRowCaches.clear();
+		mRowCaches.resize(ringSize);
+	}
+
+	const std::string& name = mEntries.at((unsigned int)index).name;
+
+	// The slot may hold an entry scrolled out, or this one before a sort or a removal
+	RowCache& row = mRowCaches[index % ringSize];
+	if (row.cache != nullptr && row.entry == index && row.name == name)
+		return row.cache.get();
+
+	std::string text = mUppercase ? Utils::String::toUpper(name) : name;
+
+	if (row.cache != nullptr)
+		mFont->updateTextCache(row.cache.get(), text, Vector2f(0, 0), 0x000000FF, 0.0f);
+	else
+		row.cache = std::unique_ptr<TextCache>(mFont->buildTextCache(text, 0, 0, 0x000000FF));
+
+	row.entry = index;
+	row.name = name;
+
+	return row.cache.get();
+}
+
 template <typename T>
 bool TextListComponent<T>::input(InputConfig* config, Input input)
 {
@@ -419,6 +472,9 @@ void TextListComponent<T>::update(int deltaTime)
 
 	listUpdate(deltaTime);
 
+	auto marqueeOffset = mMarqueeOffset;
+	auto marqueeOffset2 = mMarqueeOffset2;
+
 	if (!isScrolling() && size() > 0)
 	{
 		// always reset the marquee offsets
@@ -456,6 +512,9 @@ void TextListComponent<T>::update(int deltaTime)
 		}
 	}
 
+	if (mMarqueeOffset != marqueeOffset || mMarqueeOffset2 != marqueeOffset2)
+		GuiComponent::invalidateRender();
+
 	GuiComponent::update(deltaTime);
 }
 
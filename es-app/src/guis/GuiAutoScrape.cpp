@@ -8,6 +8,7 @@
 #include "Window.h"
 #include <string>
 #include "Log.h"
+#include "TaskScheduler.h"
 #include "Settings.h"
 #include "ApiSystem.h"
 #include "LocaleES.h"
@@ -90,6 +91,8 @@ void GuiAutoScrape::update(int deltaTime) {
 
 void GuiAutoScrape::threadAutoScrape() 
 {
+  TaskScheduler::setCurrentThreadPriority(TaskScheduler::NETWORK);
+
   std::pair<std::string,int> scrapeStatus = ApiSystem::getInstance()->scrape(&mBusyAnim);
   if(scrapeStatus.second == 0){
     this->onAutoScrapeOk();
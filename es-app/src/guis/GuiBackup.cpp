@@ -4,6 +4,7 @@
 #include "Window.h"
 #include <string>
 #include "Log.h"
+#include "TaskScheduler.h"
 #include "Settings.h"
 #include "ApiSystem.h"
 #include "LocaleES.h"
@@ -84,6 +85,8 @@ void GuiBackup::update(int deltaTime) {
 
 void GuiBackup::threadBackup() 
 {
+    TaskScheduler::setCurrentThreadPriority(TaskScheduler::BACKGROUND);
+
     std::pair<std::string,int> updateStatus = ApiSystem::getInstance()->backupSystem(&mBusyAnim, mstorageDevice);
     if(updateStatus.second == 0){
         this->onBackupOk();
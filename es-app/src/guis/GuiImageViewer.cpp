@@ -4,6 +4,7 @@
 #include "ApiSystem.h"
 #include "GuiLoading.h"
 #include "ImageIO.h"
+#include "resources/TextureResource.h"
 
 #ifdef WIN32
 #include <Windows.h>
@@ -12,7 +13,8 @@
 #include <unistd.h>
 #endif
 
-#include "utils/ZipFile.h"
+#include "utils/ComicBook.h"
+#include <fstream>
 #include "components/HelpComponent.h"
 
 class ZoomableImageComponent : public ImageComponent
@@ -33,6 +35,7 @@ public:
 		setPosition(Renderer::getScreenWidth() * 0.5, Renderer::getScreenHeight() * 0.5);
 		setOrigin(0.5, 0.5);
 		setMaxSize(Renderer::getScreenWidth(), Renderer::getScreenHeight());	
+		setUpdateAlways(true);
 	}
 
 	void runAnimation()
@@ -269,8 +272,13 @@ private:
 
 static bool g_isGuiImageViewerRunning = false;
 
+#define ZOOMEDPAGES		8
+#define PREFETCH_IMAGES	3	// Images queued on each side of the cursor
+#define CACHED_IMAGES	12	// Decoded images kept while the viewer is open
+#define PREFETCH_LOAD_PRIORITY	16	// Queue position of the images around the cursor, behind the on screen ones
+
 GuiImageViewer::GuiImageViewer(Window* window, bool linearSmooth) :
-	GuiComponent(window), mGrid(window), mPdfThreads(nullptr)
+	GuiComponent(window), mGrid(window), mPdfThreads(nullptr), mPageCursor(0), mPdfDpi(0), mPrefetchCursor(-1), mLinearSmooth(linearSmooth)
 {
 	g_isGuiImageViewerRunning = true;
 
@@ -330,7 +338,8 @@ void GuiImageViewer::loadPdf(const std::string& imagePath)
 {
 	Window* window = mWindow;
 
-	int pages = ApiSystem::getInstance()->getPdfPageCount(imagePath);
+	float pageHeight = 0;
+	int pages = ApiSystem::getInstance()->getPdfInfo(imagePath, pageHeight);
 	if (pages == 0)
 	{
 		delete this;
@@ -338,22 +347,36 @@ void GuiImageViewer::loadPdf(const std::string& imagePath)
 	}
 
 #define INITIALPAGES	1
-#define PAGESPERTHREAD  1
 
 	mPdf = imagePath;
+
+	// A page fills the screen height : no need to render more pixels ( the zoom renders its own page )
+	if (pageHeight > 0)
+		mPdfDpi = (int)Math::clamp(72.0f * Renderer::getScreenHeight() / pageHeight, 32, 300);
 	
 	for (int i = 0; i < pages; i++)
-		mGrid.add("", ":/blank.png", "", "", false, false, false, false, std::to_string(i + 1));
+	{
+		mImages.push_back(std::to_string(i + 1));
+		mGrid.add("", ":/blank.png", "", "", false, false, false, false, mImages.back());
+	}
 	
 	if (pages > INITIALPAGES)
 	{
-		mPdfThreads = new Utils::ThreadPool(1);
+		for (int i = INITIALPAGES; i < pages; i++)
+			mPendingPages.insert(i);
+
+		// The work items run on the TEXTURE_IO workers, sized from the core count
+		mPdfThreads = new Utils::ThreadPool(TaskScheduler::TEXTURE_IO);
 
-		for (int i = INITIALPAGES; i < pages; i += PAGESPERTHREAD)
+		for (int i = INITIALPAGES; i < pages; i++)
 		{
-			mPdfThreads->queueWorkItem([this, imagePath, window, i]
+			mPdfThreads->queueWorkItem([this, imagePath, window]
 			{
-				auto fl = ApiSystem::getInstance()->extractPdfImages(imagePath, i + 1, PAGESPERTHREAD);
+				int i = takeNextPage();
+				if (i < 0 || !g_isGuiImageViewerRunning)
+					return;
+
+				auto fl = ApiSystem::getInstance()->extractPdfImages(imagePath, i + 1, 1, mPdfDpi);
 				if (fl.size() == 0 || !g_isGuiImageViewerRunning)
 					return;
 
@@ -368,17 +391,20 @@ void GuiImageViewer::loadPdf(const std::string& imagePath)
 						ImageIO::removeImageCache(img);
 						mGrid.setImage(img, std::to_string(i + 1 + f));
 					}
+
+					// The page can be one of the neighbours
+					mPrefetchCursor = -1;
 				});
 			});
 		}
-
-		mPdfThreads->start();
 	}
 	
+	int dpi = mPdfDpi;
+
 	window->pushGui(new GuiLoading<std::vector<std::string>>(window, _("Loading..."),
-		[window, imagePath](auto gui)
+		[window, imagePath, dpi](auto gui)
 		{		
-			return ApiSystem::getInstance()->extractPdfImages(imagePath, 1, INITIALPAGES);
+			return ApiSystem::getInstance()->extractPdfImages(imagePath, 1, INITIALPAGES, dpi);
 		},
 			[this, window, imagePath, pages](std::vector<std::string> fileList)
 		{
@@ -395,24 +421,30 @@ void GuiImageViewer::loadPdf(const std::string& imagePath)
 		}));
 }
 
-static std::string _extractZipFile(const std::string& zipFileName, const std::string& fileToExtract)
+static std::string _extractComicPage(const std::shared_ptr<Utils::Zip::ComicBook>& book, int index)
 {
+	auto data = book->readPage(index);
+	if (data == nullptr)
+		return "";
+
 	auto pdfFolder = Utils::FileSystem::getPdfTempPath();
 
-	Utils::Zip::ZipFile zipFile;
-	if (zipFile.load(zipFileName))
-	{
-		std::string fullPath = Utils::FileSystem::combine(pdfFolder, fileToExtract);
-		std::string folder = Utils::FileSystem::getParent(fullPath);
-		if (folder != pdfFolder)
-			Utils::FileSystem::createDirectory(folder);
-
-		if (zipFile.extract(fileToExtract, fullPath, true))
-			if (Utils::FileSystem::exists(fullPath))
-				return fullPath;
-	}
+	std::string fullPath = Utils::FileSystem::combine(pdfFolder, book->getPageName(index));
+	std::string folder = Utils::FileSystem::getParent(fullPath);
+	if (folder != pdfFolder)
+		Utils::FileSystem::createDirectory(folder);
+
+	std::ofstream file(WINSTRINGW(fullPath), std::ios::out | std::ios::binary);
+	if (!file.is_open())
+		return "";
+
+	file.write((const char*)data->data(), data->size());
+	file.close();
 
-	return "";
+	if (file.fail())
+		return "";
+
+	return fullPath;
 }
 
 void GuiImageViewer::loadImages(std::vector<std::string>& images)
@@ -428,7 +460,10 @@ void GuiImageViewer::loadImages(std::vector<std::string>& images)
 	mWindow->postToUiThread([images, window, this]
 	{
 		for (int i = 0; i < images.size(); i++)
-			mGrid.add("", images[i], "", "", false, false, false, false, std::to_string(i + 1));
+		{
+			mImages.push_back(std::to_string(i + 1));
+			mGrid.add("", images[i], "", "", false, false, false, false, mImages.back());
+		}
 
 		window->pushGui(this);
 	});
@@ -442,95 +477,75 @@ void GuiImageViewer::loadCbz(const std::string& imagePath)
 
 	Window* window = mWindow;
 
-	std::vector<std::string> files;
-	std::vector<std::wstring> filesW;
-	
-
-	try
+	// Bad zip file, or no pages
+	mComicBook = Utils::Zip::ComicBook::open(imagePath);
+	if (mComicBook == nullptr)
 	{
-		Utils::Zip::ZipFile zipFile;
-		if (zipFile.load(imagePath))
-		{
-			for (auto file : zipFile.namelist())
-			{
-				auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(file));
-				if (ext != ".jpg")
-					continue;
-
-				if (Utils::String::startsWith(file, "__"))
-					continue;
-
-				files.push_back(file);
-			}
-
-			std::sort(files.begin(), files.end(), [](std::string a, std::string b) { return Utils::String::toLower(a) < Utils::String::toLower(b); });
-		}
-	}
-	catch (...)
-	{
-		// Bad zip file
 		delete this;
 		return;
 	}
 
-	int pages = files.size();
-	if (pages == 0)
-	{
-		delete this;
-		return;
-	}
+	int pages = mComicBook->getPageCount();
 
 #define INITIALPAGES	1
 
 	mPdf = imagePath;
 
 	for (int i = 0; i < pages; i++)
-		mGrid.add("", ":/blank.png", "", "", false, false, false, false, std::to_string(i + 1));
+	{
+		mImages.push_back(std::to_string(i + 1));
+		mGrid.add("", ":/blank.png", "", "", false, false, false, false, mImages.back());
+	}
 
 	if (pages > INITIALPAGES)
 	{
-		mPdfThreads = new Utils::ThreadPool(1);
+		for (int i = INITIALPAGES; i < pages; i++)
+			mPendingPages.insert(i);
+
+		mPdfThreads = new Utils::ThreadPool(TaskScheduler::TEXTURE_IO);
 
-		for (int i = INITIALPAGES; i < pages; i += PAGESPERTHREAD)
+		for (int i = INITIALPAGES; i < pages; i++)
 		{
-			auto fileToExtract = files[i];
-			mPdfThreads->queueWorkItem([this, imagePath, fileToExtract, window, i]
+			mPdfThreads->queueWorkItem([this, window]
 			{
-				auto localFile = _extractZipFile(imagePath, fileToExtract);
+				int page = takeNextPage();
+				if (page < 0 || !g_isGuiImageViewerRunning)
+					return;
+
+				auto localFile = _extractComicPage(mComicBook, page);
 				if (localFile.empty() || !g_isGuiImageViewerRunning)
 					return;
 
-				window->postToUiThread([this, i, localFile]()
+				window->postToUiThread([this, page, localFile]()
 				{
 					if (!g_isGuiImageViewerRunning)
 						return;
 
 					ImageIO::removeImageCache(localFile);
-					mGrid.setImage(localFile, std::to_string(i + 1));
+					mGrid.setImage(localFile, std::to_string(page + 1));
+					mPrefetchCursor = -1;
 				});
 			});
 		}
-
-		mPdfThreads->start();
 	}
 
+	auto book = mComicBook;
+
 	window->pushGui(new GuiLoading<std::vector<std::string>>(window, _("Loading..."),
-		[window, imagePath, files](auto gui)
+		[book](auto gui)
 		{
 			std::vector<std::string> ret;
 
-			for (size_t i = 0; i < INITIALPAGES && i < files.size(); i++)
+			for (int i = 0; i < INITIALPAGES && i < book->getPageCount(); i++)
 			{
-				auto fileToExtract = files[i];
-
-				auto localFile = _extractZipFile(imagePath, fileToExtract);
+				auto localFile = _extractComicPage(book, i);
 				if (!localFile.empty())
 					ret.push_back(localFile);
 			}
 
 			return ret;
 		},
-		[this, window, imagePath, pages](std::vector<std::string> fileList)
+		[this, window](std::vector<std::string> fileList)
 		{
 			if (fileList.size() == 0)
 				return;
@@ -546,6 +561,84 @@ void GuiImageViewer::loadCbz(const std::string& imagePath)
 	));
 }
 
+// The page closest to the cursor, the next one first when both sides are at the same distance
+int GuiImageViewer::takeNextPage()
+{
+	std::unique_lock<std::mutex> lock(mPagesLock);
+
+	if (mPendingPages.empty())
+		return -1;
+
+	int cursor = mPageCursor;
+
+	auto next = mPendingPages.lower_bound(cursor);
+	auto best = next;
+
+	if (next == mPendingPages.end())
+		best = std::prev(next);
+	else if (next != mPendingPages.begin() && cursor - *std::prev(next) < *next - cursor)
+		best = std::prev(next);
+
+	int page = *best;
+	mPendingPages.erase(best);
+	return page;
+}
+
+void GuiImageViewer::update(int deltaTime)
+{
+	if (!mPdf.empty())
+		mPageCursor = mGrid.getCursorIndex();
+
+	prefetchImages();
+
+	GuiComponent::update(deltaTime);
+}
+
+// Queues the neighbours of the cursor at the display size, the nearest first, in the textures the tiles will ask for.
+// The last ones stay referenced here, so that going back and forth doesn't reload them from the disk
+void GuiImageViewer::prefetchImages()
+{
+	int count = (int)mImages.size();
+	int cursor = mGrid.getCursorIndex();
+	if (count == 0 || cursor == mPrefetchCursor || cursor < 0 || cursor >= count)
+		return;
+
+	mPrefetchCursor = cursor;
+
+	MaxSizeInfo maxSize(Renderer::getScreenWidth(), Renderer::getScreenHeight());
+	int priority = PREFETCH_LOAD_PRIORITY;
+
+	for (int distance = 0; distance <= PREFETCH_IMAGES && distance * 2 <= count; distance++)
+	{
+		for (int side = 1; side >= (distance == 0 ? 1 : -1); side -= 2)
+		{
+			// The grid loops
+			int index = ((cursor + distance * side) % count + count) % count;
+
+			std::string path = mGrid.getImage(mImages[index]);
+			if (path.empty() || path[0] == ':' || Utils::FileSystem::isVideo(path) || Utils::FileSystem::isAudio(path))
+				continue;
+
+			auto texture = TextureResource::get(path, false, mLinearSmooth, false, true, true, &maxSize);
+
+			// The current one is already on screen
+			if (distance > 0)
+				texture->prefetch(priority++);
+
+			mCachedImages.remove(texture);
+			mCachedImages.push_front(texture);
+		}
+	}
+
+	while (mCachedImages.size() > CACHED_IMAGES)
+	{
+		auto& oldest = mCachedImages.back();
+		if (oldest.use_count() == 1)
+			TextureResource::cancelAsync(oldest);
+
+		mCachedImages.pop_back();
+	}
+}
 
 GuiImageViewer::~GuiImageViewer()
 {
@@ -580,18 +673,44 @@ bool GuiImageViewer::input(InputConfig* config, Input input)
 					// path = mGrid.getImage(path);
 					int page = mGrid.getCursorIndex() + 1;
 
+					for (auto it = mZoomedPages.begin(); it != mZoomedPages.end(); ++it)
+					{
+						if (it->first != page)
+							continue;
+
+						mZoomedPages.splice(mZoomedPages.begin(), mZoomedPages, it);
+						mWindow->pushGui(new ZoomableImageComponent(mWindow, it->second));
+						return true;
+					}
+
+					// Twice the resolution of the grid pages, for the zoom in
+					int dpi = mPdfDpi > 0 ? std::min(mPdfDpi * 2, 300) : 300;
+
 					Window* window = mWindow;
 					window->pushGui(new GuiLoading<std::string>(window, _("Loading..."),
-						[this, window, path, page](auto gui)
+						[this, window, path, page, dpi](auto gui)
 						{
-							auto files = ApiSystem::getInstance()->extractPdfImages(mPdf, page, 1, 300);
+							auto files = ApiSystem::getInstance()->extractPdfImages(mPdf, page, 1, dpi);
 							if (files.size() == 1)
 								return files[0];
 
 							return path;
 						},
-						[window](std::string file)
+						[this, window, path, page](std::string file)
 						{
+							if (file != path)
+							{
+								mZoomedPages.push_front(std::make_pair(page, file));
+
+								while (mZoomedPages.size() > ZOOMEDPAGES)
+								{
+									auto& oldest = mZoomedPages.back().second;
+									ImageIO::removeImageCache(oldest);
+									Utils::FileSystem::removeFile(oldest);
+									mZoomedPages.pop_back();
+								}
+							}
+
 							window->pushGui(new ZoomableImageComponent(window, file));
 						})
 					);
@@ -645,6 +764,7 @@ void GuiImageViewer::add(const std::string imagePath)
 	else
 		img = imagePath;
 	
+	mImages.push_back(imagePath);
 	mGrid.add("", img, vid, "", false, false, false, false, imagePath);
 }
 
@@ -4,9 +4,15 @@
 #include "Window.h"
 #include "components/ImageGridComponent.h"
 #include "utils/ThreadPool.h"
+#include "utils/ComicBook.h"
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <set>
 
 class ThemeData;
 class VideoComponent;
+class TextureResource;
 
 class GuiImageViewer : public GuiComponent
 {
@@ -20,6 +26,7 @@ public:
 	~GuiImageViewer();
 
 	bool input(InputConfig* config, Input input) override;
+	void update(int deltaTime) override;
 	virtual std::vector<HelpPrompt> getHelpPrompts() override;
 
 	void add(const std::string imagePath);
@@ -30,11 +37,29 @@ protected:
 	void loadCbz(const std::string& imagePath);
 	void loadImages(std::vector<std::string>& images);
 
+	int takeNextPage();
+	void prefetchImages();
+
 	ImageGridComponent<std::string> mGrid;
 	std::shared_ptr<ThemeData> mTheme;
 	std::string mPdf;
 
 	Utils::ThreadPool* mPdfThreads;
+	std::shared_ptr<Utils::Zip::ComicBook> mComicBook;
+
+	// Pages of the pdf or the cbz not extracted yet : the workers take the one closest to the cursor
+	std::mutex mPagesLock;
+	std::set<int> mPendingPages;
+	std::atomic<int> mPageCursor;
+
+	int mPdfDpi; // Grid pages of the pdf are rendered for the screen height
+	std::list<std::pair<int, std::string>> mZoomedPages; // Pages rendered for the zoom, most recent first
+
+	// The images around the cursor are queued ahead, and kept decoded while the viewer is open
+	std::vector<std::string> mImages; // Grid objects, in order
+	std::list<std::shared_ptr<TextureResource>> mCachedImages; // Most recent first
+	int mPrefetchCursor;
+	bool mLinearSmooth;
 };
 
 class GuiVideoViewer : public GuiComponent
@@ -4,6 +4,7 @@
 #include "Window.h"
 #include <string>
 #include "Log.h"
+#include "TaskScheduler.h"
 #include "Settings.h"
 #include "ApiSystem.h"
 #include "LocaleES.h"
@@ -85,6 +86,8 @@ void GuiInstall::update(int deltaTime) {
 
 void GuiInstall::threadInstall() 
 {
+    TaskScheduler::setCurrentThreadPriority(TaskScheduler::BACKGROUND);
+
     std::pair<std::string,int> updateStatus = ApiSystem::getInstance()->installSystem(&mBusyAnim, mstorageDevice, marchitecture);
     if(updateStatus.second == 0){
         this->onInstallOk();
@@ -28,6 +28,8 @@
 #include "Scripting.h"
 #include "SystemData.h"
 #include "VolumeControl.h"
+#include "FrameScheduler.h"
+#include "Profiler.h"
 #include <SDL_events.h>
 #include <algorithm>
 #include "utils/Platform.h"
@@ -59,6 +61,11 @@
 #include "Gamelist.h"
 #include "TextToSpeech.h"
 #include "Paths.h"
+#include "resources/TextureDiskCache.h"
+#include "resources/SvgCache.h"
+#include "resources/GlyphCache.h"
+#include "resources/PixelBuffer.h"
+#include "VideoHardwareDecode.h"
 
 #if WIN32
 #include "Win32ApiSystem.h"
@@ -106,6 +113,10 @@ GuiMenu::GuiMenu(Window *window, bool animate) : GuiComponent(window), mMenu(win
 	// MAIN MENU
 	bool isFullUI = !UIModeController::getInstance()->isUIModeKid() && !UIModeController::getInstance()->isUIModeKiosk();
 
+	// The system & sound screens are only reachable in full UI
+	if (isFullUI)
+		ApiSystem::getInstance()->prefetchMenuQueries();
+
 	// KODI >
 	// GAMES SETTINGS >
 	// CONTROLLER & BLUETOOTH >
@@ -431,8 +442,35 @@ void GuiMenu::openDeveloperSettings()
 	s->addSaveFunc([max_vram] { Settings::getInstance()->setInt("MaxVRAM", (int)round(max_vram->getValue())); });
 	
 	s->addSwitch(_("SHOW FRAMERATE"), _("Also turns on the emulator's native FPS counter, if available."), "DrawFramerate", true, nullptr);
+	s->addSwitch(_("SHOW PROFILER"), _("Shows the time spent per frame by the elements of the screen."), "DrawProfiler", true, nullptr);
+	s->addEntry(_("EXPORT PROFILER HISTORY"), false, [window]
+	{
+		if (Profiler::exportHistory())
+			window->pushGui(new GuiMsgBox(window, _("PROFILER HISTORY SAVED TO") + "\n" + Profiler::getExportPath()));
+		else
+			window->pushGui(new GuiMsgBox(window, _("ENABLE THE PROFILER FIRST")));
+	});
 	s->addSwitch(_("VSYNC"), "VSync", true, [] { Renderer::setSwapInterval(); });
 
+	// frame rate
+	auto frameRate = std::make_shared< OptionListComponent<std::string> >(mWindow, _("FRAME RATE"), false);
+	std::string currentFrameRate = Settings::getInstance()->getString("FrameRate");
+	if (currentFrameRate.empty())
+		currentFrameRate = "auto";
+
+	frameRate->add(_("AUTO"), "auto", currentFrameRate == "auto");
+	frameRate->add("60", "60", currentFrameRate == "60");
+	frameRate->add("30", "30", currentFrameRate == "30");
+	if (!frameRate->hasSelection())
+		frameRate->selectFirstItem();
+
+	s->addWithLabel(_("FRAME RATE"), frameRate);
+	s->addSaveFunc([frameRate]
+	{
+		if (Settings::getInstance()->setString("FrameRate", frameRate->getSelected()))
+			FrameScheduler::init();
+	});
+
 #ifdef BATOCERA
 	// overscan
 	auto overscan_enabled = std::make_shared<SwitchComponent>(mWindow);
@@ -576,6 +614,10 @@ void GuiMenu::openDeveloperSettings()
 	s->addEntry(_("CLEAR CACHES"), true, [this, s]
 	{
 		ImageIO::clearImageCache();
+		TextureDiskCache::clear();
+		SvgCache::clear();
+		GlyphCache::clear();
+		PixelBufferPool::clear();
 
 		auto rootPath = Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath());
 
@@ -816,11 +858,28 @@ void GuiMenu::openDeveloperSettings()
 	s->addWithLabel(_("OPTIMIZE IMAGES VRAM USE"), optimizeVram);
 	s->addSaveFunc([optimizeVram] { Settings::getInstance()->setBool("OptimizeVRAM", optimizeVram->getState()); });
 
+	// dedupTextures
+	auto dedupTextures = std::make_shared<SwitchComponent>(mWindow);
+	dedupTextures->setState(Settings::getInstance()->getBool("DedupTextures"));
+	s->addWithLabel(_("SHARE IDENTICAL IMAGES"), dedupTextures);
+	s->addSaveFunc([dedupTextures] { Settings::getInstance()->setBool("DedupTextures", dedupTextures->getState()); });
+
 	// optimizeVideo
 	auto optimizeVideo = std::make_shared<SwitchComponent>(mWindow);
 	optimizeVideo->setState(Settings::getInstance()->getBool("OptimizeVideo"));
 	s->addWithLabel(_("OPTIMIZE VIDEO VRAM USAGE"), optimizeVideo);
 	s->addSaveFunc([optimizeVideo] { Settings::getInstance()->setBool("OptimizeVideo", optimizeVideo->getState()); });
+
+	// low memory profile
+	std::vector<std::pair<std::string, std::string>> lowMemoryModes = { { _("AUTO"), "auto" }, { _("ON"), "on" }, { _("OFF"), "off" } };
+	s->addOptionList(_("LOW MEMORY MODE"), _("Smaller images and caches for the devices with 1GB of RAM, applied at the next start"), lowMemoryModes, "LowMemoryMode", true, nullptr);
+
+	// video decoding
+	std::vector<std::pair<std::string, std::string>> decoders = { { _("AUTO"), "auto" } };
+	for (auto backend : VideoHardwareDecode::getBackends())
+		decoders.push_back(std::make_pair(backend == "none" ? _("SOFTWARE") : Utils::String::toUpper(backend), backend));
+
+	s->addOptionList(_("VIDEO DECODING"), _("Auto benchmarks the decoders of this device once and keeps the fastest"), decoders, "VideoHardwareDecode", true, nullptr);
 	
 	s->onFinalize([s, window]
 	{
@@ -1009,28 +1068,32 @@ void GuiMenu::openSystemSettings()
 		}		
 	});
 
-	// Timezone
+	// Timezone : the list comes from a script, it's read once the row shows
 	if (ApiSystem::getInstance()->isScriptingSupported(ApiSystem::ScriptId::TIMEZONES))
 	{
-		VectorEx<std::string> availableTimezones = ApiSystem::getInstance()->getTimezones();
-		if (availableTimezones.size() > 0)
+		s->addDeferredWithLabel(_("TIME ZONE"), [window, s]() -> std::shared_ptr<GuiComponent>
 		{
+			VectorEx<std::string> availableTimezones = ApiSystem::getInstance()->getTimezones();
+			if (availableTimezones.size() == 0)
+				return nullptr;
+
 			std::string currentTZ = ApiSystem::getInstance()->getCurrentTimezone();
 			if (currentTZ.empty() || !availableTimezones.any([currentTZ](const std::string& tz) { return tz == currentTZ; }))
 				currentTZ = "Europe/Paris";
 
-			auto tzChoices = std::make_shared<OptionListComponent<std::string> >(mWindow, _("SELECT YOUR TIME ZONE"), false);
+			auto tzChoices = std::make_shared<OptionListComponent<std::string> >(window, _("SELECT YOUR TIME ZONE"), false);
 
 			for (auto tz : availableTimezones)
 				tzChoices->add(_(Utils::String::toUpper(tz).c_str()), tz, currentTZ == tz);
 
-			s->addWithLabel(_("TIME ZONE"), tzChoices);
 			s->addSaveFunc([tzChoices] 
 			{
 				if (SystemConf::getInstance()->set("system.timezone", tzChoices->getSelected()))
 					ApiSystem::getInstance()->setTimezone(tzChoices->getSelected());
 			});
-		}
+
+			return tzChoices;
+		});
 	}
 
 	// Clock time format (14:42 or 2:42 pm)
@@ -1130,10 +1193,13 @@ void GuiMenu::openSystemSettings()
 
 #ifdef BATOCERA
 	// video device
-	std::vector<std::string> availableVideo = ApiSystem::getInstance()->getAvailableVideoOutputDevices();
-	if (availableVideo.size())
+	s->addDeferredWithLabel(_("VIDEO OUTPUT"), [window, s]() -> std::shared_ptr<GuiComponent>
 	{
-		auto optionsVideo = std::make_shared<OptionListComponent<std::string> >(mWindow, _("VIDEO OUTPUT"), false);
+		std::vector<std::string> availableVideo = ApiSystem::getInstance()->getAvailableVideoOutputDevices();
+		if (availableVideo.size() == 0)
+			return nullptr;
+
+		auto optionsVideo = std::make_shared<OptionListComponent<std::string> >(window, _("VIDEO OUTPUT"), false);
 		std::string currentDevice = SystemConf::getInstance()->get("global.videooutput");
 		if (currentDevice.empty()) currentDevice = "auto";
 
@@ -1148,8 +1214,7 @@ void GuiMenu::openSystemSettings()
 		if (!vfound)
 			optionsVideo->add(currentDevice, currentDevice, true);
 
-		s->addWithLabel(_("VIDEO OUTPUT"), optionsVideo);
-		s->addSaveFunc([this, optionsVideo, currentDevice, s] 
+		s->addSaveFunc([optionsVideo, s] 
 		{
 			if (optionsVideo->changed()) 
 			{
@@ -1158,16 +1223,21 @@ void GuiMenu::openSystemSettings()
 				s->setVariable("exitreboot", true);
 			}
 		});
-	}
+
+		return optionsVideo;
+	});
 #endif
 
 	if (ApiSystem::getInstance()->isScriptingSupported(ApiSystem::AUDIODEVICE))
 	{
-		std::vector<std::string> availableAudio = ApiSystem::getInstance()->getAvailableAudioOutputDevices();
-		if (availableAudio.size())
+		// audio device
+		s->addDeferredWithLabel(_("AUDIO OUTPUT"), [window, s]() -> std::shared_ptr<GuiComponent>
 		{
-			// audio device
-			auto optionsAudio = std::make_shared<OptionListComponent<std::string> >(mWindow, _("AUDIO OUTPUT"), false);
+			std::vector<std::string> availableAudio = ApiSystem::getInstance()->getAvailableAudioOutputDevices();
+			if (availableAudio.size() == 0)
+				return nullptr;
+
+			auto optionsAudio = std::make_shared<OptionListComponent<std::string> >(window, _("AUDIO OUTPUT"), false);
 
 			std::string selectedAudio = ApiSystem::getInstance()->getCurrentAudioOutputDevice();
 			if (selectedAudio.empty())
@@ -1199,9 +1269,7 @@ void GuiMenu::openSystemSettings()
 			if (!afound)
 				optionsAudio->add(selectedAudio, selectedAudio, true);
 
-			s->addWithLabel(_("AUDIO OUTPUT"), optionsAudio);
-
-			s->addSaveFunc([this, optionsAudio, selectedAudio]
+			s->addSaveFunc([optionsAudio]
 			{
 				if (optionsAudio->changed())
 				{
@@ -1210,13 +1278,18 @@ void GuiMenu::openSystemSettings()
 				}
 				SystemConf::getInstance()->saveSystemConf();
 			});
-		}
+
+			return optionsAudio;
+		});
 
 		// audio profile
-		std::vector<std::string> availableAudioProfiles = ApiSystem::getInstance()->getAvailableAudioOutputProfiles();
-		if (availableAudioProfiles.size())
+		s->addDeferredWithLabel(_("AUDIO PROFILE"), [window, s]() -> std::shared_ptr<GuiComponent>
 		{
-			auto optionsAudioProfile = std::make_shared<OptionListComponent<std::string> >(mWindow, _("AUDIO PROFILE"), false);
+			std::vector<std::string> availableAudioProfiles = ApiSystem::getInstance()->getAvailableAudioOutputProfiles();
+			if (availableAudioProfiles.size() == 0)
+				return nullptr;
+
+			auto optionsAudioProfile = std::make_shared<OptionListComponent<std::string> >(window, _("AUDIO PROFILE"), false);
 
 			std::string selectedAudioProfile = ApiSystem::getInstance()->getCurrentAudioOutputProfile();
 			if (selectedAudioProfile.empty())
@@ -1248,9 +1321,7 @@ void GuiMenu::openSystemSettings()
 			if (afound == false)
 				optionsAudioProfile->add(selectedAudioProfile, selectedAudioProfile, true);
 
-			s->addWithDescription(_("AUDIO PROFILE"), _("Available options can change depending on current audio output."), optionsAudioProfile);
-
-			s->addSaveFunc([this, optionsAudioProfile, selectedAudioProfile]
+			s->addSaveFunc([optionsAudioProfile]
 			{
 				if (optionsAudioProfile->changed()) {
 					SystemConf::getInstance()->set("audio.profile", optionsAudioProfile->getSelected());
@@ -1258,7 +1329,9 @@ void GuiMenu::openSystemSettings()
 				}
 				SystemConf::getInstance()->saveSystemConf();
 			});
-		}
+
+			return optionsAudioProfile;
+		}, _("Available options can change depending on current audio output."));
 	}
 
 #ifdef BATOCERA
@@ -17,9 +17,28 @@
 #include "guis/GuiSettings.h"
 #include "guis/GuiTextEditPopup.h"
 #include "guis/GuiTextEditPopupKeyboard.h"
+#include "ApiSystem.h"
+#include "TaskScheduler.h"
 
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/pointer.h>
+#include <chrono>
+
+#ifdef WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define LATENCY_TIMEOUT_MS	2000
 
 #define WINDOW_WIDTH (float)Math::min(Renderer::getScreenHeight() * 1.125f, Renderer::getScreenWidth() * 0.90f)
 
@@ -235,11 +254,21 @@ void GuiNetPlay::onSizeChanged()
 	mHeaderGrid->setRowHeightPerc(3, subtitleHeight / mHeaderGrid->getSize().y());
 }
 
+GuiNetPlay::~GuiNetPlay()
+{
+	Window::cancelPostedFunctions(mProbeToken);
+}
+
 void GuiNetPlay::startRequest()
 {
 	if (mLobbyRequest != nullptr)
 		return;
 
+	// The probes of the previous list
+	Window::cancelPostedFunctions(mProbeToken);
+	mProbeToken = nullptr;
+	mLobbyEntries.clear();
+
 	mList->clear();
 
 	std::string netPlayLobby = SystemConf::getInstance()->get("global.netplay.lobby");
@@ -290,16 +319,53 @@ std::vector<HelpPrompt> GuiNetPlay::getHelpPrompts()
 }
 
 
+static std::string normalizeName(const std::string& name)
+{
+	auto ret = Utils::String::toLower(name);
+	ret = Utils::String::replace(ret, "_", " ");
+	ret = Utils::String::replace(ret, ".", "");
+	ret = Utils::String::replace(ret, "'", "");
+	return Utils::String::removeParenthesis(ret);
+}
+
+// Once per lobby list : the entries are then matched without walking the games
+void GuiNetPlay::buildGameIndex()
+{
+	mGamesByCrc.clear();
+	mGamesByName.clear();
+
+	for (auto sys : SystemData::sSystemVector)
+	{
+		if (!sys->isNetplaySupported())
+			continue;
+
+		SystemGames games;
+		games.system = sys;
+
+		// emplace keeps the first game, like the scan in order did
+		for (auto file : sys->getRootFolder()->getFilesRecursive(GAME))
+		{
+			auto crc = file->getMetadata(MetaDataId::Crc32);
+			if (!crc.empty())
+				mGamesByCrc.emplace(crc, file);
+
+			std::string name = normalizeName(file->getName());
+			games.names.emplace(name, file);
+			games.names.emplace(normalizeName(Utils::FileSystem::getStem(file->getPath())), file);
+			games.compactNames.emplace(Utils::String::replace(name, " ", ""), file);
+		}
+
+		mGamesByName.push_back(games);
+	}
+}
+
 FileData* GuiNetPlay::getFileData(std::string gameInfo, bool crc, std::string coreName)
 {
-	auto normalizeName = [](const std::string name)
+	if (crc)
 	{
-		auto ret = Utils::String::toLower(name);
-		ret = Utils::String::replace(ret, "_", " ");
-		ret = Utils::String::replace(ret, ".", "");
-		ret = Utils::String::replace(ret, "'", "");
-		return Utils::String::removeParenthesis(ret);
-	};
+		auto it = mGamesByCrc.find(gameInfo);
+		return it == mGamesByCrc.cend() ? nullptr : it->second;
+	}
 
 	std::string lowCore;
 
@@ -310,48 +376,27 @@ FileData* GuiNetPlay::getFileData(std::string gameInfo, bool crc, std::string co
 		lowCore = Utils::String::toLower(Utils::String::replace(coreName, " ", "_"));
 	
 	std::string normalizedName = normalizeName(gameInfo);
-	for (auto sys : SystemData::sSystemVector)
-	{
-		if (!sys->isNetplaySupported())
-			continue;
-
-		if (!crc)
-		{
-			bool coreExists = false;
+	std::string compactName = Utils::String::replace(normalizedName, " ", "");
 
-			for (auto& emul : sys->getEmulators())
-				for (auto& core : emul.cores)
-					if (Utils::String::toLower(core.name) == lowCore)
-						coreExists = true;
+	for (auto& games : mGamesByName)
+	{
+		bool coreExists = false;
 
-			if (!coreExists)
-				continue;
-		}
+		for (auto& emul : games.system->getEmulators())
+			for (auto& core : emul.cores)
+				if (Utils::String::toLower(core.name) == lowCore)
+					coreExists = true;
 
-		for (auto file : sys->getRootFolder()->getFilesRecursive(GAME))
-		{
-			if (crc)
-			{
-				if (file->getMetadata(MetaDataId::Crc32) == gameInfo)
-					return file;
-
-				continue;
-			}
-			else
-			{
-				std::string stem = normalizeName(file->getName());
-				if (stem == normalizedName)
-					return file;
+		if (!coreExists)
+			continue;
 
-				stem = normalizeName(Utils::FileSystem::getStem(file->getPath()));
-				if (stem == normalizedName)
-					return file;
+		auto it = games.names.find(normalizedName);
+		if (it != games.names.cend())
+			return it->second;
 
-				stem = Utils::String::replace(normalizeName(file->getName()), " ", "");
-				if (stem == Utils::String::replace(normalizedName, " ", ""))
-					return file;
-			}
-		}
+		it = games.compactNames.find(compactName);
+		if (it != games.compactNames.cend())
+			return it->second;
 	}
 
 	return nullptr;
@@ -383,30 +428,10 @@ public:
 		mText->setLineSpacing(1.5);
 		mText->setVerticalAlignment(ALIGN_TOP);
 
-		std::string userInfo = _U("\uf007  ") + entry.username + _U("  \uf0AC  ") + entry.country + _U("  \uf0E8  ") + entry.ip+ _U("  \uf108  ") + entry.frontend;
-
-		mSubstring = std::make_shared<TextComponent>(mWindow, userInfo.c_str(), theme->TextSmall.font, theme->Text.color);
+		mSubstring = std::make_shared<TextComponent>(mWindow, getUserInfo().c_str(), theme->TextSmall.font, theme->Text.color);
 		mSubstring->setOpacity(192);
 
-		std::string subInfo = _U("\uf11B  ") + entry.core_name + " (" + entry.retroarch_version + ")";
-
-		if (entry.fileData != nullptr)
-		{
-			if (!entry.isCrcValid)
-			{
-				if (entry.game_crc == "00000000")
-					subInfo = subInfo + "   " + _U("\uf059  ") + _("UNKNOWN ROM VERSION");
-				else
-					subInfo = subInfo + "   " + _U("\uf05E  ") + _("DIFFERENT ROM");
-			}
-			else
-				subInfo = subInfo + "  " + _U("\uf058  ") + _("SAME ROM");
-		}
-
-		if (entry.fileData != nullptr && !entry.coreExists)
-			subInfo = subInfo + "   " + _U("\uf071  ") + _("UNAVAILABLE CORE");
-		
-		mDetails = std::make_shared<TextComponent>(mWindow, subInfo.c_str(), theme->TextSmall.font, theme->Text.color);
+		mDetails = std::make_shared<TextComponent>(mWindow, getDetails().c_str(), theme->TextSmall.font, theme->Text.color);
 		mDetails->setOpacity(192);
 		
 		if (entry.has_password || entry.has_spectate_password)
@@ -463,6 +488,20 @@ public:
 		return mEntry;
 	}
 
+	// The probes completed
+	void setCrcValid(bool valid)
+	{
+		mEntry.isCrcPending = false;
+		mEntry.isCrcValid = valid;
+		mDetails->setText(getDetails());
+	}
+
+	void setLatency(int latency)
+	{
+		mEntry.latency = latency;
+		mSubstring->setText(getUserInfo());
+	}
+
 	virtual void setColor(unsigned int color)
 	{
 		mText->setColor(color);
@@ -474,6 +513,39 @@ public:
 	}
 
 private:
+	std::string getUserInfo()
+	{
+		std::string userInfo = _U("\uf007  ") + mEntry.username + _U("  \uf0AC  ") + mEntry.country + _U("  \uf0E8  ") + mEntry.ip+ _U("  \uf108  ") + mEntry.frontend;
+
+		if (mEntry.latency >= 0)
+			userInfo = userInfo + _U("  \uf1EB  ") + std::to_string(mEntry.latency) + " ms";
+
+		return userInfo;
+	}
+
+	std::string getDetails()
+	{
+		std::string subInfo = _U("\uf11B  ") + mEntry.core_name + " (" + mEntry.retroarch_version + ")";
+
+		if (mEntry.fileData != nullptr && !mEntry.isCrcPending)
+		{
+			if (!mEntry.isCrcValid)
+			{
+				if (mEntry.game_crc == "00000000")
+					subInfo = subInfo + "   " + _U("\uf059  ") + _("UNKNOWN ROM VERSION");
+				else
+					subInfo = subInfo + "   " + _U("\uf05E  ") + _("DIFFERENT ROM");
+			}
+			else
+				subInfo = subInfo + "  " + _U("\uf058  ") + _("SAME ROM");
+		}
+
+		if (mEntry.fileData != nullptr && !mEntry.coreExists)
+			subInfo = subInfo + "   " + _U("\uf071  ") + _("UNAVAILABLE CORE");
+
+		return subInfo;
+	}
+
 	std::shared_ptr<ImageComponent>  mImage;
 
 	std::shared_ptr<TextComponent>  mText;
@@ -499,6 +571,8 @@ bool GuiNetPlay::populateFromJson(const std::string json)
 
 	std::vector<LobbyAppEntry> entries;
 
+	buildGameIndex();
+
 	for (auto& item : doc.GetArray())
 	{
 		if (!item.HasMember("fields"))
@@ -510,6 +584,8 @@ bool GuiNetPlay::populateFromJson(const std::string json)
 
 		LobbyAppEntry game;	
 		game.isCrcValid = false;
+		game.isCrcPending = false;
+		game.latency = -1;
 
 		if (fields.HasMember("core_name") && fields["core_name"].IsString())
 			game.core_name = fields["core_name"].GetString();
@@ -519,11 +595,12 @@ bool GuiNetPlay::populateFromJson(const std::string json)
 		if (fields.HasMember("game_crc") && fields["game_crc"].IsString() && fields["game_crc"] != "00000000")
 			file = getFileData(Utils::String::toUpper(fields["game_crc"].GetString()), true, game.core_name);
 
+		// Found by name : the crc is compared once computed, by probeEntry
 		if (file == nullptr && fields.HasMember("game_name") && fields["game_name"].IsString())
 		{
 			file = getFileData(fields["game_name"].GetString(), false, game.core_name);
-			if (file != nullptr)
-				file->checkCrc32();
+			if (file != nullptr && file->getMetadata(MetaDataId::Crc32).empty())
+				game.isCrcPending = true;
 		}
 
 		game.fileData = file;
@@ -624,8 +701,11 @@ bool GuiNetPlay::populateFromJson(const std::string json)
 			groupAvailable = true;
 		}
 		
+		auto lobbyEntry = std::make_shared<NetPlayLobbyListEntry>(mWindow, game);
+		mLobbyEntries.push_back(lobbyEntry);
+
 		ComponentListRow row;
-		row.addElement(std::make_shared<NetPlayLobbyListEntry>(mWindow, game), true);
+		row.addElement(lobbyEntry, true);
 
 		if (game.fileData != nullptr)
 			row.makeAcceptInputHandler([this, game] { launchGame(game); });
@@ -648,8 +728,11 @@ bool GuiNetPlay::populateFromJson(const std::string json)
 				groupUnavailable = true;
 			}
 
+			auto lobbyEntry = std::make_shared<NetPlayLobbyListEntry>(mWindow, game);
+			mLobbyEntries.push_back(lobbyEntry);
+
 			ComponentListRow row;
-			row.addElement(std::make_shared<NetPlayLobbyListEntry>(mWindow, game), true);
+			row.addElement(lobbyEntry, true);
 			mList->addRow(row);
 		}
 	}
@@ -667,9 +750,126 @@ bool GuiNetPlay::populateFromJson(const std::string json)
 	else
 		mList->setCursorIndex(0, true);
 
+	mProbeToken = Window::createPostedFunctionToken();
+
+	for (int i = 0; i < (int)mLobbyEntries.size(); i++)
+		probeEntry(i);
+
 	return true;
 }
 
+// TCP connection time to the host in ms, -1 when it can't be reached within the timeout
+static int probeLatency(const std::string& host, int port, int timeoutMs)
+{
+	if (host.empty() || port <= 0)
+		return -1;
+
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	addrinfo* addresses = nullptr;
+	if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0 || addresses == nullptr)
+		return -1;
+
+	int latency = -1;
+
+#ifdef WIN32
+	SOCKET sock = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+	bool opened = sock != INVALID_SOCKET;
+	u_long nonBlocking = 1;
+	if (opened)
+		ioctlsocket(sock, FIONBIO, &nonBlocking);
+#else
+	int sock = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+	bool opened = sock >= 0;
+	if (opened)
+		fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+	if (opened)
+	{
+		auto start = std::chrono::steady_clock::now();
+		connect(sock, addresses->ai_addr, (int)addresses->ai_addrlen);
+
+		fd_set writeSet;
+		FD_ZERO(&writeSet);
+		FD_SET(sock, &writeSet);
+
+		timeval timeout;
+		timeout.tv_sec = timeoutMs / 1000;
+		timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+		if (select((int)sock + 1, nullptr, &writeSet, nullptr, &timeout) > 0)
+		{
+			int error = 0;
+			socklen_t length = sizeof(error);
+			getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)&error, &length);
+
+			if (error == 0)
+				latency = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		}
+
+#ifdef WIN32
+		closesocket(sock);
+#else
+		close(sock);
+#endif
+	}
+
+	freeaddrinfo(addresses);
+	return latency;
+}
+
+void GuiNetPlay::probeEntry(int index)
+{
+	auto token = mProbeToken;
+	Window* window = mWindow;
+
+	auto& entry = mLobbyEntries[index]->getEntry();
+
+	if (entry.isCrcPending)
+	{
+		FileData* file = entry.fileData;
+		std::string path = file->getPath();
+		bool fromArchive = file->getSystem() != nullptr && file->getSystem()->shouldExtractHashesFromArchives();
+
+		// Through the hash cache : a rom is only read once
+		TaskScheduler::submit(TaskScheduler::BACKGROUND, [this, window, token, index, file, path, fromArchive]
+		{
+			if (*token)
+				return;
+
+			ApiSystem::getInstance()->getCRC32(path, fromArchive);
+
+			window->postToUiThread([this, index, file]
+			{
+				// Cached now
+				file->checkCrc32();
+
+				auto& lobbyEntry = mLobbyEntries[index];
+				lobbyEntry->setCrcValid(lobbyEntry->getEntry().game_crc == file->getMetadata(MetaDataId::Crc32));
+			}, token);
+		});
+	}
+
+	std::string host = entry.host_method == 3 ? entry.mitm_ip : entry.ip;
+	int port = entry.host_method == 3 ? entry.mitm_port : entry.port;
+
+	TaskScheduler::submit(TaskScheduler::NETWORK, [this, window, token, index, host, port]
+	{
+		if (*token)
+			return;
+
+		int latency = probeLatency(host, port, LATENCY_TIMEOUT_MS);
+		if (latency < 0)
+			return;
+
+		window->postToUiThread([this, index, latency] { mLobbyEntries[index]->setLatency(latency); }, token);
+	});
+}
+
 void GuiNetPlay::render(const Transform4x4f &parentTrans) 
 {
 	GuiComponent::render(parentTrans);
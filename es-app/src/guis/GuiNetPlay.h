@@ -6,11 +6,15 @@
 #include "components/BusyComponent.h"
 #include "components/NinePatchComponent.h"
 #include "components/TextComponent.h"
+#include "Window.h"
 #include <memory>
+#include <unordered_map>
 #include <unordered_set>
 
 class HttpReq;
 class FileData;
+class SystemData;
+class NetPlayLobbyListEntry;
 
 struct LobbyAppEntry
 {
@@ -37,7 +41,9 @@ struct LobbyAppEntry
 	int         port;
 
 	bool		isCrcValid;
+	bool		isCrcPending; // The crc of the local game is being computed
 	bool		coreExists;
+	int			latency; // ms, -1 until probed or when unreachable
 };
 
 
@@ -45,6 +51,7 @@ class GuiNetPlay : public GuiComponent
 {
 public:
 	GuiNetPlay(Window *window);
+	~GuiNetPlay();
 
 	void update(int deltaTime) override;
 	void render(const Transform4x4f &parentTrans) override;
@@ -63,6 +70,24 @@ private:
 	FileData* getFileData(const std::string gameInfo, bool crc = true, std::string coreName = "");
 	bool coreExists(FileData* file, std::string core_name);
 
+	void buildGameIndex();
+	// Crc of the local game & latency of the host, on the workers : the rows fill in as they complete
+	void probeEntry(int index);
+
+	// The games of a netplay system by normalized name, with & without spaces
+	struct SystemGames
+	{
+		SystemData* system;
+		std::unordered_map<std::string, FileData*> names;
+		std::unordered_map<std::string, FileData*> compactNames;
+	};
+
+	std::unordered_map<std::string, FileData*>	mGamesByCrc;
+	std::vector<SystemGames>					mGamesByName;
+
+	std::vector<std::shared_ptr<NetPlayLobbyListEntry>> mLobbyEntries;
+	Window::PostedFunctionToken	mProbeToken; // Cancelled by a refresh, or when closed
+
 	NinePatchComponent				mBackground;
 	ComponentGrid					mGrid;
 
@@ -1,6 +1,7 @@
 #include "guis/GuiInstall.h"
 #include "guis/GuiMsgBox.h"
 #include "guis/GuiRetroAchievements.h"
+#include "HttpReq.h"
 #include "guis/GuiSettings.h"
 #include "components/WebImageComponent.h"
 #include "Window.h"
@@ -23,6 +24,9 @@
 
 void GuiRetroAchievements::show(Window* window)
 {
+	// The summary & the badges
+	HttpReq::preconnect({ "https://retroachievements.org/", "http://i.retroachievements.org/" });
+
 	window->pushGui(new GuiLoading<RetroAchievementInfo>(window, _("PLEASE WAIT"), 
 		[window](auto gui)
 		{
@@ -233,7 +233,7 @@ bool GuiSaveState::input(InputConfig* config, Input input)
 					toDelete.saveState->remove();
 
 					SaveStateRepository::renumberSlots(mGame, conf);
-					mRepository->refresh();
+					mRepository->refresh(mGame);
 
 					loadGrid();
 				}, 
@@ -254,7 +254,7 @@ bool GuiSaveState::input(InputConfig* config, Input input)
 			{				
 				if (toCopy.saveState->copyToSlot(slot))
 				{
-					mRepository->refresh();
+					mRepository->refresh(mGame);
 					loadGrid();
 				}
 			}
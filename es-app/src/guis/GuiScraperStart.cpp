@@ -6,6 +6,7 @@
 #include "FileData.h"
 #include "SystemData.h"
 #include "scrapers/ThreadedScraper.h"
+#include "HttpReq.h"
 #include "LocaleES.h"
 #include "GuiLoading.h"
 #include "GuiScraperSettings.h"
@@ -18,6 +19,10 @@ GuiScraperStart::GuiScraperStart(Window* window)
 
 	std::string scraperName = Settings::getInstance()->getString("Scraper");
 
+	auto currentScraper = Scraper::getScraper(scraperName);
+	if (currentScraper != nullptr)
+		HttpReq::preconnect(currentScraper->getPreconnectUrls());
+
 	// scrape from
 	auto scraper_list = std::make_shared< OptionListComponent< std::string > >(mWindow, _("SCRAPING DATABASE"), false);
 
@@ -52,10 +57,10 @@ GuiScraperStart::GuiScraperStart(Window* window)
 	auto isOlderThan = [now](const std::string& scraper, FileData* f, int days)
 	{
 		auto date = f->getMetadata().getScrapeDate(scraper);
-		if (date == nullptr || !date->isValid())
+		if (!date.isValid())
 			return true;
 
-		return date->getTime() <= (now - (days * 86400));
+		return date.getTime() <= (now - (days * 86400));
 	};
 
 //	int idx = Settings::RecentlyScrappedFilter();
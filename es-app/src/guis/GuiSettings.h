@@ -46,6 +46,12 @@ public:
 		mMenu.addWithDescription(label, description, comp, func, iconName, setCursorHere, multiLine); 
 	}
 
+	// The component, its values & its save function are created once the row is scrolled into view or selected
+	inline void addDeferredWithLabel(const std::string& label, const std::function<std::shared_ptr<GuiComponent>()>& create, const std::string& description = "")
+	{
+		mMenu.addDeferredWithLabel(label, create, description);
+	}
+
 	inline void addSaveFunc(const std::function<void()>& func) 
 	{ 
 		mSaveFuncs.push_back(func); 
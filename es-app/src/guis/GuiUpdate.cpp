@@ -3,6 +3,7 @@
 #include "Window.h"
 #include <string>
 #include "Log.h"
+#include "TaskScheduler.h"
 #include "Settings.h"
 #include "ApiSystem.h"
 #include "utils/Platform.h"
@@ -34,6 +35,8 @@ public:
 
 	void threadUpdate()
 	{
+		TaskScheduler::setCurrentThreadPriority(TaskScheduler::NETWORK);
+
 		std::pair<std::string, int> updateStatus = ApiSystem::getInstance()->updateSystem([this](const std::string info)
 		{
 			auto pos = info.find(">>>");
@@ -107,6 +110,8 @@ GuiUpdate::~GuiUpdate()
 
 void GuiUpdate::threadPing()
 {	
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::NETWORK);
+
 	if (ApiSystem::getInstance()->ping())
 	{
 		std::vector<std::string> msgtbl;
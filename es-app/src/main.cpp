@@ -14,8 +14,20 @@
 #include "Genres.h"
 #include "utils/Platform.h"
 #include "PowerSaver.h"
+#include "FrameScheduler.h"
+#include "InputLatency.h"
+#include "WakeScheduler.h"
+#include "TaskScheduler.h"
+#include "StartupTasks.h"
+#include "ConfigWriter.h"
 #include "Settings.h"
 #include "SystemData.h"
+#include "GamelistWriter.h"
+#include "RomFolderWatcher.h"
+#include "Trace.h"
+#include "Benchmark.h"
+#include "RenderBenchmark.h"
+#include "InputRecorder.h"
 #include "SystemScreenSaver.h"
 #include <SDL_events.h>
 #include <SDL_main.h>
@@ -26,19 +38,27 @@
 #include <SystemConf.h>
 #include "ApiSystem.h"
 #include "AudioManager.h"
+#include "SoundBank.h"
 #include "NetworkThread.h"
 #include "scrapers/ThreadedScraper.h"
 #include "ThreadedHasher.h"
+#include "HashCache.h"
+#include "SharedCatalog.h"
 #include <FreeImage.h>
 #include "ImageIO.h"
 #include "components/VideoVlcComponent.h"
+#include "VideoHardwareDecode.h"
 #include <csignal>
 #include "InputConfig.h"
 #include "RetroAchievements.h"
 #include "TextToSpeech.h"
 #include "Paths.h"
+#include "resources/Font.h"
 #include "resources/TextureData.h"
+#include "resources/VideoPosterCache.h"
 #include "Scripting.h"
+#include "MemoryStats.h"
+#include "MemoryProfile.h"
 
 #ifdef WIN32
 #include <Windows.h>
@@ -49,6 +69,15 @@
 static std::string gPlayVideo;
 static int gPlayVideoDuration = 0;
 static bool enable_startup_game = true;
+static bool gStartupTrace = false;
+static std::string gBenchmarkSizes;
+static std::string gBenchmarkOutput;
+static bool gRenderBenchmark = false;
+static std::string gRenderBenchmarkScript;
+static std::string gRenderBenchmarkOutput;
+static std::string gReplayInputs;
+static bool gRecordInputs = false;
+static std::string gRecordInputsPath;
 
 bool parseArgs(int argc, char* argv[])
 {
@@ -217,6 +246,48 @@ bool parseArgs(int argc, char* argv[])
 		{
 			Settings::getInstance()->setBool("ForceDisableFilters", true);
 		}
+		else if (strcmp(argv[i], "--trace") == 0)
+		{
+			gStartupTrace = true;
+		}
+		else if (strcmp(argv[i], "--benchmark") == 0)
+		{
+			gBenchmarkSizes = "1000,10000,50000";
+			enable_startup_game = false;
+
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				gBenchmarkSizes = argv[++i];
+
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				gBenchmarkOutput = argv[++i];
+		}
+		else if (strcmp(argv[i], "--render-benchmark") == 0)
+		{
+			gRenderBenchmark = true;
+			enable_startup_game = false;
+
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				gRenderBenchmarkScript = argv[++i];
+
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				gRenderBenchmarkOutput = argv[++i];
+		}
+		else if (strcmp(argv[i], "--record") == 0)
+		{
+			gRecordInputs = true;
+
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				gRecordInputsPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			gRenderBenchmark = true;
+			gReplayInputs = argv[++i];
+			enable_startup_game = false;
+
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				gRenderBenchmarkOutput = argv[++i];
+		}
 		else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
 		{
 #ifdef WIN32
@@ -245,6 +316,11 @@ bool parseArgs(int argc, char* argv[])
 				"--force-kid		Force the UI mode to be Kid\n"
 				"--force-kiosk		Force the UI mode to be Kiosk\n"
 				"--force-disable-filters		Force the UI to ignore applied filters in gamelist\n"
+				"--trace			write a Chrome trace of the startup to es_trace.json\n"
+				"--benchmark [sizes] [file]	time the catalog operations on synthetic games ( 1000,10000,50000 ), write the results to es_benchmark.json or [file]\n"
+				"--render-benchmark [script] [file]	play an input script, write the frame times & draw calls of each view to es_render_benchmark.json or [file]\n"
+				"--record [file]			record the inputs with their timing to es_inputs.rec or [file]\n"
+				"--replay [recording] [file]	replay recorded inputs at a fixed timestep, write the results like --render-benchmark\n"
 				"--home [path]		Directory to use as home path\n"
 				"--help, -h			summon a sentient, angry tuba\n\n"
 				"--monitor [index]			monitor index\n\n"				
@@ -281,7 +357,8 @@ bool loadSystemConfigFile(Window* window, const char** errorString)
 
 	StopWatch stopWatch("loadSystemConfigFile :", LogDebug);
 
-	ImageIO::loadImageCache();
+	StartupTasks::wait("imagecache");
+	StartupTasks::wait("mamenames");
 
 	if(!SystemData::loadConfig(window))
 	{
@@ -307,6 +384,7 @@ bool loadSystemConfigFile(Window* window, const char** errorString)
 //called on exit, assuming we get far enough to have the log initialized
 void onExit()
 {
+	Trace::stop();
 	Log::close();
 }
 
@@ -421,6 +499,25 @@ void playVideo()
 	window.deinit(true);
 }
 
+// A game video of the collection, for the decoders benchmark
+static std::string findBenchmarkVideo()
+{
+	for (auto system : SystemData::sSystemVector)
+	{
+		if (!system->isGameSystem() || system->isCollection())
+			continue;
+
+		for (auto game : system->getRootFolder()->getFilesRecursive(GAME))
+		{
+			std::string video = game->getVideoPath();
+			if (!video.empty() && Utils::FileSystem::exists(video))
+				return video;
+		}
+	}
+
+	return "";
+}
+
 void launchStartupGame()
 {
 	auto gamePath = SystemConf::getInstance()->get("global.bootgame.path");
@@ -503,14 +600,29 @@ int main(int argc, char* argv[])
 	//start the logger
 	Log::init();	
 
+	if (gStartupTrace || Settings::getInstance()->getBool("StartupTrace"))
+		Trace::start();
+
 	LOG(LogInfo) << "EmulationStation - v" << PROGRAM_VERSION_STRING << ", built " << PROGRAM_BUILT_STRING;
 
+	TaskScheduler::init();
+	MemoryProfile::init();
+
 	//always close the log on exit
 	atexit(&onExit);
 
-	// Set locale
+	// Set locale. setlocale is not safe while other threads run
 	setLocale(argv[0]);	
 
+	// Loaded before the steps read it
+	SystemConf* systemConf = SystemConf::getInstance();
+
+	// Off the main thread until the first use of their results. The renderer, SDL & the input stay on the main thread
+	ImageIO::setSharedImageCache(SharedCatalog::getSharedPath("imagecache.bin"));
+	StartupTasks::add("imagecache", { }, [] { ImageIO::loadImageCache(); });
+	StartupTasks::add("mamenames", { }, [] { MameNames::init(); });
+	StartupTasks::add("vlc", { }, [] { VideoVlcComponent::init(); }, TaskScheduler::BACKGROUND);
+
 #if !WIN32
 	if(enable_startup_game) {
 	  // Run boot game, before Window Create for linux
@@ -518,7 +630,8 @@ int main(int argc, char* argv[])
 	}
 #endif
 
-	Scripting::fireEvent("start");
+	if (gBenchmarkSizes.empty() && !gRenderBenchmark)
+		Scripting::fireEvent("start");
 
 	// metadata init
 	Genres::init();
@@ -528,7 +641,13 @@ int main(int argc, char* argv[])
 	SystemScreenSaver screensaver(&window);
 	ViewController::init(&window);
 	CollectionSystemManager::init(&window);
-	VideoVlcComponent::init();
+
+	// Headless : before the window initializes the renderer
+	if (!gBenchmarkSizes.empty())
+	{
+		StartupTasks::finish();
+		return Benchmark::run(gBenchmarkSizes, gBenchmarkOutput);
+	}
 
 	window.pushGui(ViewController::get());
 	if(!window.init(true, false))
@@ -551,9 +670,6 @@ int main(int argc, char* argv[])
 		window.renderSplashScreen(progressText);
 	}
 
-	MameNames::init();
-
-
 	const char* errorMsg = NULL;
 	if(!loadSystemConfigFile(splashScreen && splashScreenProgress ? &window : nullptr, &errorMsg))
 	{
@@ -568,8 +684,8 @@ int main(int argc, char* argv[])
 		// we can't handle es_systems.cfg file problems inside ES itself, so display the error message then quit
 		window.pushGui(new GuiMsgBox(&window, errorMsg, _("QUIT"), [] { Utils::Platform::quitES(); }));
 	}
-
-	SystemConf* systemConf = SystemConf::getInstance();
+	else if (SharedCatalog::isPublisher())
+		TaskScheduler::submit(TaskScheduler::BACKGROUND, [] { SharedCatalog::publish(); });
 
 #ifdef _ENABLE_KODI_
 	if (systemConf->getBool("kodi.enabled", true) && systemConf->getBool("kodi.atstartup"))
@@ -594,7 +710,10 @@ int main(int argc, char* argv[])
 
 	// preload what we can right away instead of waiting for the user to select it
 	// this makes for no delays when accessing content, but a longer startup time
+	StartupTasks::wait("vlc");
 	ViewController::get()->preload();
+	window.preloadMenuBackgroundShader();
+	Font::prewarmGlyphs(-1);
 
 	// Initialize input
 	InputConfig::AssignActionButtons();
@@ -610,14 +729,23 @@ int main(int argc, char* argv[])
 	if (errorMsg == NULL)
 		ViewController::get()->goToStart(true);
 
+	RomFolderWatcher::start(&window);
+
 	window.closeSplashScreen();
 
 	// Create a flag in  temporary directory to signal READY state
 	ApiSystem::getInstance()->setReadyFlag();
 
+	// Startup is done
+	StartupTasks::finish();
+	Trace::stop();
+
 	// Play music
 	AudioManager::getInstance()->init();
 
+	if (VideoHardwareDecode::needsBenchmark() && !gRenderBenchmark)
+		VideoVlcComponent::benchmarkDecoders(findBenchmarkVideo());
+
 	if (ViewController::get()->getState().viewing == ViewController::GAME_LIST || ViewController::get()->getState().viewing == ViewController::SYSTEM_SELECT)
 		AudioManager::getInstance()->changePlaylist(ViewController::get()->getState().getSystem()->getTheme());
 	else
@@ -642,11 +770,28 @@ int main(int argc, char* argv[])
 		timeLimit = 0;
 #endif
 
+	FrameScheduler::init();
+	InputLatency::init();
+
 	int lastTime = SDL_GetTicks();
 	int ps_time = SDL_GetTicks();
 
 	bool running = true;
 
+	// Scripted frames instead of the event loop, then the usual shutdown
+	int exitCode = 0;
+	if (gRenderBenchmark)
+	{
+		if (gReplayInputs.empty())
+			exitCode = RenderBenchmark::run(&window, gRenderBenchmarkScript, gRenderBenchmarkOutput);
+		else
+			exitCode = RenderBenchmark::replay(&window, gReplayInputs, gRenderBenchmarkOutput);
+
+		running = false;
+	}
+	else if (gRecordInputs)
+		InputRecorder::startRecording(gRecordInputsPath.empty() ? Paths::getUserEmulationStationPath() + "/es_inputs.rec" : gRecordInputsPath);
+
 	while(running)
 	{
 #ifdef WIN32	
@@ -656,7 +801,12 @@ int main(int argc, char* argv[])
 		SDL_Event event;
 
 		bool ps_standby = PowerSaver::getState() && (int) SDL_GetTicks() - ps_time > PowerSaver::getMode();
-		if(ps_standby ? SDL_WaitEventTimeout(&event, PowerSaver::getTimeout()) : SDL_PollEvent(&event))
+
+		// Nothing changed since the last frame : block until something happens instead of spinning on vsync
+		bool idle = !ps_standby && !window.isRenderNeeded();
+
+		// Idle : sleep until an event, or until the next frame something registered with the WakeScheduler
+		if (ps_standby ? SDL_WaitEventTimeout(&event, WakeScheduler::getTimeout(PowerSaver::getTimeout())) : idle ? Window::waitEvent(&event, window.getIdleTimeout()) : SDL_PollEvent(&event))
 		{
 			// PowerSaver can push events to exit SDL_WaitEventTimeout immediatly
 			// Reset this event's state
@@ -664,6 +814,10 @@ int main(int argc, char* argv[])
 
 			do
 			{
+				if (Window::isWakeUpEvent(event))
+					continue;
+
+				Window::invalidate();
 				TRYCATCH("InputManager::parseEvent", InputManager::getInstance()->parseEvent(event, &window));
 
 				if (event.type == SDL_QUIT)
@@ -674,6 +828,10 @@ int main(int argc, char* argv[])
 			// check guns
 			InputManager::getInstance()->updateGuns(&window);
 
+			// Input after idling or standby : render the next frame right away
+			if (idle || ps_standby)
+				FrameScheduler::wakeUp();
+
 			// triggered if exiting from SDL_WaitEvent due to event
 			if (ps_standby)
 				// show as if continuing from last event
@@ -707,7 +865,17 @@ int main(int argc, char* argv[])
 		if(deltaTime < 0)
 			deltaTime = 1000;
 
+		FrameScheduler::beginFrame();
+
 		TRYCATCH("Window.update" ,window.update(deltaTime))	
+
+		if (!window.isRenderNeeded())
+		{
+			FrameScheduler::skipFrame();
+			Log::flush();
+			continue;
+		}
+
 		TRYCATCH("Window.render", window.render())
 
 #ifdef WIN32		
@@ -720,7 +888,7 @@ int main(int argc, char* argv[])
 		}
 #endif
 
-		Renderer::swapBuffers();
+		FrameScheduler::present();
 
 		Log::flush();
 	}
@@ -728,15 +896,19 @@ int main(int argc, char* argv[])
 	if (Utils::Platform::isFastShutdown())
 		Settings::getInstance()->setBool("IgnoreGamelist", true);
 
+	InputRecorder::stopRecording();
+	RomFolderWatcher::stop();
 	ThreadedHasher::stop();
 	ThreadedScraper::stop();
+	VideoPosterCache::stop();
+	HashCache::save();
 
 	ApiSystem::getInstance()->deinit();
 
 	while(window.peekGui() != ViewController::get())
 		delete window.peekGui();
 
-	if (SystemData::hasDirtySystems())
+	if (SystemData::hasDirtySystems() || GamelistWriter::isBusy())
 		window.renderSplashScreen(_("SAVING METADATAS. PLEASE WAIT..."));
 
 	ImageIO::saveImageCache();
@@ -744,6 +916,9 @@ int main(int argc, char* argv[])
 	ViewController::saveState();
 	CollectionSystemManager::deinit();
 	SystemData::deleteSystems();
+	SharedCatalog::publish();
+	Utils::FileSystem::stopFileCacheWatch();
+	ConfigWriter::stop();
 
 	// call this ONLY when linking with FreeImage as a static library
 #ifdef FREEIMAGE_LIB
@@ -751,11 +926,15 @@ int main(int argc, char* argv[])
 #endif
 
 	window.deinit();
+	SoundBank::clear();
+	TaskScheduler::shutdown();
 
 	Utils::Platform::processQuitMode();
+	Scripting::stop();
 
+	LOG(LogInfo) << "Memory at exit : " << MemoryStats::getReport();
 	LOG(LogInfo) << "EmulationStation cleanly shutting down.";
 
-	return 0;
+	return exitCode;
 }
 
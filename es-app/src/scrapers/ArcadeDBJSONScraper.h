@@ -19,6 +19,8 @@ public:
 	bool isSupportedPlatform(SystemData* system) override;
 
 	const std::set<ScraperMediaSource>& getSupportedMedias() override;
+
+	std::vector<std::string> getPreconnectUrls() override { return { "http://adb.arcadeitalia.net/" }; }
 };
 
 class ArcadeDBJSONRequest : public ScraperHttpRequest
@@ -22,6 +22,8 @@ public:
 
 	bool isSupportedPlatform(SystemData* system) override;
 	const std::set<ScraperMediaSource>& getSupportedMedias() override;
+
+	std::vector<std::string> getPreconnectUrls() override { return { "https://api.thegamesdb.net/" }; }
 };
 
 class TheGamesDBJSONRequest : public ScraperHttpRequest
@@ -24,6 +24,8 @@ public:
 
 	const std::set<ScraperMediaSource>& getSupportedMedias() override;
 
+	std::vector<std::string> getPreconnectUrls() override { return { "https://db.hfsplay.fr/" }; }
+
 private:
 	std::string mToken;
 	Utils::Time::DateTime mTokenDate;
@@ -14,6 +14,9 @@
 #include <thread>
 #include <SDL_timer.h>
 #include "HfsDBScraper.h"
+#include "ImageIO.h"
+#include "TaskScheduler.h"
+#include <condition_variable>
 
 #define OVERQUOTA_RETRY_DELAY 15000
 #define OVERQUOTA_RETRY_COUNT 5
@@ -253,6 +256,8 @@ void ScraperSearchHandle::update()
 }
 
 // ScraperHttpRequest
+std::atomic<int> ScraperHttpRequest::sOverQuotaCount(0);
+
 ScraperHttpRequest::ScraperHttpRequest(std::vector<ScraperSearchResult>& resultsWrite, const std::string& url, HttpReqOptions* options)
 	: ScraperRequest(resultsWrite)
 {
@@ -261,11 +266,34 @@ ScraperHttpRequest::ScraperHttpRequest(std::vector<ScraperSearchResult>& results
 	if (options != nullptr)
 		mOptions = *options;
 
-	mRequest = new HttpReq(url, &mOptions);
 	mRetryCount = 0;
 	mOverQuotaPendingTime = 0;
 	mOverQuotaRetryDelay = OVERQUOTA_RETRY_DELAY;
 	mOverQuotaRetryCount = OVERQUOTA_RETRY_COUNT;
+	mHasCachedResponse = false;
+	mFromCache = false;
+
+	if (ScraperCache::isEnabled())
+	{
+		mCacheKey = ScraperCache::getKey(url, mOptions);
+		mHasCachedResponse = ScraperCache::load(mCacheKey, mCachedResponse);
+
+		if (mHasCachedResponse && ScraperCache::isFresh(mCachedResponse))
+		{
+			mFromCache = true;
+			mRequest = HttpReq::fromContent(url, mCachedResponse.content);
+			return;
+		}
+
+		// Outdated : only download it again if the server says it changed
+		if (mHasCachedResponse && !mCachedResponse.etag.empty())
+			mOptions.customHeaders.push_back("If-None-Match: " + mCachedResponse.etag);
+
+		if (mHasCachedResponse && !mCachedResponse.lastModified.empty())
+			mOptions.customHeaders.push_back("If-Modified-Since: " + mCachedResponse.lastModified);
+	}
+
+	mRequest = new HttpReq(url, &mOptions);
 }
 
 ScraperHttpRequest::~ScraperHttpRequest()
@@ -298,15 +326,29 @@ void ScraperHttpRequest::update()
 	if (status == HttpReq::REQ_IN_PROGRESS)
 		return;
 
+	if (status == HttpReq::REQ_304_NOTMODIFIED && mHasCachedResponse)
+	{
+		mCachedResponse.time = time(NULL);
+		ScraperCache::save(mCacheKey, mCachedResponse);
+
+		std::string url = mRequest->getUrl();
+		delete mRequest;
+
+		mFromCache = true;
+		mRequest = HttpReq::fromContent(url, mCachedResponse.content);
+		status = HttpReq::REQ_SUCCESS;
+	}
+
 	if(status == HttpReq::REQ_SUCCESS)
 	{
-		setStatus(ASYNC_DONE); // if process() has an error, status will be changed to ASYNC_ERROR
-		process(mRequest, mResults);
+		processResponse();
 		return;
 	}
 
 	if (status == HttpReq::REQ_429_TOOMANYREQUESTS)
 	{
+		sOverQuotaCount++;
+
 		mRetryCount++;
 		if (mRetryCount >= mOverQuotaRetryCount)
 		{
@@ -354,6 +396,24 @@ void ScraperHttpRequest::update()
 	setError(Utils::String::removeHtmlTags(mRequest->getErrorMsg()));
 }
 
+void ScraperHttpRequest::processResponse()
+{
+	setStatus(ASYNC_DONE); // if process() has an error, status will be changed to ASYNC_ERROR
+	process(mRequest, mResults);
+
+	if (mFromCache || mCacheKey.empty() || mStatus == ASYNC_ERROR)
+		return;
+
+	ScraperCache::Response response;
+	response.time = time(NULL);
+	response.content = mRequest->getContent();
+	response.etag = ScraperCache::getResponseHeader(mRequest, "ETag");
+	response.lastModified = ScraperCache::getResponseHeader(mRequest, "Last-Modified");
+
+	if (!response.content.empty())
+		ScraperCache::save(mCacheKey, response);
+}
+
 std::unique_ptr<MDResolveHandle> ScraperSearchResult::resolveMetaDataAssets(const ScraperSearchParams& search)
 {
 	return std::unique_ptr<MDResolveHandle>(new MDResolveHandle(*this, search));
@@ -490,37 +550,109 @@ std::unique_ptr<ImageDownloadHandle> MDResolveHandle::downloadImageAsync(const s
 		resize ? Settings::getInstance()->getInt("ScraperResizeHeight") : 0));
 }
 
+std::mutex MediaDownloadSlots::mLock;
+std::map<std::string, int> MediaDownloadSlots::mHosts;
+int MediaDownloadSlots::mActiveCount = 0;
+
+std::string MediaDownloadSlots::getHost(const std::string& url)
+{
+	size_t start = url.find("://");
+	start = (start == std::string::npos ? 0 : start + 3);
+
+	size_t end = url.find_first_of("/?#", start);
+	return Utils::String::toLower(url.substr(start, end == std::string::npos ? std::string::npos : end - start));
+}
+
+bool MediaDownloadSlots::acquire(const std::string& host)
+{
+	int maxPerHost = Settings::getInstance()->getInt("ScraperMediaPerHost");
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	int& count = mHosts[host];
+	if (maxPerHost > 0 && count >= maxPerHost)
+		return false;
+
+	count++;
+	mActiveCount++;
+	return true;
+}
+
+void MediaDownloadSlots::release(const std::string& host)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mHosts.find(host);
+	if (it == mHosts.cend())
+		return;
+
+	if (--it->second <= 0)
+		mHosts.erase(it);
+
+	mActiveCount--;
+}
+
+long long MediaDownloadSlots::getMaxRecvSpeed()
+{
+	long long bandwidth = (long long)Settings::getInstance()->getInt("ScraperMediaBandwidth") * 1024;
+	if (bandwidth <= 0)
+		return 0;
+
+	std::unique_lock<std::mutex> lock(mLock);
+	return bandwidth / (mActiveCount > 1 ? mActiveCount : 1);
+}
+
 ImageDownloadHandle::ImageDownloadHandle(const std::string& url, const std::string& path, int maxWidth, int maxHeight) : 
-	mSavePath(path), mMaxWidth(maxWidth), mMaxHeight(maxHeight)
+	mRequest(nullptr), mHasSlot(false), mSavePath(path), mMaxWidth(maxWidth), mMaxHeight(maxHeight)
 {
 	mRetryCount = 0;
 	mOverQuotaPendingTime = 0;
 	mOverQuotaRetryDelay = OVERQUOTA_RETRY_DELAY;
 	mOverQuotaRetryCount = OVERQUOTA_RETRY_COUNT;
 
+	mUrl = url;
+
 	if (url.find("screenscraper") != std::string::npos && (path.find(".jpg") != std::string::npos || path.find(".png") != std::string::npos) && url.find("media=map") == std::string::npos)
 	{
-		if (maxWidth > 0 && maxHeight > 0)
-			mRequest = new HttpReq(url + "&maxwidth=" + std::to_string(maxWidth), path);
-		else if (maxWidth > 0)
-			mRequest = new HttpReq(url + "&maxwidth=" + std::to_string(maxWidth), path);
+		if (maxWidth > 0)
+			mUrl = url + "&maxwidth=" + std::to_string(maxWidth);
 		else if (maxHeight > 0)
-			mRequest = new HttpReq(url + "&maxheight=" + std::to_string(maxHeight), path);
-		else 
-			mRequest = new HttpReq(url, path);
+			mUrl = url + "&maxheight=" + std::to_string(maxHeight);
 	}
-	else
-		mRequest = new HttpReq(url, path);
+
+	mHost = MediaDownloadSlots::getHost(mUrl);
+	startRequest();
+}
+
+bool ImageDownloadHandle::startRequest()
+{
+	if (!mHasSlot)
+	{
+		if (!MediaDownloadSlots::acquire(mHost))
+			return false;
+
+		mHasSlot = true;
+	}
+
+	HttpReqOptions options(mSavePath);
+	options.maxRecvSpeed = MediaDownloadSlots::getMaxRecvSpeed();
+
+	delete mRequest;
+	mRequest = new HttpReq(mUrl, &options);
+	return true;
 }
 
 ImageDownloadHandle::~ImageDownloadHandle()
 {
 	delete mRequest;
+
+	if (mHasSlot)
+		MediaDownloadSlots::release(mHost);
 }
 
 int ImageDownloadHandle::getPercent()
 {
-	if (mRequest->status() == HttpReq::REQ_IN_PROGRESS)
+	if (mRequest != nullptr && mRequest->status() == HttpReq::REQ_IN_PROGRESS)
 		return mRequest->getPercent();
 
 	return -1;
@@ -528,6 +660,18 @@ int ImageDownloadHandle::getPercent()
 
 void ImageDownloadHandle::update()
 {
+	if (mPostProcess != nullptr)
+	{
+		if (!mPostProcess->done)
+			return;
+
+		mSavePath = mPostProcess->path;
+		mPostProcess.reset();
+
+		setStatus(ASYNC_DONE);
+		return;
+	}
+
 	if (mOverQuotaPendingTime > 0)
 	{
 		int lastTime = SDL_GetTicks();
@@ -536,15 +680,15 @@ void ImageDownloadHandle::update()
 			mOverQuotaPendingTime = 0;
 
 			LOG(LogDebug) << "REQ_429_TOOMANYREQUESTS : Retrying";
-
-			std::string url = mRequest->getUrl();
-			delete mRequest;
-			mRequest = new HttpReq(url, mSavePath);
+			startRequest();
 		}
 
 		return;
 	}
 
+	if (mRequest == nullptr && !startRequest())
+		return;
+
 	HttpReq::Status status = mRequest->status();
 
 	if (status == HttpReq::REQ_IN_PROGRESS)
@@ -552,6 +696,8 @@ void ImageDownloadHandle::update()
 	
 	if (status == HttpReq::REQ_429_TOOMANYREQUESTS)
 	{
+		ScraperHttpRequest::notifyOverQuota();
+
 		mRetryCount++;
 		if (mRetryCount >= mOverQuotaRetryCount)
 		{
@@ -623,8 +769,17 @@ void ImageDownloadHandle::update()
 			}
 		}
 
+		bool resizable = mSavePath.find("-fanart") == std::string::npos && mSavePath.find("-bezel") == std::string::npos && mSavePath.find("-map") == std::string::npos;
+
+		// Still pictures only : gif can be animated, bezels need their alpha channel
+		if (Settings::getInstance()->getBool("ScraperRecompressImages") && mSavePath.find("-bezel") == std::string::npos && (ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp"))
+		{
+			startPostProcess(resizable);
+			return;
+		}
+
 		// It's an image ?
-		if (mSavePath.find("-fanart") == std::string::npos && mSavePath.find("-bezel") == std::string::npos && mSavePath.find("-map") == std::string::npos && (ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp" || ext == ".gif"))
+		if (resizable && (ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp" || ext == ".gif"))
 		{
 			try { resizeImage(mSavePath, mMaxWidth, mMaxHeight); }
 			catch(...) { }
@@ -634,6 +789,167 @@ void ImageDownloadHandle::update()
 	setStatus(ASYNC_DONE);
 }
 
+
+void ImageDownloadHandle::startPostProcess(bool resizable)
+{
+	int maxWidth = mMaxWidth;
+	int maxHeight = mMaxHeight;
+
+	// Full screen medias, or medias without a configured size : never more than 1080p
+	if (!resizable || (maxWidth <= 0 && maxHeight <= 0))
+	{
+		maxWidth = 1920;
+		maxHeight = 1080;
+	}
+
+	int quality = Settings::getInstance()->getInt("ScraperJpegQuality");
+
+	std::shared_ptr<PostProcess> postProcess = std::make_shared<PostProcess>();
+	postProcess->path = mSavePath;
+	mPostProcess = postProcess;
+
+	// Low priority, within the background workers budget
+	TaskScheduler::submit(TaskScheduler::BACKGROUND, [postProcess, maxWidth, maxHeight, quality]
+	{
+		int width = 0;
+		int height = 0;
+
+		std::string path = recompressImage(postProcess->path, maxWidth, maxHeight, quality, width, height);
+		if (!path.empty())
+		{
+			// Known right now : the picture is never probed when it's shown
+			if (path != postProcess->path)
+				ImageIO::removeImageCache(postProcess->path);
+
+			if (width > 0 && height > 0)
+				ImageIO::updateImageCache(path, (int)Utils::FileSystem::getFileSize(path), width, height);
+
+			postProcess->path = path;
+		}
+
+		postProcess->done = true;
+	});
+}
+
+std::string recompressImage(const std::string& path, int maxWidth, int maxHeight, int quality, int& width, int& height)
+{
+	width = 0;
+	height = 0;
+
+#if WIN32
+	std::wstring wpath = Utils::String::convertToWideString(path);
+	FREE_IMAGE_FORMAT format = FreeImage_GetFileTypeU(wpath.c_str(), 0);
+	if (format == FIF_UNKNOWN)
+		format = FreeImage_GetFIFFromFilenameU(wpath.c_str());
+#else
+	FREE_IMAGE_FORMAT format = FreeImage_GetFileType(path.c_str(), 0);
+	if (format == FIF_UNKNOWN)
+		format = FreeImage_GetFIFFromFilename(path.c_str());
+#endif
+
+	if (format == FIF_UNKNOWN || !FreeImage_FIFSupportsReading(format))
+		return "";
+
+#if WIN32
+	FIBITMAP* image = FreeImage_LoadU(format, wpath.c_str());
+#else
+	FIBITMAP* image = FreeImage_Load(format, path.c_str());
+#endif
+	if (image == NULL)
+		return "";
+
+	int imageWidth = (int)FreeImage_GetWidth(image);
+	int imageHeight = (int)FreeImage_GetHeight(image);
+	if (imageWidth <= 0 || imageHeight <= 0)
+	{
+		FreeImage_Unload(image);
+		return "";
+	}
+
+	// Fit in the box, keeping the aspect ratio
+	float scale = 1.0f;
+	if (maxWidth > 0 && imageWidth > maxWidth)
+		scale = (float)maxWidth / imageWidth;
+	if (maxHeight > 0 && imageHeight * scale > maxHeight)
+		scale = (float)maxHeight / imageHeight;
+
+	bool transparent = FreeImage_IsTransparent(image) || FreeImage_GetBPP(image) == 32;
+	bool toJpeg = !transparent && format != FIF_JPEG;
+
+	if (scale >= 1.0f && !toJpeg)
+	{
+		FreeImage_Unload(image);
+
+		width = imageWidth;
+		height = imageHeight;
+		return path;
+	}
+
+	if (scale < 1.0f)
+	{
+		FIBITMAP* rescaled = FreeImage_Rescale(image, std::max(1, (int)(imageWidth * scale)), std::max(1, (int)(imageHeight * scale)), FILTER_BILINEAR);
+		FreeImage_Unload(image);
+
+		if (rescaled == NULL)
+			return "";
+
+		image = rescaled;
+	}
+
+	std::string target = path;
+	FREE_IMAGE_FORMAT targetFormat = format;
+	int flags = 0;
+
+	if (toJpeg || format == FIF_JPEG)
+	{
+		if (FreeImage_GetBPP(image) != 24)
+		{
+			FIBITMAP* converted = FreeImage_ConvertTo24Bits(image);
+			FreeImage_Unload(image);
+
+			if (converted == NULL)
+				return "";
+
+			image = converted;
+		}
+
+		target = Utils::FileSystem::changeExtension(path, ".jpg");
+		targetFormat = FIF_JPEG;
+		flags = Math::clamp(quality, 10, 100);
+	}
+
+	width = (int)FreeImage_GetWidth(image);
+	height = (int)FreeImage_GetHeight(image);
+
+	bool saved = false;
+
+	try
+	{
+#if WIN32
+		saved = (FreeImage_SaveU(targetFormat, image, Utils::String::convertToWideString(target).c_str(), flags) != 0);
+#else
+		saved = (FreeImage_Save(targetFormat, image, target.c_str(), flags) != 0);
+#endif
+	}
+	catch (...) { }
+
+	FreeImage_Unload(image);
+
+	if (!saved)
+	{
+		LOG(LogError) << "recompressImage : unable to save " << target;
+		Utils::FileSystem::removeFile(target);
+
+		width = height = 0;
+		return Utils::FileSystem::exists(path) ? path : "";
+	}
+
+	if (target != path)
+		Utils::FileSystem::removeFile(path);
+
+	return target;
+}
+
 //you can pass 0 for width or height to keep aspect ratio
 bool resizeImage(const std::string& path, int maxWidth, int maxHeight)
 {
@@ -4,12 +4,16 @@
 
 #include "AsyncHandle.h"
 #include "HttpReq.h"
+#include "scrapers/ScraperCache.h"
 #include "MetaData.h"
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <queue>
 #include <utility>
 #include <set>
+#include <mutex>
+#include <map>
 #include <assert.h>
 #include "FileData.h"
 
@@ -93,17 +97,30 @@ public:
 	virtual void update() override;
 	virtual bool retryOn249() { return true; }
 
+	// Number of 429 responses received so far, API & media requests together : lets the ThreadedScraper slow down
+	static int getOverQuotaCount() { return sOverQuotaCount; }
+	static void notifyOverQuota() { sOverQuotaCount++; }
+
 protected:
 	virtual bool process(HttpReq* request, std::vector<ScraperSearchResult>& results) = 0;
 
 private:
+	void processResponse();
+
 	HttpReq* mRequest;
 	HttpReqOptions mOptions;
 	int	mRetryCount;
 
+	std::string mCacheKey;
+	ScraperCache::Response mCachedResponse;
+	bool mHasCachedResponse;
+	bool mFromCache;
+
 	int mOverQuotaPendingTime;
 	int mOverQuotaRetryDelay;
 	int mOverQuotaRetryCount;
+
+	static std::atomic<int> sOverQuotaCount;
 };
 
 // a request to get a list of results
@@ -126,6 +143,24 @@ typedef void (*generate_scraper_requests_func)(const ScraperSearchParams& params
 
 // -------------------------------------------------------------------------
 
+// Media downloads running at the same time on each host, and the bandwidth shared by all of them ( "ScraperMediaPerHost", "ScraperMediaBandwidth" )
+class MediaDownloadSlots
+{
+public:
+	static bool acquire(const std::string& host);
+	static void release(const std::string& host);
+
+	// Bytes per second for a download that just got its slot, 0 for no limit
+	static long long getMaxRecvSpeed();
+
+	static std::string getHost(const std::string& url);
+
+private:
+	static std::mutex mLock;
+	static std::map<std::string, int> mHosts;
+	static int mActiveCount;
+};
+
 class ImageDownloadHandle : public AsyncHandle
 {
 public:
@@ -138,7 +173,25 @@ public:
 	std::string getImageFileName() { return mSavePath; }
 
 private:
+	// Waits for a free slot on the host before sending the request
+	bool startRequest();
+
+	struct PostProcess
+	{
+		PostProcess() : done(false) { }
+
+		std::atomic<bool> done;
+		std::string path;
+	};
+
+	// Resize & jpg recompression of the downloaded picture, on a background worker ( "ScraperRecompressImages" )
+	void startPostProcess(bool resizable);
+
+	std::shared_ptr<PostProcess> mPostProcess;
 	HttpReq* mRequest;
+	std::string mUrl;
+	std::string mHost;
+	bool mHasSlot;
 
 	int	mRetryCount;
 	int mOverQuotaPendingTime;
@@ -262,6 +315,12 @@ public:
 		return 1;
 	}
 
+	// Requests per minute allowed by the server, as reported during getThreadCount. 0 when unknown
+	virtual int getMaxRequestsPerMinute() { return 0; }
+
+	// Hosts of the API, warmed by HttpReq::preconnect when the scraper screen opens
+	virtual std::vector<std::string> getPreconnectUrls() { return std::vector<std::string>(); }
+
 	bool isMediaSupported(const ScraperMediaSource& md);
 
 protected:
@@ -275,4 +334,8 @@ protected:
 //Returns true if successful, false otherwise.
 bool resizeImage(const std::string& path, int maxWidth, int maxHeight);
 
+// Scales the picture down to fit in maxWidth x maxHeight, and saves it as a .jpg when it has no transparency.
+// Returns the final path ( the extension can change ), and the final size in width & height
+std::string recompressImage(const std::string& path, int maxWidth, int maxHeight, int quality, int& width, int& height);
+
 #endif // ES_APP_SCRAPERS_SCRAPER_H
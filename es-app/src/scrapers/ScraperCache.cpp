@@ -0,0 +1,100 @@
+#include "scrapers/ScraperCache.h"
+
+#include "utils/BinaryStream.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/MemoryMappedFile.h"
+#include "utils/StringUtil.h"
+#include "utils/md5.h"
+#include "HttpReq.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <fstream>
+
+#define SCRAPER_CACHE_MAGIC		0x43535345 // 'ESSC'
+#define SCRAPER_CACHE_VERSION	1
+
+bool ScraperCache::isEnabled()
+{
+	return Settings::getInstance()->getInt("ScraperCacheDays") > 0;
+}
+
+std::string ScraperCache::getKey(const std::string& url, const HttpReqOptions& options)
+{
+	std::string key = url + "\n" + options.dataToPost;
+
+	// Session tokens change between runs but not the responses
+	for (auto& header : options.customHeaders)
+		if (!Utils::String::startsWith(header, "Authorization:"))
+			key += "\n" + header;
+
+	return key;
+}
+
+std::string ScraperCache::getCachePath(const std::string& key)
+{
+	MD5 md5;
+	md5.update(key.c_str(), key.size());
+	md5.finalize();
+
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/scrapers/" + md5.hexdigest() + ".bin");
+}
+
+bool ScraperCache::load(const std::string& key, Response& response)
+{
+	Utils::MemoryMappedFile file(getCachePath(key));
+	if (!file.isOpen())
+		return false;
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (reader.readUInt32() != SCRAPER_CACHE_MAGIC || reader.readUInt32() != SCRAPER_CACHE_VERSION)
+		return false;
+
+	// The full key guards against hash collisions
+	if (reader.readString() != key)
+		return false;
+
+	response.time = (time_t)reader.readInt64();
+	response.etag = reader.readString();
+	response.lastModified = reader.readString();
+	response.content = reader.readString();
+
+	return !reader.failed();
+}
+
+void ScraperCache::save(const std::string& key, const Response& response)
+{
+	Utils::BinaryWriter writer;
+	writer.writeUInt32(SCRAPER_CACHE_MAGIC);
+	writer.writeUInt32(SCRAPER_CACHE_VERSION);
+	writer.writeString(key);
+	writer.writeInt64((int64_t)response.time);
+	writer.writeString(response.etag);
+	writer.writeString(response.lastModified);
+	writer.writeString(response.content);
+
+	std::string cachePath = getCachePath(key);
+
+	if (!Utils::FileSystem::writeFileAtomic(cachePath, writer))
+		LOG(LogWarning) << "ScraperCache : Unable to write " << cachePath;
+}
+
+bool ScraperCache::isFresh(const Response& response)
+{
+	time_t maxAge = (time_t)Settings::getInstance()->getInt("ScraperCacheDays") * 86400;
+	time_t now = time(NULL);
+
+	return response.time <= now && now - response.time < maxAge;
+}
+
+std::string ScraperCache::getResponseHeader(HttpReq* request, const std::string& name)
+{
+	std::string lowerName = Utils::String::toLower(name);
+
+	for (auto& header : request->getResponseHeaders())
+		if (Utils::String::toLower(header.first) == lowerName)
+			return header.second;
+
+	return "";
+}
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef ES_APP_SCRAPERS_SCRAPER_CACHE_H
+#define ES_APP_SCRAPERS_SCRAPER_CACHE_H
+
+#include <string>
+#include <time.h>
+
+class HttpReq;
+class HttpReqOptions;
+
+// Scraper API responses saved on disk, one file per request named after the hash of its url, post data & headers.
+// Fresh responses ( "ScraperCacheDays" ) are served without any network access, outdated ones are revalidated with their ETag / Last-Modified
+class ScraperCache
+{
+public:
+	struct Response
+	{
+		Response() : time(0) { }
+
+		time_t		time;
+		std::string etag;
+		std::string lastModified;
+		std::string content;
+	};
+
+	static bool isEnabled();
+
+	static std::string getKey(const std::string& url, const HttpReqOptions& options);
+
+	static bool load(const std::string& key, Response& response);
+	static void save(const std::string& key, const Response& response);
+
+	static bool isFresh(const Response& response);
+
+	// Case insensitive lookup : HTTP/2 servers send lower case header names
+	static std::string getResponseHeader(HttpReq* request, const std::string& name);
+
+private:
+	static std::string getCachePath(const std::string& key);
+};
+
+#endif // ES_APP_SCRAPERS_SCRAPER_CACHE_H
@@ -924,8 +924,7 @@ int ScreenScraperScraper::getThreadCount(std::string &result)
 	if (parseResult)
 	{
 		auto userInfo = ScreenScraperRequest::processUserInfo(doc);
-		
-		// userInfo.maxRequestsPerMin / userInfo.maxthreads;
+		mMaxRequestsPerMin = userInfo.maxRequestsPerMin;
 
 		if (userInfo.maxthreads > 0)
 			return userInfo.maxthreads;
@@ -21,8 +21,15 @@ public:
 
 	bool isSupportedPlatform(SystemData* system) override;
 	int getThreadCount(std::string &result) override;
+	int getMaxRequestsPerMinute() override { return mMaxRequestsPerMin; }
+	std::vector<std::string> getPreconnectUrls() override { return { "https://www.screenscraper.fr/" }; }
 
 	const std::set<ScraperMediaSource>& getSupportedMedias() override;
+
+	ScreenScraperScraper() : mMaxRequestsPerMin(0) { }
+
+private:
+	int mMaxRequestsPerMin;
 };
 
 struct ScreenScraperUser
@@ -6,32 +6,55 @@
 #include "guis/GuiMsgBox.h"
 #include "Gamelist.h"
 #include "Log.h"
+#include "TaskScheduler.h"
+#include "Settings.h"
+#include "services/HttpEventStream.h"
+#include <SDL_timer.h>
 
 #define GUIICON _U("\uF03E ")
 
+#define MAX_WAITING_MEDIA_JOBS 16
+
 ThreadedScraper* ThreadedScraper::mInstance = nullptr;
 bool ThreadedScraper::mPaused = false;
+std::atomic<unsigned long long> ThreadedScraper::mScrapedCount(0);
+std::atomic<unsigned long long> ThreadedScraper::mFailedCount(0);
 
-ThreadedScraper::ThreadedScraper(Window* window, const std::queue<ScraperSearchParams>& searches, int threadCount)
-	: mSearchQueue(searches), mWindow(window)
+ThreadedScraper::ThreadedScraper(Window* window, const std::queue<ScraperSearchParams>& searches, int threadCount, int maxRequestsPerMinute)
+	: mSearchQueue(searches), mWindow(window), mThrottle(threadCount, maxRequestsPerMinute)
 {
 	mExitCode = ASYNC_IN_PROGRESS;
 	mTotal = (int) mSearchQueue.size();
+	mOverQuotaCount = ScraperHttpRequest::getOverQuotaCount();
 
 	mWndNotification = mWindow->createAsyncNotificationComponent();
 	mWndNotification->updateTitle(GUIICON + _("SCRAPING"));
 
-	for (int i = 0; i < threadCount; i++)
+	startThreads();
+
+	mHandle = new std::thread(&ThreadedScraper::run, this);	
+}
+
+void ThreadedScraper::startThreads()
+{
+	// Searches don't run too far ahead of the downloads
+	int maxWaitingMedias = MAX_WAITING_MEDIA_JOBS;
+
+	while ((int)mScraperThreads.size() < mThrottle.getActiveLimit() && !mSearchQueue.empty() && (int)mMediaQueue.size() < maxWaitingMedias && mThrottle.tryAcquire())
 	{
-		if (mSearchQueue.size() == 0)
-			break;
+		ScraperThread* thread;
+
+		if (mIdleThreads.empty())
+			thread = new ScraperThread((int)mScraperThreads.size());
+		else
+		{
+			thread = mIdleThreads.back();
+			mIdleThreads.pop_back();
+		}
 
-		ScraperThread* thread = new ScraperThread(i);
 		mScraperThreads.push_back(thread);
 		ProcessNextGame(thread);
-	}	
-
-	mHandle = new std::thread(&ThreadedScraper::run, this);	
+	}
 }
 
 void ThreadedScraper::ProcessNextGame(ScraperThread* thread)
@@ -55,7 +78,20 @@ ThreadedScraper::~ThreadedScraper()
 	for (auto scraperThread : mScraperThreads)
 		delete scraperThread;
 
+	for (auto scraperThread : mIdleThreads)
+		delete scraperThread;
+
+	for (auto job : mMediaJobs)
+		delete job;
+
+	while (!mMediaQueue.empty())
+	{
+		delete mMediaQueue.front();
+		mMediaQueue.pop();
+	}
+
 	mScraperThreads.clear();
+	mIdleThreads.clear();
 
 	ThreadedScraper::mInstance = nullptr;
 }
@@ -70,6 +106,13 @@ ScraperThread::ScraperThread(int threadId)
 	mThreadId = threadId;
 	mErrorStatus = 0;
 	mStatus = ASYNC_IN_PROGRESS;
+	mStartTime = 0;
+	mPendingMedias = false;
+}
+
+int ScraperThread::getElapsedTime()
+{
+	return (int)(SDL_GetTicks() - mStartTime);
 }
 
 void ScraperThread::run(const ScraperSearchParams& params)
@@ -79,7 +122,8 @@ void ScraperThread::run(const ScraperSearchParams& params)
 	mStatusString = "";
 	mStatus = ASYNC_IN_PROGRESS;
 	mSearch = params;
-	mMDResolveHandle.reset();
+	mPendingMedias = false;
+	mStartTime = SDL_GetTicks();
 
 	mSearchHandle = Scraper::getScraper()->search(params);
 }
@@ -101,10 +145,8 @@ int ScraperThread::updateState()
 		{
 			if (results.size() > 0)
 			{
-				if (results[0].hasMedia())
-					mMDResolveHandle = results[0].resolveMetaDataAssets(mSearch);
-				else
-					acceptResult(results[0]);
+				mPendingMedias = results[0].hasMedia();
+				acceptResult(results[0]);
 			}
 			else
 			{
@@ -116,28 +158,13 @@ int ScraperThread::updateState()
 			processError(httpCode, statusString);
 	}
 
-	if (mMDResolveHandle && mMDResolveHandle->status() != ASYNC_IN_PROGRESS)
-	{
-		auto status = mMDResolveHandle->status();
-		auto result = mMDResolveHandle->getResult();
-		auto statusString = mMDResolveHandle->getStatusString();
-		auto httpCode = mMDResolveHandle->getErrorCode();
-
-		LOG(LogInfo) << "[Thread " << mThreadId << "] ResolveResponse : " << statusString;
-
-		mMDResolveHandle.reset();
-
-		if (status == ASYNC_DONE)
-			acceptResult(result);
-		else if (status == ASYNC_ERROR)
-			processError(httpCode, statusString);
-	}
-
 	return mStatus;
 }
 
 void ThreadedScraper::processError(int status, const std::string statusString)
 {
+	mFailedCount++;
+
 	if (status == HttpReq::REQ_430_TOOMANYSCRAPS || status == HttpReq::REQ_430_TOOMANYFAILURES || 
 		status == HttpReq::REQ_426_BLACKLISTED || status == HttpReq::REQ_FILESTREAM_ERROR || status == HttpReq::REQ_426_SERVERMAINTENANCE ||
 		status == HttpReq::REQ_403_BADLOGIN || status == HttpReq::REQ_401_FORBIDDEN)
@@ -152,6 +179,8 @@ void ThreadedScraper::processError(int status, const std::string statusString)
 
 void ThreadedScraper::run()
 {
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::NETWORK);
+
 	while (mExitCode == ASYNC_IN_PROGRESS)
 	{
 		if (mPaused)
@@ -163,58 +192,82 @@ void ThreadedScraper::run()
 			}
 		}
 		
-		for (auto iter = mScraperThreads.cbegin(); iter != mScraperThreads.cend(); ++iter)
+		int overQuotaCount = ScraperHttpRequest::getOverQuotaCount();
+		if (overQuotaCount != mOverQuotaCount)
 		{
-			if (mExitCode != ASYNC_IN_PROGRESS)
-				break;
+			mOverQuotaCount = overQuotaCount;
+			mThrottle.onOverQuota();
+
+			LOG(LogDebug) << "ThreadedScraper : over quota, " << mThrottle.getActiveLimit() << " threads";
+		}
+
+		bool completed = false;
 
+		for (auto iter = mScraperThreads.begin(); iter != mScraperThreads.end() && mExitCode == ASYNC_IN_PROGRESS; )
+		{
 			auto mScraperThread = *iter;
 
 			int state = mScraperThread->updateState();
-			switch (state)
+			if (state == ASYNC_IN_PROGRESS)
 			{
-			case ASYNC_DONE:
-				acceptResult(*mScraperThread);
-				break;
-
-			case ASYNC_ERROR:
-				processError(mScraperThread->getError(), mScraperThread->getErrorString());
-				break;
-
-			default:
-				//std::this_thread::yield();
-				// std::this_thread::sleep_for(std::chrono::milliseconds(10));
-				break;
+				++iter;
+				continue;
 			}
 
-			if (mExitCode == ASYNC_IN_PROGRESS && state != ASYNC_IN_PROGRESS)
+			if (state == ASYNC_DONE)
 			{
-				if (!mSearchQueue.empty())
-					ProcessNextGame(mScraperThread);
-				else
-				{					
-					mScraperThreads.erase(iter);
-					if (mScraperThreads.size() == 0)
-					{
-						mExitCode = ASYNC_DONE;
-						LOG(LogDebug) << "ThreadedScraper::finished";
-					}
-					break;
+				mThrottle.onCompleted(mScraperThread->getElapsedTime());
+
+				if (mScraperThread->hasPendingMedias())
+				{
+					ScraperMediaJob* job = new ScraperMediaJob();
+					job->search = mScraperThread->getSearchParams();
+					job->result = mScraperThread->getResult();
+					mMediaQueue.push(job);
 				}
+				else
+					acceptResult(mScraperThread->getSearchParams(), mScraperThread->getResult());
 			}
+			else
+				processError(mScraperThread->getError(), mScraperThread->getErrorString());
+
+			iter = mScraperThreads.erase(iter);
+			mIdleThreads.push_back(mScraperThread);
+			completed = true;
+		}
+
+		if (mExitCode == ASYNC_IN_PROGRESS && updateMediaJobs())
+			completed = true;
+
+		if (mExitCode != ASYNC_IN_PROGRESS)
+			break;
+
+		startMediaJobs();
+		startThreads();
+
+		if (mScraperThreads.empty() && mSearchQueue.empty() && mMediaJobs.empty() && mMediaQueue.empty())
+		{
+			mExitCode = ASYNC_DONE;
+			LOG(LogDebug) << "ThreadedScraper::finished";
+			break;
 		}
+
+		if (!completed)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
 	}
 	
 	if (mExitCode == ASYNC_DONE)
 		mWindow->displayNotificationMessage(GUIICON + _("SCRAPING FINISHED") + std::string(". ") + _("UPDATE GAMELISTS TO APPLY CHANGES."));
 
+	HttpEventStream::push("scrape-end", mExitCode == ASYNC_DONE ? "{\"completed\":true}" : "{\"completed\":false}");
+
 	delete this;
 	ThreadedScraper::mInstance = nullptr;
 }
 
 void ThreadedScraper::updateUI()
 {
-	int remaining = mTotal + 1 - mSearchQueue.size() - mScraperThreads.size();
+	int remaining = mTotal + 1 - mSearchQueue.size() - mScraperThreads.size() - mMediaQueue.size() - mMediaJobs.size();
 	if (remaining < 0)
 		remaining = 0;
 
@@ -224,21 +277,76 @@ void ThreadedScraper::updateUI()
 	mWndNotification->updateTitle(GUIICON + _("SCRAPING") + " " + idx);
 	mWndNotification->updateText(mCurrentGame);
 	mWndNotification->updatePercent(percentDone);
+
+	HttpEventStream::pushProgress("scrape-progress", remaining, mTotal + 1, mCurrentGame);
+}
+
+void ThreadedScraper::startMediaJobs()
+{
+	int maxJobs = Settings::getInstance()->getInt("ScraperMediaDownloads");
+	if (maxJobs < 1)
+		maxJobs = 1;
+
+	while ((int)mMediaJobs.size() < maxJobs && !mMediaQueue.empty())
+	{
+		ScraperMediaJob* job = mMediaQueue.front();
+		mMediaQueue.pop();
+
+		job->handle = job->result.resolveMetaDataAssets(job->search);
+		mMediaJobs.push_back(job);
+	}
+}
+
+// Returns true when a game completed
+bool ThreadedScraper::updateMediaJobs()
+{
+	bool completed = false;
+
+	for (auto it = mMediaJobs.begin(); it != mMediaJobs.end() && mExitCode == ASYNC_IN_PROGRESS; )
+	{
+		ScraperMediaJob* job = *it;
+
+		auto status = job->handle->status();
+		if (status == ASYNC_IN_PROGRESS)
+		{
+			++it;
+			continue;
+		}
+
+		LOG(LogInfo) << "ThreadedScraper::ResolveResponse : " << job->search.getGameName() << " " << job->handle->getStatusString();
+
+		if (status == ASYNC_DONE)
+		{
+			ScraperSearchResult result = job->handle->getResult();
+			acceptResult(job->search, result);
+		}
+		else
+			processError(job->handle->getErrorCode(), job->handle->getStatusString());
+
+		it = mMediaJobs.erase(it);
+		delete job;
+		completed = true;
+	}
+
+	if (completed)
+		updateUI();
+
+	return completed;
 }
 
-void ThreadedScraper::acceptResult(ScraperThread& thread)
+void ThreadedScraper::acceptResult(ScraperSearchParams& search, ScraperSearchResult& result)
 {
 	LOG(LogDebug) << "ThreadedScraper::acceptResult >>";
 
-	ScraperSearchResult& result = thread.getResult();
+	mScrapedCount++;
+
 	if (result.mdl.getName().empty())
 	{		
 		auto scraperName = Scraper::getScraperName(Scraper::getScraper());
-		thread.getSearchParams().game->getMetadata().setScrapeDate(scraperName);
+		search.game->getMetadata().setScrapeDate(scraperName);
 		return;
 	}
 
-	ScraperSearchParams& search = thread.getSearchParams();
 	auto game = search.game;
 
 	mWindow->postToUiThread([game, result]()
@@ -272,7 +380,7 @@ void ThreadedScraper::start(Window* window, const std::queue<ScraperSearchParams
 	if (threadCount == 0)
 		threadCount = 1;
 
-	ThreadedScraper::mInstance = new ThreadedScraper(window, searches, threadCount);
+	ThreadedScraper::mInstance = new ThreadedScraper(window, searches, threadCount, Scraper::getScraper()->getMaxRequestsPerMinute());
 }
 
 void ThreadedScraper::stop()
@@ -288,3 +396,90 @@ void ThreadedScraper::stop()
 	catch (...) {}
 }
 
+ScraperThrottle::ScraperThrottle(int maxThreads, int maxRequestsPerMinute)
+{
+	mMaxThreads = maxThreads < 1 ? 1 : maxThreads;
+	mActiveLimit = (mMaxThreads + 1) / 2;
+	mSuccessCount = 0;
+
+	mMaxRate = maxRequestsPerMinute > 0 ? maxRequestsPerMinute / 60000.0 : 0;
+	mRate = mMaxRate;
+	mTokens = mActiveLimit;
+	mLastRefill = SDL_GetTicks();
+
+	mLatency = 0;
+	mBestLatency = 0;
+}
+
+void ScraperThrottle::refill()
+{
+	unsigned int now = SDL_GetTicks();
+
+	mTokens += (now - mLastRefill) * mRate;
+	if (mTokens > mMaxThreads)
+		mTokens = mMaxThreads;
+
+	mLastRefill = now;
+}
+
+bool ScraperThrottle::tryAcquire()
+{
+	if (mRate <= 0)
+		return true;
+
+	refill();
+
+	if (mTokens < 1)
+		return false;
+
+	mTokens -= 1;
+	return true;
+}
+
+void ScraperThrottle::onCompleted(int latency)
+{
+	mLatency = (mLatency == 0 ? latency : mLatency * 0.8 + latency * 0.2);
+	if (mBestLatency == 0 || mLatency < mBestLatency)
+		mBestLatency = mLatency;
+
+	// One decision per round of the active threads
+	if (++mSuccessCount < mActiveLimit)
+		return;
+
+	mSuccessCount = 0;
+
+	if (mLatency > mBestLatency * 2)
+	{
+		if (mActiveLimit > 1)
+			mActiveLimit--;
+	}
+	else if (mLatency <= mBestLatency * 1.5 && mActiveLimit < mMaxThreads)
+		mActiveLimit++;
+
+	// Recover the pacing lost on 429s
+	if (mRate > 0 && (mMaxRate == 0 || mRate < mMaxRate))
+	{
+		refill();
+		mRate *= 1.25;
+
+		if (mMaxRate > 0 && mRate > mMaxRate)
+			mRate = mMaxRate;
+		else if (mMaxRate == 0 && mRate * mLatency >= mMaxThreads)
+			mRate = 0; // Faster than the threads can go : no more pacing needed
+	}
+}
+
+void ScraperThrottle::onOverQuota()
+{
+	mActiveLimit = mActiveLimit > 1 ? mActiveLimit / 2 : 1;
+	mSuccessCount = 0;
+
+	refill();
+
+	if (mRate > 0)
+		mRate /= 2;
+	else
+		mRate = mActiveLimit / (mLatency > 1000 ? mLatency : 1000.0);
+
+	mTokens = 0;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <thread>
+#include <atomic>
 #include "Scraper.h"
 #include "components/AsyncNotificationComponent.h"
 
@@ -16,6 +17,10 @@ public:
 
 	int getError() { return mErrorStatus; }
 	std::string getErrorString() { return mStatusString; }
+	int getElapsedTime();
+
+	// The search found medias : they're downloaded by the ThreadedScraper's download stage, not by this thread
+	bool hasPendingMedias() { return mPendingMedias; }
 
 	int mThreadId;
 
@@ -38,13 +43,51 @@ private:
 	int mStatus;
 	int mErrorStatus;
 	std::string mStatusString;
+	unsigned int mStartTime;
+	bool mPendingMedias;
 
 	ScraperSearchResult mResult;
 	ScraperSearchParams mSearch;
 	std::unique_ptr<ScraperSearchHandle> mSearchHandle;
-	std::unique_ptr<MDResolveHandle> mMDResolveHandle;
 };
 
+// A game whose metadata are found, waiting for its medias
+struct ScraperMediaJob
+{
+	ScraperSearchParams search;
+	ScraperSearchResult result;
+	std::unique_ptr<MDResolveHandle> handle;
+};
+
+// Controls how many games are scraped at the same time : one more thread each time all the active ones succeeded with a steady latency,
+// halved on 429 responses, one less when the latency doubles. New games are paced with a token bucket when the server reports a rate limit
+class ScraperThrottle
+{
+public:
+	ScraperThrottle(int maxThreads, int maxRequestsPerMinute);
+
+	int getActiveLimit() const { return mActiveLimit; }
+
+	bool tryAcquire();
+	void onCompleted(int latency);
+	void onOverQuota();
+
+private:
+	void refill();
+
+	int		mMaxThreads;
+	int		mActiveLimit;
+	int		mSuccessCount;
+
+	// Tokens per ms, 0 when there's no known limit
+	double	mRate;
+	double	mMaxRate;
+	double	mTokens;
+	unsigned int mLastRefill;
+
+	double	mLatency;
+	double	mBestLatency;
+};
 
 class ThreadedScraper
 {
@@ -58,11 +101,18 @@ public:
 
 	static std::string formatGameName(FileData* game);
 
+	// Games scraped / failed since startup, for the web server /metrics
+	static unsigned long long getScrapedCount() { return mScrapedCount; }
+	static unsigned long long getFailedCount() { return mFailedCount; }
+
 private:
-	ThreadedScraper(Window* window, const std::queue<ScraperSearchParams>& searches, int threadCount);
+	ThreadedScraper(Window* window, const std::queue<ScraperSearchParams>& searches, int threadCount, int maxRequestsPerMinute);
 	~ThreadedScraper();
 
 	void ProcessNextGame(ScraperThread* thread);
+	void startThreads();
+	bool updateMediaJobs();
+	void startMediaJobs();
 
 	Window* mWindow;
 	AsyncNotificationComponent* mWndNotification;
@@ -77,8 +127,16 @@ private:
 	std::queue<ScraperSearchParams> mSearchQueue;
 
 	std::vector<ScraperThread*> mScraperThreads;
+	std::vector<ScraperThread*> mIdleThreads;
+
+	ScraperThrottle mThrottle;
+	int mOverQuotaCount;
+
+	// Download stage : games run in parallel, each one downloads its medias in sequence ( MDResolveHandle )
+	std::queue<ScraperMediaJob*> mMediaQueue;
+	std::vector<ScraperMediaJob*> mMediaJobs;
 	
-	void acceptResult(ScraperThread& thread);
+	void acceptResult(ScraperSearchParams& search, ScraperSearchResult& result);
 	void processError(int status, const std::string statusString);
 	void updateUI();
 
@@ -87,5 +145,8 @@ private:
 
 	static bool mPaused;
 	static ThreadedScraper* mInstance;
+
+	static std::atomic<unsigned long long> mScrapedCount;
+	static std::atomic<unsigned long long> mFailedCount;
 };
 
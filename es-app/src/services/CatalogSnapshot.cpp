@@ -0,0 +1,165 @@
+#include "services/CatalogSnapshot.h"
+
+#include "utils/md5.h"
+#include "SystemData.h"
+#include "FileData.h"
+#include "Log.h"
+
+#include <SDL_timer.h>
+#include <stack>
+
+// Bursts of edits ( scraper ) are folded in one version
+#define UPDATE_DELAY_MS 500
+
+std::shared_ptr<const CatalogSnapshot> CatalogSnapshot::mCurrent;
+std::unordered_set<SystemData*> CatalogSnapshot::mDirtySystems;
+unsigned int CatalogSnapshot::mTreeGeneration = (unsigned int)-1;
+int CatalogSnapshot::mLastUpdate = 0;
+
+const GameSnapshot::Field* GameSnapshot::getField(const std::string& key) const
+{
+	for (auto& field : fields)
+		if (field.key == key)
+			return &field;
+
+	return nullptr;
+}
+
+const GameSnapshot* SystemSnapshot::findGame(const std::string& id) const
+{
+	auto it = gamesById.find(id);
+	if (it == gamesById.cend())
+		return nullptr;
+
+	return &games[it->second];
+}
+
+std::shared_ptr<const SystemSnapshot> CatalogSnapshot::getSystem(const std::string& name) const
+{
+	auto it = systems.find(name);
+	if (it == systems.cend())
+		return nullptr;
+
+	return it->second;
+}
+
+std::shared_ptr<const CatalogSnapshot> CatalogSnapshot::get()
+{
+	return std::atomic_load(&mCurrent);
+}
+
+void CatalogSnapshot::invalidate(SystemData* system)
+{
+	if (system == nullptr)
+		return;
+
+	mDirtySystems.insert(system);
+
+	// The collections show the metadata of their source games
+	for (auto collection : SystemData::sSystemVector)
+		if (collection->isCollection())
+			mDirtySystems.insert(collection);
+}
+
+std::shared_ptr<const SystemSnapshot> CatalogSnapshot::buildSystem(SystemData* system)
+{
+	auto snapshot = std::make_shared<SystemSnapshot>();
+	snapshot->name = system->getName();
+
+	std::stack<FolderData*> stack;
+	stack.push(system->getRootFolder());
+
+	while (stack.size())
+	{
+		FolderData* current = stack.top();
+		stack.pop();
+
+		for (auto file : current->getChildren())
+		{
+			if (file->getType() == FOLDER)
+			{
+				stack.push((FolderData*)file);
+				continue;
+			}
+
+			if (file->getType() != GAME)
+				continue;
+
+			snapshot->games.push_back(GameSnapshot());
+			GameSnapshot& game = snapshot->games.back();
+
+			MD5 md5;
+			md5.update(file->getPath().c_str(), file->getPath().size());
+			md5.finalize();
+
+			game.id = md5.hexdigest();
+			game.path = file->getPath();
+			game.name = file->getName();
+			game.systemName = file->getSystemName();
+			game.sourceSystemName = file->getSourceFileData()->getSystemName();
+
+			const MetaDataList& meta = file->getMetadata();
+			for (auto& mdd : MetaDataList::getMDD())
+			{
+				if (mdd.id == MetaDataId::Name)
+					continue;
+
+				std::string value = meta.get(mdd.id);
+				if (value.empty())
+					continue;
+
+				GameSnapshot::Field field;
+				field.key = (mdd.id == MetaDataId::ScraperId) ? "scraperId" : mdd.key;
+				field.value = value;
+				field.isPath = (mdd.type == MD_PATH);
+				game.fields.push_back(field);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < snapshot->games.size(); i++)
+		snapshot->gamesById[snapshot->games[i].id] = i;
+
+	return snapshot;
+}
+
+void CatalogSnapshot::update()
+{
+	unsigned int treeGeneration = FolderData::getTreeGeneration();
+	if (treeGeneration == mTreeGeneration && mDirtySystems.empty())
+		return;
+
+	int now = SDL_GetTicks();
+	if (mCurrent != nullptr && now - mLastUpdate < UPDATE_DELAY_MS)
+		return;
+
+	mLastUpdate = now;
+
+	auto previous = get();
+	bool rebuildAll = (previous == nullptr || treeGeneration != mTreeGeneration);
+
+	auto catalog = std::make_shared<CatalogSnapshot>();
+	catalog->version = previous == nullptr ? 1 : previous->version + 1;
+
+	for (auto system : SystemData::sSystemVector)
+	{
+		if (!rebuildAll && mDirtySystems.find(system) == mDirtySystems.cend())
+		{
+			auto existing = previous->getSystem(system->getName());
+			if (existing != nullptr)
+			{
+				catalog->systems[system->getName()] = existing;
+				continue;
+			}
+		}
+
+		catalog->systems[system->getName()] = buildSystem(system);
+	}
+
+	mDirtySystems.clear();
+	mTreeGeneration = treeGeneration;
+
+	std::atomic_store(&mCurrent, std::shared_ptr<const CatalogSnapshot>(catalog));
+
+	LOG(LogDebug) << "CatalogSnapshot : version " << catalog->version << " in " << (SDL_GetTicks() - now) << "ms";
+}
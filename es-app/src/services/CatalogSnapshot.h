@@ -0,0 +1,67 @@
+#pragma once
+#ifndef ES_APP_SERVICES_CATALOG_SNAPSHOT_H
+#define ES_APP_SERVICES_CATALOG_SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+class SystemData;
+
+struct GameSnapshot
+{
+	struct Field
+	{
+		std::string key;	// json name
+		std::string value;
+		bool		isPath;	// served through /systems/{system}/games/{id}/media/{key}
+	};
+
+	std::string id;
+	std::string path;
+	std::string name;
+	std::string systemName;
+	std::string sourceSystemName;
+	std::vector<Field> fields;
+
+	const Field* getField(const std::string& key) const;
+};
+
+struct SystemSnapshot
+{
+	std::string name;
+	std::vector<GameSnapshot> games;
+	std::unordered_map<std::string, size_t> gamesById;
+
+	const GameSnapshot* findGame(const std::string& id) const;
+};
+
+// Immutable copy of the games for the web server threads. The main thread builds a new version after the reloads ( tree generation )
+// and the metadata edits ( invalidate ), only for the systems that changed, then swaps it atomically : readers keep the version they got
+class CatalogSnapshot
+{
+public:
+	unsigned int version;
+	std::unordered_map<std::string, std::shared_ptr<const SystemSnapshot>> systems;
+
+	std::shared_ptr<const SystemSnapshot> getSystem(const std::string& name) const;
+
+	// Any thread, never blocks on the main thread
+	static std::shared_ptr<const CatalogSnapshot> get();
+
+	// Main thread. invalidate : the metadata of a game of this system changed
+	static void invalidate(SystemData* system);
+	static void update();
+
+private:
+	static std::shared_ptr<const SystemSnapshot> buildSystem(SystemData* system);
+
+	static std::shared_ptr<const CatalogSnapshot> mCurrent;
+	static std::unordered_set<SystemData*> mDirtySystems;
+	static unsigned int mTreeGeneration;
+	static int mLastUpdate;
+};
+
+#endif // ES_APP_SERVICES_CATALOG_SNAPSHOT_H
@@ -15,7 +15,22 @@
 #include "utils/StringUtil.h"
 #include "utils/md5.h"
 #include "scrapers/Scraper.h"
+#include "scrapers/ThreadedScraper.h"
+#include "ThreadedHasher.h"
+#include "resources/TextureResource.h"
+#include "FrameScheduler.h"
+#include "InputLatency.h"
+#include "MemoryStats.h"
+#include "InputManager.h"
+#include "Window.h"
+#include "CatalogSnapshot.h"
+#include "Settings.h"
+#include "ImageIO.h"
+#include "Log.h"
 #include <unordered_map>
+#include <mutex>
+#include <fstream>
+#include <algorithm>
 
 void HttpApi::getSystemDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, SystemData* sys, bool localpaths)
 {
@@ -99,7 +114,20 @@ std::string HttpApi::getSystemList()
 	return s.GetString();
 }
 
-std::string HttpApi::getFileDataId(FileData* game)
+// Game ids of a system, rebuilt when its tree changed ( FolderData::getTreeGeneration )
+struct FileDataIdIndex
+{
+	FileDataIdIndex() : generation(0) { }
+
+	unsigned int generation;
+	std::unordered_map<std::string, FileData*> games;
+	std::unordered_map<FileData*, std::string> ids;
+};
+
+static std::unordered_map<SystemData*, FileDataIdIndex> sIdIndexes;
+static std::mutex sIdIndexesLock;
+
+static std::string computeFileDataId(FileData* game)
 {
 	MD5 md5;
 	md5.update(game->getPath().c_str(), game->getPath().size());
@@ -107,8 +135,20 @@ std::string HttpApi::getFileDataId(FileData* game)
 	return md5.hexdigest();
 }
 
-FileData* HttpApi::findFileData(SystemData* system, const std::string& id)
+// sIdIndexesLock must be locked
+static FileDataIdIndex& getFileDataIdIndex(SystemData* system)
 {
+	unsigned int treeGeneration = FolderData::getTreeGeneration();
+
+	auto it = sIdIndexes.find(system);
+	if (it != sIdIndexes.cend() && it->second.generation == treeGeneration)
+		return it->second;
+
+	FileDataIdIndex& index = sIdIndexes[system];
+	index.generation = treeGeneration;
+	index.games.clear();
+	index.ids.clear();
+
 	std::stack<FolderData*> stack;
 	stack.push(system->getRootFolder());
 
@@ -118,48 +158,84 @@ FileData* HttpApi::findFileData(SystemData* system, const std::string& id)
 		stack.pop();
 
 		for (auto it : current->getChildren())
-		{			
+		{
 			if (it->getType() == FOLDER)
 				stack.push((FolderData*)it);
-			else if (getFileDataId(it) == id)
-				return it;
+			else
+			{
+				std::string id = computeFileDataId(it);
+				index.games[id] = it;
+				index.ids[it] = id;
+			}
 		}
 	}
 
+	return index;
+}
+
+std::string HttpApi::getFileDataId(FileData* game)
+{
+	std::unique_lock<std::mutex> lock(sIdIndexesLock);
+
+	// Only reuse an index that is up to date, a single game isn't worth building one
+	auto it = sIdIndexes.find(game->getSystem());
+	if (it != sIdIndexes.cend() && it->second.generation == FolderData::getTreeGeneration())
+	{
+		auto id = it->second.ids.find(game);
+		if (id != it->second.ids.cend())
+			return id->second;
+	}
+
+	return computeFileDataId(game);
+}
+
+FileData* HttpApi::findFileData(SystemData* system, const std::string& id)
+{
+	std::unique_lock<std::mutex> lock(sIdIndexesLock);
+
+	FileDataIdIndex& index = getFileDataIdIndex(system);
+
+	auto it = index.games.find(id);
+	if (it != index.games.cend())
+		return it->second;
+
 	return nullptr;
 }
 
-void HttpApi::getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, FileData* game, bool localpaths)
+template<typename Writer>
+void HttpApi::getFileDataJson(Writer& writer, FileData* game, bool localpaths, const std::set<std::string>* fields)
 {
 	if (game->getType() != GAME)
 		return;
 
 	std::string id = getFileDataId(game);
 
+	auto hasField = [fields](const std::string& name) { return fields == nullptr || fields->find(name) != fields->cend(); };
+
 	writer.StartObject();
 	writer.Key("id"); writer.String(id.c_str());
-	writer.Key("path"); writer.String(game->getPath().c_str());
-	writer.Key("name"); writer.String(game->getName().c_str());
 
-	writer.Key("systemName"); writer.String(game->getSystemName().c_str());
+	if (hasField("path")) { writer.Key("path"); writer.String(game->getPath().c_str()); }
+	if (hasField("name")) { writer.Key("name"); writer.String(game->getName().c_str()); }
+	if (hasField("systemName")) { writer.Key("systemName"); writer.String(game->getSystemName().c_str()); }
 
-	auto meta = game->getMetadata();
-	for (auto mdd : MetaDataList::getMDD())
+	const MetaDataList& meta = game->getMetadata();
+	for (auto& mdd : MetaDataList::getMDD())
 	{
 		if (mdd.id == MetaDataId::Name)
 			continue;
 
-		std::string value = game->getMetadata(mdd.id);
+		std::string key = (mdd.id == MetaDataId::ScraperId) ? "scraperId" : mdd.key;
+		if (!hasField(key))
+			continue;
+
+		std::string value = meta.get(mdd.id);
 		if (!value.empty())
 		{
-			if (meta.getType(mdd.id) == MD_PATH && localpaths == false)
+			if (mdd.type == MD_PATH && localpaths == false)
 				value = "/systems/" + game->getSourceFileData()->getSystemName() + "/games/" + id + "/media/" + mdd.key;
 
-			if (mdd.id == MetaDataId::ScraperId)
-				writer.Key("scraperId");
-			else 
-				writer.Key(mdd.key.c_str());
-
+			writer.Key(key.c_str());
 			writer.String(value.c_str());
 		}
 	}
@@ -167,6 +243,35 @@ void HttpApi::getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>&
 	writer.EndObject();
 }
 
+// Same output as getFileDataJson, from the catalog snapshot
+template<typename Writer>
+void HttpApi::getGameSnapshotJson(Writer& writer, const GameSnapshot& game, bool localpaths, const std::set<std::string>* fields)
+{
+	auto hasField = [fields](const std::string& name) { return fields == nullptr || fields->find(name) != fields->cend(); };
+
+	writer.StartObject();
+	writer.Key("id"); writer.String(game.id.c_str());
+
+	if (hasField("path")) { writer.Key("path"); writer.String(game.path.c_str()); }
+	if (hasField("name")) { writer.Key("name"); writer.String(game.name.c_str()); }
+	if (hasField("systemName")) { writer.Key("systemName"); writer.String(game.systemName.c_str()); }
+
+	for (auto& field : game.fields)
+	{
+		if (!hasField(field.key))
+			continue;
+
+		writer.Key(field.key.c_str());
+
+		if (field.isPath && localpaths == false)
+			writer.String(("/systems/" + game.sourceSystemName + "/games/" + game.id + "/media/" + field.key).c_str());
+		else
+			writer.String(field.value.c_str());
+	}
+
+	writer.EndObject();
+}
+
 bool HttpApi::ImportFromJson(FileData* file, const std::string& json)
 {
 	rapidjson::Document doc;
@@ -207,7 +312,11 @@ bool HttpApi::ImportFromJson(FileData* file, const std::string& json)
 	return changed;
 }
 
-bool HttpApi::ImportMedia(FileData* file, const std::string& mediaType, const std::string& contentType, const std::string& mediaBytes)
+// Media written by chunks, and the first bytes of the images for their size
+#define MEDIA_WRITE_BLOCK_SIZE	(256 * 1024)
+#define MEDIA_HEADER_SIZE		(64 * 1024)
+
+int HttpApi::ImportMedia(FileData* file, const std::string& mediaType, const std::string& contentType, size_t contentLength, const MediaReader& read)
 {
 	std::string extension;
 	if (Utils::String::startsWith(contentType, "image/"))
@@ -228,40 +337,119 @@ bool HttpApi::ImportMedia(FileData* file, const std::string& mediaType, const st
 	else if (Utils::String::startsWith(contentType, "application/"))
 		extension = "." + contentType.substr(12);
 	else
-		return false;
+		return 404;
+
+	size_t maxSize = (size_t)std::max(1, Settings::getInstance()->getInt("HttpServerMaxUploadSize")) * 1024 * 1024;
+	if (contentLength > maxSize)
+		return 413;
 
 	for (auto mdd : MetaDataList::getMDD())
 	{
 		if (mdd.key != mediaType || mdd.type != MD_PATH)
 			continue;
 
+		bool isImage = false;
+
 		if (mdd.id == MetaDataId::Video)
 		{
 			if (extension != ".mp4" && extension != ".avi" && extension != ".mkv" && extension != ".webm")
-				return false;
+				return 404;
 		}
 		else if (mdd.id == MetaDataId::Manual || mdd.id == MetaDataId::Magazine)
 		{
 			if (extension != ".pdf" && extension != ".cbz")
-				return false;
+				return 404;
 		}
 		else if (mdd.id == MetaDataId::Map)
 		{
 			if (extension != ".jpg" && extension != ".png" && extension != ".gif" && extension != ".pdf" && extension != ".cbz")
-				return false;
+				return 404;
+
+			isImage = (extension != ".pdf" && extension != ".cbz");
 		}
 		else if (extension != ".jpg" && extension != ".png" && extension != ".gif")
-			return false;
+			return 404;
+		else
+			isImage = true;
 
 		std::string path = Scraper::getSaveAsPath(file, mdd.id, extension);
 
-		Utils::FileSystem::writeAllText(path, mediaBytes);
+		// Next to the destination, so that it can be renamed over it
+		std::string tmpPath = path + ".tmp";
+
+		std::ofstream stream(WINSTRINGW(tmpPath), std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+			return 500;
+
+		// The body is never held in memory : the chunks are buffered up to a block, then written
+		std::string block;
+		std::string header;
+		size_t size = 0;
+		bool tooLarge = false;
+
+		// The content hash is seeded with the size : it's only known when the length was sent
+		ImageContentHash hash(contentLength);
+		bool hashed = isImage && contentLength > 0;
+
+		bool received = read([&](const char* data, size_t length)
+		{
+			size += length;
+			if (size > maxSize)
+			{
+				tooLarge = true;
+				return false;
+			}
+
+			if (hashed)
+				hash.update((const unsigned char*)data, length);
+
+			if (isImage && header.size() < MEDIA_HEADER_SIZE)
+				header.append(data, std::min(length, MEDIA_HEADER_SIZE - header.size()));
+
+			block.append(data, length);
+			if (block.size() >= MEDIA_WRITE_BLOCK_SIZE)
+			{
+				stream.write(block.data(), block.size());
+				block.clear();
+			}
+
+			return !stream.fail();
+		});
+
+		if (block.size())
+			stream.write(block.data(), block.size());
+
+		stream.close();
+
+		int status = 200;
+		if (tooLarge)
+			status = 413;
+		else if (stream.fail())
+			status = 500;
+		else if (!received || size == 0 || (contentLength > 0 && size != contentLength))
+			status = 400;
+		else if (!Utils::FileSystem::renameFile(tmpPath, path))
+			status = 500;
+
+		if (status != 200)
+		{
+			Utils::FileSystem::removeFile(tmpPath);
+			return status;
+		}
+
+		// The size probe is done on the received bytes
+		unsigned int x, y;
+		if (isImage && ImageIO::getImageSize((const unsigned char*)header.data(), header.size(), &x, &y))
+			ImageIO::updateImageCache(path, (int)size, x, y, hashed ? hash.get() : 0);
+		else
+			ImageIO::removeImageCache(path);
+
 		file->setMetadata(mdd.id, path);
 		saveToGamelistRecovery(file);
-		return true;
+		return 200;
 	}
 
-	return false;
+	return 404;
 }
 
 std::string HttpApi::ToJson(FileData* file, bool localpaths)
@@ -272,22 +460,31 @@ std::string HttpApi::ToJson(FileData* file, bool localpaths)
 	return s.GetString();
 }
 
-std::string HttpApi::ToJson(SystemData* system, bool localpaths)
+std::string HttpApi::ToJson(const GameSnapshot& game, bool localpaths)
 {
 	rapidjson::StringBuffer s;
 	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
-	getSystemDataJson(writer, system, localpaths);
+	getGameSnapshotJson(writer, game, localpaths);
 	return s.GetString();
 }
 
-std::string HttpApi::getSystemGames(SystemData* system)
+std::string HttpApi::ToJson(SystemData* system, bool localpaths)
 {
 	rapidjson::StringBuffer s;
 	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
+	getSystemDataJson(writer, system, localpaths);
+	return s.GetString();
+}
 
-	writer.StartArray();
+std::vector<FileData*> HttpApi::getSystemGameList(SystemData* system)
+{
+	// The ids of the listed games come from the index, and the next game requests find them directly
+	{
+		std::unique_lock<std::mutex> lock(sIdIndexesLock);
+		getFileDataIdIndex(system);
+	}
 
-	std::vector<FileData*> files;
+	std::vector<FileData*> games;
 
 	std::stack<FolderData*> stack;
 	stack.push(system->getRootFolder());
@@ -299,18 +496,175 @@ std::string HttpApi::getSystemGames(SystemData* system)
 
 		for (auto it : current->getChildren())
 		{
-			files.push_back(it);
 			if (it->getType() == FOLDER)
 				stack.push((FolderData*)it);
+			else if (it->getType() == GAME)
+				games.push_back(it);
 		}
 	}
 
-	for (auto game : files)
-		getFileDataJson(writer, game);
+	return games;
+}
+
+#define GAMES_JSON_CHUNK_SIZE 64 * 1024
+
+void HttpApi::writeGamesJson(const std::vector<FileData*>& games, size_t offset, size_t limit, const std::set<std::string>& fields, const std::function<void(const char*, size_t)>& write)
+{
+	rapidjson::StringBuffer s;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+
+	writer.StartArray();
+
+	size_t end = (limit == 0 || offset + limit > games.size()) ? games.size() : offset + limit;
+	for (size_t i = offset; i < end; i++)
+	{
+		getFileDataJson(writer, games[i], false, fields.empty() ? nullptr : &fields);
+
+		// The writer keeps its state, only the buffer is recycled
+		if (s.GetSize() >= GAMES_JSON_CHUNK_SIZE)
+		{
+			write(s.GetString(), s.GetSize());
+			s.Clear();
+		}
+	}
 
 	writer.EndArray();
 
-	return s.GetString();
+	write(s.GetString(), s.GetSize());
+}
+
+void HttpApi::writeGamesJson(const SystemSnapshot& system, size_t offset, size_t limit, const std::set<std::string>& fields, const std::function<void(const char*, size_t)>& write)
+{
+	rapidjson::StringBuffer s;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+
+	writer.StartArray();
+
+	size_t end = (limit == 0 || offset + limit > system.games.size()) ? system.games.size() : offset + limit;
+	for (size_t i = offset; i < end; i++)
+	{
+		getGameSnapshotJson(writer, system.games[i], false, fields.empty() ? nullptr : &fields);
+
+		if (s.GetSize() >= GAMES_JSON_CHUNK_SIZE)
+		{
+			write(s.GetString(), s.GetSize());
+			s.Clear();
+		}
+	}
+
+	writer.EndArray();
+
+	write(s.GetString(), s.GetSize());
+}
+
+std::string HttpApi::getSystemGames(SystemData* system)
+{
+	std::string ret;
+	writeGamesJson(getSystemGameList(system), 0, 0, std::set<std::string>(), [&ret](const char* data, size_t size) { ret.append(data, size); });
+	return ret;
+}
+
+static void writeMetric(std::string& ret, const std::string& name, const std::string& type, const std::string& help, double value)
+{
+	ret += "# HELP " + name + " " + help + "\n";
+	ret += "# TYPE " + name + " " + type + "\n";
+	ret += name + " " + Utils::String::format("%.17g", value) + "\n";
+}
+
+std::string HttpApi::getMetrics()
+{
+	std::string ret;
+
+	// Frame times
+	uint64_t counts[FrameScheduler::HISTOGRAM_BUCKETS];
+	uint64_t count;
+	double sumMs;
+	FrameScheduler::getHistogram(counts, count, sumMs);
+
+	const float* bounds = FrameScheduler::getHistogramBounds();
+
+	ret += "# HELP es_frame_time_seconds Interval between two presented frames\n";
+	ret += "# TYPE es_frame_time_seconds histogram\n";
+
+	for (int i = 0; i < FrameScheduler::HISTOGRAM_BUCKETS; i++)
+	{
+		std::string le = (i == FrameScheduler::HISTOGRAM_BUCKETS - 1) ? "+Inf" : Utils::String::format("%.4f", bounds[i] / 1000.0f);
+		ret += "es_frame_time_seconds_bucket{le=\"" + le + "\"} " + std::to_string(counts[i]) + "\n";
+	}
+
+	ret += "es_frame_time_seconds_sum " + Utils::String::format("%.6f", sumMs / 1000.0) + "\n";
+	ret += "es_frame_time_seconds_count " + std::to_string(count) + "\n";
+
+	writeMetric(ret, "es_frame_target_rate", "gauge", "Target frames per second", FrameScheduler::getTargetRate());
+
+	// Input latency, when measured
+	if (InputLatency::isEnabled())
+	{
+		uint64_t latencyCounts[InputLatency::HISTOGRAM_BUCKETS];
+		InputLatency::getHistogram(latencyCounts, count, sumMs);
+
+		const float* latencyBounds = InputLatency::getHistogramBounds();
+
+		ret += "# HELP es_input_latency_seconds Time from an input event to the swap of the frame showing its result\n";
+		ret += "# TYPE es_input_latency_seconds histogram\n";
+
+		for (int i = 0; i < InputLatency::HISTOGRAM_BUCKETS; i++)
+		{
+			std::string le = (i == InputLatency::HISTOGRAM_BUCKETS - 1) ? "+Inf" : Utils::String::format("%.4f", latencyBounds[i] / 1000.0f);
+			ret += "es_input_latency_seconds_bucket{le=\"" + le + "\"} " + std::to_string(latencyCounts[i]) + "\n";
+		}
+
+		ret += "es_input_latency_seconds_sum " + Utils::String::format("%.6f", sumMs / 1000.0) + "\n";
+		ret += "es_input_latency_seconds_count " + std::to_string(count) + "\n";
+	}
+
+	// Input events
+	static const char* eventTypes[InputManager::EVENT_COUNTER_COUNT] = { "axis", "axis_filtered", "button", "hat", "key", "mouse" };
+
+	ret += "# HELP es_input_events_total SDL input events received, axis_filtered are the axis events staying on the same side of the deadzone\n";
+	ret += "# TYPE es_input_events_total counter\n";
+
+	for (int i = 0; i < InputManager::EVENT_COUNTER_COUNT; i++)
+		ret += "es_input_events_total{type=\"" + std::string(eventTypes[i]) + "\"} " + std::to_string(InputManager::getEventCount((InputManager::EventCounter)i)) + "\n";
+
+	writeMetric(ret, "es_log_dropped_total", "counter", "Log messages dropped because the writer was late", (double)Log::getDroppedCount());
+
+	// Memory
+	WindowResourceStats resources = Window::getResourceStats();
+	writeMetric(ret, "es_texture_vram_bytes", "gauge", "VRAM used by the textures", (double)resources.textureVram);
+	writeMetric(ret, "es_texture_total_bytes", "gauge", "Memory the textures would use if they were all loaded", (double)resources.textureTotal);
+	writeMetric(ret, "es_texture_atlas_vram_bytes", "gauge", "VRAM used by the texture atlas pages", (double)resources.atlasVram);
+	writeMetric(ret, "es_font_vram_bytes", "gauge", "VRAM used by the font textures", (double)resources.fontVram);
+	writeMetric(ret, "es_theme_ram_bytes", "gauge", "RAM used by the theme data", (double)resources.themeRam);
+	writeMetric(ret, "es_texture_loader_queue_depth", "gauge", "Textures waiting for the async loader", (double)TextureResource::getLoaderQueueDepth());
+	writeMetric(ret, "es_process_resident_memory_bytes", "gauge", "Resident set size of the process", (double)Utils::Platform::getProcessMemoryUsage());
+
+	ret += "# HELP es_memory_bytes RAM counted by subsystem\n";
+	ret += "# TYPE es_memory_bytes gauge\n";
+
+	for (int i = 0; i < MemoryStats::SUBSYSTEM_COUNT; i++)
+		ret += "es_memory_bytes{subsystem=\"" + std::string(MemoryStats::getName((MemoryStats::Subsystem)i)) + "\"} " + std::to_string(MemoryStats::getUsage((MemoryStats::Subsystem)i)) + "\n";
+
+	ret += "# HELP es_memory_peak_bytes Highest RAM counted by subsystem since startup\n";
+	ret += "# TYPE es_memory_peak_bytes gauge\n";
+
+	for (int i = 0; i < MemoryStats::SUBSYSTEM_COUNT; i++)
+		ret += "es_memory_peak_bytes{subsystem=\"" + std::string(MemoryStats::getName((MemoryStats::Subsystem)i)) + "\"} " + std::to_string(MemoryStats::getPeak((MemoryStats::Subsystem)i)) + "\n";
+
+	// File system cache
+	unsigned long long hits, misses;
+	Utils::FileSystem::getFileCacheStats(hits, misses);
+	writeMetric(ret, "es_file_cache_hits_total", "counter", "File system lookups answered by the cache", (double)hits);
+	writeMetric(ret, "es_file_cache_misses_total", "counter", "File system lookups that missed the cache", (double)misses);
+
+	// Background jobs
+	writeMetric(ret, "es_scraper_games_total", "counter", "Games scraped", (double)ThreadedScraper::getScrapedCount());
+	writeMetric(ret, "es_scraper_failures_total", "counter", "Games that failed to scrape", (double)ThreadedScraper::getFailedCount());
+	writeMetric(ret, "es_scraper_running", "gauge", "1 while the scraper runs", ThreadedScraper::isRunning() ? 1 : 0);
+	writeMetric(ret, "es_hasher_games_total", "counter", "Games hashed", (double)ThreadedHasher::getHashedCount());
+	writeMetric(ret, "es_hasher_running", "gauge", "1 while the hasher runs", ThreadedHasher::isRunning() ? 1 : 0);
+
+	return ret;
 }
 
 std::string HttpApi::getRunnningGameInfo()
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <set>
+#include <functional>
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/pointer.h>
 #include <rapidjson/prettywriter.h>
@@ -8,6 +11,8 @@
 
 class SystemData;
 class FileData;
+struct GameSnapshot;
+struct SystemSnapshot;
 
 class HttpApi
 {
@@ -16,20 +21,39 @@ public:
 	static std::string getSystemList();
 	static std::string getSystemGames(SystemData* system);
 
+	// Games of a system in tree order, for the paginated & streamed listings
+	static std::vector<FileData*> getSystemGameList(SystemData* system);
+
+	// Compact json array of games [offset, offset + limit[ ( limit 0 : all ), flushed to write by chunks. fields : metadata keys to output, empty for all
+	static void writeGamesJson(const std::vector<FileData*>& games, size_t offset, size_t limit, const std::set<std::string>& fields, const std::function<void(const char*, size_t)>& write);
+	static void writeGamesJson(const SystemSnapshot& system, size_t offset, size_t limit, const std::set<std::string>& fields, const std::function<void(const char*, size_t)>& write);
+
 	static std::string getRunnningGameInfo();
 
+	// Runtime telemetry in the Prometheus text exposition format
+	static std::string getMetrics();
+
 	static std::string ToJson(SystemData* system, bool localpaths = false);
 	static std::string ToJson(FileData* file, bool localpaths = false);
+	static std::string ToJson(const GameSnapshot& game, bool localpaths = false);
 
 	static FileData*   findFileData(SystemData* system, const std::string& id);
 
 	static bool ImportFromJson(FileData* file, const std::string& json);
 
-	static bool ImportMedia(FileData* file, const std::string& mediaType, const std::string& contentType, const std::string& mediaBytes);
+	// Calls its argument with each chunk of the uploaded body, as httplib::ContentReader. false if the upload failed or was stopped
+	typedef std::function<bool(const std::function<bool(const char* data, size_t length)>& receiver)> MediaReader;
+
+	// Streams the upload to a temporary file, moved over the media once complete. contentLength : 0 if unknown.
+	// Returns the http status : 200, 400 ( incomplete ), 404 ( unknown media or type ), 413 ( larger than "HttpServerMaxUploadSize" ) or 500
+	static int ImportMedia(FileData* file, const std::string& mediaType, const std::string& contentType, size_t contentLength, const MediaReader& read);
 	
 
 private:
 	static std::string getFileDataId(FileData* game);
-	static void getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, FileData* game, bool localpaths = false);
+	template<typename Writer>
+	static void getFileDataJson(Writer& writer, FileData* game, bool localpaths = false, const std::set<std::string>* fields = nullptr);
+	template<typename Writer>
+	static void getGameSnapshotJson(Writer& writer, const GameSnapshot& game, bool localpaths = false, const std::set<std::string>* fields = nullptr);
 	static void getSystemDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, SystemData* sys, bool localpaths = false);
 };
@@ -0,0 +1,162 @@
+#include "services/HttpEventStream.h"
+
+#include "utils/StringUtil.h"
+#include "Scripting.h"
+
+#include <rapidjson/rapidjson.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <chrono>
+
+#define MAX_EVENTS		64
+
+std::deque<HttpEventStream::Event>	HttpEventStream::mEvents;
+std::mutex							HttpEventStream::mLock;
+std::condition_variable				HttpEventStream::mCondition;
+unsigned int						HttpEventStream::mLastId = 0;
+int									HttpEventStream::mClients = 0;
+bool								HttpEventStream::mRunning = false;
+
+void HttpEventStream::start()
+{
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		mRunning = true;
+	}
+
+	Scripting::setEventListener(&HttpEventStream::onScriptingEvent);
+}
+
+void HttpEventStream::stop()
+{
+	Scripting::setEventListener(nullptr);
+
+	std::unique_lock<std::mutex> lock(mLock);
+	mRunning = false;
+	mCondition.notify_all();
+}
+
+void HttpEventStream::onScriptingEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
+{
+	// The events of the clients : the others are about the settings & the system
+	if (eventName != "game-start" && eventName != "game-end" && eventName != "game-selected" && eventName != "system-selected" &&
+		eventName != "screensaver-start" && eventName != "screensaver-stop" && eventName != "sleep" && eventName != "wake")
+		return;
+
+	rapidjson::StringBuffer s;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+
+	writer.StartObject();
+
+	if (eventName == "game-start")
+	{
+		writer.Key("path"); writer.String(arg1.c_str());
+		writer.Key("name"); writer.String(arg3.c_str());
+	}
+	else if (eventName == "game-selected")
+	{
+		writer.Key("systemName"); writer.String(arg1.c_str());
+		writer.Key("path"); writer.String(arg2.c_str());
+		writer.Key("name"); writer.String(arg3.c_str());
+	}
+	else if (eventName == "system-selected")
+	{
+		writer.Key("systemName"); writer.String(arg1.c_str());
+	}
+
+	writer.EndObject();
+
+	push(eventName, s.GetString());
+}
+
+void HttpEventStream::push(const std::string& name, const std::string& data)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (!mRunning)
+		return;
+
+	Event evt;
+	evt.id = ++mLastId;
+	evt.name = name;
+	evt.message = "id: " + std::to_string(evt.id) + "\nevent: " + name + "\ndata: " + data + "\n\n";
+
+	mEvents.push_back(evt);
+	while (mEvents.size() > MAX_EVENTS)
+		mEvents.pop_front();
+
+	mCondition.notify_all();
+}
+
+void HttpEventStream::pushProgress(const std::string& name, int current, int total, const std::string& text)
+{
+	rapidjson::StringBuffer s;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+
+	writer.StartObject();
+	writer.Key("current"); writer.Int(current);
+	writer.Key("total"); writer.Int(total);
+	writer.Key("percent"); writer.Int(total > 0 ? current * 100 / total : 0);
+	writer.Key("text"); writer.String(text.c_str());
+	writer.EndObject();
+
+	std::string data = s.GetString();
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		for (auto it = mEvents.crbegin(); it != mEvents.crend(); ++it)
+		{
+			if (it->name != name)
+				continue;
+
+			if (Utils::String::endsWith(it->message, "data: " + data + "\n\n"))
+				return;
+
+			break;
+		}
+	}
+
+	push(name, data);
+}
+
+unsigned int HttpEventStream::getLastId()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	return mLastId;
+}
+
+bool HttpEventStream::acquireClient()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	// Each client holds one of the web server threads
+	if (!mRunning || mClients >= MAX_CLIENTS)
+		return false;
+
+	mClients++;
+	return true;
+}
+
+void HttpEventStream::releaseClient()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	mClients--;
+}
+
+bool HttpEventStream::wait(unsigned int& lastId, std::string& messages, int timeoutMs)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	mCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&lastId] { return !mRunning || mLastId != lastId; });
+
+	if (!mRunning)
+		return false;
+
+	for (auto& evt : mEvents)
+		if (evt.id > lastId)
+			messages += evt.message;
+
+	lastId = mLastId;
+	return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#ifndef ES_APP_SERVICES_HTTP_EVENT_STREAM_H
+#define ES_APP_SERVICES_HTTP_EVENT_STREAM_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+// Server-Sent Events of the web server ( GET /events ) : game start/end, selection, screensaver, scraper & hasher progress.
+// The last events are kept so a reconnecting client ( Last-Event-ID ) doesn't miss any
+class HttpEventStream
+{
+public:
+	// Each client keeps one web server worker
+	static const int MAX_CLIENTS = 4;
+
+	static void start();
+	static void stop();
+
+	// data must be a json object
+	static void push(const std::string& name, const std::string& data);
+
+	// Progress of a background job, only sent when it changed
+	static void pushProgress(const std::string& name, int current, int total, const std::string& text);
+
+	static unsigned int getLastId();
+
+	static bool acquireClient();
+	static void releaseClient();
+
+	// Waits for the events after lastId, already formatted as SSE messages. Returns false when the server stops
+	static bool wait(unsigned int& lastId, std::string& messages, int timeoutMs);
+
+private:
+	struct Event
+	{
+		unsigned int id;
+		std::string name;
+		std::string message;
+	};
+
+	static void onScriptingEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3);
+
+	static std::deque<Event> mEvents;
+	static std::mutex mLock;
+	static std::condition_variable mCondition;
+	static unsigned int mLastId;
+	static int mClients;
+	static bool mRunning;
+};
+
+#endif // ES_APP_SERVICES_HTTP_EVENT_STREAM_H
@@ -1,6 +1,10 @@
 #include "HttpServerThread.h"
+
+// An idle keep-alive connection holds a worker thread while it waits for the next request
+#define CPPHTTPLIB_KEEPALIVE_TIMEOUT_SECOND 2
 #include "httplib.h"
 #include "Log.h"
+#include "TaskScheduler.h"
 
 #ifdef WIN32
 #include <Windows.h>
@@ -12,11 +16,22 @@
 #include "FileData.h"
 #include "views/ViewController.h"
 #include <unordered_map>
+#include <condition_variable>
+#include <atomic>
+#include <list>
+#include <future>
 #include "CollectionSystemManager.h"
 #include "guis/GuiMenu.h"
 #include "guis/GuiMsgBox.h"
 #include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/md5.h"
 #include "HttpApi.h"
+#include "HttpEventStream.h"
+#include "CatalogSnapshot.h"
+#include "MetadataImport.h"
+#include "Paths.h"
+#include "scrapers/Scraper.h"
 #include "Settings.h"
 #include "ApiSystem.h"
 
@@ -39,22 +54,28 @@ POST /notify													-> body must contain the message text as text/plain
 POST /launch													-> body must contain the exact file path as text/plain
 GET  /runningGame
 GET  /isIdle
+GET  /metrics													-> runtime telemetry, Prometheus text format
+GET  /events													-> Server-Sent Events : state, game-start, game-end, game-selected, system-selected, screensaver-start/stop, sleep, wake, scrape-progress/end, hash-progress/end
 
 System/Games APIS
 -----------------
 GET  /systems
 GET  /systems/{systemName}
 GET  /systems/{systemName}/logo
+GET  /systems/{systemName}/games?offset=&limit=&fields=		-> streamed game list. fields : comma separated metadata names, total in X-Total-Count
 GET  /systems/{systemName}/games/{gameId}		
 POST /systems/{systemName}/games/{gameId}						-> body must contain the game metadatas to save as application/json
 GET  /systems/{systemName}/games/{gameId}/media/{mediaType}
-POST /systems/{systemName}/games/{gameId}/media/{mediaType}		-> body must contain the file bytes to save. Content-type must be valid.
+POST /systems/{systemName}/games/{gameId}/media/{mediaType}		-> body must contain the file bytes to save. Content-type must be valid. Streamed to disk, up to "HttpServerMaxUploadSize" MB
+POST /importmetadata											-> NDJSON stream, one { "system", "id", "fields": { metadata : value } } per line. Saved in one batch
 
 Store APIs
 ----------
 POST /addgames/{systemName}										-> body must contain partial gamelist.xml file as application/xml
 POST /removegames/{systemName}									-> body must contains partial gamelist.xml file as application/xml
 
+Heavy requests ( reloadgames, addgames, removegames, importmetadata & the POST on games ) are limited to "HttpServerHeavyRequests" at once, the others get a 503 with Retry-After
+
 File APIs
 ---------
 GET /resources/{path relative to resources}"					-> any file in resources
@@ -77,6 +98,9 @@ HttpServerThread::~HttpServerThread()
 {
 	LOG(LogDebug) << "HttpServerThread : Exit";
 
+	// Wakes up the event clients before the server waits for its threads
+	HttpEventStream::stop();
+
 	if (mHttpServer != nullptr)
 	{
 		mHttpServer->stop();
@@ -101,6 +125,10 @@ static std::map<std::string, std::string> mimeTypes =
 	{ "gif", "image/gif" },
 	{ "svg", "image/svg+xml" },
 	{ "ico", "image/x-icon" },
+	{ "mp4", "video/mp4" },
+	{ "webm", "video/webm" },
+	{ "mkv", "video/x-matroska" },
+	{ "avi", "video/x-msvideo" },
 	{ "json", "application/json" },
 	{ "pdf", "application/pdf" },
 	{ "js", "application/javascript" },
@@ -136,10 +164,268 @@ static bool isAllowed(const httplib::Request& req, httplib::Response& res)
 	return true;
 }
 
+// Worker pool with a bounded queue : when every worker is busy and the queue is full, the listening thread waits
+// and the new connections stay in the socket backlog instead of piling up in memory
+class HttpTaskQueue : public httplib::TaskQueue
+{
+public:
+	HttpTaskQueue(size_t threads, size_t maxPending) : mMaxPending(maxPending), mShutdown(false)
+	{
+		for (size_t i = 0; i < threads; i++)
+			mThreads.push_back(std::thread(&HttpTaskQueue::work, this));
+	}
+
+	void enqueue(std::function<void()> fn) override
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		mSpace.wait(lock, [this] { return mJobs.size() < mMaxPending || mShutdown; });
+
+		mJobs.push_back(fn);
+		mEvent.notify_one();
+	}
+
+	void shutdown() override
+	{
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mShutdown = true;
+		}
+
+		mEvent.notify_all();
+		mSpace.notify_all();
+
+		for (auto& thread : mThreads)
+			thread.join();
+	}
+
+private:
+	void work()
+	{
+		TaskScheduler::setCurrentThreadPriority(TaskScheduler::NETWORK);
+
+		for (;;)
+		{
+			std::function<void()> fn;
+
+			{
+				std::unique_lock<std::mutex> lock(mLock);
+				mEvent.wait(lock, [this] { return !mJobs.empty() || mShutdown; });
+
+				if (mShutdown && mJobs.empty())
+					break;
+
+				fn = mJobs.front();
+				mJobs.pop_front();
+			}
+
+			mSpace.notify_one();
+			fn();
+		}
+	}
+
+	size_t mMaxPending;
+	bool mShutdown;
+
+	std::vector<std::thread> mThreads;
+	std::list<std::function<void()>> mJobs;
+	std::mutex mLock;
+	std::condition_variable mEvent;
+	std::condition_variable mSpace;
+};
+
+// Caps the requests that edit files or reload the gamelists, so they leave workers to the status endpoints
+class HeavyRequest
+{
+public:
+	HeavyRequest() : mAcquired(false) { }
+	~HeavyRequest() { if (mAcquired) mCount--; }
+
+	bool acquire(httplib::Response& res)
+	{
+		int max = std::max(1, Settings::getInstance()->getInt("HttpServerHeavyRequests"));
+		if (++mCount > max)
+		{
+			mCount--;
+
+			res.set_header("Retry-After", "1");
+			res.set_content("503 service unavailable - too many requests", "text/html");
+			res.status = 503;
+			return false;
+		}
+
+		mAcquired = true;
+		return true;
+	}
+
+private:
+	bool mAcquired;
+	static std::atomic<int> mCount;
+};
+
+std::atomic<int> HeavyRequest::mCount(0);
+
+#define SEND_FILE_BLOCK_SIZE 64 * 1024
+
+// Longest wait for the main thread to apply a bulk import, before answering 202
+#define IMPORT_APPLY_TIMEOUT_MS 10000
+
+// Resized copy of a picture, kept in cache/thumbnails : ?width=&height= on the media urls
+static std::string getThumbnail(const std::string& path, const std::string& etag, int width, int height)
+{
+	static std::mutex thumbnailsLock;
+
+	std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(path));
+	if (ext != ".jpg" && ext != ".jpeg" && ext != ".png")
+		return path;
+
+	std::string key = path + etag + std::to_string(width) + "x" + std::to_string(height);
+
+	MD5 md5;
+	md5.update(key.c_str(), key.size());
+	md5.finalize();
+
+	std::string base = Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/thumbnails/" + md5.hexdigest());
+
+	std::unique_lock<std::mutex> lock(thumbnailsLock);
+
+	if (Utils::FileSystem::exists(base + ".jpg"))
+		return base + ".jpg";
+
+	if (Utils::FileSystem::exists(base + ext))
+		return base + ext;
+
+	std::string folder = Utils::FileSystem::getParent(base);
+	if (!Utils::FileSystem::exists(folder))
+		Utils::FileSystem::createDirectory(folder);
+
+	if (!Utils::FileSystem::copyFile(path, base + ext))
+		return path;
+
+	int thumbWidth, thumbHeight;
+	std::string thumbnail = recompressImage(base + ext, width, height, 85, thumbWidth, thumbHeight);
+	if (thumbnail.empty())
+	{
+		Utils::FileSystem::removeFile(base + ext);
+		return path;
+	}
+
+	return thumbnail;
+}
+
+// Streams a file from disk with a strong ETag ( size & modification time ), answers If-None-Match with 304, and lets httplib handle the Range requests
+static bool sendFile(const httplib::Request& req, httplib::Response& res, const std::string& path)
+{
+	long long modificationTime;
+	unsigned long long size;
+	if (Utils::String::startsWith(path, ":/") || !Utils::FileSystem::getFileStamp(path, modificationTime, size))
+	{
+		auto data = ResourceManager::getInstance()->getFileData(path);
+		if (!data.ptr)
+			return false;
+
+		res.set_content((char*)data.ptr.get(), data.length, HttpServerThread::getMimeType(path).c_str());
+		return true;
+	}
+
+	int width = req.has_param("width") ? atoi(req.get_param_value("width").c_str()) : 0;
+	int height = req.has_param("height") ? atoi(req.get_param_value("height").c_str()) : 0;
+
+	std::string etag = Utils::String::format("\"%llx-%llx", size, (unsigned long long) modificationTime);
+	if (width > 0 || height > 0)
+		etag += Utils::String::format("-%dx%d", std::max(0, width), std::max(0, height));
+
+	etag += "\"";
+
+	res.set_header("ETag", etag);
+	res.set_header("Cache-Control", "no-cache");
+	res.set_header("Accept-Ranges", "bytes");
+
+	if (req.get_header_value("If-None-Match") == etag)
+	{
+		res.status = 304;
+		return true;
+	}
+
+	std::string filePath = path;
+	if (width > 0 || height > 0)
+	{
+		filePath = getThumbnail(path, etag, std::max(0, width), std::max(0, height));
+		if (filePath != path && !Utils::FileSystem::getFileStamp(filePath, modificationTime, size))
+			return false;
+	}
+
+	std::string mimeType = HttpServerThread::getMimeType(filePath);
+
+	if (size == 0)
+	{
+		res.set_content("", mimeType.c_str());
+		return true;
+	}
+
+#if WIN32
+	FILE* file = _wfopen(Utils::String::convertToWideString(filePath).c_str(), L"rb");
+#else
+	FILE* file = fopen(filePath.c_str(), "rb");
+#endif
+	if (file == nullptr)
+		return false;
+
+	std::shared_ptr<FILE> stream(file, fclose);
+
+	res.set_header("Content-Type", mimeType);
+	res.set_content_provider((size_t)size, [stream](size_t offset, size_t length, httplib::DataSink& sink)
+	{
+		char buffer[SEND_FILE_BLOCK_SIZE];
+
+		if (fseek(stream.get(), (long)offset, SEEK_SET) != 0)
+			return false;
+
+		size_t read = fread(buffer, 1, std::min(length, (size_t)SEND_FILE_BLOCK_SIZE), stream.get());
+		if (read == 0)
+			return false;
+
+		sink.write(buffer, read);
+		return true;
+	});
+
+	return true;
+}
+
+static bool isIdle()
+{
+	return
+		HttpApi::getRunnningGameInfo().empty() &&
+		!ThreadedScraper::isRunning() &&
+		!ContentInstaller::isRunning() &&
+		!ThreadedHasher::isRunning() &&
+		GuiUpdate::state != GuiUpdateState::UPDATER_RUNNING;
+}
+
+// Keeps the idle connections alive, and detects the closed ones
+#define EVENTS_HEARTBEAT_MS 15000
+
 void HttpServerThread::run()
 {
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::NETWORK);
+
 	mHttpServer = new httplib::Server();
 
+	// Each event stream keeps a worker : the pool always has room for them plus the other requests
+	int threads = Settings::getInstance()->getInt("HttpServerThreads");
+	if (threads <= 0)
+		threads = std::max(4, (int)std::thread::hardware_concurrency());
+
+	threads += HttpEventStream::MAX_CLIENTS;
+
+	mHttpServer->new_task_queue = [threads] { return new HttpTaskQueue(threads, threads * 4); };
+
+	int timeout = std::max(1, Settings::getInstance()->getInt("HttpServerTimeout"));
+	mHttpServer->set_read_timeout(timeout);
+	mHttpServer->set_write_timeout(timeout);
+	mHttpServer->set_keep_alive_max_count(std::max(1, Settings::getInstance()->getInt("HttpServerKeepAlive")));
+
+	HttpEventStream::start();
+
 	mHttpServer->Get("/", [=](const httplib::Request & req, httplib::Response &res) 
 	{
 		if (!isAllowed(req, res))
@@ -282,19 +568,70 @@ void HttpServerThread::run()
 			res.set_content(ret, "application/json");
 	});
 
-	mHttpServer->Get("/isIdle", [](const httplib::Request& req, httplib::Response& res)
+	mHttpServer->Get("/metrics", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		res.set_content(HttpApi::getMetrics(), "text/plain; version=0.0.4");
+	});
+
+	mHttpServer->Get("/events", [](const httplib::Request& req, httplib::Response& res)
 	{
 		if (!isAllowed(req, res))
 			return;
 
-		bool idle = 
-			HttpApi::getRunnningGameInfo().empty() && 
-			!ThreadedScraper::isRunning() && 
-			!ContentInstaller::isRunning() &&
-			!ThreadedHasher::isRunning() && 
-			GuiUpdate::state != GuiUpdateState::UPDATER_RUNNING;
+		if (!HttpEventStream::acquireClient())
+		{
+			res.set_content("503 too many event clients", "text/html");
+			res.status = 503;
+			return;
+		}
+
+		// Resume after the last event the client received, or start with the current state
+		unsigned int lastId = HttpEventStream::getLastId();
+
+		std::string initialMessage;
+		if (req.has_header("Last-Event-ID"))
+			lastId = (unsigned int)std::max(0, atoi(req.get_header_value("Last-Event-ID").c_str()));
+		else
+		{
+			std::string runningGame = HttpApi::getRunnningGameInfo();
+			initialMessage = "event: state\ndata: {\"idle\":" + std::string(isIdle() ? "true" : "false") + ",\"runningGame\":" + (runningGame.empty() ? std::string("null") : Utils::String::replace(Utils::String::replace(runningGame, "\r", ""), "\n", "")) + "}\n\n";
+		}
+
+		res.set_header("Content-Type", "text/event-stream");
+		res.set_header("Cache-Control", "no-cache");
+		res.set_chunked_content_provider([lastId, initialMessage](size_t offset, httplib::DataSink& sink) mutable
+		{
+			if (!initialMessage.empty())
+			{
+				sink.write(initialMessage.c_str(), initialMessage.size());
+				initialMessage.clear();
+				return true;
+			}
+
+			std::string messages;
+			if (!HttpEventStream::wait(lastId, messages, EVENTS_HEARTBEAT_MS) || !sink.is_writable())
+			{
+				sink.done();
+				return true;
+			}
+
+			if (messages.empty())
+				messages = ": ping\n\n";
 
-		if (idle)
+			sink.write(messages.c_str(), messages.size());
+			return true;
+		}, [] { HttpEventStream::releaseClient(); });
+	});
+
+	mHttpServer->Get("/isIdle", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		if (isIdle())
 		{
 			res.set_content("[ true ]", "application/json");
 			res.status = 200;
@@ -322,12 +659,8 @@ void HttpServerThread::run()
 				if (elem && elem->has("path"))
 				{
 					std::string logo = elem->get<std::string>("path");
-					auto data = ResourceManager::getInstance()->getFileData(logo);
-					if (data.ptr)
-					{
-						res.set_content((char*)data.ptr.get(), data.length, getMimeType(logo).c_str());
+					if (sendFile(req, res, logo))
 						return;
-					}
 				}
 			}
 		}
@@ -341,11 +674,30 @@ void HttpServerThread::run()
 		if (!isAllowed(req, res))
 			return;
 
-		std::string systemName = req.matches[1];
-		SystemData* system = SystemData::getSystem(systemName);
+		// Reads come from the catalog snapshot : no access to the live tree, which the main thread can reload or edit meanwhile
+		auto catalog = CatalogSnapshot::get();
+		auto system = catalog != nullptr ? catalog->getSystem(req.matches[1]) : nullptr;
 		if (system != nullptr)
 		{
-			res.set_content(HttpApi::getSystemGames(system), "application/json");
+			// ?offset=&limit= to page the list, ?fields=name,image,... to select the metadata. The total is sent in X-Total-Count
+			size_t offset = req.has_param("offset") ? (size_t)std::max(0, atoi(req.get_param_value("offset").c_str())) : 0;
+			size_t limit = req.has_param("limit") ? (size_t)std::max(0, atoi(req.get_param_value("limit").c_str())) : 0;
+
+			std::set<std::string> fields;
+			if (req.has_param("fields"))
+				for (auto field : Utils::String::split(req.get_param_value("fields"), ',', true))
+					fields.insert(Utils::String::trim(field));
+
+			// The provider keeps this version alive until the stream ends
+			res.set_header("X-Total-Count", std::to_string(system->games.size()));
+			res.set_chunked_content_provider([system, offset, limit, fields](size_t, httplib::DataSink& sink)
+			{
+				HttpApi::writeGamesJson(*system, offset, limit, fields, [&sink](const char* data, size_t size) { sink.write(data, size); });
+				sink.done();
+				return true;
+			});
+
+			res.set_header("Content-Type", "application/json");
 			return;
 		}
 		
@@ -358,30 +710,18 @@ void HttpServerThread::run()
 		if (!isAllowed(req, res))
 			return;
 
-		std::string systemName = req.matches[1];
-		SystemData* system = SystemData::getSystem(systemName);
+		auto catalog = CatalogSnapshot::get();
+		auto system = catalog != nullptr ? catalog->getSystem(req.matches[1]) : nullptr;
 		if (system != nullptr)
 		{
-			std::string gameId = req.matches[2];
-			auto game = HttpApi::findFileData(system, gameId);
+			auto game = system->findGame(req.matches[2]);
 			if (game != nullptr)
 			{
-				std::string metadataName = req.matches[3];
-
-				if (game->getMetadata().getType(metadataName) == MD_PATH)
+				auto field = game->getField(req.matches[3]);
+				if (field != nullptr && field->isPath)
 				{
-					std::string path = game->getMetadata().get(metadataName);
-					if (!path.empty())
-					{
-						auto data = ResourceManager::getInstance()->getFileData(path);
-						if (data.ptr)
-						{
-							res.set_content((char*)data.ptr.get(), data.length, getMimeType(path).c_str());
-							return;
-						}
-
-						return;
-					}
+					sendFile(req, res, field->value);
+					return;
 				}
 			}
 		}
@@ -390,17 +730,14 @@ void HttpServerThread::run()
 		res.status = 404;
 	});
 
-	mHttpServer->Post(R"(/systems/(/?.*)/games/(/?.*)/media/(/?.*))", [this](const httplib::Request& req, httplib::Response& res)
+	mHttpServer->Post(R"(/systems/(/?.*)/games/(/?.*)/media/(/?.*))", [this](const httplib::Request& req, httplib::Response& res, const httplib::ContentReader& content_reader)
 	{
 		if (!isAllowed(req, res))
 			return;
 
-		if (req.body.empty())
-		{
-			res.set_content("400 bad request - body is missing", "text/html");
-			res.status = 400;
+		HeavyRequest heavyRequest;
+		if (!heavyRequest.acquire(res))
 			return;
-		}
 
 		if (!req.has_header("Content-Type"))
 		{
@@ -410,7 +747,12 @@ void HttpServerThread::run()
 		}
 
 		std::string contentType = req.get_header_value("Content-Type");
-		
+
+		// The body is streamed to the media folder : it's only read once the game is found
+		size_t contentLength = 0;
+		if (req.has_header("Content-Length"))
+			contentLength = (size_t)strtoull(req.get_header_value("Content-Length").c_str(), nullptr, 10);
+
 		std::string systemName = req.matches[1];
 		SystemData* system = SystemData::getSystem(systemName);
 		if (system != nullptr)
@@ -423,13 +765,27 @@ void HttpServerThread::run()
 
 				if (game->getMetadata().getType(metadataName) == MD_PATH)
 				{
-					if (HttpApi::ImportMedia(game, metadataName, contentType, req.body))
+					int status = HttpApi::ImportMedia(game, metadataName, contentType, contentLength, [&content_reader](const httplib::ContentReceiver& receiver) { return content_reader(receiver); });
+					if (status == 200)
 					{
 						if (ViewController::hasInstance())
 							mWindow->postToUiThread([game]() { ViewController::get()->onFileChanged(game, FileChangeType::FILE_METADATA_CHANGED); });
 
 						return;
 					}
+
+					if (status == 400)
+						res.set_content("400 bad request - body is missing or incomplete", "text/html");
+					else if (status == 413)
+						res.set_content("413 payload too large", "text/html");
+					else if (status == 500)
+						res.set_content("500 unable to write the media", "text/html");
+
+					if (status != 404)
+					{
+						res.status = status;
+						return;
+					}
 				}
 			}
 		}
@@ -438,12 +794,55 @@ void HttpServerThread::run()
 		res.status = 404;
 	});
 
+	mHttpServer->Post("/importmetadata", [this](const httplib::Request& req, httplib::Response& res, const httplib::ContentReader& content_reader)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		HeavyRequest heavyRequest;
+		if (!heavyRequest.acquire(res))
+			return;
+
+		// Parsed & resolved while it's received
+		auto import = std::make_shared<MetadataImport>();
+		content_reader([import](const char* data, size_t length) { import->feed(data, length); return true; });
+		import->finish();
+
+		if (import->getLineCount() == 0)
+		{
+			res.set_content("400 bad request - body is missing", "text/html");
+			res.status = 400;
+			return;
+		}
+
+		// Every change in a single main thread call
+		auto done = std::make_shared<std::promise<int>>();
+		std::future<int> updated = done->get_future();
+
+		mWindow->postToUiThread([import, done]() { done->set_value(import->apply()); });
+
+		// The main loop is suspended while a game runs : the changes will be applied when it resumes
+		int count = -1;
+		if (updated.wait_for(std::chrono::milliseconds(IMPORT_APPLY_TIMEOUT_MS)) == std::future_status::ready)
+		{
+			try { count = updated.get(); }
+			catch (...) { } // Dropped at exit
+		}
+
+		res.set_content(import->getResultJson(count), "application/json");
+		if (count < 0)
+			res.status = 202;
+	});
 
 	mHttpServer->Post(R"(/systems/(/?.*)/games/(/?.*))", [this](const httplib::Request& req, httplib::Response& res)
 	{
 		if (!isAllowed(req, res))
 			return;
 
+		HeavyRequest heavyRequest;
+		if (!heavyRequest.acquire(res))
+			return;
+
 		if (req.body.empty())
 		{
 			res.set_content("400 bad request - body is missing", "text/html");
@@ -479,16 +878,15 @@ void HttpServerThread::run()
 		if (!isAllowed(req, res))
 			return;
 
-		std::string systemName = req.matches[1];
-		SystemData* system = SystemData::getSystem(systemName);
+		auto catalog = CatalogSnapshot::get();
+		auto system = catalog != nullptr ? catalog->getSystem(req.matches[1]) : nullptr;
 		if (system != nullptr)
 		{
-			std::string gameId = req.matches[2];
-			auto game = HttpApi::findFileData(system, gameId);
+			auto game = system->findGame(req.matches[2]);
 			if (game != nullptr)
 			{
 				bool localpaths = req.has_param("localpaths") && req.get_param_value("localpaths") == "true";
-				res.set_content(HttpApi::ToJson(game, localpaths), "application/json");
+				res.set_content(HttpApi::ToJson(*game, localpaths), "application/json");
 				return;
 			}
 		}
@@ -521,6 +919,10 @@ void HttpServerThread::run()
 		if (!isAllowed(req, res))
 			return;
 
+		HeavyRequest heavyRequest;
+		if (!heavyRequest.acquire(res))
+			return;
+
 		Window* w = mWindow;
 		mWindow->postToUiThread([w]()
 		{
@@ -595,6 +997,10 @@ void HttpServerThread::run()
 		if (!isAllowed(req, res))
 			return;
 
+		HeavyRequest heavyRequest;
+		if (!heavyRequest.acquire(res))
+			return;
+
 		if (req.body.empty())
 		{
 			res.set_content("400 bad request - body is missing", "text/html");
@@ -671,6 +1077,10 @@ void HttpServerThread::run()
 		if (!isAllowed(req, res))
 			return;
 
+		HeavyRequest heavyRequest;
+		if (!heavyRequest.acquire(res))
+			return;
+
 		if (req.body.empty())
 		{
 			res.set_content("400 bad request - body is missing", "text/html");
@@ -0,0 +1,209 @@
+#include "services/MetadataImport.h"
+
+#include "services/HttpApi.h"
+#include "services/CatalogSnapshot.h"
+#include "views/ViewController.h"
+#include "GamelistWriter.h"
+#include "SystemData.h"
+#include "FileData.h"
+#include "Settings.h"
+#include "Log.h"
+
+#include <unordered_map>
+#include <string.h>
+#include <rapidjson/document.h>
+
+// Longest accepted line, a game with all its fields is far below
+#define MAX_LINE_LENGTH (1024 * 1024)
+
+// Importable fields, by json name. Same names as ImportFromJson
+static const std::unordered_map<std::string, MetaDataId>& getImportableFields()
+{
+	static std::unordered_map<std::string, MetaDataId> fields = []
+	{
+		std::unordered_map<std::string, MetaDataId> ret;
+
+		for (auto& mdd : MetaDataList::getMDD())
+			if (mdd.type != MD_PATH)
+				ret[mdd.key == "id" ? "scraperId" : mdd.key] = mdd.id;
+
+		return ret;
+	}();
+
+	return fields;
+}
+
+MetadataImport::MetadataImport() : mSkipLine(false), mLines(0), mNotFound(0), mInvalid(0)
+{
+	mTreeGeneration = FolderData::getTreeGeneration();
+}
+
+void MetadataImport::feed(const char* data, size_t length)
+{
+	const char* end = data + length;
+
+	while (data < end)
+	{
+		const char* eol = (const char*)memchr(data, '\n', end - data);
+		const char* stop = eol != nullptr ? eol : end;
+
+		if (!mSkipLine && mPending.size() + (stop - data) > MAX_LINE_LENGTH)
+		{
+			mPending.clear();
+			mSkipLine = true;
+			mLines++;
+			mInvalid++;
+		}
+
+		if (!mSkipLine)
+		{
+			if (eol != nullptr && mPending.empty())
+				addLine(data, eol - data);
+			else
+			{
+				mPending.append(data, stop - data);
+
+				if (eol != nullptr)
+				{
+					addLine(mPending.data(), mPending.size());
+					mPending.clear();
+				}
+			}
+		}
+
+		if (eol != nullptr)
+			mSkipLine = false;
+
+		data = stop + (eol != nullptr ? 1 : 0);
+	}
+}
+
+void MetadataImport::finish()
+{
+	if (!mPending.empty() && !mSkipLine)
+		addLine(mPending.data(), mPending.size());
+
+	mPending.clear();
+	mSkipLine = false;
+}
+
+void MetadataImport::addLine(const char* data, size_t length)
+{
+	// Blank lines & \r\n endings
+	while (length > 0 && (data[length - 1] == '\r' || data[length - 1] == ' ' || data[length - 1] == '\t'))
+		length--;
+
+	if (length == 0)
+		return;
+
+	mLines++;
+
+	rapidjson::Document doc;
+	doc.Parse(data, length);
+
+	if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("system") || !doc["system"].IsString() ||
+		!doc.HasMember("id") || !doc["id"].IsString() || !doc.HasMember("fields") || !doc["fields"].IsObject())
+	{
+		mInvalid++;
+		return;
+	}
+
+	Change change;
+	change.system = SystemData::getSystem(doc["system"].GetString());
+	change.id = doc["id"].GetString();
+	change.file = change.system != nullptr ? HttpApi::findFileData(change.system, change.id) : nullptr;
+
+	if (change.file == nullptr)
+	{
+		mNotFound++;
+		return;
+	}
+
+	auto& importable = getImportableFields();
+
+	const rapidjson::Value& fields = doc["fields"];
+	for (auto it = fields.MemberBegin(); it != fields.MemberEnd(); ++it)
+	{
+		if (!it->value.IsString())
+			continue;
+
+		auto field = importable.find(it->name.GetString());
+		if (field != importable.cend())
+			change.values.push_back(std::pair<MetaDataId, std::string>(field->second, it->value.GetString()));
+	}
+
+	if (change.values.size())
+		mChanges.push_back(std::move(change));
+}
+
+int MetadataImport::apply()
+{
+	// The tree has been reloaded meanwhile : the games are found again from their ids
+	if (mTreeGeneration != FolderData::getTreeGeneration())
+	{
+		for (auto& change : mChanges)
+			change.file = HttpApi::findFileData(change.system, change.id);
+
+		mTreeGeneration = FolderData::getTreeGeneration();
+	}
+
+	std::set<SystemData*> systems;
+	int updated = 0;
+
+	for (auto& change : mChanges)
+	{
+		FileData* file = change.file;
+		if (file == nullptr)
+			continue;
+
+		MetaDataList& meta = file->getMetadata();
+
+		bool changed = false;
+		for (auto& value : change.values)
+		{
+			if (meta.get(value.first) != value.second)
+			{
+				changed = true;
+				break;
+			}
+		}
+
+		if (!changed)
+			continue;
+
+		// Only the entries of this game are moved in the filter index
+		SystemData* system = file->getSystem();
+		system->removeFromIndex(file);
+
+		for (auto& value : change.values)
+			meta.set(value.first, value.second);
+
+		system->addToIndex(file);
+
+		systems.insert(system);
+		updated++;
+	}
+
+	for (auto system : systems)
+	{
+		// One save for the whole batch : the dirty entries of the system are serialized together
+		if (Settings::getInstance()->getBool("SaveGamelistsOnExit"))
+			GamelistWriter::queue(system);
+
+		if (ViewController::hasInstance())
+			ViewController::get()->onFileChanged(system->getRootFolder(), FILE_METADATA_CHANGED);
+		else
+			CatalogSnapshot::invalidate(system);
+	}
+
+	LOG(LogInfo) << "MetadataImport : " << updated << " games updated in " << systems.size() << " systems, " << mNotFound << " not found, " << mInvalid << " invalid lines";
+	return updated;
+}
+
+std::string MetadataImport::getResultJson(int updated) const
+{
+	return "{\"lines\":" + std::to_string(mLines) +
+		",\"updated\":" + (updated < 0 ? std::string("null") : std::to_string(updated)) +
+		",\"notFound\":" + std::to_string(mNotFound) +
+		",\"invalid\":" + std::to_string(mInvalid) + "}";
+}
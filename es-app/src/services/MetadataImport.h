@@ -0,0 +1,57 @@
+#pragma once
+#ifndef ES_APP_SERVICES_METADATA_IMPORT_H
+#define ES_APP_SERVICES_METADATA_IMPORT_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <utility>
+#include "MetaData.h"
+
+class SystemData;
+class FileData;
+
+// Bulk metadata import of the web server : one { "system": name, "id": game id, "fields": { key: value } } json object per line.
+// The lines are parsed & resolved through the game id index while the request is received, then all the changes are applied
+// in a single call on the main thread, with one gamelist save per system instead of one per game
+class MetadataImport
+{
+public:
+	MetadataImport();
+
+	// Any thread. Chunks of the stream, cut anywhere
+	void feed(const char* data, size_t length);
+	void finish();
+
+	// Main thread. Returns the number of games that changed
+	int apply();
+
+	int getLineCount() const { return mLines; }
+	int getNotFoundCount() const { return mNotFound; }
+	int getInvalidCount() const { return mInvalid; }
+
+	std::string getResultJson(int updated) const;
+
+private:
+	struct Change
+	{
+		SystemData* system;
+		std::string id;
+		FileData* file;
+		std::vector<std::pair<MetaDataId, std::string>> values;
+	};
+
+	void addLine(const char* data, size_t length);
+
+	std::vector<Change> mChanges;
+	unsigned int mTreeGeneration; // FolderData::getTreeGeneration when the games were resolved
+
+	std::string mPending; // Incomplete last line
+	bool mSkipLine; // Line too long, ignored up to its end
+
+	int mLines;
+	int mNotFound;
+	int mInvalid;
+};
+
+#endif // ES_APP_SERVICES_METADATA_IMPORT_H
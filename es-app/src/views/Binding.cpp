@@ -13,6 +13,8 @@
 #include "utils/Platform.h"
 #include "SystemConf.h"
 #include "utils/MathExpr.h"
+#include "utils/StringTemplate.h"
+#include <unordered_map>
 
 static std::string valueOrUnknown(const std::string& value) 
 { 
@@ -71,6 +73,270 @@ static std::string getGlobalProperty(const std::string& name)
 
 static Utils::MathExpr evaluator;
 
+enum BindingKind
+{
+	BINDING_GAME = 0,
+	BINDING_BINDING,
+	BINDING_SYSTEM,
+	BINDING_GLOBAL
+};
+
+// Same order as BindingKind
+static const std::vector<Utils::StringTemplate::Delimiter> sBindingDelimiters = { { "{game:", "}" }, { "{binding:", "}" }, { "{system:", "}" }, { "{global:", "}" } };
+
+// Binding expressions are evaluated at each cursor move : they're parsed once ( UI thread only )
+struct CompiledBinding
+{
+	CompiledBinding() : isExpression(false), hasProgram(false) { }
+
+	struct Slot
+	{
+		char quote; // 0 for a bare reference, that must resolve to a number
+		std::vector<Utils::StringTemplate::Segment> segments;
+	};
+
+	Utils::StringTemplate text;
+	bool isExpression;
+
+	// Boolean expressions, with their references as variables of the program
+	bool hasProgram;
+	Utils::MathExpr::Program program;
+	std::vector<Slot> slots;
+	std::string yes; // Language the program was compiled with
+};
+
+static std::unordered_map<std::string, CompiledBinding> sCompiledBindings;
+
+static bool isBindingExpression(const std::string& expression)
+{
+	for (char ch : expression)
+		if (ch == ' ' || ch == '=' || ch == '<' || ch == '>' || ch == '&' || ch == '|' || ch == '+' || ch == '-')
+			return true;
+
+	return false;
+}
+
+static std::string replaceYesNo(const std::string& value)
+{
+	std::string ret = Utils::String::replace(value, _("YES"), "1");
+	return Utils::String::replace(ret, _("NO"), "0");
+}
+
+// A character that can't be glued to a number by the tokenizer
+static bool isNumberBoundary(char ch)
+{
+	return !(isalnum((unsigned char)ch) || ch == '_' || ch == '.' || ch == '{' || ch == '}' || ch == '$' || ch == '\'' || ch == '"');
+}
+
+// References become the "{__bN}" variables : a whole quoted string when they're inside one, otherwise a number.
+// Returns false when the program could not give the same result as evaluating the substituted text
+static bool compileProgram(CompiledBinding& binding)
+{
+	binding.slots.clear();
+
+	std::string source;
+	std::string literals; // Unquoted text, where an identifier makes the substituted text fail to evaluate
+	std::vector<std::string> slotNames;
+
+	CompiledBinding::Slot quoted;
+	quoted.quote = 0;
+
+	bool lastWasBare = false;
+
+	auto addSlot = [&](const CompiledBinding::Slot& slot)
+	{
+		std::string name = "__b" + std::to_string(binding.slots.size());
+		slotNames.push_back(name);
+		binding.slots.push_back(slot);
+		source += "{" + name + "}";
+		literals += ' ';
+	};
+
+	for (auto& segment : binding.text.segments())
+	{
+		if (segment.kind != Utils::StringTemplate::LITERAL)
+		{
+			if (quoted.quote != 0)
+				quoted.segments.push_back(segment);
+			else
+			{
+				if (lastWasBare || (!source.empty() && !isNumberBoundary(source.back())))
+					return false;
+
+				CompiledBinding::Slot bare;
+				bare.quote = 0;
+				bare.segments.push_back(segment);
+				addSlot(bare);
+				lastWasBare = true;
+			}
+
+			continue;
+		}
+
+		for (char ch : segment.text)
+		{
+			if (quoted.quote == 0)
+			{
+				if (lastWasBare && !isNumberBoundary(ch))
+					return false;
+
+				lastWasBare = false;
+
+				if (ch == '\'' || ch == '"')
+				{
+					quoted.quote = ch;
+					quoted.segments.clear();
+				}
+				else
+				{
+					source += ch;
+					literals += ch;
+				}
+			}
+			else if (ch == quoted.quote)
+			{
+				bool hasReference = false;
+				for (auto& part : quoted.segments)
+					hasReference |= (part.kind != Utils::StringTemplate::LITERAL);
+
+				if (hasReference)
+					addSlot(quoted);
+				else
+				{
+					source += quoted.quote;
+					for (auto& part : quoted.segments)
+						source += part.text;
+					source += quoted.quote;
+				}
+
+				quoted.quote = 0;
+			}
+			else if (!quoted.segments.empty() && quoted.segments.back().kind == Utils::StringTemplate::LITERAL)
+				quoted.segments.back().text += ch;
+			else
+				quoted.segments.push_back({ Utils::StringTemplate::LITERAL, std::string(1, ch) });
+		}
+	}
+
+	if (quoted.quote != 0)
+		return false;
+
+	for (char ch : replaceYesNo(literals))
+		if (isalpha((unsigned char)ch) || ch == '_' || ch == '{' || ch == '$')
+			return false;
+
+	try
+	{
+		binding.program = evaluator.compile(replaceYesNo(source).c_str(), slotNames);
+	}
+	catch (...)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+static CompiledBinding& getCompiledBinding(const std::string& expression)
+{
+	auto it = sCompiledBindings.find(expression);
+	if (it == sCompiledBindings.cend())
+	{
+		CompiledBinding binding;
+		binding.text = Utils::StringTemplate(expression, sBindingDelimiters);
+		binding.isExpression = isBindingExpression(expression);
+
+		it = sCompiledBindings.insert(std::pair<std::string, CompiledBinding>(expression, binding)).first;
+	}
+
+	CompiledBinding& binding = it->second;
+	if (binding.isExpression && binding.text.hasVariables() && binding.yes != _("YES"))
+	{
+		binding.yes = _("YES");
+		binding.hasProgram = compileProgram(binding);
+	}
+
+	return binding;
+}
+
+static void resolveBinding(std::string& output, int kind, const std::string& name, FileData* file, SystemData* system, bool isText, bool showDefaultText)
+{
+	if (kind == BINDING_GAME && file != nullptr)
+	{
+		std::string data = file->getProperty(name);
+		output.append(isText && showDefaultText ? valueOrUnknown(data) : data);
+	}
+	else if ((kind == BINDING_BINDING || kind == BINDING_SYSTEM) && system != nullptr)
+	{
+		std::string data = system->getProperty(name);
+		output.append(showDefaultText ? valueOrUnknown(data) : data);
+	}
+	else if (kind == BINDING_GLOBAL)
+	{
+		std::string data = getGlobalProperty(name);
+		output.append(showDefaultText ? valueOrUnknown(data) : data);
+	}
+	else // No source, the reference is kept as is
+		output.append(sBindingDelimiters[kind].start + name + sBindingDelimiters[kind].end);
+}
+
+// Evaluates the program of a boolean binding. False when the values don't fit it, the substituted text has to be evaluated then
+static bool evaluateProgram(const CompiledBinding& binding, FileData* file, SystemData* system, bool isText, bool showDefaultText, bool& value)
+{
+	std::vector<Utils::MathExpr::Value> values;
+	values.reserve(binding.slots.size());
+
+	std::string data;
+
+	for (auto& slot : binding.slots)
+	{
+		data.clear();
+
+		for (auto& segment : slot.segments)
+		{
+			if (segment.kind == Utils::StringTemplate::LITERAL)
+				data.append(segment.text);
+			else
+				resolveBinding(data, segment.kind, segment.text, file, system, isText, showDefaultText);
+		}
+
+		data = replaceYesNo(data);
+
+		if (slot.quote != 0)
+		{
+			if (data.find(slot.quote) != std::string::npos)
+				return false;
+
+			values.push_back(Utils::MathExpr::Value(data));
+			continue;
+		}
+
+		if (data.empty() || !isdigit((unsigned char)data[0]))
+			return false;
+
+		char* end = nullptr;
+		float number = strtod(data.c_str(), &end);
+		if (end == nullptr || *end != 0)
+			return false;
+
+		values.push_back(Utils::MathExpr::Value(number));
+	}
+
+	try
+	{
+		auto ret = evaluator.eval(binding.program, values);
+		if (ret.type != Utils::MathExpr::NUMBER)
+			return false;
+
+		value = (ret.number != 0);
+		return true;
+	}
+	catch (...)
+	{
+		return false;
+	}
+}
+
 static void _updateBindings(GuiComponent* comp, FileData* file, SystemData* system, bool showDefaultText)
 {
 	if (comp == nullptr || comp->getExtraType() == ExtraType::BUILTIN)
@@ -81,65 +347,42 @@ static void _updateBindings(GuiComponent* comp, FileData* file, SystemData* syst
 
 	TextComponent* text = dynamic_cast<TextComponent*>(comp);
 
-	auto expressions = comp->getBindingExpressions();
-	for (auto expression : expressions)
+	auto& expressions = comp->getBindingExpressions();
+	for (auto& expression : expressions)
 	{
-		std::string xp = expression.second;
-		if (xp.empty())
+		if (expression.second.empty())
 			continue;
 
-		std::string propertyName = expression.first;
+		const std::string& propertyName = expression.first;
 
 		auto existing = comp->getProperty(propertyName);
 		if (existing.type == ThemeData::ThemeElement::Property::PropertyType::Unknown)
 			continue;
 
-		bool negate = xp[0] == '!';
-		if (negate)
-			xp = xp.substr(1);
-
-		if (file != nullptr)
-		{
-			for (auto name : Utils::String::extractStrings(xp, "{game:", "}"))
-			{
-				std::string data = file->getProperty(name);
+		bool negate = expression.second[0] == '!';
 
-				if (text != nullptr && showDefaultText)
-					data = valueOrUnknown(data);
+		auto& compiled = getCompiledBinding(negate ? expression.second.substr(1) : expression.second);
 
-				xp = Utils::String::replace(xp, "{game:" + name + "}", data);
-			}
-		}
-
-		if (system != nullptr)
+		if (existing.type == ThemeData::ThemeElement::Property::PropertyType::Bool && compiled.hasProgram)
 		{
-			for (auto name : Utils::String::extractStrings(xp, "{binding:", "}"))
-			{
-				auto val = system->getProperty(name);
-				if (showDefaultText)
-					val = valueOrUnknown(val);
-
-				xp = Utils::String::replace(xp, "{binding:" + name + "}", val);
-			}
-
-			for (auto name : Utils::String::extractStrings(xp, "{system:", "}"))
+			bool value = false;
+			if (evaluateProgram(compiled, file, system, text != nullptr, showDefaultText, value))
 			{
-				auto val = system->getProperty(name);
-				if (showDefaultText)
-					val = valueOrUnknown(val);
-
-				xp = Utils::String::replace(xp, "{system:" + name + "}", val);
+				comp->setProperty(propertyName, negate ? !value : value);
+				continue;
 			}
 		}
 
-		for (auto name : Utils::String::extractStrings(xp, "{global:", "}"))
+		std::string xp;
+		if (compiled.text.hasVariables())
 		{
-			auto val = getGlobalProperty(name);
-			if (showDefaultText)
-				val = valueOrUnknown(val);
-
-			xp = Utils::String::replace(xp, "{global:" + name + "}", val);
+			xp = compiled.text.evaluate([file, system, text, showDefaultText](std::string& output, int kind, const std::string& name)
+			{
+				resolveBinding(output, kind, name, file, system, text != nullptr, showDefaultText);
+			});
 		}
+		else
+			xp = negate ? expression.second.substr(1) : expression.second;
 
 		switch (existing.type)
 		{
@@ -154,27 +397,13 @@ static void _updateBindings(GuiComponent* comp, FileData* file, SystemData* syst
 			break;
 		case ThemeData::ThemeElement::Property::PropertyType::Bool:
 		{
-			bool isExpression = false;
-
-			for (char ch : expression.second)
-			{
-				if (ch == ' ' || ch == '=' || ch == '<' || ch == '>' || ch == '&' || ch == '|' || ch == '+' || ch == '-')
-				{
-					isExpression = true;
-					break;
-				}
-			}
-
 			bool value = xp == _("YES");
 
-			if (isExpression)
+			if (compiled.isExpression)
 			{
 				try
 				{
-					std::string evalxp = Utils::String::replace(xp, _("YES"), "1");
-					evalxp = Utils::String::replace(evalxp, _("NO"), "0");
-
-					auto ret = evaluator.eval(evalxp.c_str());
+					auto ret = evaluator.eval(replaceYesNo(xp).c_str());
 					if (ret.type == Utils::MathExpr::NUMBER)
 						value = (ret.number != 0);
 				}
@@ -31,6 +31,9 @@
 const int logoBuffersLeft[] = { -5, -2, -1 };
 const int logoBuffersRight[] = { 1, 2, 5 };
 
+#define LOGO_WINDOW_MARGIN		5	// Logos kept loaded on each side of the visible ones, the largest render buffer
+#define EXTRAS_WINDOW			3	// Extras kept loaded on each side of the cursor, as far as preloadExtraNeighbours goes
+
 SystemView::SystemView(Window* window) : IList<SystemViewData, SystemData*>(window, LIST_SCROLL_STYLE_SLOW, LIST_ALWAYS_LOOP),
 										 mViewNeedsReload(true),
 										 mSystemInfo(window, _("SYSTEM INFO"), Font::get(FONT_SIZE_SMALL), 0x33333300, ALIGN_CENTER), mYButton("y")
@@ -71,6 +74,7 @@ void SystemView::clearEntries()
 			delete extra;
 
 		mEntries[i].data.backgroundExtras.clear();
+		mEntries[i].data.extrasLoaded = false;
 	}
 
 	mEntries.clear();
@@ -94,7 +98,8 @@ void SystemView::reloadTheme(SystemData* system)
 				e.data.logo->applyTheme(theme, "system", "logo", ThemeFlags::COLOR | ThemeFlags::ALIGNMENT | ThemeFlags::VISIBLE);
 		}
 
-		loadExtras(system, e);
+		if (e.data.extrasLoaded)
+			loadExtras(system, e);
 	}
 }
 
@@ -152,7 +157,84 @@ void SystemView::loadExtras(SystemData* system, IList<SystemViewData, SystemData
 		return b->getZIndex() > a->getZIndex();
 	});
 
-	SystemRandomPlaylist::resetCache();
+	e.data.extrasLoaded = true;
+}
+
+void SystemView::ensureExtras(IList<SystemViewData, SystemData*>::Entry& e)
+{
+	if (!e.data.extrasLoaded)
+		loadExtras(e.object, e);
+}
+
+void SystemView::releaseExtras(int cursor)
+{
+	auto& e = mEntries.at(cursor);
+	if (!e.data.extrasLoaded)
+		return;
+
+	setExtraRequired(cursor, false);
+
+	for (auto extra : e.data.backgroundExtras)
+	{
+		extra->onHide();
+		delete extra;
+	}
+
+	e.data.backgroundExtras.clear();
+	e.data.extrasLoaded = false;
+}
+
+// Logos & extras live in a window around the cursor : the entries leaving it are released with their textures,
+// the ones entering it are created nearest first, ahead of the scroll direction. preloadExtraNeighbours then orders their textures
+void SystemView::updateWindow()
+{
+	int count = (int)mEntries.size();
+	if (count == 0 || mCursor < 0 || mCursor >= count)
+		return;
+
+	int logoWindow = mCarousel.maxLogoCount / 2 + LOGO_WINDOW_MARGIN;
+
+	for (int i = 0; i < count; i++)
+	{
+		// The previous cursor is still rendered by the transition
+		if (i == mCursor || i == mLastCursor || i == mExtrasFadeOldCursor)
+			continue;
+
+		int distance = abs(i - mCursor);
+		distance = Math::min(distance, count - distance);
+
+		if (distance > logoWindow)
+			mEntries.at(i).data.logo = nullptr;
+
+		if (distance > EXTRAS_WINDOW)
+			releaseExtras(i);
+	}
+
+	int direction = getScrollingVelocity() < 0 ? -1 : 1;
+	int prefetch = Math::max(EXTRAS_WINDOW, mCarousel.maxLogoCount / 2 + 1);
+
+	for (int d = 0; d <= prefetch && d * 2 <= count; d++)
+	{
+		for (int side = 0; side < (d == 0 ? 1 : 2); side++)
+		{
+			int index = (mCursor + (side == 0 ? direction : -direction) * d) % count;
+			if (index < 0)
+				index += count;
+
+			auto& entry = mEntries.at(index);
+
+			if (d <= EXTRAS_WINDOW)
+				ensureExtras(entry);
+
+			if (d <= mCarousel.maxLogoCount / 2 + 1)
+			{
+				ensureLogo(entry);
+
+				if (entry.data.logo->isKindOf<ImageComponent>())
+					((ImageComponent*)entry.data.logo.get())->setLoadPriority(d * 2 + side);
+			}
+		}
+	}
 }
 
 void SystemView::ensureLogo(IList<SystemViewData, SystemData*>::Entry& entry)
@@ -280,13 +362,13 @@ void SystemView::populate()
 			e.name = (*it)->getName();
 			e.object = *it;
 
-			ensureLogo(e);
-			loadExtras(*it, e);
-
 			add(e);
 		}
 	}
 
+	// Logos & extras are loaded around the cursor only
+	updateWindow();
+
 	TextureLoader::paused = false;
 
 	if (mEntries.size() == 0)
@@ -471,13 +553,13 @@ bool SystemView::input(InputConfig* config, Input input)
 				listInput(1);
 				return true;
 			}
-			if ((Settings::getInstance()->getBool("QuickSystemSelect") && config->isMappedLike("right", input)) || config->isMappedTo("pagedown", input))
+			if ((Settings::get(BoolSetting::QuickSystemSelect) && config->isMappedLike("right", input)) || config->isMappedTo("pagedown", input))
 			{
 				int cursor = moveCursorFast(true);
 				listInput(cursor - mCursor);				
 				return true;
 			}
-			if ((Settings::getInstance()->getBool("QuickSystemSelect") && config->isMappedLike("left", input)) || config->isMappedTo("pageup", input))
+			if ((Settings::get(BoolSetting::QuickSystemSelect) && config->isMappedLike("left", input)) || config->isMappedTo("pageup", input))
 			{
 				int cursor = moveCursorFast(false);
 				listInput(cursor - mCursor);
@@ -498,13 +580,13 @@ bool SystemView::input(InputConfig* config, Input input)
 				listInput(1);
 				return true;
 			}
-			if ((Settings::getInstance()->getBool("QuickSystemSelect") && config->isMappedLike("down", input)) || config->isMappedTo("pagedown", input))
+			if ((Settings::get(BoolSetting::QuickSystemSelect) && config->isMappedLike("down", input)) || config->isMappedTo("pagedown", input))
 			{
 				int cursor = moveCursorFast(true);
 				listInput(cursor - mCursor);
 				return true;
 			}
-			if ((Settings::getInstance()->getBool("QuickSystemSelect") && config->isMappedLike("up", input)) || config->isMappedTo("pageup", input))
+			if ((Settings::get(BoolSetting::QuickSystemSelect) && config->isMappedLike("up", input)) || config->isMappedTo("pageup", input))
 			{
 				int cursor = moveCursorFast(false);
 				listInput(cursor - mCursor);
@@ -553,7 +635,7 @@ bool SystemView::input(InputConfig* config, Input input)
 			listInput(0);
 		/*
 #ifdef WIN32		
-		if(!UIModeController::getInstance()->isUIModeKid() && config->isMappedTo("select", input) && Settings::getInstance()->getBool("ScreenSaverControls"))
+		if(!UIModeController::getInstance()->isUIModeKid() && config->isMappedTo("select", input) && Settings::get(BoolSetting::ScreenSaverControls))
 		{
 			mWindow->startScreenSaver();
 			mWindow->renderScreenSaver();
@@ -659,13 +741,15 @@ void SystemView::update(int deltaTime)
 	listUpdate(deltaTime);
 	mSystemInfo.update(deltaTime);
 
+	// The logos & extras of the systems far from the screen are mostly static : only the ones with something to tick are updated
 	for (auto it = mEntries.cbegin(); it != mEntries.cend(); it++)
 	{
-		if (it->data.logo)
+		if (it->data.logo && it->data.logo->hasUpdateActivity())
 			it->data.logo->update(deltaTime);
 
 		for (auto xt : it->data.backgroundExtras)
-			xt->update(deltaTime);
+			if (xt->hasUpdateActivity())
+				xt->update(deltaTime);
 	}
 	
 	GuiComponent::update(deltaTime);
@@ -699,6 +783,7 @@ void SystemView::onCursorChanged(const CursorState& state)
 		AudioManager::getInstance()->changePlaylist(getSelected()->getTheme());
 	
 	ensureLogo(mEntries.at(mCursor));
+	updateWindow();
 
 	// update help style
 	updateHelpPrompts();
@@ -1401,7 +1486,8 @@ void SystemView::renderExtras(const Transform4x4f& trans, float lower, float upp
 			continue;
 
 		Entry& entry = mEntries.at(index);
-		
+		ensureExtras(entry);
+
 		Vector2i size = Vector2i(Math::round(mSize.x()), Math::round(mSize.y()));
 
 		Transform4x4f extrasTrans = trans;
@@ -1766,6 +1852,9 @@ void SystemView::activateExtras(int cursor, bool activate)
 
 	bool show = activate && isShowing() && !mScreensaverActive && !mDisable;
 
+	if (activate)
+		ensureExtras(mEntries.at(cursor));
+
 	SystemViewData data = mEntries.at(cursor).data;
 	for (unsigned int j = 0; j < data.backgroundExtras.size(); j++)
 	{
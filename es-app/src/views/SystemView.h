@@ -26,6 +26,7 @@ struct SystemViewData
 {
 	std::shared_ptr<GuiComponent> logo;
 	std::vector<GuiComponent*> backgroundExtras;
+	bool extrasLoaded = false;
 };
 
 struct SystemViewCarousel
@@ -101,6 +102,9 @@ private:
 
 	void	 ensureLogo(IList<SystemViewData, SystemData*>::Entry& entry);
 	void	 loadExtras(SystemData* system, IList<SystemViewData, SystemData*>::Entry& e);
+	void	 ensureExtras(IList<SystemViewData, SystemData*>::Entry& e);
+	void	 releaseExtras(int cursor);
+	void	 updateWindow();
 	void	 updateExtraTextBinding();
 	void	 showQuickSearch();
 
@@ -12,6 +12,7 @@
 #include "views/gamelist/CarouselGameListView.h"
 #include "views/SystemView.h"
 #include "views/UIModeController.h"
+#include "Trace.h"
 #include "FileFilterIndex.h"
 #include "Log.h"
 #include "Scripting.h"
@@ -27,9 +28,18 @@
 #include "ApiSystem.h"
 #include "guis/GuiMsgBox.h"
 #include "utils/ThreadPool.h"
+#include "resources/TextureResource.h"
 #include <SDL_timer.h>
 #include "TextToSpeech.h"
 #include "VolumeControl.h"
+#include "services/CatalogSnapshot.h"
+#include "RandomGamePool.h"
+#include "MemoryStats.h"
+#include "MemoryProfile.h"
+#include "SoundBank.h"
+
+#define PRELOAD_FRAME_BUDGET	8	// ms of a frame given to the deferred gamelist views, one view at least
+#define LOW_MEMORY_GAMELIST_VIEWS	2
 
 ViewController* ViewController::sInstance = nullptr;
 
@@ -193,6 +203,8 @@ void ViewController::goToSystemView(SystemData* system, bool forceImmediate)
 	mState.viewing = SYSTEM_SELECT;
 	mState.system = dest;
 
+	TextureResource::setViewPool(POOL_SYSTEMVIEW);
+
 	Scripting::fireEvent("system-selected", dest->getName());
 
 	systemList->goToSystem(dest, false);
@@ -317,6 +329,8 @@ void ViewController::goToGameList(SystemData* system, bool forceImmediate)
 	
 	mState.viewing = GAME_LIST;
 	mState.system = destinationSystem;
+
+	TextureResource::setViewPool(POOL_GAMELIST);
 	
 	if (collectionFolder != nullptr)
 	{
@@ -426,6 +440,9 @@ void ViewController::onFileChanged(FileData* file, FileChangeType change)
 	std::string key = file->getFullPath();
 	auto sourceSystem = file->getSourceFileData()->getSystem();
 
+	CatalogSnapshot::invalidate(sourceSystem);
+	RandomGamePool::invalidate(sourceSystem);
+
 	auto it = mGameListViews.find(sourceSystem);
 	if (it != mGameListViews.cend())
 		it->second->onFileChanged(file, change);
@@ -445,14 +462,14 @@ void ViewController::onFileChanged(FileData* file, FileChangeType change)
 	for (auto collection : CollectionSystemManager::get()->getAutoCollectionSystems())
 	{		
 		auto cit = mGameListViews.find(collection.second.system);
-		if (cit != mGameListViews.cend() && collection.second.system->getRootFolder()->FindByPath(key))
+		if (cit != mGameListViews.cend() && CollectionFileData::findEntry(file, collection.second.system->getRootFolder()) != nullptr)
 			cit->second->onFileChanged(file, change);
 	}
 
 	for (auto collection : CollectionSystemManager::get()->getCustomCollectionSystems())
 	{
 		auto cit = mGameListViews.find(collection.second.system);
-		if (cit != mGameListViews.cend() && collection.second.system->getRootFolder()->FindByPath(key))
+		if (cit != mGameListViews.cend() && CollectionFileData::findEntry(file, collection.second.system->getRootFolder()) != nullptr)
 			cit->second->onFileChanged(file, change);
 	}
 }
@@ -471,7 +488,7 @@ bool ViewController::doLaunchGame(FileData* game, LaunchGameOptions options)
 bool ViewController::checkLaunchOptions(FileData* game, LaunchGameOptions options, Vector3f center)
 {
 #ifdef _RPI_
-	if (Settings::getInstance()->getBool("VideoOmxPlayer") && mCurrentView)
+	if (Settings::get(BoolSetting::VideoOmxPlayer) && mCurrentView)
 		mCurrentView->onHide();
 #endif
 
@@ -524,7 +541,7 @@ void ViewController::launch(FileData* game, LaunchGameOptions options, Vector3f
 
 	if (game->getSourceFileData()->getSystem()->hasPlatformId(PlatformIds::IMAGEVIEWER))
 	{
-		auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(game->getPath()));
+		auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(game->getLeafName()));
 
 		if (Utils::FileSystem::isVideo(game->getPath()))
 			GuiVideoViewer::playVideo(mWindow, game->getPath());
@@ -653,6 +670,57 @@ void ViewController::removeGameListView(SystemData* system)
 		exists->second.reset();
 		mGameListViews.erase(system);
 	}
+
+	mGameListLru.remove(system);
+}
+
+void ViewController::touchGameListView(SystemData* system)
+{
+	if (mGameListLru.size() > 0 && mGameListLru.front() == system)
+		return;
+
+	mGameListLru.remove(system);
+	mGameListLru.push_front(system);
+}
+
+// Cold views go once there are more than "GameListViewCacheSize" of them ( LOW_MEMORY_GAMELIST_VIEWS with the low-memory profile ), or once the textures they hold exceed "GameListViewCacheMemory" MB.
+// The filters live in the systems, the cursor is kept here for the rebuild
+void ViewController::unloadColdGameListViews()
+{
+	int maxCount = Settings::getInstance()->getInt("GameListViewCacheSize");
+	if (MemoryProfile::isLowMemory() && (maxCount <= 0 || maxCount > LOW_MEMORY_GAMELIST_VIEWS))
+		maxCount = LOW_MEMORY_GAMELIST_VIEWS;
+	size_t maxMemory = (size_t)Math::max(0, Settings::getInstance()->getInt("GameListViewCacheMemory")) * 1024 * 1024;
+
+	while (mGameListLru.size() > 1)
+	{
+		bool overCount = maxCount > 0 && (int)mGameListViews.size() > maxCount;
+		bool overMemory = maxMemory > 0 && TextureResource::getTotalTextureSize() > maxMemory;
+		if (!overCount && !overMemory)
+			break;
+
+		SystemData* system = nullptr;
+
+		for (auto it = mGameListLru.rbegin(); it != mGameListLru.rend(); it++)
+		{
+			auto view = mGameListViews.find(*it);
+			if (view != mGameListViews.cend() && view->second.get() != mCurrentView.get() && view->second.use_count() == 1)
+			{
+				system = *it;
+				break;
+			}
+		}
+
+		if (system == nullptr)
+			break;
+
+		FileData* cursor = mGameListViews[system]->getCursor();
+		if (cursor != nullptr && !cursor->isPlaceHolder())
+			mUnloadedCursors[system->getName()] = cursor->getPath();
+
+		LOG(LogDebug) << "ViewController : unloading the gamelist view of " << system->getName();
+		removeGameListView(system);
+	}
 }
 
 std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* system, bool loadIfnull, const std::function<void()>& createAsPopupAndSetExitFunction)
@@ -662,7 +730,10 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 		//if we already made one, return that one
 		auto exists = mGameListViews.find(system);
 		if (exists != mGameListViews.cend())
+		{
+			touchGameListView(system);
 			return exists->second;
+		}
 
 		if (!loadIfnull)
 			return nullptr;
@@ -814,6 +885,23 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 
 		addChild(view.get());
 		mGameListViews[system] = view;
+		touchGameListView(system);
+
+		// Rebuilt after an unload : back to the same game
+		auto cursor = mUnloadedCursors.find(system->getName());
+		if (cursor != mUnloadedCursors.cend())
+		{
+			for (auto file : system->getRootFolder()->getFilesRecursive(GAME | FOLDER, true))
+			{
+				if (file->getPath() == cursor->second)
+				{
+					view->setCursor(file);
+					break;
+				}
+			}
+
+			mUnloadedCursors.erase(cursor);
+		}
 	}
 
 	return view;
@@ -923,6 +1011,12 @@ void ViewController::update(int deltaTime)
 		mCurrentView->update(deltaTime);
 
 	updateSelf(deltaTime);
+	updatePreload();
+
+	CatalogSnapshot::update();
+
+	if (!isAnimationPlaying(0) && mDeferPlayViewTransitionTo == nullptr)
+		unloadColdGameListViews();
 
 	if (mDeferPlayViewTransitionTo != nullptr)
 	{
@@ -943,12 +1037,6 @@ void ViewController::update(int deltaTime)
 void ViewController::render(const Transform4x4f& parentTrans)
 {
 	Transform4x4f trans = mCamera * parentTrans;
-	Transform4x4f transInverse;
-	transInverse.invert(trans);
-
-	// camera position, position + size
-	Vector3f viewStart = transInverse.translation();
-	Vector3f viewEnd = transInverse * Vector3f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight(), 0);
 
 	if (!isAnimationPlaying(0) && mCurrentView != nullptr)
 	{
@@ -956,20 +1044,14 @@ void ViewController::render(const Transform4x4f& parentTrans)
 	}
 	else
 	{
-		// draw systemview
-		getSystemListView()->render(trans);
+		// draw systemview & the gamelists that are, even partially, on screen during the slide
+		auto systemView = getSystemListView();
+		if (systemView->isSubtreeVisible(trans))
+			systemView->render(trans);
 
-		// draw gamelists
 		for (auto it = mGameListViews.cbegin(); it != mGameListViews.cend(); it++)
-		{
-			// clipping
-			Vector3f guiStart = it->second->getPosition();
-			Vector3f guiEnd = it->second->getPosition() + Vector3f(it->second->getSize().x(), it->second->getSize().y(), 0);
-
-			//	if (guiEnd.x() >= viewStart.x() && guiEnd.y() >= viewStart.y() && guiStart.x() <= viewEnd.x() && guiStart.y() <= viewEnd.y())
-			if (guiEnd.x() > viewStart.x() && guiEnd.y() > viewStart.y() && guiStart.x() < viewEnd.x() && guiStart.y() < viewEnd.y())
+			if (it->second->isSubtreeVisible(trans))
 				it->second->render(trans);
-		}
 	}
 
 	if(mWindow->peekGui() == this)
@@ -995,21 +1077,57 @@ void ViewController::preload()
 	if (!preloadUI)
 		return;
 
+	TraceSpan span("ViewController::preload");
+
 	mWindow->renderSplashScreen(_("Preloading UI"), 0);
 	getSystemListView();
 
-	int i = 1;
-	int max = SystemData::sSystemVector.size() + 1;
-	bool splash = preloadUI && Settings::getInstance()->getBool("SplashScreen") && Settings::getInstance()->getBool("SplashScreenProgress");
+	std::vector<SystemData*> systems;
+	for (auto system : SystemData::sSystemVector)
+		if (!system->isGroupChildSystem() && system->isVisible())
+			systems.push_back(system);
 
-	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
-	{		
-		if ((*it)->isGroupChildSystem() || !(*it)->isVisible())
+	bool splash = Settings::getInstance()->getBool("SplashScreen") && Settings::getInstance()->getBool("SplashScreenProgress");
+
+	if (Settings::getInstance()->getBool("PreloadUIDeferred"))
+	{
+		// The filters don't touch the UI : reset them on the pool, the views are built later by update(), a few per frame
+		int processedSystem = 0;
+		int systemCount = systems.size();
+
+		Utils::ThreadPool pool;
+
+		for (auto system : systems)
 		{
-			i++;
-			continue;
+			pool.queueWorkItem([system, &processedSystem]
+			{
+				system->resetFilters();
+				processedSystem++;
+			});
 		}
 
+		if (splash)
+		{
+			Window* window = mWindow;
+			pool.wait([window, &processedSystem, systemCount]
+			{
+				int px = processedSystem;
+				if (px >= 0 && px < systemCount)
+					window->renderSplashScreen(_("Preloading UI"), (float)px / (float)systemCount);
+			}, 5);
+		}
+		else
+			pool.wait();
+
+		queuePreload(systems);
+		return;
+	}
+
+	int i = 1;
+	int max = SystemData::sSystemVector.size() + 1;
+
+	for (auto system : systems)
+	{		
 		if (splash)
 		{
 			i++;
@@ -1018,8 +1136,77 @@ void ViewController::preload()
 				mWindow->renderSplashScreen(_("Preloading UI"), (float)i / (float)max);
 		}
 
-		(*it)->resetFilters();
-		getGameListView(*it);
+		TraceSpan viewSpan("getGameListView", system->getName());
+
+		system->resetFilters();
+		getGameListView(system);
+	}
+}
+
+// The last used system first, then its neighbours in the carousel
+void ViewController::queuePreload(const std::vector<SystemData*>& systems)
+{
+	mPreloadQueue.clear();
+
+	if (systems.size() == 0)
+		return;
+
+	std::string lastSystem = Settings::getInstance()->getString("StartupSystem");
+	if (lastSystem == "lastsystem")
+		lastSystem = Settings::getInstance()->getString("LastSystem");
+
+	int count = (int)systems.size();
+	int start = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (systems[i]->getName() == lastSystem)
+		{
+			start = i;
+			break;
+		}
+	}
+
+	mPreloadQueue.push_back(systems[start]->getName());
+
+	for (int d = 1; d <= count / 2; d++)
+	{
+		mPreloadQueue.push_back(systems[(start + d) % count]->getName());
+
+		if (d * 2 < count)
+			mPreloadQueue.push_back(systems[(start - d + count) % count]->getName());
+	}
+}
+
+void ViewController::updatePreload()
+{
+	if (mPreloadQueue.empty() || isAnimationPlaying(0) || mDeferPlayViewTransitionTo != nullptr)
+		return;
+
+	// Don't build what the cache would unload right away
+	int maxCount = Settings::getInstance()->getInt("GameListViewCacheSize");
+	if (maxCount > 0 && (int)mGameListViews.size() >= maxCount)
+	{
+		mPreloadQueue.clear();
+		return;
+	}
+
+	int start = SDL_GetTicks();
+
+	// Names rather than systems : they can be reloaded in between
+	while (!mPreloadQueue.empty())
+	{
+		SystemData* system = SystemData::getSystem(mPreloadQueue.front());
+		mPreloadQueue.pop_front();
+
+		if (system == nullptr || mGameListViews.find(system) != mGameListViews.cend())
+			continue;
+
+		TraceSpan viewSpan("getGameListView", system->getName());
+		getGameListView(system);
+
+		if ((int)SDL_GetTicks() - start >= PRELOAD_FRAME_BUDGET)
+			break;
 	}
 }
 
@@ -1146,6 +1333,9 @@ void ViewController::reloadAll(Window* window, bool reloadTheme)
 	}
 
 	mGameListViews.clear();
+	mGameListLru.clear();
+	mUnloadedCursors.clear();
+	mPreloadQueue.clear();
 	
 	// If preloaded is disabled
 	for (auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
@@ -1182,6 +1372,9 @@ void ViewController::reloadAll(Window* window, bool reloadTheme)
 		}
 		else
 			pool.wait();
+
+		ThemeData::clearFileCache();
+		SystemData::preloadThemeImages();
 	}
 
 	bool preloadUI = Settings::getInstance()->getBool("PreloadUI");
@@ -1257,6 +1450,11 @@ void ViewController::reloadAll(Window* window, bool reloadTheme)
 		mCurrentView->onShow();
 
 	updateHelpPrompts();
+
+	// What a reload leaves behind shows up as a growing total across the cycles
+	MemoryStats::set(MemoryStats::THEME, ThemeData::getTotalMemUsage());
+	MemoryStats::set(MemoryStats::SOUND, SoundBank::getMemUsage());
+	LOG(LogInfo) << "Memory after reload : " << MemoryStats::getReport();
 }
 
 std::vector<HelpPrompt> ViewController::getHelpPrompts()
@@ -6,6 +6,7 @@
 #include "FileData.h"
 #include "GuiComponent.h"
 #include <vector>
+#include <list>
 #include <functional>
 
 class IGameListView;
@@ -39,6 +40,7 @@ public:
 
 	// Try to completely populate the GameListView map.
 	// Caches things so there's no pauses during transitions.
+	// With "PreloadUIDeferred", the views are built after boot, within a time slice per frame
 	void preload();
 
 	// If a basic view detected a metadata change, it can request to recreate
@@ -125,6 +127,12 @@ private:
 	int getSystemId(SystemData* system);
 	void changeVolume(int increment);
 
+	void queuePreload(const std::vector<SystemData*>& systems);
+	void updatePreload();
+
+	void touchGameListView(SystemData* system);
+	void unloadColdGameListViews();
+
 	std::shared_ptr<GuiComponent> mCurrentView;
 	std::map< SystemData*, std::shared_ptr<IGameListView> > mGameListViews;
 	std::shared_ptr<SystemView> mSystemListView;
@@ -134,6 +142,11 @@ private:
 	bool mLockInput;
 	std::shared_ptr<GuiComponent>	mDeferPlayViewTransitionTo;
 	State mState;
+
+	std::list<std::string> mPreloadQueue;
+
+	std::list<SystemData*> mGameListLru;						// Most recently used first
+	std::map<std::string, std::string> mUnloadedCursors;	// Cursor path by system name, for the unloaded views
 };
 
 #endif // ES_APP_VIEWS_VIEW_CONTROLLER_H
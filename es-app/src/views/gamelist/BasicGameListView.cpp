@@ -98,6 +98,8 @@ void BasicGameListView::populateList(const std::vector<FileData*>& files)
 		// if we have the ".." PLACEHOLDER, then select the first game instead of the placeholder
 		if (showParentFolder && mCursorStack.size() && mList.size() > 1 && mList.getCursorIndex() == 0)
 			mList.setCursorIndex(1);
+
+		mList.prepareBidiTexts();
 	}
 	else
 	{
@@ -233,7 +235,7 @@ void BasicGameListView::onLongMouseClick(GuiComponent* component)
 	if (component != &mList)
 		return;
 
-	if (Settings::getInstance()->getBool("GameOptionsAtNorth"))
+	if (Settings::get(BoolSetting::GameOptionsAtNorth))
 		showSelectedGameSaveSnapshots();
 	else
 		showSelectedGameOptions();
@@ -10,14 +10,20 @@
 #include "SystemConf.h"
 #include "Window.h"
 #include "components/ComponentGrid.h"
+#include "Settings.h"
+#include "TextToSpeech.h"
+#include <algorithm>
 #include <set>
 #include "views/Binding.h"
 
 #ifdef _RPI_
-#include "Settings.h"
 #include "components/VideoPlayerComponent.h"
 #endif
 #include "components/VideoVlcComponent.h"
+#include "resources/VideoPosterCache.h"
+
+#define PREFETCH_LOAD_PRIORITY	16	// Queue position of the upcoming games medias, behind the on screen textures
+#define FAST_SCROLL_SETTLE_DELAY	150	// ms without fast scrolling before the full details come back
 
 DetailedContainer::DetailedContainer(ISimpleGameListView* parent, GuiComponent* list, Window* window, DetailedContainerType viewType) :
 	mParent(parent), mList(list), mWindow(window), mViewType(viewType),
@@ -32,7 +38,7 @@ DetailedContainer::DetailedContainer(ISimpleGameListView* parent, GuiComponent*
 	mCheevos(nullptr), mNotCheevos(nullptr),
 	mNetplay(nullptr), mNotNetplay(nullptr),
 	mSaveState(nullptr), mNoSaveState(nullptr),
-	mState(true), mFolderView(nullptr),
+	mState(true), mFastScrolling(false), mFolderView(nullptr), mHasManualOrMagazine(false), mHasMap(false),
 
 	mLblRating(window), mLblReleaseDate(window), mLblDeveloper(window), mLblPublisher(window),
 	mLblGenre(window), mLblPlayers(window), mLblLastPlayed(window), mLblPlayCount(window), mLblGameTime(window), mLblFavorite(window),
@@ -287,7 +293,7 @@ void DetailedContainer::createVideo()
 	// video
 	// Create the correct type of video window
 #ifdef _RPI_
-	if (Settings::getInstance()->getBool("VideoOmxPlayer"))
+	if (Settings::get(BoolSetting::VideoOmxPlayer))
 		mVideo = new VideoPlayerComponent(mWindow, "");
 	else
 #endif
@@ -399,6 +405,8 @@ void DetailedContainer::loadIfThemed(ImageComponent** pImage, const std::shared_
 void DetailedContainer::onThemeChanged(const std::shared_ptr<ThemeData>& theme)
 {
 	using namespace ThemeFlags;
+
+	mBoundValues.clear();
 	
 	std::string viewName = getName();
 
@@ -729,8 +737,167 @@ void DetailedContainer::loadThemedExtras(FileData* file)
 		resetThemedExtras();
 }
 
+static std::string getSnapshotPath(FileData* file, ImageSource src, const std::string& imagePath)
+{
+	if (src == TITLESHOT && Utils::FileSystem::exists(file->getMetadata(MetaDataId::TitleShot)))
+		return file->getMetadata(MetaDataId::TitleShot);
+	else if (src == BOXART && Utils::FileSystem::exists(file->getMetadata(MetaDataId::BoxArt)))
+		return file->getMetadata(MetaDataId::BoxArt);
+	else if (src == MARQUEE && !file->getMarqueePath().empty())
+		return file->getMarqueePath();
+	else if ((src == THUMBNAIL || src == BOXART) && !file->getThumbnailPath().empty())
+		return file->getThumbnailPath();
+	else if ((src == IMAGE || src == TITLESHOT) && !file->getImagePath().empty())
+		return file->getImagePath();
+	else if (src == FANART && Utils::FileSystem::exists(file->getMetadata(MetaDataId::FanArt)))
+		return file->getMetadata(MetaDataId::FanArt);
+	else if (src == CARTRIDGE && Utils::FileSystem::exists(file->getMetadata(MetaDataId::Cartridge)))
+		return file->getMetadata(MetaDataId::Cartridge);
+	else if (src == MIX && Utils::FileSystem::exists(file->getMetadata(MetaDataId::Mix)))
+		return file->getMetadata(MetaDataId::Mix);
+
+	return imagePath;
+}
+
+static std::string getMdImagePath(FileData* file, const MdImage& md)
+{
+	for (auto& id : md.metaDataIds)
+	{
+		if (id == MetaDataId::Marquee)
+		{
+			if (Utils::FileSystem::exists(file->getMarqueePath()))
+				return file->getMarqueePath();
+
+			continue;
+		}
+
+		std::string path = file->getMetadata(id);
+		if (Utils::FileSystem::exists(path))
+			return path;
+	}
+
+	return "";
+}
+
+// Same textures as updateControls would ask for the file, when the images load asynchronously
+void DetailedContainer::getPrefetchTextures(FileData* file, std::vector<std::shared_ptr<TextureResource>>& textures)
+{
+	if (file == nullptr || file->getType() != GAME)
+		return;
+
+	auto addTexture = [&textures](ImageComponent* image, const std::string& path)
+	{
+		if (image == nullptr || path.empty() || path[0] == '{' || !image->isAsync())
+			return;
+
+		MaxSizeInfo maxSize = image->getMaxSizeInfo();
+		auto texture = TextureResource::get(path, false, image->isLinear(), false, true, true, maxSize.empty() ? nullptr : &maxSize);
+		if (texture != nullptr && !texture->isLoaded())
+			textures.push_back(texture);
+	};
+
+	std::string imagePath = file->getImagePath().empty() ? file->getThumbnailPath() : file->getImagePath();
+
+	if (mVideo != nullptr)
+		addTexture(mVideo->getSnapshotImage(), getSnapshotPath(file, mVideo->getSnapshotSource(), imagePath));
+
+	if (mThumbnail != nullptr)
+	{
+		addTexture(mThumbnail, file->getThumbnailPath());
+
+		if (mViewType == DetailedContainerType::VideoView)
+			addTexture(mImage, file->getImagePath());
+	}
+
+	if (mImage != nullptr)
+	{
+		if (mViewType == DetailedContainerType::VideoView && mThumbnail == nullptr)
+			addTexture(mImage, file->getThumbnailPath());
+		else if (mViewType != DetailedContainerType::VideoView)
+			addTexture(mImage, imagePath);
+	}
+
+	for (auto& md : mdImages)
+		addTexture(md.component, getMdImagePath(file, md));
+}
+
+// Fast scrolling : the video is stopped once, the images are the ones already in memory, the name is updated. The extras keep their previous game
+bool DetailedContainer::isBoundValueChanged(const void* target, const std::string& value)
+{
+	auto it = mBoundValues.find(target);
+	if (it != mBoundValues.cend() && it->second == value)
+		return false;
+
+	mBoundValues[target] = value;
+	return true;
+}
+
+void DetailedContainer::updateLightControls(FileData* file)
+{
+	// The components get placeholder values, the next full update sets all of them
+	mBoundValues.clear();
+
+	auto setCachedImage = [](ImageComponent* image, const std::string& path)
+	{
+		if (image == nullptr)
+			return;
+
+		if (!path.empty() && TextureResource::isCached(path, false, image->isLinear()))
+			image->setImage(path, false, image->getMaxSizeInfo());
+		else
+			image->setImage("");
+	};
+
+	if (mFolderView)
+	{
+		delete mFolderView;
+		mFolderView = nullptr;
+	}
+
+	std::string imagePath = file->getImagePath().empty() ? file->getThumbnailPath() : file->getImagePath();
+
+	if (mVideo != nullptr)
+	{
+		if (!mFastScrolling)
+			mVideo->setVideo("");
+
+		std::string snapShot = getSnapshotPath(file, mVideo->getSnapshotSource(), imagePath);
+		if (TextureResource::isCached(snapShot, false, mVideo->getSnapshotImage()->isLinear()))
+			mVideo->setImage(snapShot, false, mVideo->getMaxSizeInfo());
+		else
+			mVideo->setImage("");
+	}
+
+	if (mThumbnail != nullptr)
+	{
+		if (mViewType == DetailedContainerType::VideoView)
+			setCachedImage(mImage, file->getImagePath());
+
+		setCachedImage(mThumbnail, file->getThumbnailPath());
+	}
+
+	if (mImage != nullptr)
+	{
+		if (mViewType == DetailedContainerType::VideoView && mThumbnail == nullptr)
+			setCachedImage(mImage, file->getThumbnailPath());
+		else if (mViewType != DetailedContainerType::VideoView)
+			setCachedImage(mImage, imagePath);
+	}
+
+	for (auto& md : mdImages)
+		if (md.component != nullptr)
+			md.component->setImage("");
+
+	mName.setValue(file->getMetadata(MetaDataId::Name));
+	mDescription.setText("");
+
+	mFastScrolling = true;
+}
+
 void DetailedContainer::updateControls(FileData* file, bool isClearing, int moveBy, bool isDeactivating)
 {
+	mFastScrolling = false;
+
 	bool state = (file != NULL);
 	if (state)
 	{	
@@ -745,77 +912,48 @@ void DetailedContainer::updateControls(FileData* file, bool isClearing, int move
 
 		std::string imagePath = file->getImagePath().empty() ? file->getThumbnailPath() : file->getImagePath();
 
+		auto setImage = [this](ImageComponent* image, const std::string& path)
+		{
+			if (isBoundValueChanged(image, path))
+				image->setImage(path, false, image->getMaxSizeInfo());
+		};
+
 		if (mVideo != nullptr)
 		{
-			if (!mVideo->setVideo(file->getVideoPath()))
-				mVideo->setDefaultVideo();
-
-			std::string snapShot = imagePath;
-
-			auto src = mVideo->getSnapshotSource();
-
-			if (src == TITLESHOT && Utils::FileSystem::exists(file->getMetadata(MetaDataId::TitleShot)))
-				snapShot = file->getMetadata(MetaDataId::TitleShot);
-			else if (src == BOXART && Utils::FileSystem::exists(file->getMetadata(MetaDataId::BoxArt)))
-				snapShot = file->getMetadata(MetaDataId::BoxArt);
-			else if (src == MARQUEE && !file->getMarqueePath().empty())
-				snapShot = file->getMarqueePath();
-			else if ((src == THUMBNAIL || src == BOXART) && !file->getThumbnailPath().empty())
-				snapShot = file->getThumbnailPath();			
-			else if ((src == IMAGE || src == TITLESHOT) && !file->getImagePath().empty())
-				snapShot = file->getImagePath();
-			else if (src == FANART && Utils::FileSystem::exists(file->getMetadata(MetaDataId::FanArt)))
-				snapShot = file->getMetadata(MetaDataId::FanArt);
-			else if (src == CARTRIDGE && Utils::FileSystem::exists(file->getMetadata(MetaDataId::Cartridge)))
-				snapShot = file->getMetadata(MetaDataId::Cartridge);
-			else if (src == MIX && Utils::FileSystem::exists(file->getMetadata(MetaDataId::Mix)))
-				snapShot = file->getMetadata(MetaDataId::Mix);
-			
-			mVideo->setImage(snapShot, false, mVideo->getMaxSizeInfo());
+			std::string snapShot = getSnapshotPath(file, mVideo->getSnapshotSource(), imagePath);
+
+			if (isBoundValueChanged(mVideo, file->getVideoPath() + "|" + snapShot))
+			{
+				if (!mVideo->setVideo(file->getVideoPath()))
+					mVideo->setDefaultVideo();
+
+				mVideo->setImage(snapShot, false, mVideo->getMaxSizeInfo());
+			}
 		}
 
 		if (mThumbnail != nullptr)
 		{
 			if (mViewType == DetailedContainerType::VideoView && mImage != nullptr)
-				mImage->setImage(file->getImagePath(), false, mImage->getMaxSizeInfo());
+				setImage(mImage, file->getImagePath());
 
-			mThumbnail->setImage(file->getThumbnailPath(), false, mThumbnail->getMaxSizeInfo());
+			setImage(mThumbnail, file->getThumbnailPath());
 		}
 		
 		if (mImage != nullptr)
 		{
 			if (mViewType == DetailedContainerType::VideoView && mThumbnail == nullptr)
-				mImage->setImage(file->getThumbnailPath(), false, mImage->getMaxSizeInfo());
+				setImage(mImage, file->getThumbnailPath());
 			else if (mViewType != DetailedContainerType::VideoView)
-				mImage->setImage(imagePath, false, mImage->getMaxSizeInfo());
+				setImage(mImage, imagePath);
 		}
 
 		for (auto& md : mdImages)
 		{
 			if (md.component != nullptr)
 			{
-				std::string image;
-
-				for (auto& id : md.metaDataIds)
-				{
-					if (id == MetaDataId::Marquee)
-					{
-						if (Utils::FileSystem::exists(file->getMarqueePath()))
-						{
-							image = file->getMarqueePath();
-							break;
-						}
-
-						continue;
-					}
-
-					std::string path = file->getMetadata(id);
-					if (Utils::FileSystem::exists(path)) 
-					{
-						image = path;
-						break;
-					}
-				}
+				std::string image = getMdImagePath(file, md);
+				if (!isBoundValueChanged(md.component, image))
+					continue;
 
 				if (!image.empty())
 					md.component->setImage(image, false, md.component->getMaxSizeInfo());
@@ -829,26 +967,30 @@ void DetailedContainer::updateControls(FileData* file, bool isClearing, int move
 			if (file->getType() == GAME)
 			{
 				file->detectLanguageAndRegion(false);
-				mFlag->setImage(":/flags/" + LangInfo::getFlag(file->getMetadata(MetaDataId::Language), file->getMetadata(MetaDataId::Region)) + ".png"
-					, false, mFlag->getMaxSizeInfo());
+				setImage(mFlag, ":/flags/" + LangInfo::getFlag(file->getMetadata(MetaDataId::Language), file->getMetadata(MetaDataId::Region)) + ".png");
 			}
-			else
+			else if (isBoundValueChanged(mFlag, ":/folder.svg"))
 				mFlag->setImage(":/folder.svg");
 		}
 
-		bool hasManualOrMagazine = Utils::FileSystem::exists(file->getMetadata(MetaDataId::Manual)) || Utils::FileSystem::exists(file->getMetadata(MetaDataId::Magazine));
+		// The files are only looked for when the paths change
+		if (isBoundValueChanged(&mHasManualOrMagazine, file->getMetadata(MetaDataId::Manual) + "|" + file->getMetadata(MetaDataId::Magazine)))
+			mHasManualOrMagazine = Utils::FileSystem::exists(file->getMetadata(MetaDataId::Manual)) || Utils::FileSystem::exists(file->getMetadata(MetaDataId::Magazine));
+
+		if (isBoundValueChanged(&mHasMap, file->getMetadata(MetaDataId::Map)))
+			mHasMap = Utils::FileSystem::exists(file->getMetadata(MetaDataId::Map));
 
 		if (mManual != nullptr)
-			mManual->setVisible(hasManualOrMagazine);
+			mManual->setVisible(mHasManualOrMagazine);
 
 		if (mNoManual != nullptr)
-			mNoManual->setVisible(!hasManualOrMagazine);
+			mNoManual->setVisible(!mHasManualOrMagazine);
 
 		if (mMap != nullptr)
-			mMap->setVisible(Utils::FileSystem::exists(file->getMetadata(MetaDataId::Map)));
+			mMap->setVisible(mHasMap);
 
 		if (mNoMap != nullptr)
-			mNoMap->setVisible(!Utils::FileSystem::exists(file->getMetadata(MetaDataId::Map)));
+			mNoMap->setVisible(!mHasMap);
 
 		// Save states
 		bool hasSaveState = false;
@@ -943,7 +1085,11 @@ void DetailedContainer::updateControls(FileData* file, bool isClearing, int move
 		};
 
 		mRating.setValue(file->getMetadata(MetaDataId::Rating));
-		mReleaseDate.setValue(file->getMetadata(MetaDataId::ReleaseDate));
+
+		// DateTimeComponent rebuilds its text at each setValue
+		if (isBoundValueChanged(&mReleaseDate, file->getMetadata(MetaDataId::ReleaseDate)))
+			mReleaseDate.setValue(file->getMetadata(MetaDataId::ReleaseDate));
+
 		mDeveloper.setValue(valueOrUnknown(file->getMetadata(MetaDataId::Developer)));
 		mPublisher.setValue(valueOrUnknown(file->getMetadata(MetaDataId::Publisher)));
 		mGenre.setValue(valueOrUnknown(file->getMetadata(MetaDataId::Genre)));
@@ -958,13 +1104,22 @@ void DetailedContainer::updateControls(FileData* file, bool isClearing, int move
 
 		if (file->getType() == GAME)
 		{
-			mLastPlayed.setValue(file->getMetadata(MetaDataId::LastPlayed));
+			if (isBoundValueChanged(&mLastPlayed, file->getMetadata(MetaDataId::LastPlayed)))
+				mLastPlayed.setValue(file->getMetadata(MetaDataId::LastPlayed));
+
 			mPlayCount.setValue(file->getMetadata(MetaDataId::PlayCount));
-			mGameTime.setValue(Utils::Time::secondsToString(atol(file->getMetadata(MetaDataId::GameTime).c_str())));
+
+			if (isBoundValueChanged(&mGameTime, file->getMetadata(MetaDataId::GameTime)))
+				mGameTime.setValue(Utils::Time::secondsToString(atol(file->getMetadata(MetaDataId::GameTime).c_str())));
 		}
 		else if (file->getType() == FOLDER)
+		{
 			updateDetailsForFolder((FolderData*)file);
 
+			// The folder details replace the video & its snapshot
+			forgetBoundValue(mVideo);
+		}
+
 		for (auto extra : mThemeExtras)
 			Binding::updateBindings(extra, file);
 	}
@@ -1029,6 +1184,7 @@ void DetailedContainer::updateControls(FileData* file, bool isClearing, int move
 	if (file == nullptr && isClearing)
 	{
 		resetThemedExtras();
+		mBoundValues.clear();
 
 		for (auto comp : comps)
 		{
@@ -1237,15 +1393,21 @@ DetailedContainerHost::DetailedContainerHost(ISimpleGameListView* parent, GuiCom
 	mParent = parent;
 	mList = list;
 	mWindow = window;
+	mPostedToken = Window::createPostedFunctionToken();
 	mViewType = viewType;
 
 	mActiveFile = nullptr;
+	mPendingFile = nullptr;
+	mPendingMoveBy = 0;
+	mSettleFile = nullptr;
+	mSettleMoveBy = 0;
+	mSettleDelay = 0;
 	mContainer = new DetailedContainer(parent, list, window, viewType);
 }
 
 DetailedContainerHost::~DetailedContainerHost()
 {
-	mWindow->unregisterPostedFunctions(this);
+	Window::cancelPostedFunctions(mPostedToken);
 
 	delete mContainer;
 	for (auto container : mContainers)
@@ -1263,6 +1425,30 @@ void DetailedContainerHost::onThemeChanged(const std::shared_ptr<ThemeData>& the
 
 void DetailedContainerHost::update(int deltaTime)
 {
+	if (mPendingFile != nullptr)
+	{
+		FileData* file = mPendingFile;
+		mPendingFile = nullptr;
+
+		applyControls(file, false, mPendingMoveBy);
+	}
+
+	if (mSettleDelay > 0)
+	{
+		mSettleDelay -= deltaTime;
+
+		if (mSettleDelay <= 0)
+		{
+			FileData* file = mSettleFile;
+
+			mSettleDelay = 0;
+			mSettleFile = nullptr;
+
+			if (file != nullptr)
+				applyControls(file, false, mSettleMoveBy);
+		}
+	}
+
 	mContainer->updateFolderViewAmbiantProperties();
 
 	int index = mContainers.size();
@@ -1282,7 +1468,7 @@ void DetailedContainerHost::update(int deltaTime)
 				cp->onHide();
 			}
 
-			mWindow->postToUiThread([dc]() { delete dc; }, this);
+			mWindow->postToUiThread([dc]() { delete dc; }, mPostedToken);
 			// break;
 		}
 		else
@@ -1292,13 +1478,93 @@ void DetailedContainerHost::update(int deltaTime)
 	}
 }
 
+void DetailedContainerHost::prefetchMedias(const std::vector<FileData*>& files)
+{
+	std::vector<std::shared_ptr<TextureResource>> textures;
+
+	if (Settings::get(BoolSetting::PrefetchGameMedias))
+	{
+		for (auto file : files)
+			mContainer->getPrefetchTextures(file, textures);
+
+		// The next game's video is opened ahead, it starts without the parsing delay
+		if (files.size() && files[0]->getType() == GAME && dynamic_cast<VideoVlcComponent*>(mContainer->mVideo) != nullptr)
+			VideoVlcComponent::prefetch(files[0]->getVideoPath());
+	}
+
+	// The next name the screen reader says is synthesized ahead
+	if (Settings::get(BoolSetting::TTSPresynthesis) && files.size() && TextToSpeech::getInstance()->isEnabled())
+		TextToSpeech::getInstance()->prepare(files[0]->getName());
+
+	// The farthest first : the poster job extracts the last queued video first
+	if (VideoPosterCache::isEnabled() && mContainer->mVideo != nullptr)
+		for (auto it = files.rbegin(); it != files.rend(); ++it)
+			if ((*it)->getType() == GAME)
+				VideoPosterCache::queue((*it)->getVideoPath());
+
+	// The games that are no longer ahead of the cursor ( direction reversed, or reached ) : give up their loads,
+	// unless a component now shows them, then they are on screen & load first
+	for (auto& texture : mPrefetchedTextures)
+	{
+		if (std::find(textures.cbegin(), textures.cend(), texture) != textures.cend())
+			continue;
+
+		if (texture.use_count() > 1)
+			texture->setLoadPriority(0);
+		else
+			TextureResource::cancelAsync(texture);
+	}
+
+	// Nearest first, after the textures on screen
+	for (int i = 0; i < (int)textures.size(); i++)
+		textures[i]->prefetch(PREFETCH_LOAD_PRIORITY + i);
+
+	mPrefetchedTextures = textures;
+}
+
 Vector3f DetailedContainerHost::getLaunchTarget()
 {
 	return mContainer->getLaunchTarget();
 }
 
-void DetailedContainerHost::updateControls(FileData* file, bool isClearing, int moveBy)
+void DetailedContainerHost::updateControls(FileData* file, bool isClearing, int moveBy, bool fastScroll)
+{
+	if (file != nullptr && !isClearing && fastScroll && mContainer->mState)
+	{
+		mContainer->updateLightControls(file);
+		mPendingFile = nullptr;
+		mSettleFile = nullptr;
+		mSettleDelay = FAST_SCROLL_SETTLE_DELAY;
+		return;
+	}
+
+	// The full details come back once the scroll has settled
+	if (mSettleDelay > 0 && file != nullptr && !isClearing)
+	{
+		mPendingFile = nullptr;
+		mSettleFile = file;
+		mSettleMoveBy = moveBy;
+		return;
+	}
+
+	mSettleDelay = 0;
+	mSettleFile = nullptr;
+
+	// Cursor moves : the last one of the frame wins. Initial & refresh updates ( moveBy 0 ) are applied now, the view may not be updated before it's rendered
+	if (file != nullptr && !isClearing && moveBy != 0)
+	{
+		mPendingFile = file;
+		mPendingMoveBy = moveBy;
+		return;
+	}
+
+	applyControls(file, isClearing, moveBy);
+}
+
+void DetailedContainerHost::applyControls(FileData* file, bool isClearing, int moveBy)
 {
+	mPendingFile = nullptr;
+
 	if (!mContainer->anyComponentHasStoryBoard() || file == nullptr || isClearing || moveBy == 0)
 	{
 		if (file != nullptr && !isClearing)
@@ -1337,7 +1603,7 @@ void DetailedContainerHost::updateControls(FileData* file, bool isClearing, int
 
 		for (auto cp : mContainer->getComponents())
 			cp->onShow();
-	}, this);
+	}, mPostedToken);
 }
 
 /*
@@ -4,6 +4,9 @@
 #include "components/RatingComponent.h"
 #include "components/ScrollableContainer.h"
 #include "views/gamelist/BasicGameListView.h"
+#include <unordered_map>
+
+#define MEDIA_PREFETCH_COUNT	3	// Games ahead of the cursor whose medias are queued, per scroll tier
 
 class VideoComponent;
 class ComponentGrid;
@@ -54,6 +57,8 @@ public:
 	Vector3f getLaunchTarget();
 
 	void updateControls(FileData* file, bool isClearing, int moveBy = 0, bool isDeactivating = false);
+	void updateLightControls(FileData* file);
+	void getPrefetchTextures(FileData* file, std::vector<std::shared_ptr<TextureResource>>& textures);
 
 protected:
 	void	initMDLabels();
@@ -77,6 +82,10 @@ protected:
 	bool anyComponentHasStoryBoard();
 	bool anyComponentHasStoryBoardRunning();
 
+	// Remembers the last value given to a component by updateControls : unchanged values are not set again
+	bool isBoundValueChanged(const void* target, const std::string& value);
+	void forgetBoundValue(const void* target) { mBoundValues.erase(target); }
+
 	ISimpleGameListView* mParent;
 	GuiComponent* mList;
 	Window* mWindow;
@@ -146,6 +155,11 @@ protected:
 	std::shared_ptr<ThemeData> mCustomTheme;
 
 	bool		mState;
+	bool		mFastScrolling;
+
+	std::unordered_map<const void*, std::string> mBoundValues;
+	bool		mHasManualOrMagazine;
+	bool		mHasMap;
 };
 
 
@@ -161,18 +175,35 @@ public:
 	void onThemeChanged(const std::shared_ptr<ThemeData>& theme);
 	Vector3f getLaunchTarget();
 
-	void updateControls(FileData* file, bool isClearing, int moveBy = 0);
+	// fastScroll : only the cheap details, the full ones follow after a settle delay.
+	// The cursor moves of a frame are coalesced, only the last one is applied from the next update
+	void updateControls(FileData* file, bool isClearing, int moveBy = 0, bool fastScroll = false);
 	void update(int deltaTime);
 
+	// Queues the medias of the games the cursor is heading to, at low priority
+	void prefetchMedias(const std::vector<FileData*>& files);
+
 private:
+	void applyControls(FileData* file, bool isClearing, int moveBy);
+
 	FileData* mActiveFile;
 
+	FileData* mPendingFile;
+	int		  mPendingMoveBy;
+
+	FileData* mSettleFile;
+	int		  mSettleMoveBy;
+	int		  mSettleDelay;
+
 	ISimpleGameListView* mParent;
 	GuiComponent*		mList;
 	Window* mWindow;
+	Window::PostedFunctionToken mPostedToken;
 	DetailedContainer::DetailedContainerType mViewType;
 
 	DetailedContainer* mContainer;
 	std::vector<DetailedContainer*> mContainers;
 	std::shared_ptr<ThemeData> mTheme;
+
+	std::vector<std::shared_ptr<TextureResource>> mPrefetchedTextures;
 };
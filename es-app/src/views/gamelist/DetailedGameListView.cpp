@@ -43,7 +43,11 @@ void DetailedGameListView::updateInfoPanel()
 
 	FileData* file = (mList.size() == 0 || mList.isScrolling()) ? NULL : mList.getSelected();	
 	bool isClearing = mList.getObjects().size() == 0 && mList.getCursorIndex() == 0 && mList.getScrollingVelocity() == 0;
-	mDetails.updateControls(file, isClearing, mList.getCursorIndex() - mList.getLastCursor());
+	int moveBy = mList.getCursorIndex() - mList.getLastCursor();
+	mDetails.updateControls(file, isClearing, moveBy, mList.isFastScrolling());
+
+	if (!isClearing)
+		mDetails.prefetchMedias(mList.getUpcomingObjects(moveBy, MEDIA_PREFETCH_COUNT));
 }
 
 void DetailedGameListView::launch(FileData* game)
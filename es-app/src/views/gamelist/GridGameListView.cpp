@@ -12,6 +12,7 @@
 #include "guis/GuiGamelistOptions.h"
 #include "GameNameFormatter.h"
 #include "utils/Randomizer.h"
+#include "RandomGamePool.h"
 
 GridGameListView::GridGameListView(Window* window, FolderData* root, const std::shared_ptr<ThemeData>& theme, std::string themeName, Vector2f gridSize) :
 	ISimpleGameListView(window, root),
@@ -257,7 +258,11 @@ void GridGameListView::updateInfoPanel()
 
 	FileData* file = (mGrid.size() == 0 || mGrid.isScrolling()) ? NULL : mGrid.getSelected();
 	bool isClearing = mGrid.getObjects().size() == 0 && mGrid.getCursorIndex() == 0 && mGrid.getScrollingVelocity() == 0;
-	mDetails.updateControls(file, isClearing, mGrid.getCursorIndex() - mGrid.getLastCursor());
+	int moveBy = mGrid.getCursorIndex() - mGrid.getLastCursor();
+	mDetails.updateControls(file, isClearing, moveBy, mGrid.isFastScrolling());
+
+	if (!isClearing)
+		mDetails.prefetchMedias(mGrid.getUpcomingObjects(moveBy, MEDIA_PREFETCH_COUNT));
 }
 
 void GridGameListView::addPlaceholder()
@@ -339,20 +344,27 @@ void GridGameListView::update(int deltaTime)
 
 void GridGameListView::moveToRandomGame()
 {
-	auto list = getFileDataEntries();
+	// Any game the filters show, setCursor opens its folder
+	FileData* game = RandomGamePool::pick(mRoot->getSystem(), RandomGamePool::ANY, true);
+	if (game == nullptr)
+	{
+		auto list = getFileDataEntries();
 
-	unsigned int total = (int)list.size();
-	if (total == 0)
-		return;
+		unsigned int total = (int)list.size();
+		if (total == 0)
+			return;
 
-	int target = Randomizer::random(total);
-	if (target >= 0 && target < total)
-	{
-		resetLastCursor();
-		setCursor(list.at(target));
-		if (isShowing())
-			onShow();
+		int target = Randomizer::random(total);
+		if (target < 0 || target >= total)
+			return;
+
+		game = list.at(target);
 	}
+
+	resetLastCursor();
+	setCursor(game);
+	if (isShowing())
+		onShow();
 }
 
 void GridGameListView::onLongMouseClick(GuiComponent* component)
@@ -360,7 +372,7 @@ void GridGameListView::onLongMouseClick(GuiComponent* component)
 	if (component != &mGrid)
 		return;
 
-	if (Settings::getInstance()->getBool("GameOptionsAtNorth"))
+	if (Settings::get(BoolSetting::GameOptionsAtNorth))
 		showSelectedGameSaveSnapshots();
 	else
 		showSelectedGameOptions();
@@ -23,6 +23,7 @@
 #include "guis/GuiGamelistOptions.h"
 #include "BasicGameListView.h"
 #include "utils/Randomizer.h"
+#include "RandomGamePool.h"
 #include "views/Binding.h"
 #include "guis/GuiImageViewer.h"
 #include "guis/GuiGameAchievements.h"
@@ -174,7 +175,7 @@ void ISimpleGameListView::update(const int deltaTime)
 
 	if (mOKButton.isLongPressed(deltaTime))
 	{
-		if (Settings::getInstance()->getBool("GameOptionsAtNorth"))
+		if (Settings::get(BoolSetting::GameOptionsAtNorth))
 			showSelectedGameSaveSnapshots();
 		else
 			showSelectedGameOptions();
@@ -198,7 +199,7 @@ void ISimpleGameListView::update(const int deltaTime)
 	{
 		if (UIModeController::getInstance()->isUIModeKid() && cursorHasSaveStatesEnabled())
 		{
-			if (Settings::getInstance()->getBool("GameOptionsAtNorth"))
+			if (Settings::get(BoolSetting::GameOptionsAtNorth))
 				showSelectedGameOptions();
 			else
 				showSelectedGameSaveSnapshots();
@@ -262,7 +263,7 @@ bool ISimpleGameListView::input(InputConfig* config, Input input)
 
 	if (mXButton.isShortPressed(config, input))
 	{
-		if (Settings::getInstance()->getBool("GameOptionsAtNorth"))
+		if (Settings::get(BoolSetting::GameOptionsAtNorth))
 			showSelectedGameOptions();
 		else
 			showSelectedGameSaveSnapshots();
@@ -293,7 +294,7 @@ bool ISimpleGameListView::input(InputConfig* config, Input input)
 		goBack();
 		return true;
 	}
-	else if ((Settings::getInstance()->getBool("QuickSystemSelect") && config->isMappedLike(getQuickSystemSelectRightButton(), input)) || config->isMappedLike("r2", input))
+	else if ((Settings::get(BoolSetting::QuickSystemSelect) && config->isMappedLike(getQuickSystemSelectRightButton(), input)) || config->isMappedLike("r2", input))
 	{
 		if (!mPopupSelfReference)
 		{
@@ -303,7 +304,7 @@ bool ISimpleGameListView::input(InputConfig* config, Input input)
 
 		return true;
 	}
-	else if ((Settings::getInstance()->getBool("QuickSystemSelect") && config->isMappedLike(getQuickSystemSelectLeftButton(), input)) || config->isMappedLike("l2", input))
+	else if ((Settings::get(BoolSetting::QuickSystemSelect) && config->isMappedLike(getQuickSystemSelectLeftButton(), input)) || config->isMappedLike("l2", input))
 	{
 		if (!mPopupSelfReference)
 		{
@@ -456,6 +457,14 @@ void ISimpleGameListView::showQuickSearch()
 
 void ISimpleGameListView::moveToRandomGame()
 {
+	// Any game the filters show, setCursor opens its folder
+	FileData* game = RandomGamePool::pick(mRoot->getSystem(), RandomGamePool::ANY, true);
+	if (game != nullptr)
+	{
+		setCursor(game);
+		return;
+	}
+
 	auto list = getFileDataEntries();
 
 	unsigned int total = (int)list.size();
@@ -560,13 +569,13 @@ std::vector<HelpPrompt> ISimpleGameListView::getHelpPrompts()
 
 	if (Renderer::getScreenProportion() > 1.4)
 	{
-		if (mPopupSelfReference == nullptr && Settings::getInstance()->getBool("QuickSystemSelect") && getQuickSystemSelectLeftButton() == "left")
+		if (mPopupSelfReference == nullptr && Settings::get(BoolSetting::QuickSystemSelect) && getQuickSystemSelectLeftButton() == "left")
 			prompts.push_back(HelpPrompt("left/right", _("SYSTEM")));
 
 		prompts.push_back(HelpPrompt("up/down", _("CHOOSE")));
 	}
 
-	bool invertNorthButton = Settings::getInstance()->getBool("GameOptionsAtNorth");
+	bool invertNorthButton = Settings::get(BoolSetting::GameOptionsAtNorth);
 
 	prompts.push_back(HelpPrompt(BUTTON_BACK, _("BACK"), [&] { goBack(); }));
 
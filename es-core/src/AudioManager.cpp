@@ -3,7 +3,9 @@
 #include "Log.h"
 #include "Settings.h"
 #include "Sound.h"
+#include "SoundBank.h"
 #include <SDL.h>
+#include <algorithm>
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
 #include "utils/Randomizer.h"
@@ -22,10 +24,13 @@
 // Size of last played music history as a percentage of file total
 #define LAST_PLAYED_SIZE 0.4
 
+// Fade out of the end of the songs, when SDL_mixer knows their duration ( 2.6+ )
+#define MUSIC_CROSSFADE_MS	1500
+
 AudioManager* AudioManager::sInstance = NULL;
 std::vector<std::shared_ptr<Sound>> AudioManager::sSoundVector;
 
-AudioManager::AudioManager() : mInitialized(false), mCurrentMusic(nullptr), mMusicVolume(MIX_MAX_VOLUME), mVideoPlaying(false)
+AudioManager::AudioManager() : mInitialized(false), mCurrentMusic(nullptr), mMusicVolume(MIX_MAX_VOLUME), mVideoPlaying(false), mNextMusic(nullptr), mMusicEnded(false), mMusicFadingOut(false)
 {
 	init();
 }
@@ -78,6 +83,9 @@ void AudioManager::init()
 		LOG(LogInfo) << "SDL AUDIO Initialized";
 		mInitialized = true;
 
+		// Decodes the theme sounds read with the themes, the known sounds are taken from memory
+		SoundBank::onAudioOpened();
+
 		// Reload known sounds
 		for (unsigned int i = 0; i < sSoundVector.size(); i++)
 			sSoundVector[i]->init();
@@ -108,6 +116,8 @@ void AudioManager::deinit()
 	Mix_HookMusicFinished(nullptr);
 	Mix_HaltMusic();
 
+	cancelPrefetch();
+
 	//completely tear down SDL audio. else SDL hogs audio resources and emulators might fail to start...
 	Mix_CloseAudio();
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
@@ -149,13 +159,14 @@ void AudioManager::stop()
 			sSoundVector[i]->stop();
 }
 
-void AudioManager::getMusicIn(const std::string &path, std::vector<std::string>& all_matching_files)
+void AudioManager::scanMusicIn(const std::string& path, bool anySystem, MusicIndex& index)
 {
+	// Missing folders are watched too : they are found once created
+	index.folders.push_back(std::make_pair(path, Utils::FileSystem::getFileModificationDate(path).getTime()));
+
 	if (!Utils::FileSystem::isDirectory(path))
 		return;
 
-	bool anySystem = !Settings::getInstance()->getBool("audio.persystem");
-
 	auto dirContent = Utils::FileSystem::getDirContent(path);
 	for (auto it = dirContent.cbegin(); it != dirContent.cend(); ++it)
 	{
@@ -165,11 +176,31 @@ void AudioManager::getMusicIn(const std::string &path, std::vector<std::string>&
 				continue;
 
 			if (anySystem || mSystemName == Utils::FileSystem::getFileName(*it))
-				getMusicIn(*it, all_matching_files);
+				scanMusicIn(*it, anySystem, index);
 		}
 		else if (Utils::FileSystem::isAudio(*it))
-			all_matching_files.push_back(*it);
+			index.files.push_back(*it);
+	}
+}
+
+void AudioManager::getMusicIn(const std::string &path, std::vector<std::string>& all_matching_files)
+{
+	bool anySystem = !Settings::getInstance()->getBool("audio.persystem");
+
+	// A file added or removed changes the modification time of its folder
+	MusicIndex& index = mMusicIndex[path + "|" + (anySystem ? "" : mSystemName)];
+
+	bool valid = !index.folders.empty();
+	for (auto it = index.folders.cbegin(); valid && it != index.folders.cend(); ++it)
+		valid = Utils::FileSystem::getFileModificationDate(it->first).getTime() == it->second;
+
+	if (!valid)
+	{
+		index = MusicIndex();
+		scanMusicIn(path, anySystem, index);
 	}
+
+	all_matching_files.insert(all_matching_files.end(), index.files.cbegin(), index.files.cend());
 }
 
 // batocera
@@ -184,9 +215,11 @@ void AudioManager::addLastPlayed(const std::string& newSong, int totalMusic)
 	}
 	
 	while (mLastPlayed.size() > historySize) {
+		mLastPlayedSet.erase(mLastPlayed.back());
 		mLastPlayed.pop_back();
 	}
 	mLastPlayed.push_front(newSong);
+	mLastPlayedSet.insert(newSong);
 	
 	LOG(LogDebug) << "Adding " << newSong << " to last played, " << mLastPlayed.size() << " in history";
 }
@@ -195,21 +228,11 @@ void AudioManager::addLastPlayed(const std::string& newSong, int totalMusic)
 // Check if current song exists in last played history
 bool AudioManager::songWasPlayedRecently(const std::string& song)
 {
-	for (std::string i : mLastPlayed)
-	{
-		if (song == i)
-		{
-			return true;
-		}
-	}
-	return false;
+	return mLastPlayedSet.find(song) != mLastPlayedSet.cend();
 }
 
-void AudioManager::playRandomMusic(bool continueIfPlaying) 
+std::vector<std::string> AudioManager::getMusicList()
 {
-	if (!Settings::BackgroundMusic())
-		return;
-		
 	std::vector<std::string> musics;
 
 	// check in Theme music directory
@@ -228,24 +251,105 @@ void AudioManager::playRandomMusic(bool continueIfPlaying)
 	if (musics.empty())
 		getMusicIn(Paths::getUserEmulationStationPath() + "/music", musics);
 
+	return musics;
+}
+
+std::string AudioManager::pickRandomSong(const std::vector<std::string>& musics)
+{
 	if (musics.empty())
-		return;
+		return "";
 
-	int randomIndex = Randomizer::random(musics.size());
-	while (songWasPlayedRecently(musics.at(randomIndex)))
-	{
-		LOG(LogDebug) << "Music \"" << musics.at(randomIndex) << "\" was played recently, trying again";
-		randomIndex = Randomizer::random(musics.size());
-	}
+	// The history is at most LAST_PLAYED_SIZE of the songs : there are always others
+	std::vector<int> candidates;
+	for (int i = 0; i < (int)musics.size(); i++)
+		if (!songWasPlayedRecently(musics[i]))
+			candidates.push_back(i);
+
+	if (candidates.empty())
+		return musics.at(Randomizer::random(musics.size()));
+
+	return musics.at(candidates[Randomizer::random(candidates.size())]);
+}
+
+void AudioManager::playRandomMusic(bool continueIfPlaying) 
+{
+	if (!Settings::BackgroundMusic())
+		return;
 
 	// continue playing ?
 	if (mCurrentMusic != nullptr && continueIfPlaying)
 		return;
 
-	playMusic(musics.at(randomIndex));
-	playSong(musics.at(randomIndex));
-	addLastPlayed(musics.at(randomIndex), musics.size());
+	std::vector<std::string> musics = getMusicList();
+	if (musics.empty())
+		return;
+
+	// The prefetched song, unless the playlist changed since
+	std::string song = mNextMusicPath;
+	if (song.empty() || songWasPlayedRecently(song) || std::find(musics.cbegin(), musics.cend(), song) == musics.cend())
+		song = pickRandomSong(musics);
+
+	playMusic(song);
+	playSong(song);
+	addLastPlayed(song, musics.size());
 	mPlayingSystemThemeSong = "";
+
+	prefetchSong(pickRandomSong(musics));
+}
+
+void AudioManager::prefetchSong(const std::string& path)
+{
+	cancelPrefetch();
+
+	if (path.empty() || !mInitialized)
+		return;
+
+	mNextMusicPath = path;
+
+	// Mix_LoadMUS opens the file & reads the headers ( the whole song for the modules ), it never touches the playing music
+	mPrefetchThread = std::thread([this, path]()
+	{
+		Mix_Music* music = Mix_LoadMUS(path.c_str());
+
+		std::unique_lock<std::mutex> lock(mPrefetchLock);
+		if (mNextMusicPath == path && mNextMusic == nullptr)
+			mNextMusic = music;
+		else if (music != nullptr)
+			Mix_FreeMusic(music);
+	});
+}
+
+Mix_Music* AudioManager::takePrefetchedSong(const std::string& path)
+{
+	if (mPrefetchThread.joinable())
+		mPrefetchThread.join();
+
+	std::unique_lock<std::mutex> lock(mPrefetchLock);
+
+	Mix_Music* music = nullptr;
+
+	if (mNextMusicPath == path)
+		music = mNextMusic;
+	else if (mNextMusic != nullptr)
+		Mix_FreeMusic(mNextMusic);
+
+	mNextMusic = nullptr;
+	mNextMusicPath = "";
+	return music;
+}
+
+void AudioManager::cancelPrefetch()
+{
+	if (mPrefetchThread.joinable())
+		mPrefetchThread.join();
+
+	std::unique_lock<std::mutex> lock(mPrefetchLock);
+
+	if (mNextMusic != nullptr)
+		Mix_FreeMusic(mNextMusic);
+
+	mNextMusic = nullptr;
+	mNextMusicPath = "";
 }
 
 void AudioManager::playMusic(std::string path)
@@ -259,8 +363,11 @@ void AudioManager::playMusic(std::string path)
 	if (!Settings::BackgroundMusic())
 		return;
 
-	// load a new music
-	mCurrentMusic = Mix_LoadMUS(path.c_str());
+	// load a new music, unless it's already opened
+	mCurrentMusic = takePrefetchedSong(path);
+	if (mCurrentMusic == NULL)
+		mCurrentMusic = Mix_LoadMUS(path.c_str());
+
 	if (mCurrentMusic == NULL)
 	{
 		LOG(LogError) << Mix_GetError() << " for " << path;
@@ -274,18 +381,27 @@ void AudioManager::playMusic(std::string path)
 	}
 
 	mCurrentMusicPath = path;
+	mMusicFadingOut = false;
+	mMusicEnded = false;
 	Mix_HookMusicFinished(AudioManager::musicEnd_callback);
 }
 
+// Called by the SDL audio thread, where the Mix_ functions can't be used : the next song starts in update
 void AudioManager::musicEnd_callback()
 {
-	if (!AudioManager::getInstance()->mPlayingSystemThemeSong.empty())
+	if (sInstance != nullptr)
+		sInstance->mMusicEnded = true;
+}
+
+void AudioManager::onMusicEnded()
+{
+	if (!mPlayingSystemThemeSong.empty())
 	{
-		AudioManager::getInstance()->playMusic(AudioManager::getInstance()->mPlayingSystemThemeSong);
+		playMusic(mPlayingSystemThemeSong);
 		return;
 	}
 
-	AudioManager::getInstance()->playRandomMusic(false);
+	playRandomMusic(false);
 }
 
 void AudioManager::stopMusic(bool fadeOut)
@@ -538,7 +654,7 @@ void AudioManager::setVideoPlaying(bool state)
 	if (sInstance == nullptr || !sInstance->mInitialized || !Settings::BackgroundMusic())
 		return;
 	
-	if (state && (!Settings::getInstance()->getBool("VideoLowersMusic") || !Settings::getInstance()->getBool("VideoAudio")))
+	if (state && (!Settings::getInstance()->getBool("VideoLowersMusic") || !Settings::get(BoolSetting::VideoAudio)))
 	{
 		sInstance->mVideoPlaying = false;
 		return;
@@ -566,6 +682,26 @@ void AudioManager::update(int deltaTime)
 	if (sInstance == nullptr || !sInstance->mInitialized || !Settings::BackgroundMusic())
 		return;
 
+	if (sInstance->mMusicEnded.exchange(false))
+		sInstance->onMusicEnded();
+
+#ifdef SDL_MIXER_VERSION_ATLEAST
+#if SDL_MIXER_VERSION_ATLEAST(2, 6, 0)
+	// Fade out the end of the song, the next one fades in as soon as it's finished. A system theme song loops without fading
+	if (sInstance->mCurrentMusic != nullptr && !sInstance->mMusicFadingOut && sInstance->mPlayingSystemThemeSong.empty())
+	{
+		double duration = Mix_MusicDuration(sInstance->mCurrentMusic);
+		double position = Mix_GetMusicPosition(sInstance->mCurrentMusic);
+
+		if (duration * 1000.0 > MUSIC_CROSSFADE_MS * 4 && position >= 0 && (duration - position) * 1000.0 < MUSIC_CROSSFADE_MS)
+		{
+			sInstance->mMusicFadingOut = true;
+			Mix_FadeOutMusic(std::max(1, (int)((duration - position) * 1000.0)));
+		}
+	}
+#endif
+#endif
+
 	float deltaVol = deltaTime / 8.0f;
 
 //	#define MINVOL 5
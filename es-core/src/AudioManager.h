@@ -9,7 +9,13 @@
 #include <string> 
 #include <iostream> 
 #include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <unordered_set>
 #include <math.h>
+#include <time.h>
 
 class Sound;
 class ThemeData;
@@ -26,12 +32,38 @@ private:
 	void getMusicIn(const std::string &path, std::vector<std::string>& all_matching_files); 
 	void playMusic(std::string path);
 	static void musicEnd_callback();	
+	void onMusicEnded();
+
+	// Listing of a music folder, rescanned when one of its folders is modified
+	struct MusicIndex
+	{
+		std::vector<std::pair<std::string, time_t>> folders;
+		std::vector<std::string> files;
+	};
+
+	std::map<std::string, MusicIndex> mMusicIndex;
+	void scanMusicIn(const std::string& path, bool anySystem, MusicIndex& index);
+	std::vector<std::string> getMusicList();
+	std::string pickRandomSong(const std::vector<std::string>& musics);
+
+	// The next song is opened in the background while the current one plays
+	void prefetchSong(const std::string& path);
+	Mix_Music* takePrefetchedSong(const std::string& path);
+	void cancelPrefetch();
+
+	std::thread				mPrefetchThread;
+	std::mutex				mPrefetchLock;
+	std::string				mNextMusicPath;
+	Mix_Music*				mNextMusic;
+	std::atomic<bool>		mMusicEnded;
+	bool					mMusicFadingOut;
 
 	std::string mSystemName;			// per system music folder
 	std::string mCurrentSong;			// pop-up for SongName.cpp
 	std::string mCurrentThemeMusicDirectory;
 	std::string mCurrentMusicPath;
 	std::deque<std::string> mLastPlayed;    // batocera
+	std::unordered_set<std::string> mLastPlayedSet;
 
 	bool		mInitialized;
 	std::string	mPlayingSystemThemeSong;
@@ -0,0 +1,132 @@
+#include "ConfigWriter.h"
+
+#include "utils/FileSystemUtil.h"
+#include "Log.h"
+#include "TaskScheduler.h"
+
+// A slider or a list scrolled through saves on each step : the file is written once it stays unchanged this long
+#define WRITE_DELAY_MS		500
+
+std::mutex ConfigWriter::mLock;
+std::mutex ConfigWriter::mWriteLock;
+std::condition_variable ConfigWriter::mEvent;
+std::thread* ConfigWriter::mThread = nullptr;
+bool ConfigWriter::mExit = false;
+std::map<std::string, ConfigWriter::Job> ConfigWriter::mJobs;
+
+void ConfigWriter::queue(const std::string& path, const content_function& content, const std::function<void()>& onWritten)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	Job& job = mJobs[path];
+	job.content = content;
+	job.onWritten = onWritten;
+	job.due = std::chrono::steady_clock::now() + std::chrono::milliseconds(WRITE_DELAY_MS);
+
+	// Stopped : nobody would write it
+	if (mExit)
+	{
+		lock.unlock();
+		flush();
+		return;
+	}
+
+	if (mThread == nullptr)
+		mThread = new std::thread(&ConfigWriter::run);
+
+	mEvent.notify_one();
+}
+
+void ConfigWriter::writeJob(const std::string& path, const Job& job)
+{
+	std::string content;
+	if (!job.content(content))
+		return;
+
+	if (!Utils::FileSystem::writeFileAtomic(path, content.data(), content.size()))
+	{
+		LOG(LogError) << "ConfigWriter : Unable to write " << path;
+		return;
+	}
+
+	if (job.onWritten)
+		job.onWritten();
+}
+
+void ConfigWriter::flush()
+{
+	std::unique_lock<std::mutex> writeLock(mWriteLock);
+
+	std::map<std::string, Job> jobs;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		jobs.swap(mJobs);
+	}
+
+	for (auto& job : jobs)
+		writeJob(job.first, job.second);
+}
+
+void ConfigWriter::stop()
+{
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		mExit = true;
+		mEvent.notify_one();
+	}
+
+	if (mThread != nullptr)
+	{
+		mThread->join();
+		delete mThread;
+		mThread = nullptr;
+	}
+
+	flush();
+}
+
+void ConfigWriter::run()
+{
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::BACKGROUND);
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	while (!mExit)
+	{
+		auto next = mJobs.begin();
+		for (auto it = mJobs.begin(); it != mJobs.end(); ++it)
+			if (it->second.due < next->second.due)
+				next = it;
+
+		if (next == mJobs.end())
+		{
+			mEvent.wait(lock);
+			continue;
+		}
+
+		if (next->second.due > std::chrono::steady_clock::now())
+		{
+			mEvent.wait_until(lock, next->second.due);
+			continue;
+		}
+
+		std::string path = next->first;
+
+		// The write lock first, like flush() : a flushed content is never overwritten by an older one
+		lock.unlock();
+		std::unique_lock<std::mutex> writeLock(mWriteLock);
+		lock.lock();
+
+		auto it = mJobs.find(path);
+		if (it == mJobs.end())
+			continue;
+
+		Job job = it->second;
+		mJobs.erase(it);
+
+		lock.unlock();
+		writeJob(path, job);
+		lock.lock();
+	}
+}
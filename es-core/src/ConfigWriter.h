@@ -0,0 +1,50 @@
+#pragma once
+#ifndef ES_CORE_CONFIG_WRITER_H
+#define ES_CORE_CONFIG_WRITER_H
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+
+// Writes the configuration files ( es_settings.cfg, batocera.conf ) from a background thread.
+// The saves of a file are coalesced until it stays unchanged for a moment : only the last content is written, through a temporary file & a rename
+class ConfigWriter
+{
+public:
+	// Returns the whole file, or false when there's nothing to write. Called on the writer thread
+	typedef std::function<bool(std::string& content)> content_function;
+
+	// onWritten runs on the writer thread, once the file is on disk
+	static void queue(const std::string& path, const content_function& content, const std::function<void()>& onWritten = nullptr);
+
+	// Writes the pending files on the calling thread, they're on disk on return
+	static void flush();
+
+	// Flushes, then stops the writer
+	static void stop();
+
+private:
+	struct Job
+	{
+		content_function content;
+		std::function<void()> onWritten;
+		std::chrono::steady_clock::time_point due;
+	};
+
+	static void writeJob(const std::string& path, const Job& job);
+	static void run();
+
+	static std::mutex		mLock;
+	static std::mutex		mWriteLock; // Held while a file is written
+	static std::condition_variable	mEvent;
+	static std::thread*		mThread;
+	static bool				mExit;
+
+	static std::map<std::string, Job> mJobs;
+};
+
+#endif // ES_CORE_CONFIG_WRITER_H
@@ -0,0 +1,233 @@
+#include "FrameScheduler.h"
+
+#include "renderers/Renderer.h"
+#include "InputLatency.h"
+#include "utils/StringUtil.h"
+#include "Settings.h"
+#include "Log.h"
+#include <SDL.h>
+#include <thread>
+
+#define STATS_WINDOW_MS	500
+#define SPIN_MARGIN_MS	2
+
+int FrameScheduler::mRefreshRate = 60;
+int FrameScheduler::mTargetRate = 60;
+bool FrameScheduler::mAdaptive = true;
+
+uint64_t FrameScheduler::mFrequency = 1;
+uint64_t FrameScheduler::mFrameStart = 0;
+uint64_t FrameScheduler::mLastPresent = 0;
+uint64_t FrameScheduler::mNextDeadline = 0;
+bool FrameScheduler::mWokeUp = true;
+
+uint64_t FrameScheduler::mStatsStart = 0;
+FrameStats FrameScheduler::mStats;
+uint64_t FrameScheduler::mFrameTime = 0;
+uint64_t FrameScheduler::mWorkTime = 0;
+uint64_t FrameScheduler::mPresentTime = 0;
+uint64_t FrameScheduler::mSleepTime = 0;
+int FrameScheduler::mIntervals = 0;
+
+FrameStats FrameScheduler::mLastStats;
+
+std::atomic<uint64_t> FrameScheduler::mHistogram[FrameScheduler::HISTOGRAM_BUCKETS];
+std::atomic<uint64_t> FrameScheduler::mHistogramSumUs(0);
+
+// Around the usual refresh periods ( 120, 60, 50, 30, 20fps... ), the last bucket is +Inf
+static const float sHistogramBounds[FrameScheduler::HISTOGRAM_BUCKETS] = { 8.4f, 16.8f, 20.1f, 33.4f, 50.1f, 100.0f, 250.0f, 1e30f };
+
+const float* FrameScheduler::getHistogramBounds()
+{
+	return sHistogramBounds;
+}
+
+void FrameScheduler::getHistogram(uint64_t counts[HISTOGRAM_BUCKETS], uint64_t& count, double& sumMs)
+{
+	count = 0;
+
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+	{
+		count += mHistogram[i];
+		counts[i] = count;
+	}
+
+	sumMs = (double)mHistogramSumUs / 1000.0;
+}
+
+void FrameScheduler::init()
+{
+	mFrequency = SDL_GetPerformanceFrequency();
+	if (mFrequency == 0)
+		mFrequency = 1;
+
+	mRefreshRate = 60;
+
+	SDL_DisplayMode mode;
+	if (Renderer::getSDLWindow() != nullptr && SDL_GetWindowDisplayMode(Renderer::getSDLWindow(), &mode) == 0 && mode.refresh_rate > 0)
+		mRefreshRate = mode.refresh_rate;
+
+	std::string frameRate = Settings::getInstance()->getString("FrameRate");
+
+	mAdaptive = frameRate.empty() || frameRate == "auto";
+	mTargetRate = mAdaptive ? mRefreshRate : Utils::String::toInteger(frameRate);
+	if (mTargetRate <= 0)
+		mTargetRate = mRefreshRate;
+
+	mFrameStart = mLastPresent = mNextDeadline = 0;
+	mWokeUp = true;
+
+	mStats = FrameStats();
+	mFrameTime = mWorkTime = mPresentTime = mSleepTime = 0;
+	mIntervals = 0;
+	mStatsStart = SDL_GetPerformanceCounter();
+
+	LOG(LogInfo) << "FrameScheduler : display " << mRefreshRate << "Hz, target " << mTargetRate << "fps" << (mAdaptive ? " (adaptive)" : "");
+}
+
+void FrameScheduler::beginFrame()
+{
+	mFrameStart = SDL_GetPerformanceCounter();
+}
+
+void FrameScheduler::wakeUp()
+{
+	mWokeUp = true;
+
+	if (mAdaptive)
+		mTargetRate = mRefreshRate;
+}
+
+void FrameScheduler::sleepUntil(uint64_t deadline)
+{
+	// SDL_Delay is only as accurate as the scheduler : sleep until close to the deadline, then yield until it
+	for (;;)
+	{
+		uint64_t now = SDL_GetPerformanceCounter();
+		if (now >= deadline)
+			break;
+
+		uint64_t remaining = (deadline - now) * 1000 / mFrequency;
+		if (remaining > SPIN_MARGIN_MS)
+			SDL_Delay((Uint32)(remaining - SPIN_MARGIN_MS));
+		else
+			std::this_thread::yield();
+	}
+}
+
+void FrameScheduler::present()
+{
+	uint64_t presentStart = SDL_GetPerformanceCounter();
+
+	Renderer::swapBuffers();
+	InputLatency::onPresent();
+
+	uint64_t now = SDL_GetPerformanceCounter();
+	uint64_t period = mFrequency / mTargetRate;
+
+	mStats.frames++;
+	mWorkTime += presentStart - (mFrameStart != 0 ? mFrameStart : presentStart);
+	mPresentTime += now - presentStart;
+
+	if (!mWokeUp && mLastPresent != 0)
+	{
+		uint64_t interval = now - mLastPresent;
+		mFrameTime += interval;
+		mIntervals++;
+
+		float intervalMs = (float)interval * 1000.0f / (float)mFrequency;
+		if (intervalMs > mStats.maxFrameTime)
+			mStats.maxFrameTime = intervalMs;
+
+		int bucket = 0;
+		while (bucket < HISTOGRAM_BUCKETS - 1 && intervalMs > sHistogramBounds[bucket])
+			bucket++;
+
+		mHistogram[bucket]++;
+		mHistogramSumUs += (uint64_t)(intervalMs * 1000.0f);
+
+		if (mNextDeadline != 0 && now > mNextDeadline + period / 2)
+			mStats.missedDeadlines++;
+	}
+
+	// vsync already paces frames at the display rate
+	bool paced = !(Settings::VSync() && mTargetRate >= mRefreshRate);
+
+	if (paced)
+	{
+		// Keep the cadence of the previous deadlines, unless we woke up or fell more than a frame behind
+		uint64_t deadline = mNextDeadline;
+		if (mWokeUp || deadline == 0 || now >= deadline + period)
+			deadline = now;
+		else if (now < deadline)
+		{
+			sleepUntil(deadline);
+			mSleepTime += SDL_GetPerformanceCounter() - now;
+		}
+
+		mNextDeadline = deadline + period;
+	}
+	else
+		mNextDeadline = now + period;
+
+	mWokeUp = false;
+	mLastPresent = SDL_GetPerformanceCounter();
+
+	updateStats(mLastPresent);
+}
+
+void FrameScheduler::skipFrame()
+{
+	mStats.idleFrames++;
+
+	// Idling blocks on events, the next frame must not wait for a stale deadline
+	mWokeUp = true;
+
+	updateStats(SDL_GetPerformanceCounter());
+}
+
+void FrameScheduler::updateStats(uint64_t now)
+{
+	if ((now - mStatsStart) * 1000 < STATS_WINDOW_MS * mFrequency)
+		return;
+
+	float toMs = 1000.0f / (float)mFrequency;
+
+	mStats.targetRate = mTargetRate;
+
+	if (mIntervals > 0)
+	{
+		mStats.averageFrameTime = (float)mFrameTime * toMs / (float)mIntervals;
+		mStats.averageSleepTime = (float)mSleepTime * toMs / (float)mIntervals;
+	}
+
+	if (mStats.frames > 0)
+	{
+		mStats.averageWorkTime = (float)mWorkTime * toMs / (float)mStats.frames;
+		mStats.averagePresentTime = (float)mPresentTime * toMs / (float)mStats.frames;
+	}
+
+	mLastStats = mStats;
+
+	// Adaptive : halve the rate while a quarter of the frames miss their deadline, and come back once frames are cheap enough again
+	if (mAdaptive && mStats.frames > 0)
+	{
+		float fullPeriodMs = 1000.0f / (float)mRefreshRate;
+
+		if (mTargetRate == mRefreshRate && mRefreshRate >= 50 && mStats.missedDeadlines * 4 > mStats.frames)
+		{
+			mTargetRate = mRefreshRate / 2;
+			LOG(LogDebug) << "FrameScheduler : missing deadlines, dropping to " << mTargetRate << "fps";
+		}
+		else if (mTargetRate != mRefreshRate && mStats.averageWorkTime < fullPeriodMs * 0.6f)
+		{
+			mTargetRate = mRefreshRate;
+			LOG(LogDebug) << "FrameScheduler : back to " << mTargetRate << "fps";
+		}
+	}
+
+	mStats = FrameStats();
+	mFrameTime = mWorkTime = mPresentTime = mSleepTime = 0;
+	mIntervals = 0;
+	mStatsStart = now;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef ES_CORE_FRAME_SCHEDULER_H
+#define ES_CORE_FRAME_SCHEDULER_H
+
+#include <cstdint>
+#include <atomic>
+
+struct FrameStats
+{
+	FrameStats() : targetRate(0), frames(0), idleFrames(0), missedDeadlines(0), averageFrameTime(0), maxFrameTime(0), averageWorkTime(0), averagePresentTime(0), averageSleepTime(0) { }
+
+	int		targetRate;			// Frames per second, 0 when not paced
+	int		frames;				// Rendered frames
+	int		idleFrames;			// Loop iterations that did not need to render
+	int		missedDeadlines;
+	float	averageFrameTime;	// ms between two presented frames
+	float	maxFrameTime;
+	float	averageWorkTime;	// ms spent in update & render
+	float	averagePresentTime;	// ms spent in swapBuffers
+	float	averageSleepTime;	// ms spent waiting for the next deadline
+};
+
+// Paces the main loop on a target refresh rate, sleeping precisely until each frame deadline instead of relying on vsync and SDL_Delay(1).
+// The "FrameRate" setting is "auto", "60" or "30" : auto follows the display refresh rate, and halves it while frames keep missing their deadline.
+// When nothing needs to be rendered, the main loop blocks for events, and the first frame after a wake up is never delayed
+class FrameScheduler
+{
+public:
+	static void init();
+
+	// Called before update, once events are processed
+	static void beginFrame();
+	// Swaps buffers and sleeps until the next frame deadline
+	static void present();
+	// Called instead of present() when the frame did not need to be rendered
+	static void skipFrame();
+
+	// Input arrived after idling : the next frame starts now, at full rate
+	static void wakeUp();
+
+	static int getTargetRate() { return mTargetRate; }
+	static FrameStats getStats() { return mLastStats; }
+
+	// Presented frame intervals since startup : counts[i] frames took at most getHistogramBounds()[i] ms, the last bucket is +Inf. Thread safe
+	static const int HISTOGRAM_BUCKETS = 8;
+	static const float* getHistogramBounds();
+	static void getHistogram(uint64_t counts[HISTOGRAM_BUCKETS], uint64_t& count, double& sumMs);
+
+private:
+	static void sleepUntil(uint64_t deadline);
+	static void updateStats(uint64_t now);
+
+	static int			mRefreshRate;
+	static int			mTargetRate;
+	static bool			mAdaptive;
+
+	static uint64_t		mFrequency;
+	static uint64_t		mFrameStart;
+	static uint64_t		mLastPresent;
+	static uint64_t		mNextDeadline;
+	static bool			mWokeUp;
+
+	// Current 500ms window
+	static uint64_t		mStatsStart;
+	static FrameStats	mStats;
+	static uint64_t		mFrameTime;
+	static uint64_t		mWorkTime;
+	static uint64_t		mPresentTime;
+	static uint64_t		mSleepTime;
+	static int			mIntervals;
+
+	static FrameStats	mLastStats;
+
+	static std::atomic<uint64_t> mHistogram[HISTOGRAM_BUCKETS];
+	static std::atomic<uint64_t> mHistogramSumUs;
+};
+
+#endif // ES_CORE_FRAME_SCHEDULER_H
@@ -3,10 +3,14 @@
 #include "animations/Animation.h"
 #include "animations/AnimationController.h"
 #include "renderers/Renderer.h"
+#include "resources/TextureResource.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "ThemeData.h"
 #include "Window.h"
+#include "WakeScheduler.h"
 #include <algorithm>
+#include <set>
 #include "animations/LambdaAnimation.h"
 #include "anim/StoryboardAnimator.h"
 #include "components/ScrollableContainer.h"
@@ -15,11 +19,18 @@
 #include "utils/StringUtil.h"
 
 bool GuiComponent::isLaunchTransitionRunning = false;
+int GuiComponent::sRenderCacheCount = 0;
+std::vector<GuiComponent::ActiveAnimation> GuiComponent::sActiveAnimations;
+
+// Components owning a render cache texture
+static std::set<GuiComponent*> sRenderCacheOwners;
 
 GuiComponent::GuiComponent(Window* window) : mWindow(window), mParent(NULL), mOpacity(255),
 	mPosition(Vector3f::Zero()), mOrigin(Vector2f::Zero()), mRotationOrigin(0.5, 0.5), mScaleOrigin(0.5f, 0.5f),
 	mSize(Vector2f::Zero()), mTransform(Transform4x4f::Identity()), mVisible(true), mShowing(false),
-	mExtraType(ExtraType::BUILTIN), mStoryboardAnimator(nullptr), mScreenOffset(0.0f), mTransformDirty(true), mIsMouseOver(false), mChildZIndexDirty(false)
+	mExtraType(ExtraType::BUILTIN), mStoryboardAnimator(nullptr), mScreenOffset(0.0f), mTransformDirty(true), mIsMouseOver(false), mChildZIndexDirty(false),
+	mBoundsDirty(true), mRenderCache(false), mRenderCacheValid(false), mRenderCacheTexture(0), mRenderCacheWidth(0), mRenderCacheHeight(0),
+	mUpdateActive(true), mUpdateAlways(false), mSubtreeActive(true), mActiveChildren(0)
 {
 	mClipRect = Vector4f();
 }
@@ -29,6 +40,7 @@ GuiComponent::~GuiComponent()
 	mWindow->removeGui(this);
 
 	cancelAllAnimations();
+	setRenderCache(false);
 
 	if (mStoryboardAnimator != nullptr)
 	{
@@ -63,17 +75,13 @@ bool GuiComponent::input(InputConfig* config, Input input)
 
 void GuiComponent::updateSelf(int deltaTime)
 {
-	if (mAnimationMap.size())
-	{
-		for (auto it = mAnimationMap.cbegin(), next_it = it; it != mAnimationMap.cend(); it = next_it)
-		{
-			++next_it;
-			advanceAnimation(it->first, deltaTime);
-		}
-	}
-
 	if (mStoryboardAnimator != nullptr)
+	{
 		mStoryboardAnimator->update(deltaTime);
+
+		if (mStoryboardAnimator->isRunning() && !mStoryboardAnimator->isWaiting())
+			invalidateRender();
+	}
 }
 
 void GuiComponent::updateChildren(int deltaTime)
@@ -87,6 +95,11 @@ void GuiComponent::updateChildren(int deltaTime)
 	for (auto it = mChildren.cbegin(), next_it = it; it != mChildren.cend(); it = next_it)
 	{
 		++next_it;
+
+		if (!(*it)->mSubtreeActive)
+			continue;
+
+		ProfileScope scope(*it, Profiler::UPDATE);
 		TRYCATCH("GuiComponent::updateChildren", (*it)->update(deltaTime))
 	}
 }
@@ -120,8 +133,197 @@ void GuiComponent::render(const Transform4x4f& parentTrans)
 void GuiComponent::renderChildren(const Transform4x4f& transform) const
 {
 	for (auto child : mChildren)
-		if (child->mVisible)
-			TRYCATCH("GuiComponent::renderChildren", child->render(transform));
+	{
+		if (!child->mVisible || !child->isSubtreeVisible(transform))
+			continue;
+
+		ProfileScope scope(child, Profiler::RENDER);
+		TRYCATCH("GuiComponent::renderChildren", child->renderCached(transform));
+	}
+}
+
+// Drawings a little outside of the bounds ( glows, nine patch borders... ) must not be culled
+#define BOUNDS_MARGIN (Renderer::getScreenHeight() / 32.0f)
+
+static void addTransformedBounds(Vector4f& bounds, const Transform4x4f& trans, const Vector4f& box, bool first)
+{
+	const Vector3f corners[4] =
+	{
+		trans * Vector3f(box.x(), box.y(), 0),
+		trans * Vector3f(box.z(), box.y(), 0),
+		trans * Vector3f(box.x(), box.w(), 0),
+		trans * Vector3f(box.z(), box.w(), 0)
+	};
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (first && i == 0)
+		{
+			bounds = Vector4f(corners[i].x(), corners[i].y(), corners[i].x(), corners[i].y());
+			continue;
+		}
+
+		bounds.x() = Math::min(bounds.x(), corners[i].x());
+		bounds.y() = Math::min(bounds.y(), corners[i].y());
+		bounds.z() = Math::max(bounds.z(), corners[i].x());
+		bounds.w() = Math::max(bounds.w(), corners[i].y());
+	}
+}
+
+const Vector4f& GuiComponent::getSubtreeBounds()
+{
+	if (!mBoundsDirty)
+		return mSubtreeBounds;
+
+	Vector4f local = getLocalRenderBounds();
+	mSubtreeBounds = Vector4f(Math::min(local.x(), local.z()), Math::min(local.y(), local.w()), Math::max(local.x(), local.z()), Math::max(local.y(), local.w()));
+
+	for (auto child : mChildren)
+	{
+		// getTransform first : a transform update may invalidate the bounds again
+		const Transform4x4f& childTrans = child->getTransform();
+		addTransformedBounds(mSubtreeBounds, childTrans, child->getSubtreeBounds(), false);
+	}
+
+	mBoundsDirty = false;
+	return mSubtreeBounds;
+}
+
+void GuiComponent::invalidateBounds()
+{
+	// The ancestors of a dirty component are always dirty
+	for (GuiComponent* component = this; component != nullptr && !component->mBoundsDirty; component = component->mParent)
+		component->mBoundsDirty = true;
+}
+
+bool GuiComponent::isSubtreeVisible(const Transform4x4f& parentTrans)
+{
+	const Vector4f& bounds = getSubtreeBounds();
+
+	// Nothing sized yet : can't tell
+	if (bounds.z() <= bounds.x() || bounds.w() <= bounds.y())
+		return true;
+
+	Vector4f box;
+	addTransformedBounds(box, parentTrans * getTransform(), bounds, true);
+
+	float margin = BOUNDS_MARGIN;
+	return Renderer::isVisibleOnScreen(box.x() - margin, box.y() - margin, box.z() - box.x() + 2 * margin, box.w() - box.y() + 2 * margin);
+}
+
+void GuiComponent::setRenderCache(bool enabled)
+{
+	if (mRenderCache == enabled)
+		return;
+
+	mRenderCache = enabled;
+	sRenderCacheCount += enabled ? 1 : -1;
+
+	if (!enabled)
+		releaseRenderCache();
+
+	mRenderCacheValid = false;
+	Window::invalidate();
+}
+
+void GuiComponent::releaseRenderCache()
+{
+	if (mRenderCacheTexture != 0)
+	{
+		Renderer::destroyTexture(mRenderCacheTexture);
+		sRenderCacheOwners.erase(this);
+	}
+
+	mRenderCacheTexture = 0;
+	mRenderCacheValid = false;
+}
+
+void GuiComponent::releaseRenderCaches()
+{
+	auto owners = sRenderCacheOwners;
+	for (auto owner : owners)
+		owner->releaseRenderCache();
+}
+
+void GuiComponent::invalidateRender()
+{
+	Window::invalidate();
+	invalidateBounds();
+
+	if (sRenderCacheCount == 0)
+		return;
+
+	for (GuiComponent* component = this; component != nullptr; component = component->mParent)
+		if (component->mRenderCache)
+			component->mRenderCacheValid = false;
+}
+
+void GuiComponent::renderCached(const Transform4x4f& parentTrans)
+{
+	if (!mRenderCache || !mVisible || Renderer::isRenderingToTexture())
+	{
+		render(parentTrans);
+		return;
+	}
+
+	Transform4x4f trans = parentTrans * getTransform();
+
+	// Only scaled & translated subtrees can be drawn back as a rectangle
+	auto rect = Renderer::getScreenRect(trans, mSize);
+	if (trans.r0().y() != 0 || trans.r1().x() != 0 || rect.w <= 0 || rect.h <= 0 || rect.w > Renderer::getScreenWidth() * 2 || rect.h > Renderer::getScreenHeight() * 2)
+	{
+		render(parentTrans);
+		return;
+	}
+
+	if (!Renderer::isVisibleOnScreen(rect))
+		return;
+
+	// The cache is kept when the subtree only moves
+	if (mRenderCacheTexture != 0 && (mRenderCacheWidth != rect.w || mRenderCacheHeight != rect.h))
+		releaseRenderCache();
+
+	if (!mRenderCacheValid)
+	{
+		if (mRenderCacheTexture == 0)
+		{
+			mRenderCacheTexture = Renderer::createTexture(Renderer::Texture::RGBA, false, false, rect.w, rect.h, nullptr);
+			mRenderCacheWidth = rect.w;
+			mRenderCacheHeight = rect.h;
+
+			if (mRenderCacheTexture != 0)
+				sRenderCacheOwners.insert(this);
+		}
+
+		if (mRenderCacheTexture == 0 || !Renderer::beginRenderToTexture(mRenderCacheTexture, rect))
+		{
+			LOG(LogDebug) << "GuiComponent : render cache is not available, rendering " << mTag << " directly";
+
+			setRenderCache(false);
+			render(parentTrans);
+			return;
+		}
+
+		size_t blankBinds = TextureResource::getBlankBindCount();
+
+		render(parentTrans);
+
+		Renderer::endRenderToTexture();
+
+		// Images still loading are drawn blank : render again once they are there
+		mRenderCacheValid = (TextureResource::getBlankBindCount() == blankBinds);
+	}
+
+	// The texture holds premultiplied alpha, and its first row is the bottom of the rectangle
+	Renderer::Vertex vertices[4];
+	vertices[0] = { { (float)rect.x         , (float)rect.y          }, { 0.0f, 1.0f }, 0xFFFFFFFF };
+	vertices[1] = { { (float)rect.x         , (float)rect.y + rect.h }, { 0.0f, 0.0f }, 0xFFFFFFFF };
+	vertices[2] = { { (float)rect.x + rect.w, (float)rect.y          }, { 1.0f, 1.0f }, 0xFFFFFFFF };
+	vertices[3] = { { (float)rect.x + rect.w, (float)rect.y + rect.h }, { 1.0f, 0.0f }, 0xFFFFFFFF };
+
+	Renderer::setMatrix(Transform4x4f::Identity());
+	Renderer::bindTexture(mRenderCacheTexture);
+	Renderer::drawTriangleStrips(&vertices[0], 4, Renderer::Blend::ONE, Renderer::Blend::ONE_MINUS_SRC_ALPHA);
 }
 
 Vector3f GuiComponent::getPosition() const
@@ -136,6 +338,7 @@ void GuiComponent::setPosition(float x, float y, float z)
 		return;
 	
 	mPosition = position;
+	invalidateRender();
 	onPositionChanged();	
 }
 
@@ -151,6 +354,7 @@ void GuiComponent::setOrigin(float x, float y)
 		return;
 
 	mOrigin = origin;
+	invalidateRender();
 	onOriginChanged();
 }
 
@@ -166,6 +370,7 @@ void GuiComponent::setRotationOrigin(float x, float y)
 		return;
 
 	mRotationOrigin = origin;
+	invalidateRender();
 	onRotationOriginChanged();
 }
 
@@ -180,6 +385,9 @@ void GuiComponent::setSize(float w, float h)
 	//if (size == mSize)
 	//	return;
 
+	if (size != mSize)
+		invalidateRender();
+
 	mSize = size;
     onSizeChanged();
 }
@@ -195,6 +403,7 @@ void GuiComponent::setRotation(float rotation)
 		return;
 
 	mRotation = rotation;
+	invalidateRender();
 	onRotationChanged();
 }
 
@@ -209,6 +418,7 @@ void GuiComponent::setScale(float scale)
 		return;
 
 	mScale = scale;
+	invalidateRender();
 	onScaleChanged();
 }
 
@@ -223,6 +433,7 @@ void GuiComponent::setScaleOrigin(const Vector2f& scaleOrigin)
 		return;
 
 	mScaleOrigin = scaleOrigin;
+	invalidateRender();
 	onScaleOriginChanged();
 }
 
@@ -237,6 +448,7 @@ void GuiComponent::setScreenOffset(const Vector2f& screenOffset)
 		return;
 
 	mScreenOffset = screenOffset;
+	invalidateRender();
 	onScreenOffsetChanged();
 }
 
@@ -251,6 +463,7 @@ void GuiComponent::setZIndex(float z)
 		return;
 
 	mZIndex = z;
+	invalidateRender();
 
 	if (mParent != nullptr)
 		mParent->mChildZIndexDirty = true;
@@ -272,6 +485,9 @@ bool GuiComponent::isVisible() const
 }
 void GuiComponent::setVisible(bool visible)
 {
+	if (mVisible != visible)
+		invalidateRender();
+
 	mVisible = visible;
 }
 
@@ -284,6 +500,7 @@ Vector2f GuiComponent::getCenter() const
 //Children stuff.
 void GuiComponent::addChild(GuiComponent* cmp)
 {
+	invalidateRender();
 	mChildren.push_back(cmp);
 
 	if(cmp->getParent())
@@ -298,6 +515,8 @@ void GuiComponent::removeChild(GuiComponent* cmp)
 	if(!cmp->getParent())
 		return;
 
+	invalidateRender();
+
 	if(cmp->getParent() != this)
 	{
 		LOG(LogError) << "Tried to remove child from incorrect parent!";
@@ -318,6 +537,7 @@ void GuiComponent::removeChild(GuiComponent* cmp)
 void GuiComponent::clearChildren()
 {
 	mChildren.clear();
+	invalidateBounds();
 }
 
 void GuiComponent::sortChildren()
@@ -339,8 +559,55 @@ GuiComponent* GuiComponent::getChild(unsigned int i) const
 
 void GuiComponent::setParent(GuiComponent* parent)
 {
+	if (mParent == parent)
+		return;
+
+	if (mParent != nullptr && mSubtreeActive)
+	{
+		mParent->mActiveChildren--;
+		mParent->refreshUpdateActivity();
+	}
+
 	mParent = parent;
 
+	if (mParent != nullptr && mSubtreeActive)
+	{
+		mParent->mActiveChildren++;
+		mParent->refreshUpdateActivity();
+	}
+}
+
+void GuiComponent::setUpdateActive(bool active)
+{
+	if (mUpdateActive == active)
+		return;
+
+	mUpdateActive = active;
+	refreshUpdateActivity();
+}
+
+void GuiComponent::setUpdateAlways(bool always)
+{
+	if (mUpdateAlways == always)
+		return;
+
+	mUpdateAlways = always;
+	refreshUpdateActivity();
+}
+
+void GuiComponent::refreshUpdateActivity()
+{
+	bool active = mUpdateActive || mUpdateAlways || mStoryboardAnimator != nullptr || mActiveChildren > 0;
+	if (mSubtreeActive == active)
+		return;
+
+	mSubtreeActive = active;
+
+	if (mParent != nullptr)
+	{
+		mParent->mActiveChildren += active ? 1 : -1;
+		mParent->refreshUpdateActivity();
+	}
 }
 
 GuiComponent* GuiComponent::getParent() const
@@ -359,6 +626,8 @@ void GuiComponent::setOpacity(unsigned char opacity)
 		return;
 
 	mOpacity = opacity;
+	invalidateRender();
+
 	for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
 	{
 		(*it)->setOpacity(opacity);
@@ -372,6 +641,11 @@ const Transform4x4f& GuiComponent::getTransform()
 
 	mTransformDirty = false;
 	mTransform = Transform4x4f::Identity();
+
+	// The bounds of the parent depend on the transform of its children
+	if (mParent != nullptr)
+		mParent->invalidateBounds();
+
 	mTransform.translate(mPosition);
 
 	if (!mScreenOffset.empty())
@@ -438,9 +712,63 @@ void GuiComponent::setAnimation(Animation* anim, int delay, std::function<void()
 		oldAnim = it->second;
 	
 	if (oldAnim)
+	{
+		unregisterAnimation(oldAnim);
 		delete oldAnim;
+	}
+
+	auto controller = new AnimationController(anim, delay, finishedCallback, reverse);
+	mAnimationMap[slot] = controller;
+	sActiveAnimations.push_back({ this, slot, controller });
+}
 
-	mAnimationMap[slot] = new AnimationController(anim, delay, finishedCallback, reverse);
+void GuiComponent::unregisterAnimation(AnimationController* controller)
+{
+	for (auto& active : sActiveAnimations)
+	{
+		if (active.controller == controller)
+		{
+			active.controller = nullptr;
+			break;
+		}
+	}
+}
+
+void GuiComponent::updateAnimations(int deltaTime)
+{
+	std::vector<AnimationController*> finished;
+
+	// The animations started by the others begin on the next frame
+	size_t count = sActiveAnimations.size();
+	for (size_t i = 0; i < count; i++)
+	{
+		ActiveAnimation active = sActiveAnimations[i];
+		if (active.controller == nullptr)
+			continue;
+
+		// Animations still in their delay only need a frame when it ends
+		int remaining = -(active.controller->getTime() + deltaTime);
+		if (remaining > 0)
+			WakeScheduler::requestFrameIn(remaining);
+		else
+			active.component->invalidateRender();
+
+		if (active.controller->update(deltaTime))
+		{
+			auto it = active.component->mAnimationMap.find(active.slot);
+			if (it != active.component->mAnimationMap.cend() && it->second == active.controller)
+				active.component->mAnimationMap.erase(it);
+
+			sActiveAnimations[i].controller = nullptr;
+			finished.push_back(active.controller);
+		}
+	}
+
+	sActiveAnimations.erase(std::remove_if(sActiveAnimations.begin(), sActiveAnimations.end(), [](const ActiveAnimation& active) { return active.controller == nullptr; }), sActiveAnimations.end());
+
+	// The callbacks can start, stop or delete anything : they run once the list is consistent
+	for (auto controller : finished)
+		delete controller;
 }
 
 bool GuiComponent::stopAnimation(unsigned char slot)
@@ -450,6 +778,7 @@ bool GuiComponent::stopAnimation(unsigned char slot)
 	{
 		auto anim = it->second;
 		mAnimationMap.erase(it);
+		unregisterAnimation(anim);
 		delete anim;
 		return true;
 	}
@@ -466,6 +795,7 @@ bool GuiComponent::cancelAnimation(unsigned char slot)
 		anim->removeFinishedCallback();
 
 		mAnimationMap.erase(it);
+		unregisterAnimation(anim);
 		delete anim;
 
 		return true;
@@ -483,6 +813,7 @@ bool GuiComponent::finishAnimation(unsigned char slot)
 
 		auto anim = it->second;
 		mAnimationMap.erase(it);
+		unregisterAnimation(anim);
 		delete anim;
 		return true;
 	}
@@ -499,6 +830,7 @@ bool GuiComponent::advanceAnimation(unsigned char slot, unsigned int time)
 		{
 			auto anim = it->second;
 			mAnimationMap.erase(it);
+			unregisterAnimation(anim);
 			delete anim;
 		}
 
@@ -608,6 +940,7 @@ bool GuiComponent::selectStoryboard(const std::string& name)
 		}
 
 		mStoryboardAnimator = new StoryboardAnimator(this, sb->second);
+		refreshUpdateActivity();
 		return true;
 	}
 
@@ -624,7 +957,10 @@ bool GuiComponent::applyStoryboard(const ThemeData::ThemeElement* elem, const st
 	}
 
 	mStoryBoards = elem->mStoryBoards;
-	return selectStoryboard(name);
+
+	bool ret = selectStoryboard(name);
+	refreshUpdateActivity();
+	return ret;
 }
 
 void GuiComponent::stopStoryboard()
@@ -656,6 +992,8 @@ void GuiComponent::deselectStoryboard(bool restoreinitialProperties)
 		mStoryboardAnimator->reset();
 		delete mStoryboardAnimator;
 		mStoryboardAnimator = nullptr;
+
+		refreshUpdateActivity();
 	}
 }
 
@@ -711,97 +1049,99 @@ void GuiComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const std
 
 	using namespace ThemeFlags;
 
-	if(properties & POSITION && elem->has("pos"))
+	if(properties & POSITION && elem->has(ThemeProperties::POS))
 	{
-		Vector2f denormalized = elem->get<Vector2f>("pos") * scale;
+		Vector2f denormalized = elem->get<Vector2f>(ThemeProperties::POS) * scale;
 		setPosition(Vector3f(denormalized.x(), denormalized.y(), 0));
 	}
 
-	if (properties & POSITION && elem->has("x"))
+	if (properties & POSITION && elem->has(ThemeProperties::X))
 	{
-		float denormalized = elem->get<float>("x") * scale.x();
+		float denormalized = elem->get<float>(ThemeProperties::X) * scale.x();
 		setPosition(Vector3f(denormalized, mPosition.y(), 0));
 	}
 
-	if (properties & POSITION && elem->has("y"))
+	if (properties & POSITION && elem->has(ThemeProperties::Y))
 	{
-		float denormalized = elem->get<float>("y") * scale.y();
+		float denormalized = elem->get<float>(ThemeProperties::Y) * scale.y();
 		setPosition(Vector3f(mPosition.x(), denormalized, 0));
 	}
 
-	if(properties & ThemeFlags::SIZE && elem->has("size"))
-		setSize(elem->get<Vector2f>("size") * scale);
+	if(properties & ThemeFlags::SIZE && elem->has(ThemeProperties::SIZE))
+		setSize(elem->get<Vector2f>(ThemeProperties::SIZE) * scale);
 
-	if (properties & SIZE && elem->has("w"))
+	if (properties & SIZE && elem->has(ThemeProperties::W))
 	{
-		float denormalized = elem->get<float>("w") * scale.x();
+		float denormalized = elem->get<float>(ThemeProperties::W) * scale.x();
 		setSize(Vector2f(denormalized, mSize.y()));
 	}
 
-	if (properties & SIZE && elem->has("h"))
+	if (properties & SIZE && elem->has(ThemeProperties::H))
 	{
-		float denormalized = elem->get<float>("h") * scale.y();
+		float denormalized = elem->get<float>(ThemeProperties::H) * scale.y();
 		setSize(Vector2f(mSize.x(), denormalized));
 	}
 
 	// position + size also implies origin
-	if((properties & ORIGIN || (properties & POSITION && properties & ThemeFlags::SIZE)) && elem->has("origin"))
-		setOrigin(elem->get<Vector2f>("origin"));
+	if((properties & ORIGIN || (properties & POSITION && properties & ThemeFlags::SIZE)) && elem->has(ThemeProperties::ORIGIN))
+		setOrigin(elem->get<Vector2f>(ThemeProperties::ORIGIN));
 
 	if(properties & ThemeFlags::ROTATION) 
 	{
-		if(elem->has("rotation"))
-			setRotationDegrees(elem->get<float>("rotation"));
+		if(elem->has(ThemeProperties::ROTATION))
+			setRotationDegrees(elem->get<float>(ThemeProperties::ROTATION));
 		
-		if(elem->has("rotationOrigin"))
-			setRotationOrigin(elem->get<Vector2f>("rotationOrigin"));
+		if(elem->has(ThemeProperties::ROTATION_ORIGIN))
+			setRotationOrigin(elem->get<Vector2f>(ThemeProperties::ROTATION_ORIGIN));
 
-		if (elem->has("scale"))
-			setScale(elem->get<float>("scale"));
+		if (elem->has(ThemeProperties::SCALE))
+			setScale(elem->get<float>(ThemeProperties::SCALE));
 
-		if (elem->has("scaleOrigin"))
-			setScaleOrigin(elem->get<Vector2f>("scaleOrigin"));
+		if (elem->has(ThemeProperties::SCALE_ORIGIN))
+			setScaleOrigin(elem->get<Vector2f>(ThemeProperties::SCALE_ORIGIN));
 	}
 
-	if(properties & ThemeFlags::Z_INDEX && elem->has("zIndex"))
-		setZIndex(elem->get<float>("zIndex"));
+	if(properties & ThemeFlags::Z_INDEX && elem->has(ThemeProperties::Z_INDEX))
+		setZIndex(elem->get<float>(ThemeProperties::Z_INDEX));
 	else
 		setZIndex(getDefaultZIndex());
 
 	if (properties & ThemeFlags::VISIBLE)
-		setVisible(!elem->has("visible") || elem->get<bool>("visible"));
+		setVisible(!elem->has(ThemeProperties::VISIBLE) || elem->get<bool>(ThemeProperties::VISIBLE));
 
-	if (properties & POSITION && elem->has("offset"))
+	if (properties & POSITION && elem->has(ThemeProperties::OFFSET))
 	{
-		Vector2f denormalized = elem->get<Vector2f>("offset") * screenScale;
+		Vector2f denormalized = elem->get<Vector2f>(ThemeProperties::OFFSET) * screenScale;
 		setScreenOffset(denormalized);
 	}
 
-	if (properties & POSITION && elem->has("offsetX"))
+	if (properties & POSITION && elem->has(ThemeProperties::OFFSET_X))
 	{
-		float denormalized = elem->get<float>("offsetX") * screenScale.x();
+		float denormalized = elem->get<float>(ThemeProperties::OFFSET_X) * screenScale.x();
 		setScreenOffset(Vector2f(denormalized, mScreenOffset.y()));
 	}
 
-	if (properties & POSITION && elem->has("offsetY"))
+	if (properties & POSITION && elem->has(ThemeProperties::OFFSET_Y))
 	{
-		float denormalized = elem->get<float>("offsetY") * scale.y();
+		float denormalized = elem->get<float>(ThemeProperties::OFFSET_Y) * scale.y();
 		setScreenOffset(Vector2f(mScreenOffset.x(), denormalized));
 	}
 
-	if (properties & POSITION && elem->has("clipRect"))
+	if (properties & POSITION && elem->has(ThemeProperties::CLIP_RECT))
 	{
-		Vector4f val = elem->get<Vector4f>("clipRect") * Vector4f(screenScale.x(), screenScale.y(), screenScale.x(), screenScale.y());
+		Vector4f val = elem->get<Vector4f>(ThemeProperties::CLIP_RECT) * Vector4f(screenScale.x(), screenScale.y(), screenScale.x(), screenScale.y());
 		setClipRect(val);
 	}
 	else
 		setClipRect(Vector4f());
 
-	if (elem->has("onclick"))
-		setClickAction(elem->get<std::string>("onclick"));
+	if (elem->has(ThemeProperties::ONCLICK))
+		setClickAction(elem->get<std::string>(ThemeProperties::ONCLICK));
 	else
 		setClickAction("");
 
+	setRenderCache(elem->has(ThemeProperties::RENDER_CACHE) && elem->get<bool>(ThemeProperties::RENDER_CACHE));
+
 	for (auto prop : elem->properties)
 		if (prop.second.type == ThemeData::ThemeElement::Property::PropertyType::String && Utils::String::endsWith(prop.first, "_binding"))
 			mBindingExpressions[Utils::String::replace(prop.first, "_binding", "")] = prop.second.s;
@@ -952,7 +1292,7 @@ bool GuiComponent::isChild(GuiComponent* cmp)
 	return false;
 }
 
-ThemeData::ThemeElement::Property GuiComponent::getProperty(const std::string name)
+ThemeData::ThemeElement::Property GuiComponent::getProperty(const std::string& name)
 {
 	if (getParent() != nullptr && getParent()->isKindOf<ScrollableContainer>())
 	{
@@ -1020,7 +1360,7 @@ ThemeData::ThemeElement::Property GuiComponent::getProperty(const std::string na
 	return "";
 }
 
-void GuiComponent::setProperty(const std::string name, const ThemeData::ThemeElement::Property& value)
+void GuiComponent::setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value)
 {
 	Vector2f screenScale = Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 	Vector2f scale = getParent() ? getParent()->getSize() : screenScale;
@@ -1101,6 +1441,9 @@ void GuiComponent::setProperty(const std::string name, const ThemeData::ThemeEle
 
 void GuiComponent::setClipRect(const Vector4f& vec)
 {
+	if (mClipRect != vec)
+		invalidateRender();
+
 	mClipRect = vec;
 }
 
@@ -121,6 +121,12 @@ public:
 	bool isVisible() const;
 	void setVisible(bool visible);
 
+	// Update activity : a component declares if it needs ticks ( animations, videos, timers... ), true by default.
+	// updateChildren skips the children whose whole subtree has nothing to tick, so the cost of a frame follows what is animating
+	void setUpdateActive(bool active);
+	bool isUpdateActive() const { return mUpdateActive; }
+	bool hasUpdateActivity() const { return mSubtreeActive; }
+
 	// Returns the center point of the image (takes origin into account).
 	Vector2f getCenter() const;
 
@@ -146,6 +152,9 @@ public:
 	void stopAllAnimations();
 	void cancelAllAnimations();
 
+	// Advances the playing animations of all the components in one pass, once per frame, then calls the callbacks of the finished ones
+	static void updateAnimations(int deltaTime);
+
 	virtual unsigned char getOpacity() const;
 	virtual void setOpacity(unsigned char opacity);
 
@@ -188,8 +197,8 @@ public:
 	bool isStaticExtra() const { return mExtraType == ExtraType::STATIC; }
 	void setExtraType(ExtraType value) { mExtraType = value; }
 
-	virtual ThemeData::ThemeElement::Property getProperty(const std::string name);
-	virtual void setProperty(const std::string name, const ThemeData::ThemeElement::Property& value);
+	virtual ThemeData::ThemeElement::Property getProperty(const std::string& name);
+	virtual void setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value);
 
 	bool& isShowing() { return mShowing; }
 
@@ -211,6 +220,21 @@ public:
 	Vector4f& getClipRect() { return mClipRect; }
 	virtual void setClipRect(const Vector4f& vec);
 
+	// Area drawn by the component itself, in its own coordinates (x1, y1, x2, y2). Override when drawing outside of the size
+	virtual Vector4f getLocalRenderBounds() { return Vector4f(0, 0, mSize.x(), mSize.y()); }
+	// Render bounds of the component & of all its children, in its own coordinates. Cached until invalidateBounds() is called
+	const Vector4f& getSubtreeBounds();
+	void invalidateBounds();
+	// False when the whole subtree is outside of the screen & of the current clip rect
+	bool isSubtreeVisible(const Transform4x4f& parentTrans);
+
+	// Render cache : the subtree is rendered once into a texture, and drawn from it until one of its components calls invalidateRender().
+	// Meant for static decorations, components that change without invalidating ( videos... ) would be frozen
+	void setRenderCache(bool enabled);
+	bool isRenderCached() const { return mRenderCache; }
+	void invalidateRenderCache() { mRenderCacheValid = false; }
+	static void releaseRenderCaches(); // Before the renderer is destroyed
+
 	// Mouse
 	bool isMouseOver() { return mIsMouseOver; }
 
@@ -226,18 +250,26 @@ public:
 	
 	void setClickAction(const std::string& action) { mClickAction = action; }
 
-	std::map<std::string, std::string> getBindingExpressions() { return mBindingExpressions; }
+	const std::map<std::string, std::string>& getBindingExpressions() { return mBindingExpressions; }
 
 protected:
 	void beginCustomClipRect();
 	void endCustomClipRect();
 
 	void renderChildren(const Transform4x4f& transform) const;
-	void updateSelf(int deltaTime); // updates animations
+	// render(), or the render cache when enabled
+	void renderCached(const Transform4x4f& parentTrans);
+	void updateSelf(int deltaTime); // updates the storyboard
 	void updateChildren(int deltaTime); // updates animations
 
 	void loadThemedChildren(const ThemeData::ThemeElement* elem);
 
+	// Requests a new frame, and redraws the render caches of this component & of its ancestors
+	void invalidateRender();
+
+	// Ticks whatever the activity declared by the base class, for the components overriding update() with their own timers
+	void setUpdateAlways(bool always);
+
 	unsigned char mOpacity;
 	Window* mWindow;
 
@@ -284,11 +316,42 @@ private:
 
 	std::map<unsigned char, AnimationController*> mAnimationMap;
 	//AnimationController* mAnimationMap[MAX_ANIMATIONS];
+
+	struct ActiveAnimation
+	{
+		GuiComponent*			component;
+		unsigned char			slot;
+		AnimationController*	controller; // nullptr once removed, until the next updateAnimations
+	};
+
+	void unregisterAnimation(AnimationController* controller);
+
+	static std::vector<ActiveAnimation> sActiveAnimations;
 	
 	StoryboardAnimator* mStoryboardAnimator;
 	std::map<std::string, ThemeStoryboard*> mStoryBoards;
 
 	std::string mTag;
+
+	bool			mUpdateActive;
+	bool			mUpdateAlways;
+	bool			mSubtreeActive;		// mUpdateActive, a storyboard or an active child
+	int				mActiveChildren;
+
+	void refreshUpdateActivity();
+
+	void releaseRenderCache();
+
+	Vector4f		mSubtreeBounds;
+	bool			mBoundsDirty;
+
+	bool			mRenderCache;
+	bool			mRenderCacheValid;
+	unsigned int	mRenderCacheTexture;
+	int				mRenderCacheWidth;
+	int				mRenderCacheHeight;
+
+	static int		sRenderCacheCount;
 };
 
 #endif // ES_CORE_GUI_COMPONENT_H
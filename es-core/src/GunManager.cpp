@@ -13,6 +13,9 @@
 
 #ifdef HAVE_UDEV
 #include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <linux/input.h>
@@ -114,6 +117,23 @@ public:
 GunManager::GunManager()
 {
 #ifdef HAVE_UDEV
+	udev_monitor = NULL;
+	mReaderThread = nullptr;
+	mReaderExit = false;
+	mGunsChanged = false;
+	mHotplugPending = false;
+
+	mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+	mWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if (mEpollFd >= 0 && mWakeFd >= 0)
+	{
+		epoll_event ev = { };
+		ev.events = EPOLLIN;
+		ev.data.fd = mWakeFd;
+		epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mWakeFd, &ev);
+	}
+
 	udev = udev_new();
 	if (udev != NULL)
 	{
@@ -122,15 +142,34 @@ GunManager::GunManager()
 		{
 			udev_monitor_filter_add_match_subsystem_devtype(udev_monitor, "input", NULL);
 			udev_monitor_enable_receiving(udev_monitor);
+			watchHotplug();
 		}
 	}
 	udev_initial_gunsList();
+
+	if (mEpollFd >= 0 && mWakeFd >= 0)
+		mReaderThread = new std::thread(&GunManager::readerThread, this);
+	else
+		LOG(LogError) << "GunManager : Unable to create the epoll set, guns are disabled";
 #endif
 }
 
 GunManager::~GunManager()
 {
 #ifdef HAVE_UDEV
+	if (mReaderThread != nullptr)
+	{
+		mReaderExit = true;
+
+		uint64_t one = 1;
+		if (write(mWakeFd, &one, sizeof(one)) < 0)
+			LOG(LogError) << "GunManager : Unable to wake the reader thread";
+
+		mReaderThread->join();
+		delete mReaderThread;
+		mReaderThread = nullptr;
+	}
+
 	if (udev != NULL)
 	{
 		// close guns
@@ -147,6 +186,12 @@ GunManager::~GunManager()
 		
 		udev_unref(udev);
 	}
+
+	if (mWakeFd >= 0)
+		close(mWakeFd);
+
+	if (mEpollFd >= 0)
+		close(mEpollFd);
 #elif WIN32
 	enableRawInputCapture(false);
 #endif
@@ -155,57 +200,165 @@ GunManager::~GunManager()
 int GunManager::readGunEvents(Gun* gun)
 {
 #ifdef HAVE_UDEV
+	std::unique_lock<std::mutex> lock(mGunStatesLock);
+
+	auto it = mGunStates.find(gun->fd);
+	if (it == mGunStates.cend())
+		return 0;
+
+	// The position is applied by updateGunPosition
+	float x = gun->mX;
+	float y = gun->mY;
+	*(GunData*)gun = it->second.data;
+	gun->mX = x;
+	gun->mY = y;
+
+	int calibration = it->second.calibration;
+	it->second.calibration = 0;
+	return calibration;
+#endif
+
+	return 0;
+}
+
+#ifdef HAVE_UDEV
+// Reader thread, mGunStatesLock held
+bool GunManager::readGunState(int fd, GunEventState& state)
+{
 	int len;
 	struct input_event input_events[64];
 
-	while ((len = read(gun->fd, input_events, sizeof(input_events))) > 0) {
+	bool changed = false;
+
+	while ((len = read(fd, input_events, sizeof(input_events))) > 0) {
 	  for (unsigned i = 0; i<len/sizeof(input_event); i++) {
-			if (input_events[i].type == EV_KEY) {
+			if (input_events[i].type == EV_ABS) {
+				if (input_events[i].code == ABS_X && state.maxX != state.minX) {
+					state.data.mX = ((float)(input_events[i].value - state.minX)) / ((float)(state.maxX - state.minX));
+					changed = true;
+				}
+				else if (input_events[i].code == ABS_Y && state.maxY != state.minY) {
+					state.data.mY = ((float)(input_events[i].value - state.minY)) / ((float)(state.maxY - state.minY));
+					changed = true;
+				}
+			}
+			else if (input_events[i].type == EV_KEY) {
 				//printf("key, code=%i, value=%i\n", input_events[i].code, input_events[i].value);
+				bool down = (input_events[i].value != 0);
+				changed = true;
+
 				switch (input_events[i].code) {
 				case KEY_CONFIG:
-					if (input_events[i].value == 1) {
-						// starting calibration
-						return 1;
-					}
-					else {
-						// stopping calibration
-						return 2;
-					}
+					// starting / stopping calibration
+					state.calibration = (input_events[i].value == 1) ? 1 : 2;
 					break;
 				case BTN_LEFT:
-					gun->mLButtonDown = (input_events[i].value != 0);
+					state.data.mLButtonDown = down;
 					break;
 				case BTN_RIGHT:
-					gun->mRButtonDown = (input_events[i].value != 0);
+					state.data.mRButtonDown = down;
 					break;
 				case BTN_MIDDLE:
-					gun->mStartButtonDown = (input_events[i].value != 0);
+					state.data.mStartButtonDown = down;
 					break;
 				case BTN_1:
-					gun->mSelectButtonDown = (input_events[i].value != 0);
+					state.data.mSelectButtonDown = down;
 					break;
 				case BTN_5:
-					gun->mDPadUpButtonDown = (input_events[i].value != 0);
+					state.data.mDPadUpButtonDown = down;
 					break;
 				case BTN_6:
-					gun->mDPadDownButtonDown = (input_events[i].value != 0);
+					state.data.mDPadDownButtonDown = down;
 					break;
 				case BTN_7:
-					gun->mDPadLeftButtonDown = (input_events[i].value != 0);
+					state.data.mDPadLeftButtonDown = down;
 					break;
 				case BTN_8:
-					gun->mDPadRightButtonDown = (input_events[i].value != 0);
+					state.data.mDPadRightButtonDown = down;
 					break;
 				}
 			}
 		}
 	}
-#endif
 
-	return 0;
+	return changed;
 }
 
+void GunManager::readerThread()
+{
+	epoll_event events[16];
+
+	int hotplugFd = udev_monitor ? udev_monitor_get_fd(udev_monitor) : -1;
+
+	while (!mReaderExit)
+	{
+		int count = epoll_wait(mEpollFd, events, 16, -1);
+		if (count < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			LOG(LogError) << "GunManager : epoll_wait failed, guns are no longer read";
+			break;
+		}
+
+		bool changed = false;
+
+		for (int i = 0; i < count; i++)
+		{
+			int fd = events[i].data.fd;
+
+			if (fd == mWakeFd)
+			{
+				uint64_t value;
+				if (read(mWakeFd, &value, sizeof(value)) < 0)
+					continue;
+			}
+			else if (fd == hotplugFd)
+			{
+				// One shot : updateGuns receives the devices on the main thread, then watches again
+				mHotplugPending = true;
+				changed = true;
+			}
+			else
+			{
+				std::unique_lock<std::mutex> lock(mGunStatesLock);
+
+				auto it = mGunStates.find(fd);
+				if (it == mGunStates.end())
+					continue;
+
+				if (readGunState(fd, it->second))
+					changed = true;
+
+				// Unplugged : stop watching until udev reports the removal, or it would wake up in a loop
+				if (events[i].events & (EPOLLERR | EPOLLHUP))
+					epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, nullptr);
+			}
+		}
+
+		if (changed)
+		{
+			mGunsChanged = true;
+			Window::invalidate();
+		}
+	}
+}
+
+void GunManager::watchHotplug()
+{
+	if (mEpollFd < 0 || udev_monitor == NULL)
+		return;
+
+	epoll_event ev = { };
+	ev.events = EPOLLIN | EPOLLONESHOT;
+	ev.data.fd = udev_monitor_get_fd(udev_monitor);
+
+	if (epoll_ctl(mEpollFd, EPOLL_CTL_MOD, ev.data.fd, &ev) < 0)
+		epoll_ctl(mEpollFd, EPOLL_CTL_ADD, ev.data.fd, &ev);
+}
+#endif
+
 class Stabilizer
 {
 public:
@@ -456,7 +609,9 @@ void GunManager::updateGuns(Window* window)
 	bool bGunborder;
 	const char* action;
 
-	while (udev_monitor && udev_input_poll_hotplug_available(udev_monitor)) 
+	bool hotplug = mHotplugPending.exchange(false);
+
+	while (hotplug && udev_monitor && udev_input_poll_hotplug_available(udev_monitor)) 
 	{
 		struct udev_device *dev = udev_monitor_receive_device(udev_monitor);
 		bool dev_handled = false;
@@ -490,6 +645,13 @@ void GunManager::updateGuns(Window* window)
 				udev_device_unref(dev); // not handled, clean it
 		}
 	}
+
+	if (hotplug)
+		watchHotplug();
+
+	// Nothing read since the last frame : the guns are idle
+	if (!mGunsChanged.exchange(false))
+		return;
 #elif WIN32
 
 	static int updateGunCheck = 0;
@@ -745,18 +907,14 @@ bool GunManager::isReplacingMouse()
 bool GunManager::updateGunPosition(Gun* gun) 
 {
 #ifdef HAVE_UDEV
-	struct input_absinfo absinfo;
+	std::unique_lock<std::mutex> lock(mGunStatesLock);
 
-	if (ioctl(gun->fd, EVIOCGABS(ABS_X), &absinfo) == -1) 
+	auto it = mGunStates.find(gun->fd);
+	if (it == mGunStates.cend())
 		return false;
 
-	gun->mX = ((float)(absinfo.value - absinfo.minimum)) / ((float)(absinfo.maximum - absinfo.minimum));
-
-	if (ioctl(gun->fd, EVIOCGABS(ABS_Y), &absinfo) == -1) 
-		return false;
-
-	gun->mY = ((float)(absinfo.value - absinfo.minimum)) / ((float)(absinfo.maximum - absinfo.minimum));
-
+	gun->mX = it->second.data.mX;
+	gun->mY = it->second.data.mY;
 	return true;
 #else
 	if (gun->mName == WIIMOTE_GUN)
@@ -862,6 +1020,39 @@ bool GunManager::udev_addGun(struct udev_device *dev, Window* window, bool needG
 	newgun->fd = fd;
 	newgun->mNeedBorders = needGunBorder;
 
+	// The ranges, and the position until the gun moves
+	GunEventState state;
+	struct input_absinfo absinfo;
+
+	if (ioctl(fd, EVIOCGABS(ABS_X), &absinfo) != -1 && absinfo.maximum != absinfo.minimum)
+	{
+		state.minX = absinfo.minimum;
+		state.maxX = absinfo.maximum;
+		state.data.mX = ((float)(absinfo.value - absinfo.minimum)) / ((float)(absinfo.maximum - absinfo.minimum));
+	}
+
+	if (ioctl(fd, EVIOCGABS(ABS_Y), &absinfo) != -1 && absinfo.maximum != absinfo.minimum)
+	{
+		state.minY = absinfo.minimum;
+		state.maxY = absinfo.maximum;
+		state.data.mY = ((float)(absinfo.value - absinfo.minimum)) / ((float)(absinfo.maximum - absinfo.minimum));
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(mGunStatesLock);
+		mGunStates[fd] = state;
+
+		if (mEpollFd >= 0)
+		{
+			epoll_event ev = { };
+			ev.events = EPOLLIN;
+			ev.data.fd = fd;
+			epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &ev);
+		}
+	}
+
+	mGunsChanged = true;
+
 	if (!newgun->mName.empty() && window != NULL)
 		window->displayNotificationMessage(_U("\uF05B ") + Utils::String::format(_("%s connected").c_str(), Utils::String::trim(newgun->mName).c_str()));
 
@@ -871,6 +1062,15 @@ bool GunManager::udev_addGun(struct udev_device *dev, Window* window, bool needG
 }
 
 void GunManager::udev_closeGun(Gun* gun) {
+  {
+    std::unique_lock<std::mutex> lock(mGunStatesLock);
+
+    if (mEpollFd >= 0)
+      epoll_ctl(mEpollFd, EPOLL_CTL_DEL, gun->fd, nullptr);
+
+    mGunStates.erase(gun->fd);
+  }
+
   close(gun->fd);
   udev_device_unref(gun->dev);
 }
@@ -8,6 +8,10 @@
 
 #ifdef HAVE_UDEV
 #include <libudev.h>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
 #elif WIN32
 #include <SDL.h>
 #include <Windows.h>
@@ -139,6 +143,31 @@ private:
   struct udev *udev;
   struct udev_monitor *udev_monitor;
 
+	// The evdev devices are read by a thread sleeping in epoll : it keeps the latest state of each gun,
+	// updateGuns applies it once per frame when something changed, and does nothing while the guns are idle
+	struct GunEventState
+	{
+		GunEventState() : minX(0), maxX(1), minY(0), maxY(1), calibration(0) { }
+
+		GunData data;
+		int minX, maxX, minY, maxY;
+		int calibration; // 1 starting, 2 stopping, 0 nothing new
+	};
+
+	std::map<int, GunEventState> mGunStates; // By fd
+	std::mutex mGunStatesLock;
+
+	int mEpollFd;
+	int mWakeFd;
+	std::thread* mReaderThread;
+	std::atomic<bool> mReaderExit;
+	std::atomic<bool> mGunsChanged;
+	std::atomic<bool> mHotplugPending;
+
+	void readerThread();
+	bool readGunState(int fd, GunEventState& state);
+	void watchHotplug();
+
   static bool udev_input_poll_hotplug_available(struct udev_monitor *dev);
   void udev_initial_gunsList();
   bool udev_addGun(struct udev_device *dev, Window* window, bool needGunBorder);
@@ -0,0 +1,257 @@
+#include "HttpDownload.h"
+
+#include "HttpReq.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/md5.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#define PART_MIN_SIZE	(4LL * 1024 * 1024)	// Smaller files are downloaded in one request
+#define MAX_PARTS		4
+#define PART_RETRIES	3	// Per part, each one continues the previous attempt
+#define JOIN_BUFFER_SIZE	(1024 * 1024)
+
+// The total size of the content & its validator, when the server accepts ranges
+bool HttpDownload::probe(const std::string& url, int64_t& total, std::string& validator)
+{
+	HttpReqOptions options;
+	options.rangeStart = 0;
+	options.rangeEnd = 0;
+
+	HttpReq request(url, &options);
+	if (!request.wait())
+		return false;
+
+	// bytes 0-0/123456
+	std::string range = request.getResponseHeader("Content-Range");
+	auto slash = range.find('/');
+	if (!Utils::String::startsWith(range, "bytes") || slash == std::string::npos)
+		return false;
+
+	total = atoll(range.substr(slash + 1).c_str());
+
+	validator = request.getResponseHeader("ETag");
+	if (validator.empty() || Utils::String::startsWith(validator, "W/"))
+		validator = request.getResponseHeader("Last-Modified");
+
+	return total > 0;
+}
+
+bool HttpDownload::download(const std::string& url, const std::string& fileName, const std::function<void(int64_t position, int64_t total)>& progress)
+{
+	int64_t total = -1;
+	std::string validator;
+
+	if (!probe(url, total, validator) || total < PART_MIN_SIZE * 2)
+		return downloadSingle(url, fileName, total, progress);
+
+	int count = (int)std::min<int64_t>(MAX_PARTS, total / PART_MIN_SIZE);
+	int64_t partSize = total / count;
+
+	// Named by the total size : the parts of another version are not continued
+	std::vector<Part> parts;
+	for (int i = 0; i < count; i++)
+	{
+		Part part;
+		part.start = i * partSize;
+		part.end = i == count - 1 ? total - 1 : part.start + partSize - 1;
+		part.path = fileName + ".part" + std::to_string(i) + "-" + std::to_string(total);
+		parts.push_back(part);
+	}
+
+	LOG(LogDebug) << "HttpDownload : " << url << " in " << count << " parts";
+
+	if (!downloadParts(url, parts, validator, total, progress))
+		return false;
+
+	return joinParts(parts, fileName, validator);
+}
+
+bool HttpDownload::downloadSingle(const std::string& url, const std::string& fileName, int64_t total, const std::function<void(int64_t position, int64_t total)>& progress)
+{
+	HttpReq request(url, fileName);
+
+	while (request.status() == HttpReq::REQ_IN_PROGRESS)
+	{
+		if (progress != nullptr)
+		{
+			int64_t position = request.getPosition();
+
+			// From the content length
+			int64_t size = total;
+			if (size <= 0 && request.getPercent() > 0)
+				size = position * 100LL / request.getPercent();
+
+			progress(position, size);
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+
+	return request.status() == HttpReq::REQ_SUCCESS;
+}
+
+bool HttpDownload::downloadParts(const std::string& url, const std::vector<Part>& parts, const std::string& validator, int64_t total, const std::function<void(int64_t position, int64_t total)>& progress)
+{
+	int count = (int)parts.size();
+
+	std::vector<std::unique_ptr<HttpReq>> requests(count);
+	std::vector<int> attempts(count, 0);
+	std::vector<bool> done(count, false);
+
+	auto start = [&](int index)
+	{
+		auto& part = parts[index];
+
+		// Completed by a previous download
+		if (Utils::FileSystem::exists(part.path) && (int64_t)Utils::FileSystem::getFileSize(part.path) == part.length())
+		{
+			done[index] = true;
+			return;
+		}
+
+		HttpReqOptions options(part.path);
+		options.rangeStart = part.start;
+		options.rangeEnd = part.end;
+		options.resume = true;
+		options.ownConnection = true;
+
+		// The whole content comes back if it changed since the probe : the size check drops it
+		if (!validator.empty())
+			options.customHeaders.push_back("If-Range: " + validator);
+
+		attempts[index]++;
+		requests[index] = std::unique_ptr<HttpReq>(new HttpReq(url, &options));
+	};
+
+	for (int i = 0; i < count; i++)
+		start(i);
+
+	while (true)
+	{
+		int64_t position = 0;
+		bool running = false;
+
+		for (int i = 0; i < count; i++)
+		{
+			if (done[i])
+			{
+				position += parts[i].length();
+				continue;
+			}
+
+			auto status = requests[i]->status();
+			if (status == HttpReq::REQ_IN_PROGRESS)
+			{
+				running = true;
+				position += std::max<int64_t>(0, requests[i]->getPosition());
+				continue;
+			}
+
+			requests[i].reset();
+
+			if (status == HttpReq::REQ_SUCCESS && (int64_t)Utils::FileSystem::getFileSize(parts[i].path) == parts[i].length())
+			{
+				done[i] = true;
+				position += parts[i].length();
+				continue;
+			}
+
+			if (status == HttpReq::REQ_SUCCESS)
+			{
+				LOG(LogError) << "HttpDownload : unexpected size for " << parts[i].path;
+				Utils::FileSystem::removeFile(parts[i].path);
+			}
+
+			// The other parts keep what they received, for the next attempt
+			if (attempts[i] >= PART_RETRIES)
+			{
+				LOG(LogError) << "HttpDownload : " << url << " failed";
+				return false;
+			}
+
+			start(i);
+			running = true;
+		}
+
+		if (progress != nullptr)
+			progress(position, total);
+
+		if (!running)
+			break;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+
+	return true;
+}
+
+// Joined in order, & hashed on the way when the server gave the md5
+bool HttpDownload::joinParts(const std::vector<Part>& parts, const std::string& fileName, const std::string& validator)
+{
+	std::string md5 = Utils::String::toLower(Utils::String::replace(validator, "\"", ""));
+	bool checkMd5 = md5.size() == 32 && md5.find_first_not_of("0123456789abcdef") == std::string::npos;
+
+	MD5 hash;
+
+	std::string tempFile = fileName + ".tmp";
+	std::ofstream output(WINSTRINGW(tempFile), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!output.is_open())
+		return false;
+
+	std::vector<char> buffer(JOIN_BUFFER_SIZE);
+
+	for (auto& part : parts)
+	{
+		std::ifstream input(WINSTRINGW(part.path), std::ios::in | std::ios::binary);
+		if (!input.is_open())
+		{
+			output.close();
+			Utils::FileSystem::removeFile(tempFile);
+			return false;
+		}
+
+		while (input)
+		{
+			input.read(buffer.data(), buffer.size());
+
+			auto read = input.gcount();
+			if (read <= 0)
+				break;
+
+			output.write(buffer.data(), read);
+
+			if (checkMd5)
+				hash.update(buffer.data(), (MD5::size_type)read);
+		}
+	}
+
+	output.close();
+
+	bool valid = !output.fail();
+	if (valid && checkMd5 && hash.finalize().hexdigest() != md5)
+	{
+		LOG(LogError) << "HttpDownload : md5 mismatch for " << fileName;
+		valid = false;
+	}
+
+	// A corrupted part can't be told from the others
+	for (auto& part : parts)
+		if (valid || checkMd5)
+			Utils::FileSystem::removeFile(part.path);
+
+	if (!valid)
+	{
+		Utils::FileSystem::removeFile(tempFile);
+		return false;
+	}
+
+	Utils::FileSystem::removeFile(fileName);
+	return Utils::FileSystem::renameFile(tempFile, fileName) || Utils::FileSystem::copyFile(tempFile, fileName);
+}
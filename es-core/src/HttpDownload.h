@@ -0,0 +1,37 @@
+#pragma once
+#ifndef ES_CORE_HTTP_DOWNLOAD_H
+#define ES_CORE_HTTP_DOWNLOAD_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Downloads the large files in parallel byte ranges, each on its own connection : a single stream is bound by the latency of the link.
+// The parts of an interrupted download stay next to the file, and are continued by the next attempt on the same url & size.
+// When the ETag of the server is a plain md5 ( static & S3 servers ), the parts are checked against it as they are joined.
+// Servers without ranges and the small files get a single request
+class HttpDownload
+{
+public:
+	// Blocking. progress receives the bytes received & the total size, -1 when unknown
+	static bool download(const std::string& url, const std::string& fileName, const std::function<void(int64_t position, int64_t total)>& progress = nullptr);
+
+private:
+	struct Part
+	{
+		int64_t start;
+		int64_t end; // inclusive
+		std::string path;
+
+		int64_t length() const { return end - start + 1; }
+	};
+
+	static bool probe(const std::string& url, int64_t& total, std::string& validator);
+
+	static bool downloadSingle(const std::string& url, const std::string& fileName, int64_t total, const std::function<void(int64_t position, int64_t total)>& progress);
+	static bool downloadParts(const std::string& url, const std::vector<Part>& parts, const std::string& validator, int64_t total, const std::function<void(int64_t position, int64_t total)>& progress);
+	static bool joinParts(const std::vector<Part>& parts, const std::string& fileName, const std::string& validator);
+};
+
+#endif // ES_CORE_HTTP_DOWNLOAD_H
@@ -5,6 +5,7 @@
 #include "Log.h"
 #include <assert.h>
 #include <thread>
+#include <chrono>
 
 #include <SDL.h>
 
@@ -17,9 +18,147 @@
 #include <mutex>
 static std::mutex mMutex;
 
-CURLM* HttpReq::s_multi_handle = curl_multi_init();
+#define MAX_POOLED_HANDLES 8
+
+// Matches curl's default DNS cache timeout
+#define PRECONNECT_DELAY_SECONDS 60
+
+static std::mutex mShareLocks[CURL_LOCK_DATA_LAST];
+
+CURLM* HttpReq::s_multi_handle = HttpReq::createMultiHandle();
+CURLSH* HttpReq::s_share_handle = HttpReq::createShareHandle();
 
 std::map<CURL*, HttpReq*> HttpReq::s_requests;
+std::vector<CURL*> HttpReq::s_handles_pool;
+
+static std::map<std::string, std::chrono::steady_clock::time_point> s_preconnected;
+
+CURLM* HttpReq::createMultiHandle()
+{
+	CURLM* multi = curl_multi_init();
+	if (multi == nullptr)
+		return nullptr;
+
+	// Concurrent requests to the same host ( scrapers ) share one HTTP/2 connection instead of opening new ones
+	curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+	return multi;
+}
+
+CURLSH* HttpReq::createShareHandle()
+{
+	CURLSH* share = curl_share_init();
+	if (share == nullptr)
+		return nullptr;
+
+	curl_share_setopt(share, CURLSHOPT_LOCKFUNC, (curl_lock_function) [](CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr) { mShareLocks[data].lock(); });
+	curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, (curl_unlock_function) [](CURL* handle, curl_lock_data data, void* userptr) { mShareLocks[data].unlock(); });
+
+	// Saves the DNS lookups & TLS handshakes of the small API calls
+	curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+	curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+	return share;
+}
+
+// Reset handles keep their live connections & caches : the next request to the same host reuses them
+CURL* HttpReq::acquireHandle()
+{
+	CURL* handle = nullptr;
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (!s_handles_pool.empty())
+		{
+			handle = s_handles_pool.back();
+			s_handles_pool.pop_back();
+		}
+	}
+
+	if (handle == nullptr)
+		handle = curl_easy_init();
+
+	if (handle != nullptr && s_share_handle != nullptr)
+		curl_easy_setopt(handle, CURLOPT_SHARE, s_share_handle);
+
+	return handle;
+}
+
+// mMutex must be locked
+void HttpReq::releaseHandle(CURL* handle)
+{
+	if (s_handles_pool.size() >= MAX_POOLED_HANDLES)
+	{
+		curl_easy_cleanup(handle);
+		return;
+	}
+
+	curl_easy_reset(handle);
+	s_handles_pool.push_back(handle);
+}
+
+void HttpReq::preconnect(const std::vector<std::string>& urls)
+{
+	std::vector<std::string> hosts;
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		auto now = std::chrono::steady_clock::now();
+
+		for (auto url : urls)
+		{
+			// scheme://host[:port]
+			auto start = url.find("://");
+			if (start == std::string::npos)
+				continue;
+
+			auto end = url.find('/', start + 3);
+			std::string hostUrl = Utils::String::toLower(end == std::string::npos ? url : url.substr(0, end)) + "/";
+
+			auto it = s_preconnected.find(hostUrl);
+			if (it != s_preconnected.cend() && now - it->second < std::chrono::seconds(PRECONNECT_DELAY_SECONDS))
+				continue;
+
+			s_preconnected[hostUrl] = now;
+			hosts.push_back(hostUrl);
+		}
+	}
+
+	if (hosts.empty())
+		return;
+
+	std::thread([hosts]
+	{
+		for (auto hostUrl : hosts)
+			preconnectHost(hostUrl);
+	}).detach();
+}
+
+// A HEAD on the root of the host : the lookup, the TLS session & the live connection land in the share handle
+void HttpReq::preconnectHost(const std::string& hostUrl)
+{
+	CURL* handle = acquireHandle();
+	if (handle == nullptr)
+		return;
+
+	curl_easy_setopt(handle, CURLOPT_URL, hostUrl.c_str());
+	curl_easy_setopt(handle, CURLOPT_NOBODY, 1L);
+	curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
+	curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+	curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+	curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, 5L);
+	curl_easy_setopt(handle, CURLOPT_TIMEOUT, 10L);
+
+	CURLcode err = curl_easy_perform(handle);
+	if (err != CURLE_OK)
+		LOG(LogDebug) << "HttpReq::preconnect " << hostUrl << " failed : " << curl_easy_strerror(err);
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	releaseHandle(handle);
+}
 
 std::string HttpReq::urlEncode(const std::string &s)
 {
@@ -93,7 +232,7 @@ static std::string _regGetString(HKEY hKey, const std::string &strPath, const st
 #endif
 
 HttpReq::HttpReq(const std::string& url, const std::string& outputFilename) 
-	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mFile(NULL)
+	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mHeaders(NULL), mFile(NULL), mKeepTempStream(false)
 {
 	HttpReqOptions options;
 	options.outputFilename = outputFilename;	
@@ -101,11 +240,25 @@ HttpReq::HttpReq(const std::string& url, const std::string& outputFilename)
 }
 
 HttpReq::HttpReq(const std::string& url, HttpReqOptions* options)
-	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mFile(NULL)
+	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mHeaders(NULL), mFile(NULL), mKeepTempStream(false)
 {
 	performRequest(url, options);
 }
 
+HttpReq::HttpReq()
+	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mHeaders(NULL), mFile(NULL), mKeepTempStream(false), mPercent(-1), mPosition(-1)
+{
+}
+
+HttpReq* HttpReq::fromContent(const std::string& url, const std::string& content)
+{
+	HttpReq* req = new HttpReq();
+	req->mUrl = url;
+	req->mContent << content;
+	req->mStatus = REQ_SUCCESS;
+	return req;
+}
+
 void HttpReq::performRequest(const std::string& url, HttpReqOptions* options)
 {
 	mUrl = url;
@@ -118,7 +271,7 @@ void HttpReq::performRequest(const std::string& url, HttpReqOptions* options)
 	mFilePath = outputFilename;
 	mPosition = -1;
 	mPercent = -1;	
-	mHandle = curl_easy_init();
+	mHandle = acquireHandle();
 
 	if(mHandle == NULL)
 	{
@@ -143,14 +296,15 @@ void HttpReq::performRequest(const std::string& url, HttpReqOptions* options)
 		curl_easy_setopt(mHandle, CURLOPT_COPYPOSTFIELDS, options->dataToPost.c_str());
 	}
 
+	if (options != nullptr && options->maxRecvSpeed > 0)
+		curl_easy_setopt(mHandle, CURLOPT_MAX_RECV_SPEED_LARGE, (curl_off_t)options->maxRecvSpeed);
+
 	if (options != nullptr && options->customHeaders.size() > 0)
 	{
-		struct curl_slist *hs = nullptr;
-
 		for (auto header : options->customHeaders)
-			hs = curl_slist_append(hs, header.c_str());
+			mHeaders = curl_slist_append(mHeaders, header.c_str());
 
-		curl_easy_setopt(mHandle, CURLOPT_HTTPHEADER, hs);
+		curl_easy_setopt(mHandle, CURLOPT_HTTPHEADER, mHeaders);
 	}
 	/*
 	struct curl_slist *hs = NULL;
@@ -174,6 +328,17 @@ void HttpReq::performRequest(const std::string& url, HttpReqOptions* options)
 	// Ignore expired SSL certificates
 	curl_easy_setopt(mHandle, CURLOPT_SSL_VERIFYPEER, 0L);
 
+	if (options != nullptr && options->ownConnection)
+		curl_easy_setopt(mHandle, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_1_1);
+	else
+	{
+		// HTTP/2 over TLS when the server has it, and wait for a multiplexed stream rather than opening a connection
+		curl_easy_setopt(mHandle, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+		curl_easy_setopt(mHandle, CURLOPT_PIPEWAIT, 1L);
+	}
+
+	curl_easy_setopt(mHandle, CURLOPT_TCP_KEEPALIVE, 1L);
+
 	//set curl to handle redirects
 	err = curl_easy_setopt(mHandle, CURLOPT_CONNECTTIMEOUT, 10L);
 	if (err != CURLE_OK)
@@ -259,18 +424,27 @@ void HttpReq::performRequest(const std::string& url, HttpReqOptions* options)
 	}
 #endif
 	
+	long long rangeStart = options != nullptr ? options->rangeStart : -1;
+	long long rangeEnd = options != nullptr ? options->rangeEnd : -1;
+
 	std::unique_lock<std::mutex> lock(mMutex);
 
+	int64_t resumed = 0;
+
 	if (!mFilePath.empty())
 	{
 		mTempStreamPath = outputFilename + ".tmp";
+		mKeepTempStream = options != nullptr && options->resume && rangeStart >= 0;
 		
-		Utils::FileSystem::removeFile(mTempStreamPath);
+		if (mKeepTempStream)
+			resumed = Utils::FileSystem::getFileSize(mTempStreamPath);
+		else
+			Utils::FileSystem::removeFile(mTempStreamPath);
 
 #if defined(_WIN32)
-		mFile = _wfopen(Utils::String::convertToWideString(mTempStreamPath).c_str(), L"wb");
+		mFile = _wfopen(Utils::String::convertToWideString(mTempStreamPath).c_str(), resumed > 0 ? L"ab" : L"wb");
 #else
-		mFile = fopen(mTempStreamPath.c_str(), "wb");		
+		mFile = fopen(mTempStreamPath.c_str(), resumed > 0 ? "ab" : "wb");		
 #endif
 
 		if (mFile == nullptr)
@@ -280,10 +454,17 @@ void HttpReq::performRequest(const std::string& url, HttpReqOptions* options)
 			return;
 		}
 
-		mPosition = 0;
+		mPosition = resumed;
 		Utils::FileSystem::removeFile(outputFilename);
 	}
 
+	// Continues after the bytes of the previous attempts
+	if (rangeStart >= 0)
+	{
+		std::string range = std::to_string(rangeStart + resumed) + "-" + (rangeEnd >= 0 ? std::to_string(rangeEnd) : "");
+		curl_easy_setopt(mHandle, CURLOPT_RANGE, range.c_str());
+	}
+
 	//add the handle to our multi
 	CURLMcode merr = curl_multi_add_handle(s_multi_handle, mHandle);
 	if(merr != CURLM_OK)
@@ -314,7 +495,7 @@ HttpReq::~HttpReq()
 
 	closeStream();
 	
-	if (!mTempStreamPath.empty())
+	if (!mTempStreamPath.empty() && !(mKeepTempStream && mStatus != REQ_SUCCESS))
 		Utils::FileSystem::removeFile(mTempStreamPath);
 
 	if(mHandle)
@@ -324,10 +505,16 @@ HttpReq::~HttpReq()
 		CURLMcode merr = curl_multi_remove_handle(s_multi_handle, mHandle);
 
 		if(merr != CURLM_OK)
+		{
 			LOG(LogError) << "Error removing curl_easy handle from curl_multi: " << curl_multi_strerror(merr);
-
-		curl_easy_cleanup(mHandle);
+			curl_easy_cleanup(mHandle);
+		}
+		else
+			releaseHandle(mHandle);
 	}
+
+	if (mHeaders != nullptr)
+		curl_slist_free_all(mHeaders);
 }
 
 HttpReq::Status HttpReq::status()
@@ -364,6 +551,8 @@ HttpReq::Status HttpReq::status()
 
 				if (req->mStatus == REQ_FILESTREAM_ERROR)
 				{
+					req->mKeepTempStream = false;
+
 					std::string err = "File stream error (disk full ?)";
 					req->onError(err.c_str());
 				}
@@ -372,7 +561,13 @@ HttpReq::Status HttpReq::status()
 					int http_status_code;
 					curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &http_status_code);					
 
+					// The body is not the content : only an interrupted transfer is continued
 					if (http_status_code < 200 || http_status_code > 299)
+						req->mKeepTempStream = false;
+
+					if (http_status_code == 304)
+						req->mStatus = REQ_304_NOTMODIFIED;
+					else if (http_status_code < 200 || http_status_code > 299)
 					{
 						std::string err;
 
@@ -512,6 +707,11 @@ std::string HttpReq::getResponseHeader(const std::string& header)
 	auto it = mResponseHeaders.find(header);
 	if (it != mResponseHeaders.cend())
 		return it->second;
+
+	// HTTP/2 sends the names in lower case
+	for (auto& item : mResponseHeaders)
+		if (Utils::String::compareIgnoreCase(item.first, header) == 0)
+			return item.second;
 		
 	return "";
 }
@@ -30,8 +30,8 @@
 class HttpReqOptions
 {
 public:
-	HttpReqOptions() {}
-	HttpReqOptions(const std::string& filename) 
+	HttpReqOptions() : maxRecvSpeed(0), rangeStart(-1), rangeEnd(-1), resume(false), ownConnection(false) {}
+	HttpReqOptions(const std::string& filename) : maxRecvSpeed(0), rangeStart(-1), rangeEnd(-1), resume(false), ownConnection(false)
 	{
 		outputFilename = filename;
 	}
@@ -39,6 +39,14 @@ public:
 	std::string outputFilename;
 	std::vector<std::string> customHeaders;
 	std::string dataToPost;
+	long long maxRecvSpeed; // bytes per second, 0 for no limit
+
+	long long rangeStart; // bytes, inclusive. -1 for the whole content
+	long long rangeEnd; // -1 for the end of the content
+	// With a range & an output file : the temp file of a failed attempt is kept, and continued by the next one
+	bool resume;
+	// HTTP/1.1 : parallel requests to the host get their own connections, instead of being multiplexed on one
+	bool ownConnection;
 };
 
 class HttpReq
@@ -56,6 +64,7 @@ public:
 		REQ_FILESTREAM_ERROR = 4,		
 
 		REQ_SUCCESS = 200,
+		REQ_304_NOTMODIFIED = 304,
 		REQ_400_BADREQUEST = 400,
 		REQ_401_FORBIDDEN = 401,
 		REQ_403_BADLOGIN = 403,
@@ -87,11 +96,20 @@ public:
 	std::string getUrl() { return mUrl; }
 	std::string getFilePath() { return mFilePath; }	
 	std::map<std::string, std::string>& getResponseHeaders() { return mResponseHeaders; }
-	std::string getResponseHeader(const std::string& header);
+	std::string getResponseHeader(const std::string& header); // Case insensitive
 
 	bool wait();
 
+	// A completed request, for responses that come from a cache
+	static HttpReq* fromContent(const std::string& url, const std::string& content);
+
+	// Warms the DNS cache, TLS sessions & connections of the hosts a screen is about to hit, from a background thread.
+	// Hosts warmed less than a minute ago are skipped
+	static void preconnect(const std::vector<std::string>& urls);
+
 private:
+	HttpReq();
+
 	void performRequest(const std::string& url, HttpReqOptions* options);
 	void closeStream();
 
@@ -106,9 +124,20 @@ private:
 
 	static CURLM* s_multi_handle;
 
+	// DNS cache, TLS sessions & connections shared by all the requests, and the released easy handles kept for reuse
+	static CURLSH* s_share_handle;
+	static std::vector<CURL*> s_handles_pool;
+
+	static CURLM* createMultiHandle();
+	static CURLSH* createShareHandle();
+	static CURL* acquireHandle();
+	static void releaseHandle(CURL* handle);
+	static void preconnectHost(const std::string& hostUrl);
+
 	void onError(const char* msg);
 
 	CURL* mHandle;
+	struct curl_slist* mHeaders;
 
 	Status mStatus;
 
@@ -119,6 +148,7 @@ private:
 	std::string   mFilePath;
 	std::string   mTempStreamPath;	
 	FILE*		  mFile;	
+	bool		  mKeepTempStream; // resume
 
 	std::string mErrorMsg;
 	std::string mUrl;
@@ -5,14 +5,129 @@
 #include <string.h>
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
+#include "utils/MemoryMappedFile.h"
+#include "utils/BinaryStream.h"
 #include <sstream>
 #include <fstream>
-#include <map>
+#include <unordered_map>
 #include <mutex>
+#include <algorithm>
 #include "renderers/Renderer.h"
 #include "Paths.h"
 
-unsigned char* ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height, MaxSizeInfo* maxSize, Vector2i* baseSize, Vector2i* packedSize, int subImageIndex)
+// SSE2 is part of x86-64 and NEON of ARMv8 : the vector kernels are selected at compile time, other targets use the scalar loops
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMAGEIO_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMAGEIO_NEON
+#endif
+
+// FreeImage BGRA -> RGBA
+static void swizzleBGRA(const unsigned int* src, unsigned int* dst, size_t count)
+{
+	size_t x = 0;
+
+#if defined(IMAGEIO_SSE2)
+	const __m128i maskAG = _mm_set1_epi32((int)0xFF00FF00);
+	const __m128i maskRB = _mm_set1_epi32(0x00FF00FF);
+
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i c = _mm_loadu_si128((const __m128i*)(src + x));
+		__m128i rb = _mm_and_si128(c, maskRB);
+		__m128i ret = _mm_or_si128(_mm_and_si128(c, maskAG), _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16)));
+		_mm_storeu_si128((__m128i*)(dst + x), ret);
+	}
+#elif defined(IMAGEIO_NEON)
+	const uint32x4_t maskAG = vdupq_n_u32(0xFF00FF00);
+	const uint32x4_t maskRB = vdupq_n_u32(0x00FF00FF);
+
+	for (; x + 4 <= count; x += 4)
+	{
+		uint32x4_t c = vld1q_u32(src + x);
+		uint32x4_t rb = vandq_u32(c, maskRB);
+		uint32x4_t ret = vorrq_u32(vandq_u32(c, maskAG), vorrq_u32(vshlq_n_u32(rb, 16), vshrq_n_u32(rb, 16)));
+		vst1q_u32(dst + x, ret);
+	}
+#endif
+
+	for (; x < count; x++)
+	{
+		unsigned int c = src[x];
+		dst[x] = (c & 0xFF00FF00) | ((c & 0xFF) << 16) | ((c >> 16) & 0xFF);
+	}
+}
+
+static void swapRows(unsigned char* row0, unsigned char* row1, size_t bytes)
+{
+	size_t i = 0;
+
+#if defined(IMAGEIO_SSE2)
+	for (; i + 16 <= bytes; i += 16)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(row0 + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(row1 + i));
+		_mm_storeu_si128((__m128i*)(row0 + i), b);
+		_mm_storeu_si128((__m128i*)(row1 + i), a);
+	}
+#elif defined(IMAGEIO_NEON)
+	for (; i + 16 <= bytes; i += 16)
+	{
+		uint8x16_t a = vld1q_u8(row0 + i);
+		uint8x16_t b = vld1q_u8(row1 + i);
+		vst1q_u8(row0 + i, b);
+		vst1q_u8(row1 + i, a);
+	}
+#endif
+
+	for (; i < bytes; i++)
+		std::swap(row0[i], row1[i]);
+}
+
+// Averages 2x2 blocks of two rows into 'count' pixels. Returns the number of pixels done, the caller finishes the row
+static size_t halveRows(const unsigned char* row0, const unsigned char* row1, unsigned char* dst, size_t count)
+{
+	size_t x = 0;
+
+#if defined(IMAGEIO_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi16(2);
+
+	// 4 source pixels -> 2 pixels
+	for (; x + 2 <= count; x += 2)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(row0 + x * 8));
+		__m128i b = _mm_loadu_si128((const __m128i*)(row1 + x * 8));
+
+		__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+		__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+		lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+		hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+		__m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), round), 2);
+		_mm_storel_epi64((__m128i*)(dst + x * 4), _mm_packus_epi16(sum, zero));
+	}
+#elif defined(IMAGEIO_NEON)
+	for (; x + 2 <= count; x += 2)
+	{
+		uint8x16_t a = vld1q_u8(row0 + x * 8);
+		uint8x16_t b = vld1q_u8(row1 + x * 8);
+
+		uint16x8_t lo = vaddl_u8(vget_low_u8(a), vget_low_u8(b));
+		uint16x8_t hi = vaddl_u8(vget_high_u8(a), vget_high_u8(b));
+
+		uint16x8_t sum = vcombine_u16(vadd_u16(vget_low_u16(lo), vget_high_u16(lo)), vadd_u16(vget_low_u16(hi), vget_high_u16(hi)));
+		vst1_u8(dst + x * 4, vrshrn_n_u16(sum, 2));
+	}
+#endif
+
+	return x;
+}
+
+PixelBuffer ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height, MaxSizeInfo* maxSize, Vector2i* baseSize, Vector2i* packedSize, int subImageIndex)
 {
 	LOG(LogDebug) << "ImageIO::loadFromMemoryRGBA32";
 
@@ -36,7 +151,15 @@ unsigned char* ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const s
 			FIMULTIBITMAP* fiMultiBitmap = nullptr;
 			FIBITMAP* fiBitmap = nullptr;
 
-			if (subImageIndex < 0)
+			// JPEGs can be decoded at 1/2, 1/4 or 1/8 size ( scaled IDCT ), as long as the result stays larger than the requested size.
+			// With external zoom the target can exceed maxSize, so these are decoded at full size
+			int jpegSize = 0;
+			if (format == FIF_JPEG && subImageIndex < 0 && maxSize != nullptr && maxSize->x() > 0 && maxSize->y() > 0 && !maxSize->externalZoom())
+				jpegSize = (int)std::max(maxSize->x(), maxSize->y());
+
+			if (jpegSize > 0 && jpegSize < 0xFFFF)
+				fiBitmap = FreeImage_LoadFromMemory(format, fiMemory, JPEG_DEFAULT | (jpegSize << 16));
+			else if (subImageIndex < 0)
 				fiBitmap = FreeImage_LoadFromMemory(format, fiMemory);
 			else 
 			{
@@ -51,6 +174,20 @@ unsigned char* ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const s
 				}
 			}
 			
+			// A reduced JPEG decode keeps the size of the file in its metadata
+			Vector2i originalSize(0, 0);
+
+			FITAG* tagWidth = nullptr;
+			FITAG* tagHeight = nullptr;
+			if (jpegSize > 0 && fiBitmap != nullptr &&
+				FreeImage_GetMetadata(FIMD_COMMENTS, fiBitmap, "OriginalJPEGWidth", &tagWidth) && FreeImage_GetMetadata(FIMD_COMMENTS, fiBitmap, "OriginalJPEGHeight", &tagHeight))
+			{
+				int originalWidth = atoi((const char*)FreeImage_GetTagValue(tagWidth));
+				int originalHeight = atoi((const char*)FreeImage_GetTagValue(tagHeight));
+				if (originalWidth > 0 && originalHeight > 0)
+					originalSize = Vector2i(originalWidth, originalHeight);
+			}
+
 			if (fiBitmap != nullptr)
 			{
 				//loaded. convert to 32bit if necessary
@@ -79,7 +216,10 @@ unsigned char* ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const s
 					height = FreeImage_GetHeight(fiBitmap);
 
 					if (baseSize != nullptr)
-						*baseSize = Vector2i(width, height);
+						*baseSize = (originalSize.x() > 0 ? originalSize : Vector2i(width, height));
+
+					if (packedSize != nullptr && originalSize.x() > 0 && (originalSize.x() != width || originalSize.y() != height))
+						*packedSize = Vector2i(width, height);
 
 					if (maxSize != nullptr && maxSize->x() > 0 && maxSize->y() > 0 && (width > maxSize->x() || height > maxSize->y()))
 					{
@@ -113,19 +253,13 @@ unsigned char* ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const s
 						}
 					}
 
-					unsigned char* tempData = new unsigned char[width * height * 4];
-
-					int w = (int)width;
+					PixelBuffer tempData(PixelBufferPool::allocate(width * height * 4));
 
 					for (int y = (int)height; --y >= 0; )
 					{
 						unsigned int* argb = (unsigned int*)FreeImage_GetScanLine(fiBitmap, y);
-						unsigned int* abgr = (unsigned int*)(tempData + (y * width * 4));
-						for (int x = w; --x >= 0;)
-						{
-							unsigned int c = argb[x];
-							abgr[x] = (c & 0xFF00FF00) | ((c & 0xFF) << 16) | ((c >> 16) & 0xFF);
-						}
+						unsigned int* abgr = (unsigned int*)(tempData.get() + (y * width * 4));
+						swizzleBGRA(argb, abgr, width);
 					}
 
 					if (fiMultiBitmap)
@@ -159,17 +293,40 @@ unsigned char* ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const s
 
 void ImageIO::flipPixelsVert(unsigned char* imagePx, const size_t& width, const size_t& height)
 {
-	unsigned int temp;
-	unsigned int* arr = (unsigned int*)imagePx;
-	for(size_t y = 0; y < height / 2; y++)
+	size_t stride = width * 4;
+	for (size_t y = 0; y < height / 2; y++)
+		swapRows(imagePx + y * stride, imagePx + (height - y - 1) * stride, stride);
+}
+
+PixelBuffer ImageIO::halveRGBA32(const unsigned char* imagePx, size_t width, size_t height, size_t& outWidth, size_t& outHeight)
+{
+	outWidth = std::max((size_t)1, width / 2);
+	outHeight = std::max((size_t)1, height / 2);
+
+	PixelBuffer ret(PixelBufferPool::allocate(outWidth * outHeight * 4));
+
+	size_t stride = width * 4;
+
+	for (size_t y = 0; y < outHeight; y++)
 	{
-		for(size_t x = 0; x < width; x++)
+		const unsigned char* row0 = imagePx + std::min(y * 2, height - 1) * stride;
+		const unsigned char* row1 = imagePx + std::min(y * 2 + 1, height - 1) * stride;
+		unsigned char* dst = ret.get() + y * outWidth * 4;
+
+		size_t x = (width >= 2 ? halveRows(row0, row1, dst, outWidth) : 0);
+		dst += x * 4;
+
+		for (; x < outWidth; x++, dst += 4)
 		{
-			temp = arr[x + (y * width)];
-			arr[x + (y * width)] = arr[x + (height * width) - ((y + 1) * width)];
-			arr[x + (height * width) - ((y + 1) * width)] = temp;
+			size_t x0 = std::min(x * 2, width - 1) * 4;
+			size_t x1 = std::min(x * 2 + 1, width - 1) * 4;
+
+			for (int c = 0; c < 4; c++)
+				dst[c] = (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
 		}
 	}
+
+	return ret;
 }
 
 Vector2i ImageIO::adjustPictureSize(Vector2i imageSize, Vector2i maxSize, bool externSize)
@@ -234,13 +391,41 @@ Vector2f ImageIO::getPictureMinSize(Vector2f imageSize, Vector2f maxSize)
 	return Vector2f(cxDIB, cyDIB);
 }
 
+// Image size cache : an open addressing hash table of path hashes, memory mapped at load. Entries found or changed during
+// the session are kept in sizeCache, and saveImageCache writes the changed slots in place. The file is only rebuilt when it
+// has to grow. Like before, entries are not checked against the files, except the content hashes which are checked against the file size
+#define IMAGE_CACHE_MAGIC	0x43495345 // 'ESIC'
+#define IMAGE_CACHE_VERSION	2
+
+struct ImageCacheHeader
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	capacity; // Power of 2
+	uint32_t	count;
+	uint64_t	rootHash; // Paths::getRootPath
+};
+
+struct ImageCacheSlot
+{
+	uint64_t	hash; // 0 : empty
+	int32_t		size; // < 0 : removed
+	int32_t		x;
+	int32_t		y;
+	int32_t		reserved;
+	uint64_t	contentHash; // 0 : not computed
+};
+
 struct CachedFileInfo
 {
-	CachedFileInfo(int sz, int sx, int sy)
+	CachedFileInfo(int sz, int sx, int sy, uint64_t hash = 0)
 	{
 		size = sz;
 		x = sx;
 		y = sy;		
+		contentHash = hash;
+		dirty = false;
+		cachable = false;
 	};
 
 	CachedFileInfo()
@@ -248,74 +433,169 @@ struct CachedFileInfo
 		size = 0;
 		x = 0;
 		y = 0;		
+		contentHash = 0;
+		dirty = false;
+		cachable = false;
 	};
 
-	int size;
+	int size; // -1 : unreadable, -2 : removed
 	int x;
 	int y;	
+	uint64_t contentHash;
+	bool dirty;
+	bool cachable;
 };
 
-static std::map<std::string, CachedFileInfo> sizeCache;
+static std::mutex sizeCacheLock;
+static std::unordered_map<uint64_t, CachedFileInfo> sizeCache;
 static bool sizeCacheDirty = false;
 
+static Utils::MemoryMappedFile sizeCacheFile;
+static const ImageCacheSlot* sizeCacheSlots = nullptr;
+static uint32_t sizeCacheCapacity = 0;
+static uint32_t sizeCacheCount = 0;
+
+// Read only fallback ( fleet catalog ) : the mapped file is never written, saveImageCache rebuilds the local one instead
+static std::string sizeCacheSharedFilename;
+static bool sizeCacheShared = false;
+
 std::string getImageCacheFilename()
 {
-	return Paths::getUserEmulationStationPath() + "/imagecache.db";
+	return Paths::getUserEmulationStationPath() + "/imagecache.bin";
 }
 
-void ImageIO::clearImageCache()
+static uint64_t getPathHash(const std::string& path)
 {
-	std::string fname = getImageCacheFilename();
-	Utils::FileSystem::removeFile(fname);
-	sizeCache.clear();
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ULL;
+	for (unsigned char c : path)
+	{
+		hash ^= c;
+		hash *= 1099511628211ULL;
+	}
+
+	return hash == 0 ? 1 : hash;
 }
 
-void ImageIO::loadImageCache()
+// FNV-1a of the bytes, seeded with the size. Two files with the same value are taken as identical
+ImageContentHash::ImageContentHash(size_t size)
 {
-	std::string fname = getImageCacheFilename();
+	mHash = 14695981039346656037ULL ^ (uint64_t)size;
+}
 
-	std::ifstream f(fname.c_str());
-	if (f.fail())
-		return;
+void ImageContentHash::update(const unsigned char* data, size_t size)
+{
+	uint64_t hash = mHash;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= data[i];
+		hash *= 1099511628211ULL;
+	}
 
-	sizeCache.clear();
+	mHash = hash;
+}
 
-	std::string relativeTo = Paths::getRootPath();
+static uint64_t getContentHash(const unsigned char* data, size_t size)
+{
+	ImageContentHash hash(size);
+	hash.update(data, size);
+	return hash.get();
+}
 
-	std::vector<std::string> splits;
+// Slot of the hash in the mapped table, or the empty slot where it would go. -1 if the table is full or not loaded
+static int findSlot(const ImageCacheSlot* slots, uint32_t capacity, uint64_t hash)
+{
+	if (slots == nullptr || capacity == 0)
+		return -1;
 
-	std::string line;
-	while (std::getline(f, line))
-	{
-		splits.clear();
+	uint32_t mask = capacity - 1;
+	uint32_t index = (uint32_t)hash & mask;
 
-		const char* src = line.c_str();
+	for (uint32_t i = 0; i < capacity; i++, index = (index + 1) & mask)
+		if (slots[index].hash == hash || slots[index].hash == 0)
+			return (int)index;
 
-		while (true)
-		{
-			const char* d = strchr(src, '|');
-			size_t len = (d) ? d - src : strlen(src);
+	return -1;
+}
 
-			if (len)
-				splits.push_back(std::string(src, len)); // capture token
+static void closeImageCacheFile()
+{
+	sizeCacheFile.close();
+	sizeCacheSlots = nullptr;
+	sizeCacheCapacity = 0;
+	sizeCacheCount = 0;
+	sizeCacheShared = false;
+}
 
-			if (d) src += len + 1; else break;
-		}
+static bool openImageCacheFile(const std::string& fname)
+{
+	closeImageCacheFile();
 
-		if (splits.size() == 4)
-		{
-			std::string file = Utils::FileSystem::resolveRelativePath(splits[0], relativeTo, true);
+	if (!sizeCacheFile.open(fname))
+		return false;
 
-			CachedFileInfo fi;
-			fi.size = Utils::String::toInteger(splits[1]);
-			fi.x = Utils::String::toInteger(splits[2]);
-			fi.y = Utils::String::toInteger(splits[3]);
+	if (sizeCacheFile.size() < sizeof(ImageCacheHeader))
+	{
+		sizeCacheFile.close();
+		return false;
+	}
 
-			sizeCache[file] = fi;
-		}
+	ImageCacheHeader header;
+	memcpy(&header, sizeCacheFile.data(), sizeof(header));
+
+	if (header.magic != IMAGE_CACHE_MAGIC || header.version != IMAGE_CACHE_VERSION || header.rootHash != getPathHash(Paths::getRootPath()) ||
+		header.capacity == 0 || (header.capacity & (header.capacity - 1)) != 0 ||
+		sizeCacheFile.size() != sizeof(ImageCacheHeader) + (size_t)header.capacity * sizeof(ImageCacheSlot))
+	{
+		LOG(LogWarning) << "ImageIO : invalid image cache";
+		sizeCacheFile.close();
+		return false;
 	}
 
-	f.close();
+	sizeCacheSlots = (const ImageCacheSlot*)(sizeCacheFile.data() + sizeof(ImageCacheHeader));
+	sizeCacheCapacity = header.capacity;
+	sizeCacheCount = header.count;
+	return true;
+}
+
+static bool openImageCacheFile()
+{
+	if (openImageCacheFile(getImageCacheFilename()))
+		return true;
+
+	if (sizeCacheSharedFilename.empty() || !openImageCacheFile(sizeCacheSharedFilename))
+		return false;
+
+	sizeCacheShared = true;
+	return true;
+}
+
+void ImageIO::setSharedImageCache(const std::string& fname)
+{
+	std::unique_lock<std::mutex> lock(sizeCacheLock);
+	sizeCacheSharedFilename = fname;
+}
+
+void ImageIO::clearImageCache()
+{
+	std::unique_lock<std::mutex> lock(sizeCacheLock);
+
+	closeImageCacheFile();
+
+	std::string fname = getImageCacheFilename();
+	Utils::FileSystem::removeFile(fname);
+	sizeCache.clear();
+	sizeCacheDirty = false;
+}
+
+void ImageIO::loadImageCache()
+{
+	std::unique_lock<std::mutex> lock(sizeCacheLock);
+
+	sizeCache.clear();
+	sizeCacheDirty = false;
+
+	openImageCacheFile();
 }
 
 static bool _isCachablePath(const std::string& path)
@@ -328,95 +608,286 @@ static bool _isCachablePath(const std::string& path)
 		path.find("/saves/") == std::string::npos;
 }
 
-void ImageIO::saveImageCache()
+static void writeImageCacheSlot(ImageCacheSlot& slot, uint64_t hash, const CachedFileInfo& info)
 {
-	if (!sizeCacheDirty)
-		return;
+	bool valid = info.cachable && info.size > 0 && info.x > 0;
+
+	slot.hash = hash;
+	slot.size = valid ? info.size : -1;
+	slot.x = valid ? info.x : 0;
+	slot.y = valid ? info.y : 0;
+	slot.reserved = 0;
+	slot.contentHash = valid ? info.contentHash : 0;
+}
+
+// Requires sizeCacheLock. Builds a new table from the mapped one & the session entries
+static bool rebuildImageCacheFile()
+{
+	uint32_t live = 0;
+	for (uint32_t i = 0; i < sizeCacheCapacity; i++)
+		if (sizeCacheSlots[i].hash != 0 && sizeCacheSlots[i].size >= 0)
+			live++;
+
+	for (auto& item : sizeCache)
+		if (item.second.dirty)
+			live++;
+
+	uint32_t capacity = 1024;
+	while (capacity < live * 2)
+		capacity *= 2;
+
+	std::vector<ImageCacheSlot> slots(capacity);
+	memset(slots.data(), 0, capacity * sizeof(ImageCacheSlot));
+
+	uint32_t count = 0;
+
+	auto insert = [&](const ImageCacheSlot& slot)
+	{
+		int index = findSlot(slots.data(), capacity, slot.hash);
+		if (index < 0)
+			return;
+
+		if (slots[index].hash == 0)
+			count++;
+
+		slots[index] = slot;
+	};
+
+	for (uint32_t i = 0; i < sizeCacheCapacity; i++)
+	{
+		const ImageCacheSlot& slot = sizeCacheSlots[i];
+		if (slot.hash == 0 || slot.size < 0)
+			continue;
+
+		auto it = sizeCache.find(slot.hash);
+		if (it == sizeCache.cend() || !it->second.dirty)
+			insert(slot);
+	}
+
+	for (auto& item : sizeCache)
+	{
+		if (!item.second.dirty || !item.second.cachable || item.second.size <= 0 || item.second.x <= 0)
+			continue;
+
+		ImageCacheSlot slot;
+		writeImageCacheSlot(slot, item.first, item.second);
+		insert(slot);
+	}
+
+	ImageCacheHeader header;
+	header.magic = IMAGE_CACHE_MAGIC;
+	header.version = IMAGE_CACHE_VERSION;
+	header.capacity = capacity;
+	header.count = count;
+	header.rootHash = getPathHash(Paths::getRootPath());
+
+	closeImageCacheFile();
 
 	std::string fname = getImageCacheFilename();
-	std::ofstream f(fname.c_str(), std::ios::binary);
-	if (f.fail())
+
+	Utils::BinaryWriter writer;
+	writer.write(&header, sizeof(header));
+	writer.write(slots.data(), capacity * sizeof(ImageCacheSlot));
+
+	if (!Utils::FileSystem::writeFileAtomic(fname, writer))
+		return false;
+
+	// Text cache of the previous versions
+	Utils::FileSystem::removeFile(Paths::getUserEmulationStationPath() + "/imagecache.db");
+	return true;
+}
+
+void ImageIO::saveImageCache()
+{
+	std::unique_lock<std::mutex> lock(sizeCacheLock);
+
+	if (!sizeCacheDirty)
 		return;
 
-	std::string relativeTo = Paths::getRootPath();
+	// Changed slots, and the number of hashes that are not in the file yet
+	std::vector<std::pair<int, ImageCacheSlot>> writes;
+	uint32_t count = sizeCacheCount;
+	bool rebuild = (sizeCacheSlots == nullptr || sizeCacheShared);
 
-	for (auto it : sizeCache)
+	for (auto& item : sizeCache)
 	{
-		if (it.second.size < 0)
+		if (rebuild)
+			break;
+
+		if (!item.second.dirty)
 			continue;
 
-		if (!_isCachablePath(it.first))
+		int index = findSlot(sizeCacheSlots, sizeCacheCapacity, item.first);
+		if (index < 0)
+		{
+			rebuild = true;
+			break;
+		}
+
+		bool valid = item.second.cachable && item.second.size > 0 && item.second.x > 0;
+
+		// Nothing to remove
+		if (sizeCacheSlots[index].hash == 0 && !valid)
 			continue;
 
-		std::string path = Utils::FileSystem::createRelativePath(it.first, relativeTo, true); 
+		if (sizeCacheSlots[index].hash == 0)
+			count++;
 
-		f << path;
-		f << "|";
-		f << std::to_string(it.second.size);
-		f << "|";
-		f << std::to_string(it.second.x);
-		f << "|";
-		f << std::to_string(it.second.y);
-		f << "\n";
+		ImageCacheSlot slot;
+		writeImageCacheSlot(slot, item.first, item.second);
+		writes.push_back(std::pair<int, ImageCacheSlot>(index, slot));
 	}
 
-	f.close();
-}
+	// Keep the load factor under 70%
+	if (!rebuild && (uint64_t)count * 10 > (uint64_t)sizeCacheCapacity * 7)
+		rebuild = true;
 
-static std::mutex sizeCacheLock;
+	if (rebuild)
+		rebuildImageCacheFile();
+	else if (writes.size())
+	{
+		ImageCacheHeader header;
+		memcpy(&header, sizeCacheFile.data(), sizeof(header));
+		header.count = count;
+
+		// The mapping of the file has to be released first on Windows
+		closeImageCacheFile();
+
+		std::fstream f(WINSTRINGW(getImageCacheFilename()), std::ios::binary | std::ios::in | std::ios::out);
+		if (!f.fail())
+		{
+			for (auto& write : writes)
+			{
+				f.seekp(sizeof(ImageCacheHeader) + (size_t)write.first * sizeof(ImageCacheSlot));
+				f.write((const char*)&write.second, sizeof(ImageCacheSlot));
+			}
+
+			f.seekp(0);
+			f.write((const char*)&header, sizeof(header));
+			f.close();
+		}
+	}
+
+	for (auto& item : sizeCache)
+		item.second.dirty = false;
+
+	sizeCacheDirty = false;
+
+	openImageCacheFile();
+}
 
 void ImageIO::removeImageCache(const std::string& fn)
 {
 	std::unique_lock<std::mutex> lock(sizeCacheLock);
 
-	auto it = sizeCache.find(fn);
-	if (it != sizeCache.cend())
-		sizeCache.erase(fn);
+	// Kept as a removed entry, so that the slot of the file is cleared by saveImageCache
+	CachedFileInfo& item = sizeCache[getPathHash(fn)];
+	item.size = -2;
+	item.x = 0;
+	item.y = 0;
+	item.cachable = _isCachablePath(fn);
+	item.dirty = item.cachable;
+
+	if (item.dirty)
+		sizeCacheDirty = true;
 }
 
-void ImageIO::updateImageCache(const std::string& fn, int sz, int x, int y)
+void ImageIO::updateImageCache(const std::string& fn, int sz, int x, int y, uint64_t contentHash)
 {
 	std::unique_lock<std::mutex> lock(sizeCacheLock);
 
-	auto it = sizeCache.find(fn);
-	if (it != sizeCache.cend())
+	uint64_t hash = getPathHash(fn);
+
+	// Without a content hash, the known one is kept as long as the file size is the same
+	auto it = sizeCache.find(hash);
+	if (it != sizeCache.cend() && x == it->second.x && y == it->second.y && sz == it->second.size && (contentHash == 0 || contentHash == it->second.contentHash))
+		return;
+
+	int index = findSlot(sizeCacheSlots, sizeCacheCapacity, hash);
+	bool inFile = (index >= 0 && sizeCacheSlots[index].hash == hash && sizeCacheSlots[index].size >= 0);
+
+	if (it == sizeCache.cend())
 	{
-		if (x != it->second.x || y != it->second.y || sz != it->second.size)
+		// Already there
+		if (inFile && sizeCacheSlots[index].size == sz && sizeCacheSlots[index].x == x && sizeCacheSlots[index].y == y && 
+			(contentHash == 0 || contentHash == sizeCacheSlots[index].contentHash))
 		{
-			auto& item = it->second;
+			sizeCache[hash] = CachedFileInfo(sz, x, y, sizeCacheSlots[index].contentHash);
+			return;
+		}
 
-			item.x = x;
-			item.y = y;
-			item.size = sz;
+		it = sizeCache.insert(std::pair<uint64_t, CachedFileInfo>(hash, CachedFileInfo())).first;
+		if (inFile)
+			it->second.contentHash = sizeCacheSlots[index].contentHash;
+	}
 
-			if (sz > 0 && x > 0 && _isCachablePath(fn))
-				sizeCacheDirty = true;
-		}
+	auto& item = it->second;
+	if (contentHash != 0 || item.size != sz)
+		item.contentHash = contentHash;
+
+	item.x = x;
+	item.y = y;
+	item.size = sz;
+	item.cachable = _isCachablePath(fn);
+
+	// Unreadable files are not saved, but their previous entry is removed
+	if (item.cachable && ((sz > 0 && x > 0) || inFile))
+	{
+		item.dirty = true;
+		sizeCacheDirty = true;
 	}
-	else
+}
+
+// Requires sizeCacheLock
+static bool findImageCache(const std::string& fn, CachedFileInfo& info)
+{
+	uint64_t hash = getPathHash(fn);
+
+	auto it = sizeCache.find(hash);
+	if (it != sizeCache.cend())
 	{
-		sizeCache[fn] = CachedFileInfo(sz, x, y);
+		if (it->second.size == -2)
+			return false;
 
-		if (sz > 0 && x > 0 && _isCachablePath(fn))
-			sizeCacheDirty = true;
+		info = it->second;
+		return true;
 	}
-}
 
+	int index = findSlot(sizeCacheSlots, sizeCacheCapacity, hash);
+	if (index < 0 || sizeCacheSlots[index].hash != hash || sizeCacheSlots[index].size < 0)
+		return false;
+
+	info = CachedFileInfo(sizeCacheSlots[index].size, sizeCacheSlots[index].x, sizeCacheSlots[index].y, sizeCacheSlots[index].contentHash);
+	return true;
+}
 
-bool ImageIO::loadImageSize(const std::string& fn, unsigned int *x, unsigned int *y)
+bool ImageIO::loadImageSize(const std::string& fn, unsigned int *x, unsigned int *y, uint64_t* contentHash)
 {
+	if (contentHash != nullptr)
+		*contentHash = 0;
+
+	// A content hash is only trusted while the file keeps its size
+	size_t size = (size_t)-1;
+
 	{
 		std::unique_lock<std::mutex> lock(sizeCacheLock);
 
-		auto it = sizeCache.find(fn);
-		if (it != sizeCache.cend())
+		CachedFileInfo info;
+		if (findImageCache(fn, info))
 		{
-			if (it->second.size < 0)
+			if (info.size < 0)
 				return false;
 
-			*x = it->second.x;
-			*y = it->second.y;
-			return true;
+			if (contentHash == nullptr || (info.contentHash != 0 && (size = Utils::FileSystem::getFileSize(fn)) == (size_t)info.size))
+			{
+				*x = info.x;
+				*y = info.y;
+
+				if (contentHash != nullptr)
+					*contentHash = info.contentHash;
+
+				return true;
+			}
 		}
 	}
 
@@ -429,7 +900,19 @@ bool ImageIO::loadImageSize(const std::string& fn, unsigned int *x, unsigned int
 		return false;
 	}
 
-	auto size = Utils::FileSystem::getFileSize(fn);
+	if (size == (size_t)-1)
+		size = Utils::FileSystem::getFileSize(fn);
+
+	// The whole file is read for the content hash, the header is then taken from the mapping
+	Utils::MemoryMappedFile mapped;
+	uint64_t hash = 0;
+
+	if (contentHash != nullptr && mapped.open(fn) && mapped.size() >= 24)
+	{
+		hash = getContentHash(mapped.data(), mapped.size());
+		size = mapped.size();
+		*contentHash = hash;
+	}
 
 #if WIN32
 	FILE* f = _wfopen(Utils::String::convertToWideString(fn).c_str(), L"rb");
@@ -497,7 +980,7 @@ bool ImageIO::loadImageSize(const std::string& fn, unsigned int *x, unsigned int
 			return false;
 		}
 
-		updateImageCache(fn, size, *x, *y);
+		updateImageCache(fn, (int)size, *x, *y, hash);
 		return true;
 	}
 
@@ -509,7 +992,7 @@ bool ImageIO::loadImageSize(const std::string& fn, unsigned int *x, unsigned int
 
 		LOG(LogDebug) << "ImageIO::loadImageSize\tGIF size " << std::string(std::to_string(*x) + "x" + std::to_string(*y)).c_str();
 
-		updateImageCache(fn, size, *x, *y);
+		updateImageCache(fn, (int)size, *x, *y, hash);
 		return true;
 	}
 
@@ -521,7 +1004,7 @@ bool ImageIO::loadImageSize(const std::string& fn, unsigned int *x, unsigned int
 
 		LOG(LogDebug) << "ImageIO::loadImageSize\tPNG size " << std::string(std::to_string(*x) + "x" + std::to_string(*y)).c_str();
 
-		updateImageCache(fn, size, *x, *y);
+		updateImageCache(fn, (int)size, *x, *y, hash);
 		return true;
 	}
 
@@ -530,6 +1013,48 @@ bool ImageIO::loadImageSize(const std::string& fn, unsigned int *x, unsigned int
 	return false;
 }
 
+bool ImageIO::getImageSize(const unsigned char* data, size_t size, unsigned int *x, unsigned int *y)
+{
+	if (data == nullptr || size < 24)
+		return false;
+
+	// JPEG : the chunks are walked up to the DCT frame, which has to be in the buffer
+	if (data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+	{
+		size_t pos = 2;
+		while (pos + 9 < size && data[pos] == 0xFF)
+		{
+			unsigned char marker = data[pos + 1];
+			if (marker == 0xC0 || marker == 0xC1 || marker == 0xC2 || marker == 0xC3 || marker == 0xC9 || marker == 0xCA || marker == 0xCB)
+			{
+				*y = (data[pos + 5] << 8) + data[pos + 6];
+				*x = (data[pos + 7] << 8) + data[pos + 8];
+				return *x > 0 && *x <= 5000;
+			}
+
+			pos += 2 + (data[pos + 2] << 8) + data[pos + 3];
+		}
+
+		return false;
+	}
+
+	if (data[0] == 'G' && data[1] == 'I' && data[2] == 'F')
+	{
+		*x = data[6] + (data[7] << 8);
+		*y = data[8] + (data[9] << 8);
+		return true;
+	}
+
+	if (data[0] == 0x89 && data[1] == 'P' && data[2] == 'N' && data[3] == 'G' && data[12] == 'I' && data[13] == 'H' && data[14] == 'D' && data[15] == 'R')
+	{
+		*x = (data[16] << 24) + (data[17] << 16) + (data[18] << 8) + (data[19] << 0);
+		*y = (data[20] << 24) + (data[21] << 16) + (data[22] << 8) + (data[23] << 0);
+		return true;
+	}
+
+	return false;
+}
+
 bool ImageIO::getMultiBitmapInformation(const std::string& path, int& totalFrames, int& frameTime)
 {	
 	totalFrames = 1;
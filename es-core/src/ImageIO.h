@@ -3,9 +3,12 @@
 #define ES_CORE_IMAGE_IO
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <string>
 #include <vector>
 #include "math/Vector2f.h"
 #include "math/Vector2i.h"
+#include "resources/PixelBuffer.h"
 
 
 class MaxSizeInfo
@@ -40,21 +43,42 @@ private:
 	bool	 mExternalZoomKnown;
 };
 
+// Content hash of the image cache, for the files that are read by chunks. The size of the file has to be known first
+class ImageContentHash
+{
+public:
+	ImageContentHash(size_t size);
+
+	void update(const unsigned char* data, size_t size);
+	uint64_t get() const { return mHash == 0 ? 1 : mHash; }
+
+private:
+	uint64_t mHash;
+};
+
 class ImageIO
 {
 public:
-	static unsigned char*  loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height, MaxSizeInfo* maxSize = nullptr, Vector2i* baseSize = nullptr, Vector2i* packedSize = nullptr, int subImageIndex = -1);
+	static PixelBuffer loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height, MaxSizeInfo* maxSize = nullptr, Vector2i* baseSize = nullptr, Vector2i* packedSize = nullptr, int subImageIndex = -1);
 	static void flipPixelsVert(unsigned char* imagePx, const size_t& width, const size_t& height);
+	// Box filtered half size copy
+	static PixelBuffer halveRGBA32(const unsigned char* imagePx, size_t width, size_t height, size_t& outWidth, size_t& outHeight);
 	
 	static Vector2f getPictureMinSize(Vector2f imageSize, Vector2f maxSize);
 	static Vector2i adjustPictureSize(Vector2i imageSize, Vector2i maxSize, bool externSize = false);
-	static bool		loadImageSize(const std::string& fn, unsigned int *x, unsigned int *y);
+	// contentHash : hash of the file bytes, computed along the size probe & kept in the cache. 0 when unknown
+	static bool		loadImageSize(const std::string& fn, unsigned int *x, unsigned int *y, uint64_t* contentHash = nullptr);
 
 	static void		removeImageCache(const std::string& fn);
-	static void		updateImageCache(const std::string& fn, int sz, int x, int y);
+	static void		updateImageCache(const std::string& fn, int sz, int x, int y, uint64_t contentHash = 0);
 	static void		loadImageCache();
 	static void		saveImageCache();
 	static void		clearImageCache();
+	// Read only cache used when the local one is missing ( shared by the cabinets of a fleet )
+	static void		setSharedImageCache(const std::string& fname);
+
+	// Same probe as loadImageSize, on the first bytes of a file ( jpg, png & gif )
+	static bool		getImageSize(const unsigned char* data, size_t size, unsigned int *x, unsigned int *y);
 
 	static bool		getMultiBitmapInformation(const std::string& path, int& totalFrames, int& frameTime);
 };
@@ -0,0 +1,148 @@
+#include "InputLatency.h"
+
+#include "renderers/Renderer.h"
+#include "Settings.h"
+#include "Log.h"
+#include <SDL.h>
+#include <algorithm>
+
+#define REPORT_WINDOW_MS	5000
+
+// Inputs are coalesced per frame, a bound keeps a stuck render loop from growing the list
+#define MAX_PENDING_INPUTS	64
+
+bool InputLatency::mEnabled = false;
+bool InputLatency::mGpuSync = false;
+uint64_t InputLatency::mFrequency = 1;
+
+uint64_t InputLatency::mEventTime = 0;
+std::vector<uint64_t> InputLatency::mPending;
+
+uint64_t InputLatency::mReportStart = 0;
+std::vector<float> InputLatency::mSamples;
+
+std::atomic<uint64_t> InputLatency::mHistogram[InputLatency::HISTOGRAM_BUCKETS];
+std::atomic<uint64_t> InputLatency::mHistogramSumUs(0);
+
+// One to a few frames at 60Hz, the last bucket is +Inf
+static const float sHistogramBounds[InputLatency::HISTOGRAM_BUCKETS] = { 8.4f, 16.8f, 33.4f, 50.1f, 66.8f, 100.0f, 150.0f, 250.0f, 1e30f };
+
+const float* InputLatency::getHistogramBounds()
+{
+	return sHistogramBounds;
+}
+
+void InputLatency::getHistogram(uint64_t counts[HISTOGRAM_BUCKETS], uint64_t& count, double& sumMs)
+{
+	count = 0;
+
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+	{
+		count += mHistogram[i];
+		counts[i] = count;
+	}
+
+	sumMs = (double)mHistogramSumUs / 1000.0;
+}
+
+void InputLatency::init()
+{
+	mEnabled = Settings::getInstance()->getBool("InputLatencyStats");
+	mGpuSync = mEnabled && Settings::getInstance()->getBool("InputLatencyGpuSync");
+
+	mFrequency = SDL_GetPerformanceFrequency();
+	if (mFrequency == 0)
+		mFrequency = 1;
+
+	mEventTime = 0;
+	mPending.clear();
+	mSamples.clear();
+	mReportStart = SDL_GetPerformanceCounter();
+
+	if (mEnabled)
+		LOG(LogInfo) << "InputLatency : measuring input to swap latency" << (mGpuSync ? " (GPU sync)" : "");
+}
+
+void InputLatency::beginEvent(const SDL_Event& ev)
+{
+	if (!mEnabled)
+		return;
+
+	// SDL stamps the events in ms when they are queued : move that back on the performance counter
+	uint64_t now = SDL_GetPerformanceCounter();
+	Uint32 ticks = SDL_GetTicks();
+	Uint32 age = ticks >= ev.common.timestamp && ev.common.timestamp != 0 ? ticks - ev.common.timestamp : 0;
+
+	uint64_t queued = (uint64_t)age * mFrequency / 1000;
+	mEventTime = queued < now ? now - queued : now;
+}
+
+void InputLatency::endEvent()
+{
+	mEventTime = 0;
+}
+
+void InputLatency::onInput()
+{
+	if (!mEnabled || mEventTime == 0)
+		return;
+
+	// An axis or a mouse event can produce several inputs : one sample per event
+	if (!mPending.empty() && mPending.back() == mEventTime)
+		return;
+
+	if (mPending.size() < MAX_PENDING_INPUTS)
+		mPending.push_back(mEventTime);
+}
+
+void InputLatency::onPresent()
+{
+	if (!mEnabled)
+		return;
+
+	if (!mPending.empty())
+	{
+		// The swap only queues the frame : wait for the GPU to include the rendering itself
+		if (mGpuSync)
+			Renderer::waitForGpu();
+
+		uint64_t now = SDL_GetPerformanceCounter();
+
+		for (auto eventTime : mPending)
+		{
+			float latencyMs = (float)(now - eventTime) * 1000.0f / (float)mFrequency;
+
+			int bucket = 0;
+			while (bucket < HISTOGRAM_BUCKETS - 1 && latencyMs > sHistogramBounds[bucket])
+				bucket++;
+
+			mHistogram[bucket]++;
+			mHistogramSumUs += (uint64_t)(latencyMs * 1000.0f);
+
+			mSamples.push_back(latencyMs);
+		}
+
+		mPending.clear();
+	}
+
+	report(SDL_GetPerformanceCounter());
+}
+
+void InputLatency::report(uint64_t now)
+{
+	if ((now - mReportStart) * 1000 < REPORT_WINDOW_MS * mFrequency)
+		return;
+
+	mReportStart = now;
+
+	if (mSamples.empty())
+		return;
+
+	std::sort(mSamples.begin(), mSamples.end());
+
+	auto percentile = [](const std::vector<float>& samples, int p) { return samples[std::min(samples.size() - 1, samples.size() * p / 100)]; };
+
+	LOG(LogInfo) << "InputLatency : " << mSamples.size() << " inputs, p50 " << percentile(mSamples, 50) << "ms, p95 " << percentile(mSamples, 95) << "ms, p99 " << percentile(mSamples, 99) << "ms, max " << mSamples.back() << "ms";
+
+	mSamples.clear();
+}
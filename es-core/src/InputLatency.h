@@ -0,0 +1,54 @@
+#pragma once
+#ifndef ES_CORE_INPUT_LATENCY_H
+#define ES_CORE_INPUT_LATENCY_H
+
+#include <cstdint>
+#include <atomic>
+#include <vector>
+
+union SDL_Event;
+
+// Time from an input event ( its SDL timestamp ) to the swap of the first frame rendered after Window::input handled it.
+// Enabled with the "InputLatencyStats" setting : the distribution is logged every few seconds & exported through /metrics.
+// With "InputLatencyGpuSync", the swap waits for the GPU to finish, so the measure includes the rendering of the frame
+class InputLatency
+{
+public:
+	static void init();
+
+	static bool isEnabled() { return mEnabled; }
+
+	// InputManager::parseEvent : the event being dispatched
+	static void beginEvent(const SDL_Event& ev);
+	static void endEvent();
+
+	// Window::input : the current event reached the UI, its result is in the next presented frame
+	static void onInput();
+
+	// FrameScheduler::present, after the buffers are swapped
+	static void onPresent();
+
+	// Latencies since startup : counts[i] inputs took at most getHistogramBounds()[i] ms, the last bucket is +Inf. Thread safe
+	static const int HISTOGRAM_BUCKETS = 9;
+	static const float* getHistogramBounds();
+	static void getHistogram(uint64_t counts[HISTOGRAM_BUCKETS], uint64_t& count, double& sumMs);
+
+private:
+	static void report(uint64_t now);
+
+	static bool				mEnabled;
+	static bool				mGpuSync;
+	static uint64_t			mFrequency;
+
+	static uint64_t			mEventTime;			// 0 outside of parseEvent
+	static std::vector<uint64_t> mPending;		// Handled inputs waiting for their frame
+
+	// Current report window
+	static uint64_t			mReportStart;
+	static std::vector<float> mSamples;
+
+	static std::atomic<uint64_t> mHistogram[HISTOGRAM_BUCKETS];
+	static std::atomic<uint64_t> mHistogramSumUs;
+};
+
+#endif // ES_CORE_INPUT_LATENCY_H
@@ -6,6 +6,7 @@
 #include "utils/Platform.h"
 #include "Scripting.h"
 #include "Window.h"
+#include "InputLatency.h"
 #include <pugixml/src/pugixml.hpp>
 #include <SDL.h>
 #include <iostream>
@@ -47,11 +48,13 @@ int SDL_USER_CECBUTTONDOWN = -1;
 int SDL_USER_CECBUTTONUP   = -1;
 
 static std::mutex mJoysticksLock;
+static std::mutex mEmulatorsConfigLock;
 
 InputManager* InputManager::mInstance = NULL;
 Delegate<IJoystickChangedEvent> InputManager::joystickChanged;
+std::atomic<uint64_t> InputManager::mEventCounts[InputManager::EVENT_COUNTER_COUNT];
 
-InputManager::InputManager() : mKeyboardInputConfig(nullptr), mMouseButtonsInputConfig(nullptr), mCECInputConfig(nullptr), mGunInputConfig(nullptr), mGunManager(nullptr)
+InputManager::InputManager() : mKeyboardInputConfig(nullptr), mMouseButtonsInputConfig(nullptr), mCECInputConfig(nullptr), mGunInputConfig(nullptr), mGunManager(nullptr), mLastJoystickSlot(0), mEmulatorsConfigValid(false)
 {
 
 }
@@ -228,13 +231,12 @@ void InputManager::clearJoysticks()
 
 	mInputConfigs.clear();
 
-	for (auto iter = mPrevAxisValues.begin(); iter != mPrevAxisValues.end(); iter++)
-		if (iter->second)
-			delete[] iter->second;
-
-	mPrevAxisValues.clear();
+	mJoystickSlots.clear();
+	mLastJoystickSlot = 0;
 
 	mJoysticksLock.unlock();
+
+	invalidateEmulatorsConfig();
 }
 
 #if defined(WIN32)
@@ -426,18 +428,28 @@ void InputManager::rebuildAllJoysticks(bool deinit)
 		else
 			LOG(LogInfo) << "Added known joystick " << SDL_JoystickName(joy) << " (GUID: " << guid << ", instance ID: " << joyId << ", device index: " << idx << ", device path : " << devicePath << ").";
 
-		// set up the prevAxisValues
-		int numAxes = SDL_JoystickNumAxes(joy);
-		
-		mPrevAxisValues.erase(joyId);
-		mPrevAxisValues[joyId] = new int[numAxes];
-		std::fill(mPrevAxisValues[joyId], mPrevAxisValues[joyId] + numAxes, 0); //initialize array to 0
+		// set up the axis state
+		int numAxes = std::max(0, SDL_JoystickNumAxes(joy));
+
+		auto slot = std::find_if(mJoystickSlots.begin(), mJoystickSlots.end(), [joyId](const JoystickSlot& s) { return s.id == joyId; });
+		if (slot == mJoystickSlots.end())
+			slot = mJoystickSlots.insert(mJoystickSlots.end(), JoystickSlot());
+
+		slot->id = joyId;
+		slot->joystick = joy;
+		slot->config = mInputConfigs[joyId];
+		slot->prevAxisValues.assign(numAxes, 0);
+		slot->initialValues.assign(numAxes, AXIS_UNKNOWN);
 	}	
 
 	mJoysticksLock.unlock();
 
 	computeLastKnownPlayersDeviceIndexes();
 
+	// Computed now rather than when a game is launched
+	invalidateEmulatorsConfig();
+	configureEmulators();
+
 	joystickChanged.invoke([](IJoystickChangedEvent* c) { c->onJoystickChanged(); });
 
 	SDL_JoystickEventState(SDL_ENABLE);
@@ -454,8 +466,70 @@ typedef struct SDL_JoyBatteryEventX
 } SDL_JoyBatteryEventX;
 #endif
 
+// Stamps the inputs the event produces, on every return path
+struct InputLatencyScope
+{
+	InputLatencyScope(const SDL_Event& ev) { InputLatency::beginEvent(ev); }
+	~InputLatencyScope() { InputLatency::endEvent(); }
+};
+
+InputManager::JoystickSlot* InputManager::getJoystickSlot(SDL_JoystickID id)
+{
+	// The events of a stick come in bursts
+	if (mLastJoystickSlot < (int)mJoystickSlots.size() && mJoystickSlots[mLastJoystickSlot].id == id)
+		return &mJoystickSlots[mLastJoystickSlot];
+
+	for (int i = 0; i < (int)mJoystickSlots.size(); i++)
+	{
+		if (mJoystickSlots[i].id == id)
+		{
+			mLastJoystickSlot = i;
+			return &mJoystickSlots[i];
+		}
+	}
+
+	return nullptr;
+}
+
+// some axes are "full" : from -32000 to +32000
+// in this case, their unpressed state is not 0
+// SDL provides a function to get this value
+// in es, the trick is to minus this value to the value to do as if it started at 0
+int InputManager::getAxisInitialValue(JoystickSlot& slot, int axis)
+{
+	int& value = slot.initialValues[axis];
+	if (value != AXIS_UNKNOWN)
+		return value;
+
+	value = 0;
+
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+	// SDL_JoystickGetAxisInitialState doesn't work with 8bitdo start+b
+	// required for several pads like xbox and 8bitdo
+	// The first value of a pad is kept across the reconnections
+	if (slot.config != nullptr)
+	{
+		Sint16 x;
+		std::string guid = std::to_string(axis) + "@" + slot.config->getDeviceGUIDString();
+
+		auto it = mJoysticksInitialValues.find(guid);
+		if (it != mJoysticksInitialValues.cend())
+			value = it->second;
+		else if (SDL_JoystickGetAxisInitialState(slot.joystick, axis, &x))
+		{
+			mJoysticksInitialValues[guid] = x;
+			value = x;
+		}
+	}
+#endif
+
+	return value;
+}
+
 bool InputManager::parseEvent(const SDL_Event& ev, Window* window)
 {
+	InputLatencyScope latencyScope(ev);
+
 	bool causedEvent = false;
 
 	switch (ev.type)
@@ -497,64 +571,43 @@ bool InputManager::parseEvent(const SDL_Event& ev, Window* window)
 #endif
 
 	case SDL_JOYAXISMOTION:
-	{		
-	// some axes are "full" : from -32000 to +32000
-	// in this case, their unpressed state is not 0
-	// SDL provides a function to get this value
-	// in es, the trick is to minus this value to the value to do as if it started at 0
-		int initialValue = 0;
-		Sint16 x;
+	{
+		mEventCounts[AXIS_EVENTS]++;
 
-#if SDL_VERSION_ATLEAST(2, 0, 9)
-		// SDL_JoystickGetAxisInitialState doesn't work with 8bitdo start+b
-		// required for several pads like xbox and 8bitdo
+		JoystickSlot* slot = getJoystickSlot(ev.jaxis.which);
+		if (slot == nullptr || ev.jaxis.axis >= slot->prevAxisValues.size())
+			return false;
 
-		auto inputConfig = mInputConfigs.find(ev.jaxis.which);
-		if (inputConfig != mInputConfigs.cend())
-		{
-			std::string guid = std::to_string(ev.jaxis.axis) + "@" + inputConfig->second->getDeviceGUIDString();
+		int value = ev.jaxis.value - getAxisInitialValue(*slot, ev.jaxis.axis);
+		int& prevValue = slot->prevAxisValues[ev.jaxis.axis];
 
-			auto it = mJoysticksInitialValues.find(guid);
-			if (it != mJoysticksInitialValues.cend())
-				initialValue = it->second;
-			else if (SDL_JoystickGetAxisInitialState(mJoysticks[ev.jaxis.which], ev.jaxis.axis, &x))
-			{
-				mJoysticksInitialValues[guid] = x;
-				initialValue = x;
-			}
+		// Most of the events of a stick stay on the same side of the deadzone
+		bool pressed = abs(value) > DEADZONE;
+		bool wasPressed = abs(prevValue) > DEADZONE;
+		prevValue = value;
+
+		if (pressed == wasPressed)
+		{
+			mEventCounts[AXIS_FILTERED]++;
+			return false;
 		}
-#endif
 
-		if (mPrevAxisValues.find(ev.jaxis.which) != mPrevAxisValues.cend())
-		{			
-			//if it switched boundaries
-			if ((abs(ev.jaxis.value - initialValue) > DEADZONE) != (abs(mPrevAxisValues[ev.jaxis.which][ev.jaxis.axis]) > DEADZONE))
-			{
-				int normValue;
-				if (abs(ev.jaxis.value - initialValue) <= DEADZONE) 
-					normValue = 0;
-				else
-					if (ev.jaxis.value - initialValue > 0) 
-						normValue = 1;
-					else
-						normValue = -1;
-
-				window->input(getInputConfigByDevice(ev.jaxis.which), Input(ev.jaxis.which, TYPE_AXIS, ev.jaxis.axis, normValue, false));
-				causedEvent = true;
-			}
+		int normValue = !pressed ? 0 : value > 0 ? 1 : -1;
 
-			mPrevAxisValues[ev.jaxis.which][ev.jaxis.axis] = ev.jaxis.value - initialValue; 
-		}
+		window->input(slot->config, Input(ev.jaxis.which, TYPE_AXIS, ev.jaxis.axis, normValue, false));
+		causedEvent = true;
 
 		return causedEvent;
 	}
 	case SDL_JOYBUTTONDOWN:
 	case SDL_JOYBUTTONUP:
+		mEventCounts[BUTTON_EVENTS]++;
 		window->input(getInputConfigByDevice(ev.jbutton.which), Input(ev.jbutton.which, TYPE_BUTTON, ev.jbutton.button, ev.jbutton.state == SDL_PRESSED, false));
 		return true;
 	
 	case SDL_MOUSEBUTTONDOWN:        
 	case SDL_MOUSEBUTTONUP:
+		mEventCounts[MOUSE_EVENTS]++;
 		if (!getGunManager()->isReplacingMouse())
 			if (!window->processMouseButton(ev.button.button, ev.type == SDL_MOUSEBUTTONDOWN, ev.button.x, ev.button.y))
 				window->input(getInputConfigByDevice(DEVICE_MOUSE), Input(DEVICE_MOUSE, TYPE_BUTTON, ev.button.button, ev.type == SDL_MOUSEBUTTONDOWN, false));
@@ -562,6 +615,7 @@ bool InputManager::parseEvent(const SDL_Event& ev, Window* window)
 		return true;
 
 	case SDL_MOUSEMOTION:
+		mEventCounts[MOUSE_EVENTS]++;
 #if !WIN32
 	  if (ev.motion.which == SDL_TOUCH_MOUSEID)
 #endif
@@ -577,10 +631,12 @@ bool InputManager::parseEvent(const SDL_Event& ev, Window* window)
 		return true;
 
 	case SDL_JOYHATMOTION:
+		mEventCounts[HAT_EVENTS]++;
 		window->input(getInputConfigByDevice(ev.jhat.which), Input(ev.jhat.which, TYPE_HAT, ev.jhat.hat, ev.jhat.value, false));
 		return true;
 
 	case SDL_KEYDOWN:
+		mEventCounts[KEY_EVENTS]++;
 		if (ev.key.keysym.sym == SDLK_BACKSPACE && SDL_IsTextInputActive())
 			window->textInput("\b");
 
@@ -601,6 +657,7 @@ bool InputManager::parseEvent(const SDL_Event& ev, Window* window)
 		return true;
 
 	case SDL_KEYUP:
+		mEventCounts[KEY_EVENTS]++;
 		window->input(getInputConfigByDevice(DEVICE_KEYBOARD), Input(DEVICE_KEYBOARD, TYPE_KEY, ev.key.keysym.sym, 0, false));
 		return true;
 
@@ -983,6 +1040,8 @@ void InputManager::writeDeviceConfig(InputConfig* config)
 	// execute any onFinish commands and re-load the config for changes
 	doOnFinish();
 	loadInputConfig(config);
+
+	invalidateEmulatorsConfig();
 }
 
 void InputManager::doOnFinish()
@@ -1205,7 +1264,33 @@ std::map<int, InputConfig*> InputManager::computePlayersConfigs()
 	return playerJoysticks;
 }
 
+std::string InputManager::getPlayersSettingsKey()
+{
+	std::string key;
+
+	for (int player = 0; player < MAX_PLAYERS; player++)
+	{
+		key += Settings::getInstance()->getString(Utils::String::format("INPUT P%iPATH", player + 1)) + "|";
+		key += Settings::getInstance()->getString(Utils::String::format("INPUT P%iNAME", player + 1)) + "|";
+		key += Settings::getInstance()->getString(Utils::String::format("INPUT P%iGUID", player + 1)) + "|";
+	}
+
+	return key;
+}
+
+void InputManager::invalidateEmulatorsConfig()
+{
+	std::unique_lock<std::mutex> lock(mEmulatorsConfigLock);
+	mEmulatorsConfigValid = false;
+}
+
 std::string InputManager::configureEmulators() {
+  std::string key = getPlayersSettingsKey();
+
+  std::unique_lock<std::mutex> lock(mEmulatorsConfigLock);
+  if (mEmulatorsConfigValid && mEmulatorsConfigKey == key)
+    return mEmulatorsConfig;
+
   std::map<int, InputConfig*> playerJoysticks = computePlayersConfigs();
   std::stringstream command;
 
@@ -1225,7 +1310,12 @@ std::string InputManager::configureEmulators() {
     }
   }
   LOG(LogInfo) << "Configure emulators command : " << command.str().c_str();
-  return command.str();
+
+  mEmulatorsConfig = command.str();
+  mEmulatorsConfigKey = key;
+  mEmulatorsConfigValid = true;
+
+  return mEmulatorsConfig;
 }
 
 void InputManager::updateBatteryLevel(int id, const std::string& device, const std::string& devicePath, int level)
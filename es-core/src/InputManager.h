@@ -4,6 +4,9 @@
 
 #include <SDL_joystick.h>
 #include <map>
+#include <vector>
+#include <atomic>
+#include <cstdint>
 #include <pugixml/src/pugixml.hpp>
 #include <utils/Delegate.h>
 
@@ -56,6 +59,7 @@ public:
 	// this list helps to convert mice to guns
 	std::vector<std::string> getMice();
 
+	// Cached until a joystick is plugged, a config saved or the player assignments change
 	std::string configureEmulators();
 
 	// information about last association players/pads 
@@ -71,6 +75,21 @@ public:
 	void sendMouseClick(Window* window, int button);
 	InputConfig* getInputConfigByDevice(int deviceId);
 
+	// SDL events received since startup. Thread safe
+	enum EventCounter
+	{
+		AXIS_EVENTS = 0,
+		AXIS_FILTERED = 1,	// Axis events that stayed on the same side of the deadzone
+		BUTTON_EVENTS = 2,
+		HAT_EVENTS = 3,
+		KEY_EVENTS = 4,
+		MOUSE_EVENTS = 5,
+
+		EVENT_COUNTER_COUNT = 6
+	};
+
+	static uint64_t getEventCount(EventCounter counter) { return mEventCounts[counter]; }
+
 private:
 	InputManager();
 
@@ -92,10 +111,36 @@ private:
   	InputConfig* mGunInputConfig;
 	InputConfig* mCECInputConfig;
 
-	std::map<SDL_JoystickID, int*> mPrevAxisValues;
+	// Per joystick state of the axis events, in the order of the device indexes : a few pads at most, a scan is cheaper than a map
+	struct JoystickSlot
+	{
+		SDL_JoystickID id;
+		SDL_Joystick* joystick;
+		InputConfig* config;
+		std::vector<int> prevAxisValues;	// Relative to the initial values
+		std::vector<int> initialValues;		// AXIS_UNKNOWN until the first event of the axis
+	};
+
+	static const int AXIS_UNKNOWN = 0x7FFFFFFF;
+
+	JoystickSlot* getJoystickSlot(SDL_JoystickID id);
+	int getAxisInitialValue(JoystickSlot& slot, int axis);
+
+	std::vector<JoystickSlot> mJoystickSlots;
+	int mLastJoystickSlot;
+
+	static std::atomic<uint64_t> mEventCounts[EVENT_COUNTER_COUNT];
+
 	std::map<int, PlayerDeviceInfo> m_lastKnownPlayersDeviceIndexes;
 	std::map<int, InputConfig*> computePlayersConfigs();
 
+	std::string getPlayersSettingsKey();
+	void invalidateEmulatorsConfig();
+
+	std::string mEmulatorsConfig;
+	std::string mEmulatorsConfigKey;	// INPUT P*PATH, NAME & GUID settings the cache was computed with
+	bool mEmulatorsConfigValid;
+
 	bool initialized() const;
 	bool loadInputConfig(InputConfig* config); // returns true if successfully loaded, false if not (or didn't exist)
 	bool loadFromSdlMapping(InputConfig* config, const std::string& mapping);
@@ -0,0 +1,111 @@
+#include "InputRecorder.h"
+
+#include "utils/StringUtil.h"
+#include "InputConfig.h"
+#include "Log.h"
+
+#include <SDL_timer.h>
+#include <algorithm>
+
+std::ofstream InputRecorder::mStream;
+unsigned int InputRecorder::mStartTime = 0;
+std::map<std::tuple<int, int, int>, std::string> InputRecorder::mPressed;
+
+bool InputRecorder::startRecording(const std::string& path)
+{
+	stopRecording();
+
+	mStream.open(WINSTRINGW(path), std::ios::out | std::ios::binary);
+	if (!mStream.is_open())
+	{
+		LOG(LogError) << "InputRecorder : unable to write " << path;
+		return false;
+	}
+
+	mStream << "# EmulationStation input recording : <ms> <input> <pressed>\n";
+	mStartTime = SDL_GetTicks();
+
+	LOG(LogInfo) << "InputRecorder : recording to " << path;
+	return true;
+}
+
+void InputRecorder::stopRecording()
+{
+	if (!mStream.is_open())
+		return;
+
+	mStream << (SDL_GetTicks() - mStartTime) << " end\n";
+	mStream.close();
+
+	mPressed.clear();
+}
+
+void InputRecorder::write(const std::string& name, bool pressed)
+{
+	mStream << (SDL_GetTicks() - mStartTime) << " " << name << " " << (pressed ? 1 : 0) << "\n";
+}
+
+void InputRecorder::onInput(InputConfig* config, const Input& input)
+{
+	if (!mStream.is_open() || config == nullptr)
+		return;
+
+	auto key = std::make_tuple(input.device, (int)input.type, input.id);
+	auto it = mPressed.find(key);
+
+	// Release, or an axis moving straight to the opposite direction
+	if (it != mPressed.cend())
+	{
+		write(it->second, false);
+		mPressed.erase(it);
+	}
+
+	if (input.value == 0)
+		return;
+
+	auto names = config->getMappedTo(input);
+	if (names.empty())
+		return;
+
+	write(names[0], true);
+	mPressed[key] = names[0];
+}
+
+bool InputRecorder::load(const std::string& path, std::vector<Event>& events, int& duration)
+{
+	std::ifstream stream(WINSTRINGW(path), std::ios::in | std::ios::binary);
+	if (!stream.is_open())
+	{
+		LOG(LogError) << "InputRecorder : unable to read " << path;
+		return false;
+	}
+
+	events.clear();
+	duration = 0;
+
+	std::string line;
+	while (std::getline(stream, line))
+	{
+		line = Utils::String::trim(line);
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		auto args = Utils::String::split(line, ' ', true);
+		if (args.size() < 2)
+			continue;
+
+		int time = atoi(args[0].c_str());
+		duration = std::max(duration, time);
+
+		if (args[1] == "end" || args.size() < 3)
+			continue;
+
+		Event event;
+		event.time = time;
+		event.name = args[1];
+		event.pressed = args[2] != "0";
+		events.push_back(event);
+	}
+
+	return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef ES_CORE_INPUT_RECORDER_H
+#define ES_CORE_INPUT_RECORDER_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+class InputConfig;
+struct Input;
+
+// Records the inputs reaching Window::input, with their time, to replay the same navigation at a fixed timestep.
+// The inputs are stored by mapped name ( "down", "a"... ), and replayed with the keyboard mapping : a recording is portable across controllers.
+// One event per line, "<ms> <name> <1 pressed / 0 released>", and "<ms> end" when the recording stops
+class InputRecorder
+{
+public:
+	struct Event
+	{
+		int			time; // ms since the start of the recording
+		std::string name;
+		bool		pressed;
+	};
+
+	static bool startRecording(const std::string& path);
+	static void stopRecording();
+	static bool isRecording() { return mStream.is_open(); }
+
+	// Window::input
+	static void onInput(InputConfig* config, const Input& input);
+
+	// The events of a recording, and its duration in ms
+	static bool load(const std::string& path, std::vector<Event>& events, int& duration);
+
+private:
+	static void write(const std::string& name, bool pressed);
+
+	static std::ofstream	mStream;
+	static unsigned int		mStartTime;
+
+	// Name of the pressed inputs by device, type & id, for their release to match when a release maps to several names ( axis back to 0 )
+	static std::map<std::tuple<int, int, int>, std::string> mPressed;
+};
+
+#endif // ES_CORE_INPUT_RECORDER_H
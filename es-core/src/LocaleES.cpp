@@ -1,11 +1,79 @@
 #include "LocaleES.h"
 #include <iostream>
+#include <fstream>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <string.h>
+#include <stdint.h>
 
 #define PACKAGE_LANG "emulationstation2"
 
+struct CStringHash
+{
+	size_t operator()(const char* value) const
+	{
+		// FNV-1a
+		size_t hash = (size_t)14695981039346656037ULL;
+		for (; *value != 0; value++)
+			hash = (hash ^ (unsigned char)*value) * (size_t)1099511628211ULL;
+
+		return hash;
+	}
+};
+
+struct CStringEqual
+{
+	bool operator()(const char* a, const char* b) const { return strcmp(a, b) == 0; }
+};
+
+// Translations of a language, found from the message itself : no std::string is built for the lookup.
+// Filled once, then published : a published table is never modified
+class TranslationTable
+{
+public:
+	const std::string* find(const char* key) const
+	{
+		auto it = mItems.find(key);
+		return it == mItems.cend() ? nullptr : &it->second;
+	}
+
+	void set(const char* key, const std::string& text)
+	{
+		auto it = mItems.find(key);
+		if (it != mItems.end())
+		{
+			it->second = text;
+			return;
+		}
+
+		mKeys.push_back(key);
+		mItems.emplace(mKeys.back().c_str(), text);
+	}
+
+private:
+	std::unordered_map<const char*, std::string, CStringHash, CStringEqual> mItems;
+	std::deque<std::string> mKeys; // Never moved by push_back
+};
+
+// Swapped as a whole on language changes : the threads translating meanwhile keep the table they loaded
+static std::shared_ptr<const TranslationTable> sTranslations = std::make_shared<TranslationTable>();
+
+static std::shared_ptr<const TranslationTable> getTranslations()
+{
+	return std::atomic_load(&sTranslations);
+}
+
+static void setTranslations(const std::shared_ptr<const TranslationTable>& table)
+{
+	std::atomic_store(&sTranslations, table);
+}
+
 #if !defined(WIN32)
 
 #include "SystemConf.h"
+#include "utils/StringUtil.h"
 
 #ifndef HAVE_INTL
 const char* ngettext(const char* msgid, const char* msgid_plural, unsigned long int n)
@@ -21,6 +89,138 @@ const char* pgettext(const char* context, const char* msgid) {
 #endif
 
 std::string EsLocale::default_LANGUAGE = "";
+std::string EsLocale::mCatalogPath = "";
+
+std::string EsLocale::getText(const char* msgid)
+{
+	auto translations = getTranslations();
+
+	const std::string* text = translations->find(msgid);
+	if (text != nullptr)
+		return *text;
+
+#ifdef HAVE_INTL
+	// Catalogs the table doesn't know how to find ( other domain path, LANGUAGE forms... ) are still honored
+	return gettext(msgid);
+#else
+	return msgid;
+#endif
+}
+
+// GNU .mo catalog : header, then the offset & length of each msgid, and of each translation
+static bool loadMoFile(const std::string& path, TranslationTable& table)
+{
+	std::ifstream stream(path, std::ios::binary | std::ios::ate);
+	if (!stream.is_open())
+		return false;
+
+	size_t size = (size_t)stream.tellg();
+	if (size < 28)
+		return false;
+
+	std::vector<char> data(size);
+	stream.seekg(0);
+	if (!stream.read(data.data(), size))
+		return false;
+
+	uint32_t magic;
+	memcpy(&magic, data.data(), 4);
+
+	bool swap = (magic == 0xde120495);
+	if (!swap && magic != 0x950412de)
+		return false;
+
+	auto read32 = [&data, swap](uint64_t offset)
+	{
+		uint32_t value;
+		memcpy(&value, data.data() + offset, 4);
+		if (swap)
+			value = (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+
+		return value;
+	};
+
+	uint64_t count = read32(8);
+	uint64_t originals = read32(12);
+	uint64_t translations = read32(16);
+
+	if (originals + count * 8 > size || translations + count * 8 > size)
+		return false;
+
+	for (uint64_t i = 0; i < count; i++)
+	{
+		uint64_t idLength = read32(originals + i * 8);
+		uint64_t idOffset = read32(originals + i * 8 + 4);
+		uint64_t textLength = read32(translations + i * 8);
+		uint64_t textOffset = read32(translations + i * 8 + 4);
+
+		// Both are followed by a '\0'
+		if (idOffset + idLength >= size || textOffset + textLength >= size)
+			continue;
+
+		const char* msgid = data.data() + idOffset;
+		const char* text = data.data() + textOffset;
+
+		// The header, and the entries with a context ( "context\4msgid" ), are not looked up by _()
+		if (idLength == 0 || textLength == 0 || memchr(msgid, '\4', idLength) != nullptr)
+			continue;
+
+		// Plural entries : the singular form ( "msgid\0msgid_plural" ) gets the first translation
+		table.set(msgid, std::string(text, strnlen(text, textLength)));
+	}
+
+	return true;
+}
+
+// Same search as gettext : each language of LANGUAGE, then the LC_MESSAGES locale, with and without their codeset & territory
+void EsLocale::loadCatalog()
+{
+	auto table = std::make_shared<TranslationTable>();
+
+	if (mCatalogPath.empty())
+	{
+		setTranslations(table);
+		return;
+	}
+
+	std::string languages;
+
+	const char* env = getenv("LANGUAGE");
+	if (env != NULL)
+		languages = env;
+
+	const char* messages = setlocale(LC_MESSAGES, NULL);
+	if (messages != NULL)
+		languages += std::string(":") + messages;
+
+	for (auto language : Utils::String::split(languages, ':', true))
+	{
+		if (language == "C" || language == "POSIX")
+			continue;
+
+		std::vector<std::string> names = { language };
+
+		auto end = language.find_first_of(".@");
+		if (end != std::string::npos)
+			names.push_back(language.substr(0, end));
+
+		end = language.find('_');
+		if (end != std::string::npos)
+			names.push_back(language.substr(0, end));
+
+		for (auto name : names)
+		{
+			std::string path = mCatalogPath + "/" + name + "/LC_MESSAGES/" + PACKAGE_LANG + ".mo";
+			if (loadMoFile(path, *table))
+			{
+				setTranslations(table);
+				return;
+			}
+		}
+	}
+
+	setTranslations(table);
+}
 
 std::string EsLocale::changeLocale(const std::string& locale) {
 	char *clocale = NULL;
@@ -40,6 +240,10 @@ std::string EsLocale::changeLocale(const std::string& locale) {
 		return "";
 	}
 
+#ifdef HAVE_INTL
+	loadCatalog();
+#endif
+
 	return clocale;
 }
 
@@ -73,6 +277,10 @@ std::string EsLocale::init(std::string locale, std::string path) {
 		return locale;
 	}
 
+	// _() looks the messages up in its own table first, ngettext & pgettext go through gettext
+	mCatalogPath = path;
+	loadCatalog();
+
 	return nlocale;
 
 #endif
@@ -95,7 +303,6 @@ const bool EsLocale::isRTL()
 #include "SystemConf.h"
 #include <fstream>
 
-std::map<std::string, std::string> EsLocale::mItems;
 std::string EsLocale::mCurrentLanguage = "en_US";
 bool EsLocale::mCurrentLanguageLoaded = true; // By default, 'en' is considered loaded
 
@@ -128,33 +335,33 @@ PluralRule rules[] = {
 PluralRule EsLocale::mPluralRule = rules[0];
 const std::vector<PluralRule> pluralRules(rules, rules + sizeof(rules) / sizeof(rules[0]));
 
-const std::string EsLocale::getText(const std::string& text)
+std::string EsLocale::getText(const char* text)
 {
 	checkLocalisationLoaded();
 
-	auto item = mItems.find(text);
-	if (item != mItems.cend())
-		return item->second;
+	auto translations = getTranslations();
+
+	const std::string* item = translations->find(text);
+	if (item != nullptr)
+		return *item;
 
 	return text;
 }
 
-const std::string EsLocale::getTextWithContext(const std::string& context, const std::string& text)
+std::string EsLocale::getTextWithContext(const std::string& context, const std::string& text)
 {
 	checkLocalisationLoaded();
 
-	auto item = mItems.find(context + "|" + text);
-	if (item != mItems.cend())
-		return item->second;
+	auto translations = getTranslations();
 
-	item = mItems.find(text);
-	if (item != mItems.cend())
-		return item->second;
+	const std::string* item = translations->find((context + "|" + text).c_str());
+	if (item != nullptr)
+		return *item;
 
-	return text;
+	return getText(text);
 }
 
-const std::string EsLocale::nGetText(const std::string msgid, const std::string msgid_plural, int n)
+std::string EsLocale::nGetText(const std::string& msgid, const std::string& msgid_plural, int n)
 {
 	if (mCurrentLanguage.empty() || mCurrentLanguage == "en_US") // English default
 		return n != 1 ? msgid_plural : msgid;
@@ -168,15 +375,13 @@ const std::string EsLocale::nGetText(const std::string msgid, const std::string
 	if (pluralId == 0)
 		return getText(msgid);
 
-	auto item = mItems.find(std::to_string(pluralId) + "@" + msgid_plural);
-	if (item != mItems.cend())
-		return item->second;
+	auto translations = getTranslations();
 
-	item = mItems.find(msgid_plural);
-	if (item != mItems.cend())
-		return item->second;
+	const std::string* item = translations->find((std::to_string(pluralId) + "@" + msgid_plural).c_str());
+	if (item != nullptr)
+		return *item;
 
-	return msgid_plural;
+	return getText(msgid_plural);
 }
 
 const bool EsLocale::isRTL()
@@ -201,7 +406,8 @@ void EsLocale::checkLocalisationLoaded()
 	mCurrentLanguageLoaded = true;
 
 	mPluralRule = rules[0];
-	mItems.clear();
+
+	auto translations = std::make_shared<TranslationTable>();
 
 	for (auto file : { "es-features.po", "emulationstation2.po" })
 	{
@@ -402,26 +608,28 @@ void EsLocale::checkLocalisationLoaded()
 				{
 					if (idx.empty() || idx == "0")
 					{
-						if (mItems.find(msgid) == mItems.cend() || msgctxt.empty())
-							mItems[msgid] = msgstr;
+						if (translations->find(msgid.c_str()) == nullptr || msgctxt.empty())
+							translations->set(msgid.c_str(), msgstr);
 					}
 				}
 
 				if (!msgctxt.empty() && !msgstr.empty())
-					mItems[msgctxt + "|" + msgid] = msgstr;
+					translations->set((msgctxt + "|" + msgid).c_str(), msgstr);
 
 				if (!msgid_plural.empty() && !msgstr.empty())
 				{
 					if (!idx.empty() && idx != "0")
-						mItems[idx + "@" + msgid_plural] = msgstr;
+						translations->set((idx + "@" + msgid_plural).c_str(), msgstr);
 					else
-						mItems[msgid_plural] = msgstr;
+						translations->set(msgid_plural.c_str(), msgstr);
 				}
 
 				msgctxt = "";
 			}
 		}
 	}
+
+	setTranslations(translations);
 }
 
 #endif
@@ -10,18 +10,16 @@
 
 #define ENABLE_NLS 1
 #include "gettext.h"
-#define _(A) std::string(gettext(A))
 
 #else
 
-#define _(A) std::string(A)
-
 const char* ngettext(const char* msgid, const char* msgid_plural, unsigned long int n);
 const char* pgettext(const char* context, const char* msgid);
 
 #endif
 
 #define _U(x) x
+#define _(A) EsLocale::getText(A)
 
 class EsLocale
 {
@@ -29,15 +27,22 @@ public:
 	static std::string init(std::string locale, std::string path);
 	static std::string changeLocale(const std::string& locale);
 
+	// Hashed lookup in the catalog of the language, then gettext for the messages it doesn't have. Thread safe
+	static std::string getText(const char* msgid);
+	static std::string getText(const std::string& msgid) { return getText(msgid.c_str()); }
+
 	static const bool isRTL();
 private:
+	static void loadCatalog();
+
 	static std::string default_LANGUAGE;
+	static std::string mCatalogPath;
 };
 
 #else // WIN32
 
 #include <string>
-#include <map>
+#include <unordered_map>
 #include <functional>
 #include "utils/StringUtil.h"
 
@@ -53,9 +58,11 @@ struct PluralRule
 class EsLocale
 {
 public:
-	static const std::string getText(const std::string& text);
-	static const std::string getTextWithContext(const std::string& context, const std::string& text);
-	static const std::string nGetText(const std::string msgid, const std::string msgid_plural, int n);
+	// Hashed lookup in the catalog of the language. Thread safe
+	static std::string getText(const char* text);
+	static std::string getText(const std::string& text) { return getText(text.c_str()); }
+	static std::string getTextWithContext(const std::string& context, const std::string& text);
+	static std::string nGetText(const std::string& msgid, const std::string& msgid_plural, int n);
 
 	static const std::string getLanguage() { return mCurrentLanguage; }
 
@@ -65,7 +72,6 @@ public:
 
 private:
 	static void checkLocalisationLoaded();
-	static std::map<std::string, std::string> mItems;
 	static std::string mCurrentLanguage;
 	static bool mCurrentLanguageLoaded;
 
@@ -4,19 +4,179 @@
 #include "utils/Platform.h"
 #include <iostream>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <ctime>
+#include <cstring>
 #include "Settings.h"
 #include <iomanip> 
+#include <algorithm>
+#include <chrono>
 #include <SDL_timer.h>
 #include "Paths.h"
+#include "Trace.h"
 
 #if WIN32
 #include <Windows.h>
 #endif
 
-static std::mutex mLogLock;
+// Per thread : a burst of the loading threads fits, the writer drains it in the background
+#define LOG_RING_SIZE			(64 * 1024)
+
+// Without Log::flush calls, the writer still empties the rings this often
+#define LOG_WRITER_INTERVAL_MS	1000
+
+// Single producer ( its thread ), single consumer ( the writer, under mWriteLock ).
+// Records are a LogRecord header then the text, wrapping around the end of the buffer
+class LogRing
+{
+public:
+	LogRing() : head(0), tail(0), dropped(0), orphan(false) { }
+
+	bool push(const std::string& text, bool console);
+
+	template<class F> void drain(F write);
+
+	bool isHalfFull() { return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed) > LOG_RING_SIZE / 2; }
+
+	std::atomic<size_t> head; // Written by the producer
+	std::atomic<size_t> tail; // Written by the consumer
+	std::atomic<uint64_t> dropped;
+	std::atomic<bool> orphan; // Its thread has exited : removed once empty
+
+private:
+	void copyIn(size_t pos, const void* src, size_t size);
+	void copyOut(size_t pos, void* dst, size_t size);
+
+	char mData[LOG_RING_SIZE];
+};
+
+struct LogRecord
+{
+	uint32_t length;
+	uint32_t console;
+};
+
+void LogRing::copyIn(size_t pos, const void* src, size_t size)
+{
+	size_t offset = pos % LOG_RING_SIZE;
+	size_t first = std::min(size, (size_t)LOG_RING_SIZE - offset);
+
+	memcpy(mData + offset, src, first);
+	if (first < size)
+		memcpy(mData, (const char*)src + first, size - first);
+}
+
+void LogRing::copyOut(size_t pos, void* dst, size_t size)
+{
+	size_t offset = pos % LOG_RING_SIZE;
+	size_t first = std::min(size, (size_t)LOG_RING_SIZE - offset);
+
+	memcpy(dst, mData + offset, first);
+	if (first < size)
+		memcpy((char*)dst + first, mData, size - first);
+}
+
+bool LogRing::push(const std::string& text, bool console)
+{
+	size_t h = head.load(std::memory_order_relaxed);
+	size_t t = tail.load(std::memory_order_acquire);
+
+	LogRecord record;
+	record.length = (uint32_t)text.size();
+	record.console = console ? 1 : 0;
+
+	size_t size = sizeof(LogRecord) + text.size();
+	if (size > LOG_RING_SIZE - (h - t))
+	{
+		dropped++;
+		return false;
+	}
+
+	copyIn(h, &record, sizeof(LogRecord));
+	copyIn(h + sizeof(LogRecord), text.data(), text.size());
+
+	head.store(h + size, std::memory_order_release);
+	return true;
+}
+
+template<class F> void LogRing::drain(F write)
+{
+	size_t t = tail.load(std::memory_order_relaxed);
+	size_t h = head.load(std::memory_order_acquire);
+
+	std::string text;
+
+	while (t < h)
+	{
+		LogRecord record;
+		copyOut(t, &record, sizeof(LogRecord));
+
+		text.resize(record.length);
+		if (record.length > 0)
+			copyOut(t + sizeof(LogRecord), &text[0], record.length);
+
+		t += sizeof(LogRecord) + record.length;
+		tail.store(t, std::memory_order_release);
+
+		write(text, record.console != 0);
+	}
+}
+
+static std::mutex mRingsLock;
+static std::vector<std::shared_ptr<LogRing>> mRings;
+
+// Serializes the consumers of the rings & the file
+static std::mutex mWriteLock;
+
+static std::mutex mWriterLock;
+static std::condition_variable mWriterEvent;
+static std::thread* mWriter = nullptr;
+static bool mWriterExit = false;
+
+// Trivial thread locals : still usable while the thread exits
+static thread_local LogRing* mThreadRing = nullptr; // Owned by mRings
+static thread_local bool mThreadExited = false;
+
+// Formatting the date is the slow part of a message : once per second
+static thread_local time_t mThreadSecond = -1;
+static thread_local char mThreadTimestamp[32];
+
+struct LogThreadGuard
+{
+	~LogThreadGuard()
+	{
+		if (mThreadRing != nullptr)
+			mThreadRing->orphan = true;
+
+		mThreadRing = nullptr;
+		mThreadExited = true;
+	}
+};
+
+static thread_local LogThreadGuard mThreadGuard;
+
+static void writeText(const std::string& text, bool console, FILE* file)
+{
+	if (file != NULL)
+		fwrite(text.data(), 1, text.size(), file);
+
+	// Errors also go to the console, everything with --debug
+	if (console)
+	{
+#if WIN32
+		OutputDebugStringA(text.c_str());
+#else
+		fprintf(stderr, "%s", text.c_str());
+#endif
+	}
+}
 
 LogLevel Log::mReportingLevel = (LogLevel) -1;
-bool     Log::mDirty          = false;
+std::atomic<bool> Log::mDirty(false);
+std::atomic<uint64_t> Log::mDropped(0);
 FILE*    Log::mFile           = NULL;
 
 void Log::init()
@@ -56,20 +216,40 @@ void Log::init()
 	Utils::FileSystem::removeFile(bakPath);
 	Utils::FileSystem::renameFile(logPath, bakPath);
 
-	bool locked = mLogLock.try_lock();
+	{
+		std::unique_lock<std::mutex> lock(mWriteLock);
+		mFile = fopen(logPath.c_str(), "w");
+		mDirty = false;
+	}
 
-	mFile = fopen(logPath.c_str(), "w");
-	mDirty = false;
-	mReportingLevel = lvl;
+	if (mFile == NULL)
+		return;
 
-	if (locked)
-		mLogLock.unlock();
+	{
+		std::unique_lock<std::mutex> lock(mWriterLock);
+		mWriterExit = false;
+		mWriter = new std::thread(&Log::writerThread);
+	}
+
+	mReportingLevel = lvl;
 }
 
 std::ostringstream& Log::get(LogLevel level)
 {
 	time_t t = time(nullptr);
-	mStream << std::put_time(localtime(&t), "%F %T\t");
+	if (t != mThreadSecond)
+	{
+		struct tm local;
+#if WIN32
+		localtime_s(&local, &t);
+#else
+		localtime_r(&t, &local);
+#endif
+		strftime(mThreadTimestamp, sizeof(mThreadTimestamp), "%F %T\t", &local);
+		mThreadSecond = t;
+	}
+
+	mStream << mThreadTimestamp;
 
 	switch (level)
 	{
@@ -92,24 +272,106 @@ std::ostringstream& Log::get(LogLevel level)
 	return mStream;
 }
 
-void Log::flush()
+void Log::writerThread()
 {
-	if (!mDirty)
-		return;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mWriterLock);
+			mWriterEvent.wait_for(lock, std::chrono::milliseconds(LOG_WRITER_INTERVAL_MS), []() { return mWriterExit || mDirty; });
+
+			if (mWriterExit)
+				break;
+		}
+
+		writePending();
+	}
+}
+
+// Empties the rings in the file. The order is kept per thread, not between threads
+void Log::writePending()
+{
+	std::unique_lock<std::mutex> lock(mWriteLock);
+
+	mDirty = false;
+
+	std::vector<std::shared_ptr<LogRing>> rings;
 
-	if (mLogLock.try_lock())
 	{
-		if (mFile != nullptr)
-			fflush(mFile);
+		std::unique_lock<std::mutex> ringsLock(mRingsLock);
+		rings = mRings;
+	}
 
-		mDirty = false;
-		mLogLock.unlock();
+	auto write = [](const std::string& text, bool console) { writeText(text, console, mFile); };
+
+	bool written = false;
+
+	for (auto& ring : rings)
+	{
+		if (ring->head != ring->tail)
+		{
+			ring->drain(write);
+			written = true;
+		}
+
+		uint64_t dropped = ring->dropped.exchange(0);
+		if (dropped > 0)
+		{
+			mDropped += dropped;
+			write("Log : " + std::to_string(dropped) + " messages dropped, the writer is late\n", true);
+			written = true;
+		}
+	}
+
+	if (written && mFile != NULL)
+		fflush(mFile);
+
+	// Rings of the exited threads : empty now, nobody can push anymore
+	std::unique_lock<std::mutex> ringsLock(mRingsLock);
+	for (auto it = mRings.begin(); it != mRings.end(); )
+	{
+		if ((*it)->orphan && (*it)->head == (*it)->tail)
+			it = mRings.erase(it);
+		else
+			++it;
 	}
 }
 
+void Log::flush(bool synchronous)
+{
+	if (synchronous)
+	{
+		writePending();
+		return;
+	}
+
+	if (!mDirty)
+		return;
+
+	std::unique_lock<std::mutex> lock(mWriterLock);
+	mWriterEvent.notify_one();
+}
+
 void Log::close()
 {
-	bool locked = mLogLock.try_lock();
+	std::thread* writer = nullptr;
+
+	{
+		std::unique_lock<std::mutex> lock(mWriterLock);
+		mWriterExit = true;
+		std::swap(writer, mWriter);
+		mWriterEvent.notify_one();
+	}
+
+	if (writer != nullptr)
+	{
+		writer->join();
+		delete writer;
+	}
+
+	writePending();
+
+	std::unique_lock<std::mutex> lock(mWriteLock);
 
 	if (mFile != NULL)
 	{
@@ -119,35 +381,44 @@ void Log::close()
 	}
 
 	mDirty = false;
-	
-	if (locked)
-		mLogLock.unlock();
 }
 
 Log::~Log()
 {
-	bool locked = mLogLock.try_lock();
+	mStream << std::endl;
 
-	if (mFile != NULL)
+	bool console = (mMessageLevel == LogError || mReportingLevel >= LogDebug);
+	std::string text = mStream.str();
+
+	// Larger than a ring, or from an exiting thread : written by the caller
+	if (mThreadExited || text.size() + sizeof(LogRecord) > LOG_RING_SIZE / 2)
 	{
-		mStream << std::endl;
-		fprintf(mFile, "%s", mStream.str().c_str());
-		mDirty = true;
+		std::unique_lock<std::mutex> lock(mWriteLock);
+		writeText(text, console, mFile);
+		return;
 	}
-	
-	// If it's an error, also print to console
-	// print all messages if using --debug
-	if (mMessageLevel == LogError || mReportingLevel >= LogDebug)
+
+	if (mThreadRing == nullptr)
 	{
-#if WIN32
-		OutputDebugStringA(mStream.str().c_str());
-#else
-		fprintf(stderr, "%s", mStream.str().c_str());
-#endif
+		auto ring = std::make_shared<LogRing>();
+
+		{
+			std::unique_lock<std::mutex> lock(mRingsLock);
+			mRings.push_back(ring);
+		}
+
+		mThreadRing = ring.get();
+		(void)&mThreadGuard; // Marks the ring orphan when the thread exits
 	}
 
-	if (locked)
-		mLogLock.unlock();
+	if (!mThreadRing->push(text, console))
+		return;
+
+	mDirty = true;
+
+	// A burst : the writer doesn't wait for the next flush
+	if (mThreadRing->isHalfFull())
+		mWriterEvent.notify_one();
 }
 
 StopWatch::StopWatch(const std::string& elapsedMillisecondsMessage, LogLevel level)
@@ -155,10 +426,14 @@ StopWatch::StopWatch(const std::string& elapsedMillisecondsMessage, LogLevel lev
 	mMessage = elapsedMillisecondsMessage; 
 	mLevel = level;
 	mStartTicks = SDL_GetTicks();
+	mTraceStart = Trace::enabled() ? Trace::now() : -1;
 }
 
 StopWatch::~StopWatch()
 {
 	int elapsed = SDL_GetTicks() - mStartTicks;
 	LOG(mLevel) << mMessage << " " << elapsed << "ms";
+
+	if (mTraceStart >= 0)
+		Trace::addSpan(mMessage, "", mTraceStart, Trace::now());
 }
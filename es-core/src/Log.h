@@ -4,15 +4,25 @@
 
 #include <sstream>
 #include <exception>
+#include <atomic>
+#include <cstdint>
 	
-#define LOG(level) if(!Log::enabled() || level > Log::getReportingLevel()) ; else Log().get(level)
+
+// Levels above LOG_MAX_LEVEL are compiled out ( cmake -DLOG_MAX_LEVEL=info makes LOG(LogDebug) a no-op )
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL 3
+#endif
+
+#define LOG(level) if((int)(level) > LOG_MAX_LEVEL || !Log::enabled() || level > Log::getReportingLevel()) ; else Log().get(level)
 
 #define TRYCATCH(m, x) { try { x; } \
-catch (const std::exception& e) { LOG(LogError) << m << " Exception " << e.what(); Log::flush(); throw e; } \
-catch (...) { LOG(LogError) << m << " Unknown Exception occured"; Log::flush(); throw; } }
+catch (const std::exception& e) { LOG(LogError) << m << " Exception " << e.what(); Log::flush(true); throw e; } \
+catch (...) { LOG(LogError) << m << " Unknown Exception occured"; Log::flush(true); throw; } }
 
 enum LogLevel { LogError, LogWarning, LogInfo, LogDebug };
 
+// Messages go to a ring buffer of the calling thread and a background thread writes them : logging never waits for the file.
+// A full ring drops the message, the count goes to the log & /metrics
 class Log
 {
 public:
@@ -23,12 +33,19 @@ public:
 	static inline bool enabled() { return mFile != NULL; }
 
 	static void init();
-	static void flush();
+	// Wakes the writer up. Synchronous, the messages are in the file on return
+	static void flush(bool synchronous = false);
 	static void close();
+
+	static uint64_t getDroppedCount() { return mDropped; }
 	
 private:
+	static void writerThread();
+	static void writePending();
+
 	static LogLevel     mReportingLevel;
-	static bool         mDirty;
+	static std::atomic<bool> mDirty;
+	static std::atomic<uint64_t> mDropped;
 	static FILE*        mFile;
 
 protected:
@@ -46,6 +63,7 @@ private:
 	std::string mMessage;
 	LogLevel    mLevel;
 	int         mStartTicks;
+	long long   mTraceStart; // also recorded as a Trace span when tracing
 };
 
 #endif // ES_CORE_LOG_H
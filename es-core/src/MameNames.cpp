@@ -2,13 +2,24 @@
 
 #include "resources/ResourceManager.h"
 #include "utils/FileSystemUtil.h"
+#include "utils/BinaryStream.h"
+#include "Paths.h"
 #include "Log.h"
 #include <pugixml/src/pugixml.hpp>
 #include "utils/StringUtil.h"
 #include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <unordered_map>
 
-MameNames* MameNames::sInstance = nullptr;
+#define MAMENAMES_CACHE_MAGIC	0x4E4D4145 // 'EAMN'
+#define MAMENAMES_CACHE_END		0x444E4545 // 'EEND'
+#define MAMENAMES_CACHE_VERSION	"1" // Increase when the layout changes
+
+static const char* sResources[] = { ":/mamenames.xml", ":/mamebioses.xml", ":/mamedevices.xml", ":/gungames.xml", ":/wheelgames.xml" };
 
+MameNames* MameNames::sInstance = nullptr;
 void MameNames::init()
 {
 	if(!sInstance)
@@ -35,18 +46,166 @@ MameNames* MameNames::getInstance()
 
 } // getInstance
 
-MameNames::MameNames()
+// FNV-1a, the seed selects one of the hash functions
+uint32_t MameNames::hash(uint32_t seed, const char* data, size_t length)
+{
+	uint32_t h = 0x811C9DC5 ^ (seed * 0x9E3779B1);
+	for (size_t i = 0; i < length; i++)
+	{
+		h ^= (unsigned char)data[i];
+		h *= 16777619;
+	}
+
+	return h;
+}
+
+// The resources in use, with their size & date
+std::string MameNames::getCacheKey()
+{
+	std::string key = MAMENAMES_CACHE_VERSION;
+
+	for (auto resource : sResources)
+	{
+		std::string path = ResourceManager::getInstance()->getResourcePath(resource);
+		key += "|" + path;
+
+		if (Utils::FileSystem::exists(path))
+			key += "|" + std::to_string(Utils::FileSystem::getFileSize(path)) + "|" + std::to_string((long long)Utils::FileSystem::getFileModificationDate(path).getTime());
+	}
+
+	return key;
+}
+
+static void readSystemGames(const std::string& xmlpath, std::map<std::string, std::unordered_set<std::string>>& systemGames)
+{
+	if (!Utils::FileSystem::exists(xmlpath))
+		return;
+
+	pugi::xml_document doc;
+	pugi::xml_parse_result result = doc.load_file(WINSTRINGW(xmlpath).c_str());
+	if (!result)
+	{
+		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
+		return;
+	}
+
+	pugi::xml_node systems = doc.child("systems");
+	if (!systems)
+	{
+		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\" <systems> root is missing !";
+		return;
+	}
+
+	LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
+
+	for (pugi::xml_node systemNode = systems.child("system"); systemNode; systemNode = systemNode.next_sibling("system"))
+	{
+		if (!systemNode.attribute("name"))
+			continue;
+
+		std::string systemNames = systemNode.attribute("name").value();
+		for (auto systemName : Utils::String::split(systemNames, ','))
+		{
+			std::unordered_set<std::string> games;
+
+			for (pugi::xml_node gameNode = systemNode.child("game"); gameNode; gameNode = gameNode.next_sibling("game"))
+			{
+				std::string device = gameNode.text().get();
+				if (!device.empty())
+					games.insert(device);
+			}
+
+			if (games.size())
+				systemGames[Utils::String::trim(systemName)] = games;
+		}
+	}
+}
+
+static void readNameList(const std::string& xmlpath, const char* rootName, const char* nodeName, const std::function<void(const std::string&)>& add)
 {
-	std::string xmlpath;
+	if (!Utils::FileSystem::exists(xmlpath))
+		return;
 
 	pugi::xml_document doc;
-	pugi::xml_parse_result result;
+	pugi::xml_parse_result result = doc.load_file(WINSTRINGW(xmlpath).c_str());
+	if (!result)
+	{
+		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
+		return;
+	}
+
+	LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
+
+	pugi::xml_node root = doc;
+
+	pugi::xml_node list = doc.child(rootName);
+	if (list)
+		root = list;
+
+	for (pugi::xml_node node = root.child(nodeName); node; node = node.next_sibling(nodeName))
+		add(node.text().get());
+}
+
+static void writeSystemGames(Utils::BinaryWriter& writer, const std::map<std::string, std::unordered_set<std::string>>& systemGames)
+{
+	writer.writeUInt32((uint32_t)systemGames.size());
+	for (auto& system : systemGames)
+	{
+		writer.writeString(system.first);
+		writer.writeUInt32((uint32_t)system.second.size());
+		for (auto& game : system.second)
+			writer.writeString(game);
+	}
+}
+
+static void readSystemGames(Utils::BinaryReader& reader, std::map<std::string, std::unordered_set<std::string>>& systemGames)
+{
+	uint32_t count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		std::unordered_set<std::string>& games = systemGames[reader.readString()];
+
+		uint32_t gameCount = reader.readUInt32();
+		for (uint32_t g = 0; g < gameCount && !reader.failed(); g++)
+			games.insert(reader.readString());
+	}
+}
+
+static void writePadding(Utils::BinaryWriter& writer)
+{
+	while (writer.size() % 4)
+		writer.writeUInt8(0);
+}
+
+// Parses the xml resources, and lays the names out in a hash & displace table ( CHD ) : the bucket of a name stores the seed of the hash giving its slot,
+// or the slot itself ( as -slot - 1 ) for the buckets of a single name
+std::string MameNames::buildCache(const std::string& key)
+{
+	std::vector<std::string> names;
+	std::vector<std::string> realNames;
+	std::vector<uint8_t> flags;
+	std::unordered_map<std::string, uint32_t> indexes;
+
+	auto getIndex = [&](const std::string& name)
+	{
+		auto it = indexes.find(name);
+		if (it != indexes.cend())
+			return it->second;
+
+		uint32_t index = (uint32_t)names.size();
+		indexes[name] = index;
+		names.push_back(name);
+		realNames.push_back(std::string());
+		flags.push_back(0);
+		return index;
+	};
 
 	// Read mame games information
-	xmlpath = ResourceManager::getInstance()->getResourcePath(":/mamenames.xml");
+	std::string xmlpath = ResourceManager::getInstance()->getResourcePath(":/mamenames.xml");
 	if (Utils::FileSystem::exists(xmlpath))
-	{		
-		result = doc.load_file(WINSTRINGW(xmlpath).c_str());
+	{
+		pugi::xml_document doc;
+		pugi::xml_parse_result result = doc.load_file(WINSTRINGW(xmlpath).c_str());
 		if (result)
 		{
 			LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
@@ -60,156 +219,200 @@ MameNames::MameNames()
 			std::string sTrue = "true";
 			for (pugi::xml_node gameNode = root.child("game"); gameNode; gameNode = gameNode.next_sibling("game"))
 			{
-				NamePair namePair = { gameNode.child("mamename").text().get(), gameNode.child("realname").text().get() };
-				mNamePairs.push_back(namePair);
+				uint32_t index = getIndex(gameNode.child("mamename").text().get());
+
+				// The first one wins, as with the sorted list
+				if (flags[index] & REALNAME)
+					continue;
+
+				realNames[index] = gameNode.child("realname").text().get();
+				flags[index] |= REALNAME;
 
 				if (gameNode.attribute("vert") && gameNode.attribute("vert").value() == sTrue)
-					mVerticalGames.insert(namePair.mameName);
+					flags[index] |= VERTICAL;
 
 				if (gameNode.attribute("gun") && gameNode.attribute("gun").value() == sTrue)
-					mArcadeLightGunGames.insert(namePair.mameName);
+					flags[index] |= LIGHTGUN;
 
 				if (gameNode.attribute("wheel") && gameNode.attribute("wheel").value() == sTrue)
-					mArcadeWheelGames.insert(namePair.mameName);
+					flags[index] |= WHEEL;
 			}
 		}
 		else
 			LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
 	}
-	
-	// Read bios
-	xmlpath = ResourceManager::getInstance()->getResourcePath(":/mamebioses.xml"); 	
-	if (Utils::FileSystem::exists(xmlpath))
-	{
-		result = doc.load_file(WINSTRINGW(xmlpath).c_str());
-		if (result)
-		{
-			LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
 
-			pugi::xml_node root = doc;
+	readNameList(ResourceManager::getInstance()->getResourcePath(":/mamebioses.xml"), "bioses", "bios", [&](const std::string& name) { flags[getIndex(name)] |= BIOS; });
+	readNameList(ResourceManager::getInstance()->getResourcePath(":/mamedevices.xml"), "devices", "device", [&](const std::string& name) { flags[getIndex(name)] |= DEVICE; });
 
-			pugi::xml_node bioses = doc.child("bioses");
-			if (bioses)
-				root = bioses;
+	std::map<std::string, std::unordered_set<std::string>> gunGames;
+	std::map<std::string, std::unordered_set<std::string>> wheelGames;
 
-			for (pugi::xml_node biosNode = root.child("bios"); biosNode; biosNode = biosNode.next_sibling("bios"))
-			{
-				std::string bios = biosNode.text().get();
-				mMameBioses.insert(bios);
-			}
-		}
-		else
-			LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
+	readSystemGames(ResourceManager::getInstance()->getResourcePath(":/gungames.xml"), gunGames);
+	readSystemGames(ResourceManager::getInstance()->getResourcePath(":/wheelgames.xml"), wheelGames);
 
-	}
-	
-	// Read devices
-	xmlpath = ResourceManager::getInstance()->getResourcePath(":/mamedevices.xml"); 	
-	if (Utils::FileSystem::exists(xmlpath))
-	{
-		result = doc.load_file(WINSTRINGW(xmlpath).c_str());
-		if (result)
-		{
-			LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
+	// Perfect hash
+	uint32_t count = (uint32_t)names.size();
+	uint32_t bucketCount = std::max(1u, count);
 
-			pugi::xml_node root = doc;
+	std::vector<std::vector<uint32_t>> buckets(bucketCount);
+	for (uint32_t i = 0; i < count; i++)
+		buckets[hash(0, names[i].data(), names[i].size()) % bucketCount].push_back(i);
 
-			pugi::xml_node devices = doc.child("devices");
-			if (devices)
-				root = devices;
+	std::vector<uint32_t> order(bucketCount);
+	for (uint32_t i = 0; i < bucketCount; i++)
+		order[i] = i;
 
-			for (pugi::xml_node deviceNode = root.child("device"); deviceNode; deviceNode = deviceNode.next_sibling("device"))
-			{
-				std::string device = deviceNode.text().get();
-				mMameDevices.insert(device);
-			}
-		}
-		else 
-			LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
-	}
+	// The largest buckets are placed first, while most slots are free
+	std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
 
-	// Read gun games for non arcade systems
-	xmlpath = ResourceManager::getInstance()->getResourcePath(":/gungames.xml");
-	if (Utils::FileSystem::exists(xmlpath))
+	std::vector<int32_t> displacements(bucketCount, 0);
+	std::vector<int32_t> slots(count, -1);
+	std::vector<uint32_t> bucketSlots;
+
+	size_t pos = 0;
+	for (; pos < order.size() && buckets[order[pos]].size() > 1; pos++)
 	{
-		result = doc.load_file(WINSTRINGW(xmlpath).c_str());
-		if (result)
+		auto& bucket = buckets[order[pos]];
+
+		for (uint32_t seed = 1; ; seed++)
 		{
-			pugi::xml_node systems = doc.child("systems");
-			if (systems)
-			{
-				LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
+			bucketSlots.clear();
 
-				for (pugi::xml_node systemNode = systems.child("system"); systemNode; systemNode = systemNode.next_sibling("system"))
+			bool placed = true;
+			for (auto index : bucket)
+			{
+				uint32_t slot = hash(seed, names[index].data(), names[index].size()) % count;
+				if (slots[slot] >= 0 || std::find(bucketSlots.cbegin(), bucketSlots.cend(), slot) != bucketSlots.cend())
 				{
-					if (!systemNode.attribute("name"))
-						continue;
-
-					std::string systemNames = systemNode.attribute("name").value();
-					for (auto systemName : Utils::String::split(systemNames, ','))
-					{
-						std::unordered_set<std::string> games;
-
-						for (pugi::xml_node gameNode = systemNode.child("game"); gameNode; gameNode = gameNode.next_sibling("game"))
-						{
-							std::string device = gameNode.text().get();
-							if (!device.empty())
-								games.insert(device);
-						}
-
-						if (games.size())
-							mNonArcadeGunGames[Utils::String::trim(systemName)] = games;
-					}	
+					placed = false;
+					break;
 				}
+
+				bucketSlots.push_back(slot);
 			}
-			else 
-				LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\" <systems> root is missing !";
+
+			if (!placed)
+				continue;
+
+			for (size_t i = 0; i < bucket.size(); i++)
+				slots[bucketSlots[i]] = (int32_t)bucket[i];
+
+			displacements[order[pos]] = (int32_t)seed;
+			break;
 		}
-		else
-			LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
 	}
 
-	// Read wheel games
-	xmlpath = ResourceManager::getInstance()->getResourcePath(":/wheelgames.xml");
-	if (Utils::FileSystem::exists(xmlpath))
+	uint32_t freeSlot = 0;
+	for (; pos < order.size() && buckets[order[pos]].size() == 1; pos++)
 	{
-		result = doc.load_file(WINSTRINGW(xmlpath).c_str());
-		if (result)
-		{
-			pugi::xml_node systems = doc.child("systems");
-			if (systems)
-			{
-				LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
+		while (slots[freeSlot] >= 0)
+			freeSlot++;
 
-				for (pugi::xml_node systemNode = systems.child("system"); systemNode; systemNode = systemNode.next_sibling("system"))
-				{
-					if (!systemNode.attribute("name"))
-						continue;
-
-					std::string systemNames = systemNode.attribute("name").value();
-					for (auto systemName : Utils::String::split(systemNames, ','))
-					{
-						std::unordered_set<std::string> games;
-
-						for (pugi::xml_node gameNode = systemNode.child("game"); gameNode; gameNode = gameNode.next_sibling("game"))
-						{
-							std::string device = gameNode.text().get();
-							if (!device.empty())
-								games.insert(device);
-						}
-
-						if (games.size())
-							mNonArcadeWheelGames[Utils::String::trim(systemName)] = games;
-					}	
-				}
-			}
-			else 
-				LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\" <systems> root is missing !";
-		}
-		else
-			LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
+		slots[freeSlot] = (int32_t)buckets[order[pos]][0];
+		displacements[order[pos]] = -(int32_t)freeSlot - 1;
+	}
+
+	// Entries & string pool
+	std::string strings;
+	std::vector<Entry> entries(count);
+
+	for (uint32_t slot = 0; slot < count; slot++)
+	{
+		uint32_t index = (uint32_t)slots[slot];
+
+		Entry& entry = entries[slot];
+		memset(&entry, 0, sizeof(Entry));
+
+		entry.name = (uint32_t)strings.size();
+		entry.nameLength = (uint16_t)std::min(names[index].size(), (size_t)0xFFFF);
+		strings.append(names[index], 0, entry.nameLength);
+
+		entry.realName = (uint32_t)strings.size();
+		entry.realNameLength = (uint16_t)std::min(realNames[index].size(), (size_t)0xFFFF);
+		strings.append(realNames[index], 0, entry.realNameLength);
+
+		entry.flags = flags[index];
 	}
 
+	Utils::BinaryWriter writer;
+	writer.writeUInt32(MAMENAMES_CACHE_MAGIC);
+	writer.writeString(key);
+	writePadding(writer);
+
+	writer.writeUInt32(count);
+	writer.writeUInt32(bucketCount);
+	writer.writeUInt32((uint32_t)strings.size());
+	writer.write(displacements.data(), displacements.size() * sizeof(int32_t));
+	writer.write(entries.data(), entries.size() * sizeof(Entry));
+	writer.write(strings.data(), strings.size());
+
+	writeSystemGames(writer, gunGames);
+	writeSystemGames(writer, wheelGames);
+
+	writer.writeUInt32(MAMENAMES_CACHE_END);
+	return writer.buffer();
+}
+
+bool MameNames::attach(const unsigned char* data, size_t size, const std::string& key)
+{
+	Utils::BinaryReader reader(data, size);
+	if (reader.readUInt32() != MAMENAMES_CACHE_MAGIC || reader.readString() != key)
+		return false;
+
+	size_t padding = (4 - (size - reader.remaining()) % 4) % 4;
+	reader.readRaw(padding);
+
+	uint32_t count = reader.readUInt32();
+	uint32_t bucketCount = reader.readUInt32();
+	uint32_t stringsSize = reader.readUInt32();
+
+	if (reader.failed() || bucketCount == 0)
+		return false;
+
+	mDisplacements = (const int32_t*)reader.readRaw((size_t)bucketCount * sizeof(int32_t));
+	mEntries = (const Entry*)reader.readRaw((size_t)count * sizeof(Entry));
+	mStrings = (const char*)reader.readRaw(stringsSize);
+
+	mNonArcadeGunGames.clear();
+	mNonArcadeWheelGames.clear();
+
+	readSystemGames(reader, mNonArcadeGunGames);
+	readSystemGames(reader, mNonArcadeWheelGames);
+
+	if (reader.failed() || reader.readUInt32() != MAMENAMES_CACHE_END)
+	{
+		mCount = 0;
+		return false;
+	}
+
+	mCount = count;
+	mBucketCount = bucketCount;
+	return true;
+}
+
+MameNames::MameNames() : mCount(0), mBucketCount(0), mDisplacements(nullptr), mEntries(nullptr), mStrings(nullptr)
+{
+	std::string key = getCacheKey();
+	std::string cachePath = Paths::getUserEmulationStationPath() + "/cache/mamenames.cache";
+
+	if (mFile.open(cachePath) && attach(mFile.data(), mFile.size(), key))
+		return;
+
+	mFile.close();
+	mBuffer = buildCache(key);
+
+	if (Utils::FileSystem::writeFileAtomic(cachePath, mBuffer.data(), mBuffer.size()) && mFile.open(cachePath) && attach(mFile.data(), mFile.size(), key))
+	{
+		std::string().swap(mBuffer);
+		return;
+	}
+	else
+		LOG(LogWarning) << "MameNames : Unable to write " << cachePath;
+
+	mFile.close();
+	attach((const unsigned char*)mBuffer.data(), mBuffer.size(), key);
+
 } // MameNames
 
 MameNames::~MameNames()
@@ -217,38 +420,52 @@ MameNames::~MameNames()
 
 } // ~MameNames
 
-std::string MameNames::getRealName(const std::string& _mameName)
+const MameNames::Entry* MameNames::find(const std::string& name) const
 {
-	size_t start = 0;
-	size_t end   = mNamePairs.size();
+	if (mCount == 0)
+		return nullptr;
 
-	while(start < end)
-	{
-		const size_t index   = (start + end) / 2;
-		const int    compare = strcmp(mNamePairs[index].mameName.c_str(), _mameName.c_str());
+	int32_t displacement = mDisplacements[hash(0, name.data(), name.size()) % mBucketCount];
+	uint32_t slot = displacement < 0 ? (uint32_t)(-displacement - 1) : hash((uint32_t)displacement, name.data(), name.size()) % mCount;
+	if (slot >= mCount)
+		return nullptr;
 
-		if(compare < 0)       start = index + 1;
-		else if( compare > 0) end   = index;
-		else                  return mNamePairs[index].realName;
-	}
+	const Entry* entry = &mEntries[slot];
+	if (entry->nameLength != name.size() || memcmp(mStrings + entry->name, name.data(), name.size()) != 0)
+		return nullptr;
+
+	return entry;
+}
+
+const bool MameNames::hasFlag(const std::string& name, uint8_t flag) const
+{
+	const Entry* entry = find(name);
+	return entry != nullptr && (entry->flags & flag) != 0;
+}
+
+std::string MameNames::getRealName(const std::string& _mameName)
+{
+	const Entry* entry = find(_mameName);
+	if (entry == nullptr || (entry->flags & REALNAME) == 0)
+		return _mameName;
 
-	return _mameName;
+	return std::string(mStrings + entry->realName, entry->realNameLength);
 
 } // getRealName
 
 const bool MameNames::isBios(const std::string& _biosName)
 {
-	return (mMameBioses.find(_biosName) != mMameBioses.cend());
+	return hasFlag(_biosName, BIOS);
 } // isBios
 
 const bool MameNames::isDevice(const std::string& _deviceName)
 {
-	return (mMameDevices.find(_deviceName) != mMameDevices.cend());
+	return hasFlag(_deviceName, DEVICE);
 } // isDevice
 
 const bool MameNames::isVertical(const std::string& _nameName)
 {
-	return (mVerticalGames.find(_nameName) != mVerticalGames.cend());
+	return hasFlag(_nameName, VERTICAL);
 }
 
 static std::string getIndexedName(const std::string& name)
@@ -274,7 +491,7 @@ static std::string getIndexedName(const std::string& name)
 const bool MameNames::isLightgun(const std::string& _nameName, const std::string& systemName, bool isArcade)
 {
 	if (isArcade)
-		return mArcadeLightGunGames.find(_nameName) != mArcadeLightGunGames.cend();
+		return hasFlag(_nameName, LIGHTGUN);
 
 	auto it = mNonArcadeGunGames.find(systemName);
 	if (it == mNonArcadeGunGames.cend())
@@ -297,7 +514,7 @@ const bool MameNames::isLightgun(const std::string& _nameName, const std::string
 const bool MameNames::isWheel(const std::string& _nameName, const std::string& systemName, bool isArcade)
 {
 	if (isArcade)
-		return mArcadeWheelGames.find(_nameName) != mArcadeWheelGames.cend();
+		return hasFlag(_nameName, WHEEL);
 
 	auto it = mNonArcadeWheelGames.find(systemName);
 	if (it == mNonArcadeWheelGames.cend())
@@ -2,13 +2,18 @@
 #ifndef ES_CORE_MAMENAMES_H
 #define ES_CORE_MAMENAMES_H
 
+#include "utils/MemoryMappedFile.h"
+
 #include <string>
 #include <vector>
 #include <unordered_set>
 #include <map>
+#include <cstdint>
 
 class SystemData;
 
+// Arcade names, bios, devices & flags, compiled from the xml resources into a memory-mapped cache on the first run ( and when the resources change ).
+// The names are found with a minimal perfect hash : one probe, and no parsing at boot
 class MameNames
 {
 public:
@@ -25,26 +30,48 @@ public:
 
 private:
 
-	struct NamePair
+	enum Flags : uint8_t
 	{
-		std::string mameName;
-		std::string realName;
+		REALNAME = 1,
+		BIOS = 2,
+		DEVICE = 4,
+		VERTICAL = 8,
+		LIGHTGUN = 16,
+		WHEEL = 32
 	};
 
-	typedef std::vector<NamePair> namePairVector;
+	// 16 bytes, offsets in the string pool
+	struct Entry
+	{
+		uint32_t name;
+		uint32_t realName;
+		uint16_t nameLength;
+		uint16_t realNameLength;
+		uint8_t  flags;
+		uint8_t  padding[3];
+	};
 
 	 MameNames();
 	~MameNames();
 
 	static MameNames* sInstance;
 
-	namePairVector mNamePairs;
+	static std::string getCacheKey();
+	static std::string buildCache(const std::string& key);
+	static uint32_t hash(uint32_t seed, const char* data, size_t length);
+
+	bool attach(const unsigned char* data, size_t size, const std::string& key);
+	const Entry* find(const std::string& name) const;
+	const bool hasFlag(const std::string& name, uint8_t flag) const;
+
+	Utils::MemoryMappedFile mFile;
+	std::string				mBuffer; // The cache could not be written
 
-	std::unordered_set<std::string> mMameBioses;
-	std::unordered_set<std::string> mMameDevices;
-	std::unordered_set<std::string> mVerticalGames;
-	std::unordered_set<std::string> mArcadeLightGunGames;
-	std::unordered_set<std::string> mArcadeWheelGames;
+	uint32_t		mCount;
+	uint32_t		mBucketCount;
+	const int32_t*	mDisplacements;
+	const Entry*	mEntries;
+	const char*		mStrings;
 
 	std::map<std::string, std::unordered_set<std::string>> mNonArcadeGunGames;
   	std::map<std::string, std::unordered_set<std::string>> mNonArcadeWheelGames;
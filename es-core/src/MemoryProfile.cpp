@@ -0,0 +1,114 @@
+#include "MemoryProfile.h"
+
+#include "utils/Platform.h"
+#include "ImageIO.h"
+#include "Settings.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cstring>
+
+#define LOW_MEMORY_THRESHOLD	(1536LL * 1024 * 1024)	// 1GB boards report less than their nominal size
+
+#define PRESSURE_INTERVAL_MS	2000
+#define PRESSURE_HIGH			10.0f	// % of the last 10 seconds some tasks waited for memory
+#define PRESSURE_LOW			2.0f
+
+#define LOW_MEMORY_IMAGE_SCALE	0.75f
+#define GLYPH_ATLAS_WIDTH		2048
+#define LOW_MEMORY_GLYPH_ATLAS_WIDTH	1024
+
+bool MemoryProfile::mLowMemory = false;
+bool MemoryProfile::mUnderPressure = false;
+bool MemoryProfile::mPressureAvailable = false;
+int MemoryProfile::mElapsed = 0;
+
+void MemoryProfile::init()
+{
+	std::string mode = Settings::getInstance()->getString("LowMemoryMode");
+
+	size_t totalMemory = Utils::Platform::getTotalMemory();
+
+	if (mode == "on")
+		mLowMemory = true;
+	else if (mode == "off")
+		mLowMemory = false;
+	else
+		mLowMemory = totalMemory > 0 && (long long)totalMemory < LOW_MEMORY_THRESHOLD;
+
+	mUnderPressure = false;
+	mPressureAvailable = mode != "off" && readPressure() >= 0;
+	mElapsed = 0;
+
+	if (mLowMemory)
+		LOG(LogInfo) << "MemoryProfile : low-memory profile enabled (" << (totalMemory / 1024 / 1024) << " MB of RAM)";
+}
+
+float MemoryProfile::readPressure()
+{
+#if WIN32
+	return -1;
+#else
+	FILE* file = fopen("/proc/pressure/memory", "r");
+	if (file == nullptr)
+		return -1;
+
+	// some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+	float avg10 = -1;
+	if (fscanf(file, "some avg10=%f", &avg10) != 1)
+		avg10 = -1;
+
+	fclose(file);
+	return avg10;
+#endif
+}
+
+void MemoryProfile::update(int deltaTime)
+{
+	if (!mPressureAvailable)
+		return;
+
+	mElapsed += deltaTime;
+	if (mElapsed < PRESSURE_INTERVAL_MS)
+		return;
+
+	mElapsed = 0;
+
+	float pressure = readPressure();
+	if (pressure < 0)
+		return;
+
+	if (!mUnderPressure && pressure >= PRESSURE_HIGH)
+	{
+		mUnderPressure = true;
+		LOG(LogWarning) << "MemoryProfile : memory pressure " << pressure << "%, switching to the low-memory profile";
+	}
+	else if (mUnderPressure && pressure < PRESSURE_LOW)
+	{
+		mUnderPressure = false;
+		LOG(LogInfo) << "MemoryProfile : memory pressure back to " << pressure << "%";
+	}
+}
+
+// Halved : the evictions of TextureDataManager bring the textures down at the next loads
+size_t MemoryProfile::getTextureBudget()
+{
+	size_t budget = (size_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
+	return isLowMemory() ? budget / 2 : budget;
+}
+
+int MemoryProfile::getGlyphAtlasWidth()
+{
+	return isLowMemory() ? LOW_MEMORY_GLYPH_ATLAS_WIDTH : GLYPH_ATLAS_WIDTH;
+}
+
+MaxSizeInfo MemoryProfile::getMaxSize(MaxSizeInfo maxSize)
+{
+	if (!isLowMemory() || maxSize.empty())
+		return maxSize;
+
+	if (maxSize.isExternalZoomKnown())
+		return MaxSizeInfo(maxSize.x() * LOW_MEMORY_IMAGE_SCALE, maxSize.y() * LOW_MEMORY_IMAGE_SCALE, maxSize.externalZoom());
+
+	return MaxSizeInfo(maxSize.x() * LOW_MEMORY_IMAGE_SCALE, maxSize.y() * LOW_MEMORY_IMAGE_SCALE);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#ifndef ES_CORE_MEMORY_PROFILE_H
+#define ES_CORE_MEMORY_PROFILE_H
+
+#include <cstddef>
+
+class MaxSizeInfo;
+
+// Low-memory profile, for the 1GB boards : a smaller texture budget, smaller images & glyph atlas pages, fewer cached gamelist views,
+// lazy metadata and no video previews in the grids. "LowMemoryMode" is "auto" ( on below LOW_MEMORY_THRESHOLD of physical RAM ), "on" or "off".
+// At runtime, the memory pressure ( PSI on Linux ) turns the profile on while the system stalls for memory. The metadata mode only applies at load
+class MemoryProfile
+{
+public:
+	static void init();
+
+	// Window::update : the pressure is read every few seconds
+	static void update(int deltaTime);
+
+	static bool isLowMemory() { return mLowMemory || mUnderPressure; }
+	static bool isUnderPressure() { return mUnderPressure; }
+
+	// "MaxVRAM", in bytes
+	static size_t getTextureBudget();
+	// Width of the new glyph atlas pages
+	static int getGlyphAtlasWidth();
+	// Size the images are loaded at
+	static MaxSizeInfo getMaxSize(MaxSizeInfo maxSize);
+
+private:
+	static float readPressure(); // "some avg10" of /proc/pressure/memory, -1 when unknown
+
+	static bool		mLowMemory;
+	static bool		mUnderPressure;
+	static bool		mPressureAvailable;
+	static int		mElapsed;
+};
+
+#endif // ES_CORE_MEMORY_PROFILE_H
@@ -0,0 +1,61 @@
+#include "MemoryStats.h"
+
+#include "utils/StringUtil.h"
+
+std::atomic<int64_t> MemoryStats::mUsage[MemoryStats::SUBSYSTEM_COUNT];
+std::atomic<int64_t> MemoryStats::mPeak[MemoryStats::SUBSYSTEM_COUNT];
+
+static const char* sSubsystemNames[MemoryStats::SUBSYSTEM_COUNT] = { "FileData", "Metadata", "Theme", "TextCache", "FilterIndex", "Sound" };
+
+const char* MemoryStats::getName(Subsystem subsystem)
+{
+	return sSubsystemNames[subsystem];
+}
+
+void MemoryStats::add(Subsystem subsystem, int64_t bytes)
+{
+	if (bytes == 0)
+		return;
+
+	int64_t usage = mUsage[subsystem].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	if (bytes > 0)
+		updatePeak(subsystem, usage);
+}
+
+void MemoryStats::set(Subsystem subsystem, int64_t bytes)
+{
+	mUsage[subsystem].store(bytes, std::memory_order_relaxed);
+	updatePeak(subsystem, bytes);
+}
+
+void MemoryStats::updatePeak(Subsystem subsystem, int64_t usage)
+{
+	int64_t peak = mPeak[subsystem].load(std::memory_order_relaxed);
+	while (usage > peak && !mPeak[subsystem].compare_exchange_weak(peak, usage, std::memory_order_relaxed))
+		;
+}
+
+int64_t MemoryStats::getUsage(Subsystem subsystem)
+{
+	return mUsage[subsystem].load(std::memory_order_relaxed);
+}
+
+int64_t MemoryStats::getPeak(Subsystem subsystem)
+{
+	return mPeak[subsystem].load(std::memory_order_relaxed);
+}
+
+std::string MemoryStats::getReport()
+{
+	std::string ret;
+
+	for (int i = 0; i < SUBSYSTEM_COUNT; i++)
+	{
+		if (!ret.empty())
+			ret += ", ";
+
+		ret += Utils::String::format("%s %.1fMB (max %.1fMB)", sSubsystemNames[i], getUsage((Subsystem)i) / 1000.0f / 1000.0f, getPeak((Subsystem)i) / 1000.0f / 1000.0f);
+	}
+
+	return ret;
+}
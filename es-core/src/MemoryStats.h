@@ -0,0 +1,73 @@
+#pragma once
+#ifndef ES_CORE_MEMORY_STATS_H
+#define ES_CORE_MEMORY_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// RAM used by the subsystems, besides the textures & fonts which have their own VRAM accounting.
+// The sizes are counted where the subsystems allocate ( payload & container storage, not the allocator overhead ), so reading them is cheap from any thread.
+// The high-water marks are kept since startup : logged after each reload, shown with DrawFramerate & exported through /metrics
+class MemoryStats
+{
+public:
+	enum Subsystem
+	{
+		FILE_DATA,		// Tree nodes, by FileDataArena chunk
+		METADATA,		// MetaDataList values
+		THEME,			// Shared theme elements, sampled
+		TEXT_CACHE,		// TextCache vertices
+		FILTER_INDEX,	// FileFilterIndex inverted & text indexes
+		SOUND,			// SoundBank files & decoded chunks, sampled
+
+		SUBSYSTEM_COUNT
+	};
+
+	static const char* getName(Subsystem subsystem);
+
+	// bytes is negative when freed
+	static void add(Subsystem subsystem, int64_t bytes);
+	// The subsystems that are sampled instead of counted
+	static void set(Subsystem subsystem, int64_t bytes);
+
+	static int64_t getUsage(Subsystem subsystem);
+	static int64_t getPeak(Subsystem subsystem);
+
+	// "FileData 12.3MB (max 12.3MB), Metadata ..."
+	static std::string getReport();
+
+private:
+	static void updatePeak(Subsystem subsystem, int64_t usage);
+
+	static std::atomic<int64_t> mUsage[SUBSYSTEM_COUNT];
+	static std::atomic<int64_t> mPeak[SUBSYSTEM_COUNT];
+};
+
+// Bytes counted in a subsystem for the lifetime of their owner. A copy starts empty : the copied storage is its own, counted by its next set()
+template<MemoryStats::Subsystem S>
+class MemoryCounter
+{
+public:
+	MemoryCounter() : mBytes(0) { }
+	MemoryCounter(const MemoryCounter&) : mBytes(0) { }
+	~MemoryCounter() { MemoryStats::add(S, -mBytes); }
+
+	MemoryCounter& operator=(const MemoryCounter&) { return *this; }
+
+	void set(int64_t bytes)
+	{
+		if (bytes != mBytes)
+			MemoryStats::add(S, bytes - mBytes);
+
+		mBytes = bytes;
+	}
+
+	void add(int64_t bytes) { set(mBytes + bytes); }
+	int64_t get() const { return mBytes; }
+
+private:
+	int64_t mBytes;
+};
+
+#endif // ES_CORE_MEMORY_STATS_H
@@ -51,9 +51,9 @@ int PowerSaver::getTimeout()
 void PowerSaver::loadWakeupTime()
 {
 	// TODO : Move this to Screensaver Class
-	std::string behaviour = Settings::getInstance()->getString("ScreenSaverBehavior");
+	std::string behaviour = Settings::get(StringSetting::ScreenSaverBehavior);
 	if (behaviour == "random video")
-		mWakeupTimeout = Settings::getInstance()->getInt("ScreenSaverSwapVideoTimeout") - getMode();
+		mWakeupTimeout = Settings::get(IntSetting::ScreenSaverSwapVideoTimeout) - getMode();
 	else if (behaviour == "slideshow")
 		mWakeupTimeout = Settings::getInstance()->getInt("ScreenSaverSwapImageTimeout") - getMode();
 	else // Dim and Blank
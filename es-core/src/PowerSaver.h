@@ -46,6 +46,9 @@ public:
 			setState(true); 
 	}
 
+	// True while something animating asked to pause
+	static bool isPaused() { return mPauseCounter > 0; }
+
 	static void lock(bool state)
 	{
 		if (state)
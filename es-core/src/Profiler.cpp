@@ -0,0 +1,275 @@
+#include "Profiler.h"
+
+#include "renderers/Renderer.h"
+#include "utils/StringUtil.h"
+#include "GuiComponent.h"
+#include "Log.h"
+#include "Paths.h"
+
+#include <SDL_timer.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <typeinfo>
+
+bool Profiler::mEnabled = false;
+bool Profiler::mFrameOpen = false;
+uint64_t Profiler::mFrameStart = 0;
+uint64_t Profiler::mRenderStart = 0;
+uint64_t Profiler::mUpdateTime = 0;
+
+std::map<std::string, Profiler::Entry> Profiler::mEntries;
+std::vector<std::string> Profiler::mPath;
+
+std::vector<Profiler::Frame> Profiler::mHistory;
+int64_t Profiler::mFrameCount = 0;
+int64_t Profiler::mOverlayFrame = 0;
+
+static float toMs(uint64_t ticks)
+{
+	return (float)((double)ticks * 1000.0 / (double)SDL_GetPerformanceFrequency());
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+	if (mEnabled == enabled)
+		return;
+
+	mEnabled = enabled;
+	mFrameOpen = false;
+	mEntries.clear();
+	mPath.clear();
+
+	if (mEnabled)
+	{
+		mHistory.resize(HISTORY_SIZE);
+		mFrameCount = 0;
+		mOverlayFrame = 0;
+	}
+	else
+	{
+		mHistory.clear();
+		mHistory.shrink_to_fit();
+	}
+}
+
+std::string Profiler::getComponentName(const GuiComponent* component)
+{
+	// Theme elements are tagged with their name
+	std::string tag = component->getTag();
+
+	std::string name = typeid(*component).name();
+
+	// Itanium ABI : <length><name>, MSVC : "class <name>"
+	if (Utils::String::startsWith(name, "class "))
+		name = name.substr(6);
+	else if (!name.empty() && name[0] >= '0' && name[0] <= '9')
+	{
+		size_t pos = 0;
+		size_t length = 0;
+		while (pos < name.size() && name[pos] >= '0' && name[pos] <= '9')
+			length = length * 10 + (name[pos++] - '0');
+
+		name = name.substr(pos, length);
+	}
+
+	if (!tag.empty())
+		name += " '" + tag + "'";
+
+	return name;
+}
+
+void Profiler::add(const std::string& name, Phase phase, uint64_t ticks)
+{
+	Entry& entry = mEntries[name];
+	if (phase == UPDATE)
+		entry.update += ticks;
+	else
+		entry.render += ticks;
+
+	entry.calls++;
+}
+
+void Profiler::beginFrame()
+{
+	if (!mEnabled)
+		return;
+
+	// The previous frame was not rendered
+	if (mFrameOpen)
+	{
+		beginRender();
+		endFrame();
+	}
+
+	mFrameOpen = true;
+	mFrameStart = SDL_GetPerformanceCounter();
+	mRenderStart = 0;
+	mUpdateTime = 0;
+	mEntries.clear();
+}
+
+void Profiler::beginRender()
+{
+	if (!mEnabled || !mFrameOpen)
+		return;
+
+	mRenderStart = SDL_GetPerformanceCounter();
+	mUpdateTime = mRenderStart - mFrameStart;
+
+	Renderer::beginGpuTimer();
+}
+
+void Profiler::endFrame()
+{
+	if (!mEnabled || !mFrameOpen)
+		return;
+
+	Renderer::endGpuTimer();
+
+	mFrameOpen = false;
+
+	Frame& frame = mHistory[mFrameCount % HISTORY_SIZE];
+	frame.updateTime = toMs(mUpdateTime);
+	frame.renderTime = mRenderStart != 0 ? toMs(SDL_GetPerformanceCounter() - mRenderStart) : 0;
+	frame.gpuTime = Renderer::getGpuTime();
+	frame.entries.assign(mEntries.cbegin(), mEntries.cend());
+
+	mFrameCount++;
+}
+
+std::string Profiler::getOverlayText()
+{
+	if (!mEnabled)
+		return "";
+
+	int64_t first = std::max(mOverlayFrame, mFrameCount - HISTORY_SIZE);
+	int count = (int)(mFrameCount - first);
+	mOverlayFrame = mFrameCount;
+
+	if (count <= 0)
+		return "";
+
+	float updateTime = 0;
+	float renderTime = 0;
+	float gpuTime = 0;
+	int gpuFrames = 0;
+
+	std::map<std::string, std::pair<float, float>> totals;
+
+	for (int64_t i = first; i < mFrameCount; i++)
+	{
+		const Frame& frame = mHistory[i % HISTORY_SIZE];
+
+		updateTime += frame.updateTime;
+		renderTime += frame.renderTime;
+
+		if (frame.gpuTime >= 0)
+		{
+			gpuTime += frame.gpuTime;
+			gpuFrames++;
+		}
+
+		for (auto& entry : frame.entries)
+		{
+			auto& total = totals[entry.first];
+			total.first += toMs(entry.second.update);
+			total.second += toMs(entry.second.render);
+		}
+	}
+
+	std::vector<std::pair<std::string, std::pair<float, float>>> sorted(totals.cbegin(), totals.cend());
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, std::pair<float, float>>& a, const std::pair<std::string, std::pair<float, float>>& b)
+	{
+		return a.second.first + a.second.second > b.second.first + b.second.second;
+	});
+
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(2);
+	ss << "Profiler (" << count << " frames, ms per frame)";
+	ss << "\nUpdate: " << updateTime / count << " Render: " << renderTime / count << " GPU: ";
+
+	if (gpuFrames > 0)
+		ss << gpuTime / gpuFrames;
+	else
+		ss << "n/a";
+
+	for (int i = 0; i < (int)sorted.size() && i < OVERLAY_ENTRIES; i++)
+		ss << "\n" << sorted[i].second.first / count << " / " << sorted[i].second.second / count << "  " << sorted[i].first;
+
+	return ss.str();
+}
+
+std::string Profiler::getExportPath()
+{
+	return Paths::getUserEmulationStationPath() + "/es_profile.csv";
+}
+
+bool Profiler::exportHistory()
+{
+	if (!mEnabled)
+		return false;
+
+	std::string path = getExportPath();
+
+	std::ofstream stream(WINSTRINGW(path), std::ios::binary | std::ios::trunc);
+	if (!stream.is_open())
+	{
+		LOG(LogError) << "Profiler : Unable to write " << path;
+		return false;
+	}
+
+	// One row with the totals of each frame, then one row per entry
+	stream << "frame,name,update_ms,render_ms,gpu_ms,calls\n";
+	stream << std::fixed << std::setprecision(3);
+
+	int64_t first = std::max((int64_t)0, mFrameCount - HISTORY_SIZE);
+	for (int64_t i = first; i < mFrameCount; i++)
+	{
+		const Frame& frame = mHistory[i % HISTORY_SIZE];
+
+		stream << i << ",\"(frame)\"," << frame.updateTime << "," << frame.renderTime << ",";
+		if (frame.gpuTime >= 0)
+			stream << frame.gpuTime;
+		stream << ",\n";
+
+		for (auto& entry : frame.entries)
+			stream << i << ",\"" << Utils::String::replace(entry.first, "\"", "\"\"") << "\"," << toMs(entry.second.update) << "," << toMs(entry.second.render) << ",," << entry.second.calls << "\n";
+	}
+
+	stream.close();
+
+	LOG(LogInfo) << "Profiler : " << (mFrameCount - first) << " frames written to " << path;
+	return true;
+}
+
+void ProfileScope::begin(const std::string& name, Profiler::Phase phase, bool component)
+{
+	mPhase = phase;
+	mComponent = component;
+
+	if (component)
+	{
+		mName = Profiler::mPath.empty() ? name : Profiler::mPath.back() + " > " + name;
+		Profiler::mPath.push_back(mName);
+	}
+	else
+		mName = name;
+
+	mStart = SDL_GetPerformanceCounter();
+}
+
+void ProfileScope::end()
+{
+	uint64_t ticks = SDL_GetPerformanceCounter() - mStart;
+
+	// The profiler may have been toggled inside the scope
+	if (!Profiler::mEnabled)
+		return;
+
+	if (mComponent && !Profiler::mPath.empty())
+		Profiler::mPath.pop_back();
+
+	Profiler::add(mName, mPhase, ticks);
+}
@@ -0,0 +1,110 @@
+#pragma once
+#ifndef ES_CORE_PROFILER_H
+#define ES_CORE_PROFILER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class GuiComponent;
+
+// Breaks each frame into the time spent in update & render by the top GuiComponent subtrees, posted functions, texture uploads,
+// and on the GPU when timer queries are available. Enabled with the "DrawProfiler" setting, which also shows the overlay.
+// The last HISTORY_SIZE frames can be exported as CSV
+class Profiler
+{
+public:
+	enum Phase { UPDATE = 0, RENDER = 1 };
+
+	static const int MAX_DEPTH = 3;			// Deeper subtrees are accounted to their ancestor
+	static const int HISTORY_SIZE = 600;
+	static const int OVERLAY_ENTRIES = 12;
+
+	static inline bool enabled() { return mEnabled; }
+	static void setEnabled(bool enabled);
+
+	// Called by Window at the start of update & render, and at the end of render
+	static void beginFrame();
+	static void beginRender();
+	static void endFrame();
+
+	// Averages since the previous call, as text for the overlay
+	static std::string getOverlayText();
+
+	static std::string getExportPath();
+	static bool exportHistory();
+
+private:
+	friend class ProfileScope;
+
+	struct Entry
+	{
+		Entry() : update(0), render(0), calls(0) { }
+
+		uint64_t	update;
+		uint64_t	render;
+		int			calls;
+	};
+
+	struct Frame
+	{
+		float		updateTime;	// ms
+		float		renderTime;
+		float		gpuTime;	// -1 when not available
+		std::vector<std::pair<std::string, Entry>> entries;
+	};
+
+	static std::string getComponentName(const GuiComponent* component);
+	static void add(const std::string& name, Phase phase, uint64_t ticks);
+
+	static bool							mEnabled;
+	static bool							mFrameOpen;
+	static uint64_t						mFrameStart;
+	static uint64_t						mRenderStart;
+	static uint64_t						mUpdateTime;
+
+	static std::map<std::string, Entry>	mEntries;		// Current frame
+	static std::vector<std::string>		mPath;			// Open component scopes
+
+	static std::vector<Frame>			mHistory;		// Ring buffer, indexed by frame number
+	static int64_t						mFrameCount;
+	static int64_t						mOverlayFrame;	// First frame not yet in the overlay
+};
+
+// Times the enclosing block. Component scopes nest, and are keyed by their path from the GUI stack
+class ProfileScope
+{
+public:
+	ProfileScope(const GuiComponent* component, Profiler::Phase phase)
+	{
+		mActive = Profiler::mEnabled && Profiler::mPath.size() < Profiler::MAX_DEPTH;
+		if (mActive)
+			begin(Profiler::getComponentName(component), phase, true);
+	}
+
+	ProfileScope(const char* name, Profiler::Phase phase)
+	{
+		mActive = Profiler::mEnabled;
+		if (mActive)
+			begin(name, phase, false);
+	}
+
+	~ProfileScope()
+	{
+		if (mActive)
+			end();
+	}
+
+private:
+	void begin(const std::string& name, Profiler::Phase phase, bool component);
+	void end();
+
+	bool			mActive;
+	bool			mComponent;
+	Profiler::Phase	mPhase;
+	std::string		mName;
+	uint64_t		mStart;
+};
+
+#endif // ES_CORE_PROFILER_H
@@ -5,10 +5,17 @@
 #include "utils/StringUtil.h"
 #include "utils/VectorEx.h"
 #include "Paths.h"
+#include "TaskScheduler.h"
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 #include <set>
 #include <map>
 
+// Past it, the oldest events are dropped : a stuck script directory must not grow the queue
+#define MAX_QUEUED_EVENTS	64
+
 using namespace Utils::Platform;
 
 namespace Scripting
@@ -41,8 +48,14 @@ namespace Scripting
             psi.run();
         };
 
-        std::thread runThread(runScript);
-        runThread.detach();
+        // The quit scripts outlive the scheduler, which is shut down before them
+        if (eventName == "quit")
+        {
+            std::thread runThread(runScript);
+            runThread.detach();
+        }
+        else
+            TaskScheduler::submit(TaskScheduler::BACKGROUND, runScript);
 #else            
         LOG(LogDebug) << "  executing: " << script;
 
@@ -56,10 +69,141 @@ namespace Scripting
 
     static std::set<std::string> _supportedExtensions = { ".exe", ".cmd", ".bat", ".ps1", ".sh", ".py" };
 
+    static EventListener _eventListener;
+    static std::mutex _eventListenerLock;
+
+    void setEventListener(const EventListener& listener)
+    {
+        std::unique_lock<std::mutex> lock(_eventListenerLock);
+        _eventListener = listener;
+    }
+
+    struct Event
+    {
+        std::string name;
+        std::string arg1;
+        std::string arg2;
+        std::string arg3;
+    };
+
+    static std::mutex _queueLock;
+    static std::condition_variable _queueEvent;
+    static std::deque<Event> _queue;
+    static std::thread* _dispatcher = nullptr;
+    static bool _dispatching = false;
+    static bool _stopped = false;
+
+    // Only the last one matters, a fast scroll fires one per item
+    static bool isCoalesced(const std::string& eventName)
+    {
+        return eventName == "game-selected" || eventName == "system-selected";
+    }
+
+    // Their scripts must have started before ES goes on : the emulator or the process exit follows
+    static bool isSynchronous(const std::string& eventName)
+    {
+        return eventName == "quit" || eventName == "reboot" || eventName == "shutdown" || eventName == "game-start" || eventName == "game-end";
+    }
+
+    static void runScripts(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3);
+
+    static void dispatch()
+    {
+        TaskScheduler::setCurrentThreadPriority(TaskScheduler::BACKGROUND);
+
+        std::unique_lock<std::mutex> lock(_queueLock);
+
+        while (true)
+        {
+            _queueEvent.wait(lock, []() { return _stopped || !_queue.empty(); });
+
+            if (_queue.empty())
+                break;
+
+            Event ev = _queue.front();
+            _queue.pop_front();
+            _dispatching = true;
+
+            lock.unlock();
+            runScripts(ev.name, ev.arg1, ev.arg2, ev.arg3);
+            lock.lock();
+
+            _dispatching = false;
+            _queueEvent.notify_all();
+        }
+    }
+
+    void stop()
+    {
+        std::thread* dispatcher = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(_queueLock);
+            _stopped = true;
+            std::swap(dispatcher, _dispatcher);
+            _queueEvent.notify_all();
+        }
+
+        if (dispatcher != nullptr)
+        {
+            dispatcher->join();
+            delete dispatcher;
+        }
+    }
+
     void fireEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
     {
         LOG(LogDebug) << "fireEvent: " << eventName << " " << arg1 << " " << arg2 << " " << arg3;
 
+        {
+            std::unique_lock<std::mutex> lock(_eventListenerLock);
+            if (_eventListener != nullptr)
+                _eventListener(eventName, arg1, arg2, arg3);
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(_queueLock);
+
+            if (isSynchronous(eventName) || _stopped)
+            {
+                // The queued events first, in their order
+                _queueEvent.wait(lock, []() { return _dispatcher == nullptr || (_queue.empty() && !_dispatching); });
+            }
+            else
+            {
+                if (isCoalesced(eventName))
+                {
+                    for (auto it = _queue.begin(); it != _queue.end(); ++it)
+                    {
+                        if (it->name == eventName)
+                        {
+                            _queue.erase(it);
+                            break;
+                        }
+                    }
+                }
+
+                if (_queue.size() >= MAX_QUEUED_EVENTS)
+                {
+                    LOG(LogWarning) << "fireEvent: too many queued events, dropping " << _queue.front().name;
+                    _queue.pop_front();
+                }
+
+                _queue.push_back(Event { eventName, arg1, arg2, arg3 });
+
+                if (_dispatcher == nullptr)
+                    _dispatcher = new std::thread(&dispatch);
+
+                _queueEvent.notify_all();
+                return;
+            }
+        }
+
+        runScripts(eventName, arg1, arg2, arg3);
+    }
+
+    static void runScripts(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
+    {
         // Process splitted paths scripts
         std::vector<std::string> scriptDirList =
         {
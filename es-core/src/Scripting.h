@@ -3,10 +3,21 @@
 #define ES_CORE_SCRIPTING_H
 
 #include <string>
+#include <functional>
 
 namespace Scripting
 {
+	// The scripts run in order on a dispatcher thread : the caller doesn't wait for their lookup & start.
+	// A queued "game-selected" or "system-selected" is replaced by the newer one. "quit", "reboot", "shutdown", "game-start" & "game-end"
+	// wait for the queued events, then start their scripts before returning
 	void fireEvent(const std::string& eventName, const std::string& arg1="", const std::string& arg2="", const std::string& arg3="");
+
+	// Runs the queued events & joins the dispatcher. The next events run synchronously
+	void stop();
+
+	// In-process observer of the events, called from the thread that fires them. Pass nullptr to remove it
+	typedef std::function<void(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)> EventListener;
+	void setEventListener(const EventListener& listener);
 } // Scripting::
 
 #endif //ES_CORE_SCRIPTING_H
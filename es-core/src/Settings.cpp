@@ -7,57 +7,103 @@
 #include <pugixml/src/pugixml.hpp>
 #include <algorithm>
 #include <vector>
+#include <mutex>
 #include "utils/StringUtil.h"
 #include "Paths.h"
+#include "ConfigWriter.h"
+#include <sstream>
 
 Settings* Settings::sInstance = NULL;
 static std::string mEmptyString = "";
 Delegate<ISettingsChangedEvent> Settings::settingChanged;
 
-IMPLEMENT_STATIC_BOOL_SETTING(DebugText, false)
-IMPLEMENT_STATIC_BOOL_SETTING(DebugImage, false)
-IMPLEMENT_STATIC_BOOL_SETTING(DebugGrid, false)
-IMPLEMENT_STATIC_BOOL_SETTING(DebugMouse, false)
-IMPLEMENT_STATIC_BOOL_SETTING(ShowControllerActivity, true)
-IMPLEMENT_STATIC_BOOL_SETTING(ShowControllerBattery, true)
-IMPLEMENT_STATIC_BOOL_SETTING(DrawClock, true)
-IMPLEMENT_STATIC_BOOL_SETTING(ClockMode12, false)
-IMPLEMENT_STATIC_BOOL_SETTING(DrawFramerate, false)
-IMPLEMENT_STATIC_BOOL_SETTING(VolumePopup, true)
-IMPLEMENT_STATIC_BOOL_SETTING(BackgroundMusic, true)
-IMPLEMENT_STATIC_BOOL_SETTING(VSync, true)
-IMPLEMENT_STATIC_BOOL_SETTING(PreloadMedias, false)
-IMPLEMENT_STATIC_BOOL_SETTING(IgnoreLeadingArticles, false)
-IMPLEMENT_STATIC_BOOL_SETTING(ShowFoldersFirst, true)
-IMPLEMENT_STATIC_BOOL_SETTING(ScrollLoadMedias, false)
-IMPLEMENT_STATIC_INT_SETTING(ScreenSaverTime, 5 * 60 * 1000)
+bool Settings::mBoolSlots[(int)BoolSetting::Count];
+int Settings::mIntSlots[(int)IntSetting::Count];
+std::string Settings::mStringSlots[(int)StringSetting::Count];
+unsigned int Settings::mGeneration = 0;
 
-#if WIN32
-IMPLEMENT_STATIC_BOOL_SETTING(ShowNetworkIndicator, false)
-#else
-IMPLEMENT_STATIC_BOOL_SETTING(ShowNetworkIndicator, true)
-#endif
+static std::mutex mStringSlotsLock;
+
+#define SETTINGS_REGISTRY_NAME(ID, NAME) NAME,
+
+static const char* sBoolSettingNames[] = { BOOL_SETTINGS_REGISTRY(SETTINGS_REGISTRY_NAME) };
+static const char* sIntSettingNames[] = { INT_SETTINGS_REGISTRY(SETTINGS_REGISTRY_NAME) };
+static const char* sStringSettingNames[] = { STRING_SETTINGS_REGISTRY(SETTINGS_REGISTRY_NAME) };
+
+const char* Settings::getName(BoolSetting id) { return sBoolSettingNames[(int)id]; }
+const char* Settings::getName(IntSetting id) { return sIntSettingNames[(int)id]; }
+const char* Settings::getName(StringSetting id) { return sStringSettingNames[(int)id]; }
+
+std::string Settings::get(StringSetting id)
+{
+	std::unique_lock<std::mutex> lock(mStringSlotsLock);
+	return mStringSlots[(int)id];
+}
+
+struct SettingSlot
+{
+	char type; // b, i or s
+	int index;
+};
+
+// Only the setters look names up
+static const std::map<std::string, SettingSlot>& getSettingSlots()
+{
+	static std::map<std::string, SettingSlot> slots;
+
+	if (slots.empty())
+	{
+		for (int i = 0; i < (int)BoolSetting::Count; i++)
+			slots[sBoolSettingNames[i]] = { 'b', i };
+		for (int i = 0; i < (int)IntSetting::Count; i++)
+			slots[sIntSettingNames[i]] = { 'i', i };
+		for (int i = 0; i < (int)StringSetting::Count; i++)
+			slots[sStringSettingNames[i]] = { 's', i };
+	}
+
+	return slots;
+}
+
+void Settings::loadSlots()
+{
+	for (int i = 0; i < (int)BoolSetting::Count; i++)
+		mBoolSlots[i] = getBool(sBoolSettingNames[i]);
+	for (int i = 0; i < (int)IntSetting::Count; i++)
+		mIntSlots[i] = getInt(sIntSettingNames[i]);
+	for (int i = 0; i < (int)StringSetting::Count; i++)
+	{
+		std::string value = getString(sStringSettingNames[i]);
+
+		std::unique_lock<std::mutex> lock(mStringSlotsLock);
+		mStringSlots[i] = value;
+	}
+
+	mGeneration++;
+}
 
 void Settings::updateCachedSetting(const std::string& name)
 {
-	UPDATE_STATIC_BOOL_SETTING_EX("audio.bgmusic", BackgroundMusic)
-	UPDATE_STATIC_BOOL_SETTING(DebugText)
-	UPDATE_STATIC_BOOL_SETTING(DebugImage)
-	UPDATE_STATIC_BOOL_SETTING(DebugGrid)
-	UPDATE_STATIC_BOOL_SETTING(DebugMouse)
-	UPDATE_STATIC_BOOL_SETTING(ShowControllerActivity)
-	UPDATE_STATIC_BOOL_SETTING(ShowControllerBattery)
-	UPDATE_STATIC_BOOL_SETTING(ShowNetworkIndicator)
-	UPDATE_STATIC_BOOL_SETTING(DrawClock)
-	UPDATE_STATIC_BOOL_SETTING(ClockMode12)
-	UPDATE_STATIC_BOOL_SETTING(DrawFramerate)
-	UPDATE_STATIC_BOOL_SETTING(ScrollLoadMedias)
-	UPDATE_STATIC_BOOL_SETTING(VolumePopup)
-	UPDATE_STATIC_BOOL_SETTING(VSync)
-	UPDATE_STATIC_BOOL_SETTING(PreloadMedias)
-	UPDATE_STATIC_BOOL_SETTING(IgnoreLeadingArticles)		
-	UPDATE_STATIC_BOOL_SETTING(ShowFoldersFirst)
-	UPDATE_STATIC_INT_SETTING(ScreenSaverTime)
+	auto& slots = getSettingSlots();
+
+	auto it = slots.find(name);
+	if (it != slots.cend())
+	{
+		switch (it->second.type)
+		{
+		case 'b': mBoolSlots[it->second.index] = getBool(name); break;
+		case 'i': mIntSlots[it->second.index] = getInt(name); break;
+		case 's':
+			{
+				std::string value = getString(name);
+
+				std::unique_lock<std::mutex> lock(mStringSlotsLock);
+				mStringSlots[it->second.index] = value;
+			}
+			break;
+		}
+	}
+
+	mGeneration++;
 
 	if (mLoaded)
 		settingChanged.invoke([name](ISettingsChangedEvent* c) { c->onSettingChanged(name); });
@@ -118,8 +164,8 @@ void Settings::setDefaults()
 	mBoolMap["ParseGamelistOnly"] = false;
 	mBoolMap["ShowHiddenFiles"] = false;
 	mBoolMap["ShowParentFolder"] = true;
-	mBoolMap["IgnoreLeadingArticles"] = Settings::_IgnoreLeadingArticles;
-	mBoolMap["ShowFoldersFirst"] = Settings::_ShowFoldersFirst;
+	mBoolMap["IgnoreLeadingArticles"] = false;
+	mBoolMap["ShowFoldersFirst"] = true;
 	mBoolMap["DrawFramerate"] = false;
 	mBoolMap["ScrollLoadMedias"] = false;	
 	mBoolMap["ShowExit"] = true;
@@ -140,14 +186,15 @@ void Settings::setDefaults()
 	mBoolMap["FullscreenBorderless"] = false;
 #endif
 	mBoolMap["TTS"] = false;
+	mBoolMap["TTSPresynthesis"] = false;
 
 	mIntMap["MonitorID"] = -1;
 
     mBoolMap["UseOSK"] = true; // on screen keyboard
-    mBoolMap["DrawClock"] = Settings::_DrawClock;
-	mBoolMap["ClockMode12"] = Settings::_ClockMode12;	
-	mBoolMap["ShowControllerActivity"] = Settings::_ShowControllerActivity;
-	mBoolMap["ShowControllerBattery"] = Settings::_ShowControllerBattery;
+    mBoolMap["DrawClock"] = true;
+	mBoolMap["ClockMode12"] = false;	
+	mBoolMap["ShowControllerActivity"] = true;
+	mBoolMap["ShowControllerBattery"] = true;
     mIntMap["SystemVolume"] = 95;
     mBoolMap["Overscan"] = false;
     mStringMap["Language"] = "en_US";
@@ -158,7 +205,7 @@ void Settings::setDefaults()
     mStringMap["INPUT P5"] = "DEFAULT";
     mStringMap["Overclock"] = "none";
 
-	mBoolMap["VSync"] = Settings::_VSync;
+	mBoolMap["VSync"] = true;
 	mStringMap["FolderViewMode"] = "never";
 	mStringMap["HiddenSystems"] = "";
 
@@ -175,8 +222,36 @@ void Settings::setDefaults()
 	mStringMap["ShowBattery"] = "text";
 	mBoolMap["CheckBiosesAtLaunch"] = true;
 	mBoolMap["RemoveMultiDiskContent"] = true;
+	mBoolMap["GamelistCache"] = true;
+	mBoolMap["IncrementalRomScan"] = true;
+	mBoolMap["HashCache"] = true;
+	mStringMap["SharedCatalogPath"] = "";
+	mStringMap["SharedCatalogMode"] = ""; // "publish" or "use"
+	mBoolMap["LazyMetadata"] = false;
+	mBoolMap["StartupTrace"] = false;
+	mBoolMap["ThemeCache"] = true;
+	mBoolMap["TextureDiskCache"] = false;
+	mIntMap["WebImageCacheSize"] = 64; // MB
+	mBoolMap["TextureAtlas"] = true;
+	mBoolMap["RendererBatching"] = true;
+	mBoolMap["IdleFrameSkip"] = true;
+	mStringMap["FrameRate"] = "auto";
+	mBoolMap["DrawProfiler"] = false;
+	mBoolMap["InputLatencyStats"] = false;
+	mBoolMap["InputLatencyGpuSync"] = false;
+	mBoolMap["TaskAffinity"] = true;
+	mBoolMap["ShaderCache"] = true;
+	mBoolMap["GlyphCache"] = true;
+	mBoolMap["AsyncGlyphs"] = true;
+	mBoolMap["PrecomputeBidi"] = false;
+	mBoolMap["FontDistanceField"] = false;
+	mBoolMap["PrefetchGameMedias"] = true;
 
-	mBoolMap["ShowNetworkIndicator"] = Settings::_ShowNetworkIndicator;
+#if WIN32
+	mBoolMap["ShowNetworkIndicator"] = false;
+#else
+	mBoolMap["ShowNetworkIndicator"] = true;
+#endif
 
 	mBoolMap["Debug"] = false;
 
@@ -187,9 +262,15 @@ void Settings::setDefaults()
 	
 	mIntMap["RecentlyScrappedFilter"] = 3;
 	
-	mIntMap["ScreenSaverTime"] = Settings::_ScreenSaverTime;
+	mIntMap["ScreenSaverTime"] = 5 * 60 * 1000;
 	mIntMap["ScraperResizeWidth"] = 640;
 	mIntMap["ScraperResizeHeight"] = 0;
+	mIntMap["ScraperCacheDays"] = 7;
+	mIntMap["ScraperMediaDownloads"] = 4;
+	mIntMap["ScraperMediaPerHost"] = 2;
+	mIntMap["ScraperMediaBandwidth"] = 0;
+	mBoolMap["ScraperRecompressImages"] = false;
+	mIntMap["ScraperJpegQuality"] = 90;
 
 #if defined(_WIN32) || defined(TINKERBOARD) || defined(X86) || defined(X86_64) || defined(ODROIDN2) || defined(ODROIDC2) || defined(ODROIDXU4) || defined(RPI4)
 	// Boards > 1Gb RAM
@@ -205,6 +286,9 @@ void Settings::setDefaults()
 	mIntMap["MaxVRAM"] = 100;
 #endif
 
+	// Texture data uploaded to VRAM per frame, in KB. 0 : no limit
+	mIntMap["TextureUploadBudget"] = 4096;
+
 	mStringMap["TransitionStyle"] = "auto";
 	mStringMap["GameTransitionStyle"] = "auto";
 
@@ -258,7 +342,7 @@ void Settings::setDefaults()
 	mBoolMap["VideoAudio"] = true;
 	mBoolMap["ScreenSaverVideoMute"] = false;
 	mBoolMap["VideoLowersMusic"] = true;
-	mBoolMap["VolumePopup"] = Settings::_VolumePopup;
+	mBoolMap["VolumePopup"] = true;
 
 	mIntMap["MusicVolume"] = 128;
 
@@ -277,6 +361,13 @@ void Settings::setDefaults()
 	mBoolMap["LocalArt"] = false;
 	mBoolMap["WebServices"] = false;
 
+	// Embedded web server ( port 1234 ). Threads 0 : automatic
+	mIntMap["HttpServerThreads"] = 0;
+	mIntMap["HttpServerKeepAlive"] = 10;
+	mIntMap["HttpServerTimeout"] = 10;
+	mIntMap["HttpServerHeavyRequests"] = 2;
+	mIntMap["HttpServerMaxUploadSize"] = 512; // MB
+
 	// Audio out device for volume control
 	#ifdef _RPI_
 		mStringMap["AudioDevice"] = "PCM";
@@ -300,11 +391,21 @@ void Settings::setDefaults()
 	mStringMap["DefaultGridSize"] = "";
 
 	mBoolMap["ThreadedLoading"] = true;
+	mBoolMap["SessionFileCache"] = true;
+	mBoolMap["LiveRomFolders"] = true;
 	mBoolMap["AsyncImages"] = true;
 	mBoolMap["PreloadUI"] = false;
-	mBoolMap["PreloadMedias"] = Settings::_PreloadMedias;
+	mBoolMap["PreloadUIDeferred"] = true;
+	mIntMap["GameListViewCacheSize"] = 12;
+	mIntMap["GameListViewCacheMemory"] = 0;
+	mBoolMap["PreloadMedias"] = false;
 	mBoolMap["OptimizeVRAM"] = true;
+	mBoolMap["DedupTextures"] = false;
+	mStringMap["LowMemoryMode"] = "auto";
 	mBoolMap["OptimizeVideo"] = true;
+	mBoolMap["VideoYuvFrames"] = true;
+	mStringMap["VideoHardwareDecode"] = "auto";
+	mBoolMap["VideoPosterCache"] = false;
 
 	mBoolMap["ShowFilenames"] = false;
 
@@ -334,7 +435,7 @@ void Settings::setDefaults()
 	mStringMap["INPUT P8NAME"] = "DEFAULT";
 
 	// Audio settings
-	mBoolMap["audio.bgmusic"] = Settings::_BackgroundMusic;
+	mBoolMap["audio.bgmusic"] = true;
 	mBoolMap["audio.persystem"] = false;
 	mBoolMap["audio.display_titles"] = true;
 	mBoolMap["audio.thememusics"] = true;
@@ -371,10 +472,12 @@ void Settings::setDefaults()
 	mDefaultIntMap = mIntMap;
 	mDefaultFloatMap = mFloatMap;
 	mDefaultStringMap = mStringMap;
+
+	loadSlots();
 }
 
 template <typename K, typename V>
-void saveMap(pugi::xml_node &node, std::map<K, V>& map, const char* type, std::map<K, V>& defaultMap, V defaultValue)
+void saveMap(pugi::xml_node &node, const std::map<K, V>& map, const char* type, const std::map<K, V>& defaultMap, V defaultValue)
 {
 	for(auto iter = map.cbegin(); iter != map.cend(); iter++)
 	{
@@ -406,39 +509,53 @@ bool Settings::saveFile()
 
 	const std::string path = Paths::getUserEmulationStationPath() + "/es_settings.cfg";
 
-	pugi::xml_document doc;
-
-	pugi::xml_node config = doc.append_child("config"); // root element
-
-	saveMap<std::string, bool>(config, mBoolMap, "bool", mDefaultBoolMap, false);
-	saveMap<std::string, int>(config, mIntMap, "int", mDefaultIntMap, 0);
-	saveMap<std::string, float>(config, mFloatMap, "float", mDefaultFloatMap, 0);
+	// Serialized & written in the background from a copy, the defaults never change once loaded
+	auto boolMap = mBoolMap;
+	auto intMap = mIntMap;
+	auto floatMap = mFloatMap;
+	auto stringMap = mStringMap;
 
-	//saveMap<std::string, std::string>(config, mStringMap, "string");
-	for(auto iter = mStringMap.cbegin(); iter != mStringMap.cend(); iter++)
+	ConfigWriter::queue(path, [this, boolMap, intMap, floatMap, stringMap](std::string& content)
 	{
-		// key is on the "don't save" list, so don't save it
-		if (std::find(settings_dont_save.cbegin(), settings_dont_save.cend(), iter->first) != settings_dont_save.cend())
-			continue;
-
-		// Value is not known, and empty, don't save it
-		auto def = mDefaultStringMap.find(iter->first);
-		if (def == mDefaultStringMap.cend() && iter->second.empty())
-			continue;
-
-		// Value is know and has default value, don't save it
-		if (def != mDefaultStringMap.cend() && def->second == iter->second)
-			continue;
-
-		pugi::xml_node node = config.append_child("string");
-		node.append_attribute("name").set_value(iter->first.c_str());
-		node.append_attribute("value").set_value(iter->second.c_str());
-	}
-
-	doc.save_file(WINSTRINGW(path).c_str());
-
-	Scripting::fireEvent("config-changed");
-	Scripting::fireEvent("settings-changed");
+		pugi::xml_document doc;
+
+		pugi::xml_node config = doc.append_child("config"); // root element
+
+		saveMap<std::string, bool>(config, boolMap, "bool", mDefaultBoolMap, false);
+		saveMap<std::string, int>(config, intMap, "int", mDefaultIntMap, 0);
+		saveMap<std::string, float>(config, floatMap, "float", mDefaultFloatMap, 0);
+
+		//saveMap<std::string, std::string>(config, mStringMap, "string");
+		for (auto iter = stringMap.cbegin(); iter != stringMap.cend(); iter++)
+		{
+			// key is on the "don't save" list, so don't save it
+			if (std::find(settings_dont_save.cbegin(), settings_dont_save.cend(), iter->first) != settings_dont_save.cend())
+				continue;
+
+			// Value is not known, and empty, don't save it
+			auto def = mDefaultStringMap.find(iter->first);
+			if (def == mDefaultStringMap.cend() && iter->second.empty())
+				continue;
+
+			// Value is know and has default value, don't save it
+			if (def != mDefaultStringMap.cend() && def->second == iter->second)
+				continue;
+
+			pugi::xml_node node = config.append_child("string");
+			node.append_attribute("name").set_value(iter->first.c_str());
+			node.append_attribute("value").set_value(iter->second.c_str());
+		}
+
+		std::ostringstream stream;
+		doc.save(stream);
+		content = stream.str();
+		return true;
+	},
+	[]
+	{
+		Scripting::fireEvent("config-changed");
+		Scripting::fireEvent("settings-changed");
+	});
 
 	return true;
 }
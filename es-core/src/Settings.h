@@ -13,28 +13,74 @@
 #define DEFINE_FLOAT_SETTING(XX) static float XX() { return Settings::getInstance()->getFloat(#XX); }; static bool set##XX(float val) { return Settings::getInstance()->setFloat(#XX, val); };
 #define DEFINE_STRING_SETTING(XX) static std::string XX() { return Settings::getInstance()->getString(#XX); }; static bool set##XX(const std::string& val) { return Settings::getInstance()->setString(#XX, val); };
 
-// Cached static settings macros
+// Registry of the settings read on hot paths : each one has an id resolved at compile time & a typed slot, kept in sync by the setters.
+// Settings::get(BoolSetting::LocalArt) reads the slot without any string lookup. X(id, name)
+#define BOOL_SETTINGS_REGISTRY(X) \
+	X(BackgroundMusic, "audio.bgmusic") \
+	X(DebugText, "DebugText") \
+	X(DebugImage, "DebugImage") \
+	X(DebugGrid, "DebugGrid") \
+	X(DebugMouse, "DebugMouse") \
+	X(DrawClock, "DrawClock") \
+	X(ShowControllerActivity, "ShowControllerActivity") \
+	X(ShowControllerBattery, "ShowControllerBattery") \
+	X(ShowNetworkIndicator, "ShowNetworkIndicator") \
+	X(DrawFramerate, "DrawFramerate") \
+	X(VolumePopup, "VolumePopup") \
+	X(ClockMode12, "ClockMode12") \
+	X(VSync, "VSync") \
+	X(PreloadMedias, "PreloadMedias") \
+	X(IgnoreLeadingArticles, "IgnoreLeadingArticles") \
+	X(ShowFoldersFirst, "ShowFoldersFirst") \
+	X(ScrollLoadMedias, "ScrollLoadMedias") \
+	X(ShowHiddenFiles, "ShowHiddenFiles") \
+	X(AllImagesAsync, "AllImagesAsync") \
+	X(LocalArt, "LocalArt") \
+	X(ForceDisableFilters, "ForceDisableFilters") \
+	X(AsyncImages, "AsyncImages") \
+	X(OptimizeVRAM, "OptimizeVRAM") \
+	X(OptimizeVideo, "OptimizeVideo") \
+	X(VideoYuvFrames, "VideoYuvFrames") \
+	X(VideoAudio, "VideoAudio") \
+	X(VideoOmxPlayer, "VideoOmxPlayer") \
+	X(ScreenSaverVideoMute, "ScreenSaverVideoMute") \
+	X(ScreenSaverControls, "ScreenSaverControls") \
+	X(IdleFrameSkip, "IdleFrameSkip") \
+	X(FirstJoystickOnly, "FirstJoystickOnly") \
+	X(GameOptionsAtNorth, "GameOptionsAtNorth") \
+	X(QuickSystemSelect, "QuickSystemSelect") \
+	X(PrefetchGameMedias, "PrefetchGameMedias") \
+	X(TTSPresynthesis, "TTSPresynthesis") \
+	X(DedupTextures, "DedupTextures")
+
+#define INT_SETTINGS_REGISTRY(X) \
+	X(ScreenSaverTime, "ScreenSaverTime") \
+	X(ScreenSaverSwapVideoTimeout, "ScreenSaverSwapVideoTimeout")
+
+#define STRING_SETTINGS_REGISTRY(X) \
+	X(TransitionStyle, "TransitionStyle") \
+	X(GameTransitionStyle, "GameTransitionStyle") \
+	X(PowerSaverMode, "PowerSaverMode") \
+	X(ScreenSaverBehavior, "ScreenSaverBehavior")
+
+#define SETTINGS_REGISTRY_ID(ID, NAME) ID,
+
+enum class BoolSetting : int { BOOL_SETTINGS_REGISTRY(SETTINGS_REGISTRY_ID) Count };
+enum class IntSetting : int { INT_SETTINGS_REGISTRY(SETTINGS_REGISTRY_ID) Count };
+enum class StringSetting : int { STRING_SETTINGS_REGISTRY(SETTINGS_REGISTRY_ID) Count };
+
+// Shortcut methods of the registry settings
 #define DECLARE_STATIC_BOOL_SETTING(XX) \
-private: \
-static bool _##XX; \
-public: \
-static bool XX() { return _##XX; }; \
-static bool set##XX(bool val) { _##XX = val; return Settings::getInstance()->setBool(#XX, val); };
+static bool XX() { return get(BoolSetting::XX); }; \
+static bool set##XX(bool val) { return set(BoolSetting::XX, val); };
 
 #define DECLARE_STATIC_INT_SETTING(XX) \
-private: \
-static int _##XX; \
-public: \
-inline static int XX() { return _##XX; }; \
-static bool set##XX(bool val) { _##XX = val; return Settings::getInstance()->setInt(#XX, val); };
+static int XX() { return get(IntSetting::XX); }; \
+static bool set##XX(int val) { return set(IntSetting::XX, val); };
 
-// Cached static settings macros. To use in cpp to implement cached settings
-#define IMPLEMENT_STATIC_BOOL_SETTING(XX, VAL) bool Settings::_##XX = VAL;
-#define UPDATE_STATIC_BOOL_SETTING(XX) if (name == #XX) _##XX = getBool(#XX);
-#define UPDATE_STATIC_BOOL_SETTING_EX(NAME, XX) if (name == NAME) _##XX = getBool(NAME);
-
-#define IMPLEMENT_STATIC_INT_SETTING(XX, VAL) int Settings::_##XX = VAL;
-#define UPDATE_STATIC_INT_SETTING(XX) if (name == #XX) _##XX = getInt(#XX);
+#define DECLARE_STATIC_STRING_SETTING(XX) \
+static std::string XX() { return get(StringSetting::XX); }; \
+static bool set##XX(const std::string& val) { return set(StringSetting::XX, val); };
 
 class ISettingsChangedEvent
 {
@@ -64,7 +110,24 @@ public:
 
 	std::map<std::string, std::string>& getStringMap() { return mStringMap; }
 
-	// Cached settings using static fields. They must be implemented using IMPLEMENT_STATIC_xx_SETTING & updated with UPDATE_STATIC_xxx_SETTING
+	// Registry settings
+	static bool get(BoolSetting id) { return mBoolSlots[(int)id]; }
+	static int get(IntSetting id) { return mIntSlots[(int)id]; }
+	// By value : the slot can be reassigned by a setter on another thread
+	static std::string get(StringSetting id);
+
+	static bool set(BoolSetting id, bool value) { return getInstance()->setBool(getName(id), value); }
+	static bool set(IntSetting id, int value) { return getInstance()->setInt(getName(id), value); }
+	static bool set(StringSetting id, const std::string& value) { return getInstance()->setString(getName(id), value); }
+
+	static const char* getName(BoolSetting id);
+	static const char* getName(IntSetting id);
+	static const char* getName(StringSetting id);
+
+	// Changes each time a setting changes : values derived from settings ( per system ones... ) are computed again when it differs
+	static unsigned int getGeneration() { return mGeneration; }
+
+	// Shortcuts of the registry settings
 	DECLARE_STATIC_BOOL_SETTING(DebugText)
 	DECLARE_STATIC_BOOL_SETTING(DebugImage)
 	DECLARE_STATIC_BOOL_SETTING(DebugGrid)
@@ -82,12 +145,15 @@ public:
 	DECLARE_STATIC_BOOL_SETTING(IgnoreLeadingArticles)
 	DECLARE_STATIC_BOOL_SETTING(ShowFoldersFirst)
 	DECLARE_STATIC_BOOL_SETTING(ScrollLoadMedias)
-	DECLARE_STATIC_INT_SETTING(ScreenSaverTime);
+	DECLARE_STATIC_BOOL_SETTING(ShowHiddenFiles)
+	DECLARE_STATIC_BOOL_SETTING(AllImagesAsync)
+	DECLARE_STATIC_INT_SETTING(ScreenSaverTime)
+	DECLARE_STATIC_STRING_SETTING(TransitionStyle)
+	DECLARE_STATIC_STRING_SETTING(GameTransitionStyle)
+	DECLARE_STATIC_STRING_SETTING(PowerSaverMode)
 
 	// Non-cached settings with only shortcut methods
-	DEFINE_BOOL_SETTING(ShowHiddenFiles)
 	DEFINE_BOOL_SETTING(HiddenSystemsShowGames)
-	DEFINE_BOOL_SETTING(AllImagesAsync)
 	DEFINE_BOOL_SETTING(IgnoreGamelist)
 	DEFINE_BOOL_SETTING(SaveGamelistsOnExit)
 	DEFINE_BOOL_SETTING(RemoveMultiDiskContent)	
@@ -98,9 +164,6 @@ public:
 	DEFINE_BOOL_SETTING(NetPlayShowMissingGames)			
 	DEFINE_BOOL_SETTING(LoadEmptySystems)		
 	DEFINE_STRING_SETTING(HiddenSystems)
-	DEFINE_STRING_SETTING(TransitionStyle)
-	DEFINE_STRING_SETTING(GameTransitionStyle)		
-	DEFINE_STRING_SETTING(PowerSaverMode)		
 	DEFINE_INT_SETTING(RecentlyScrappedFilter)
 
 	static Delegate<ISettingsChangedEvent> settingChanged;
@@ -127,6 +190,12 @@ private:
 
 	bool mLoaded;
 	void updateCachedSetting(const std::string& name);
+	void loadSlots();
+
+	static bool mBoolSlots[(int)BoolSetting::Count];
+	static int mIntSlots[(int)IntSetting::Count];
+	static std::string mStringSlots[(int)StringSetting::Count];
+	static unsigned int mGeneration;
 };
 
 #endif // ES_CORE_SETTINGS_H
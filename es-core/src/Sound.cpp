@@ -3,6 +3,7 @@
 #include "AudioManager.h"
 #include "Log.h"
 #include "Settings.h"
+#include "SoundBank.h"
 #include "ThemeData.h"
 #include "resources/ResourceManager.h"
 
@@ -29,12 +30,12 @@ std::shared_ptr<Sound> Sound::get(const std::string& path)
 
 std::shared_ptr<Sound> Sound::getFromTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element)
 {
-	LOG(LogInfo) << " req sound [" << view << "." << element << "]";
+	LOG(LogDebug) << " req sound [" << view << "." << element << "]";
 
 	const ThemeData::ThemeElement* elem = theme->getElement(view, element, "sound");
 	if (!elem || !elem->has("path"))
 	{
-		LOG(LogInfo) << "   (missing)";
+		LOG(LogDebug) << "   (missing)";
 		return get("");
 	}
 
@@ -70,13 +71,8 @@ void Sound::init()
 	if (!Settings::getInstance()->getBool("EnableSounds"))
 		return;
 
-	//load wav file via SDL
-	mSampleData = Mix_LoadWAV(mPath.c_str());
-	if (mSampleData == nullptr)
-	{
-		LOG(LogError) << "Error loading sound \"" << mPath << "\"!\n" << "	" << SDL_GetError();
-		return;
-	}
+	// Decoded once, shared with the other themes using the same file
+	mSampleData = SoundBank::get(mPath);
 }
 
 void Sound::deinit()
@@ -84,8 +80,8 @@ void Sound::deinit()
 	if (mSampleData == nullptr)
 		return;
 
+	// The chunk belongs to the bank, kept for the next init
 	stop();
-	Mix_FreeChunk(mSampleData);
 	mSampleData = nullptr;	
 }
 
@@ -0,0 +1,210 @@
+#include "SoundBank.h"
+
+#include "resources/ResourceManager.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/ThreadPool.h"
+#include "utils/Crc32.h"
+#include "AudioManager.h"
+#include "Log.h"
+
+std::mutex SoundBank::mLock;
+std::map<std::string, SoundBank::Entry> SoundBank::mEntries;
+std::map<std::string, std::shared_ptr<SoundBank::Content>> SoundBank::mContents;
+
+// The system background musics are sound elements too : they are streamed by AudioManager, not kept decoded
+#define MAX_PRELOAD_SIZE	(1024 * 1024)
+
+int SoundBank::mFrequency = 0;
+Uint16 SoundBank::mFormat = 0;
+int SoundBank::mChannels = 0;
+
+std::shared_ptr<SoundBank::Content> SoundBank::load(const std::string& path)
+{
+	long long modificationTime = 0;
+	unsigned long long size = 0;
+	Utils::FileSystem::getFileStamp(path, modificationTime, size);
+
+	const ResourceData data = ResourceManager::getInstance()->getFileData(path);
+	if (data.ptr == nullptr || data.length == 0)
+		return nullptr;
+
+	std::shared_ptr<Content> content = std::make_shared<Content>();
+	content->path = path;
+	content->data = data.ptr;
+	content->length = data.length;
+	content->key = std::to_string(Utils::Crc32::compute(0, data.ptr.get(), data.length)) + "|" + std::to_string(data.length);
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mContents.find(content->key);
+	if (it != mContents.cend())
+		content = it->second;
+	else
+		mContents[content->key] = content;
+
+	Entry& entry = mEntries[path];
+
+	// The file was modified : the previous content is freed once no other file shares it
+	if (entry.content != nullptr && entry.content != content && entry.content.use_count() == 2)
+	{
+		if (entry.content->chunk != nullptr)
+			Mix_FreeChunk(entry.content->chunk);
+
+		mContents.erase(entry.content->key);
+	}
+
+	entry.modificationTime = modificationTime;
+	entry.size = size;
+	entry.content = content;
+
+	return content;
+}
+
+void SoundBank::decode(Content& content)
+{
+	SDL_RWops* rw = SDL_RWFromConstMem(content.data.get(), (int)content.length);
+	if (rw != nullptr)
+		content.chunk = Mix_LoadWAV_RW(rw, 1);
+
+	// Not retried every time the sound is played
+	if (content.chunk == nullptr)
+	{
+		content.failed = true;
+		LOG(LogError) << "Error loading sound \"" << content.path << "\"!\n" << "	" << SDL_GetError();
+	}
+}
+
+void SoundBank::preload(const std::vector<std::string>& paths)
+{
+	std::vector<std::string> files;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		for (auto& path : paths)
+		{
+			long long modificationTime;
+			unsigned long long size;
+			if (!Utils::FileSystem::getFileStamp(path, modificationTime, size) || size > MAX_PRELOAD_SIZE)
+				continue;
+
+			auto it = mEntries.find(path);
+			if (it == mEntries.cend() || it->second.modificationTime != modificationTime || it->second.size != size)
+				files.push_back(path);
+		}
+	}
+
+	if (files.size())
+	{
+		Utils::ThreadPool pool(TaskScheduler::TEXTURE_IO);
+
+		for (auto& path : files)
+			pool.queueWorkItem([path] { load(path); });
+
+		pool.wait();
+
+		LOG(LogDebug) << "SoundBank : " << files.size() << " sounds read";
+	}
+
+	// Decoding is sequential : the SDL_mixer decoders are initialized on first use
+	if (AudioManager::isInitialized())
+		onAudioOpened();
+}
+
+Mix_Chunk* SoundBank::get(const std::string& path)
+{
+	if (path.empty() || !AudioManager::isInitialized())
+		return nullptr;
+
+	std::shared_ptr<Content> content;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		auto it = mEntries.find(path);
+		if (it != mEntries.cend())
+			content = it->second.content;
+	}
+
+	if (content == nullptr)
+		content = load(path);
+
+	if (content == nullptr)
+		return nullptr;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (content->chunk == nullptr && !content->failed)
+		decode(*content);
+
+	return content->chunk;
+}
+
+void SoundBank::onAudioOpened()
+{
+	int frequency = 0;
+	Uint16 format = 0;
+	int channels = 0;
+	if (Mix_QuerySpec(&frequency, &format, &channels) == 0)
+		return;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	// Mix_OpenAudio may get another frequency or channel count from a new output device
+	bool changed = frequency != mFrequency || format != mFormat || channels != mChannels;
+
+	mFrequency = frequency;
+	mFormat = format;
+	mChannels = channels;
+
+	for (auto& it : mContents)
+	{
+		Content& content = *it.second;
+
+		if (changed && content.chunk != nullptr)
+		{
+			Mix_FreeChunk(content.chunk);
+			content.chunk = nullptr;
+			content.failed = false;
+		}
+
+		if (content.chunk == nullptr && !content.failed)
+			decode(content);
+	}
+}
+
+size_t SoundBank::getMemUsage()
+{
+	size_t total = 0;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	for (auto& it : mContents)
+	{
+		total += it.second->length;
+		if (it.second->chunk != nullptr)
+			total += it.second->chunk->alen;
+	}
+
+	return total;
+}
+
+void SoundBank::clear()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	// No channel may still play a freed chunk
+	if (AudioManager::isInitialized())
+		Mix_HaltChannel(-1);
+
+	for (auto& it : mContents)
+		if (it.second->chunk != nullptr)
+			Mix_FreeChunk(it.second->chunk);
+
+	mContents.clear();
+	mEntries.clear();
+
+	mFrequency = 0;
+	mFormat = 0;
+	mChannels = 0;
+}
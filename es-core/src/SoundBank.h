@@ -0,0 +1,65 @@
+#pragma once
+#ifndef ES_CORE_SOUND_BANK_H
+#define ES_CORE_SOUND_BANK_H
+
+#include "SDL_mixer.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Sound effects kept in memory : the theme sounds are read when the themes load, decoded to the mixer format once the audio device is opened,
+// and kept when the device is closed for a game. Identical files ( the same sounds copied in several themes ) share one chunk
+class SoundBank
+{
+public:
+	// Reads the files, in parallel. The mixer may not be opened yet, decoding waits for onAudioOpened
+	static void preload(const std::vector<std::string>& paths);
+
+	// Decoded sound, owned by the bank. The files that were not preloaded are read now. nullptr when the mixer is closed
+	static Mix_Chunk* get(const std::string& path);
+
+	// Decodes the preloaded files, again if the device was reopened with another format
+	static void onAudioOpened();
+
+	static void clear();
+
+	// Files & decoded chunks, in bytes
+	static size_t getMemUsage();
+
+private:
+	struct Content
+	{
+		Content() : length(0), chunk(nullptr), failed(false) { }
+
+		std::string						path;
+		std::string						key;
+		std::shared_ptr<unsigned char>	data;
+		size_t							length;
+		Mix_Chunk*						chunk;
+		bool							failed;
+	};
+
+	struct Entry
+	{
+		Entry() : modificationTime(0), size(0) { }
+
+		long long						modificationTime;
+		unsigned long long				size;
+		std::shared_ptr<Content>		content;
+	};
+
+	static std::shared_ptr<Content> load(const std::string& path);
+	static void decode(Content& content);
+
+	static std::mutex										mLock;
+	static std::map<std::string, Entry>						mEntries;	// by path
+	static std::map<std::string, std::shared_ptr<Content>>	mContents;	// by crc & size of the file
+
+	static int		mFrequency;
+	static Uint16	mFormat;
+	static int		mChannels;
+};
+
+#endif // ES_CORE_SOUND_BANK_H
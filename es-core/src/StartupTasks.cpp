@@ -0,0 +1,157 @@
+#include "StartupTasks.h"
+
+#include "utils/StringUtil.h"
+#include "Trace.h"
+#include "Log.h"
+
+#include <chrono>
+
+std::mutex StartupTasks::sLock;
+std::condition_variable StartupTasks::sDone;
+std::map<std::string, StartupTasks::Step> StartupTasks::sSteps;
+
+static std::chrono::steady_clock::time_point sStartTime = std::chrono::steady_clock::now();
+
+long long StartupTasks::now()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - sStartTime).count();
+}
+
+void StartupTasks::add(const std::string& name, const std::vector<std::string>& dependencies, const std::function<void()>& task, TaskScheduler::Priority priority)
+{
+	std::unique_lock<std::mutex> lock(sLock);
+
+	Step& step = sSteps[name];
+	step.dependencies = dependencies;
+	step.task = task;
+	step.priority = priority;
+
+	startReadySteps();
+}
+
+void StartupTasks::startReadySteps()
+{
+	for (auto& it : sSteps)
+	{
+		Step& step = it.second;
+		if (step.started)
+			continue;
+
+		bool ready = true;
+		for (auto& dependency : step.dependencies)
+		{
+			auto dep = sSteps.find(dependency);
+			if (dep != sSteps.cend() && !dep->second.done)
+			{
+				ready = false;
+				break;
+			}
+		}
+
+		if (!ready)
+			continue;
+
+		step.started = true;
+
+		std::string name = it.first;
+		TaskScheduler::submit(step.priority, [name] { run(name); });
+	}
+}
+
+void StartupTasks::run(const std::string& name)
+{
+	std::function<void()> task;
+
+	{
+		std::unique_lock<std::mutex> lock(sLock);
+		sSteps[name].start = now();
+		task = sSteps[name].task;
+	}
+
+	{
+		TraceSpan span("Startup step", name);
+		task();
+	}
+
+	std::unique_lock<std::mutex> lock(sLock);
+
+	Step& step = sSteps[name];
+	step.end = now();
+	step.done = true;
+	step.task = nullptr;
+
+	startReadySteps();
+	sDone.notify_all();
+}
+
+void StartupTasks::wait(const std::string& name)
+{
+	std::unique_lock<std::mutex> lock(sLock);
+
+	auto it = sSteps.find(name);
+	if (it == sSteps.cend() || it->second.done)
+		return;
+
+	TraceSpan span("Startup wait", name);
+
+	long long start = now();
+	sDone.wait(lock, [&it] { return it->second.done; });
+	it->second.waited += now() - start;
+}
+
+// The step, preceded by the dependency that finished last before it
+std::string StartupTasks::getCriticalPath(const std::string& name)
+{
+	std::string path;
+
+	auto it = sSteps.find(name);
+	while (it != sSteps.end())
+	{
+		Step& step = it->second;
+
+		std::string item = Utils::String::format("%s %lldms", it->first.c_str(), step.end - step.start);
+		path = path.empty() ? item : item + " > " + path;
+
+		auto last = sSteps.end();
+		for (auto& dependency : step.dependencies)
+		{
+			auto dep = sSteps.find(dependency);
+			if (dep != sSteps.end() && (last == sSteps.end() || dep->second.end > last->second.end))
+				last = dep;
+		}
+
+		it = last;
+	}
+
+	return path;
+}
+
+void StartupTasks::finish()
+{
+	std::vector<std::string> names;
+
+	{
+		std::unique_lock<std::mutex> lock(sLock);
+		for (auto& it : sSteps)
+			names.push_back(it.first);
+	}
+
+	for (auto& name : names)
+		wait(name);
+
+	std::unique_lock<std::mutex> lock(sLock);
+
+	for (auto& it : sSteps)
+	{
+		if (it.second.waited <= 0)
+			continue;
+
+		std::string path = getCriticalPath(it.first);
+		LOG(LogInfo) << "StartupTasks : waited " << it.second.waited << "ms for " << path;
+
+		if (Trace::enabled())
+			Trace::addSpan("Startup critical path", path, Trace::now() - 1, Trace::now());
+	}
+
+	sSteps.clear();
+}
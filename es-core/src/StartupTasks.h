@@ -0,0 +1,53 @@
+#pragma once
+#ifndef ES_CORE_STARTUP_TASKS_H
+#define ES_CORE_STARTUP_TASKS_H
+
+#include "TaskScheduler.h"
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Startup steps that don't need the main thread ( no GL, no SDL subsystem ), run by the TaskScheduler while the main thread goes on.
+// A step starts once the steps it depends on are done, and the main thread waits for a step right before it needs it.
+// The steps & the waits are traced, and finish() logs the critical path : the chains of steps the main thread ended up waiting for
+class StartupTasks
+{
+public:
+	static void add(const std::string& name, const std::vector<std::string>& dependencies, const std::function<void()>& task, TaskScheduler::Priority priority = TaskScheduler::UI_CRITICAL);
+
+	// Main thread
+	static void wait(const std::string& name);
+	// Waits for the remaining steps
+	static void finish();
+
+private:
+	struct Step
+	{
+		Step() : started(false), done(false), start(0), end(0), waited(0) { }
+
+		std::vector<std::string> dependencies;
+		std::function<void()> task;
+		TaskScheduler::Priority priority;
+
+		bool started;
+		bool done;
+		long long start;	// Milliseconds since the first step
+		long long end;
+		long long waited;	// By the main thread
+	};
+
+	static void startReadySteps(); // Under sLock
+	static void run(const std::string& name);
+	static long long now();
+	static std::string getCriticalPath(const std::string& name);
+
+	static std::mutex sLock;
+	static std::condition_variable sDone;
+	static std::map<std::string, Step> sSteps;
+};
+
+#endif // ES_CORE_STARTUP_TASKS_H
@@ -0,0 +1,64 @@
+#include "StatusIndicators.h"
+
+#include "components/IExternalActivity.h"
+#include "TaskScheduler.h"
+#include "Settings.h"
+
+#define STATUS_INTERVAL_MS	2000
+
+std::mutex StatusIndicators::mLock;
+std::shared_ptr<const StatusSnapshot> StatusIndicators::mSnapshot = std::make_shared<StatusSnapshot>();
+std::atomic<int> StatusIndicators::mVersion(0);
+std::atomic<bool> StatusIndicators::mSampling(false);
+int StatusIndicators::mElapsed = STATUS_INTERVAL_MS;
+
+void StatusIndicators::update(int deltaTime)
+{
+	mElapsed += deltaTime;
+	if (mElapsed < STATUS_INTERVAL_MS || mSampling)
+		return;
+
+	mElapsed = 0;
+	mSampling = true;
+
+	// Settings are read by the main thread
+	std::string showBattery = Settings::getInstance()->getString("ShowBattery");
+	bool showNetwork = Settings::ShowNetworkIndicator();
+
+	TaskScheduler::submit(TaskScheduler::BACKGROUND, [showBattery, showNetwork] { sample(showBattery, showNetwork); });
+}
+
+void StatusIndicators::sample(const std::string& showBattery, bool showNetwork)
+{
+	auto snapshot = std::make_shared<StatusSnapshot>();
+	snapshot->showBattery = showBattery;
+	snapshot->showNetwork = showNetwork;
+
+	if (!showBattery.empty())
+		snapshot->battery = Utils::Platform::queryBatteryInformation();
+
+	if (showNetwork)
+	{
+		snapshot->networkConnected = !Utils::Platform::queryIPAdress().empty();
+		snapshot->planeMode = IExternalActivity::Instance != nullptr && IExternalActivity::Instance->isPlaneMode();
+	}
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto& previous = mSnapshot;
+	if (previous->showBattery != snapshot->showBattery || previous->showNetwork != snapshot->showNetwork ||
+		previous->battery.hasBattery != snapshot->battery.hasBattery || previous->battery.isCharging != snapshot->battery.isCharging || previous->battery.level != snapshot->battery.level ||
+		previous->networkConnected != snapshot->networkConnected || previous->planeMode != snapshot->planeMode)
+	{
+		mSnapshot = snapshot;
+		mVersion++;
+	}
+
+	mSampling = false;
+}
+
+std::shared_ptr<const StatusSnapshot> StatusIndicators::get()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	return mSnapshot;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef ES_CORE_STATUS_INDICATORS_H
+#define ES_CORE_STATUS_INDICATORS_H
+
+#include "utils/Platform.h"
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <string>
+
+struct StatusSnapshot
+{
+	StatusSnapshot() : networkConnected(false), planeMode(false), showNetwork(false) { }
+
+	Utils::Platform::BatteryInformation battery;
+	bool networkConnected;
+	bool planeMode;
+
+	// Settings the sources were sampled with
+	std::string showBattery;
+	bool showNetwork;
+};
+
+// Battery, network & plane mode, shared by the indicators : sampled once per interval on a background worker instead of by each component on the main thread.
+// The snapshots are immutable, the version is only bumped when a sample differs from the previous one, so the components rebuild their images & texts on changes only
+class StatusIndicators
+{
+public:
+	// Window::update
+	static void update(int deltaTime);
+
+	static std::shared_ptr<const StatusSnapshot> get();
+	static int getVersion() { return mVersion; }
+
+private:
+	static void sample(const std::string& showBattery, bool showNetwork);
+
+	static std::mutex mLock;
+	static std::shared_ptr<const StatusSnapshot> mSnapshot;
+	static std::atomic<int> mVersion;
+	static std::atomic<bool> mSampling;
+	static int mElapsed;
+};
+
+#endif // ES_CORE_STATUS_INDICATORS_H
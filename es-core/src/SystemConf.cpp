@@ -6,6 +6,7 @@
 #include "utils/FileSystemUtil.h"
 #include "Settings.h"
 #include "Paths.h"
+#include "ConfigWriter.h"
 
 #include <set>
 #include <regex>
@@ -51,8 +52,7 @@ SystemConf::SystemConf()
 	mSystemConfFile = Paths::getSystemConfFilePath();
 	if (mSystemConfFile.empty())
 		return;
-	
-	mSystemConfFileTmp = mSystemConfFile + ".tmp";
+
 	loadSystemConf();	
 }
 
@@ -107,103 +107,101 @@ bool SystemConf::saveSystemConf()
 	if (!mWasChanged)
 		return false;
 
-	std::ifstream filein(mSystemConfFile); //File to read from
+	mWasChanged = false;
+
+	// Merged with the file & written in the background, from a copy of the values
+	std::string path = mSystemConfFile;
+	auto values = confMap;
 
-#ifndef WIN32
-	if (!filein)
+	ConfigWriter::queue(path, [path, values](std::string& content)
 	{
-		LOG(LogError) << "Unable to open for saving :  " << mSystemConfFile << "\n";
-		return false;
-	}
+		std::ifstream filein(path); //File to read from
+
+#ifndef WIN32
+		if (!filein)
+		{
+			LOG(LogError) << "Unable to open for saving :  " << path << "\n";
+			return false;
+		}
 #endif
 
-	/* Read all lines in a vector */
-	std::vector<std::string> fileLines;
-	std::string line;
+		/* Read all lines in a vector */
+		std::vector<std::string> fileLines;
+		std::string line;
 
-	if (filein)
-	{
-		while (std::getline(filein, line))
-			fileLines.push_back(line);
+		if (filein)
+		{
+			while (std::getline(filein, line))
+				fileLines.push_back(line);
 
-		filein.close();
-	}
+			filein.close();
+		}
 
-	static std::string removeID = "$^(p$^mpv$rpver$^vper$vper$^vper$vper$vper$^vperv^pervncvizn";
+		static std::string removeID = "$^(p$^mpv$rpver$^vper$vper$^vper$vper$vper$^vperv^pervncvizn";
 
-	int lastTime = SDL_GetTicks();
+		int lastTime = SDL_GetTicks();
 
-	/* Save new value if exists */
-	for (auto& it : confMap)
-	{
-		std::string key = it.first + "=";		
-		char key0 = key[0];
+		/* Save new value if exists */
+		for (auto& it : values)
+		{
+			std::string key = it.first + "=";		
+			char key0 = key[0];
 
-		bool lineFound = false;
+			bool lineFound = false;
 
-		for (auto& currentLine : fileLines)
-		{
-			if (currentLine.size() < 3)
-				continue;
+			for (auto& currentLine : fileLines)
+			{
+				if (currentLine.size() < 3)
+					continue;
 
-			char fc = currentLine[0];
-			if (fc != key0 && currentLine[1] != key0)
-				continue;
+				char fc = currentLine[0];
+				if (fc != key0 && currentLine[1] != key0)
+					continue;
 
-			int idx = currentLine.find(key);
-			if (idx == std::string::npos)
-				continue;
+				int idx = currentLine.find(key);
+				if (idx == std::string::npos)
+					continue;
 
-			if (idx == 0 || (idx == 1 && (fc == ';' || fc == '#')))
-			{
-				std::string val = it.second;
-				if ((!val.empty() && val != "auto") || dontRemoveValue.find(it.first) != dontRemoveValue.cend())
+				if (idx == 0 || (idx == 1 && (fc == ';' || fc == '#')))
 				{
-					auto defaultValue = defaults.find(key);
-					if (defaultValue != defaults.cend() && defaultValue->second == val)
+					std::string val = it.second;
+					if ((!val.empty() && val != "auto") || dontRemoveValue.find(it.first) != dontRemoveValue.cend())
+					{
+						auto defaultValue = defaults.find(key);
+						if (defaultValue != defaults.cend() && defaultValue->second == val)
+							currentLine = removeID;
+						else
+							currentLine = key + val;
+					}
+					else 
 						currentLine = removeID;
-					else
-						currentLine = key + val;
-				}
-				else 
-					currentLine = removeID;
 
-				lineFound = true;
+					lineFound = true;
+				}
 			}
-		}
 
-		if (!lineFound)
-		{
-			std::string val = it.second;
-			if (!val.empty() && val != "auto")
-				fileLines.push_back(key + val);
+			if (!lineFound)
+			{
+				std::string val = it.second;
+				if (!val.empty() && val != "auto")
+					fileLines.push_back(key + val);
+			}
 		}
-	}
 
-	lastTime = SDL_GetTicks() - lastTime;
+		lastTime = SDL_GetTicks() - lastTime;
 
-	LOG(LogDebug) << "saveSystemConf :  " << lastTime;
+		LOG(LogDebug) << "saveSystemConf :  " << lastTime;
 
-	std::ofstream fileout(mSystemConfFileTmp); //Temporary file
-	if (!fileout)
-	{
-		LOG(LogError) << "Unable to open for saving :  " << mSystemConfFileTmp << "\n";
-		return false;
-	}
-	for (int i = 0; i < fileLines.size(); i++) 
-	{
-		if (fileLines[i] != removeID)
-			fileout << fileLines[i] << "\n";
-	}
-
-	fileout.close();
-	
-	std::ifstream  src(mSystemConfFileTmp, std::ios::binary);
-	std::ofstream  dst(mSystemConfFile, std::ios::binary);
-	dst << src.rdbuf();
+		std::string text;
+		for (int i = 0; i < fileLines.size(); i++)
+		{
+			if (fileLines[i] != removeID)
+				text += fileLines[i] + "\n";
+		}
 
-	remove(mSystemConfFileTmp.c_str());
-	mWasChanged = false;
+		content = text;
+		return true;
+	});
 
 	return true;
 }
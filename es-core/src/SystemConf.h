@@ -31,7 +31,6 @@ private:
 
 
 	std::string mSystemConfFile;
-	std::string mSystemConfFileTmp;
 };
 
 
@@ -0,0 +1,271 @@
+#include "TaskScheduler.h"
+
+#include "Settings.h"
+#include "Log.h"
+#include <algorithm>
+
+#if WIN32
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+TaskScheduler::WorkerSet TaskScheduler::mWorkers[TaskScheduler::PRIORITY_COUNT];
+std::atomic<bool> TaskScheduler::mExit(false);
+int TaskScheduler::mCoreCount = 0;
+bool TaskScheduler::mAffinity = false;
+
+// Set on the worker threads : their tasks submit to their own deque
+static thread_local int sWorkerPriority = -1;
+static thread_local int sWorkerIndex = -1;
+
+#if defined(__linux__) && !WIN32
+// Nice values : the background classes yield the cores to the UI, the network one mostly sleeps
+static const int sNiceValues[TaskScheduler::PRIORITY_COUNT] = { 0, 0, 10, 5 };
+#endif
+
+void TaskScheduler::init()
+{
+	mCoreCount = 0;
+	mAffinity = getCoreCount() >= 4 && Settings::getInstance()->getBool("TaskAffinity");
+
+	// The main thread keeps the first core for itself
+	if (mAffinity)
+	{
+#if WIN32
+		SetThreadAffinityMask(GetCurrentThread(), 1);
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(0, &set);
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+	}
+
+	LOG(LogInfo) << "TaskScheduler : " << getCoreCount() << " cores, workers " << getWorkerCount(UI_CRITICAL) << "/" << getWorkerCount(TEXTURE_IO) << "/" << getWorkerCount(BACKGROUND) << "/" << getWorkerCount(NETWORK) << (mAffinity ? " (affinity)" : "");
+}
+
+void TaskScheduler::shutdown()
+{
+	mExit = true;
+
+	for (int i = 0; i < PRIORITY_COUNT; i++)
+	{
+		auto& set = mWorkers[i];
+
+		std::vector<std::thread> threads;
+
+		{
+			std::unique_lock<std::mutex> lock(set.lock);
+			set.tasks.clear();
+
+			for (auto& worker : set.workers)
+			{
+				std::unique_lock<std::mutex> workerLock(worker->lock);
+				worker->tasks.clear();
+			}
+
+			set.pending = 0;
+			threads.swap(set.threads);
+			set.event.notify_all();
+		}
+
+		for (auto& thread : threads)
+			if (thread.joinable())
+				thread.join();
+	}
+}
+
+int TaskScheduler::getCoreCount()
+{
+	if (mCoreCount <= 0)
+		mCoreCount = std::max(1, (int)std::thread::hardware_concurrency());
+
+	return mCoreCount;
+}
+
+int TaskScheduler::getWorkerCount(Priority priority)
+{
+	int cores = getCoreCount();
+
+	switch (priority)
+	{
+	case UI_CRITICAL:
+		return cores;
+	case TEXTURE_IO:
+		return std::max(1, cores / 2);
+	case BACKGROUND:
+		return std::max(1, (cores - 1) / 2);
+	case NETWORK:
+		return std::max(2, cores / 2);
+	default:
+		return 1;
+	}
+}
+
+void TaskScheduler::submit(Priority priority, const std::function<void()>& task)
+{
+	if (mExit || priority < 0 || priority >= PRIORITY_COUNT)
+		return;
+
+	auto& set = mWorkers[priority];
+
+	// From a worker of the class : on its own deque, the others steal it if they are idle
+	if (sWorkerPriority == priority && sWorkerIndex >= 0)
+	{
+		auto& worker = *set.workers[sWorkerIndex];
+
+		{
+			std::unique_lock<std::mutex> workerLock(worker.lock);
+			worker.tasks.push_back(task);
+		}
+
+		set.pending++;
+
+		std::unique_lock<std::mutex> lock(set.lock);
+		if (set.sleeping > 0)
+			set.event.notify_one();
+		else if (!mExit && set.started < (int)set.workers.size())
+		{
+			int index = set.started++;
+			set.threads.push_back(std::thread(&TaskScheduler::run, priority, index));
+		}
+
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(set.lock);
+
+	// The deques exist before any worker can steal from them
+	if (set.workers.empty())
+		for (int i = 0; i < getWorkerCount(priority); i++)
+			set.workers.push_back(std::unique_ptr<Worker>(new Worker()));
+
+	set.tasks.push_back(task);
+	set.pending++;
+
+	// Workers start on demand, up to the budget of the class
+	if (set.sleeping == 0 && set.started < (int)set.workers.size())
+	{
+		int index = set.started++;
+		set.threads.push_back(std::thread(&TaskScheduler::run, priority, index));
+	}
+
+	set.event.notify_one();
+}
+
+bool TaskScheduler::takeTask(WorkerSet& set, int index, std::function<void()>& task)
+{
+	// Newest of its own first : nested tasks run depth first
+	{
+		auto& worker = *set.workers[index];
+
+		std::unique_lock<std::mutex> workerLock(worker.lock);
+		if (!worker.tasks.empty())
+		{
+			task = worker.tasks.back();
+			worker.tasks.pop_back();
+			set.pending--;
+			return true;
+		}
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(set.lock);
+		if (!set.tasks.empty())
+		{
+			task = set.tasks.front();
+			set.tasks.pop_front();
+			set.pending--;
+			return true;
+		}
+	}
+
+	// Steal the oldest task of another worker, those are the biggest ones with recursive work
+	int started = set.started;
+	for (int i = 1; i < started; i++)
+	{
+		auto& victim = *set.workers[(index + i) % started];
+
+		std::unique_lock<std::mutex> victimLock(victim.lock);
+		if (!victim.tasks.empty())
+		{
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			set.pending--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void TaskScheduler::run(Priority priority, int index)
+{
+	sWorkerPriority = priority;
+	sWorkerIndex = index;
+
+	setCurrentThreadPriority(priority);
+
+	auto& set = mWorkers[priority];
+
+	while (!mExit)
+	{
+		std::function<void()> task;
+
+		if (!takeTask(set, index, task))
+		{
+			std::unique_lock<std::mutex> lock(set.lock);
+
+			set.sleeping++;
+			set.event.wait(lock, [&set]() { return mExit || set.pending > 0; });
+			set.sleeping--;
+			continue;
+		}
+
+		try
+		{
+			task();
+		}
+		catch (...)
+		{
+			LOG(LogError) << "TaskScheduler : task failed with an exception";
+		}
+	}
+}
+
+void TaskScheduler::setCurrentThreadPriority(Priority priority)
+{
+	if (priority < 0 || priority >= PRIORITY_COUNT)
+		return;
+
+	bool background = (priority == BACKGROUND || priority == NETWORK);
+
+#if WIN32
+	SetThreadPriority(GetCurrentThread(), priority == BACKGROUND ? THREAD_PRIORITY_LOWEST : priority == NETWORK ? THREAD_PRIORITY_BELOW_NORMAL : THREAD_PRIORITY_NORMAL);
+
+	if (mAffinity)
+	{
+		DWORD_PTR all = getCoreCount() >= (int)(sizeof(DWORD_PTR) * 8) ? ~(DWORD_PTR)0 : (((DWORD_PTR)1 << getCoreCount()) - 1);
+		SetThreadAffinityMask(GetCurrentThread(), background ? all & ~(DWORD_PTR)1 : all);
+	}
+#elif defined(__linux__)
+	// Per thread on Linux. Lowering a nice value needs privileges : a thread started by a background one stays background
+	setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), sNiceValues[priority]);
+
+	if (mAffinity)
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+
+		for (int i = background ? 1 : 0; i < getCoreCount() && i < CPU_SETSIZE; i++)
+			CPU_SET(i, &set);
+
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	}
+#endif
+}
@@ -0,0 +1,75 @@
+#pragma once
+#ifndef ES_CORE_TASK_SCHEDULER_H
+#define ES_CORE_TASK_SCHEDULER_H
+
+#include <functional>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
+
+// Shared worker threads, one set per priority class, sized from the core count so background jobs don't oversubscribe small devices.
+// Each worker has its own deque : tasks submitted by a worker stay on it ( nested tasks run depth first, cache warm ), idle workers steal the oldest tasks of the others
+// Long running threads that keep their own loop ( scraper, network, installers... ) call setCurrentThreadPriority to join their class.
+// On 4 cores or more, with the "TaskAffinity" setting, the main thread stays on the first core and the background classes run on the others
+class TaskScheduler
+{
+public:
+	enum Priority : int
+	{
+		UI_CRITICAL = 0,	// The UI waits for it : loading, sorting
+		TEXTURE_IO = 1,		// Textures, sounds & glyphs for the next frames
+		BACKGROUND = 2,		// Hashing, post processing, scripts
+		NETWORK = 3,		// Mostly waiting for the network
+
+		PRIORITY_COUNT = 4
+	};
+
+	// Main thread, before the first task
+	static void init();
+	// Drops the queued tasks and joins the workers
+	static void shutdown();
+
+	static int getCoreCount();
+	static int getWorkerCount(Priority priority);
+
+	// Thread safe. Tasks submitted from outside the class start in their submission order
+	static void submit(Priority priority, const std::function<void()>& task);
+
+	static void setCurrentThreadPriority(Priority priority);
+
+private:
+	struct Worker
+	{
+		std::mutex lock;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	struct WorkerSet
+	{
+		WorkerSet() : pending(0), started(0), sleeping(0) { }
+
+		std::mutex lock;
+		std::condition_variable event;
+		std::deque<std::function<void()>> tasks; // Submitted from outside the class
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::vector<std::thread> threads;
+
+		std::atomic<int> pending;	// Queued in any deque
+		std::atomic<int> started;	// Workers that can be stolen from
+		int sleeping;
+	};
+
+	static void run(Priority priority, int index);
+	static bool takeTask(WorkerSet& set, int index, std::function<void()>& task);
+
+	static WorkerSet mWorkers[PRIORITY_COUNT];
+	static std::atomic<bool> mExit;
+	static int mCoreCount;
+	static bool mAffinity;
+};
+
+#endif // ES_CORE_TASK_SCHEDULER_H
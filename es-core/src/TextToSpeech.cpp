@@ -1,6 +1,7 @@
 #include "TextToSpeech.h"
 #include "Log.h"
 #include "LocaleES.h"
+#include "TaskScheduler.h"
 
 #if WIN32
 #include "SystemConf.h"
@@ -12,6 +13,8 @@
 
 void TextToSpeech::SpeakThread()
 {
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::UI_CRITICAL);
+
 	if (FAILED(::CoInitializeEx(NULL, COINITBASE_MULTITHREADED)))
 		return;
 
@@ -52,6 +55,152 @@ void TextToSpeech::SpeakThread()
 }
 #elif defined(_ENABLE_TTS_)
 #include <espeak/speak_lib.h>
+#include "SDL_mixer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string.h>
+#include <vector>
+
+#define TTS_CHANNEL		0					// Reserved, the sounds play on the others
+#define TTS_CACHE_BYTES	(8 * 1024 * 1024)	// In the mixer format
+
+// The synthesis in progress, there's one at a time on the synthesis thread
+static std::vector<short> sSynthSamples;
+static std::atomic<int> sSpeechGeneration(0); // Bumped by each interruption
+static int sSynthGeneration = 0;
+static int sSampleRate = 22050;
+
+static int synthCallback(short* wav, int numsamples, espeak_EVENT* events)
+{
+	// Interrupted : espeak stops there
+	if (sSpeechGeneration != sSynthGeneration)
+		return 1;
+
+	if (wav != nullptr && numsamples > 0)
+		sSynthSamples.insert(sSynthSamples.end(), wav, wav + numsamples);
+
+	return 0;
+}
+
+void TextToSpeech::SynthesisThread()
+{
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::UI_CRITICAL);
+
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mEvent.wait(lock, [this]() { return mShouldTerminate || !mSpeechQueue.empty(); });
+
+		if (mShouldTerminate)
+			break;
+
+		Utterance item = mSpeechQueue.front();
+		mSpeechQueue.pop_front();
+
+		std::string voice = mVoice;
+		int generation = sSpeechGeneration;
+		sSynthGeneration = generation;
+
+		lock.unlock();
+
+		Mix_Chunk* chunk = synthesize(item.text, voice);
+		if (chunk == nullptr || !item.play)
+			continue;
+
+		// After the expanded speech being played
+		while (sSpeechGeneration == generation && !mShouldTerminate && Mix_Playing(TTS_CHANNEL))
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+		lock.lock();
+
+		if (sSpeechGeneration == generation && !mShouldTerminate)
+		{
+			Mix_ReserveChannels(TTS_CHANNEL + 1);
+			Mix_PlayChannel(TTS_CHANNEL, chunk, 0);
+		}
+	}
+}
+
+// espeak gives mono 16 bits samples, SDL_mixer converts them to its format from a WAV in memory
+Mix_Chunk* TextToSpeech::synthesize(const std::string& text, const std::string& voice)
+{
+	std::string key = voice + "|" + text;
+
+	for (auto it = mCache.begin(); it != mCache.end(); it++)
+	{
+		if (it->key != key)
+			continue;
+
+		mCache.splice(mCache.begin(), mCache, it);
+		return mCache.front().chunk;
+	}
+
+	// No audio device
+	if (Mix_QuerySpec(nullptr, nullptr, nullptr) == 0)
+		return nullptr;
+
+	if (voice != mAppliedVoice)
+	{
+		if (espeak_SetVoiceByName(voice.c_str()) != EE_OK)
+			LOG(LogError) << "TTS::synthesize() - Failed to set the voice " << voice;
+
+		mAppliedVoice = voice;
+	}
+
+	sSynthSamples.clear();
+
+	if (espeak_Synth(text.c_str(), text.length() + 1, 0, POS_CHARACTER, 0, espeakCHARS_UTF8, NULL, NULL) != EE_OK)
+	{
+		LOG(LogError) << "TTS::synthesize() - Failed";
+		return nullptr;
+	}
+
+	if (sSpeechGeneration != sSynthGeneration || sSynthSamples.empty())
+		return nullptr;
+
+	uint32_t dataBytes = (uint32_t)(sSynthSamples.size() * sizeof(short));
+
+	std::vector<unsigned char> wav(44 + dataBytes);
+
+	auto write16 = [&wav](size_t offset, uint32_t value) { wav[offset] = value & 0xFF; wav[offset + 1] = (value >> 8) & 0xFF; };
+	auto write32 = [&write16](size_t offset, uint32_t value) { write16(offset, value & 0xFFFF); write16(offset + 2, value >> 16); };
+
+	memcpy(&wav[0], "RIFF", 4);
+	write32(4, 36 + dataBytes);
+	memcpy(&wav[8], "WAVEfmt ", 8);
+	write32(16, 16);
+	write16(20, 1); // PCM
+	write16(22, 1); // Mono
+	write32(24, sSampleRate);
+	write32(28, sSampleRate * 2);
+	write16(32, 2);
+	write16(34, 16);
+	memcpy(&wav[36], "data", 4);
+	write32(40, dataBytes);
+	memcpy(&wav[44], sSynthSamples.data(), dataBytes); // Little endian, as all the targets
+
+	Mix_Chunk* chunk = Mix_LoadWAV_RW(SDL_RWFromConstMem(wav.data(), (int)wav.size()), 1);
+	if (chunk == nullptr)
+		return nullptr;
+
+	CachedSpeech speech;
+	speech.key = key;
+	speech.chunk = chunk;
+	speech.bytes = chunk->alen;
+	mCache.push_front(speech);
+	mCacheBytes += speech.bytes;
+
+	// The least recently said go first, never the new one
+	while (mCacheBytes > TTS_CACHE_BYTES && mCache.size() > 1)
+	{
+		Mix_FreeChunk(mCache.back().chunk);
+		mCacheBytes -= mCache.back().bytes;
+		mCache.pop_back();
+	}
+
+	return chunk;
+}
 #endif
 
 std::weak_ptr<TextToSpeech> TextToSpeech::sInstance;
@@ -91,9 +240,16 @@ void TextToSpeech::init()
 	mShouldTerminate = false;
 	mSpeakThread = new std::thread(&TextToSpeech::SpeakThread, this);
 #elif defined(_ENABLE_TTS_)	
-	m_isAvailable = espeak_Initialize(AUDIO_OUTPUT_PLAYBACK, 0, NULL, 0) != EE_INTERNAL_ERROR;
+	int sampleRate = espeak_Initialize(AUDIO_OUTPUT_SYNCHRONOUS, 0, NULL, 0);
+	m_isAvailable = sampleRate != EE_INTERNAL_ERROR;
 	if (!m_isAvailable)
 		return;
+
+	sSampleRate = sampleRate;
+	espeak_SetSynthCallback(synthCallback);
+
+	mCacheBytes = 0;
+	mShouldTerminate = false;
 	
 	char* envv = getenv("LANGUAGE");
 	if (envv != nullptr && std::string(envv).length() >= 4) 
@@ -104,6 +260,8 @@ void TextToSpeech::init()
 		if (envv != nullptr && std::string(envv).length() >= 4)					
 			setLanguage(envv);					
 	}	
+
+	mSynthesisThread = new std::thread(&TextToSpeech::SynthesisThread, this);
 #endif
 }
 
@@ -128,6 +286,27 @@ void TextToSpeech::deinit()
 		mSpeakThread = nullptr;
 	}
 #elif defined(_ENABLE_TTS_)
+	if (mSynthesisThread != nullptr)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mShouldTerminate = true;
+			sSpeechGeneration++;
+		}
+
+		mEvent.notify_all();
+
+		mSynthesisThread->join();
+		delete mSynthesisThread;
+		mSynthesisThread = nullptr;
+	}
+
+	for (auto& speech : mCache)
+		Mix_FreeChunk(speech.chunk);
+
+	mCache.clear();
+	mCacheBytes = 0;
+
 	if (espeak_Terminate() != EE_OK) {
 		LOG(LogError) << "TTS::deinit() - Failed to terminate";
 	}
@@ -204,12 +383,13 @@ void TextToSpeech::setLanguage(const std::string language)
 	if (language_part1 == "zh_CN") voice = "Mandarin"; // or cantonese ?
 	if (language_part1 == "zh_TW") voice = "Mandarin"; // or cantonese ?
 
-	if (espeak_SetVoiceByName(voice.c_str()) == EE_OK) {
-		LOG(LogInfo) << "TTS::setLanguage() - set to " << language_part1 << " (" << voice << ")";
-	}
-	else {
-		LOG(LogError) << "TTS::setLanguage() - Failed with " << language_part1 << " (" << voice << ")";
+	// Applied by the synthesis thread
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mVoice = voice;
 	}
+
+	LOG(LogInfo) << "TTS::setLanguage() - set to " << language_part1 << " (" << voice << ")";
 #endif
 }
 
@@ -231,7 +411,12 @@ void TextToSpeech::say(const std::string text, bool expand, const std::string la
 	std::unique_lock<std::mutex> lock(mMutex);
 
 	if (!expand)
+	{
+		for (auto queued : mSpeechQueue)
+			delete queued;
+
 		mSpeechQueue.clear();
+	}
 
 	SpeakItem* item = new SpeakItem();
 	item->text = full;
@@ -242,18 +427,45 @@ void TextToSpeech::say(const std::string text, bool expand, const std::string la
 
 #elif defined(_ENABLE_TTS_)
 
-	if (expand == false && espeak_IsPlaying() == 1)
-		espeak_Cancel();
-	
-	if (espeak_Synth(text.c_str(),
-		text.length() * 4 /* potentially 4 bytes by char */,
-		0,
-		POS_CHARACTER,
-		0,
-		espeakCHARS_UTF8,
-		NULL,
-		NULL) != EE_OK) {
-		LOG(LogError) << "TTS::say() - Failed";
-	}	
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	// Queued, being synthesized or played : all stale
+	if (!expand)
+	{
+		mSpeechQueue.clear();
+		sSpeechGeneration++;
+
+		if (Mix_QuerySpec(nullptr, nullptr, nullptr) != 0)
+			Mix_HaltChannel(TTS_CHANNEL);
+	}
+
+	// Before the prepared ones
+	Utterance item;
+	item.text = text;
+	item.play = true;
+	mSpeechQueue.insert(std::find_if(mSpeechQueue.begin(), mSpeechQueue.end(), [](const Utterance& queued) { return !queued.play; }), item);
+
+	mEvent.notify_one();
+#endif
+}
+
+void TextToSpeech::prepare(const std::string& text)
+{
+	if (!m_isAvailable || !m_enabled || text.empty())
+		return;
+
+#if !WIN32 && defined(_ENABLE_TTS_)
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	for (auto& queued : mSpeechQueue)
+		if (queued.text == text)
+			return;
+
+	Utterance item;
+	item.text = text;
+	item.play = false;
+	mSpeechQueue.push_back(item);
+
+	mEvent.notify_one();
 #endif
 }
@@ -5,13 +5,17 @@
 #include <string>
 #include <memory>
 
-#if WIN32
+#if WIN32 || defined(_ENABLE_TTS_)
 #include <thread>
 #include <mutex>
 #include <list>
 #include <condition_variable>
 #endif
 
+#ifdef _ENABLE_TTS_
+struct Mix_Chunk;
+#endif
+
 /*!
 Singleton pattern. Call getInstance() to get an object.
 */
@@ -29,6 +33,9 @@ public:
 	void setLanguage(const std::string language);
 	void say(const std::string text, bool expand = false, const std::string lang = "");
 
+	// Synthesized into the cache without being said, for what the next moves will say ( "TTSPresynthesis" )
+	void prepare(const std::string& text);
+
 private:
 	TextToSpeech();
 	
@@ -56,6 +63,37 @@ private:
 	};
 
 	std::list<SpeakItem*>		mSpeechQueue;
+#elif defined(_ENABLE_TTS_)
+	// espeak synthesizes on this thread only, the speech is played by SDL_mixer on TTS_CHANNEL.
+	// A new say() ( not expanding ) drops the queue, aborts the synthesis in progress & stops the channel
+	void SynthesisThread();
+	Mix_Chunk* synthesize(const std::string& text, const std::string& voice);
+
+	std::thread*				mSynthesisThread;
+	std::mutex					mMutex;
+	std::condition_variable		mEvent;
+	bool						mShouldTerminate;
+
+	struct Utterance
+	{
+		std::string text;
+		bool play; // Otherwise prepared
+	};
+
+	std::list<Utterance>		mSpeechQueue;
+
+	struct CachedSpeech
+	{
+		std::string key; // voice|text
+		Mix_Chunk*	chunk;
+		size_t		bytes;
+	};
+
+	std::list<CachedSpeech>		mCache; // Most recently used first
+	size_t						mCacheBytes;
+
+	std::string					mVoice;
+	std::string					mAppliedVoice; // Synthesis thread
 #endif
 
 };
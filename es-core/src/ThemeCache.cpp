@@ -0,0 +1,281 @@
+#include "ThemeCache.h"
+
+#include "ThemeData.h"
+#include "resources/ResourceManager.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/BinaryStream.h"
+#include "utils/MemoryMappedFile.h"
+#include "utils/Platform.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <fstream>
+
+#define THEME_CACHE_MAGIC	0x43485445 // 'ETHC'
+#define THEME_CACHE_END		0x444E4545 // 'EEND'
+#define THEME_CACHE_VERSION	"1" // Increase when the parser or the cached structures change
+
+static void writeStringMap(Utils::BinaryWriter& writer, const std::map<std::string, std::string>& map)
+{
+	writer.writeUInt32((uint32_t)map.size());
+	for (auto& item : map)
+	{
+		writer.writeString(item.first);
+		writer.writeString(item.second);
+	}
+}
+
+static void readStringMap(Utils::BinaryReader& reader, std::map<std::string, std::string>& map)
+{
+	uint32_t count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		std::string name = reader.readString();
+		map[name] = reader.readString();
+	}
+}
+
+static void writeStringVector(Utils::BinaryWriter& writer, const std::vector<std::string>& values)
+{
+	writer.writeUInt32((uint32_t)values.size());
+	for (auto& value : values)
+		writer.writeString(value);
+}
+
+static void readStringVector(Utils::BinaryReader& reader, std::vector<std::string>& values)
+{
+	uint32_t count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+		values.push_back(reader.readString());
+}
+
+std::string ThemeCache::getFileStamp(const std::string& path)
+{
+	return std::to_string(Utils::FileSystem::getFileSize(path)) + "|" + std::to_string((long long)Utils::FileSystem::getFileModificationDate(path).getTime());
+}
+
+std::string ThemeCache::getCachePath(ThemeData* theme)
+{
+	std::string name = theme->getVariable("system.name");
+	if (name.empty())
+		name = theme->mSystemThemeFolder;
+
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/themes/" + name + ".cache");
+}
+
+std::string ThemeCache::getKey(ThemeData* theme, const std::string& path)
+{
+	std::string key = THEME_CACHE_VERSION "|" + path + "|" + theme->mSystemThemeFolder;
+
+	key += "|" + theme->mLanguage + "|" + theme->mLangAndRegion + "|" + theme->mRegion;
+	key += "|" + theme->mColorset + "|" + theme->mIconset + "|" + theme->mMenu + "|" + theme->mSystemview + "|" + theme->mGamelistview;
+
+	// Inputs of parseFilterAttributes
+	key += "|" + std::to_string(Renderer::getScreenWidth()) + "x" + std::to_string(Renderer::getScreenHeight());
+	key += Renderer::isSmallScreen() ? "|small" : "|";
+	key += Settings::getInstance()->getBool("ShowHelpPrompts") ? "|help" : "|";
+	key += "|" + Utils::Platform::getArchString();
+
+	// ThemeData::loadFile adjusts the carousel of some themes by name
+	key += "|" + Settings::getInstance()->getString("ThemeSet");
+
+	for (auto& var : theme->mVariables)
+		key += "|" + var.first + "=" + var.second;
+
+	return key;
+}
+
+bool ThemeCache::load(ThemeData* theme, const std::string& cachePath, const std::string& key)
+{
+	Utils::MemoryMappedFile file(cachePath);
+	if (!file.isOpen())
+		return false;
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (reader.readUInt32() != THEME_CACHE_MAGIC || reader.readString() != key)
+	{
+		LOG(LogDebug) << "ThemeCache : " << cachePath << " does not match the current configuration";
+		return false;
+	}
+
+	// Dependencies
+	uint32_t count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		std::string path = reader.readString();
+		std::string stamp = reader.readString();
+		if (!reader.failed() && getFileStamp(path) != stamp)
+		{
+			LOG(LogDebug) << "ThemeCache : " << path << " has changed";
+			return false;
+		}
+	}
+
+	count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		std::string path = reader.readString();
+		bool exists = reader.readUInt8() != 0;
+		if (!reader.failed() && ResourceManager::getInstance()->fileExists(path) != exists)
+		{
+			LOG(LogDebug) << "ThemeCache : " << path << (exists ? " has been removed" : " has been added");
+			return false;
+		}
+	}
+
+	count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		std::string name = reader.readString();
+		std::string value = reader.readString();
+		if (!reader.failed() && Settings::getInstance()->getString(name) != value)
+			return false;
+	}
+
+	// Theme
+	float version = reader.readFloat();
+	std::string systemThemeFolder = reader.readString();
+	std::string defaultView = reader.readString();
+	std::string defaultTransition = reader.readString();
+
+	std::map<std::string, std::string> variables;
+	readStringMap(reader, variables);
+
+	Utils::MathExpr::ValueMap evaluatorVariables;
+
+	count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		Utils::MathExpr::Value& value = evaluatorVariables[reader.readString()];
+		value.type = reader.readUInt8();
+		value.number = reader.readFloat();
+		value.string = reader.readString();
+	}
+
+	std::vector<Subset> subsets;
+
+	count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		std::string subset = reader.readString();
+		std::string name = reader.readString();
+		std::string displayName = reader.readString();
+		std::string subSetDisplayName = reader.readString();
+
+		subsets.push_back(Subset(subset, name, displayName, subSetDisplayName));
+		readStringVector(reader, subsets.back().appliesTo);
+	}
+
+	ThemeData::UnsortedViewMap views;
+
+	count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		views.push_back(std::pair<std::string, ThemeData::ThemeView>(reader.readString(), ThemeData::ThemeView()));
+		ThemeData::ThemeView& view = views.back().second;
+
+		uint32_t elementCount = reader.readUInt32();
+		for (uint32_t e = 0; e < elementCount && !reader.failed(); e++)
+		{
+			std::string name = reader.readString();
+			std::shared_ptr<ThemeData::ThemeElement> element = std::make_shared<ThemeData::ThemeElement>();
+			element->loadFromBinary(reader);
+			view.elements[name] = element;
+		}
+
+		readStringVector(reader, view.orderedKeys);
+		view.baseType = reader.readString();
+		readStringVector(reader, view.baseTypes);
+		view.displayName = reader.readString();
+		view.isCustomView = reader.readUInt8() != 0;
+	}
+
+	if (reader.failed() || reader.readUInt32() != THEME_CACHE_END)
+	{
+		LOG(LogWarning) << "ThemeCache : " << cachePath << " is invalid";
+		return false;
+	}
+
+	theme->mVersion = version;
+	theme->mSystemThemeFolder = systemThemeFolder;
+	theme->mDefaultView = defaultView;
+	theme->mDefaultTransition = defaultTransition;
+	theme->mVariables.swap(variables);
+	theme->mEvaluatorVariables.swap(evaluatorVariables);
+	theme->mSubsets.swap(subsets);
+	theme->mViews.swap(views);
+
+	return true;
+}
+
+void ThemeCache::save(ThemeData* theme, const std::string& cachePath, const std::string& key, const ThemeCacheDependencies& dependencies)
+{
+	Utils::BinaryWriter writer;
+	writer.writeUInt32(THEME_CACHE_MAGIC);
+	writer.writeString(key);
+
+	// Dependencies
+	writeStringMap(writer, dependencies.files);
+
+	writer.writeUInt32((uint32_t)dependencies.paths.size());
+	for (auto& path : dependencies.paths)
+	{
+		writer.writeString(path.first);
+		writer.writeUInt8(path.second ? 1 : 0);
+	}
+
+	writeStringMap(writer, dependencies.settings);
+
+	// Theme
+	writer.writeFloat(theme->mVersion);
+	writer.writeString(theme->mSystemThemeFolder);
+	writer.writeString(theme->mDefaultView);
+	writer.writeString(theme->mDefaultTransition);
+
+	writeStringMap(writer, theme->mVariables);
+
+	writer.writeUInt32((uint32_t)theme->mEvaluatorVariables.size());
+	for (auto& var : theme->mEvaluatorVariables)
+	{
+		writer.writeString(var.first);
+		writer.writeUInt8((uint8_t)var.second.type);
+		writer.writeFloat(var.second.number);
+		writer.writeString(var.second.string);
+	}
+
+	writer.writeUInt32((uint32_t)theme->mSubsets.size());
+	for (auto& subset : theme->mSubsets)
+	{
+		writer.writeString(subset.subset);
+		writer.writeString(subset.name);
+		writer.writeString(subset.displayName);
+		writer.writeString(subset.subSetDisplayName);
+		writeStringVector(writer, subset.appliesTo);
+	}
+
+	writer.writeUInt32((uint32_t)theme->mViews.size());
+	for (auto& view : theme->mViews)
+	{
+		writer.writeString(view.first);
+
+		writer.writeUInt32((uint32_t)view.second.elements.size());
+		for (auto& element : view.second.elements)
+		{
+			writer.writeString(element.first);
+			element.second->saveToBinary(writer);
+		}
+
+		writeStringVector(writer, view.second.orderedKeys);
+		writer.writeString(view.second.baseType);
+		writeStringVector(writer, view.second.baseTypes);
+		writer.writeString(view.second.displayName);
+		writer.writeUInt8(view.second.isCustomView ? 1 : 0);
+	}
+
+	writer.writeUInt32(THEME_CACHE_END);
+
+	if (!Utils::FileSystem::writeFileAtomic(cachePath, writer))
+		LOG(LogWarning) << "ThemeCache : Unable to write " << cachePath;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#ifndef ES_CORE_THEME_CACHE_H
+#define ES_CORE_THEME_CACHE_H
+
+#include <string>
+#include <map>
+
+class ThemeData;
+
+// What a theme load has read, besides the inputs of its key. Recorded while parsing, checked again before a cached theme is used
+struct ThemeCacheDependencies
+{
+	std::map<std::string, std::string>	files;		// xml files -> ThemeCache::getFileStamp
+	std::map<std::string, bool>			paths;		// tested paths -> exists
+	std::map<std::string, std::string>	settings;	// subset settings -> value
+};
+
+// Compiled theme cache : the views & elements of a system's theme, once variables, subsets and filters are resolved.
+// One file per system, keyed by the theme path, the system variables, the selected subsets, language, region & screen.
+class ThemeCache
+{
+public:
+	// Both are computed before the theme is parsed
+	static std::string getCachePath(ThemeData* theme);
+	static std::string getKey(ThemeData* theme, const std::string& path);
+
+	// Restores the theme if the cache matches the key and none of its dependencies has changed
+	static bool load(ThemeData* theme, const std::string& cachePath, const std::string& key);
+	static void save(ThemeData* theme, const std::string& cachePath, const std::string& key, const ThemeCacheDependencies& dependencies);
+
+	// Size & modification date of a file
+	static std::string getFileStamp(const std::string& path);
+};
+
+#endif // ES_CORE_THEME_CACHE_H
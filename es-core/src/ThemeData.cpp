@@ -1,4 +1,5 @@
 #include "ThemeData.h"
+#include "ThemeCache.h"
 
 #include "components/ImageComponent.h"
 #include "components/TextComponent.h"
@@ -19,11 +20,21 @@
 #include "Settings.h"
 #include "SystemConf.h"
 #include <algorithm>
+#include <stdexcept>
+#include <mutex>
+#include <cstring>
 #include "LocaleES.h"
 #include "anim/ThemeStoryboard.h"
 #include "Paths.h"
 #include "utils/HtmlColor.h"
 #include "utils/VectorEx.h"
+#include "utils/StringPool.h"
+#include "utils/StringTemplate.h"
+#include "utils/BinaryStream.h"
+#include "utils/ThreadPool.h"
+#include "ImageIO.h"
+#include "Trace.h"
+#include <set>
 
 std::vector<std::string> ThemeData::sSupportedViews{ { "system" }, { "basic" }, { "detailed" }, { "grid" }, { "video" }, { "gamecarousel" }, { "menu" }, { "screen" }, { "splash" } };
 std::vector<std::string> ThemeData::sSupportedFeatures { { "video" }, { "carousel" }, { "gamecarousel" }, { "z-index" }, { "visible" },{ "manufacturer" } };
@@ -61,7 +72,8 @@ std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>> The
 		{ "offset", NORMALIZED_PAIR },
 		{ "offsetX", FLOAT },
 		{ "offsetY", FLOAT },
-		{ "clipRect", NORMALIZED_RECT } } },
+		{ "clipRect", NORMALIZED_RECT },
+		{ "renderCache", BOOLEAN } } },
 
 	{ "stackpanel", {		
 		{ "pos", NORMALIZED_PAIR },
@@ -70,6 +82,7 @@ std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>> The
 		{ "reverse", BOOLEAN },
 		{ "separator", FLOAT },
 		{ "visible", BOOLEAN },
+		{ "renderCache", BOOLEAN },
 		{ "zIndex", FLOAT } } },
 
 	{ "shader", {
@@ -120,6 +133,7 @@ std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>> The
 		{ "flipY", BOOLEAN },
 		{ "onclick", STRING },
 		{ "linearSmooth", BOOLEAN },
+		{ "renderCache", BOOLEAN },
 		{ "zIndex", FLOAT } } },
 
 	{ "imagegrid", {
@@ -230,6 +244,7 @@ std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>> The
 		{ "padding", NORMALIZED_RECT },
 		{ "onclick", STRING },
 		{ "visible", BOOLEAN },
+		{ "renderCache", BOOLEAN },
 		{ "zIndex", FLOAT } } },
 
 	{ "textlist", {
@@ -286,6 +301,7 @@ std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>> The
 		{ "size", NORMALIZED_PAIR },
 	 	{ "origin", NORMALIZED_PAIR },
 	 	{ "visible", BOOLEAN },
+		{ "renderCache", BOOLEAN },
 	 	{ "zIndex", FLOAT } } },
 
 	{ "ninepatch", {
@@ -312,6 +328,7 @@ std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>> The
 		{ "edgeColor", COLOR },
 		{ "animateColor", COLOR },
 		{ "animateColorTime", FLOAT },
+		{ "renderCache", BOOLEAN },
 		{ "zIndex", FLOAT } } },
 
 	{ "datetime", {
@@ -598,38 +615,224 @@ std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>> The
 std::shared_ptr<ThemeData::ThemeMenu> ThemeData::mMenuTheme;
 ThemeData* ThemeData::mDefaultTheme = nullptr;
 
+// Same order as ThemeProperties::PropertyId
+static const char* sPropertyNames[ThemeProperties::COUNT] =
+{
+	"",
+
+	"pos", "size", "x", "y", "w", "h", "origin", "rotation", "rotationOrigin", "scale", "scaleOrigin", "zIndex", "visible",
+	"offset", "offsetX", "offsetY", "clipRect", "opacity", "onclick", "renderCache",
+
+	"path", "default", "color", "colorEnd", "gradientType", "maxSize", "minSize", "tile", "flipX", "flipY",
+	"roundCorners", "saturation", "reflexion", "reflexionOnFrame", "padding", "linearSmooth",
+
+	"text", "fontPath", "fontSize", "alignment", "horizontalAlignment", "verticalAlignment", "forceUppercase", "lineSpacing",
+	"backgroundColor", "glowColor", "glowSize", "glowOffset", "singleLineScroll", "autoScroll"
+};
+
+// Names which are not known when the registry is built ( bindings, shader parameters... ) are interned in the StringPool
+#define THEME_PROPERTY_DYNAMIC	0x40000000
+
+// Every property name declared in sElementMap gets a fixed id, the registry is never modified after it's built : lookups don't lock
+struct ThemePropertyRegistry
+{
+	ThemePropertyRegistry(const std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>>& elementMap)
+	{
+		for (unsigned int i = 0; i < ThemeProperties::COUNT; i++)
+		{
+			names.push_back(sPropertyNames[i]);
+			ids[names.back()] = i;
+		}
+
+		for (auto& element : elementMap)
+		{
+			for (auto& prop : element.second)
+			{
+				if (ids.find(prop.first) != ids.cend())
+					continue;
+
+				ids[prop.first] = (unsigned int)names.size();
+				names.push_back(prop.first);
+			}
+		}
+	}
+
+	std::vector<std::string> names;
+	std::unordered_map<std::string, unsigned int> ids;
+};
+
+static const ThemePropertyRegistry& getPropertyRegistry(const std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>>& elementMap)
+{
+	static ThemePropertyRegistry registry(elementMap);
+	return registry;
+}
+
+unsigned int ThemeData::getPropertyId(const std::string& name, bool create)
+{
+	const ThemePropertyRegistry& registry = getPropertyRegistry(sElementMap);
+
+	auto it = registry.ids.find(name);
+	if (it != registry.ids.cend())
+		return it->second;
+
+	unsigned int id = create ? Utils::StringPool::intern(name) : Utils::StringPool::find(name);
+	return id == 0 ? ThemeProperties::INVALID : THEME_PROPERTY_DYNAMIC | id;
+}
+
+const std::string& ThemeData::getPropertyName(unsigned int id)
+{
+	if (id & THEME_PROPERTY_DYNAMIC)
+		return Utils::StringPool::get(id & ~THEME_PROPERTY_DYNAMIC);
+
+	const ThemePropertyRegistry& registry = getPropertyRegistry(sElementMap);
+	if (id < registry.names.size())
+		return registry.names[id];
+
+	return registry.names[ThemeProperties::INVALID];
+}
+
+ThemeData::ThemeElement::PropertyMap::iterator ThemeData::ThemeElement::PropertyMap::find(unsigned int id)
+{
+	auto it = std::lower_bound(mItems.begin(), mItems.end(), id, [](const value_type& item, unsigned int value) { return item.first.id < value; });
+	if (it != mItems.end() && it->first.id == id)
+		return it;
+
+	return mItems.end();
+}
+
+ThemeData::ThemeElement::PropertyMap::const_iterator ThemeData::ThemeElement::PropertyMap::find(unsigned int id) const
+{
+	auto it = std::lower_bound(mItems.cbegin(), mItems.cend(), id, [](const value_type& item, unsigned int value) { return item.first.id < value; });
+	if (it != mItems.cend() && it->first.id == id)
+		return it;
+
+	return mItems.cend();
+}
+
+ThemeData::ThemeElement::Property& ThemeData::ThemeElement::PropertyMap::operator[](unsigned int id)
+{
+	auto it = std::lower_bound(mItems.begin(), mItems.end(), id, [](const value_type& item, unsigned int value) { return item.first.id < value; });
+	if (it != mItems.end() && it->first.id == id)
+		return it->second;
+
+	return mItems.insert(it, value_type(id, Property()))->second;
+}
+
+ThemeData::ThemeElement::Property& ThemeData::ThemeElement::PropertyMap::operator[](const std::string& name)
+{
+	unsigned int id = ThemeData::getPropertyId(name, true);
+	if (id != ThemeProperties::INVALID)
+		return (*this)[id];
+
+	// No id for this name ( string pool full ) : the value is dropped instead of being stored as another property
+	LOG(LogError) << "ThemeData : unable to register the property \"" << name << "\"";
+
+	thread_local Property dropped;
+	dropped = Property();
+	return dropped;
+}
+
+const ThemeData::ThemeElement::Property& ThemeData::ThemeElement::PropertyMap::at(unsigned int id) const
+{
+	auto it = find(id);
+	if (it == mItems.cend())
+		throw std::out_of_range("ThemeElement property");
+
+	return it->second;
+}
+
+void ThemeData::ThemeElement::PropertyMap::erase(unsigned int id)
+{
+	auto it = find(id);
+	if (it != mItems.end())
+		mItems.erase(it);
+}
+
 #define MINIMUM_THEME_FORMAT_VERSION 3
 #define CURRENT_THEME_FORMAT_VERSION 6
 
 
+// Compiled "${variable}" templates, by source string. Shared by every system, released with the theme file cache
+static std::mutex sPlaceholderTemplatesLock;
+static std::unordered_map<std::string, std::shared_ptr<Utils::StringTemplate>> sPlaceholderTemplates;
+
+// Parsed values, by type & source string : the systems of a theme repeat the same ones
+static std::mutex sParsedValuesLock;
+static std::unordered_map<std::string, ThemeData::ThemeElement::Property> sParsedValues[ThemeData::BOOLEAN + 1];
+
+ThemeData::ThemeElement::Property ThemeData::parseValue(ElementPropertyType type, const std::string& str)
+{
+	{
+		std::unique_lock<std::mutex> lock(sParsedValuesLock);
+
+		auto it = sParsedValues[type].find(str);
+		if (it != sParsedValues[type].cend())
+			return it->second;
+	}
+
+	ThemeElement::Property value;
+
+	switch (type)
+	{
+	case NORMALIZED_RECT:
+		value = Vector4f::parseString(str);
+		break;
+	case NORMALIZED_PAIR:
+		value = Vector2f::parseString(str);
+		break;
+	case COLOR:
+		value = Utils::HtmlColor::parse(str);
+		break;
+	case FLOAT:
+		value = Utils::String::toFloat(str);
+		break;
+	default:
+		value = str;
+		break;
+	}
+
+	std::unique_lock<std::mutex> lock(sParsedValuesLock);
+	sParsedValues[type][str] = value;
+	return value;
+}
+
 std::string ThemeData::resolvePlaceholders(const char* in)
 {
 	if (in == nullptr || in[0] == 0)
-		return in;
+		return "";
 
-	auto begin = strstr(in, "${");
-	if (begin == nullptr)
+	if (strstr(in, "${") == nullptr)
 		return in;
 
-	auto end = strstr(begin, "}");
-	if (end == nullptr)
-		return in;
+	std::shared_ptr<Utils::StringTemplate> compiled;
 
-	std::string inStr(in);
+	{
+		std::unique_lock<std::mutex> lock(sPlaceholderTemplatesLock);
 
-	const size_t variableBegin = begin - in;
-	const size_t variableEnd = end - in;
+		auto it = sPlaceholderTemplates.find(in);
+		if (it != sPlaceholderTemplates.cend())
+			compiled = it->second;
+		else
+		{
+			static const std::vector<Utils::StringTemplate::Delimiter> delimiters = { { "${", "}" } };
 
-	std::string prefix  = inStr.substr(0, variableBegin);
-	std::string replace = inStr.substr(variableBegin + 2, variableEnd - (variableBegin + 2));
-	std::string suffix = resolvePlaceholders(end + 1);
+			compiled = std::make_shared<Utils::StringTemplate>(in, delimiters);
+			sPlaceholderTemplates[in] = compiled;
+		}
+	}
 
-	return prefix + mVariables[replace] + suffix;
+	return compiled->evaluate([this](std::string& output, int kind, const std::string& name)
+	{
+		auto it = mVariables.find(name);
+		if (it != mVariables.cend())
+			output.append(it->second);
+	});
 }
 
 ThemeData::ThemeData()
 {	
 	mPerGameOverrideTmp = false;
+	mTrackDependencies = false;
 	mColorset = Settings::getInstance()->getString("ThemeColorSet");
 	mIconset = Settings::getInstance()->getString("ThemeIconSet");
 	mMenu = Settings::getInstance()->getString("ThemeMenu");
@@ -659,6 +862,307 @@ ThemeData::ThemeData()
 	mVersion = 0;
 }
 
+// Parsed theme files, shared by the ThemeData of every system : they mostly include the same files ( colors, fonts, common views... ).
+// Cached documents are read-only, they can be parsed by several threads at once
+struct ThemeFileCacheEntry
+{
+	std::string stamp;
+	std::shared_ptr<pugi::xml_document> doc;
+};
+
+static std::mutex sThemeFileCacheLock;
+static std::map<std::string, ThemeFileCacheEntry> sThemeFileCache;
+
+// Changes that the parser used to make in the document itself, done once when a file is loaded.
+// <subset> attributes are copied to their includes : they are resolved later, for each system
+static void normalizeThemeDocument(pugi::xml_node parent)
+{
+	for (pugi::xml_node node = parent.first_child(); node; node = node.next_sibling())
+	{
+		if (strcmp(node.name(), "subset") == 0)
+		{
+			const std::string name = node.attribute("name").as_string();
+			const std::string displayName = node.attribute("displayName").as_string();
+			const std::string appliesTo = node.attribute("appliesTo").as_string();
+
+			for (pugi::xml_node include = node.child("include"); include; include = include.next_sibling("include"))
+			{
+				include.remove_attribute("subset");
+				include.append_attribute("subset") = name.c_str();
+
+				if (!appliesTo.empty())
+				{
+					include.remove_attribute("appliesTo");
+					include.append_attribute("appliesTo") = appliesTo.c_str();
+				}
+
+				if (!displayName.empty())
+				{
+					include.remove_attribute("subSetDisplayName");
+					include.append_attribute("subSetDisplayName") = displayName.c_str();
+				}
+			}
+		}
+
+		normalizeThemeDocument(node);
+	}
+}
+
+std::shared_ptr<pugi::xml_document> ThemeData::loadThemeDocument(const std::string& path, bool fromFile, pugi::xml_parse_result& result)
+{
+	std::shared_ptr<pugi::xml_document> doc = std::make_shared<pugi::xml_document>();
+
+	if (!fromFile)
+	{
+		result = doc->load_string(path.c_str());
+		if (result)
+			normalizeThemeDocument(*doc);
+
+		return doc;
+	}
+
+	std::string stamp = ThemeCache::getFileStamp(path);
+
+	{
+		std::unique_lock<std::mutex> lock(sThemeFileCacheLock);
+
+		auto it = sThemeFileCache.find(path);
+		if (it != sThemeFileCache.cend() && it->second.stamp == stamp)
+		{
+			result = pugi::xml_parse_result();
+			result.status = pugi::status_ok;
+			return it->second.doc;
+		}
+	}
+
+	result = doc->load_file(WINSTRINGW(path).c_str());
+	if (!result)
+		return doc;
+
+	normalizeThemeDocument(*doc);
+
+	std::unique_lock<std::mutex> lock(sThemeFileCacheLock);
+
+	ThemeFileCacheEntry& entry = sThemeFileCache[path];
+	entry.stamp = stamp;
+	entry.doc = doc;
+
+	return doc;
+}
+
+bool ThemeData::themeFileExists(const std::string& path)
+{
+	bool exists = ResourceManager::getInstance()->fileExists(path);
+
+	if (mTrackDependencies)
+		mDependencies.paths.insert(std::pair<std::string, bool>(path, exists));
+
+	return exists;
+}
+
+std::string ThemeData::getSubsetSetting(const std::string& name)
+{
+	std::string value = Settings::getInstance()->getString(name);
+
+	if (mTrackDependencies)
+		mDependencies.settings.insert(std::pair<std::string, std::string>(name, value));
+
+	return value;
+}
+
+void ThemeData::trackThemeFile(const std::string& path)
+{
+	if (mTrackDependencies)
+		mDependencies.files.insert(std::pair<std::string, std::string>(path, ThemeCache::getFileStamp(path)));
+}
+
+void ThemeData::clearFileCache()
+{
+	std::unique_lock<std::mutex> lock(sThemeFileCacheLock);
+	sThemeFileCache.clear();
+
+	std::unique_lock<std::mutex> templatesLock(sPlaceholderTemplatesLock);
+	sPlaceholderTemplates.clear();
+
+	std::unique_lock<std::mutex> valuesLock(sParsedValuesLock);
+	for (auto& values : sParsedValues)
+		values.clear();
+}
+
+// Elements of the loaded themes, by hash of their binary form. Systems using the same theme define most of their elements identically :
+// they all reference the first one loaded. Pooled elements are read-only, ThemeView::getElementForWrite copies them
+struct SharedThemeElement
+{
+	std::weak_ptr<ThemeData::ThemeElement> element;
+	size_t memUsage;
+};
+
+static std::mutex sElementPoolLock;
+static std::unordered_multimap<size_t, SharedThemeElement> sElementPool;
+
+static std::shared_ptr<ThemeData::ThemeElement> shareElement(const std::shared_ptr<ThemeData::ThemeElement>& element)
+{
+	if (element->shared)
+		return element;
+
+	Utils::BinaryWriter writer;
+	element->saveToBinary(writer);
+
+	size_t hash = std::hash<std::string>()(writer.buffer());
+
+	std::unique_lock<std::mutex> lock(sElementPoolLock);
+
+	auto range = sElementPool.equal_range(hash);
+	for (auto it = range.first; it != range.second; )
+	{
+		auto candidate = it->second.element.lock();
+		if (candidate == nullptr)
+		{
+			it = sElementPool.erase(it);
+			continue;
+		}
+
+		Utils::BinaryWriter other;
+		candidate->saveToBinary(other);
+		if (other.buffer() == writer.buffer())
+			return candidate;
+
+		it++;
+	}
+
+	element->shared = true;
+
+	SharedThemeElement entry;
+	entry.element = element;
+	entry.memUsage = element->getMemUsage();
+	sElementPool.insert(std::pair<size_t, SharedThemeElement>(hash, entry));
+
+	return element;
+}
+
+void ThemeData::shareElements()
+{
+	for (auto& view : mViews)
+		for (auto& element : view.second.elements)
+			element.second = shareElement(element.second);
+}
+
+size_t ThemeData::getTotalMemUsage()
+{
+	size_t total = 0;
+
+	std::unique_lock<std::mutex> lock(sElementPoolLock);
+
+	for (auto it = sElementPool.begin(); it != sElementPool.end(); )
+	{
+		if (it->second.element.expired())
+		{
+			it = sElementPool.erase(it);
+			continue;
+		}
+
+		total += it->second.memUsage;
+		it++;
+	}
+
+	return total;
+}
+
+static bool isImagePath(const std::string& path)
+{
+	auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(path));
+	return ext == ".jpg" || ext == ".png" || ext == ".jpeg" || ext == ".gif";
+}
+
+static void collectPaths(const ThemeData::ThemeElement& element, const std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>>& elementMap, bool (*filter)(const std::string&), std::set<std::string>& paths)
+{
+	auto typeMap = elementMap.find(element.type);
+	if (typeMap != elementMap.cend())
+	{
+		for (auto& prop : element.properties)
+		{
+			if (prop.second.type != ThemeData::ThemeElement::Property::PropertyType::String || prop.second.s.empty())
+				continue;
+
+			auto type = typeMap->second.find(prop.first);
+			if (type == typeMap->second.cend() || type->second != ThemeData::PATH)
+				continue;
+
+			// Embedded resources & bindings are resolved when the component loads them
+			const std::string& path = prop.second.s;
+			if (path[0] == ':' || path.find('{') != std::string::npos)
+				continue;
+
+			if (filter(path))
+				paths.insert(path);
+		}
+	}
+
+	for (auto& child : element.children)
+		collectPaths(child.second, elementMap, filter, paths);
+}
+
+void ThemeData::preloadImageSizes(const std::vector<ThemeData*>& themes)
+{
+	// Sizes are only needed to queue textures asynchronously
+	if (!Settings::get(BoolSetting::AsyncImages))
+		return;
+
+	TraceSpan span("preloadImageSizes");
+
+	std::set<const ThemeElement*> elements;
+	std::set<std::string> paths;
+
+	for (auto theme : themes)
+		for (auto& view : theme->mViews)
+			for (auto& element : view.second.elements)
+				if (elements.insert(element.second.get()).second)
+					collectPaths(*element.second, sElementMap, isImagePath, paths);
+
+	if (paths.empty())
+		return;
+
+	Utils::ThreadPool pool(TaskScheduler::TEXTURE_IO);
+
+	for (auto& path : paths)
+	{
+		pool.queueWorkItem([path]
+		{
+			unsigned int x, y;
+			ImageIO::loadImageSize(path, &x, &y);
+		});
+	}
+
+	pool.wait();
+
+	LOG(LogDebug) << "ThemeData::preloadImageSizes : " << paths.size() << " images probed";
+}
+
+std::vector<std::string> ThemeData::getSoundPaths(const std::vector<ThemeData*>& themes)
+{
+	std::set<const ThemeElement*> elements;
+	std::set<std::string> paths;
+
+	for (auto theme : themes)
+		for (auto& view : theme->mViews)
+			for (auto& element : view.second.elements)
+				if (elements.insert(element.second.get()).second)
+					collectPaths(*element.second, sElementMap, Utils::FileSystem::isAudio, paths);
+
+	return std::vector<std::string>(paths.cbegin(), paths.cend());
+}
+
+ThemeData::ThemeElement& ThemeData::ThemeView::getElementForWrite(const std::string& name)
+{
+	auto& element = elements[name];
+	if (element == nullptr)
+		element = std::make_shared<ThemeElement>();
+	else if (element->shared || element.use_count() > 1)
+		element = std::make_shared<ThemeElement>(*element);
+
+	return *element;
+}
+
 void ThemeData::loadFile(const std::string system, std::map<std::string, std::string> sysDataMap, const std::string& path, bool fromFile)
 {
 	mPaths.push_back(path);
@@ -690,12 +1194,41 @@ void ThemeData::loadFile(const std::string system, std::map<std::string, std::st
 			mEvaluatorVariables[var.first] = var.second;		
 	}
 
-	pugi::xml_document doc;
-	pugi::xml_parse_result res = fromFile ? doc.load_file(WINSTRINGW(path).c_str()) : doc.load_string(path.c_str());
+	// Configurations that have already been parsed are restored from the compiled theme cache
+	mTrackDependencies = false;
+	mDependencies = ThemeCacheDependencies();
+
+	std::string cachePath;
+	std::string cacheKey;
+
+	if (fromFile && Settings::getInstance()->getBool("ThemeCache"))
+	{
+		cachePath = ThemeCache::getCachePath(this);
+		cacheKey = ThemeCache::getKey(this, path);
+
+		if (ThemeCache::load(this, cachePath, cacheKey))
+		{
+			shareElements();
+
+			if (system != "splash" && system != "imageviewer")
+			{
+				mMenuTheme = nullptr;
+				mDefaultTheme = this;
+			}
+
+			return;
+		}
+
+		mTrackDependencies = true;
+		trackThemeFile(path);
+	}
+
+	pugi::xml_parse_result res;
+	std::shared_ptr<pugi::xml_document> doc = loadThemeDocument(path, fromFile, res);
 	if(!res)
 		throw error << "XML parsing error: \n    " << res.description();
 
-	pugi::xml_node root = doc.child("theme");
+	pugi::xml_node root = doc->child("theme");
 	if(!root)
 		throw error << "Missing <theme> tag!";
 
@@ -719,13 +1252,22 @@ void ThemeData::loadFile(const std::string system, std::map<std::string, std::st
 			auto systemcarousel = systemView->second.elements.find("systemcarousel");
 			if (systemcarousel != systemView->second.elements.cend())
 			{
-				auto defaultTransition = systemcarousel->second.properties.find("defaultTransition");
-				if (defaultTransition == systemcarousel->second.properties.cend() || defaultTransition->second.s == "instant")
-					systemcarousel->second.properties["defaultTransition"] = std::string("fade & slide");
+				auto defaultTransition = systemcarousel->second->properties.find("defaultTransition");
+				if (defaultTransition == systemcarousel->second->properties.cend() || defaultTransition->second.s == "instant")
+					systemView->second.getElementForWrite("systemcarousel").properties["defaultTransition"] = std::string("fade & slide");
 			}
 		}
 	}
 
+	if (mTrackDependencies)
+	{
+		mTrackDependencies = false;
+		ThemeCache::save(this, cachePath, cacheKey, mDependencies);
+		mDependencies = ThemeCacheDependencies();
+	}
+
+	shareElements();
+
 	if (system != "splash" && system != "imageviewer")
 	{
 		mMenuTheme = nullptr;
@@ -770,7 +1312,7 @@ std::string ThemeData::resolveSystemVariable(const std::string& systemThemeFolde
 	{
 		result.replace(start_pos, 7, systemThemeFolder);
 
-		if (!Utils::FileSystem::exists(result))
+		if (!themeFileExists(result))
 		{
 			std::string compatibleFolder = systemThemeFolder;
 
@@ -862,7 +1404,7 @@ bool ThemeData::parseSubset(const pugi::xml_node& node)
 	
 	if (subsetAttr == "colorset")
 	{
-		std::string perSystemSetName = Settings::getInstance()->getString("subset." + mSystemThemeFolder + ".colorset");
+		std::string perSystemSetName = getSubsetSetting("subset." + mSystemThemeFolder + ".colorset");
 		if (!perSystemSetName.empty())
 		{
 			if (nameAttr == perSystemSetName)
@@ -873,7 +1415,7 @@ bool ThemeData::parseSubset(const pugi::xml_node& node)
 	}
 	else if (subsetAttr == "iconset")
 	{
-		std::string perSystemSetName = Settings::getInstance()->getString("subset." + mSystemThemeFolder + ".iconset");
+		std::string perSystemSetName = getSubsetSetting("subset." + mSystemThemeFolder + ".iconset");
 		if (!perSystemSetName.empty())
 		{
 			if (nameAttr == perSystemSetName)
@@ -894,7 +1436,7 @@ bool ThemeData::parseSubset(const pugi::xml_node& node)
 	}
 	else if (subsetAttr == "gamelistview")
 	{
-		std::string perSystemSetName = Settings::getInstance()->getString("subset." + mSystemThemeFolder + ".gamelistview");
+		std::string perSystemSetName = getSubsetSetting("subset." + mSystemThemeFolder + ".gamelistview");
 		if (!perSystemSetName.empty())
 		{
 			if (nameAttr == perSystemSetName)
@@ -905,7 +1447,7 @@ bool ThemeData::parseSubset(const pugi::xml_node& node)
 	}
 	else
 	{
-		std::string perSystemSetName = Settings::getInstance()->getString("subset." + mSystemThemeFolder + "." + subsetAttr);
+		std::string perSystemSetName = getSubsetSetting("subset." + mSystemThemeFolder + "." + subsetAttr);
 		if (!perSystemSetName.empty())
 		{
 			if (nameAttr == perSystemSetName)
@@ -913,7 +1455,7 @@ bool ThemeData::parseSubset(const pugi::xml_node& node)
 		}
 		else
 		{
-			std::string setID = Settings::getInstance()->getString("subset." + subsetAttr);
+			std::string setID = getSubsetSetting("subset." + subsetAttr);
 			if (nameAttr == setID || (setID.empty() && isFirstSubset(node)))
 				return true;
 		}
@@ -938,12 +1480,12 @@ void ThemeData::parseInclude(const pugi::xml_node& node)
 
 	std::string path = Utils::FileSystem::resolveRelativePath(resolveSystemVariable(mSystemThemeFolder, relPath), Utils::FileSystem::getParent(mPaths.back()), true);
 
-	if (!ResourceManager::getInstance()->fileExists(path))
+	if (!themeFileExists(path))
 	{
 		if (relPath.find("$") != std::string::npos && relPath.find("${") == std::string::npos)
 		{
 			path = Utils::FileSystem::resolveRelativePath(resolveSystemVariable("default", relPath), Utils::FileSystem::getParent(mPaths.back()), true);
-			if (ResourceManager::getInstance()->fileExists(path))
+			if (themeFileExists(path))
 			{
 				if (mPaths.size() == 1)
 					mSystemThemeFolder = "default";
@@ -1224,10 +1766,10 @@ bool ThemeData::parseFilterAttributes(const pugi::xml_node& node)
 				const std::string subsetToFind = Utils::String::trim(splits[0]);
 				const std::string subsetValue = Utils::String::trim(splits[1]);
 
-				std::string selectedSubset = Settings::getInstance()->getString("subset." + mSystemThemeFolder + "." + subsetToFind);
+				std::string selectedSubset = getSubsetSetting("subset." + mSystemThemeFolder + "." + subsetToFind);
 				if (selectedSubset.empty())
 				{
-					selectedSubset = Settings::getInstance()->getString("subset." + subsetToFind);
+					selectedSubset = getSubsetSetting("subset." + subsetToFind);
 
 					if (subsetToFind == "systemview")
 						selectedSubset = mSystemview;
@@ -1323,29 +1865,9 @@ void ThemeData::parseSubsetElement(const pugi::xml_node& root)
 	if (!parseFilterAttributes(root))
 		return;
 
-	const std::string name = root.attribute("name").as_string();
-	const std::string displayName = resolvePlaceholders(root.attribute("displayName").as_string());
-	const std::string appliesTo = root.attribute("appliesTo").as_string();
-
+	// The subset attributes have been copied to the includes when the document was loaded ( see normalizeThemeDocument )
 	for (pugi::xml_node node = root.child("include"); node; node = node.next_sibling("include"))
-	{
-		node.remove_attribute("subset");
-		node.append_attribute("subset") = name.c_str();
-
-		if (!appliesTo.empty())
-		{
-			node.remove_attribute("appliesTo");
-			node.append_attribute("appliesTo") = appliesTo.c_str();
-		}
-
-		if (!displayName.empty())
-		{
-			node.remove_attribute("subSetDisplayName");
-			node.append_attribute("subSetDisplayName") = displayName.c_str();
-		}
-
 		parseInclude(node);
-	}
 }
 
 void ThemeData::parseViews(const pugi::xml_node& root)
@@ -1377,8 +1899,7 @@ void ThemeData::parseCustomViewBaseClass(const pugi::xml_node& root, ThemeView&
 
 	for (auto& element : baseView.elements)
 	{
-		view.elements.erase(element.first);			
-		view.elements.insert(std::pair<std::string, ThemeElement>(element.first, element.second));
+		view.elements[element.first] = element.second;
 
 		if (std::find(view.orderedKeys.cbegin(), view.orderedKeys.cend(), element.first) == view.orderedKeys.cend())
 			view.orderedKeys.push_back(element.first);
@@ -1467,7 +1988,7 @@ void ThemeData::parseView(const pugi::xml_node& root, ThemeView& view, bool over
 			off = nameAttr.find_first_of(delim, prevOff);
 
 			parseElement(node, elemTypeIt->second,
-				view.elements.insert(std::pair<std::string, ThemeElement>(elemKey, ThemeElement())).first->second, view, overwriteElements);
+				view.getElementForWrite(elemKey), view, overwriteElements);
 
 			if (std::find(view.orderedKeys.cbegin(), view.orderedKeys.cend(), elemKey) == view.orderedKeys.cend())
 				view.orderedKeys.push_back(elemKey);
@@ -1553,19 +2074,19 @@ void ThemeData::processElement(const pugi::xml_node& root, ThemeElement& element
 		break;
 
 	case FLOAT:
-		element.properties[name] = Utils::String::toFloat(str);
+		element.properties[name] = parseValue(FLOAT, str);
 		break;
 
 	case NORMALIZED_RECT:
-		element.properties[name] = Vector4f::parseString(str);
+		element.properties[name] = parseValue(NORMALIZED_RECT, str);
 		break;
 
 	case NORMALIZED_PAIR:
-		element.properties[name] = Vector2f::parseString(str);
+		element.properties[name] = parseValue(NORMALIZED_PAIR, str);
 		break;
 
 	case COLOR:
-		element.properties[name] = Utils::HtmlColor::parse(str);
+		element.properties[name] = parseValue(COLOR, str);
 		break;
 
 	case BOOLEAN:
@@ -1628,7 +2149,7 @@ void ThemeData::processElement(const pugi::xml_node& root, ThemeElement& element
 				break;
 			}
 
-			if (ResourceManager::getInstance()->fileExists(path))
+			if (themeFileExists(path))
 			{
 				element.properties[name] = path;
 				break;
@@ -1636,7 +2157,7 @@ void ThemeData::processElement(const pugi::xml_node& root, ThemeElement& element
 			else if ((str[0] == '.' || str[0] == '~') && mPaths.size() > 1)
 			{
 				std::string rootPath = Utils::FileSystem::resolveRelativePath(str, Utils::FileSystem::getParent(mPaths.front()), true);
-				if (rootPath != path && ResourceManager::getInstance()->fileExists(rootPath))
+				if (rootPath != path && themeFileExists(rootPath))
 				{
 					element.properties[name] = rootPath;
 					break;
@@ -1729,14 +2250,14 @@ void ThemeData::parseElement(const pugi::xml_node& root, const std::map<std::str
 		auto importIt = view.elements.find(imports);
 		if (importIt != view.elements.cend())
 		{
-			for (auto prop : importIt->second.properties)
+			for (auto prop : importIt->second->properties)
 			{
 				auto typeIt = typeMap.find(prop.first);
 				if (typeIt != typeMap.cend())
 					element.properties[prop.first] = prop.second;
 			}
 
-			for (auto sb : importIt->second.mStoryBoards)
+			for (auto sb : importIt->second->mStoryBoards)
 				element.mStoryBoards[sb.first] = new ThemeStoryboard(*sb.second);
 		}
 	}
@@ -1832,7 +2353,11 @@ void ThemeData::parseElement(const pugi::xml_node& root, const std::map<std::str
 			if (element.type == "menuIcons")
 				type = PATH;
 			else if (name == "animate" && std::string(root.name()) == "imagegrid")
-				node.set_name("animateSelection");
+			{
+				// Old name of animateSelection ( the node isn't renamed : documents are shared )
+				name = "animateSelection";
+				type = BOOLEAN;
+			}
 			else if (element.type == "shader")
 				type = STRING;
 			else if (name == "shader")
@@ -1934,14 +2459,14 @@ const ThemeData::ThemeElement* ThemeData::getElement(const std::string& view, co
 	auto elemIt = viewIt->second.elements.find(element);
 	if(elemIt == viewIt->second.elements.cend()) return NULL;
 
-	if(elemIt->second.type != expectedType && !expectedType.empty())
+	if(elemIt->second->type != expectedType && !expectedType.empty())
 	{
 		LOG(LogWarning) << " requested mismatched theme type for [" << view << "." << element << "] - expected \"" 
-			<< expectedType << "\", got \"" << elemIt->second.type << "\"";
+			<< expectedType << "\", got \"" << elemIt->second->type << "\"";
 		return NULL;
 	}
 
-	return &elemIt->second;
+	return elemIt->second.get();
 }
 
 const std::vector<std::string> ThemeData::getElementNames(const std::string& view, const std::string& expectedType) const
@@ -1952,7 +2477,7 @@ const std::vector<std::string> ThemeData::getElementNames(const std::string& vie
 	if (viewIt != mViews.cend())
 	{
 		for (auto& element : viewIt->second.elements)
-			if (element.second.type == expectedType)
+			if (element.second->type == expectedType)
 				ret.push_back(element.first);
 	}
 
@@ -2032,7 +2557,7 @@ std::vector<GuiComponent*> ThemeData::makeExtras(const std::shared_ptr<ThemeData
 	
 	for(auto it = viewIt->second.orderedKeys.cbegin(); it != viewIt->second.orderedKeys.cend(); it++)
 	{
-		ThemeElement& elem = viewIt->second.elements.at(*it);
+		const ThemeElement& elem = *viewIt->second.elements.at(*it);
 		if(elem.extra)
 		{			
 			if (type != ExtraImportType::ALL_EXTRAS)
@@ -2405,8 +2930,180 @@ bool ThemeData::ThemeView::isOfType(const std::string type)
 	return baseType == type || std::find(baseTypes.cbegin(), baseTypes.cend(), type) != baseTypes.cend();
 }
 
+// Binary form of the elements. Animation kinds, in the order of ThemeStoryboard's copy constructor
+enum ThemeElementAnimation : uint8_t
+{
+	ANIMATION_FLOAT = 1,
+	ANIMATION_COLOR,
+	ANIMATION_VECTOR2,
+	ANIMATION_VECTOR4,
+	ANIMATION_STRING,
+	ANIMATION_PATH,
+	ANIMATION_SOUND
+};
+
+typedef ThemeData::ThemeElement::Property ThemeProperty;
+
+static void writeProperty(Utils::BinaryWriter& writer, const ThemeProperty& prop)
+{
+	writer.writeUInt8((uint8_t)prop.type);
+
+	switch (prop.type)
+	{
+	case ThemeProperty::PropertyType::String:
+		writer.writeString(prop.s);
+		break;
+	case ThemeProperty::PropertyType::Int:
+		writer.writeUInt32(prop.i);
+		break;
+	case ThemeProperty::PropertyType::Float:
+		writer.writeFloat(prop.f);
+		break;
+	case ThemeProperty::PropertyType::Bool:
+		writer.writeUInt8(prop.b ? 1 : 0);
+		break;
+	case ThemeProperty::PropertyType::Pair:
+		writer.writeFloat(prop.v.x());
+		writer.writeFloat(prop.v.y());
+		break;
+	case ThemeProperty::PropertyType::Rect:
+		writer.writeFloat(prop.r.x());
+		writer.writeFloat(prop.r.y());
+		writer.writeFloat(prop.r.z());
+		writer.writeFloat(prop.r.w());
+		break;
+	default:
+		break;
+	}
+}
+
+static void readProperty(Utils::BinaryReader& reader, ThemeProperty& prop)
+{
+	switch ((ThemeProperty::PropertyType)reader.readUInt8())
+	{
+	case ThemeProperty::PropertyType::String:
+		prop = reader.readString();
+		break;
+	case ThemeProperty::PropertyType::Int:
+		prop = (unsigned int)reader.readUInt32();
+		break;
+	case ThemeProperty::PropertyType::Float:
+		prop = reader.readFloat();
+		break;
+	case ThemeProperty::PropertyType::Bool:
+		prop = reader.readUInt8() != 0;
+		break;
+	case ThemeProperty::PropertyType::Pair:
+		{
+			float x = reader.readFloat();
+			float y = reader.readFloat();
+			prop = Vector2f(x, y);
+		}
+		break;
+	case ThemeProperty::PropertyType::Rect:
+		{
+			float x = reader.readFloat();
+			float y = reader.readFloat();
+			float z = reader.readFloat();
+			float w = reader.readFloat();
+			prop = Vector4f(x, y, z, w);
+		}
+		break;
+	default:
+		prop.type = ThemeProperty::PropertyType::Unknown;
+		break;
+	}
+}
+
+static void writeStoryboard(Utils::BinaryWriter& writer, const ThemeStoryboard* storyboard)
+{
+	writer.writeString(storyboard->eventName);
+	writer.writeUInt32((uint32_t)storyboard->repeat);
+	writer.writeUInt32((uint32_t)storyboard->repeatAt);
+
+	std::vector<std::pair<uint8_t, ThemeAnimation*>> animations;
+	for (auto anim : storyboard->animations)
+	{
+		uint8_t kind = 0;
+
+		if (dynamic_cast<ThemeFloatAnimation*>(anim) != nullptr)
+			kind = ANIMATION_FLOAT;
+		else if (dynamic_cast<ThemeColorAnimation*>(anim) != nullptr)
+			kind = ANIMATION_COLOR;
+		else if (dynamic_cast<ThemeVector2Animation*>(anim) != nullptr)
+			kind = ANIMATION_VECTOR2;
+		else if (dynamic_cast<ThemeVector4Animation*>(anim) != nullptr)
+			kind = ANIMATION_VECTOR4;
+		else if (dynamic_cast<ThemeStringAnimation*>(anim) != nullptr)
+			kind = ANIMATION_STRING;
+		else if (dynamic_cast<ThemePathAnimation*>(anim) != nullptr)
+			kind = ANIMATION_PATH;
+		else if (dynamic_cast<ThemeSoundAnimation*>(anim) != nullptr)
+			kind = ANIMATION_SOUND;
+
+		if (kind != 0)
+			animations.push_back(std::pair<uint8_t, ThemeAnimation*>(kind, anim));
+	}
+
+	writer.writeUInt32((uint32_t)animations.size());
+
+	for (auto& item : animations)
+	{
+		ThemeAnimation* anim = item.second;
+
+		writer.writeUInt8(item.first);
+		writer.writeString(anim->propertyName);
+		writer.writeUInt32((uint32_t)anim->duration);
+		writer.writeUInt32((uint32_t)anim->begin);
+		writer.writeUInt8(anim->autoReverse ? 1 : 0);
+		writer.writeUInt32((uint32_t)anim->repeat);
+		writer.writeUInt8((uint8_t)anim->easingMode);
+		writeProperty(writer, anim->from);
+		writeProperty(writer, anim->to);
+	}
+}
+
+static void readStoryboard(Utils::BinaryReader& reader, ThemeStoryboard* storyboard)
+{
+	storyboard->eventName = reader.readString();
+	storyboard->repeat = (int)reader.readUInt32();
+	storyboard->repeatAt = (int)reader.readUInt32();
+
+	uint32_t count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		ThemeAnimation* anim = nullptr;
+
+		switch (reader.readUInt8())
+		{
+		case ANIMATION_FLOAT: anim = new ThemeFloatAnimation(); break;
+		case ANIMATION_COLOR: anim = new ThemeColorAnimation(); break;
+		case ANIMATION_VECTOR2: anim = new ThemeVector2Animation(); break;
+		case ANIMATION_VECTOR4: anim = new ThemeVector4Animation(); break;
+		case ANIMATION_STRING: anim = new ThemeStringAnimation(); break;
+		case ANIMATION_PATH: anim = new ThemePathAnimation(); break;
+		case ANIMATION_SOUND: anim = new ThemeSoundAnimation(); break;
+		default:
+			reader.setFailed();
+			return;
+		}
+
+		anim->propertyName = reader.readString();
+		anim->duration = (int)reader.readUInt32();
+		anim->begin = (int)reader.readUInt32();
+		anim->autoReverse = reader.readUInt8() != 0;
+		anim->repeat = (int)reader.readUInt32();
+		anim->easingMode = (ThemeAnimation::EasingMode)reader.readUInt8();
+		readProperty(reader, anim->from);
+		readProperty(reader, anim->to);
+
+		storyboard->animations.push_back(anim);
+	}
+}
+
 ThemeData::ThemeElement::ThemeElement(const ThemeElement& src)
 {
+	shared = false;
 	extra = src.extra;
 	type = src.type;
 	properties = src.properties;
@@ -2424,6 +3121,89 @@ ThemeData::ThemeElement::~ThemeElement()
 	mStoryBoards.clear();
 }
 
+void ThemeData::ThemeElement::saveToBinary(Utils::BinaryWriter& writer) const
+{
+	writer.writeUInt32((uint32_t)extra);
+	writer.writeString(type);
+
+	writer.writeUInt32((uint32_t)properties.size());
+	for (auto& prop : properties)
+	{
+		writer.writeString(prop.first);
+		writeProperty(writer, prop.second);
+	}
+
+	writer.writeUInt32((uint32_t)mStoryBoards.size());
+	for (auto& sb : mStoryBoards)
+	{
+		writer.writeString(sb.first);
+		writeStoryboard(writer, sb.second);
+	}
+
+	writer.writeUInt32((uint32_t)children.size());
+	for (auto& child : children)
+	{
+		writer.writeString(child.first);
+		child.second.saveToBinary(writer);
+	}
+}
+
+void ThemeData::ThemeElement::loadFromBinary(Utils::BinaryReader& reader)
+{
+	extra = (int)reader.readUInt32();
+	type = reader.readString();
+
+	uint32_t count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		std::string name = reader.readString();
+		readProperty(reader, properties[name]);
+	}
+
+	count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		std::string name = reader.readString();
+
+		auto storyboard = new ThemeStoryboard();
+		readStoryboard(reader, storyboard);
+
+		auto sb = mStoryBoards.find(name);
+		if (sb != mStoryBoards.cend())
+			delete sb->second;
+
+		mStoryBoards[name] = storyboard;
+	}
+
+	count = reader.readUInt32();
+	for (uint32_t i = 0; i < count && !reader.failed(); i++)
+	{
+		children.push_back(std::pair<std::string, ThemeElement>(reader.readString(), ThemeElement()));
+		children.back().second.loadFromBinary(reader);
+	}
+}
+
+size_t ThemeData::ThemeElement::getMemUsage() const
+{
+	size_t size = sizeof(ThemeElement) + type.capacity();
+
+	for (auto& prop : properties)
+		size += sizeof(PropertyMap::value_type) + prop.second.s.capacity();
+
+	for (auto& sb : mStoryBoards)
+	{
+		size += sizeof(ThemeStoryboard) + sb.first.capacity() + sb.second->eventName.capacity();
+
+		for (auto anim : sb.second->animations)
+			size += sizeof(ThemeAnimation) + anim->propertyName.capacity() + anim->from.s.capacity() + anim->to.s.capacity();
+	}
+
+	for (auto& child : children)
+		size += child.first.capacity() + child.second.getMemUsage();
+
+	return size;
+}
+
 std::shared_ptr<ThemeData> ThemeData::clone(const std::string& viewName)
 {
 	auto theme = std::make_shared<ThemeData>();
@@ -2457,9 +3237,10 @@ std::shared_ptr<ThemeData> ThemeData::clone(const std::string& viewName)
 bool ThemeData::appendFile(const std::string& path, bool perGameOverride)
 {
 	mPaths.push_back(path);
+	trackThemeFile(path);
 
-	pugi::xml_document includeDoc;
-	pugi::xml_parse_result result = includeDoc.load_file(WINSTRINGW(path).c_str());
+	pugi::xml_parse_result result;
+	std::shared_ptr<pugi::xml_document> includeDoc = loadThemeDocument(path, true, result);
 	if (!result)
 	{
 		mPaths.pop_back();
@@ -2467,7 +3248,7 @@ bool ThemeData::appendFile(const std::string& path, bool perGameOverride)
 		return false;
 	}
 
-	pugi::xml_node theme = includeDoc.child("theme");
+	pugi::xml_node theme = includeDoc->child("theme");
 	if (!theme)
 	{
 		mPaths.pop_back();
@@ -2520,10 +3301,11 @@ void ThemeData::applySelfTheme(GuiComponent* comp, const ThemeElement& elem)
 	auto theme = std::make_shared<ThemeData>();
 
 	ThemeView& view = theme->mViews.insert(std::pair<std::string, ThemeView>("default", ThemeView())).first->second;
-	auto element = view.elements.insert(std::pair<std::string, ThemeElement>("default", elem));
+	auto element = std::make_shared<ThemeElement>(elem);
+	view.elements["default"] = element;
 
 	comp->applyTheme(theme, "default", "default", ThemeFlags::ALL);
 
 	// Clear storyboard or they'll be deleted as we use a temporary fake theme...
-	element.first->second.mStoryBoards.clear();
+	element->mStoryBoards.clear();
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include <pugixml/src/pugixml.hpp>
 #include "utils/MathExpr.h"
 #include "renderers/Renderer.h"
+#include "ThemeCache.h"
 
 namespace pugi { class xml_node; }
 
@@ -29,6 +30,8 @@ class Window;
 class Font;
 class ThemeStoryboard;
 
+namespace Utils { class BinaryWriter; class BinaryReader; }
+
 namespace ThemeFlags
 {
 	enum PropertyFlags : unsigned int
@@ -53,6 +56,71 @@ namespace ThemeFlags
 	};
 }
 
+// Interned ids of the most used theme properties, known at compile time. Other property names get an id when they're first stored.
+// Names are in ThemeData.cpp ( sPropertyNames ), in the same order
+namespace ThemeProperties
+{
+	enum PropertyId : unsigned int
+	{
+		INVALID = 0,
+
+		POS,
+		SIZE,
+		X,
+		Y,
+		W,
+		H,
+		ORIGIN,
+		ROTATION,
+		ROTATION_ORIGIN,
+		SCALE,
+		SCALE_ORIGIN,
+		Z_INDEX,
+		VISIBLE,
+		OFFSET,
+		OFFSET_X,
+		OFFSET_Y,
+		CLIP_RECT,
+		OPACITY,
+		ONCLICK,
+		RENDER_CACHE,
+
+		PATH,
+		DEFAULT,
+		COLOR,
+		COLOR_END,
+		GRADIENT_TYPE,
+		MAX_SIZE,
+		MIN_SIZE,
+		TILE,
+		FLIP_X,
+		FLIP_Y,
+		ROUND_CORNERS,
+		SATURATION,
+		REFLEXION,
+		REFLEXION_ON_FRAME,
+		PADDING,
+		LINEAR_SMOOTH,
+
+		TEXT,
+		FONT_PATH,
+		FONT_SIZE,
+		ALIGNMENT,
+		HORIZONTAL_ALIGNMENT,
+		VERTICAL_ALIGNMENT,
+		FORCE_UPPERCASE,
+		LINE_SPACING,
+		BACKGROUND_COLOR,
+		GLOW_COLOR,
+		GLOW_SIZE,
+		GLOW_OFFSET,
+		SINGLE_LINE_SCROLL,
+		AUTO_SCROLL,
+
+		COUNT
+	};
+}
+
 class ThemeException : public std::exception
 {
 public:
@@ -171,6 +239,7 @@ struct ButtonElement
 class ThemeData
 {
 	friend class GuiComponent;
+	friend class ThemeCache;
 
 public:
 	class ThemeMenu
@@ -203,11 +272,12 @@ public:
 	class ThemeElement
 	{
 	public:
-		ThemeElement() { extra = 0; }
+		ThemeElement() { extra = 0; shared = false; }
 		ThemeElement(const ThemeElement& src);
 		~ThemeElement();
 
 		int extra;
+		bool shared; // Published in the element pool, may be referenced by other themes : never modify it, write a copy
 		std::string type;
 		std::map<std::string, ThemeStoryboard*> mStoryBoards;
 
@@ -257,10 +327,65 @@ public:
 
 		};
 
-		std::map< std::string, Property > properties;
+		// Property id, converts to the property name
+		struct PropertyName
+		{
+			PropertyName(unsigned int propertyId) : id(propertyId) { }
+
+			inline operator const std::string&() const { return ThemeData::getPropertyName(id); }
+			inline const std::string& str() const { return ThemeData::getPropertyName(id); }
+
+			inline bool operator==(const std::string& name) const { return str() == name; }
+			inline bool operator==(const char* name) const { return str() == name; }
+			inline bool operator!=(const std::string& name) const { return str() != name; }
+			inline bool operator!=(const char* name) const { return str() != name; }
+
+			unsigned int id;
+		};
+
+		// Flat array of properties, sorted by id. Lookups by name are kept for compatibility, they resolve the id first
+		// Iteration is in id order, not in name order as the former std::map : callers must not depend on it
+		class PropertyMap
+		{
+		public:
+			typedef std::pair<PropertyName, Property> value_type;
+			typedef std::vector<value_type>::iterator iterator;
+			typedef std::vector<value_type>::const_iterator const_iterator;
+
+			inline iterator begin() { return mItems.begin(); }
+			inline iterator end() { return mItems.end(); }
+			inline const_iterator begin() const { return mItems.cbegin(); }
+			inline const_iterator end() const { return mItems.cend(); }
+			inline const_iterator cbegin() const { return mItems.cbegin(); }
+			inline const_iterator cend() const { return mItems.cend(); }
+
+			inline size_t size() const { return mItems.size(); }
+			inline bool empty() const { return mItems.empty(); }
+
+			iterator find(unsigned int id);
+			const_iterator find(unsigned int id) const;
+			inline iterator find(const std::string& name) { return find(ThemeData::getPropertyId(name)); }
+			inline const_iterator find(const std::string& name) const { return find(ThemeData::getPropertyId(name)); }
+
+			Property& operator[](unsigned int id);
+			inline Property& operator[](const PropertyName& name) { return (*this)[name.id]; }
+			Property& operator[](const std::string& name);
+
+			// Throws std::out_of_range, as std::map::at
+			const Property& at(unsigned int id) const;
+			inline const Property& at(const std::string& name) const { return at(ThemeData::getPropertyId(name)); }
+
+			void erase(unsigned int id);
+			inline void erase(const std::string& name) { erase(ThemeData::getPropertyId(name)); }
+
+		private:
+			std::vector<value_type> mItems;
+		};
+
+		PropertyMap properties;
 
 		template<typename T>
-		const T get(const std::string& prop) const
+		const T get(unsigned int prop) const
 		{
 			if(     std::is_same<T, Vector2f>::value)     return *(const T*)&properties.at(prop).v;
 			else if(std::is_same<T, std::string>::value)  return *(const T*)&properties.at(prop).s;
@@ -271,7 +396,17 @@ public:
 			return T();
 		}
 
-		inline bool has(const std::string& prop) const { return (properties.find(prop) != properties.cend()); }
+		template<typename T>
+		inline const T get(const std::string& prop) const { return get<T>(ThemeData::getPropertyId(prop)); }
+
+		inline bool has(unsigned int prop) const { return (properties.find(prop) != properties.cend()); }
+		inline bool has(const std::string& prop) const { return has(ThemeData::getPropertyId(prop)); }
+
+		// Binary form, used by ThemeCache and to find identical elements
+		void saveToBinary(Utils::BinaryWriter& writer) const;
+		void loadFromBinary(Utils::BinaryReader& reader);
+
+		size_t getMemUsage() const;
 	};
 
 private:
@@ -280,8 +415,12 @@ private:
 	public:
 		ThemeView() { isCustomView = false; }
 
-		std::map<std::string, ThemeElement> elements;
+		// Elements are shared between the themes that define them identically ( systems using the same theme, clones... )
+		std::map<std::string, std::shared_ptr<ThemeElement>> elements;
 		std::vector<std::string> orderedKeys;
+
+		// Copy on write : returns an element owned by this view, created if missing
+		ThemeElement& getElementForWrite(const std::string& name);
 		std::string baseType;
 
 		std::vector<std::string> baseTypes;
@@ -346,6 +485,25 @@ public:
 	static std::vector<Subset> getSubSet(const std::vector<Subset>& subsets, const std::string& subset);
 
 	static void setDefaultTheme(ThemeData* theme);
+
+	// Interned property names. Unknown names return ThemeProperties::INVALID, unless 'create' is set
+	static unsigned int getPropertyId(const std::string& name, bool create = false);
+	static const std::string& getPropertyName(unsigned int id);
+
+	// Releases the theme files kept parsed while the systems load their theme, the compiled placeholders & the parsed values
+	static void clearFileCache();
+
+	// A NORMALIZED_RECT, NORMALIZED_PAIR, COLOR or FLOAT value, parsed once by source string
+	static ThemeElement::Property parseValue(ElementPropertyType type, const std::string& str);
+
+	// Memory used by the elements of all loaded themes, once shared
+	static size_t getTotalMemUsage();
+
+	// Probes the size of every image file referenced by the themes, in parallel, so that their textures can be queued without reading the files on the UI thread
+	static void preloadImageSizes(const std::vector<ThemeData*>& themes);
+
+	// Sound files referenced by the themes ( sound elements, carousel scroll sounds, storyboards... )
+	static std::vector<std::string> getSoundPaths(const std::vector<ThemeData*>& themes);
 	static ThemeData* getDefaultTheme() { return mDefaultTheme; }
 	
 	std::string getSystemThemeFolder() { return mSystemThemeFolder; }
@@ -370,7 +528,13 @@ public:
 
 	static void parseCustomShader(const ThemeData::ThemeElement* elem, Renderer::ShaderInfo* pShader);
 
+
 private:
+	static std::shared_ptr<pugi::xml_document> loadThemeDocument(const std::string& path, bool fromFile, pugi::xml_parse_result& result);
+
+	// Replaces the elements by identical ones already loaded by another theme
+	void shareElements();
+
 	static std::map< std::string, std::map<std::string, ElementPropertyType> > sElementMap;
 	static std::vector<std::string> sSupportedFeatures;
 	static std::vector<std::string> sSupportedViews;
@@ -411,6 +575,11 @@ private:
 	std::string resolveSystemVariable(const std::string& systemThemeFolder, const std::string& path);
 	std::string resolvePlaceholders(const char* in);
 
+	// Lookups that make the result of a load, recorded for ThemeCache
+	bool themeFileExists(const std::string& path);
+	std::string getSubsetSetting(const std::string& name);
+	void trackThemeFile(const std::string& path);
+
 	std::string mColorset;
 	std::string mIconset;
 	std::string mMenu;
@@ -470,6 +639,9 @@ private:
 	static ThemeData* mDefaultTheme;	
 
 	bool mPerGameOverrideTmp;
+
+	bool mTrackDependencies;
+	ThemeCacheDependencies mDependencies;
 	
 	Utils::MathExpr mEvaluator;
 	Utils::MathExpr::ValueMap mEvaluatorVariables;
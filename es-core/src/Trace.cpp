@@ -0,0 +1,169 @@
+#include "Trace.h"
+
+#include "utils/StringUtil.h"
+#include "Log.h"
+#include "Paths.h"
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <map>
+
+// Keeps memory bounded if the trace is left running
+#define MAX_TRACE_EVENTS	500000
+
+struct TraceEvent
+{
+	std::string name;
+	std::string detail;
+	long long	start;
+	long long	duration;
+	int			thread;
+};
+
+static std::mutex							sTraceLock;
+static std::vector<TraceEvent>				sTraceEvents;
+static std::map<std::thread::id, int>		sTraceThreads;
+static std::chrono::steady_clock::time_point sTraceStart;
+
+std::atomic<bool> Trace::mEnabled(false);
+
+std::string Trace::getTracePath()
+{
+	return Paths::getUserEmulationStationPath() + "/es_trace.json";
+}
+
+void Trace::start()
+{
+	std::unique_lock<std::mutex> lock(sTraceLock);
+
+	sTraceEvents.clear();
+	sTraceThreads.clear();
+	sTraceThreads[std::this_thread::get_id()] = 1; // Main thread
+	sTraceStart = std::chrono::steady_clock::now();
+
+	mEnabled = true;
+
+	LOG(LogInfo) << "Trace : recording to " << getTracePath();
+}
+
+long long Trace::now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sTraceStart).count();
+}
+
+void Trace::addSpan(const std::string& name, const std::string& detail, long long start, long long end)
+{
+	if (!mEnabled)
+		return;
+
+	std::unique_lock<std::mutex> lock(sTraceLock);
+	if (sTraceEvents.size() >= MAX_TRACE_EVENTS)
+		return;
+
+	auto id = std::this_thread::get_id();
+
+	auto it = sTraceThreads.find(id);
+	if (it == sTraceThreads.cend())
+		it = sTraceThreads.insert(std::pair<std::thread::id, int>(id, (int)sTraceThreads.size() + 1)).first;
+
+	TraceEvent evt;
+	evt.name = name;
+	evt.detail = detail;
+	evt.start = start;
+	evt.duration = end - start;
+	evt.thread = it->second;
+	sTraceEvents.push_back(evt);
+}
+
+static std::string escapeJson(const std::string& value)
+{
+	std::string ret;
+	ret.reserve(value.size());
+
+	for (auto c : value)
+	{
+		if (c == '"' || c == '\\')
+		{
+			ret += '\\';
+			ret += c;
+		}
+		else if ((unsigned char)c < 0x20)
+			ret += ' ';
+		else
+			ret += c;
+	}
+
+	return ret;
+}
+
+void Trace::stop()
+{
+	// Spans can still be added from other threads : only the first call writes the file
+	if (!mEnabled.exchange(false))
+		return;
+
+	std::unique_lock<std::mutex> lock(sTraceLock);
+
+	std::string path = getTracePath();
+
+	std::ofstream stream(WINSTRINGW(path), std::ios::binary | std::ios::trunc);
+	if (!stream.is_open())
+	{
+		LOG(LogError) << "Trace : Unable to write " << path;
+		return;
+	}
+
+	stream << "{\"traceEvents\":[\n";
+
+	bool first = true;
+
+	for (auto& thread : sTraceThreads)
+	{
+		stream << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.second << ",\"args\":{\"name\":\"" << (thread.second == 1 ? "main" : "thread " + std::to_string(thread.second)) << "\"}}";
+		first = false;
+	}
+
+	for (auto& evt : sTraceEvents)
+	{
+		stream << (first ? "" : ",\n") << "{\"name\":\"" << escapeJson(evt.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << evt.thread << ",\"ts\":" << evt.start << ",\"dur\":" << evt.duration;
+
+		if (!evt.detail.empty())
+			stream << ",\"args\":{\"detail\":\"" << escapeJson(evt.detail) << "\"}";
+
+		stream << "}";
+		first = false;
+	}
+
+	stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	stream.close();
+
+	LOG(LogInfo) << "Trace : " << sTraceEvents.size() << " spans written to " << path;
+
+	sTraceEvents.clear();
+	sTraceEvents.shrink_to_fit();
+	sTraceThreads.clear();
+}
+
+TraceSpan::TraceSpan(const char* name) : mName(name), mStart(-1)
+{
+	if (Trace::enabled())
+		mStart = Trace::now();
+}
+
+TraceSpan::TraceSpan(const char* name, const std::string& detail) : mName(name), mStart(-1)
+{
+	if (Trace::enabled())
+	{
+		mDetail = detail;
+		mStart = Trace::now();
+	}
+}
+
+TraceSpan::~TraceSpan()
+{
+	if (mStart >= 0 && Trace::enabled())
+		Trace::addSpan(mName, mDetail, mStart, Trace::now());
+}
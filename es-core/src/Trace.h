@@ -0,0 +1,42 @@
+#pragma once
+#ifndef ES_CORE_TRACE_H
+#define ES_CORE_TRACE_H
+
+#include <string>
+#include <atomic>
+
+// Records nested timing spans, with their thread, and exports them in the Chrome trace_event JSON format ( chrome://tracing, ui.perfetto.dev ).
+// Enabled with the "StartupTrace" setting or --trace. Spans nest by time on each thread, there's nothing to declare
+class Trace
+{
+public:
+	static void start();
+	// Writes the trace file, and stops recording
+	static void stop();
+
+	static inline bool enabled() { return mEnabled; }
+
+	// Microseconds since the trace started
+	static long long now();
+	static void addSpan(const std::string& name, const std::string& detail, long long start, long long end);
+
+	static std::string getTracePath();
+
+private:
+	static std::atomic<bool> mEnabled;
+};
+
+class TraceSpan
+{
+public:
+	TraceSpan(const char* name);
+	TraceSpan(const char* name, const std::string& detail);
+	~TraceSpan();
+
+private:
+	const char*	mName;
+	std::string	mDetail;
+	long long	mStart;
+};
+
+#endif // ES_CORE_TRACE_H
@@ -0,0 +1,243 @@
+#include "VideoHardwareDecode.h"
+
+#include "renderers/Renderer.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <vlc/vlc.h>
+#include <thread>
+#include <chrono>
+
+// Length of the decoding test of each backend, played faster than real time so that the decoder is the bottleneck
+#define BENCHMARK_MS		2000
+#define BENCHMARK_RATE		4.0f
+#define BENCHMARK_MIN_FRAMES 10
+
+// A backend further in the list must be this much faster to be chosen ( the hardware ones use less CPU at the same frame rate )
+#define BENCHMARK_MARGIN	1.1f
+
+struct DecodeBackend
+{
+	const char* name;
+	const char* option;
+};
+
+static const DecodeBackend sBackends[] =
+{
+#if defined(WIN32)
+	{ "d3d11va", ":avcodec-hw=d3d11va" },
+	{ "dxva2", ":avcodec-hw=dxva2" },
+#elif defined(_RPI_)
+	{ "mmal", ":codec=mmal" },
+	{ "v4l2m2m", ":avcodec-codec=h264_v4l2m2m" },
+#elif defined(__APPLE__)
+	{ "videotoolbox", ":codec=videotoolbox" },
+#elif defined(__linux__)
+	{ "vaapi", ":avcodec-hw=vaapi" },
+	{ "vdpau", ":avcodec-hw=vdpau" },
+	{ "v4l2m2m", ":avcodec-codec=h264_v4l2m2m" },
+#endif
+	{ "none", ":avcodec-hw=none" }
+};
+
+std::mutex VideoHardwareDecode::mLock;
+std::string VideoHardwareDecode::mBenchmarkedBackend;
+bool VideoHardwareDecode::mBenchmarkLoaded = false;
+std::atomic<bool> VideoHardwareDecode::mBenchmarkRunning(false);
+std::atomic<bool> VideoHardwareDecode::mFailed(false);
+
+std::vector<std::string> VideoHardwareDecode::getBackends()
+{
+	std::vector<std::string> ret;
+	for (auto& backend : sBackends)
+		ret.push_back(backend.name);
+
+	return ret;
+}
+
+std::string VideoHardwareDecode::getCachePath()
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/videodecode.cache");
+}
+
+std::string VideoHardwareDecode::getDeviceKey()
+{
+	// A new VLC or a new GPU driver may change the result
+	std::string key = libvlc_get_version();
+	for (auto& info : Renderer::getDriverInformation())
+		key += "|" + info.second;
+
+	return key;
+}
+
+std::string VideoHardwareDecode::getSelectedBackend()
+{
+	if (mFailed)
+		return "none";
+
+	std::string policy = Settings::getInstance()->getString("VideoHardwareDecode");
+	if (policy != "auto")
+		return policy;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	// The cache file is "device key \n backend"
+	if (!mBenchmarkLoaded && !mBenchmarkRunning)
+	{
+		mBenchmarkLoaded = true;
+
+		auto lines = Utils::String::split(Utils::FileSystem::readAllText(getCachePath()), '\n');
+		if (lines.size() >= 2 && lines[0] == getDeviceKey())
+			mBenchmarkedBackend = lines[1];
+	}
+
+	// Until the benchmark is done, VLC's own default
+	return mBenchmarkedBackend;
+}
+
+std::vector<std::string> VideoHardwareDecode::getMediaOptions()
+{
+	std::vector<std::string> ret;
+
+	std::string backend = getSelectedBackend();
+	for (auto& it : sBackends)
+		if (backend == it.name)
+			ret.push_back(it.option);
+
+	return ret;
+}
+
+bool VideoHardwareDecode::isHardwareActive()
+{
+	std::string backend = getSelectedBackend();
+	return !backend.empty() && backend != "none";
+}
+
+void VideoHardwareDecode::reportFailure()
+{
+	if (mFailed.exchange(true))
+		return;
+
+	LOG(LogWarning) << "VideoHardwareDecode : Video failed with hardware decoding, using software decoding";
+}
+
+bool VideoHardwareDecode::needsBenchmark()
+{
+	if (Settings::getInstance()->getString("VideoHardwareDecode") != "auto" || mBenchmarkRunning)
+		return false;
+
+	getSelectedBackend();
+
+	std::unique_lock<std::mutex> lock(mLock);
+	return mBenchmarkedBackend.empty();
+}
+
+// Frames are decoded into a small RGBA target & counted
+#define BENCHMARK_WIDTH		160
+#define BENCHMARK_HEIGHT	90
+
+struct BenchmarkContext
+{
+	BenchmarkContext() : pixels(BENCHMARK_WIDTH * BENCHMARK_HEIGHT * 4), frames(0) { }
+
+	std::vector<unsigned char> pixels;
+	std::atomic<int> frames;
+};
+
+static void* benchmarkLock(void* data, void** pixels)
+{
+	*pixels = ((BenchmarkContext*)data)->pixels.data();
+	return nullptr;
+}
+
+static void benchmarkDisplay(void* data, void* id)
+{
+	((BenchmarkContext*)data)->frames++;
+}
+
+int VideoHardwareDecode::measure(libvlc_instance_t* vlc, const std::string& samplePath, const std::string& backend)
+{
+	libvlc_media_t* media = libvlc_media_new_path(vlc, samplePath.c_str());
+	if (media == nullptr)
+		return 0;
+
+	for (auto& it : sBackends)
+		if (backend == it.name)
+			libvlc_media_add_option(media, it.option);
+
+	libvlc_media_add_option(media, ":no-audio");
+
+	libvlc_media_player_t* player = libvlc_media_player_new_from_media(media);
+	if (player == nullptr)
+	{
+		libvlc_media_release(media);
+		return 0;
+	}
+
+	BenchmarkContext context;
+	libvlc_video_set_callbacks(player, benchmarkLock, nullptr, benchmarkDisplay, &context);
+	libvlc_video_set_format(player, "RGBA", BENCHMARK_WIDTH, BENCHMARK_HEIGHT, BENCHMARK_WIDTH * 4);
+
+	libvlc_media_player_play(player);
+	libvlc_media_player_set_rate(player, BENCHMARK_RATE);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(BENCHMARK_MS));
+
+	bool failed = libvlc_media_player_get_state(player) == libvlc_Error;
+
+	libvlc_media_player_stop(player);
+	libvlc_media_player_release(player);
+	libvlc_media_release(media);
+
+	return failed ? 0 : context.frames.load();
+}
+
+void VideoHardwareDecode::benchmark(libvlc_instance_t* vlc, const std::string& samplePath)
+{
+	if (vlc == nullptr || samplePath.empty() || mBenchmarkRunning.exchange(true))
+		return;
+
+	std::string key = getDeviceKey();
+
+	std::thread([vlc, samplePath, key]()
+	{
+		std::string best;
+		int bestFrames = 0;
+
+		for (auto& backend : sBackends)
+		{
+			int frames = measure(vlc, samplePath, backend.name);
+			LOG(LogInfo) << "VideoHardwareDecode : " << backend.name << " decoded " << frames << " frames";
+
+			if (frames < BENCHMARK_MIN_FRAMES)
+				continue;
+
+			if (best.empty() || frames > bestFrames * BENCHMARK_MARGIN)
+			{
+				best = backend.name;
+				bestFrames = frames;
+			}
+		}
+
+		// Nothing decoded : the sample is probably broken, try again next time
+		if (!best.empty())
+		{
+			LOG(LogInfo) << "VideoHardwareDecode : Using " << best;
+
+			std::string cachePath = getCachePath();
+			std::string folder = Utils::FileSystem::getParent(cachePath);
+			if (!Utils::FileSystem::exists(folder))
+				Utils::FileSystem::createDirectory(folder);
+
+			Utils::FileSystem::writeAllText(cachePath, key + "\n" + best);
+
+			std::unique_lock<std::mutex> lock(mLock);
+			mBenchmarkedBackend = best;
+		}
+
+		mBenchmarkRunning = false;
+	}).detach();
+}
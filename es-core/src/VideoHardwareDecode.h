@@ -0,0 +1,46 @@
+#pragma once
+#ifndef ES_CORE_VIDEO_HARDWARE_DECODE_H
+#define ES_CORE_VIDEO_HARDWARE_DECODE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+struct libvlc_instance_t;
+
+// VLC decoding backend of the videos. The "VideoHardwareDecode" setting is "auto", "none" or a backend name ( vaapi, d3d11va, mmal... ).
+// auto : the backends of the platform are benchmarked once on a sample video, and the fastest working one is cached for this device.
+// A video that fails with a hardware backend switches to software decoding until the next start
+class VideoHardwareDecode
+{
+public:
+	// Media options of the selected backend
+	static std::vector<std::string> getMediaOptions();
+
+	// Backends available on this platform, preferred first. "none" is always the last one
+	static std::vector<std::string> getBackends();
+
+	// True when the policy is auto and this device has no benchmark result yet
+	static bool needsBenchmark();
+
+	// Runs in the background. Call from the main thread ( the device identity reads the GL driver )
+	static void benchmark(libvlc_instance_t* vlc, const std::string& samplePath);
+
+	static bool isHardwareActive();
+	static void reportFailure();
+
+private:
+	static std::string getSelectedBackend();
+	static std::string getDeviceKey();
+	static std::string getCachePath();
+	static int measure(libvlc_instance_t* vlc, const std::string& samplePath, const std::string& backend);
+
+	static std::mutex		mLock;
+	static std::string		mBenchmarkedBackend;
+	static bool				mBenchmarkLoaded;
+	static std::atomic<bool> mBenchmarkRunning;
+	static std::atomic<bool> mFailed;
+};
+
+#endif // ES_CORE_VIDEO_HARDWARE_DECODE_H
@@ -10,12 +10,16 @@
 
 #ifdef _ENABLE_PULSE_
 #include <thread>
+#include <atomic>
 #include <condition_variable>
 #include <pulse/pulseaudio.h>
 
+// The context is only used by the thread of the mainloop : the main thread reads the cached volume, and its changes are applied by the loop.
+// While a change is sent, the next ones only replace the pending value ( holding the volume key sends the last one ), and the sink events don't overwrite it
 class PulseAudioControl
 {
 #define DEFAULT_SINK_NAME "@DEFAULT_SINK@"
+#define NO_PENDING_VOLUME -1
 
 public:
 	PulseAudioControl()
@@ -26,6 +30,9 @@ public:
 	  	mReady   = 0;
 		mMute    = 0;
 		mVolume  = 100;
+		mPendingVolume = NO_PENDING_VOLUME;
+		mSending = false;
+		mExit = false;
 
 		mThread = new std::thread(&PulseAudioControl::run, this);
 		WaitEvent();
@@ -51,10 +58,11 @@ public:
 			return;
 
 		mVolume = value;
-          
-		pa_operation* o = pa_context_get_sink_info_by_name(mContext, DEFAULT_SINK_NAME, set_sink_volume_callback, this);
-      	if (o != NULL)
-			pa_operation_unref(o);
+		mPendingVolume = value;
+
+		// Thread safe
+		if (mMainLoop != nullptr)
+			pa_mainloop_wakeup(mMainLoop);
 	}
 
 	void exit()
@@ -64,8 +72,9 @@ public:
 		mReady = false;
 
 		if(mThread != nullptr) {
+		  mExit = true;
 		  if (mMainLoop != nullptr) {
-		    pa_mainloop_quit(mMainLoop, 0);
+		    pa_mainloop_wakeup(mMainLoop);
 		  }
 		  mThread->join();
 		  mThread = nullptr;
@@ -85,7 +94,8 @@ public:
 		pa_context_connect(mContext, nullptr, pa_context_flags::PA_CONTEXT_NOFLAGS, nullptr);
 
 		int result = 0;
-		pa_mainloop_run(mMainLoop, &result);
+		while (!mExit && pa_mainloop_iterate(mMainLoop, 1, &result) >= 0)
+			sendPendingVolume();
 
 		pa_context_unref(mContext);
 		pa_mainloop_free(mMainLoop);
@@ -96,6 +106,21 @@ public:
 
 
 private:
+	void sendPendingVolume()
+	{
+		if (mSending || mPendingVolume == NO_PENDING_VOLUME || !mReady)
+			return;
+
+		pa_operation* o = pa_context_get_sink_info_by_name(mContext, DEFAULT_SINK_NAME, set_sink_volume_callback, this);
+		if (o != NULL)
+		{
+			mSending = true;
+			pa_operation_unref(o);
+		}
+		else
+			mPendingVolume = NO_PENDING_VOLUME;
+	}
+
 	static void quit(void* userdata, int code)
 	{
 		PulseAudioControl* pThis = (PulseAudioControl*)userdata;
@@ -116,7 +141,8 @@ private:
 
 		int channel = 0;
 
-		if (is_last == 0)
+		// A change is on its way : the one of the event is older
+		if (is_last == 0 && !pThis->mSending && pThis->mPendingVolume == NO_PENDING_VOLUME)
 		{
 			pThis->mMute = i->mute;
 			pThis->mVolume = (unsigned)(((uint64_t) i->volume.values[channel] * 100 + (uint64_t)PA_VOLUME_NORM / 2) / (uint64_t)PA_VOLUME_NORM);		
@@ -129,11 +155,42 @@ private:
 
 		pa_cvolume cv;
 
-		if (is_last == 0)
-		{	
-			pa_cvolume_set(&cv, i->channel_map.channels, (pa_volume_t) (pThis->mVolume * (double) PA_VOLUME_NORM / 100));
-			pa_operation_unref(pa_context_set_sink_volume_by_name(c, DEFAULT_SINK_NAME, &cv, simple_callback, NULL));
+		// No default sink
+		if (is_last < 0)
+		{
+			pThis->mPendingVolume = NO_PENDING_VOLUME;
+			pThis->mSending = false;
+			return;
 		}
+
+		if (is_last != 0)
+			return;
+
+		int volume = pThis->mPendingVolume.exchange(NO_PENDING_VOLUME);
+		if (volume == NO_PENDING_VOLUME)
+		{
+			pThis->mSending = false;
+			return;
+		}
+
+		pa_cvolume_set(&cv, i->channel_map.channels, (pa_volume_t) (volume * (double) PA_VOLUME_NORM / 100));
+
+		pa_operation* o = pa_context_set_sink_volume_by_name(c, DEFAULT_SINK_NAME, &cv, set_volume_done_callback, userdata);
+		if (o != NULL)
+			pa_operation_unref(o);
+		else
+			pThis->mSending = false;
+	}
+
+	static void set_volume_done_callback(pa_context *c, int success, void *userdata) 
+	{
+		PulseAudioControl* pThis = (PulseAudioControl*)userdata;
+
+		simple_callback(c, success, userdata);
+
+		// The changes received meanwhile, in the same loop
+		pThis->mSending = false;
+		pThis->sendPendingVolume();
 	}
 
 	static void subscribe_callback(pa_context *c, pa_subscription_event_type_t type, uint32_t idx, void *userdata) 
@@ -184,9 +241,12 @@ private:
 	}
 
 private:
-	int mReady;
-	int mMute;
-	int mVolume;
+	std::atomic<int> mReady;
+	std::atomic<int> mMute;
+	std::atomic<int> mVolume;
+	std::atomic<int> mPendingVolume;	// Set by the main thread, sent by the mainloop
+	bool mSending;						// Mainloop only
+	std::atomic<bool> mExit;
 
 	void FireEvent()
 	{
@@ -0,0 +1,42 @@
+#include "WakeScheduler.h"
+
+#include <SDL_timer.h>
+
+std::atomic<unsigned int> WakeScheduler::mDeadline(WakeScheduler::NO_DEADLINE);
+bool WakeScheduler::mDue = false;
+
+void WakeScheduler::requestFrameAt(unsigned int ticks)
+{
+	unsigned int current = mDeadline;
+	while (ticks < current && !mDeadline.compare_exchange_weak(current, ticks));
+}
+
+void WakeScheduler::requestFrameIn(int delayMs)
+{
+	requestFrameAt(SDL_GetTicks() + (unsigned int)(delayMs > 0 ? delayMs : 0));
+}
+
+void WakeScheduler::beginUpdate()
+{
+	// The deadline that woke the loop up still needs its frame, even if nothing registers it again
+	mDue = mDeadline.exchange(NO_DEADLINE) <= SDL_GetTicks();
+}
+
+bool WakeScheduler::isDue()
+{
+	return mDue || mDeadline <= SDL_GetTicks();
+}
+
+int WakeScheduler::getTimeout(int maxTimeout)
+{
+	unsigned int deadline = mDeadline;
+	if (deadline == NO_DEADLINE)
+		return maxTimeout;
+
+	unsigned int now = SDL_GetTicks();
+	if (deadline <= now)
+		return 0;
+
+	unsigned int remaining = deadline - now;
+	return remaining < (unsigned int)maxTimeout ? (int)remaining : maxTimeout;
+}
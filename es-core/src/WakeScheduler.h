@@ -0,0 +1,34 @@
+#pragma once
+#ifndef ES_CORE_WAKE_SCHEDULER_H
+#define ES_CORE_WAKE_SCHEDULER_H
+
+#include <atomic>
+
+// Earliest time a frame is needed by something that is waiting : an animation delay, a storyboard gap, a delayed video, the clock or the screensaver.
+// Components register their deadline from update(), the registrations are collected again on every main loop iteration,
+// and an idle main loop sleeps exactly until the earliest one. Changes that need a frame right away use Window::invalidate()
+class WakeScheduler
+{
+public:
+	// SDL_GetTicks based. A deadline already passed requests the next frame. Thread safe
+	static void requestFrameAt(unsigned int ticks);
+	static void requestFrameIn(int delayMs);
+
+	// Window::update, before the components register again
+	static void beginUpdate();
+
+	// A registered deadline is reached
+	static bool isDue();
+	static void frameRendered() { mDue = false; }
+
+	// ms to sleep until the earliest deadline, at most maxTimeout
+	static int getTimeout(int maxTimeout);
+
+private:
+	static const unsigned int NO_DEADLINE = 0xFFFFFFFF;
+
+	static std::atomic<unsigned int> mDeadline;
+	static bool mDue;
+};
+
+#endif // ES_CORE_WAKE_SCHEDULER_H
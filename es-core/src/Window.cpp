@@ -24,14 +24,28 @@
 #include "components/VolumeInfoComponent.h"
 #include "Splash.h"
 #include "PowerSaver.h"
+#include "FrameScheduler.h"
+#include "WakeScheduler.h"
+#include "InputLatency.h"
+#include "InputRecorder.h"
+#include "Profiler.h"
+#include "MemoryStats.h"
+#include "MemoryProfile.h"
+#include "StatusIndicators.h"
+#include "SoundBank.h"
 #include "renderers/Renderer.h"
 
 #if WIN32
 #include <SDL_syswm.h>
 #endif
 
+// Posted functions run by the main thread per frame, the others wait for the next one
+#define POSTED_FUNCTIONS_BUDGET_MS	4
+#define RESTORE_WAIT_MS				300	// After a game, for the textures that were visible
+
 Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mAverageDeltaTime(10),
-  mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mClockElapsed(0), mMouseCapture(nullptr), mMenuBackgroundShaderTextureCache(-1)
+  mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mClockElapsed(0), mMouseCapture(nullptr), mMenuBackgroundShaderTextureCache(-1), mLastRenderTime(0),
+  mPostedFunctions(nullptr), mPendingFunctions(nullptr), mPendingFunctionsTail(nullptr)
 {			
 	mTransitionOffset = 0;
 
@@ -43,6 +57,10 @@ Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCoun
 	mLastShowCursor = -2;
 }
 
+std::atomic<bool> Window::sRenderRequested(true);
+std::atomic<bool> Window::sWaitingForEvents(false);
+std::atomic<int>  Window::sWakeUpEventType(-1);
+
 Window::~Window()
 {
 	resetMenuBackgroundShader();
@@ -57,10 +75,22 @@ Window::~Window()
 		delete peekGui();
 
 	delete mHelp;
+
+	auto functions = mPostedFunctions.exchange(nullptr);
+	for (auto list : { functions, mPendingFunctions })
+	{
+		while (list != nullptr)
+		{
+			auto next = list->next;
+			delete list;
+			list = next;
+		}
+	}
 }
 
 void Window::pushGui(GuiComponent* gui)
 {
+	invalidate();
 	resetMenuBackgroundShader();
 
 	if (mGuiStack.size() > 0)
@@ -78,6 +108,7 @@ void Window::pushGui(GuiComponent* gui)
 
 void Window::removeGui(GuiComponent* gui)
 {
+	invalidate();
 	resetMenuBackgroundShader();
 
 	if (mMouseCapture == gui)
@@ -129,6 +160,9 @@ bool Window::init(bool initRenderer, bool initInputManager)
 
 	ResourceManager::getInstance()->reloadAll();
 
+	// The fonts were reloaded meanwhile, the view can show once its textures are there
+	TextureResource::waitForRestore(RESTORE_WAIT_MS);
+
 	//keep a reference to the default fonts, so they don't keep getting destroyed/recreated
 	if(mDefaultFonts.empty())
 	{
@@ -197,6 +231,7 @@ void Window::deinit(bool deinitRenderer)
 
 	TextureResource::clearQueue();
 	ResourceManager::getInstance()->unloadAll();
+	GuiComponent::releaseRenderCaches();
 
 	if (deinitRenderer)
 		Renderer::deinit();
@@ -213,7 +248,7 @@ void Window::input(InputConfig* config, Input input)
 	if (config == nullptr)
 		return;
 	
-	if (config->getDeviceIndex() >= 0 && Settings::getInstance()->getBool("FirstJoystickOnly"))
+	if (config->getDeviceIndex() >= 0 && Settings::get(BoolSetting::FirstJoystickOnly))
 	{
 		// Find first player controller info
 		auto playerDevices = InputManager::getInstance()->lastKnownPlayersDeviceIndexes();
@@ -227,11 +262,14 @@ void Window::input(InputConfig* config, Input input)
 			return;
 	}
 
+	InputLatency::onInput();
+	InputRecorder::onInput(config, input);
+
 	if (mScreenSaver) 
 	{
-		if (mScreenSaver->isScreenSaverActive() && Settings::getInstance()->getBool("ScreenSaverControls") &&
-			((Settings::getInstance()->getString("ScreenSaverBehavior") == "slideshow") || 			
-			(Settings::getInstance()->getString("ScreenSaverBehavior") == "random video")))
+		if (mScreenSaver->isScreenSaverActive() && Settings::get(BoolSetting::ScreenSaverControls) &&
+			((Settings::get(StringSetting::ScreenSaverBehavior) == "slideshow") || 			
+			(Settings::get(StringSetting::ScreenSaverBehavior) == "random video")))
 		{
 			if (config->isMappedLike("right", input) || config->isMappedTo("select", input))
 			{
@@ -291,6 +329,7 @@ static std::mutex mNotificationMessagesLock;
 void Window::displayNotificationMessage(std::string message, int duration)
 {
 	std::unique_lock<std::mutex> lock(mNotificationMessagesLock);
+	invalidate();
 
 	if (duration <= 0)
 	{
@@ -428,6 +467,11 @@ void Window::processSongTitleNotifications()
 
 void Window::update(int deltaTime)
 {
+	WakeScheduler::beginUpdate();
+
+	Profiler::setEnabled(Settings::getInstance()->getBool("DrawProfiler"));
+	Profiler::beginFrame();
+
 	if (mLastShowCursor >= 0)
 	{
 		mLastShowCursor += deltaTime;
@@ -438,7 +482,18 @@ void Window::update(int deltaTime)
 		}
 	}
 
-	processPostedFunctions();
+	{
+		ProfileScope scope("Posted functions", Profiler::UPDATE);
+		processPostedFunctions();
+	}
+
+	{
+		// Glyphs finished by the worker, then those of the fonts loaded since startup, a few at a time
+		ProfileScope scope("Glyph prewarm", Profiler::UPDATE);
+		Font::uploadRasterizedGlyphs();
+		Font::prewarmGlyphs(2);
+	}
+
 	processSongTitleNotifications();
 	processNotificationMessages();
 
@@ -455,12 +510,17 @@ void Window::update(int deltaTime)
 	if (mVolumeInfo)
 		mVolumeInfo->update(deltaTime);
 
+	MemoryProfile::update(deltaTime);
+	StatusIndicators::update(deltaTime);
+
 	mFrameTimeElapsed += deltaTime;
 	mFrameCountElapsed++;
 	if (mFrameTimeElapsed > 500)
 	{
 		mAverageDeltaTime = mFrameTimeElapsed / mFrameCountElapsed;
 
+		updateResourceStats();
+
 		if (Settings::DrawFramerate())
 		{
 			std::stringstream ss;
@@ -473,12 +533,48 @@ void Window::update(int deltaTime)
 			float textureVramUsageMb = TextureResource::getTotalMemUsage() / 1000.0f / 1000.0f;
 			float textureTotalUsageMb = TextureResource::getTotalTextureSize() / 1000.0f / 1000.0f;
 			float fontVramUsageMb = Font::getTotalMemUsage() / 1000.0f / 1000.0f;
+			float themeRamUsageMb = ThemeData::getTotalMemUsage() / 1000.0f / 1000.0f;
+			float atlasVramUsageMb = TextureResource::getAtlasMemUsage() / 1000.0f / 1000.0f;
+
+			ss << "\nFont VRAM: " << fontVramUsageMb << " Tex VRAM: " << textureVramUsageMb << " Tex Max: " << textureTotalUsageMb << " Atlas: " << atlasVramUsageMb << " Theme RAM: " << themeRamUsageMb;
+
+			// async texture queue
+			TextureLoaderStats loader = TextureResource::getLoaderStats();
+			ss << "\nTex Queue: " << loader.queueDepth << " Loaded: " << loader.loaded << " Wait: " << loader.averageWait << "ms (max " << loader.maxWait << "ms)";
+
+			// vram budget pools
+			TextureBudgetStats budget = TextureResource::getBudgetStats();
+			ss << "\nVRAM Pools:";
+			for (int i = 0; i < POOL_COUNT; i++)
+				ss << " " << TextureDataManager::getPoolName((TexturePool)i) << " " << budget.poolSize[i] / 1000.0f / 1000.0f;
+			ss << " / " << budget.budget / 1000.0f / 1000.0f << " Evicted: " << budget.evictions << " (" << budget.evictedBytes / 1000.0f / 1000.0f << ") Reloaded: " << budget.reloads;
+			ss << "\nTex Uploads: " << budget.uploads << " (" << budget.uploadedBytes / 1000.0f / 1000.0f << ") Deferred: " << budget.deferredUploads;
+
+			Renderer::BatchStats batches = Renderer::getBatchStats();
+			ss << "\nDraws: " << batches.drawCalls << " Batches: " << batches.batches << " Vertices: " << batches.vertices;
+			ss << "\nGL State: " << batches.stateCalls << " Skipped: " << batches.skippedStateCalls;
+
+			FrameStats frames = FrameScheduler::getStats();
+			ss << "\nTarget: " << frames.targetRate << "fps Frame: " << frames.averageFrameTime << "ms (max " << frames.maxFrameTime << "ms) Work: " << frames.averageWorkTime << "ms Swap: " << frames.averagePresentTime << "ms Sleep: " << frames.averageSleepTime << "ms";
+			ss << "\nFrames: " << frames.frames << " Idle: " << frames.idleFrames << " Missed: " << frames.missedDeadlines;
 
-			ss << "\nFont VRAM: " << fontVramUsageMb << " Tex VRAM: " << textureVramUsageMb << " Tex Max: " << textureTotalUsageMb;
+			// ram by subsystem
+			ss << "\nRAM:";
+			for (int i = 0; i < MemoryStats::SUBSYSTEM_COUNT; i++)
+				ss << " " << MemoryStats::getName((MemoryStats::Subsystem)i) << " " << MemoryStats::getUsage((MemoryStats::Subsystem)i) / 1000.0f / 1000.0f << " (" << MemoryStats::getPeak((MemoryStats::Subsystem)i) / 1000.0f / 1000.0f << ")";
 
 			mFrameDataText = std::unique_ptr<TextCache>(mDefaultFonts.at(0)->buildTextCache(ss.str(), Vector2f(50.f, 50.f), 0xFFFF40FF, 0.0f, ALIGN_LEFT, 1.2f));			
 		}
 
+		if (Profiler::enabled())
+		{
+			std::string profile = Profiler::getOverlayText();
+			if (!profile.empty())
+				mProfilerText = std::unique_ptr<TextCache>(mDefaultFonts.at(0)->buildTextCache(profile, Vector2f(Renderer::getScreenWidth() / 2.0f, 50.f), 0x40FFFFFF, 0.0f, ALIGN_LEFT, 1.2f));
+		}
+		else
+			mProfilerText = nullptr;
+
 		mFrameTimeElapsed = 0;
 		mFrameCountElapsed = 0;
 	}
@@ -508,16 +604,34 @@ void Window::update(int deltaTime)
 
 			mClockElapsed = 1000; // next update in 1000ms
 		}
+
+		WakeScheduler::requestFrameIn(mClockElapsed);
 	}
 
 	mTimeSinceLastInput += deltaTime;
 
+	// The screensaver starts in render()
+	unsigned int screensaverTime = (unsigned int)Settings::ScreenSaverTime();
+	if (screensaverTime != 0 && mTimeSinceLastInput < screensaverTime)
+		WakeScheduler::requestFrameIn(screensaverTime - mTimeSinceLastInput);
+
+	{
+		ProfileScope scope("Animations", Profiler::UPDATE);
+		GuiComponent::updateAnimations(deltaTime);
+	}
+
 	if (peekGui())
+	{
+		ProfileScope scope(peekGui(), Profiler::UPDATE);
 		peekGui()->update(deltaTime);
+	}
 
 	// Update the screensaver
 	if (mScreenSaver)
+	{
+		ProfileScope scope("Screensaver", Profiler::UPDATE);
 		mScreenSaver->update(deltaTime);
+	}
 
 	// update pads 
 	if (mControllerActivity)
@@ -637,6 +751,13 @@ void Window::renderMenuBackgroundShader()
 		resetMenuBackgroundShader();
 }
 
+void Window::preloadMenuBackgroundShader()
+{
+	auto menuBackground = ThemeData::getMenuTheme()->Background;
+	if (!menuBackground.shader.path.empty())
+		Renderer::preloadShader(menuBackground.shader.path);
+}
+
 void Window::resetMenuBackgroundShader()
 {
 	if (mMenuBackgroundShaderTextureCache != -1)
@@ -646,11 +767,96 @@ void Window::resetMenuBackgroundShader()
 	}
 }
 
+void Window::invalidate()
+{
+	// Wake up the main loop only once, when it is blocked in waitEvent
+	if (sRenderRequested.exchange(true) || !sWaitingForEvents)
+		return;
+
+	int type = sWakeUpEventType;
+	if (type < 0)
+		return;
+
+	SDL_Event event;
+	SDL_memset(&event, 0, sizeof(event));
+	event.type = (Uint32)type;
+	SDL_PushEvent(&event);
+}
+
+bool Window::isRenderNeeded()
+{
+	if (sRenderRequested || !Settings::get(BoolSetting::IdleFrameSkip))
+		return true;
+
+	// Videos, storyboards, busy spinners & notification popups pause the PowerSaver while they animate
+	if (PowerSaver::isPaused() || mRenderScreenSaver || Settings::DrawFramerate() || Profiler::enabled())
+		return true;
+
+	if (!mNotificationPopups.empty() || !mAsyncNotificationComponent.empty())
+		return true;
+
+#ifndef HAVE_UDEV
+	// The evdev reader requests the frames when a gun moves, the other platforms poll them
+	if (InputManager::getInstance()->getGuns().size() > 0)
+		return true;
+#endif
+
+	if (WakeScheduler::isDue())
+		return true;
+
+	// Refresh from time to time anyway, for components that don't report their changes
+	return SDL_GetTicks() - mLastRenderTime >= IDLE_REFRESH_TIME;
+}
+
+int Window::getIdleTimeout()
+{
+	int sinceLastRender = (int)(SDL_GetTicks() - mLastRenderTime);
+	return WakeScheduler::getTimeout(std::max(0, IDLE_REFRESH_TIME - sinceLastRender));
+}
+
+bool Window::waitEvent(SDL_Event* event, int timeout)
+{
+	if (sWakeUpEventType < 0)
+		sWakeUpEventType = (int)SDL_RegisterEvents(1);
+
+	sWaitingForEvents = true;
+
+	int ret = sRenderRequested ? SDL_PollEvent(event) : SDL_WaitEventTimeout(event, timeout);
+
+	sWaitingForEvents = false;
+
+	if (ret && isWakeUpEvent(*event))
+		ret = SDL_PollEvent(event);
+
+	return ret != 0;
+}
+
+bool Window::isWakeUpEvent(const SDL_Event& event)
+{
+	return sWakeUpEventType >= 0 && event.type == (Uint32)sWakeUpEventType;
+}
+
 void Window::render()
 {
+	// Invalidations from now on request the next frame
+	sRenderRequested = false;
+	WakeScheduler::frameRendered();
+	mLastRenderTime = SDL_GetTicks();
+
 	Transform4x4f transform = Transform4x4f::Identity();
 
 	mRenderedHelpPrompts = false;
+
+	// Textures loaded from now on belong to the screensaver, menu or view budget pool
+	TexturePool texturePool = TextureResource::getViewPool();
+	if (mRenderScreenSaver)
+		texturePool = POOL_SCREENSAVER;
+	else if (mGuiStack.size() > 1)
+		texturePool = POOL_MENU;
+
+	TextureResource::beginFrame(texturePool);
+
+	Profiler::beginRender();
 	
 	// draw only bottom and top of GuiStack (if they are different)
 	if (mGuiStack.size())
@@ -660,7 +866,11 @@ void Window::render()
 
 		auto menuBackground = ThemeData::getMenuTheme()->Background;
 
-		bottom->render(transform);
+		{
+			ProfileScope scope(bottom, Profiler::RENDER);
+			bottom->render(transform);
+		}
+
 		if (bottom != top)
 		{
 			if ((top->getTag() == "GuiLoading") && mGuiStack.size() > 2)
@@ -670,8 +880,12 @@ void Window::render()
 
 				auto& middle = mGuiStack.at(mGuiStack.size() - 2);
 				if (middle != bottom)
+				{
+					ProfileScope scope(middle, Profiler::RENDER);
 					middle->render(transform);
+				}
 
+				ProfileScope scope(top, Profiler::RENDER);
 				top->render(transform);
 			}
 			else
@@ -680,12 +894,16 @@ void Window::render()
 				{
 					auto& middle = mGuiStack.at(mGuiStack.size() - 2);
 					if (middle != bottom)
+					{
+						ProfileScope scope(middle, Profiler::RENDER);
 						middle->render(transform);
+					}
 				}
 
 				mBackgroundOverlay->render(transform);
 				renderMenuBackgroundShader();
 
+				ProfileScope scope(top, Profiler::RENDER);
 				top->render(transform);
 			}
 		}
@@ -698,8 +916,13 @@ void Window::render()
 	renderSindenBorders();
 
 	if (mGuiStack.size() < 2 || !Renderer::isSmallScreen())
+	{
 		if (!mRenderedHelpPrompts)
+		{
+			ProfileScope scope("Help prompts", Profiler::RENDER);
 			mHelp->render(transform);
+		}
+	}
 
 	// FPS overlay
 	if (Settings::DrawFramerate() && mFrameDataText)
@@ -719,6 +942,14 @@ void Window::render()
 		mDefaultFonts.at(1)->renderTextCache(mFrameDataText.get());
 	}
 
+	// Profiler overlay
+	if (Profiler::enabled() && mProfilerText)
+	{
+		Renderer::setMatrix(transform);
+		Renderer::drawRect(Renderer::getScreenWidth() / 2.0f - 5.f, 50.f, mProfilerText->metrics.size.x() + 10.f, mProfilerText->metrics.size.y(), 0x00000080);
+		mDefaultFonts.at(1)->renderTextCache(mProfilerText.get());
+	}
+
 	// clock 
 	if (Settings::DrawClock() && mClock && (mGuiStack.size() < 2 || !Renderer::isSmallScreen()))
 		mClock->render(transform);
@@ -738,6 +969,8 @@ void Window::render()
 	// Render notifications
 	if (!mRenderScreenSaver)
 	{
+		ProfileScope scope("Notifications", Profiler::RENDER);
+
 		for (auto popup : mNotificationPopups)
 			popup->render(transform);
 
@@ -746,7 +979,10 @@ void Window::render()
 
 	// Always call the screensaver render function regardless of whether the screensaver is active
 	// or not because it may perform a fade on transition
-	renderScreenSaver();
+	{
+		ProfileScope scope("Screensaver", Profiler::RENDER);
+		renderScreenSaver();
+	}
 
 	if (!mRenderScreenSaver)
 	{
@@ -893,6 +1129,8 @@ void Window::render()
 
 		Renderer::setScreenMargin(margin.x(), margin.y());
 	}
+
+	Profiler::endFrame();
 }
 
 void Window::normalizeNextUpdate()
@@ -1187,28 +1425,41 @@ void Window::updateAsyncNotifications(int deltaTime)
 		PowerSaver::resume();
 }
 
-void Window::unregisterPostedFunctions(void* data)
+static WindowResourceStats sResourceStats;
+static std::mutex sResourceStatsLock;
+
+void Window::updateResourceStats()
 {
-	if (data == nullptr)
-		return;
+	WindowResourceStats stats;
+	stats.textureVram = TextureResource::getTotalMemUsage();
+	stats.textureTotal = TextureResource::getTotalTextureSize();
+	stats.fontVram = Font::getTotalMemUsage();
+	stats.atlasVram = TextureResource::getAtlasMemUsage();
+	stats.themeRam = ThemeData::getTotalMemUsage();
+
+	MemoryStats::set(MemoryStats::THEME, stats.themeRam);
+	MemoryStats::set(MemoryStats::SOUND, SoundBank::getMemUsage());
+
+	std::unique_lock<std::mutex> lock(sResourceStatsLock);
+	sResourceStats = stats;
+}
 
-	for (auto it = mFunctions.cbegin(); it != mFunctions.cend(); )
-	{
-		if ((*it).container == data)
-			it = mFunctions.erase(it);
-		else
-			it++;
-	}
+WindowResourceStats Window::getResourceStats()
+{
+	std::unique_lock<std::mutex> lock(sResourceStatsLock);
+	return sResourceStats;
 }
 
-void Window::postToUiThread(const std::function<void()>& func, void* data)
+void Window::postToUiThread(const std::function<void()>& func, const PostedFunctionToken& token)
 {	
-	std::unique_lock<std::mutex> lock(mNotificationMessagesLock);
+	PostedFunction* pf = new PostedFunction();
+	pf->func = func;
+	pf->token = token;
+	pf->next = mPostedFunctions.load(std::memory_order_relaxed);
 
-	PostedFunction pf;
-	pf.func = func;
-	pf.container = data;
-	mFunctions.push_back(pf);
+	while (!mPostedFunctions.compare_exchange_weak(pf->next, pf, std::memory_order_release, std::memory_order_relaxed));
+
+	invalidate();
 	if (mSleeping || !PowerSaver::getState())
 	{
 		mSleeping = false;
@@ -1219,19 +1470,54 @@ void Window::postToUiThread(const std::function<void()>& func, void* data)
 
 void Window::processPostedFunctions()
 {
-	std::vector<PostedFunction> functions;
+	// Newest first : reverse the batch before queuing it after the functions left by the previous frame
+	PostedFunction* batch = mPostedFunctions.exchange(nullptr, std::memory_order_acquire);
+	if (batch != nullptr)
+	{
+		PostedFunction* first = nullptr;
+		PostedFunction* last = batch;
+
+		while (batch != nullptr)
+		{
+			auto next = batch->next;
+			batch->next = first;
+			first = batch;
+			batch = next;
+		}
 
-	mNotificationMessagesLock.lock();
+		if (mPendingFunctionsTail != nullptr)
+			mPendingFunctionsTail->next = first;
+		else
+			mPendingFunctions = first;
 
-	for (auto func : mFunctions)
-		functions.push_back(func);
+		mPendingFunctionsTail = last;
+	}
 
-	mFunctions.clear();
+	if (mPendingFunctions == nullptr)
+		return;
 
-	mNotificationMessagesLock.unlock();
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+	Uint64 deadline = SDL_GetPerformanceCounter() + frequency * POSTED_FUNCTIONS_BUDGET_MS / 1000;
 
-	for (auto func : functions)
-		TRYCATCH("processPostedFunction", func.func())
+	// Functions posted by the ones running now wait for the next frame
+	while (mPendingFunctions != nullptr)
+	{
+		PostedFunction* pf = mPendingFunctions;
+		mPendingFunctions = pf->next;
+		if (mPendingFunctions == nullptr)
+			mPendingFunctionsTail = nullptr;
+
+		if (pf->token == nullptr || !*pf->token)
+			TRYCATCH("processPostedFunction", pf->func())
+
+		delete pf;
+
+		if (mPendingFunctions != nullptr && SDL_GetPerformanceCounter() >= deadline)
+		{
+			invalidate();
+			break;
+		}
+	}
 }
 
 void Window::onThemeChanged(const std::shared_ptr<ThemeData>& theme)
@@ -9,6 +9,7 @@
 #include "math/Vector2i.h"
 #include <memory>
 #include <functional>
+#include <atomic>
 
 class FileData;
 class Font;
@@ -28,6 +29,19 @@ class ControllerActivityComponent;
 class VolumeInfoComponent;
 class BatteryIndicatorComponent;
 class Splash;
+union SDL_Event;
+
+// Memory used by the resources, sampled by the main loop every 500ms
+struct WindowResourceStats
+{
+	WindowResourceStats() : textureVram(0), textureTotal(0), fontVram(0), atlasVram(0), themeRam(0) { }
+
+	size_t textureVram;
+	size_t textureTotal;	// if all the textures were loaded
+	size_t fontVram;
+	size_t atlasVram;
+	size_t themeRam;
+};
 
 class Window
 {
@@ -60,6 +74,19 @@ public:
 	void update(int deltaTime);
 	void render();
 
+	// Idle frames : when the "IdleFrameSkip" setting is on, a frame is only rendered when something requested it
+	// (property change, animation, input, notification, texture load, playing video, WakeScheduler deadline...), or every IDLE_REFRESH_TIME ms.
+	// Short ( the "instant" PowerSaver delay ) : a component changing its state in update() without requesting a frame only lags, it doesn't freeze
+	static const int IDLE_REFRESH_TIME = 200;
+
+	static void invalidate(); // Requests a new frame. Can be called from any thread
+	bool isRenderNeeded();
+	int getIdleTimeout(); // ms an idle main loop can wait for events
+
+	// Waits for an event at most timeout ms, returns immediately when a frame is requested. Returns false if no event arrived
+	static bool waitEvent(SDL_Event* event, int timeout);
+	static bool isWakeUpEvent(const SDL_Event& event);
+
 	bool init(bool initRenderer = true, bool initInputManager = true);
 	void deinit(bool deinitRenderer = true);
 
@@ -76,6 +103,9 @@ public:
 	void renderSplashScreen(float opacity = 1, bool swapBuffers = true);
 	void closeSplashScreen();
 
+	// Compiles the menu background shader of the theme before the first menu opens
+	void preloadMenuBackgroundShader();
+
 	void renderHelpPromptsEarly(const Transform4x4f& transform); // used to render HelpPrompts before a fade
 	void setHelpPrompts(const std::vector<HelpPrompt>& prompts, const HelpStyle& style);
 
@@ -87,8 +117,16 @@ public:
 	bool cancelScreenSaver();
 	void renderScreenSaver();
 
-	void postToUiThread(const std::function<void()>& func, void* data = nullptr);
-	void unregisterPostedFunctions(void* data);
+	// Functions posted with a token are dropped once it is cancelled, without searching the queue
+	typedef std::shared_ptr<std::atomic<bool>> PostedFunctionToken;
+	static PostedFunctionToken createPostedFunctionToken() { return std::make_shared<std::atomic<bool>>(false); }
+	static void cancelPostedFunctions(const PostedFunctionToken& token) { if (token != nullptr) *token = true; }
+
+	// Lock free, from any thread. The main thread runs the posted functions in order, within a time budget per frame
+	void postToUiThread(const std::function<void()>& func, const PostedFunctionToken& token = nullptr);
+
+	// Thread safe : the resources themselves can only be walked from the main thread
+	static WindowResourceStats getResourceStats();
 	void reactivateGui();
 
 	void onThemeChanged(const std::shared_ptr<ThemeData>& theme);
@@ -112,6 +150,7 @@ private:
 	std::vector<GuiComponent*> hitTest(int x, int y);
 
 	void processPostedFunctions();
+	void updateResourceStats();
 	void renderSindenBorders();
 
 	std::vector<AsyncNotificationComponent*> mAsyncNotificationComponent;
@@ -121,10 +160,15 @@ private:
 	struct PostedFunction
 	{
 		std::function<void()> func;
-		void* container;
+		PostedFunctionToken token;
+		PostedFunction* next;
 	};
 
-	std::vector<PostedFunction> mFunctions;
+	// Producers push on mPostedFunctions, newest first. The main thread takes the whole list at once
+	// and keeps what the frame budget did not allow to run, oldest first
+	std::atomic<PostedFunction*> mPostedFunctions;
+	PostedFunction* mPendingFunctions;
+	PostedFunction* mPendingFunctionsTail;
 
 	std::vector<GuiInfoPopup*> mNotificationPopups;
 	void updateNotificationPopups(int deltaTime);
@@ -155,6 +199,7 @@ private:
 	int mAverageDeltaTime;
 
 	std::unique_ptr<TextCache> mFrameDataText;
+	std::unique_ptr<TextCache> mProfilerText;
 
 	int mClockElapsed;
 	std::shared_ptr<TextComponent>	mClock;
@@ -184,6 +229,12 @@ private:
 	void renderMenuBackgroundShader();
 	void resetMenuBackgroundShader();
 	unsigned int mMenuBackgroundShaderTextureCache;
+
+	unsigned int mLastRenderTime;
+
+	static std::atomic<bool> sRenderRequested;
+	static std::atomic<bool> sWaitingForEvents;
+	static std::atomic<int>  sWakeUpEventType;
 };
 
 #endif // ES_CORE_WINDOW_H
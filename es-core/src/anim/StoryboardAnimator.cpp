@@ -1,15 +1,46 @@
 #include "StoryboardAnimator.h"
 #include "PowerSaver.h"
+#include "WakeScheduler.h"
+
+#include <algorithm>
+#include <cmath>
 
 StoryboardAnimator::StoryboardAnimator(GuiComponent* comp, ThemeStoryboard* storyboard)
 {
 	mHasInitialProperties = false;
 	mPaused = true;
+	mWaiting = false;
 	mComponent = comp;
 
 	mStoryBoard = new ThemeStoryboard(*storyboard);
 	mRepeatCount = 0;
 	mCurrentTime = 0;
+
+	// One track by property name, whatever the count of its animations
+	for (auto anim : mStoryBoard->animations)
+	{
+		int track = -1;
+		for (int i = 0; i < (int)mTracks.size(); i++)
+			if (mTracks[i].name == anim->propertyName) { track = i; break; }
+
+		if (track < 0)
+		{
+			track = (int)mTracks.size();
+			mTracks.push_back({ anim->propertyName, ThemeData::ThemeElement::Property(), false, false });
+		}
+
+		mAnimTracks.push_back(track);
+	}
+
+	size_t count = mStoryBoard->animations.size();
+	mStates.resize(count, PENDING);
+	mTimes.resize(count, 0);
+	mRepeats.resize(count, 0);
+	mReversed.resize(count, 0);
+
+	mRunning.reserve(count);
+	mPendingCount = (int)count;
+	mFinishedCount = 0;
 }
 
 StoryboardAnimator::~StoryboardAnimator()
@@ -17,73 +48,83 @@ StoryboardAnimator::~StoryboardAnimator()
 	delete mStoryBoard;
 
 	pause();
-
-	for (auto story : _currentStories)
-		delete story;
-
-	_currentStories.clear();
 }
 
 void StoryboardAnimator::clearStories()
 {
-	for (auto story : _finishedStories)
-		delete story;
-
-	for (auto story : _currentStories)
-		delete story;
+	std::fill(mStates.begin(), mStates.end(), PENDING);
+	std::fill(mTimes.begin(), mTimes.end(), 0);
+	std::fill(mRepeats.begin(), mRepeats.end(), 0);
+	std::fill(mReversed.begin(), mReversed.end(), 0);
+
+	mRunning.clear();
+	mPendingCount = (int)mStates.size();
+	mFinishedCount = 0;
+}
 
-	_finishedStories.clear();
-	_currentStories.clear();
+void StoryboardAnimator::applyInitialProperties()
+{
+	for (auto& track : mTracks)
+		if (track.hasInitialValue && !track.disabled)
+			mComponent->setProperty(track.name, track.initialValue);
 }
 
 void StoryboardAnimator::reset(int atTime)
 {
-	if (mPaused)
+	if (mPaused || mWaiting)
 	{
 		PowerSaver::pause();
 		mPaused = false;
+		mWaiting = false;
 	}
 
 	mCurrentTime = atTime;
 
 	clearStories();
 
+	auto& animations = mStoryBoard->animations;
+
 	if (atTime > 0)
 	{
-		for (auto anim : mStoryBoard->animations)
-			if (anim->begin + anim->duration <= atTime)
-				_finishedStories.push_back(new StoryAnimation(anim));
+		for (int i = 0; i < (int)animations.size(); i++)
+		{
+			if (animations[i]->begin + animations[i]->duration <= atTime)
+			{
+				mStates[i] = FINISHED;
+				mPendingCount--;
+				mFinishedCount++;
+			}
+		}
 
 		addNewAnimations();
 	}
 	else
 	{
 		if (mHasInitialProperties)
+			applyInitialProperties();
+
+		for (int i = 0; i < (int)animations.size(); i++)
 		{
-			for (auto prop : mInitialProperties)
-				if (mDisabledProperties.find(prop.first) == mDisabledProperties.cend())
-					mComponent->setProperty(prop.first, prop.second);
+			if (animations[i]->begin == 0)
+			{
+				mStates[i] = RUNNING;
+				mPendingCount--;
+				mRunning.push_back(i);
+			}
 		}
-
-		for (auto anim : mStoryBoard->animations)
-			if (anim->begin == 0)
-				_currentStories.push_back(new StoryAnimation(anim));
 	}
 }
 
 void StoryboardAnimator::clearInitialProperties()
 {	
-	mInitialProperties.clear();
+	for (auto& track : mTracks)
+		track.hasInitialValue = false;
 }
 
 void StoryboardAnimator::stop()
 {
 	pause();
-
-	for (auto prop : mInitialProperties)
-		if (mDisabledProperties.find(prop.first) == mDisabledProperties.cend())
-			mComponent->setProperty(prop.first, prop.second);
-
+	applyInitialProperties();
 	clearStories();
 }
 
@@ -91,60 +132,176 @@ void StoryboardAnimator::pause()
 { 
 	if (!mPaused)
 	{
-		PowerSaver::resume();
+		if (!mWaiting)
+			PowerSaver::resume();
+
 		mPaused = true;
+		mWaiting = false;
 	}
 }
 
 void StoryboardAnimator::addNewAnimations()
 {
-	for (auto anim : mStoryBoard->animations)
+	if (mPendingCount == 0)
+		return;
+
+	auto& animations = mStoryBoard->animations;
+
+	for (int i = 0; i < (int)animations.size(); i++)
 	{
-		bool exists = false;
+		if (mStates[i] != PENDING || mCurrentTime < animations[i]->begin)
+			continue;
+
+		auto anim = animations[i];
+		anim->ensureInitialValue(mComponent->getProperty(anim->propertyName));
+
+		mStates[i] = RUNNING;
+		mPendingCount--;
+		mRunning.push_back(i);
+	}
+}
+
+float StoryboardAnimator::ease(ThemeAnimation::EasingMode mode, int time, int duration)
+{
+	if (time >= duration)
+		return 1;
+
+	float b = 0;
+	float c = 1;
+
+	float t = time / (float)duration;
+	if (t > 1)
+		t = 1;
+
+	switch (mode)
+	{
+	case ThemeAnimation::EasingMode::EaseIn:
+		return (t * t + b);
+
+	case ThemeAnimation::EasingMode::EaseInCubic:
+		return t * t * t;
+
+	case ThemeAnimation::EasingMode::EaseInQuint:
+		return t * t * t * t * t;
+
+	case ThemeAnimation::EasingMode::EaseOut:
+		return (-c * t * (t - 2.0f));
+
+	case ThemeAnimation::EasingMode::EaseOutCubic:
+		t = t - 1.0f;
+		return t * t * t + 1.0f;
+
+	case ThemeAnimation::EasingMode::EaseOutQuint:
+		t = t - 1.0f;
+		return t * t * t * t * t + 1.0f;
+
+	case ThemeAnimation::EasingMode::EaseInOut:
+		t = time / ((float)duration / 2.0f);
+		if (t < 1)
+			return t * t / 2.0f;
 
-		for (auto story : _currentStories)
-			if (story->animation == anim) { exists = true; break; }
+		t--;
+		return (-c / 2.0f * (t * (t - 2.0f) - 1.0f));
 
-		if (!exists && _finishedStories.size())
+	case ThemeAnimation::EasingMode::Bump:
+		#define PIVAL 3.141592653589793238462643383279502884L
+		return sin((PIVAL / 2.0) * t) + sin(PIVAL * t) / 2.0;
+
+	default:
+		return t;
+	}
+}
+
+bool StoryboardAnimator::evaluate(int index, int elapsed, ThemeData::ThemeElement::Property& value)
+{
+	auto animation = mStoryBoard->animations[index];
+
+	int& currentTime = mTimes[index];
+	int& repeatCount = mRepeats[index];
+	uint8_t& isReversed = mReversed[index];
+
+	if (isReversed)
+		currentTime -= elapsed;
+	else
+		currentTime += elapsed;
+
+	bool ended = false;
+	bool pseudoEnd = false;
+
+	if (!isReversed && currentTime > animation->duration)
+	{
+		if (animation->autoReverse)
 		{
-			for (auto story : _finishedStories)
-				if (story->animation == anim) { exists = true; break; }
+			isReversed = 1;
+			currentTime = animation->duration;
 		}
+		else
+		{
+			pseudoEnd = true;
+			currentTime = 0;
+		}
+	}
+	else if (isReversed && currentTime < 0)
+	{
+		currentTime = 0;
+		isReversed = 0;
+		pseudoEnd = true;
+	}
 
-		if (exists)
-			continue;
-
-		if (mCurrentTime >= anim->begin)
+	if (pseudoEnd)
+	{
+		if (animation->repeat == 1)
+			ended = true;
+		else if (animation->repeat > 1)
 		{
-			anim->ensureInitialValue(mComponent->getProperty(anim->propertyName));
-			_currentStories.push_back(new StoryAnimation(anim));
+			repeatCount++;
+			if (repeatCount >= animation->repeat)
+				ended = true;
+			else
+				currentTime = 0;
 		}
 	}
+
+	if (ended || animation->duration == 0)
+	{
+		value = animation->computeValue(animation->autoReverse ? 0.0f : 1.0f);
+		return false;
+	}
+
+	value = animation->computeValue(ease(animation->easingMode, currentTime, animation->duration));
+	return true;
 }
 
 bool StoryboardAnimator::update(int elapsed)
 {
-	if (mPaused || elapsed > 500)
+	// A long sleep until the next animation is not a hiccup
+	if (mPaused || (elapsed > 500 && !mWaiting))
 		return true;
 
+	auto& animations = mStoryBoard->animations;
+
 	if (!mHasInitialProperties)
 	{
 		mHasInitialProperties = true;
 
-		for (auto anim : mStoryBoard->animations)
-			mInitialProperties[anim->propertyName] = mComponent->getProperty(anim->propertyName);
+		for (auto& track : mTracks)
+		{
+			track.initialValue = mComponent->getProperty(track.name);
+			track.hasInitialValue = true;
+		}
 
-		for (auto anim : mStoryBoard->animations)
+		for (int i = 0; i < (int)animations.size(); i++)
 		{
-			if (anim->begin == 0)
-			{
-				if (anim->to.type == ThemeData::ThemeElement::Property::Unknown)
-					anim->to = mComponent->getProperty(anim->propertyName);
-				if (anim->from.type == ThemeData::ThemeElement::Property::Unknown)
-					anim->from = mComponent->getProperty(anim->propertyName);
-				else if (mDisabledProperties.find(anim->propertyName) == mDisabledProperties.cend())
-					mComponent->setProperty(anim->propertyName, anim->from);
-			}
+			auto anim = animations[i];
+			if (anim->begin != 0)
+				continue;
+
+			if (anim->to.type == ThemeData::ThemeElement::Property::Unknown)
+				anim->to = mComponent->getProperty(anim->propertyName);
+			if (anim->from.type == ThemeData::ThemeElement::Property::Unknown)
+				anim->from = mComponent->getProperty(anim->propertyName);
+			else if (!mTracks[mAnimTracks[i]].disabled)
+				mComponent->setProperty(anim->propertyName, anim->from);
 		}
 	}
 
@@ -152,26 +309,26 @@ bool StoryboardAnimator::update(int elapsed)
 
 	addNewAnimations();
 
-	for (int i = _currentStories.size() - 1; i >= 0; i--)
+	ThemeData::ThemeElement::Property value;
+
+	for (int r = (int)mRunning.size() - 1; r >= 0; r--)
 	{
-		auto story = _currentStories[i];
-		bool ended = !story->update(elapsed);
+		int index = mRunning[r];
+		bool ended = !evaluate(index, elapsed, value);
 
-		if (mDisabledProperties.find(story->animation->propertyName) == mDisabledProperties.cend())
-			mComponent->setProperty(story->animation->propertyName, story->currentValue);
+		auto& track = mTracks[mAnimTracks[index]];
+		if (!track.disabled)
+			mComponent->setProperty(track.name, value);
 
 		if (ended)
 		{
-			_finishedStories.push_back(story);
-
-			auto it = _currentStories.begin();
-			std::advance(it, i);
-			_currentStories.erase(it);
-			continue;
+			mStates[index] = FINISHED;
+			mFinishedCount++;
+			mRunning.erase(mRunning.begin() + r);
 		}
 	}
 
-	if (_finishedStories.size() == mStoryBoard->animations.size())
+	if (mFinishedCount == (int)animations.size())
 	{
 		if (mStoryBoard->repeat == 1)
 		{
@@ -194,9 +351,40 @@ bool StoryboardAnimator::update(int elapsed)
 		return true;
 	}
 
+	updateWaiting();
 	return true;
 }
 
+void StoryboardAnimator::updateWaiting()
+{
+	// Nothing animates until the next begin : let the main loop sleep until then instead of rendering every frame
+	int delay = -1;
+
+	if (mRunning.empty())
+	{
+		for (auto anim : mStoryBoard->animations)
+		{
+			int remaining = anim->begin - mCurrentTime;
+			if (remaining > 0 && (delay < 0 || remaining < delay))
+				delay = remaining;
+		}
+	}
+
+	bool waiting = delay > 0;
+	if (waiting)
+		WakeScheduler::requestFrameIn(delay);
+
+	if (waiting == mWaiting)
+		return;
+
+	if (waiting)
+		PowerSaver::resume();
+	else
+		PowerSaver::pause();
+
+	mWaiting = waiting;
+}
+
 const std::string StoryboardAnimator::getName()
 {
 	if (mStoryBoard != nullptr)
@@ -207,8 +395,8 @@ const std::string StoryboardAnimator::getName()
 
 void StoryboardAnimator::enableProperty(const std::string& name, bool enable)
 {
-	mDisabledProperties.erase(name);
-
-	if (!enable)
-		mDisabledProperties.insert(name);
+	// The storyboard doesn't animate the other properties
+	for (auto& track : mTracks)
+		if (track.name == name)
+			track.disabled = !enable;
 }
\ No newline at end of file
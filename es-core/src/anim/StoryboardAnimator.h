@@ -4,155 +4,11 @@
 #include "ThemeStoryboard.h"
 #include "GuiComponent.h"
 #include <vector>
-#include <map>
-#include <set>
-
-class StoryAnimation
-{
-public:
-	StoryAnimation(ThemeAnimation* anim)
-	{
-		animation = anim;
-
-		_repeatCount = 0;
-		_currentTime = 0;
-		_isReversed = false;		
-	}
-
-	bool update(int elapsed)
-	{
-		if (animation == nullptr)
-			return false;
-
-		if (_isReversed)
-			_currentTime -= elapsed;
-		else
-			_currentTime += elapsed;
-
-		bool ended = false;
-		bool pseudoEnd = false;
-
-		if (!_isReversed && _currentTime > animation->duration)
-		{
-			if (animation->autoReverse)
-			{
-				_isReversed = true;
-				_currentTime = animation->duration;
-			}
-			else
-			{
-				pseudoEnd = true;
-				_currentTime = 0;
-			}
-
-		}
-		else if (_isReversed && _currentTime < 0)
-		{
-			_currentTime = 0;
-			_isReversed = false;
-			pseudoEnd = true;
-		}
-
-		if (pseudoEnd)
-		{
-			if (animation->repeat == 1)
-				ended = true;
-			else if (animation->repeat > 1)
-			{
-				_repeatCount++;
-				if (_repeatCount >= animation->repeat)
-					ended = true;
-				else
-					_currentTime = 0;
-			}
-		}
-
-		if (ended || animation->duration == 0)
-		{
-			currentValue = animation->computeValue(animation->autoReverse ? 0.0f : 1.0f);
-			return false;
-		}
-
-		float value = 0;
-
-		if (_currentTime >= animation->duration)
-			value = 1;
-		else if (_currentTime < animation->duration)
-		{
-			float b = 0;
-			float c = 1;
-			float d = animation->duration;
-
-			float t = _currentTime / (float)animation->duration;
-			if (t > 1)
-				t = 1;
-
-			switch (animation->easingMode)
-			{
-			case ThemeAnimation::EasingMode::EaseIn:
-				value = (t * t + b);
-				break;
-
-			case ThemeAnimation::EasingMode::EaseInCubic:
-				value = t * t * t;
-				break;
-
-			case ThemeAnimation::EasingMode::EaseInQuint:
-				value = t * t * t * t * t;
-				break;
-
-			case ThemeAnimation::EasingMode::EaseOut:
-				value = (-c * t * (t - 2.0f));
-				break;
-
-			case ThemeAnimation::EasingMode::EaseOutCubic:
-				t = t - 1.0f;
-				value = t * t * t + 1.0f;
-				break;
-
-			case ThemeAnimation::EasingMode::EaseOutQuint:
-				t = t - 1.0f;
-				value = t * t * t * t * t + 1.0f;
-				break;
-
-			case ThemeAnimation::EasingMode::EaseInOut:
-				t = _currentTime / ((float)animation->duration / 2.0f);
-				if (t < 1)
-					value = t * t / 2.0f;
-				else
-				{
-					t--;
-					value = (-c / 2.0f * (t * (t - 2.0f) - 1.0f));
-				}
-				break;
-
-			case ThemeAnimation::EasingMode::Bump:
-				#define PIVAL 3.141592653589793238462643383279502884L
-				value = sin((PIVAL / 2.0) * t) + sin(PIVAL * t) / 2.0;
-				break;
-
-			default:
-				value = t;
-				break;
-			}
-		}
-
-		currentValue = animation->computeValue(value);
-
-		return !ended;
-	}
-
-
-	ThemeData::ThemeElement::Property currentValue;
-
-	ThemeAnimation* animation;
-
-private:
-	int _repeatCount;
-	int _currentTime;
-	bool _isReversed;
-};
+#include <cstdint>
 
+// Plays a storyboard on a component.
+// The storyboard is compiled once into flat arrays : the state of each animation is indexed like mStoryBoard->animations,
+// each animation knows the track of its property, and a frame is one pass over the running indexes
 class StoryboardAnimator
 {
 public:
@@ -165,6 +21,8 @@ public:
 	void pause();
 
 	bool isRunning() { return !mPaused; }
+	// Running, but the next animations begin later : the WakeScheduler has their deadline
+	bool isWaiting() { return mWaiting; }
 	void clearInitialProperties();
 
 	const std::string getName();
@@ -172,8 +30,30 @@ public:
 	void enableProperty(const std::string& name, bool enable);
 
 private:
+	enum State : uint8_t
+	{
+		PENDING,
+		RUNNING,
+		FINISHED
+	};
+
+	// A property animated by the storyboard
+	struct Track
+	{
+		std::string							name;
+		ThemeData::ThemeElement::Property	initialValue;
+		bool								hasInitialValue;
+		bool								disabled;
+	};
+
+	// Advances one animation, false when it ended
+	bool evaluate(int index, int elapsed, ThemeData::ThemeElement::Property& value);
+	static float ease(ThemeAnimation::EasingMode mode, int time, int duration);
+
+	void applyInitialProperties();
 	void addNewAnimations();
 	void clearStories();
+	void updateWaiting();
 
 	GuiComponent* mComponent;
 	ThemeStoryboard* mStoryBoard;
@@ -182,11 +62,20 @@ private:
 	int mCurrentTime;
 
 	bool mPaused;
+	bool mWaiting;
+
+	std::vector<Track> mTracks;
+
+	// By animation
+	std::vector<int>		mAnimTracks;
+	std::vector<State>		mStates;
+	std::vector<int>		mTimes;
+	std::vector<int>		mRepeats;
+	std::vector<uint8_t>	mReversed;
 
-	std::vector<StoryAnimation*> _currentStories;
-	std::vector<StoryAnimation*> _finishedStories;
-	std::map<std::string, ThemeData::ThemeElement::Property> mInitialProperties;
-	std::set<std::string> mDisabledProperties;
+	std::vector<int> mRunning; // Started first, first
+	int mPendingCount;
+	int mFinishedCount;
 
 	bool mHasInitialProperties;
 };
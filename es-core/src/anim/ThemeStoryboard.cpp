@@ -1,7 +1,6 @@
 #include "ThemeStoryboard.h"
 #include "Log.h"
 #include "utils/StringUtil.h"
-#include "utils/HtmlColor.h"
 #include "resources/ResourceManager.h"
 
 ThemeStoryboard::ThemeStoryboard(const ThemeStoryboard& src)
@@ -84,26 +83,26 @@ bool ThemeStoryboard::fromXmlNode(const pugi::xml_node& root, const std::map<std
 		{
 		case ThemeData::ElementPropertyType::NORMALIZED_RECT:
 			anim = new ThemeVector4Animation();
-			if (node.attribute("from")) anim->from = Vector4f::parseString(node.attribute("from").as_string());
-			if (node.attribute("to")) anim->to = Vector4f::parseString(node.attribute("to").as_string());
+			if (node.attribute("from")) anim->from = ThemeData::parseValue(type, node.attribute("from").as_string());
+			if (node.attribute("to")) anim->to = ThemeData::parseValue(type, node.attribute("to").as_string());
 			break;
 
 		case ThemeData::ElementPropertyType::NORMALIZED_PAIR:
 			anim = new ThemeVector2Animation();
-			if (node.attribute("from")) anim->from = Vector2f::parseString(node.attribute("from").as_string());
-			if (node.attribute("to")) anim->to = Vector2f::parseString(node.attribute("to").as_string());		
+			if (node.attribute("from")) anim->from = ThemeData::parseValue(type, node.attribute("from").as_string());
+			if (node.attribute("to")) anim->to = ThemeData::parseValue(type, node.attribute("to").as_string());		
 			break;
 
 		case ThemeData::ElementPropertyType::COLOR:			
 			anim = new ThemeColorAnimation();
-			if (node.attribute("from")) anim->from = Utils::HtmlColor::parse(node.attribute("from").as_string());
-			if (node.attribute("to")) anim->to = Utils::HtmlColor::parse(node.attribute("to").as_string());
+			if (node.attribute("from")) anim->from = ThemeData::parseValue(type, node.attribute("from").as_string());
+			if (node.attribute("to")) anim->to = ThemeData::parseValue(type, node.attribute("to").as_string());
 			break;
 
 		case ThemeData::ElementPropertyType::FLOAT:
 			anim = new ThemeFloatAnimation();
-			if (node.attribute("from")) anim->from = Utils::String::toFloat(node.attribute("from").as_string());	
-			if (node.attribute("to")) anim->to = Utils::String::toFloat(node.attribute("to").as_string());
+			if (node.attribute("from")) anim->from = ThemeData::parseValue(type, node.attribute("from").as_string());	
+			if (node.attribute("to")) anim->to = ThemeData::parseValue(type, node.attribute("to").as_string());
 			break;
 
 		case ThemeData::ElementPropertyType::PATH:
@@ -3,6 +3,7 @@
 #include "components/ImageComponent.h"
 #include "resources/ResourceManager.h"
 #include "Log.h"
+#include "Window.h"
 
 AnimatedImageComponent::AnimatedImageComponent(Window* window) : GuiComponent(window), mEnabled(false)
 {
@@ -59,6 +60,7 @@ void AnimatedImageComponent::update(int deltaTime)
 
 	while(mFrames.at(mCurrentFrame).second <= mFrameAccumulator)
 	{
+		invalidateRender();
 		mCurrentFrame++;
 
 		if(mCurrentFrame == (int)mFrames.size())
@@ -1,11 +1,9 @@
 #include "components/BatteryIconComponent.h"
-#include "Settings.h"
-
-#define UPDATE_NETWORK_DELAY	2000
+#include "StatusIndicators.h"
 
 BatteryIconComponent::BatteryIconComponent(Window* window) : ImageComponent(window)
 {	
-	mBatteryInfoCheckTime = UPDATE_NETWORK_DELAY;
+	mStatusVersion = -1;
 
 	mIncharge = ResourceManager::getInstance()->getResourcePath(":/battery/incharge.svg");
 	mFull = ResourceManager::getInstance()->getResourcePath(":/battery/full.svg");
@@ -14,45 +12,42 @@ BatteryIconComponent::BatteryIconComponent(Window* window) : ImageComponent(wind
 	mAt25 = ResourceManager::getInstance()->getResourcePath(":/battery/25.svg");
 	mEmpty = ResourceManager::getInstance()->getResourcePath(":/battery/empty.svg");
 
-	mBatteryInfo = Utils::Platform::BatteryInformation();
 	//setVisible(Settings::getInstance()->getBool("ShowNetworkIndicator") && !Utils::Platform::queryIPAdress().empty());
+	setUpdateAlways(true);
 }
 
 void BatteryIconComponent::update(int deltaTime)
 {
 	ImageComponent::update(deltaTime);
 
-	mBatteryInfoCheckTime += deltaTime;
-	if (mBatteryInfoCheckTime >= UPDATE_NETWORK_DELAY)
-	{		
-		if (Settings::getInstance()->getString("ShowBattery").empty())
-			mBatteryInfo.hasBattery = false;
-		else 
-			mBatteryInfo = Utils::Platform::queryBatteryInformation();
+	if (mStatusVersion != StatusIndicators::getVersion())
+	{
+		mStatusVersion = StatusIndicators::getVersion();
+
+		// Empty when ShowBattery is off
+		Utils::Platform::BatteryInformation batteryInfo = StatusIndicators::get()->battery;
 
-		setVisible(mBatteryInfo.hasBattery); // Settings::getInstance()->getBool("ShowNetworkIndicator") && !Utils::Platform::queryIPAdress().empty());
+		setVisible(batteryInfo.hasBattery); // Settings::getInstance()->getBool("ShowNetworkIndicator") && !Utils::Platform::queryIPAdress().empty());
 
-		if (mBatteryInfo.hasBattery)
+		if (batteryInfo.hasBattery)
 		{
 			std::string txName = mIncharge;
 
-			if (mBatteryInfo.isCharging && !mIncharge.empty())
+			if (batteryInfo.isCharging && !mIncharge.empty())
 				txName = mIncharge;
-			else if (mBatteryInfo.level > 75 && !mFull.empty())
+			else if (batteryInfo.level > 75 && !mFull.empty())
 				txName = mFull;
-			else if (mBatteryInfo.level > 50 && !mAt75.empty())
+			else if (batteryInfo.level > 50 && !mAt75.empty())
 				txName = mAt75;
-			else if (mBatteryInfo.level > 25 && !mAt50.empty())
+			else if (batteryInfo.level > 25 && !mAt50.empty())
 				txName = mAt50;
-			else if (mBatteryInfo.level > 5 && !mAt25.empty())
+			else if (batteryInfo.level > 5 && !mAt25.empty())
 				txName = mAt25;
 			else
 				txName = mEmpty;
 
 			setImage(txName);
 		}
-
-		mBatteryInfoCheckTime = 0;
 	}
 }
 
@@ -81,5 +76,7 @@ void BatteryIconComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, c
 
 	if (elem->has("empty") && ResourceManager::getInstance()->fileExists(elem->get<std::string>("empty")))
 		mEmpty = elem->get<std::string>("empty");
+
+	mStatusVersion = -1;
 }
 
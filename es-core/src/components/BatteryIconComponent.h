@@ -20,8 +20,7 @@ public:
 	void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
 private:
-	int mBatteryInfoCheckTime;
-	Utils::Platform::BatteryInformation mBatteryInfo;
+	int mStatusVersion;
 
 	std::string mIncharge;
 	std::string mFull;
@@ -1,30 +1,30 @@
 #include "components/BatteryTextComponent.h"
-#include "Settings.h"
+#include "StatusIndicators.h"
 #include <time.h>
 
-#define UPDATE_NETWORK_DELAY	2000
-
 BatteryTextComponent::BatteryTextComponent(Window* window) : TextComponent(window)
 {	
-	mBatteryInfoCheckTime = UPDATE_NETWORK_DELAY;
-	mBatteryInfo = Utils::Platform::BatteryInformation();
+	mStatusVersion = -1;
+	setUpdateAlways(true);
 }
 
 void BatteryTextComponent::update(int deltaTime)
 {
 	TextComponent::update(deltaTime);
 	
-	mBatteryInfoCheckTime += deltaTime;
-	if (mBatteryInfoCheckTime >= UPDATE_NETWORK_DELAY)
+	if (mStatusVersion != StatusIndicators::getVersion())
 	{
-		if (Settings::getInstance()->getString("ShowBattery") != "text")
-			mBatteryInfo.hasBattery = false;
-		else 
-			mBatteryInfo = Utils::Platform::queryBatteryInformation();
+		mStatusVersion = StatusIndicators::getVersion();
+
+		auto status = StatusIndicators::get();
 
-		setVisible(mBatteryInfo.hasBattery && mBatteryInfo.level >= 0);
+		Utils::Platform::BatteryInformation batteryInfo;
+		if (status->showBattery == "text")
+			batteryInfo = status->battery;
 
-		auto batteryText = std::to_string(mBatteryInfo.level) + "%";
+		setVisible(batteryInfo.hasBattery && batteryInfo.level >= 0);
+
+		auto batteryText = std::to_string(batteryInfo.level) + "%";
 
 		float sx = mSize.x();
 
@@ -38,7 +38,5 @@ void BatteryTextComponent::update(int deltaTime)
 			mSize.x() = sx;
 			setSize(sz);
 		}
-
-		mBatteryInfoCheckTime = 0;
 	}
 }
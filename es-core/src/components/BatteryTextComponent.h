@@ -19,8 +19,7 @@ public:
 	virtual void update(int deltaTime);
 
 private:
-	int mBatteryInfoCheckTime;
-	Utils::Platform::BatteryInformation mBatteryInfo;
+	int mStatusVersion;
 };
 
 #endif // ES_CORE_COMPONENTS_BATTTEXT_COMPONENT_H
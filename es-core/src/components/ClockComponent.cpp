@@ -5,6 +5,7 @@
 ClockComponent::ClockComponent(Window* window) : TextComponent(window)
 {	
 	mClockElapsed = 0;
+	setUpdateAlways(true);
 }
 
 void ClockComponent::update(int deltaTime)
@@ -7,7 +7,7 @@
 using namespace GridFlags;
 
 ComponentGrid::ComponentGrid(Window* window, const Vector2i& gridDimensions) : GuiComponent(window), 
-	mGridSize(gridDimensions), mCursor(0, 0)
+	mGridSize(gridDimensions), mCursor(0, 0), mLayoutSize(0, 0), mLayoutDirty(true), mSeparatorsDirty(false)
 {
 	assert(gridDimensions.x() > 0 && gridDimensions.y() > 0);
 
@@ -30,50 +30,63 @@ ComponentGrid::~ComponentGrid()
 		delete ptr;	
 }
 
-float ComponentGrid::getColWidth(int col)
+void ComponentGrid::computeSizes(const std::vector<GridSizeInfo*>& infos, float total, std::vector<float>& sizes, std::vector<float>& offsets)
 {
-	if (col < 0 || col >= mColWidths.size())
-		return 0;
+	// The free space is shared by the automatic columns / rows
+	float freeSize = total;
 
-	if (mColWidths[col]->value != 0 || mColWidths[col]->absolute)
-		return mColWidths[col]->compute(mSize.x());
+	int autoSize = 0;
+	for (auto info : infos)
+	{
+		if (info->value == 0 && !info->absolute)
+			autoSize++;
+		else
+			freeSize -= info->compute(total);
+	}
 
-	// calculate automatic width
-	float freeWidth = mSize.x();
+	sizes.resize(infos.size());
+	offsets.resize(infos.size() + 1);
+	offsets[0] = 0;
 
-	int autoSizeCols = 0;
-	for (int x = 0; x < mGridSize.x(); x++)
+	for (int i = 0; i < (int)infos.size(); i++)
 	{
-		if (mColWidths[x]->value == 0 && !mColWidths[x]->absolute)
-			autoSizeCols++;
+		if (infos[i]->value != 0 || infos[i]->absolute)
+			sizes[i] = infos[i]->compute(total);
 		else
-			freeWidth -= mColWidths[x]->compute(mSize.x());
+			sizes[i] = freeSize / (float)std::max(1, autoSize);
+
+		offsets[i + 1] = offsets[i] + sizes[i];
 	}
+}
+
+void ComponentGrid::updateLayout()
+{
+	if (!mLayoutDirty && mLayoutSize == mSize)
+		return;
+
+	computeSizes(mColWidths, mSize.x(), mColSizes, mColOffsets);
+	computeSizes(mRowHeights, mSize.y(), mRowSizes, mRowOffsets);
 
-	return freeWidth / (float)std::max(1, autoSizeCols);
+	mLayoutSize = mSize;
+	mLayoutDirty = false;
 }
 
-float ComponentGrid::getRowHeight(int row)
+float ComponentGrid::getColWidth(int col)
 {
-	if (row < 0 || row >= mRowHeights.size())
+	if (col < 0 || col >= mColWidths.size())
 		return 0;
 
-	if (mRowHeights[row]->value != 0 || mRowHeights[row]->absolute)
-		return mRowHeights[row]->compute(mSize.y());
-
-	// calculate automatic height
-	float freeHeight = mSize.y();
+	updateLayout();
+	return mColSizes[col];
+}
 
-	int autoSizeRows = 0;
-	for (int y = 0; y < mGridSize.y(); y++)
-	{
-		if (mRowHeights[y]->value == 0 && !mRowHeights[y]->absolute)
-			autoSizeRows++;
-		else
-			freeHeight -= mRowHeights[y]->compute(mSize.y());
-	}
+float ComponentGrid::getRowHeight(int row)
+{
+	if (row < 0 || row >= mRowHeights.size())
+		return 0;
 
-	return freeHeight / (float) std::max(1, autoSizeRows);
+	updateLayout();
+	return mRowSizes[row];
 }
 
 void ComponentGrid::setColWidthPerc(int col, float width, bool update)
@@ -83,6 +96,7 @@ void ComponentGrid::setColWidthPerc(int col, float width, bool update)
 
 	mColWidths[col]->value = width;
 	mColWidths[col]->absolute = false;
+	mLayoutDirty = true;
 
 	if (update)
 		onSizeChanged();
@@ -95,6 +109,7 @@ void ComponentGrid::setRowHeightPerc(int row, float height, bool update)
 
 	mRowHeights[row]->value = height;
 	mRowHeights[row]->absolute = false;
+	mLayoutDirty = true;
 
 	if (update)
 		onSizeChanged();
@@ -107,6 +122,7 @@ void ComponentGrid::setColWidth(int col, float width, bool update)
 
 	mColWidths[col]->value = width;
 	mColWidths[col]->absolute = true;
+	mLayoutDirty = true;
 
 	if (update)
 		onSizeChanged();
@@ -119,6 +135,7 @@ void ComponentGrid::setRowHeight(int row, float height, bool update)
 
 	mRowHeights[row]->value = height;
 	mRowHeights[row]->absolute = true;
+	mLayoutDirty = true;
 
 	if (update)
 		onSizeChanged();
@@ -143,8 +160,8 @@ void ComponentGrid::setEntry(const std::shared_ptr<GuiComponent>& comp, const Ve
 		onCursorMoved(origCursor, mCursor);
 	}
 
-	updateCellComponent(mCells.back());
-	updateSeparators();
+	updateCellComponent(mCells.back(), true);
+	mSeparatorsDirty = true;
 }
 
 bool ComponentGrid::removeEntry(const std::shared_ptr<GuiComponent>& comp)
@@ -155,6 +172,7 @@ bool ComponentGrid::removeEntry(const std::shared_ptr<GuiComponent>& comp)
 		{
 			removeChild(comp.get());
 			mCells.erase(it);
+			mSeparatorsDirty = true;
 			return true;
 		}
 	}
@@ -162,36 +180,53 @@ bool ComponentGrid::removeEntry(const std::shared_ptr<GuiComponent>& comp)
 	return false;
 }
 
-void ComponentGrid::updateCellComponent(const GridEntry& cell)
+void ComponentGrid::getCellRect(const GridEntry& cell, Vector2f& pos, Vector2f& size)
 {
-	// size
-	Vector2f size(0, 0);
-	for(int x = cell.pos.x(); x < cell.pos.x() + cell.dim.x(); x++)
-		size[0] += getColWidth(x);
-	for(int y = cell.pos.y(); y < cell.pos.y() + cell.dim.y(); y++)
-		size[1] += getRowHeight(y);
+	updateLayout();
+
+	pos = Vector2f(mColOffsets[cell.pos.x()], mRowOffsets[cell.pos.y()]);
+
+	size = Vector2f(0, 0);
+	for(int x = cell.pos.x(); x < cell.pos.x() + cell.dim.x() && x < mGridSize.x(); x++)
+		size[0] += mColSizes[x];
+	for(int y = cell.pos.y(); y < cell.pos.y() + cell.dim.y() && y < mGridSize.y(); y++)
+		size[1] += mRowSizes[y];
+}
+
+bool ComponentGrid::updateCellComponent(GridEntry& cell, bool force)
+{
+	Vector2f cellPos;
+	Vector2f size;
+	getCellRect(cell, cellPos, size);
 
+	// Same rows & columns, and nobody touched the component since
+	if (!force && cell.laidOut && cell.cellPos == cellPos && cell.cellSize == size &&
+		cell.component->getSize() == cell.componentSize && cell.component->getPosition() == cell.componentPos)
+		return false;
+
+	// size
 	if(cell.resize)
 		cell.component->setSize(size);
 
-	// position
-	// find top left corner
+	// position : center component in the cell
 	Vector3f pos(0, 0, 0);
-	for(int x = 0; x < cell.pos.x(); x++)
-		pos[0] += getColWidth(x);
-	for(int y = 0; y < cell.pos.y(); y++)
-		pos[1] += getRowHeight(y);
-
-	// center component
-	pos[0] = pos.x() + (size.x() - cell.component->getSize().x()) / 2;
-	pos[1] = pos.y() + (size.y() - cell.component->getSize().y()) / 2;
+	pos[0] = cellPos.x() + (size.x() - cell.component->getSize().x()) / 2;
+	pos[1] = cellPos.y() + (size.y() - cell.component->getSize().y()) / 2;
 	
 	cell.component->setPosition(pos);
+
+	cell.laidOut = true;
+	cell.cellPos = cellPos;
+	cell.cellSize = size;
+	cell.componentSize = cell.component->getSize();
+	cell.componentPos = cell.component->getPosition();
+	return true;
 }
 
 void ComponentGrid::updateSeparators()
 {
 	mLines.clear();
+	mSeparatorsDirty = false;
 
 	unsigned int color = Renderer::convertColor(mSeparatorColor);
 
@@ -207,16 +242,7 @@ void ComponentGrid::updateSeparators()
 			continue;
 
 		// find component position + size
-		pos = Vector2f(0, 0);
-		size = Vector2f(0, 0);
-		for(int x = 0; x < it->pos.x(); x++)
-			pos[0] += getColWidth(x);
-		for(int y = 0; y < it->pos.y(); y++)
-			pos[1] += getRowHeight(y);
-		for(int x = it->pos.x(); x < it->pos.x() + it->dim.x(); x++)
-			size[0] += getColWidth(x);
-		for(int y = it->pos.y(); y < it->pos.y() + it->dim.y(); y++)
-			size[1] += getRowHeight(y);
+		getCellRect(*it, pos, size);
 
 		if(it->border & BORDER_TOP || drawAll)
 		{
@@ -245,10 +271,13 @@ void ComponentGrid::onSizeChanged()
 {
 	GuiComponent::onSizeChanged();
 
-	for(auto it = mCells.cbegin(); it != mCells.cend(); it++)
-		updateCellComponent(*it);
+	// Only the cells whose rows or columns changed are laid out again
+	bool changed = false;
+	for(auto it = mCells.begin(); it != mCells.end(); it++)
+		changed |= updateCellComponent(*it);
 
-	updateSeparators();
+	if (changed)
+		mSeparatorsDirty = true;
 }
 
 const ComponentGrid::GridEntry* ComponentGrid::getCellAt(int x, int y) const
@@ -390,6 +419,9 @@ void ComponentGrid::update(int deltaTime)
 	const GridEntry* cursorEntry = getCellAt(mCursor);
 	for(auto it = mCells.cbegin(); it != mCells.cend(); it++)
 	{
+		if (!it->component->hasUpdateActivity())
+			continue;
+
 		if(it->updateType == UPDATE_ALWAYS || (it->updateType == UPDATE_WHEN_SELECTED && cursorEntry == &(*it)))
 			it->component->update(deltaTime);
 	}
@@ -406,6 +438,9 @@ void ComponentGrid::render(const Transform4x4f& parentTrans)
 	renderChildren(trans);
 	
 	// draw cell separators
+	if (mSeparatorsDirty)
+		updateSeparators();
+
 	if(mLines.size())
 	{
 		Renderer::setMatrix(trans);
@@ -74,7 +74,7 @@ public:
 
 	virtual std::vector<HelpPrompt> getHelpPrompts() override;
 
-	void setSeparatorColor(unsigned int separatorColor) { mSeparatorColor = separatorColor; updateSeparators(); }
+	void setSeparatorColor(unsigned int separatorColor) { mSeparatorColor = separatorColor; mSeparatorsDirty = true; }
 	inline void setUnhandledInputCallback(const std::function<bool(InputConfig* config, Input input)>& func) { mUnhandledInputCallback = func; }
 
 	Vector2i getGridSize() { return mGridSize; }
@@ -91,10 +91,17 @@ private:
 		GridFlags::UpdateType updateType;
 		unsigned int border;
 
+		// Last layout of the cell : it is done again only if its rows or columns moved, or if the component was changed meanwhile
+		bool laidOut;
+		Vector2f cellPos;
+		Vector2f cellSize;
+		Vector2f componentSize;
+		Vector3f componentPos;
+
 		GridEntry(const Vector2i& p = Vector2i::Zero(), const Vector2i& d = Vector2i::Zero(),
 			const std::shared_ptr<GuiComponent>& cmp = nullptr, bool f = false, bool r = true, 
 			GridFlags::UpdateType u = GridFlags::UPDATE_ALWAYS, unsigned int b = GridFlags::BORDER_NONE) : 
-			pos(p), dim(d), component(cmp), canFocus(f), resize(r), updateType(u), border(b)
+			pos(p), dim(d), component(cmp), canFocus(f), resize(r), updateType(u), border(b), laidOut(false)
 		{};
 
 		operator bool() const
@@ -121,13 +128,26 @@ private:
 	std::vector<GridSizeInfo*> mRowHeights;
 	std::vector<GridSizeInfo*> mColWidths;
 	
+	// Computed sizes & offsets of the columns and rows, for mLayoutSize
+	std::vector<float> mColSizes;
+	std::vector<float> mColOffsets;
+	std::vector<float> mRowSizes;
+	std::vector<float> mRowOffsets;
+	Vector2f mLayoutSize;
+	bool mLayoutDirty;
+
 	std::vector<Renderer::Vertex> mLines;
+	bool mSeparatorsDirty;
 
 	unsigned int mSeparatorColor;
 
-	// Update position & size
-	void updateCellComponent(const GridEntry& cell);
+	void updateLayout();
+	static void computeSizes(const std::vector<GridSizeInfo*>& infos, float total, std::vector<float>& sizes, std::vector<float>& offsets);
+
+	// Update position & size. Returns false if the cell was already laid out this way
+	bool updateCellComponent(GridEntry& cell, bool force = false);
 	void updateSeparators();
+	void getCellRect(const GridEntry& cell, Vector2f& pos, Vector2f& size);
 
 	const GridEntry* getCellAt(int x, int y) const;
 	inline const GridEntry* getCellAt(const Vector2i& pos) const { return getCellAt(pos.x(), pos.y()); }
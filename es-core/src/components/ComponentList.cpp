@@ -8,6 +8,8 @@
 #include "components/OptionListComponent.h"
 #include "InputManager.h"
 
+#include <algorithm>
+
 #define TOTAL_HORIZONTAL_PADDING_PX 20
 
 ComponentList::ComponentList(Window* window) : IList<ComponentListRow, std::string>(window, LIST_SCROLL_STYLE_SLOW, LIST_NEVER_LOOP), mScrollbar(window)
@@ -99,7 +101,11 @@ void ComponentList::addGroup(const std::string& label, bool forceVisible)
 void ComponentList::onSizeChanged()
 {
 	IList::onSizeChanged();
+	updateLayout();
+}
 
+void ComponentList::updateLayout()
+{
 	float yOffset = 0;
 	for(auto it = mEntries.cbegin(); it != mEntries.cend(); it++)
 	{
@@ -111,6 +117,76 @@ void ComponentList::onSizeChanged()
 	updateCameraOffset();
 }
 
+bool ComponentList::buildDeferredRow(int index)
+{
+	if (index < 0 || index >= (int)mEntries.size() || mEntries[index].data.deferred == nullptr)
+		return false;
+
+	// Cleared first, and built on a copy : the new elements can add rows
+	auto build = mEntries[index].data.deferred;
+	mEntries[index].data.deferred = nullptr;
+
+	ComponentListRow built = mEntries[index].data;
+	float height = getRowHeight(built);
+
+	build(built);
+
+	ComponentListRow& row = mEntries[index].data;
+
+	for (auto& elt : row.elements)
+		if (std::find_if(built.elements.cbegin(), built.elements.cend(), [&elt](const ComponentListElement& e) { return e.component == elt.component; }) == built.elements.cend())
+			removeChild(elt.component.get());
+
+	for (auto& elt : built.elements)
+	{
+		if (std::find_if(row.elements.cbegin(), row.elements.cend(), [&elt](const ComponentListElement& e) { return e.component == elt.component; }) != row.elements.cend())
+			continue;
+
+		addChild(elt.component.get());
+
+		if (mFocused && index == mCursor)
+			elt.component->onFocusGained();
+	}
+
+	row = built;
+
+	if (getRowHeight(row) != height)
+	{
+		updateLayout();
+
+		mSelectorBarOffset = 0;
+		for (int i = 0; i < mCursor; i++)
+			mSelectorBarOffset += getRowHeight(mEntries.at(i).data);
+	}
+	else
+	{
+		updateElementSize(row);
+		updateElementPosition(row);
+	}
+
+	return true;
+}
+
+void ComponentList::buildDeferredRows()
+{
+	// One screen ahead, so that paging doesn't show the rows unfinished
+	float y = 0;
+	float end = mCameraOffset + mSize.y() * 2;
+
+	for (int i = 0; i < (int)mEntries.size() && y < end; i++)
+	{
+		float rowHeight = getRowHeight(mEntries[i].data);
+
+		if (y + rowHeight >= mCameraOffset && mEntries[i].data.deferred != nullptr)
+		{
+			buildDeferredRow(i);
+			rowHeight = getRowHeight(mEntries[i].data);
+		}
+
+		y += rowHeight;
+	}
+}
+
 void ComponentList::onFocusLost()
 {
 	mFocused = false;
@@ -143,6 +219,8 @@ bool ComponentList::input(InputConfig* config, Input input)
 	if(size() == 0)
 		return false;
 
+	buildDeferredRow(mCursor);
+
 	// give it to the current row's input handler
 	if(mEntries.at(mCursor).data.input_handler)
 	{
@@ -189,6 +267,7 @@ void ComponentList::update(int deltaTime)
 	mScrollbar.update(deltaTime);
 
 	listUpdate(deltaTime);
+	buildDeferredRows();
 
 	if(size())
 	{
@@ -196,7 +275,8 @@ void ComponentList::update(int deltaTime)
 		{
 			for (auto& entry : mEntries)
 				for (auto it = entry.data.elements.cbegin(); it != entry.data.elements.cend(); it++)
-					it->component->update(deltaTime);
+					if (it->component->hasUpdateActivity())
+						it->component->update(deltaTime);
 		}
 		else if (mUpdateType == ComponentListFlags::UpdateType::UPDATE_WHEN_SELECTED)
 		{
@@ -211,6 +291,9 @@ void ComponentList::onCursorChanged(const CursorState& state)
 {
 	mScrollbar.onCursorChanged();
 
+	if (mCursor >= 0 && mCursor < size())
+		buildDeferredRow(mCursor);
+
 	// update the selector bar position
 	// in the future this might be animated
 	mSelectorBarOffset = 0;
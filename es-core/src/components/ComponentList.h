@@ -43,6 +43,10 @@ struct ComponentListRow
 	// If no input handler is supplied (input_handler == nullptr), the default behavior is to forward the input to 
 	// the rightmost element in the currently selected row.
 	std::function<bool(InputConfig*, Input)> input_handler;
+
+	// Deferred row : completed once it is scrolled into view or selected, for the menu items with expensive values and the very long lists.
+	// It can add elements, replace them ( a placeholder giving the row its height ), or set the input handler
+	std::function<void(ComponentListRow& row)> deferred;
 	
 	inline void addElement(const std::shared_ptr<GuiComponent>& component, bool resize_width)
 	{
@@ -130,6 +134,12 @@ private:
 	int mOldCursor;
 
 	void updateCameraOffset();
+	void updateLayout();
+
+	// Completes the deferred rows around the visible ones, or the given row
+	void buildDeferredRows();
+	bool buildDeferredRow(int index);
+
 	void updateElementPosition(const ComponentListRow& row, float yOffset = -1.0);
 	void updateElementSize(const ComponentListRow& row);
 	
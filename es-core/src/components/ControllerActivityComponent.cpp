@@ -5,14 +5,11 @@
 #include "ThemeData.h"
 #include "InputManager.h"
 #include "Settings.h"
-#include "utils/Platform.h"
-#include "IExternalActivity.h"
+#include "StatusIndicators.h"
 
 // #define DEVTEST
 
 #define PLAYER_PAD_TIME_MS		 150
-#define UPDATE_NETWORK_DELAY	2000
-#define UPDATE_BATTERY_DELAY	5000
 
 ControllerActivityComponent::ControllerActivityComponent(Window* window) : GuiComponent(window)
 {
@@ -28,9 +25,7 @@ void ControllerActivityComponent::init()
 	mView = CONTROLLERS;
 	
 	mBatteryInfo = Utils::Platform::BatteryInformation();
-	mBatteryCheckTime = UPDATE_BATTERY_DELAY;
-
-	mNetworkCheckTime = UPDATE_NETWORK_DELAY;
+	mStatusVersion = StatusIndicators::getVersion();
 
 	mColorShift = 0xFFFFFF99;
 	mActivityColor = 0xFF000066;
@@ -126,24 +121,15 @@ void ControllerActivityComponent::update(int deltaTime)
 {
 	GuiComponent::update(deltaTime);
 
-	if (mView & BATTERY)
+	if ((mView & (BATTERY | NETWORK)) && mStatusVersion != StatusIndicators::getVersion())
 	{
-		mBatteryCheckTime += deltaTime;
-		if (mBatteryCheckTime >= UPDATE_BATTERY_DELAY)
-		{
+		mStatusVersion = StatusIndicators::getVersion();
+
+		if (mView & BATTERY)
 			updateBatteryInfo();
-			mBatteryCheckTime = 0;
-		}
-	}
-	
-	if (mView & NETWORK)
-	{
-		mNetworkCheckTime += deltaTime;
-		if (mNetworkCheckTime >= UPDATE_NETWORK_DELAY)
-		{
+
+		if (mView & NETWORK)
 			updateNetworkInfo();
-			mNetworkCheckTime = 0;			
-		}
 	}
 
 	if (mView & CONTROLLERS)
@@ -465,12 +451,14 @@ void ControllerActivityComponent::applyTheme(const std::shared_ptr<ThemeData>& t
 	// Force update battery images
 	mBatteryInfo.level = -2;
 	updateBatteryInfo();
+	updateNetworkInfo();
 }
 
 void ControllerActivityComponent::updateNetworkInfo()
 {
-	mNetworkConnected = Settings::ShowNetworkIndicator() && !Utils::Platform::queryIPAdress().empty();	
-	mPlanemodeEnabled = Settings::ShowNetworkIndicator() && IExternalActivity::Instance != nullptr && IExternalActivity::Instance->isPlaneMode();	
+	auto status = StatusIndicators::get();
+	mNetworkConnected = status->networkConnected;
+	mPlanemodeEnabled = status->planeMode;
 }
 
 void ControllerActivityComponent::updateBatteryInfo()
@@ -481,7 +469,7 @@ void ControllerActivityComponent::updateBatteryInfo()
 		return;
 	}
 
-	auto info = Utils::Platform::queryBatteryInformation();
+	auto info = StatusIndicators::get()->battery;
 
 	if (info.hasBattery == mBatteryInfo.hasBattery && info.isCharging == mBatteryInfo.isCharging && info.level == mBatteryInfo.level)
 		return;
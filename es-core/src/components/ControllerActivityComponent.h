@@ -97,18 +97,18 @@ protected:
 
 	PlayerPad mPads[MAX_PLAYERS];
 
+	int mStatusVersion; // StatusIndicators version of the battery & network info
+
 protected:
 	// Network info
 	void updateNetworkInfo();
 	std::shared_ptr<TextureResource> mNetworkImage;
 	bool mNetworkConnected;
-	int mNetworkCheckTime;
     	std::shared_ptr<TextureResource> mPlanemodeImage;
   	bool mPlanemodeEnabled;
 
 protected:
 	// Battery info
-	int mBatteryCheckTime;
 	int mBatteryTextX;
 
 	Utils::Platform::BatteryInformation mBatteryInfo;
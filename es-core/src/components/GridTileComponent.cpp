@@ -15,6 +15,7 @@
 #include "utils/FileSystemUtil.h"
 
 #include "Settings.h"
+#include "MemoryProfile.h"
 #include "ImageGridComponent.h"
 
 #define VIDEODELAY	100
@@ -334,15 +335,43 @@ bool GridTileComponent::isMinSizeTile()
 }
 
 void GridTileComponent::renderContent(const Transform4x4f& parentTrans, bool renderBackground)
+{
+	renderLayers(parentTrans, (renderBackground ? LAYER_BACKGROUND : 0) | LAYER_IMAGE | LAYER_OVERLAYS);
+}
+
+void GridTileComponent::pushMinSizeClipRect(const Transform4x4f& trans, GridTileProperties& currentProperties)
+{
+	float padding = currentProperties.Padding.x();
+	float topPadding = currentProperties.Padding.y();
+	float bottomPadding = topPadding;
+
+	if (currentProperties.Label.Visible && !mLabelMerged)
+		bottomPadding = std::max((int)topPadding, (int)(mSize.y() * currentProperties.Label.size.y()));
+
+	Transform4x4f tx = trans;
+	tx.translate(padding, topPadding);
+
+	int x = (int)Math::round(tx.translation()[0]);
+	int y = (int)Math::round(tx.translation()[1]);
+	int w = (int)Math::round((mSize.x() - 2 * padding) * tx.r0().x());
+	int h = (int)Math::round((mSize.y() - topPadding - bottomPadding) * tx.r1().y());
+		
+	Renderer::pushClipRect(x, y, w, h);
+}
+
+void GridTileComponent::renderLayers(const Transform4x4f& parentTrans, int layers)
 {
 	if (!mVisible)
 		return;
 
 	Transform4x4f trans = parentTrans * getTransform();
 
-	if (renderBackground)
+	if (layers & LAYER_BACKGROUND)
 		mBackground.render(trans);
 
+	if ((layers & (LAYER_IMAGE | LAYER_OVERLAYS)) == 0)
+		return;
+
 	auto rect = Renderer::getScreenRect(trans, mSize);
 	if (!Renderer::isVisibleOnScreen(rect))
 		return;
@@ -350,37 +379,32 @@ void GridTileComponent::renderContent(const Transform4x4f& parentTrans, bool ren
 	auto& currentProperties = getCurrentProperties(false);
 
 	bool isMinSize = !mIsDefaultImage && currentProperties.Image.sizeMode == "minSize";
-	if (isMinSize)
-	{
-		float padding = currentProperties.Padding.x();
-		float topPadding = currentProperties.Padding.y();
-		float bottomPadding = topPadding;
 
-		if (currentProperties.Label.Visible && !mLabelMerged)
-			bottomPadding = std::max((int)topPadding, (int)(mSize.y() * currentProperties.Label.size.y()));
+	if (layers & LAYER_IMAGE)
+	{
+		if (isMinSize)
+			pushMinSizeClipRect(trans, currentProperties);
 
-		Transform4x4f tx = trans;
-		tx.translate(padding, topPadding);
+		if (mImage != NULL)
+		{
+			if (!isMinSize || !mSelected || mVideo == nullptr || !(mVideo->isPlaying() && !mVideo->isFading()))
+				mImage->render(trans);
+		}
 
-		int x = (int)Math::round(tx.translation()[0]);
-		int y = (int)Math::round(tx.translation()[1]);
-		int w = (int)Math::round((mSize.x() - 2 * padding) * tx.r0().x());
-		int h = (int)Math::round((mSize.y() - topPadding - bottomPadding) * tx.r1().y());
-		
-		Renderer::pushClipRect(x, y, w, h);
-	}
+		if (mSelected && !mVideoPath.empty() && mVideo != nullptr)
+			mVideo->render(trans);
 
-	if (mImage != NULL)
-	{
-		if (!isMinSize || !mSelected || mVideo == nullptr || !(mVideo->isPlaying() && !mVideo->isFading()))
-			mImage->render(trans);
+		if (isMinSize && (!mLabelMerged || (layers & LAYER_OVERLAYS) == 0))
+			Renderer::popClipRect();
 	}
 
-	if (mSelected && !mVideoPath.empty() && mVideo != nullptr)
-		mVideo->render(trans);
+	if ((layers & LAYER_OVERLAYS) == 0)
+		return;
 
-	if (!mLabelMerged && isMinSize)
-		Renderer::popClipRect();
+	// A merged label is clipped with the minSize image
+	bool clipOverlays = isMinSize && mLabelMerged;
+	if (clipOverlays && (layers & LAYER_IMAGE) == 0)
+		pushMinSizeClipRect(trans, currentProperties);
 
 	std::vector<GuiComponent*> zOrdered;
 
@@ -404,7 +428,7 @@ void GridTileComponent::renderContent(const Transform4x4f& parentTrans, bool ren
 	for (auto comp : zOrdered)
 		comp->render(trans);
 
-	if (mLabelMerged && isMinSize)
+	if (clipOverlays)
 		Renderer::popClipRect();
 }
 
@@ -692,7 +716,7 @@ void GridTileComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, cons
 	resetProperties();
 
 	const ThemeData::ThemeElement* grid = theme->getElement(view, "gamegrid", "imagegrid");
-	if (grid && grid->has("showVideoAtDelay"))
+	if (grid && grid->has("showVideoAtDelay") && !MemoryProfile::isLowMemory())
 	{
 		createVideo();
 
@@ -955,6 +979,14 @@ void GridTileComponent::setMarquee(const std::string& path)
 	resize();
 }
 
+void GridTileComponent::setLoadPriority(int priority)
+{
+	mImage->setLoadPriority(priority);
+
+	if (mMarquee != nullptr)
+		mMarquee->setLoadPriority(priority);
+}
+
 void GridTileComponent::setCheevos(bool cheevos)
 {
 	if (mCheevos == nullptr)
@@ -981,6 +1013,19 @@ void GridTileComponent::resetImages()
 	stopVideo();
 }
 
+void GridTileComponent::recycle()
+{
+	setSelected(false, false, nullptr, true);
+
+	resetImages();
+	forceMarquee("");
+	setVideo("");
+	setFavorite(false);
+	setCheevos(false);
+	setIsDefaultImage(false);
+	setVisible(true);
+}
+
 void GridTileComponent::setLabel(std::string name)
 {
 	if (mLabel.getText() == name)
@@ -212,11 +212,15 @@ public:
 
 	void resetImages();
 
+	// Unbinds the tile so that the grid can reuse it for another entry, keeping the theme
+	void recycle();
+
 	void setLabel(std::string name);
 	void setVideo(const std::string& path, float defaultDelay = -1.0);
 
 	void setImage(const std::string& path, bool isDefaultImage = false);
 	void setMarquee(const std::string& path);
+	void setLoadPriority(int priority);
 	
 	void setFavorite(bool favorite);
 	void setCheevos(bool favorite);
@@ -226,8 +230,17 @@ public:
 
 	void forceSize(Vector2f size, float selectedZoom = 1.0);
 
+	enum RenderLayer
+	{
+		LAYER_BACKGROUND = 1,
+		LAYER_IMAGE = 2,
+		LAYER_OVERLAYS = 4 // label, marquee, favorite, cheevos & overlay images
+	};
+
 	void renderBackground(const Transform4x4f& parentTrans);
 	void renderContent(const Transform4x4f& parentTrans, bool renderBackground = false);
+	// Renders a combination of RenderLayer only
+	void renderLayers(const Transform4x4f& parentTrans, int layers);
 
 	bool shouldSplitRendering() { return isAnimationPlaying(3); };
 
@@ -261,6 +274,7 @@ private:
 	void	stopVideo();
 
 	void resize();
+	void pushMinSizeClipRect(const Transform4x4f& trans, GridTileProperties& currentProperties);
 
 	static void applyThemeToProperties(const ThemeData::ThemeElement* elem, GridTileProperties& properties);
 
@@ -15,6 +15,8 @@
 // space between [text] and next [icon] (px)
 #define ENTRY_SPACING (ICON_TEXT_SPACING * 2.0f)
 
+#define GRID_CACHE_SIZE 8
+
 static const std::map<std::string, const char*> ICON_PATH_MAP{
 	{ "up/down", ":/help/dpad_updown.svg" },
 	{ "left/right", ":/help/dpad_leftright.svg" },
@@ -87,6 +89,21 @@ void HelpComponent::updateGrid()
 
 	bool is43screen = Renderer::getScreenProportion() < 1.4;
 
+	size_t key = getGridKey(maxWidth, is43screen);
+	for (auto it = mGridCache.begin(); it != mGridCache.end(); it++)
+	{
+		if (it->first != key)
+			continue;
+
+		mGrid = it->second;
+		mGridCache.splice(mGridCache.begin(), mGridCache, it);
+
+		for (auto i = 0; i < mGrid->getChildCount(); i++)
+			mGrid->getChild(i)->setOpacity(getOpacity());
+
+		return;
+	}
+
 	float width = 0;
 	const float height = Math::round(font->getLetterHeight() * 1.25f);
 	for (auto it = mPrompts.cbegin(); it != mPrompts.cend(); it++)
@@ -152,6 +169,50 @@ void HelpComponent::updateGrid()
 
 	mGrid->setPosition(Vector3f(mStyle.position.x(), mStyle.position.y(), 0.0f));
 	mGrid->setOrigin(mStyle.origin);
+
+	mGridCache.push_front(std::make_pair(key, mGrid));
+	if (mGridCache.size() > GRID_CACHE_SIZE)
+		mGridCache.pop_back();
+}
+
+static inline void hashCombine(size_t& seed, size_t value)
+{
+	seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+size_t HelpComponent::getGridKey(int maxWidth, bool is43screen)
+{
+	std::hash<std::string> hashString;
+	std::hash<float> hashFloat;
+
+	size_t key = std::hash<void*>()(mStyle.font.get());
+	hashCombine(key, (size_t)maxWidth);
+	hashCombine(key, is43screen ? 1 : 0);
+	hashCombine(key, hashFloat(mStyle.position.x()));
+	hashCombine(key, hashFloat(mStyle.position.y()));
+	hashCombine(key, hashFloat(mStyle.origin.x()));
+	hashCombine(key, hashFloat(mStyle.origin.y()));
+	hashCombine(key, mStyle.iconColor);
+	hashCombine(key, mStyle.textColor);
+	hashCombine(key, mStyle.glowColor);
+	hashCombine(key, mStyle.glowSize);
+	hashCombine(key, hashFloat(mStyle.glowOffset.x()));
+	hashCombine(key, hashFloat(mStyle.glowOffset.y()));
+
+	for (auto& icon : mStyle.iconMap)
+	{
+		hashCombine(key, hashString(icon.first));
+		hashCombine(key, hashString(icon.second));
+	}
+
+	// The labels depend on the controller type
+	for (auto& prompt : mPrompts)
+	{
+		hashCombine(key, hashString(InputConfig::buttonLabel(prompt.first)));
+		hashCombine(key, hashString(prompt.second));
+	}
+
+	return key;
 }
 
 std::shared_ptr<TextureResource> HelpComponent::getIconTexture(const char* name)
@@ -4,6 +4,7 @@
 
 #include "GuiComponent.h"
 #include "HelpStyle.h"
+#include <list>
 
 class ComponentGrid;
 class ImageComponent;
@@ -35,6 +36,10 @@ private:
 	std::shared_ptr<ComponentGrid> mGrid;
 	void updateGrid();
 
+	// Laid out bars, by hash of the prompts & style : the views sharing their prompts don't build them again
+	size_t getGridKey(int maxWidth, bool is43screen);
+	std::list<std::pair<size_t, std::shared_ptr<ComponentGrid>>> mGridCache;
+
 	std::vector<HelpPrompt> mPrompts;
 	HelpStyle mStyle;
 
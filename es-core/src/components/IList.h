@@ -8,6 +8,7 @@
 #include "PowerSaver.h"
 #include "ThemeData.h"
 #include "Settings.h"
+#include "Window.h"
 #include <vector>
 
 enum CursorState
@@ -50,6 +51,8 @@ const ScrollTier SLOW_SCROLL_TIERS[] = {
 };
 const ScrollTierList LIST_SCROLL_STYLE_SLOW = { 2, SLOW_SCROLL_TIERS };
 
+#define FAST_SCROLL_DELAY	120	// Scroll tiers moving at least one entry per FAST_SCROLL_DELAY ms are fast scrolling
+
 class ILongMouseClickEvent
 {
 public:
@@ -112,6 +115,12 @@ public:
 		return (mScrollVelocity != 0 && mScrollTier > 0);
 	}
 
+	// Whatever the ScrollLoadMedias setting
+	bool isFastScrolling() const
+	{
+		return mScrollVelocity != 0 && mScrollTier > 0 && mTierList.tiers[mScrollTier].scrollDelay <= FAST_SCROLL_DELAY;
+	}
+
 	int getScrollingVelocity() 
 	{
 		if (Settings::ScrollLoadMedias())
@@ -241,6 +250,35 @@ public:
 		return objects;
 	}
 
+	// The objects the cursor is heading to, nearest first : in the scroll direction, or the one of the last move when stopped.
+	// The faster the scroll, the further it looks
+	inline std::vector<UserData> getUpcomingObjects(int lastMove, int count)
+	{
+		std::vector<UserData> objects;
+
+		int sz = (int)mEntries.size();
+		if (sz < 2 || mCursor < 0 || mCursor >= sz)
+			return objects;
+
+		int direction = mScrollVelocity != 0 ? mScrollVelocity : lastMove;
+		direction = direction < 0 ? -1 : 1;
+
+		count = Math::min(count * (1 + mScrollTier), sz - 1);
+
+		for (int i = 1; i <= count; i++)
+		{
+			int index = mCursor + direction * i;
+			if (mLoopType == LIST_ALWAYS_LOOP)
+				index = (index % sz + sz) % sz;
+			else if (index < 0 || index >= sz)
+				break;
+
+			objects.push_back(mEntries.at(index).object);
+		}
+
+		return objects;
+	}
+
 protected:
 	void remove(typename std::vector<Entry>::const_iterator& it)
 	{
@@ -284,6 +322,7 @@ protected:
 		// update the title overlay opacity
 		const int dir = (mScrollTier >= mTierList.count - 1) ? 1 : -1; // fade in if scroll tier is >= 1, otherwise fade out
 		int op = mTitleOverlayOpacity + deltaTime*dir; // we just do a 1-to-1 time -> opacity, no scaling
+		unsigned char titleOverlayOpacity = mTitleOverlayOpacity;
 		if(op >= 255)
 			mTitleOverlayOpacity = 255;
 		else if(op <= 0)
@@ -291,9 +330,14 @@ protected:
 		else
 			mTitleOverlayOpacity = (unsigned char)op;
 
+		if (mTitleOverlayOpacity != titleOverlayOpacity)
+			invalidateRender();
+
 		if(mScrollVelocity == 0 || size() < 2)
 			return;
 
+		invalidateRender();
+
 		mScrollCursorAccumulator += deltaTime;
 		mScrollTierAccumulator += deltaTime;
 
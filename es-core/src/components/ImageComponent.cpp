@@ -1,12 +1,13 @@
 #include "components/ImageComponent.h"
 
+#include "resources/AnimationFrames.h"
 #include "resources/TextureResource.h"
 #include "Log.h"
 #include "Settings.h"
 #include "ThemeData.h"
+#include "Window.h"
 #include "LocaleES.h"
 #include "utils/FileSystemUtil.h"
-#include "playlists/AnimatedGifPlaylist.h"
 #include "playlists/M3uPlaylist.h"
 #include "utils/StringUtil.h"
 
@@ -41,7 +42,12 @@ ImageComponent::ImageComponent(Window* window, bool forceLoad, bool dynamic) : G
 	mRoundCorners = 0.0f;
 	
 	mPlaylistTimer = 0;
+	mAnimationFrame = -1;
+	mAnimationTimer = 0;
 	updateColors();
+
+	// Only animated images & playlists need ticks
+	setUpdateActive(false);
 }
 
 ImageComponent::~ImageComponent()
@@ -52,6 +58,8 @@ ImageComponent::~ImageComponent()
 
 void ImageComponent::resize()
 {
+	invalidateRender();
+
 	if (!mTexture)
 		return;
 
@@ -173,13 +181,9 @@ void ImageComponent::setImage(const std::string&  path, bool tile, MaxSizeInfo m
 			int totalFrames, frameTime;
 			if (ImageIO::getMultiBitmapInformation(canonicalPath, totalFrames, frameTime) && totalFrames > 0)
 			{
-				mPath = "";
-				mForceLoad = true; // Disable async for animated gifs
-
 				setAllowFading(false);
-				setPlaylist(std::make_shared<AnimatedGifPlaylist>(canonicalPath, totalFrames, frameTime));
-				if (!mPath.empty())
-					return;
+				setAnimationFrames(AnimationFrames::get(canonicalPath, totalFrames, frameTime, maxSize));
+				return;
 			}
 		}
 		else if (ext == ".m3u")
@@ -194,6 +198,9 @@ void ImageComponent::setImage(const std::string&  path, bool tile, MaxSizeInfo m
 
 	mPath = canonicalPath;
 
+	if (mAnimation != nullptr)
+		setAnimationFrames(nullptr);
+
 	if (mTexture != nullptr)
 		mTexture->setRequired(false);
 
@@ -238,6 +245,10 @@ void ImageComponent::setImage(const std::string&  path, bool tile, MaxSizeInfo m
 void ImageComponent::setImage(const char* path, size_t length, bool tile)
 {
 	mPath = "";
+
+	if (mAnimation != nullptr)
+		setAnimationFrames(nullptr);
+
 	if (mTexture != nullptr)
 		mTexture->setRequired(false);
 
@@ -254,6 +265,9 @@ void ImageComponent::setImage(const char* path, size_t length, bool tile)
 
 void ImageComponent::setImage(const std::shared_ptr<TextureResource>& texture)
 {
+	if (mAnimation != nullptr)
+		setAnimationFrames(nullptr);
+
 	if (mTexture != nullptr)
 		mTexture->setRequired(false);
 
@@ -265,6 +279,15 @@ void ImageComponent::setImage(const std::shared_ptr<TextureResource>& texture)
 	resize();
 }
 
+void ImageComponent::setLoadPriority(int priority)
+{
+	if (mLoadingTexture != nullptr)
+		mLoadingTexture->setLoadPriority(priority);
+
+	if (mTexture != nullptr)
+		mTexture->setLoadPriority(priority);
+}
+
 void ImageComponent::setResize(float width, float height)
 {
 	if (mSize.x() != 0 && mSize.y() != 0 && !mTargetIsMax && !mTargetIsMin && mTargetSize.x() == width && mTargetSize.y() == height)
@@ -421,6 +444,8 @@ void ImageComponent::updateVertices()
 	if(!mTexture)
 		return;
 
+	invalidateRender();
+
 	// we go through this mess to make sure everything is properly rounded
 	// if we just round vertices at the end, edge cases occur near sizes of 0.5
 	const Vector2f     topLeft     = { mSize * mTopLeftCrop };
@@ -464,6 +489,8 @@ void ImageComponent::updateVertices()
 
 void ImageComponent::updateColors()
 {
+	invalidateRender();
+
 	float opacity = (mOpacity * (mFading ? mFadeOpacity / 255.0 : 1.0)) / 255.0;
 
 	const unsigned int color = Renderer::convertColor(mColorShift & 0xFFFFFF00 | (unsigned char)((mColorShift & 0xFF) * opacity));
@@ -554,7 +581,9 @@ void ImageComponent::render(const Transform4x4f& parentTrans)
 		// The bind() function returns false if the texture is not currently loaded. A blank
 		// texture is bound in this case but we want to handle a fade so it doesn't just 'jump' in
 		// when it finally loads
-		if (!mTexture->bind())
+		// Small images may share an atlas page : the texture coordinates are remapped to their region, which custom shaders don't expect
+		Vector4f atlasRect(0, 0, 1, 1);
+		if (!(mCustomShader.path.empty() ? mTexture->bindAtlas(atlasRect) : mTexture->bind()))
 		{
 			fadeIn(false);
 			return;
@@ -580,14 +609,21 @@ void ImageComponent::render(const Transform4x4f& parentTrans)
 		mVertices->saturation = mSaturation;
 		mVertices->customShader = mCustomShader.path.empty() ? nullptr : &mCustomShader;
 
+		Renderer::Vertex vertices[4];
+		for (int i = 0; i < 4; i++)
+		{
+			vertices[i] = mVertices[i];
+			vertices[i].tex = Vector2f(atlasRect.x() + mVertices[i].tex.x() * atlasRect.z(), atlasRect.y() + mVertices[i].tex.y() * atlasRect.w());
+		}
+
 		if (mRoundCorners > 0 && mRoundCornerStencil.size() > 0)
 		{
 			Renderer::setStencil(mRoundCornerStencil.data(), mRoundCornerStencil.size());
-			Renderer::drawTriangleStrips(&mVertices[0], 4);
+			Renderer::drawTriangleStrips(&vertices[0], 4);
 			Renderer::disableStencil();
 		}
 		else
-			Renderer::drawTriangleStrips(&mVertices[0], 4);
+			Renderer::drawTriangleStrips(&vertices[0], 4);
 
 		if (mReflection.x() != 0 || mReflection.y() != 0)
 		{
@@ -609,23 +645,23 @@ void ImageComponent::render(const Transform4x4f& parentTrans)
 			Renderer::Vertex mirrorVertices[4];
 
 			mirrorVertices[0] = {
-				{ mVertices[0].pos.x(), mVertices[0].pos.y() + h },
-				{ mVertices[0].tex.x(), mVertices[1].tex.y() },
+				{ vertices[0].pos.x(), vertices[0].pos.y() + h },
+				{ vertices[0].tex.x(), vertices[1].tex.y() },
 				colorT };
 
 			mirrorVertices[1] = {
-				{ mVertices[1].pos.x(), mVertices[1].pos.y() + h },
-				{ mVertices[1].tex.x(), mVertices[0].tex.y() },
+				{ vertices[1].pos.x(), vertices[1].pos.y() + h },
+				{ vertices[1].tex.x(), vertices[0].tex.y() },
 				colorB };
 
 			mirrorVertices[2] = {
-				{ mVertices[2].pos.x(), mVertices[2].pos.y() + h },
-				{ mVertices[2].tex.x(), mVertices[3].tex.y() },
+				{ vertices[2].pos.x(), vertices[2].pos.y() + h },
+				{ vertices[2].tex.x(), vertices[3].tex.y() },
 				colorT };
 
 			mirrorVertices[3] = {
-				{ mVertices[3].pos.x(), mVertices[3].pos.y() + h },
-				{ mVertices[3].tex.x(), mVertices[2].tex.y() },
+				{ vertices[3].pos.x(), vertices[3].pos.y() + h },
+				{ vertices[3].tex.x(), vertices[2].tex.y() },
 				colorB };
 
 			Renderer::drawTriangleStrips(&mirrorVertices[0], 4);
@@ -695,120 +731,120 @@ void ImageComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const s
 	if (!elem)
 		return;
 
-	if (elem->has("linearSmooth"))
-		mLinear = elem->get<bool>("linearSmooth");
+	if (elem->has(ThemeProperties::LINEAR_SMOOTH))
+		mLinear = elem->get<bool>(ThemeProperties::LINEAR_SMOOTH);
 
 	Vector2f scale = getParent() ? getParent()->getSize() : Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 	
-	if (properties & POSITION && elem->has("pos"))
+	if (properties & POSITION && elem->has(ThemeProperties::POS))
 	{
-		Vector2f denormalized = elem->get<Vector2f>("pos") * scale;
+		Vector2f denormalized = elem->get<Vector2f>(ThemeProperties::POS) * scale;
 		setPosition(Vector3f(denormalized.x(), denormalized.y(), 0));
 	}
 
-	if (properties & POSITION && elem->has("x"))
+	if (properties & POSITION && elem->has(ThemeProperties::X))
 	{
-		float denormalized = elem->get<float>("x") * scale.x();
+		float denormalized = elem->get<float>(ThemeProperties::X) * scale.x();
 		setPosition(Vector3f(denormalized, mPosition.y(), 0));
 	}
 	
-	if (properties & POSITION && elem->has("y"))
+	if (properties & POSITION && elem->has(ThemeProperties::Y))
 	{
-		float denormalized = elem->get<float>("y") * scale.y();
+		float denormalized = elem->get<float>(ThemeProperties::Y) * scale.y();
 		setPosition(Vector3f(mPosition.x(), denormalized, 0));
 	}
 	
 	if (properties & ThemeFlags::SIZE)
 	{
-		if (elem->has("size"))
-			setResize(elem->get<Vector2f>("size") * scale);
-		else if (elem->has("maxSize"))
-			setMaxSize(elem->get<Vector2f>("maxSize") * scale);
-		else if (elem->has("minSize"))
-			setMinSize(elem->get<Vector2f>("minSize") * scale);
+		if (elem->has(ThemeProperties::SIZE))
+			setResize(elem->get<Vector2f>(ThemeProperties::SIZE) * scale);
+		else if (elem->has(ThemeProperties::MAX_SIZE))
+			setMaxSize(elem->get<Vector2f>(ThemeProperties::MAX_SIZE) * scale);
+		else if (elem->has(ThemeProperties::MIN_SIZE))
+			setMinSize(elem->get<Vector2f>(ThemeProperties::MIN_SIZE) * scale);
 	}
 
-	if (properties & SIZE && elem->has("w"))
+	if (properties & SIZE && elem->has(ThemeProperties::W))
 	{
-		mTargetSize = Vector2f(elem->get<float>("w") * scale.x(), mTargetSize.y());
+		mTargetSize = Vector2f(elem->get<float>(ThemeProperties::W) * scale.x(), mTargetSize.y());
 		resize();
 	}
 
-	if (properties & SIZE && elem->has("h"))
+	if (properties & SIZE && elem->has(ThemeProperties::H))
 	{
-		mTargetSize = Vector2f(mTargetSize.x(), elem->get<float>("h") * scale.y());
+		mTargetSize = Vector2f(mTargetSize.x(), elem->get<float>(ThemeProperties::H) * scale.y());
 		resize();
 	}
 
-	if (properties & SIZE && elem->has("padding"))
-		setPadding(elem->get<Vector4f>("padding"));
+	if (properties & SIZE && elem->has(ThemeProperties::PADDING))
+		setPadding(elem->get<Vector4f>(ThemeProperties::PADDING));
 
 	// position + size also implies origin
-	if ((properties & ORIGIN || (properties & POSITION && properties & ThemeFlags::SIZE)) && elem->has("origin"))
-		setOrigin(elem->get<Vector2f>("origin"));
+	if ((properties & ORIGIN || (properties & POSITION && properties & ThemeFlags::SIZE)) && elem->has(ThemeProperties::ORIGIN))
+		setOrigin(elem->get<Vector2f>(ThemeProperties::ORIGIN));
 
-	if (elem->has("default")) {
-		setDefaultImage(elem->get<std::string>("default"));
+	if (elem->has(ThemeProperties::DEFAULT)) {
+		setDefaultImage(elem->get<std::string>(ThemeProperties::DEFAULT));
 	}
 
 	if (properties & COLOR)
 	{
-		if (elem->has("color"))
+		if (elem->has(ThemeProperties::COLOR))
 		{
 			setColorShift(elem->get<unsigned int>("color"));
 			setColorShiftEnd(elem->get<unsigned int>("color"));
 		}
 
-		if (elem->has("colorEnd"))
+		if (elem->has(ThemeProperties::COLOR_END))
 			setColorShiftEnd(elem->get<unsigned int>("colorEnd"));
 
-		if (elem->has("gradientType"))
-			setColorGradientHorizontal(elem->get<std::string>("gradientType").compare("horizontal"));
+		if (elem->has(ThemeProperties::GRADIENT_TYPE))
+			setColorGradientHorizontal(elem->get<std::string>(ThemeProperties::GRADIENT_TYPE).compare("horizontal"));
 		
-		if (elem->has("reflexion"))
-			mReflection = elem->get<Vector2f>("reflexion");
+		if (elem->has(ThemeProperties::REFLEXION))
+			mReflection = elem->get<Vector2f>(ThemeProperties::REFLEXION);
 		else
 			mReflection = Vector2f::Zero();
 
-		if (elem->has("reflexionOnFrame"))
-			mReflectOnBorders = elem->get<bool>("reflexionOnFrame");
+		if (elem->has(ThemeProperties::REFLEXION_ON_FRAME))
+			mReflectOnBorders = elem->get<bool>(ThemeProperties::REFLEXION_ON_FRAME);
 		else
 			mReflectOnBorders = false;
 
-		if (elem->has("opacity"))
-			setOpacity((unsigned char) (elem->get<float>("opacity") * 255.0));		
+		if (elem->has(ThemeProperties::OPACITY))
+			setOpacity((unsigned char) (elem->get<float>(ThemeProperties::OPACITY) * 255.0));		
 
-		if (elem->has("saturation"))
-			mSaturation = Math::clamp(elem->get<float>("saturation"), 0.0f, 1.0f);
+		if (elem->has(ThemeProperties::SATURATION))
+			mSaturation = Math::clamp(elem->get<float>(ThemeProperties::SATURATION), 0.0f, 1.0f);
 
 		ThemeData::parseCustomShader(elem, &mCustomShader);
 	}	
 
 	if(properties & ThemeFlags::ROTATION) 
 	{
-		if(elem->has("rotation"))
-			setRotationDegrees(elem->get<float>("rotation"));
+		if(elem->has(ThemeProperties::ROTATION))
+			setRotationDegrees(elem->get<float>(ThemeProperties::ROTATION));
 
-		if(elem->has("rotationOrigin"))
-			setRotationOrigin(elem->get<Vector2f>("rotationOrigin"));
+		if(elem->has(ThemeProperties::ROTATION_ORIGIN))
+			setRotationOrigin(elem->get<Vector2f>(ThemeProperties::ROTATION_ORIGIN));
 
-		if (elem->has("scale"))
-			setScale(elem->get<float>("scale"));
+		if (elem->has(ThemeProperties::SCALE))
+			setScale(elem->get<float>(ThemeProperties::SCALE));
 
-		if (elem->has("scaleOrigin"))
-			setScaleOrigin(elem->get<Vector2f>("scaleOrigin"));
+		if (elem->has(ThemeProperties::SCALE_ORIGIN))
+			setScaleOrigin(elem->get<Vector2f>(ThemeProperties::SCALE_ORIGIN));
 
-		if (elem->has("flipX"))
-			setFlipX(elem->get<bool>("flipX"));
+		if (elem->has(ThemeProperties::FLIP_X))
+			setFlipX(elem->get<bool>(ThemeProperties::FLIP_X));
 
-		if (elem->has("flipY"))
-			setFlipY(elem->get<bool>("flipY"));
+		if (elem->has(ThemeProperties::FLIP_Y))
+			setFlipY(elem->get<bool>(ThemeProperties::FLIP_Y));
 
 	}
 
-	if (properties & ALIGNMENT && elem->has("horizontalAlignment"))
+	if (properties & ALIGNMENT && elem->has(ThemeProperties::HORIZONTAL_ALIGNMENT))
 	{
-		std::string str = elem->get<std::string>("horizontalAlignment");
+		std::string str = elem->get<std::string>(ThemeProperties::HORIZONTAL_ALIGNMENT);
 		if (str == "left")
 			setHorizontalAlignment(ALIGN_LEFT);
 		else if (str == "right")
@@ -817,9 +853,9 @@ void ImageComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const s
 			setHorizontalAlignment(ALIGN_CENTER);		
 	}
 
-	if (properties & ALIGNMENT && elem->has("verticalAlignment"))
+	if (properties & ALIGNMENT && elem->has(ThemeProperties::VERTICAL_ALIGNMENT))
 	{
-		std::string str = elem->get<std::string>("verticalAlignment");
+		std::string str = elem->get<std::string>(ThemeProperties::VERTICAL_ALIGNMENT);
 		if (str == "top")
 			setVerticalAlignment(ALIGN_TOP);
 		else if (str == "bottom")
@@ -828,28 +864,28 @@ void ImageComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const s
 			setVerticalAlignment(ALIGN_CENTER);
 	}
 
-	if (properties & ALIGNMENT && elem->has("roundCorners"))
-		setRoundCorners(elem->get<float>("roundCorners"));
+	if (properties & ALIGNMENT && elem->has(ThemeProperties::ROUND_CORNERS))
+		setRoundCorners(elem->get<float>(ThemeProperties::ROUND_CORNERS));
 	
-	if(properties & ThemeFlags::Z_INDEX && elem->has("zIndex"))
-		setZIndex(elem->get<float>("zIndex"));
+	if(properties & ThemeFlags::Z_INDEX && elem->has(ThemeProperties::Z_INDEX))
+		setZIndex(elem->get<float>(ThemeProperties::Z_INDEX));
 	else
 		setZIndex(getDefaultZIndex());
 	
 	if (properties & ThemeFlags::VISIBLE)
-		setVisible(!elem->has("visible") || elem->get<bool>("visible"));
+		setVisible(!elem->has(ThemeProperties::VISIBLE) || elem->get<bool>(ThemeProperties::VISIBLE));
 
-	if (properties & POSITION && elem->has("clipRect"))
+	if (properties & POSITION && elem->has(ThemeProperties::CLIP_RECT))
 	{
-		Vector4f val = elem->get<Vector4f>("clipRect") * Vector4f(scale.x(), scale.y(), scale.x(), scale.y());
+		Vector4f val = elem->get<Vector4f>(ThemeProperties::CLIP_RECT) * Vector4f(scale.x(), scale.y(), scale.x(), scale.y());
 		setClipRect(val);
 	}
 	else
 		setClipRect(Vector4f());
 		
-	if (properties & PATH && elem->has("path"))
+	if (properties & PATH && elem->has(ThemeProperties::PATH))
 	{
-		auto path = elem->get<std::string>("path");
+		auto path = elem->get<std::string>(ThemeProperties::PATH);
 
 		if (!path.empty())
 		{			
@@ -857,7 +893,7 @@ void ImageComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const s
 			
 			if (mPlaylist == nullptr)
 			{
-				bool tile = (elem->has("tile") && elem->get<bool>("tile"));
+				bool tile = (elem->has(ThemeProperties::TILE) && elem->get<bool>(ThemeProperties::TILE));
 				if (tile)
 					setImage(path, true, MaxSizeInfo(), false);
 				else
@@ -872,11 +908,13 @@ void ImageComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const s
 		}
 	}
 
-	if (elem->has("onclick"))
-		setClickAction(elem->get<std::string>("onclick"));
+	if (elem->has(ThemeProperties::ONCLICK))
+		setClickAction(elem->get<std::string>(ThemeProperties::ONCLICK));
 	else
 		setClickAction("");
 
+	setRenderCache(elem->has(ThemeProperties::RENDER_CACHE) && elem->get<bool>(ThemeProperties::RENDER_CACHE));
+
 	for (auto prop : elem->properties)
 		if (prop.second.type == ThemeData::ThemeElement::Property::PropertyType::String && Utils::String::endsWith(prop.first, "_binding"))
 			mBindingExpressions[Utils::String::replace(prop.first, "_binding", "")] = prop.second.s;
@@ -898,6 +936,8 @@ void ImageComponent::setPlaylist(std::shared_ptr<IPlaylist> playList)
 {
 	mPlaylistCache.clear();
 	mPlaylist = playList;
+	setUpdateActive(mAnimation != nullptr || mPlaylist != nullptr);
+
 	if (mPlaylist == nullptr)
 		return;
 
@@ -906,6 +946,70 @@ void ImageComponent::setPlaylist(std::shared_ptr<IPlaylist> playList)
 		setImage(image, false, getMaxSizeInfo(), true, false);
 }
 
+void ImageComponent::setAnimationFrames(const std::shared_ptr<AnimationFrames>& animation)
+{
+	mAnimation = animation;
+	mAnimationFrame = -1;
+	mAnimationTimer = 0;
+	setUpdateActive(mAnimation != nullptr || mPlaylist != nullptr);
+
+	if (mAnimation == nullptr)
+	{
+		if (mTexture != nullptr && mTexture == mAnimationTexture)
+		{
+			mTexture->setRequired(false);
+			mTexture.reset();
+		}
+
+		// The texture goes first, it points to the pixels
+		mAnimationTexture.reset();
+		mAnimationPixels.reset();
+		return;
+	}
+
+	setPlaylist(nullptr);
+	mPath = mAnimation->getPath();
+
+	if (mTexture != nullptr)
+		mTexture->setRequired(false);
+
+	TextureResource::cancelAsync(mLoadingTexture);
+	TextureResource::cancelAsync(mTexture);
+
+	mLoadingTexture.reset();
+	mTexture.reset();
+
+	if (mAnimationTexture == nullptr)
+		mAnimationTexture = TextureResource::get("", false, mLinear);
+
+	updateAnimation();
+}
+
+void ImageComponent::updateAnimation()
+{
+	int index = mAnimationFrame < 0 ? 0 : (mAnimationFrame + 1) % mAnimation->getFrameCount();
+
+	// Still decoding : the current frame stays on screen
+	auto frame = mAnimation->getFrame(index);
+	if (frame.rgba == nullptr)
+		return;
+
+	mAnimationTexture->updateFromExternalPixels(frame.rgba.get(), frame.width, frame.height);
+	mAnimationPixels = frame.rgba;
+	mAnimationFrame = index;
+	mAnimationTimer = 0;
+
+	if (mTexture != mAnimationTexture)
+	{
+		mTexture = mAnimationTexture;
+
+		if (isShowing())
+			mTexture->setRequired(true);
+
+		resize();
+	}
+}
+
 void ImageComponent::onShow()
 {
 	mPlaylistTimer = 0;
@@ -935,6 +1039,14 @@ void ImageComponent::update(int deltaTime)
 {
 	GuiComponent::update(deltaTime);
 
+	if (mAnimation != nullptr && isShowing())
+	{
+		mAnimationTimer += deltaTime;
+
+		if (mAnimationFrame < 0 || mAnimationTimer >= mAnimation->getFrameTime())
+			updateAnimation();
+	}
+
 	if (mPlaylist && isShowing())
 	{
 		mPlaylistTimer += deltaTime;
@@ -958,7 +1070,7 @@ bool ImageComponent::isTiled()
 	return mTexture != nullptr && mTexture->isTiled(); 
 }
 
-ThemeData::ThemeElement::Property ImageComponent::getProperty(const std::string name)
+ThemeData::ThemeElement::Property ImageComponent::getProperty(const std::string& name)
 {
 	Vector2f scale = getParent() ? getParent()->getSize() : Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 
@@ -982,7 +1094,7 @@ ThemeData::ThemeElement::Property ImageComponent::getProperty(const std::string
 	return GuiComponent::getProperty(name);
 }
 
-void ImageComponent::setProperty(const std::string name, const ThemeData::ThemeElement::Property& value)
+void ImageComponent::setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value)
 {	
 	Vector2f scale = getParent() ? getParent()->getSize() : Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 
@@ -10,6 +10,7 @@
 
 class TextureResource;
 class MaxSizeInfo;
+class AnimationFrames;
 
 class IPlaylist
 {
@@ -39,6 +40,9 @@ public:
 	//Use an already existing texture.
 	void setImage(const std::shared_ptr<TextureResource>& texture);
 
+	// Order in the async texture queue, lower values load first
+	void setLoadPriority(int priority);
+
 	void onSizeChanged() override;
 	void setOpacity(unsigned char opacity) override;
 
@@ -94,7 +98,16 @@ public:
 	virtual std::vector<HelpPrompt> getHelpPrompts() override;
 
 	void setAllowFading(bool fade) { mAllowFading = fade; };
-	void setMirroring(Vector2f mirror) { mReflection = mirror; };
+	void setMirroring(Vector2f mirror) { mReflection = mirror; invalidateBounds(); };
+
+	// The reflection is drawn below the image
+	Vector4f getLocalRenderBounds() override
+	{
+		if (mReflection.x() == 0 && mReflection.y() == 0)
+			return GuiComponent::getLocalRenderBounds();
+
+		return Vector4f(0, 0, mSize.x(), mSize.y() + Math::max(mSize.y(), mTargetSize.y()));
+	}
 
 	std::shared_ptr<TextureResource> getTexture() { return mTexture; };
 
@@ -125,10 +138,11 @@ public:
 	bool isTiled();
 
 	bool isLinear() { return mLinear; }
+	bool isAsync() { return mDynamic && !mForceLoad; }
 	void setIsLinear(bool value) { mLinear = value; }
 
-	ThemeData::ThemeElement::Property getProperty(const std::string name) override;
-	void setProperty(const std::string name, const ThemeData::ThemeElement::Property& value) override;
+	ThemeData::ThemeElement::Property getProperty(const std::string& name) override;
+	void setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value) override;
 	void setTargetIsMax() { mTargetIsMax = true; }
 	bool getTargetIsMax() { return mTargetIsMax; }
 
@@ -192,6 +206,16 @@ private:
 
 	float mPlaylistTimer;
 
+	// Animated GIF / APNG : the decoded frames are shared, each image updates its own texture
+	void setAnimationFrames(const std::shared_ptr<AnimationFrames>& animation);
+	void updateAnimation();
+
+	std::shared_ptr<AnimationFrames> mAnimation;
+	std::shared_ptr<unsigned char> mAnimationPixels; // Referenced by mAnimationTexture
+	std::shared_ptr<TextureResource> mAnimationTexture;
+	int mAnimationFrame;
+	int mAnimationTimer;
+
 	bool mLinear;
 
 	std::vector<Renderer::Vertex>	mRoundCornerStencil;
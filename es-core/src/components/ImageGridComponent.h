@@ -147,6 +147,8 @@ private:
 	Vector2i	getVisibleRange();
 	void		loadTile(std::shared_ptr<GridTileComponent> tile, typename IList<ImageGridData, T>::Entry& entry);
 	std::shared_ptr<GridTileComponent> createTile(int i, int dimOpposite, Vector2f tileDistance, Vector2f startPosition);
+	void		placeTile(const std::shared_ptr<GridTileComponent>& tile, int i, int dimOpposite, Vector2f tileDistance, Vector2f startPosition);
+	void		releaseTile(const std::shared_ptr<GridTileComponent>& tile);
 
 	inline bool isVertical() { return mScrollDirection == SCROLL_VERTICALLY; };
 
@@ -203,6 +205,9 @@ private:
 	float mCameraOffset;
 
 	std::map<int, std::shared_ptr<GridTileComponent>> mScrollLoopTiles;
+
+	// Tiles scrolled out or cleared, already themed : rebound to other entries instead of being rebuilt
+	std::vector<std::shared_ptr<GridTileComponent>> mTilePool;
 };
 
 
@@ -226,9 +231,31 @@ Vector2i ImageGridComponent<T>::getVisibleRange()
 template<typename T>
 std::shared_ptr<GridTileComponent> ImageGridComponent<T>::createTile(int i, int dimOpposite, Vector2f tileDistance, Vector2f startPosition)
 {
+	if (!mTilePool.empty())
+	{
+		auto tile = mTilePool.back();
+		mTilePool.pop_back();
+
+		placeTile(tile, i, dimOpposite, tileDistance, startPosition);
+		return tile;
+	}
+
 	// Create tiles
 	auto tile = std::make_shared<GridTileComponent>(mWindow);
+	tile->setOrigin(0.5f, 0.5f);
+	tile->setSize(mTileSize);
+
+	// Once per tile : the pool is dropped when the theme changes
+	if (mTheme)
+		tile->applyTheme(mTheme, mName, "gridtile", ThemeFlags::ALL);
+
+	placeTile(tile, i, dimOpposite, tileDistance, startPosition);
+	return tile;
+}
 
+template<typename T>
+void ImageGridComponent<T>::placeTile(const std::shared_ptr<GridTileComponent>& tile, int i, int dimOpposite, Vector2f tileDistance, Vector2f startPosition)
+{
 	int X = i % (int)dimOpposite;
 	int Y = i / (int)dimOpposite;
 
@@ -241,17 +268,26 @@ std::shared_ptr<GridTileComponent> ImageGridComponent<T>::createTile(int i, int
 	if (!isVertical())
 		std::swap(X, Y);
 
-	tile->setOrigin(0.5f, 0.5f);
 	tile->setPosition(X * tileDistance.x() + startPosition.x(), Y * tileDistance.y() + startPosition.y());
 	tile->setSize(mTileSize);
 
-	if (mTheme)
-		tile->applyTheme(mTheme, mName, "gridtile", ThemeFlags::ALL);
-
 	if (mAutoLayout.x() != 0 && mAutoLayout.y() != 0)
 		tile->forceSize(mTileSize, mAutoLayoutZoom);
+}
 
-	return tile;
+template<typename T>
+void ImageGridComponent<T>::releaseTile(const std::shared_ptr<GridTileComponent>& tile)
+{
+	// Still referenced elsewhere ( getSelectedTile ), or more than a screen of spares
+	auto range = getVisibleRange();
+	if (tile.use_count() > 1 || (int)mTilePool.size() >= Math::max(1, range.y() - range.x()))
+	{
+		tile->resetImages();
+		return;
+	}
+
+	tile->recycle();
+	mTilePool.push_back(tile);
 }
 
 template<typename T>
@@ -347,10 +383,26 @@ void ImageGridComponent<T>::ensureVisibleTileExist()
 					entry.data.tile->onShow();
 			}
 
+			// Tiles close to the cursor load first
+			int loadPriority = std::abs(idx - mCursor) / dimOpposite;
+			entry.data.tile->setLoadPriority(loadPriority);
+
 			if (mScrollLoop && i < startIndex || i > endIndex)
 			{
-				auto tile = createTile(idx, dimOpposite, tileDistance, startPosition);
+				std::shared_ptr<GridTileComponent> tile;
+
+				auto old = oldScrollLoopTiles.find(idx);
+				if (old != oldScrollLoopTiles.cend())
+				{
+					tile = old->second;
+					oldScrollLoopTiles.erase(old);
+					placeTile(tile, idx, dimOpposite, tileDistance, startPosition);
+				}
+				else
+					tile = createTile(idx, dimOpposite, tileDistance, startPosition);
+
 				loadTile(tile, entry);
+				tile->setLoadPriority(loadPriority);
 				mScrollLoopTiles[idx] = tile;
 			}
 		}
@@ -360,13 +412,16 @@ void ImageGridComponent<T>::ensureVisibleTileExist()
 
 			if (!mShowing)
 			{
-				entry.data.tile->resetImages();
+				releaseTile(entry.data.tile);
 				entry.data.tile = nullptr;
 			}
 			else
 				entry.data.tile->onHide();
 		}
 	}
+
+	for (auto& tile : oldScrollLoopTiles)
+		releaseTile(tile.second);
 }
 
 template<typename T>
@@ -436,6 +491,16 @@ void ImageGridComponent<T>::add(const std::string& name, const std::string& imag
 template<typename T>
 void ImageGridComponent<T>::clear()
 {	
+	// Repopulating ( filters, sorting ) rebinds the same tiles
+	for (auto& entry : mEntries)
+		if (entry.data.tile != nullptr)
+			releaseTile(entry.data.tile);
+
+	for (auto& tile : mScrollLoopTiles)
+		releaseTile(tile.second);
+
+	mScrollLoopTiles.clear();
+
 	IList<ImageGridData, T>::clear();
 	resetGrid();
 }
@@ -459,6 +524,10 @@ void ImageGridComponent<T>::setImage(const std::string& imagePath, const T& obj)
 	if (entry != list->end() && (*entry).data.texturePath != imagePath)
 	{
 		(*entry).data.texturePath = imagePath;
+
+		if ((*entry).data.tile != nullptr)
+			releaseTile((*entry).data.tile);
+
 		(*entry).data.tile = nullptr;
 
 		mEntriesDirty = true;
@@ -688,6 +757,13 @@ void ImageGridComponent<T>::render(const Transform4x4f& parentTrans)
 	for (auto scrollLoopTile : mScrollLoopTiles)
 		scrollLoopTile.second->render(tileTrans);
 
+	// Tiles at rest don't overlap : render all their backgrounds, then images, then labels & overlays, so that the renderer
+	// batches each layer instead of switching textures for every tile. Animated tiles are rendered over them, in order
+	bool layeredRendering = mMargin.x() >= 0 && mMargin.y() >= 0;
+
+	std::vector<GridTileComponent*> restingTiles;
+	std::vector<GridTileComponent*> animatedTiles;
+
 	for (int i = 0; i < mEntries.size(); i++)
 	{
 		typename IList<ImageGridData, T>::Entry& entry = mEntries[i];
@@ -699,11 +775,25 @@ void ImageGridComponent<T>::render(const Transform4x4f& parentTrans)
 				if (splittedRendering && entry.data.tile->shouldSplitRendering())
 					entry.data.tile->renderBackground(tileTrans);
 			}
+			else if (layeredRendering && !entry.data.tile->shouldSplitRendering())
+				restingTiles.push_back(entry.data.tile.get());
 			else
-				entry.data.tile->render(tileTrans);
+				animatedTiles.push_back(entry.data.tile.get());
 		}
 	}
 
+	for (auto tile : restingTiles)
+		tile->renderBackground(tileTrans);
+
+	for (auto tile : restingTiles)
+		tile->renderLayers(tileTrans, GridTileComponent::LAYER_IMAGE);
+
+	for (auto tile : restingTiles)
+		tile->renderLayers(tileTrans, GridTileComponent::LAYER_OVERLAYS);
+
+	for (auto tile : animatedTiles)
+		tile->render(tileTrans);
+
 	// Render the selected image content on top of the others
 	if (selectedTile != nullptr)
 	{
@@ -748,6 +838,7 @@ void ImageGridComponent<T>::applyTheme(const std::shared_ptr<ThemeData>& theme,
 {
 	// Keep the theme pointer to apply it on the tiles later on
 	mTheme = nullptr;
+	mTilePool.clear();
 
 	// Apply theme to GuiComponent but not size property, which will be applied at the end of this function
 	GuiComponent::applyTheme(theme, view, element, properties ^ ThemeFlags::SIZE);
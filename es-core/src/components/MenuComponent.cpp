@@ -153,6 +153,38 @@ void MenuComponent::addWithLabel(const std::string& label, const std::shared_ptr
 	addRow(row, setCursorHere);
 }
 
+void MenuComponent::addDeferredWithLabel(const std::string& label, const std::function<std::shared_ptr<GuiComponent>()>& create, const std::string& description, const std::string& iconName)
+{
+	auto theme = ThemeData::getMenuTheme();
+
+	ComponentListRow row;
+
+	addMenuIcon(mWindow, row, iconName);
+
+	if (!description.empty())
+	{
+		mList->setUpdateType(ComponentListFlags::UpdateType::UPDATE_ALWAYS);
+		row.addElement(std::make_shared<MultiLineMenuEntry>(mWindow, Utils::String::toUpper(label), description, false), true);
+	}
+	else
+	{
+		auto text = std::make_shared<TextComponent>(mWindow, Utils::String::toUpper(label), theme->Text.font, theme->Text.color);
+		row.addElement(text, true);
+
+		if (EsLocale::isRTL())
+			text->setHorizontalAlignment(Alignment::ALIGN_RIGHT);
+	}
+
+	row.deferred = [create](ComponentListRow& built)
+	{
+		auto comp = create();
+		if (comp != nullptr)
+			built.addElement(comp, false);
+	};
+
+	addRow(row);
+}
+
 void MenuComponent::addWithDescription(const std::string& label, const std::string& description, const std::shared_ptr<GuiComponent>& comp, const std::function<void()>& func, const std::string& iconName, bool setCursorHere, bool multiLine, const std::string& userData, bool doUpdateSize)
 {
 	auto theme = ThemeData::getMenuTheme();
@@ -33,6 +33,8 @@ public:
 	inline void clear() { mList->clear(); }
 
 	void addWithLabel(const std::string& label, const std::shared_ptr<GuiComponent>& comp, const std::function<void()>& func = nullptr, const std::string& iconName = "", bool setCursorHere = false);
+	// The component is created once the row is scrolled into view or selected
+	void addDeferredWithLabel(const std::string& label, const std::function<std::shared_ptr<GuiComponent>()>& create, const std::string& description = "", const std::string& iconName = "");
 	void addWithDescription(const std::string& label, const std::string& description, const std::shared_ptr<GuiComponent>& comp, const std::function<void()>& func = nullptr, const std::string& iconName = "", bool setCursorHere = false, bool multiLine = false, const std::string& userData = "", bool doUpdateSize = true);
 	void addEntry(const std::string& name, bool add_arrow = false, const std::function<void()>& func = nullptr, const std::string& iconName = "", bool setCursorHere = false, bool onButtonRelease = false, const std::string& userData = "", bool doUpdateSize = true);
 	void addGroup(const std::string& label, bool forceVisible = false, bool doUpdateSize = true) { mList->addGroup(label, forceVisible); if (doUpdateSize) updateSize(); }
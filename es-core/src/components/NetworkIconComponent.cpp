@@ -1,25 +1,25 @@
 #include "components/NetworkIconComponent.h"
-#include "Settings.h"
-#include "utils/Platform.h"
-#include "IExternalActivity.h"
-
-#define UPDATE_NETWORK_DELAY	2000
+#include "StatusIndicators.h"
 
 NetworkIconComponent::NetworkIconComponent(Window* window) : ImageComponent(window)
 {	
-	mNetworkCheckTime = UPDATE_NETWORK_DELAY;
+	mStatusVersion = -1;
 	setVisible(false);
+	setUpdateAlways(true);
 }
 
 void NetworkIconComponent::update(int deltaTime)
 {
 	ImageComponent::update(deltaTime);
 
-	mNetworkCheckTime += deltaTime;
-	if (mNetworkCheckTime >= UPDATE_NETWORK_DELAY)
-	{		
-		bool networkConnected = Settings::ShowNetworkIndicator() && !Utils::Platform::queryIPAdress().empty();
-		bool planemodeEnabled = Settings::ShowNetworkIndicator() && IExternalActivity::Instance != nullptr && IExternalActivity::Instance->isPlaneMode();
+	if (mStatusVersion != StatusIndicators::getVersion())
+	{
+		mStatusVersion = StatusIndicators::getVersion();
+
+		// False when ShowNetworkIndicator is off
+		auto status = StatusIndicators::get();
+		bool networkConnected = status->networkConnected;
+		bool planemodeEnabled = status->planeMode;
 
 		setVisible(networkConnected || planemodeEnabled);
 
@@ -32,8 +32,6 @@ void NetworkIconComponent::update(int deltaTime)
 
 			setImage(txName);
 		}
-
-		mNetworkCheckTime = 0;
 	}
 }
 
@@ -52,5 +50,7 @@ void NetworkIconComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, c
 
 	if (elem->has("planemodeIcon") && ResourceManager::getInstance()->fileExists(elem->get<std::string>("planemodeIcon")))
 		mPlanemodeIcon = elem->get<std::string>("planemodeIcon");
+
+	mStatusVersion = -1;
 }
 
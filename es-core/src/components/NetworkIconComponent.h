@@ -19,7 +19,7 @@ public:
 	void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
 private:
-	int mNetworkCheckTime;
+	int mStatusVersion;
 
 	std::string mNetworkIcon;
 	std::string mPlanemodeIcon;
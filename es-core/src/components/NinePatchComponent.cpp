@@ -3,11 +3,40 @@
 #include "resources/TextureResource.h"
 #include "Log.h"
 #include "ThemeData.h"
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+#define GEOMETRY_CACHE_MAX 256
+
+// Vertex positions & texture coordinates ( without colors ) by size, corner size, padding & texture size.
+// Menus have many ninepatches laid out the same way ( buttons, frames ), only the first one computes them
+struct NinePatchGeometryKey
+{
+	Vector2f size;
+	Vector2f cornerSize;
+	Vector4f padding;
+	Vector2i textureSize;
+
+	bool operator<(const NinePatchGeometryKey& other) const
+	{
+		return std::make_tuple(size.x(), size.y(), cornerSize.x(), cornerSize.y(), padding.x(), padding.y(), padding.z(), padding.w(), textureSize.x(), textureSize.y()) <
+			std::make_tuple(other.size.x(), other.size.y(), other.cornerSize.x(), other.cornerSize.y(), other.padding.x(), other.padding.y(), other.padding.z(), other.padding.w(), other.textureSize.x(), other.textureSize.y());
+	}
+};
+
+struct NinePatchGeometry
+{
+	Renderer::Vertex vertices[6 * 9];
+};
+
+// Only used by the render thread
+static std::map<NinePatchGeometryKey, NinePatchGeometry> sGeometryCache;
 
 NinePatchComponent::NinePatchComponent(Window* window, const std::string& path, unsigned int edgeColor, unsigned int centerColor) : GuiComponent(window),
 	mCornerSize(16, 16),
 	mEdgeColor(edgeColor), mCenterColor(centerColor),
-	mVertices(NULL), mPadding(Vector4f(0, 0, 0, 0))
+	mVerticesValid(false), mGeometryDirty(false), mPadding(Vector4f(0, 0, 0, 0))
 {
 	mTimer = 0;
 	mAnimateTiming = 0;
@@ -15,6 +44,9 @@ NinePatchComponent::NinePatchComponent(Window* window, const std::string& path,
 	
 	mPreviousSize = Vector2f(0, 0);
 	setImagePath(path);
+
+	// Only the color animation needs ticks
+	setUpdateActive(false);
 }
 
 void NinePatchComponent::setOpacity(unsigned char opacity)
@@ -30,9 +62,6 @@ NinePatchComponent::~NinePatchComponent()
 {
 	if (mTexture != nullptr)
 		mTexture->setRequired(false);
-
-	if (mVertices != NULL)
-		delete[] mVertices;
 }
 
 void NinePatchComponent::update(int deltaTime)
@@ -49,7 +78,7 @@ void NinePatchComponent::update(int deltaTime)
 
 void NinePatchComponent::updateColors()
 {
-	if (mVertices == nullptr)
+	if (!mVerticesValid)
 		return;
 
 	float opacity = mOpacity / 255.0;
@@ -76,25 +105,38 @@ void NinePatchComponent::updateColors()
 
 void NinePatchComponent::buildVertices()
 {
+	mGeometryDirty = false;
+
 	if(mTexture == nullptr)
 		return;
 
-	if(mVertices != NULL)
-		delete[] mVertices;	
+	mVerticesValid = false;
 
 	if(mTexture->getSize() == Vector2i::Zero())
 	{
-		mVertices = NULL;
 		LOG(LogWarning) << "NinePatchComponent missing texture!";
 		return;
 	}
 
-	mVertices = new Renderer::Vertex[6 * 9];
-
 	const Vector2f texSize = Vector2f((float)mTexture->getSize().x(), (float)mTexture->getSize().y());
 	if (texSize.x() <= 0 || texSize.y() <= 0)
 		return;
 
+	NinePatchGeometryKey key;
+	key.size = mSize;
+	key.cornerSize = mCornerSize;
+	key.padding = mPadding;
+	key.textureSize = mTexture->getSize();
+
+	auto it = sGeometryCache.find(key);
+	if (it != sGeometryCache.cend())
+	{
+		std::copy(it->second.vertices, it->second.vertices + 6 * 9, mVertices);
+		mVerticesValid = true;
+		updateColors();
+		return;
+	}
+
 	const float imgSizeX[3] = { mCornerSize.x(), mSize.x() - mCornerSize.x() * 2 - mPadding.x() - mPadding.z(), mCornerSize.x()};
 	const float imgSizeY[3] = { mCornerSize.y(), mSize.y() - mCornerSize.y() * 2 - mPadding.y() - mPadding.w(), mCornerSize.y()};
 	const float imgPosX[3]  = { mPadding.x(), mPadding.y() + imgSizeX[0], mPadding.x() + imgSizeX[0] + imgSizeX[1] };
@@ -132,12 +174,24 @@ void NinePatchComponent::buildVertices()
 		v += 6;
 	}
 
+	if (sGeometryCache.size() >= GEOMETRY_CACHE_MAX)
+		sGeometryCache.clear();
+
+	std::copy(mVertices, mVertices + 6 * 9, sGeometryCache[key].vertices);
+
+	mVerticesValid = true;
 	updateColors();
 }
 
 void NinePatchComponent::render(const Transform4x4f& parentTrans)
 {
-	if (!mVisible || mTexture == nullptr || mVertices == nullptr)
+	if (!mVisible || mTexture == nullptr)
+		return;
+
+	if (mGeometryDirty)
+		buildVertices();
+
+	if (!mVerticesValid)
 		return;
 
 	Transform4x4f trans = parentTrans * getTransform();
@@ -212,7 +266,7 @@ void NinePatchComponent::onSizeChanged()
 		return;
 
 	mPreviousSize = mSize;
-	buildVertices();
+	invalidateVertices();
 }
 
 const Vector2f& NinePatchComponent::getCornerSize() const
@@ -226,7 +280,7 @@ void NinePatchComponent::setCornerSize(float sizeX, float sizeY)
 		return;
 
 	mCornerSize = Vector2f(sizeX, sizeY);
-	buildVertices();
+	invalidateVertices();
 }
 
 void NinePatchComponent::fitTo(Vector2f size, Vector3f position, Vector2f padding)
@@ -256,7 +310,7 @@ void NinePatchComponent::setImagePath(const std::string& path)
 	if (isShowing() && mTexture != nullptr)
 		mTexture->setRequired(true);
 
-	buildVertices();
+	invalidateVertices();
 }
 
 void NinePatchComponent::setEdgeColor(unsigned int edgeColor)
@@ -334,7 +388,7 @@ void NinePatchComponent::onHide()
 		mTexture->setRequired(false);	
 }
 
-ThemeData::ThemeElement::Property NinePatchComponent::getProperty(const std::string name)
+ThemeData::ThemeElement::Property NinePatchComponent::getProperty(const std::string& name)
 {
 	Vector2f scale = getParent() ? getParent()->getSize() : Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 
@@ -354,7 +408,7 @@ ThemeData::ThemeElement::Property NinePatchComponent::getProperty(const std::str
 	return GuiComponent::getProperty(name);
 }
 
-void NinePatchComponent::setProperty(const std::string name, const ThemeData::ThemeElement::Property& value)
+void NinePatchComponent::setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value)
 {
 	Vector2f scale = getParent() ? getParent()->getSize() : Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 
@@ -383,5 +437,5 @@ void NinePatchComponent::setPadding(const Vector4f padding)
 		return;
 
 	mPadding = padding; 
-	buildVertices();
+	invalidateVertices();
 }
\ No newline at end of file
@@ -46,22 +46,26 @@ public:
 	virtual void setOpacity(unsigned char opacity);
 
 	void setAnimateColor(unsigned int color) { mAnimateColor = color; };
-	void setAnimateTiming(float timing) { mAnimateTiming = timing; };
+	void setAnimateTiming(float timing) { mAnimateTiming = timing; setUpdateActive(timing > 0); };
 
 	virtual void onShow() override;
 	virtual void onHide() override;
 
-	ThemeData::ThemeElement::Property getProperty(const std::string name) override;
-	void setProperty(const std::string name, const ThemeData::ThemeElement::Property& value) override;
+	ThemeData::ThemeElement::Property getProperty(const std::string& name) override;
+	void setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value) override;
 
 	Vector4f getPadding() { return mPadding; }
 	void setPadding(const Vector4f padding);
 
 private:
+	// The geometry is built at the next render, from the shared cache when another ninepatch has the same layout
+	void invalidateVertices() { mGeometryDirty = true; }
 	void buildVertices();
 	void updateColors();
 
-	Renderer::Vertex* mVertices;
+	Renderer::Vertex mVertices[6 * 9];
+	bool mVerticesValid;
+	bool mGeometryDirty;
 
 	std::string mPath;
 	Vector2f mCornerSize;
@@ -10,6 +10,7 @@
 #include "components/MultiLineMenuEntry.h"
 #include "components/MenuComponent.h"
 
+#include <algorithm>
 #include <tuple>
 
 //Used to display a list of options.
@@ -53,11 +54,19 @@ private:
 			OptionListData* item;
 		};
 
+		// Only the rows built so far
 		std::vector<CheckBoxElement> mCheckBoxes;
 
+		// The list row of each entry, for the jumps
+		std::vector<int> mRows;
+		bool mVirtualized;
+
+		std::string mSearch;
+		int mSearchTime;
+
 	public:
 		OptionListPopup(Window* window, OptionListComponent<T>* parent, const std::string& title, const std::function<void(T& data, ComponentListRow& row)> callback = nullptr) : GuiComponent(window),
-			mMenu(window, title.c_str()), mParent(parent)
+			mMenu(window, title.c_str()), mParent(parent), mVirtualized(callback == nullptr), mSearchTime(0)
 		{
 			auto menuTheme = ThemeData::getMenuTheme();
 			auto font = menuTheme->Text.font;
@@ -66,11 +75,17 @@ private:
 		//	if (parent->mMultiSelect && parent->mMultiSelectShowNames)
 		//		font = menuTheme->TextSmall.font;
 
+			// The rows of the plain entries are created when they scroll into view : until then, a placeholder gives them the height of their text
+			float rowHeight = font->getHeight();
+
 			ComponentListRow row;
+			mRows.reserve(mParent->mEntries.size());
 					
 			for(auto it = mParent->mEntries.begin(); it != mParent->mEntries.end(); it++)
 			{
 				row.elements.clear();
+				row.input_handler = nullptr;
+				row.deferred = nullptr;
 
 				OptionListData& e = *it;
 				
@@ -103,56 +118,23 @@ private:
 						row.addElement(std::make_shared<MultiLineMenuEntry>(mWindow, Utils::String::toUpper(it->name), it->description), true);
 					else
 					{
-						auto text = std::make_shared<TextComponent>(mWindow, e.treeChild ? "      " + Utils::String::toUpper(it->name) : Utils::String::toUpper(it->name), font, color);
-						if (EsLocale::isRTL())
-							text->setHorizontalAlignment(Alignment::ALIGN_RIGHT);
-
-						row.addElement(text, true);
+						auto placeholder = std::make_shared<GuiComponent>(mWindow);
+						placeholder->setSize(0, rowHeight);
+						row.addElement(placeholder, true);
 					}
 
-					if (mParent->mMultiSelect)
-					{
-						// add checkbox
-						auto checkbox = std::make_shared<ImageComponent>(mWindow);
-						checkbox->setImage(it->selected ? CHECKED_PATH : UNCHECKED_PATH);
-						checkbox->setResize(0, font->getLetterHeight());
-						row.addElement(checkbox, false);
-
-						// input handler
-						// update checkbox state & selected value
-						row.makeAcceptInputHandler([this, &e, checkbox]
-						{
-							e.selected = !e.selected;
-							checkbox->setImage(e.selected ? CHECKED_PATH : UNCHECKED_PATH);
-							mParent->onSelectedChanged();
-						});
-
-						CheckBoxElement el;
-						el.checkbox = checkbox.get();
-						el.item = &e;
-
-						// for select all/none
-						mCheckBoxes.push_back(el);
-					}
-					else {
-						// input handler for non-multiselect
-						// update selected value and close
-						row.makeAcceptInputHandler([this, &e]
-						{
-							mParent->mEntries.at(mParent->getSelectedId()).selected = false;
-							e.selected = true;
-							mParent->onSelectedChanged();
-							delete this;
-						});
-					}
+					row.deferred = [this, &e, font, color](ComponentListRow& built) { buildRow(e, built, font, color); };
 				}
 
 
 				if (!e.group.empty())
-					mMenu.addGroup(e.group);
+					mMenu.addGroup(e.group, false, false);
+
+				mRows.push_back(mMenu.getList()->size());
 
 				// also set cursor to this row if we're not multi-select and this row is selected
-				mMenu.addRow(row, (!mParent->mMultiSelect && it->selected), false);
+				// The layout is computed once, by the size of the menu
+				mMenu.getList()->addRow(row, (!mParent->mMultiSelect && it->selected), false);
 			}
 
 			mMenu.addButton(_("BACK"), _("accept"), [this] { delete this; }); 
@@ -161,21 +143,23 @@ private:
 			{
 				mMenu.addButton(_("SELECT ALL"), _("select all"), [this]
 				{
-					for (unsigned int i = 0; i < mParent->mEntries.size(); i++)
-					{
-						mParent->mEntries.at(i).selected = true;
-						mCheckBoxes.at(i).checkbox->setImage(CHECKED_PATH);
-					}
+					for (auto& entry : mParent->mEntries)
+						entry.selected = true;
+
+					for (auto& el : mCheckBoxes)
+						el.checkbox->setImage(CHECKED_PATH);
+
 					mParent->onSelectedChanged();
 				});
 
 				mMenu.addButton(_("SELECT NONE"), _("select none"), [this]
 				{
-					for (unsigned int i = 0; i < mParent->mEntries.size(); i++)
-					{
-						mParent->mEntries.at(i).selected = false;
-						mCheckBoxes.at(i).checkbox->setImage(UNCHECKED_PATH);
-					}
+					for (auto& entry : mParent->mEntries)
+						entry.selected = false;
+
+					for (auto& el : mCheckBoxes)
+						el.checkbox->setImage(UNCHECKED_PATH);
+
 					mParent->onSelectedChanged();
 				});
 			}
@@ -196,15 +180,184 @@ private:
 				return true;
 			}
 
+			// left/right jump to the previous/next initial
+			if (mVirtualized && input.value != 0 && !mMenu.isCursorToButtons())
+			{
+				if (config->isMappedLike("left", input))
+				{
+					jumpToInitial(-1);
+					return true;
+				}
+
+				if (config->isMappedLike("right", input))
+				{
+					jumpToInitial(1);
+					return true;
+				}
+			}
+
 			return GuiComponent::input(config, input);
 		}
 
+		// Incremental search : the letters typed within a second make the prefix, the same letter again goes to the next entry
+		void textInput(const char* text) override
+		{
+			if (!mVirtualized || text == nullptr || *text == 0)
+			{
+				GuiComponent::textInput(text);
+				return;
+			}
+
+			if (mSearchTime > 1000)
+				mSearch.clear();
+
+			mSearchTime = 0;
+
+			std::string letter = Utils::String::toUpper(text);
+			if (mSearch == letter)
+				jumpTo(mSearch, true);
+			else if (jumpTo(mSearch + letter, false))
+				mSearch += letter;
+			else
+			{
+				mSearch = letter;
+				jumpTo(mSearch, true);
+			}
+		}
+
+		void update(int deltaTime) override
+		{
+			mSearchTime += deltaTime;
+			GuiComponent::update(deltaTime);
+		}
+
 		std::vector<HelpPrompt> getHelpPrompts() override
 		{
 			auto prompts = mMenu.getHelpPrompts();
 			prompts.push_back(HelpPrompt(BUTTON_BACK, _("BACK")));
 			return prompts;
 		}
+
+	private:
+		void buildRow(OptionListData& e, ComponentListRow& row, const std::shared_ptr<Font>& font, unsigned int color)
+		{
+			if (e.description.empty())
+			{
+				auto text = std::make_shared<TextComponent>(mWindow, e.treeChild ? "      " + Utils::String::toUpper(e.name) : Utils::String::toUpper(e.name), font, color);
+				if (EsLocale::isRTL())
+					text->setHorizontalAlignment(Alignment::ALIGN_RIGHT);
+
+				row.elements.clear();
+				row.addElement(text, true);
+			}
+
+			if (mParent->mMultiSelect)
+			{
+				// add checkbox
+				auto checkbox = std::make_shared<ImageComponent>(mWindow);
+				checkbox->setImage(e.selected ? CHECKED_PATH : UNCHECKED_PATH);
+				checkbox->setResize(0, font->getLetterHeight());
+				row.addElement(checkbox, false);
+
+				// input handler
+				// update checkbox state & selected value
+				row.makeAcceptInputHandler([this, &e, checkbox]
+				{
+					e.selected = !e.selected;
+					checkbox->setImage(e.selected ? CHECKED_PATH : UNCHECKED_PATH);
+					mParent->onSelectedChanged();
+				});
+
+				CheckBoxElement el;
+				el.checkbox = checkbox.get();
+				el.item = &e;
+
+				// for select all/none
+				mCheckBoxes.push_back(el);
+			}
+			else {
+				// input handler for non-multiselect
+				// update selected value and close
+				row.makeAcceptInputHandler([this, &e]
+				{
+					mParent->mEntries.at(mParent->getSelectedId()).selected = false;
+					e.selected = true;
+					mParent->onSelectedChanged();
+					delete this;
+				});
+			}
+		}
+
+		int getCursorEntry()
+		{
+			int cursor = mMenu.getCursorIndex();
+			auto it = std::upper_bound(mRows.cbegin(), mRows.cend(), cursor);
+			return it == mRows.cbegin() ? 0 : (int)(it - mRows.cbegin()) - 1;
+		}
+
+		std::string getInitial(int index)
+		{
+			std::string name = Utils::String::toUpper(Utils::String::trim(mParent->mEntries[index].name));
+			return name.substr(0, Utils::String::nextCursor(name, 0));
+		}
+
+		void selectEntry(int index)
+		{
+			mMenu.setCursorToList();
+			mMenu.getList()->setCursorIndex(mRows[index]);
+		}
+
+		bool jumpTo(const std::string& prefix, bool skipCurrent)
+		{
+			int count = (int)mParent->mEntries.size();
+			if (count == 0)
+				return false;
+
+			int cursor = getCursorEntry();
+
+			for (int i = skipCurrent ? 1 : 0; i <= count; i++)
+			{
+				int index = (cursor + i) % count;
+				if (Utils::String::startsWith(Utils::String::toUpper(Utils::String::trim(mParent->mEntries[index].name)), prefix))
+				{
+					selectEntry(index);
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		void jumpToInitial(int direction)
+		{
+			int count = (int)mParent->mEntries.size();
+			if (count == 0)
+				return;
+
+			int cursor = getCursorEntry();
+			std::string initial = getInitial(cursor);
+
+			int index = cursor;
+			for (int i = 1; i < count; i++)
+			{
+				int next = (cursor + direction * i + count) % count;
+				if (getInitial(next) != initial)
+				{
+					index = next;
+					break;
+				}
+			}
+
+			// Backwards, on the first entry of that letter
+			if (direction < 0)
+			{
+				initial = getInitial(index);
+				while (index > 0 && getInitial(index - 1) == initial)
+					index--;
+			}
+
+			selectEntry(index);
+		}
 	};
 
 public:
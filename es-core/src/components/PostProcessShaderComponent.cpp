@@ -50,7 +50,7 @@ void PostProcessShaderComponent::applyTheme(const std::shared_ptr<ThemeData>& th
 	}
 }
 
-ThemeData::ThemeElement::Property PostProcessShaderComponent::getProperty(const std::string name)
+ThemeData::ThemeElement::Property PostProcessShaderComponent::getProperty(const std::string& name)
 {
 	if (name == "path")
 		return mShaderPath;
@@ -64,7 +64,7 @@ ThemeData::ThemeElement::Property PostProcessShaderComponent::getProperty(const
 	return GuiComponent::getProperty(name);
 }
 
-void PostProcessShaderComponent::setProperty(const std::string name, const ThemeData::ThemeElement::Property& value)
+void PostProcessShaderComponent::setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value)
 {
 	if (name == "path" && value.type == ThemeData::ThemeElement::Property::PropertyType::String)
 		mShaderPath = value.s;
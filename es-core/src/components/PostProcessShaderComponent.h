@@ -17,8 +17,8 @@ public:
 	void render(const Transform4x4f& parentTrans) override;
 	void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
-	ThemeData::ThemeElement::Property getProperty(const std::string name) override;
-	void setProperty(const std::string name, const ThemeData::ThemeElement::Property& value) override;
+	ThemeData::ThemeElement::Property getProperty(const std::string& name) override;
+	void setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value) override;
 
 private:
 	std::string mShaderPath;
@@ -2,6 +2,7 @@
 
 #include "math/Vector2i.h"
 #include "renderers/Renderer.h"
+#include "Window.h"
 
 #define AUTO_SCROLL_RESET_DELAY 6000 // ms to reset to top after we reach the bottom
 #define AUTO_SCROLL_DELAY 6000 // ms to wait before we start to scroll
@@ -63,6 +64,7 @@ void ScrollableContainer::update(int deltaTime)
 {
 	if(mAutoScrollSpeed != 0)
 	{
+		invalidateRender();
 		mAutoScrollAccumulator += deltaTime;
 
 		//scale speed by our width! more text per line = slower scrolling
@@ -3,6 +3,7 @@
 #include "utils/StringUtil.h"
 #include "Log.h"
 #include "Settings.h"
+#include "Window.h"
 
 #define AUTO_SCROLL_RESET_DELAY 6000 // ms to reset to top after we reach the bottom
 #define AUTO_SCROLL_DELAY 6000 // ms to wait before we start to scroll
@@ -18,6 +19,9 @@ TextComponent::TextComponent(Window* window) : GuiComponent(window),
 	mMarqueeOffset = 0;
 	mMarqueeOffset2 = 0;
 	mMarqueeTime = 0;	
+
+	// Only the marquees need ticks
+	setUpdateActive(false);
 }
 
 TextComponent::TextComponent(Window* window, const std::string& text, const std::shared_ptr<Font>& font, unsigned int color, Alignment align,
@@ -37,6 +41,8 @@ TextComponent::TextComponent(Window* window, const std::string& text, const std:
 	mMarqueeOffset = 0;
 	mMarqueeOffset2 = 0;
 	mMarqueeTime = 0;	
+
+	setUpdateActive(false);
 }
 
 void TextComponent::onSizeChanged()
@@ -76,6 +82,7 @@ void TextComponent::setColor(unsigned int color)
 		return;
 
 	mColor = color;
+	invalidateRender();
 	onColorChanged();
 }
 
@@ -108,6 +115,7 @@ void TextComponent::setText(const std::string& text)
 	mText = text;
 	mMarqueeOffset = 0;
 	mMarqueeOffset2 = 0;
+	invalidateRender();
 
 	if (mAutoScroll != AutoScrollType::NONE && !mText.empty())
 		mMarqueeTime = -AUTO_SCROLL_DELAY + AUTO_SCROLL_SPEED;
@@ -259,6 +267,11 @@ void TextComponent::render(const Transform4x4f& parentTrans)
 void TextComponent::onTextChanged()
 {
 	mTextLength = -1;
+
+	// Kept so that the next build reuses its vertex storage
+	if (mTextCache != nullptr)
+		mRecycledTextCache = mTextCache;
+
 	mTextCache = nullptr;
 
 	if (mAutoCalcExtent.x())
@@ -288,6 +301,7 @@ void TextComponent::buildTextCache()
 	if(!mFont || mText.empty())
 	{
 		mTextCache.reset();
+		mRecycledTextCache.reset();
 		return;
 	}
 
@@ -332,17 +346,37 @@ void TextComponent::buildTextCache()
 
 			text.append(abbrev);
 		}
+	}
+	else
+		text = f->wrapText(text, sx);
 
-		mTextCache = std::shared_ptr<TextCache>(f->buildTextCache(text, Vector2f(0, 0), color, sx, mHorizontalAlignment, mLineSpacing));
+	// Not shared anymore : rebuilt in place, which does not allocate when the glyph count is unchanged
+	if (mRecycledTextCache != nullptr && mRecycledTextCache.use_count() == 1)
+	{
+		f->updateTextCache(mRecycledTextCache.get(), text, Vector2f(0, 0), color, sx, mHorizontalAlignment, mLineSpacing);
+		mTextCache = mRecycledTextCache;
 	}
 	else
-		mTextCache = std::shared_ptr<TextCache>(f->buildTextCache(f->wrapText(text, sx), Vector2f(0, 0), color, sx, mHorizontalAlignment, mLineSpacing));
+		mTextCache = std::shared_ptr<TextCache>(f->buildTextCache(text, Vector2f(0, 0), color, sx, mHorizontalAlignment, mLineSpacing));
+
+	mRecycledTextCache.reset();
 }
 
 void TextComponent::update(int deltaTime)
 {
 	GuiComponent::update(deltaTime);
 
+	auto marqueeOffset = mMarqueeOffset;
+	auto marqueeOffset2 = mMarqueeOffset2;
+	updateMarquee(deltaTime);
+
+	if (mMarqueeOffset != marqueeOffset || mMarqueeOffset2 != marqueeOffset2)
+		invalidateRender();
+}
+
+void TextComponent::updateMarquee(int deltaTime)
+{
+
 	if (!mShowing)
 	{
 		mMarqueeTime = 0;
@@ -508,9 +542,9 @@ void TextComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const st
 
 	if (properties & ALIGNMENT)
 	{
-		if (elem->has("alignment"))
+		if (elem->has(ThemeProperties::ALIGNMENT))
 		{
-			std::string str = elem->get<std::string>("alignment");
+			std::string str = elem->get<std::string>(ThemeProperties::ALIGNMENT);
 			if (str == "left")
 				setHorizontalAlignment(ALIGN_LEFT);
 			else if (str == "center")
@@ -521,9 +555,9 @@ void TextComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const st
 				LOG(LogError) << "Unknown text alignment string: " << str;
 		}
 
-		if (elem->has("verticalAlignment"))
+		if (elem->has(ThemeProperties::VERTICAL_ALIGNMENT))
 		{
-			std::string str = elem->get<std::string>("verticalAlignment");
+			std::string str = elem->get<std::string>(ThemeProperties::VERTICAL_ALIGNMENT);
 			if (str == "top")
 				setVerticalAlignment(ALIGN_TOP);
 			else if (str == "center")
@@ -534,11 +568,11 @@ void TextComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const st
 				LOG(LogError) << "Unknown text alignment string: " << str;
 		}
 
-		if (elem->has("padding"))
+		if (elem->has(ThemeProperties::PADDING))
 		{
 			Vector2f scale = getParent() ? getParent()->getSize() : Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 			
-			auto padding = elem->get<Vector4f>("padding");
+			auto padding = elem->get<Vector4f>(ThemeProperties::PADDING);
 			if (padding.x() < 1 && padding.y() < 1 && padding.z() < 1 && padding.w() < 1)
 				mPadding = padding * Vector4f(scale.x(), scale.y(), scale.x(), scale.y());
 			else 
@@ -550,27 +584,27 @@ void TextComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const st
 
 	if (properties & TEXT)
 	{
-		if (elem->has("text"))
+		if (elem->has(ThemeProperties::TEXT))
 		{
-			mSourceText = elem->get<std::string>("text");
+			mSourceText = elem->get<std::string>(ThemeProperties::TEXT);
 			setText(mSourceText);
 		}
 		else
 			mSourceText = "";
 	}
 
-	if(properties & FORCE_UPPERCASE && elem->has("forceUppercase"))
-		setUppercase(elem->get<bool>("forceUppercase"));
+	if(properties & FORCE_UPPERCASE && elem->has(ThemeProperties::FORCE_UPPERCASE))
+		setUppercase(elem->get<bool>(ThemeProperties::FORCE_UPPERCASE));
 
-	if(properties & LINE_SPACING && elem->has("lineSpacing"))
-		setLineSpacing(elem->get<float>("lineSpacing"));
+	if(properties & LINE_SPACING && elem->has(ThemeProperties::LINE_SPACING))
+		setLineSpacing(elem->get<float>(ThemeProperties::LINE_SPACING));
 
 	if (properties & COLOR)
 	{
-		if (elem->has("color"))
+		if (elem->has(ThemeProperties::COLOR))
 			setColor(elem->get<unsigned int>("color"));
 
-		if (elem->has("backgroundColor"))
+		if (elem->has(ThemeProperties::BACKGROUND_COLOR))
 		{
 			setBackgroundColor(elem->get<unsigned int>("backgroundColor"));
 			setRenderBackground(true);
@@ -578,32 +612,32 @@ void TextComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const st
 		else 
 			setRenderBackground(false);
 
-		if (elem->has("glowColor"))
+		if (elem->has(ThemeProperties::GLOW_COLOR))
 			mGlowColor = elem->get<unsigned int>("glowColor");
 		else
 			mGlowColor = 0;
 
-		if (elem->has("glowSize"))
-			mGlowSize = (int)elem->get<float>("glowSize");
+		if (elem->has(ThemeProperties::GLOW_SIZE))
+			mGlowSize = (int)elem->get<float>(ThemeProperties::GLOW_SIZE);
 
-		if (elem->has("glowOffset"))
-			mGlowOffset = elem->get<Vector2f>("glowOffset");
+		if (elem->has(ThemeProperties::GLOW_OFFSET))
+			mGlowOffset = elem->get<Vector2f>(ThemeProperties::GLOW_OFFSET);
 
-		if (elem->has("reflexion"))
-			mReflection = elem->get<Vector2f>("reflexion");
+		if (elem->has(ThemeProperties::REFLEXION))
+			mReflection = elem->get<Vector2f>(ThemeProperties::REFLEXION);
 		else
 			mReflection = Vector2f::Zero();
 
-		if (elem->has("reflexionOnFrame"))
-			mReflectOnBorders = elem->get<bool>("reflexionOnFrame");
+		if (elem->has(ThemeProperties::REFLEXION_ON_FRAME))
+			mReflectOnBorders = elem->get<bool>(ThemeProperties::REFLEXION_ON_FRAME);
 		else
 			mReflectOnBorders = false;
 
-		if (elem->has("singleLineScroll"))
-			setAutoScroll(elem->get<bool>("singleLineScroll"));
-		else if (elem->has("autoScroll"))
+		if (elem->has(ThemeProperties::SINGLE_LINE_SCROLL))
+			setAutoScroll(elem->get<bool>(ThemeProperties::SINGLE_LINE_SCROLL));
+		else if (elem->has(ThemeProperties::AUTO_SCROLL))
 		{
-			auto autoScroll = elem->get<std::string>("autoScroll");
+			auto autoScroll = elem->get<std::string>(ThemeProperties::AUTO_SCROLL);
 			if (autoScroll == "horizontal")
 				setAutoScroll(AutoScrollType::HORIZONTAL);
 			else if (autoScroll == "vertical")
@@ -629,6 +663,7 @@ void TextComponent::setAutoScroll(AutoScrollType value)
 		return;
 
 	mAutoScroll = value;
+	setUpdateActive(mAutoScroll != AutoScrollType::NONE);
 	onSizeChanged();	
 }
 
@@ -641,7 +676,7 @@ void TextComponent::setMultiLine(MultiLineType value)
 	onTextChanged();
 }
 
-ThemeData::ThemeElement::Property TextComponent::getProperty(const std::string name)
+ThemeData::ThemeElement::Property TextComponent::getProperty(const std::string& name)
 {
 	Vector2f scale = getParent() ? getParent()->getSize() : Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 
@@ -669,7 +704,7 @@ ThemeData::ThemeElement::Property TextComponent::getProperty(const std::string n
 	return GuiComponent::getProperty(name);
 }
 
-void TextComponent::setProperty(const std::string name, const ThemeData::ThemeElement::Property& value)
+void TextComponent::setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value)
 {
 	Vector2f scale = getParent() ? getParent()->getSize() : Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 
@@ -69,8 +69,8 @@ public:
 
 	std::string getOriginalThemeText() { return mSourceText; }
 
-	ThemeData::ThemeElement::Property getProperty(const std::string name) override;
-	void setProperty(const std::string name, const ThemeData::ThemeElement::Property& value) override;
+	ThemeData::ThemeElement::Property getProperty(const std::string& name) override;
+	void setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value) override;
 
 	virtual void onShow() override;
 
@@ -96,6 +96,7 @@ protected:
 
 private:	
 	void onColorChanged();
+	void updateMarquee(int deltaTime);
 
 	unsigned int mColor;
 	unsigned int mBgColor;
@@ -105,6 +106,7 @@ private:
 	bool mUppercase;
 	
 	std::shared_ptr<TextCache> mTextCache;
+	std::shared_ptr<TextCache> mRecycledTextCache;
 	Alignment mHorizontalAlignment;
 	Alignment mVerticalAlignment;
 	float mLineSpacing;
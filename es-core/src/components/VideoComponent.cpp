@@ -1,8 +1,11 @@
 #include "components/VideoComponent.h"
 
 #include "resources/ResourceManager.h"
+#include "resources/TextureResource.h"
+#include "resources/VideoPosterCache.h"
 #include "utils/FileSystemUtil.h"
 #include "PowerSaver.h"
+#include "WakeScheduler.h"
 #include "ThemeData.h"
 #include "Window.h"
 #include <SDL_timer.h>
@@ -10,6 +13,7 @@
 #include "Paths.h"
 
 #define FADE_TIME_MS	400
+#define POSTER_LOOP_DELAY_MS	300
 
 std::string getTitlePath() 
 {
@@ -31,7 +35,7 @@ void writeSubtitle(const char* gameName, const char* systemName, bool always)
 	FILE* file = fopen(getTitlePath().c_str(), "w");
 	if (file)
 	{
-		int end = (int)(Settings::getInstance()->getInt("ScreenSaverSwapVideoTimeout") / (1000));
+		int end = (int)(Settings::get(IntSetting::ScreenSaverSwapVideoTimeout) / (1000));
 		if (always)
 			fprintf(file, "1\n00:00:01,000 --> 00:00:%d,000\n", end);
 		else
@@ -67,7 +71,12 @@ VideoComponent::VideoComponent(Window* window) :
 	mTargetIsMax(false),
 	mTargetIsMin(false),
 	mTargetSize(0, 0),
-	mPlayAudio(true)
+	mPlayAudio(true),
+	mPoster(window, true),
+	mHasPoster(false),
+	mLoopLoaded(false),
+	mLoopFrame(-1),
+	mPosterTime(0)
 {
 	mScaleOrigin = Vector2f::Zero();
 
@@ -78,6 +87,7 @@ VideoComponent::VideoComponent(Window* window) :
 	mIsWaitingForVideoToStart = false;
 
 	mStaticImage.setAllowFading(false);
+	mPoster.setAllowFading(false);
 
 	// Setup the default configuration
 	mConfig.showSnapshotDelay 		= false;
@@ -101,18 +111,21 @@ void VideoComponent::onOriginChanged()
 {
 	GuiComponent::onOriginChanged();
 	mStaticImage.setOrigin(mOrigin);
+	mPoster.setOrigin(mOrigin);
 }
 
 void VideoComponent::onPositionChanged()
 {
 	GuiComponent::onPositionChanged();
 	mStaticImage.setPosition(mPosition);
+	mPoster.setPosition(mPosition);
 }
 
 void VideoComponent::onSizeChanged()
 {
 	GuiComponent::onSizeChanged();
 	mStaticImage.onSizeChanged();
+	mPoster.onSizeChanged();
 }
 
 bool VideoComponent::setVideo(std::string path, bool checkFileExists)
@@ -213,6 +226,13 @@ void VideoComponent::render(const Transform4x4f& parentTrans)
 
 void VideoComponent::renderSnapshot(const Transform4x4f& parentTrans)
 {
+	// Instead of an empty slot until VLC shows the first frame. The video fades in over it
+	if (mHasPoster && !mVideoPath.empty() && !mConfig.showSnapshotDelay && (!mIsPlaying || mFadeIn < 1.0))
+	{
+		mPoster.setOpacity(getOpacity());
+		mPoster.render(parentTrans);
+	}
+
 	// This is the case where the video is not currently being displayed. Work out
 	// if we need to display a static image
 	if ((mConfig.showSnapshotNoVideo && mVideoPath.empty()) || ((mStartDelayed || mFadeIn < 1.0) && mConfig.showSnapshotDelay))
@@ -258,49 +278,49 @@ void VideoComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const s
 	Vector2f screenScale = Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 	Vector2f scale = getParent() ? getParent()->getSize() : screenScale;
 
-	if ((properties & POSITION) && elem->has("pos"))
+	if ((properties & POSITION) && elem->has(ThemeProperties::POS))
 	{
-		Vector2f denormalized = elem->get<Vector2f>("pos") * scale;
+		Vector2f denormalized = elem->get<Vector2f>(ThemeProperties::POS) * scale;
 		setPosition(Vector3f(denormalized.x(), denormalized.y(), 0));
 	}
 
-	if (properties & POSITION && elem->has("x"))
+	if (properties & POSITION && elem->has(ThemeProperties::X))
 	{
-		float denormalized = elem->get<float>("x") * scale.x();
+		float denormalized = elem->get<float>(ThemeProperties::X) * scale.x();
 		setPosition(Vector3f(denormalized, mPosition.y(), 0));
 	}
 
-	if (properties & POSITION && elem->has("y"))
+	if (properties & POSITION && elem->has(ThemeProperties::Y))
 	{
-		float denormalized = elem->get<float>("y") * scale.y();
+		float denormalized = elem->get<float>(ThemeProperties::Y) * scale.y();
 		setPosition(Vector3f(mPosition.x(), denormalized, 0));
 	}
 
 	if(properties & ThemeFlags::SIZE)
 	{
-		if (elem->has("size"))
+		if (elem->has(ThemeProperties::SIZE))
 		{
-			mSize = elem->get<Vector2f>("size") * scale;
+			mSize = elem->get<Vector2f>(ThemeProperties::SIZE) * scale;
 			setResize(mSize);
 		}
-		else if (elem->has("maxSize"))
+		else if (elem->has(ThemeProperties::MAX_SIZE))
 		{
-			mSize = elem->get<Vector2f>("maxSize") * scale;
+			mSize = elem->get<Vector2f>(ThemeProperties::MAX_SIZE) * scale;
 			setMaxSize(mSize);
 		}
-		else if (elem->has("minSize"))
+		else if (elem->has(ThemeProperties::MIN_SIZE))
 		{
-			mSize = elem->get<Vector2f>("minSize") * scale;
+			mSize = elem->get<Vector2f>(ThemeProperties::MIN_SIZE) * scale;
 			setMinSize(mSize);
 		}
 	}
 
 	// position + size also implies origin
-	if (((properties & ORIGIN) || ((properties & POSITION) && (properties & ThemeFlags::SIZE))) && elem->has("origin"))
-		setOrigin(elem->get<Vector2f>("origin"));
+	if (((properties & ORIGIN) || ((properties & POSITION) && (properties & ThemeFlags::SIZE))) && elem->has(ThemeProperties::ORIGIN))
+		setOrigin(elem->get<Vector2f>(ThemeProperties::ORIGIN));
 
-	if(elem->has("default"))
-		mConfig.defaultVideoPath = elem->get<std::string>("default");
+	if(elem->has(ThemeProperties::DEFAULT))
+		mConfig.defaultVideoPath = elem->get<std::string>(ThemeProperties::DEFAULT);
 
 	if((properties & ThemeFlags::DELAY) && elem->has("delay"))
 		mConfig.startDelay = (unsigned)(elem->get<float>("delay") * 1000.0f);
@@ -336,19 +356,19 @@ void VideoComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const s
 
 	if(properties & ThemeFlags::ROTATION) 
 	{
-		if(elem->has("rotation"))
-			setRotationDegrees(elem->get<float>("rotation"));
-		if(elem->has("rotationOrigin"))
-			setRotationOrigin(elem->get<Vector2f>("rotationOrigin"));
+		if(elem->has(ThemeProperties::ROTATION))
+			setRotationDegrees(elem->get<float>(ThemeProperties::ROTATION));
+		if(elem->has(ThemeProperties::ROTATION_ORIGIN))
+			setRotationOrigin(elem->get<Vector2f>(ThemeProperties::ROTATION_ORIGIN));
 	}
 
-	if(properties & ThemeFlags::Z_INDEX && elem->has("zIndex"))
-		setZIndex(elem->get<float>("zIndex"));
+	if(properties & ThemeFlags::Z_INDEX && elem->has(ThemeProperties::Z_INDEX))
+		setZIndex(elem->get<float>(ThemeProperties::Z_INDEX));
 	else
 		setZIndex(getDefaultZIndex());
 
-	if(properties & ThemeFlags::VISIBLE && elem->has("visible"))
-		setVisible(elem->get<bool>("visible"));
+	if(properties & ThemeFlags::VISIBLE && elem->has(ThemeProperties::VISIBLE))
+		setVisible(elem->get<bool>(ThemeProperties::VISIBLE));
 	else
 		setVisible(true);
 
@@ -357,9 +377,9 @@ void VideoComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const s
 	else
 		setPlayAudio(true);
 
-	if (elem->has("path"))
+	if (elem->has(ThemeProperties::PATH))
 	{
-		auto path = elem->get<std::string>("path");
+		auto path = elem->get<std::string>(ThemeProperties::PATH);
 
 		if (Utils::FileSystem::exists(path))
 			mVideoPath = path;
@@ -367,34 +387,34 @@ void VideoComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const s
 			mVideoPath = mConfig.defaultVideoPath;
 	}
 
-	if (properties & POSITION && elem->has("offset"))
+	if (properties & POSITION && elem->has(ThemeProperties::OFFSET))
 	{
-		Vector2f denormalized = elem->get<Vector2f>("offset") * screenScale;
+		Vector2f denormalized = elem->get<Vector2f>(ThemeProperties::OFFSET) * screenScale;
 		mScreenOffset = denormalized;
 	}
 
-	if (properties & POSITION && elem->has("offsetX"))
+	if (properties & POSITION && elem->has(ThemeProperties::OFFSET_X))
 	{
-		float denormalized = elem->get<float>("offsetX") * screenScale.x();
+		float denormalized = elem->get<float>(ThemeProperties::OFFSET_X) * screenScale.x();
 		mScreenOffset = Vector2f(denormalized, mScreenOffset.y());
 	}
 
-	if (properties & POSITION && elem->has("offsetY"))
+	if (properties & POSITION && elem->has(ThemeProperties::OFFSET_Y))
 	{
-		float denormalized = elem->get<float>("offsetY") * scale.y();
+		float denormalized = elem->get<float>(ThemeProperties::OFFSET_Y) * scale.y();
 		mScreenOffset = Vector2f(mScreenOffset.x(), denormalized);
 	}
 
-	if (properties & POSITION && elem->has("clipRect"))
+	if (properties & POSITION && elem->has(ThemeProperties::CLIP_RECT))
 	{
-		Vector4f val = elem->get<Vector4f>("clipRect") * Vector4f(screenScale.x(), screenScale.y(), screenScale.x(), screenScale.y());
+		Vector4f val = elem->get<Vector4f>(ThemeProperties::CLIP_RECT) * Vector4f(screenScale.x(), screenScale.y(), screenScale.x(), screenScale.y());
 		setClipRect(val);
 	}
 	else
 		setClipRect(Vector4f());
 
-	if (elem->has("onclick"))
-		setClickAction(elem->get<std::string>("onclick"));
+	if (elem->has(ThemeProperties::ONCLICK))
+		setClickAction(elem->get<std::string>(ThemeProperties::ONCLICK));
 	else
 		setClickAction("");
 
@@ -490,6 +510,11 @@ void VideoComponent::startVideoWithDelay()
 void VideoComponent::update(int deltaTime)
 {
 	manageState();
+	updatePoster(deltaTime);
+
+	// The delayed start is checked in manageState, and the snapshot fades out before it
+	if (mStartDelayed)
+		WakeScheduler::requestFrameAt(mStartTime > FADE_TIME_MS ? mStartTime - FADE_TIME_MS : 0);
 
 	if (mIsPlaying)
 	{
@@ -522,6 +547,81 @@ void VideoComponent::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+void VideoComponent::loadPoster()
+{
+	mPosterPath = mVideoPath;
+	mHasPoster = false;
+	mLoopLoaded = false;
+	mLoopFrame = -1;
+	mPosterTime = 0;
+	mLoopPixels.reset();
+
+	if (mVideoPath.empty() || !VideoPosterCache::isEnabled())
+		return;
+
+	TextureDiskCache::Image image;
+	if (!VideoPosterCache::loadPoster(mVideoPath, image))
+	{
+		// Ready for the next time the cursor lands here
+		VideoPosterCache::queue(mVideoPath);
+		return;
+	}
+
+	mPosterPixels = std::move(image.buffer);
+
+	if (mPosterTexture == nullptr)
+		mPosterTexture = TextureResource::get("", false, true);
+
+	mPosterTexture->updateFromExternalPixels(mPosterPixels.get(), image.width, image.height);
+	mPoster.setImage(mPosterTexture);
+	mHasPoster = true;
+}
+
+void VideoComponent::updatePoster(int deltaTime)
+{
+	if (mPosterPath != mVideoPath)
+		loadPoster();
+
+	if (!mHasPoster || (mIsPlaying && mFadeIn >= 1.0f))
+		return;
+
+	// The loop starts once the cursor stays on the game : fast scrolling only shows the posters
+	mPosterTime += deltaTime;
+	if (mPosterTime < POSTER_LOOP_DELAY_MS)
+		return;
+
+	if (!mLoopLoaded)
+	{
+		mLoopLoaded = true;
+
+		TextureDiskCache::Image image;
+		if (!VideoPosterCache::loadLoop(mVideoPath, image))
+			return;
+
+		mLoopPixels = std::move(image.buffer);
+		mLoopFrameSize = image.packedSize;
+
+		if (mLoopTexture == nullptr)
+			mLoopTexture = TextureResource::get("", false, true);
+	}
+
+	if (mLoopPixels == nullptr)
+		return;
+
+	int frame = ((mPosterTime - POSTER_LOOP_DELAY_MS) / VideoPosterCache::LOOP_FRAME_MS) % VideoPosterCache::LOOP_FRAMES;
+	if (frame == mLoopFrame)
+		return;
+
+	size_t frameBytes = (size_t)mLoopFrameSize.x() * mLoopFrameSize.y() * 4;
+	mLoopTexture->updateFromExternalPixels(mLoopPixels.get() + frame * frameBytes, mLoopFrameSize.x(), mLoopFrameSize.y());
+
+	// Same aspect ratio as the poster, the image keeps its size
+	if (mLoopFrame < 0)
+		mPoster.setImage(mLoopTexture);
+
+	mLoopFrame = frame;
+}
+
 void VideoComponent::manageState()
 {
 	if (mIsWaitingForVideoToStart && mIsPlaying)
@@ -625,9 +725,10 @@ void VideoComponent::setRoundCorners(float value)
 { 
 	mRoundCorners = value; 
 	mStaticImage.setRoundCorners(value);
+	mPoster.setRoundCorners(value);
 }
 
-ThemeData::ThemeElement::Property VideoComponent::getProperty(const std::string name)
+ThemeData::ThemeElement::Property VideoComponent::getProperty(const std::string& name)
 {
 	if (name == "path")
 		return mVideoPath;
@@ -635,7 +736,7 @@ ThemeData::ThemeElement::Property VideoComponent::getProperty(const std::string
 	return GuiComponent::getProperty(name);
 }
 
-void VideoComponent::setProperty(const std::string name, const ThemeData::ThemeElement::Property& value)
+void VideoComponent::setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value)
 {
 	GuiComponent::setProperty(name, value);
 
@@ -658,6 +759,7 @@ void VideoComponent::setClipRect(const Vector4f& vec)
 {
 	GuiComponent::setClipRect(vec);
 	mStaticImage.setClipRect(vec);
+	mPoster.setClipRect(vec);
 }
 
 bool VideoComponent::showSnapshots()
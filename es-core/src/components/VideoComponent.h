@@ -117,6 +117,7 @@ public:
 	};
 
 	ImageSource getSnapshotSource() { return mConfig.snapshotSource; };
+	ImageComponent* getSnapshotImage() { return &mStaticImage; }
 	void setSnapshotSource(ImageSource source) { mConfig.snapshotSource = source; };
 
 	inline void setOnVideoEnded(const std::function<bool()>& callback) {
@@ -152,8 +153,8 @@ public:
 	bool getPlayAudio() { return mPlayAudio; }
 	void setPlayAudio(bool value) { mPlayAudio = value; }
 
-	ThemeData::ThemeElement::Property getProperty(const std::string name) override;
-	void setProperty(const std::string name, const ThemeData::ThemeElement::Property& value) override;
+	ThemeData::ThemeElement::Property getProperty(const std::string& name) override;
+	void setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value) override;
 
 	virtual void setClipRect(const Vector4f& vec);
 
@@ -188,6 +189,10 @@ private:
 	// Manage the playing state of the component
 	void manageState();
 
+	// Poster & loop of the video from VideoPosterCache, shown until the video fades in
+	void loadPoster();
+	void updatePoster(int deltaTime);
+
 protected:
 	unsigned						mVideoWidth;
 	unsigned						mVideoHeight;
@@ -214,6 +219,19 @@ protected:
 	float							mRoundCorners;
 
 	Configuration					mConfig;
+
+	// The textures point to the pixels : declared first, destroyed last
+	PixelBuffer						mPosterPixels;
+	PixelBuffer						mLoopPixels;
+	Vector2i						mLoopFrameSize;
+	std::shared_ptr<TextureResource> mPosterTexture;
+	std::shared_ptr<TextureResource> mLoopTexture;
+	ImageComponent					mPoster;
+	std::string						mPosterPath;
+	bool							mHasPoster;
+	bool							mLoopLoaded;
+	int								mLoopFrame;
+	int								mPosterTime;
 };
 
 #endif // ES_CORE_COMPONENTS_VIDEO_COMPONENT_H
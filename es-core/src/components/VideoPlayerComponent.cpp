@@ -46,6 +46,7 @@ void VideoPlayerComponent::setResize(float width, float height)
 	mTargetSize = Vector2f(width, height);
 	mTargetIsMax = false;
 	mStaticImage.setResize(width, height);
+	mPoster.setResize(width, height);
 	onSizeChanged();
 }
 
@@ -55,6 +56,7 @@ void VideoPlayerComponent::setMaxSize(float width, float height)
 	mTargetSize = Vector2f(width, height);
 	mTargetIsMax = true;
 	mStaticImage.setMaxSize(width, height);
+	mPoster.setMaxSize(width, height);
 	onSizeChanged();
 }
 
@@ -64,6 +66,7 @@ void VideoPlayerComponent::setMinSize(float width, float height)
 	mTargetSize = Vector2f(width, height);
 	mTargetIsMax = false;
 	mStaticImage.setMinSize(width, height);
+	mPoster.setMinSize(width, height);
 	onSizeChanged();
 
 	// TODO add cropping with  --crop 100,100,300,300
@@ -174,8 +177,8 @@ void VideoPlayerComponent::startVideo()
 				const char* argv[] = { "", "--layer", "10010", "--loop", "--no-osd", "--aspect-mode", "letterbox", "--vol", "0", "-o", "both","--win", buf1, "--orientation", buf2, "", "", "", "", NULL };
 
 				// check if we want to mute the audio
-				if (!getPlayAudio() || !Settings::getInstance()->getBool("VideoAudio") || (float)VolumeControl::getInstance()->getVolume() == 0 ||
-					(Settings::getInstance()->getBool("ScreenSaverVideoMute") && mScreensaverMode))
+				if (!getPlayAudio() || !Settings::get(BoolSetting::VideoAudio) || (float)VolumeControl::getInstance()->getVolume() == 0 ||
+					(Settings::get(BoolSetting::ScreenSaverVideoMute) && mScreensaverMode))
 				{
 					argv[8] = "-1000000";
 				}
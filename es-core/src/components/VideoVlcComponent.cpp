@@ -18,11 +18,21 @@
 #endif
 
 #include "ImageIO.h"
+#include "VideoHardwareDecode.h"
 
 #define MATHPI          3.141592653589793238462643383279502884L
 
+// Idle media players kept for the next videos, and videos opened ahead of the selection
+#define PLAYER_POOL_SIZE	2
+#define PREFETCH_MEDIAS		2
+#define PREFETCH_TIMEOUT_MS	3000
+
 libvlc_instance_t* VideoVlcComponent::mVLC = NULL;
 
+std::mutex VideoVlcComponent::mPoolLock;
+std::vector<libvlc_media_player_t*> VideoVlcComponent::mPlayerPool;
+std::vector<std::pair<std::string, libvlc_media_t*>> VideoVlcComponent::mPrefetchedMedias;
+
 // VLC prepares to render a video frame.
 static void *lock(void *data, void **p_pixels) 
 {
@@ -32,10 +42,34 @@ static void *lock(void *data, void **p_pixels)
 	
 	c->mutexes[frame].lock();
 	c->hasFrame[frame] = false;
-	*p_pixels = c->surfaces[frame];
+	p_pixels[0] = c->surfaces[frame];
+
+	if (c->yuv)
+	{
+		p_pixels[1] = c->surfaces[frame] + c->width * c->height;
+		p_pixels[2] = (unsigned char*)p_pixels[1] + (c->width / 2) * (c->height / 2);
+	}
+
 	return NULL; // Picture identifier, not needed here.
 }
 
+// VLC asks for the frame format ( I420 mode ) : the planes have their own pitches, which libvlc_video_set_format can't give
+static unsigned setupYuvFormat(void** data, char* chroma, unsigned* width, unsigned* height, unsigned* pitches, unsigned* lines)
+{
+	struct VideoContext *c = (struct VideoContext *)*data;
+
+	memcpy(chroma, "I420", 4);
+	*width = c->width;
+	*height = c->height;
+
+	pitches[0] = c->width;
+	pitches[1] = pitches[2] = c->width / 2;
+	lines[0] = c->height;
+	lines[1] = lines[2] = c->height / 2;
+
+	return 1;
+}
+
 // VLC just rendered a video frame.
 static void unlock(void *data, void* /*id*/, void *const* /*p_pixels*/) 
 {
@@ -65,6 +99,7 @@ VideoVlcComponent::VideoVlcComponent(Window* window) :
 	mMedia(nullptr)
 {
 	mSaturation = 1.0f;
+	mHardwareDecode = false;
 	mElapsed = 0;
 	mColorShift = 0xFFFFFFFF;
 	mLinearSmooth = false;
@@ -94,6 +129,7 @@ void VideoVlcComponent::setResize(float width, float height)
 	mTargetIsMax = false;
 	mTargetIsMin = false;
 	mStaticImage.setResize(width, height);
+	mPoster.setResize(width, height);
 	resize();
 }
 
@@ -106,6 +142,7 @@ void VideoVlcComponent::setMaxSize(float width, float height)
 	mTargetIsMax = true;
 	mTargetIsMin = false;
 	mStaticImage.setMaxSize(width, height);
+	mPoster.setMaxSize(width, height);
 	resize();
 }
 
@@ -118,6 +155,7 @@ void VideoVlcComponent::setMinSize(float width, float height)
 	mTargetIsMax = false;
 	mTargetIsMin = true;
 	mStaticImage.setMinSize(width, height);
+	mPoster.setMinSize(width, height);
 	resize();
 }
 
@@ -257,11 +295,14 @@ void VideoVlcComponent::render(const Transform4x4f& parentTrans)
 #ifdef _RPI_
 			// Rpi : A lot of videos are encoded in 60fps on screenscraper
 			// Try to limit transfert to opengl textures to 30fps to save CPU
-			if (!Settings::getInstance()->getBool("OptimizeVideo") || mElapsed >= 40) // 40ms = 25fps, 33.33 = 30 fps
+			if (!Settings::get(BoolSetting::OptimizeVideo) || mElapsed >= 40) // 40ms = 25fps, 33.33 = 30 fps
 #endif
 			{
 				mContext.mutexes[frame].lock();
-				mTexture->updateFromExternalPixels(mContext.surfaces[frame], mVideoWidth, mVideoHeight);
+				if (mContext.yuv)
+					mTexture->updateFromExternalYUV(mContext.surfaces[frame], mVideoWidth, mVideoHeight);
+				else
+					mTexture->updateFromExternalPixels(mContext.surfaces[frame], mVideoWidth, mVideoHeight);
 				mContext.hasFrame[frame] = false;
 				mContext.mutexes[frame].unlock();
 
@@ -386,9 +427,13 @@ void VideoVlcComponent::setupContext()
 	if (mContext.valid)
 		return;
 	
-	// Create an RGBA surface to render the video into
-	mContext.surfaces[0] = new unsigned char[mVideoWidth * mVideoHeight * 4];
-	mContext.surfaces[1] = new unsigned char[mVideoWidth * mVideoHeight * 4];
+	// Create an RGBA ( or I420 ) surface to render the video into
+	size_t frameSize = mContext.yuv ? mVideoWidth * mVideoHeight * 3 / 2 : mVideoWidth * mVideoHeight * 4;
+
+	mContext.surfaces[0] = new unsigned char[frameSize];
+	mContext.surfaces[1] = new unsigned char[frameSize];
+	mContext.width = mVideoWidth;
+	mContext.height = mVideoHeight;
 	mContext.hasFrame[0] = false;	
 	mContext.hasFrame[1] = false;
 	mContext.component = this;
@@ -502,8 +547,151 @@ void VideoVlcComponent::init()
 	delete[] theArgs;
 }
 
+libvlc_media_t* VideoVlcComponent::createMedia(const std::string& path)
+{
+	libvlc_media_t* media = libvlc_media_new_path(mVLC, path.c_str());
+	if (media == nullptr)
+		return nullptr;
+
+	// use : vlc long-help
+	// Decoding backend first, vlc.options can override it
+	for (auto option : VideoHardwareDecode::getMediaOptions())
+		libvlc_media_add_option(media, option.c_str());
+
+	std::string options = SystemConf::getInstance()->get("vlc.options");
+	if (!options.empty())
+	{
+		std::vector<std::string> tokens = Utils::String::split(options, ' ');
+		for (auto token : tokens)
+			libvlc_media_add_option(media, token.c_str());
+	}
+
+	return media;
+}
+
+void VideoVlcComponent::prefetch(const std::string& path)
+{
+#if LIBVLC_VERSION_MAJOR >= 3
+	if (mVLC == nullptr || path.empty() || !Utils::FileSystem::exists(path))
+		return;
+
+#ifdef WIN32
+	std::string vlcPath(Utils::String::replace(path, "/", "\\"));
+#else
+	std::string vlcPath(path);
+#endif
+
+	std::unique_lock<std::mutex> lock(mPoolLock);
+
+	for (auto& it : mPrefetchedMedias)
+		if (it.first == vlcPath)
+			return;
+
+	libvlc_media_t* media = createMedia(vlcPath);
+	if (media == nullptr)
+		return;
+
+	// The track list is read by the VLC preparser thread, the local file only
+	libvlc_media_parse_with_options(media, libvlc_media_parse_local, PREFETCH_TIMEOUT_MS);
+
+	mPrefetchedMedias.push_back(std::make_pair(vlcPath, media));
+
+	// The oldest guesses are the least likely
+	while (mPrefetchedMedias.size() > PREFETCH_MEDIAS)
+	{
+		libvlc_media_parse_stop(mPrefetchedMedias.front().second);
+		libvlc_media_release(mPrefetchedMedias.front().second);
+		mPrefetchedMedias.erase(mPrefetchedMedias.begin());
+	}
+#endif
+}
+
+libvlc_media_t* VideoVlcComponent::takePrefetchedMedia(const std::string& path)
+{
+#if LIBVLC_VERSION_MAJOR >= 3
+	std::unique_lock<std::mutex> lock(mPoolLock);
+
+	for (auto it = mPrefetchedMedias.begin(); it != mPrefetchedMedias.end(); ++it)
+	{
+		if (it->first != path)
+			continue;
+
+		libvlc_media_t* media = it->second;
+		mPrefetchedMedias.erase(it);
+
+		// Still parsing : a synchronous parse of a fresh media is more predictable than waiting for this one
+		if (libvlc_media_get_parsed_status(media) != libvlc_media_parsed_status_done)
+		{
+			libvlc_media_parse_stop(media);
+			libvlc_media_release(media);
+			return nullptr;
+		}
+
+		return media;
+	}
+#endif
+	return nullptr;
+}
+
+libvlc_media_player_t* VideoVlcComponent::acquirePlayer(libvlc_media_t* media, bool video)
+{
+	// The pooled players still have the frame callbacks of their last video
+	if (video)
+	{
+		std::unique_lock<std::mutex> lock(mPoolLock);
+
+		if (mPlayerPool.size())
+		{
+			libvlc_media_player_t* player = mPlayerPool.back();
+			mPlayerPool.pop_back();
+
+			libvlc_media_player_set_media(player, media);
+			libvlc_audio_set_mute(player, 0);
+			return player;
+		}
+	}
+
+	return libvlc_media_player_new_from_media(media);
+}
+
+void VideoVlcComponent::releasePlayer(libvlc_media_player_t* player, bool reusable)
+{
+	// Synchronous : no more frame callbacks to the previous context once stopped
+	libvlc_media_player_stop(player);
+
+	if (reusable)
+	{
+		std::unique_lock<std::mutex> lock(mPoolLock);
+
+		if (mPlayerPool.size() < PLAYER_POOL_SIZE)
+		{
+			mPlayerPool.push_back(player);
+			return;
+		}
+	}
+
+	libvlc_media_player_release(player);
+}
+
+void VideoVlcComponent::benchmarkDecoders(const std::string& samplePath)
+{
+	init();
+	VideoHardwareDecode::benchmark(mVLC, samplePath);
+}
+
 void VideoVlcComponent::handleLooping()
 {
+	// The hardware decoder failed : start over with software decoding
+	if (mMediaPlayer && mHardwareDecode && libvlc_media_player_get_state(mMediaPlayer) == libvlc_Error)
+	{
+		VideoHardwareDecode::reportFailure();
+
+		stopVideo();
+		mIsWaitingForVideoToStart = true;
+		startVideo();
+		return;
+	}
+
 	if (mIsPlaying && mMediaPlayer)
 	{
 		libvlc_state_t state = libvlc_media_player_get_state(mMediaPlayer);
@@ -546,7 +734,7 @@ void VideoVlcComponent::handleLooping()
 				}
 			}
 
-			if (!getPlayAudio() || (!mScreensaverMode && !Settings::getInstance()->getBool("VideoAudio")) || (Settings::getInstance()->getBool("ScreenSaverVideoMute") && mScreensaverMode))
+			if (!getPlayAudio() || (!mScreensaverMode && !Settings::get(BoolSetting::VideoAudio)) || (Settings::get(BoolSetting::ScreenSaverVideoMute) && mScreensaverMode))
 				libvlc_audio_set_mute(mMediaPlayer, 1);
 
 			//libvlc_media_player_set_position(mMediaPlayer, 0.0f);
@@ -582,22 +770,19 @@ void VideoVlcComponent::startVideo()
 		// Set the video that we are going to be playing so we don't attempt to restart it
 		mPlayingVideoPath = mVideoPath;
 
-		// Open the media
-		mMedia = libvlc_media_new_path(mVLC, path.c_str());
-		if (mMedia)
-		{			
-			// use : vlc long-help
-			// WIN32 ? libvlc_media_add_option(mMedia, ":avcodec-hw=dxva2");
-			// RPI/OMX ? libvlc_media_add_option(mMedia, ":codec=mediacodec,iomx,all"); .
+		// Open the media, already parsed if it was prefetched
+		bool parsed = true;
+		mHardwareDecode = VideoHardwareDecode::isHardwareActive();
 
-			std::string options = SystemConf::getInstance()->get("vlc.options");
-			if (!options.empty())
-			{
-				std::vector<std::string> tokens = Utils::String::split(options, ' ');
-				for (auto token : tokens)
-					libvlc_media_add_option(mMedia, token.c_str());
-			}
-			
+		mMedia = takePrefetchedMedia(path);
+		if (mMedia == nullptr)
+		{
+			mMedia = createMedia(path);
+			parsed = false;
+		}
+
+		if (mMedia)
+		{
 			// If we have a playlist : most videos have a fader, skip it 1 second
 			if (mPlaylist != nullptr && mConfig.startDelay == 0 && !mConfig.showSnapshotDelay && !mConfig.showSnapshotNoVideo)
 				libvlc_media_add_option(mMedia, ":start-time=0.7");			
@@ -606,7 +791,9 @@ void VideoVlcComponent::startVideo()
 
 			unsigned track_count;
 			// Get the media metadata so we can find the aspect ratio
-			libvlc_media_parse(mMedia);
+			if (!parsed)
+				libvlc_media_parse(mMedia);
+
 			libvlc_media_track_t** tracks;
 			track_count = libvlc_media_tracks_get(mMedia, &tracks);
 			for (unsigned track = 0; track < track_count; ++track)
@@ -626,7 +813,7 @@ void VideoVlcComponent::startVideo()
 
 			if (mVideoWidth == 0 && mVideoHeight == 0 && Utils::FileSystem::isAudio(path))
 			{
-				if (getPlayAudio() && !mScreensaverMode && Settings::getInstance()->getBool("VideoAudio"))
+				if (getPlayAudio() && !mScreensaverMode && Settings::get(BoolSetting::VideoAudio))
 				{
 					// Make fake dimension to play audio files
 					mVideoWidth = 1;
@@ -637,7 +824,7 @@ void VideoVlcComponent::startVideo()
 			// Make sure we found a valid video track
 			if ((mVideoWidth > 0) && (mVideoHeight > 0))
 			{			
-				if (mVideoWidth > 1 && Settings::getInstance()->getBool("OptimizeVideo"))
+				if (mVideoWidth > 1 && Settings::get(BoolSetting::OptimizeVideo))
 				{
 					// Avoid videos bigger than resolution
 					Vector2f maxSize(Renderer::getScreenWidth(), Renderer::getScreenHeight());
@@ -662,15 +849,23 @@ void VideoVlcComponent::startVideo()
 					}
 				}
 
+				// The renderer converts I420 frames : VLC skips the RGB conversion, and the uploads are 2.7x smaller. The custom shaders expect RGBA
+				mContext.yuv = mVideoWidth > 1 && mCustomShader.path.empty() && Settings::get(BoolSetting::VideoYuvFrames) && Renderer::supportsYuvTextures();
+				if (mContext.yuv)
+				{
+					mVideoWidth = std::max(2u, mVideoWidth & ~1u);
+					mVideoHeight = std::max(2u, mVideoHeight & ~1u);
+				}
+
 				PowerSaver::pause();
 				setupContext();
 
 				// Setup the media player
-				mMediaPlayer = libvlc_media_player_new_from_media(mMedia);
+				mMediaPlayer = acquirePlayer(mMedia, mVideoWidth > 1);
 			
 				if (hasAudioTrack)
 				{
-					if (!getPlayAudio() || (!mScreensaverMode && !Settings::getInstance()->getBool("VideoAudio")) || (Settings::getInstance()->getBool("ScreenSaverVideoMute") && mScreensaverMode))
+					if (!getPlayAudio() || (!mScreensaverMode && !Settings::get(BoolSetting::VideoAudio)) || (Settings::get(BoolSetting::ScreenSaverVideoMute) && mScreensaverMode))
 						libvlc_audio_set_mute(mMediaPlayer, 1);
 					else
 						AudioManager::setVideoPlaying(true);
@@ -681,7 +876,11 @@ void VideoVlcComponent::startVideo()
 				if (mVideoWidth > 1)
 				{
 					libvlc_video_set_callbacks(mMediaPlayer, lock, unlock, display, (void*)&mContext);
-					libvlc_video_set_format(mMediaPlayer, "RGBA", (int)mVideoWidth, (int)mVideoHeight, (int)mVideoWidth * 4);
+
+					if (mContext.yuv)
+						libvlc_video_set_format_callbacks(mMediaPlayer, setupYuvFormat, nullptr);
+					else
+						libvlc_video_set_format(mMediaPlayer, "RGBA", (int)mVideoWidth, (int)mVideoHeight, (int)mVideoWidth * 4);
 				}
 			}
 		}
@@ -697,8 +896,8 @@ void VideoVlcComponent::stopVideo()
 	// Release the media player so it stops calling back to us
 	if (mMediaPlayer)
 	{
-		libvlc_media_player_stop(mMediaPlayer);
-		libvlc_media_player_release(mMediaPlayer);
+		// The players of the audio files have no frame callbacks, they can't be given to a video
+		releasePlayer(mMediaPlayer, mVideoWidth > 1);
 		mMediaPlayer = NULL;
 	}
 
@@ -785,7 +984,7 @@ void VideoVlcComponent::onShow()
 		pauseStoryboard();
 }
 
-ThemeData::ThemeElement::Property VideoVlcComponent::getProperty(const std::string name)
+ThemeData::ThemeElement::Property VideoVlcComponent::getProperty(const std::string& name)
 {
 	Vector2f scale = getParent() ? getParent()->getSize() : Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 
@@ -804,7 +1003,7 @@ ThemeData::ThemeElement::Property VideoVlcComponent::getProperty(const std::stri
 	return VideoComponent::getProperty(name);
 }
 
-void VideoVlcComponent::setProperty(const std::string name, const ThemeData::ThemeElement::Property& value)
+void VideoVlcComponent::setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value)
 {
 	Vector2f scale = getParent() ? getParent()->getSize() : Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 
@@ -21,6 +21,9 @@ struct VideoContext
 		hasFrame[0] = false;
 		hasFrame[1] = false;
 		surfaceId = 0;
+		yuv = false;
+		width = 0;
+		height = 0;
 	}
 
 	int					surfaceId;
@@ -30,6 +33,11 @@ struct VideoContext
 
 	VideoComponent*		component;
 	bool				valid;	
+
+	// I420 frames : the planes follow each other in the surfaces
+	bool				yuv;
+	unsigned int		width;
+	unsigned int		height;
 };
 
 
@@ -58,6 +66,12 @@ class VideoVlcComponent : public VideoComponent
 public:
 	static void init();
 
+	// Opens & parses a video that will likely be shown next, in the background. startVideo takes it ready to play
+	static void prefetch(const std::string& path);
+
+	// Selects the decoding backend ( "VideoHardwareDecode" auto ) by decoding this video with each one, in the background
+	static void benchmarkDecoders(const std::string& samplePath);
+
 	VideoVlcComponent(Window* window);
 	virtual ~VideoVlcComponent();
 
@@ -82,8 +96,8 @@ public:
 
 	virtual void onShow() override;
 
-	ThemeData::ThemeElement::Property getProperty(const std::string name) override;
-	void setProperty(const std::string name, const ThemeData::ThemeElement::Property& value) override;
+	ThemeData::ThemeElement::Property getProperty(const std::string& name) override;
+	void setProperty(const std::string& name, const ThemeData::ThemeElement::Property& value) override;
 
 	void setEffect(VideoVlcFlags::VideoVlcEffect effect) { mEffect = effect; }
 
@@ -113,8 +127,19 @@ private:
 	void setupContext();
 	void freeContext();
 
+	static libvlc_media_t* createMedia(const std::string& path);
+	static libvlc_media_t* takePrefetchedMedia(const std::string& path);
+
+	// Media players are reused between videos : creating one costs more than switching its media
+	static libvlc_media_player_t* acquirePlayer(libvlc_media_t* media, bool video);
+	static void releasePlayer(libvlc_media_player_t* player, bool reusable);
+
 private:
 	static libvlc_instance_t*		mVLC;
+
+	static std::mutex									mPoolLock;
+	static std::vector<libvlc_media_player_t*>			mPlayerPool;
+	static std::vector<std::pair<std::string, libvlc_media_t*>> mPrefetchedMedias;
 	libvlc_media_t*					mMedia;
 	libvlc_media_player_t*			mMediaPlayer;
 	VideoContext					mContext;
@@ -134,6 +159,7 @@ private:
 
 	bool							mLinearSmooth;
 	float							mSaturation;
+	bool							mHardwareDecode;
 };
 
 #endif // ES_CORE_COMPONENTS_VIDEO_VLC_COMPONENT_H
@@ -1,44 +1,8 @@
 #include "WebImageComponent.h"
 #include "utils/StringUtil.h"
 #include "HttpReq.h"
-#include "utils/ZipFile.h"
 #include "resources/TextureResource.h"
-#include "Paths.h"
-
-#include <algorithm>
-#include <cctype>
-#include <functional>
-
-struct url
-{
-public:
-	static url parse(const std::string& url_s)
-	{
-		url ret;
-
-		using namespace std;
-
-		const std::string prot_end("://");
-		std::string::const_iterator prot_i = search(url_s.begin(), url_s.end(), prot_end.begin(), prot_end.end());
-		ret.protocol.reserve(distance(url_s.begin(), prot_i));
-		transform(url_s.begin(), prot_i, back_inserter(ret.protocol), ptr_fun<int, int>(tolower));
-		if (prot_i == url_s.end())
-			return ret;
-
-		advance(prot_i, prot_end.length());
-		string::const_iterator path_i = find(prot_i, url_s.end(), '/');
-		ret.host.reserve(distance(prot_i, path_i));
-		transform(prot_i, path_i, back_inserter(ret.host), ptr_fun<int, int>(tolower)); // host is icase
-		string::const_iterator query_i = find(path_i, url_s.end(), '?');
-		ret.path.assign(path_i, query_i);
-		if (query_i != url_s.end())
-			++query_i;
-		ret.query.assign(query_i, url_s.end());
-		return ret;
-	}
-
-	std::string protocol, host, path, query;
-};
+#include "resources/WebImageCache.h"
 
 // keepInCacheDuration = 0 -> image expire immediately
 // keepInCacheDuration = -1 -> image expire never
@@ -46,11 +10,12 @@ public:
 // keepInCacheDuration = 86400 -> image expire in 24 hours ( 60*60*10 )
 
 WebImageComponent::WebImageComponent(Window* window, double keepInCacheDuration) : ImageComponent(window, false), 
-	mRequest(nullptr), mKeepInCacheDuration(keepInCacheDuration),
+	mKeepInCacheDuration(keepInCacheDuration),
 	mBusyAnim(nullptr)
 {
 	mWaitLoaded = false;
 	mOnLoaded = nullptr;
+	setUpdateAlways(true);
 }
 
 void WebImageComponent::resize()
@@ -71,35 +36,18 @@ void WebImageComponent::resize()
 
 WebImageComponent::~WebImageComponent()
 {
-	if (mRequest != nullptr)
-		delete mRequest;
+	mRequest.reset();
 
 	if (mBusyAnim != nullptr)
 		delete mBusyAnim;
 
-	if (mKeepInCacheDuration == 0 && Utils::FileSystem::exists(mLocalFile))
-	{
-		Utils::FileSystem::removeFile(mLocalFile);
-
-		auto root = Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/tmp");
-		auto file = Utils::FileSystem::getParent(Utils::FileSystem::getGenericPath(mLocalFile));
-
-		while (!file.empty() && file != root && file != mLocalFile)
-		{
-			Utils::FileSystem::removeFile(file);
-			file = Utils::FileSystem::getParent(file);
-		}
-	}
+	if (mKeepInCacheDuration == 0)
+		WebImageCache::remove(mLocalFile);
 }
 
 void WebImageComponent::setImage(const std::string& path, bool tile, MaxSizeInfo maxSize, bool checkFileExists, bool allowMultiImagePlaylist)
 {
-	if (mRequest != nullptr)
-	{
-		delete mRequest;
-		mRequest = nullptr;
-	}
-
+	mRequest.reset();
 	mWaitLoaded = true;
 
 	if (!Utils::String::startsWith(path, "http://") && !Utils::String::startsWith(path, "https://"))
@@ -114,48 +62,16 @@ void WebImageComponent::setImage(const std::string& path, bool tile, MaxSizeInfo
 		return;
 	}
 
-	url uri = url::parse(path);
-	if (uri.host.empty() || uri.path.empty())
+	std::string localFile = WebImageCache::getLocalFile(path);
+	if (localFile.empty())
 		return;
 
-	if (Utils::String::startsWith(uri.path, "/"))
-		uri.path = uri.path.substr(1);
-
-	std::string queryCrc;
-
-	if (!uri.query.empty())
-	{
-		auto file_crc32 = Utils::Zip::ZipFile::computeCRC(0, uri.query.data(), uri.query.size());
-		queryCrc = "-" + Utils::String::toHexString(file_crc32);
-	}
-
-	std::string localFile = Paths::getUserEmulationStationPath() + "/tmp/" + uri.host + "/" + uri.path + queryCrc;
-	if (Utils::FileSystem::exists(localFile))
+	// Expired files are kept for the revalidation
+	if (WebImageCache::isFresh(localFile, mKeepInCacheDuration))
 	{
-		bool keepLoadingLocal = true;
-
-		if (mKeepInCacheDuration == 0)
-		{
-			keepLoadingLocal = false;
-			Utils::FileSystem::removeFile(localFile);
-		}
-		else if (mKeepInCacheDuration > 0)
-		{
-			auto date = Utils::FileSystem::getFileCreationDate(localFile);
-			auto duration = Utils::Time::DateTime::now().elapsedSecondsSince(date);
-			if (duration > mKeepInCacheDuration)
-			{
-				keepLoadingLocal = false;
-				Utils::FileSystem::removeFile(localFile);
-			}
-		}
-
-		if (keepLoadingLocal)
-		{
-			ImageComponent::setImage(localFile, tile, maxSize, checkFileExists, allowMultiImagePlaylist);
-			resize();
-			return;
-		}
+		ImageComponent::setImage(localFile, tile, maxSize, checkFileExists, allowMultiImagePlaylist);
+		resize();
+		return;
 	}
 
 	mMaxSize = maxSize;
@@ -183,10 +99,10 @@ void WebImageComponent::update(int deltaTime)
 		mBusyAnim = nullptr;
 	}
 
-	delete mRequest;
-	mRequest = nullptr;	
+	bool loaded = WebImageCache::onCompleted(mRequest, mLocalFile);
+	mRequest.reset();
 
-	if (status == HttpReq::REQ_SUCCESS && Utils::FileSystem::exists(mLocalFile))
+	if (loaded)
 	{
 		ImageComponent::setImage(mLocalFile, false, mMaxSize, false);
 		resize();
@@ -212,11 +128,7 @@ void WebImageComponent::render(const Transform4x4f& parentTrans)
 
 	if (mRequest == nullptr && !mUrlToLoad.empty() && !mLocalFile.empty())
 	{
-		std::string localPath = Utils::FileSystem::getParent(mLocalFile);
-		if (!Utils::FileSystem::exists(localPath))
-			Utils::FileSystem::createDirectory(localPath);
-		
-		mRequest = new HttpReq(mUrlToLoad, mLocalFile);
+		mRequest = WebImageCache::fetch(mUrlToLoad, mLocalFile);
 		mUrlToLoad = "";
 
 		if (mBusyAnim != nullptr)
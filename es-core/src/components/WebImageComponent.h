@@ -24,7 +24,7 @@ protected:
 	virtual void resize() override;
 
 private:
-	HttpReq*	mRequest = nullptr;
+	std::shared_ptr<HttpReq> mRequest; // Shared with the components loading the same url
 	
 	std::string mUrlToLoad;
 	std::string mLocalFile;
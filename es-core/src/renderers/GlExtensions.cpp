@@ -39,6 +39,8 @@ namespace glext
 	PFNGLBLITFRAMEBUFFERPROC glBlitFramebuffer = nullptr;
 	PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers = nullptr;
 	PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffers = nullptr;
+	PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus = nullptr;
+	PFNGLBLENDFUNCSEPARATEPROC glBlendFuncSeparate = nullptr;
 	PFNGLCOPYIMAGESUBDATAPROC glCopyImageSubData = nullptr;
 
 	PFNGLGETACTIVEUNIFORMPROC glGetActiveUniform = nullptr;
@@ -112,6 +114,8 @@ namespace glext
 		glBlitFramebuffer = (PFNGLBLITFRAMEBUFFERPROC)_glProcAddress("glBlitFramebuffer");
 		glGenFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)_glProcAddress("glGenFramebuffers");
 		glDeleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)_glProcAddress("glDeleteFramebuffers");		
+		glCheckFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)_glProcAddress("glCheckFramebufferStatus");
+		glBlendFuncSeparate = (PFNGLBLENDFUNCSEPARATEPROC)_glProcAddress("glBlendFuncSeparate");
 		glCopyImageSubData = (PFNGLCOPYIMAGESUBDATAPROC)_glProcAddress("glCopyImageSubData");
 
 		glGetActiveUniform = (PFNGLGETACTIVEUNIFORMPROC)_glProcAddress("glGetActiveUniform");
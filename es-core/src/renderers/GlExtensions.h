@@ -46,6 +46,8 @@ namespace glext
 	extern PFNGLBLITFRAMEBUFFERPROC glBlitFramebuffer;
 	extern PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers;
 	extern PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffers;	
+	extern PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus;
+	extern PFNGLBLENDFUNCSEPARATEPROC glBlendFuncSeparate;
 	extern PFNGLCOPYIMAGESUBDATAPROC glCopyImageSubData;
 
 	extern PFNGLGETACTIVEUNIFORMPROC glGetActiveUniform;
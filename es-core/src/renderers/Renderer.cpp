@@ -3,6 +3,8 @@
 #include "Renderer_GL21.h"
 #include "Renderer_GLES10.h"
 #include "Renderer_GLES20.h"
+#include "Renderer_GLES30.h"
+#include "Renderer_Null.h"
 
 #include "math/Transform4x4f.h"
 #include "math/Vector2i.h"
@@ -12,7 +14,9 @@
 #include "Settings.h"
 
 #include <SDL.h>
+#include <map>
 #include <stack>
+#include <tuple>
 
 namespace Renderer
 {
@@ -97,11 +101,11 @@ namespace Renderer
 		size_t                     width   = 0;
 		size_t                     height  = 0;
 		ResourceData               resData = ResourceManager::getInstance()->getFileData(":/window_icon_256.png");
-		unsigned char*             rawData = ImageIO::loadFromMemoryRGBA32(resData.ptr.get(), resData.length, width, height);
+		PixelBuffer                rawData = ImageIO::loadFromMemoryRGBA32(resData.ptr.get(), resData.length, width, height);
 
 		if(rawData != nullptr)
 		{
-			ImageIO::flipPixelsVert(rawData, width, height);
+			ImageIO::flipPixelsVert(rawData.get(), width, height);
 
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
 			unsigned int rmask = 0xFF000000;
@@ -115,15 +119,13 @@ namespace Renderer
 			unsigned int amask = 0xFF000000;
 #endif
 			// try creating SDL surface from logo data
-			SDL_Surface* logoSurface = SDL_CreateRGBSurfaceFrom((void*)rawData, (int)width, (int)height, 32, (int)(width * 4), rmask, gmask, bmask, amask);
+			SDL_Surface* logoSurface = SDL_CreateRGBSurfaceFrom((void*)rawData.get(), (int)width, (int)height, 32, (int)(width * 4), rmask, gmask, bmask, amask);
 			
 			if(logoSurface != nullptr)
 			{
 				SDL_SetWindowIcon(sdlWindow, logoSurface);
 				SDL_FreeSurface(logoSurface);
 			}
-
-			delete[] rawData;
 		}
 
 	} // setIcon
@@ -621,7 +623,7 @@ namespace Renderer
 
 #define ROUNDING_PIECES 8.0f
 
-	static void addRoundCorner(float x, float y, double sa, double arc, float r, unsigned int color, float pieces, std::vector<Vertex> &vertex)
+	static void addRoundCorner(float x, float y, double sa, double arc, float r, float pieces, std::vector<Vector2f> &points)
 	{
 		// centre of the arc, for clockwise sense
 		float cent_x = x + r * Math::cosf(sa + ES_PI / 2.0f);
@@ -632,49 +634,78 @@ namespace Renderer
 
 		float step = arc / (float)n;
 
-		Vertex vx;
-		vx.tex = Vector2f::Zero();
-		vx.col = color;
-
 		for (int i = 0; i <= n; i++)
 		{
 			float ang = sa + step * (float)i;
 
 			// compute the next point
-			float next_x = cent_x + r * Math::sinf(ang);
-			float next_y = cent_y - r * Math::cosf(ang);
-
-			vx.pos[0] = next_x;
-			vx.pos[1] = next_y;
-			vertex.push_back(vx);
+			points.push_back(Vector2f(cent_x + r * Math::sinf(ang), cent_y - r * Math::cosf(ang)));
 		}
 	}
 
-	std::vector<Vertex> createRoundRect(float x, float y, float width, float height, float radius, unsigned int color)
+	#define ROUND_RECT_CACHE_SIZE 256
+
+	// Outlines at the origin, keyed by (width, height, radius). The segment count only depends on the radius
+	static std::map<std::tuple<float, float, float>, std::vector<Vector2f>> roundRectCache;
+
+	static const std::vector<Vector2f>& getRoundRectOutline(float width, float height, float radius)
 	{
-		auto finalColor = convertColor(color);
+		auto key = std::make_tuple(width, height, radius);
+
+		auto it = roundRectCache.find(key);
+		if (it != roundRectCache.cend())
+			return it->second;
+
+		// Animated sizes would make it grow forever
+		if (roundRectCache.size() >= ROUND_RECT_CACHE_SIZE)
+			roundRectCache.clear();
+
 		float pieces = Math::min(3.0f, Math::max(radius / 3.0f, ROUNDING_PIECES));
 
+		std::vector<Vector2f>& points = roundRectCache[key];
+		addRoundCorner(0, radius, 3.0f * ES_PI / 2.0f, ES_PI / 2.0f, radius, pieces, points);
+		addRoundCorner(width - radius, 0, 0.0, ES_PI / 2.0f, radius, pieces, points);
+		addRoundCorner(width, height - radius, ES_PI / 2.0f, ES_PI / 2.0f, radius, pieces, points);
+		addRoundCorner(radius, height, ES_PI, ES_PI / 2.0f, radius, pieces, points);
+		return points;
+	}
+
+	static void buildRoundRect(float x, float y, float width, float height, float radius, unsigned int color, std::vector<Vertex>& vertex)
+	{
+		const std::vector<Vector2f>& points = getRoundRectOutline(width, height, radius);
+
+		Vertex vx;
+		vx.tex = Vector2f::Zero();
+		vx.col = convertColor(color);
+
+		vertex.resize(points.size(), vx);
+
+		for (size_t i = 0; i < points.size(); i++)
+			vertex[i].pos = Vector2f(x + points[i].x(), y + points[i].y());
+	}
+
+	std::vector<Vertex> createRoundRect(float x, float y, float width, float height, float radius, unsigned int color)
+	{
 		std::vector<Vertex> vertex;
-		addRoundCorner(x, y + radius, 3.0f * ES_PI / 2.0f, ES_PI / 2.0f, radius, finalColor, pieces, vertex);
-		addRoundCorner(x + width - radius, y, 0.0, ES_PI / 2.0f, radius, finalColor, pieces, vertex);
-		addRoundCorner(x + width, y + height - radius, ES_PI / 2.0f, ES_PI / 2.0f, radius, finalColor, pieces, vertex);
-		addRoundCorner(x + radius, y + height, ES_PI, ES_PI / 2.0f, radius, finalColor, pieces, vertex);
+		buildRoundRect(x, y, width, height, radius, color, vertex);
 		return vertex;
 	}
-	
+
+	// Reused by the per frame calls, which run on the render thread only
+	static std::vector<Vertex> roundRectVertices;
+
 	void drawRoundRect(float x, float y, float width, float height, float radius, unsigned int color, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
 		bindTexture(0);
 
-		std::vector<Vertex> vertex = createRoundRect(x, y, width, height, radius, color);
-		drawTriangleFan(vertex.data(), vertex.size(), _srcBlendFactor, _dstBlendFactor);
+		buildRoundRect(x, y, width, height, radius, color, roundRectVertices);
+		drawTriangleFan(roundRectVertices.data(), roundRectVertices.size(), _srcBlendFactor, _dstBlendFactor);
 	}
 
 	void enableRoundCornerStencil(float x, float y, float width, float height, float radius)
 	{
-		std::vector<Vertex> vertex = createRoundRect(x, y, width, height, radius);
-		setStencil(vertex.data(), vertex.size());
+		buildRoundRect(x, y, width, height, radius, 0xFFFFFFFF, roundRectVertices);
+		setStencil(roundRectVertices.data(), roundRectVertices.size());
 	}
 
 
@@ -691,6 +722,13 @@ namespace Renderer
 		}
 #endif
 
+#ifdef RENDERER_GLES_30
+		{
+			GLES30Renderer rd;
+			ret.push_back(rd.getDriverName());
+		}
+#endif
+
 #ifdef RENDERER_OPENGL_21
 		{
 			OpenGL21Renderer rd;
@@ -704,6 +742,13 @@ namespace Renderer
 			ret.push_back(rd.getDriverName());
 		}
 #endif
+
+#ifdef RENDERER_NULL
+		{
+			NullRenderer rd;
+			ret.push_back(rd.getDriverName());
+		}
+#endif
 		return ret;
 	}
 
@@ -720,6 +765,14 @@ namespace Renderer
 		}
 #endif
 
+#ifdef RENDERER_GLES_30
+		{
+			GLES30Renderer rd;
+			if (rd.getDriverName() == name)
+				return new GLES30Renderer();
+		}
+#endif
+
 #ifdef RENDERER_OPENGL_21
 		{
 			OpenGL21Renderer rd;
@@ -736,12 +789,26 @@ namespace Renderer
 		}
 #endif
 
+#ifdef RENDERER_NULL
+		{
+			NullRenderer rd;
+			if (rd.getDriverName() == name)
+				return new NullRenderer();
+		}
+#endif
+
 		return nullptr;
 	}
 
 	static IRenderer* createRenderer()
 	{
 		IRenderer* instance = getRendererFromName(Settings::getInstance()->getString("Renderer"));
+
+		// No display to render to ( SDL_VIDEODRIVER=dummy or offscreen ) : headless
+		const char* videoDriver = SDL_GetCurrentVideoDriver();
+		if (instance == nullptr && videoDriver != nullptr && (strcmp(videoDriver, "dummy") == 0 || strcmp(videoDriver, "offscreen") == 0))
+			instance = new NullRenderer();
+
 		if (instance == nullptr)
 		{
 #ifdef RENDERER_GLES_20
@@ -787,76 +854,318 @@ namespace Renderer
 		return Instance()->setupWindow();
 	}
 
+	//////////////////////////////////////////////////////////////////////////
+	// Draw-call batching
+	//
+	// Consecutive triangle strips sharing the same texture, blending & saturation, without custom shader, are
+	// transformed on the CPU and gathered in a single vertex buffer, joined with degenerate triangles ( face culling
+	// is never enabled ). The buffer is sent as one draw call with an identity matrix whenever the state changes.
+	// The model matrix is therefore only applied to the renderer when a non batched draw needs it.
+
+	#define MAX_BATCH_VERTICES 16384
+
+	static bool                batchingEnabled = false;
+	static std::vector<Vertex> batchVertices;
+	static unsigned int        batchTexture = 0;
+	static Blend::Factor       batchSrcBlendFactor = Blend::SRC_ALPHA;
+	static Blend::Factor       batchDstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA;
+	static float               batchSaturation = 1.0f;
+
+	static unsigned int        boundTexture = 0;
+	static Transform4x4f       currentMatrix = Transform4x4f::Identity();
+	static Transform4x4f       roundedMatrix = Transform4x4f::Identity();
+	static bool                matrixDirty = false;
+	static const Vertex*       uploadedVertices = nullptr; // Vertices in the renderer's buffer, for drawTriangleStrips(verticesChanged = false)
+
+	static BatchStats          frameStats;
+	static BatchStats          lastFrameStats;
+
+	static void flushBatch()
+	{
+		if (batchVertices.empty())
+			return;
+
+		Instance()->setMatrix(Transform4x4f::Identity());
+		Instance()->drawTriangleStrips(batchVertices.data(), (unsigned int)batchVertices.size(), batchSrcBlendFactor, batchDstBlendFactor, true);
+
+		frameStats.batches++;
+		frameStats.vertices += (unsigned int)batchVertices.size();
+
+		batchVertices.clear();
+		uploadedVertices = nullptr;
+		matrixDirty = true;
+	}
+
+	// Prepares the renderer for a draw that is not batched
+	static void applyState()
+	{
+		flushBatch();
+
+		if (matrixDirty)
+		{
+			Instance()->setMatrix(currentMatrix);
+			matrixDirty = false;
+		}
+	}
+
+	static bool addToBatch(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		if (!batchingEnabled || _numVertices < 3 || _vertices->customShader != nullptr)
+			return false;
+
+		if (!batchVertices.empty() && (batchTexture != boundTexture || batchSrcBlendFactor != _srcBlendFactor || batchDstBlendFactor != _dstBlendFactor ||
+			batchSaturation != _vertices->saturation || batchVertices.size() + _numVertices + 2 > MAX_BATCH_VERTICES))
+			flushBatch();
+
+		if (_numVertices > MAX_BATCH_VERTICES)
+			return false;
+
+		bool link = !batchVertices.empty();
+		if (!link)
+		{
+			batchTexture = boundTexture;
+			batchSrcBlendFactor = _srcBlendFactor;
+			batchDstBlendFactor = _dstBlendFactor;
+			batchSaturation = _vertices->saturation;
+		}
+
+		size_t first = batchVertices.size() + (link ? 2 : 0);
+		batchVertices.resize(first + _numVertices);
+
+		Vertex* dst = &batchVertices[first];
+		for (unsigned int i = 0; i < _numVertices; i++)
+		{
+			const Vector3f pos = roundedMatrix * Vector3f(_vertices[i].pos.x(), _vertices[i].pos.y(), 0.0f);
+
+			dst[i] = _vertices[i];
+			dst[i].pos = Vector2f(pos.x(), pos.y());
+		}
+
+		// Degenerate link with the previous strip
+		if (link)
+		{
+			batchVertices[first - 2] = batchVertices[first - 3];
+			batchVertices[first - 1] = batchVertices[first];
+		}
+
+		return true;
+	}
+
+	BatchStats getBatchStats()
+	{
+		return lastFrameStats;
+	}
+
+	void beginGpuTimer()
+	{
+		flushBatch();
+		Instance()->beginGpuTimer();
+	}
+
+	void endGpuTimer()
+	{
+		flushBatch();
+		Instance()->endGpuTimer();
+	}
+
+	float getGpuTime()
+	{
+		return Instance()->getGpuTime();
+	}
+
+	void waitForGpu()
+	{
+		Instance()->waitForGpu();
+	}
+
+	static bool             renderingToTexture = false;
+	static std::stack<Rect> savedClipStack;
+	static std::stack<Rect> savedNativeClipStack;
+
+	bool beginRenderToTexture(const unsigned int _texture, const Rect& _screenRect)
+	{
+		if (renderingToTexture || screenRotate != 0 || screenMargin.x() != 0 || screenMargin.y() != 0)
+			return false;
+
+		flushBatch();
+
+		if (!Instance()->beginRenderTarget(_texture, Rect(screenOffsetX + _screenRect.x, screenOffsetY + _screenRect.y, _screenRect.w, _screenRect.h)))
+			return false;
+
+		// The clip rects of the screen are restored at the end
+		savedClipStack.swap(clipStack);
+		savedNativeClipStack.swap(nativeClipStack);
+
+		renderingToTexture = true;
+		return true;
+	}
+
+	void endRenderToTexture()
+	{
+		if (!renderingToTexture)
+			return;
+
+		flushBatch();
+		Instance()->endRenderTarget();
+
+		clipStack = std::stack<Rect>();
+		nativeClipStack = std::stack<Rect>();
+		clipStack.swap(savedClipStack);
+		nativeClipStack.swap(savedNativeClipStack);
+
+		renderingToTexture = false;
+
+		if (!clipStack.empty())
+			setScissor(clipStack.top());
+	}
+
+	bool isRenderingToTexture()
+	{
+		return renderingToTexture;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	void createContext() 
 	{
 		Instance()->createContext();
+
+		batchingEnabled = Settings::getInstance()->getBool("RendererBatching");
+		batchVertices.clear();
+		batchVertices.reserve(MAX_BATCH_VERTICES);
+
+		boundTexture = 0;
+		currentMatrix = roundedMatrix = Transform4x4f::Identity();
+		matrixDirty = false;
+		uploadedVertices = nullptr;
 	}
 
 	void resetCache()
 	{
+		flushBatch();
 		Instance()->resetCache();
+		uploadedVertices = nullptr;
 	}
 	
 	void destroyContext()
 	{
+		batchVertices.clear();
 		Instance()->destroyContext();
 	}
 
 	unsigned int createTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data)
 	{
+		flushBatch();
 		return Instance()->createTexture(_type, _linear, _repeat, _width, _height, _data);
 	}
 
 	void  destroyTexture(const unsigned int _texture)
 	{
+		flushBatch();
 		Instance()->destroyTexture(_texture);
 	}
 
 	void updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data)
 	{
+		flushBatch();
 		Instance()->updateTexture(_texture, _type, _x, _y, _width, _height, _data);
 	}
 
 	void bindTexture(const unsigned int _texture)
 	{
+		if (!batchVertices.empty() && batchTexture != _texture)
+			flushBatch();
+
+		boundTexture = _texture;
 		Instance()->bindTexture(_texture);
 	}
 
 	void drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
+		applyState();
 		Instance()->drawLines(_vertices, _numVertices, _srcBlendFactor, _dstBlendFactor);
+		uploadedVertices = nullptr;
+		frameStats.drawCalls++;
+		frameStats.batches++;
 	}
 
 	void drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor, bool verticesChanged)
 	{
-		Instance()->drawTriangleStrips(_vertices, _numVertices, _srcBlendFactor, _dstBlendFactor, verticesChanged);
+		frameStats.drawCalls++;
+
+		if (addToBatch(_vertices, _numVertices, _srcBlendFactor, _dstBlendFactor))
+			return;
+
+		applyState();
+		Instance()->drawTriangleStrips(_vertices, _numVertices, _srcBlendFactor, _dstBlendFactor, verticesChanged || uploadedVertices != _vertices);
+		uploadedVertices = _vertices;
+
+		frameStats.batches++;
+		frameStats.vertices += _numVertices;
 	}
 
 	void drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
+		applyState();
 		Instance()->drawTriangleFan(_vertices, _numVertices, _srcBlendFactor, _dstBlendFactor);
+		uploadedVertices = nullptr;
+		frameStats.drawCalls++;
+		frameStats.batches++;
+		frameStats.vertices += _numVertices;
 	}
 
 	void setProjection(const Transform4x4f& _projection)
 	{
+		flushBatch();
 		Instance()->setProjection(_projection);
 	}
 
 	void setMatrix(const Transform4x4f& _matrix)
 	{
-		Instance()->setMatrix(_matrix);
+		currentMatrix = _matrix;
+		roundedMatrix = _matrix;
+		roundedMatrix.round();
+
+		if (batchingEnabled)
+			matrixDirty = true;
+		else
+			Instance()->setMatrix(_matrix);
 	}
 
 	void blurBehind(const float _x, const float _y, const float _w, const float _h, const float blurSize)
 	{
 		std::map<std::string, std::string> map;
 		map["blur"] = std::to_string(blurSize);
-		Instance()->postProcessShader(":/shaders/blur.glsl", _x, _y, _w, _h, map);		
+		postProcessShader(":/shaders/blur.glsl", _x, _y, _w, _h, map);
 	}
 
 	void postProcessShader(const std::string& path, const float _x, const float _y, const float _w, const float _h, const std::map<std::string, std::string>& parameters, unsigned int* data)
 	{
+		// Shaders read back the screen, not the render target
+		if (renderingToTexture)
+			return;
+
+		applyState();
 		Instance()->postProcessShader(path, _x, _y, _w, _h, parameters, data);
+
+		// The renderer draws with its own matrix & buffer
+		uploadedVertices = nullptr;
+		matrixDirty = true;
+	}
+
+	void preloadShader(const std::string& path)
+	{
+		Instance()->preloadShader(path);
+	}
+
+	bool supportsDistanceField()
+	{
+		return Instance()->supportsDistanceField();
+	}
+
+	bool supportsYuvTextures()
+	{
+		return Instance()->supportsYuvTextures();
 	}
 
 	Rect& getViewport()
@@ -866,22 +1175,27 @@ namespace Renderer
 
 	void setViewport(const Rect& _viewport)
 	{
+		flushBatch();
 		viewPort = _viewport;
 		Instance()->setViewport(_viewport);
 	}
 
 	void setScissor(const Rect& _scissor)
 	{
+		flushBatch();
 		Instance()->setScissor(_scissor);
 	}
 
 	void setStencil(const Vertex* _vertices, const unsigned int _numVertices)
 	{
+		applyState();
 		Instance()->setStencil(_vertices, _numVertices);
+		uploadedVertices = nullptr;
 	}
 
 	void disableStencil()
 	{
+		flushBatch();
 		Instance()->disableStencil();
 	}
 
@@ -892,7 +1206,12 @@ namespace Renderer
 
 	void swapBuffers() 
 	{
+		flushBatch();
+		Instance()->collectStateStats(frameStats);
 		Instance()->swapBuffers();
+
+		lastFrameStats = frameStats;
+		frameStats = BatchStats();
 	}
 
 	size_t getTotalMemUsage()
@@ -38,7 +38,10 @@ namespace Renderer
 		enum Type
 		{
 			RGBA  = 0,
-			ALPHA = 1
+			ALPHA = 1,
+			DISTANCE_FIELD = 2, // Alpha channel holding a signed distance to the glyph outline, 0.5 on the edge
+			YUV = 3 // I420 video frame : the Y plane followed by the half size U & V planes, converted to RGB by a shader
+
 
 		}; // Type
 
@@ -91,6 +94,18 @@ namespace Renderer
 
 	}; // Vertex
 
+	struct BatchStats
+	{
+		BatchStats() : drawCalls(0), batches(0), vertices(0), stateCalls(0), skippedStateCalls(0) { }
+
+		unsigned int drawCalls; // Draws requested by the components
+		unsigned int batches;   // Draws sent to the renderer
+		unsigned int vertices;
+
+		unsigned int stateCalls;        // GL state changes sent to the driver
+		unsigned int skippedStateCalls; // Redundant ones, eliminated by the renderer's state cache
+	};
+
 	class IRenderer
 	{
 	public:
@@ -127,8 +142,31 @@ namespace Renderer
 		virtual void         swapBuffers() = 0;
 		
 		virtual void		 postProcessShader(const std::string& path, const float _x, const float _y, const float _w, const float _h, const std::map<std::string, std::string>& parameters, unsigned int* data = nullptr) { };
+		// Compiles ( or loads from the shader cache ) a post-process shader before its first use
+		virtual void		 preloadShader(const std::string& path) { };
+
+		// DISTANCE_FIELD textures are drawn through a shader that thresholds the distance
+		virtual bool		 supportsDistanceField() { return false; };
+
+		// YUV textures are uploaded as separate planes & drawn through a conversion shader. Width & height must be even
+		virtual bool		 supportsYuvTextures() { return false; };
 
 		virtual size_t		 getTotalMemUsage() { return (size_t) -1; };
+
+		// Fills & resets the state cache counters of the frame
+		virtual void		 collectStateStats(BatchStats& stats) { };
+
+		// GPU time of the frame, with timer queries. getGpuTime returns the last available result in ms, or -1 when unsupported
+		virtual void		 beginGpuTimer() { };
+		virtual void		 endGpuTimer() { };
+		virtual float		 getGpuTime() { return -1; };
+
+		// Blocks until the GPU executed the submitted commands
+		virtual void		 waitForGpu() { };
+
+		// Redirects drawing to _texture, which covers _area of the window (top left based). Returns false when unsupported
+		virtual bool		 beginRenderTarget(const unsigned int _texture, const Rect& _area) { return false; };
+		virtual void		 endRenderTarget() { };
 	};
 	
 	std::vector<std::string> getRendererNames();
@@ -181,8 +219,23 @@ namespace Renderer
 
 	void		 blurBehind		   (const float _x, const float _y, const float _w, const float _h, const float blurSize = 4.0f);
 	void		 postProcessShader (const std::string& path, const float _x, const float _y, const float _w, const float _h, const std::map<std::string, std::string>& parameters, unsigned int* data = nullptr);
+	void		 preloadShader     (const std::string& path);
+	bool		 supportsDistanceField();
+	bool		 supportsYuvTextures();
 
 	size_t		 getTotalMemUsage  ();
+	BatchStats	 getBatchStats     (); // Previous frame
+
+	void		 beginGpuTimer     ();
+	void		 endGpuTimer       ();
+	float		 getGpuTime        (); // ms, a few frames late. -1 when not available
+	void		 waitForGpu        ();
+
+	// Redirects drawing into _texture, which must have the size of _screenRect. Clipping starts over until endRenderToTexture.
+	// Not available with a rotated screen or screen margins
+	bool		 beginRenderToTexture(const unsigned int _texture, const Rect& _screenRect);
+	void		 endRenderToTexture();
+	bool		 isRenderingToTexture();
 
 	std::string  getDriverName();
 	std::vector<std::pair<std::string, std::string>> getDriverInformation();
@@ -41,11 +41,63 @@ namespace Renderer
 		{
 			case Texture::RGBA:  { return GL_RGBA;  } break;
 			case Texture::ALPHA: { return GL_ALPHA; } break;
+			case Texture::DISTANCE_FIELD: { return GL_ALPHA; } break;
 			default:             { return GL_ZERO;  }
 		}
 
 	} // convertTextureType
 
+	// Shadow copies of the GL state, to skip redundant calls. Blending and the client arrays stay enabled between draws
+	static bool         blendEnabled       = false;
+	static GLenum       blendSrcFactor     = GL_ZERO;
+	static GLenum       blendDstFactor     = GL_ZERO;
+	static bool         clientArrays       = false;
+	static unsigned int stateCallsIssued   = 0;
+	static unsigned int stateCallsSkipped  = 0;
+
+	static void setBlendFactors(const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		const GLenum srcFactor = convertBlendFactor(_srcBlendFactor);
+		const GLenum dstFactor = convertBlendFactor(_dstBlendFactor);
+
+		if (!blendEnabled)
+		{
+			glEnable(GL_BLEND);
+			blendEnabled = true;
+			stateCallsIssued++;
+		}
+		else
+			stateCallsSkipped++;
+
+		if (blendSrcFactor != srcFactor || blendDstFactor != dstFactor)
+		{
+			glBlendFunc(srcFactor, dstFactor);
+			blendSrcFactor = srcFactor;
+			blendDstFactor = dstFactor;
+			stateCallsIssued++;
+		}
+		else
+			stateCallsSkipped++;
+	}
+
+	static void setVertexPointers(const Vertex* _vertices)
+	{
+		if (!clientArrays)
+		{
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glEnableClientState(GL_COLOR_ARRAY);
+			clientArrays = true;
+			stateCallsIssued += 3;
+		}
+		else
+			stateCallsSkipped += 3;
+
+		glVertexPointer(  2, GL_FLOAT,         sizeof(Vertex), &_vertices[0].pos);
+		glTexCoordPointer(2, GL_FLOAT,         sizeof(Vertex), &_vertices[0].tex);
+		glColorPointer(   4, GL_UNSIGNED_BYTE, sizeof(Vertex), &_vertices[0].col);
+	}
+
 	unsigned int OpenGL21Renderer::getWindowFlags()
 	{
 		return SDL_WINDOW_OPENGL;
@@ -104,6 +156,12 @@ namespace Renderer
 
 		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 
+		boundTexture = 0;
+		blendEnabled = false;
+		blendSrcFactor = GL_ZERO;
+		blendDstFactor = GL_ZERO;
+		clientArrays = false;
+
 		std::string glExts = (const char*)glGetString(GL_EXTENSIONS);
 		LOG(LogInfo) << "Checking available OpenGL extensions...";
 		LOG(LogInfo) << " ARB_texture_non_power_of_two: " << (glExts.find("ARB_texture_non_power_of_two") != std::string::npos ? "ok" : "MISSING");
@@ -131,7 +189,6 @@ namespace Renderer
 		if (glGetError() != GL_NO_ERROR)
 			return 0;
 
-		bindTexture(0);
 		bindTexture(texture);
 
 		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE);
@@ -159,6 +216,10 @@ namespace Renderer
 	{
 		glDeleteTextures(1, &_texture);
 
+		// Deleting a bound texture reverts the binding to 0
+		if (boundTexture == _texture)
+			boundTexture = 0;
+
 	} // destroyTexture
 
 	void OpenGL21Renderer::updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data)
@@ -173,15 +234,20 @@ namespace Renderer
 		else 
 			glTexSubImage2D(GL_TEXTURE_2D, 0, _x, _y, _width, _height, convertTextureType(_type), GL_UNSIGNED_BYTE, _data);
 
-		glBindTexture(GL_TEXTURE_2D, 0);
+		// Restore the binding known by bindTexture
+		glBindTexture(GL_TEXTURE_2D, boundTexture);
 
 	} // updateTexture
 
 	void OpenGL21Renderer::bindTexture(const unsigned int _texture)
 	{
 		if (boundTexture == _texture)
+		{
+			stateCallsSkipped++;
 			return;
+		}
 
+		stateCallsIssued++;
 		boundTexture = _texture;
 
 		glBindTexture(GL_TEXTURE_2D, _texture);
@@ -193,46 +259,19 @@ namespace Renderer
 
 	void OpenGL21Renderer::drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
-		glEnable(GL_BLEND);
-		glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor));
-
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(  2, GL_FLOAT,         sizeof(Vertex), &_vertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT,         sizeof(Vertex), &_vertices[0].tex);
-		glColorPointer(   4, GL_UNSIGNED_BYTE, sizeof(Vertex), &_vertices[0].col);
+		setBlendFactors(_srcBlendFactor, _dstBlendFactor);
+		setVertexPointers(_vertices);
 
 		glDrawArrays(GL_LINES, 0, _numVertices);
 
-		glDisableClientState(GL_COLOR_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_VERTEX_ARRAY);
-
-		glDisable(GL_BLEND);
-
 	} // drawLines
 
 	void OpenGL21Renderer::drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor, bool verticesChanged)
 	{
-		glEnable(GL_BLEND);
-		glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor));
-
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
+		setBlendFactors(_srcBlendFactor, _dstBlendFactor);
+		setVertexPointers(_vertices);
 
-		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &_vertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &_vertices[0].tex);
-		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &_vertices[0].col);
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, _numVertices);
-		
-		glDisableClientState(GL_COLOR_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_VERTEX_ARRAY);
-
-		glDisable(GL_BLEND);
 
 	} // drawTriangleStrips
 
@@ -310,35 +349,37 @@ namespace Renderer
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	} // swapBuffers
 
+	void OpenGL21Renderer::waitForGpu()
+	{
+		glFinish();
+	} // waitForGpu
+
 
-	void OpenGL21Renderer::drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	void OpenGL21Renderer::collectStateStats(BatchStats& stats)
 	{
-		glEnable(GL_MULTISAMPLE);
+		stats.stateCalls = stateCallsIssued;
+		stats.skippedStateCalls = stateCallsSkipped;
 
-		glEnable(GL_BLEND);
-		glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor));
+		stateCallsIssued = 0;
+		stateCallsSkipped = 0;
 
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
+	} // collectStateStats
 
-		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &_vertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &_vertices[0].tex);
-		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &_vertices[0].col);
+	void OpenGL21Renderer::drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		glEnable(GL_MULTISAMPLE);
 
-		glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices);
+		setBlendFactors(_srcBlendFactor, _dstBlendFactor);
+		setVertexPointers(_vertices);
 
-		glDisableClientState(GL_COLOR_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_VERTEX_ARRAY);
+		glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices);
 
-		glDisable(GL_BLEND);
 		glDisable(GL_MULTISAMPLE);
 	}
 
 	void OpenGL21Renderer::setStencil(const Vertex* _vertices, const unsigned int _numVertices)
 	{
-		bool tx = glIsEnabled(GL_TEXTURE_2D);
+		bool tx = boundTexture != 0;
 		glDisable(GL_TEXTURE_2D);
 
 		glClear(GL_DEPTH_BUFFER_BIT);
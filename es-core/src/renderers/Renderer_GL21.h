@@ -44,6 +44,9 @@ namespace Renderer
 
 		void         setSwapInterval() override;
 		void         swapBuffers() override;
+		void		 waitForGpu() override;
+
+		void		 collectStateStats(BatchStats& stats) override;
 	};
 }
 
@@ -45,6 +45,7 @@ namespace Renderer
 		{
 			case Texture::RGBA:  { return GL_RGBA;  } break;
 			case Texture::ALPHA: { return GL_ALPHA; } break;
+			case Texture::DISTANCE_FIELD: { return GL_ALPHA; } break;
 			default:             { return GL_ZERO;  }
 		}
 
@@ -295,6 +296,11 @@ namespace Renderer
 
 	} // swapBuffers
 
+	void GLES10Renderer::waitForGpu()
+	{
+		glFinish();
+	} // waitForGpu
+
 	void GLES10Renderer::drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
 		glEnable(GL_BLEND);
@@ -44,6 +44,7 @@ namespace Renderer
 
 		void         setSwapInterval() override;
 		void         swapBuffers() override;
+		void		 waitForGpu() override;
 	};
 };
 
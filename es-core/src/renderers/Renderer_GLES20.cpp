@@ -16,6 +16,7 @@
 
 #include "GlExtensions.h"
 #include "Shader.h"
+#include "ShaderCache.h"
 
 #include "resources/ResourceManager.h"
 
@@ -26,8 +27,12 @@ namespace Renderer
 
 	struct TextureInfo
 	{
+		TextureInfo() : type(0), distanceField(false) { planes[0] = planes[1] = 0; }
+
 		GLenum type;
 		Vector2f size;
+		bool distanceField;
+		GLuint planes[2]; // U & V of the YUV textures
 	};
 
 	static SDL_GLContext	sdlContext       = nullptr;
@@ -39,6 +44,8 @@ namespace Renderer
 	static ShaderProgram    shaderProgramColorTexture;
 	static ShaderProgram    shaderProgramColorNoTexture;
 	static ShaderProgram    shaderProgramAlpha;
+	static ShaderProgram    shaderProgramDistanceField;
+	static ShaderProgram    shaderProgramYuv;
 
 	static GLuint			vertexBuffer     = 0;
 
@@ -57,7 +64,10 @@ namespace Renderer
 		if (program == currentProgram)
 		{
 			if (currentProgram != nullptr)
+			{
+				glStateCallsSkipped++;
 				currentProgram->setMatrix(mvpMatrix);
+			}
 
 			return;
 		}
@@ -242,10 +252,7 @@ namespace Renderer
 			)=====";
 
 		// Compile each shader, link them to make a full program
-		auto vertexShaderNoTexture = Shader::createShader(GL_VERTEX_SHADER, vertexSourceNoTexture);
-		auto fragmentShaderColorNoTexture = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSourceNoTexture);
-
-		shaderProgramColorNoTexture.createShaderProgram(vertexShaderNoTexture, fragmentShaderColorNoTexture);
+		shaderProgramColorNoTexture.loadFromSource(vertexSourceNoTexture, fragmentSourceNoTexture);
 		
 		// vertex shader (texture)
 		std::string vertexSourceTexture =
@@ -293,9 +300,7 @@ namespace Renderer
 			)=====";
 
 		// Compile each shader, link them to make a full program
-		auto vertexShaderTexture = Shader::createShader(GL_VERTEX_SHADER, vertexSourceTexture);
-		auto fragmentShaderColorTexture = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSourceTexture);
-		shaderProgramColorTexture.createShaderProgram(vertexShaderTexture, fragmentShaderColorTexture);
+		shaderProgramColorTexture.loadFromSource(vertexSourceTexture, fragmentSourceTexture);
 		
 		// fragment shader (alpha texture)
 		std::string fragmentSourceAlpha =
@@ -317,10 +322,84 @@ namespace Renderer
 			)=====";
 
 
-		auto vertexShaderAlpha = Shader::createShader(GL_VERTEX_SHADER, vertexSourceTexture);
-		auto fragmentShaderAlpha = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSourceAlpha);
+		shaderProgramAlpha.loadFromSource(vertexSourceTexture, fragmentSourceAlpha);
+
+		// Screen space derivatives give the width of the edge at any scale. GLSL ES needs an extension for them
+#if defined(USE_OPENGLES_20)
+		std::string derivatives = SDL_GL_ExtensionSupported("GL_OES_standard_derivatives") ? "#extension GL_OES_standard_derivatives : enable\n#define DERIVATIVES\n" : "";
+#else
+		std::string derivatives = "#define DERIVATIVES\n";
+#endif
+
+		// fragment shader (distance field texture)
+		std::string fragmentSourceDistanceField =
+			SHADER_VERSION_STRING + derivatives +
+			R"=====(
+			#ifdef GL_ES
+			precision mediump float;
+			precision mediump sampler2D;
+			#endif		
+
+			varying   vec4      v_col;
+			varying   vec2      v_tex;
+			uniform   sampler2D u_tex;
+			void main(void)           
+			{                         
+			    float distance = texture2D(u_tex, v_tex).a;
+			#ifdef DERIVATIVES
+			    float width = clamp(fwidth(distance) * 0.7, 0.01, 0.5);
+			#else
+			    float width = 0.08;
+			#endif
+			    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+			    gl_FragColor = vec4(v_col.rgb, v_col.a * alpha);
+			}
+			)=====";
+
+		shaderProgramDistanceField.loadFromSource(vertexSourceTexture, fragmentSourceDistanceField);
+
+		// fragment shader (I420 planes, BT.601 limited range)
+		std::string fragmentSourceYuv =
+			SHADER_VERSION_STRING +
+			R"=====(
+			#ifdef GL_ES
+			precision mediump float;
+			precision mediump sampler2D;
+			#endif		
+
+			varying   vec4      v_col;
+			varying   vec2      v_tex;
+			uniform   sampler2D u_tex;
+			uniform   sampler2D u_texU;
+			uniform   sampler2D u_texV;
+			uniform   float saturation;
+			void main(void)           
+			{                         
+			    float y = 1.1643 * (texture2D(u_tex, v_tex).r - 0.0625);
+			    float u = texture2D(u_texU, v_tex).r - 0.5;
+			    float v = texture2D(u_texV, v_tex).r - 0.5;
+
+			    vec4 clr = vec4(y + 1.5958 * v, y - 0.39173 * u - 0.81290 * v, y + 2.017 * u, 1.0) * v_col;
 
-		shaderProgramAlpha.createShaderProgram(vertexShaderAlpha, fragmentShaderAlpha);
+			    if (saturation != 1.0) {
+			    	vec3 gray = vec3(dot(clr.rgb, vec3(0.34, 0.55, 0.11)));
+			    	vec3 blend = mix(gray, clr.rgb, saturation);
+			    	clr = vec4(blend, clr.a);
+			    }
+
+			    gl_FragColor = clr;
+			}
+			)=====";
+
+		// The planes are bound to the texture units 1 & 2 while drawing
+		if (shaderProgramYuv.loadFromSource(vertexSourceTexture, fragmentSourceYuv))
+		{
+			shaderProgramYuv.select();
+			shaderProgramYuv.setUniformInt("u_tex", 0);
+			shaderProgramYuv.setUniformInt("u_texU", 1);
+			shaderProgramYuv.setUniformInt("u_texV", 2);
+			shaderProgramYuv.unSelect();
+		}
 		
 		useProgram(nullptr);
 
@@ -356,6 +435,159 @@ namespace Renderer
 
 	} // convertBlendFactor
 
+//////////////////////////////////////////////////////////////////////////
+
+	// Shadow copies of the GL state, to skip redundant calls
+	static int		blendEnabled   = -1; // -1 : unknown
+	static GLenum	blendSrcFactor = GL_ZERO;
+	static GLenum	blendDstFactor = GL_ZERO;
+	static bool		scissorEnabled = false;
+	static Rect		scissorRect;
+
+	// Render target : viewport & scissor are shifted so that the target area lands at the origin of the texture
+	static bool		renderTargetActive = false;
+	static int		renderTargetOffsetX = 0;
+	static int		renderTargetOffsetY = 0;
+	static Rect		currentViewport;
+
+	// GPU timer queries : GL_ARB_timer_query on desktop GL, GL_EXT_disjoint_timer_query on GLES. Results are read a few frames later, never waited for
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED				0x88BF
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT				0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE	0x8867
+#endif
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+	typedef void (APIENTRY* GenQueriesProc)(GLsizei n, GLuint* ids);
+	typedef void (APIENTRY* DeleteQueriesProc)(GLsizei n, const GLuint* ids);
+	typedef void (APIENTRY* BeginQueryProc)(GLenum target, GLuint id);
+	typedef void (APIENTRY* EndQueryProc)(GLenum target);
+	typedef void (APIENTRY* GetQueryObjectivProc)(GLuint id, GLenum pname, GLint* params);
+	typedef void (APIENTRY* GetQueryObjectui64vProc)(GLuint id, GLenum pname, uint64_t* params);
+
+	#define GPU_QUERIES 4
+
+	static GenQueriesProc			gpuGenQueries          = nullptr;
+	static DeleteQueriesProc		gpuDeleteQueries       = nullptr;
+	static BeginQueryProc			gpuBeginQuery          = nullptr;
+	static EndQueryProc				gpuEndQuery            = nullptr;
+	static GetQueryObjectivProc		gpuGetQueryObjectiv    = nullptr;
+	static GetQueryObjectui64vProc	gpuGetQueryObjectui64v = nullptr;
+
+	static GLuint	gpuQueries[GPU_QUERIES] = { 0 };
+	static bool		gpuQueryPending[GPU_QUERIES] = { false };
+	static int		gpuQueryIndex   = 0;
+	static bool		gpuQueryRunning = false;
+	static float	gpuTime         = -1;
+
+	static void setupGpuTimer()
+	{
+		std::string suffix;
+		if (SDL_GL_ExtensionSupported("GL_ARB_timer_query"))
+			suffix = "";
+		else if (SDL_GL_ExtensionSupported("GL_EXT_disjoint_timer_query"))
+			suffix = "EXT";
+		else
+			return;
+
+		gpuGenQueries          = (GenQueriesProc)SDL_GL_GetProcAddress(("glGenQueries" + suffix).c_str());
+		gpuDeleteQueries       = (DeleteQueriesProc)SDL_GL_GetProcAddress(("glDeleteQueries" + suffix).c_str());
+		gpuBeginQuery          = (BeginQueryProc)SDL_GL_GetProcAddress(("glBeginQuery" + suffix).c_str());
+		gpuEndQuery            = (EndQueryProc)SDL_GL_GetProcAddress(("glEndQuery" + suffix).c_str());
+		gpuGetQueryObjectiv    = (GetQueryObjectivProc)SDL_GL_GetProcAddress(("glGetQueryObjectiv" + suffix).c_str());
+		gpuGetQueryObjectui64v = (GetQueryObjectui64vProc)SDL_GL_GetProcAddress(("glGetQueryObjectui64v" + suffix).c_str());
+
+		if (gpuGenQueries == nullptr || gpuDeleteQueries == nullptr || gpuBeginQuery == nullptr || gpuEndQuery == nullptr || gpuGetQueryObjectiv == nullptr || gpuGetQueryObjectui64v == nullptr)
+		{
+			gpuGenQueries = nullptr;
+			return;
+		}
+
+		gpuGenQueries(GPU_QUERIES, gpuQueries);
+
+		LOG(LogInfo) << " GPU timer queries: ok";
+	}
+
+	static void destroyGpuTimer()
+	{
+		if (gpuGenQueries != nullptr)
+			gpuDeleteQueries(GPU_QUERIES, gpuQueries);
+
+		gpuGenQueries = nullptr;
+
+		for (int i = 0; i < GPU_QUERIES; i++)
+		{
+			gpuQueries[i] = 0;
+			gpuQueryPending[i] = false;
+		}
+
+		gpuQueryIndex = 0;
+		gpuQueryRunning = false;
+		gpuTime = -1;
+	}
+
+	static void resetStateCache()
+	{
+		blendEnabled = -1;
+		scissorEnabled = false;
+		scissorRect = Rect();
+		boundTexture = 0;
+		currentProgram = nullptr;
+
+		ShaderProgram::resetAttributeCache();
+	}
+
+	static void setBlendState(const bool _enabled, const GLenum _srcFactor = GL_SRC_ALPHA, const GLenum _dstFactor = GL_ONE_MINUS_SRC_ALPHA)
+	{
+		if (blendEnabled != (_enabled ? 1 : 0))
+		{
+			if (_enabled)
+				GL_CHECK_ERROR(glEnable(GL_BLEND));
+			else
+				GL_CHECK_ERROR(glDisable(GL_BLEND));
+
+			blendEnabled = _enabled ? 1 : 0;
+			glStateCallsIssued++;
+		}
+		else
+			glStateCallsSkipped++;
+
+		if (!_enabled)
+			return;
+
+		if (blendSrcFactor != _srcFactor || blendDstFactor != _dstFactor)
+		{
+			// Render targets keep a premultiplied alpha channel, to be composited with ONE, ONE_MINUS_SRC_ALPHA
+			if (renderTargetActive)
+				GL_CHECK_ERROR(glBlendFuncSeparate(_srcFactor, _dstFactor, GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+			else
+				GL_CHECK_ERROR(glBlendFunc(_srcFactor, _dstFactor));
+
+			blendSrcFactor = _srcFactor;
+			blendDstFactor = _dstFactor;
+			glStateCallsIssued++;
+		}
+		else
+			glStateCallsSkipped++;
+	}
+
+	// Blending is disabled when one of the factors is ONE, except for premultiplied alpha (ONE, ONE_MINUS_SRC_ALPHA)
+	static void setBlendFactors(const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		if (_srcBlendFactor == Blend::ONE && _dstBlendFactor == Blend::ONE_MINUS_SRC_ALPHA)
+			setBlendState(true, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		else if (_srcBlendFactor != Blend::ONE && _dstBlendFactor != Blend::ONE)
+			setBlendState(true, convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor));
+		else
+			setBlendState(false);
+	}
+
 //////////////////////////////////////////////////////////////////////////
 
 	static GLenum convertTextureType(const Texture::Type _type)
@@ -365,8 +597,12 @@ namespace Renderer
 			case Texture::RGBA:  { return GL_RGBA;            } break;
 #if defined(USE_OPENGLES_20)
 			case Texture::ALPHA: { return GL_ALPHA; } break;
+			case Texture::DISTANCE_FIELD: { return GL_ALPHA; } break;
+			case Texture::YUV: { return GL_LUMINANCE; } break;
 #else
 			case Texture::ALPHA: { return GL_LUMINANCE_ALPHA; } break;
+			case Texture::DISTANCE_FIELD: { return GL_LUMINANCE_ALPHA; } break;
+			case Texture::YUV: { return GL_LUMINANCE; } break;
 #endif
 			default:             { return GL_ZERO;            }
 		}
@@ -427,7 +663,7 @@ namespace Renderer
 	}
 
 //////////////////////////////////////////////////////////////////////////
-	GLES20Renderer::GLES20Renderer() : mFrameBuffer(-1)
+	GLES20Renderer::GLES20Renderer() : mFrameBuffer(-1), mRenderTargetBuffer(-1)
 	{
 
 	}
@@ -531,6 +767,10 @@ namespace Renderer
 		initializeGlExtensions();
 #endif
 
+		resetStateCache();
+		setupGpuTimer();
+		ShaderCache::init();
+
 		setupDefaultShaders();
 		setupVertexBuffer();
 
@@ -553,6 +793,9 @@ namespace Renderer
 	{
 		bindTexture(0);
 
+		// The current program can be a custom shader deleted below
+		useProgram(nullptr);
+
 		for (auto customShader : _customShaderBatch)
 		{
 			if (customShader.second != nullptr)
@@ -580,11 +823,19 @@ namespace Renderer
 			glDeleteFramebuffers(1, &mFrameBuffer);
 			mFrameBuffer = -1;
 		}
+
+		if (mRenderTargetBuffer != -1)
+		{
+			glDeleteFramebuffers(1, &mRenderTargetBuffer);
+			mRenderTargetBuffer = -1;
+		}
 	}
 
 	void GLES20Renderer::destroyContext()
 	{
 		resetCache();
+		destroyGpuTimer();
+		ShaderCache::deinit();
 
 		SDL_GL_DeleteContext(sdlContext);
 		sdlContext = nullptr;
@@ -593,6 +844,45 @@ namespace Renderer
 
 //////////////////////////////////////////////////////////////////////////
 
+	static void setActiveTexture(GLenum unit)
+	{
+#if OPENGL_EXTENSIONS
+		GL_CHECK_ERROR(glActiveTexture_(unit));
+#else
+		GL_CHECK_ERROR(glActiveTexture(unit));
+#endif
+	}
+
+	// U & V planes of a YUV texture, texture unit 0 is left unbound
+	static GLuint createYuvPlane(const bool _linear, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		GLuint plane = 0;
+		glGenTextures(1, &plane);
+
+		GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, plane));
+		GL_CHECK_ERROR(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+		GL_CHECK_ERROR(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+		GL_CHECK_ERROR(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+		GL_CHECK_ERROR(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _linear ? GL_LINEAR : GL_NEAREST));
+		GL_CHECK_ERROR(glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, _width, _height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, _data));
+
+		return plane;
+	}
+
+	static void uploadYuvPlanes(TextureInfo* info, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		if (_data == nullptr)
+			return;
+
+		unsigned char* planeU = (unsigned char*)_data + _width * _height;
+		unsigned char* planeV = planeU + (_width / 2) * (_height / 2);
+
+		GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, info->planes[0]));
+		GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _width / 2, _height / 2, GL_LUMINANCE, GL_UNSIGNED_BYTE, planeU));
+		GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, info->planes[1]));
+		GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _width / 2, _height / 2, GL_LUMINANCE, GL_UNSIGNED_BYTE, planeV));
+	}
+
 	unsigned int GLES20Renderer::createTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data)
 	{
 		const GLenum type = convertTextureType(_type);
@@ -606,7 +896,6 @@ namespace Renderer
 			return 0;
 		}
 		
-		bindTexture(0);
 		bindTexture(texture);
 
 		GL_CHECK_ERROR(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE));
@@ -657,14 +946,30 @@ namespace Renderer
 			{
 				it->second->type = type;
 				it->second->size = Vector2f(_width, _height);
+				it->second->distanceField = (_type == Texture::DISTANCE_FIELD);
 			}
 			else
 			{
 				auto info = new TextureInfo();
 				info->type = type;
 				info->size = Vector2f(_width, _height);
+				info->distanceField = (_type == Texture::DISTANCE_FIELD);
 				_textures[texture] = info;
 			}
+
+			// The Y plane is the texture itself ( first in the I420 buffer ), U & V are attached to it
+			if (_type == Texture::YUV)
+			{
+				TextureInfo* info = _textures[texture];
+
+				unsigned char* planeU = _data == nullptr ? nullptr : (unsigned char*)_data + _width * _height;
+				unsigned char* planeV = _data == nullptr ? nullptr : planeU + (_width / 2) * (_height / 2);
+
+				info->planes[0] = createYuvPlane(_linear, _width / 2, _height / 2, planeU);
+				info->planes[1] = createYuvPlane(_linear, _width / 2, _height / 2, planeV);
+
+				GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, texture));
+			}
 		}
 
 		return texture;
@@ -680,6 +985,9 @@ namespace Renderer
 		{
 			if (it->second != nullptr)
 			{
+				if (it->second->planes[0] != 0)
+					GL_CHECK_ERROR(glDeleteTextures(2, it->second->planes));
+
 				delete it->second;
 				it->second = nullptr;
 			}
@@ -689,6 +997,10 @@ namespace Renderer
 		
 		GL_CHECK_ERROR(glDeleteTextures(1, &_texture));
 
+		// Deleting a bound texture reverts the binding to 0
+		if (boundTexture == _texture)
+			boundTexture = 0;
+
 	} // destroyTexture
 
 //////////////////////////////////////////////////////////////////////////
@@ -725,14 +1037,22 @@ namespace Renderer
 			{
 				it->second->type = type;
 				it->second->size = Vector2f(_width, _height);
+				it->second->distanceField = (_type == Texture::DISTANCE_FIELD);
 			}
 			else
 			{
 				auto info = new TextureInfo();
 				info->type = type;
 				info->size = Vector2f(_width, _height);
+				info->distanceField = (_type == Texture::DISTANCE_FIELD);
 				_textures[_texture] = info;
 			}
+
+			if (_type == Texture::YUV && _textures[_texture]->planes[0] != 0)
+			{
+				uploadYuvPlanes(_textures[_texture], _width, _height, _data);
+				GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, _texture));
+			}
 		}
 
 		bindTexture(0);
@@ -744,8 +1064,12 @@ namespace Renderer
 	void GLES20Renderer::bindTexture(const unsigned int _texture)
 	{
 		if (boundTexture == _texture)
+		{
+			glStateCallsSkipped++;
 			return;
+		}
 
+		glStateCallsIssued++;
 		boundTexture = _texture;
 
 		if(_texture == 0)
@@ -771,18 +1095,8 @@ namespace Renderer
 		useProgram(&shaderProgramColorNoTexture);
 
 		// Do rendering
-		if (_srcBlendFactor != Blend::ONE && _dstBlendFactor != Blend::ONE)
-		{
-			GL_CHECK_ERROR(glEnable(GL_BLEND));
-			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor)));
-			GL_CHECK_ERROR(glDrawArrays(GL_LINES, 0, _numVertices));
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-		}
-		else
-		{
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-			GL_CHECK_ERROR(glDrawArrays(GL_LINES, 0, _numVertices));
-		}
+		setBlendFactors(_srcBlendFactor, _dstBlendFactor);
+		GL_CHECK_ERROR(glDrawArrays(GL_LINES, 0, _numVertices));
 
 	} // drawLines
 
@@ -797,7 +1111,20 @@ namespace Renderer
 		if (boundTexture != 0)
 		{
 			auto it = _textures.find(boundTexture);
-			if (it != _textures.cend() && it->second != nullptr && it->second->type == GL_ALPHA)
+			if (it != _textures.cend() && it->second != nullptr && it->second->distanceField)
+				useProgram(&shaderProgramDistanceField);
+			else if (it != _textures.cend() && it->second != nullptr && it->second->planes[0] != 0)
+			{
+				useProgram(&shaderProgramYuv);
+				shaderProgramYuv.setSaturation(_vertices->saturation);
+
+				setActiveTexture(GL_TEXTURE1);
+				GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, it->second->planes[0]));
+				setActiveTexture(GL_TEXTURE2);
+				GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, it->second->planes[1]));
+				setActiveTexture(GL_TEXTURE0);
+			}
+			else if (it != _textures.cend() && it->second != nullptr && it->second->type == GL_ALPHA)
 				useProgram(&shaderProgramAlpha);
 			else
 			{
@@ -852,18 +1179,8 @@ namespace Renderer
 			useProgram(&shaderProgramColorNoTexture);
 
 		// Do rendering
-		if (_srcBlendFactor != Blend::ONE && _dstBlendFactor != Blend::ONE)
-		{
-			GL_CHECK_ERROR(glEnable(GL_BLEND));
-			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor)));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_STRIP, 0, _numVertices));
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-		}
-		else
-		{
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_STRIP, 0, _numVertices));
-		}
+		setBlendFactors(_srcBlendFactor, _dstBlendFactor);
+		GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_STRIP, 0, _numVertices));
 	} // drawTriangleStrips
 
 //////////////////////////////////////////////////////////////////////////
@@ -887,8 +1204,10 @@ namespace Renderer
 
 	void GLES20Renderer::setViewport(const Rect& _viewport)
 	{
+		currentViewport = _viewport;
+
 		// glViewport starts at the bottom left of the window
-		GL_CHECK_ERROR(glViewport( _viewport.x, getWindowHeight() - _viewport.y - _viewport.h, _viewport.w, _viewport.h));
+		GL_CHECK_ERROR(glViewport( _viewport.x + renderTargetOffsetX, getWindowHeight() - _viewport.y - _viewport.h + renderTargetOffsetY, _viewport.w, _viewport.h));
 
 	} // setViewport
 
@@ -898,17 +1217,150 @@ namespace Renderer
 	{
 		if((_scissor.x == 0) && (_scissor.y == 0) && (_scissor.w == 0) && (_scissor.h == 0))
 		{
+			if (!scissorEnabled)
+			{
+				glStateCallsSkipped++;
+				return;
+			}
+
 			GL_CHECK_ERROR(glDisable(GL_SCISSOR_TEST));
+			scissorEnabled = false;
+			glStateCallsIssued++;
 		}
 		else
 		{
+			if (scissorEnabled && scissorRect.x == _scissor.x && scissorRect.y == _scissor.y && scissorRect.w == _scissor.w && scissorRect.h == _scissor.h)
+			{
+				glStateCallsSkipped += 2;
+				return;
+			}
+
 			// glScissor starts at the bottom left of the window
-			GL_CHECK_ERROR(glScissor(_scissor.x, getWindowHeight() - _scissor.y - _scissor.h, _scissor.w, _scissor.h));
-			GL_CHECK_ERROR(glEnable(GL_SCISSOR_TEST));
+			GL_CHECK_ERROR(glScissor(_scissor.x + renderTargetOffsetX, getWindowHeight() - _scissor.y - _scissor.h + renderTargetOffsetY, _scissor.w, _scissor.h));
+			glStateCallsIssued++;
+
+			if (!scissorEnabled)
+			{
+				GL_CHECK_ERROR(glEnable(GL_SCISSOR_TEST));
+				glStateCallsIssued++;
+			}
+
+			scissorEnabled = true;
+			scissorRect = _scissor;
 		}
 
 	} // setScissor
 
+//////////////////////////////////////////////////////////////////////////
+
+	void GLES20Renderer::preloadShader(const std::string& path)
+	{
+#if OPENGL_EXTENSIONS
+		// Same requirements as postProcessShader
+		if (glBlitFramebuffer == nullptr || path.empty())
+			return;
+
+		std::string fullPath = ResourceManager::getInstance()->getResourcePath(path);
+		ShaderBatch::getShaderBatch(fullPath.c_str());
+#endif
+	} // preloadShader
+
+//////////////////////////////////////////////////////////////////////////
+
+	bool GLES20Renderer::supportsDistanceField()
+	{
+		return shaderProgramDistanceField.isLinked();
+
+	} // supportsDistanceField
+
+//////////////////////////////////////////////////////////////////////////
+
+	bool GLES20Renderer::supportsYuvTextures()
+	{
+		return shaderProgramYuv.isLinked();
+
+	} // supportsYuvTextures
+
+//////////////////////////////////////////////////////////////////////////
+
+	bool GLES20Renderer::beginRenderTarget(const unsigned int _texture, const Rect& _area)
+	{
+#if OPENGL_EXTENSIONS
+		if (glGenFramebuffers == nullptr || glCheckFramebufferStatus == nullptr || glBlendFuncSeparate == nullptr)
+			return false;
+#endif
+
+		if (renderTargetActive || _texture == 0)
+			return false;
+
+		if (mRenderTargetBuffer == -1)
+			glGenFramebuffers(1, &mRenderTargetBuffer);
+
+		if (mRenderTargetBuffer == -1)
+			return false;
+
+		GL_CHECK_ERROR(glBindFramebuffer(GL_FRAMEBUFFER, mRenderTargetBuffer));
+		GL_CHECK_ERROR(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture, 0));
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			LOG(LogWarning) << "GLES20Renderer : render target is not complete";
+
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			return false;
+		}
+
+		renderTargetActive = true;
+
+		// _area is in window coordinates, top left based
+		renderTargetOffsetX = -_area.x;
+		renderTargetOffsetY = _area.y + _area.h - getWindowHeight();
+
+		if (scissorEnabled)
+		{
+			GL_CHECK_ERROR(glDisable(GL_SCISSOR_TEST));
+			scissorEnabled = false;
+		}
+
+		GL_CHECK_ERROR(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+		GL_CHECK_ERROR(glClear(GL_COLOR_BUFFER_BIT));
+		GL_CHECK_ERROR(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+
+		// The alpha blend function differs while the target is bound
+		blendSrcFactor = GL_ZERO;
+		blendDstFactor = GL_ZERO;
+
+		setViewport(currentViewport);
+		return true;
+
+	} // beginRenderTarget
+
+	void GLES20Renderer::endRenderTarget()
+	{
+		if (!renderTargetActive)
+			return;
+
+		GL_CHECK_ERROR(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0));
+		GL_CHECK_ERROR(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+		renderTargetActive = false;
+		renderTargetOffsetX = 0;
+		renderTargetOffsetY = 0;
+
+		if (scissorEnabled)
+		{
+			GL_CHECK_ERROR(glDisable(GL_SCISSOR_TEST));
+			scissorEnabled = false;
+		}
+
+		blendSrcFactor = GL_ZERO;
+		blendDstFactor = GL_ZERO;
+
+		setViewport(currentViewport);
+
+	} // endRenderTarget
+
 //////////////////////////////////////////////////////////////////////////
 
 	void GLES20Renderer::setSwapInterval()
@@ -939,6 +1391,11 @@ namespace Renderer
 		GL_CHECK_ERROR(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 	} // swapBuffers
 
+	void GLES20Renderer::waitForGpu()
+	{
+		GL_CHECK_ERROR(glFinish());
+	} // waitForGpu
+
 //////////////////////////////////////////////////////////////////////////
 	
 	void GLES20Renderer::drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
@@ -962,18 +1419,8 @@ namespace Renderer
 			useProgram(&shaderProgramColorNoTexture);
 
 		// Do rendering
-		if (_srcBlendFactor != Blend::ONE && _dstBlendFactor != Blend::ONE)
-		{
-			GL_CHECK_ERROR(glEnable(GL_BLEND));
-			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor)));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices));
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-		}
-		else
-		{
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices));			
-		}
+		setBlendFactors(_srcBlendFactor, _dstBlendFactor);
+		GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices));
 	}
 
 	void GLES20Renderer::setStencil(const Vertex* _vertices, const unsigned int _numVertices)
@@ -991,11 +1438,9 @@ namespace Renderer
 		glStencilFunc(GL_ALWAYS, 1, ~0);
 		glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
 
-		glEnable(GL_BLEND);
-		glBlendFunc(convertBlendFactor(Blend::SRC_ALPHA), convertBlendFactor(Blend::ONE_MINUS_SRC_ALPHA));
+		setBlendState(true);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * _numVertices, _vertices, GL_DYNAMIC_DRAW);
 		glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices);
-		glDisable(GL_BLEND);
 
 		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 		glDepthMask(GL_TRUE);
@@ -1009,6 +1454,67 @@ namespace Renderer
 		glDisable(GL_STENCIL_TEST);
 	}
 
+	void GLES20Renderer::collectStateStats(BatchStats& stats)
+	{
+		stats.stateCalls = glStateCallsIssued;
+		stats.skippedStateCalls = glStateCallsSkipped;
+
+		glStateCallsIssued = 0;
+		glStateCallsSkipped = 0;
+
+	} // collectStateStats
+
+//////////////////////////////////////////////////////////////////////////
+
+	void GLES20Renderer::beginGpuTimer()
+	{
+		// The oldest query has not been read yet : skip this frame
+		if (gpuGenQueries == nullptr || gpuQueryRunning || gpuQueryPending[gpuQueryIndex])
+			return;
+
+		gpuBeginQuery(GL_TIME_ELAPSED, gpuQueries[gpuQueryIndex]);
+		gpuQueryRunning = true;
+
+	} // beginGpuTimer
+
+	void GLES20Renderer::endGpuTimer()
+	{
+		if (!gpuQueryRunning)
+			return;
+
+		gpuEndQuery(GL_TIME_ELAPSED);
+		gpuQueryRunning = false;
+		gpuQueryPending[gpuQueryIndex] = true;
+		gpuQueryIndex = (gpuQueryIndex + 1) % GPU_QUERIES;
+
+		// Read the available results, oldest first
+		for (int i = 0; i < GPU_QUERIES; i++)
+		{
+			int query = (gpuQueryIndex + i) % GPU_QUERIES;
+			if (!gpuQueryPending[query])
+				continue;
+
+			GLint available = 0;
+			gpuGetQueryObjectiv(gpuQueries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				break;
+
+			uint64_t elapsed = 0;
+			gpuGetQueryObjectui64v(gpuQueries[query], GL_QUERY_RESULT, &elapsed);
+			gpuQueryPending[query] = false;
+			gpuTime = (float)((double)elapsed / 1000000.0);
+		}
+
+	} // endGpuTimer
+
+	float GLES20Renderer::getGpuTime()
+	{
+		return gpuTime;
+
+	} // getGpuTime
+
+//////////////////////////////////////////////////////////////////////////
+
 	size_t GLES20Renderer::getTotalMemUsage()
 	{
 		size_t total = 0;
@@ -1018,6 +1524,9 @@ namespace Renderer
 			if (tex.first != 0 && tex.second)
 			{
 				size_t size = tex.second->size.x() * tex.second->size.y() * (tex.second->type == GL_ALPHA ? 1 : 4);
+				if (tex.second->planes[0] != 0)
+					size = tex.second->size.x() * tex.second->size.y() * 3 / 2;
+
 				total += size;
 			}
 		}	
@@ -1101,9 +1610,9 @@ namespace Renderer
 			auto oldProgram = currentProgram;
 			auto oldMatrix = worldViewMatrix;
 
-			GLboolean oldCissors;
-			glGetBooleanv(GL_SCISSOR_TEST, &oldCissors);
-			glDisable(GL_SCISSOR_TEST);
+			bool oldCissors = scissorEnabled;
+			if (oldCissors)
+				glDisable(GL_SCISSOR_TEST);
 
 			setMatrix(Transform4x4f::Identity());
 
@@ -1208,10 +1717,8 @@ namespace Renderer
 				for (auto param : parameters)
 					customShader->setUniformEx(param.first, param.second);
 
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				setBlendState(true);
 				glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-				glDisable(GL_BLEND);
 			}
 
 			bindTexture(0);
@@ -48,13 +48,26 @@ namespace Renderer
 
 		void         setSwapInterval() override;
 		void         swapBuffers() override;
+		void		 waitForGpu() override;
 		
 		void		 postProcessShader(const std::string& path, const float _x, const float _y, const float _w, const float _h, const std::map<std::string, std::string>& parameters, unsigned int* data = nullptr);
+		void		 preloadShader(const std::string& path) override;
+		bool		 supportsDistanceField() override;
+		bool		 supportsYuvTextures() override;
 
 		size_t		 getTotalMemUsage() override;
+		void		 collectStateStats(BatchStats& stats) override;
+
+		void		 beginGpuTimer() override;
+		void		 endGpuTimer() override;
+		float		 getGpuTime() override;
+
+		bool		 beginRenderTarget(const unsigned int _texture, const Rect& _area) override;
+		void		 endRenderTarget() override;
 
 	private:
 		unsigned int mFrameBuffer;
+		unsigned int mRenderTargetBuffer;
 	};
 }
 
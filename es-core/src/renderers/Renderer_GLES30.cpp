@@ -0,0 +1,184 @@
+#include "Renderer_GLES30.h"
+
+#ifdef RENDERER_GLES_30
+
+#include "GlExtensions.h"
+#include "Shader.h"
+#include "Log.h"
+
+#ifndef GL_MAJOR_VERSION
+#define GL_MAJOR_VERSION		0x821B
+#endif
+#ifndef GL_MINOR_VERSION
+#define GL_MINOR_VERSION		0x821C
+#endif
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER	0x88EC
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW			0x88E0
+#endif
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+// Smaller uploads ( glyphs, small icons ) are cheaper to send directly
+#define PIXEL_BUFFER_MIN_SIZE	(64 * 1024)
+
+namespace Renderer
+{
+	// GLES 3.0 entry points are not declared by SDL_opengles2.h
+	typedef void (APIENTRY* GenVertexArraysProc)(GLsizei n, GLuint* arrays);
+	typedef void (APIENTRY* DeleteVertexArraysProc)(GLsizei n, const GLuint* arrays);
+	typedef void (APIENTRY* BindVertexArrayProc)(GLuint array);
+
+	static GenVertexArraysProc		gles3GenVertexArrays    = nullptr;
+	static DeleteVertexArraysProc	gles3DeleteVertexArrays = nullptr;
+	static BindVertexArrayProc		gles3BindVertexArray    = nullptr;
+
+	GLES30Renderer::GLES30Renderer() : GLES20Renderer(), mContext3(false), mVertexArray(0), mPixelBuffer(0)
+	{
+
+	}
+
+	std::string GLES30Renderer::getDriverName()
+	{
+		return "OPENGL ES 3.0";
+	}
+
+	std::vector<std::pair<std::string, std::string>> GLES30Renderer::getDriverInformation()
+	{
+		std::vector<std::pair<std::string, std::string>> info = GLES20Renderer::getDriverInformation();
+
+		if (mContext3)
+			info.push_back(std::pair<std::string, std::string>("FEATURES", std::string("VAO") + (mPixelBuffer != 0 ? ", PBO" : "") + ", INSTANCING, TEXTURE ARRAYS, ETC2"));
+		else
+			info.push_back(std::pair<std::string, std::string>("FEATURES", "GLES 2.0 FALLBACK"));
+
+		return info;
+	}
+
+	void GLES30Renderer::setupWindow()
+	{
+		GLES20Renderer::setupWindow();
+
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+
+	} // setupWindow
+
+	void GLES30Renderer::createContext()
+	{
+		GLES20Renderer::createContext();
+
+		mContext3 = false;
+		mVertexArray = 0;
+		mPixelBuffer = 0;
+
+		GLint major = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+
+		// GL_MAJOR_VERSION is unknown to 2.0 contexts
+		while (glGetError() != GL_NO_ERROR)
+			;
+
+		if (major < 3)
+		{
+			LOG(LogWarning) << "GLES30Renderer : the driver gave a GLES " << (major > 0 ? major : 2) << " context, using the GLES 2.0 paths";
+			return;
+		}
+
+		gles3GenVertexArrays    = (GenVertexArraysProc)SDL_GL_GetProcAddress("glGenVertexArrays");
+		gles3DeleteVertexArrays = (DeleteVertexArraysProc)SDL_GL_GetProcAddress("glDeleteVertexArrays");
+		gles3BindVertexArray    = (BindVertexArrayProc)SDL_GL_GetProcAddress("glBindVertexArray");
+
+		if (gles3GenVertexArrays == nullptr || gles3DeleteVertexArrays == nullptr || gles3BindVertexArray == nullptr)
+		{
+			LOG(LogWarning) << "GLES30Renderer : GLES 3.0 entry points missing, using the GLES 2.0 paths";
+			return;
+		}
+
+		mContext3 = true;
+
+		// All programs share one vertex buffer & layout : a single VAO keeps the attribute setup for the whole session
+		GL_CHECK_ERROR(gles3GenVertexArrays(1, &mVertexArray));
+		GL_CHECK_ERROR(gles3BindVertexArray(mVertexArray));
+
+		// The attributes enabled while the default shaders were set up belong to the default VAO
+		ShaderProgram::resetAttributeCache();
+
+		GL_CHECK_ERROR(glGenBuffers(1, &mPixelBuffer));
+
+		LOG(LogInfo) << " GLES 3.0 context: ok";
+
+	} // createContext
+
+	void GLES30Renderer::destroyContext()
+	{
+		if (mPixelBuffer != 0)
+			GL_CHECK_ERROR(glDeleteBuffers(1, &mPixelBuffer));
+
+		if (mVertexArray != 0)
+		{
+			GL_CHECK_ERROR(gles3BindVertexArray(0));
+			GL_CHECK_ERROR(gles3DeleteVertexArrays(1, &mVertexArray));
+		}
+
+		mPixelBuffer = 0;
+		mVertexArray = 0;
+		mContext3 = false;
+
+		GLES20Renderer::destroyContext();
+
+	} // destroyContext
+
+	bool GLES30Renderer::beginPixelUpload(const Texture::Type _type, const unsigned int _width, const unsigned int _height, const void* _data)
+	{
+		if (mPixelBuffer == 0 || _data == nullptr)
+			return false;
+
+		const size_t size = (size_t)_width * _height * (_type == Texture::RGBA ? 4 : 1);
+		if (size < PIXEL_BUFFER_MIN_SIZE)
+			return false;
+
+		// Orphan the previous storage, so the driver never waits for a transfer still in flight
+		GL_CHECK_ERROR(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mPixelBuffer));
+		GL_CHECK_ERROR(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, _data, GL_STREAM_DRAW));
+		return true;
+	}
+
+	void GLES30Renderer::endPixelUpload()
+	{
+		// A bound unpack buffer would turn the pointers of every other upload into offsets
+		GL_CHECK_ERROR(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	}
+
+	unsigned int GLES30Renderer::createTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		if (!beginPixelUpload(_type, _width, _height, _data))
+			return GLES20Renderer::createTexture(_type, _linear, _repeat, _width, _height, _data);
+
+		// With an unpack buffer bound, a null pointer is the offset 0 of the buffer
+		unsigned int texture = GLES20Renderer::createTexture(_type, _linear, _repeat, _width, _height, nullptr);
+		endPixelUpload();
+
+		return texture;
+
+	} // createTexture
+
+	void GLES30Renderer::updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		if (!beginPixelUpload(_type, _width, _height, _data))
+		{
+			GLES20Renderer::updateTexture(_texture, _type, _x, _y, _width, _height, _data);
+			return;
+		}
+
+		GLES20Renderer::updateTexture(_texture, _type, _x, _y, _width, _height, nullptr);
+		endPixelUpload();
+
+	} // updateTexture
+
+} // Renderer::
+
+#endif // RENDERER_GLES_30
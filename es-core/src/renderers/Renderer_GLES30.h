@@ -0,0 +1,43 @@
+#pragma once
+#ifndef ES_CORE_RENDERER_GLES30_H
+#define ES_CORE_RENDERER_GLES30_H
+
+#if defined(USE_OPENGLES_20)
+
+#define RENDERER_GLES_30
+
+#include "Renderer_GLES20.h"
+
+namespace Renderer
+{
+	// GLES 3.x context on top of the GLES 2.0 backend : the vertex layout lives in a vertex array object, and large texture uploads go
+	// through a pixel unpack buffer so the copy to the GPU doesn't stall the frame. Falls back to the GLES 2.0 paths when the driver only gives a 2.0 context
+	class GLES30Renderer : public GLES20Renderer
+	{
+	public:
+		GLES30Renderer();
+
+		std::string getDriverName() override;
+		std::vector<std::pair<std::string, std::string>> getDriverInformation() override;
+
+		void         setupWindow() override;
+
+		void         createContext() override;
+		void         destroyContext() override;
+
+		unsigned int createTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data) override;
+		void         updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data) override;
+
+	private:
+		bool         beginPixelUpload(const Texture::Type _type, const unsigned int _width, const unsigned int _height, const void* _data);
+		void         endPixelUpload();
+
+		bool         mContext3;
+		unsigned int mVertexArray;
+		unsigned int mPixelBuffer;
+	};
+}
+
+#endif // USE_OPENGLES_20
+
+#endif // ES_CORE_RENDERER_GLES30_H
@@ -0,0 +1,205 @@
+#include "Renderer_Null.h"
+
+#include "math/Transform4x4f.h"
+
+#include <SDL.h>
+
+namespace Renderer
+{
+	static size_t getTextureSize(const Texture::Type _type, const unsigned int _width, const unsigned int _height)
+	{
+		switch (_type)
+		{
+			case Texture::RGBA: { return (size_t)_width * _height * 4;     } break;
+			case Texture::YUV:  { return (size_t)_width * _height * 3 / 2; } break;
+			default:            { return (size_t)_width * _height;         }
+		}
+
+	} // getTextureSize
+
+	NullRenderer::NullRenderer() : mNextTexture(1), mBoundTexture(0), mStateCalls(0), mSkippedStateCalls(0), mTextureMemory(0)
+	{
+
+	} // NullRenderer
+
+	std::string NullRenderer::getDriverName()
+	{
+		return "NULL";
+
+	} // getDriverName
+
+	std::vector<std::pair<std::string, std::string>> NullRenderer::getDriverInformation()
+	{
+		std::vector<std::pair<std::string, std::string>> info;
+		info.push_back(std::pair<std::string, std::string>("GRAPHICS API", getDriverName()));
+		info.push_back(std::pair<std::string, std::string>("TEXTURES", std::to_string(mTextureSizes.size())));
+		return info;
+
+	} // getDriverInformation
+
+	unsigned int NullRenderer::getWindowFlags()
+	{
+		return SDL_WINDOW_HIDDEN;
+
+	} // getWindowFlags
+
+	void NullRenderer::setupWindow()
+	{
+
+	} // setupWindow
+
+	void NullRenderer::createContext()
+	{
+
+	} // createContext
+
+	void NullRenderer::destroyContext()
+	{
+		mTextureSizes.clear();
+		mTextureMemory = 0;
+		mBoundTexture = 0;
+
+	} // destroyContext
+
+	void NullRenderer::resetCache()
+	{
+		mBoundTexture = 0;
+
+	} // resetCache
+
+	unsigned int NullRenderer::createTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		unsigned int texture = mNextTexture++;
+
+		size_t size = getTextureSize(_type, _width, _height);
+		mTextureSizes[texture] = size;
+		mTextureMemory += size;
+
+		return texture;
+
+	} // createTexture
+
+	void NullRenderer::destroyTexture(const unsigned int _texture)
+	{
+		auto it = mTextureSizes.find(_texture);
+		if (it == mTextureSizes.cend())
+			return;
+
+		mTextureMemory -= it->second;
+		mTextureSizes.erase(it);
+
+		if (mBoundTexture == _texture)
+			mBoundTexture = 0;
+
+	} // destroyTexture
+
+	void NullRenderer::updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		// A full update can resize the texture
+		if (_x != 0 || _y != 0)
+			return;
+
+		auto it = mTextureSizes.find(_texture);
+		if (it == mTextureSizes.cend())
+			return;
+
+		size_t size = getTextureSize(_type, _width, _height);
+		if (size > it->second)
+		{
+			mTextureMemory += size - it->second;
+			it->second = size;
+		}
+
+	} // updateTexture
+
+	void NullRenderer::bindTexture(const unsigned int _texture)
+	{
+		if (mBoundTexture == _texture)
+		{
+			mSkippedStateCalls++;
+			return;
+		}
+
+		mBoundTexture = _texture;
+		mStateCalls++;
+
+	} // bindTexture
+
+	void NullRenderer::drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+
+	} // drawLines
+
+	void NullRenderer::drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor, bool verticesChanged)
+	{
+
+	} // drawTriangleStrips
+
+	void NullRenderer::drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+
+	} // drawTriangleFan
+
+	void NullRenderer::setProjection(const Transform4x4f& _projection)
+	{
+		mStateCalls++;
+
+	} // setProjection
+
+	void NullRenderer::setMatrix(const Transform4x4f& _matrix)
+	{
+		mStateCalls++;
+
+	} // setMatrix
+
+	void NullRenderer::setViewport(const Rect& _viewport)
+	{
+		mStateCalls++;
+
+	} // setViewport
+
+	void NullRenderer::setScissor(const Rect& _scissor)
+	{
+		mStateCalls++;
+
+	} // setScissor
+
+	void NullRenderer::setStencil(const Vertex* _vertices, const unsigned int _numVertices)
+	{
+		mStateCalls++;
+
+	} // setStencil
+
+	void NullRenderer::disableStencil()
+	{
+		mStateCalls++;
+
+	} // disableStencil
+
+	void NullRenderer::setSwapInterval()
+	{
+
+	} // setSwapInterval
+
+	void NullRenderer::swapBuffers()
+	{
+
+	} // swapBuffers
+
+	size_t NullRenderer::getTotalMemUsage()
+	{
+		return mTextureMemory;
+
+	} // getTotalMemUsage
+
+	void NullRenderer::collectStateStats(BatchStats& stats)
+	{
+		stats.stateCalls = mStateCalls;
+		stats.skippedStateCalls = mSkippedStateCalls;
+
+		mStateCalls = 0;
+		mSkippedStateCalls = 0;
+
+	} // collectStateStats
+
+} // Renderer::
@@ -1,14 +1,62 @@
 #include "Shader.h"
+#include "ShaderCache.h"
 #include "Log.h"
 #include "renderers/Renderer.h"
 #include "resources/ResourceManager.h"
 #include "utils/StringUtil.h"
 #include "utils/HtmlColor.h"
 
+#include <cstring>
+
 namespace Renderer
 {
 	std::string SHADER_VERSION_STRING;
 
+	unsigned int glStateCallsIssued = 0;
+	unsigned int glStateCallsSkipped = 0;
+
+	#define MAX_CACHED_ATTRIBUTES 16
+
+	// Vertex offset set up for each enabled attribute array, -1 when disabled. All programs share the same vertex buffer & layout
+	static int attributeOffsets[MAX_CACHED_ATTRIBUTES] = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+
+	static void enableAttribute(GLint location, GLint size, GLenum type, GLboolean normalized, int offset)
+	{
+		if (location < 0)
+			return;
+
+		if (location < MAX_CACHED_ATTRIBUTES && attributeOffsets[location] == offset)
+		{
+			glStateCallsSkipped += 2;
+			return;
+		}
+
+		GL_CHECK_ERROR(glVertexAttribPointer(location, size, type, normalized, sizeof(Vertex), (const void*)(size_t)offset));
+		GL_CHECK_ERROR(glEnableVertexAttribArray(location));
+		glStateCallsIssued += 2;
+
+		if (location < MAX_CACHED_ATTRIBUTES)
+			attributeOffsets[location] = offset;
+	}
+
+	static void disableAttribute(GLint location)
+	{
+		if (location < 0)
+			return;
+
+		GL_CHECK_ERROR(glDisableVertexAttribArray(location));
+		glStateCallsIssued++;
+
+		if (location < MAX_CACHED_ATTRIBUTES)
+			attributeOffsets[location] = -1;
+	}
+
+	void ShaderProgram::resetAttributeCache()
+	{
+		for (int i = 0; i < MAX_CACHED_ATTRIBUTES; i++)
+			attributeOffsets[i] = -1;
+	}
+
 	Shader Shader::createShader(GLenum type, const std::string& source)
 	{
 		const GLuint shaderId = glCreateShader(type);
@@ -88,7 +136,9 @@ namespace Renderer
 		mOutputSize(-1),
 		mInputSize(-1),
 		mTextureSize(-1),
-		mResolution(-1)
+		mResolution(-1),
+		mCachedUniforms(0),
+		mSaturationValue(1.0f)
 	{
 	}
 
@@ -103,6 +153,7 @@ namespace Renderer
 
 			GL_CHECK_ERROR(glDeleteProgram(mId));
 			mId = -1;
+			mCachedUniforms = 0;
 		}
 	}
 
@@ -119,20 +170,45 @@ namespace Renderer
 
 		std::string versionString = SHADER_VERSION_STRING;
 
-		Shader vertex = Shader::createShader(GL_VERTEX_SHADER, versionString + "#define VERTEX\n" + shaderCode);
+		return loadFromSource(versionString + "#define VERTEX\n" + shaderCode, versionString + "#define FRAGMENT\n" + shaderCode);
+	}
+
+	bool ShaderProgram::loadFromSource(const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		if (ShaderCache::isAvailable())
+		{
+			GLuint programId = glCreateProgram();
+			if (ShaderCache::load(programId, vertexSource, fragmentSource))
+			{
+				this->linkStatus = true;
+				this->mId = programId;
+				this->mCachedUniforms = 0;
+				findAttribsAndUniforms();
+				return true;
+			}
+
+			GL_CHECK_ERROR(glDeleteProgram(programId));
+		}
+
+		Shader vertex = Shader::createShader(GL_VERTEX_SHADER, vertexSource);
 		if (vertex.id < 0)
 			return false;
 
-		Shader fragment = Shader::createShader(GL_FRAGMENT_SHADER, versionString + "#define FRAGMENT\n" + shaderCode);
+		Shader fragment = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSource);
 		if (fragment.id < 0)
 			return false;
 
-		return createShaderProgram(vertex, fragment);
+		if (!createShaderProgram(vertex, fragment))
+			return false;
+
+		ShaderCache::save(mId, vertexSource, fragmentSource);
+		return true;
 	}
 
 	bool ShaderProgram::createShaderProgram(Shader &vertexShader, Shader &fragmentShader)
 	{
 		GLuint programId = glCreateProgram();
+		ShaderCache::prepare(programId);
 
 		GL_CHECK_ERROR(glAttachShader(programId, vertexShader.id));
 		GL_CHECK_ERROR(glAttachShader(programId, fragmentShader.id));
@@ -175,6 +251,7 @@ namespace Renderer
 		if (this->linkStatus == GL_TRUE)
 		{
 			this->mId = programId;
+			this->mCachedUniforms = 0;
 			findAttribsAndUniforms();
 			return true;
 		}
@@ -232,37 +309,62 @@ namespace Renderer
 		}
 	}
 
+	void ShaderProgram::setUniformVector2f(GLint location, CachedUniform uniform, Vector2f& cache, const Vector2f& value)
+	{
+		if (location == -1)
+			return;
+
+		if (isUniformCached(uniform) && cache == value)
+		{
+			glStateCallsSkipped++;
+			return;
+		}
+
+		GL_CHECK_ERROR(glUniform2f(location, value.x(), value.y()));
+		glStateCallsIssued++;
+
+		cache = value;
+		mCachedUniforms |= uniform;
+	}
+
 	void ShaderProgram::setSaturation(GLfloat saturation)
 	{
-		if (mSaturation != -1)
-			GL_CHECK_ERROR(glUniform1f(mSaturation, saturation));
+		if (mSaturation == -1)
+			return;
+
+		if (isUniformCached(UNIFORM_SATURATION) && mSaturationValue == saturation)
+		{
+			glStateCallsSkipped++;
+			return;
+		}
+
+		GL_CHECK_ERROR(glUniform1f(mSaturation, saturation));
+		glStateCallsIssued++;
+
+		mSaturationValue = saturation;
+		mCachedUniforms |= UNIFORM_SATURATION;
 	}
 
 	void ShaderProgram::setTextureSize(const Vector2f& size)
 	{
-		if (mTextureSize != -1)
-			GL_CHECK_ERROR(glUniform2f(mTextureSize, size.x(), size.y()));
+		setUniformVector2f(mTextureSize, UNIFORM_TEXTURESIZE, mTextureSizeValue, size);
 	}
 	
 	void ShaderProgram::setOutputSize(const Vector2f& size)
 	{
-		if (mOutputSize != -1)
-			GL_CHECK_ERROR(glUniform2f(mOutputSize, size.x(), size.y()));
+		setUniformVector2f(mOutputSize, UNIFORM_OUTPUTSIZE, mOutputSizeValue, size);
 	}
 
 	void ShaderProgram::setInputSize(const Vector2f& size)
 	{
-		if (mInputSize != -1)
-			GL_CHECK_ERROR(glUniform2f(mInputSize, size.x(), size.y()));
+		setUniformVector2f(mInputSize, UNIFORM_INPUTSIZE, mInputSizeValue, size);
 	}
 
 	void ShaderProgram::setResolution()
 	{
-		if (mResolution != -1)
-			GL_CHECK_ERROR(glUniform2f(mResolution, getScreenWidth(), getScreenHeight()));
+		setUniformVector2f(mResolution, UNIFORM_RESOLUTION, mResolutionValue, Vector2f((float)getScreenWidth(), (float)getScreenHeight()));
 	}
 
-
 	void ShaderProgram::setUniformFloat(const std::string& name, const GLfloat& value)
 	{
 		GLint location = glGetUniformLocation(mId, name.c_str());
@@ -270,6 +372,13 @@ namespace Renderer
 			GL_CHECK_ERROR(glUniform1f(location, value));
 	}
 
+	void ShaderProgram::setUniformInt(const std::string& name, const GLint& value)
+	{
+		GLint location = glGetUniformLocation(mId, name.c_str());
+		if (location != -1)
+			GL_CHECK_ERROR(glUniform1i(location, value));
+	}
+
 	void ShaderProgram::setUniformVector2f(const std::string& name, const Vector2f& value)
 	{
 		GLint location = glGetUniformLocation(mId, name.c_str());
@@ -332,44 +441,39 @@ namespace Renderer
 
 	void ShaderProgram::setMatrix(Transform4x4f& mvpMatrix)
 	{
-		if (mvpUniform != -1 && mvpUniform != GL_INVALID_VALUE && mvpUniform != GL_INVALID_OPERATION)
-			GL_CHECK_ERROR(glUniformMatrix4fv(mvpUniform, 1, GL_FALSE, (float*)&mvpMatrix));
+		if (mvpUniform == -1 || mvpUniform == GL_INVALID_VALUE || mvpUniform == GL_INVALID_OPERATION)
+			return;
+
+		if (isUniformCached(UNIFORM_MATRIX) && memcmp(&mMatrixValue, &mvpMatrix, sizeof(Transform4x4f)) == 0)
+		{
+			glStateCallsSkipped++;
+			return;
+		}
+
+		GL_CHECK_ERROR(glUniformMatrix4fv(mvpUniform, 1, GL_FALSE, (float*)&mvpMatrix));
+		glStateCallsIssued++;
+
+		mMatrixValue = mvpMatrix;
+		mCachedUniforms |= UNIFORM_MATRIX;
 	}
 
 	void ShaderProgram::select()
 	{
 		GL_CHECK_ERROR(glUseProgram(mId));
+		glStateCallsIssued++;
 
-		if (mPositionAttribute != -1)
-		{
-			GL_CHECK_ERROR(glVertexAttribPointer(mPositionAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, pos)));
-			GL_CHECK_ERROR(glEnableVertexAttribArray(mPositionAttribute));
-		}
-
-		if (mColorAttribute != -1)
-		{
-			GL_CHECK_ERROR(glVertexAttribPointer(mColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (const void*)offsetof(Vertex, col)));
-			GL_CHECK_ERROR(glEnableVertexAttribArray(mColorAttribute));
-		}
-
-		if (mTexCoordAttribute != -1)
-		{
-			GL_CHECK_ERROR(glVertexAttribPointer(mTexCoordAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, tex)));
-			GL_CHECK_ERROR(glEnableVertexAttribArray(mTexCoordAttribute));
-		}
+		enableAttribute(mPositionAttribute, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, pos));
+		enableAttribute(mColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Vertex, col));
+		enableAttribute(mTexCoordAttribute, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, tex));
 	}
 
 	void ShaderProgram::unSelect()
 	{
 		GL_CHECK_ERROR(glUseProgram(0));
+		glStateCallsIssued++;
 
-		if (mPositionAttribute != -1)
-			GL_CHECK_ERROR(glDisableVertexAttribArray(mPositionAttribute));
-
-		if (mColorAttribute != -1)
-			GL_CHECK_ERROR(glDisableVertexAttribArray(mColorAttribute));
-
-		if (mTexCoordAttribute != -1)
-			GL_CHECK_ERROR(glDisableVertexAttribArray(mTexCoordAttribute));
+		disableAttribute(mPositionAttribute);
+		disableAttribute(mColorAttribute);
+		disableAttribute(mTexCoordAttribute);
 	}
 }
\ No newline at end of file
@@ -4,12 +4,17 @@
 
 #include "GlExtensions.h"
 #include "math/Transform4x4f.h"
+#include "math/Vector2f.h"
 
 #include <string>
 #include <vector>
 
 namespace Renderer
 {
+	// GL state changes sent to the driver, and those skipped because the shadow state already matched
+	extern unsigned int glStateCallsIssued;
+	extern unsigned int glStateCallsSkipped;
+
 	class Shader
 	{
 	public:
@@ -38,6 +43,9 @@ namespace Renderer
 
 		bool loadFromFile(const std::string& path);
 
+		// Compiles & links the sources, or loads the program binary from the shader cache
+		bool loadFromSource(const std::string& vertexSource, const std::string& fragmentSource);
+
 		// Links vertex and fragment shaders together to make a GLSL program
 		bool createShaderProgram(Shader &vertexShader, Shader &fragmentShader);
 
@@ -52,14 +60,32 @@ namespace Renderer
 		void setResolution();
 
 		void setUniformFloat(const std::string& name, const GLfloat& value);
+		void setUniformInt(const std::string& name, const GLint& value);
 		void setUniformVector2f(const std::string& name, const Vector2f& value);
 		void setUniformEx(const std::string& name, const std::string value);
 
 		bool supportsTextureSize() { return mTextureSize != -1; }
+		bool isLinked() const { return linkStatus; }
 
 		void deleteProgram();
 
+		// Forgets the vertex attribute arrays assumed to be enabled, after the context was (re)created
+		static void resetAttributeCache();
+
 	private:
+		enum CachedUniform
+		{
+			UNIFORM_MATRIX      = 1,
+			UNIFORM_SATURATION  = 2,
+			UNIFORM_TEXTURESIZE = 4,
+			UNIFORM_OUTPUTSIZE  = 8,
+			UNIFORM_INPUTSIZE   = 16,
+			UNIFORM_RESOLUTION  = 32
+		};
+
+		bool isUniformCached(CachedUniform uniform) { return (mCachedUniforms & uniform) != 0; }
+		void setUniformVector2f(GLint location, CachedUniform uniform, Vector2f& cache, const Vector2f& value);
+
 		GLuint mId;
 		bool linkStatus;
 		GLint mPositionAttribute;
@@ -75,6 +101,15 @@ namespace Renderer
 
 		std::vector<Shader> mAttachedShaders;
 
+		// Last values sent to the program uniforms
+		unsigned int  mCachedUniforms;
+		Transform4x4f mMatrixValue;
+		GLfloat       mSaturationValue;
+		Vector2f      mTextureSizeValue;
+		Vector2f      mOutputSizeValue;
+		Vector2f      mInputSizeValue;
+		Vector2f      mResolutionValue;
+
 	private:
 		void findAttribsAndUniforms();
 	};
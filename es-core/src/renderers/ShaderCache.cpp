@@ -0,0 +1,209 @@
+#include "renderers/ShaderCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/BinaryStream.h"
+#include "utils/MemoryMappedFile.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <fstream>
+
+#define SHADER_CACHE_MAGIC		0x43485345 // 'ESHC'
+#define SHADER_CACHE_VERSION	"1"
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH			0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS		0x87FE
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT	0x8257
+#endif
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+namespace Renderer
+{
+	// GL_ARB_get_program_binary on desktop GL, GL_OES_get_program_binary on GLES
+	typedef void (APIENTRY* GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+	typedef void (APIENTRY* ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLint length);
+	typedef void (APIENTRY* ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+	static GetProgramBinaryProc		shaderGetProgramBinary   = nullptr;
+	static ProgramBinaryProc		shaderProgramBinary      = nullptr;
+	static ProgramParameteriProc	shaderProgramParameteri  = nullptr;
+
+	bool ShaderCache::mAvailable = false;
+	std::string ShaderCache::mDriver;
+
+	static std::string getGLString(GLenum name)
+	{
+		const GLubyte* value = glGetString(name);
+		return value != nullptr ? (const char*)value : "";
+	}
+
+	void ShaderCache::init()
+	{
+		mAvailable = false;
+
+		if (!Settings::getInstance()->getBool("ShaderCache"))
+			return;
+
+		std::string suffix;
+		if (SDL_GL_ExtensionSupported("GL_ARB_get_program_binary"))
+			suffix = "";
+		else if (SDL_GL_ExtensionSupported("GL_OES_get_program_binary"))
+			suffix = "OES";
+		else
+			return;
+
+		shaderGetProgramBinary = (GetProgramBinaryProc)SDL_GL_GetProcAddress(("glGetProgramBinary" + suffix).c_str());
+		shaderProgramBinary = (ProgramBinaryProc)SDL_GL_GetProcAddress(("glProgramBinary" + suffix).c_str());
+
+		// Desktop drivers may not keep the binary unless asked before linking
+		shaderProgramParameteri = suffix.empty() ? (ProgramParameteriProc)SDL_GL_GetProcAddress("glProgramParameteri") : nullptr;
+
+		if (shaderGetProgramBinary == nullptr || shaderProgramBinary == nullptr)
+			return;
+
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		if (formats <= 0)
+			return;
+
+		mDriver = getGLString(GL_VENDOR) + "|" + getGLString(GL_RENDERER) + "|" + getGLString(GL_VERSION);
+
+		// Binaries of another driver are rejected anyway : drop them instead of letting them pile up
+		std::string folder = getCacheFolder();
+		std::string driverPath = folder + "/driver.txt";
+
+		if (!Utils::FileSystem::exists(folder))
+			Utils::FileSystem::createDirectory(folder);
+		else if (Utils::FileSystem::readAllText(driverPath) != mDriver)
+		{
+			LOG(LogInfo) << "ShaderCache : driver changed, clearing the cache";
+			clear();
+		}
+
+		if (!Utils::FileSystem::exists(driverPath))
+			Utils::FileSystem::writeAllText(driverPath, mDriver);
+
+		mAvailable = true;
+
+		LOG(LogInfo) << " Shader binary cache: ok";
+	}
+
+	void ShaderCache::deinit()
+	{
+		mAvailable = false;
+
+		shaderGetProgramBinary = nullptr;
+		shaderProgramBinary = nullptr;
+		shaderProgramParameteri = nullptr;
+	}
+
+	std::string ShaderCache::getCacheFolder()
+	{
+		return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/shaders");
+	}
+
+	std::string ShaderCache::getKey(const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		return SHADER_CACHE_VERSION "|" + mDriver + "|" + vertexSource + "|" + fragmentSource;
+	}
+
+	std::string ShaderCache::getCachePath(const std::string& key)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)std::hash<std::string>()(key));
+		return getCacheFolder() + "/" + name;
+	}
+
+	void ShaderCache::prepare(GLuint programId)
+	{
+		if (mAvailable && shaderProgramParameteri != nullptr)
+			GL_CHECK_ERROR(shaderProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+	}
+
+	bool ShaderCache::load(GLuint programId, const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		if (!mAvailable)
+			return false;
+
+		std::string key = getKey(vertexSource, fragmentSource);
+		std::string cachePath = getCachePath(key);
+
+		Utils::MemoryMappedFile file(cachePath);
+		if (!file.isOpen())
+			return false;
+
+		Utils::BinaryReader reader(file.data(), file.size());
+		if (reader.readUInt32() != SHADER_CACHE_MAGIC || reader.readString() != key)
+			return false;
+
+		GLenum format = (GLenum)reader.readUInt32();
+		uint32_t length = reader.readUInt32();
+
+		const unsigned char* binary = reader.readRaw(length);
+		if (reader.failed() || binary == nullptr || length == 0)
+			return false;
+
+		GL_CHECK_ERROR(shaderProgramBinary(programId, format, binary, (GLint)length));
+
+		// Drivers reject the binaries of their previous versions
+		GLint linked = GL_FALSE;
+		GL_CHECK_ERROR(glGetProgramiv(programId, GL_LINK_STATUS, &linked));
+		if (linked == GL_TRUE)
+			return true;
+
+		LOG(LogDebug) << "ShaderCache : binary rejected by the driver, compiling";
+
+		file.close();
+		Utils::FileSystem::removeFile(cachePath);
+		return false;
+	}
+
+	void ShaderCache::save(GLuint programId, const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		if (!mAvailable)
+			return;
+
+		GLint length = 0;
+		GL_CHECK_ERROR(glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &length));
+		if (length <= 0)
+			return;
+
+		std::string binary;
+		binary.resize(length);
+
+		GLsizei written = 0;
+		GLenum format = 0;
+		GL_CHECK_ERROR(shaderGetProgramBinary(programId, length, &written, &format, &binary[0]));
+		if (written <= 0)
+			return;
+
+		std::string key = getKey(vertexSource, fragmentSource);
+		std::string cachePath = getCachePath(key);
+
+		Utils::BinaryWriter writer;
+		writer.writeUInt32(SHADER_CACHE_MAGIC);
+		writer.writeString(key);
+		writer.writeUInt32((uint32_t)format);
+		writer.writeUInt32((uint32_t)written);
+		writer.write(binary.data(), written);
+
+		Utils::FileSystem::writeFileAtomic(cachePath, writer);
+	}
+
+	void ShaderCache::clear()
+	{
+		std::string folder = getCacheFolder();
+		if (Utils::FileSystem::exists(folder))
+			Utils::FileSystem::deleteDirectoryFiles(folder);
+	}
+
+} // Renderer::
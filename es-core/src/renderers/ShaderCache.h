@@ -0,0 +1,41 @@
+#pragma once
+#ifndef ES_CORE_RENDERER_SHADER_CACHE_H
+#define ES_CORE_RENDERER_SHADER_CACHE_H
+
+#include "GlExtensions.h"
+#include <string>
+
+namespace Renderer
+{
+	// Linked program binaries ( glGetProgramBinary / glProgramBinary ), stored on disk so that the next runs skip the GLSL compilation.
+	// Enabled with the "ShaderCache" setting. Entries are keyed by the shader sources & the driver, and the whole cache is dropped when the driver changes
+	class ShaderCache
+	{
+	public:
+		// Called once the GL context is created
+		static void init();
+		static void deinit();
+
+		static bool isAvailable() { return mAvailable; }
+
+		// Before linking a program that will be saved
+		static void prepare(GLuint programId);
+
+		// Loads the binary into programId, false when missing or rejected by the driver
+		static bool load(GLuint programId, const std::string& vertexSource, const std::string& fragmentSource);
+		static void save(GLuint programId, const std::string& vertexSource, const std::string& fragmentSource);
+
+		static void clear();
+
+	private:
+		static std::string getCacheFolder();
+		static std::string getKey(const std::string& vertexSource, const std::string& fragmentSource);
+		static std::string getCachePath(const std::string& key);
+
+		static bool			mAvailable;
+		static std::string	mDriver;
+	};
+
+} // Renderer::
+
+#endif // ES_CORE_RENDERER_SHADER_CACHE_H
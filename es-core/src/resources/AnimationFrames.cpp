@@ -0,0 +1,134 @@
+#include "resources/AnimationFrames.h"
+
+#include "resources/ResourceManager.h"
+#include "MemoryProfile.h"
+#include "TaskScheduler.h"
+#include "Log.h"
+
+#include <algorithm>
+
+std::mutex AnimationFrames::sInstancesLock;
+std::map<std::string, std::weak_ptr<AnimationFrames>> AnimationFrames::sInstances;
+
+std::shared_ptr<AnimationFrames> AnimationFrames::get(const std::string& path, int frameCount, int frameTime, MaxSizeInfo maxSize)
+{
+	std::string key = path + "|" + std::to_string((int)maxSize.x()) + "x" + std::to_string((int)maxSize.y());
+
+	std::unique_lock<std::mutex> lock(sInstancesLock);
+
+	for (auto it = sInstances.begin(); it != sInstances.end(); )
+	{
+		if (it->second.expired())
+			it = sInstances.erase(it);
+		else
+			it++;
+	}
+
+	auto it = sInstances.find(key);
+	if (it != sInstances.cend())
+		return it->second.lock();
+
+	auto frames = std::make_shared<AnimationFrames>(path, frameCount, frameTime, maxSize);
+	sInstances[key] = frames;
+	return frames;
+}
+
+AnimationFrames::AnimationFrames(const std::string& path, int frameCount, int frameTime, MaxSizeInfo maxSize)
+	: mPath(path), mFrameCount(std::max(1, frameCount)), mFrameTime(frameTime), mMaxSize(maxSize), mFileLength(0), mWanted(0), mDecoding(false), mFailed(false)
+{
+	mCapacity = std::min(RING_FRAMES, mFrameCount);
+}
+
+AnimationFrames::Frame AnimationFrames::getFrame(int index)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	mWanted = index % mFrameCount;
+
+	if (!mDecoding && !mFailed && getNextDecode() >= 0)
+	{
+		mDecoding = true;
+
+		auto self = shared_from_this();
+		TaskScheduler::submit(TaskScheduler::TEXTURE_IO, [self] { self->decode(); });
+	}
+
+	auto it = mFrames.find(mWanted);
+	if (it != mFrames.cend())
+		return it->second;
+
+	return Frame();
+}
+
+// From the frame asked, in playing order
+int AnimationFrames::getNextDecode()
+{
+	for (int i = 0; i < mCapacity; i++)
+	{
+		int index = (mWanted + i) % mFrameCount;
+		if (mFrames.find(index) == mFrames.cend())
+			return index;
+	}
+
+	return -1;
+}
+
+void AnimationFrames::decode()
+{
+	if (mFileData == nullptr)
+	{
+		const ResourceData data = ResourceManager::getInstance()->getFileData(mPath);
+
+		std::unique_lock<std::mutex> lock(mLock);
+		mFileData = data.ptr;
+		mFileLength = data.length;
+	}
+
+	while (true)
+	{
+		int index;
+
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+
+			index = mFileData == nullptr ? -1 : getNextDecode();
+			if (index < 0)
+			{
+				mFailed = mFileData == nullptr;
+				mDecoding = false;
+				return;
+			}
+		}
+
+		// Composed over the previous frames by FreeImage, the worker takes the cost instead of the UI thread
+		Frame frame;
+		MaxSizeInfo maxSize = mMaxSize;
+		frame.rgba = std::shared_ptr<unsigned char>(ImageIO::loadFromMemoryRGBA32(mFileData.get(), mFileLength, frame.width, frame.height, maxSize.empty() ? nullptr : &maxSize, nullptr, nullptr, index).release(), PixelBufferDeleter());
+
+		std::unique_lock<std::mutex> lock(mLock);
+
+		if (frame.rgba == nullptr)
+		{
+			LOG(LogError) << "AnimationFrames : can't decode frame " << index << " of " << mPath;
+			mFailed = true;
+			mDecoding = false;
+			return;
+		}
+
+		if (mFrames.empty() && !MemoryProfile::isLowMemory() && frame.width * frame.height * 4 * mFrameCount <= MAX_ALL_FRAMES_BYTES)
+			mCapacity = mFrameCount;
+
+		mFrames[index] = frame;
+
+		// The frames furthest behind the one asked go first
+		while ((int)mFrames.size() > mCapacity)
+		{
+			auto oldest = mFrames.begin();
+			for (auto it = mFrames.begin(); it != mFrames.end(); it++)
+				if ((it->first - mWanted + mFrameCount) % mFrameCount > (oldest->first - mWanted + mFrameCount) % mFrameCount)
+					oldest = it;
+
+			mFrames.erase(oldest);
+		}
+	}
+}
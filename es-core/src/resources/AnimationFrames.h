@@ -0,0 +1,62 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_ANIMATION_FRAMES_H
+#define ES_CORE_RESOURCES_ANIMATION_FRAMES_H
+
+#include "ImageIO.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Decoded frames of an animated GIF / APNG, shared by the images showing the same file at the same size.
+// The file is read once and a TEXTURE_IO worker decodes the frames ahead of the images : the whole animation is kept when it fits
+// in MAX_ALL_FRAMES_BYTES ( & the low-memory profile is off ), otherwise a ring of RING_FRAMES following the last frame asked
+class AnimationFrames : public std::enable_shared_from_this<AnimationFrames>
+{
+public:
+	static const int RING_FRAMES = 8;
+	static const size_t MAX_ALL_FRAMES_BYTES = 16 * 1024 * 1024;
+
+	struct Frame
+	{
+		Frame() : width(0), height(0) { }
+
+		std::shared_ptr<unsigned char> rgba; // width x height, ready for upload
+		size_t width;
+		size_t height;
+	};
+
+	static std::shared_ptr<AnimationFrames> get(const std::string& path, int frameCount, int frameTime, MaxSizeInfo maxSize);
+
+	const std::string& getPath() { return mPath; }
+	int getFrameCount() { return mFrameCount; }
+	int getFrameTime() { return mFrameTime; }
+
+	// Empty while the frame is decoded : the images keep showing the previous one
+	Frame getFrame(int index);
+
+	AnimationFrames(const std::string& path, int frameCount, int frameTime, MaxSizeInfo maxSize);
+
+private:
+	void decode();
+	int getNextDecode(); // -1 when the frames ahead are decoded
+
+	std::string		mPath;
+	int				mFrameCount;
+	int				mFrameTime;
+	MaxSizeInfo		mMaxSize;
+
+	std::mutex				mLock;
+	std::shared_ptr<unsigned char> mFileData; // Read by the worker
+	size_t					mFileLength;
+	std::map<int, Frame>	mFrames;
+	int						mCapacity;
+	int						mWanted;
+	bool					mDecoding;
+	bool					mFailed;
+
+	static std::mutex sInstancesLock;
+	static std::map<std::string, std::weak_ptr<AnimationFrames>> sInstances;
+};
+
+#endif // ES_CORE_RESOURCES_ANIMATION_FRAMES_H
@@ -9,22 +9,40 @@
 
 #include "ResourceManager.h"
 #include "TextureResource.h"
+#include "GlyphCache.h"
+#include "GlyphRasterizer.h"
 #include "Settings.h"
+#include "MemoryProfile.h"
 #include "ImageIO.h"
 #include <algorithm>
+#include <SDL_timer.h>
 #include "math/Transform4x4f.h"
 
 #ifdef WIN32
 #include <Windows.h>
 #endif
 
+// FT_RENDER_MODE_SDF appeared with FreeType 2.11
+#if FREETYPE_MAJOR > 2 || (FREETYPE_MAJOR == 2 && FREETYPE_MINOR >= 11)
+#define FONT_DISTANCE_FIELD 1
+#endif
+
+#define DISTANCE_FIELD_SIZE		48	// Rasterization size of the distance field atlases
+#define DISTANCE_FIELD_SPREAD	8	// FreeType's default, in pixels around the outline
+
+#define BIDI_CACHE_SIZE			4096
+
 FT_Library Font::sLibrary = NULL;
 
 int Font::getSize() const { return mSize; }
 
 std::map< std::pair<std::string, int>, std::weak_ptr<Font> > Font::sFontMap;
+std::map< std::string, std::weak_ptr<Font> > Font::sDistanceFieldFonts;
 static std::map<unsigned int, std::string> substituableChars;
 
+// The substitutes are private use characters : the map is not searched for the others
+#define SUBSTITUABLE_FIRST 0xF000
+
 Font::FontFace::FontFace(ResourceData&& d, int size) : data(d)
 {
 	int err = FT_New_Memory_Face(sLibrary, data.ptr.get(), (FT_Long)data.length, 0, &face);
@@ -82,10 +100,15 @@ size_t Font::getTotalMemUsage()
 		it++;
 	}
 
+	for (auto source : sDistanceFieldFonts)
+		if (!source.second.expired())
+			total += source.second.lock()->getMemUsage();
+
 	return total;
 }
 
-Font::Font(int size, const std::string& path) : mSize(size), mPath(path)
+Font::Font(int size, const std::string& path, bool distanceField, const std::shared_ptr<Font>& distanceFieldSource) : mSize(size), mPath(path),
+	mDistanceField(distanceField), mDistanceFieldSource(distanceFieldSource)
 {
 	mSize = size;
 	//if(mSize > 160) mSize = 160; // maximize the font size while it is causing issues on linux
@@ -105,18 +128,24 @@ Font::Font(int size, const std::string& path) : mSize(size), mPath(path)
 
 	mLoaded = true;
 	mMaxGlyphHeight = 0;
+	mPrewarming = false;
+	mGlyphSetChanged = false;
 
 	if(!sLibrary)
 		initLibrary();
 
-	for (unsigned int i = 0; i < 255; i++)
-		mGlyphCacheArray[i] = NULL;
+	for (unsigned int i = 0; i < GLYPH_TABLE_SIZE; i++)
+		mGlyphTable[i] = NULL;
 
 	// always initialize ASCII characters
 	for(unsigned int i = 32; i < 128; i++)
 		getGlyph(i);
 
 	clearFaceCache();
+
+	// The others used by the previous runs are rasterized by prewarmGlyphs
+	mPrewarmGlyphs = GlyphCache::load(mPath, mSize);
+	std::reverse(mPrewarmGlyphs.begin(), mPrewarmGlyphs.end());
 }
 
 Font::~Font()
@@ -146,6 +175,8 @@ bool Font::unload()
 {
 	if (mLoaded)
 	{		
+		saveGlyphSet();
+
 		for (auto tex : mTextures)
 			tex->deinitTexture();
 
@@ -170,18 +201,45 @@ std::shared_ptr<Font> Font::get(int size, const std::string& path)
 			return foundFont->second.lock();
 	}
 
-	std::shared_ptr<Font> font = std::shared_ptr<Font>(new Font(def.second, def.first));
+	std::shared_ptr<Font> font;
+	if (isDistanceFieldEnabled())
+		font = std::shared_ptr<Font>(new Font(def.second, def.first, true, getDistanceFieldSource(def.first)));
+	else
+		font = std::shared_ptr<Font>(new Font(def.second, def.first));
+
 	sFontMap[def] = std::weak_ptr<Font>(font);
 	ResourceManager::getInstance()->addReloadable(font);
 	return font;
 }
 
+bool Font::isDistanceFieldEnabled()
+{
+#if FONT_DISTANCE_FIELD
+	return Settings::getInstance()->getBool("FontDistanceField") && Renderer::supportsDistanceField();
+#else
+	return false;
+#endif
+}
+
+std::shared_ptr<Font> Font::getDistanceFieldSource(const std::string& path)
+{
+	auto it = sDistanceFieldFonts.find(path);
+	if (it != sDistanceFieldFonts.cend() && !it->second.expired())
+		return it->second.lock();
+
+	std::shared_ptr<Font> font = std::shared_ptr<Font>(new Font(DISTANCE_FIELD_SIZE, path, true));
+	sDistanceFieldFonts[path] = std::weak_ptr<Font>(font);
+	ResourceManager::getInstance()->addReloadable(font);
+	return font;
+}
+
 Font::FontTexture::FontTexture()
 {
 	textureId = 0;
 	textureSize = Vector2i(2048, 512);
 	writePos = Vector2i::Zero();
 	rowHeight = 0;
+	distanceField = false;
 }
 
 Font::FontTexture::~FontTexture()
@@ -221,7 +279,7 @@ void Font::FontTexture::initTexture()
 {
 	if (textureId == 0)
 	{
-		textureId = Renderer::createTexture(Renderer::Texture::ALPHA, true, false, textureSize.x(), textureSize.y(), nullptr);
+		textureId = Renderer::createTexture(distanceField ? Renderer::Texture::DISTANCE_FIELD : Renderer::Texture::ALPHA, true, false, textureSize.x(), textureSize.y(), nullptr);
 		if (textureId == 0)
 			LOG(LogError) << "FontTexture::initTexture() failed to create texture " << textureSize.x() << "x" << textureSize.y();
 	}
@@ -254,10 +312,11 @@ void Font::getTextureForNewGlyph(const Vector2i& glyphSize, FontTexture*& tex_ou
 	// make a new one
 	FontTexture* tex = new FontTexture();
 
-	int x = Math::min(2048, mSize * 64);
+	int x = Math::min(MemoryProfile::getGlyphAtlasWidth(), mSize * 64);
 	int y = Math::min(2048, Math::max(glyphSize.y(), mSize) + 2) * 1.2;
 
 	tex->textureSize = Vector2i(x, y);
+	tex->distanceField = mDistanceField;
 	tex->initTexture();
 
 	tex_out = tex;
@@ -294,51 +353,79 @@ std::vector<std::string> getFallbackFontPaths()
 	return paths;
 }
 
-#if defined(WIN32) || defined(X86) || defined(X86_64)
+// Font files are memory mapped : all the sizes of a font share the same pages
 static std::map<std::string, ResourceData> globalTTFCache;
-#endif
 
-FT_Face Font::getFaceForChar(unsigned int id)
+static const ResourceData* getFontData(const std::string& path)
+{
+	auto itCache = globalTTFCache.find(path);
+	if (itCache == globalTTFCache.cend())
+	{
+		ResourceData dataX = ResourceManager::getInstance()->getFileData(path);
+		globalTTFCache.insert(std::pair<std::string, ResourceData>(path, dataX));
+		itCache = globalTTFCache.find(path);
+	}
+
+	if (itCache == globalTTFCache.cend())
+		return nullptr;
+
+	return &itCache->second;
+}
+
+static const std::vector<std::string>& getFallbackFonts()
 {
 	static const std::vector<std::string> fallbackFonts = getFallbackFontPaths();
+	return fallbackFonts;
+}
 
-	// look through our current font + fallback fonts to see if any have the glyph we're looking for
-	for(unsigned int i = 0; i < fallbackFonts.size() + 1; i++)
-	{
-		auto fit = mFaceCache.find(i);
+// Face index by (font, codepoint block) : the fallback that had a character of the block is tried first, for the session
+#define FACE_BLOCK_SHIFT	7
+static std::map<std::pair<std::string, unsigned int>, unsigned int> faceByBlock;
 
-		if(fit == mFaceCache.cend()) // doesn't exist yet
-		{
-			// i == 0 -> mPath
-			// otherwise, take from fallbackFonts
-			const std::string& path = (i == 0 ? mPath : fallbackFonts.at(i - 1));
+FT_Face Font::getFace(unsigned int index)
+{
+	auto fit = mFaceCache.find(index);
+	if (fit != mFaceCache.cend())
+		return fit->second->face;
 
-#if defined(WIN32) || defined(X86) || defined(X86_64)
-			auto itCache = globalTTFCache.find(path);
-			if (itCache == globalTTFCache.cend())
-			{
-				ResourceData dataX = ResourceManager::getInstance()->getFileData(path);
-				globalTTFCache.insert(std::pair<std::string, ResourceData>(path, dataX));
-				itCache = globalTTFCache.find(path);
-			}
-						
-			if (itCache == globalTTFCache.cend())
-				continue;
+	// index == 0 -> mPath
+	// otherwise, take from fallbackFonts
+	const std::string& path = (index == 0 ? mPath : getFallbackFonts().at(index - 1));
 
-			mFaceCache[i] = std::unique_ptr<FontFace>(new FontFace(std::move(itCache->second), mSize));
-#else
-			ResourceData data = ResourceManager::getInstance()->getFileData(path);
-			mFaceCache[i] = std::unique_ptr<FontFace>(new FontFace(std::move(data), mSize));
-#endif
-			fit = mFaceCache.find(i);
-		}
+	const ResourceData* data = getFontData(path);
+	if (data == nullptr)
+		return nullptr;
+
+	FontFace* fontFace = new FontFace(ResourceData(*data), mSize);
+	mFaceCache[index] = std::unique_ptr<FontFace>(fontFace);
+	return fontFace->face;
+}
 
-		if(FT_Get_Char_Index(fit->second->face, id) != 0)
-			return fit->second->face;
+FT_Face Font::getFaceForChar(unsigned int id)
+{
+	auto block = std::make_pair(mPath, id >> FACE_BLOCK_SHIFT);
+
+	auto hint = faceByBlock.find(block);
+	if (hint != faceByBlock.cend())
+	{
+		FT_Face face = getFace(hint->second);
+		if (face != nullptr && FT_Get_Char_Index(face, id) != 0)
+			return face;
+	}
+
+	// look through our current font + fallback fonts to see if any have the glyph we're looking for
+	for(unsigned int i = 0; i < getFallbackFonts().size() + 1; i++)
+	{
+		FT_Face face = getFace(i);
+		if (face != nullptr && FT_Get_Char_Index(face, id) != 0)
+		{
+			faceByBlock[block] = i;
+			return face;
+		}
 	}
 
 	// nothing has a valid glyph - return the "real" face so we get a "missing" character
-	return mFaceCache.cbegin()->second->face;
+	return getFace(0);
 }
 
 void Font::clearFaceCache()
@@ -346,13 +433,63 @@ void Font::clearFaceCache()
 	mFaceCache.clear();
 }
 
+// FT_LOAD_RENDER rasterizes coverage, distance fields need a second pass
+static bool loadGlyphBitmap(FT_Face face, unsigned int id, bool distanceField)
+{
+#if FONT_DISTANCE_FIELD
+	if (distanceField)
+		return FT_Load_Char(face, id, FT_LOAD_DEFAULT) == 0 && FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF) == 0;
+#endif
+
+	return FT_Load_Char(face, id, FT_LOAD_RENDER) == 0;
+}
+
+// Glyph of the distance field atlas, with the metrics of this size
+Font::Glyph* Font::getScaledGlyph(unsigned int id)
+{
+	Glyph* source = mDistanceFieldSource->getGlyph(id);
+	if (source == NULL)
+		return NULL;
+
+	float scale = (float)mSize / (float)mDistanceFieldSource->mSize;
+
+	Glyph* pGlyph = new Glyph(*source);
+	pGlyph->advance = source->advance * scale;
+	pGlyph->bearing = source->bearing * scale;
+	pGlyph->glyphSize = Vector2i(Math::round(source->glyphSize.x() * scale), Math::round(source->glyphSize.y() * scale));
+	pGlyph->padding = source->padding * scale;
+
+	int height = Math::round((source->glyphSize.y() - 2 * source->padding) * scale);
+	if (height > mMaxGlyphHeight)
+	{
+		mMaxGlyphHeight = height;
+		clearMeasures();
+	}
+
+	addGlyph(id, pGlyph);
+
+	if (id >= 128 && !mPrewarming)
+		mGlyphSetChanged = true;
+
+	return pGlyph;
+}
+
+void Font::addGlyph(unsigned int id, Glyph* pGlyph)
+{
+	mGlyphMap[id] = pGlyph;
+
+	int index = getGlyphTableIndex(id);
+	if (index >= 0)
+		mGlyphTable[index] = pGlyph;
+}
+
 Font::Glyph* Font::getGlyph(unsigned int id)
 {
-	if (id < 255)
+	// When computing & displaying long descriptions in gamelist views, it can come here textsize*2 times per frame : the usual ranges avoid the map
+	int index = getGlyphTableIndex(id);
+	if (index >= 0)
 	{
-		// FCA Optimisation : array is faster than a map
-		// When computing & displaying long descriptions in gamelist views, it can come here textsize*2 times per frame
-		Glyph* fastCache = mGlyphCacheArray[id];
+		Glyph* fastCache = mGlyphTable[index];
 		if (fastCache != NULL)
 			return fastCache;
 	}
@@ -365,6 +502,12 @@ Font::Glyph* Font::getGlyph(unsigned int id)
 	}
 
 	// nope, need to make a glyph
+	if (mDistanceFieldSource != nullptr)
+		return getScaledGlyph(id);
+
+	if (isAsyncGlyph(id))
+		return queueGlyph(id);
+
 	FT_Face face = getFaceForChar(id);
 	if(!face)
 	{
@@ -374,56 +517,236 @@ Font::Glyph* Font::getGlyph(unsigned int id)
 
 	FT_GlyphSlot g = face->glyph;
 
-	if(FT_Load_Char(face, id, FT_LOAD_RENDER))
+	if(!loadGlyphBitmap(face, id, mDistanceField))
 	{
 		LOG(LogError) << "Could not find glyph for character " << id << " for font " << mPath << ", size " << mSize << "!";
 		return NULL;
 	}
 
+	// create glyph
+	Glyph* pGlyph = new Glyph();
+
 	Vector2i glyphSize(g->bitmap.width, g->bitmap.rows);
+	Vector2f advance((float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f);
+	Vector2f bearing((float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f);
+
+	if (!placeGlyph(pGlyph, glyphSize, advance, bearing, g->bitmap.buffer))
+	{
+		LOG(LogError) << "Could not create glyph for character " << id << " for font " << mPath << ", size " << mSize << " (no suitable texture found)!";
+		delete pGlyph;
+		return NULL;
+	}
+
+	addGlyph(id, pGlyph);
+
+	if (id >= 128 && !mPrewarming)
+		mGlyphSetChanged = true;
+
+	// done
+	return pGlyph;
+}
 
+bool Font::placeGlyph(Glyph* pGlyph, const Vector2i& glyphSize, const Vector2f& advance, const Vector2f& bearing, const unsigned char* bitmap)
+{
 	FontTexture* tex = NULL;
 	Vector2i cursor;
 	getTextureForNewGlyph(glyphSize, tex, cursor);
 
 	// getTextureForNewGlyph can fail if the glyph is bigger than the max texture size (absurdly large font size)
 	if(tex == NULL)
-	{
-		LOG(LogError) << "Could not create glyph for character " << id << " for font " << mPath << ", size " << mSize << " (no suitable texture found)!";
-		return NULL;
-	}
+		return false;
 
-	// create glyph
-	Glyph* pGlyph = new Glyph();
-	
 	pGlyph->texture = tex;
 	pGlyph->texPos = Vector2f((float)cursor.x() / (float)tex->textureSize.x(), (float)cursor.y() / (float)tex->textureSize.y());
 	pGlyph->texSize = Vector2f((float)glyphSize.x() / (float)tex->textureSize.x(), (float)glyphSize.y() / (float)tex->textureSize.y());
-	pGlyph->advance = Vector2f((float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f);
-	pGlyph->bearing = Vector2f((float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f);	
+	pGlyph->advance = advance;
+	pGlyph->bearing = bearing;
 	pGlyph->cursor = cursor;
 	pGlyph->glyphSize = glyphSize;
+	pGlyph->padding = (mDistanceField && glyphSize.x() > 0 ? DISTANCE_FIELD_SPREAD : 0);
+	pGlyph->pending = false;
 
 	// upload glyph bitmap to texture
 	if (glyphSize.x() > 0 && glyphSize.y() > 0)
-		Renderer::updateTexture(tex->textureId, Renderer::Texture::ALPHA, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), g->bitmap.buffer);
+		Renderer::updateTexture(tex->textureId, mDistanceField ? Renderer::Texture::DISTANCE_FIELD : Renderer::Texture::ALPHA, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), (void*)bitmap);
 
 	// update max glyph height
-	if(glyphSize.y() > mMaxGlyphHeight)
-		mMaxGlyphHeight = glyphSize.y();
+	if(glyphSize.y() - 2 * pGlyph->padding > mMaxGlyphHeight)
+	{
+		mMaxGlyphHeight = glyphSize.y() - 2 * pGlyph->padding;
 
-	mGlyphMap[id] = pGlyph;
+		// Measured heights depend on it
+		clearMeasures();
+	}
 
-	if (id < 255)
-		mGlyphCacheArray[id] = pGlyph;
+	return true;
+}
 
-	// done
+// CJK & Hangul : large fallback faces, one glyph at a time
+#define ASYNC_GLYPHS_FIRST	0x2E80
+
+bool Font::isAsyncGlyph(unsigned int id)
+{
+	if (id < ASYNC_GLYPHS_FIRST || mPrewarming || mDistanceField || mDistanceFieldSource != nullptr)
+		return false;
+
+	if (mSyncGlyphs.find(id) != mSyncGlyphs.cend())
+		return false;
+
+	return GlyphRasterizer::isEnabled();
+}
+
+// Drawn as a blank until the worker is done. These characters are full width, which is the expected advance
+Font::Glyph* Font::queueGlyph(unsigned int id)
+{
+	GlyphRasterizer::Request request;
+	request.fontPath = mPath;
+	request.size = mSize;
+	request.id = id;
+
+	std::vector<std::string> paths = getFallbackFonts();
+	paths.insert(paths.begin(), mPath);
+
+	for (auto path : paths)
+	{
+		const ResourceData* data = getFontData(path);
+		if (data != nullptr)
+			request.faces.push_back(*data);
+	}
+
+	GlyphRasterizer::queue(request);
+
+	Glyph* pGlyph = new Glyph();
+	pGlyph->texture = NULL;
+	pGlyph->advance = Vector2f((float)mSize, (float)mSize);
+	pGlyph->pending = true;
+
+	mGlyphMap[id] = pGlyph;
 	return pGlyph;
 }
 
+unsigned int Font::sGlyphGeneration = 0;
+
+void Font::uploadRasterizedGlyphs()
+{
+	std::vector<GlyphRasterizer::Result> results;
+	GlyphRasterizer::getResults(results);
+
+	if (results.empty())
+		return;
+
+	for (auto& result : results)
+	{
+		for (auto it = sFontMap.cbegin(); it != sFontMap.cend(); it++)
+		{
+			std::shared_ptr<Font> font = it->second.lock();
+			if (font != nullptr && font->mSize == result.size && font->mPath == result.fontPath)
+			{
+				font->uploadRasterizedGlyph(result);
+				break;
+			}
+		}
+	}
+
+	// The texts drawn with the blanks are rebuilt by Font::refreshTextCache
+	sGlyphGeneration++;
+}
+
+void Font::uploadRasterizedGlyph(const GlyphRasterizer::Result& result)
+{
+	auto it = mGlyphMap.find(result.id);
+	if (it == mGlyphMap.cend() || !it->second->pending)
+		return;
+
+	Glyph* pGlyph = it->second;
+
+	// Requeued by the next getGlyph once the textures are back
+	if (!mLoaded)
+	{
+		mGlyphMap.erase(it);
+		delete pGlyph;
+		return;
+	}
+
+	if (!result.valid || !placeGlyph(pGlyph, result.glyphSize, result.advance, result.bearing, result.bitmap.data()))
+	{
+		// Left to getGlyph, which logs the error
+		mGlyphMap.erase(it);
+		delete pGlyph;
+		mSyncGlyphs.insert(result.id);
+	}
+	else if (!mPrewarming)
+		mGlyphSetChanged = true;
+
+	// Measured sizes used the expected advance
+	clearMeasures();
+}
+
+void Font::saveGlyphSet()
+{
+	if (!mGlyphSetChanged)
+		return;
+
+	mGlyphSetChanged = false;
+
+	// ASCII is always rasterized
+	std::vector<unsigned int> glyphs;
+	for (auto it = mGlyphMap.cbegin(); it != mGlyphMap.cend(); it++)
+		if (it->first >= 128)
+			glyphs.push_back(it->first);
+
+	// Not prewarmed yet
+	for (auto id : mPrewarmGlyphs)
+		if (mGlyphMap.find(id) == mGlyphMap.cend())
+			glyphs.push_back(id);
+
+	GlyphCache::save(mPath, mSize, glyphs);
+}
+
+bool Font::prewarmGlyphs(int maxTimeMs)
+{
+	unsigned int start = SDL_GetTicks();
+	bool pending = false;
+
+	for (auto it = sFontMap.cbegin(); it != sFontMap.cend(); it++)
+	{
+		std::shared_ptr<Font> font = it->second.lock();
+		if (font == nullptr || !font->mLoaded || font->mPrewarmGlyphs.empty())
+			continue;
+
+		font->mPrewarming = true;
+
+		while (!font->mPrewarmGlyphs.empty())
+		{
+			if (maxTimeMs >= 0 && SDL_GetTicks() - start >= (unsigned int)maxTimeMs)
+				break;
+
+			font->getGlyph(font->mPrewarmGlyphs.back());
+			font->mPrewarmGlyphs.pop_back();
+		}
+
+		font->mPrewarming = false;
+
+		if (!font->mPrewarmGlyphs.empty())
+		{
+			pending = true;
+			break;
+		}
+
+		// Same as after the ASCII characters
+		font->clearFaceCache();
+	}
+
+	return pending;
+}
+
 // completely recreate the texture data for all textures based on mGlyphs information
 void Font::rebuildTextures()
 {
+	// The atlas belongs to the distance field source, which reloads it
+	if (mDistanceFieldSource != nullptr)
+		return;
+
 	// recreate OpenGL textures
 	for(auto tex : mTextures)
 		tex->initTexture();
@@ -431,16 +754,19 @@ void Font::rebuildTextures()
 	// reupload the texture data
 	for(auto it = mGlyphMap.cbegin(); it != mGlyphMap.cend(); it++)
 	{
+		if (it->second->pending)
+			continue;
+
 		FT_Face face = getFaceForChar(it->first);
 		FT_GlyphSlot glyphSlot = face->glyph;
 
 		// load the glyph bitmap through FT
-		FT_Load_Char(face, it->first, FT_LOAD_RENDER);
+		loadGlyphBitmap(face, it->first, mDistanceField);
 
 		Glyph* glyph = it->second;
 		
 		// upload to texture
-		Renderer::updateTexture(glyph->texture->textureId, Renderer::Texture::ALPHA,
+		Renderer::updateTexture(glyph->texture->textureId, mDistanceField ? Renderer::Texture::DISTANCE_FIELD : Renderer::Texture::ALPHA,
 			glyph->cursor.x(), glyph->cursor.y(),
 			glyph->glyphSize.x(), glyph->glyphSize.y(),
 			glyphSlot->bitmap.buffer);
@@ -457,6 +783,9 @@ void Font::renderSingleGlow(TextCache* cache, const Transform4x4f& parentTrans,
 
 void Font::renderTextCacheEx(TextCache* cache, const Transform4x4f& parentTrans, unsigned int mGlowSize, unsigned int mGlowColor, Vector2f& mGlowOffset, unsigned char mOpacity)
 {
+	if (cache != NULL)
+		refreshTextCache(cache);
+
 	if ((mGlowColor & 0x000000FF) != 0 && mGlowSize > 0)
 	{
 		Transform4x4f glowTrans = parentTrans;
@@ -515,6 +844,8 @@ void Font::renderTextCache(TextCache* cache, bool verticesChanged)
 		return;
 	}
 
+	refreshTextCache(cache);
+
 	int tex = -1;
 
 	for(auto& vertex : cache->vertexLists)
@@ -560,6 +891,8 @@ void Font::renderGradientTextCache(TextCache* cache, unsigned int colorTop, unsi
 		return;
 	}
 
+	refreshTextCache(cache);
+
 	for (auto it = cache->vertexLists.cbegin(); it != cache->vertexLists.cend(); it++)
 	{
 		if (*it->textureIdPtr == 0)
@@ -670,8 +1003,126 @@ std::string tryFastBidi(const std::string& text)
     return ret;
 }
 
-Vector2f Font::sizeText(std::string text, float lineSpacing)
+// Visual order of the RTL strings, most recently used first
+struct BidiEntry
+{
+	std::string text;
+	std::string visual;
+};
+
+static std::list<BidiEntry> bidiCache;
+static std::unordered_map<size_t, std::list<BidiEntry>::iterator> bidiIndex;
+
+static bool hasBidiChars(const std::string& text)
+{
+	for (auto c : text)
+		if (isBidiChar(c))
+			return true;
+
+	return false;
+}
+
+static const std::string& getBidiText(const std::string& text)
+{
+	size_t hash = std::hash<std::string>()(text);
+
+	auto it = bidiIndex.find(hash);
+	if (it != bidiIndex.cend() && it->second->text == text)
+	{
+		bidiCache.splice(bidiCache.begin(), bidiCache, it->second);
+		return it->second->visual;
+	}
+
+	if (it != bidiIndex.cend())
+	{
+		bidiCache.erase(it->second);
+		bidiIndex.erase(it);
+	}
+
+	if (bidiCache.size() >= BIDI_CACHE_SIZE)
+	{
+		bidiIndex.erase(std::hash<std::string>()(bidiCache.back().text));
+		bidiCache.pop_back();
+	}
+
+	bidiCache.push_front({ text, tryFastBidi(text) });
+	bidiIndex[hash] = bidiCache.begin();
+	return bidiCache.front().visual;
+}
+
+void Font::prepareBidiText(const std::string& text)
+{
+	if (EsLocale::isRTL() && bidiCache.size() < BIDI_CACHE_SIZE && hasBidiChars(text))
+		getBidiText(text);
+}
+
+static inline void hashCombine(size_t& seed, size_t value)
 {
+	seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+Font::Measure* Font::findMeasure(MeasureKind kind, const std::string& text, float width, float lineSpacing, size_t& textHash, size_t& key)
+{
+	textHash = std::hash<std::string>()(text);
+
+	key = textHash;
+	hashCombine(key, (size_t)kind);
+	hashCombine(key, std::hash<float>()(width));
+	hashCombine(key, std::hash<float>()(lineSpacing));
+
+	auto it = mMeasureIndex.find(key);
+	if (it == mMeasureIndex.cend())
+		return nullptr;
+
+	Measure& measure = *it->second;
+	if (measure.kind != kind || measure.textHash != textHash || measure.textLength != text.length() || measure.width != width || measure.lineSpacing != lineSpacing)
+		return nullptr;
+
+	mMeasures.splice(mMeasures.begin(), mMeasures, it->second);
+	return &measure;
+}
+
+Font::Measure& Font::addMeasure(MeasureKind kind, const std::string& text, float width, float lineSpacing, size_t textHash, size_t key)
+{
+	if (mMeasures.size() >= MEASURE_CACHE_SIZE)
+	{
+		auto last = std::prev(mMeasures.end());
+
+		// The index may already point on a newer entry with the same key
+		auto it = mMeasureIndex.find(last->key);
+		if (it != mMeasureIndex.cend() && it->second == last)
+			mMeasureIndex.erase(it);
+
+		mMeasures.pop_back();
+	}
+
+	mMeasures.push_front(Measure());
+
+	Measure& measure = mMeasures.front();
+	measure.kind = kind;
+	measure.textHash = textHash;
+	measure.textLength = text.length();
+	measure.width = width;
+	measure.lineSpacing = lineSpacing;
+	measure.key = key;
+
+	mMeasureIndex[key] = mMeasures.begin();
+	return measure;
+}
+
+void Font::clearMeasures()
+{
+	mMeasures.clear();
+	mMeasureIndex.clear();
+}
+
+Vector2f Font::sizeText(const std::string& text, float lineSpacing)
+{
+	size_t textHash, key;
+	Measure* cached = findMeasure(MEASURE_SIZE, text, 0, lineSpacing, textHash, key);
+	if (cached != nullptr)
+		return cached->size;
+
 	float lineWidth = 0.0f;
 	float highestWidth = 0.0f;
 
@@ -679,12 +1130,12 @@ Vector2f Font::sizeText(std::string text, float lineSpacing)
 
 	float y = lineHeight;
 
-	size_t i = 0;
-	while(i < text.length())
-	{
-		unsigned int character = Utils::String::chars2Unicode(text, i); // advances i
+	static thread_local std::vector<unsigned int> codepoints;
+	Utils::String::decodeUnicode(text, codepoints);
 
-		if (substituableChars.find(character) != substituableChars.cend())
+	for (auto character : codepoints)
+	{
+		if (character >= SUBSTITUABLE_FIRST && substituableChars.find(character) != substituableChars.cend())
 		{
 			lineWidth += lineHeight;
 			continue;
@@ -707,7 +1158,9 @@ Vector2f Font::sizeText(std::string text, float lineSpacing)
 	if(lineWidth > highestWidth)
 		highestWidth = lineWidth;
 
-	return Vector2f(highestWidth, y);
+	Vector2f size(highestWidth, y);
+	addMeasure(MEASURE_SIZE, text, 0, lineSpacing, textHash, key).size = size;
+	return size;
 }
 
 float Font::getHeight(float lineSpacing) const
@@ -719,7 +1172,7 @@ float Font::getLetterHeight()
 {
 	Glyph* glyph = getGlyph('S');
 	if (glyph != nullptr)
-		return glyph->glyphSize.y();
+		return glyph->glyphSize.y() - 2 * glyph->padding;
 
 	return mSize;
 }
@@ -731,21 +1184,28 @@ static inline bool isWhiteSpace(unsigned int c)
 
 // Thanks eagle0wl'PR @ Retropie EmulationStation https://github.com/RetroPie/EmulationStation/pull/269/files
 // Breaks up a normal string with newlines to make it fit xLen
-std::string Font::wrapText(std::string text, float maxWidth)
+std::string Font::wrapText(const std::string& text, float maxWidth)
 {
+	size_t textHash, key;
+	Measure* cached = findMeasure(MEASURE_WRAP, text, maxWidth, 0, textHash, key);
+	if (cached != nullptr)
+		return cached->wrapped;
+
 	std::string out;
+	out.reserve(text.length() + 16);
 
-	int lastCursor = 0;
+	size_t start = 0; // beginning of the line being cut
+	size_t lastCursor = 0;
 
-	while (text.length() > 0)  // find next cut-point
+	while (start < text.length())  // find next cut-point
 	{
-		size_t cursor = 0;
+		size_t cursor = start;
 		float lineWidth = 0.0f;
-		size_t lastWhiteSpace = 0;
+		size_t lastWhiteSpace = std::string::npos;
 		while (lineWidth < maxWidth && cursor < text.length())
 		{
 			lastCursor = cursor;
-			unsigned int c = Utils::String::chars2Unicode(text, cursor);
+			unsigned int c = Utils::String::nextUnicode(text, cursor);
 
 			if (c == (unsigned int) '\n' || c == (unsigned int) '\r')
 				lineWidth = 0.0f;
@@ -762,31 +1222,37 @@ std::string Font::wrapText(std::string text, float maxWidth)
 
 		if (cursor == text.length()) // arrived at end of text.
 		{
-			out += text;
-			text.erase();
+			out.append(text, start, std::string::npos);
+			break;
 		}
-		else // need to cut at last whitespace or lacking that, the previous cursor.
-		{
-			size_t cut = (lastWhiteSpace != 0) ? lastWhiteSpace : lastCursor;
-			if (cut == 0)
-				break;
 
-			out += text.substr(0, cut) + "\n";
-			text.erase(0, cut);
-			lineWidth = 0.0f;
-		}
+		// need to cut at last whitespace or lacking that, the previous cursor.
+		size_t cut = (lastWhiteSpace != std::string::npos) ? lastWhiteSpace : lastCursor;
+		if (cut <= start)
+			break;
+
+		out.append(text, start, cut - start);
+		out += '\n';
+		start = cut;
 	}
 
+	addMeasure(MEASURE_WRAP, text, maxWidth, 0, textHash, key).wrapped = out;
 	return out;
 }
 
-Vector2f Font::sizeWrappedText(std::string text, float xLen, float lineSpacing)
+Vector2f Font::sizeWrappedText(const std::string& text, float xLen, float lineSpacing)
 {
-	text = wrapText(text, xLen);
-	return sizeText(text, lineSpacing);
+	size_t textHash, key;
+	Measure* cached = findMeasure(MEASURE_WRAPPED_SIZE, text, xLen, lineSpacing, textHash, key);
+	if (cached != nullptr)
+		return cached->size;
+
+	Vector2f size = sizeText(wrapText(text, xLen), lineSpacing);
+	addMeasure(MEASURE_WRAPPED_SIZE, text, xLen, lineSpacing, textHash, key).size = size;
+	return size;
 }
 
-Vector2f Font::getWrappedTextCursorOffset(std::string text, float xLen, size_t stop, float lineSpacing)
+Vector2f Font::getWrappedTextCursorOffset(const std::string& text, float xLen, size_t stop, float lineSpacing)
 {
 	std::string wrappedText = wrapText(text, xLen);
 
@@ -797,8 +1263,8 @@ Vector2f Font::getWrappedTextCursorOffset(std::string text, float xLen, size_t s
 	size_t cursor = 0;
 	while(cursor < stop)
 	{
-		unsigned int wrappedCharacter = Utils::String::chars2Unicode(wrappedText, wrapCursor);
-		unsigned int character = Utils::String::chars2Unicode(text, cursor);
+		unsigned int wrappedCharacter = Utils::String::nextUnicode(wrappedText, wrapCursor);
+		unsigned int character = Utils::String::nextUnicode(text, cursor);
 
 		if(wrappedCharacter == '\n' && character != '\n')
 		{
@@ -851,7 +1317,14 @@ float Font::getNewlineStartOffset(const std::string& text, const unsigned int& c
 	}
 }
 
-TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsigned int color, float xLen, Alignment alignment, float lineSpacing)
+TextCache* Font::buildTextCache(const std::string& text, Vector2f offset, unsigned int color, float xLen, Alignment alignment, float lineSpacing)
+{
+	TextCache* cache = new TextCache();
+	updateTextCache(cache, text, offset, color, xLen, alignment, lineSpacing);
+	return cache;
+}
+
+void Font::updateTextCache(TextCache* cache, const std::string& _text, Vector2f offset, unsigned int color, float xLen, Alignment alignment, float lineSpacing)
 {
 	float x = offset[0] + (xLen != 0 ? getNewlineStartOffset(_text, 0, xLen, alignment) : 0);
 	
@@ -861,10 +1334,15 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 	float yDecal = (yBot + yTop) / 2.0f;
 	float y = offset[1] + (yBot + yTop)/2.0f;
 
-	// vertices by texture
-	std::map< FontTexture*, std::vector<Renderer::Vertex> > vertMap;
+	// vertices by texture : the previous lists are kept with their capacity, so that an update with the same glyph count does not allocate
+	for (auto& vertList : cache->vertexLists)
+		vertList.verts.clear();
 
-	std::string text = EsLocale::isRTL() ? tryFastBidi(_text) : _text;
+	cache->imageSubstitutes.clear();
+	size_t listIndex = 0;
+	bool pendingGlyphs = false;
+
+	std::string text = EsLocale::isRTL() && hasBidiChars(_text) ? getBidiText(_text) : _text;
 
 	std::map<int, int> tabStops;
 	int tabIndex = 0;
@@ -883,11 +1361,11 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 			size_t pos = 0;
 			while (pos < text.length())
 			{
-				unsigned int character = Utils::String::chars2Unicode(text, pos); // also advances cursor
+				unsigned int character = Utils::String::nextUnicode(text, pos); // also advances cursor
 				if (character == 0 || character == '\r')
 					continue;
 
-				if (substituableChars.find(character) != substituableChars.cend())
+				if (character >= SUBSTITUABLE_FIRST && substituableChars.find(character) != substituableChars.cend())
 				{
 					x += yBot;
 					continue;
@@ -914,8 +1392,6 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 		}
 	}
 
-	std::vector<TextImageSubstitute> imageSubstitutes;
-
 	bool inParenthesis = false;
 	bool inBlock = false;
 
@@ -923,10 +1399,10 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 	size_t cursor = 0;
 	while(cursor < text.length())
 	{
-		unsigned int character = Utils::String::chars2Unicode(text, cursor); // also advances cursor
+		unsigned int character = Utils::String::nextUnicode(text, cursor); // also advances cursor
 
-		auto it = substituableChars.find(character);
-		if (it != substituableChars.cend() && ResourceManager::getInstance()->fileExists(it->second))
+		auto it = character >= SUBSTITUABLE_FIRST ? substituableChars.find(character) : substituableChars.end();
+		if (it != substituableChars.end() && ResourceManager::getInstance()->fileExists(it->second))
 		{
 			auto padding = (yTop / 4.0f);
 
@@ -956,7 +1432,7 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 				is.vertex[2] = { { (float) rc.x + rc.w  , (float) rc.y + rc.h }	, { 1.0f, 0.0f }, 0xFFFFFFFF };
 				is.vertex[3] = { { (float) rc.x + rc.w  , (float) rc.y }		, { 1.0f, 1.0f }, 0xFFFFFFFF };
 
-				imageSubstitutes.push_back(is);
+				cache->imageSubstitutes.push_back(is);
 
 				x += yBot - (2.0f*padding);
 				continue;
@@ -1008,18 +1484,29 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 		if(glyph == NULL)
 			continue;
 
-		std::vector<Renderer::Vertex>& verts = vertMap[glyph->texture];
+		if (glyph->pending)
+		{
+			pendingGlyphs = true;
+			x += glyph->advance.x();
+			continue;
+		}
+
+		if (listIndex >= cache->vertexLists.size() || cache->vertexLists[listIndex].textureIdPtr != &glyph->texture->textureId)
+			listIndex = cache->getVertexList(&glyph->texture->textureId);
+
+		std::vector<Renderer::Vertex>& verts = cache->vertexLists[listIndex].verts;
 		size_t oldVertSize = verts.size();
 		verts.resize(oldVertSize + 6);
 		Renderer::Vertex* vertices = verts.data() + oldVertSize;
 
-		const float        glyphStartX    = x + glyph->bearing.x();
+		const float        glyphStartX    = x + glyph->bearing.x() - glyph->padding;
+		const float        glyphStartY    = y - glyph->bearing.y() - glyph->padding;
 		const unsigned int convertedColor = Renderer::convertColor(color);
 
-		vertices[1] = { { glyphStartX                                       , y - glyph->bearing.y()                                          }, { glyph->texPos.x(),                      glyph->texPos.y()                      }, convertedColor };
-		vertices[2] = { { glyphStartX                                       , y - glyph->bearing.y() + (glyph->glyphSize.y())                 }, { glyph->texPos.x(),                      glyph->texPos.y() + glyph->texSize.y() }, convertedColor };
-		vertices[3] = { { glyphStartX + glyph->glyphSize.x()                , y - glyph->bearing.y()                                          }, { glyph->texPos.x() + glyph->texSize.x(), glyph->texPos.y()                      }, convertedColor };
-		vertices[4] = { { glyphStartX + glyph->glyphSize.x()                , y - glyph->bearing.y() + (glyph->glyphSize.y())                 }, { glyph->texPos.x() + glyph->texSize.x(), glyph->texPos.y() + glyph->texSize.y() }, convertedColor };
+		vertices[1] = { { glyphStartX                                       , glyphStartY                                                     }, { glyph->texPos.x(),                      glyph->texPos.y()                      }, convertedColor };
+		vertices[2] = { { glyphStartX                                       , glyphStartY + (glyph->glyphSize.y())                            }, { glyph->texPos.x(),                      glyph->texPos.y() + glyph->texSize.y() }, convertedColor };
+		vertices[3] = { { glyphStartX + glyph->glyphSize.x()                , glyphStartY                                                     }, { glyph->texPos.x() + glyph->texSize.x(), glyph->texPos.y()                      }, convertedColor };
+		vertices[4] = { { glyphStartX + glyph->glyphSize.x()                , glyphStartY + (glyph->glyphSize.y())                            }, { glyph->texPos.x() + glyph->texSize.x(), glyph->texPos.y() + glyph->texSize.y() }, convertedColor };
 
 		// round vertices
 		for (int i = 1; i < 5; ++i)
@@ -1040,26 +1527,47 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 		x += glyph->advance.x();
 	}
 
-	//TextCache::CacheMetrics metrics = { sizeText(text, lineSpacing) };
+	// Pages no longer used by the text
+	for (auto it = cache->vertexLists.begin(); it != cache->vertexLists.end(); )
+	{
+		if (it->verts.empty())
+		{
+			TextCache::releaseVertices(it->verts);
+			it = cache->vertexLists.erase(it);
+		}
+		else
+			it++;
+	}
 
-	TextCache* cache = new TextCache();
-	cache->vertexLists.resize(vertMap.size());
 	cache->metrics = { sizeText(text, lineSpacing) };
-	cache->imageSubstitutes = imageSubstitutes;
 
-	unsigned int i = 0;
-	for(auto it = vertMap.cbegin(); it != vertMap.cend(); it++)
-	{
-		TextCache::VertexList& vertList = cache->vertexLists.at(i);
+	// Kept to be rebuilt once the worker is done
+	cache->pendingGlyphs = pendingGlyphs;
+	cache->glyphGeneration = sGlyphGeneration;
 
-		vertList.textureIdPtr = &it->first->textureId;
-		vertList.verts = it->second;
-		i++;
-	}
+	if (pendingGlyphs)
+		cache->pendingText = { _text, offset, color, xLen, alignment, lineSpacing };
+	else
+		cache->pendingText.text.clear();
+
+	cache->updateMemUsage();
 
 	clearFaceCache();
+}
 
-	return cache;
+void Font::refreshTextCache(TextCache* cache)
+{
+	if (!cache->pendingGlyphs || cache->glyphGeneration == sGlyphGeneration || cache->renderingGlow)
+		return;
+
+	TextCache::PendingText pending = cache->pendingText;
+	updateTextCache(cache, pending.text, pending.offset, pending.color, pending.xLen, pending.alignment, pending.lineSpacing);
+
+	// The colors set since the build
+	if (cache->colorMode == TextCache::COLOR_SINGLE)
+		cache->setColor(cache->colors[0]);
+	else if (cache->colorMode == TextCache::COLOR_EXTRA)
+		cache->setColors(cache->colors[0], cache->colors[1]);
 }
 
 TextCache* Font::buildTextCache(const std::string& text, float offsetX, float offsetY, unsigned int color)
@@ -1067,8 +1575,61 @@ TextCache* Font::buildTextCache(const std::string& text, float offsetX, float of
 	return buildTextCache(text, Vector2f(offsetX, offsetY), color, 0.0f);
 }
 
+std::vector<std::vector<Renderer::Vertex>> TextCache::sVertexPool;
+
+TextCache::~TextCache()
+{
+	for (auto& vertList : vertexLists)
+		releaseVertices(vertList.verts);
+}
+
+void TextCache::updateMemUsage()
+{
+	size_t size = sizeof(TextCache) + vertexLists.capacity() * sizeof(VertexList) + imageSubstitutes.capacity() * sizeof(TextImageSubstitute) + pendingText.text.capacity();
+	for (auto& vertList : vertexLists)
+		size += vertList.verts.capacity() * sizeof(Renderer::Vertex);
+
+	memUsage.set(size);
+}
+
+size_t TextCache::getVertexList(unsigned int* textureIdPtr)
+{
+	for (size_t i = 0; i < vertexLists.size(); i++)
+		if (vertexLists[i].textureIdPtr == textureIdPtr)
+			return i;
+
+	VertexList vertList;
+	vertList.textureIdPtr = textureIdPtr;
+
+	if (!sVertexPool.empty())
+	{
+		vertList.verts.swap(sVertexPool.back());
+		sVertexPool.pop_back();
+	}
+
+	vertexLists.push_back(std::move(vertList));
+	return vertexLists.size() - 1;
+}
+
+void TextCache::releaseVertices(std::vector<Renderer::Vertex>& verts)
+{
+	// Long texts keep their own storage, the pool is meant for the many short labels that are rebuilt
+	if (verts.capacity() == 0 || verts.capacity() > VERTEX_POOL_MAX_CAPACITY || sVertexPool.size() >= VERTEX_POOL_SIZE)
+		return;
+
+	verts.clear();
+	sVertexPool.push_back(std::move(verts));
+}
+
 void TextCache::setColors(unsigned int color, unsigned int extraColor)
 {
+	if (!renderingGlow)
+	{
+		colorMode = COLOR_EXTRA;
+		colors[0] = color;
+		colors[1] = extraColor;
+	}
+
 	const unsigned int convertedColor = Renderer::convertColor(color);
 	const unsigned int convertedExtraColor = Renderer::convertColor(extraColor);
 
@@ -1086,6 +1647,12 @@ void TextCache::setColors(unsigned int color, unsigned int extraColor)
 
 void TextCache::setColor(unsigned int color)
 {
+	if (!renderingGlow)
+	{
+		colorMode = COLOR_SINGLE;
+		colors[0] = color;
+	}
+
 	const unsigned int convertedColor = Renderer::convertColor(color);
 
 	for (auto it = vertexLists.begin(); it != vertexLists.end(); it++)
@@ -1166,11 +1733,16 @@ void Font::OnThemeChanged()
 			auto stem = Utils::FileSystem::getStem(file.path);
 
 			auto val = Utils::String::fromHexString(stem);
-			if (val >= 0xF000)
+			if (val >= SUBSTITUABLE_FIRST)
 			{
 				substituableChars.erase(val);
 				substituableChars.insert(std::pair<unsigned int, std::string>(val, file.path));
 			}
 		}
 	}
+
+	// Substituted characters are measured as images
+	for (auto font : sFontMap)
+		if (!font.second.expired())
+			font.second.lock()->clearMeasures();
 }
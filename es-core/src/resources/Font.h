@@ -6,9 +6,14 @@
 #include "math/Vector2i.h"
 #include "renderers/Renderer.h"
 #include "resources/ResourceManager.h"
+#include "resources/GlyphRasterizer.h"
 #include "ThemeData.h"
+#include "MemoryStats.h"
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include <list>
+#include <set>
+#include <unordered_map>
 #include <vector>
 
 class TextCache;
@@ -47,20 +52,34 @@ public:
 	static std::shared_ptr<Font> get(int size, const std::string& path = getDefaultPath());
 	static void OnThemeChanged();
 
+	// Uploads the glyphs rasterized by the GlyphRasterizer worker since the previous call
+	static void uploadRasterizedGlyphs();
+
+	// Rasterizes the glyphs the previous runs used with the loaded fonts, for at most maxTimeMs ( everything when negative ). Returns true while some are left
+	static bool prewarmGlyphs(int maxTimeMs);
+
+	// Reorders an RTL string ahead into the bidi cache, for the lists of the "PrecomputeBidi" setting
+	static void prepareBidiText(const std::string& text);
+
+	// "FontDistanceField" setting : every size of a font is drawn from one distance field atlas, rasterized at a single size
+	static bool isDistanceFieldEnabled();
+
 	virtual ~Font();
 
-	Vector2f sizeText(std::string text, float lineSpacing = 1.5f); // Returns the expected size of a string when rendered.  Extra spacing is applied to the Y axis.
+	Vector2f sizeText(const std::string& text, float lineSpacing = 1.5f); // Returns the expected size of a string when rendered.  Extra spacing is applied to the Y axis.
 	TextCache* buildTextCache(const std::string& text, float offsetX, float offsetY, unsigned int color);
 	TextCache* buildTextCache(const std::string& text, Vector2f offset, unsigned int color, float xLen, Alignment alignment = ALIGN_LEFT, float lineSpacing = 1.5f);
+	// Rebuilds an existing cache in place, reusing its vertex storage ( clocks, counters... )
+	void updateTextCache(TextCache* cache, const std::string& text, Vector2f offset, unsigned int color, float xLen, Alignment alignment = ALIGN_LEFT, float lineSpacing = 1.5f);
 	
 	void renderTextCache(TextCache* cache, bool verticesChanged = true);
 	void renderTextCacheEx(TextCache* cache, const Transform4x4f& parentTrans, unsigned int mGlowSize, unsigned int mGlowColor, Vector2f& mGlowOffset, unsigned char mOpacity = 255);
 
 	void renderGradientTextCache(TextCache* cache, unsigned int colorTop, unsigned int colorBottom, bool horz = false);
 	
-	std::string wrapText(std::string text, float xLen); // Inserts newlines into text to make it wrap properly.
-	Vector2f sizeWrappedText(std::string text, float xLen, float lineSpacing = 1.5f); // Returns the expected size of a string after wrapping is applied.
-	Vector2f getWrappedTextCursorOffset(std::string text, float xLen, size_t cursor, float lineSpacing = 1.5f); // Returns the position of of the cursor after moving "cursor" characters.
+	std::string wrapText(const std::string& text, float xLen); // Inserts newlines into text to make it wrap properly.
+	Vector2f sizeWrappedText(const std::string& text, float xLen, float lineSpacing = 1.5f); // Returns the expected size of a string after wrapping is applied.
+	Vector2f getWrappedTextCursorOffset(const std::string& text, float xLen, size_t cursor, float lineSpacing = 1.5f); // Returns the position of of the cursor after moving "cursor" characters.
 
 	float getHeight(float lineSpacing = 1.5f) const;
 	float getLetterHeight();
@@ -81,10 +100,17 @@ public:
 private:
 	void renderSingleGlow(TextCache* cache, const Transform4x4f& parentTrans, float x, float y, bool verticesChanged = true);
 
+	// Rebuilds a cache drawn with the blanks of pending glyphs, once some are done
+	void refreshTextCache(TextCache* cache);
+	static unsigned int sGlyphGeneration; // Incremented when rasterized glyphs are uploaded
+
 	static FT_Library sLibrary;
 	static std::map< std::pair<std::string, int>, std::weak_ptr<Font> > sFontMap;
+	static std::map< std::string, std::weak_ptr<Font> > sDistanceFieldFonts; // Atlas owners, by path
 
-	Font(int size, const std::string& path);
+	static std::shared_ptr<Font> getDistanceFieldSource(const std::string& path);
+
+	Font(int size, const std::string& path, bool distanceField = false, const std::shared_ptr<Font>& distanceFieldSource = nullptr);
 
 	class FontTexture
 	{
@@ -94,6 +120,7 @@ private:
 
 		Vector2i writePos;
 		int rowHeight;
+		bool distanceField;
 
 		FontTexture();
 		~FontTexture();
@@ -120,6 +147,7 @@ private:
 	void getTextureForNewGlyph(const Vector2i& glyphSize, FontTexture*& tex_out, Vector2i& cursor_out);
 
 	std::map< unsigned int, std::unique_ptr<FontFace> > mFaceCache;
+	FT_Face getFace(unsigned int index); // 0 is mPath, then the fallbacks
 	FT_Face getFaceForChar(unsigned int id);
 	void clearFaceCache();
 
@@ -135,12 +163,49 @@ private:
 
 		Vector2i cursor;
 		Vector2i glyphSize;
+
+		float padding; // Distance field border around the outline, included in glyphSize
+		bool pending; // Queued to the GlyphRasterizer : no texture yet, only the expected advance
 	};
 
-	Glyph* mGlyphCacheArray[255]; // used to cache 255 first chars
+	// Direct-mapped glyphs of the Latin ranges ( 0-0x24F ) and of the general punctuation & currency symbols ( 0x2000-0x20CF ).
+	// The map owns all the glyphs, and is the only lookup for the rare codepoints
+	static const unsigned int GLYPH_TABLE_LATIN = 0x250;
+	static const unsigned int GLYPH_TABLE_PUNCTUATION = 0x2000;
+	static const unsigned int GLYPH_TABLE_PUNCTUATION_END = 0x20D0;
+	static const unsigned int GLYPH_TABLE_SIZE = GLYPH_TABLE_LATIN + GLYPH_TABLE_PUNCTUATION_END - GLYPH_TABLE_PUNCTUATION;
+
+	Glyph* mGlyphTable[GLYPH_TABLE_SIZE];
 	std::map<unsigned int, Glyph*> mGlyphMap;
 
+	static inline int getGlyphTableIndex(unsigned int id)
+	{
+		if (id < GLYPH_TABLE_LATIN)
+			return (int)id;
+
+		if (id >= GLYPH_TABLE_PUNCTUATION && id < GLYPH_TABLE_PUNCTUATION_END)
+			return (int)(GLYPH_TABLE_LATIN + id - GLYPH_TABLE_PUNCTUATION);
+
+		return -1;
+	}
+
+	void addGlyph(unsigned int id, Glyph* pGlyph);
+
 	Glyph* getGlyph(unsigned int id);
+	Glyph* getScaledGlyph(unsigned int id);
+	bool placeGlyph(Glyph* pGlyph, const Vector2i& glyphSize, const Vector2f& advance, const Vector2f& bearing, const unsigned char* bitmap);
+
+	bool isAsyncGlyph(unsigned int id);
+	Glyph* queueGlyph(unsigned int id);
+	void uploadRasterizedGlyph(const GlyphRasterizer::Result& result);
+
+	std::set<unsigned int> mSyncGlyphs; // The worker failed, rasterized on the main thread
+
+	void saveGlyphSet();
+
+	std::vector<unsigned int> mPrewarmGlyphs; // From the glyph cache, not yet rasterized
+	bool mPrewarming;
+	bool mGlyphSetChanged;
 
 	int mMaxGlyphHeight;
 	
@@ -148,8 +213,36 @@ private:
 	const std::string mPath;
 	bool mLoaded;
 
+	bool mDistanceField;
+	std::shared_ptr<Font> mDistanceFieldSource; // Owns the atlas the glyphs of the other sizes are scaled from
+
 	float getNewlineStartOffset(const std::string& text, const unsigned int& charStart, const float& xLen, const Alignment& alignment);
 
+	static const int MEASURE_CACHE_SIZE = 256;
+
+	enum MeasureKind { MEASURE_SIZE, MEASURE_WRAP, MEASURE_WRAPPED_SIZE };
+
+	// Results of sizeText, wrapText & sizeWrappedText, while layouts settle they're asked the same strings many times
+	struct Measure
+	{
+		MeasureKind	kind;
+		size_t		textHash;
+		size_t		textLength;
+		float		width;
+		float		lineSpacing;
+
+		size_t		key;
+		Vector2f	size;
+		std::string	wrapped;
+	};
+
+	Measure* findMeasure(MeasureKind kind, const std::string& text, float width, float lineSpacing, size_t& textHash, size_t& key);
+	Measure& addMeasure(MeasureKind kind, const std::string& text, float width, float lineSpacing, size_t textHash, size_t key);
+	void clearMeasures();
+
+	std::list<Measure> mMeasures; // Most recently used first
+	std::unordered_map<size_t, std::list<Measure>::iterator> mMeasureIndex;
+
 	friend TextCache;
 };
 
@@ -181,12 +274,50 @@ protected:
 	std::vector<TextImageSubstitute> imageSubstitutes;
 	bool renderingGlow;
 
+	// Built with glyphs still on the GlyphRasterizer worker : the arguments & colors to rebuild it ( Font::refreshTextCache )
+	struct PendingText
+	{
+		std::string text;
+		Vector2f offset;
+		unsigned int color;
+		float xLen;
+		Alignment alignment;
+		float lineSpacing;
+	};
+
+	enum ColorMode { COLOR_BUILD, COLOR_SINGLE, COLOR_EXTRA };
+
+	bool pendingGlyphs;
+	unsigned int glyphGeneration;
+	PendingText pendingText;
+
+	ColorMode colorMode;
+	unsigned int colors[2];
+
+	MemoryCounter<MemoryStats::TEXT_CACHE> memUsage;
+	void updateMemUsage();
+
+	// Index of the list of the texture, created with a pooled vector when missing
+	size_t getVertexList(unsigned int* textureIdPtr);
+
+	// Vertex storage of the destroyed caches, reused by the next ones
+	static const size_t VERTEX_POOL_SIZE = 128;
+	static const size_t VERTEX_POOL_MAX_CAPACITY = 6 * 256;
+
+	static std::vector<std::vector<Renderer::Vertex>> sVertexPool;
+	static void releaseVertices(std::vector<Renderer::Vertex>& verts);
+
 public:
 	TextCache()
 	{
 		renderingGlow = false;
+		pendingGlyphs = false;
+		glyphGeneration = 0;
+		colorMode = COLOR_BUILD;
 	}
 
+	~TextCache();
+
 	struct CacheMetrics
 	{
 		Vector2f size;
@@ -0,0 +1,85 @@
+#include "resources/GlyphCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/BinaryStream.h"
+#include "utils/MemoryMappedFile.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <fstream>
+
+#define GLYPH_CACHE_MAGIC	0x43594c47 // 'GLYC'
+
+bool GlyphCache::isEnabled()
+{
+	return Settings::getInstance()->getBool("GlyphCache");
+}
+
+std::string GlyphCache::getCacheFolder()
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/glyphs");
+}
+
+std::string GlyphCache::getCachePath(const std::string& fontPath, int size)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)std::hash<std::string>()(fontPath + "|" + std::to_string(size)));
+	return getCacheFolder() + "/" + name;
+}
+
+std::vector<unsigned int> GlyphCache::load(const std::string& fontPath, int size)
+{
+	std::vector<unsigned int> ret;
+	if (!isEnabled())
+		return ret;
+
+	Utils::MemoryMappedFile file(getCachePath(fontPath, size));
+	if (!file.isOpen())
+		return ret;
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (reader.readUInt32() != GLYPH_CACHE_MAGIC || reader.readString() != fontPath || (int)reader.readUInt32() != size)
+		return ret;
+
+	uint32_t count = reader.readUInt32();
+	if (reader.failed() || count > MAX_GLYPHS)
+		return ret;
+
+	ret.reserve(count);
+	for (uint32_t i = 0; i < count; i++)
+		ret.push_back(reader.readUInt32());
+
+	if (reader.failed())
+		ret.clear();
+
+	return ret;
+}
+
+void GlyphCache::save(const std::string& fontPath, int size, const std::vector<unsigned int>& glyphs)
+{
+	if (!isEnabled() || glyphs.empty())
+		return;
+
+	size_t count = std::min(glyphs.size(), (size_t)MAX_GLYPHS);
+
+	Utils::BinaryWriter writer;
+	writer.writeUInt32(GLYPH_CACHE_MAGIC);
+	writer.writeString(fontPath);
+	writer.writeUInt32((uint32_t)size);
+	writer.writeUInt32((uint32_t)count);
+
+	for (size_t i = 0; i < count; i++)
+		writer.writeUInt32(glyphs[i]);
+
+	Utils::FileSystem::writeFileAtomic(getCachePath(fontPath, size), writer);
+}
+
+void GlyphCache::clear()
+{
+	std::string folder = getCacheFolder();
+	if (Utils::FileSystem::exists(folder))
+		Utils::FileSystem::deleteDirectoryFiles(folder);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_GLYPH_CACHE_H
+#define ES_CORE_RESOURCES_GLYPH_CACHE_H
+
+#include <string>
+#include <vector>
+
+// Characters used by each (font path, size), stored on disk so that the next runs rasterize them ahead instead of when they're first shown.
+// Enabled with the "GlyphCache" setting
+class GlyphCache
+{
+public:
+	static const int MAX_GLYPHS = 4096;
+
+	static bool isEnabled();
+
+	static std::vector<unsigned int> load(const std::string& fontPath, int size);
+	static void save(const std::string& fontPath, int size, const std::vector<unsigned int>& glyphs);
+
+	static void clear();
+
+private:
+	static std::string getCacheFolder();
+	static std::string getCachePath(const std::string& fontPath, int size);
+};
+
+#endif // ES_CORE_RESOURCES_GLYPH_CACHE_H
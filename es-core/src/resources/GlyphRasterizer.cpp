@@ -0,0 +1,227 @@
+#include "resources/GlyphRasterizer.h"
+
+#include "Settings.h"
+#include "Log.h"
+#include "TaskScheduler.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <condition_variable>
+#include <cstring>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#define FACE_BLOCK_SHIFT	7	// Codepoints are assigned to the fallback faces by blocks of 128
+
+class GlyphRasterizerThread
+{
+public:
+	GlyphRasterizerThread() : mThread(nullptr), mShouldTerminate(false) { }
+	~GlyphRasterizerThread() { stop(); }
+
+	void queue(const GlyphRasterizer::Request& request)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		if (mThread == nullptr)
+		{
+			mShouldTerminate = false;
+			mThread = new std::thread(&GlyphRasterizerThread::run, this);
+		}
+
+		mRequests.push_back(request);
+		mEvent.notify_one();
+	}
+
+	void getResults(std::vector<GlyphRasterizer::Result>& results)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		for (auto& result : mResults)
+			results.push_back(std::move(result));
+
+		mResults.clear();
+	}
+
+	void stop()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			if (mThread == nullptr)
+				return;
+
+			mShouldTerminate = true;
+			mRequests.clear();
+			mEvent.notify_one();
+		}
+
+		mThread->join();
+		delete mThread;
+		mThread = nullptr;
+
+		mResults.clear();
+	}
+
+private:
+	void run()
+	{
+		TaskScheduler::setCurrentThreadPriority(TaskScheduler::TEXTURE_IO);
+
+		FT_Library library;
+		if (FT_Init_FreeType(&library))
+		{
+			LOG(LogError) << "GlyphRasterizer : Error initializing FreeType";
+			return;
+		}
+
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mEvent.wait(lock, [this]() { return mShouldTerminate || !mRequests.empty(); });
+
+			if (mShouldTerminate)
+				break;
+
+			GlyphRasterizer::Request request = mRequests.front();
+			mRequests.pop_front();
+
+			lock.unlock();
+
+			GlyphRasterizer::Result result = rasterize(library, request);
+
+			lock.lock();
+			mResults.push_back(std::move(result));
+
+			bool idle = mRequests.empty();
+			lock.unlock();
+
+			// Same as Font::clearFaceCache, the faces of the large fonts are not kept around
+			if (idle)
+				closeFaces();
+		}
+
+		closeFaces();
+		FT_Done_FreeType(library);
+	}
+
+	FT_Face getFace(FT_Library library, const ResourceData& data, int size)
+	{
+		auto key = std::make_pair(data.ptr.get(), size);
+
+		auto it = mFaces.find(key);
+		if (it != mFaces.cend())
+			return it->second;
+
+		FT_Face face = nullptr;
+		if (FT_New_Memory_Face(library, data.ptr.get(), (FT_Long)data.length, 0, &face) == 0)
+			FT_Set_Pixel_Sizes(face, 0, size);
+		else
+			face = nullptr;
+
+		mFaces[key] = face;
+		return face;
+	}
+
+	void closeFaces()
+	{
+		for (auto face : mFaces)
+			if (face.second != nullptr)
+				FT_Done_Face(face.second);
+
+		mFaces.clear();
+	}
+
+	GlyphRasterizer::Result rasterize(FT_Library library, const GlyphRasterizer::Request& request)
+	{
+		GlyphRasterizer::Result result;
+		result.fontPath = request.fontPath;
+		result.size = request.size;
+		result.id = request.id;
+		result.valid = false;
+
+		if (request.faces.empty())
+			return result;
+
+		// The face that had the previous character of the block is the likely one
+		auto block = std::make_pair(request.fontPath, request.id >> FACE_BLOCK_SHIFT);
+
+		FT_Face face = nullptr;
+
+		auto hint = mBlocks.find(block);
+		if (hint != mBlocks.cend() && hint->second < request.faces.size())
+		{
+			FT_Face candidate = getFace(library, request.faces[hint->second], request.size);
+			if (candidate != nullptr && FT_Get_Char_Index(candidate, request.id) != 0)
+				face = candidate;
+		}
+
+		for (size_t i = 0; face == nullptr && i < request.faces.size(); i++)
+		{
+			FT_Face candidate = getFace(library, request.faces[i], request.size);
+			if (candidate != nullptr && FT_Get_Char_Index(candidate, request.id) != 0)
+			{
+				face = candidate;
+				mBlocks[block] = i;
+			}
+		}
+
+		// nothing has a valid glyph - use the "real" face so we get a "missing" character
+		if (face == nullptr)
+			face = getFace(library, request.faces[0], request.size);
+
+		if (face == nullptr || FT_Load_Char(face, request.id, FT_LOAD_RENDER) != 0)
+			return result;
+
+		FT_GlyphSlot g = face->glyph;
+
+		result.valid = true;
+		result.glyphSize = Vector2i(g->bitmap.width, g->bitmap.rows);
+		result.advance = Vector2f((float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f);
+		result.bearing = Vector2f((float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f);
+
+		int width = g->bitmap.width;
+		int pitch = g->bitmap.pitch < 0 ? -g->bitmap.pitch : g->bitmap.pitch;
+
+		result.bitmap.resize(width * g->bitmap.rows);
+		for (unsigned int y = 0; y < g->bitmap.rows; y++)
+			memcpy(result.bitmap.data() + y * width, g->bitmap.buffer + y * pitch, width);
+
+		return result;
+	}
+
+	std::thread*							mThread;
+	std::mutex								mMutex;
+	std::condition_variable					mEvent;
+	bool									mShouldTerminate;
+
+	std::list<GlyphRasterizer::Request>		mRequests;
+	std::list<GlyphRasterizer::Result>		mResults;
+
+	// Worker side only
+	std::map<std::pair<const unsigned char*, int>, FT_Face>		mFaces;
+	std::map<std::pair<std::string, unsigned int>, size_t>		mBlocks;	// Face index by (font, codepoint block), for the session
+};
+
+static GlyphRasterizerThread sRasterizer;
+
+bool GlyphRasterizer::isEnabled()
+{
+	return Settings::getInstance()->getBool("AsyncGlyphs");
+}
+
+void GlyphRasterizer::queue(const Request& request)
+{
+	sRasterizer.queue(request);
+}
+
+void GlyphRasterizer::getResults(std::vector<Result>& results)
+{
+	sRasterizer.getResults(results);
+}
+
+void GlyphRasterizer::stop()
+{
+	sRasterizer.stop();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_GLYPH_RASTERIZER_H
+#define ES_CORE_RESOURCES_GLYPH_RASTERIZER_H
+
+#include "math/Vector2f.h"
+#include "math/Vector2i.h"
+#include "resources/ResourceManager.h"
+#include <string>
+#include <vector>
+
+// Rasterizes glyphs on a worker thread, with its own FreeType library & faces, so that the first render of a text in a large CJK face does not stall the frame.
+// Enabled with the "AsyncGlyphs" setting. The fonts upload the results to their atlas from the main thread ( Font::uploadRasterizedGlyphs )
+class GlyphRasterizer
+{
+public:
+	struct Request
+	{
+		std::string					fontPath;
+		int							size;
+		unsigned int				id;
+		std::vector<ResourceData>	faces;		// The font file, then the fallbacks
+	};
+
+	struct Result
+	{
+		std::string					fontPath;
+		int							size;
+		unsigned int				id;
+		bool						valid;
+
+		Vector2i					glyphSize;
+		Vector2f					advance;
+		Vector2f					bearing;
+		std::vector<unsigned char>	bitmap;		// glyphSize.x() * glyphSize.y() coverage bytes
+	};
+
+	static bool isEnabled();
+
+	static void queue(const Request& request);
+
+	// Moves the finished requests into results
+	static void getResults(std::vector<Result>& results);
+
+	static void stop();
+};
+
+#endif // ES_CORE_RESOURCES_GLYPH_RASTERIZER_H
@@ -0,0 +1,106 @@
+#include "resources/PixelBuffer.h"
+
+#include "MemoryProfile.h"
+
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Smaller buffers ( icons, glyphs, blank textures ) go straight to the heap
+#define MIN_POOLED_SIZE (64 * 1024)
+
+// Idle bytes kept for the next decodes
+#define MAX_IDLE_BYTES (48 * 1024 * 1024)
+#define MAX_IDLE_BYTES_LOW_MEMORY (12 * 1024 * 1024)
+
+#define MAX_IDLE_PER_CLASS 4
+
+// Capacity of the buffer, in front of the pixels. 16 bytes keep the pixels aligned like new[]
+#define HEADER_SIZE 16
+
+static std::mutex sLock;
+static std::map<size_t, std::vector<unsigned char*>> sIdle; // Blocks, by capacity
+static size_t sIdleBytes = 0;
+
+static size_t getCapacity(size_t size)
+{
+	if (size <= MIN_POOLED_SIZE)
+		return size;
+
+	size_t base = MIN_POOLED_SIZE;
+	while (base * 2 < size)
+		base *= 2;
+
+	size_t step = base / 4;
+	return base + ((size - base + step - 1) / step) * step;
+}
+
+unsigned char* PixelBufferPool::allocate(size_t size)
+{
+	size_t capacity = getCapacity(size);
+
+	if (capacity > MIN_POOLED_SIZE)
+	{
+		std::unique_lock<std::mutex> lock(sLock);
+
+		auto it = sIdle.find(capacity);
+		if (it != sIdle.cend() && !it->second.empty())
+		{
+			unsigned char* block = it->second.back();
+			it->second.pop_back();
+			sIdleBytes -= capacity;
+
+			return block + HEADER_SIZE;
+		}
+	}
+
+	unsigned char* block = (unsigned char*) ::operator new(capacity + HEADER_SIZE);
+	*(size_t*)block = capacity;
+
+	return block + HEADER_SIZE;
+}
+
+void PixelBufferPool::release(unsigned char* data)
+{
+	if (data == nullptr)
+		return;
+
+	unsigned char* block = data - HEADER_SIZE;
+	size_t capacity = *(size_t*)block;
+
+	if (capacity > MIN_POOLED_SIZE)
+	{
+		size_t maxIdleBytes = MemoryProfile::isLowMemory() ? MAX_IDLE_BYTES_LOW_MEMORY : MAX_IDLE_BYTES;
+
+		std::unique_lock<std::mutex> lock(sLock);
+
+		auto& blocks = sIdle[capacity];
+		if (blocks.size() < MAX_IDLE_PER_CLASS && sIdleBytes + capacity <= maxIdleBytes)
+		{
+			blocks.push_back(block);
+			sIdleBytes += capacity;
+			return;
+		}
+	}
+
+	::operator delete(block);
+}
+
+void PixelBufferPool::clear()
+{
+	std::unique_lock<std::mutex> lock(sLock);
+
+	for (auto& blocks : sIdle)
+		for (auto block : blocks.second)
+			::operator delete(block);
+
+	sIdle.clear();
+	sIdleBytes = 0;
+}
+
+size_t PixelBufferPool::getIdleBytes()
+{
+	std::unique_lock<std::mutex> lock(sLock);
+	return sIdleBytes;
+}
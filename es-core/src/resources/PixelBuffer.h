@@ -0,0 +1,33 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_PIXEL_BUFFER_H
+#define ES_CORE_RESOURCES_PIXEL_BUFFER_H
+
+#include <cstddef>
+#include <memory>
+
+// Decoded pixels buffers. The sizes are rounded up to size classes ( 4 per power of two, at most 25% unused ) and the released
+// buffers are kept per class, so that the next decode of a similar image reuses one instead of going back to the heap.
+// Thread safe : the buffers are allocated by the loader threads & released by the render thread
+class PixelBufferPool
+{
+public:
+	// Same failure as new[]
+	static unsigned char* allocate(size_t size);
+	// nullptr is ignored
+	static void release(unsigned char* data);
+
+	// Frees the idle buffers
+	static void clear();
+
+	static size_t getIdleBytes();
+};
+
+struct PixelBufferDeleter
+{
+	void operator()(unsigned char* data) const { PixelBufferPool::release(data); }
+};
+
+// Owner of a pooled buffer : decoded pixels are moved from the decoder to the texture, never copied
+typedef std::unique_ptr<unsigned char[], PixelBufferDeleter> PixelBuffer;
+
+#endif // ES_CORE_RESOURCES_PIXEL_BUFFER_H
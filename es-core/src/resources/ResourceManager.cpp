@@ -2,6 +2,7 @@
 
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
+#include "utils/MemoryMappedFile.h"
 #include <fstream>
 #include <algorithm>
 #include "Log.h"
@@ -11,6 +12,9 @@
 auto array_deleter = [](unsigned char* p) { delete[] p; };
 auto nop_deleter = [](unsigned char* /*p*/) { };
 
+// Below this size, reading is cheaper than setting up a mapping
+#define MAPPED_FILE_MIN_SIZE	(64 * 1024)
+
 std::shared_ptr<ResourceManager> ResourceManager::sInstance = nullptr;
 
 ResourceManager::ResourceManager()
@@ -100,6 +104,13 @@ const ResourceData ResourceManager::getFileData(const std::string& path) const
 	const std::string respath = getResourcePath(path);
 
 	auto size = Utils::FileSystem::getFileSize(respath);
+	if (size >= MAPPED_FILE_MIN_SIZE)
+	{
+		ResourceData data = mapFile(respath);
+		if (data.ptr != nullptr)
+			return data;
+	}
+
 	if (size > 0)
 	{
 		ResourceData data = loadFile(respath, size);
@@ -135,6 +146,22 @@ ResourceData ResourceManager::loadFile(const std::string& path, size_t size) con
 	return ret;
 }
 
+ResourceData ResourceManager::mapFile(const std::string& path) const
+{
+	std::shared_ptr<Utils::MemoryMappedFile> file = std::make_shared<Utils::MemoryMappedFile>(path);
+	if (!file->isOpen())
+	{
+		ResourceData ret = { NULL, 0 };
+		return ret;
+	}
+
+	// The deleter owns the mapping : decoders & FreeType read straight from the page cache
+	std::shared_ptr<unsigned char> data((unsigned char*)file->data(), [file](unsigned char* /*p*/) { });
+
+	ResourceData ret = { data, file->size() };
+	return ret;
+}
+
 bool ResourceManager::fileExists(const std::string& path) const
 {
 	// Animated Gifs : Check if the extension contains a ',' -> If it's the case, we have the multi-image index as argument
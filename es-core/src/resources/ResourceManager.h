@@ -11,6 +11,7 @@
 //Allow loading resources embedded into the executable like an actual file.
 //Allow embedded resources to be optionally remapped to actual files for further customization.
 
+// Files of 64 KB or more are memory mapped : ptr is read-only, and keeps the mapping alive
 struct ResourceData
 {
 	const std::shared_ptr<unsigned char> ptr;
@@ -49,6 +50,7 @@ private:
 	static std::shared_ptr<ResourceManager> sInstance;
 
 	ResourceData loadFile(const std::string& path, size_t size) const;
+	ResourceData mapFile(const std::string& path) const;
 
 	class ReloadableInfo
 	{
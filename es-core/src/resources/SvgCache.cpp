@@ -0,0 +1,154 @@
+#include "resources/SvgCache.h"
+
+#include "resources/TextureDiskCache.h"
+#include "ImageIO.h"
+#include "Log.h"
+#include <nanosvg/nanosvg.h>
+#include <nanosvg/nanosvgrast.h>
+#include <string.h>
+
+std::mutex SvgCache::sMutex;
+std::map<std::string, std::shared_ptr<NSVGimage>> SvgCache::sImages;
+std::list<std::string> SvgCache::sImageOrder;
+std::list<SvgCache::Bitmap> SvgCache::sBitmaps;
+size_t SvgCache::sBitmapBytes = 0;
+
+std::string SvgCache::getKey(const std::string& path, const unsigned char* fileData, size_t length)
+{
+	return path + "|" + std::to_string(length) + "|" + std::to_string(std::hash<std::string>()(std::string((const char*)fileData, length)));
+}
+
+std::shared_ptr<NSVGimage> SvgCache::parse(const std::string& key, const unsigned char* fileData, size_t length, float dpi)
+{
+	{
+		std::unique_lock<std::mutex> lock(sMutex);
+
+		auto it = sImages.find(key);
+		if (it != sImages.cend())
+		{
+			sImageOrder.remove(key);
+			sImageOrder.push_front(key);
+			return it->second;
+		}
+	}
+
+	// nsvgParse excepts a modifiable, null-terminated string
+	char* copy = (char*)malloc(length + 1);
+	if (copy == NULL)
+		return nullptr;
+
+	memcpy(copy, fileData, length);
+	copy[length] = '\0';
+
+	NSVGimage* svgImage = nsvgParse(copy, "px", dpi);
+	free(copy);
+
+	if (svgImage == nullptr)
+		return nullptr;
+
+	std::shared_ptr<NSVGimage> image(svgImage, nsvgDelete);
+
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	// Another thread may have parsed it meanwhile
+	auto it = sImages.find(key);
+	if (it != sImages.cend())
+		return it->second;
+
+	sImages[key] = image;
+	sImageOrder.push_front(key);
+
+	while (sImageOrder.size() > MAX_IMAGES)
+	{
+		sImages.erase(sImageOrder.back());
+		sImageOrder.pop_back();
+	}
+
+	return image;
+}
+
+PixelBuffer SvgCache::rasterize(const std::string& key, const std::string& path, const std::shared_ptr<NSVGimage>& image, size_t width, size_t height, double scale)
+{
+	size_t bytes = width * height * 4;
+	std::string bitmapKey = key + "|" + std::to_string(width) + "x" + std::to_string(height);
+
+	{
+		std::unique_lock<std::mutex> lock(sMutex);
+
+		for (auto it = sBitmaps.begin(); it != sBitmaps.end(); ++it)
+		{
+			if (it->key != bitmapKey)
+				continue;
+
+			PixelBuffer dataRGBA(PixelBufferPool::allocate(bytes));
+			memcpy(dataRGBA.get(), it->data.get(), bytes);
+			sBitmaps.splice(sBitmaps.begin(), sBitmaps, it);
+			return dataRGBA;
+		}
+	}
+
+	bool persist = TextureDiskCache::isEnabled() && !path.empty() && path[0] != ':';
+	std::string variant = "svg" + std::to_string(width) + "x" + std::to_string(height);
+
+	PixelBuffer dataRGBA;
+
+	TextureDiskCache::Image cached;
+	cached.rgba = nullptr;
+
+	if (persist && TextureDiskCache::loadVariant(path, variant, cached) && cached.width == width && cached.height == height)
+	{
+		// The loaded buffer is handed over as is
+		dataRGBA = std::move(cached.buffer);
+		persist = false;
+	}
+	else
+	{
+		dataRGBA.reset(PixelBufferPool::allocate(bytes));
+
+		NSVGrasterizer* rast = nsvgCreateRasterizer();
+		nsvgRasterize(rast, image.get(), 0, 0, scale, dataRGBA.get(), (int)width, (int)height, (int)width * 4);
+		nsvgDeleteRasterizer(rast);
+
+		ImageIO::flipPixelsVert(dataRGBA.get(), width, height);
+	}
+
+	if (persist)
+	{
+		TextureDiskCache::Image entry;
+		entry.rgba = dataRGBA.get();
+		entry.width = width;
+		entry.height = height;
+		entry.baseSize = Vector2i(width, height);
+		entry.packedSize = Vector2i(0, 0);
+		TextureDiskCache::saveVariant(path, variant, entry);
+	}
+
+	if (bytes > MAX_BITMAP_BYTES / 4)
+		return dataRGBA;
+
+	std::shared_ptr<unsigned char> copy(new unsigned char[bytes], std::default_delete<unsigned char[]>());
+	memcpy(copy.get(), dataRGBA.get(), bytes);
+
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	sBitmaps.push_front(Bitmap{ bitmapKey, copy, bytes });
+	sBitmapBytes += bytes;
+
+	while (sBitmapBytes > MAX_BITMAP_BYTES && !sBitmaps.empty())
+	{
+		sBitmapBytes -= sBitmaps.back().bytes;
+		sBitmaps.pop_back();
+	}
+
+	return dataRGBA;
+}
+
+void SvgCache::clear()
+{
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	sImages.clear();
+	sImageOrder.clear();
+	sBitmaps.clear();
+	sBitmapBytes = 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_SVG_CACHE_H
+#define ES_CORE_RESOURCES_SVG_CACHE_H
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "resources/PixelBuffer.h"
+
+struct NSVGimage;
+
+// Parsed SVG documents per file content, and an LRU of their rasterized bitmaps per pixel size, so that
+// reloading a texture after an eviction, a theme reload or a game does not parse & rasterize it again.
+// Bitmaps of files are also persisted by the TextureDiskCache when it is enabled
+class SvgCache
+{
+public:
+	static const size_t MAX_IMAGES = 128;
+	static const size_t MAX_BITMAP_BYTES = 16 * 1024 * 1024;
+
+	// Identifies the document : path, size & content hash
+	static std::string getKey(const std::string& path, const unsigned char* fileData, size_t length);
+
+	static std::shared_ptr<NSVGimage> parse(const std::string& key, const unsigned char* fileData, size_t length, float dpi);
+
+	// Returns width x height RGBA pixels, flipped for upload
+	static PixelBuffer rasterize(const std::string& key, const std::string& path, const std::shared_ptr<NSVGimage>& image, size_t width, size_t height, double scale);
+
+	static void clear();
+
+private:
+	struct Bitmap
+	{
+		std::string				key;
+		std::shared_ptr<unsigned char> data;
+		size_t					bytes;
+	};
+
+	static std::mutex											sMutex;
+	static std::map<std::string, std::shared_ptr<NSVGimage>>	sImages;
+	static std::list<std::string>								sImageOrder;	// Most recently used first
+	static std::list<Bitmap>									sBitmaps;		// Most recently used first
+	static size_t												sBitmapBytes;
+};
+
+#endif // ES_CORE_RESOURCES_SVG_CACHE_H
@@ -0,0 +1,170 @@
+#include "resources/TextureAtlas.h"
+
+#include "renderers/Renderer.h"
+#include "Settings.h"
+#include "Log.h"
+
+#include <cstring>
+#include <algorithm>
+
+#define ATLAS_PADDING 1
+
+std::mutex TextureAtlas::sMutex;
+std::vector<TextureAtlas::Page> TextureAtlas::sPages;
+
+bool TextureAtlas::isEnabled()
+{
+	return Settings::getInstance()->getBool("TextureAtlas");
+}
+
+bool TextureAtlas::fits(size_t width, size_t height)
+{
+	return width > 0 && height > 0 && width <= MAX_TEXTURE_SIZE && height <= MAX_TEXTURE_SIZE;
+}
+
+bool TextureAtlas::allocate(Page& page, int width, int height, int& x, int& y)
+{
+	// Best fitting shelf, not more than 50% taller than the region
+	Shelf* best = nullptr;
+
+	for (auto& shelf : page.shelves)
+	{
+		if (shelf.height < height || shelf.height > height + height / 2 || shelf.x + width > PAGE_SIZE)
+			continue;
+
+		if (best == nullptr || shelf.height < best->height)
+			best = &shelf;
+	}
+
+	if (best == nullptr)
+	{
+		if (page.nextY + height > PAGE_SIZE)
+			return false;
+
+		page.shelves.push_back(Shelf{ page.nextY, height, 0 });
+		page.nextY += height;
+		best = &page.shelves.back();
+	}
+
+	x = best->x;
+	y = best->y;
+	best->x += width;
+	return true;
+}
+
+bool TextureAtlas::add(const unsigned char* dataRGBA, size_t width, size_t height, bool linear, Region& region)
+{
+	if (dataRGBA == nullptr || !fits(width, height))
+		return false;
+
+	int cellWidth = (int)width + 2 * ATLAS_PADDING;
+	int cellHeight = (int)height + 2 * ATLAS_PADDING;
+
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	int index = -1;
+	int x = 0;
+	int y = 0;
+
+	for (int i = 0; i < (int)sPages.size() && index < 0; i++)
+		if (sPages[i].textureId != 0 && sPages[i].linear == linear && allocate(sPages[i], cellWidth, cellHeight, x, y))
+			index = i;
+
+	if (index < 0)
+	{
+		unsigned int textureId = Renderer::createTexture(Renderer::Texture::RGBA, linear, false, PAGE_SIZE, PAGE_SIZE, nullptr);
+		if (textureId == 0)
+			return false;
+
+		Page page;
+		page.textureId = textureId;
+		page.linear = linear;
+		page.regions = 0;
+		page.nextY = 0;
+
+		// Reuse the slot of a destroyed page, so that region indices stay valid
+		for (int i = 0; i < (int)sPages.size() && index < 0; i++)
+			if (sPages[i].textureId == 0)
+				index = i;
+
+		if (index < 0)
+		{
+			index = (int)sPages.size();
+			sPages.push_back(page);
+		}
+		else
+			sPages[index] = page;
+
+		allocate(sPages[index], cellWidth, cellHeight, x, y);
+
+		LOG(LogDebug) << "TextureAtlas : new page " << index << (linear ? " (linear)" : " (nearest)");
+	}
+
+	Page& page = sPages[index];
+
+	// Copy the image with its edges repeated in the padding
+	unsigned char* cell = new unsigned char[cellWidth * cellHeight * 4];
+
+	for (int cy = 0; cy < cellHeight; cy++)
+	{
+		int sy = std::max(0, std::min((int)height - 1, cy - ATLAS_PADDING));
+
+		unsigned char* dst = cell + cy * cellWidth * 4;
+		const unsigned char* src = dataRGBA + sy * width * 4;
+
+		memcpy(dst, src, ATLAS_PADDING * 4);
+		memcpy(dst + ATLAS_PADDING * 4, src, width * 4);
+		memcpy(dst + (ATLAS_PADDING + width) * 4, src + (width - 1) * 4, ATLAS_PADDING * 4);
+	}
+
+	Renderer::updateTexture(page.textureId, Renderer::Texture::RGBA, x, y, cellWidth, cellHeight, cell);
+	delete[] cell;
+
+	// updateTexture leaves another texture bound
+	Renderer::bindTexture(0);
+
+	page.regions++;
+
+	region.textureId = page.textureId;
+	region.page = index;
+	region.uv = Vector4f(
+		(float)(x + ATLAS_PADDING) / (float)PAGE_SIZE,
+		(float)(y + ATLAS_PADDING) / (float)PAGE_SIZE,
+		(float)width / (float)PAGE_SIZE,
+		(float)height / (float)PAGE_SIZE);
+
+	return true;
+}
+
+void TextureAtlas::remove(Region& region)
+{
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	if (region.page >= 0 && region.page < (int)sPages.size())
+	{
+		Page& page = sPages[region.page];
+		if (page.textureId == region.textureId && --page.regions <= 0)
+		{
+			Renderer::destroyTexture(page.textureId);
+
+			page.textureId = 0;
+			page.regions = 0;
+			page.nextY = 0;
+			page.shelves.clear();
+		}
+	}
+
+	region = Region();
+}
+
+size_t TextureAtlas::getTotalMemUsage()
+{
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	size_t total = 0;
+	for (auto& page : sPages)
+		if (page.textureId != 0)
+			total += PAGE_SIZE * PAGE_SIZE * 4;
+
+	return total;
+}
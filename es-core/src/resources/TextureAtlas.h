@@ -0,0 +1,59 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_TEXTURE_ATLAS_H
+#define ES_CORE_RESOURCES_TEXTURE_ATLAS_H
+
+#include "math/Vector4f.h"
+#include <mutex>
+#include <vector>
+
+// Shared VRAM pages for small textures ( help prompts, battery/network/controller icons, menu icons, option arrows... ).
+// Each region is surrounded by a 1 pixel border that repeats its edges, so that linear filtering never samples a neighbour.
+// Space is not reused when a region is removed : a page is destroyed once all its regions are gone. Enabled with the "TextureAtlas" setting.
+class TextureAtlas
+{
+public:
+	struct Region
+	{
+		Region() : textureId(0), page(-1) { }
+
+		unsigned int	textureId;
+		Vector4f		uv; // x, y, width, height in normalized page coordinates
+		int				page;
+	};
+
+	static const int PAGE_SIZE = 1024;
+	static const int MAX_TEXTURE_SIZE = 128;
+
+	static bool isEnabled();
+	static bool fits(size_t width, size_t height);
+
+	// Uploads the pixels to a page with the same filtering. Must be called from the render thread
+	static bool add(const unsigned char* dataRGBA, size_t width, size_t height, bool linear, Region& region);
+	static void remove(Region& region);
+
+	static size_t getTotalMemUsage();
+
+private:
+	struct Shelf
+	{
+		int y;
+		int height;
+		int x;
+	};
+
+	struct Page
+	{
+		unsigned int		textureId;
+		bool				linear;
+		int					regions;
+		int					nextY;
+		std::vector<Shelf>	shelves;
+	};
+
+	static bool allocate(Page& page, int width, int height, int& x, int& y);
+
+	static std::mutex			sMutex;
+	static std::vector<Page>	sPages;
+};
+
+#endif // ES_CORE_RESOURCES_TEXTURE_ATLAS_H
@@ -3,16 +3,21 @@
 #include "math/Misc.h"
 #include "renderers/Renderer.h"
 #include "resources/ResourceManager.h"
+#include "resources/TextureDiskCache.h"
+#include "resources/VideoPosterCache.h"
+#include "resources/SvgCache.h"
 #include "ImageIO.h"
 #include "Log.h"
+#include "Trace.h"
+#include "Profiler.h"
 #include <nanosvg/nanosvg.h>
-#include <nanosvg/nanosvgrast.h>
 #include <string.h>
 #include <algorithm>
 #include <vlc/vlc.h>
 
 #include "Settings.h"
-#include "utils/ZipFile.h"
+#include "MemoryProfile.h"
+#include "utils/ComicBook.h"
 #include "utils/StringUtil.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/StringListLock.h"
@@ -20,7 +25,7 @@
 
 #define DPI 96
 
-#define OPTIMIZEVRAM Settings::getInstance()->getBool("OptimizeVRAM")
+#define OPTIMIZEVRAM Settings::get(BoolSetting::OptimizeVRAM)
 
 IPdfHandler* TextureData::PdfHandler = nullptr;
 
@@ -29,7 +34,18 @@ TextureData::TextureData(bool tile, bool linear) : mTile(tile), mLinear(linear),
 									  mPackedSize(Vector2i(0, 0)), mBaseSize(Vector2i(0, 0))
 {
 	mIsExternalDataRGBA = false;
+	mIsYUV = false;
 	mRequired = false;
+	mReloadable = false;
+	mAtlasAllowed = true;
+
+	mLoadPriority = 0;
+	mQueued = false;
+	mLoading = false;
+
+	mPool = POOL_SYSTEMVIEW;
+	mLastFrame = 0;
+	mEvicted = false;
 }
 
 TextureData::~TextureData()
@@ -53,16 +69,10 @@ bool TextureData::initSVGFromMemory(const unsigned char* fileData, size_t length
 	if (mDataRGBA || (mTextureID != 0))
 		return true;
 
-	// nsvgParse excepts a modifiable, null-terminated string
-	char* copy = (char*)malloc(length + 1);
-	if (copy == NULL)
-		return false;
-	
-	memcpy(copy, fileData, length);
-	copy[length] = '\0';
+	// Parsed documents & bitmaps are cached : reloads after an eviction, a theme reload or a game are copies
+	std::string svgKey = SvgCache::getKey(mPath, fileData, length);
 
-	NSVGimage* svgImage = nsvgParse(copy, "px", DPI);
-	free(copy);
+	std::shared_ptr<NSVGimage> svgImage = SvgCache::parse(svgKey, fileData, length, DPI);
 	if (!svgImage)
 	{
 		LOG(LogError) << "Error parsing SVG image.";
@@ -135,21 +145,12 @@ bool TextureData::initSVGFromMemory(const unsigned char* fileData, size_t length
 		return false;
 	}
 
-	unsigned char* dataRGBA = new unsigned char[mWidth * mHeight * 4];
-
 	double scale = ((float)((int)mHeight)) / svgImage->height;
 	double scaleV = ((float)((int)mWidth)) / svgImage->width;
 	if (scaleV < scale)
 		scale = scaleV;
 
-	NSVGrasterizer* rast = nsvgCreateRasterizer();
-	nsvgRasterize(rast, svgImage, 0, 0, scale, dataRGBA, (int)mWidth, (int)mHeight, (int)mWidth * 4);
-	nsvgDeleteRasterizer(rast);
-	nsvgDelete(svgImage);
-
-	ImageIO::flipPixelsVert(dataRGBA, mWidth, mHeight);
-
-	mDataRGBA = dataRGBA;
+	mDataRGBA = SvgCache::rasterize(svgKey, mPath, svgImage, mWidth, mHeight, scale).release();
 
 	return true;
 }
@@ -165,11 +166,9 @@ bool TextureData::initImageFromMemory(const unsigned char* fileData, size_t leng
 			return true;
 	}
 
-	MaxSizeInfo maxSize(Renderer::getScreenWidth(), Renderer::getScreenHeight(), false);
-	if (!mMaxSize.empty())
-		maxSize = mMaxSize;
+	MaxSizeInfo maxSize = getDecodeMaxSize();
 	
-	unsigned char* imageRGBA = nullptr;
+	PixelBuffer imageRGBA;
 	
 	if (subImageIndex >= 0)
 		imageRGBA = ImageIO::loadFromMemoryRGBA32((const unsigned char*)(fileData), length, width, height, &maxSize, &mBaseSize, &mPackedSize, subImageIndex);
@@ -186,52 +185,210 @@ bool TextureData::initImageFromMemory(const unsigned char* fileData, size_t leng
 	mSourceHeight = (float) height;
 	mScalable = false;
 
-	return initFromRGBA(imageRGBA, width, height, false);
+	return initFromRGBA(std::move(imageRGBA), width, height);
 }
 
-bool TextureData::initFromRGBA(unsigned char* dataRGBA, size_t width, size_t height, bool copyData)
+MaxSizeInfo TextureData::getDecodeMaxSize()
+{
+	if (!mMaxSize.empty())
+		return mMaxSize;
+
+	return MaxSizeInfo(Renderer::getScreenWidth(), Renderer::getScreenHeight(), false);
+}
+
+int TextureData::getPyramidLevel(const std::string& path)
+{
+	unsigned int width, height;
+	if (!ImageIO::loadImageSize(path, &width, &height))
+		return 0;
+
+	return TextureDiskCache::getPyramidLevel(Vector2i(width, height), getDecodeMaxSize());
+}
+
+bool TextureData::loadFromDiskCache(const std::string& path, int pyramidLevel)
+{
+	if (isLoaded())
+		return true;
+
+	TextureDiskCache::Image image;
+	if (pyramidLevel > 0 ? !TextureDiskCache::loadLevel(path, pyramidLevel, image) : !TextureDiskCache::load(path, getDecodeMaxSize(), image))
+		return false;
+
+	mBaseSize = image.baseSize;
+	mPackedSize = image.packedSize;
+	mSourceWidth = (float)image.width;
+	mSourceHeight = (float)image.height;
+	mScalable = false;
+
+	return initFromRGBA(std::move(image.buffer), image.width, image.height);
+}
+
+bool TextureData::initPyramidFromMemory(const std::string& path, const unsigned char* fileData, size_t length, int pyramidLevel)
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (mDataRGBA || (mTextureID != 0))
+			return true;
+	}
+
+	size_t width, height;
+	Vector2i baseSize, packedSize;
+
+	PixelBuffer imageRGBA = ImageIO::loadFromMemoryRGBA32(fileData, length, width, height, nullptr, &baseSize, &packedSize);
+	if (imageRGBA == nullptr)
+	{
+		LOG(LogError) << "Could not initialize texture from memory, invalid data!  (file path: " << mPath << ", data ptr: " << (size_t)fileData << ", reported size: " << length << ")";
+		return false;
+	}
+
+	// Each level is reduced from the previous one. The requested level, and the smaller ones, are stored
+	PixelBuffer texture;
+	size_t textureWidth = 0;
+	size_t textureHeight = 0;
+	bool isTexture = false; // imageRGBA is the requested level, still needed for the next ones
+
+	for (int level = 1; level <= TextureDiskCache::PYRAMID_LEVELS; level++)
+	{
+		if (level > pyramidLevel && (width / 2 < TextureDiskCache::PYRAMID_MIN_SIZE || height / 2 < TextureDiskCache::PYRAMID_MIN_SIZE))
+			break;
+
+		size_t levelWidth, levelHeight;
+		PixelBuffer levelRGBA = ImageIO::halveRGBA32(imageRGBA.get(), width, height, levelWidth, levelHeight);
+
+		// The other levels go back to the pool
+		if (isTexture)
+		{
+			texture = std::move(imageRGBA);
+			isTexture = false;
+		}
+
+		imageRGBA = std::move(levelRGBA);
+		width = levelWidth;
+		height = levelHeight;
+
+		if (level < pyramidLevel)
+			continue;
+
+		TextureDiskCache::Image image;
+		image.rgba = imageRGBA.get();
+		image.width = width;
+		image.height = height;
+		image.baseSize = baseSize;
+		image.packedSize = Vector2i((int)width, (int)height);
+		TextureDiskCache::saveLevel(path, level, image);
+
+		if (level == pyramidLevel)
+		{
+			isTexture = true;
+			textureWidth = width;
+			textureHeight = height;
+		}
+	}
+
+	if (isTexture)
+		texture = std::move(imageRGBA);
+
+	if (texture == nullptr)
+		return false;
+
+	mBaseSize = baseSize;
+	mPackedSize = Vector2i((int)textureWidth, (int)textureHeight);
+	mSourceWidth = (float)textureWidth;
+	mSourceHeight = (float)textureHeight;
+	mScalable = false;
+
+	return initFromRGBA(std::move(texture), textureWidth, textureHeight);
+}
+
+void TextureData::saveToDiskCache(const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	if (mDataRGBA == nullptr)
+		return;
+
+	TextureDiskCache::Image image;
+	image.rgba = mDataRGBA;
+	image.width = mWidth;
+	image.height = mHeight;
+	image.baseSize = mBaseSize;
+	image.packedSize = mPackedSize;
+
+	TextureDiskCache::save(path, getDecodeMaxSize(), image);
+}
+
+bool TextureData::initFromRGBA(PixelBuffer dataRGBA, size_t width, size_t height)
 {
-	// If already initialised then don't read again
 	std::unique_lock<std::mutex> lock(mMutex);
 
 	if (mIsExternalDataRGBA)
 	{
 		mIsExternalDataRGBA = false;
+		mIsYUV = false;
 		mDataRGBA = nullptr;
 	}
 
+	// If already initialised then don't read again, the buffer goes back to the pool
 	if (mDataRGBA)
 		return true;
 
-	if (copyData)
-	{
-		// Take a copy
-		mDataRGBA = new unsigned char[width * height * 4];
-		memcpy(mDataRGBA, dataRGBA, width * height * 4);
-	}
-	else
-		mDataRGBA = dataRGBA;
-
+	mDataRGBA = dataRGBA.release();
 	mWidth = width;
 	mHeight = height;
 	return true;
 }
 
+bool TextureData::initFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height)
+{
+	// Take a copy
+	PixelBuffer copy(PixelBufferPool::allocate(width * height * 4));
+	memcpy(copy.get(), dataRGBA, width * height * 4);
+
+	return initFromRGBA(std::move(copy), width, height);
+}
+
 bool TextureData::updateFromExternalRGBA(unsigned char* dataRGBA, size_t width, size_t height)
+{
+	return updateFromExternalData(dataRGBA, width, height, false);
+}
+
+bool TextureData::updateFromExternalYUV(unsigned char* dataYUV, size_t width, size_t height)
+{
+	return updateFromExternalData(dataYUV, width, height, true);
+}
+
+bool TextureData::updateFromExternalData(unsigned char* data, size_t width, size_t height, bool yuv)
 {
 	// If already initialised then don't read again
 	std::unique_lock<std::mutex> lock(mMutex);
 
 	if (!mIsExternalDataRGBA && mDataRGBA != nullptr)
-		delete[] mDataRGBA;
+		PixelBufferPool::release(mDataRGBA);
+
+	// The texture has planes or not, it can't change format
+	if (mTextureID != 0 && mAtlasRegion.textureId == 0 && (mIsYUV != yuv || mWidth != width || mHeight != height))
+	{
+		Renderer::destroyTexture(mTextureID);
+		mTextureID = 0;
+	}
 
 	mIsExternalDataRGBA = true;
-	mDataRGBA = dataRGBA;
+	mIsYUV = yuv;
+	mDataRGBA = data;
 	mWidth = width;
 	mHeight = height;
+	mAtlasAllowed = false;
+
+	if (mAtlasRegion.textureId != 0)
+	{
+		TextureAtlas::remove(mAtlasRegion);
+		mTextureID = 0;
+	}
 
 	if (mTextureID != 0)
-		Renderer::updateTexture(mTextureID, Renderer::Texture::RGBA, 0, 0, mWidth, mHeight, mDataRGBA);
+	{
+		ProfileScope scope("Texture uploads", Profiler::RENDER);
+		Renderer::updateTexture(mTextureID, mIsYUV ? Renderer::Texture::YUV : Renderer::Texture::RGBA, 0, 0, mWidth, mHeight, mDataRGBA);
+	}
 
 	return true;
 }
@@ -245,6 +402,22 @@ extern void _checkUpgradedVlcVersion();
 
 bool TextureData::loadFromVideo()
 {
+	// Already extracted by the background job, no VLC instance needed
+	if (VideoPosterCache::isEnabled())
+	{
+		TextureDiskCache::Image image;
+		if (VideoPosterCache::loadPoster(mPath, image))
+		{
+			mBaseSize = image.baseSize;
+			mPackedSize = image.packedSize;
+			mSourceWidth = (float)image.width;
+			mSourceHeight = (float)image.height;
+			mScalable = false;
+
+			return initFromRGBA(std::move(image.buffer), image.width, image.height);
+		}
+	}
+
 	Utils::StringListLock lock(mImageExtractorLock, mPath);
 
 	auto val = Utils::FileSystem::createRelativePath(Utils::FileSystem::changeExtension(mPath, ".jpg"), Paths::getHomePath(), true);
@@ -379,44 +552,14 @@ bool TextureData::loadFromCbz()
 
 	Utils::StringListLock lock(mImageExtractorLock, mPath);
 
-	std::vector<Utils::Zip::ZipInfo> files;
-
-	Utils::Zip::ZipFile zipFile;
-	if (zipFile.load(mPath))
-	{
-		for (auto file : zipFile.infolist())
-		{
-			auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(file.filename));
-			if (ext != ".jpg")
-				continue;
-
-			if (Utils::String::startsWith(file.filename, "__"))
-				continue;
-
-			files.push_back(file);
-		}
-
-		std::sort(files.begin(), files.end(), [](const Utils::Zip::ZipInfo& a, const Utils::Zip::ZipInfo& b) { return Utils::String::toLower(a.filename) < Utils::String::toLower(b.filename); });
-	}
+	auto book = Utils::Zip::ComicBook::open(mPath);
+	if (book == nullptr)
+		return false;
 
-	if (files.size() > 0 && files[0].file_size > 0)
+	auto page = book->readPage(0);
+	if (page != nullptr && page->size() > 0)
 	{
-		size_t size = files[0].file_size;
-		unsigned char* buffer = new unsigned char[size];
-
-		Utils::Zip::zip_callback func = [](void *pOpaque, unsigned long long ofs, const void *pBuf, size_t n)
-		{
-			unsigned char* pSource = (unsigned char*)pBuf;
-			unsigned char* pDest = (unsigned char*)pOpaque;
-
-			memcpy(pDest + ofs, pSource, n);
-
-			return n;
-		};
-
-		zipFile.readBuffered(files[0].filename, func, buffer);
-		
-		retval = initImageFromMemory(buffer, size);
+		retval = initImageFromMemory(page->data(), page->size());
 
 		if (retval)
 			ImageIO::updateImageCache(mPath, Utils::FileSystem::getFileSize(mPath), mBaseSize.x(), mBaseSize.y());
@@ -427,6 +570,8 @@ bool TextureData::loadFromCbz()
 
 bool TextureData::load(bool updateCache)
 {
+	TraceSpan span("TextureData::load", mPath);
+
 	bool retval = false;
 
 	// Need to load. See if there is a file
@@ -455,6 +600,19 @@ bool TextureData::load(bool updateCache)
 			path = mPath.substr(0, idx);			
 		}
 
+		// Scraped media can skip decoding, from the pixels stored by a previous load
+		// Large images are reduced through a pyramid of half sizes, shared by the different MaxSizeInfo they cover
+		bool diskCache = subImageIndex < 0 && TextureDiskCache::isEnabled() && TextureDiskCache::isCachable(path);
+		int pyramidLevel = diskCache ? getPyramidLevel(path) : 0;
+
+		if (diskCache && loadFromDiskCache(path, pyramidLevel))
+		{
+			if (updateCache)
+				ImageIO::updateImageCache(mPath, Utils::FileSystem::getFileSize(path), mBaseSize.x(), mBaseSize.y());
+
+			return true;
+		}
+
 		std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
 		const ResourceData& data = rm->getFileData(path);
 		// is it an SVG?
@@ -463,9 +621,16 @@ bool TextureData::load(bool updateCache)
 			mScalable = true;
 			retval = initSVGFromMemory((const unsigned char*)data.ptr.get(), data.length);
 		}
+		else if (pyramidLevel > 0)
+			retval = initPyramidFromMemory(path, (const unsigned char*)data.ptr.get(), data.length, pyramidLevel);
 		else
+		{
 			retval = initImageFromMemory((const unsigned char*)data.ptr.get(), data.length, subImageIndex);
 
+			if (retval && diskCache)
+				saveToDiskCache(path);
+		}
+
 		if (updateCache && retval)
 			ImageIO::updateImageCache(mPath, data.length, mBaseSize.x(), mBaseSize.y());
 	}
@@ -481,11 +646,32 @@ bool TextureData::isLoaded()
 	return false;
 }
 
-bool TextureData::uploadAndBind()
+bool TextureData::isUploadPending()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return mTextureID == 0 && mDataRGBA != nullptr;
+}
+
+bool TextureData::uploadAndBind(Vector4f* atlasRect)
 {
 	// See if it's already been uploaded
 	std::unique_lock<std::mutex> lock(mMutex);
 
+	if (atlasRect != nullptr)
+		*atlasRect = Vector4f(0, 0, 1, 1);
+	else
+		mAtlasAllowed = false;
+
+	if (mTextureID != 0 && mAtlasRegion.textureId != 0 && atlasRect == nullptr)
+	{
+		// Drawn by a component that expects its own texture : leave the atlas, the next get() reloads the image
+		TextureAtlas::remove(mAtlasRegion);
+		mTextureID = 0;
+
+		Renderer::bindTexture(0);
+		return false;
+	}
+
 	if (mTextureID != 0)
 		Renderer::bindTexture(mTextureID);
 	else
@@ -497,17 +683,32 @@ bool TextureData::uploadAndBind()
 			return false;
 		}
 
-		// Upload texture
-		mTextureID = Renderer::createTexture(Renderer::Texture::RGBA, mLinear, mTile, mWidth, mHeight, mDataRGBA);
-		if (mTextureID == 0)
-			return false;
+		ProfileScope scope("Texture uploads", Profiler::RENDER);
+
+		// Small images that can be reloaded share atlas pages
+		if (mAtlasAllowed && !mTile && mReloadable && !mIsExternalDataRGBA && TextureAtlas::fits(mWidth, mHeight) && TextureAtlas::isEnabled() &&
+			TextureAtlas::add(mDataRGBA, mWidth, mHeight, mLinear, mAtlasRegion))
+		{
+			mTextureID = mAtlasRegion.textureId;
+			Renderer::bindTexture(mTextureID);
+		}
+		else
+		{
+			// Upload texture
+			mTextureID = Renderer::createTexture(mIsYUV ? Renderer::Texture::YUV : Renderer::Texture::RGBA, mLinear, mTile, mWidth, mHeight, mDataRGBA);
+			if (mTextureID == 0)
+				return false;
+		}
 
 		if (mDataRGBA != nullptr && !mIsExternalDataRGBA)
-			delete[] mDataRGBA;
+			PixelBufferPool::release(mDataRGBA);
 
 		mDataRGBA = nullptr;
 	}
 
+	if (atlasRect != nullptr && mAtlasRegion.textureId != 0)
+		*atlasRect = mAtlasRegion.uv;
+
 	return true;
 }
 
@@ -516,7 +717,11 @@ void TextureData::releaseVRAM()
 	std::unique_lock<std::mutex> lock(mMutex);
 	if (mTextureID != 0)
 	{
-		Renderer::destroyTexture(mTextureID);
+		if (mAtlasRegion.textureId != 0)
+			TextureAtlas::remove(mAtlasRegion);
+		else
+			Renderer::destroyTexture(mTextureID);
+
 		mTextureID = 0;
 	}
 }
@@ -526,7 +731,7 @@ void TextureData::releaseRAM()
 	std::unique_lock<std::mutex> lock(mMutex);
 
 	if (mDataRGBA != nullptr && !mIsExternalDataRGBA)
-		delete[] mDataRGBA;
+		PixelBufferPool::release(mDataRGBA);
 
 	mDataRGBA = 0;
 }
@@ -587,16 +792,18 @@ void TextureData::setSourceSize(float width, float height)
 size_t TextureData::getVRAMUsage()
 {
 	if ((mTextureID != 0) || (mDataRGBA != nullptr))
-		return mWidth * mHeight * 4;
+		return mIsYUV ? mWidth * mHeight * 3 / 2 : mWidth * mHeight * 4;
 	else
 		return 0;
 }
 
 void TextureData::setMaxSize(MaxSizeInfo maxSize)
 {
-	if (!Settings::getInstance()->getBool("OptimizeVRAM"))
+	if (!Settings::get(BoolSetting::OptimizeVRAM))
 		return;
 
+	maxSize = MemoryProfile::getMaxSize(maxSize);
+
 	if (mSourceWidth == 0 || mSourceHeight == 0)
 		mMaxSize = maxSize;
 	else
@@ -2,12 +2,39 @@
 #ifndef ES_CORE_RESOURCES_TEXTURE_DATA_H
 #define ES_CORE_RESOURCES_TEXTURE_DATA_H
 
+#include <chrono>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 #include "ImageIO.h"
+#include "resources/PixelBuffer.h"
+#include "resources/TextureAtlas.h"
 
 class TextureResource;
+class TextureData;
+
+// Order of the TextureLoader queue : lowest priority value first, then the most recent request
+struct TextureQueueKey
+{
+	int				priority;
+	unsigned int	order;
+
+	inline bool operator<(const TextureQueueKey& other) const { return priority != other.priority ? priority < other.priority : order > other.order; }
+};
+
+typedef std::map<TextureQueueKey, std::shared_ptr<TextureData>> TextureQueue;
+
+// VRAM budget pools : a texture belongs to the pool that was active when it was last loaded
+enum TexturePool : int
+{
+	POOL_SYSTEMVIEW = 0,
+	POOL_GAMELIST = 1,
+	POOL_MENU = 2,
+	POOL_SCREENSAVER = 3,
+	POOL_COUNT = 4
+};
 
 class IPdfHandler
 {
@@ -18,6 +45,9 @@ public:
 
 class TextureData
 {
+	friend class TextureLoader;
+	friend class TextureDataManager;
+
 public:
 	static IPdfHandler* PdfHandler;
 
@@ -30,7 +60,10 @@ public:
 	void initFromPath(const std::string& path);
 	bool initSVGFromMemory(const unsigned char* fileData, size_t length);
 	bool initImageFromMemory(const unsigned char* fileData, size_t length, int subImageIndex = -1);
-	bool initFromRGBA(unsigned char* dataRGBA, size_t width, size_t height, bool copyData = true);
+	// Takes the decoded pixels over
+	bool initFromRGBA(PixelBuffer dataRGBA, size_t width, size_t height);
+	// Copies pixels the caller keeps
+	bool initFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height);
 
 	// Read the data into memory if necessary
 	bool load(bool updateCache = false);
@@ -39,10 +72,14 @@ public:
 	bool loadFromVideo();
 
 	bool isLoaded();
+	// Loaded in RAM, waiting for its first uploadAndBind
+	bool isUploadPending();
 
 	// Upload the texture to VRAM if necessary and bind. Returns true if bound ok or
-	// false if either not loaded
-	bool uploadAndBind();
+	// false if either not loaded.
+	// Callers that pass atlasRect accept a texture shared with others : it receives the normalized (x, y, w, h) of the image in the bound texture.
+	// Without it, the texture leaves the atlas for good and has to be reloaded
+	bool uploadAndBind(Vector4f* atlasRect = nullptr);
 
 	// Release the texture from VRAM
 	void releaseVRAM();
@@ -73,13 +110,35 @@ public:
 	inline const std::string& getPath() { return mPath; };
 
 	bool updateFromExternalRGBA(unsigned char* dataRGBA, size_t width, size_t height);
+	// I420 frame ( Renderer::Texture::YUV )
+	bool updateFromExternalYUV(unsigned char* dataYUV, size_t width, size_t height);
 
 	bool isRequired() { return mRequired; };
 	void setRequired(bool value) { mRequired = value; };
 
 private:
+	bool updateFromExternalData(unsigned char* data, size_t width, size_t height, bool yuv);
+
+	MaxSizeInfo getDecodeMaxSize();
+	int getPyramidLevel(const std::string& path);
+	bool loadFromDiskCache(const std::string& path, int pyramidLevel);
+	bool initPyramidFromMemory(const std::string& path, const unsigned char* fileData, size_t length, int pyramidLevel);
+	void saveToDiskCache(const std::string& path);
+
 	bool			mRequired;
 
+	// TextureLoader state, guarded by the loader lock. The handle gives O(1) cancellation
+	int				mLoadPriority;
+	bool			mQueued;
+	bool			mLoading;
+	TextureQueue::iterator mQueueHandle;
+	std::chrono::steady_clock::time_point mQueueTime;
+
+	// TextureDataManager budget state, only used from the render thread
+	TexturePool		mPool;
+	unsigned int	mLastFrame;	// Last frame the texture was bound. Textures bound in the previous frame are visible & pinned
+	bool			mEvicted;
+
 	std::mutex		mMutex;
 	bool			mTile;
 	bool			mLinear;
@@ -98,6 +157,10 @@ private:
 	Vector2i		mBaseSize;
 
 	bool			mIsExternalDataRGBA;
+	bool			mIsYUV;
+
+	bool			mAtlasAllowed;
+	TextureAtlas::Region mAtlasRegion;
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_DATA_H
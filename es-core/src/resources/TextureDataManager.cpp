@@ -3,10 +3,19 @@
 #include "resources/TextureData.h"
 #include "resources/TextureResource.h"
 #include "Settings.h"
+#include "MemoryProfile.h"
+#include "Window.h"
 #include "Log.h"
+#include "TaskScheduler.h"
 #include <algorithm>
+#include <string.h>
 
-TextureDataManager::TextureDataManager()
+#define RESTORE_VISIBLE_FRAMES		120
+#define RESTORE_VISIBLE_PRIORITY	-1000	// Before the priorities of the components ( the distance to the cursor )
+#define RESTORE_BACKGROUND_PRIORITY	1000
+
+TextureDataManager::TextureDataManager() : mViewPool(POOL_SYSTEMVIEW), mActivePool(POOL_SYSTEMVIEW), mFrame(1), mEvictions(0), mEvictedBytes(0), mReloads(0),
+	mFrameUploadBudget(0), mFrameUploadedBytes(0), mUploads(0), mUploadedBytes(0), mDeferredUploads(0), mBlankBinds(0)
 {
 	mLoader = new TextureLoader(this);
 }
@@ -76,6 +85,15 @@ void TextureDataManager::cancelAsync(const TextureResource* key)
 		mLoader->remove(*(*it).second);
 }
 
+void TextureDataManager::setLoadPriority(const TextureResource* key, int priority)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	auto it = mTextureLookup.find(key);
+	if (it != mTextureLookup.cend())
+		mLoader->setPriority(*(*it).second, priority);
+}
+
 std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key, TextureLoadMode enableLoading)
 {
 	std::unique_lock<std::mutex> lock(mMutex);
@@ -112,14 +130,43 @@ std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key,
 	return tex;
 }
 
-bool TextureDataManager::bind(const TextureResource* key)
+bool TextureDataManager::bind(const TextureResource* key, Vector4f* atlasRect)
 {
 	std::shared_ptr<TextureData> tex = get(key);
 	bool bound = false;
 	if (tex != nullptr)
-		bound = tex->uploadAndBind();
+	{
+		tex->mLastFrame = mFrame;
+
+		if (tex->isUploadPending())
+		{
+			// The first upload of a frame is always done, so that large textures are not postponed forever
+			if (mFrameUploadBudget != 0 && mFrameUploadedBytes != 0 && mFrameUploadedBytes >= mFrameUploadBudget && !tex->isRequired())
+			{
+				mDeferredUploads++;
+				mBlankBinds++;
+				Window::invalidate(); // Upload it next frame
+				getBlankTexture()->uploadAndBind(atlasRect);
+				return false;
+			}
+
+			bound = tex->uploadAndBind(atlasRect);
+			if (bound)
+			{
+				size_t bytes = tex->getVRAMUsage();
+				mFrameUploadedBytes += bytes;
+				mUploadedBytes += bytes;
+				mUploads++;
+			}
+		}
+		else
+			bound = tex->uploadAndBind(atlasRect);
+	}
 	if (!bound)
-		getBlankTexture()->uploadAndBind();
+	{
+		mBlankBinds++;
+		getBlankTexture()->uploadAndBind(atlasRect);
+	}
 	return bound;
 }
 
@@ -150,6 +197,16 @@ size_t TextureDataManager::getQueueSize()
 	return mLoader->getQueueSize();
 }
 
+size_t TextureDataManager::getQueueDepth()
+{
+	return mLoader->getQueueDepth();
+}
+
+TextureLoaderStats TextureDataManager::getLoaderStats()
+{
+	return mLoader->getStats();
+}
+
 bool compareTextures(const std::shared_ptr<TextureData>& first, const std::shared_ptr<TextureData>& second)
 {
 	bool isResource = first->getPath().rfind(":/") == 0;
@@ -160,6 +217,114 @@ bool compareTextures(const std::shared_ptr<TextureData>& first, const std::share
 	return (second->isRequired() && !first->isRequired());
 }
 
+bool TextureDataManager::isPinned(const std::shared_ptr<TextureData>& tex)
+{
+	return tex->isRequired() || tex->mLastFrame + 1 >= mFrame;
+}
+
+void TextureDataManager::evict(std::shared_ptr<TextureData>& tex, TexturePool pool, bool otherPools, size_t& size, size_t maxSize, std::unique_lock<std::mutex>& lock)
+{
+	// mTextures is sorted by last use : walk it from the least recently used
+	for (auto it = mTextures.crbegin(); it != mTextures.crend(); ++it)
+	{
+		if (size < maxSize)
+			break;
+
+		std::shared_ptr<TextureData> item = *it;
+		if (item == tex || isPinned(item))
+			continue;
+
+		bool inPool = (item->mPool == pool);
+		if (inPool == otherPools)
+			continue;
+
+		bool changed = false;
+
+		if (item->isLoaded())
+		{
+			LOG(LogDebug) << "Cleanup VRAM\tReleased : " << item->getPath().c_str() << " (" << getPoolName(item->mPool) << ")";
+
+			size_t bytes = item->getVRAMUsage();
+			size -= bytes;
+
+			item->releaseVRAM();
+			item->releaseRAM();
+
+			item->mEvicted = true;
+			mEvictions++;
+			mEvictedBytes += bytes;
+		}
+
+		// It may be already in the loader queue. In this case it wouldn't have been using
+		// any VRAM yet but it will be. Remove it from the loader queue
+		if (mLoader->remove(item))
+		{
+			LOG(LogDebug) << "Cleanup VRAM\tRemoved from queue : " << item->getPath().c_str();
+			changed = true;
+		}
+
+		if (changed)
+		{
+			lock.unlock();
+			size = TextureResource::getTotalMemUsage();
+			lock.lock();
+		}
+	}
+}
+
+void TextureDataManager::beginFrame(TexturePool activePool)
+{
+	mActivePool = activePool;
+	mFrame++;
+
+	mFrameUploadBudget = (size_t)std::max(0, Settings::getInstance()->getInt("TextureUploadBudget")) * 1024;
+	mFrameUploadedBytes = 0;
+}
+
+const char* TextureDataManager::getPoolName(TexturePool pool)
+{
+	switch (pool)
+	{
+	case POOL_SYSTEMVIEW: return "system";
+	case POOL_GAMELIST: return "gamelist";
+	case POOL_MENU: return "menu";
+	case POOL_SCREENSAVER: return "screensaver";
+	default: return "";
+	}
+}
+
+TextureBudgetStats TextureDataManager::getBudgetStats()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	TextureBudgetStats stats;
+	stats.budget = MemoryProfile::getTextureBudget();
+
+	for (int i = 0; i < POOL_COUNT; i++)
+		stats.poolSize[i] = 0;
+
+	for (auto& tex : mTextures)
+		if (tex->mPool >= 0 && tex->mPool < POOL_COUNT)
+			stats.poolSize[tex->mPool] += tex->getVRAMUsage();
+
+	stats.evictions = mEvictions;
+	stats.evictedBytes = mEvictedBytes;
+	stats.reloads = mReloads;
+
+	stats.uploads = mUploads;
+	stats.uploadedBytes = mUploadedBytes;
+	stats.deferredUploads = mDeferredUploads;
+
+	mEvictions = 0;
+	mEvictedBytes = 0;
+	mReloads = 0;
+	mUploads = 0;
+	mUploadedBytes = 0;
+	mDeferredUploads = 0;
+
+	return stats;
+}
+
 void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
 {
 	// See if it's already loaded
@@ -175,53 +340,28 @@ void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
 		block = true; // Reload instantly or other instances will fade again
 	}
 
+	if (tex->mEvicted)
+	{
+		tex->mEvicted = false;
+		mReloads++;
+	}
+
+	tex->mPool = mActivePool;
+
 	// Not loaded. Make sure there is room
 	size_t size = TextureResource::getTotalMemUsage();
-	size_t max_texture = (size_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
+	size_t max_texture = MemoryProfile::getTextureBudget();
 
 	if (size >= max_texture)
 	{
 		LOG(LogDebug) << "Cleanup VRAM\tCurrent VRAM : " << std::to_string(size / 1024.0 / 1024.0).c_str() << " MB";
 
 		std::unique_lock<std::mutex> lock(mMutex);
-		for (auto it = mTextures.crbegin(); it != mTextures.crend(); ++it)
-		{
-			if (size < max_texture)
-				break;
-
-			if ((*it) == tex)
-				continue;
-
-			if ((*it)->isRequired())
-				continue;
-
-			bool changed = false;
-
-			if ((*it)->isLoaded())
-			{
-				LOG(LogDebug) << "Cleanup VRAM\tReleased : " << (*it)->getPath().c_str();
-
-				size -= (*it)->getVRAMUsage();
+		evict(tex, mActivePool, true, size, max_texture, lock);
+		evict(tex, mActivePool, false, size, max_texture, lock);
 
-				(*it)->releaseVRAM();
-				(*it)->releaseRAM();
-			}
-
-			// It may be already in the loader queue. In this case it wouldn't have been using
-			// any VRAM yet but it will be. Remove it from the loader queue
-			if (mLoader->remove(*it))
-			{
-				LOG(LogDebug) << "Cleanup VRAM\tRemoved from queue : " << (*it)->getPath().c_str();
-				changed = true;
-			}
-			
-			if (changed)
-			{
-				lock.unlock();
-				size = TextureResource::getTotalMemUsage();
-				lock.lock();
-			}
-		}
+		if (size >= max_texture)
+			LOG(LogDebug) << "Cleanup VRAM\tOnly pinned textures left : " << std::to_string(size / 1024.0 / 1024.0).c_str() << " MB";
 	}
 
 	if (!block)
@@ -233,13 +373,12 @@ void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
 	}
 }
 
-TextureLoader::TextureLoader(TextureDataManager* mgr) : mManager(mgr), mExit(false)
+TextureLoader::TextureLoader(TextureDataManager* mgr) : mManager(mgr), mExit(false), mQueueOrder(0), mLoadedCount(0), mTotalWait(0), mMaxWait(0)
 {
-	int num_threads = std::thread::hardware_concurrency() / 2;
-	if (num_threads == 0)
-		num_threads = 1;
+	// Own threads for the priority ordered queue, sized & prioritized as the texture class of the TaskScheduler
+	int num_threads = TaskScheduler::getWorkerCount(TaskScheduler::TEXTURE_IO);
 
-	for (size_t i = 0; i < num_threads; i++)
+	for (int i = 0; i < num_threads; i++)
 		mThreads.push_back(std::thread(&TextureLoader::threadProc, this));
 }
 
@@ -258,6 +397,8 @@ TextureLoader::~TextureLoader()
 
 void TextureLoader::threadProc()
 {
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::TEXTURE_IO);
+
 	while (true)
 	{		
 		// Wait for an event to say there is something in the queue
@@ -269,14 +410,19 @@ void TextureLoader::threadProc()
 
 		if (!mTextureDataQ.empty())
 		{
-			std::shared_ptr<TextureData> textureData = mTextureDataQ.front();
-			mTextureDataQ.pop_front();
+			std::shared_ptr<TextureData> textureData = mTextureDataQ.begin()->second;
+			dequeue(textureData);
+
+			textureData->mLoading = true;
 
-			mProcessingTextureDataQ.push_back(textureData);
+			int wait = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - textureData->mQueueTime).count();
+			mTotalWait += wait;
+			mMaxWait = std::max(mMaxWait, wait);
+			mLoadedCount++;
 
 			lock.unlock();
 
-			if (textureData && !textureData->isLoaded())
+			if (!textureData->isLoaded())
 			{
 				//LOG(LogDebug) << "TextureLoader::Thread\tLoading " << textureData->getPath().c_str();
 				std::this_thread::yield();
@@ -284,11 +430,14 @@ void TextureLoader::threadProc()
 				textureData->load(true);
 				//mManager->onTextureLoaded(textureData);				
 
-				lock.lock();
-				mProcessingTextureDataQ.remove(textureData);			
-				lock.unlock();
+				// Let the main loop upload & display it
+				Window::invalidate();
 			}
 
+			lock.lock();
+			textureData->mLoading = false;
+			lock.unlock();
+
 			std::this_thread::yield();
 		}		
 	}
@@ -296,6 +445,31 @@ void TextureLoader::threadProc()
 
 bool TextureLoader::paused = false;
 
+void TextureLoader::enqueue(const std::shared_ptr<TextureData>& textureData)
+{
+	enqueue(textureData, textureData->mLoadPriority);
+}
+
+void TextureLoader::enqueue(const std::shared_ptr<TextureData>& textureData, int priority)
+{
+	TextureQueueKey key;
+	key.priority = priority;
+	key.order = ++mQueueOrder;
+
+	textureData->mQueueHandle = mTextureDataQ.insert(std::pair<TextureQueueKey, std::shared_ptr<TextureData>>(key, textureData)).first;
+	textureData->mQueued = true;
+}
+
+bool TextureLoader::dequeue(const std::shared_ptr<TextureData>& textureData)
+{
+	if (!textureData->mQueued)
+		return false;
+
+	mTextureDataQ.erase(textureData->mQueueHandle);
+	textureData->mQueued = false;
+	return true;
+}
+
 void TextureLoader::load(std::shared_ptr<TextureData> textureData)
 {
 //	if (paused)
@@ -308,32 +482,55 @@ void TextureLoader::load(std::shared_ptr<TextureData> textureData)
 		return;
 
 	// If is is currently loading, don't add again
-	if (std::find(mProcessingTextureDataQ.cbegin(), mProcessingTextureDataQ.cend(), textureData) != mProcessingTextureDataQ.cend())
+	if (textureData->mLoading)
+		return;
+
+	// Requeue it if it is already there : the newly requested textures load first, for the same priority
+	if (!dequeue(textureData))
+		textureData->mQueueTime = std::chrono::steady_clock::now();
+
+	enqueue(textureData);
+	mEvent.notify_one();
+}
+
+void TextureLoader::load(std::shared_ptr<TextureData> textureData, int priority)
+{
+	std::unique_lock<std::mutex> lock(mLoaderLock);
+
+	if (textureData->isLoaded() || textureData->mLoading)
 		return;
 
-	// Remove it from the queue if it is already there
-	auto tx = std::find(mTextureDataQ.cbegin(), mTextureDataQ.cend(), textureData);
-	if (tx != mTextureDataQ.cend())
-		mTextureDataQ.erase(tx);
+	if (!dequeue(textureData))
+		textureData->mQueueTime = std::chrono::steady_clock::now();
 
-	// Put it on the start of the queue as we want the newly requested textures to load first
-	mTextureDataQ.push_front(textureData);
+	enqueue(textureData, priority);
 	mEvent.notify_one();
 }
 
+bool TextureLoader::isPending(const std::shared_ptr<TextureData>& textureData)
+{
+	std::unique_lock<std::mutex> lock(mLoaderLock);
+	return textureData->mQueued || textureData->mLoading;
+}
+
 bool TextureLoader::remove(std::shared_ptr<TextureData> textureData)
 {
 	// Just remove it from the queue so we don't attempt to load it
 	std::unique_lock<std::mutex> lock(mLoaderLock);
+	return dequeue(textureData);
+}
 
-	auto tx = std::find(mTextureDataQ.cbegin(), mTextureDataQ.cend(), textureData);
-	if (tx != mTextureDataQ.cend())
-	{
-		mTextureDataQ.erase(tx);
-		return true;
-	}
+void TextureLoader::setPriority(std::shared_ptr<TextureData> textureData, int priority)
+{
+	std::unique_lock<std::mutex> lock(mLoaderLock);
 
-	return false;
+	if (textureData->mLoadPriority == priority)
+		return;
+
+	textureData->mLoadPriority = priority;
+
+	if (dequeue(textureData))
+		enqueue(textureData);
 }
 
 size_t TextureLoader::getQueueSize()
@@ -343,23 +540,96 @@ size_t TextureLoader::getQueueSize()
 	// Gets the amount of video memory that will be used once all textures in
 	// the queue are loaded
 	size_t mem = 0;
-	for (auto tex : mTextureDataQ)
-		mem += tex->width() * tex->height() * 4;
+	for (auto& tex : mTextureDataQ)
+		mem += tex.second->width() * tex.second->height() * 4;
 
 	return mem;
 }
 
+size_t TextureLoader::getQueueDepth()
+{
+	std::unique_lock<std::mutex> lock(mLoaderLock);
+	return mTextureDataQ.size();
+}
+
+TextureLoaderStats TextureLoader::getStats()
+{
+	std::unique_lock<std::mutex> lock(mLoaderLock);
+
+	TextureLoaderStats stats;
+	stats.queueDepth = mTextureDataQ.size();
+	stats.loaded = mLoadedCount;
+	stats.averageWait = mLoadedCount == 0 ? 0 : (int)(mTotalWait / (long long)mLoadedCount);
+	stats.maxWait = mMaxWait;
+
+	mLoadedCount = 0;
+	mTotalWait = 0;
+	mMaxWait = 0;
+
+	return stats;
+}
+
 void TextureLoader::clearQueue()
 {
 	std::unique_lock<std::mutex> lock(mLoaderLock);
 
 	// Just abort any waiting texture
+	for (auto& tex : mTextureDataQ)
+		tex.second->mQueued = false;
+
 	mTextureDataQ.clear();	
 }
 
+void TextureDataManager::markBound(const std::shared_ptr<TextureData>& tex)
+{
+	tex->mLastFrame = mFrame;
+}
+
+void TextureDataManager::restore(const std::shared_ptr<TextureData>& tex)
+{
+	if (tex->isLoaded())
+		return;
+
+	// The launch transition is drawn after the view : a few seconds of frames
+	bool visible = tex->isRequired() || tex->mLastFrame + RESTORE_VISIBLE_FRAMES >= mFrame;
+
+	mLoader->load(tex, visible ? RESTORE_VISIBLE_PRIORITY : RESTORE_BACKGROUND_PRIORITY);
+
+	if (visible)
+		mRestoring.push_back(tex);
+}
+
+void TextureDataManager::waitForRestore(int maxTimeMs)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	while (!mRestoring.empty())
+	{
+		// Loaded, or dropped from the queue
+		for (auto it = mRestoring.begin(); it != mRestoring.end(); )
+		{
+			if (!mLoader->isPending(*it))
+				it = mRestoring.erase(it);
+			else
+				it++;
+		}
+
+		if (mRestoring.empty() || std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() >= maxTimeMs)
+			break;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+
+	if (!mRestoring.empty())
+		LOG(LogDebug) << "TextureDataManager : " << mRestoring.size() << " visible textures still loading after " << maxTimeMs << "ms";
+
+	mRestoring.clear();
+}
+
 void TextureDataManager::clearQueue()
 {
 	mBlank = nullptr;
+	mRestoring.clear();
 
 	if (mLoader != nullptr)
 		mLoader->clearQueue();
@@ -372,16 +642,10 @@ std::shared_ptr<TextureData> TextureDataManager::getBlankTexture()
 		mBlank = std::make_shared<TextureData>(false, false);
 
 		int size = 8;
-		unsigned char* data = new unsigned char[size * size * 4];
-		for (int i = 0; i < size * size; ++i)
-		{
-			data[i * 4] = 0;
-			data[i * 4 + 1] = 0;
-			data[i * 4 + 2] = 0;
-			data[i * 4 + 3] = 0;
-		}
+		PixelBuffer data(PixelBufferPool::allocate(size * size * 4));
+		memset(data.get(), 0, size * size * 4);
 
-		mBlank->initFromRGBA(data, size, size);
+		mBlank->initFromRGBA(std::move(data), size, size);
 	}
 
 	return mBlank;
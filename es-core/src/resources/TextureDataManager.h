@@ -9,11 +9,32 @@
 #include <mutex>
 #include <thread>
 #include <vector>
+#include "resources/TextureData.h"
 
 class TextureDataManager;
-class TextureData;
 class TextureResource;
 
+struct TextureLoaderStats
+{
+	size_t	queueDepth;
+	size_t	loaded;			// Textures loaded since the previous call
+	int		averageWait;	// Time these textures have spent in the queue, in ms
+	int		maxWait;
+};
+
+struct TextureBudgetStats
+{
+	size_t	budget;					// MaxVRAM, in bytes
+	size_t	poolSize[POOL_COUNT];	// VRAM used by the textures of each pool
+	size_t	evictions;				// Textures released to stay within the budget since the previous call
+	size_t	evictedBytes;
+	size_t	reloads;				// Evicted textures that had to be loaded again since the previous call
+	size_t	uploads;				// Textures uploaded to VRAM since the previous call
+	size_t	uploadedBytes;
+	size_t	deferredUploads;		// Uploads postponed to the next frame, since the previous call
+};
+
+// Loads the textures in a priority queue : lowest priority value first ( on screen, close to the selected item ), then the most recent request
 class TextureLoader
 {
 public:
@@ -21,18 +42,35 @@ public:
 	~TextureLoader();
 
 	void load(std::shared_ptr<TextureData> textureData);
+	// Queued with its own priority, the texture keeps the one of its components
+	void load(std::shared_ptr<TextureData> textureData, int priority);
 	bool remove(std::shared_ptr<TextureData> textureData);
+	bool isPending(const std::shared_ptr<TextureData>& textureData); // queued or loading
+	void setPriority(std::shared_ptr<TextureData> textureData, int priority);
 	void clearQueue();
 
 	size_t getQueueSize();
+	size_t getQueueDepth(); // number of queued textures
+
+	// Resets the wait time counters
+	TextureLoaderStats getStats();
 
 	static bool paused;
 
 private:	
 	void threadProc();
 
-	std::list<std::shared_ptr<TextureData>> 										mProcessingTextureDataQ;
-	std::list<std::shared_ptr<TextureData>> 										mTextureDataQ;
+	// Both require mLoaderLock
+	void enqueue(const std::shared_ptr<TextureData>& textureData);
+	void enqueue(const std::shared_ptr<TextureData>& textureData, int priority);
+	bool dequeue(const std::shared_ptr<TextureData>& textureData);
+
+	TextureQueue				mTextureDataQ;
+	unsigned int				mQueueOrder;
+
+	size_t						mLoadedCount;
+	long long					mTotalWait;
+	int							mMaxWait;
 
 	std::vector<std::thread>	mThreads;
 	std::mutex					mLoaderLock;
@@ -57,6 +95,12 @@ private:
 // to releaseRAM() which frees the memory buffer if the texture can be reloaded from
 // disk if needed again
 //
+// VRAM is kept under the "MaxVRAM" budget : when a texture is loaded, the least recently used
+// textures of the other pools are released first, then those of the active pool. Required
+// textures and the textures bound during the last frame (the visible ones) are pinned.
+// Uploads are limited to "TextureUploadBudget" KB per frame : the textures over the budget
+// are drawn blank ( or fading ) and uploaded during the next frames
+//
 class TextureDataManager
 {
 public:
@@ -78,8 +122,11 @@ public:
 	void remove(const TextureResource* key);
 
 	void cancelAsync(const TextureResource* key);
+	void setLoadPriority(const TextureResource* key, int priority);
 	std::shared_ptr<TextureData> get(const TextureResource* key, TextureLoadMode enableLoading = TextureLoadMode::ENABLED);
-	bool bind(const TextureResource* key);
+	bool bind(const TextureResource* key, Vector4f* atlasRect = nullptr);
+	// Number of binds that fell back to the blank texture, the texture not being loaded or uploaded yet
+	size_t getBlankBinds() { return mBlankBinds; }
 
 	// Get the total size of all textures managed by this object, loaded and unloaded in bytes
 	size_t	getTotalSize();
@@ -88,22 +135,62 @@ public:
 	// Get the total size of all load-pending textures in the queue - these will
 	// be committed to VRAM as the queue is processed
 	size_t  getQueueSize();
+	size_t  getQueueDepth();
+	TextureLoaderStats getLoaderStats();
+	// Resets the eviction counters
+	TextureBudgetStats getBudgetStats();
+
+	// The pool of the current view, and the pool of the textures loaded from now on ( the view pool, menus or screensaver )
+	void setViewPool(TexturePool pool) { mViewPool = pool; }
+	TexturePool getViewPool() { return mViewPool; }
+	void beginFrame(TexturePool activePool);
+
 	// Load a texture, freeing resources as necessary to make space
 	void load(std::shared_ptr<TextureData> tex, bool block = false);
 
+	// Textures bound without the manager ( the ones that are not dynamic )
+	void markBound(const std::shared_ptr<TextureData>& tex);
+
+	// ResourceManager::reloadAll, after a game : the textures drawn just before the game are queued first, the others behind whatever the UI asks.
+	// waitForRestore blocks until the first ones are loaded, or for maxTimeMs
+	void restore(const std::shared_ptr<TextureData>& tex);
+	void waitForRestore(int maxTimeMs);
+
 	void clearQueue();
 
 	void onTextureLoaded(std::shared_ptr<TextureData> tex);
 
+	static const char* getPoolName(TexturePool pool);
+
 private:
 	std::shared_ptr<TextureData> getBlankTexture();
 
+	// Requires mMutex. Releases the textures of one pool ( or the other pools ), least recently used first
+	void evict(std::shared_ptr<TextureData>& tex, TexturePool pool, bool otherPools, size_t& size, size_t maxSize, std::unique_lock<std::mutex>& lock);
+	bool isPinned(const std::shared_ptr<TextureData>& tex);
+
 	std::mutex					mMutex;
 
 	std::list<std::shared_ptr<TextureData> >												mTextures;
 	std::map<const TextureResource*, std::list<std::shared_ptr<TextureData> >::const_iterator > 	mTextureLookup;
 	std::shared_ptr<TextureData>															mBlank;
+	std::vector<std::shared_ptr<TextureData>>												mRestoring;
 	TextureLoader*																			mLoader;
+
+	TexturePool		mViewPool;
+	TexturePool		mActivePool;
+	unsigned int	mFrame;
+
+	size_t			mEvictions;
+	size_t			mEvictedBytes;
+	size_t			mReloads;
+
+	size_t			mFrameUploadBudget;
+	size_t			mFrameUploadedBytes;
+	size_t			mUploads;
+	size_t			mUploadedBytes;
+	size_t			mDeferredUploads;
+	size_t			mBlankBinds;
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_DATA_MANAGER_H
@@ -0,0 +1,238 @@
+#include "resources/TextureDiskCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/BinaryStream.h"
+#include "utils/MemoryMappedFile.h"
+#include "renderers/Renderer.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <fstream>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+
+#define TEXTURE_CACHE_MAGIC		0x43585445 // 'ETXC'
+#define TEXTURE_CACHE_VERSION	"1"
+
+// Pixel formats. Opaque images are stored without their alpha channel
+#define TEXTURE_FORMAT_RGBA		0
+#define TEXTURE_FORMAT_RGB		1
+
+bool TextureDiskCache::isEnabled()
+{
+	return Settings::getInstance()->getBool("TextureDiskCache");
+}
+
+bool TextureDiskCache::isCachable(const std::string& path)
+{
+	// Embedded resources & theme assets are small and few, temporary files change
+	if (path.empty() || path[0] == ':')
+		return false;
+
+	if (path.find("/themes/") != std::string::npos || path.find("/tmp/") != std::string::npos || path.find("/emulationstation.tmp/") != std::string::npos || path.find("/pdftmp/") != std::string::npos)
+		return false;
+
+	auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(path));
+	return ext == ".png" || ext == ".jpg" || ext == ".jpeg";
+}
+
+std::string TextureDiskCache::getCacheFolder()
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/textures");
+}
+
+std::string TextureDiskCache::getKey(const std::string& path, const std::string& variant)
+{
+	std::string key = TEXTURE_CACHE_VERSION "|" + path;
+	key += "|" + std::to_string(Utils::FileSystem::getFileSize(path)) + "|" + std::to_string((long long)Utils::FileSystem::getFileModificationDate(path).getTime());
+	key += "|" + variant;
+	return key;
+}
+
+std::string TextureDiskCache::getVariant(MaxSizeInfo& maxSize)
+{
+	return std::to_string((int)maxSize.x()) + "x" + std::to_string((int)maxSize.y()) + (maxSize.externalZoom() ? "|zoom" : "|");
+}
+
+std::string TextureDiskCache::getCachePath(const std::string& key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.tex", (unsigned long long)std::hash<std::string>()(key));
+	return getCacheFolder() + "/" + name;
+}
+
+int TextureDiskCache::getPyramidLevel(const Vector2i& baseSize, MaxSizeInfo maxSize)
+{
+	if (baseSize.x() <= 0 || baseSize.y() <= 0 || maxSize.x() <= 0 || maxSize.y() <= 0)
+		return 0;
+
+	// Same reduction as ImageIO::loadFromMemoryRGBA32
+	Vector2i target = ImageIO::adjustPictureSize(baseSize, Vector2i(maxSize.x(), maxSize.y()), maxSize.externalZoom());
+	if (target.x() > Renderer::getScreenWidth() || target.y() > Renderer::getScreenHeight())
+		target = ImageIO::adjustPictureSize(target, Vector2i(Renderer::getScreenWidth(), Renderer::getScreenHeight()), false);
+
+	int level = 0;
+
+	int width = baseSize.x();
+	int height = baseSize.y();
+
+	while (level < PYRAMID_LEVELS)
+	{
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+
+		if (width < target.x() || height < target.y() || width < PYRAMID_MIN_SIZE || height < PYRAMID_MIN_SIZE)
+			break;
+
+		level++;
+	}
+
+	return level;
+}
+
+bool TextureDiskCache::load(const std::string& path, MaxSizeInfo maxSize, Image& image)
+{
+	return loadEntry(getKey(path, getVariant(maxSize)), image);
+}
+
+void TextureDiskCache::save(const std::string& path, MaxSizeInfo maxSize, const Image& image)
+{
+	saveEntry(getKey(path, getVariant(maxSize)), image);
+}
+
+bool TextureDiskCache::loadLevel(const std::string& path, int level, Image& image)
+{
+	return loadEntry(getKey(path, "level" + std::to_string(level)), image);
+}
+
+void TextureDiskCache::saveLevel(const std::string& path, int level, const Image& image)
+{
+	saveEntry(getKey(path, "level" + std::to_string(level)), image);
+}
+
+bool TextureDiskCache::loadVariant(const std::string& path, const std::string& variant, Image& image)
+{
+	return loadEntry(getKey(path, variant), image);
+}
+
+void TextureDiskCache::saveVariant(const std::string& path, const std::string& variant, const Image& image)
+{
+	saveEntry(getKey(path, variant), image);
+}
+
+bool TextureDiskCache::hasVariant(const std::string& path, const std::string& variant)
+{
+	return Utils::FileSystem::exists(getCachePath(getKey(path, variant)));
+}
+
+bool TextureDiskCache::loadEntry(const std::string& key, Image& image)
+{
+	Utils::MemoryMappedFile file(getCachePath(key));
+	if (!file.isOpen())
+		return false;
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (reader.readUInt32() != TEXTURE_CACHE_MAGIC || reader.readString() != key)
+		return false;
+
+	uint32_t width = reader.readUInt32();
+	uint32_t height = reader.readUInt32();
+	int baseX = (int)reader.readUInt32();
+	int baseY = (int)reader.readUInt32();
+	int packedX = (int)reader.readUInt32();
+	int packedY = (int)reader.readUInt32();
+	uint8_t format = reader.readUInt8();
+
+	if (reader.failed() || width == 0 || height == 0 || format > TEXTURE_FORMAT_RGB)
+		return false;
+
+	size_t pixels = (size_t)width * (size_t)height;
+
+	const unsigned char* src = reader.readRaw(pixels * (format == TEXTURE_FORMAT_RGB ? 3 : 4));
+	if (src == nullptr)
+	{
+		LOG(LogWarning) << "TextureDiskCache : invalid cache for " << key;
+		return false;
+	}
+
+	PixelBuffer rgba(PixelBufferPool::allocate(pixels * 4));
+
+	if (format == TEXTURE_FORMAT_RGBA)
+		memcpy(rgba.get(), src, pixels * 4);
+	else
+	{
+		unsigned char* dst = rgba.get();
+		for (size_t i = 0; i < pixels; i++, src += 3, dst += 4)
+		{
+			dst[0] = src[0];
+			dst[1] = src[1];
+			dst[2] = src[2];
+			dst[3] = 0xFF;
+		}
+	}
+
+	image.rgba = rgba.get();
+	image.buffer = std::move(rgba);
+	image.width = width;
+	image.height = height;
+	image.baseSize = Vector2i(baseX, baseY);
+	image.packedSize = Vector2i(packedX, packedY);
+	return true;
+}
+
+void TextureDiskCache::saveEntry(const std::string& key, const Image& image)
+{
+	if (image.rgba == nullptr || image.width == 0 || image.height == 0)
+		return;
+
+	std::string cachePath = getCachePath(key);
+
+	size_t pixels = image.width * image.height;
+
+	bool opaque = true;
+	for (size_t i = 0; i < pixels && opaque; i++)
+		opaque = image.rgba[i * 4 + 3] == 0xFF;
+
+	Utils::BinaryWriter writer;
+	writer.writeUInt32(TEXTURE_CACHE_MAGIC);
+	writer.writeString(key);
+	writer.writeUInt32((uint32_t)image.width);
+	writer.writeUInt32((uint32_t)image.height);
+	writer.writeUInt32((uint32_t)image.baseSize.x());
+	writer.writeUInt32((uint32_t)image.baseSize.y());
+	writer.writeUInt32((uint32_t)image.packedSize.x());
+	writer.writeUInt32((uint32_t)image.packedSize.y());
+	writer.writeUInt8(opaque ? TEXTURE_FORMAT_RGB : TEXTURE_FORMAT_RGBA);
+
+	if (opaque)
+	{
+		std::string rgb;
+		rgb.resize(pixels * 3);
+
+		const unsigned char* src = image.rgba;
+		char* dst = &rgb[0];
+		for (size_t i = 0; i < pixels; i++, src += 4, dst += 3)
+		{
+			dst[0] = (char)src[0];
+			dst[1] = (char)src[1];
+			dst[2] = (char)src[2];
+		}
+
+		writer.write(rgb.data(), rgb.size());
+	}
+	else
+		writer.write(image.rgba, pixels * 4);
+
+	// Several loader threads may write at once
+	Utils::FileSystem::writeFileAtomic(cachePath, writer, true);
+}
+
+void TextureDiskCache::clear()
+{
+	std::string folder = getCacheFolder();
+	if (Utils::FileSystem::exists(folder))
+		Utils::FileSystem::deleteDirectoryFiles(folder);
+}
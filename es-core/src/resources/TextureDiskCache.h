@@ -0,0 +1,58 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_TEXTURE_DISK_CACHE_H
+#define ES_CORE_RESOURCES_TEXTURE_DISK_CACHE_H
+
+#include "ImageIO.h"
+#include "math/Vector2i.h"
+#include "resources/PixelBuffer.h"
+#include <string>
+
+// Decoded & downscaled images, stored on disk so that the next loads skip the PNG/JPG decoding. Enabled with the "TextureDiskCache" setting.
+// Large images are stored as a pyramid of 1/2, 1/4 and 1/8 sizes, shared by every MaxSizeInfo they cover ( grid tiles, carousels... ).
+// Others are keyed by the MaxSizeInfo they were reduced to. Entries are also keyed by the source size & modification date
+class TextureDiskCache
+{
+public:
+	struct Image
+	{
+		const unsigned char* rgba;
+		PixelBuffer		buffer; // Owns rgba after a load, to be moved to the texture. Empty when saving borrowed pixels
+		size_t			width;
+		size_t			height;
+		Vector2i		baseSize;
+		Vector2i		packedSize;
+	};
+
+	static bool isEnabled();
+	static bool isCachable(const std::string& path);
+
+	static bool load(const std::string& path, MaxSizeInfo maxSize, Image& image);
+	static void save(const std::string& path, MaxSizeInfo maxSize, const Image& image);
+
+	static const int PYRAMID_LEVELS = 3;
+	static const int PYRAMID_MIN_SIZE = 32; // Smallest level size, in pixels
+
+	// Smallest level ( 1 to 3, size / 2^level ) that still covers the size the image is reduced to. 0 if the image is not large enough
+	static int getPyramidLevel(const Vector2i& baseSize, MaxSizeInfo maxSize);
+
+	static bool loadLevel(const std::string& path, int level, Image& image);
+	static void saveLevel(const std::string& path, int level, const Image& image);
+
+	// Entries of other producers ( rasterized SVGs... ), whatever isCachable says
+	static bool loadVariant(const std::string& path, const std::string& variant, Image& image);
+	static void saveVariant(const std::string& path, const std::string& variant, const Image& image);
+	static bool hasVariant(const std::string& path, const std::string& variant);
+
+	static void clear();
+
+private:
+	static std::string getCacheFolder();
+	static std::string getKey(const std::string& path, const std::string& variant);
+	static std::string getCachePath(const std::string& key);
+	static std::string getVariant(MaxSizeInfo& maxSize);
+
+	static bool loadEntry(const std::string& key, Image& image);
+	static void saveEntry(const std::string& key, const Image& image);
+};
+
+#endif // ES_CORE_RESOURCES_TEXTURE_DISK_CACHE_H
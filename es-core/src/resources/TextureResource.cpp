@@ -9,10 +9,16 @@
 #include "renderers/Renderer.h"
 
 TextureDataManager		TextureResource::sTextureDataManager;
-std::map< TextureResource::TextureKeyType, std::weak_ptr<TextureResource> > TextureResource::sTextureMap;
-std::set<TextureResource*> 	TextureResource::sAllTextures;
+std::unordered_map< TextureResource::TextureKeyType, std::weak_ptr<TextureResource>, TextureResource::TextureKeyHash > TextureResource::sTextureMap;
+std::unordered_map< uint64_t, std::weak_ptr<TextureResource> > TextureResource::sContentMap;
+TextureResource*		TextureResource::sFirstTexture = nullptr;
 
-TextureResource::TextureResource(const std::string& path, bool tile, bool linear, bool dynamic, bool allowAsync, MaxSizeInfo* maxSize) : mTextureData(nullptr), mForceLoad(false)
+TextureResource::TextureKeyType::TextureKeyType(const std::string& path, bool tile, bool linear) : path(path), tile(tile), linear(linear)
+{
+	hash = std::hash<std::string>()(path) ^ ((size_t)tile << 1) ^ ((size_t)linear << 2);
+}
+
+TextureResource::TextureResource(const std::string& path, bool tile, bool linear, bool dynamic, bool allowAsync, MaxSizeInfo* maxSize) : mTextureData(nullptr), mForceLoad(false), mPrevTexture(nullptr), mNextTexture(nullptr)
 {
 	// Create a texture data object for this texture
 	if (!path.empty())
@@ -35,7 +41,7 @@ TextureResource::TextureResource(const std::string& path, bool tile, bool linear
 
 			unsigned int width, height;
 
-			if (allowAsync && Settings::getInstance()->getBool("AsyncImages") && ImageIO::loadImageSize(fullpath.c_str(), &width, &height))
+			if (allowAsync && Settings::get(BoolSetting::AsyncImages) && ImageIO::loadImageSize(fullpath.c_str(), &width, &height))
 			{
 				data->setTemporarySize(width, height);
 				async = true;
@@ -75,8 +81,11 @@ TextureResource::TextureResource(const std::string& path, bool tile, bool linear
 		mTextureData = std::make_shared<TextureData>(tile, linear);
 	}
 
-	if (sAllTextures.find(this) == sAllTextures.end())
-		sAllTextures.insert(this);
+	mNextTexture = sFirstTexture;
+	if (sFirstTexture != nullptr)
+		sFirstTexture->mPrevTexture = this;
+
+	sFirstTexture = this;
 }
 
 TextureResource::~TextureResource()
@@ -86,12 +95,13 @@ TextureResource::~TextureResource()
 	if (mTextureData == nullptr)
 		sTextureDataManager.remove(this);
 
-	if (sAllTextures.size() > 0)
-	{
-		auto pthis = sAllTextures.find(this);
-		if (pthis != sAllTextures.end())
-			sAllTextures.erase(pthis);
-	}
+	if (mPrevTexture != nullptr)
+		mPrevTexture->mNextTexture = mNextTexture;
+	else if (sFirstTexture == this)
+		sFirstTexture = mNextTexture;
+
+	if (mNextTexture != nullptr)
+		mNextTexture->mPrevTexture = mPrevTexture;
 }
 
 void TextureResource::onTextureLoaded(std::shared_ptr<TextureData> tex)
@@ -111,6 +121,14 @@ void TextureResource::updateFromExternalPixels(unsigned char* dataRGBA, size_t w
 	mSourceSize = Vector2f(mTextureData->sourceWidth(), mTextureData->sourceHeight());
 }
 
+void TextureResource::updateFromExternalYUV(unsigned char* dataYUV, size_t width, size_t height)
+{
+	mTextureData->updateFromExternalYUV(dataYUV, width, height);
+
+	mSize = Vector2i((int)width, (int)height);
+	mSourceSize = Vector2f(mTextureData->sourceWidth(), mTextureData->sourceHeight());
+}
+
 void TextureResource::initFromPixels(unsigned char* dataRGBA, size_t width, size_t height)
 {
 	// This is only valid if we have a local texture data object
@@ -163,6 +181,21 @@ void TextureResource::prioritize() const
 		sTextureDataManager.get(this, TextureDataManager::TextureLoadMode::MOVETOTOPONLY);
 }
 
+void TextureResource::setLoadPriority(int priority) const
+{
+	if (mTextureData == nullptr)
+		sTextureDataManager.setLoadPriority(this, priority);
+}
+
+void TextureResource::prefetch(int priority) const
+{
+	if (mTextureData != nullptr)
+		return;
+
+	sTextureDataManager.setLoadPriority(this, priority);
+	sTextureDataManager.get(this, TextureDataManager::TextureLoadMode::ENABLED);
+}
+
 void TextureResource::setRequired(bool value) const
 {
 	if (mTextureData != nullptr)
@@ -177,6 +210,7 @@ bool TextureResource::bind()
 {
 	if (mTextureData != nullptr)
 	{
+		sTextureDataManager.markBound(mTextureData);
 		mTextureData->uploadAndBind();
 		return true;
 	}
@@ -184,12 +218,34 @@ bool TextureResource::bind()
 	return sTextureDataManager.bind(this);	
 }
 
+bool TextureResource::bindAtlas(Vector4f& uvRect)
+{
+	if (mTextureData != nullptr)
+	{
+		sTextureDataManager.markBound(mTextureData);
+		mTextureData->uploadAndBind(&uvRect);
+		return true;
+	}
+
+	return sTextureDataManager.bind(this, &uvRect);
+}
+
 void TextureResource::cancelAsync(std::shared_ptr<TextureResource> texture)
 {
 	if (texture != nullptr)
 		sTextureDataManager.cancelAsync(texture.get());
 }
 
+bool TextureResource::isCached(const std::string& path, bool tile, bool linear)
+{
+	auto it = sTextureMap.find(TextureKeyType(Utils::FileSystem::getCanonicalPath(path), tile, linear));
+	if (it == sTextureMap.cend())
+		return false;
+
+	std::shared_ptr<TextureResource> texture = it->second.lock();
+	return texture != nullptr && texture->isLoaded();
+}
+
 std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, bool tile, bool linear, bool forceLoad, bool dynamic, bool asReloadable, MaxSizeInfo* maxSize)
 {
 	std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
@@ -213,37 +269,45 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 		if (!foundTexture->second.expired())
 		{
 			std::shared_ptr<TextureResource> rc = foundTexture->second.lock();
+			applyMaxSize(rc, maxSize);
+			return rc;
+		}
+		else
+			sTextureMap.erase(foundTexture);
+	}
 
-			if (maxSize != nullptr && !maxSize->empty() && Settings::getInstance()->getBool("OptimizeVRAM"))
-			{				
-				std::shared_ptr<TextureData> dt;
-				if (rc->mTextureData != nullptr)
-					dt = rc->mTextureData;
-				else
-					dt = sTextureDataManager.get(rc.get(), TextureDataManager::TextureLoadMode::DISABLED);
+	// Another path with the same bytes : the path becomes an alias of its texture
+	uint64_t contentKey = 0;
+	if (asReloadable && dynamic && Settings::get(BoolSetting::DedupTextures))
+	{
+		unsigned int width, height;
+		uint64_t contentHash = 0;
 
-				if (dt != nullptr)
+		if (ImageIO::loadImageSize(canonicalPath, &width, &height, &contentHash) && contentHash != 0)
+		{
+			contentKey = getContentKey(contentHash, tile, linear);
+
+			auto foundContent = sContentMap.find(contentKey);
+			if (foundContent != sContentMap.cend())
+			{
+				std::shared_ptr<TextureResource> rc = foundContent->second.lock();
+				if (rc != nullptr)
 				{
-					dt->setMaxSize(*maxSize);
-
-					if (dt->isLoaded() && !dt->isMaxSizeValid())
-					{
-						dt->releaseVRAM();
-						dt->releaseRAM();
-						dt->load();
-					}
+					LOG(LogDebug) << "TextureResource : " << canonicalPath << " shares the texture of an identical file";
+
+					sTextureMap[key] = std::weak_ptr<TextureResource>(rc);
+					applyMaxSize(rc, maxSize);
+					return rc;
 				}
-			}
 
-			return rc;
+				sContentMap.erase(foundContent);
+			}
 		}
-		else
-			sTextureMap.erase(foundTexture);
 	}
 	
 	// need to create it
 	std::shared_ptr<TextureResource> tex;
-	tex = std::make_shared<TextureResource>(std::get<0>(key), tile, linear, dynamic, !forceLoad, maxSize);
+	tex = std::make_shared<TextureResource>(key.path, tile, linear, dynamic, !forceLoad, maxSize);
 	
 	auto loadMode = forceLoad ? TextureDataManager::TextureLoadMode::ENABLED : TextureDataManager::TextureLoadMode::DISABLED;
 	std::shared_ptr<TextureData> data = sTextureDataManager.get(tex.get(), loadMode);
@@ -252,6 +316,9 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 	{
 		sTextureMap[key] = std::weak_ptr<TextureResource>(tex);
 
+		if (contentKey != 0)
+			sContentMap[contentKey] = std::weak_ptr<TextureResource>(tex);
+
 		// Add it to the reloadable list
 		rm->addReloadable(tex);
 	}
@@ -271,6 +338,30 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 	return tex;
 }
 
+void TextureResource::applyMaxSize(const std::shared_ptr<TextureResource>& texture, MaxSizeInfo* maxSize)
+{
+	if (maxSize == nullptr || maxSize->empty() || !Settings::get(BoolSetting::OptimizeVRAM))
+		return;
+
+	std::shared_ptr<TextureData> dt;
+	if (texture->mTextureData != nullptr)
+		dt = texture->mTextureData;
+	else
+		dt = sTextureDataManager.get(texture.get(), TextureDataManager::TextureLoadMode::DISABLED);
+
+	if (dt != nullptr)
+	{
+		dt->setMaxSize(*maxSize);
+
+		if (dt->isLoaded() && !dt->isMaxSizeValid())
+		{
+			dt->releaseVRAM();
+			dt->releaseRAM();
+			dt->load();
+		}
+	}
+}
+
 // For scalable source images in textures we want to set the resolution to rasterize at
 void TextureResource::rasterizeAt(size_t width, size_t height)
 {
@@ -321,7 +412,7 @@ size_t TextureResource::getTotalMemUsage(bool includeQueueSize)
 		total = 0;
 
 		// Count up all textures that manage their own texture data
-		for (auto tex : sAllTextures)
+		for (auto tex = sFirstTexture; tex != nullptr; tex = tex->mNextTexture)
 		{
 			if (tex->mTextureData != nullptr)
 				total += tex->mTextureData->getVRAMUsage();
@@ -341,7 +432,7 @@ size_t TextureResource::getTotalTextureSize()
 {
 	size_t total = 0;
 	// Count up all textures that manage their own texture data
-	for (auto tex : sAllTextures)
+	for (auto tex = sFirstTexture; tex != nullptr; tex = tex->mNextTexture)
 	{
 		if (tex->mTextureData != nullptr)
 			total += tex->getSize().x() * tex->getSize().y() * 4;
@@ -351,6 +442,46 @@ size_t TextureResource::getTotalTextureSize()
 	return total;
 }
 
+TextureLoaderStats TextureResource::getLoaderStats()
+{
+	return sTextureDataManager.getLoaderStats();
+}
+
+size_t TextureResource::getLoaderQueueDepth()
+{
+	return sTextureDataManager.getQueueDepth();
+}
+
+size_t TextureResource::getAtlasMemUsage()
+{
+	return TextureAtlas::getTotalMemUsage();
+}
+
+TextureBudgetStats TextureResource::getBudgetStats()
+{
+	return sTextureDataManager.getBudgetStats();
+}
+
+void TextureResource::setViewPool(TexturePool pool)
+{
+	sTextureDataManager.setViewPool(pool);
+}
+
+TexturePool TextureResource::getViewPool()
+{
+	return sTextureDataManager.getViewPool();
+}
+
+size_t TextureResource::getBlankBindCount()
+{
+	return sTextureDataManager.getBlankBinds();
+}
+
+void TextureResource::beginFrame(TexturePool activePool)
+{
+	sTextureDataManager.beginFrame(activePool);
+}
+
 bool TextureResource::unload()
 {
 	// Release the texture's resources
@@ -373,12 +504,18 @@ bool TextureResource::unload()
 
 void TextureResource::reload()
 {
-	// For dynamically loaded textures the texture manager will load them on demand.
-	// For manually loaded textures we have to reload them here
-	if (mTextureData && !mTextureData->isLoaded())
-		mTextureData->load();
-	else if (mTextureData == nullptr)
-		sTextureDataManager.get(this);
+	// Through the loader queue, the textures that were visible first
+	std::shared_ptr<TextureData> data = mTextureData;
+	if (data == nullptr)
+		data = sTextureDataManager.get(this, TextureDataManager::TextureLoadMode::DISABLED);
+
+	if (data != nullptr)
+		sTextureDataManager.restore(data);
+}
+
+void TextureResource::waitForRestore(int maxTimeMs)
+{
+	sTextureDataManager.waitForRestore(maxTimeMs);
 }
 
 void TextureResource::clearQueue()
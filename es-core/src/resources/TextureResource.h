@@ -7,9 +7,8 @@
 #include "resources/ResourceManager.h"
 #include "resources/TextureDataManager.h"
 #include "resources/TextureData.h"
-#include <set>
 #include <string>
-#include <tuple>
+#include <unordered_map>
 
 // An OpenGL texture.
 // Automatically recreates the texture with renderer deinit/reinit.
@@ -21,8 +20,11 @@ public:
 public:
 	static void cancelAsync(std::shared_ptr<TextureResource> texture);
 	static std::shared_ptr<TextureResource> get(const std::string& path, bool tile = false, bool linear = false, bool forceLoad = false, bool dynamic = true, bool asReloadable = true, MaxSizeInfo* maxSize = nullptr);
+	// The texture exists & is loaded, get() would not queue anything
+	static bool isCached(const std::string& path, bool tile = false, bool linear = false);
 	void initFromPixels(unsigned char* dataRGBA, size_t width, size_t height);
 	void updateFromExternalPixels(unsigned char* dataRGBA, size_t width, size_t height);
+	void updateFromExternalYUV(unsigned char* dataYUV, size_t width, size_t height);
 	virtual void initFromMemory(const char* file, size_t length);
 
 	// For scalable source images in textures we want to set the resolution to rasterize at
@@ -34,13 +36,29 @@ public:
 	bool isLoaded() const;
 	bool isTiled() const;
 	void prioritize() const;
+	// Position in the async loader queue : lower values load first ( 0 : on screen / selected )
+	void setLoadPriority(int priority) const;
+	// Queues the async load ahead of the first bind, at the given priority
+	void prefetch(int priority) const;
 	void setRequired(bool value) const;
 
 	const Vector2i getSize() const;
 	bool bind();
+	// Binds a texture that may be shared with other small images. uvRect receives the normalized (x, y, w, h) of the image in the bound texture
+	bool bindAtlas(Vector4f& uvRect);
 
 	static size_t getTotalMemUsage(bool includeQueueSize = true); // returns an approximation of total VRAM used by textures (in bytes)
 	static size_t getTotalTextureSize(); // returns the number of bytes that would be used if all textures were in memory
+	static TextureLoaderStats getLoaderStats(); // async queue depth & wait times since the previous call
+	static size_t getLoaderQueueDepth(); // thread safe, doesn't reset the loader stats
+	static size_t getAtlasMemUsage(); // VRAM used by the pages of small textures
+	static TextureBudgetStats getBudgetStats(); // VRAM per pool & evictions since the previous call
+	static size_t getBlankBindCount(); // binds drawn blank so far, because their texture was not ready
+
+	// VRAM budget pools. The view pool is the one of the current system or gamelist view, the active pool is given at each frame
+	static void setViewPool(TexturePool pool);
+	static TexturePool getViewPool();
+	static void beginFrame(TexturePool activePool);
 	
 	virtual bool unload();
 	virtual void reload();
@@ -49,6 +67,9 @@ public:
 
 	static void clearQueue();
 
+	// After ResourceManager::reloadAll : waits for the textures that were visible before the game, at most maxTimeMs
+	static void waitForRestore(int maxTimeMs);
+
 private:
 	// mTextureData is used for textures that are not loaded from a file - these ones
 	// are permanently allocated and cannot be loaded and unloaded based on resources
@@ -61,9 +82,35 @@ private:
 	Vector2f					mSourceSize;
 	bool							mForceLoad;
 
-	typedef std::tuple<std::string, bool, bool> TextureKeyType;
-	static std::map< TextureKeyType, std::weak_ptr<TextureResource> > sTextureMap; // map of textures, used to prevent duplicate textures
-	static std::set<TextureResource*> 	sAllTextures;	// Set of all textures, used for memory management
+	// Canonical path & flags, hashed once per lookup
+	struct TextureKeyType
+	{
+		TextureKeyType(const std::string& path, bool tile, bool linear);
+
+		bool operator==(const TextureKeyType& other) const { return hash == other.hash && tile == other.tile && linear == other.linear && path == other.path; }
+
+		std::string path;
+		size_t		hash;
+		bool		tile;
+		bool		linear;
+	};
+
+	struct TextureKeyHash
+	{
+		size_t operator()(const TextureKeyType& key) const { return key.hash; }
+	};
+
+	static std::unordered_map< TextureKeyType, std::weak_ptr<TextureResource>, TextureKeyHash > sTextureMap; // map of textures, used to prevent duplicate textures
+	// Textures by content hash & flags ( "DedupTextures" ), so that byte-identical files share one texture
+	static std::unordered_map< uint64_t, std::weak_ptr<TextureResource> > sContentMap;
+
+	static uint64_t getContentKey(uint64_t contentHash, bool tile, bool linear) { return (contentHash << 2) | ((uint64_t)tile << 1) | (uint64_t)linear; }
+	static void applyMaxSize(const std::shared_ptr<TextureResource>& texture, MaxSizeInfo* maxSize);
+
+	// List of all textures, used for memory management
+	static TextureResource*		sFirstTexture;
+	TextureResource*			mPrevTexture;
+	TextureResource*			mNextTexture;
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_RESOURCE_H
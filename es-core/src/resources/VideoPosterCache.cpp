@@ -0,0 +1,297 @@
+#include "resources/VideoPosterCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "Settings.h"
+#include "Log.h"
+#include "TaskScheduler.h"
+
+#include <vlc/vlc.h>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+
+// Same offset as TextureData::loadFromVideo : most videos start with a black frame or a logo
+#define POSTER_START_TIME	":start-time=1.5"
+
+// Giving up on a video that doesn't decode this fast, or that is shorter than the loop
+#define EXTRACT_TIMEOUT_MS	4000
+
+// Videos wait in the queue for the nearby games only
+#define MAX_QUEUE_SIZE		32
+
+#if WIN32
+extern void _checkUpgradedVlcVersion();
+#endif
+
+std::mutex VideoPosterCache::mLock;
+std::condition_variable VideoPosterCache::mEvent;
+std::deque<std::string> VideoPosterCache::mQueue;
+std::thread* VideoPosterCache::mThread = nullptr;
+std::atomic<bool> VideoPosterCache::mExit(false);
+
+bool VideoPosterCache::isEnabled()
+{
+	return Settings::getInstance()->getBool("VideoPosterCache");
+}
+
+bool VideoPosterCache::hasPoster(const std::string& videoPath)
+{
+	return TextureDiskCache::hasVariant(videoPath, "poster");
+}
+
+bool VideoPosterCache::loadPoster(const std::string& videoPath, TextureDiskCache::Image& image)
+{
+	return TextureDiskCache::loadVariant(videoPath, "poster", image);
+}
+
+bool VideoPosterCache::loadLoop(const std::string& videoPath, TextureDiskCache::Image& image)
+{
+	if (!TextureDiskCache::loadVariant(videoPath, "loop", image))
+		return false;
+
+	if (image.packedSize.y() <= 0 || image.height != (size_t)image.packedSize.y() * LOOP_FRAMES)
+	{
+		image.buffer.reset();
+		image.rgba = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+void VideoPosterCache::queue(const std::string& videoPath)
+{
+	if (videoPath.empty() || !isEnabled() || hasPoster(videoPath))
+		return;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	if (mExit)
+		return;
+
+	for (auto it = mQueue.begin(); it != mQueue.end(); ++it)
+	{
+		if (*it == videoPath)
+		{
+			mQueue.erase(it);
+			break;
+		}
+	}
+
+	mQueue.push_back(videoPath);
+
+	while (mQueue.size() > MAX_QUEUE_SIZE)
+		mQueue.pop_front();
+
+	if (mThread == nullptr)
+		mThread = new std::thread(&VideoPosterCache::run);
+
+	mEvent.notify_one();
+}
+
+void VideoPosterCache::stop()
+{
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		mExit = true;
+		mQueue.clear();
+		mEvent.notify_one();
+	}
+
+	if (mThread != nullptr)
+	{
+		mThread->join();
+		delete mThread;
+		mThread = nullptr;
+	}
+}
+
+void VideoPosterCache::run()
+{
+	TaskScheduler::setCurrentThreadPriority(TaskScheduler::BACKGROUND);
+
+	// Own instance : the extraction must not share the players or the options of the displayed videos
+	const char* args[] = { "--quiet", "--intf=dummy", "--no-audio", "--no-video-title-show" };
+
+#if WIN32
+	_checkUpgradedVlcVersion();
+#endif
+
+	libvlc_instance_t* vlc = libvlc_new(sizeof(args) / sizeof(args[0]), args);
+	if (vlc == nullptr)
+	{
+		LOG(LogError) << "VideoPosterCache : Unable to initialize VLC";
+		return;
+	}
+
+	while (!mExit)
+	{
+		std::string videoPath;
+
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mEvent.wait(lock, []() { return mExit || !mQueue.empty(); });
+
+			if (mExit)
+				break;
+
+			videoPath = mQueue.back();
+			mQueue.pop_back();
+		}
+
+		if (!hasPoster(videoPath) && Utils::FileSystem::exists(videoPath))
+			extract(vlc, videoPath);
+	}
+
+	libvlc_release(vlc);
+}
+
+struct PosterContext
+{
+	PosterContext() : width(0), height(0), loopWidth(0), loopHeight(0), hasPoster(false), loopFrames(0) { }
+
+	std::vector<unsigned char> frame;
+	unsigned width;
+	unsigned height;
+
+	std::vector<unsigned char> poster;
+	std::vector<unsigned char> loop;
+	unsigned loopWidth;
+	unsigned loopHeight;
+
+	std::atomic<bool> hasPoster;
+	std::atomic<int> loopFrames;
+	std::chrono::steady_clock::time_point nextLoopFrame;
+};
+
+// The poster keeps the aspect ratio of the video, at most POSTER_WIDTH wide
+static unsigned posterSetup(void** opaque, char* chroma, unsigned* width, unsigned* height, unsigned* pitches, unsigned* lines)
+{
+	PosterContext* context = (PosterContext*)*opaque;
+
+	if (*width == 0 || *height == 0)
+		return 0;
+
+	unsigned w = std::min(*width, (unsigned)VideoPosterCache::POSTER_WIDTH) & ~1u;
+	unsigned h = std::max(2u, (unsigned)((unsigned long long)*height * w / *width) & ~1u);
+
+	memcpy(chroma, "RGBA", 4);
+	*width = w;
+	*height = h;
+	pitches[0] = w * 4;
+	lines[0] = h;
+
+	context->width = w;
+	context->height = h;
+	context->frame.resize(w * h * 4);
+
+	context->loopWidth = std::min(w, (unsigned)VideoPosterCache::LOOP_WIDTH);
+	context->loopHeight = std::max(1u, h * context->loopWidth / w);
+	context->loop.resize(context->loopWidth * context->loopHeight * 4 * VideoPosterCache::LOOP_FRAMES);
+
+	return 1;
+}
+
+static void* posterLock(void* data, void** pixels)
+{
+	*pixels = ((PosterContext*)data)->frame.data();
+	return nullptr;
+}
+
+static void posterDisplay(void* data, void* id)
+{
+	PosterContext* context = (PosterContext*)data;
+	if (context->frame.empty())
+		return;
+
+	auto now = std::chrono::steady_clock::now();
+
+	if (!context->hasPoster)
+	{
+		context->poster = context->frame;
+		context->nextLoopFrame = now;
+		context->hasPoster = true;
+	}
+
+	int index = context->loopFrames;
+	if (index >= VideoPosterCache::LOOP_FRAMES || now < context->nextLoopFrame)
+		return;
+
+	// Nearest sampling, the loop is small and short
+	unsigned char* dst = context->loop.data() + (size_t)index * context->loopWidth * context->loopHeight * 4;
+	for (unsigned y = 0; y < context->loopHeight; y++)
+	{
+		const unsigned char* src = context->frame.data() + (size_t)(y * context->height / context->loopHeight) * context->width * 4;
+		for (unsigned x = 0; x < context->loopWidth; x++, dst += 4)
+			memcpy(dst, src + (x * context->width / context->loopWidth) * 4, 4);
+	}
+
+	context->nextLoopFrame += std::chrono::milliseconds(VideoPosterCache::LOOP_FRAME_MS);
+	context->loopFrames = index + 1;
+}
+
+void VideoPosterCache::extract(libvlc_instance_t* vlc, const std::string& videoPath)
+{
+	libvlc_media_t* media = libvlc_media_new_path(vlc, Utils::FileSystem::getPreferredPath(videoPath).c_str());
+	if (media == nullptr)
+		return;
+
+	libvlc_media_add_option(media, ":no-audio");
+	libvlc_media_add_option(media, POSTER_START_TIME);
+
+	libvlc_media_player_t* player = libvlc_media_player_new_from_media(media);
+	if (player == nullptr)
+	{
+		libvlc_media_release(media);
+		return;
+	}
+
+	PosterContext context;
+	libvlc_video_set_callbacks(player, posterLock, nullptr, posterDisplay, &context);
+	libvlc_video_set_format_callbacks(player, posterSetup, nullptr);
+
+	libvlc_media_player_play(player);
+
+	auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(EXTRACT_TIMEOUT_MS);
+
+	while (!mExit && context.loopFrames < LOOP_FRAMES && std::chrono::steady_clock::now() < timeout)
+	{
+		libvlc_state_t state = libvlc_media_player_get_state(player);
+		if (state == libvlc_Ended || state == libvlc_Error)
+			break;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+
+	// Synchronous : no more display callbacks past this point
+	libvlc_media_player_stop(player);
+	libvlc_media_player_release(player);
+	libvlc_media_release(media);
+
+	if (mExit || !context.hasPoster)
+	{
+		LOG(LogDebug) << "VideoPosterCache : No frame decoded from " << videoPath;
+		return;
+	}
+
+	// The loop first : the poster is the "done" mark
+	if (context.loopFrames == LOOP_FRAMES)
+	{
+		TextureDiskCache::Image loop;
+		loop.rgba = context.loop.data();
+		loop.width = context.loopWidth;
+		loop.height = context.loopHeight * LOOP_FRAMES;
+		loop.baseSize = Vector2i(context.width, context.height);
+		loop.packedSize = Vector2i(context.loopWidth, context.loopHeight);
+		TextureDiskCache::saveVariant(videoPath, "loop", loop);
+	}
+
+	TextureDiskCache::Image poster;
+	poster.rgba = context.poster.data();
+	poster.width = context.width;
+	poster.height = context.height;
+	poster.baseSize = Vector2i(context.width, context.height);
+	poster.packedSize = Vector2i(context.width, context.height);
+	TextureDiskCache::saveVariant(videoPath, "poster", poster);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_VIDEO_POSTER_CACHE_H
+#define ES_CORE_RESOURCES_VIDEO_POSTER_CACHE_H
+
+#include "resources/TextureDiskCache.h"
+#include <string>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
+struct libvlc_instance_t;
+
+// First frame & short low-res loop of the game videos, extracted in the background and stored in the texture disk cache.
+// Video slots show them while VLC opens the video, thumbnails of videos use the poster. Enabled with the "VideoPosterCache" setting
+class VideoPosterCache
+{
+public:
+	static const int POSTER_WIDTH = 320;
+	static const int LOOP_WIDTH = 128;
+	static const int LOOP_FRAMES = 12;
+	static const int LOOP_FRAME_MS = 125;
+
+	static bool isEnabled();
+
+	// Thread safe. The last queued videos are extracted first, the cursor is on them
+	static void queue(const std::string& videoPath);
+
+	static bool hasPoster(const std::string& videoPath);
+	static bool loadPoster(const std::string& videoPath, TextureDiskCache::Image& image);
+
+	// LOOP_FRAMES frames of LOOP_WIDTH pixels, stacked vertically : image.packedSize is the size of one frame
+	static bool loadLoop(const std::string& videoPath, TextureDiskCache::Image& image);
+
+	static void stop();
+
+private:
+	static void run();
+	static void extract(libvlc_instance_t* vlc, const std::string& videoPath);
+
+	static std::mutex				mLock;
+	static std::condition_variable	mEvent;
+	static std::deque<std::string>	mQueue;
+	static std::thread*				mThread;
+	static std::atomic<bool>		mExit;
+};
+
+#endif // ES_CORE_RESOURCES_VIDEO_POSTER_CACHE_H
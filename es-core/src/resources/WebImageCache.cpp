@@ -0,0 +1,270 @@
+#include "resources/WebImageCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/ZipFile.h"
+#include "HttpReq.h"
+#include "TaskScheduler.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <vector>
+
+#define VALIDATORS_EXTENSION	".validators"
+
+std::mutex WebImageCache::sLock;
+std::map<std::string, std::weak_ptr<HttpReq>> WebImageCache::sRequests;
+std::atomic<bool> WebImageCache::sTrimming(false);
+
+struct url
+{
+public:
+	static url parse(const std::string& url_s)
+	{
+		url ret;
+
+		using namespace std;
+
+		const std::string prot_end("://");
+		std::string::const_iterator prot_i = search(url_s.begin(), url_s.end(), prot_end.begin(), prot_end.end());
+		ret.protocol.reserve(distance(url_s.begin(), prot_i));
+		transform(url_s.begin(), prot_i, back_inserter(ret.protocol), ptr_fun<int, int>(tolower));
+		if (prot_i == url_s.end())
+			return ret;
+
+		advance(prot_i, prot_end.length());
+		string::const_iterator path_i = find(prot_i, url_s.end(), '/');
+		ret.host.reserve(distance(prot_i, path_i));
+		transform(prot_i, path_i, back_inserter(ret.host), ptr_fun<int, int>(tolower)); // host is icase
+		string::const_iterator query_i = find(path_i, url_s.end(), '?');
+		ret.path.assign(path_i, query_i);
+		if (query_i != url_s.end())
+			++query_i;
+		ret.query.assign(query_i, url_s.end());
+		return ret;
+	}
+
+	std::string protocol, host, path, query;
+};
+
+std::string WebImageCache::getRoot()
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/tmp/webimages");
+}
+
+std::string WebImageCache::getLocalFile(const std::string& imageUrl)
+{
+	url uri = url::parse(imageUrl);
+	if (uri.host.empty() || uri.path.empty())
+		return "";
+
+	if (Utils::String::startsWith(uri.path, "/"))
+		uri.path = uri.path.substr(1);
+
+	std::string queryCrc;
+
+	if (!uri.query.empty())
+	{
+		auto file_crc32 = Utils::Zip::ZipFile::computeCRC(0, uri.query.data(), uri.query.size());
+		queryCrc = "-" + Utils::String::toHexString(file_crc32);
+	}
+
+	return getRoot() + "/" + uri.host + "/" + uri.path + queryCrc;
+}
+
+bool WebImageCache::isFresh(const std::string& localFile, double keepInCacheDuration)
+{
+	if (keepInCacheDuration == 0 || !Utils::FileSystem::exists(localFile))
+		return false;
+
+	if (keepInCacheDuration < 0)
+		return true;
+
+	Validators validators;
+	if (loadValidators(localFile, validators))
+		return difftime(time(NULL), validators.time) <= keepInCacheDuration;
+
+	auto date = Utils::FileSystem::getFileCreationDate(localFile);
+	return Utils::Time::DateTime::now().elapsedSecondsSince(date) <= keepInCacheDuration;
+}
+
+std::shared_ptr<HttpReq> WebImageCache::fetch(const std::string& imageUrl, const std::string& localFile)
+{
+	std::unique_lock<std::mutex> lock(sLock);
+
+	auto it = sRequests.find(localFile);
+	if (it != sRequests.cend())
+	{
+		auto request = it->second.lock();
+		if (request != nullptr)
+			return request;
+	}
+
+	std::string localPath = Utils::FileSystem::getParent(localFile);
+	if (!Utils::FileSystem::exists(localPath))
+		Utils::FileSystem::createDirectory(localPath);
+
+	HttpReqOptions options(localFile);
+
+	// Not modified : the file stays as it is
+	Validators validators;
+	if (Utils::FileSystem::exists(localFile) && loadValidators(localFile, validators))
+	{
+		if (!validators.etag.empty())
+			options.customHeaders.push_back("If-None-Match: " + validators.etag);
+
+		if (!validators.lastModified.empty())
+			options.customHeaders.push_back("If-Modified-Since: " + validators.lastModified);
+	}
+
+	auto request = std::make_shared<HttpReq>(imageUrl, &options);
+
+	for (auto it = sRequests.begin(); it != sRequests.end(); )
+	{
+		if (it->second.expired())
+			it = sRequests.erase(it);
+		else
+			it++;
+	}
+
+	sRequests[localFile] = request;
+	return request;
+}
+
+bool WebImageCache::onCompleted(const std::shared_ptr<HttpReq>& request, const std::string& localFile)
+{
+	auto status = request->status();
+	if (status != HttpReq::REQ_SUCCESS && status != HttpReq::REQ_304_NOTMODIFIED)
+		return false;
+
+	if (!Utils::FileSystem::exists(localFile))
+		return false;
+
+	Validators validators;
+	if (status == HttpReq::REQ_304_NOTMODIFIED)
+		loadValidators(localFile, validators);
+
+	// A 304 may not repeat them
+	std::string etag = request->getResponseHeader("ETag");
+	if (!etag.empty())
+		validators.etag = etag;
+
+	std::string lastModified = request->getResponseHeader("Last-Modified");
+	if (!lastModified.empty())
+		validators.lastModified = lastModified;
+
+	validators.time = time(NULL);
+
+	{
+		std::unique_lock<std::mutex> lock(sLock);
+		saveValidators(localFile, validators);
+	}
+
+	if (status == HttpReq::REQ_SUCCESS && !sTrimming.exchange(true))
+		TaskScheduler::submit(TaskScheduler::BACKGROUND, [] { trim(); });
+
+	return true;
+}
+
+void WebImageCache::remove(const std::string& localFile)
+{
+	if (localFile.empty() || !Utils::FileSystem::exists(localFile))
+		return;
+
+	Utils::FileSystem::removeFile(localFile);
+	Utils::FileSystem::removeFile(localFile + VALIDATORS_EXTENSION);
+
+	// Up to the root, as long as the folders are empty
+	auto root = getRoot();
+	auto file = Utils::FileSystem::getParent(Utils::FileSystem::getGenericPath(localFile));
+
+	while (!file.empty() && file != root && file != localFile && Utils::FileSystem::removeFile(file))
+		file = Utils::FileSystem::getParent(file);
+}
+
+// "time\netag\nlast-modified"
+bool WebImageCache::loadValidators(const std::string& localFile, Validators& validators)
+{
+	std::string path = localFile + VALIDATORS_EXTENSION;
+	if (!Utils::FileSystem::exists(path))
+		return false;
+
+	auto lines = Utils::String::split(Utils::FileSystem::readAllText(path), '\n');
+	if (lines.empty())
+		return false;
+
+	validators.time = (time_t)atoll(lines[0].c_str());
+	validators.etag = lines.size() > 1 ? lines[1] : "";
+	validators.lastModified = lines.size() > 2 ? lines[2] : "";
+
+	return validators.time > 0;
+}
+
+void WebImageCache::saveValidators(const std::string& localFile, const Validators& validators)
+{
+	Utils::FileSystem::writeAllText(localFile + VALIDATORS_EXTENSION, std::to_string((long long)validators.time) + "\n" + validators.etag + "\n" + validators.lastModified);
+}
+
+void WebImageCache::trim()
+{
+	struct Entry
+	{
+		std::string path;
+		unsigned long long size;
+		time_t time;
+	};
+
+	long long maxSize = (long long)Settings::getInstance()->getInt("WebImageCacheSize") * 1024 * 1024;
+
+	std::vector<Entry> entries;
+	long long totalSize = 0;
+
+	for (auto file : Utils::FileSystem::getDirContent(getRoot(), true))
+	{
+		if (Utils::FileSystem::isDirectory(file) || Utils::String::endsWith(file, VALIDATORS_EXTENSION) || Utils::String::endsWith(file, ".tmp"))
+			continue;
+
+		Entry entry;
+		entry.path = file;
+		entry.size = Utils::FileSystem::getFileSize(file);
+		entry.time = Utils::FileSystem::getFileModificationDate(file).getTime();
+
+		Validators validators;
+		if (loadValidators(file, validators))
+			entry.time = validators.time;
+
+		totalSize += entry.size;
+		entries.push_back(entry);
+	}
+
+	if (maxSize > 0 && totalSize > maxSize)
+	{
+		std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+
+		for (auto& entry : entries)
+		{
+			if (totalSize <= maxSize)
+				break;
+
+			{
+				std::unique_lock<std::mutex> lock(sLock);
+
+				// Being downloaded again
+				auto it = sRequests.find(entry.path);
+				if (it != sRequests.cend() && !it->second.expired())
+					continue;
+			}
+
+			remove(entry.path);
+			totalSize -= entry.size;
+		}
+
+		LOG(LogDebug) << "WebImageCache : trimmed to " << (totalSize / 1024 / 1024) << " MB";
+	}
+
+	sTrimming = false;
+}
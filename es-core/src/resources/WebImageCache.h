@@ -0,0 +1,54 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_WEB_IMAGE_CACHE_H
+#define ES_CORE_RESOURCES_WEB_IMAGE_CACHE_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <time.h>
+
+class HttpReq;
+
+// Remote images of the store, the theme & content downloaders and the achievements, shared by the WebImageComponents under tmp/webimages/<host>/<path>.
+// Expired files are revalidated with the ETag / Last-Modified kept next to them, the components asking for a file being downloaded share its request,
+// and the oldest downloads are removed above "WebImageCacheSize" MB
+class WebImageCache
+{
+public:
+	// Empty when the url has no host or path
+	static std::string getLocalFile(const std::string& url);
+
+	// keepInCacheDuration, in seconds : -1 never expires, 0 expires immediately
+	static bool isFresh(const std::string& localFile, double keepInCacheDuration);
+
+	// The request of the file in progress, or a new one, conditional when the file has validators
+	static std::shared_ptr<HttpReq> fetch(const std::string& url, const std::string& localFile);
+
+	// By each owner of a completed request : true when the file is ready to load, downloaded or not modified
+	static bool onCompleted(const std::shared_ptr<HttpReq>& request, const std::string& localFile);
+
+	static void remove(const std::string& localFile);
+
+private:
+	struct Validators
+	{
+		Validators() : time(0) { }
+
+		time_t		time; // Of the download or the last revalidation
+		std::string etag;
+		std::string lastModified;
+	};
+
+	static std::string getRoot();
+	static bool loadValidators(const std::string& localFile, Validators& validators);
+	static void saveValidators(const std::string& localFile, const Validators& validators);
+	static void trim();
+
+	static std::mutex sLock;
+	static std::map<std::string, std::weak_ptr<HttpReq>> sRequests;
+	static std::atomic<bool> sTrimming;
+};
+
+#endif // ES_CORE_RESOURCES_WEB_IMAGE_CACHE_H
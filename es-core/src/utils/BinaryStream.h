@@ -0,0 +1,106 @@
+#pragma once
+#ifndef ES_CORE_UTILS_BINARY_STREAM_H
+#define ES_CORE_UTILS_BINARY_STREAM_H
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+namespace Utils
+{
+	// Little helpers used to build and read the binary cache files (native byte order, no alignment).
+	class BinaryWriter
+	{
+	public:
+		BinaryWriter() { }
+
+		inline void writeUInt8(uint8_t value) { mBuffer.push_back((char)value); }
+		inline void writeUInt16(uint16_t value) { write(&value, sizeof(value)); }
+		inline void writeUInt32(uint32_t value) { write(&value, sizeof(value)); }
+		inline void writeInt64(int64_t value) { write(&value, sizeof(value)); }
+		inline void writeUInt64(uint64_t value) { write(&value, sizeof(value)); }
+		inline void writeFloat(float value) { write(&value, sizeof(value)); }
+
+		inline void writeString(const std::string& value)
+		{
+			writeUInt32((uint32_t)value.size());
+			mBuffer.append(value);
+		}
+
+		inline void write(const void* data, size_t size) { mBuffer.append((const char*)data, size); }
+
+		// Patch a previously written uint32 (used for record sizes)
+		inline void setUInt32At(size_t offset, uint32_t value)
+		{
+			if (offset + sizeof(value) <= mBuffer.size())
+				memcpy(&mBuffer[offset], &value, sizeof(value));
+		}
+
+		inline size_t size() const { return mBuffer.size(); }
+		inline const std::string& buffer() const { return mBuffer; }
+		inline void clear() { mBuffer.clear(); }
+
+	private:
+		std::string mBuffer;
+	};
+
+	class BinaryReader
+	{
+	public:
+		BinaryReader(const unsigned char* data, size_t size) : mData(data), mEnd(data + size), mFailed(data == nullptr) { }
+
+		inline uint8_t readUInt8() { uint8_t value = 0; read(&value, sizeof(value)); return value; }
+		inline uint16_t readUInt16() { uint16_t value = 0; read(&value, sizeof(value)); return value; }
+		inline uint32_t readUInt32() { uint32_t value = 0; read(&value, sizeof(value)); return value; }
+		inline int64_t readInt64() { int64_t value = 0; read(&value, sizeof(value)); return value; }
+		inline uint64_t readUInt64() { uint64_t value = 0; read(&value, sizeof(value)); return value; }
+		inline float readFloat() { float value = 0; read(&value, sizeof(value)); return value; }
+
+		inline std::string readString()
+		{
+			uint32_t length = readUInt32();
+			if (mFailed || length > (size_t)(mEnd - mData))
+			{
+				mFailed = true;
+				return std::string();
+			}
+
+			std::string ret((const char*)mData, length);
+			mData += length;
+			return ret;
+		}
+
+		// Returns a pointer on the next 'size' bytes without copying them
+		inline const unsigned char* readRaw(size_t size)
+		{
+			if (mFailed || size > (size_t)(mEnd - mData))
+			{
+				mFailed = true;
+				return nullptr;
+			}
+
+			const unsigned char* ret = mData;
+			mData += size;
+			return ret;
+		}
+
+		inline void read(void* dest, size_t size)
+		{
+			const unsigned char* src = readRaw(size);
+			if (src != nullptr)
+				memcpy(dest, src, size);
+		}
+
+		inline bool failed() const { return mFailed; }
+		inline void setFailed() { mFailed = true; }
+		inline bool eof() const { return mFailed || mData >= mEnd; }
+		inline size_t remaining() const { return mFailed ? 0 : (size_t)(mEnd - mData); }
+
+	private:
+		const unsigned char* mData;
+		const unsigned char* mEnd;
+		bool mFailed;
+	};
+}
+
+#endif // ES_CORE_UTILS_BINARY_STREAM_H
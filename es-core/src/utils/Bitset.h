@@ -0,0 +1,47 @@
+#pragma once
+#ifndef ES_CORE_UTILS_BITSET_H
+#define ES_CORE_UTILS_BITSET_H
+
+#include <cstdint>
+#include <vector>
+
+namespace Utils
+{
+	// Growable set of small integers, stored as 64 bits words so that intersections are word wide loops
+	class Bitset
+	{
+	public:
+		inline void clear() { mWords.clear(); }
+
+		inline void set(unsigned int index)
+		{
+			size_t word = index >> 6;
+			if (word >= mWords.size())
+				mWords.resize(word + 1, 0);
+
+			mWords[word] |= (uint64_t)1 << (index & 63);
+		}
+
+		inline bool test(unsigned int index) const
+		{
+			size_t word = index >> 6;
+			return word < mWords.size() && (mWords[word] & ((uint64_t)1 << (index & 63))) != 0;
+		}
+
+		Bitset& operator&=(const Bitset& other)
+		{
+			if (mWords.size() > other.mWords.size())
+				mWords.resize(other.mWords.size());
+
+			for (size_t i = 0; i < mWords.size(); i++)
+				mWords[i] &= other.mWords[i];
+
+			return *this;
+		}
+
+	private:
+		std::vector<uint64_t> mWords;
+	};
+}
+
+#endif // ES_CORE_UTILS_BITSET_H
@@ -0,0 +1,172 @@
+#include "utils/ComicBook.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define COMIC_OPEN_BOOKS		2
+#define COMIC_CACHE_PAGES		16
+#define COMIC_CACHE_SIZE		(96 * 1024 * 1024)
+
+namespace Utils
+{
+	namespace Zip
+	{
+		std::mutex ComicBook::sBooksLock;
+		std::list<std::shared_ptr<ComicBook>> ComicBook::sBooks;
+
+		std::shared_ptr<ComicBook> ComicBook::open(const std::string& path)
+		{
+			unsigned long long fileSize = Utils::FileSystem::getFileSize(path);
+
+			std::unique_lock<std::mutex> lock(sBooksLock);
+
+			for (auto it = sBooks.begin(); it != sBooks.end(); ++it)
+			{
+				if ((*it)->mPath != path)
+					continue;
+
+				auto book = *it;
+				sBooks.erase(it);
+
+				// Replaced since it was opened
+				if (book->mFileSize != fileSize)
+					break;
+
+				sBooks.push_front(book);
+				return book;
+			}
+
+			std::shared_ptr<ComicBook> book(new ComicBook(path));
+			if (!book->load())
+				return nullptr;
+
+			book->mFileSize = fileSize;
+
+			sBooks.push_front(book);
+			while (sBooks.size() > COMIC_OPEN_BOOKS)
+				sBooks.pop_back();
+
+			return book;
+		}
+
+		ComicBook::ComicBook(const std::string& path) : mPath(path), mFileSize(0), mCacheSize(0)
+		{
+		}
+
+		ComicBook::~ComicBook()
+		{
+		}
+
+		bool ComicBook::load()
+		{
+			try
+			{
+				if (!mZip.load(mPath))
+					return false;
+
+				for (auto& file : mZip.infolist())
+				{
+					auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(file.filename));
+					if (ext != ".jpg")
+						continue;
+
+					if (Utils::String::startsWith(file.filename, "__"))
+						continue;
+
+					mPages.push_back(file);
+				}
+			}
+			catch (...)
+			{
+				LOG(LogError) << "ComicBook : bad archive " << mPath;
+				return false;
+			}
+
+			std::sort(mPages.begin(), mPages.end(), [](const ZipInfo& a, const ZipInfo& b) { return Utils::String::toLower(a.filename) < Utils::String::toLower(b.filename); });
+			return mPages.size() > 0;
+		}
+
+		std::shared_ptr<std::vector<unsigned char>> ComicBook::getCachedPage(int index)
+		{
+			std::unique_lock<std::mutex> lock(mCacheLock);
+
+			for (auto it = mCache.begin(); it != mCache.end(); ++it)
+			{
+				if (it->first != index)
+					continue;
+
+				if (it != mCache.begin())
+					mCache.splice(mCache.begin(), mCache, it);
+
+				return mCache.front().second;
+			}
+
+			return nullptr;
+		}
+
+		std::shared_ptr<std::vector<unsigned char>> ComicBook::inflatePage(int index)
+		{
+			const ZipInfo& info = mPages[index];
+			if (info.file_size == 0)
+				return nullptr;
+
+			auto data = std::make_shared<std::vector<unsigned char>>(info.file_size);
+
+			struct InflateContext
+			{
+				unsigned char* data;
+				size_t size;
+			} context = { data->data(), data->size() };
+
+			Utils::Zip::zip_callback func = [](void *pOpaque, unsigned long long ofs, const void *pBuf, size_t n)
+			{
+				InflateContext* ctx = (InflateContext*)pOpaque;
+				if (ofs + n > ctx->size)
+					return (size_t)0;
+
+				memcpy(ctx->data + ofs, pBuf, n);
+				return n;
+			};
+
+			{
+				std::unique_lock<std::mutex> lock(mZipLock);
+				if (!mZip.readBuffered(info, func, &context))
+					return nullptr;
+			}
+
+			std::unique_lock<std::mutex> lock(mCacheLock);
+
+			// Inflated meanwhile by another thread
+			for (auto& item : mCache)
+				if (item.first == index)
+					return item.second;
+
+			mCache.push_front(std::make_pair(index, data));
+			mCacheSize += data->size();
+
+			while (mCache.size() > 1 && (mCache.size() > COMIC_CACHE_PAGES || mCacheSize > COMIC_CACHE_SIZE))
+			{
+				mCacheSize -= mCache.back().second->size();
+				mCache.pop_back();
+			}
+
+			return data;
+		}
+
+		std::shared_ptr<std::vector<unsigned char>> ComicBook::readPage(int index)
+		{
+			if (index < 0 || index >= (int)mPages.size())
+				return nullptr;
+
+			auto data = getCachedPage(index);
+			if (data != nullptr)
+				return data;
+
+			return inflatePage(index);
+		}
+	}
+}
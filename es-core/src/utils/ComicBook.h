@@ -0,0 +1,59 @@
+#pragma once
+#ifndef ES_CORE_UTILS_COMIC_BOOK_H
+#define ES_CORE_UTILS_COMIC_BOOK_H
+
+#include "utils/ZipFile.h"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+	namespace Zip
+	{
+		// A .cbz opened once : the central directory is read and the pages are listed on open, then each page is inflated by its index.
+		// The last pages read stay in memory, and the last books opened are kept, so the cover of a game & the viewer share the same archive.
+		// Thread safe : the viewer inflates the pages from its workers
+		class ComicBook
+		{
+		public:
+			static std::shared_ptr<ComicBook> open(const std::string& path);
+
+			~ComicBook();
+
+			const std::string& getPath() const { return mPath; }
+
+			int getPageCount() const { return (int)mPages.size(); };
+			const std::string& getPageName(int index) const { return mPages[index].filename; }
+
+			// Inflated page ( the jpg file ), nullptr if it can't be read
+			std::shared_ptr<std::vector<unsigned char>> readPage(int index);
+
+		private:
+			ComicBook(const std::string& path);
+
+			bool load();
+			std::shared_ptr<std::vector<unsigned char>> getCachedPage(int index);
+			std::shared_ptr<std::vector<unsigned char>> inflatePage(int index);
+
+			std::string mPath;
+			unsigned long long mFileSize;
+
+			std::mutex mZipLock; // miniz reads the archive through a single file handle
+			ZipFile mZip;
+			std::vector<ZipInfo> mPages;
+
+			std::mutex mCacheLock;
+			std::list<std::pair<int, std::shared_ptr<std::vector<unsigned char>>>> mCache; // Most recent first
+			size_t mCacheSize;
+
+			static std::mutex sBooksLock;
+			static std::list<std::shared_ptr<ComicBook>> sBooks;
+		};
+	}
+}
+
+#endif // ES_CORE_UTILS_COMIC_BOOK_H
@@ -0,0 +1,270 @@
+#include "utils/Crc32.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC32_ARM
+#elif defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CRC32_TARGET
+#else
+#include <cpuid.h>
+#define CRC32_TARGET __attribute__((target("sse4.1,pclmul")))
+#endif
+#define CRC32_PCLMUL
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define CRC32_BIG_ENDIAN
+#endif
+
+namespace Utils
+{
+	namespace Crc32
+	{
+		struct Tables
+		{
+			Tables()
+			{
+				for (uint32_t i = 0; i < 256; i++)
+				{
+					uint32_t crc = i;
+					for (int bit = 0; bit < 8; bit++)
+						crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+
+					table[0][i] = crc;
+				}
+
+				for (int slice = 1; slice < 8; slice++)
+					for (uint32_t i = 0; i < 256; i++)
+						table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xFF];
+			}
+
+			uint32_t table[8][256];
+		};
+
+		static const Tables& getTables()
+		{
+			static Tables tables;
+			return tables;
+		}
+
+		// Slicing-by-8 : 8 bytes per step, with one table per byte position
+		static uint32_t computeTables(uint32_t crc, const unsigned char* p, size_t size)
+		{
+			const uint32_t (*t)[256] = getTables().table;
+
+			crc = ~crc;
+
+			while (size > 0 && ((uintptr_t)p & 7) != 0)
+			{
+				crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+				size--;
+			}
+
+#ifndef CRC32_BIG_ENDIAN
+			while (size >= 8)
+			{
+				uint32_t one, two;
+				memcpy(&one, p, 4);
+				memcpy(&two, p + 4, 4);
+
+				one ^= crc;
+				crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+					  t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+
+				p += 8;
+				size -= 8;
+			}
+#endif
+
+			while (size-- > 0)
+				crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+
+			return ~crc;
+		}
+
+#ifdef CRC32_ARM
+		static uint32_t computeArm(uint32_t crc, const unsigned char* p, size_t size)
+		{
+			crc = ~crc;
+
+			while (size > 0 && ((uintptr_t)p & 7) != 0)
+			{
+				crc = __crc32b(crc, *p++);
+				size--;
+			}
+
+			while (size >= 8)
+			{
+				uint64_t value;
+				memcpy(&value, p, 8);
+				crc = __crc32d(crc, value);
+
+				p += 8;
+				size -= 8;
+			}
+
+			while (size-- > 0)
+				crc = __crc32b(crc, *p++);
+
+			return ~crc;
+		}
+#endif
+
+#ifdef CRC32_PCLMUL
+		static bool hasPclmul()
+		{
+			static int supported = -1;
+			if (supported < 0)
+			{
+				unsigned int ecx = 0;
+#if defined(_MSC_VER)
+				int info[4];
+				__cpuid(info, 1);
+				ecx = (unsigned int)info[2];
+#else
+				unsigned int eax, ebx, edx;
+				if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+					ecx = 0;
+#endif
+				// PCLMULQDQ & SSE4.1 ( _mm_extract_epi32 )
+				supported = ((ecx & (1 << 1)) && (ecx & (1 << 19))) ? 1 : 0;
+			}
+
+			return supported == 1;
+		}
+
+		// Folding with carry-less multiplications, from Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ" ( as in zlib / Chromium ).
+		// Works on the inverted crc, size must be a multiple of 16 and at least 64
+		CRC32_TARGET static uint32_t computePclmul(uint32_t crc, const unsigned char* p, size_t size)
+		{
+			alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+			alignas(16) static const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+			alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+			alignas(16) static const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+			__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+			x1 = _mm_loadu_si128((const __m128i*)(p + 0x00));
+			x2 = _mm_loadu_si128((const __m128i*)(p + 0x10));
+			x3 = _mm_loadu_si128((const __m128i*)(p + 0x20));
+			x4 = _mm_loadu_si128((const __m128i*)(p + 0x30));
+
+			x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+
+			x0 = _mm_load_si128((const __m128i*)k1k2);
+
+			p += 64;
+			size -= 64;
+
+			// Four 128 bits lanes, folded by 512 bits
+			while (size >= 64)
+			{
+				x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+				x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+				x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+				x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+				x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+				x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+				x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+				x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+				y5 = _mm_loadu_si128((const __m128i*)(p + 0x00));
+				y6 = _mm_loadu_si128((const __m128i*)(p + 0x10));
+				y7 = _mm_loadu_si128((const __m128i*)(p + 0x20));
+				y8 = _mm_loadu_si128((const __m128i*)(p + 0x30));
+
+				x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+				x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+				x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+				x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+				p += 64;
+				size -= 64;
+			}
+
+			// Fold the lanes into one
+			x0 = _mm_load_si128((const __m128i*)k3k4);
+
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+			while (size >= 16)
+			{
+				x2 = _mm_loadu_si128((const __m128i*)p);
+
+				x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+				x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+				x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+				p += 16;
+				size -= 16;
+			}
+
+			// 128 -> 64 bits
+			x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+			x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+			x1 = _mm_srli_si128(x1, 8);
+			x1 = _mm_xor_si128(x1, x2);
+
+			x0 = _mm_loadl_epi64((const __m128i*)k5k0);
+
+			x2 = _mm_srli_si128(x1, 4);
+			x1 = _mm_and_si128(x1, x3);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x1 = _mm_xor_si128(x1, x2);
+
+			// Barrett reduction to 32 bits
+			x0 = _mm_load_si128((const __m128i*)poly);
+
+			x2 = _mm_and_si128(x1, x3);
+			x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+			x2 = _mm_and_si128(x2, x3);
+			x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+			x1 = _mm_xor_si128(x1, x2);
+
+			return (uint32_t)_mm_extract_epi32(x1, 1);
+		}
+#endif
+
+		unsigned int compute(unsigned int crc, const void* data, size_t size)
+		{
+			const unsigned char* p = (const unsigned char*)data;
+			if (p == nullptr)
+				return 0;
+
+#if defined(CRC32_ARM)
+			return computeArm(crc, p, size);
+#else
+#if defined(CRC32_PCLMUL)
+			if (size >= 64 && hasPclmul())
+			{
+				size_t blocks = size & ~(size_t)15;
+				crc = ~computePclmul(~(uint32_t)crc, p, blocks);
+
+				p += blocks;
+				size -= blocks;
+			}
+#endif
+			return computeTables(crc, p, size);
+#endif
+		}
+	}
+}
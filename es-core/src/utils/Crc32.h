@@ -0,0 +1,17 @@
+#pragma once
+#ifndef ES_CORE_UTILS_CRC32_H
+#define ES_CORE_UTILS_CRC32_H
+
+#include <cstddef>
+
+namespace Utils
+{
+	// zlib compatible CRC-32 ( same results as mz_crc32 / crc32 ). Uses the ARMv8 CRC instructions when the build targets them,
+	// PCLMULQDQ folding on x86 CPUs that have it, and slicing-by-8 tables otherwise
+	namespace Crc32
+	{
+		unsigned int compute(unsigned int crc, const void* data, size_t size);
+	}
+}
+
+#endif // ES_CORE_UTILS_CRC32_H
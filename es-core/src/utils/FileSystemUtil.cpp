@@ -1,8 +1,10 @@
 #define _FILE_OFFSET_BITS 64
 
 #include "utils/FileSystemUtil.h"
+#include "utils/BinaryStream.h"
 #include "utils/StringUtil.h"
 #include "utils/ZipFile.h"
+#include "utils/Crc32.h"
 #include "utils/md5.h"
 
 #include "Settings.h"
@@ -10,6 +12,7 @@
 #include <string.h>
 #include <algorithm>
 #include <set>
+#include <map>
 
 #if defined(_WIN32)
 // because windows...
@@ -27,22 +30,75 @@
 #else // _WIN32
 #include <dirent.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
 #include <mutex>
+#include <poll.h>
 #endif // _WIN32
 
+#if defined(__linux__)
+#include <sys/statfs.h>
+#include <sys/sysmacros.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#endif
+
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <unordered_map>
+#include <atomic>
+#include <thread>
 
 #include "Paths.h"
+#include "Log.h"
+#include "TaskScheduler.h"
 
 namespace Utils
 {
 	namespace FileSystem
 	{		
+		// inotify watches on the directories listed under the roots ( rom folders ). Their entries stay in the FileCache for the whole session,
+		// the watcher thread forgets them when they change
+		class FileCacheWatch
+		{
+		public:
+			static void addRoot(const std::string& path);
+			static void stop();
+			static int addListener(const std::function<void(const std::string&)>& listener);
+			static void removeListener(int id);
+
+			static bool isActive() { return mActive; }
+			static bool isWatched(const std::string& directory);
+			static bool watch(const std::string& directory);
+
+		private:
+			static void run();
+
+			// Far below the usual max_user_watches, other programs need some
+			static const size_t MAX_WATCHES = 8192;
+
+			static std::mutex mLock;
+			static std::vector<std::string> mRoots;
+			static std::unordered_map<std::string, int> mWatches;
+			static std::unordered_map<int, std::string> mDirectories;
+			static std::atomic<bool> mActive;
+			static std::thread* mThread;
+			// Held while the listeners run : once removeListener returns, the listener won't be called
+			static std::mutex mListenersLock;
+			static std::map<int, std::function<void(const std::string&)>> mListeners;
+			static int mNextListenerId;
+			static int mNotifyFd;
+			static int mWakeFd;
+		};
+
+		// Lookups are spread over shards, so the loading threads don't serialize on a single lock
+		#define FILE_CACHE_SHARDS	16
+
 		struct FileCache
 		{
-			FileCache() {}
+			FileCache() : exists(false), directory(false), hidden(false), isSymLink(false), session(false) {}
 
 			FileCache(bool _exists, bool _dir)
 			{
@@ -50,11 +106,14 @@ namespace Utils
 				exists = _exists;
 				hidden = false;
 				isSymLink = false;
+				session = false;
 			}
 
 #if WIN32			
 			FileCache(DWORD dwFileAttributes)
 			{
+				session = false;
+
 				if (0xFFFFFFFF == dwFileAttributes)
 				{
 					directory = false;
@@ -71,23 +130,13 @@ namespace Utils
 				}
 			}
 #else
-			FileCache(const std::string& name, dirent* entry, bool _hidden)
+			FileCache(bool _dir, bool _symLink, bool _hidden)
 			{
 				exists = true;
+				directory = _dir;
 				hidden = _hidden;
-
-				if (entry->d_type == 10)
-				{
-					struct stat64 info;
-					if (stat64(resolveSymlink(name).c_str(), &info) == 0)
-						directory = S_ISDIR(info.st_mode);
-					else 
-						directory = false;
-				}
-				else
-					directory = (entry->d_type == 4);
-
-				isSymLink = (entry->d_type == 10); // DT_LNK;
+				isSymLink = _symLink;
+				session = false;
 			}
 #endif
 
@@ -95,6 +144,7 @@ namespace Utils
 			bool directory;
 			bool hidden;
 			bool isSymLink;
+			bool session; // In a watched directory : kept outside of the FileSystemCacheActivator scopes
 
 			static int fromStat64(const std::string& key, struct stat64* info)
 			{
@@ -104,7 +154,8 @@ namespace Utils
 				int ret = stat64(key.c_str(), info);
 #endif
 
-				mFileCacheMutex.lock();
+				if (!mEnabled && !FileCacheWatch::isActive())
+					return ret;
 
 				FileCache cache(ret == 0, false);
 				if (cache.exists)
@@ -121,66 +172,447 @@ namespace Utils
 #endif
 				}
 
-				mFileCache[key] = cache;
-
-				mFileCacheMutex.unlock();
-
+				add(key, cache);
 				return ret;
 			}
 
 			static void add(const std::string& key, const FileCache& cache)
 			{
-				if (!mEnabled)
+				if (!mEnabled && !FileCacheWatch::isActive())
+					return;
+
+				FileCache entry = cache;
+				entry.session = FileCacheWatch::isWatched(Utils::FileSystem::getParent(key));
+
+				if (!mEnabled && !entry.session)
 					return;
 
-				mFileCacheMutex.lock();
-				mFileCache[key] = cache;
-				mFileCacheMutex.unlock();
+				Shard& shard = getShard(key);
+				std::unique_lock<std::mutex> lock(shard.lock);
+				shard.entries[key] = entry;
 			}
 
-			static FileCache* get(const std::string& key)
+			// The directory is being enumerated : the files that won't be added don't exist
+			static void addListing(const std::string& path)
 			{
-				if (!mEnabled)
-					return nullptr;
+				FileCache marker(true, true);
+				marker.session = FileCacheWatch::watch(path);
+
+				if (!mEnabled && !marker.session)
+					return;
 
-				std::unique_lock<std::mutex> lock(mFileCacheMutex);
+				std::string key = path + "/*";
+
+				Shard& shard = getShard(key);
+				std::unique_lock<std::mutex> lock(shard.lock);
+				shard.entries[key] = marker;
+			}
+
+			static bool get(const std::string& key, FileCache& cache)
+			{
+				bool enabled = mEnabled;
+				if (!enabled && !FileCacheWatch::isActive())
+					return false;
+
+				{
+					Shard& shard = getShard(key);
+					std::unique_lock<std::mutex> lock(shard.lock);
+
+					auto it = shard.entries.find(key);
+					if (it != shard.entries.cend() && (enabled || it->second.session))
+					{
+						mHits++;
+						cache = it->second;
+						return true;
+					}
+				}
+
+				std::string listingKey = Utils::FileSystem::getParent(key) + "/*";
+
+				bool listed = false;
+				bool session = false;
 
-				if (mFileCache.size())
 				{
-					auto it = mFileCache.find(key);
-					if (it != mFileCache.cend())
-						return &it->second;
+					Shard& shard = getShard(listingKey);
+					std::unique_lock<std::mutex> lock(shard.lock);
 
-					it = mFileCache.find(Utils::FileSystem::getParent(key) + "/*");
-					if (it != mFileCache.cend())
+					auto it = shard.entries.find(listingKey);
+					if (it != shard.entries.cend() && (enabled || it->second.session))
 					{
-						mFileCache[key] = FileCache(false, false);
-						return &mFileCache[key];
+						listed = true;
+						session = it->second.session;
 					}
 				}
 
-				return nullptr;
+				if (listed)
+				{
+					mHits++;
+					cache = FileCache(false, false);
+					cache.session = session;
+
+					Shard& shard = getShard(key);
+					std::unique_lock<std::mutex> lock(shard.lock);
+					shard.entries[key] = cache;
+					return true;
+				}
+
+				mMisses++;
+				return false;
 			}
 
+			// The path changed : forget it, the listing of its parent & everything below it
+			static void invalidate(const std::string& path, bool recursive)
+			{
+				for (auto& key : { path, path + "/*", Utils::FileSystem::getParent(path) + "/*" })
+				{
+					Shard& shard = getShard(key);
+					std::unique_lock<std::mutex> lock(shard.lock);
+					shard.entries.erase(key);
+				}
+
+				if (!recursive)
+					return;
+
+				std::string prefix = path + "/";
+
+				for (int i = 0; i < FILE_CACHE_SHARDS; i++)
+				{
+					std::unique_lock<std::mutex> lock(mShards[i].lock);
+
+					for (auto it = mShards[i].entries.begin(); it != mShards[i].entries.end(); )
+					{
+						if (Utils::String::startsWith(it->first, prefix))
+							it = mShards[i].entries.erase(it);
+						else
+							++it;
+					}
+				}
+			}
+
+			static void clear()
+			{
+				for (int i = 0; i < FILE_CACHE_SHARDS; i++)
+				{
+					std::unique_lock<std::mutex> lock(mShards[i].lock);
+					mShards[i].entries.clear();
+				}
+			}
+
+			// End of the FileSystemCacheActivator scopes : the watched directories stay cached
 			static void resetCache()
 			{
-				mFileCacheMutex.lock();
-				mFileCache.clear();
-				mFileCacheMutex.unlock();
+				for (int i = 0; i < FILE_CACHE_SHARDS; i++)
+				{
+					std::unique_lock<std::mutex> lock(mShards[i].lock);
+
+					for (auto it = mShards[i].entries.begin(); it != mShards[i].entries.end(); )
+					{
+						if (it->second.session)
+							++it;
+						else
+							it = mShards[i].entries.erase(it);
+					}
+				}
 			}
 
 			static inline void setEnabled(bool value) { mEnabled = value; }
-			static inline bool isEnabled() { return mEnabled; }
+			static inline bool isEnabled() { return mEnabled || FileCacheWatch::isActive(); }
+
+			static std::atomic<unsigned long long> mHits;
+			static std::atomic<unsigned long long> mMisses;
 
 		private:
-			static std::unordered_map<std::string, FileCache> mFileCache;
-			static std::mutex mFileCacheMutex;
-			static bool mEnabled;
+			struct Shard
+			{
+				std::mutex lock;
+				std::unordered_map<std::string, FileCache> entries;
+			};
+
+			static Shard& getShard(const std::string& key) { return mShards[std::hash<std::string>()(key) % FILE_CACHE_SHARDS]; }
+
+			static Shard mShards[FILE_CACHE_SHARDS];
+			static std::atomic<bool> mEnabled;
+		};
+
+		FileCache::Shard FileCache::mShards[FILE_CACHE_SHARDS];
+		std::atomic<bool> FileCache::mEnabled(false);
+		std::atomic<unsigned long long> FileCache::mHits(0);
+		std::atomic<unsigned long long> FileCache::mMisses(0);
+
+		// Forgets the path once the operation returned : the watcher would see it a bit later, the caller checks right away
+		struct FileCacheInvalidation
+		{
+			FileCacheInvalidation(const std::string& path, bool recursive) : mPath(path), mRecursive(recursive) { }
+			~FileCacheInvalidation() { FileCache::invalidate(mPath, mRecursive); }
+
+			std::string mPath;
+			bool mRecursive;
 		};
 
-		std::unordered_map<std::string, FileCache> FileCache::mFileCache;
-		std::mutex FileCache::mFileCacheMutex;
-		bool FileCache::mEnabled = false;
+		void getFileCacheStats(unsigned long long& hits, unsigned long long& misses)
+		{
+			hits = FileCache::mHits;
+			misses = FileCache::mMisses;
+		}
+
+	// FileCacheWatch
+
+		std::mutex FileCacheWatch::mLock;
+		std::vector<std::string> FileCacheWatch::mRoots;
+		std::unordered_map<std::string, int> FileCacheWatch::mWatches;
+		std::unordered_map<int, std::string> FileCacheWatch::mDirectories;
+		std::atomic<bool> FileCacheWatch::mActive(false);
+		std::thread* FileCacheWatch::mThread = nullptr;
+		std::mutex FileCacheWatch::mListenersLock;
+		std::map<int, std::function<void(const std::string&)>> FileCacheWatch::mListeners;
+		int FileCacheWatch::mNextListenerId = 0;
+		int FileCacheWatch::mNotifyFd = -1;
+		int FileCacheWatch::mWakeFd = -1;
+
+		void FileCacheWatch::addRoot(const std::string& _path)
+		{
+#if defined(__linux__)
+			std::string path = getGenericPath(_path);
+			if (path.empty() || !Settings::getInstance()->getBool("SessionFileCache"))
+				return;
+
+			std::unique_lock<std::mutex> lock(mLock);
+
+			if (mNotifyFd < 0)
+			{
+				mNotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+				mWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+				if (mNotifyFd < 0 || mWakeFd < 0)
+				{
+					LOG(LogError) << "FileCacheWatch : inotify is not available, the file cache is limited to the loading";
+					return;
+				}
+
+				mThread = new std::thread(&FileCacheWatch::run);
+			}
+
+			if (std::find(mRoots.cbegin(), mRoots.cend(), path) == mRoots.cend())
+				mRoots.push_back(path);
+
+			mActive = true;
+#endif
+		}
+
+		void FileCacheWatch::stop()
+		{
+#if defined(__linux__)
+			std::thread* thread = nullptr;
+
+			{
+				std::unique_lock<std::mutex> lock(mLock);
+				mActive = false;
+				std::swap(thread, mThread);
+
+				if (mWakeFd >= 0)
+				{
+					uint64_t one = 1;
+					if (write(mWakeFd, &one, sizeof(one)) < 0)
+						LOG(LogError) << "FileCacheWatch : Unable to wake the watcher";
+				}
+			}
+
+			if (thread != nullptr)
+			{
+				thread->join();
+				delete thread;
+			}
+
+			std::unique_lock<std::mutex> lock(mLock);
+
+			if (mNotifyFd >= 0)
+				close(mNotifyFd);
+
+			if (mWakeFd >= 0)
+				close(mWakeFd);
+
+			mNotifyFd = mWakeFd = -1;
+			mRoots.clear();
+			mWatches.clear();
+			mDirectories.clear();
+#endif
+			FileCache::clear();
+		}
+
+		int FileCacheWatch::addListener(const std::function<void(const std::string&)>& listener)
+		{
+			std::unique_lock<std::mutex> lock(mListenersLock);
+			int id = ++mNextListenerId;
+			mListeners[id] = listener;
+			return id;
+		}
+
+		void FileCacheWatch::removeListener(int id)
+		{
+			std::unique_lock<std::mutex> lock(mListenersLock);
+			mListeners.erase(id);
+		}
+
+		bool FileCacheWatch::isWatched(const std::string& directory)
+		{
+			if (!mActive)
+				return false;
+
+			std::unique_lock<std::mutex> lock(mLock);
+			return mWatches.find(directory) != mWatches.cend();
+		}
+
+		bool FileCacheWatch::watch(const std::string& directory)
+		{
+			if (!mActive)
+				return false;
+
+#if defined(__linux__)
+			std::unique_lock<std::mutex> lock(mLock);
+
+			if (mWatches.find(directory) != mWatches.cend())
+				return true;
+
+			bool underRoot = false;
+			for (auto& root : mRoots)
+			{
+				if (directory == root || Utils::String::startsWith(directory, root + "/"))
+				{
+					underRoot = true;
+					break;
+				}
+			}
+
+			if (!underRoot || mWatches.size() >= MAX_WATCHES)
+				return false;
+
+			// Only what changes the existence of the entries : the cache doesn't hold sizes or dates
+			int wd = inotify_add_watch(mNotifyFd, directory.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+			if (wd < 0)
+			{
+				if (errno == ENOSPC)
+					LOG(LogWarning) << "FileCacheWatch : no more inotify watches, " << directory << " is not cached";
+
+				return false;
+			}
+
+			mWatches[directory] = wd;
+			mDirectories[wd] = directory;
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		void FileCacheWatch::run()
+		{
+#if defined(__linux__)
+			TaskScheduler::setCurrentThreadPriority(TaskScheduler::BACKGROUND);
+
+			alignas(struct inotify_event) char buffer[16384];
+
+			while (true)
+			{
+				struct pollfd fds[2];
+				fds[0].fd = mNotifyFd;
+				fds[0].events = POLLIN;
+				fds[1].fd = mWakeFd;
+				fds[1].events = POLLIN;
+
+				if (poll(fds, 2, -1) < 0)
+				{
+					if (errno == EINTR)
+						continue;
+
+					break;
+				}
+
+				if (fds[1].revents & POLLIN)
+					break;
+
+				ssize_t len;
+				while ((len = read(mNotifyFd, buffer, sizeof(buffer))) > 0)
+				{
+					for (char* ptr = buffer; ptr < buffer + len; )
+					{
+						struct inotify_event* event = (struct inotify_event*)ptr;
+						ptr += sizeof(struct inotify_event) + event->len;
+
+						if (event->mask & IN_Q_OVERFLOW)
+						{
+							// Events were lost : nothing watched can be trusted anymore
+							LOG(LogWarning) << "FileCacheWatch : inotify queue overflow, dropping the file cache";
+							FileCache::clear();
+							continue;
+						}
+
+						std::string directory;
+
+						{
+							std::unique_lock<std::mutex> lock(mLock);
+
+							auto it = mDirectories.find(event->wd);
+							if (it == mDirectories.cend())
+								continue;
+
+							directory = it->second;
+
+							if (event->mask & IN_IGNORED)
+							{
+								mWatches.erase(directory);
+								mDirectories.erase(it);
+							}
+						}
+
+						std::string path = directory;
+
+						if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))
+							FileCache::invalidate(directory, true);
+						else if (event->len > 0)
+						{
+							path = directory + "/" + std::string(event->name);
+							FileCache::invalidate(path, (event->mask & IN_ISDIR) != 0);
+						}
+						else
+							continue;
+
+						// IN_IGNORED follows the removal, which was already reported
+						if (event->mask & IN_IGNORED)
+							continue;
+
+						std::unique_lock<std::mutex> lock(mListenersLock);
+						for (auto& listener : mListeners)
+							listener.second(path);
+					}
+				}
+			}
+#endif
+		}
+
+		void watchFileCacheRoot(const std::string& path)
+		{
+			FileCacheWatch::addRoot(path);
+		}
+
+		int addFileCacheWatchListener(const std::function<void(const std::string& path)>& listener)
+		{
+			return FileCacheWatch::addListener(listener);
+		}
+
+		void removeFileCacheWatchListener(int id)
+		{
+			FileCacheWatch::removeListener(id);
+		}
+
+		bool isFileCacheWatched(const std::string& directory)
+		{
+			return FileCacheWatch::isWatched(getGenericPath(directory));
+		}
+
+		void stopFileCacheWatch()
+		{
+			FileCacheWatch::stop();
+		}
 
 	// FileSystemCacheActivator
 
@@ -210,6 +642,83 @@ namespace Utils
 
 	// Methods
 
+#if !defined(_WIN32)
+		// getdents64 batch size : a 50k entries folder is read in a handful of calls ( glibc's readdir uses 32KB )
+		#define DIRENT_BUFFER_SIZE	(256 * 1024)
+
+		// Type of an entry the file system didn't type ( DT_UNKNOWN ), or the target of a link. Only asks for the type, without revalidating the attributes on NFS/CIFS
+		static unsigned char getEntryType(int dirFd, const char* name, bool followLink)
+		{
+#if defined(STATX_TYPE)
+			struct statx stx;
+			if (statx(dirFd, name, (followLink ? 0 : AT_SYMLINK_NOFOLLOW) | AT_STATX_DONT_SYNC, STATX_TYPE, &stx) == 0 && (stx.stx_mask & STATX_TYPE))
+				return IFTODT(stx.stx_mode);
+#endif
+			struct stat info;
+			if (fstatat(dirFd, name, &info, followLink ? 0 : AT_SYMLINK_NOFOLLOW) == 0)
+				return IFTODT(info.st_mode);
+
+			return DT_UNKNOWN;
+		}
+
+		static void enumerateEntry(int dirFd, const char* name, unsigned char type, const std::function<void(const char*, bool, bool)>& func)
+		{
+			// ignore "." and ".."
+			if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+				return;
+
+			if (type == DT_UNKNOWN)
+				type = getEntryType(dirFd, name, false);
+
+			bool isSymLink = (type == DT_LNK);
+			if (isSymLink)
+				type = getEntryType(dirFd, name, true);
+
+			func(name, type == DT_DIR, isSymLink);
+		}
+
+		// Lists a directory from the d_type of its entries : the links & the file systems which don't fill d_type cost a statx, the others nothing.
+		// func(name, directory, symlink). Returns false if the directory can't be opened
+		static bool enumerateDirectory(const std::string& path, const std::function<void(const char*, bool, bool)>& func)
+		{
+#if defined(__linux__)
+			int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			if (fd < 0)
+				return false;
+
+			std::vector<char> buffer(DIRENT_BUFFER_SIZE);
+
+			while (true)
+			{
+				long count = syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+				if (count <= 0)
+					break;
+
+				for (long pos = 0; pos < count; )
+				{
+					struct dirent64* entry = (struct dirent64*)(buffer.data() + pos);
+					pos += entry->d_reclen;
+
+					enumerateEntry(fd, entry->d_name, entry->d_type, func);
+				}
+			}
+
+			close(fd);
+#else
+			DIR* dir = opendir(path.c_str());
+			if (dir == NULL)
+				return false;
+
+			struct dirent* entry;
+			while ((entry = readdir(dir)) != NULL)
+				enumerateEntry(dirfd(dir), entry->d_name, entry->d_type, func);
+
+			closedir(dir);
+#endif
+			return true;
+		}
+#endif // !_WIN32
+
 		stringList getDirContent(const std::string& _path, const bool _recursive, const bool includeHidden)
 		{
 			std::string path = getGenericPath(_path);
@@ -219,7 +728,7 @@ namespace Utils
 			if(isDirectory(path))
 			{
 				// tell filecache we enumerated the folder
-				FileCache::add(path + "/*", FileCache(true, true));
+				FileCache::addListing(path);
 
 #if defined(_WIN32)
 				WIN32_FIND_DATAW findData;
@@ -259,40 +768,24 @@ namespace Utils
 					FindClose(hFind);
 				}
 #else // _WIN32
-				DIR* dir = opendir(path.c_str());
-
-				if(dir != NULL)
+				enumerateDirectory(path, [&](const char* name, bool directory, bool isSymLink)
 				{
-					struct dirent* entry;
+					std::string fullName(getGenericPath(path + "/" + name));
 
-					// loop over all files in the directory
-					while((entry = readdir(dir)) != NULL)
-					{
-						std::string name(entry->d_name);
+					FileCache cache(directory, isSymLink, name[0] == '.');
+					FileCache::add(fullName, cache);
 
-						// ignore "." and ".."
-						if((name != ".") && (name != ".."))
-						{
-							std::string fullName(getGenericPath(path + "/" + name));
+					if (!includeHidden && cache.hidden)
+						return;
 
-							FileCache cache(fullName, entry, getFileName(fullName)[0] == '.');
-							FileCache::add(fullName, cache);
+					contentList.push_back(fullName);
 
-							if (!includeHidden && cache.hidden)
-								continue;
-
-							contentList.push_back(fullName);
-
-							if (_recursive && cache.directory)
-							{
-								for (auto item : getDirContent(fullName, true, includeHidden))
-									contentList.push_back(item);
-							}
-						}
+					if (_recursive && cache.directory)
+					{
+						for (auto item : getDirContent(fullName, true, includeHidden))
+							contentList.push_back(item);
 					}
-
-					closedir(dir);
-				}
+				});
 #endif // _WIN32
 
 			}
@@ -322,7 +815,7 @@ namespace Utils
 			fileList  contentList;
 
 			// tell filecache we enumerated the folder
-			FileCache::add(path + "/*", FileCache(true, true));
+			FileCache::addListing(path);
 
 			// only parse the directory, if it's a directory
 			// if (isDirectory(path))
@@ -389,54 +882,186 @@ namespace Utils
 					FindClose(hFind);
 				}
 #else // _WIN32
-				DIR* dir = opendir(path.c_str());
-
-				if (dir != NULL)
+				enumerateDirectory(path, [&](const char* name, bool directory, bool isSymLink)
 				{
-					struct dirent* entry;
+					FileInfo fi;
+					fi.path = getGenericPath(path + "/" + name);
+					fi.hidden = (name[0] == '.'); // same as isHidden, without a cache lookup
+					fi.directory = directory;
+
+					FileCache::add(fi.path, FileCache(fi.directory, isSymLink, fi.hidden));
+					contentList.push_back(fi);
+				});
+#endif // _WIN32
 
-					// loop over all files in the directory
-					while ((entry = readdir(dir)) != NULL)
-					{
-						std::string name(entry->d_name);
+			}
 
-						// ignore "." and ".."
-						if ((name != ".") && (name != ".."))
-						{
-							std::string fullName(getGenericPath(path + "/" + name));
+			// return the content list
+			return contentList;
 
-							FileInfo fi;
-							fi.path = fullName;
-							fi.hidden = Utils::FileSystem::isHidden(fullName);
+		} // getDirectoryFiles
 
-							if (entry->d_type == 10) // DT_LNK
-							{
-								struct stat64 si;
-								if (stat64(resolveSymlink(fullName).c_str(), &si) == 0)
-									fi.directory = S_ISDIR(si.st_mode);
-								else
-									fi.directory = false;
-							}
-							else
-								fi.directory = (entry->d_type == 4); // DT_DIR;
+		// Registers a directory listing obtained elsewhere ( persisted manifest ) as if getDirectoryFiles had enumerated it
+		void addDirectoryFilesToCache(const std::string& _path, const fileList& files)
+		{
+			if (!FileCache::isEnabled())
+				return;
 
-							FileCache::add(fullName, FileCache(fullName, entry, fi.hidden));
+			std::string path = getGenericPath(_path);
+			FileCache::addListing(path);
 
-							//DT_LNK
-							contentList.push_back(fi);
-						}
-					}
+			for (auto& fi : files)
+			{
+				FileCache cache(true, fi.directory);
+				cache.hidden = fi.hidden;
+				FileCache::add(fi.path, cache);
+			}
+		}
 
-					closedir(dir);
-				}
-#endif // _WIN32
+		// Modification time of a directory ( in nanoseconds when available ) + inode. Not cached : used to detect changes
+		bool getDirectoryStamp(const std::string& _path, long long& modificationTime, unsigned long long& inode)
+		{
+			std::string path = getGenericPath(_path);
+			struct stat64 info;
+
+#if defined(_WIN32)
+			if (_wstat64(Utils::String::convertToWideString(path).c_str(), &info) != 0 || !S_ISDIR(info.st_mode))
+				return false;
+
+			modificationTime = (long long)info.st_mtime * 1000000000LL;
+#else
+			if (stat64(path.c_str(), &info) != 0 || !S_ISDIR(info.st_mode))
+				return false;
 
+#if defined(__APPLE__)
+			modificationTime = (long long)info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+			modificationTime = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+#endif
+			inode = (unsigned long long)info.st_ino;
+			return true;
+		}
+
+#if defined(__linux__)
+		// queue/rotational of the disk : partitions have no queue, their disk is the parent folder in sysfs
+		static bool isRotationalDevice(unsigned int major, unsigned int minor)
+		{
+			std::string block = "/sys/dev/block/" + std::to_string(major) + ":" + std::to_string(minor);
+
+			for (auto path : { block + "/queue/rotational", block + "/../queue/rotational" })
+			{
+				FILE* file = fopen(path.c_str(), "r");
+				if (file == nullptr)
+					continue;
+
+				int rotational = fgetc(file);
+				fclose(file);
+				return rotational == '1';
 			}
 
-			// return the content list
-			return contentList;
+			return false;
+		}
 
-		} // getDirectoryFiles
+		static bool isNetworkFileSystem(const std::string& path)
+		{
+			struct statfs info;
+			if (statfs(path.c_str(), &info) != 0)
+				return false;
+
+			switch ((unsigned int)info.f_type)
+			{
+			case 0x6969:		// NFS
+			case 0x517B:		// SMB
+			case 0xFF534D42:	// CIFS
+			case 0xFE534D42:	// SMB2
+				return true;
+			}
+
+			return false;
+		}
+#endif
+
+		StorageDevice getStorageDevice(const std::string& _path)
+		{
+			static std::mutex devicesLock;
+			static std::map<unsigned long long, bool> devices;
+
+			StorageDevice device;
+			device.id = 0;
+			device.sequential = false;
+
+			std::string path = getGenericPath(_path);
+
+#if defined(_WIN32)
+			if (path.size() < 2 || path[1] != ':')
+				return device;
+
+			device.id = (unsigned long long)toupper(path[0]);
+
+			std::unique_lock<std::mutex> lock(devicesLock);
+
+			auto it = devices.find(device.id);
+			if (it == devices.cend())
+			{
+				// The seek penalty of the local drives is not known without opening the volume
+				std::string root = path.substr(0, 2) + "\\";
+				it = devices.insert(std::make_pair(device.id, GetDriveTypeW(Utils::String::convertToWideString(root).c_str()) == DRIVE_REMOTE)).first;
+			}
+
+			device.sequential = it->second;
+#else
+			struct stat64 info;
+			if (stat64(path.c_str(), &info) != 0)
+				return device;
+
+			device.id = (unsigned long long)info.st_dev;
+
+			std::unique_lock<std::mutex> lock(devicesLock);
+
+			auto it = devices.find(device.id);
+			if (it == devices.cend())
+			{
+#if defined(__linux__)
+				// No block device behind ( major 0 ) : network shares, tmpfs, overlays
+				bool sequential = major(info.st_dev) == 0 ? isNetworkFileSystem(path) : isRotationalDevice(major(info.st_dev), minor(info.st_dev));
+#else
+				bool sequential = false;
+#endif
+				it = devices.insert(std::make_pair(device.id, sequential)).first;
+
+				if (sequential)
+					LOG(LogInfo) << "Storage device of " << path << " is read sequentially";
+			}
+
+			device.sequential = it->second;
+#endif
+			return device;
+		}
+
+		bool getFileStamp(const std::string& _path, long long& modificationTime, unsigned long long& size)
+		{
+			std::string path = getGenericPath(_path);
+			struct stat64 info;
+
+#if defined(_WIN32)
+			if (_wstat64(Utils::String::convertToWideString(path).c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+				return false;
+
+			modificationTime = (long long)info.st_mtime * 1000000000LL;
+#else
+			if (stat64(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+				return false;
+
+#if defined(__APPLE__)
+			modificationTime = (long long)info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+			modificationTime = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+#endif
+			size = (unsigned long long)info.st_size;
+			return true;
+		}
 
 		std::vector<std::string> getPathList(const std::string& _path)
 		{
@@ -891,6 +1516,8 @@ namespace Utils
 			if (!exists(path))
 				return true;
 
+			FileCacheInvalidation invalidation(path, true);
+
 #if WIN32			
 			return RemoveDirectoryW(Utils::String::convertToWideString(getPreferredPath(_path)).c_str());
 #else
@@ -906,6 +1533,8 @@ namespace Utils
 			if(!exists(path))
 				return true;
 
+			FileCacheInvalidation invalidation(path, isDirectory(path));
+
 #if WIN32			
 			if (isDirectory(_path))
 				return RemoveDirectoryW(Utils::String::convertToWideString(getPreferredPath(_path)).c_str());
@@ -935,6 +1564,8 @@ namespace Utils
 			if(exists(path))
 				return true;
 
+			FileCacheInvalidation invalidation(path, false);
+
 #ifdef WIN32	
 			if (::CreateDirectoryW(Utils::String::convertToWideString(_path).c_str(), nullptr))
 				return true;
@@ -961,9 +1592,9 @@ namespace Utils
 			if (_path.empty())
 				return false;
 
-			auto it = FileCache::get(_path);
-			if (it != nullptr)
-				return it->exists;
+			FileCache cache;
+			if (FileCache::get(_path, cache))
+				return cache.exists;
 
 #ifdef WIN32			
 			if (!FileCache::isEnabled())
@@ -1000,9 +1631,9 @@ namespace Utils
 
 		bool isRegularFile(const std::string& _path)
 		{
-			auto it = FileCache::get(_path);
-			if (it != nullptr)
-				return it->exists && !it->directory && !it->isSymLink;
+			FileCache cache;
+			if (FileCache::get(_path, cache))
+				return cache.exists && !cache.directory && !cache.isSymLink;
 
 			std::string path = getGenericPath(_path);
 			struct stat64 info;
@@ -1018,9 +1649,9 @@ namespace Utils
 
 		bool isDirectory(const std::string& _path)
 		{
-			auto it = FileCache::get(_path);
-			if (it != nullptr)
-				return it->exists && it->directory;
+			FileCache cache;
+			if (FileCache::get(_path, cache))
+				return cache.exists && cache.directory;
 
 #ifdef WIN32
 			// check for symlink attribute
@@ -1049,9 +1680,9 @@ namespace Utils
 		bool isSymlink(const std::string& _path)
 		{
 		
-			auto it = FileCache::get(_path);
-			if (it != nullptr)
-				return it->exists && it->isSymLink;
+			FileCache cache;
+			if (FileCache::get(_path, cache))
+				return cache.exists && cache.isSymLink;
 				
 			std::string path = getGenericPath(_path);
 
@@ -1079,9 +1710,9 @@ namespace Utils
 
 		bool isHidden(const std::string& _path)
 		{
-			auto it = FileCache::get(_path);
-			if (it != nullptr)
-				return it->exists && it->hidden;
+			FileCache cache;
+			if (FileCache::get(_path, cache))
+				return cache.exists && cache.hidden;
 
 			std::string path = getGenericPath(_path);
 
@@ -1229,6 +1860,8 @@ namespace Utils
 			if (file == nullptr)
 				return;		
 
+			FileCacheInvalidation invalidation(getGenericPath(fileName), false);
+
 			void* buffer = (void*) text.data();
 			size_t size = text.size();
 
@@ -1242,17 +1875,51 @@ namespace Utils
 			if (!exists(path))
 				return true;
 
-			if (overWrite && Utils::FileSystem::exists(dst))
-				Utils::FileSystem::removeFile(dst);
-
+			FileCacheInvalidation invalidation(path, isDirectory(path));
+			FileCacheInvalidation dstInvalidation(getGenericPath(dst), false);
 
+			// Replacing is atomic on both platforms : dst is never missing, even if we're interrupted
 #if WIN32			
-			return MoveFileW(Utils::String::convertToWideString(path).c_str(), Utils::String::convertToWideString(dst).c_str());
+			return MoveFileExW(Utils::String::convertToWideString(path).c_str(), Utils::String::convertToWideString(dst).c_str(), overWrite ? MOVEFILE_REPLACE_EXISTING : 0);
 #else
+			if (!overWrite && Utils::FileSystem::exists(dst))
+				return false;
+
 			return std::rename(src.c_str(), dst.c_str()) == 0;
 #endif
 		}
 
+		bool writeFileAtomic(const std::string& fileName, const char* data, size_t size, bool concurrentWriters)
+		{
+			std::string folder = getParent(fileName);
+			if (!exists(folder))
+				createDirectory(folder);
+
+			std::string tmpPath = fileName + ".tmp";
+			if (concurrentWriters)
+				tmpPath = fileName + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+			std::ofstream stream(WINSTRINGW(tmpPath), std::ios::binary | std::ios::trunc);
+			if (!stream.is_open())
+				return false;
+
+			stream.write(data, size);
+			stream.close();
+
+			if (stream.fail() || !renameFile(tmpPath, fileName))
+			{
+				removeFile(tmpPath);
+				return false;
+			}
+
+			return true;
+		}
+
+		bool writeFileAtomic(const std::string& fileName, const Utils::BinaryWriter& writer, bool concurrentWriters)
+		{
+			return writeFileAtomic(fileName, writer.buffer().data(), writer.size(), concurrentWriters);
+		}
+
 		bool copyFile(const std::string src, const std::string dst)
 		{
 			std::string path = getGenericPath(src);
@@ -1286,6 +1953,8 @@ namespace Utils
 				return false;
 			}
 
+			FileCacheInvalidation invalidation(pathD, false);
+
 			while (size = fread(buf, 1, 512, source))
 				fwrite(buf, 1, size, dest);
 
@@ -1406,80 +2075,123 @@ namespace Utils
 			return pdfpath;
 		}
 		
-		std::string getFileCrc32(const std::string& filename)
-		{
-			std::string hex;
+		// Retroarch CRC calculations are limited in size. See encoding_crc32.c
+		#define CRC32_MAX_SIZE (64 * 1024 * 1024)
+		#define HASH_BLOCK_SIZE (4 * 1024 * 1024)
 
+		// Reads the file by large blocks, as a sequential access. Stops when onBlock returns false
+		static bool readFileBlocks(const std::string& filename, const std::function<bool(const char*, size_t)>& onBlock)
+		{
 #if defined(_WIN32)
 			FILE* file = _wfopen(Utils::String::convertToWideString(filename).c_str(), L"rb");
-#else			
-			FILE* file = fopen(filename.c_str(), "rb");
+			if (file == nullptr)
+				return false;
+
+			setvbuf(file, nullptr, _IONBF, 0);
+#else
+			int fd = open(filename.c_str(), O_RDONLY);
+			if (fd < 0)
+				return false;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+			posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
 #endif
-			if (file)
+			char* buffer = new char[HASH_BLOCK_SIZE];
+			bool ok = true;
+
+			while (true)
 			{
-				// Retroarch CRC calculations are limited in size. See encoding_crc32.c
-				#define CRC32_BUFFER_SIZE 1048576
-				#define CRC32_MAX_MB 64
+#if defined(_WIN32)
+				size_t size = fread(buffer, 1, HASH_BLOCK_SIZE, file);
+				if (size == 0)
+				{
+					ok = !ferror(file);
+					break;
+				}
+#else
+				ssize_t size = read(fd, buffer, HASH_BLOCK_SIZE);
+				if (size < 0 && errno == EINTR)
+					continue;
 
-				char* buffer = new char[CRC32_BUFFER_SIZE];
-				if (buffer)
+				if (size <= 0)
 				{
-					size_t size;
-					unsigned int file_crc32 = 0;
+					ok = (size == 0);
+					break;
+				}
+#endif
+				if (!onBlock(buffer, (size_t)size))
+					break;
+			}
 
-					for (int i = 0; i < CRC32_MAX_MB; i++)
-					{
-						size = fread(buffer, 1, CRC32_BUFFER_SIZE, file);
-						if (size == 0)
-							break;
+			delete[] buffer;
 
-						file_crc32 = Utils::Zip::ZipFile::computeCRC(file_crc32, buffer, size);
-					}
+#if defined(_WIN32)
+			fclose(file);
+#else
+			close(fd);
+#endif
+			return ok;
+		}
 
-					hex = Utils::String::toHexString(file_crc32);
+		std::string getFileCrc32(const std::string& filename)
+		{
+			unsigned int file_crc32 = 0;
+			size_t total = 0;
 
-					delete buffer;
-				}
+			bool ok = readFileBlocks(filename, [&file_crc32, &total](const char* data, size_t size)
+			{
+				size = std::min(size, (size_t)CRC32_MAX_SIZE - total);
+				file_crc32 = Utils::Crc32::compute(file_crc32, data, size);
+				total += size;
+				return total < CRC32_MAX_SIZE;
+			});
 
-				fclose(file);
-			}
+			if (!ok)
+				return "";
 
-			return hex;
+			return Utils::String::toHexString(file_crc32);
 		}
 
 		std::string getFileMd5(const std::string& filename)
 		{
-			std::string hex;
+			MD5 md5;
 
-#if defined(_WIN32)
-			FILE* file = _wfopen(Utils::String::convertToWideString(filename).c_str(), L"rb");
-#else			
-			FILE* file = fopen(filename.c_str(), "rb");
-#endif
-			if (file)
-			{
-				#define CRCBUFFERSIZE 64 * 1024
-				char* buffer = new char[CRCBUFFERSIZE];
-
-				if (buffer)
-				{
-					MD5 md5;
+			if (!readFileBlocks(filename, [&md5](const char* data, size_t size) { md5.update(data, (MD5::size_type)size); return true; }))
+				return "";
 
-					size_t size;
-					while (size = fread(buffer, 1, CRCBUFFERSIZE, file))
-						md5.update(buffer, size);
+			md5.finalize();
+			return md5.hexdigest();
+		}
 
-					md5.finalize();
-					hex = md5.hexdigest();
+		bool getFileCrc32AndMd5(const std::string& filename, std::string& crc32, std::string& md5)
+		{
+			unsigned int file_crc32 = 0;
+			size_t total = 0;
+			MD5 hash;
 
-					delete buffer;
+			bool ok = readFileBlocks(filename, [&file_crc32, &total, &hash](const char* data, size_t size)
+			{
+				if (total < CRC32_MAX_SIZE)
+				{
+					size_t crcSize = std::min(size, (size_t)CRC32_MAX_SIZE - total);
+					file_crc32 = Utils::Crc32::compute(file_crc32, data, crcSize);
+					total += crcSize;
 				}
 
-				fclose(file);
-			}
+				hash.update(data, (MD5::size_type)size);
+				return true;
+			});
+
+			if (!ok)
+				return false;
 
-			return hex;
-		}		
+			hash.finalize();
+
+			crc32 = Utils::String::toHexString(file_crc32);
+			md5 = hash.hexdigest();
+			return true;
+		}
 
 		static std::set<std::string> _imageExtensions = { ".jpg", ".png", ".jpeg", ".gif" };
 		static std::set<std::string> _videoExtensions = { ".mp4", ".avi", ".mkv", ".webm" };
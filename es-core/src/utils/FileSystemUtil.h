@@ -2,6 +2,7 @@
 #ifndef ES_CORE_UTILS_FILE_SYSTEM_UTIL_H
 #define ES_CORE_UTILS_FILE_SYSTEM_UTIL_H
 
+#include <functional>
 #include <list>
 #include <string>
 #include <vector>
@@ -9,6 +10,8 @@
 
 namespace Utils
 {
+	class BinaryWriter;
+
 	namespace FileSystem
 	{
 		typedef std::list<std::string> stringList;
@@ -57,6 +60,18 @@ namespace Utils
 		typedef std::list<FileInfo> fileList;
 
 		fileList	getDirectoryFiles(const std::string& _path);
+		void		addDirectoryFilesToCache(const std::string& _path, const fileList& files);
+		bool		getDirectoryStamp(const std::string& _path, long long& modificationTime, unsigned long long& inode);
+		bool		getFileStamp(const std::string& _path, long long& modificationTime, unsigned long long& size);
+
+		struct StorageDevice
+		{
+			unsigned long long id;	// st_dev, or the drive on Windows
+			bool sequential;		// Spinning disk or network share : parallel reads make it seek between the files
+		};
+
+		// Looked up once per device
+		StorageDevice getStorageDevice(const std::string& _path);
 		std::string combine(const std::string& _path, const std::string& filename);
 		unsigned long long	getFileSize(const std::string& _path);
 
@@ -69,6 +84,11 @@ namespace Utils
 		void		deleteDirectoryFiles(const std::string path, bool deleteDirectory = false);
 		bool		renameFile(const std::string src, const std::string dst, bool overWrite = true);
 
+		// Writes a temporary file renamed over fileName : readers find the previous content or the new one, never a part of it.
+		// The folder is created. concurrentWriters gives each thread its own temporary file. False if fileName is unchanged
+		bool		writeFileAtomic(const std::string& fileName, const char* data, size_t size, bool concurrentWriters = false);
+		bool		writeFileAtomic(const std::string& fileName, const Utils::BinaryWriter& writer, bool concurrentWriters = false);
+
 		std::string megaBytesToString(unsigned long size);
 		std::string kiloBytesToString(unsigned long size);
 
@@ -81,9 +101,23 @@ namespace Utils
 
 		std::string getFileCrc32(const std::string& filename);
 		std::string getFileMd5(const std::string& filename);
+		bool		getFileCrc32AndMd5(const std::string& filename, std::string& crc32, std::string& md5); // Single read of the file for both. The crc covers the same 64 MB as getFileCrc32
 
 		std::string changeExtension(const std::string& _path, const std::string& extension);
 
+		// Lookups answered by the file cache, since startup
+		void		getFileCacheStats(unsigned long long& hits, unsigned long long& misses);
+
+		// The directories listed below path stay in the file cache for the whole session, inotify tells when they change ( Linux, "SessionFileCache" setting ).
+		// Outside of them, the cache only lives in the FileSystemCacheActivator scopes
+		void		watchFileCacheRoot(const std::string& path);
+		void		stopFileCacheWatch();
+		// Called from the watcher thread with each path created, removed or moved in the watched directories. Returns an id for removeFileCacheWatchListener
+		int			addFileCacheWatchListener(const std::function<void(const std::string& path)>& listener);
+		void		removeFileCacheWatchListener(int id);
+		// The directory has been listed, and inotify reports its changes
+		bool		isFileCacheWatched(const std::string& directory);
+
 		class FileSystemCacheActivator
 		{
 		public:
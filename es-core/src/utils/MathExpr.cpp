@@ -11,6 +11,7 @@
 #include <stdexcept>
 #include <math.h>
 #include <stdio.h>
+#include <algorithm>
 
 #include "MathExpr.h"
 
@@ -57,8 +58,14 @@ namespace Utils
 
 #define isvariablechar(c) (isalpha(c) || c == '_')
 
-	MathExpr::ValuePtrQueue MathExpr::toRPN(const char* expr, ValueMap* vars, IntMap opPrecedence)
+	MathExpr::ValuePtrQueue MathExpr::toRPN(const char* expr, std::vector<std::string>& slotNames, bool appendSlots, bool& hasNames) const
 	{
+		auto precedence = [this](const std::string& op)
+		{
+			auto it = opPrecedence.find(op);
+			return it == opPrecedence.cend() ? 0 : it->second;
+		};
+
 		ValuePtrQueue rpnQueue; std::stack<std::string> operatorStack;
 		bool lastTokenWasOp = true;
 
@@ -80,10 +87,8 @@ namespace Utils
 			}
 			else if (isvariablechar(*expr) || *expr == '{' || *expr == '$')
 			{
-				// If the function is a variable, resolve it and
-				// add the parsed number to the output queue.
-				if (!vars)
-					throw std::domain_error("Detected variable, but the variable map is null.");
+				// If the function is a variable, add its slot to the output queue.
+				hasNames = true;
 
 				std::stringstream ss;
 
@@ -119,11 +124,19 @@ namespace Utils
 				else if (key == "false")
 					rpnQueue.push(new Value(0));
 				else {
-					ValueMap::iterator it = vars->find(key);
-					if (it == vars->end())
-						throw std::domain_error("Unable to find the variable '" + key + "'.");
+					auto slot = std::find(slotNames.cbegin(), slotNames.cend(), key);
+					if (slot == slotNames.cend())
+					{
+						if (!appendSlots)
+							throw std::domain_error("Unable to find the variable '" + key + "'.");
+
+						slotNames.push_back(key);
+						slot = slotNames.cend() - 1;
+					}
 
-					rpnQueue.push(new Value(it->second));
+					Value* value = new Value(key, VARIABLE);
+					value->number = (float)(slot - slotNames.cbegin());
+					rpnQueue.push(value);
 				}
 
 				lastTokenWasOp = false;
@@ -198,7 +211,7 @@ namespace Utils
 
 					}
 
-					while (!operatorStack.empty() && opPrecedence[str] <= opPrecedence[operatorStack.top()])
+					while (!operatorStack.empty() && precedence(str) <= precedence(operatorStack.top()))
 					{
 						rpnQueue.push(new Value(operatorStack.top(), TOKEN));
 						operatorStack.pop();
@@ -218,99 +231,223 @@ namespace Utils
 		return rpnQueue;
 	}
 
+	int MathExpr::getOpcode(const std::string& str)
+	{
+		static const std::map<std::string, int> opcodes =
+		{
+			{ "+", OP_ADD }, { "*", OP_MUL }, { "-", OP_SUB }, { "/", OP_DIV }, { "<<", OP_SHL }, { "^", OP_POW }, { ">>", OP_SHR },
+			{ ">", OP_GT }, { ">=", OP_GE }, { "<", OP_LT }, { "<=", OP_LE }, { "&&", OP_AND }, { "||", OP_OR },
+			{ "==", OP_EQ }, { "!=", OP_NE }, { "!", OP_NOT }
+		};
+
+		auto it = opcodes.find(str);
+		return it == opcodes.cend() ? OP_UNKNOWN : it->second;
+	}
+
+	void MathExpr::applyOperator(const Value& op, std::vector<Value>& evaluation)
+	{
+		if (evaluation.size() < 2) {
+			throw std::domain_error("Invalid equation.");
+		}
+		Value right = std::move(evaluation.back()); evaluation.pop_back();
+		Value left = std::move(evaluation.back()); evaluation.pop_back();
+
+		int code = (int)op.number;
+		if (code == OP_ADD && left.isNumber())
+			evaluation.push_back(left.number + right.toNumber());
+		else if (code == OP_ADD && left.isString())
+			evaluation.push_back(left.string + right.toString());
+		else if (code == OP_MUL)
+			evaluation.push_back(left.toNumber() * right.toNumber());
+		else if (code == OP_SUB)
+			evaluation.push_back(left.toNumber() - right.toNumber());
+		else if (code == OP_DIV)
+		{
+			float r = right.toNumber();
+			if (r == 0)
+				evaluation.push_back(0.0f);
+			else
+				evaluation.push_back(left.toNumber() / r);
+		}
+		else if (code == OP_SHL)
+			evaluation.push_back((float)((int)left.toNumber() << (int)right.toNumber()));
+		else if (code == OP_POW)
+			evaluation.push_back((float)pow(left.toNumber(), right.toNumber()));
+		else if (code == OP_SHR)
+			evaluation.push_back((float)((int)left.toNumber() >> (int)right.toNumber()));
+		else if (code == OP_GT)
+			evaluation.push_back(left.toNumber() > right.toNumber());
+		else if (code == OP_GE)
+			evaluation.push_back(left.toNumber() >= right.toNumber());
+		else if (code == OP_LT)
+			evaluation.push_back(left.toNumber() < right.toNumber());
+		else if (code == OP_LE)
+			evaluation.push_back(left.toNumber() <= right.toNumber());
+		else if (code == OP_AND)
+			evaluation.push_back(left.toNumber() && right.toNumber());
+		else if (code == OP_OR)
+			evaluation.push_back(left.toNumber() || right.toNumber());
+		else if (code == OP_EQ)
+		{
+			if (left.isNumber() && right.isNumber())
+				evaluation.push_back(left.number == right.number);
+			else if (left.isString() && right.isString())
+				evaluation.push_back(left.string == right.string);
+			else if (left.isString())
+				evaluation.push_back(left.string == right.toString());
+			else
+				evaluation.push_back(left.toNumber() == right.toNumber());
+		}
+		else if (code == OP_NE)
+		{
+			if (left.isNumber() && right.isNumber())
+				evaluation.push_back(left.number != right.number);
+			else if (left.isString() && right.isString())
+				evaluation.push_back(left.string != right.string);
+			else if (left.isString())
+				evaluation.push_back(left.string != right.toString());
+			else
+				evaluation.push_back(left.toNumber() != right.toNumber());
+		}
+		else if (code == OP_NOT)
+			evaluation.push_back(!right.toNumber());
+		else
+			throw std::domain_error("Unknown operator: " + left.toString() + " " + op.string + " " + right.toString() + ".");
+	}
+
 	MathExpr::Value MathExpr::eval(const char* expr, ValueMap* vars) 
+	{
+		auto it = mPrograms.find(expr);
+		if (it == mPrograms.cend())
+		{
+			// Themes have a bounded set of expressions, this only protects against generated ones
+			if (mPrograms.size() >= 1024)
+				mPrograms.clear();
+
+			it = mPrograms.insert(std::pair<std::string, Program>(expr, compile(expr))).first;
+		}
+
+		const Program& program = it->second;
+
+		if (program.hasNames && !vars)
+			throw std::domain_error("Detected variable, but the variable map is null.");
+
+		mSlots.clear();
+		for (auto& name : program.variables)
+		{
+			ValueMap::iterator var = vars->find(name);
+			if (var == vars->end())
+				throw std::domain_error("Unable to find the variable '" + name + "'.");
+
+			mSlots.push_back(var->second);
+		}
+
+		return eval(program, mSlots);
+	}
+
+	MathExpr::Program MathExpr::compile(const char* expr)
+	{
+		std::vector<std::string> slotNames;
+		return compile(expr, slotNames, true);
+	}
+
+	MathExpr::Program MathExpr::compile(const char* expr, const std::vector<std::string>& slotNames)
+	{
+		std::vector<std::string> names = slotNames;
+		return compile(expr, names, false);
+	}
+
+	MathExpr::Program MathExpr::compile(const char* expr, std::vector<std::string>& slotNames, bool appendSlots)
 	{
 		// Convert to RPN with Dijkstra's Shunting-yard algorithm.
-		ValuePtrQueue rpn = toRPN(expr, vars, opPrecedence);
+		Program program;
+		ValuePtrQueue rpn = toRPN(expr, slotNames, appendSlots, program.hasNames);
+
+		program.rpn.reserve(rpn.size());
 
-		// Evaluate the expression in RPN form.
-		ValueStack evaluation;
+		// Number of values on the stack that come from constants only, they're at the end of program.rpn
+		size_t constants = 0;
 
-		while (!rpn.empty()) 
+		while (!rpn.empty())
 		{
 			Value* tok = rpn.front();
 			rpn.pop();
 
-			if (tok->isToken())
+			Value value = *tok;
+			delete tok;
+
+			if (!value.isToken())
 			{
-				std::string str = tok->string;
-				if (evaluation.size() < 2) {
-					throw std::domain_error("Invalid equation.");
-				}
-				Value right = evaluation.top(); evaluation.pop();
-				Value left = evaluation.top(); evaluation.pop();
-				if (!str.compare("+") && left.isNumber())
-					evaluation.push(left.number + right.toNumber());
-				if (!str.compare("+") && left.isString())
-					evaluation.push(left.string + right.toString());
-				else if (!str.compare("*"))
-					evaluation.push(left.toNumber() * right.toNumber());
-				else if (!str.compare("-"))
-					evaluation.push(left.toNumber() - right.toNumber());
-				else if (!str.compare("/"))
-				{
-					float r = right.toNumber();
-					if (r == 0)
-						evaluation.push(0);
-					else
-						evaluation.push(left.toNumber() / r);
-				}
-				else if (!str.compare("<<"))
-					evaluation.push((int)left.toNumber() << (int)right.toNumber());
-				else if (!str.compare("^"))
-					evaluation.push(pow(left.toNumber(), right.toNumber()));
-				else if (!str.compare(">>"))
-					evaluation.push((int)left.toNumber() >> (int)right.toNumber());
-				else if (!str.compare(">"))
-					evaluation.push(left.toNumber() > right.toNumber());
-				else if (!str.compare(">="))
-					evaluation.push(left.toNumber() >= right.toNumber());
-				else if (!str.compare("<"))
-					evaluation.push(left.toNumber() < right.toNumber());
-				else if (!str.compare("<="))
-					evaluation.push(left.toNumber() <= right.toNumber());
-				else if (!str.compare("&&"))
-					evaluation.push(left.toNumber() && right.toNumber());
-				else if (!str.compare("||"))
-					evaluation.push(left.toNumber() || right.toNumber());
-				else if (!str.compare("=="))
+				if (value.type == VARIABLE)
+					constants = 0;
+				else
+					constants++;
+
+				program.rpn.push_back(std::move(value));
+				continue;
+			}
+
+			value.number = (float)getOpcode(value.string);
+
+			// Fold the operators of two constants, the ones that throw are left for the evaluation
+			if (constants >= 2)
+			{
+				std::vector<Value> folded(program.rpn.end() - 2, program.rpn.end());
+
+				try
 				{
-					if (left.isNumber() && right.isNumber())
-						evaluation.push(left.number == right.number);
-					else if (left.isString() && right.isString())
-						evaluation.push(left.string == right.string);
-					else if (left.isString())
-						evaluation.push(left.string == right.toString());
-					else
-						evaluation.push(left.toNumber() == right.toNumber());
+					applyOperator(value, folded);
+
+					program.rpn.pop_back();
+					program.rpn.back() = std::move(folded.back());
+					constants--;
+					continue;
 				}
-				else if (!str.compare("!="))
+				catch (...)
 				{
-					if (left.isNumber() && right.isNumber())
-						evaluation.push(left.number != right.number);
-					else if (left.isString() && right.isString())
-						evaluation.push(left.string != right.string);
-					else if (left.isString())
-						evaluation.push(left.string != right.toString());
-					else
-						evaluation.push(left.toNumber() != right.toNumber());
+
 				}
-				else if (!str.compare("!"))
-					evaluation.push(!right.toNumber());
-				else
-					throw std::domain_error("Unknown operator: " + left.toString() + " " + str + " " + right.toString() + ".");
 			}
-			else if (tok->isNumber() || tok->isString())
+
+			constants = 0;
+			program.rpn.push_back(std::move(value));
+		}
+
+		for (auto& tok : program.rpn)
+			if (!tok.isToken() && tok.type != VARIABLE && !tok.isNumber() && !tok.isString())
+				throw std::domain_error("Invalid token '" + tok.toString() + "'.");
+
+		program.variables = slotNames;
+		return program;
+	}
+
+	MathExpr::Value MathExpr::eval(const Program& program, const std::vector<Value>& slots)
+	{
+		mStack.clear();
+
+		for (auto& tok : program.rpn)
+		{
+			if (tok.isToken())
+				applyOperator(tok, mStack);
+			else if (tok.type == VARIABLE)
 			{
-				evaluation.push(*tok);
+				size_t slot = (size_t)tok.number;
+				if (slot >= slots.size())
+					throw std::domain_error("Unable to find the variable '" + tok.string + "'.");
+
+				const Value& value = slots[slot];
+				if (!value.isNumber() && !value.isString())
+					throw std::domain_error("Invalid token '" + tok.string + "'.");
+
+				mStack.push_back(value);
 			}
 			else
-			{
-				throw std::domain_error("Invalid token '" + tok->toString() + "'.");
-			}
-
-			delete tok;
+				mStack.push_back(tok);
 		}
-		return evaluation.top();
+
+		if (mStack.empty())
+			throw std::domain_error("Invalid equation.");
+
+		return mStack.back();
 	}
-}
\ No newline at end of file
+}
@@ -11,6 +11,7 @@
 #include <string>
 #include <queue>
 #include <stack>
+#include <vector>
 
 namespace Utils
 {
@@ -24,7 +25,7 @@ namespace Utils
 			TOKEN = 1,
 			NUMBER = 2,
 			STRING = 4,
-
+			VARIABLE = 8	// Slot of a compiled program, its index is in number
 		};
 		struct Value
 		{
@@ -57,16 +58,48 @@ namespace Utils
 
 		typedef std::map<std::string, Value> ValueMap;
 		typedef std::queue<Value*> ValuePtrQueue;
-		typedef std::stack<Value> ValueStack;
 		typedef std::map<std::string, int> IntMap;
 
+		enum Opcode
+		{
+			OP_UNKNOWN = 0,
+			OP_ADD, OP_MUL, OP_SUB, OP_DIV, OP_SHL, OP_POW, OP_SHR,
+			OP_GT, OP_GE, OP_LT, OP_LE, OP_AND, OP_OR, OP_EQ, OP_NE, OP_NOT
+		};
+
+		// An expression tokenized once, with its constant parts folded. Operators have their Opcode in number, variables their slot index
+		struct Program
+		{
+			Program() : hasNames(false) { }
+
+			std::vector<Value> rpn;
+			std::vector<std::string> variables;
+			bool hasNames; // Variables, or true/false : evaluating the expression requires a variable map
+		};
+
 	public:
 		MathExpr();
 
+		// Programs are cached by expression, variables are read from vars at each call
 		MathExpr::Value eval(const char* expr, ValueMap* vars = 0);
 
+		// The variables of the expression are the ones of slotNames, or the ones found in the order they appear. Both throw like eval
+		Program compile(const char* expr);
+		Program compile(const char* expr, const std::vector<std::string>& slotNames);
+
+		// Only the string values allocate, the evaluation stack is kept between calls
+		MathExpr::Value eval(const Program& program, const std::vector<Value>& slots);
+
 	private:
-		static ValuePtrQueue toRPN(const char* expr, ValueMap* vars, IntMap opPrecedence);
+		ValuePtrQueue toRPN(const char* expr, std::vector<std::string>& slotNames, bool appendSlots, bool& hasNames) const;
+		Program compile(const char* expr, std::vector<std::string>& slotNames, bool appendSlots);
+
+		static int getOpcode(const std::string& str);
+		static void applyOperator(const Value& op, std::vector<Value>& evaluation);
+
+		std::map<std::string, Program> mPrograms;
+		std::vector<Value> mStack;
+		std::vector<Value> mSlots;
 
 		IntMap opPrecedence;
 	};
@@ -0,0 +1,149 @@
+#define _FILE_OFFSET_BITS 64
+
+#include "utils/MemoryMappedFile.h"
+#include "utils/StringUtil.h"
+
+#if WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>
+
+namespace Utils
+{
+	MemoryMappedFile::MemoryMappedFile() : mData(nullptr), mSize(0), mMapped(false)
+	{
+#if WIN32
+		mFileHandle = INVALID_HANDLE_VALUE;
+		mMappingHandle = nullptr;
+#endif
+	}
+
+	MemoryMappedFile::MemoryMappedFile(const std::string& path) : MemoryMappedFile()
+	{
+		open(path);
+	}
+
+	MemoryMappedFile::~MemoryMappedFile()
+	{
+		close();
+	}
+
+	bool MemoryMappedFile::open(const std::string& path)
+	{
+		close();
+
+#if WIN32
+		HANDLE hFile = CreateFileW(Utils::String::convertToWideString(path).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (hFile != INVALID_HANDLE_VALUE)
+		{
+			LARGE_INTEGER fileSize;
+			if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0)
+			{
+				HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+				if (hMapping != NULL)
+				{
+					void* view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+					if (view != NULL)
+					{
+						mFileHandle = hFile;
+						mMappingHandle = hMapping;
+						mData = (const unsigned char*)view;
+						mSize = (size_t)fileSize.QuadPart;
+						mMapped = true;
+						return true;
+					}
+
+					CloseHandle(hMapping);
+				}
+			}
+
+			CloseHandle(hFile);
+		}
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd >= 0)
+		{
+			struct stat info;
+			if (fstat(fd, &info) == 0 && info.st_size > 0)
+			{
+				void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (view != MAP_FAILED)
+				{
+					::close(fd); // the mapping keeps its own reference on the file
+
+					mData = (const unsigned char*)view;
+					mSize = (size_t)info.st_size;
+					mMapped = true;
+					return true;
+				}
+			}
+
+			::close(fd);
+		}
+#endif
+
+		// Fallback : read the file in memory
+#if WIN32
+		std::ifstream stream(Utils::String::convertToWideString(path), std::ios::in | std::ios::binary | std::ios::ate);
+#else
+		std::ifstream stream(path, std::ios::in | std::ios::binary | std::ios::ate);
+#endif
+		if (!stream.is_open())
+			return false;
+
+		std::streamoff length = stream.tellg();
+		if (length <= 0)
+			return false;
+
+		unsigned char* buffer = new unsigned char[(size_t)length];
+
+		stream.seekg(0, std::ios::beg);
+		stream.read((char*)buffer, length);
+		if (stream.gcount() != length)
+		{
+			delete[] buffer;
+			return false;
+		}
+
+		mData = buffer;
+		mSize = (size_t)length;
+		mMapped = false;
+		return true;
+	}
+
+	void MemoryMappedFile::close()
+	{
+		if (mData == nullptr)
+			return;
+
+		if (mMapped)
+		{
+#if WIN32
+			UnmapViewOfFile((LPCVOID)mData);
+
+			if (mMappingHandle != nullptr)
+				CloseHandle((HANDLE)mMappingHandle);
+
+			if (mFileHandle != INVALID_HANDLE_VALUE)
+				CloseHandle((HANDLE)mFileHandle);
+
+			mMappingHandle = nullptr;
+			mFileHandle = INVALID_HANDLE_VALUE;
+#else
+			munmap((void*)mData, mSize);
+#endif
+		}
+		else
+			delete[] mData;
+
+		mData = nullptr;
+		mSize = 0;
+		mMapped = false;
+	}
+}
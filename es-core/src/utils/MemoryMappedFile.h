@@ -0,0 +1,40 @@
+#pragma once
+#ifndef ES_CORE_UTILS_MEMORY_MAPPED_FILE_H
+#define ES_CORE_UTILS_MEMORY_MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+namespace Utils
+{
+	// Read-only view over a whole file. Uses mmap / MapViewOfFile when available, and falls back to reading the file in memory.
+	class MemoryMappedFile
+	{
+	public:
+		MemoryMappedFile();
+		MemoryMappedFile(const std::string& path);
+		~MemoryMappedFile();
+
+		bool open(const std::string& path);
+		void close();
+
+		inline bool isOpen() const { return mData != nullptr; }
+		inline const unsigned char* data() const { return mData; }
+		inline size_t size() const { return mSize; }
+
+	private:
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+		const unsigned char* mData;
+		size_t mSize;
+		bool mMapped;
+
+#if WIN32
+		void* mFileHandle;
+		void* mMappingHandle;
+#endif
+	};
+}
+
+#endif // ES_CORE_UTILS_MEMORY_MAPPED_FILE_H
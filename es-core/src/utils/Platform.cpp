@@ -4,6 +4,7 @@
 
 #if WIN32
 #include <codecvt>
+#include <psapi.h>
 #else
 #include <sys/types.h>
 #include <unistd.h>
@@ -579,5 +580,42 @@ namespace Utils
 
 			return "";
 		}
+
+		size_t getProcessMemoryUsage()
+		{
+#if WIN32
+			PROCESS_MEMORY_COUNTERS counters;
+			if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+				return (size_t)counters.WorkingSetSize;
+#else
+			FILE* file = fopen("/proc/self/statm", "r");
+			if (file != nullptr)
+			{
+				unsigned long size = 0, resident = 0;
+				int count = fscanf(file, "%lu %lu", &size, &resident);
+				fclose(file);
+
+				if (count == 2)
+					return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+			}
+#endif
+			return 0;
+		}
+
+		size_t getTotalMemory()
+		{
+#if WIN32
+			MEMORYSTATUSEX status;
+			status.dwLength = sizeof(status);
+			if (GlobalMemoryStatusEx(&status))
+				return (size_t)status.ullTotalPhys;
+#else
+			long pages = sysconf(_SC_PHYS_PAGES);
+			long pageSize = sysconf(_SC_PAGESIZE);
+			if (pages > 0 && pageSize > 0)
+				return (size_t)pages * (size_t)pageSize;
+#endif
+			return 0;
+		}
 	}
 }
@@ -63,6 +63,9 @@ namespace Utils
 
 		std::string queryIPAdress();
 		std::string getArchString();
+
+		size_t getProcessMemoryUsage(); // resident set size in bytes, 0 when unknown
+		size_t getTotalMemory(); // physical RAM in bytes, 0 when unknown
 	}
 }
 
@@ -0,0 +1,111 @@
+#include "utils/StringPool.h"
+#include "Log.h"
+
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+// Strings are stored in fixed size chunks which are never moved : get() doesn't need to lock
+#define POOL_CHUNK_BITS		12
+#define POOL_CHUNK_SIZE		(1 << POOL_CHUNK_BITS)
+#define POOL_MAX_CHUNKS		4096
+
+namespace Utils
+{
+	static std::mutex							sPoolLock;
+	static std::unordered_multimap<size_t, unsigned int> sPoolIndex; // hash -> ids ( so the strings are not stored twice )
+	static std::atomic<std::string*>			sPoolChunks[POOL_MAX_CHUNKS];
+	static unsigned int							sPoolCount = 1;
+	static size_t								sPoolBytes = 0;
+	static bool									sPoolFull = false;
+
+	static const std::string					sEmptyString;
+
+	unsigned int StringPool::intern(const std::string& value)
+	{
+		if (value.empty())
+			return 0;
+
+		size_t hash = std::hash<std::string>()(value);
+
+		std::unique_lock<std::mutex> lock(sPoolLock);
+
+		auto range = sPoolIndex.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+			if (get(it->second) == value)
+				return it->second;
+
+		unsigned int id = sPoolCount;
+
+		unsigned int chunk = id >> POOL_CHUNK_BITS;
+		if (chunk >= POOL_MAX_CHUNKS)
+		{
+			if (!sPoolFull)
+				LOG(LogError) << "StringPool : full, " << (sPoolCount - 1) << " strings. The next ones are not interned";
+
+			sPoolFull = true;
+			return 0;
+		}
+
+		std::string* strings = sPoolChunks[chunk].load(std::memory_order_acquire);
+		if (strings == nullptr)
+		{
+			strings = new std::string[POOL_CHUNK_SIZE];
+			sPoolChunks[chunk].store(strings, std::memory_order_release);
+		}
+
+		strings[id & (POOL_CHUNK_SIZE - 1)] = value;
+		sPoolIndex.insert(std::pair<size_t, unsigned int>(hash, id));
+		sPoolBytes += value.capacity() + 1;
+		sPoolCount++;
+
+		return id;
+	}
+
+	unsigned int StringPool::find(const std::string& value)
+	{
+		if (value.empty())
+			return 0;
+
+		size_t hash = std::hash<std::string>()(value);
+
+		std::unique_lock<std::mutex> lock(sPoolLock);
+
+		auto range = sPoolIndex.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+			if (get(it->second) == value)
+				return it->second;
+
+		return 0;
+	}
+
+	const std::string& StringPool::get(unsigned int id)
+	{
+		if (id == 0)
+			return sEmptyString;
+
+		unsigned int chunk = id >> POOL_CHUNK_BITS;
+		if (chunk >= POOL_MAX_CHUNKS)
+			return sEmptyString;
+
+		std::string* strings = sPoolChunks[chunk].load(std::memory_order_acquire);
+		if (strings == nullptr)
+			return sEmptyString;
+
+		return strings[id & (POOL_CHUNK_SIZE - 1)];
+	}
+
+	unsigned int StringPool::size()
+	{
+		std::unique_lock<std::mutex> lock(sPoolLock);
+		return sPoolCount - 1;
+	}
+
+	size_t StringPool::memoryUsage()
+	{
+		std::unique_lock<std::mutex> lock(sPoolLock);
+
+		size_t chunks = (sPoolCount + POOL_CHUNK_SIZE - 1) >> POOL_CHUNK_BITS;
+		return sPoolBytes + chunks * POOL_CHUNK_SIZE * sizeof(std::string) + sPoolIndex.size() * (sizeof(size_t) + sizeof(unsigned int) + 2 * sizeof(void*));
+	}
+}
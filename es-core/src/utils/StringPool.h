@@ -0,0 +1,25 @@
+#pragma once
+#ifndef ES_CORE_UTILS_STRING_POOL_H
+#define ES_CORE_UTILS_STRING_POOL_H
+
+#include <string>
+
+namespace Utils
+{
+	// Process wide pool of interned strings. Ids are stable for the lifetime of the process, 0 is the empty string.
+	// Used for the metadata values repeated across games ( developer, genre, region... ) so they are stored once, and can be compared as integers.
+	class StringPool
+	{
+	public:
+		// 0 when the pool is full ( an error is logged ) : don't use it as the id of a non empty string
+		static unsigned int intern(const std::string& value);
+		// Id of a string which has already been interned, 0 if not
+		static unsigned int find(const std::string& value);
+		static const std::string& get(unsigned int id);
+
+		static unsigned int size();
+		static size_t memoryUsage();
+	};
+}
+
+#endif // ES_CORE_UTILS_STRING_POOL_H
@@ -0,0 +1,64 @@
+#include "utils/StringTemplate.h"
+
+namespace Utils
+{
+	StringTemplate::StringTemplate(const std::string& source, const std::vector<Delimiter>& delimiters) : mLiteralSize(0)
+	{
+		std::string literal;
+		size_t pos = 0;
+
+		while (pos < source.size())
+		{
+			// Nearest reference
+			size_t start = std::string::npos;
+			int kind = LITERAL;
+
+			for (int i = 0; i < (int)delimiters.size(); i++)
+			{
+				size_t found = source.find(delimiters[i].start, pos);
+				if (found != std::string::npos && (start == std::string::npos || found < start))
+				{
+					start = found;
+					kind = i;
+				}
+			}
+
+			if (kind == LITERAL)
+				break;
+
+			const Delimiter& delimiter = delimiters[kind];
+
+			size_t nameStart = start + delimiter.start.size();
+			size_t end = source.find(delimiter.end, nameStart);
+			if (end == std::string::npos)
+				break;
+
+			if (end == nameStart)
+			{
+				literal.append(source, pos, end + delimiter.end.size() - pos);
+				pos = end + delimiter.end.size();
+				continue;
+			}
+
+			literal.append(source, pos, start - pos);
+			if (!literal.empty())
+			{
+				mLiteralSize += literal.size();
+				mSegments.push_back(Segment{ LITERAL, literal });
+				literal.clear();
+			}
+
+			mSegments.push_back(Segment{ kind, source.substr(nameStart, end - nameStart) });
+			pos = end + delimiter.end.size();
+		}
+
+		if (pos < source.size())
+			literal.append(source, pos, std::string::npos);
+
+		if (!literal.empty())
+		{
+			mLiteralSize += literal.size();
+			mSegments.push_back(Segment{ LITERAL, literal });
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef ES_CORE_UTILS_STRING_TEMPLATE_H
+#define ES_CORE_UTILS_STRING_TEMPLATE_H
+
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+	// A string parsed once into literal text and variable references ( "${name}", "{game:name}"... ), so that it can be evaluated many times.
+	class StringTemplate
+	{
+	public:
+		struct Delimiter
+		{
+			std::string start;
+			std::string end;
+		};
+
+		struct Segment
+		{
+			int			kind; // LITERAL, or the index of the delimiter
+			std::string	text; // Literal text, or variable name
+		};
+
+		static const int LITERAL = -1;
+
+		StringTemplate() : mLiteralSize(0) { }
+
+		// References with an empty name, or without end delimiter, are kept as literal text
+		StringTemplate(const std::string& source, const std::vector<Delimiter>& delimiters);
+
+		inline bool hasVariables() const { return mSegments.size() > 1 || (mSegments.size() == 1 && mSegments[0].kind != LITERAL); }
+		inline const std::vector<Segment>& segments() const { return mSegments; }
+
+		// 'resolve(std::string& output, int kind, const std::string& name)' appends the value of a variable. Only the output string is allocated
+		template<typename T>
+		std::string evaluate(const T& resolve) const
+		{
+			std::string ret;
+			ret.reserve(mLiteralSize + 16 * mSegments.size());
+
+			for (auto& segment : mSegments)
+			{
+				if (segment.kind == LITERAL)
+					ret.append(segment.text);
+				else
+					resolve(ret, segment.kind, segment.text);
+			}
+
+			return ret;
+		}
+
+	private:
+		std::vector<Segment> mSegments;
+		size_t mLiteralSize;
+	};
+}
+
+#endif // ES_CORE_UTILS_STRING_TEMPLATE_H
@@ -13,14 +13,18 @@ namespace Utils
 		typedef std::vector<std::string> stringVector;
 
 		unsigned int chars2Unicode      (const std::string& _string, size_t& _cursor);
+		void         decodeUnicode      (const std::string& _string, std::vector<unsigned int>& _codepoints); // The whole string, ASCII runs 8 bytes at a time
 		std::string  unicode2Chars      (const unsigned int _unicode);
 		size_t       nextCursor         (const std::string& _string, const size_t _cursor);
 		size_t       prevCursor         (const std::string& _string, const size_t _cursor);
 		size_t       moveCursor         (const std::string& _string, const size_t _cursor, const int _amount);
 		std::string  toLower            (const std::string& _string);
 		std::string  toUpper            (const std::string& _string);
+		void         toLowerInPlace     (std::string& _string);
+		void         toUpperInPlace     (std::string& _string);
 		std::string  trim               (const std::string& _string);
 		std::string  replace            (const std::string& _string, const std::string& _replace, const std::string& _with);
+		void         replaceInPlace     (std::string& _string, const std::string& _replace, const std::string& _with);
 		bool         startsWith         (const std::string& _string, const std::string& _start);
 		bool         endsWith           (const std::string& _string, const std::string& _end);
 		std::string  removeParenthesis  (const std::string& _string);		
@@ -36,6 +40,7 @@ namespace Utils
 
 		std::string join(const std::vector<std::string>& items, std::string separator);
 		int			compareIgnoreCase(const std::string& name1, const std::string& name2);
+		std::u32string foldCase(const std::string& name); // Keys that compare like compareIgnoreCase
 		std::string proper(const std::string& _string);
 		std::string removeHtmlTags(const std::string& html);
 		bool        containsIgnoreCase(const std::string & _string, const std::string & _what);
@@ -54,6 +59,19 @@ namespace Utils
 
 		bool		isPrintableChar(char c);
 
+		// chars2Unicode with the ASCII case inlined, for the text layout loops
+		inline unsigned int nextUnicode(const std::string& _string, size_t& _cursor)
+		{
+			unsigned char c = (unsigned char)_string[_cursor];
+			if (c < 0x80)
+			{
+				_cursor++;
+				return c;
+			}
+
+			return chars2Unicode(_string, _cursor);
+		}
+
 #if defined(_WIN32)
 		const std::string convertFromWideString(const std::wstring wstring);
 		const std::wstring convertToWideString(const std::string string);
@@ -1,126 +1,99 @@
 #include "ThreadPool.h"
 
-#if WIN32
-#include <Windows.h>
-#endif
+#include <chrono>
 
 namespace Utils
 {
-	ThreadPool::ThreadPool(int threadByCore) : mRunning(false), mWaiting(false), mNumWork(0)
+	ThreadPool::ThreadPool(TaskScheduler::Priority priority) : mPriority(priority), mGroup(std::make_shared<Group>())
 	{
-		mThreadByCore = threadByCore;
 	}
 
-	void ThreadPool::start()
+	ThreadPool::~ThreadPool()
 	{
-		mRunning = true;
+		stop();
+	}
 
-		size_t num_threads = std::thread::hardware_concurrency() * mThreadByCore;
+	bool ThreadPool::Group::runOne()
+	{
+		work_function work;
 
-		auto doWork = [&](size_t id)
 		{
-#if WIN32
-			auto mask = (static_cast<DWORD_PTR>(1) << id);
-			SetThreadAffinityMask(GetCurrentThread(), mask);
-#endif
+			std::unique_lock<std::mutex> guard(lock);
+			if (workQueue.empty())
+				return false;
 
-			while (mRunning)
+			work = workQueue.front();
+			workQueue.pop();
+		}
+
+		if (running)
+		{
+			try
 			{
-				_mutex.lock();
-				if (!mWorkQueue.empty())
-				{
-					auto work = mWorkQueue.front();
-					mWorkQueue.pop();
-					_mutex.unlock();
-
-					try
-					{
-						work();
-					}
-					catch (...) {}
-					
-					mNumWork--;
-				}
-				else
-				{
-					_mutex.unlock();
-
-					// Extra code : Exit finished threads
-					if (mWaiting)
-						return;
-
-					std::this_thread::yield();
-					std::this_thread::sleep_for(std::chrono::milliseconds(1));
-				}
+				work();
 			}
-		};
-
-		mThreads.reserve(num_threads);
-
-		for (size_t i = 0; i < num_threads; i++)
-			mThreads.push_back(std::thread(doWork, i));
-	}
+			catch (...) {}
+		}
 
-	ThreadPool::~ThreadPool()
-	{
-		mRunning = false;
+		std::unique_lock<std::mutex> guard(lock);
+		if (--numWork == 0)
+			changed.notify_all();
 
-		for (std::thread& t : mThreads)
-			if (t.joinable())
-				t.join();
+		return true;
 	}
 
 	void ThreadPool::queueWorkItem(work_function work)
 	{
-		_mutex.lock();
-		mWorkQueue.push(work);
-		mNumWork++;
-		_mutex.unlock();
+		{
+			std::unique_lock<std::mutex> guard(mGroup->lock);
+			mGroup->workQueue.push(work);
+			mGroup->numWork++;
+			mGroup->changed.notify_all();
+		}
+
+		// The scheduler task may find the queue already emptied by a waiting thread : it just returns
+		auto group = mGroup;
+		TaskScheduler::submit(mPriority, [group]() { group->runOne(); });
 	}
 
 	void ThreadPool::wait()
 	{
-		if (!mRunning)
-			start();
+		while (true)
+		{
+			if (mGroup->runOne())
+				continue;
+
+			// Nothing left to take : sleep until the running items end, or queue new ones
+			std::unique_lock<std::mutex> guard(mGroup->lock);
+			mGroup->changed.wait(guard, [this]() { return mGroup->numWork == 0 || !mGroup->workQueue.empty(); });
 
-		mWaiting = true;
-		while (mNumWork.load() > 0)
-			std::this_thread::yield();
+			if (mGroup->numWork == 0)
+				break;
+		}
 	}
 
 	void ThreadPool::wait(work_function work, int delay)
 	{
-		if (!mRunning)
-			start();
-
-		mWaiting = true;
-
-		while (mNumWork.load() > 0)
+		// The caller renders the progress : it doesn't take work items
+		while (mGroup->numWork.load() > 0)
 		{
 			work();
 
-			std::this_thread::yield();
-			std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+			std::unique_lock<std::mutex> guard(mGroup->lock);
+			mGroup->changed.wait_for(guard, std::chrono::milliseconds(delay), [this]() { return mGroup->numWork == 0; });
 		}
 	}
 
 	void ThreadPool::stop()
 	{
-		_mutex.lock();
+		std::unique_lock<std::mutex> guard(mGroup->lock);
 
-		while (!mWorkQueue.empty())
+		while (!mGroup->workQueue.empty())
 		{
-			mNumWork--;
-			mWorkQueue.pop();
+			mGroup->numWork--;
+			mGroup->workQueue.pop();
 		}
-		
-		_mutex.unlock();
-		mWaiting = true;
 
-		while (mNumWork.load() > 0)
-		{
-			std::this_thread::yield();
-			std::this_thread::sleep_for(std::chrono::milliseconds(10));
-		}
+		mGroup->changed.wait(guard, [this]() { return mGroup->numWork == 0; });
 	}
-}
\ No newline at end of file
+}
@@ -1,41 +1,65 @@
 #ifndef __THREADPOOL
 #define __THREADPOOL
 
-#include <thread>
+#include "TaskScheduler.h"
 #include <mutex>
+#include <condition_variable>
+#include <future>
 #include <queue>
 #include <atomic>
+#include <memory>
 #include <functional>
 
 namespace Utils
 {
+	// A group of work items, run by the TaskScheduler workers of its priority class.
+	// Waiting threads run the queued items of their own group, so pools can be nested in work items, then sleep until the running ones end
 	class ThreadPool
 	{
 	public:
 		typedef std::function<void(void)> work_function;
 
-		ThreadPool(int threadByCore = 2);
+		ThreadPool(TaskScheduler::Priority priority = TaskScheduler::UI_CRITICAL);
 		~ThreadPool();
 
-		void start();
 		void queueWorkItem(work_function work);
+
+		// The result ( or the exception ) of the work item. Cancelled or stopped before it started, the future reports a broken promise
+		template<class F> auto submit(F func) -> std::future<decltype(func())>
+		{
+			typedef decltype(func()) result_type;
+
+			auto task = std::make_shared<std::packaged_task<result_type()>>(func);
+			auto result = task->get_future();
+
+			queueWorkItem([task]() { (*task)(); });
+			return result;
+		}
+
 		void wait();
 		void wait(work_function work, int delay = 50);
-		void cancel() { mRunning = false; }
+		void cancel() { mGroup->running = false; }
 		void stop();
 
-		bool isRunning() { return mRunning; }
+		bool isRunning() { return mGroup->running; }
 
 	private:
-		bool mRunning;
-		bool mWaiting;
-		std::queue<work_function> mWorkQueue;
-		std::atomic<size_t> mNumWork;
-		std::mutex _mutex;
-		std::vector<std::thread> mThreads;
-		int mThreadByCore;
+		struct Group
+		{
+			Group() : running(true), numWork(0) { }
+
+			bool runOne();
+
+			std::atomic<bool> running;
+			std::queue<work_function> workQueue;
+			std::atomic<size_t> numWork; // Queued & running, changed under the lock
+			std::mutex lock;
+			std::condition_variable changed; // An item was queued or the last one ended
+		};
 
+		TaskScheduler::Priority mPriority;
+		std::shared_ptr<Group> mGroup;
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -13,6 +13,7 @@
 #include <string>
 #include "zip_file.hpp"
 #include "FileSystemUtil.h"
+#include "Crc32.h"
 #include "md5.h"
 #include "Log.h"
 
@@ -22,7 +23,7 @@ namespace Utils
 	{
 		unsigned int ZipFile::computeCRC(unsigned int crc, const void* ptr, size_t buf_len)
 		{			
-			return (mz_uint32)mz_crc32((mz_uint32)crc, (const mz_uint8 *)ptr, buf_len);
+			return Utils::Crc32::compute(crc, ptr, buf_len);
 		}
 
 		#define mZipArchive   ((mz_zip_archive*) mZipFile)
@@ -213,6 +214,7 @@ namespace Utils
 				zi.file_size = file_stat.m_uncomp_size;
 				zi.compress_size = file_stat.m_comp_size;
 				zi.crc = file_stat.m_crc32;				
+				zi.index = i;
 
 				ret.push_back(zi);
 
@@ -304,6 +306,79 @@ namespace Utils
 			return false;
 		}
 
+		bool ZipFile::readBuffered(const ZipInfo& info, zip_callback pCallback, void* pOpaque)
+		{
+			if (mZipFile == nullptr)
+				return false;
+
+			if (info.index < 0)
+				return readBuffered(info.filename, pCallback, pOpaque);
+
+			try
+			{
+				return mz_zip_reader_extract_to_callback(mZipArchive, info.index, pCallback, pOpaque, 0);
+			}
+			catch (...)
+			{
+
+			}
+
+			return false;
+		}
+
+		bool ZipFile::readFile(const std::string &name, std::vector<unsigned char>& data, size_t maxSize)
+		{
+			data.clear();
+
+			if (mZipFile == nullptr)
+				return false;
+
+			struct ReadContext
+			{
+				std::vector<unsigned char>* data;
+				size_t maxSize;
+			} context = { &data, maxSize };
+
+			// Returning less than n stops the decompression
+			Utils::Zip::zip_callback func = [](void *pOpaque, unsigned long long ofs, const void *pBuf, size_t n)
+			{
+				ReadContext* ctx = (ReadContext*)pOpaque;
+				if (ctx->data->size() + n > ctx->maxSize)
+					return (size_t)0;
+
+				ctx->data->insert(ctx->data->end(), (const unsigned char*)pBuf, (const unsigned char*)pBuf + n);
+				return n;
+			};
+
+			if (readBuffered(name, func, &context))
+				return true;
+
+			data.clear();
+			return false;
+		}
+
+		bool ZipFile::findSingleFile(ZipInfo& info)
+		{
+			if (mZipFile == nullptr)
+				return false;
+
+			bool found = false;
+
+			for (auto& it : infolist())
+			{
+				if (Utils::FileSystem::getExtension(it.filename) == ".txt" || it.filename.empty() || it.filename.back() == '/')
+					continue;
+
+				if (found)
+					return false;
+
+				info = it;
+				found = true;
+			}
+
+			return found;
+		}
+
 		std::string ZipFile::getFileCrc(const std::string &name)
 		{
 			if (mZipFile == nullptr)
@@ -17,6 +17,7 @@ namespace Utils
 			std::size_t compress_size = 0;
 			std::size_t file_size = 0;
 			uint32_t crc = 0;
+			int index = -1; // Position in the central directory, for the reads that don't look the name up
 		};
 
 		class ZipFile
@@ -29,6 +30,11 @@ namespace Utils
 			bool extract(const std::string &member, const std::string &path, bool pathIsFullPath = false);
 
 			bool readBuffered(const std::string &name, zip_callback pCallback, void* pOpaque);
+			bool readBuffered(const ZipInfo& info, zip_callback pCallback, void* pOpaque);
+			bool readFile(const std::string &name, std::vector<unsigned char>& data, size_t maxSize);
+
+			// The only member which is not a folder or a .txt file : the rom of single game archives
+			bool findSingleFile(ZipInfo& info);
 
 			std::string getFileCrc(const std::string &name);
 			std::string getFileMd5(const std::string &name);
@@ -168,30 +168,34 @@ static void* rc_hash_handle_cd_open_track(const char* path, uint32_t track)
 	return nullptr;
 }
 
+static void initReaders()
+{
+	if (readersinit)
+		return;
+
+	filereader.open = rc_hash_handle_file_open;
+	filereader.seek = rc_hash_handle_file_seek;
+	filereader.tell = rc_hash_handle_file_tell;
+	filereader.read = rc_hash_handle_file_read;
+	filereader.close = rc_hash_handle_file_close;
+	rc_hash_init_custom_filereader(&filereader);
+
+	cdreader.open_track = rc_hash_handle_cd_open_track;
+	cdreader.read_sector = rc_hash_handle_read_sector;
+	cdreader.close_track = rc_hash_handle_close_track;
+	cdreader.first_track_sector = rc_hash_handle_first_track_sector;
+
+	rc_hash_get_default_cdreader(&mDefaultCdReader);
+	rc_hash_init_custom_cdreader(&cdreader);
+
+	readersinit = true;
+}
+
 bool generateHashFromFile(char hash[33], int console_id, const char* path)
 {
 	try
 	{
-		if (!readersinit)
-		{
-			filereader.open = rc_hash_handle_file_open;
-			filereader.seek = rc_hash_handle_file_seek;
-			filereader.tell = rc_hash_handle_file_tell;
-			filereader.read = rc_hash_handle_file_read;
-			filereader.close = rc_hash_handle_file_close;
-			rc_hash_init_custom_filereader(&filereader);
-
-			cdreader.open_track = rc_hash_handle_cd_open_track;
-			cdreader.read_sector = rc_hash_handle_read_sector;
-			cdreader.close_track = rc_hash_handle_close_track;
-			cdreader.first_track_sector = rc_hash_handle_first_track_sector;
-
-			rc_hash_get_default_cdreader(&mDefaultCdReader);
-			rc_hash_init_custom_cdreader(&cdreader);
-
-			readersinit = true;
-		}
-
+		initReaders();
 		return rc_hash_generate_from_file(hash, console_id, path) != 0;
 	}
 	catch (...)
@@ -200,3 +204,70 @@ bool generateHashFromFile(char hash[33], int console_id, const char* path)
 
 	return false;
 }
+
+bool isHashFromBufferSupported(int console_id)
+{
+	switch (console_id)
+	{
+	case RC_CONSOLE_AMSTRAD_PC:
+	case RC_CONSOLE_APPLE_II:
+	case RC_CONSOLE_ARCADIA_2001:
+	case RC_CONSOLE_ATARI_2600:
+	case RC_CONSOLE_ATARI_JAGUAR:
+	case RC_CONSOLE_COLECOVISION:
+	case RC_CONSOLE_COMMODORE_64:
+	case RC_CONSOLE_ELEKTOR_TV_GAMES_COMPUTER:
+	case RC_CONSOLE_FAIRCHILD_CHANNEL_F:
+	case RC_CONSOLE_GAMEBOY:
+	case RC_CONSOLE_GAMEBOY_ADVANCE:
+	case RC_CONSOLE_GAMEBOY_COLOR:
+	case RC_CONSOLE_GAME_GEAR:
+	case RC_CONSOLE_INTELLIVISION:
+	case RC_CONSOLE_INTERTON_VC_4000:
+	case RC_CONSOLE_MAGNAVOX_ODYSSEY2:
+	case RC_CONSOLE_MASTER_SYSTEM:
+	case RC_CONSOLE_MEGA_DRIVE:
+	case RC_CONSOLE_MEGADUCK:
+	case RC_CONSOLE_MSX:
+	case RC_CONSOLE_NEOGEO_POCKET:
+	case RC_CONSOLE_ORIC:
+	case RC_CONSOLE_PC8800:
+	case RC_CONSOLE_POKEMON_MINI:
+	case RC_CONSOLE_SEGA_32X:
+	case RC_CONSOLE_SG1000:
+	case RC_CONSOLE_SUPERVISION:
+	case RC_CONSOLE_TI83:
+	case RC_CONSOLE_TIC80:
+	case RC_CONSOLE_UZEBOX:
+	case RC_CONSOLE_VECTREX:
+	case RC_CONSOLE_VIRTUAL_BOY:
+	case RC_CONSOLE_WASM4:
+	case RC_CONSOLE_WONDERSWAN:
+	case RC_CONSOLE_ARDUBOY:
+	case RC_CONSOLE_ATARI_7800:
+	case RC_CONSOLE_ATARI_LYNX:
+	case RC_CONSOLE_NINTENDO:
+	case RC_CONSOLE_PC_ENGINE:
+	case RC_CONSOLE_SUPER_NINTENDO:
+	case RC_CONSOLE_NINTENDO_64:
+	case RC_CONSOLE_NINTENDO_DS:
+	case RC_CONSOLE_NINTENDO_DSI:
+		return true;
+	}
+
+	return false;
+}
+
+bool generateHashFromBuffer(char hash[33], int console_id, const unsigned char* buffer, size_t size)
+{
+	try
+	{
+		initReaders();
+		return rc_hash_generate_from_buffer(hash, console_id, buffer, size) != 0;
+	}
+	catch (...)
+	{
+	}
+
+	return false;
+}
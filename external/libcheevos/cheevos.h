@@ -1,5 +1,10 @@
 #pragma once
 
 #include "rcheevos/include/rc_consoles.h"
+#include <cstddef>
 
 bool generateHashFromFile(char hash[33], int console_id, const char* path);
+
+// Cartridge based consoles, hashed from the rom contents ( no CD images )
+bool isHashFromBufferSupported(int console_id);
+bool generateHashFromBuffer(char hash[33], int console_id, const unsigned char* buffer, size_t size);